@@ -0,0 +1,370 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+#include "../suite/workbook_generator.hpp"
+#include "library_adapter.hpp"
+
+// Measures xlnt and, where they were found when building, libxlsxwriter, OpenXLSX and
+// openpyxl on the same workloads and inputs and writes the results as JSON, e.g.
+// xlnt_comparison --rows=100000 --repetitions=5 --output=results.json
+// The inputs are the files given on the command line, or the files in benchmarks/data,
+// and a synthetic workbook of the shape given with the arguments of xlnt_generate_workbook.
+// Each result is the fastest of the repetitions and the highest peak memory of them.
+
+namespace {
+
+const std::vector<xlnt_comparison::workload> all_workloads = {xlnt_comparison::workload::load,
+    xlnt_comparison::workload::save, xlnt_comparison::workload::streaming_read,
+    xlnt_comparison::workload::streaming_write};
+
+struct options
+{
+    xlnt_benchmark::workbook_shape shape;
+    std::vector<std::string> inputs;
+    std::vector<std::string> libraries;
+    std::vector<std::string> workloads;
+    std::size_t repetitions = 3;
+    std::string output;
+};
+
+std::vector<std::string> split_list(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    std::string item;
+
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+
+    return items;
+}
+
+bool selected(const std::vector<std::string> &selection, const std::string &name)
+{
+    return selection.empty() || std::find(selection.begin(), selection.end(), name) != selection.end();
+}
+
+std::size_t file_size(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<std::size_t>(file.tellg()) : 0;
+}
+
+std::string json_string(const std::string &text)
+{
+    std::string escaped = "\"";
+
+    for (const auto c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            escaped.append("\\\"");
+            break;
+        case '\\':
+            escaped.append("\\\\");
+            break;
+        case '\n':
+            escaped.append("\\n");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char control[7];
+                std::snprintf(control, sizeof(control), "\\u%04x", static_cast<unsigned int>(c));
+                escaped.append(control);
+            }
+            else
+            {
+                escaped.push_back(c);
+            }
+        }
+    }
+
+    return escaped + "\"";
+}
+
+// the cells of wb as tables, read with xlnt before anything is measured
+std::vector<xlnt_comparison::table_sheet> read_tables(const std::string &path)
+{
+    xlnt::workbook wb;
+    wb.load(path);
+    std::vector<xlnt_comparison::table_sheet> sheets;
+
+    for (const auto ws : wb)
+    {
+        sheets.push_back({ws.title(), {}});
+
+        for (const auto row : ws.rows(true))
+        {
+            for (const auto cell : row)
+            {
+                xlnt_comparison::table_cell value{cell.row(), cell.column_index(),
+                    xlnt_comparison::table_cell::kind::number, 0.0, std::string()};
+
+                switch (cell.data_type())
+                {
+                case xlnt::cell_type::empty:
+                    continue;
+                case xlnt::cell_type::boolean:
+                    value.type = xlnt_comparison::table_cell::kind::boolean;
+                    value.number = cell.value<bool>() ? 1.0 : 0.0;
+                    break;
+                case xlnt::cell_type::number:
+                case xlnt::cell_type::date:
+                    value.number = cell.value<double>();
+                    break;
+                default:
+                    value.type = xlnt_comparison::table_cell::kind::text;
+                    value.text = cell.value<std::string>();
+                    break;
+                }
+
+                sheets.back().cells.push_back(std::move(value));
+            }
+        }
+    }
+
+    return sheets;
+}
+
+std::vector<std::unique_ptr<xlnt_comparison::library_adapter>> available_adapters()
+{
+    std::vector<std::unique_ptr<xlnt_comparison::library_adapter>> adapters;
+    adapters.push_back(xlnt_comparison::make_xlnt_adapter());
+#ifdef XLNT_COMPARISON_XLSXWRITER
+    adapters.push_back(xlnt_comparison::make_xlsxwriter_adapter());
+#endif
+#ifdef XLNT_COMPARISON_OPENXLSX
+    adapters.push_back(xlnt_comparison::make_openxlsx_adapter());
+#endif
+#ifdef XLNT_COMPARISON_PYTHON
+    adapters.push_back(xlnt_comparison::make_openpyxl_adapter(XLNT_COMPARISON_PYTHON, XLNT_COMPARISON_OPENPYXL_SCRIPT));
+#endif
+    return adapters;
+}
+
+bool parse_arguments(int argc, char *argv[], options &parsed)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        const auto value = argument.substr(argument.find('=') + 1);
+
+        if (xlnt_benchmark::parse_shape_argument(argument, parsed.shape))
+        {
+            continue;
+        }
+        else if (argument.compare(0, 12, "--libraries=") == 0)
+        {
+            parsed.libraries = split_list(value);
+        }
+        else if (argument.compare(0, 12, "--workloads=") == 0)
+        {
+            parsed.workloads = split_list(value);
+        }
+        else if (argument.compare(0, 14, "--repetitions=") == 0)
+        {
+            parsed.repetitions = std::max<std::size_t>(1, std::stoul(value));
+        }
+        else if (argument.compare(0, 9, "--output=") == 0)
+        {
+            parsed.output = value;
+        }
+        else if (argument.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "unknown argument " << argument << "\n"
+                      << "usage: " << argv[0] << " [--libraries=xlnt,libxlsxwriter,OpenXLSX,openpyxl]"
+                      << " [--workloads=load,save,streaming_read,streaming_write] [--repetitions=N]"
+                      << " [--output=results.json] [workbook shape arguments of xlnt_generate_workbook]"
+                      << " [input.xlsx ...]\n";
+            return false;
+        }
+        else
+        {
+            parsed.inputs.push_back(argument);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    options parsed;
+
+    if (!parse_arguments(argc, argv, parsed))
+    {
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::string>> files; // name and path
+
+    for (const auto &input : parsed.inputs)
+    {
+        files.emplace_back(xlnt::path(input).filename(), input);
+    }
+
+    if (files.empty())
+    {
+        for (const auto &name : {"large.xlsx", "very_large.xlsx"})
+        {
+            files.emplace_back(name, std::string(XLNT_BENCHMARK_DATA_DIR) + "/" + name);
+        }
+    }
+
+    const std::string synthetic_path = "xlnt_comparison_synthetic.xlsx";
+    const std::string output_path = "xlnt_comparison_output.xlsx";
+
+    try
+    {
+        xlnt_benchmark::generate_workbook(parsed.shape).save(synthetic_path);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "couldn't generate the synthetic workbook: " << e.what() << "\n";
+        return 1;
+    }
+
+    files.emplace_back("synthetic", synthetic_path);
+
+    auto adapters = available_adapters();
+    std::ostringstream results;
+    results << std::setprecision(9);
+    auto first_result = true;
+
+    for (const auto &file : files)
+    {
+        xlnt_comparison::workload_input input;
+        input.name = file.first;
+        input.path = file.second;
+
+        try
+        {
+            input.sheets = read_tables(input.path);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "skipping " << input.path << ": " << e.what() << "\n";
+            continue;
+        }
+
+        for (const auto &adapter : adapters)
+        {
+            if (!selected(parsed.libraries, adapter->name()))
+            {
+                continue;
+            }
+
+            for (const auto w : all_workloads)
+            {
+                const auto workload = xlnt_comparison::workload_name(w);
+
+                if (!adapter->supports(w) || !selected(parsed.workloads, workload))
+                {
+                    continue;
+                }
+
+                results << (first_result ? "\n" : ",\n") << "    {\"library\": " << json_string(adapter->name())
+                        << ", \"workload\": " << json_string(workload) << ", \"input\": " << json_string(input.name);
+                first_result = false;
+
+                try
+                {
+                    xlnt_comparison::measurement best;
+                    best.seconds = -1.0;
+
+                    for (std::size_t i = 0; i < parsed.repetitions; ++i)
+                    {
+                        const auto measured = adapter->measure(w, input, output_path);
+
+                        if (best.seconds < 0.0 || measured.seconds < best.seconds)
+                        {
+                            best.cells = measured.cells;
+                            best.seconds = measured.seconds;
+                        }
+
+                        best.peak_bytes = std::max(best.peak_bytes, measured.peak_bytes);
+                        best.peak_of_process = best.peak_of_process || measured.peak_of_process;
+                    }
+
+                    const auto writes = w == xlnt_comparison::workload::save
+                        || w == xlnt_comparison::workload::streaming_write;
+                    const auto bytes = file_size(writes ? output_path : input.path);
+                    const auto seconds = std::max(best.seconds, 1e-9);
+
+                    results << ", \"cells\": " << best.cells << ", \"bytes\": " << bytes
+                            << ", \"seconds\": " << best.seconds << ", \"cells_per_second\": " << best.cells / seconds
+                            << ", \"bytes_per_second\": " << bytes / seconds << ", \"peak_bytes\": " << best.peak_bytes
+                            << ", \"peak_of_process\": " << (best.peak_of_process ? "true" : "false") << "}";
+
+                    std::cerr << adapter->name() << " " << workload << " " << input.name << ": " << best.seconds
+                              << " s, " << best.cells / seconds << " cells/s\n";
+                }
+                catch (const std::exception &e)
+                {
+                    results << ", \"error\": " << json_string(e.what()) << "}";
+                    std::cerr << adapter->name() << " " << workload << " " << input.name << " failed: " << e.what()
+                              << "\n";
+                }
+
+                std::remove(output_path.c_str());
+            }
+        }
+    }
+
+    std::remove(synthetic_path.c_str());
+
+    std::ostringstream report;
+    report << "{\n  \"synthetic_shape\": " << json_string(xlnt_benchmark::describe_shape(parsed.shape))
+           << ",\n  \"repetitions\": " << parsed.repetitions << ",\n  \"results\": [" << results.str() << "\n  ]\n}\n";
+
+    if (parsed.output.empty())
+    {
+        std::cout << report.str();
+    }
+    else
+    {
+        std::ofstream(parsed.output) << report.str();
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <chrono>
+
+#include <helpers/memory_usage.hpp>
+
+#include "library_adapter.hpp"
+
+namespace xlnt_comparison {
+
+const char *workload_name(workload w)
+{
+    switch (w)
+    {
+    case workload::load:
+        return "load";
+    case workload::save:
+        return "save";
+    case workload::streaming_read:
+        return "streaming_read";
+    case workload::streaming_write:
+        return "streaming_write";
+    }
+
+    return "unknown";
+}
+
+measurement library_adapter::measure(workload w, const workload_input &input, const std::string &output)
+{
+    measurement result;
+
+    const auto baseline = xlnt::benchmarks::current_resident_bytes();
+    result.peak_of_process = !xlnt::benchmarks::reset_peak_resident_bytes();
+
+    const auto start = std::chrono::steady_clock::now();
+    result.cells = run(w, input, output);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const auto peak = xlnt::benchmarks::peak_resident_bytes();
+    result.peak_bytes = peak > baseline ? peak - baseline : 0;
+
+    return result;
+}
+
+} // namespace xlnt_comparison
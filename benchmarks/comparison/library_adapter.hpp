@@ -0,0 +1,179 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xlnt_comparison {
+
+/// <summary>
+/// The operations every library is measured on.
+/// </summary>
+enum class workload
+{
+    /// <summary>
+    /// Reads a whole file into the library's in-memory document and visits every cell.
+    /// </summary>
+    load,
+
+    /// <summary>
+    /// Builds an in-memory document from a table and saves it.
+    /// </summary>
+    save,
+
+    /// <summary>
+    /// Reads every cell of a file with the library's forward-only reader.
+    /// </summary>
+    streaming_read,
+
+    /// <summary>
+    /// Writes a table row by row with the library's forward-only or constant memory writer.
+    /// </summary>
+    streaming_write
+};
+
+/// <summary>
+/// Returns the name of w as it appears in the results, e.g. "streaming_read".
+/// </summary>
+const char *workload_name(workload w);
+
+/// <summary>
+/// A cell of a table, in the types every library can write.
+/// </summary>
+struct table_cell
+{
+    enum class kind
+    {
+        number,
+        text,
+        boolean
+    };
+
+    /// <summary>
+    /// The row and the column of the cell, starting from 1.
+    /// </summary>
+    std::size_t row;
+    std::size_t column;
+
+    kind type;
+    double number;
+    std::string text;
+};
+
+/// <summary>
+/// The cells of a worksheet in row order, which the writing workloads write.
+/// </summary>
+struct table_sheet
+{
+    std::string title;
+    std::vector<table_cell> cells;
+};
+
+/// <summary>
+/// The file the reading workloads read and its contents as tables for the writing ones,
+/// so that every library reads and writes the same cells.
+/// </summary>
+struct workload_input
+{
+    /// <summary>
+    /// The name of the input in the results.
+    /// </summary>
+    std::string name;
+
+    std::string path;
+    std::vector<table_sheet> sheets;
+};
+
+/// <summary>
+/// What one run of a workload took.
+/// </summary>
+struct measurement
+{
+    std::size_t cells = 0;
+    double seconds = 0.0;
+
+    /// <summary>
+    /// The most memory resident during the run above what was resident before it, or 0
+    /// if the platform doesn't tell.
+    /// </summary>
+    std::size_t peak_bytes = 0;
+
+    /// <summary>
+    /// True if the peak couldn't be reset before the run and is the one of the whole process.
+    /// </summary>
+    bool peak_of_process = false;
+};
+
+/// <summary>
+/// Runs the workloads with one spreadsheet library.
+/// </summary>
+class library_adapter
+{
+public:
+    virtual ~library_adapter() = default;
+
+    /// <summary>
+    /// The name of the library in the results.
+    /// </summary>
+    virtual std::string name() const = 0;
+
+    /// <summary>
+    /// Returns false if the library has no way of doing w, e.g. reading for a writer only library.
+    /// </summary>
+    virtual bool supports(workload w) const = 0;
+
+    /// <summary>
+    /// Runs w on input, writing to output for the writing workloads, and returns the number
+    /// of cells read or written. Throws if the library fails.
+    /// </summary>
+    virtual std::size_t run(workload w, const workload_input &input, const std::string &output) = 0;
+
+    /// <summary>
+    /// Times run and measures the memory it takes in this process. Adapters running the
+    /// library in another process measure it there instead.
+    /// </summary>
+    virtual measurement measure(workload w, const workload_input &input, const std::string &output);
+};
+
+std::unique_ptr<library_adapter> make_xlnt_adapter();
+
+#ifdef XLNT_COMPARISON_XLSXWRITER
+std::unique_ptr<library_adapter> make_xlsxwriter_adapter();
+#endif
+
+#ifdef XLNT_COMPARISON_OPENXLSX
+std::unique_ptr<library_adapter> make_openxlsx_adapter();
+#endif
+
+#ifdef XLNT_COMPARISON_PYTHON
+/// <summary>
+/// Runs openpyxl_adapter.py with the given Python interpreter for every workload.
+/// </summary>
+std::unique_ptr<library_adapter> make_openpyxl_adapter(const std::string &python, const std::string &script);
+#endif
+
+} // namespace xlnt_comparison
@@ -0,0 +1,125 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "library_adapter.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace xlnt_comparison {
+
+namespace {
+
+// Returns the number following "name": in the flat JSON object json, or throws if there is none.
+double json_number(const std::string &json, const std::string &name)
+{
+    const auto key = "\"" + name + "\":";
+    const auto position = json.find(key);
+
+    if (position == std::string::npos)
+    {
+        throw std::runtime_error("openpyxl_adapter.py didn't report " + name + ": " + json);
+    }
+
+    return std::strtod(json.c_str() + position + key.size(), nullptr);
+}
+
+// openpyxl is measured by openpyxl_adapter.py in a Python process of its own, which
+// reads the input into a table itself before the writing workloads and reports the
+// measurement as a line of JSON
+class openpyxl_adapter : public library_adapter
+{
+public:
+    openpyxl_adapter(const std::string &python, const std::string &script)
+        : python_(python),
+          script_(script)
+    {
+    }
+
+    std::string name() const override
+    {
+        return "openpyxl";
+    }
+
+    bool supports(workload) const override
+    {
+        return true;
+    }
+
+    std::size_t run(workload w, const workload_input &input, const std::string &output) override
+    {
+        return measure(w, input, output).cells;
+    }
+
+    measurement measure(workload w, const workload_input &input, const std::string &output) override
+    {
+        const auto command = "\"" + python_ + "\" \"" + script_ + "\" " + workload_name(w) + " \"" + input.path
+            + "\" \"" + output + "\"";
+        auto process = popen(command.c_str(), "r");
+
+        if (process == nullptr)
+        {
+            throw std::runtime_error("couldn't run " + command);
+        }
+
+        std::string reported;
+        char buffer[256];
+
+        while (std::fgets(buffer, sizeof(buffer), process) != nullptr)
+        {
+            reported.append(buffer);
+        }
+
+        if (pclose(process) != 0)
+        {
+            throw std::runtime_error("openpyxl_adapter.py failed: " + reported);
+        }
+
+        measurement result;
+        result.cells = static_cast<std::size_t>(json_number(reported, "cells"));
+        result.seconds = json_number(reported, "seconds");
+        result.peak_bytes = static_cast<std::size_t>(json_number(reported, "peak_bytes"));
+        result.peak_of_process = reported.find("\"peak_of_process\": true") != std::string::npos;
+
+        return result;
+    }
+
+private:
+    std::string python_;
+    std::string script_;
+};
+
+} // namespace
+
+std::unique_ptr<library_adapter> make_openpyxl_adapter(const std::string &python, const std::string &script)
+{
+    return std::unique_ptr<library_adapter>(new openpyxl_adapter(python, script));
+}
+
+} // namespace xlnt_comparison
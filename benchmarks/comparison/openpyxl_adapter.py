@@ -0,0 +1,160 @@
+# Runs one workload of the comparison benchmark with openpyxl and prints its measurement
+# as a line of JSON, e.g.
+#   python openpyxl_adapter.py streaming_read input.xlsx output.xlsx
+# xlnt_comparison runs this for every workload, so it mirrors library_adapter.hpp: load
+# and streaming_read read input, save and streaming_write write the cells of input to
+# output. The input is read into a table before the writing workloads are timed.
+
+import json
+import sys
+import time
+
+try:
+    import resource
+except ImportError:
+    resource = None
+
+
+def status_bytes(field):
+    """Returns the value of a kB field of /proc/self/status in bytes, or 0."""
+    try:
+        with open('/proc/self/status') as status:
+            for line in status:
+                if line.startswith(field + ':'):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    return 0
+
+
+def reset_peak():
+    """Makes VmHWM start from the current usage where Linux allows it."""
+    try:
+        with open('/proc/self/clear_refs', 'w') as clear_refs:
+            clear_refs.write('5')
+        return True
+    except OSError:
+        return False
+
+
+def peak_bytes():
+    peak = status_bytes('VmHWM')
+    if peak == 0 and resource is not None:
+        # ru_maxrss is in kB on Linux and in bytes on macOS
+        peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        if sys.platform != 'darwin':
+            peak *= 1024
+    return peak
+
+
+def read_table(path):
+    """Returns the title of each worksheet of path with its rows, as the number of
+    each row and the columns and values of its non-empty cells."""
+    import openpyxl
+    wb = openpyxl.load_workbook(path, read_only=True)
+    sheets = []
+    for ws in wb.worksheets:
+        rows = []
+        for row_number, row in enumerate(ws.iter_rows(), ws.min_row or 1):
+            rows.append((row_number, [(cell.column, cell.value) for cell in row
+                                      if getattr(cell, 'value', None) is not None]))
+        sheets.append((ws.title, rows))
+    wb.close()
+    return sheets
+
+
+def load(path):
+    import openpyxl
+    wb = openpyxl.load_workbook(path)
+    cells = 0
+    for ws in wb.worksheets:
+        for row in ws.iter_rows():
+            cells += sum(1 for cell in row if cell.value is not None)
+    return cells
+
+
+def streaming_read(path):
+    import openpyxl
+    wb = openpyxl.load_workbook(path, read_only=True)
+    cells = 0
+    for ws in wb.worksheets:
+        for row in ws.iter_rows(values_only=True):
+            cells += sum(1 for value in row if value is not None)
+    wb.close()
+    return cells
+
+
+def save(sheets, output):
+    import openpyxl
+    wb = openpyxl.Workbook()
+    cells = 0
+    for index, (title, rows) in enumerate(sheets):
+        ws = wb.active if index == 0 else wb.create_sheet()
+        ws.title = title
+        for row_number, row in rows:
+            for column, value in row:
+                ws.cell(row=row_number, column=column, value=value)
+                cells += 1
+    wb.save(output)
+    return cells
+
+
+def streaming_write(sheets, output):
+    import openpyxl
+    wb = openpyxl.Workbook(write_only=True)
+    cells = 0
+    for title, rows in sheets:
+        ws = wb.create_sheet(title)
+        written = 0
+        for row_number, row in rows:
+            # rows are written in order, so missing ones are written empty
+            for _ in range(written + 1, row_number):
+                ws.append([])
+            written = row_number
+            values = [None] * (row[-1][0] if row else 0)
+            for column, value in row:
+                values[column - 1] = value
+            ws.append(values)
+            cells += len(row)
+    wb.save(output)
+    return cells
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.stderr.write('usage: openpyxl_adapter.py workload input.xlsx output.xlsx\n')
+        return 1
+
+    workload, path, output = sys.argv[1:]
+    sheets = read_table(path) if workload in ('save', 'streaming_write') else None
+
+    baseline = status_bytes('VmRSS')
+    peak_of_process = not reset_peak() or baseline == 0
+    start = time.perf_counter()
+
+    if workload == 'load':
+        cells = load(path)
+    elif workload == 'streaming_read':
+        cells = streaming_read(path)
+    elif workload == 'save':
+        cells = save(sheets, output)
+    elif workload == 'streaming_write':
+        cells = streaming_write(sheets, output)
+    else:
+        sys.stderr.write('unknown workload ' + workload + '\n')
+        return 1
+
+    seconds = time.perf_counter() - start
+    peak = peak_bytes()
+
+    print(json.dumps({
+        'cells': cells,
+        'seconds': seconds,
+        'peak_bytes': peak if peak_of_process else max(peak - baseline, 0),
+        'peak_of_process': peak_of_process,
+    }))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,139 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstdint>
+#include <cstdio>
+
+#include <OpenXLSX.hpp>
+
+#include "library_adapter.hpp"
+
+namespace xlnt_comparison {
+
+namespace {
+
+// OpenXLSX keeps the whole document in memory and has no forward-only reader or writer,
+// so it's only measured on load and save
+class openxlsx_adapter : public library_adapter
+{
+public:
+    std::string name() const override
+    {
+        return "OpenXLSX";
+    }
+
+    bool supports(workload w) const override
+    {
+        return w == workload::load || w == workload::save;
+    }
+
+    std::size_t run(workload w, const workload_input &input, const std::string &output) override
+    {
+        return w == workload::load ? load(input.path) : save(input.sheets, output);
+    }
+
+private:
+    static std::size_t load(const std::string &path)
+    {
+        OpenXLSX::XLDocument document;
+        document.open(path);
+        auto workbook = document.workbook();
+        std::size_t cells = 0;
+
+        for (const auto &title : workbook.worksheetNames())
+        {
+            auto worksheet = workbook.worksheet(title);
+
+            for (auto &row : worksheet.rows())
+            {
+                for (auto &cell : row.cells())
+                {
+                    cells += cell.value().type() == OpenXLSX::XLValueType::Empty ? 0 : 1;
+                }
+            }
+        }
+
+        document.close();
+
+        return cells;
+    }
+
+    static std::size_t save(const std::vector<table_sheet> &sheets, const std::string &output)
+    {
+        // create doesn't replace an existing file
+        std::remove(output.c_str());
+
+        OpenXLSX::XLDocument document;
+        document.create(output);
+        auto workbook = document.workbook();
+        std::size_t cells = 0;
+
+        for (std::size_t i = 0; i < sheets.size(); ++i)
+        {
+            if (i == 0)
+            {
+                workbook.worksheet(workbook.worksheetNames().front()).setName(sheets[i].title);
+            }
+            else
+            {
+                workbook.addWorksheet(sheets[i].title);
+            }
+
+            auto worksheet = workbook.worksheet(sheets[i].title);
+
+            for (const auto &value : sheets[i].cells)
+            {
+                auto cell = worksheet.cell(static_cast<std::uint32_t>(value.row), static_cast<std::uint16_t>(value.column));
+
+                switch (value.type)
+                {
+                case table_cell::kind::number:
+                    cell.value() = value.number;
+                    break;
+                case table_cell::kind::text:
+                    cell.value() = value.text;
+                    break;
+                case table_cell::kind::boolean:
+                    cell.value() = value.number != 0.0;
+                    break;
+                }
+
+                ++cells;
+            }
+        }
+
+        document.save();
+        document.close();
+
+        return cells;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<library_adapter> make_openxlsx_adapter()
+{
+    return std::unique_ptr<library_adapter>(new openxlsx_adapter());
+}
+
+} // namespace xlnt_comparison
@@ -0,0 +1,178 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <xlnt/xlnt.hpp>
+
+#include "library_adapter.hpp"
+
+namespace xlnt_comparison {
+
+namespace {
+
+template <typename Cell>
+void set_value(Cell cell, const table_cell &value)
+{
+    switch (value.type)
+    {
+    case table_cell::kind::number:
+        cell.value(value.number);
+        break;
+    case table_cell::kind::text:
+        cell.value(value.text);
+        break;
+    case table_cell::kind::boolean:
+        cell.value(value.number != 0.0);
+        break;
+    }
+}
+
+xlnt::cell_reference reference_of(const table_cell &value)
+{
+    return xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(value.column), static_cast<xlnt::row_t>(value.row));
+}
+
+class xlnt_adapter : public library_adapter
+{
+public:
+    std::string name() const override
+    {
+        return "xlnt";
+    }
+
+    bool supports(workload) const override
+    {
+        return true;
+    }
+
+    std::size_t run(workload w, const workload_input &input, const std::string &output) override
+    {
+        switch (w)
+        {
+        case workload::load:
+            return load(input.path);
+        case workload::save:
+            return save(input.sheets, output);
+        case workload::streaming_read:
+            return streaming_read(input.path);
+        case workload::streaming_write:
+            return streaming_write(input.sheets, output);
+        }
+
+        return 0;
+    }
+
+private:
+    static std::size_t load(const std::string &path)
+    {
+        xlnt::workbook wb;
+        wb.load(path);
+        std::size_t cells = 0;
+
+        for (const auto ws : wb)
+        {
+            for (const auto row : ws.rows(true))
+            {
+                for (const auto cell : row)
+                {
+                    cells += cell.data_type() == xlnt::cell_type::empty ? 0 : 1;
+                }
+            }
+        }
+
+        return cells;
+    }
+
+    static std::size_t save(const std::vector<table_sheet> &sheets, const std::string &output)
+    {
+        xlnt::workbook wb;
+        std::size_t cells = 0;
+
+        for (std::size_t i = 0; i < sheets.size(); ++i)
+        {
+            auto ws = i == 0 ? wb.active_sheet() : wb.create_sheet();
+            ws.title(sheets[i].title);
+
+            for (const auto &value : sheets[i].cells)
+            {
+                set_value(ws.cell(reference_of(value)), value);
+                ++cells;
+            }
+        }
+
+        wb.save(output);
+
+        return cells;
+    }
+
+    static std::size_t streaming_read(const std::string &path)
+    {
+        xlnt::streaming_workbook_reader reader;
+        reader.open(xlnt::path(path));
+        std::size_t cells = 0;
+
+        for (const auto &title : reader.sheet_titles())
+        {
+            reader.begin_worksheet(title);
+
+            while (reader.has_cell())
+            {
+                cells += reader.read_cell().data_type() == xlnt::cell_type::empty ? 0 : 1;
+            }
+
+            reader.end_worksheet();
+        }
+
+        return cells;
+    }
+
+    static std::size_t streaming_write(const std::vector<table_sheet> &sheets, const std::string &output)
+    {
+        xlnt::streaming_workbook_writer writer;
+        writer.open(output);
+        std::size_t cells = 0;
+
+        for (const auto &sheet : sheets)
+        {
+            writer.add_worksheet(sheet.title);
+
+            for (const auto &value : sheet.cells)
+            {
+                set_value(writer.add_cell(reference_of(value)), value);
+                ++cells;
+            }
+        }
+
+        writer.close();
+
+        return cells;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<library_adapter> make_xlnt_adapter()
+{
+    return std::unique_ptr<library_adapter>(new xlnt_adapter());
+}
+
+} // namespace xlnt_comparison
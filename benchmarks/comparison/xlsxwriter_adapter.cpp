@@ -0,0 +1,107 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <stdexcept>
+
+#include <xlsxwriter.h>
+
+#include "library_adapter.hpp"
+
+namespace xlnt_comparison {
+
+namespace {
+
+// libxlsxwriter only writes, so it's measured on save and, with constant_memory, which
+// writes each row once the next one is started, on streaming_write
+class xlsxwriter_adapter : public library_adapter
+{
+public:
+    std::string name() const override
+    {
+        return "libxlsxwriter";
+    }
+
+    bool supports(workload w) const override
+    {
+        return w == workload::save || w == workload::streaming_write;
+    }
+
+    std::size_t run(workload w, const workload_input &input, const std::string &output) override
+    {
+        lxw_workbook_options options = {};
+        options.constant_memory = w == workload::streaming_write ? LXW_TRUE : LXW_FALSE;
+        auto workbook = workbook_new_opt(output.c_str(), &options);
+
+        if (workbook == nullptr)
+        {
+            throw std::runtime_error("libxlsxwriter couldn't create " + output);
+        }
+
+        std::size_t cells = 0;
+
+        for (const auto &sheet : input.sheets)
+        {
+            auto worksheet = workbook_add_worksheet(workbook, sheet.title.c_str());
+
+            for (const auto &value : sheet.cells)
+            {
+                // libxlsxwriter counts rows and columns from 0
+                const auto row = static_cast<lxw_row_t>(value.row - 1);
+                const auto column = static_cast<lxw_col_t>(value.column - 1);
+
+                switch (value.type)
+                {
+                case table_cell::kind::number:
+                    worksheet_write_number(worksheet, row, column, value.number, nullptr);
+                    break;
+                case table_cell::kind::text:
+                    worksheet_write_string(worksheet, row, column, value.text.c_str(), nullptr);
+                    break;
+                case table_cell::kind::boolean:
+                    worksheet_write_boolean(worksheet, row, column, value.number != 0.0, nullptr);
+                    break;
+                }
+
+                ++cells;
+            }
+        }
+
+        const auto error = workbook_close(workbook);
+
+        if (error != LXW_NO_ERROR)
+        {
+            throw std::runtime_error(std::string("libxlsxwriter failed: ") + lxw_strerror(error));
+        }
+
+        return cells;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<library_adapter> make_xlsxwriter_adapter()
+{
+    return std::unique_ptr<library_adapter>(new xlsxwriter_adapter());
+}
+
+} // namespace xlnt_comparison
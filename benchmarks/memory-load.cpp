@@ -0,0 +1,150 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <iomanip>
+#include <iostream>
+
+#include <detail/implementations/cell_impl.hpp>
+#include <helpers/memory_usage.hpp>
+#include <helpers/path_helper.hpp>
+#include <xlnt/xlnt.hpp>
+
+// Reports how much memory reading a workbook takes, as a companion to the timings
+// of spreadsheet-load. Loading is run last because on platforms where the peak
+// can't be reset it is the larger one.
+
+namespace {
+
+double megabytes(std::size_t bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+double per_cell(std::size_t bytes, std::size_t cells)
+{
+    return cells == 0 ? 0.0 : static_cast<double>(bytes) / static_cast<double>(cells);
+}
+
+void print_memory(const char *what, std::size_t bytes, std::size_t cells)
+{
+    std::cout << "  " << std::left << std::setw(28) << what << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << megabytes(bytes) << " MiB" << std::setw(10) << per_cell(bytes, cells)
+              << " bytes/cell\n";
+}
+
+std::size_t usage_above(std::size_t usage, std::size_t baseline)
+{
+    return usage > baseline ? usage - baseline : 0;
+}
+
+void run_streaming_memory_test(const xlnt::path &file)
+{
+    std::cout << "streaming_workbook_reader " << file.string() << "\n";
+
+    const auto baseline = xlnt::benchmarks::current_resident_bytes();
+    const auto peak_reset = xlnt::benchmarks::reset_peak_resident_bytes();
+    std::size_t cells = 0;
+
+    {
+        xlnt::streaming_workbook_reader reader;
+        reader.open(file);
+
+        for (const auto &title : reader.sheet_titles())
+        {
+            reader.begin_worksheet(title);
+
+            while (reader.has_cell())
+            {
+                reader.read_cell();
+                ++cells;
+            }
+
+            reader.end_worksheet();
+        }
+    }
+
+    std::cout << "  cells " << cells << (peak_reset ? "" : " (peak of the whole process)") << "\n";
+    print_memory("peak above baseline", usage_above(xlnt::benchmarks::peak_resident_bytes(), baseline), cells);
+    std::cout << "\n";
+}
+
+void run_load_memory_test(const xlnt::path &file)
+{
+    std::cout << "workbook::load " << file.string() << "\n";
+
+    const auto baseline = xlnt::benchmarks::current_resident_bytes();
+    const auto peak_reset = xlnt::benchmarks::reset_peak_resident_bytes();
+
+    xlnt::workbook wb;
+    wb.load(file);
+
+    const auto peak = usage_above(xlnt::benchmarks::peak_resident_bytes(), baseline);
+    const auto retained = usage_above(xlnt::benchmarks::current_resident_bytes(), baseline);
+
+    // counting afterwards, since iterating the cells allocates too
+    std::size_t cells = 0;
+
+    for (const auto ws : wb)
+    {
+        for (const auto row : ws.rows(true))
+        {
+            cells += row.length();
+        }
+    }
+
+    // lower bounds of the memory the cells and the shared string table need
+    const auto cell_storage = cells * sizeof(xlnt::detail::cell_impl);
+    std::size_t shared_string_storage = 0;
+
+    for (const auto &text : wb.shared_strings())
+    {
+        shared_string_storage += sizeof(xlnt::rich_text);
+
+        for (const auto &run : text.runs())
+        {
+            shared_string_storage += sizeof(xlnt::rich_text_run) + run.first.size();
+        }
+    }
+
+    std::cout << "  cells " << cells << ", shared strings " << wb.shared_strings().size()
+              << (peak_reset ? "" : " (peak of the whole process)") << "\n";
+    print_memory("peak above baseline", peak, cells);
+    print_memory("retained after load", retained, cells);
+    print_memory("staging (peak - retained)", usage_above(peak, retained), cells);
+    print_memory("cell_impl storage (min)", cell_storage, cells);
+    print_memory("shared strings (min)", shared_string_storage, cells);
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const auto file = argc > 1 ? xlnt::path(argv[1]) : path_helper::benchmark_file("very_large.xlsx");
+
+    run_streaming_memory_test(file);
+    run_load_memory_test(file);
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Cell references are decoded for every cell read from sheetData and for every call to
+// worksheet::cell(const std::string &), so they are a measurable part of loading a workbook.
+// This compares the shared decoder in detail/utils/reference_decoding.hpp with the
+// character by character implementations it replaced.
+
+#include <benchmark/benchmark.h>
+#include <cctype>
+#include <random>
+#include <string>
+#include <vector>
+#include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/utils/reference_decoding.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+
+namespace {
+
+// setup a large quantity of random cell references with one to three column letters
+class RandomReferences : public benchmark::Fixture
+{
+    static constexpr size_t Number_of_Elements = 1 << 20;
+
+    std::vector<std::string> inputs;
+    std::vector<std::string> columns;
+
+    size_t index = 0;
+
+public:
+    void SetUp(::benchmark::State &)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<xlnt::column_t::index_t> column_dis(1, 16384);
+        std::uniform_int_distribution<xlnt::row_t> row_dis(1, 1048576);
+        inputs.reserve(Number_of_Elements);
+        columns.reserve(Number_of_Elements);
+        for (size_t i = 0; i < Number_of_Elements; ++i)
+        {
+            columns.push_back(xlnt::column_t::column_string_from_index(column_dis(gen)));
+            inputs.push_back(columns.back() + std::to_string(row_dis(gen)));
+        }
+    }
+
+    void TearDown(const ::benchmark::State &)
+    {
+        // gbench is keeping the fixtures alive somewhere, need to clear the data after use
+        inputs = std::vector<std::string>{};
+        columns = std::vector<std::string>{};
+    }
+
+    const std::string &get_rand()
+    {
+        return inputs[++index & (Number_of_Elements - 1)];
+    }
+
+    const std::string &get_rand_column()
+    {
+        return columns[++index & (Number_of_Elements - 1)];
+    }
+};
+
+// column_t::column_index_from_string before the shared decoder
+xlnt::column_t::index_t column_index_from_string_legacy(const std::string &column_string)
+{
+    xlnt::column_t::index_t column_index = 0;
+    int place = 1;
+
+    for (int i = static_cast<int>(column_string.length()) - 1; i >= 0; i--)
+    {
+        auto char_index = std::toupper(column_string[static_cast<std::size_t>(i)]) - 'A';
+        column_index += static_cast<xlnt::column_t::index_t>((char_index + 1) * place);
+        place *= 26;
+    }
+
+    return column_index;
+}
+
+// cell_reference(const std::string &) before the shared decoder, which split the
+// reference into a column and a row string first
+std::pair<xlnt::column_t::index_t, xlnt::row_t> cell_reference_legacy(const std::string &reference)
+{
+    std::string col_str;
+    std::string row_str;
+    size_t i = 0;
+
+    while (i < reference.length() && std::isalpha(static_cast<unsigned char>(reference[i])))
+    {
+        col_str += static_cast<char>(std::toupper(static_cast<unsigned char>(reference[i])));
+        ++i;
+    }
+
+    while (i < reference.length() && std::isdigit(static_cast<unsigned char>(reference[i])))
+    {
+        row_str += reference[i];
+        ++i;
+    }
+
+    return {column_index_from_string_legacy(col_str), static_cast<xlnt::row_t>(std::stoul(row_str))};
+}
+
+} // namespace
+
+BENCHMARK_F(RandomReferences, cell_reference_legacy)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(cell_reference_legacy(get_rand()));
+    }
+}
+
+BENCHMARK_F(RandomReferences, cell_reference_from_string)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(xlnt::cell_reference(get_rand()));
+    }
+}
+
+BENCHMARK_F(RandomReferences, decode_cell_reference)
+(benchmark::State &state)
+{
+    xlnt::column_t::index_t column = 0;
+    std::uint64_t row = 0;
+    bool absolute_column = false;
+    bool absolute_row = false;
+
+    while (state.KeepRunning())
+    {
+        const auto &reference = get_rand();
+        benchmark::DoNotOptimize(xlnt::detail::decode_cell_reference(reference.data(),
+            reference.data() + reference.size(), column, row, absolute_column, absolute_row));
+        benchmark::DoNotOptimize(column);
+        benchmark::DoNotOptimize(row);
+    }
+}
+
+BENCHMARK_F(RandomReferences, column_index_legacy)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(column_index_from_string_legacy(get_rand_column()));
+    }
+}
+
+BENCHMARK_F(RandomReferences, column_index_from_string)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(xlnt::column_t::column_index_from_string(get_rand_column()));
+    }
+}
+
+// the sheetData parsers, which already know the row from the enclosing row element
+BENCHMARK_F(RandomReferences, sheet_data_cell_reference)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(xlnt::detail::Cell_Reference(1, get_rand()));
+    }
+}
+
+BENCHMARK_F(RandomReferences, cell_reference_to_string)
+(benchmark::State &state)
+{
+    const xlnt::cell_reference reference(get_rand());
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(reference.to_string());
+    }
+}
+
+BENCHMARK_F(RandomReferences, cell_reference_to_chars)
+(benchmark::State &state)
+{
+    const xlnt::cell_reference reference(get_rand());
+    char characters[xlnt::cell_reference::max_string_length];
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(reference.to_chars(characters));
+        benchmark::ClobberMemory();
+    }
+}
@@ -0,0 +1,132 @@
+// Encrypted workbooks are decrypted with AES after a key derivation which hashes the
+// password tens of thousands of times, and saving encrypts the package the same way.
+// This measures the throughput of the block ciphers and hashes in detail/cryptography
+// and the cost of a typical key derivation.
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <detail/cryptography/aes.hpp>
+#include <detail/cryptography/hash.hpp>
+
+namespace {
+
+// a package-sized buffer of random bytes, a multiple of the AES block size
+std::vector<std::uint8_t> random_bytes(std::size_t count)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dis(0, 255);
+    std::vector<std::uint8_t> bytes(count);
+
+    for (auto &byte : bytes)
+    {
+        byte = static_cast<std::uint8_t>(dis(gen));
+    }
+
+    return bytes;
+}
+
+const std::size_t package_size = 4 * 1024 * 1024;
+
+void aes_ecb_decrypt(benchmark::State &state)
+{
+    const auto key = random_bytes(static_cast<std::size_t>(state.range(0)) / 8);
+    const auto input = random_bytes(package_size);
+    std::vector<std::uint8_t> output(input.size());
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::aes_ecb_decrypt(input.data(), input.size(), key, output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+
+void aes_ecb_encrypt(benchmark::State &state)
+{
+    const auto key = random_bytes(static_cast<std::size_t>(state.range(0)) / 8);
+    const auto input = random_bytes(package_size);
+    std::vector<std::uint8_t> output(input.size());
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::aes_ecb_encrypt(input.data(), input.size(), key, output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+
+void aes_cbc_decrypt(benchmark::State &state)
+{
+    const auto key = random_bytes(static_cast<std::size_t>(state.range(0)) / 8);
+    const auto iv = random_bytes(16);
+    const auto input = random_bytes(package_size);
+    std::vector<std::uint8_t> output(input.size());
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::aes_cbc_decrypt(input.data(), input.size(), key, iv.data(), output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+
+void aes_cbc_encrypt(benchmark::State &state)
+{
+    const auto key = random_bytes(static_cast<std::size_t>(state.range(0)) / 8);
+    const auto iv = random_bytes(16);
+    const auto input = random_bytes(package_size);
+    std::vector<std::uint8_t> output(input.size());
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::aes_cbc_encrypt(input.data(), input.size(), key, iv.data(), output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+
+void hash_throughput(benchmark::State &state, xlnt::detail::hash_algorithm algorithm)
+{
+    const auto input = random_bytes(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint8_t> output;
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::hash(algorithm, input, output);
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input.size()));
+}
+
+// the spin counts written by Excel, 50000 for sha1 in standard encryption and 100000
+// for sha512 in agile encryption
+void key_derivation(benchmark::State &state, xlnt::detail::hash_algorithm algorithm)
+{
+    const auto spin_count = static_cast<std::size_t>(state.range(0));
+    const auto initial = xlnt::detail::hash(algorithm, random_bytes(32));
+
+    while (state.KeepRunning())
+    {
+        auto digest = initial;
+        xlnt::detail::spin_hash(algorithm, digest, spin_count);
+        benchmark::DoNotOptimize(digest.data());
+    }
+}
+
+} // namespace
+
+BENCHMARK(aes_ecb_decrypt)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(aes_ecb_encrypt)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(aes_cbc_decrypt)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(aes_cbc_encrypt)->Arg(128)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(hash_throughput, sha1, xlnt::detail::hash_algorithm::sha1)->Arg(64)->Arg(package_size);
+BENCHMARK_CAPTURE(hash_throughput, sha512, xlnt::detail::hash_algorithm::sha512)->Arg(64)->Arg(package_size);
+BENCHMARK_CAPTURE(key_derivation, sha1, xlnt::detail::hash_algorithm::sha1)->Arg(50000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(key_derivation, sha512, xlnt::detail::hash_algorithm::sha512)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,105 @@
+// Dates are decoded from their serial numbers for every date cell that is read as a
+// date or rendered through a date number format. This compares the decomposition in
+// detail/time_helpers.hpp with the Julian day number arithmetic it replaced.
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include <detail/number_format/number_formatter.hpp>
+#include <detail/time_helpers.hpp>
+#include <xlnt/utils/date.hpp>
+#include <xlnt/utils/datetime.hpp>
+
+namespace {
+
+// setup a large quantity of random timestamps between 1900 and 2100
+class RandomSerials : public benchmark::Fixture
+{
+    static constexpr size_t Number_of_Elements = 1 << 20;
+
+    std::vector<double> inputs;
+
+    size_t index = 0;
+
+public:
+    void SetUp(::benchmark::State &)
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dis(61.0, 73050.0);
+        inputs.reserve(Number_of_Elements);
+        for (size_t i = 0; i < Number_of_Elements; ++i)
+        {
+            inputs.push_back(dis(gen));
+        }
+    }
+
+    void TearDown(const ::benchmark::State &)
+    {
+        // gbench is keeping the fixtures alive somewhere, need to clear the data after use
+        inputs = std::vector<double>{};
+    }
+
+    double get_rand()
+    {
+        return inputs[++index & (Number_of_Elements - 1)];
+    }
+};
+
+// date::from_number before the shared decomposition
+xlnt::date date_from_number_legacy(int days_since_base_year)
+{
+    xlnt::date result(0, 0, 0);
+
+    int l = days_since_base_year + 68569 + 2415019;
+    int n = int((4 * l) / 146097);
+    l = l - int((146097 * n + 3) / 4);
+    int i = int((4000 * (l + 1)) / 1461001);
+    l = l - int((1461 * i) / 4) + 31;
+    int j = int((80 * l) / 2447);
+    result.day = l - int((2447 * j) / 80);
+    l = int(j / 11);
+    result.month = j + 2 - (12 * l);
+    result.year = 100 * (n - 49) + i + l;
+
+    return result;
+}
+
+} // namespace
+
+BENCHMARK_F(RandomSerials, date_from_number_legacy)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(date_from_number_legacy(static_cast<int>(get_rand())));
+    }
+}
+
+BENCHMARK_F(RandomSerials, date_from_number)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(xlnt::date::from_number(static_cast<int>(get_rand()), xlnt::calendar::windows_1900));
+    }
+}
+
+BENCHMARK_F(RandomSerials, datetime_from_number)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(xlnt::datetime::from_number(get_rand(), xlnt::calendar::windows_1900));
+    }
+}
+
+BENCHMARK_F(RandomSerials, format_datetime)
+(benchmark::State &state)
+{
+    const xlnt::detail::number_formatter formatter("yyyy-mm-dd hh:mm:ss", xlnt::calendar::windows_1900);
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(formatter.format_number(get_rand()));
+    }
+}
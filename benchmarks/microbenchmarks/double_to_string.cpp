@@ -207,6 +207,19 @@ BENCHMARK_F(RandFloats, string_from_double_production)
     }
 }
 
+// the non-allocating path used for sheetData, compare with string_from_double_production
+BENCHMARK_F(RandFloats, chars_from_double_serialise_to)
+(benchmark::State &state)
+{
+    char buf[xlnt::detail::serialised_double_capacity];
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(
+            xlnt::detail::serialise_to(buf, get_rand()));
+        benchmark::ClobberMemory();
+    }
+}
+
 #if XLNT_HAS_FEATURE(TO_CHARS)
 #include <charconv>
 BENCHMARK_F(RandFloats, string_from_double_std_to_chars)
@@ -0,0 +1,138 @@
+// Number formats are compiled by detail::number_formatter the first time a cell with
+// that format is rendered and then applied to every such cell, for example by
+// cell::to_string. This measures compiling typical format codes and formatting
+// numbers with the compiled formatters.
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <detail/number_format/number_formatter.hpp>
+
+namespace {
+
+// a mix of builtin and custom format codes
+const std::vector<std::string> &format_codes()
+{
+    static const std::vector<std::string> codes = {
+        "General",
+        "0",
+        "0.00",
+        "#,##0.00",
+        "0%",
+        "0.00E+00",
+        "# ?/?",
+        "mm-dd-yy",
+        "d-mmm-yy",
+        "h:mm:ss AM/PM",
+        "[$-409]dddd mmmm dd yyyy",
+        "#,##0.00_);[Red](#,##0.00)",
+        "[Blue][>=100]#,##0;[Red][<=-100]#,##0;0.00",
+        "_(\"$\"* #,##0.00_);_(\"$\"* \\(#,##0.00\\);_(\"$\"* \"-\"??_);_(@_)",
+    };
+
+    return codes;
+}
+
+// setup a large quantity of random numbers of the magnitudes found in spreadsheets
+class RandomNumbers : public benchmark::Fixture
+{
+    static constexpr size_t Number_of_Elements = 1 << 16;
+
+    std::vector<double> inputs;
+
+    size_t index = 0;
+
+public:
+    void SetUp(::benchmark::State &)
+    {
+        // the fixture is kept between runs and its data is small, so it is made once
+        if (!inputs.empty())
+        {
+            return;
+        }
+
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dis(-100000.0, 100000.0);
+        inputs.reserve(Number_of_Elements);
+        for (size_t i = 0; i < Number_of_Elements; ++i)
+        {
+            inputs.push_back(dis(gen));
+        }
+    }
+
+    const std::vector<double> &all() const
+    {
+        return inputs;
+    }
+
+    double get_rand()
+    {
+        return inputs[++index & (Number_of_Elements - 1)];
+    }
+};
+
+void number_format_parse(benchmark::State &state)
+{
+    const auto &code = format_codes()[static_cast<std::size_t>(state.range(0))];
+    state.SetLabel(code);
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::number_formatter formatter(code, xlnt::calendar::windows_1900);
+        benchmark::DoNotOptimize(&formatter);
+    }
+}
+
+} // namespace
+
+BENCHMARK(number_format_parse)->DenseRange(0, 13);
+
+BENCHMARK_DEFINE_F(RandomNumbers, format_number)
+(benchmark::State &state)
+{
+    const auto &code = format_codes()[static_cast<std::size_t>(state.range(0))];
+    const xlnt::detail::number_formatter formatter(code, xlnt::calendar::windows_1900);
+    state.SetLabel(code);
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(formatter.format_number(get_rand()));
+    }
+}
+
+BENCHMARK_REGISTER_F(RandomNumbers, format_number)->DenseRange(0, 13);
+
+// the batched interface, which doesn't allocate a string per number
+BENCHMARK_DEFINE_F(RandomNumbers, format_numbers)
+(benchmark::State &state)
+{
+    const auto &code = format_codes()[static_cast<std::size_t>(state.range(0))];
+    const xlnt::detail::number_formatter formatter(code, xlnt::calendar::windows_1900);
+    const auto &numbers = all();
+    std::string output;
+    std::vector<std::size_t> offsets;
+    state.SetLabel(code);
+
+    while (state.KeepRunning())
+    {
+        formatter.format_numbers(numbers.data(), numbers.size(), output, offsets);
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numbers.size()));
+}
+
+BENCHMARK_REGISTER_F(RandomNumbers, format_numbers)->DenseRange(0, 13);
+
+BENCHMARK_F(RandomNumbers, format_text)
+(benchmark::State &state)
+{
+    const xlnt::detail::number_formatter formatter("\"Total: \"@", xlnt::calendar::windows_1900);
+    const std::string text = "quarterly revenue";
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(formatter.format_text(text));
+    }
+}
@@ -0,0 +1,167 @@
+// Part paths are built, resolved and looked up in the manifest for every part read or
+// written: the consumer canonicalizes each relationship chain and asks for content
+// types, and the producer resolves relationship targets relative to their source part.
+// This measures the path operations and manifest lookups behind these.
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include <xlnt/packaging/manifest.hpp>
+#include <xlnt/packaging/relationship.hpp>
+#include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+namespace {
+
+// the manifest of a workbook with a typical number of sheets
+class WorkbookManifest : public benchmark::Fixture
+{
+    static constexpr size_t Number_of_Sheets = 64;
+
+    xlnt::workbook wb;
+    std::vector<std::vector<xlnt::relationship>> chains;
+    std::vector<xlnt::path> parts;
+
+    size_t index = 0;
+
+public:
+    void SetUp(::benchmark::State &)
+    {
+        // the fixture is kept between runs and its data is small, so it is made once
+        if (!chains.empty())
+        {
+            return;
+        }
+
+        while (wb.sheet_count() < Number_of_Sheets)
+        {
+            wb.create_sheet();
+        }
+
+        const auto &manifest = wb.manifest();
+        const auto workbook_rel = manifest.relationship(xlnt::path("/"), xlnt::relationship_type::office_document);
+        const auto workbook_path = manifest.canonicalize({workbook_rel});
+
+        for (const auto &rel : manifest.relationships(workbook_path))
+        {
+            chains.push_back({workbook_rel, rel});
+            parts.push_back(manifest.canonicalize(chains.back()));
+        }
+    }
+
+    const xlnt::manifest &manifest() const
+    {
+        return wb.manifest();
+    }
+
+    const std::vector<xlnt::relationship> &get_chain()
+    {
+        return chains[++index % chains.size()];
+    }
+
+    const xlnt::path &get_part()
+    {
+        return parts[++index % parts.size()];
+    }
+};
+
+} // namespace
+
+BENCHMARK_F(WorkbookManifest, manifest_canonicalize)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(manifest().canonicalize(get_chain()));
+    }
+}
+
+BENCHMARK_F(WorkbookManifest, manifest_content_type)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(manifest().content_type(get_part()));
+    }
+}
+
+BENCHMARK_F(WorkbookManifest, manifest_relationships)
+(benchmark::State &state)
+{
+    const auto workbook_path = xlnt::path("/xl/workbook.xml");
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(manifest().relationships(workbook_path, xlnt::relationship_type::worksheet));
+    }
+}
+
+BENCHMARK_F(WorkbookManifest, manifest_has_relationship)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(manifest().has_relationship(get_part(), xlnt::relationship_type::comments));
+    }
+}
+
+static void path_append(benchmark::State &state)
+{
+    const xlnt::path directory("/xl/worksheets");
+    const std::string filename = "sheet1.xml";
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(directory.append(filename));
+    }
+}
+BENCHMARK(path_append);
+
+static void path_split(benchmark::State &state)
+{
+    const xlnt::path part("/xl/worksheets/_rels/sheet1.xml.rels");
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(part.split());
+    }
+}
+BENCHMARK(path_split);
+
+static void path_parent_filename_extension(benchmark::State &state)
+{
+    const xlnt::path part("/xl/worksheets/sheet1.xml");
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(part.parent());
+        benchmark::DoNotOptimize(part.filename());
+        benchmark::DoNotOptimize(part.extension());
+    }
+}
+BENCHMARK(path_parent_filename_extension);
+
+static void path_resolve(benchmark::State &state)
+{
+    const xlnt::path target("../drawings/drawing1.xml");
+    const xlnt::path base("/xl/worksheets");
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(target.resolve(base));
+    }
+}
+BENCHMARK(path_resolve);
+
+static void path_relative_to(benchmark::State &state)
+{
+    const xlnt::path part("/xl/worksheets/sheet1.xml");
+    const xlnt::path base("/xl");
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(part.relative_to(base));
+    }
+}
+BENCHMARK(path_relative_to);
@@ -0,0 +1,142 @@
+// Every string cell written or read with the shared string table is looked up by its
+// rich_text in workbook_impl::shared_strings_ids_, so rich_text_hash and the equality
+// behind it are paid once per string cell. This measures plain text, which is stored
+// compactly, and formatted text with several runs.
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <xlnt/cell/rich_text.hpp>
+#include <xlnt/styles/font.hpp>
+
+namespace {
+
+// setup a large quantity of random strings of typical cell lengths
+class RandomRichText : public benchmark::Fixture
+{
+    static constexpr size_t Number_of_Elements = 1 << 16;
+
+    std::vector<xlnt::rich_text> plain;
+    std::vector<xlnt::rich_text> formatted;
+
+    size_t index = 0;
+
+public:
+    void SetUp(::benchmark::State &)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> length_dis(4, 40);
+        std::uniform_int_distribution<int> char_dis('a', 'z');
+        plain.reserve(Number_of_Elements);
+        formatted.reserve(Number_of_Elements);
+
+        auto random_string = [&]() {
+            std::string result(static_cast<std::size_t>(length_dis(gen)), ' ');
+            for (auto &c : result)
+            {
+                c = static_cast<char>(char_dis(gen));
+            }
+            return result;
+        };
+
+        xlnt::font bold;
+        bold.bold(true);
+
+        for (size_t i = 0; i < Number_of_Elements; ++i)
+        {
+            plain.emplace_back(random_string());
+
+            xlnt::rich_text text;
+            text.add_run(xlnt::rich_text_run{random_string(), xlnt::optional<xlnt::font>(bold), false});
+            text.add_run(xlnt::rich_text_run{random_string(), xlnt::optional<xlnt::font>(), false});
+            text.add_run(xlnt::rich_text_run{random_string(), xlnt::optional<xlnt::font>(bold), false});
+            formatted.push_back(std::move(text));
+        }
+    }
+
+    void TearDown(const ::benchmark::State &)
+    {
+        // gbench is keeping the fixtures alive somewhere, need to clear the data after use
+        plain = std::vector<xlnt::rich_text>{};
+        formatted = std::vector<xlnt::rich_text>{};
+    }
+
+    const std::vector<xlnt::rich_text> &all_plain() const
+    {
+        return plain;
+    }
+
+    const std::vector<xlnt::rich_text> &all_formatted() const
+    {
+        return formatted;
+    }
+
+    const xlnt::rich_text &get_rand_plain()
+    {
+        return plain[++index & (Number_of_Elements - 1)];
+    }
+
+    const xlnt::rich_text &get_rand_formatted()
+    {
+        return formatted[++index & (Number_of_Elements - 1)];
+    }
+};
+
+} // namespace
+
+BENCHMARK_F(RandomRichText, rich_text_hash_plain)
+(benchmark::State &state)
+{
+    const xlnt::rich_text_hash hasher;
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(hasher(get_rand_plain()));
+    }
+}
+
+BENCHMARK_F(RandomRichText, rich_text_hash_formatted)
+(benchmark::State &state)
+{
+    const xlnt::rich_text_hash hasher;
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(hasher(get_rand_formatted()));
+    }
+}
+
+// the lookup done for each string cell when the shared string table is built
+BENCHMARK_F(RandomRichText, shared_string_lookup_plain)
+(benchmark::State &state)
+{
+    std::unordered_map<xlnt::rich_text, std::size_t, xlnt::rich_text_hash> ids;
+
+    for (const auto &text : all_plain())
+    {
+        ids.emplace(text, ids.size());
+    }
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(ids.find(get_rand_plain()));
+    }
+}
+
+BENCHMARK_F(RandomRichText, shared_string_lookup_formatted)
+(benchmark::State &state)
+{
+    std::unordered_map<xlnt::rich_text, std::size_t, xlnt::rich_text_hash> ids;
+
+    for (const auto &text : all_formatted())
+    {
+        ids.emplace(text, ids.size());
+    }
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(ids.find(get_rand_formatted()));
+    }
+}
@@ -211,6 +211,29 @@ BENCHMARK_F(RandFloatStrs, double_from_string_production)
     }
 }
 
+// the values of a batch of sheetData cells parsed in one pass from the batch's text,
+// reported per value so that it compares with double_from_string_production
+BENCHMARK_F(RandFloatStrs, double_from_string_production_batch)
+(benchmark::State &state)
+{
+    constexpr size_t Batch_Size = 1024;
+    xlnt::detail::Sheet_Data batch;
+    for (size_t i = 0; i < Batch_Size; ++i)
+    {
+        batch.parsed_cells.emplace_back();
+        batch.append(batch.parsed_cells.back().value, get_rand());
+    }
+    std::vector<double> numbers;
+
+    while (state.KeepRunning())
+    {
+        xlnt::detail::deserialise_numbers(batch, numbers);
+        benchmark::DoNotOptimize(numbers.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * Batch_Size));
+}
+
 #if XLNT_HAS_FEATURE(TO_CHARS)
 #include <charconv>
 BENCHMARK_F(RandFloatStrs, double_from_string_std_from_chars)
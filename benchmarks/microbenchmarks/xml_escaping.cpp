@@ -0,0 +1,145 @@
+// All text in sheetData is escaped by detail::sheet_data_writer as the worksheet is
+// written, so escaping is paid for every byte of every string and formula. This measures
+// text without anything to escape, which is the common case, and text full of markup.
+
+#include <benchmark/benchmark.h>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <detail/serialization/sheet_data_writer.hpp>
+
+namespace {
+
+// throws away everything it is handed so only the writer itself is measured
+class null_streambuf : public std::streambuf
+{
+protected:
+    std::streamsize xsputn(const char *, std::streamsize count) override
+    {
+        return count;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        return traits_type::not_eof(c);
+    }
+};
+
+// setup a large quantity of random strings, half of them with characters to escape
+class RandomText : public benchmark::Fixture
+{
+    static constexpr size_t Number_of_Elements = 1 << 16;
+
+    std::vector<std::string> clean;
+    std::vector<std::string> markup;
+
+    size_t index = 0;
+
+public:
+    void SetUp(::benchmark::State &)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> length_dis(4, 40);
+        std::uniform_int_distribution<int> char_dis('a', 'z');
+        std::uniform_int_distribution<int> markup_dis(0, 7);
+        const char special[] = {'<', '>', '&', '"', '\'', '\n', '\t', '\r'};
+        clean.reserve(Number_of_Elements);
+        markup.reserve(Number_of_Elements);
+
+        for (size_t i = 0; i < Number_of_Elements; ++i)
+        {
+            std::string text(static_cast<std::size_t>(length_dis(gen)), ' ');
+            for (auto &c : text)
+            {
+                c = static_cast<char>(char_dis(gen));
+            }
+            clean.push_back(text);
+
+            for (std::size_t j = 0; j < text.size(); j += 4)
+            {
+                text[j] = special[markup_dis(gen)];
+            }
+            markup.push_back(text);
+        }
+    }
+
+    void TearDown(const ::benchmark::State &)
+    {
+        // gbench is keeping the fixtures alive somewhere, need to clear the data after use
+        clean = std::vector<std::string>{};
+        markup = std::vector<std::string>{};
+    }
+
+    const std::string &get_rand_clean()
+    {
+        return clean[++index & (Number_of_Elements - 1)];
+    }
+
+    const std::string &get_rand_markup()
+    {
+        return markup[++index & (Number_of_Elements - 1)];
+    }
+};
+
+} // namespace
+
+BENCHMARK_F(RandomText, escape_characters_clean)
+(benchmark::State &state)
+{
+    null_streambuf sink;
+    std::ostream stream(&sink);
+    xlnt::detail::sheet_data_writer writer(stream);
+    std::int64_t bytes = 0;
+
+    while (state.KeepRunning())
+    {
+        const auto &text = get_rand_clean();
+        writer.element("t", text);
+        bytes += static_cast<std::int64_t>(text.size());
+    }
+
+    writer.flush();
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK_F(RandomText, escape_characters_markup)
+(benchmark::State &state)
+{
+    null_streambuf sink;
+    std::ostream stream(&sink);
+    xlnt::detail::sheet_data_writer writer(stream);
+    std::int64_t bytes = 0;
+
+    while (state.KeepRunning())
+    {
+        const auto &text = get_rand_markup();
+        writer.element("t", text);
+        bytes += static_cast<std::int64_t>(text.size());
+    }
+
+    writer.flush();
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK_F(RandomText, escape_attribute_markup)
+(benchmark::State &state)
+{
+    null_streambuf sink;
+    std::ostream stream(&sink);
+    xlnt::detail::sheet_data_writer writer(stream);
+    std::int64_t bytes = 0;
+
+    while (state.KeepRunning())
+    {
+        const auto &text = get_rand_markup();
+        writer.start_element("c");
+        writer.attribute("r", text);
+        writer.end_empty_element();
+        bytes += static_cast<std::int64_t>(text.size());
+    }
+
+    writer.flush();
+    state.SetBytesProcessed(bytes);
+}
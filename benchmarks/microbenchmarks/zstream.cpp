@@ -0,0 +1,100 @@
+// Every part of a workbook goes through the zip streambufs in detail/zstream.cpp. Parts
+// larger than izstream::whole_inflate_limit are inflated through a buffer of the size
+// given to izstream, which is what load_options::decompression_buffer_size sets, so this measures
+// reading such a part at different buffer sizes and writing it at each compression level.
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <detail/serialization/zstream.hpp>
+
+namespace {
+
+const xlnt::path part_path("xl/worksheets/sheet1.xml");
+
+// sheetData of typical numeric and shared string cells, larger than the whole inflate limit
+const std::string &part_contents()
+{
+    static const std::string contents = []() {
+        std::string result = "<sheetData>";
+        auto row = std::uint64_t(1);
+
+        while (result.size() < 4 * xlnt::detail::izstream::whole_inflate_limit)
+        {
+            const auto r = std::to_string(row);
+            result.append("<row r=\"" + r + "\">");
+            result.append("<c r=\"A" + r + "\"><v>" + std::to_string(row * 7919 % 100003) + "</v></c>");
+            result.append("<c r=\"B" + r + "\" t=\"s\"><v>" + std::to_string(row % 617) + "</v></c>");
+            result.append("<c r=\"C" + r + "\"><v>" + std::to_string(static_cast<double>(row) / 7.0) + "</v></c>");
+            result.append("</row>");
+            ++row;
+        }
+
+        result.append("</sheetData>");
+        return result;
+    }();
+
+    return contents;
+}
+
+std::string write_archive(xlnt::compression_level level)
+{
+    std::ostringstream archive_stream;
+
+    {
+        xlnt::detail::ozstream archive(archive_stream, level);
+        auto buffer = archive.open(part_path);
+        std::ostream part(buffer.get());
+        part.write(part_contents().data(), static_cast<std::streamsize>(part_contents().size()));
+    }
+
+    return archive_stream.str();
+}
+
+void zip_read_part(benchmark::State &state)
+{
+    const auto archive_bytes = write_archive(xlnt::compression_level::standard);
+    const auto buffer_size = static_cast<std::size_t>(state.range(0));
+    std::vector<char> chunk(64 * 1024);
+
+    while (state.KeepRunning())
+    {
+        // a stringstream rather than a memory_istreambuf, so the streaming path is taken
+        std::istringstream archive_stream(archive_bytes);
+        xlnt::detail::izstream archive(archive_stream, buffer_size);
+        auto buffer = archive.open(part_path);
+        std::istream part(buffer.get());
+
+        while (part.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || part.gcount() > 0)
+        {
+            benchmark::DoNotOptimize(chunk.data());
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * part_contents().size()));
+}
+
+void zip_write_part(benchmark::State &state)
+{
+    const auto level = static_cast<xlnt::compression_level>(state.range(0));
+    const char *labels[] = {"none", "fastest", "standard", "best"};
+    state.SetLabel(labels[state.range(0)]);
+    part_contents();
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(write_archive(level));
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * part_contents().size()));
+}
+
+} // namespace
+
+BENCHMARK(zip_read_part)->RangeMultiplier(4)->Range(4 * 1024, 1024 * 1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(zip_write_part)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
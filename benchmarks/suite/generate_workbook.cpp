@@ -0,0 +1,79 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <iostream>
+#include <string>
+
+#include <xlnt/xlnt.hpp>
+
+#include "workbook_generator.hpp"
+
+// Writes a synthetic workbook of the shape given on the command line, e.g.
+// xlnt_generate_workbook --rows=100000 --strings=50000 --styles=100 out.xlsx
+
+int main(int argc, char *argv[])
+{
+    xlnt_benchmark::workbook_shape shape;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+
+        if (xlnt_benchmark::parse_shape_argument(argument, shape))
+        {
+            continue;
+        }
+
+        if (argument.compare(0, 2, "--") == 0 || !output.empty())
+        {
+            std::cerr << "unknown argument " << argument << "\n"
+                      << "usage: " << argv[0] << " [--rows=N] [--columns=N] [--sheets=N] [--strings=N]"
+                      << " [--string_ratio=R] [--styles=N] [--formula_density=R] [--sparsity=R] [--seed=N] output.xlsx\n";
+            return 1;
+        }
+
+        output = argument;
+    }
+
+    if (output.empty())
+    {
+        std::cerr << "missing output file\n";
+        return 1;
+    }
+
+    try
+    {
+        xlnt_benchmark::generate_workbook(shape).save(output);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << output << ": " << xlnt_benchmark::describe_shape(shape) << "\n";
+
+    return 0;
+}
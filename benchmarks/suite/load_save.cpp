@@ -0,0 +1,68 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <xlnt/xlnt.hpp>
+
+#include "suite_helpers.hpp"
+
+namespace {
+
+void load(benchmark::State &state, const char *name)
+{
+    const auto &data = xlnt_benchmark::data_file(name);
+    const auto cells = xlnt_benchmark::cell_count(data);
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        xlnt::workbook wb;
+        wb.load(data);
+    }
+
+    xlnt_benchmark::report(state, data.size(), cells);
+}
+
+void save(benchmark::State &state, const char *name)
+{
+    xlnt::workbook wb;
+    wb.load(xlnt_benchmark::data_file(name));
+    const auto cells = xlnt_benchmark::cell_count(wb);
+    std::vector<std::uint8_t> saved;
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        saved.clear();
+        wb.save(saved);
+    }
+
+    xlnt_benchmark::report(state, saved.size(), cells);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(load, large, "large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(load, very_large, "very_large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(save, large, "large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(save, very_large, "very_large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
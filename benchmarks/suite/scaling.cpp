@@ -0,0 +1,121 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <map>
+
+#include <xlnt/xlnt.hpp>
+
+#include "suite_helpers.hpp"
+#include "workbook_generator.hpp"
+
+// Sweeps of the shape of synthetic workbooks, varying one parameter of a base shape
+// at a time, so that the results show how loading and saving scale with it. Write
+// them as a table with e.g. --benchmark_filter=scaling --benchmark_out=scaling.csv
+// --benchmark_out_format=csv.
+
+namespace {
+
+xlnt_benchmark::workbook_shape shape_of(const benchmark::State &state)
+{
+    xlnt_benchmark::workbook_shape shape;
+    shape.rows = static_cast<std::size_t>(state.range(0));
+    shape.columns = static_cast<std::size_t>(state.range(1));
+    shape.sheets = static_cast<std::size_t>(state.range(2));
+    shape.strings = static_cast<std::size_t>(state.range(3));
+    shape.styles = static_cast<std::size_t>(state.range(4));
+    shape.formula_density = static_cast<double>(state.range(5)) / 100.0;
+    shape.sparsity = static_cast<double>(state.range(6)) / 100.0;
+
+    return shape;
+}
+
+const std::vector<std::uint8_t> &generated_data(const xlnt_benchmark::workbook_shape &shape)
+{
+    static std::map<std::string, std::vector<std::uint8_t>> generated;
+    auto &data = generated[xlnt_benchmark::describe_shape(shape)];
+
+    if (data.empty())
+    {
+        xlnt_benchmark::generate_workbook(shape).save(data);
+    }
+
+    return data;
+}
+
+void scaling_sweeps(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->ArgNames({"rows", "columns", "sheets", "strings", "styles", "formula_pct", "sparse_pct"});
+
+    // rows, columns, sheets, strings, styles, formula percentage, sparsity percentage
+    for (auto rows : {1000, 10000, 100000})
+        benchmark->Args({rows, 10, 1, 100, 0, 0, 0});
+    for (auto strings : {0, 1000, 10000, 100000})
+        benchmark->Args({10000, 10, 1, strings, 0, 0, 0});
+    for (auto sheets : {4, 16})
+        benchmark->Args({10000, 10, sheets, 100, 0, 0, 0});
+    for (auto styles : {10, 100, 1000})
+        benchmark->Args({10000, 10, 1, 100, styles, 0, 0});
+    for (auto formulas : {25, 100})
+        benchmark->Args({10000, 10, 1, 100, 0, formulas, 0});
+    for (auto sparsity : {50, 90})
+        benchmark->Args({10000, 10, 1, 100, 0, 0, sparsity});
+
+    benchmark->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+void scaling_load(benchmark::State &state)
+{
+    const auto &data = generated_data(shape_of(state));
+    const auto cells = xlnt_benchmark::cell_count(data);
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        xlnt::workbook wb;
+        wb.load(data);
+    }
+
+    xlnt_benchmark::report(state, data.size(), cells);
+}
+
+void scaling_save(benchmark::State &state)
+{
+    const auto wb = xlnt_benchmark::generate_workbook(shape_of(state));
+    const auto cells = xlnt_benchmark::cell_count(wb);
+    std::vector<std::uint8_t> saved;
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        saved.clear();
+        wb.save(saved);
+    }
+
+    xlnt_benchmark::report(state, saved.size(), cells);
+}
+
+} // namespace
+
+BENCHMARK(scaling_load)->Apply(scaling_sweeps);
+BENCHMARK(scaling_save)->Apply(scaling_sweeps);
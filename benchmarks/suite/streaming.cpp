@@ -0,0 +1,151 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <xlnt/xlnt.hpp>
+
+#include "suite_helpers.hpp"
+
+namespace {
+
+void streaming_read_cells(benchmark::State &state, const char *name)
+{
+    const auto &data = xlnt_benchmark::data_file(name);
+    std::size_t cells = 0;
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        xlnt::streaming_workbook_reader reader;
+        reader.open(data);
+        cells = 0;
+
+        for (const auto &title : reader.sheet_titles())
+        {
+            reader.begin_worksheet(title);
+
+            while (reader.has_cell())
+            {
+                benchmark::DoNotOptimize(reader.read_cell());
+                ++cells;
+            }
+
+            reader.end_worksheet();
+        }
+    }
+
+    xlnt_benchmark::report(state, data.size(), cells);
+}
+
+void streaming_read_columns(benchmark::State &state, const char *name)
+{
+    const auto &data = xlnt_benchmark::data_file(name);
+    std::size_t cells = 0;
+    xlnt::column_batch batch;
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        xlnt::streaming_workbook_reader reader;
+        reader.open(data);
+        cells = 0;
+
+        for (const auto &title : reader.sheet_titles())
+        {
+            reader.begin_worksheet(title);
+
+            // cells missing from a row are padded and counted too
+            while (reader.read_columns(batch, 1024) > 0)
+            {
+                cells += batch.size() * batch.columns.size();
+            }
+
+            reader.end_worksheet();
+        }
+    }
+
+    xlnt_benchmark::report(state, data.size(), cells);
+}
+
+// writes the cells of every worksheet of the named file one by one
+void streaming_write(benchmark::State &state, const char *name)
+{
+    xlnt::workbook source;
+    source.load(xlnt_benchmark::data_file(name));
+    std::size_t cells = 0;
+    std::vector<std::uint8_t> saved;
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        saved.clear();
+        cells = 0;
+
+        xlnt::streaming_workbook_writer writer;
+        writer.open(saved);
+
+        for (const auto ws : source)
+        {
+            writer.add_worksheet(ws.title());
+
+            for (const auto row : ws.rows(true))
+            {
+                for (const auto cell : row)
+                {
+                    auto written = writer.add_cell(cell.reference());
+
+                    switch (cell.data_type())
+                    {
+                    case xlnt::cell_type::empty:
+                        break;
+                    case xlnt::cell_type::boolean:
+                        written.value(cell.value<bool>());
+                        break;
+                    case xlnt::cell_type::number:
+                    case xlnt::cell_type::date:
+                        written.value(cell.value<double>());
+                        break;
+                    default:
+                        written.value(cell.value<std::string>());
+                        break;
+                    }
+
+                    ++cells;
+                }
+            }
+        }
+
+        writer.close();
+    }
+
+    xlnt_benchmark::report(state, saved.size(), cells);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(streaming_read_cells, large, "large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(streaming_read_cells, very_large, "very_large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(streaming_read_columns, large, "large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(streaming_read_columns, very_large, "very_large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(streaming_write, large, "large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(streaming_write, very_large, "very_large.xlsx")->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,72 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <xlnt/xlnt.hpp>
+
+#include "suite_helpers.hpp"
+
+namespace {
+
+// styles a block of state.range(0) rows and 10 columns through ranges and cells
+void styling(benchmark::State &state)
+{
+    const auto rows = static_cast<xlnt::row_t>(state.range(0));
+    const auto cells = static_cast<std::size_t>(rows) * 10;
+    std::vector<std::uint8_t> saved;
+    xlnt_benchmark::begin_measurement();
+
+    for (auto _ : state)
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= rows; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 10; ++column)
+            {
+                ws.cell(column, row).value(static_cast<double>(row * column));
+            }
+        }
+
+        auto block = ws.range(xlnt::range_reference(1, 1, 10, rows));
+        block.font(xlnt::font().bold(true).size(12));
+        block.fill(xlnt::fill::solid(xlnt::rgb_color(255, 255, 0)));
+        block.number_format(xlnt::number_format::number_00());
+
+        // every other row differs, so that the cells end up with several formats
+        for (xlnt::row_t row = 2; row <= rows; row += 2)
+        {
+            ws.cell(1, row).alignment(xlnt::alignment().horizontal(xlnt::horizontal_alignment::center));
+        }
+
+        saved.clear();
+        wb.save(saved);
+    }
+
+    xlnt_benchmark::report(state, saved.size(), cells);
+}
+
+} // namespace
+
+BENCHMARK(styling)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,163 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include <helpers/memory_usage.hpp>
+#include <helpers/path_helper.hpp>
+#include <xlnt/xlnt.hpp>
+
+#include "suite_helpers.hpp"
+
+namespace xlnt_benchmark {
+
+namespace {
+
+const std::vector<std::uint8_t> &file_bytes(const xlnt::path &file)
+{
+    static std::map<std::string, std::vector<std::uint8_t>> files;
+    auto match = files.find(file.string());
+
+    if (match == files.end())
+    {
+        std::ifstream stream(file.string(), std::ios::binary);
+
+        if (!stream)
+        {
+            throw std::runtime_error("missing benchmark file " + file.string());
+        }
+
+        std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        match = files.emplace(file.string(), std::move(bytes)).first;
+    }
+
+    return match->second;
+}
+
+} // namespace
+
+const std::vector<std::uint8_t> &data_file(const std::string &name)
+{
+    return file_bytes(path_helper::benchmark_file(name));
+}
+
+const std::vector<std::uint8_t> &test_data_file(const std::string &name)
+{
+    return file_bytes(path_helper::test_file(name));
+}
+
+std::size_t cell_count(const xlnt::workbook &wb)
+{
+    std::size_t cells = 0;
+
+    for (const auto ws : wb)
+    {
+        for (const auto row : ws.rows(true))
+        {
+            cells += row.length();
+        }
+    }
+
+    return cells;
+}
+
+std::size_t cell_count(const std::vector<std::uint8_t> &data, const std::string &password)
+{
+    xlnt::workbook wb;
+
+    if (password.empty())
+    {
+        wb.load(data);
+    }
+    else
+    {
+        wb.load(data, password);
+    }
+
+    return cell_count(wb);
+}
+
+std::size_t peak_resident_bytes()
+{
+    return xlnt::benchmarks::peak_resident_bytes();
+}
+
+#if !defined(XLNT_BENCHMARK_COUNT_ALLOCATIONS)
+// defined by allocation_counter.cpp otherwise
+bool counting_allocations()
+{
+    return false;
+}
+
+std::uint64_t allocation_count()
+{
+    return 0;
+}
+
+std::uint64_t allocated_byte_count()
+{
+    return 0;
+}
+#endif
+
+namespace {
+
+std::uint64_t first_allocation = 0;
+std::uint64_t first_allocated_byte = 0;
+
+} // namespace
+
+void begin_measurement()
+{
+    xlnt::benchmarks::reset_peak_resident_bytes();
+
+    first_allocation = allocation_count();
+    first_allocated_byte = allocated_byte_count();
+}
+
+void report(benchmark::State &state, std::size_t bytes, std::size_t cells)
+{
+    const auto allocations = allocation_count() - first_allocation;
+    const auto allocated_bytes = allocated_byte_count() - first_allocated_byte;
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+    state.counters["cells"] = benchmark::Counter(static_cast<double>(cells),
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["peak_rss"] = benchmark::Counter(static_cast<double>(peak_resident_bytes()),
+        benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+
+    if (counting_allocations() && state.iterations() > 0)
+    {
+        // per cell of one iteration, or per iteration if there are no cells
+        const auto per = static_cast<double>(state.iterations()) * static_cast<double>(cells == 0 ? 1 : cells);
+        state.counters["allocs_per_cell"] = static_cast<double>(allocations) / per;
+        state.counters["alloc_bytes_per_cell"] = static_cast<double>(allocated_bytes) / per;
+    }
+}
+
+} // namespace xlnt_benchmark
@@ -0,0 +1,103 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace xlnt {
+class workbook;
+}
+
+namespace xlnt_benchmark {
+
+/// <summary>
+/// Returns the bytes of the file with the given name in benchmarks/data. Files are
+/// read once and kept so that benchmarks don't measure the disk.
+/// </summary>
+const std::vector<std::uint8_t> &data_file(const std::string &name);
+
+/// <summary>
+/// Returns the bytes of the file with the given name in tests/data, like data_file.
+/// </summary>
+const std::vector<std::uint8_t> &test_data_file(const std::string &name);
+
+/// <summary>
+/// Returns the number of cells in all worksheets of wb.
+/// </summary>
+std::size_t cell_count(const xlnt::workbook &wb);
+
+/// <summary>
+/// Returns the number of cells in all worksheets of the workbook in data, which is
+/// decrypted with password unless that is empty. Benchmarks of loading count the
+/// cells with this before they start so that counting isn't measured.
+/// </summary>
+std::size_t cell_count(const std::vector<std::uint8_t> &data, const std::string &password = std::string());
+
+/// <summary>
+/// Returns the most memory this process has had resident so far, in bytes, or 0
+/// if the platform doesn't tell.
+/// </summary>
+std::size_t peak_resident_bytes();
+
+/// <summary>
+/// Starts measuring peak_resident_bytes from the current usage, where the platform
+/// allows it (Linux), and the allocations reported by report. Call this right before
+/// the benchmark loop. Where the peak can't be reset, it's the one of the whole
+/// process, so run one benchmark per process with --benchmark_filter to compare them.
+/// </summary>
+void begin_measurement();
+
+/// <summary>
+/// Returns true if the suite was built with XLNT_BENCHMARK_COUNT_ALLOCATIONS, which
+/// replaces the global operator new and delete to count allocations.
+/// </summary>
+bool counting_allocations();
+
+/// <summary>
+/// Returns the number of allocations made by the process so far, or 0 if
+/// allocations aren't counted.
+/// </summary>
+std::uint64_t allocation_count();
+
+/// <summary>
+/// Returns the number of bytes allocated by the process so far, or 0 if
+/// allocations aren't counted.
+/// </summary>
+std::uint64_t allocated_byte_count();
+
+/// <summary>
+/// Reports the throughput of processing bytes and cells in every iteration as MB/s
+/// and cells/s, and the peak resident memory, as counters of state. If allocations
+/// are counted, the allocations and allocated bytes per cell since begin_measurement
+/// are reported too.
+/// </summary>
+void report(benchmark::State &state, std::size_t bytes, std::size_t cells);
+
+} // namespace xlnt_benchmark
@@ -0,0 +1,154 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+#include "workbook_generator.hpp"
+
+namespace xlnt_benchmark {
+
+xlnt::workbook generate_workbook(const workbook_shape &shape)
+{
+    std::mt19937 generator(shape.seed);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_real_distribution<double> number(-1e6, 1e6);
+
+    xlnt::workbook wb;
+
+    std::vector<std::string> strings;
+    strings.reserve(shape.strings);
+
+    for (std::size_t i = 0; i < shape.strings; ++i)
+    {
+        strings.push_back("string " + std::to_string(i));
+    }
+
+    // every format differs from all others in its font or fill
+    std::vector<xlnt::format> formats;
+    formats.reserve(shape.styles);
+
+    for (std::size_t i = 0; i < shape.styles; ++i)
+    {
+        const auto color = static_cast<std::uint32_t>(i / 16);
+        formats.push_back(wb.create_format()
+                              .font(xlnt::font().size(8.0 + static_cast<double>(i % 16)), true)
+                              .fill(xlnt::fill::solid(xlnt::rgb_color(static_cast<std::uint8_t>(color & 0xff),
+                                        static_cast<std::uint8_t>((color >> 8) & 0xff),
+                                        static_cast<std::uint8_t>((color >> 16) & 0xff))),
+                                  true));
+    }
+
+    std::uniform_int_distribution<std::size_t> string_index(0, shape.strings == 0 ? 0 : shape.strings - 1);
+    std::uniform_int_distribution<std::size_t> format_index(0, shape.styles == 0 ? 0 : shape.styles - 1);
+
+    for (std::size_t sheet = 0; sheet < shape.sheets; ++sheet)
+    {
+        auto ws = sheet == 0 ? wb.active_sheet() : wb.create_sheet();
+        ws.title("Sheet" + std::to_string(sheet + 1));
+
+        for (std::size_t row = 1; row <= shape.rows; ++row)
+        {
+            for (std::size_t column = 1; column <= shape.columns; ++column)
+            {
+                if (shape.sparsity > 0.0 && chance(generator) < shape.sparsity)
+                {
+                    continue;
+                }
+
+                auto cell = ws.cell(static_cast<xlnt::column_t::index_t>(column), static_cast<xlnt::row_t>(row));
+
+                if (shape.formula_density > 0.0 && chance(generator) < shape.formula_density)
+                {
+                    // refers to the row above, so formulas form chains as in typical sheets
+                    const auto column_name = xlnt::column_t::column_string_from_index(
+                        static_cast<xlnt::column_t::index_t>(column));
+                    cell.formula(row == 1 ? "1+1" : column_name + std::to_string(row - 1) + "*2");
+                }
+                else if (!strings.empty() && chance(generator) < shape.string_ratio)
+                {
+                    cell.value(strings[string_index(generator)]);
+                }
+                else
+                {
+                    cell.value(number(generator));
+                }
+
+                if (!formats.empty())
+                {
+                    cell.format(formats[format_index(generator)]);
+                }
+            }
+        }
+    }
+
+    return wb;
+}
+
+std::string describe_shape(const workbook_shape &shape)
+{
+    std::ostringstream description;
+    description << "rows=" << shape.rows
+                << " columns=" << shape.columns
+                << " sheets=" << shape.sheets
+                << " strings=" << shape.strings
+                << " string_ratio=" << shape.string_ratio
+                << " styles=" << shape.styles
+                << " formula_density=" << shape.formula_density
+                << " sparsity=" << shape.sparsity
+                << " seed=" << shape.seed;
+
+    return description.str();
+}
+
+bool parse_shape_argument(const std::string &argument, workbook_shape &shape)
+{
+    const auto equals = argument.find('=');
+
+    if (argument.compare(0, 2, "--") != 0 || equals == std::string::npos)
+    {
+        return false;
+    }
+
+    const auto name = argument.substr(2, equals - 2);
+    std::istringstream value(argument.substr(equals + 1));
+
+    if (name == "rows") value >> shape.rows;
+    else if (name == "columns") value >> shape.columns;
+    else if (name == "sheets") value >> shape.sheets;
+    else if (name == "strings") value >> shape.strings;
+    else if (name == "string_ratio") value >> shape.string_ratio;
+    else if (name == "styles") value >> shape.styles;
+    else if (name == "formula_density") value >> shape.formula_density;
+    else if (name == "sparsity") value >> shape.sparsity;
+    else if (name == "seed") value >> shape.seed;
+    else return false;
+
+    return !value.fail() && value.peek() == std::char_traits<char>::eof();
+}
+
+} // namespace xlnt_benchmark
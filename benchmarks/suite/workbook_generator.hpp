@@ -0,0 +1,106 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xlnt {
+class workbook;
+}
+
+namespace xlnt_benchmark {
+
+/// <summary>
+/// The shape of a synthetic workbook made by generate_workbook.
+/// </summary>
+struct workbook_shape
+{
+    /// <summary>
+    /// The number of rows of every worksheet.
+    /// </summary>
+    std::size_t rows = 1000;
+
+    /// <summary>
+    /// The number of columns of every worksheet.
+    /// </summary>
+    std::size_t columns = 10;
+
+    /// <summary>
+    /// The number of worksheets.
+    /// </summary>
+    std::size_t sheets = 1;
+
+    /// <summary>
+    /// The number of distinct strings cells are chosen from, i.e. the size of the
+    /// shared string table. With 0, every value is a number.
+    /// </summary>
+    std::size_t strings = 100;
+
+    /// <summary>
+    /// The fraction of the values which are strings rather than numbers, if there are strings.
+    /// </summary>
+    double string_ratio = 0.5;
+
+    /// <summary>
+    /// The number of distinct formats cells are chosen from. With 0, cells keep the default format.
+    /// </summary>
+    std::size_t styles = 0;
+
+    /// <summary>
+    /// The fraction of the cells which hold a formula instead of a value.
+    /// </summary>
+    double formula_density = 0.0;
+
+    /// <summary>
+    /// The fraction of the cells which are left out.
+    /// </summary>
+    double sparsity = 0.0;
+
+    /// <summary>
+    /// Seeds the choices of the generator, so that the same shape always gives the same workbook.
+    /// </summary>
+    std::uint32_t seed = 1;
+};
+
+/// <summary>
+/// Returns a workbook filled according to shape.
+/// </summary>
+xlnt::workbook generate_workbook(const workbook_shape &shape);
+
+/// <summary>
+/// Returns a description of shape such as "rows=1000 columns=10 ...", with the
+/// same names that parse_shape_argument reads.
+/// </summary>
+std::string describe_shape(const workbook_shape &shape);
+
+/// <summary>
+/// Sets the member of shape named by an argument of the form "--name=value", e.g.
+/// "--rows=1000". Returns false if the argument isn't one of those.
+/// </summary>
+bool parse_shape_argument(const std::string &argument, workbook_shape &shape);
+
+} // namespace xlnt_benchmark
@@ -79,6 +79,8 @@ struct cell_impl;
 /// The Cell class is required to know its value and type, display options,
 /// and any other features of an Excel cell.Utilities for referencing
 /// cells using Excel's 'A1' column/row nomenclature are also provided.
+/// Const member functions may be called from several threads at once as long as
+/// nothing modifies the workbook meanwhile.
 /// </remarks>
 class XLNT_API cell
 {
@@ -180,10 +182,17 @@ public:
     void value(const timedelta &timedelta_value);
 
     /// <summary>
-    /// Sets the value of this cell to the given value.
+    /// Sets the value of this cell to the given value. The string is kept with the cell
+    /// instead of in the shared string table if the cell has a formula, as its cached result.
     /// </summary>
     void value(const std::string &string_value);
 
+    /// <summary>
+    /// Sets the value of this cell to the given value, moving the string into the cell
+    /// or the shared string table instead of copying it.
+    /// </summary>
+    void value(std::string &&string_value);
+
     /// <summary>
     /// Sets the value of this cell to the given value.
     /// </summary>
@@ -466,9 +475,21 @@ public:
     /// <summary>
     /// Sets the formula of this cell to the given value.
     /// This formula string should begin with '='.
+    /// The value of the cell is kept and saved as the cached result of the formula,
+    /// which is what readers which don't evaluate formulas see.
     /// </summary>
     void formula(const std::string &formula);
 
+    /// <summary>
+    /// Sets the formula of this cell and the cached result of it, as set by value(cached_value).
+    /// </summary>
+    template <typename T>
+    void formula(const std::string &formula, const T &cached_value)
+    {
+        this->formula(formula);
+        value(cached_value);
+    }
+
     /// <summary>
     /// Removes the formula from this cell. After this is called, has_formula() will return false.
     /// </summary>
@@ -524,6 +545,13 @@ public:
     /// </summary>
     void error(const std::string &error);
 
+    /// <summary>
+    /// Returns the index of the string of this cell in the shared string table of its
+    /// workbook, so that cells can be grouped or counted by string without decoding it.
+    /// Throws invalid_data_type if the type of this cell isn't cell::type::shared_string.
+    /// </summary>
+    std::size_t shared_string_index() const;
+
     /// <summary>
     /// Returns a cell from this cell's parent workbook at
     /// a relative offset given by the parameters.
@@ -560,6 +588,12 @@ public:
     /// </summary>
     std::string check_string(const std::string &to_check);
 
+    /// <summary>
+    /// Returns to_check after verifying and fixing encoding, size, and illegal characters,
+    /// reusing its characters instead of copying them.
+    /// </summary>
+    std::string check_string(std::string &&to_check);
+
     // comment
 
     /// <summary>
@@ -635,6 +669,7 @@ public:
     bool operator!=(const cell &comparand) const;
 
 private:
+    friend class range;
     friend class style;
     friend class worksheet;
     friend class detail::xlsx_consumer;
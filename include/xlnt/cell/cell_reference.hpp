@@ -27,6 +27,7 @@
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/cell/index_types.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -59,6 +60,12 @@ struct XLNT_API cell_reference_hash
 class XLNT_API cell_reference
 {
 public:
+    /// <summary>
+    /// The most characters to_chars writes, for "$" followed by the letters of the
+    /// largest column, "$" and the digits of the largest row.
+    /// </summary>
+    static const std::size_t max_string_length = 19;
+
     /// <summary>
     /// Splits a coordinate string like "A1" into an equivalent pair like {"A", 1}.
     /// </summary>
@@ -73,6 +80,13 @@ public:
     static std::pair<std::string, row_t> split_reference(
         const std::string &reference_string, bool &absolute_column, bool &absolute_row);
 
+    /// <summary>
+    /// Returns the cell_reference for the characters [begin, end), such as "B14" or "$B$14",
+    /// without copying them into a string. Throws invalid_cell_reference like the constructor
+    /// taking a string.
+    /// </summary>
+    static cell_reference from_chars(const char *begin, const char *end);
+
     // constructors
 
     /// <summary>
@@ -182,6 +196,13 @@ public:
     /// </summary>
     std::string to_string() const;
 
+    /// <summary>
+    /// Writes the string to_string would return to buffer without allocating and returns a
+    /// pointer past the last character written. No terminating null is written, and buffer
+    /// must have room for max_string_length characters.
+    /// </summary>
+    char *to_chars(char *buffer) const;
+
     /// <summary>
     /// Returns a 1x1 range_reference containing only this cell_reference.
     /// </summary>
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,6 +35,13 @@
 
 namespace xlnt {
 
+namespace detail {
+
+class xlsx_consumer;
+class xlsx_producer;
+
+} // namespace detail
+
 /// <summary>
 /// Encapsulates zero or more formatted text runs where a text run
 /// is a string of text with the same defined formatting.
@@ -51,11 +59,22 @@ public:
     /// </summary>
     rich_text(const std::string &plain_text);
 
+    /// <summary>
+    /// Constructs a rich text object with the given text and no font, taking
+    /// over the characters of plain_text instead of copying them.
+    /// </summary>
+    rich_text(std::string &&plain_text);
+
     /// <summary>
     /// Constructs a rich text object from other
     /// </summary>
     rich_text(const rich_text &other);
 
+    /// <summary>
+    /// Constructs a rich text object by moving from other.
+    /// </summary>
+    rich_text(rich_text &&other) = default;
+
     /// <summary>
     /// Constructs a rich text object with the given text and font.
     /// </summary>
@@ -127,11 +146,22 @@ public:
     /// </summary>
     void phonetic_properties(const phonetic_pr &phonetic_props);
 
+    /// <summary>
+    /// Returns the approximate number of bytes this text has allocated for its runs
+    /// and their strings, not including the size of the rich_text itself.
+    /// </summary>
+    std::size_t memory_usage() const;
+
     /// <summary>
     /// Copies rich text object from other
     /// </summary>
     rich_text &operator=(const rich_text &rhs);
 
+    /// <summary>
+    /// Moves rich text object from other
+    /// </summary>
+    rich_text &operator=(rich_text &&rhs) = default;
+
     /// <summary>
     /// Returns true if the runs that make up this text are identical to those in rhs.
     /// </summary>
@@ -153,28 +183,60 @@ public:
     bool operator!=(const std::string &rhs) const;
 
 private:
+    friend class rich_text_hash;
+    friend class detail::xlsx_consumer;
+    friend class detail::xlsx_producer;
+
+    /// <summary>
+    /// A run as it is stored. Its font is immutable and shared by every copy of the text,
+    /// and by the runs of other texts with the same font if it was interned when read.
+    /// </summary>
+    struct stored_run
+    {
+        std::string text;
+        std::shared_ptr<const font> run_font;
+        bool preserve_space = false;
+
+        bool operator==(const stored_run &other) const;
+    };
+
+    /// <summary>
+    /// Stores the single unformatted run of new_run compactly if runs_ is empty,
+    /// otherwise moves the compact run into runs_ first and appends new_run.
+    /// </summary>
+    void append_run(const rich_text_run &new_run);
+
+    /// <summary>
+    /// Appends a run with the given text and font, which may be null for no font, sharing
+    /// the font instead of copying it.
+    /// </summary>
+    void append_run(std::string &&text, std::shared_ptr<const font> run_font, bool preserve_space);
+
     /// <summary>
-    /// The runs that make up this rich text.
+    /// The runs that make up this rich text. This is empty if the text consists of a
+    /// single unformatted run, which is held by plain_ instead.
     /// </summary>
-    std::vector<rich_text_run> runs_;
+    std::vector<stored_run> runs_;
+
+    /// <summary>
+    /// The text of the single unformatted run if compact_ is true.
+    /// </summary>
+    std::string plain_;
+    bool plain_preserve_space_ = false;
+    bool compact_ = false;
+
     std::vector<phonetic_run> phonetic_runs_;
     optional<phonetic_pr> phonetic_properties_;
 };
 
+/// <summary>
+/// Hashes the runs of a rich_text in order, combining the text of each run with the
+/// name, size and emphasis of its font. Runs are read in place rather than copied.
+/// </summary>
 class XLNT_API rich_text_hash
 {
 public:
-    std::size_t operator()(const rich_text &k) const
-    {
-        std::size_t res = 0;
-
-        for (auto r : k.runs())
-        {
-            res ^= std::hash<std::string>()(r.first);
-        }
-
-        return res;
-    }
+    std::size_t operator()(const rich_text &k) const;
 };
 
 } // namespace xlnt
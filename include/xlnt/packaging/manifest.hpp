@@ -86,6 +86,13 @@ public:
     /// </summary>
     std::vector<xlnt::relationship> relationships(const path &source, relationship_type type) const;
 
+    /// <summary>
+    /// Returns the id of a relationship with "source" as the source, a type of "type" and
+    /// "target" as the path of its target, or an empty string if there is none. This looks
+    /// the target up in an index instead of searching every relationship of source.
+    /// </summary>
+    std::string relationship_id(const path &source, relationship_type type, const std::string &target) const;
+
     /// <summary>
     /// Returns the canonical path of the chain of relationships by traversing through rels
     /// and forming the absolute combined path.
@@ -197,6 +204,19 @@ private:
     /// The map of package parts to their registered relationships.
     /// </summary>
     std::unordered_map<path, std::unordered_map<std::string, xlnt::relationship>> relationships_;
+
+    /// <summary>
+    /// For each source part, the id of a relationship by its type and target, as looked
+    /// up by relationship_id.
+    /// </summary>
+    std::unordered_map<path, std::unordered_map<std::string, std::string>> relationship_targets_;
+
+    /// <summary>
+    /// For each source part, an index below which every rId was taken when a relationship
+    /// was last registered, which next_relationship_id starts from. It is dropped when a
+    /// relationship of the part is unregistered.
+    /// </summary>
+    std::unordered_map<path, std::size_t> next_relationship_index_;
 };
 
 } // namespace xlnt
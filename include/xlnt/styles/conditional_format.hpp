@@ -160,6 +160,7 @@ public:
 private:
     friend struct detail::stylesheet;
     friend class detail::xlsx_consumer;
+    friend class worksheet;
 
     /// <summary>
     ///
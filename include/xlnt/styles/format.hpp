@@ -220,6 +220,7 @@ private:
     friend class detail::xlsx_producer;
     friend class detail::xlsx_consumer;
     friend class cell;
+    friend class range;
 
     /// <summary>
     /// Constructs a format from an impl pointer.
@@ -321,6 +321,50 @@ public:
     ~unhandled_switch_case() override;
 };
 
+/// <summary>
+/// Exception for a load or save which was cancelled by its progress callback
+/// </summary>
+class XLNT_API operation_cancelled : public exception
+{
+public:
+    /// <summary>
+    /// Default constructor.
+    /// </summary>
+    operation_cancelled();
+
+    /// <summary>
+    /// Default copy constructor.
+    /// </summary>
+    operation_cancelled(const operation_cancelled &) = default;
+
+    /// <summary>
+    /// Destructor
+    /// </summary>
+    ~operation_cancelled() override;
+};
+
+/// <summary>
+/// Exception for a file which exceeds one of the resource limits of load_options
+/// </summary>
+class XLNT_API limit_exceeded : public exception
+{
+public:
+    /// <summary>
+    /// Constructs a limit_exceeded exception with a message naming the limit.
+    /// </summary>
+    explicit limit_exceeded(const std::string &message);
+
+    /// <summary>
+    /// Default copy constructor.
+    /// </summary>
+    limit_exceeded(const limit_exceeded &) = default;
+
+    /// <summary>
+    /// Destructor
+    /// </summary>
+    ~limit_exceeded() override;
+};
+
 /// <summary>
 /// Exception for attempting to use a feature which is not supported
 /// </summary>
@@ -0,0 +1,99 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Runs the parallel work of xlnt, such as reading and writing worksheets with
+/// load_options::worksheet_threads and save_options::worksheet_threads, decrypting and
+/// encrypting packages, visiting cells with worksheet::parallel_for_each_cell, and
+/// sorting and summarizing ranges. Derive from this to run that work on a thread pool
+/// of the application instead of threads started for each call, and install it with
+/// set_executor.
+/// </summary>
+class XLNT_API executor
+{
+public:
+    virtual ~executor();
+
+    /// <summary>
+    /// Calls worker up to thread_count times, concurrently, and returns once every call has
+    /// returned. The calls take their work from a queue they share until it is empty, so
+    /// the executor may make fewer calls than thread_count, or make them one after another,
+    /// and the calling thread may make one of them itself. At least one call must be made.
+    /// worker doesn't throw.
+    /// </summary>
+    virtual void run(std::size_t thread_count, const std::function<void()> &worker) = 0;
+
+    /// <summary>
+    /// Returns the number of threads worth using for work which isn't limited by an
+    /// option of the call, such as decrypting a package. This is never 0.
+    /// </summary>
+    virtual std::size_t concurrency() const = 0;
+};
+
+/// <summary>
+/// The executor used unless another one is set. It starts the threads of every call
+/// and joins them before returning, making one of the calls on the calling thread.
+/// </summary>
+class XLNT_API thread_executor : public executor
+{
+public:
+    /// <summary>
+    /// Constructs an executor using up to max_threads threads for each call, the calling
+    /// thread included, or as many as each call asks for if max_threads is 0. Its
+    /// concurrency is max_threads, or the number of hardware threads if that is 0.
+    /// </summary>
+    explicit thread_executor(std::size_t max_threads = 0);
+
+    void run(std::size_t thread_count, const std::function<void()> &worker) override;
+
+    std::size_t concurrency() const override;
+
+private:
+    std::size_t max_threads_;
+};
+
+/// <summary>
+/// Makes every parallel path of xlnt run on the given executor from now on, or on a
+/// default thread_executor if it is nullptr. Calls which are already running keep the
+/// executor they started with. Threads which hand data from one stage to another, such as
+/// those of load_options::pipelined_sheet_data and load_options::inflate_ahead, wait for
+/// each other and are still started by themselves.
+/// </summary>
+XLNT_API void set_executor(std::shared_ptr<executor> new_executor);
+
+/// <summary>
+/// Returns the executor parallel work is currently run on.
+/// </summary>
+XLNT_API std::shared_ptr<executor> current_executor();
+
+} // namespace xlnt
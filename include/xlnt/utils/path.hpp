@@ -238,8 +238,7 @@ struct hash<xlnt::path>
     /// </summary>
     size_t operator()(const xlnt::path &p) const
     {
-        static hash<string> hasher;
-        return hasher(p.string());
+        return hash<string>()(p.string());
     }
 };
 
@@ -0,0 +1,103 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/utils/date.hpp>
+#include <xlnt/utils/datetime.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The value of an element of a typed row as the cell type it is written as, chosen at
+/// compile time: integers as std::int64_t, floating point numbers as double, and bool,
+/// std::string, date and datetime as they are. const char * is written as std::string.
+/// There is no overload for other types, so rows holding them don't compile.
+/// </summary>
+inline bool typed_cell_value(bool value)
+{
+    return value;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, std::int64_t>::type
+typed_cell_value(T value)
+{
+    return static_cast<std::int64_t>(value);
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, double>::type typed_cell_value(T value)
+{
+    return static_cast<double>(value);
+}
+
+inline const std::string &typed_cell_value(const std::string &value)
+{
+    return value;
+}
+
+inline std::string typed_cell_value(const char *value)
+{
+    return value;
+}
+
+inline const date &typed_cell_value(const date &value)
+{
+    return value;
+}
+
+inline const datetime &typed_cell_value(const datetime &value)
+{
+    return value;
+}
+
+template <typename Tuple, typename Write, std::size_t... Indices>
+void write_typed_row(const Tuple &values, Write &write, std::index_sequence<Indices...>)
+{
+    // a braced list is evaluated from left to right, so the cells are written in column order
+    using expand = int[];
+    (void)expand{0, (write(static_cast<column_t::index_t>(Indices + 1), typed_cell_value(std::get<Indices>(values))), 0)...};
+}
+
+/// <summary>
+/// Calls write(column, value) with the typed_cell_value of every element of values,
+/// where the first element is in column 1.
+/// </summary>
+template <typename... Ts, typename Write>
+void write_typed_row(const std::tuple<Ts...> &values, Write write)
+{
+    write_typed_row(values, write, std::index_sequence_for<Ts...>());
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,67 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// A destination for the bytes of an archive, e.g. a multipart upload to cloud
+/// storage. workbook::save writes the archive front to back in chunks of
+/// save_options::sink_chunk_size bytes with write_async, serializing the next
+/// chunk while the previous one is written.
+/// </summary>
+class XLNT_API byte_sink
+{
+public:
+    virtual ~byte_sink();
+
+    /// <summary>
+    /// Writes the count bytes at data to the sink at offset, which is where the
+    /// previous write ended. Throws if they can't be written.
+    /// </summary>
+    virtual void write(std::uint64_t offset, const std::uint8_t *data, std::size_t count) = 0;
+
+    /// <summary>
+    /// Starts writing data to the sink at offset and returns a future which is ready
+    /// once it has been written. By default, write is called on another thread. It is
+    /// never called again before the previous write has completed.
+    /// </summary>
+    virtual std::future<void> write_async(std::uint64_t offset, std::vector<std::uint8_t> data);
+
+    /// <summary>
+    /// Called once after the last chunk of a save has been written, e.g. to complete
+    /// an upload. Does nothing by default.
+    /// </summary>
+    virtual void finish();
+};
+
+} // namespace xlnt
@@ -0,0 +1,67 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// A random-access source of the bytes of an archive, e.g. an object in cloud storage
+/// read with ranged requests. workbook::load reads the central directory from the end
+/// of the source and then only the ranges of the parts it reads, fetching the range
+/// after the one being parsed ahead of time with read_async.
+/// </summary>
+class XLNT_API byte_source
+{
+public:
+    virtual ~byte_source();
+
+    /// <summary>
+    /// Returns the number of bytes of the source.
+    /// </summary>
+    virtual std::uint64_t size() = 0;
+
+    /// <summary>
+    /// Reads the count bytes starting at offset into destination. offset + count is
+    /// never more than size(). Throws if they can't all be read.
+    /// </summary>
+    virtual void read(std::uint64_t offset, std::uint8_t *destination, std::size_t count) = 0;
+
+    /// <summary>
+    /// Starts reading the count bytes starting at offset and returns a future holding
+    /// them. By default, read is called on another thread, so it may be called while
+    /// another read is still running. Sources which can't be read concurrently or have
+    /// asynchronous requests of their own should override this.
+    /// </summary>
+    virtual std::future<std::vector<std::uint8_t>> read_async(std::uint64_t offset, std::size_t count);
+};
+
+} // namespace xlnt
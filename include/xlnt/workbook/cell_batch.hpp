@@ -0,0 +1,89 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_type.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Column buffers holding the values of consecutive cells read by
+/// streaming_workbook_reader::read_rows. Element i of each vector describes the
+/// same cell. The buffers keep their capacity between reads so they can be reused.
+/// </summary>
+class XLNT_API cell_batch
+{
+public:
+    /// <summary>
+    /// The row of each cell.
+    /// </summary>
+    std::vector<row_t> rows;
+
+    /// <summary>
+    /// The column index of each cell, where column A is 1.
+    /// </summary>
+    std::vector<column_t::index_t> columns;
+
+    /// <summary>
+    /// The type of each cell's value. Cells without a value are cell_type::empty.
+    /// </summary>
+    std::vector<cell_type> types;
+
+    /// <summary>
+    /// The value of number, date and boolean cells, where TRUE is 1 and FALSE is 0.
+    /// This is 0 for cells of any other type.
+    /// </summary>
+    std::vector<double> numbers;
+
+    /// <summary>
+    /// For shared_string cells, the index of the value in the workbook's shared strings.
+    /// For inline_string, formula_string and error cells, the index of the value in strings.
+    /// This is 0 for cells of any other type.
+    /// </summary>
+    std::vector<std::uint32_t> indices;
+
+    /// <summary>
+    /// The values of inline_string, formula_string and error cells of this batch.
+    /// </summary>
+    std::vector<std::string> strings;
+
+    /// <summary>
+    /// Returns the number of cells in this batch.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Removes all cells from this batch without releasing the buffers' memory.
+    /// </summary>
+    void clear();
+};
+
+} // namespace xlnt
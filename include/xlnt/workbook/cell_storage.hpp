@@ -0,0 +1,57 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// An enumeration of the storage engines a workbook can use for the cells of its worksheets.
+/// </summary>
+enum class cell_storage
+{
+    /// <summary>
+    /// Each cell is a separate node in a hash map keyed by its reference.
+    /// Best for sparse sheets and random access.
+    /// </summary>
+    hashed,
+
+    /// <summary>
+    /// Cells are kept in rows ordered by row number, each row holding contiguous
+    /// blocks of adjacent columns. Best for dense sheets which are walked row by row.
+    /// </summary>
+    dense_rows,
+
+    /// <summary>
+    /// Like dense_rows, but once the blocks of all worksheets of the workbook exceed
+    /// workbook::cell_memory_budget, further blocks are placed in a temporary file
+    /// mapped into memory, which the operating system pages out as needed instead of
+    /// swapping. Best for worksheets which don't fit into memory. Cells keep their
+    /// address, so cell objects stay valid.
+    /// </summary>
+    spilled_rows
+};
+
+} // namespace xlnt
@@ -0,0 +1,109 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_type.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Column buffers holding the values of the rows read by
+/// streaming_workbook_reader::read_columns. Element i of every column describes the
+/// cell of that column in rows[i], which is cell_type::empty if the row has no such
+/// cell. The buffers keep their capacity between reads so they can be reused.
+/// </summary>
+class XLNT_API column_batch
+{
+public:
+    /// <summary>
+    /// The values of one column, with one element per row of the batch.
+    /// </summary>
+    struct column
+    {
+        /// <summary>
+        /// The index of this column, where column A is 1.
+        /// </summary>
+        column_t::index_t index = 0;
+
+        /// <summary>
+        /// The type of each cell's value.
+        /// </summary>
+        std::vector<cell_type> types;
+
+        /// <summary>
+        /// The value of number, date and boolean cells, where TRUE is 1 and FALSE is 0.
+        /// This is 0 for cells of any other type.
+        /// </summary>
+        std::vector<double> numbers;
+
+        /// <summary>
+        /// For shared_string cells, the index of the value in the workbook's shared strings.
+        /// For inline_string, formula_string and error cells, the index of the value in
+        /// the strings of the batch. This is 0 for cells of any other type.
+        /// </summary>
+        std::vector<std::uint32_t> indices;
+    };
+
+    /// <summary>
+    /// The row of each element of the columns. Rows without any cells are left out.
+    /// </summary>
+    std::vector<row_t> rows;
+
+    /// <summary>
+    /// The columns which had a cell in this batch or an earlier one, by ascending index.
+    /// </summary>
+    std::vector<column> columns;
+
+    /// <summary>
+    /// The values of inline_string, formula_string and error cells of this batch.
+    /// </summary>
+    std::vector<std::string> strings;
+
+    /// <summary>
+    /// Returns the number of rows in this batch.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Returns the column with the given index, or nullptr if no cell of this
+    /// batch or an earlier one was in that column.
+    /// </summary>
+    const column *find(column_t::index_t index) const;
+
+    /// <summary>
+    /// Removes all rows from this batch without releasing the buffers' memory.
+    /// The columns are kept, with no elements.
+    /// </summary>
+    void clear();
+};
+
+} // namespace xlnt
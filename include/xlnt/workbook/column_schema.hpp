@@ -0,0 +1,64 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_type.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// The type of the values of one column in the rows sampled by
+/// streaming_workbook_reader::sample_schema.
+/// </summary>
+struct XLNT_API column_schema
+{
+    /// <summary>
+    /// The index of this column, where column A is 1.
+    /// </summary>
+    column_t::index_t index = 0;
+
+    /// <summary>
+    /// The type of the first value sampled in this column. Numbers with a date number
+    /// format are cell_type::date. Shared, inline and formula strings are all strings,
+    /// so they don't make a column mixed. This is cell_type::empty if the column only had
+    /// cells without a value or with an error.
+    /// </summary>
+    cell_type type = cell_type::empty;
+
+    /// <summary>
+    /// True if a sampled value in this column had another type than type.
+    /// </summary>
+    bool mixed = false;
+
+    /// <summary>
+    /// The number of sampled rows that have no value in this column or have an error in it.
+    /// </summary>
+    std::size_t nulls = 0;
+};
+
+} // namespace xlnt
@@ -0,0 +1,146 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// A column of values in buffers owned by the caller, which
+/// streaming_workbook_writer::append_rows writes without creating a cell for each
+/// value. The buffers are laid out like those of an Arrow array, so the buffers of
+/// an Arrow array can be used without copying them.
+/// </summary>
+class XLNT_API column_view
+{
+public:
+    /// <summary>
+    /// The kind of values in a column and which buffers hold them.
+    /// </summary>
+    enum class value_kind
+    {
+        /// <summary>
+        /// Numbers in doubles. NaN and infinite values are written as no cell.
+        /// </summary>
+        doubles,
+        /// <summary>
+        /// Numbers in integers.
+        /// </summary>
+        integers,
+        /// <summary>
+        /// Booleans in the bitmap booleans, one bit per value starting with the
+        /// least significant bit.
+        /// </summary>
+        booleans,
+        /// <summary>
+        /// UTF-8 strings written inline, where value i is the characters from
+        /// offsets[i] to offsets[i + 1].
+        /// </summary>
+        strings,
+        /// <summary>
+        /// Strings in the workbook's shared strings. Value i is the shared string
+        /// dictionary[indices[i]], or indices[i] itself if dictionary is nullptr.
+        /// </summary>
+        shared_strings
+    };
+
+    /// <summary>
+    /// The index of the column the values are written to, where column A is 1.
+    /// </summary>
+    column_t::index_t index = 1;
+
+    /// <summary>
+    /// The kind of values in this column.
+    /// </summary>
+    value_kind kind = value_kind::doubles;
+
+    /// <summary>
+    /// The values of a doubles column.
+    /// </summary>
+    const double *doubles = nullptr;
+
+    /// <summary>
+    /// The values of an integers column.
+    /// </summary>
+    const std::int64_t *integers = nullptr;
+
+    /// <summary>
+    /// The bitmap of values of a booleans column.
+    /// </summary>
+    const std::uint8_t *booleans = nullptr;
+
+    /// <summary>
+    /// The offsets of the values of a strings column into characters, one more than
+    /// there are values.
+    /// </summary>
+    const std::int32_t *offsets = nullptr;
+
+    /// <summary>
+    /// The UTF-8 characters of the values of a strings column.
+    /// </summary>
+    const char *characters = nullptr;
+
+    /// <summary>
+    /// The values of a shared_strings column, see value_kind::shared_strings.
+    /// </summary>
+    const std::int32_t *indices = nullptr;
+
+    /// <summary>
+    /// The shared string index of each entry of the dictionary indices refers to, or
+    /// nullptr if indices are shared string indices.
+    /// </summary>
+    const std::uint32_t *dictionary = nullptr;
+
+    /// <summary>
+    /// The number of entries in dictionary. Indices outside of it throw invalid_parameter.
+    /// </summary>
+    std::size_t dictionary_size = 0;
+
+    /// <summary>
+    /// A bitmap like booleans in which a cleared bit means the row has no cell in this
+    /// column, or nullptr if every row has one.
+    /// </summary>
+    const std::uint8_t *validity = nullptr;
+
+    /// <summary>
+    /// The position of the value of the first row in the buffers, in values or, for
+    /// the bitmaps, bits. This is the offset of a sliced Arrow array.
+    /// </summary>
+    std::int64_t offset = 0;
+
+    /// <summary>
+    /// The style id every cell of this column is written with, see
+    /// streaming_workbook_writer::add_format, or 0 for the default format.
+    /// </summary>
+    std::size_t format_id = 0;
+};
+
+} // namespace xlnt
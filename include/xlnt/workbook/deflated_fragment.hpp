@@ -0,0 +1,99 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/workbook/save_options.hpp>
+
+namespace xlnt {
+
+class worksheet;
+
+/// <summary>
+/// Rows of the sheetData of a worksheet deflated ahead of time, so that separate processes
+/// can each write the rows of a part of a large worksheet and one of them can splice the
+/// results into its own save with save_options::sheet_data_fragments without inflating
+/// and deflating them again.
+/// data is a raw deflate stream (RFC 1951) of blocks none of which is marked final. It
+/// refers to nothing before its start and ends with an empty stored block at a byte
+/// boundary, as a full flush leaves it, so fragments can be concatenated into one stream
+/// which still has to be ended with a final block.
+/// </summary>
+class XLNT_API deflated_fragment
+{
+public:
+    /// <summary>
+    /// Returns the size bytes at data, e.g. the XML of a run of row elements, deflated as
+    /// given by level into a fragment. They are kept in stored blocks if level is
+    /// compression_level::none.
+    /// </summary>
+    static deflated_fragment compress(const std::uint8_t *data, std::size_t size,
+        compression_level level = compression_level::standard);
+
+    /// <summary>
+    /// Returns xml deflated as given by level into a fragment, see compress above.
+    /// </summary>
+    static deflated_fragment compress(const std::string &xml,
+        compression_level level = compression_level::standard);
+
+    /// <summary>
+    /// Returns the row elements every cell of ws would be written as by workbook::save,
+    /// deflated as given by level. Strings are written inline instead of as indices into
+    /// the shared strings, rich text is written as its plain text, and hyperlinks, comments
+    /// and everything else outside of sheetData are left out. The style ids of the cells are
+    /// written as they are, so the workbook the fragment is spliced into must have the same
+    /// formats, e.g. by starting from the same template. Shared formulae are numbered from 0
+    /// in each fragment, so at most one fragment of a worksheet may have them.
+    /// </summary>
+    static deflated_fragment from_sheet_data(const worksheet &ws,
+        compression_level level = compression_level::standard);
+
+    /// <summary>
+    /// Appends next to the end of this fragment.
+    /// </summary>
+    void append(const deflated_fragment &next);
+
+    /// <summary>
+    /// The deflated bytes.
+    /// </summary>
+    std::vector<std::uint8_t> data;
+
+    /// <summary>
+    /// The CRC-32 of the bytes before they were deflated, as stored in ZIP archives.
+    /// </summary>
+    std::uint32_t crc32 = 0;
+
+    /// <summary>
+    /// The number of bytes before they were deflated.
+    /// </summary>
+    std::uint64_t uncompressed_size = 0;
+};
+
+} // namespace xlnt
@@ -0,0 +1,71 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+namespace detail {
+
+struct encryption_key_impl;
+class xlsx_consumer;
+class xlsx_producer;
+
+} // namespace detail
+
+/// <summary>
+/// A password for encrypted workbooks which remembers the keys derived from it.
+/// Deriving a key hashes the password with a salt up to 100000 times, which loading
+/// or saving with a plain password string repeats every time. Workbooks loaded and
+/// saved with the same encryption_key only derive the key once for each salt.
+/// Copies share what has been derived and may be used from several threads at once.
+/// </summary>
+class XLNT_API encryption_key
+{
+public:
+    /// <summary>
+    /// Constructs a key for the given password, which nothing has been derived from yet.
+    /// </summary>
+    explicit encryption_key(const std::string &password);
+
+    /// <summary>
+    /// Returns the number of keys which have been derived from the password so far.
+    /// </summary>
+    std::size_t derived_key_count() const;
+
+private:
+    friend class detail::xlsx_consumer;
+    friend class detail::xlsx_producer;
+
+    /// <summary>
+    /// The password and the keys derived from it, shared between copies.
+    /// </summary>
+    std::shared_ptr<detail::encryption_key_impl> d_;
+};
+
+} // namespace xlnt
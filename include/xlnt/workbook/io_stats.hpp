@@ -0,0 +1,157 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Time and volume of the phases of one workbook load or save, filled in when
+/// load_options::stats or save_options::stats points to it. Values are added to
+/// the ones already there, so a single io_stats can sum up several loads; call
+/// reset in between otherwise. Phases may contain each other, e.g. inflating a part
+/// is also part of the time spent reading it, and phases run on several threads,
+/// such as reading worksheets with load_options::worksheet_threads, add up the time
+/// of each thread.
+/// </summary>
+class XLNT_API io_stats
+{
+public:
+    /// <summary>
+    /// The wall time spent in a phase, the bytes it processed and how often it happened.
+    /// </summary>
+    struct phase
+    {
+        /// <summary>
+        /// The time spent in the phase in seconds.
+        /// </summary>
+        double seconds = 0.0;
+
+        /// <summary>
+        /// The number of bytes processed by the phase, as described for each phase.
+        /// </summary>
+        std::uint64_t bytes = 0;
+
+        /// <summary>
+        /// The number of times the phase happened.
+        /// </summary>
+        std::size_t count = 0;
+    };
+
+    /// <summary>
+    /// The time and uncompressed bytes of inflating, or the time and compressed bytes
+    /// of deflating, one part of the archive.
+    /// </summary>
+    struct part
+    {
+        /// <summary>
+        /// The path of the part in the archive.
+        /// </summary>
+        std::string path;
+
+        /// <summary>
+        /// The time spent compressing or decompressing the part. For members which
+        /// are stored uncompressed, this is the time spent copying them.
+        /// </summary>
+        phase compression;
+    };
+
+    /// <summary>
+    /// The whole load or save.
+    /// </summary>
+    phase total;
+
+    /// <summary>
+    /// Reading the central directory of the archive, or writing it when saving.
+    /// The count is the number of members.
+    /// </summary>
+    phase archive;
+
+    /// <summary>
+    /// Decompressing parts, with the number of uncompressed bytes. This sums up parts.
+    /// </summary>
+    phase inflate;
+
+    /// <summary>
+    /// Compressing parts, with the number of compressed bytes. This sums up parts.
+    /// </summary>
+    phase deflate;
+
+    /// <summary>
+    /// Reading or writing the shared string table, whose strings are counted in strings.
+    /// </summary>
+    phase shared_strings;
+
+    /// <summary>
+    /// Reading or writing the stylesheet, whose formats are counted in formats.
+    /// </summary>
+    phase stylesheet;
+
+    /// <summary>
+    /// Reading the cells of worksheets and constructing them, or writing them when
+    /// saving. The count is the number of worksheets.
+    /// </summary>
+    phase sheet_data;
+
+    /// <summary>
+    /// Writing the XML of every part when saving, including deflating it.
+    /// </summary>
+    phase serialization;
+
+    /// <summary>
+    /// The parts of the archive which have been inflated or deflated, in the order
+    /// they were finished.
+    /// </summary>
+    std::vector<part> parts;
+
+    /// <summary>
+    /// The number of cells read or written.
+    /// </summary>
+    std::size_t cells = 0;
+
+    /// <summary>
+    /// The number of shared strings read or written.
+    /// </summary>
+    std::size_t strings = 0;
+
+    /// <summary>
+    /// The number of cell formats read or written.
+    /// </summary>
+    std::size_t formats = 0;
+
+    /// <summary>
+    /// Sets every phase and count back to zero and removes all parts.
+    /// </summary>
+    void reset();
+};
+
+} // namespace xlnt
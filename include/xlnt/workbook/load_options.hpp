@@ -0,0 +1,256 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/progress.hpp>
+
+namespace xlnt {
+
+class io_stats;
+class worksheet;
+
+/// <summary>
+/// Options which control how a workbook is read by workbook::load.
+/// The defaults reproduce the behaviour of the load overloads without options.
+/// </summary>
+class XLNT_API load_options
+{
+public:
+    /// <summary>
+    /// If this is true, the cells of each worksheet are parsed from XML on the
+    /// calling thread while a second thread constructs them in the worksheet.
+    /// This overlaps parsing with cell construction on large sheets.
+    /// </summary>
+    bool pipelined_sheet_data = false;
+
+    /// <summary>
+    /// The number of parsed cells staged before they are constructed in the
+    /// worksheet. When pipelined_sheet_data is true, this is the number of cells
+    /// handed from the parsing thread to the constructing thread at once.
+    /// </summary>
+    std::size_t sheet_data_batch_size = 4096;
+
+    /// <summary>
+    /// The number of threads used to read worksheets concurrently. Each thread
+    /// decompresses and parses its own worksheet part; the parts of a worksheet which
+    /// touch workbook-wide state are still read one worksheet at a time.
+    /// A value of 0 or 1 reads the worksheets sequentially on the calling thread.
+    /// </summary>
+    std::size_t worksheet_threads = 1;
+
+    /// <summary>
+    /// The size in bytes of the buffers used to decompress each part of the
+    /// archive. Larger buffers mean fewer inflate calls and buffer refills per part.
+    /// Values below 512 are raised to 512.
+    /// </summary>
+    std::size_t decompression_buffer_size = 128 * 1024;
+
+    /// <summary>
+    /// The number of bytes requested by each ranged read when loading from a
+    /// byte_source. The range after the one being parsed is fetched ahead of time, and
+    /// parts larger than this are fetched as several ranges at once.
+    /// </summary>
+    std::size_t source_block_size = 1024 * 1024;
+
+    /// <summary>
+    /// If this is true, workbook::load(const path &) maps the file into memory
+    /// instead of reading it through a file stream. Parts are then inflated directly
+    /// from the mapping and stored parts are read without copying. If the file can't
+    /// be mapped, it is read through a file stream as usual.
+    /// </summary>
+    bool memory_map = false;
+
+    /// <summary>
+    /// If this is true, streaming_workbook_reader reads the archive front to back from its
+    /// local headers instead of seeking to the central directory, so it can read from
+    /// streams which can't seek such as pipes or sockets. A worksheet which hasn't been
+    /// passed yet is inflated straight from the stream, while parts passed on the way to
+    /// another are kept compressed in memory until they're needed. Relationships of parts
+    /// other than the package and the workbook aren't read.
+    /// This has no effect on workbook::load.
+    /// </summary>
+    bool forward_only = false;
+
+    /// <summary>
+    /// If this is true, each worksheet part is inflated into memory and the content of
+    /// its sheetData element is scanned directly instead of through the XML parser,
+    /// which still reads the rest of the part. This is much faster on large sheets at
+    /// the cost of holding the uncompressed part in memory while it is read.
+    /// </summary>
+    bool fast_sheet_data = true;
+
+    /// <summary>
+    /// If this is true, worksheet parts which are parsed as they are inflated are inflated
+    /// on a thread of their own into a ring of blocks of decompression_buffer_size bytes,
+    /// so that inflating a large worksheet overlaps with parsing it. This applies to
+    /// streaming_workbook_reader and to workbook::load when fast_sheet_data is false,
+    /// since fast_sheet_data inflates each part completely before scanning it.
+    /// </summary>
+    bool inflate_ahead = false;
+
+    /// <summary>
+    /// If this is true, workbook::load only reads the workbook-level parts and each
+    /// worksheet is read the first time it is accessed, e.g. through sheet_by_title,
+    /// sheet_by_index or by iterating over the workbook. The workbook keeps a copy of
+    /// the compressed file in memory until it is cleared or loaded again. sheet_titles,
+    /// sheet_count and the workbook properties don't read any worksheet.
+    /// This has no effect on streaming_workbook_reader.
+    /// </summary>
+    bool lazy_worksheets = false;
+
+    /// <summary>
+    /// If this is true, the shared string table is only indexed on load and each string
+    /// is decoded when a cell first asks for it. The table keeps the uncompressed part in
+    /// memory instead of a rich_text per string. Every string is decoded once the table is
+    /// modified, e.g. by assigning a string to a cell, or the workbook is saved or compared.
+    /// </summary>
+    bool lazy_shared_strings = false;
+
+    /// <summary>
+    /// If this is true, images and other binary parts such as vbaProject.bin are kept
+    /// compressed as they were in the archive instead of being inflated on load. They
+    /// are inflated when first accessed, e.g. through workbook::binaries or
+    /// workbook::thumbnail, and copied into the saved archive without being inflated
+    /// and deflated again if they never were.
+    /// </summary>
+    bool lazy_binaries = false;
+
+    /// <summary>
+    /// If this is true, only what's needed for the values of the cells is read: the
+    /// shared strings, the number formats of the cell formats, so that dates are still
+    /// recognised, and the rows and cells of each worksheet. The rest of the stylesheet,
+    /// the theme, the calculation chain, the thumbnail, binary parts such as
+    /// vbaProject.bin, and everything in a worksheet other than its dimension and
+    /// sheetData are skipped. This includes columns, views, merged cells, hyperlinks,
+    /// conditional formatting, print settings, comments and drawings. A workbook loaded
+    /// like this is meant to be read; saving it writes only what was read.
+    /// </summary>
+    bool values_only = false;
+
+    /// <summary>
+    /// If this is true, workbook::shrink_to_fit is called once the workbook has been read,
+    /// releasing the capacity reserved while parsing in the containers of the worksheets,
+    /// the shared string table and the stylesheet. Worksheets read later because of
+    /// lazy_worksheets aren't shrunk.
+    /// </summary>
+    bool shrink_to_fit = false;
+
+    /// <summary>
+    /// The titles of the worksheets whose content is read. The other worksheets are
+    /// still created, but left empty. If this is empty, every worksheet is read.
+    /// streaming_workbook_reader only lists and begins these worksheets.
+    /// </summary>
+    std::vector<std::string> sheets;
+
+    /// <summary>
+    /// If set, only the cells in this inclusive range of columns are read from sheetData.
+    /// Other cells are skipped without being constructed, except that the text of a
+    /// shared formula is still taken from its master cell for the cells which are read.
+    /// This also applies to streaming_workbook_reader.
+    /// </summary>
+    optional<std::pair<column_t, column_t>> columns;
+
+    /// <summary>
+    /// If set, only the rows in this inclusive range, and their cells, are read from
+    /// sheetData. It is combined with columns in the same way.
+    /// </summary>
+    optional<std::pair<row_t, row_t>> rows;
+
+    /// <summary>
+    /// If this isn't nullptr, the time and volume of each phase of workbook::load are
+    /// added to the io_stats it points to, which must outlive the load. For a
+    /// streaming_workbook_reader, this covers opening the workbook. Worksheets read
+    /// later because of lazy_worksheets aren't recorded.
+    /// </summary>
+    io_stats *stats = nullptr;
+
+    /// <summary>
+    /// If this is set, it is called after every progress_interval cells read from the
+    /// sheetData of a worksheet, and once when all cells of a worksheet have been read.
+    /// If it returns false, workbook::load throws operation_cancelled, leaving the
+    /// workbook partially loaded. It is never called concurrently, but may be called
+    /// from the threads reading worksheets when worksheet_threads is more than 1.
+    /// Worksheets read later because of lazy_worksheets and streaming_workbook_reader
+    /// don't report their progress.
+    /// </summary>
+    progress_callback progress;
+
+    /// <summary>
+    /// The number of cells of a worksheet read between calls of progress. Cells are
+    /// counted a batch of sheet_data_batch_size cells at a time, so the calls can be
+    /// further apart than this.
+    /// </summary>
+    std::size_t progress_interval = 64 * 1024;
+
+    /// <summary>
+    /// If this is set, it is called with each worksheet as soon as it has been read
+    /// completely, so that it can be used before workbook::load returns. Other worksheets
+    /// may still be being read at that point, so it should only use the worksheet it is
+    /// called with. It is never called concurrently, but may be called from the threads
+    /// reading worksheets when worksheet_threads is more than 1, which wait for it.
+    /// Worksheets read later because of lazy_worksheets and streaming_workbook_reader
+    /// aren't passed to it.
+    /// </summary>
+    std::function<void(worksheet)> worksheet_loaded;
+
+    // The limits below protect against files crafted to exhaust memory. A load which
+    // exceeds one of them throws limit_exceeded as soon as it is noticed. 0 means no limit.
+
+    /// <summary>
+    /// The maximum number of cells read from the sheetData of all worksheets together.
+    /// Cells outside of rows and columns aren't counted. streaming_workbook_reader
+    /// doesn't hold its cells, so this doesn't apply to it.
+    /// </summary>
+    std::size_t max_cells = 0;
+
+    /// <summary>
+    /// The maximum number of strings in the shared string table.
+    /// </summary>
+    std::size_t max_shared_strings = 0;
+
+    /// <summary>
+    /// The maximum uncompressed size in bytes of each part of the archive. Both the size
+    /// recorded in the archive and the number of bytes actually inflated are checked,
+    /// so parts which claim to be small and inflate to much more are stopped as well.
+    /// </summary>
+    std::uint64_t max_part_size = 0;
+
+    /// <summary>
+    /// The maximum number of entries in each list of the stylesheet: number formats,
+    /// fonts, fills, borders, cell formats, cell style formats and cell styles.
+    /// </summary>
+    std::size_t max_styles = 0;
+};
+
+} // namespace xlnt
@@ -0,0 +1,96 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+class load_options;
+class path;
+class workbook;
+
+namespace detail {
+class load_buffers;
+}
+
+/// <summary>
+/// Loads workbooks one after another while keeping the inflaters and decompression
+/// buffers of the parts read, so that each load after the first reuses them instead of
+/// allocating its own. This is for processing many files in a batch; a loader holds
+/// on to its buffers until it is destroyed or release() is called. A loader may be
+/// used from several threads at once, but each thread of a batch having its own keeps
+/// them from contending for the buffers.
+/// </summary>
+class XLNT_API loader
+{
+public:
+    loader();
+    ~loader();
+
+    loader(const loader &) = delete;
+    loader &operator=(const loader &) = delete;
+
+    /// <summary>
+    /// Loads the XLSX file in stream into destination like workbook::load.
+    /// </summary>
+    void load(workbook &destination, std::istream &stream);
+
+    void load(workbook &destination, std::istream &stream, const load_options &options);
+
+    /// <summary>
+    /// Loads the XLSX file at filename into destination like workbook::load.
+    /// </summary>
+    void load(workbook &destination, const xlnt::path &filename);
+
+    void load(workbook &destination, const xlnt::path &filename, const load_options &options);
+
+    /// <summary>
+    /// Loads the XLSX file in data into destination like workbook::load.
+    /// </summary>
+    void load(workbook &destination, const std::vector<std::uint8_t> &data);
+
+    void load(workbook &destination, const std::vector<std::uint8_t> &data, const load_options &options);
+
+    /// <summary>
+    /// Returns the number of bytes of decompression buffers kept for the next load.
+    /// </summary>
+    std::size_t retained_bytes() const;
+
+    /// <summary>
+    /// Frees the inflaters and buffers kept for the next load.
+    /// </summary>
+    void release();
+
+private:
+    std::shared_ptr<detail::load_buffers> buffers_;
+};
+
+} // namespace xlnt
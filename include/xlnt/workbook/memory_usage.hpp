@@ -0,0 +1,91 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// The approximate number of bytes a workbook or worksheet occupies in memory, as
+/// returned by workbook::memory_usage and worksheet::memory_usage. The sizes are
+/// estimates of the containers and their heap allocations, which don't include the
+/// overhead of the allocator, so they are best used to compare workbooks.
+/// </summary>
+class XLNT_API memory_usage
+{
+public:
+    /// <summary>
+    /// The containers of the cells, including the out-of-line fields of cells
+    /// with text, formulas, hyperlinks or comments.
+    /// </summary>
+    std::size_t cells = 0;
+
+    /// <summary>
+    /// The text of cells which don't refer to the shared string table.
+    /// </summary>
+    std::size_t text = 0;
+
+    /// <summary>
+    /// The formulas of cells and shared formulas.
+    /// </summary>
+    std::size_t formulas = 0;
+
+    /// <summary>
+    /// The shared string table, including strings which haven't been decoded yet
+    /// because of load_options::lazy_shared_strings.
+    /// </summary>
+    std::size_t shared_strings = 0;
+
+    /// <summary>
+    /// Formats, styles and the records they refer to, such as fonts and fills.
+    /// </summary>
+    std::size_t styles = 0;
+
+    /// <summary>
+    /// Images and other binary parts, and the data worksheets are read from later
+    /// because of load_options::lazy_worksheets.
+    /// </summary>
+    std::size_t binaries = 0;
+
+    /// <summary>
+    /// Cell comments.
+    /// </summary>
+    std::size_t comments = 0;
+
+    /// <summary>
+    /// Returns the sum of all of the above.
+    /// </summary>
+    std::size_t total() const;
+
+    /// <summary>
+    /// Adds each size of other to the one of this and returns this.
+    /// </summary>
+    memory_usage &operator+=(const memory_usage &other);
+};
+
+} // namespace xlnt
@@ -0,0 +1,70 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// How far workbook::load or workbook::save has got with the cells of the worksheets.
+/// This is what the progress callback of load_options and save_options is called with.
+/// </summary>
+class XLNT_API progress
+{
+public:
+    /// <summary>
+    /// The title of the worksheet whose cells are being read or written.
+    /// </summary>
+    std::string worksheet;
+
+    /// <summary>
+    /// The number of cells of this worksheet read or written so far.
+    /// </summary>
+    std::size_t worksheet_cells = 0;
+
+    /// <summary>
+    /// The number of cells of all worksheets read or written so far, including this one.
+    /// </summary>
+    std::size_t total_cells = 0;
+
+    /// <summary>
+    /// True if every cell of this worksheet has been read or written. Each worksheet
+    /// gets exactly one such call.
+    /// </summary>
+    bool worksheet_done = false;
+};
+
+/// <summary>
+/// A function called with the progress of a load or save. Returning false cancels it,
+/// which makes the load or save throw xlnt::operation_cancelled as soon as possible.
+/// </summary>
+using progress_callback = std::function<bool(const progress &)>;
+
+} // namespace xlnt
@@ -0,0 +1,120 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/workbook/cell_batch.hpp>
+
+namespace xlnt {
+
+class streaming_workbook_reader;
+
+/// <summary>
+/// A single-pass range over the rows of the current worksheet of a
+/// streaming_workbook_reader, as returned by streaming_workbook_reader::rows. Each
+/// element is a cell_batch holding the cells of the next rows, read with read_rows.
+/// The batch is reused, so it is only valid until the iterator is incremented.
+/// </summary>
+class XLNT_API row_batch_range
+{
+public:
+    /// <summary>
+    /// An input iterator over the batches of a row_batch_range.
+    /// </summary>
+    class XLNT_API iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = cell_batch;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const cell_batch *;
+        using reference = const cell_batch &;
+
+        /// <summary>
+        /// Returns the batch of the rows read last.
+        /// </summary>
+        reference operator*() const;
+
+        /// <summary>
+        /// Returns a pointer to the batch of the rows read last.
+        /// </summary>
+        pointer operator->() const;
+
+        /// <summary>
+        /// Reads the next rows into the batch.
+        /// </summary>
+        iterator &operator++();
+
+        /// <summary>
+        /// Returns true if both iterators are past the last row or belong to the same range.
+        /// </summary>
+        bool operator==(const iterator &other) const;
+
+        /// <summary>
+        /// Returns the opposite of operator==.
+        /// </summary>
+        bool operator!=(const iterator &other) const;
+
+    private:
+        friend class row_batch_range;
+
+        explicit iterator(row_batch_range *range);
+
+        /// <summary>
+        /// The range being read, or nullptr once its last row has been read.
+        /// </summary>
+        row_batch_range *range_;
+    };
+
+    /// <summary>
+    /// Reads the first rows and returns an iterator to their batch. A range can only
+    /// be iterated once.
+    /// </summary>
+    iterator begin();
+
+    /// <summary>
+    /// Returns the iterator past the last row.
+    /// </summary>
+    iterator end();
+
+private:
+    friend class streaming_workbook_reader;
+
+    row_batch_range(streaming_workbook_reader &reader, std::size_t rows_per_batch);
+
+    /// <summary>
+    /// Reads the next rows into batch_, returning false once there are none left.
+    /// </summary>
+    bool read_next();
+
+    streaming_workbook_reader *reader_;
+    std::size_t rows_per_batch_;
+    cell_batch batch_;
+};
+
+} // namespace xlnt
@@ -0,0 +1,188 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/workbook/progress.hpp>
+
+namespace xlnt {
+
+class deflated_fragment;
+class io_stats;
+
+/// <summary>
+/// How the parts of a saved workbook are compressed in the ZIP archive.
+/// </summary>
+enum class compression_level
+{
+    /// <summary>
+    /// Parts are stored without compression. Fastest to write and read, largest file.
+    /// </summary>
+    none,
+
+    /// <summary>
+    /// Parts are deflated at the fastest level.
+    /// </summary>
+    fastest,
+
+    /// <summary>
+    /// Parts are deflated at the default level. This is what save() without options uses.
+    /// </summary>
+    standard,
+
+    /// <summary>
+    /// Parts are deflated at the level giving the smallest file.
+    /// </summary>
+    best
+};
+
+/// <summary>
+/// Options which control how a workbook is written by workbook::save.
+/// The defaults reproduce the behaviour of the save overloads without options.
+/// </summary>
+class XLNT_API save_options
+{
+public:
+    /// <summary>
+    /// The compression applied to every part of the archive.
+    /// </summary>
+    compression_level compression = compression_level::standard;
+
+    /// <summary>
+    /// The number of threads used to write worksheets concurrently. Each thread
+    /// serializes and compresses a worksheet and its child parts into memory; the
+    /// results are then added to the archive in manifest order.
+    /// A value of 0 or 1 writes the worksheets sequentially on the calling thread.
+    /// </summary>
+    std::size_t worksheet_threads = 1;
+
+    /// <summary>
+    /// If this isn't nullptr, the time and volume of each phase of workbook::save are
+    /// added to the io_stats it points to, which must outlive the save.
+    /// </summary>
+    io_stats *stats = nullptr;
+
+    /// <summary>
+    /// If this is set, it is called after every progress_interval cells written to the
+    /// sheetData of a worksheet, and once when all cells of a worksheet have been written.
+    /// If it returns false, workbook::save throws operation_cancelled and the destination
+    /// is left with an incomplete archive. It is never called concurrently, but may be
+    /// called from the threads writing worksheets when worksheet_threads is more than 1.
+    /// streaming_workbook_writer doesn't report its progress.
+    /// </summary>
+    progress_callback progress;
+
+    /// <summary>
+    /// The number of cells of a worksheet written between calls of progress. Cells are
+    /// counted a row at a time, so the calls can be slightly further apart than this.
+    /// </summary>
+    std::size_t progress_interval = 64 * 1024;
+
+    /// <summary>
+    /// The number of bytes of each chunk written when saving to a byte_sink. The last
+    /// chunk may be smaller.
+    /// </summary>
+    std::size_t sink_chunk_size = 8 * 1024 * 1024;
+
+    /// <summary>
+    /// If this isn't nullptr, the fragments it maps the title of a worksheet to are spliced,
+    /// in order and without inflating them, into the sheetData of that worksheet after the
+    /// rows of its own cells, see deflated_fragment::from_sheet_data. Their rows must come
+    /// after those of the worksheet and of the fragments before them. The dimension written
+    /// for the worksheet only covers its own cells. The map must outlive the save. Worksheets
+    /// with fragments are always written sequentially and as usual, and XLSB saves and
+    /// streaming_workbook_writer ignore the map.
+    /// </summary>
+    const std::unordered_map<std::string, std::vector<deflated_fragment>> *sheet_data_fragments = nullptr;
+
+    /// <summary>
+    /// If this is true, the worksheets of a workbook loaded with load_options::lazy_worksheets
+    /// which haven't been accessed since are copied into the archive together with their
+    /// child parts, such as comments and drawings, as the compressed entries they were
+    /// loaded from instead of being read and written again. Worksheets sharing a child part
+    /// with another worksheet are written as usual, and all worksheets are written as usual
+    /// if formats have been removed from the workbook since it was loaded, as that changes
+    /// the format ids the copied worksheets refer to.
+    /// </summary>
+    bool preserve_unchanged_parts = false;
+
+    /// <summary>
+    /// If this is true, the shared strings are compacted with workbook::compact_shared_strings
+    /// before they are written, dropping strings no cell uses. This is skipped if any worksheet
+    /// is copied because of preserve_unchanged_parts, as the copy keeps the old numbering.
+    /// </summary>
+    bool compact_shared_strings = false;
+
+    /// <summary>
+    /// If this and compact_shared_strings are true, the shared strings used by the most
+    /// cells are written first.
+    /// </summary>
+    bool order_shared_strings_by_frequency = false;
+
+    /// <summary>
+    /// If this is true, runs of formulas down a column which are copies of the first formula
+    /// of the run moved along with their cells, such as =A2*B2, =A3*B3 and so on, are written
+    /// as one shared formula whose other cells only refer to it. This makes worksheets with
+    /// many such formulas smaller and faster to write and open. As with shared formulas read
+    /// from a file, after loading the saved workbook every cell of a run reports the formula
+    /// of its first cell. Formulas with row ranges such as 1:3 are always written in full.
+    /// </summary>
+    bool share_formulas = false;
+
+    /// <summary>
+    /// If this is true, the parts are ordered in the archive so that it can be read front
+    /// to back, see load_options::forward_only: the content types, the relationships, the
+    /// document properties, the workbook and every other workbook part, including the
+    /// styles and the shared strings, come before the first worksheet. The count attribute
+    /// of the shared strings is then taken from a scan of the cells. Worksheets already
+    /// written by streaming_workbook_writer stay at the start of its archive.
+    /// </summary>
+    bool streaming_part_order = false;
+
+    /// <summary>
+    /// If this is true, saving the same workbook with the same options always gives the same
+    /// bytes: the content types, the relationships without a numbered id and the defined names
+    /// of each worksheet, which are kept in hash tables, are written sorted, and parts copied
+    /// from the archive the workbook was loaded from are stamped with the same fixed date and
+    /// time as every other part instead of keeping their own.
+    /// </summary>
+    bool deterministic = false;
+
+    /// <summary>
+    /// If this is true, the workbook is written as an XLSB file, whose workbook, styles,
+    /// shared strings and worksheets are binary records instead of XML. Only the cell values,
+    /// the sheets and the number formats of the cell formats are kept: formulas are written
+    /// as their cached values, and fonts, fills, borders, alignments and every other part,
+    /// such as comments and drawings, are left out. The worksheets are written sequentially
+    /// and preserve_unchanged_parts is ignored.
+    /// </summary>
+    bool xlsb = false;
+};
+
+} // namespace xlnt
@@ -0,0 +1,136 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+class column_view;
+class format;
+class streaming_workbook_writer;
+class worksheet;
+
+namespace detail {
+class xlsx_producer;
+} // namespace detail
+
+/// <summary>
+/// Writes the cells of one worksheet of a streaming_workbook_writer independently of the
+/// other worksheets, see streaming_workbook_writer::open_worksheet. Each sheet writer can be
+/// used on a thread of its own, where its rows are serialized and compressed into memory.
+/// The worksheets are added to the file in the order they were opened when the workbook
+/// writer is closed, after which sheet writers mustn't be used anymore.
+/// </summary>
+class XLNT_API streaming_sheet_writer
+{
+public:
+    /// <summary>
+    /// Writes a cell at ref and returns it to be given a value or formula, as
+    /// streaming_workbook_writer::add_cell does. Strings are written inline, and the cell
+    /// mustn't be given rich text or a format, which would change the workbook from
+    /// several threads.
+    /// </summary>
+    cell add_cell(const cell_reference &ref);
+
+    /// <summary>
+    /// Writes a cell at ref with cell_format, which has to have been created before the
+    /// sheet writer was opened, and returns it to be given a value or formula.
+    /// </summary>
+    cell add_cell(const cell_reference &ref, const format &cell_format);
+
+    /// <summary>
+    /// Writes a cell at ref with the format whose style id is format_id, see
+    /// streaming_workbook_writer::add_format, and returns it to be given a value or formula.
+    /// </summary>
+    cell add_cell(const cell_reference &ref, std::size_t format_id);
+
+    /// <summary>
+    /// Writes the last added cell and ends its row. The next cell must be below it.
+    /// </summary>
+    void end_row();
+
+    /// <summary>
+    /// Writes values to the cells of the row below the last one, starting in column A,
+    /// and ends the row. Each value is given to the cell with cell::value.
+    /// </summary>
+    template <typename T>
+    void append_row(const std::vector<T> &values)
+    {
+        const auto row = next_row();
+        column_t::index_t column = 1;
+
+        for (const auto &value : values)
+        {
+            add_cell(cell_reference(column++, row)).value(value);
+        }
+
+        end_row();
+    }
+
+    /// <summary>
+    /// Writes row_count rows below the last one with the values of columns, see
+    /// streaming_workbook_writer::append_rows. Shared strings have to have been added
+    /// before the sheet writer was opened.
+    /// </summary>
+    void append_rows(std::size_t row_count, const std::vector<column_view> &columns);
+
+    /// <summary>
+    /// Returns the row below the last one which has been written to the worksheet.
+    /// </summary>
+    row_t next_row() const;
+
+    /// <summary>
+    /// Returns the worksheet being written. Properties of the sheet written before its
+    /// cells, such as columns and views, must be set before the first cell is added.
+    /// </summary>
+    class worksheet worksheet() const;
+
+    /// <summary>
+    /// Writes everything after the rows of the worksheet and compresses the rest of it on
+    /// the calling thread. Nothing can be added afterwards. This is called by
+    /// streaming_workbook_writer::close for sheet writers which haven't been closed.
+    /// </summary>
+    void close();
+
+private:
+    friend class streaming_workbook_writer;
+
+    explicit streaming_sheet_writer(detail::xlsx_producer &producer);
+
+    /// <summary>
+    /// The producer writing the worksheet, owned by the producer of the workbook.
+    /// </summary>
+    detail::xlsx_producer *producer_;
+};
+
+} // namespace xlnt
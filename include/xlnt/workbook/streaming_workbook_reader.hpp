@@ -25,12 +25,15 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/workbook/row_batch_range.hpp>
 
 namespace xml {
 class parser;
@@ -39,6 +42,12 @@ class parser;
 namespace xlnt {
 
 class cell;
+class cell_batch;
+class column_batch;
+struct column_schema;
+class load_options;
+class rich_text;
+class row_properties;
 template <typename T>
 class optional;
 class path;
@@ -46,6 +55,7 @@ class workbook;
 class worksheet;
 
 namespace detail {
+class sheet_prefetch;
 class xlsx_consumer;
 }
 
@@ -68,10 +78,67 @@ public:
 
     /// <summary>
     /// Reads the next cell in the current worksheet and optionally returns it if
-    /// the last cell in the sheet has not yet been read.
+    /// the last cell in the sheet has not yet been read. The same cell is reused for
+    /// every call, so the returned cell is only valid until the next one.
     /// </summary>
     cell read_cell();
 
+    /// <summary>
+    /// Sets the function called with the number and properties of every row read by
+    /// has_cell(), read_rows() or read_columns(), before any of its cells are returned.
+    /// The row properties aren't kept in the worksheet returned by end_worksheet().
+    /// </summary>
+    void row_callback(const std::function<void(row_t, const row_properties &)> &callback);
+
+    /// <summary>
+    /// Clears batch and fills it with the cells of up to row_count of the next rows
+    /// in the current worksheet. Returns the number of rows read, which is 0 once
+    /// the last row in the sheet has been read. This avoids creating a cell for every
+    /// value and can be mixed with has_cell() and read_cell().
+    /// </summary>
+    std::size_t read_rows(cell_batch &batch, std::size_t row_count);
+
+    /// <summary>
+    /// Like read_rows, but decodes the rows into one typed buffer per column, with
+    /// cell_type::empty values where a row has no cell in a column.
+    /// </summary>
+    std::size_t read_columns(column_batch &batch, std::size_t row_count);
+
+    /// <summary>
+    /// Begins reading the worksheet with the given title and returns a range over its
+    /// rows in batches of up to rows_per_batch rows, e.g.
+    /// for (const auto &batch : reader.rows("Sheet1")). Each batch is read with read_rows
+    /// as the range is iterated, and end_worksheet() must be called afterwards as usual.
+    /// </summary>
+    row_batch_range rows(const std::string &title, std::size_t rows_per_batch = 1024);
+
+    /// <summary>
+    /// Returns the type of the values of each column in the first row_count rows of the
+    /// worksheet with the given title, by ascending column index. Only the type and style
+    /// of each cell are read, without decoding its value, and the rows after the sample
+    /// aren't read at all. This doesn't change the position of the current worksheet.
+    /// </summary>
+    std::vector<column_schema> sample_schema(const std::string &title, std::size_t row_count);
+
+    /// <summary>
+    /// Returns the shared string at index, as referenced by the indices of
+    /// shared_string cells in a cell_batch.
+    /// </summary>
+    const rich_text &shared_string(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the plain text of the shared string at index, such as
+    /// cell::shared_string_index() of a cell returned by read_cell(). With
+    /// load_options::lazy_shared_strings, a string without formatting runs is decoded
+    /// from the table every time without being kept.
+    /// </summary>
+    std::string resolve_string(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the number of shared strings in the workbook without decoding them.
+    /// </summary>
+    std::size_t shared_string_count() const;
+
     bool has_worksheet(const std::string &name);
 
     /// <summary>
@@ -119,6 +186,21 @@ public:
     /// </summary>
     void open(std::istream &stream);
 
+    /// <summary>
+    /// Interprets data in stream as an XLSX file like open(std::istream &). Only the
+    /// worksheets in options.sheets are listed and can be begun, and only the cells
+    /// within options.rows and options.columns are read. With options.lazy_shared_strings,
+    /// the shared string table is only indexed when the reader is opened, so reading can
+    /// start right away, and each string is decoded when it is asked for.
+    /// </summary>
+    void open(std::istream &stream, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file like
+    /// open(std::istream &, const load_options &).
+    /// </summary>
+    void open(const path &filename, const load_options &options);
+
     /// <summary>
     /// Holds the given streambuf internally, creates a std::istream backed
     /// by the given buffer, and calls open(std::istream &) with that stream.
@@ -126,12 +208,35 @@ public:
     void open(std::unique_ptr<std::streambuf> &&buffer);
 
     /// <summary>
-    /// Returns a vector of the titles of sheets in the workbook in order.
+    /// Returns a vector of the titles of sheets in the workbook in order, only
+    /// including the projected ones if the reader was opened with load_options::sheets.
     /// </summary>
     std::vector<std::string> sheet_titles();
 
+    /// <summary>
+    /// Starts inflating the worksheet after the current one in sheet_titles() order on a
+    /// background thread while the current one is read, or the first one if none has been
+    /// begun yet, so that begin_worksheet() finds it in memory. Each prefetched worksheet
+    /// holds up to max_bytes of uncompressed XML; a larger one is streamed as usual.
+    /// This has no effect on a reader opened with load_options::forward_only.
+    /// </summary>
+    void prefetch(std::size_t max_bytes = 64 * 1024 * 1024);
+
+    /// <summary>
+    /// Like prefetch(std::size_t), but prefetches the worksheets in the given order of
+    /// titles, so the one after the current one in order is inflated next.
+    /// </summary>
+    void prefetch(const std::vector<std::string> &order, std::size_t max_bytes = 64 * 1024 * 1024);
+
 private:
+    /// <summary>
+    /// Starts prefetching the worksheet after title in prefetch_order_, or the first one
+    /// if title is empty, unless it is already being prefetched.
+    /// </summary>
+    void prefetch_after(const std::string &title);
+
     std::string worksheet_rel_id_;
+    std::function<void(row_t, const row_properties &)> row_callback_;
     std::unique_ptr<detail::xlsx_consumer> consumer_;
     std::unique_ptr<workbook> workbook_;
     std::unique_ptr<std::istream> stream_;
@@ -139,6 +244,10 @@ private:
     std::unique_ptr<std::istream> part_stream_;
     std::unique_ptr<std::streambuf> part_stream_buffer_;
     std::unique_ptr<xml::parser> parser_;
+    std::string current_title_;
+    std::vector<std::string> prefetch_order_;
+    std::size_t prefetch_max_bytes_ = 0;
+    std::unique_ptr<detail::sheet_prefetch> prefetch_;
 };
 
 } // namespace xlnt
@@ -27,9 +27,15 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/utils/typed_row.hpp>
+#include <xlnt/workbook/streaming_sheet_writer.hpp>
 
 namespace xml {
 class serializer;
@@ -37,13 +43,13 @@ class serializer;
 
 namespace xlnt {
 
-class cell;
-class cell_reference;
+class column_view;
 class path;
 class workbook;
 class worksheet;
 
 namespace detail {
+class encrypting_ostreambuf;
 class xlsx_producer;
 } // namespace detail
 
@@ -65,17 +71,97 @@ public:
 
     /// <summary>
     /// Writes a cell to the currently active worksheet at the position given by
-    /// ref and with the given value. ref should be to the right of or below
-    /// the previously written cell.
+    /// ref and returns it to be given a value, format or formula. ref must be to the
+    /// right of or below the previously written cell, otherwise invalid_parameter is
+    /// thrown. The cell is written when the next one is added, so it is only valid
+    /// until then. Cells are never stored in the worksheet, which keeps memory use flat
+    /// however many rows are written, but comments and hyperlinks aren't written.
+    /// Row properties must be set before the first cell of their row is added.
     /// </summary>
     cell add_cell(const cell_reference &ref);
 
+    /// <summary>
+    /// Writes a cell at ref as add_cell(ref) does and returns it with the format whose
+    /// style id is format_id, see add_format, to be given a value or formula. The id is
+    /// written as it is, without the format being looked up or deduplicated for the cell.
+    /// Throws invalid_parameter before anything is written if there is no such format.
+    /// </summary>
+    cell add_cell(const cell_reference &ref, std::size_t format_id);
+
+    /// <summary>
+    /// Returns the style id of cell_format for add_cell and column_view::format_id. Formats
+    /// are created and given their font, fill, number format and so on through
+    /// workbook().create_format() before the cells using them are written, and keep their
+    /// ids until the writer is closed. Throws invalid_parameter if cell_format belongs to
+    /// another workbook.
+    /// </summary>
+    std::size_t add_format(const format &cell_format);
+
+    /// <summary>
+    /// Writes the last added cell and ends its row. The next cell must be below it.
+    /// Adding a cell below the current row ends the row as well.
+    /// </summary>
+    void end_row();
+
+    /// <summary>
+    /// Writes values to the cells of the row below the last one, starting in column A,
+    /// and ends the row. Each value is given to the cell with cell::value.
+    /// </summary>
+    template <typename T>
+    void append_row(const std::vector<T> &values)
+    {
+        const auto row = next_row();
+        column_t::index_t column = 1;
+
+        for (const auto &value : values)
+        {
+            add_cell(cell_reference(column++, row)).value(value);
+        }
+
+        end_row();
+    }
+
+    /// <summary>
+    /// Writes row_count rows below the last one with the values of columns, which must be
+    /// in ascending order of their index. Row i has the value i of each column, minding
+    /// the offset and validity of the column. The values are written straight from the
+    /// buffers of the columns, without a cell for each. Throws invalid_parameter before
+    /// anything is written if the columns aren't ascending, a column lacks the buffers of
+    /// its kind or the rows don't fit into the worksheet.
+    /// </summary>
+    void append_rows(std::size_t row_count, const std::vector<column_view> &columns);
+
+    /// <summary>
+    /// Adds text to the shared strings of the workbook unless it's already there and
+    /// returns its index, for use in a column_view of shared strings.
+    /// </summary>
+    std::size_t add_shared_string(const std::string &text);
+
+    /// <summary>
+    /// Returns the row below the last one which has been written to the current worksheet.
+    /// </summary>
+    row_t next_row() const;
+
     /// <summary>
     /// Ends writing of data to the current sheet and begins writing a new sheet
-    /// with the given title.
+    /// with the given title. Properties of the sheet written before its cells, such
+    /// as columns and views, must be set on the returned worksheet before the first
+    /// cell is added.
     /// </summary>
     worksheet add_worksheet(const std::string &title);
 
+    /// <summary>
+    /// Adds a worksheet with the given title and returns a writer for it which is
+    /// independent of the current sheet and of other sheet writers, so that several
+    /// worksheets can be written at once, each on a thread of its own. From now on, strings
+    /// assigned to cells are stored inline since the shared strings can't be added to from
+    /// several threads. Worksheets, shared strings and formats have to be added before the
+    /// sheet writers using them are handed to other threads, and close must only be called
+    /// once they are done. The worksheet is written after those written with add_worksheet,
+    /// in the order sheet writers were opened.
+    /// </summary>
+    streaming_sheet_writer open_worksheet(const std::string &title);
+
     /// <summary>
     /// Serializes the workbook into an XLSX file and saves the bytes into
     /// byte vector data.
@@ -107,10 +193,66 @@ public:
     /// </summary>
     void open(std::ostream &stream);
 
+    /// <summary>
+    /// Holds the given streambuf internally, creates a std::ostream backed
+    /// by the given buffer, and calls open(std::ostream &) with that stream.
+    /// </summary>
+    void open(std::unique_ptr<std::streambuf> &&buffer);
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file encrypted with password and saves
+    /// the data into a file named filename. The package is encrypted while it's
+    /// written rather than held in memory until close.
+    /// </summary>
+    void open(const xlnt::path &filename, const std::string &password);
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file encrypted with password and saves
+    /// the data into stream, which has to be seekable since the tables of the encrypted
+    /// file are written by close. Throws invalid_parameter otherwise.
+    /// </summary>
+    void open(std::ostream &stream, const std::string &password);
+
+    /// <summary>
+    /// Writes the elements of row to the cells of the row below the last one, starting in
+    /// column A, and ends the row. How each element is written is chosen at compile time
+    /// from its type, without a cell for it: integers and floating point numbers as numbers,
+    /// leaving out NaN and infinite values, bool as a boolean, std::string and const char *
+    /// as shared strings, and date and datetime as their serial numbers with a date format.
+    /// Rows holding elements of other types don't compile.
+    /// </summary>
+    template <typename... Ts>
+    void write_row(const std::tuple<Ts...> &row)
+    {
+        begin_typed_row(sizeof...(Ts));
+        detail::write_typed_row(row, [this](column_t::index_t column, const auto &value) {
+            write_typed_cell(column, value);
+        });
+        end_row();
+    }
+
+private:
+    /// <summary>
+    /// Ends the current row and starts the row below it for write_row with column_count cells.
+    /// </summary>
+    void begin_typed_row(std::size_t column_count);
+
+    /// <summary>
+    /// Writes a cell of the row started by begin_typed_row, see write_row.
+    /// </summary>
+    void write_typed_cell(column_t::index_t column, std::int64_t value);
+    void write_typed_cell(column_t::index_t column, double value);
+    void write_typed_cell(column_t::index_t column, bool value);
+    void write_typed_cell(column_t::index_t column, const std::string &value);
+    void write_typed_cell(column_t::index_t column, const date &value);
+    void write_typed_cell(column_t::index_t column, const datetime &value);
+
     std::unique_ptr<xlnt::detail::xlsx_producer> producer_;
     std::unique_ptr<workbook> workbook_;
     std::unique_ptr<std::ostream> stream_;
     std::unique_ptr<std::streambuf> stream_buffer_;
+    std::unique_ptr<xlnt::detail::encrypting_ostreambuf> encrypting_buffer_;
+    std::unique_ptr<std::ostream> encrypting_stream_;
     std::unique_ptr<std::ostream> part_stream_;
     std::unique_ptr<std::streambuf> part_stream_buffer_;
     std::unique_ptr<xml::serializer> serializer_;
@@ -27,6 +27,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -43,22 +44,30 @@
 namespace xlnt {
 
 enum class calendar;
+enum class cell_storage;
 enum class core_property;
 enum class extended_property;
 enum class relationship_type;
+enum class string_storage;
 
 class alignment;
 class border;
+class byte_sink;
+class byte_source;
 class calculation_properties;
 class cell;
 class cell_style;
 class color;
 class const_worksheet_iterator;
+class encryption_key;
 class fill;
 class font;
 class format;
+class load_options;
 class rich_text;
 class manifest;
+class memory_usage;
+class merge_options;
 class metadata_property;
 class named_range;
 class number_format;
@@ -68,6 +77,7 @@ class protection;
 class range;
 class range_reference;
 class relationship;
+class save_options;
 class streaming_workbook_reader;
 class style;
 class style_serializer;
@@ -82,9 +92,15 @@ struct datetime;
 
 namespace detail {
 
+class formula_engine;
+class load_buffers;
+class shared_string_loader;
 struct stylesheet;
 struct workbook_impl;
 struct worksheet_impl;
+class worksheet_loader;
+class xlsb_consumer;
+class xlsb_producer;
 class xlsx_consumer;
 class xlsx_producer;
 
@@ -93,6 +109,12 @@ class xlsx_producer;
 /// <summary>
 /// workbook is the container for all other parts of the document.
 /// </summary>
+/// <remarks>
+/// A workbook may be read from several threads at once through its const member
+/// functions and those of its const worksheets and cells, including the worksheets and
+/// shared strings of a lazily loaded workbook. Any modification requires that no other
+/// thread accesses the workbook at the same time.
+/// </remarks>
 class XLNT_API workbook
 {
 public:
@@ -102,7 +124,8 @@ public:
     enum class clone_method
     {
         deep_copy,
-        shallow_copy
+        shallow_copy,
+        copy_on_access
     };
 
     /// <summary>
@@ -200,6 +223,13 @@ public:
     /// <summary>
     /// Creates a clone of this workbook. A shallow copy will copy the workbook's internal pointers,
     /// while a deep copy will copy all the internal structures and create a full clone of the workbook.
+    /// A copy on access clone is a deep copy whose worksheets copy their cells from this workbook
+    /// when they are first accessed, which makes cloning a template cheap if only some of its
+    /// worksheets are used. It is a deferred copy rather than copy on write: the clone keeps
+    /// this whole workbook alive until every worksheet of the clone has been accessed, and
+    /// changes made to a worksheet of this workbook before then are copied along with it.
+    /// Accessing a worksheet throws xlnt::exception if it was removed from this workbook or
+    /// its cells were given formats created after the clone.
     /// </summary>
     workbook clone(clone_method method) const;
 
@@ -228,10 +258,29 @@ public:
 
     /// <summary>
     /// Creates and returns a new sheet at the specified index initializing it
-    /// with all of the data from the provided worksheet.
+    /// with all of the data from the provided worksheet. The worksheet may belong to
+    /// another workbook, in which case its cells are copied into the cell storage of
+    /// this workbook along with the shared strings and formats they use, each of which
+    /// is added to this workbook once.
     /// </summary>
     worksheet copy_sheet(worksheet worksheet, std::size_t index);
 
+    /// <summary>
+    /// Moves the worksheets of sources after the last sheet of this workbook, in order.
+    /// The cells of each worksheet are moved rather than copied and taken over by the
+    /// cell storage of this workbook in a single pass, in which their shared strings and
+    /// formats are translated. Each distinct string and format is added to this workbook
+    /// once, and equal ones are shared with what is already here. The sources are
+    /// cleared and removed from the vector.
+    /// </summary>
+    void merge_from(std::vector<workbook> &&sources);
+
+    /// <summary>
+    /// Moves the worksheets of sources after the last sheet of this workbook as above,
+    /// handling the titles which are already taken as options tell.
+    /// </summary>
+    void merge_from(std::vector<workbook> &&sources, const merge_options &options);
+
     /// <summary>
     /// Returns the worksheet that is determined to be active. An active
     /// sheet is that which is initially shown by the spreadsheet editor.
@@ -449,6 +498,77 @@ public:
     /// </summary>
     void base_date(calendar base_date);
 
+    /// <summary>
+    /// Returns the storage engine used for the cells of this workbook's worksheets.
+    /// The default is cell_storage::hashed.
+    /// </summary>
+    xlnt::cell_storage cell_storage() const;
+
+    /// <summary>
+    /// Sets the storage engine used for the cells of this workbook's worksheets.
+    /// Existing worksheets are converted, which invalidates any cell objects
+    /// obtained from them. The setting is kept by clear() and load().
+    /// </summary>
+    void cell_storage(xlnt::cell_storage storage);
+
+    /// <summary>
+    /// Returns the number of bytes of cells which worksheets using cell_storage::spilled_rows
+    /// keep in memory before further cells are placed in a temporary file. The default
+    /// is 256 MiB.
+    /// </summary>
+    std::size_t cell_memory_budget() const;
+
+    /// <summary>
+    /// Sets the number of bytes of cells which worksheets using cell_storage::spilled_rows
+    /// keep in memory before further cells are placed in a temporary file. Cells already
+    /// stored stay where they are. The setting is kept by clear() and load().
+    /// </summary>
+    void cell_memory_budget(std::size_t bytes);
+
+    /// <summary>
+    /// Moves the cells of each worksheet into one array sorted by row and column and
+    /// releases the containers of the storage engine, so that a workbook which is only
+    /// read afterwards takes less memory and is never modified by its readers, which can
+    /// then run concurrently. Worksheets which haven't been read yet are read first.
+    /// Cell values and formats can still be changed, but adding or removing cells of a
+    /// frozen worksheet throws xlnt::unsupported. This invalidates any cell objects
+    /// obtained from the workbook. Worksheets created later aren't frozen.
+    /// </summary>
+    void freeze();
+
+    /// <summary>
+    /// Moves the cells of frozen worksheets back into the storage engine of this
+    /// workbook. This invalidates any cell objects obtained from them.
+    /// </summary>
+    void thaw();
+
+    /// <summary>
+    /// Returns true if any worksheet of this workbook is frozen.
+    /// </summary>
+    bool frozen() const;
+
+    /// <summary>
+    /// Releases the capacity which the containers of this workbook reserved while it was
+    /// built but don't need for what they hold: the cell storage and row, column and
+    /// formula containers of each worksheet, the shared string table and the lists of the
+    /// stylesheet. Worksheets which haven't been read yet are left alone. Cell objects
+    /// obtained from the workbook stay valid.
+    /// </summary>
+    void shrink_to_fit();
+
+    /// <summary>
+    /// Returns how strings assigned to cells of this workbook are stored.
+    /// The default is string_storage::shared_table.
+    /// </summary>
+    xlnt::string_storage string_storage() const;
+
+    /// <summary>
+    /// Sets how strings assigned to cells of this workbook from now on are stored.
+    /// Cells which already have a value and rich text values are not affected.
+    /// The setting is kept by clear() and load().
+    /// </summary>
+    void string_storage(xlnt::string_storage storage);
+
     /// <summary>
     /// Returns true if this workbook has had its title set.
     /// </summary>
@@ -588,8 +708,15 @@ public:
     void save(const xlnt::path &filename, std::u8string_view password) const;
 #endif
 
+    /// <summary>
+    /// Serializes the workbook into an XLSX file encrypted with the password of key
+    /// and saves it to a file named filename, reusing the keys derived by key before.
+    /// </summary>
+    void save(const xlnt::path &filename, const encryption_key &key) const;
+
     /// <summary>
     /// Serializes the workbook into an XLSX file and saves the data into stream.
+    /// The stream is only appended to, so it may be a pipe or socket which can't seek.
     /// </summary>
     void save(std::ostream &stream) const;
 
@@ -607,6 +734,63 @@ public:
     void save(std::ostream &stream, std::u8string_view password) const;
 #endif
 
+    /// <summary>
+    /// Serializes the workbook into an XLSX file encrypted with the password of key
+    /// and writes it to stream, reusing the keys derived by key before.
+    /// </summary>
+    void save(std::ostream &stream, const encryption_key &key) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file, written as configured by options,
+    /// and loads the bytes into byte vector data.
+    /// </summary>
+    void save(std::vector<std::uint8_t> &data, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file, written as configured by options,
+    /// and saves the data into a file named filename.
+    /// </summary>
+    void save(const std::string &filename, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file, written as configured by options,
+    /// and saves the data into a file named filename.
+    /// </summary>
+    void save(const xlnt::path &filename, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file, written as configured by options,
+    /// and saves the data into stream.
+    /// </summary>
+    void save(std::ostream &stream, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file and writes it to sink.
+    /// </summary>
+    void save(byte_sink &sink) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file, written as configured by options,
+    /// and writes it to sink in chunks of save_options::sink_chunk_size bytes. The
+    /// next chunk is serialized while the previous one is being written.
+    /// </summary>
+    void save(byte_sink &sink, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes a snapshot of the workbook into an XLSX file named filename on a
+    /// background thread. The snapshot is a deep clone taken before this returns, so
+    /// this workbook may be changed while the file is written. The returned future
+    /// rethrows any exception thrown while saving.
+    /// </summary>
+    std::future<void> save_async(const xlnt::path &filename) const;
+
+    /// <summary>
+    /// Serializes a snapshot of the workbook into an XLSX file named filename on a
+    /// background thread, written as configured by options. A progress callback in
+    /// options is called from that thread.
+    /// </summary>
+    std::future<void> save_async(const xlnt::path &filename, const save_options &options) const;
+
     /// <summary>
     /// Interprets byte vector data as an XLSX file and sets the content of this
     /// workbook to match that file.
@@ -688,6 +872,13 @@ public:
     void load(const xlnt::path &filename, std::u8string_view password);
 #endif
 
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file encrypted with the
+    /// password of key and sets the content of this workbook to match that file.
+    /// The key is derived only if key hasn't derived it for the same salt before.
+    /// </summary>
+    void load(const xlnt::path &filename, const encryption_key &key);
+
     /// <summary>
     /// Interprets data in stream as an XLSX file and sets the content of this
     /// workbook to match that file.
@@ -708,6 +899,96 @@ public:
     void load(std::istream &stream, std::u8string_view password);
 #endif
 
+    /// <summary>
+    /// Interprets data in stream as an XLSX file encrypted with the password of key
+    /// and sets the content of this workbook to match that file. The key is derived
+    /// only if key hasn't derived it for the same salt before.
+    /// </summary>
+    void load(std::istream &stream, const encryption_key &key);
+
+    /// <summary>
+    /// Interprets byte vector data as an XLSX file and sets the content of this
+    /// workbook to match that file, reading it as configured by options.
+    /// </summary>
+    void load(const std::vector<std::uint8_t> &data, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the content
+    /// of this workbook to match that file, reading it as configured by options.
+    /// </summary>
+    void load(const std::string &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the content
+    /// of this workbook to match that file, reading it as configured by options.
+    /// </summary>
+    void load(const xlnt::path &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets data in stream as an XLSX file and sets the content of this
+    /// workbook to match that file, reading it as configured by options.
+    /// </summary>
+    void load(std::istream &stream, const load_options &options);
+
+    /// <summary>
+    /// Interprets the bytes of source as an XLSX file and sets the content of this
+    /// workbook to match that file.
+    /// </summary>
+    void load(std::shared_ptr<byte_source> source);
+
+    /// <summary>
+    /// Interprets the bytes of source as an XLSX file and sets the content of this
+    /// workbook to match that file, as configured by options. source is read with
+    /// ranged reads of the central directory and the parts needed, so with
+    /// load_options::lazy_worksheets only the worksheets accessed are fetched. The
+    /// workbook then keeps source until every worksheet has been read.
+    /// </summary>
+    void load(std::shared_ptr<byte_source> source, const load_options &options);
+
+    /// <summary>
+    /// Loads the XLSX file named filename, calls modifications with this workbook and
+    /// writes the result back to the file. The worksheets, shared strings and binary
+    /// parts are only read once modifications accesses them, and the worksheets it
+    /// doesn't access are copied into the new file as they were compressed in the old
+    /// one; see load_options::lazy_worksheets and save_options::preserve_unchanged_parts.
+    /// The file is only replaced once the new archive has been written completely.
+    /// </summary>
+    void update(const xlnt::path &filename, const std::function<void(workbook &)> &modifications);
+
+    /// <summary>
+    /// Updates the XLSX file named filename as above, loading and saving it as configured
+    /// by load and save except for the options update needs.
+    /// </summary>
+    void update(const xlnt::path &filename, const std::function<void(workbook &)> &modifications,
+        const load_options &load, const save_options &save);
+
+    /// <summary>
+    /// Writes this workbook to data as a snapshot, which load_snapshot reads much faster
+    /// than load reads an XLSX file. A snapshot holds the workbook as an uncompressed
+    /// archive whose worksheets have their cells stored as flat binary arrays instead of
+    /// XML. It's meant for caching, e.g. of templates which are loaded repeatedly, and the
+    /// format is versioned: other versions of xlnt may refuse to read it.
+    /// </summary>
+    void save_snapshot(std::vector<std::uint8_t> &data) const;
+
+    /// <summary>
+    /// Writes this workbook to the file named filename as a snapshot.
+    /// </summary>
+    void save_snapshot(const xlnt::path &filename) const;
+
+    /// <summary>
+    /// Sets the content of this workbook to the snapshot in data, as written by
+    /// save_snapshot. Throws unsupported if it was written in another version of the
+    /// snapshot format.
+    /// </summary>
+    void load_snapshot(const std::vector<std::uint8_t> &data);
+
+    /// <summary>
+    /// Sets the content of this workbook to the snapshot in the file named filename,
+    /// which is mapped into memory instead of being read if possible.
+    /// </summary>
+    void load_snapshot(const xlnt::path &filename);
+
     // View
 
     /// <summary>
@@ -890,6 +1171,12 @@ public:
     /// </summary>
     std::size_t add_shared_string(const rich_text &shared, bool allow_duplicates = false);
 
+    /// <summary>
+    /// Append a shared string to the shared string collection in this workbook,
+    /// moving it into the collection if it is added. See the overload above.
+    /// </summary>
+    std::size_t add_shared_string(rich_text &&shared, bool allow_duplicates = false);
+
     /// <summary>
     /// Returns a reference to the shared string related to the specified index
     /// </summary>
@@ -897,16 +1184,26 @@ public:
 
     /// <summary>
     /// Returns a reference to the shared strings being used by cells
-    /// in this workbook.
+    /// in this workbook. This decodes every string of a workbook loaded
+    /// with load_options::lazy_shared_strings.
     /// </summary>
     std::vector<rich_text> &shared_strings();
 
     /// <summary>
     /// Returns a reference to the shared strings being used by cells
-    /// in this workbook.
+    /// in this workbook. This decodes every string of a workbook loaded
+    /// with load_options::lazy_shared_strings.
     /// </summary>
     const std::vector<rich_text> &shared_strings() const;
 
+    /// <summary>
+    /// Removes the shared strings which no cell refers to any more and merges identical
+    /// ones, renumbering the strings of all cells. If order_by_frequency is true, the
+    /// strings used by the most cells come first. This loads every worksheet and shared
+    /// string of a lazily loaded workbook. Returns the number of strings removed.
+    /// </summary>
+    std::size_t compact_shared_strings(bool order_by_frequency = false);
+
     // Thumbnail
 
     /// <summary>
@@ -943,6 +1240,27 @@ public:
     /// </summary>
     void calculation_properties(const class calculation_properties &props);
 
+    /// <summary>
+    /// Returns the approximate number of bytes this workbook occupies in memory, i.e.
+    /// the memory_usage of all of its worksheets plus its shared strings, styles and
+    /// binaries. This doesn't read worksheets which are still waiting to be read
+    /// because of load_options::lazy_worksheets.
+    /// </summary>
+    class memory_usage memory_usage() const;
+
+    // Formulas
+
+    /// <summary>
+    /// Evaluates the formulas of this workbook and stores their results as the cached
+    /// values of their cells, returning the number of formulas evaluated. Each formula is
+    /// parsed once and the workbook remembers which cells every formula reads, so calling
+    /// this again only evaluates the formulas depending on cells changed since the previous
+    /// call. Formulas which don't depend on each other are evaluated on up to threads threads.
+    /// Array formulas, formulas in a dependency cycle and formulas using functions or
+    /// defined names which aren't supported keep their cached values.
+    /// </summary>
+    std::size_t calculate(std::size_t threads = 1);
+
     /// <summary>
     /// Returns true if this workbook is equal to other. If compare_by_reference is true, the comparison
     /// will only check that both workbook instances point to the same internal workbook. Otherwise,
@@ -987,11 +1305,17 @@ public:
     bool operator!=(const workbook &rhs) const;
 
 private:
+    friend class loader;
     friend class streaming_workbook_reader;
     friend class worksheet;
+    friend class detail::formula_engine;
+    friend class detail::xlsb_consumer;
+    friend class detail::xlsb_producer;
     friend class detail::xlsx_consumer;
     friend class detail::xlsx_producer;
     friend struct detail::worksheet_impl;
+    friend class detail::worksheet_loader;
+    friend class detail::shared_string_loader;
 
     /// <summary>
     /// Private constructor. Constructs a workbook from an implementation pointer.
@@ -1005,6 +1329,17 @@ private:
     /// </summary>
     workbook(std::weak_ptr<detail::workbook_impl> impl);
 
+    /// <summary>
+    /// Constructs a workbook without any of the parts, properties, styles and worksheets
+    /// empty() adds, for constructors and readers which load a file into it anyway.
+    /// </summary>
+    static workbook bare();
+
+    /// <summary>
+    /// Builds the workbook empty() returns copies of.
+    /// </summary>
+    static workbook build_empty();
+
     /// <summary>
     /// Internal function to set the impl.
     /// </summary>
@@ -1092,6 +1427,19 @@ private:
     template <typename T>
     void load_internal(std::istream &stream, const T &password);
 
+    /// <summary>
+    /// Loads the workbook like the public overloads taking load_options, with the parts of
+    /// the archive taking their inflaters and buffers from buffers unless it is nullptr.
+    /// </summary>
+    void load_reusing(std::istream &stream, const load_options &options,
+        std::shared_ptr<detail::load_buffers> buffers);
+
+    void load_reusing(const xlnt::path &filename, const load_options &options,
+        std::shared_ptr<detail::load_buffers> buffers);
+
+    void load_reusing(const std::vector<std::uint8_t> &data, const load_options &options,
+        std::shared_ptr<detail::load_buffers> buffers);
+
     /// <summary>
     /// Returns a reference to the workbook implementation structure. Provides
     /// a nicer interface than constantly dereferencing workbook::d_.
@@ -1119,6 +1467,18 @@ private:
     /// </summary>
     void register_workbook_part(relationship_type type);
 
+    /// <summary>
+    /// Like register_workbook_part but only remembers the type until the manifest
+    /// is next accessed, so that frequent callers like add_shared_string don't
+    /// have to look up the manifest every time.
+    /// </summary>
+    void register_workbook_part_later(relationship_type type);
+
+    /// <summary>
+    /// Adds the parts remembered by register_workbook_part_later to the manifest.
+    /// </summary>
+    void register_pending_parts() const;
+
     /// <summary>
     /// Adds a worksheet-level part of the given type to the manifest if it doesn't
     /// already exist. The part will have a path and content type of the default
@@ -0,0 +1,94 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/utils/optional.hpp>
+#include <xlnt/utils/variant.hpp>
+#include <xlnt/workbook/metadata_property.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+
+class path;
+
+/// <summary>
+/// What peek found out about one sheet of a workbook.
+/// </summary>
+struct XLNT_API sheet_summary
+{
+    /// <summary>
+    /// The title of the sheet.
+    /// </summary>
+    std::string title;
+
+    /// <summary>
+    /// True if the sheet is hidden, like workbook::sheet_hidden_by_index.
+    /// </summary>
+    bool hidden = false;
+
+    /// <summary>
+    /// The range of used cells the worksheet declares in its dimension element, which
+    /// isn't set if it has none or the sheet isn't a worksheet. Files not written by
+    /// Excel may declare a range which doesn't match their cells.
+    /// </summary>
+    optional<range_reference> dimension;
+};
+
+/// <summary>
+/// What peek found out about a workbook without loading it.
+/// </summary>
+struct XLNT_API workbook_summary
+{
+    /// <summary>
+    /// The sheets of the workbook in order.
+    /// </summary>
+    std::vector<sheet_summary> sheets;
+
+    /// <summary>
+    /// The core properties of the workbook, such as its title and creator, in the order
+    /// of workbook::core_properties.
+    /// </summary>
+    std::vector<std::pair<core_property, variant>> core_properties;
+};
+
+/// <summary>
+/// Reads the sheet titles, visibility and dimensions and the core properties of the XLSX
+/// file in stream without loading the workbook. Only the central directory, the content
+/// types, the relationships, the core properties and the workbook part are read, and
+/// each worksheet only until its dimension, so this takes about as long for any size of
+/// file. Throws invalid_file if stream isn't an XLSX file.
+/// </summary>
+XLNT_API workbook_summary peek(std::istream &stream);
+
+/// <summary>
+/// Like peek(std::istream &), for the file with the given filename.
+/// </summary>
+XLNT_API workbook_summary peek(const path &filename);
+
+} // namespace xlnt
@@ -0,0 +1,107 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstdint>
+
+#include <xlnt/xlnt_config.hpp>
+
+// The structs of the Arrow C data interface, declared exactly as the interface
+// specifies so that they are compatible with those of any other library.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ArrowSchema
+{
+    // Array type description
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+struct ArrowArray
+{
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace xlnt {
+
+class range_reference;
+class worksheet;
+
+/// <summary>
+/// Exports the cells of ws in range through the Arrow C data interface, as a struct
+/// array with a nullable child per column of the range and an element per row, so that
+/// any library implementing the interface can take it over without depending on
+/// Arrow here. If header_row is true, the first row of the range names the columns,
+/// otherwise they are named by their letters. The existing cells are visited in one pass.
+/// A column of numbers and dates becomes a float64 array holding the numbers, and dates
+/// as their serial numbers. A column of booleans only becomes a boolean array. A column
+/// with any strings or errors becomes a dictionary array of int32 indices into a utf8
+/// dictionary, which is shared by all such columns and holds the plain text of the
+/// workbook's shared strings followed by any other text, numbers included, of those
+/// columns. Rows without a cell in a column are null and a column without any cells is
+/// a null array. The caller owns schema and array and has to release them, as the
+/// interface specifies. Throws invalid_parameter if the dictionary exceeds the 2 GiB
+/// a utf8 array can address.
+/// </summary>
+XLNT_API void export_arrow(const worksheet &ws, const range_reference &range, bool header_row,
+    ArrowSchema *schema, ArrowArray *array);
+
+} // namespace xlnt
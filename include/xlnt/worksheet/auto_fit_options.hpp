@@ -0,0 +1,69 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Options which control how worksheet::auto_fit_columns sizes columns. Widths are in
+/// the units of column_properties::width, the width of a digit in the default font.
+/// </summary>
+class XLNT_API auto_fit_options
+{
+public:
+    /// <summary>
+    /// The width added to that of the widest cell of a column. The default is the
+    /// 5 pixels Excel adds to a column of the default font.
+    /// </summary>
+    double padding = 5.0 / 7.0;
+
+    /// <summary>
+    /// The smallest width a column is given.
+    /// </summary>
+    double minimum_width = 0.0;
+
+    /// <summary>
+    /// The largest width a column is given. Excel doesn't allow columns wider than 255.
+    /// </summary>
+    double maximum_width = 255.0;
+
+    /// <summary>
+    /// If this is true, numbers, dates and text are measured as formatted with the number
+    /// format of their cell, as Excel displays them. Otherwise numbers and dates are measured
+    /// as the shortest text which reads back as the same double, and text as it is.
+    /// </summary>
+    bool formatted = true;
+
+    /// <summary>
+    /// The number of threads measuring cells, each taking a share of the rows. A value of 0
+    /// uses the concurrency of the current executor and 1 measures on the calling thread.
+    /// </summary>
+    std::size_t thread_count = 1;
+};
+
+} // namespace xlnt
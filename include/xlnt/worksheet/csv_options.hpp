@@ -0,0 +1,85 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <string>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Options which control how worksheet::export_csv writes the cells of a worksheet and
+/// how worksheet::import_csv reads them. The defaults write RFC 4180 CSV with the cells
+/// formatted as Excel displays them.
+/// </summary>
+class XLNT_API csv_options
+{
+public:
+    /// <summary>
+    /// The character between the fields of a record.
+    /// </summary>
+    char delimiter = ',';
+
+    /// <summary>
+    /// The character around fields containing the delimiter, the quote itself or a line
+    /// break. Quotes within a field are doubled.
+    /// </summary>
+    char quote = '"';
+
+    /// <summary>
+    /// The characters after each record, including the last one. When reading, records
+    /// end at any of CR LF, LF or CR regardless of this.
+    /// </summary>
+    std::string line_terminator = "\r\n";
+
+    /// <summary>
+    /// If this is true, every field is quoted, including empty ones. Only used when writing.
+    /// </summary>
+    bool quote_all = false;
+
+    /// <summary>
+    /// If this is true, numbers, dates and text are formatted with the number format of
+    /// their cell, as Excel does when it saves a sheet as CSV. Otherwise numbers and dates
+    /// are written as the shortest text which reads back as the same double, and text as
+    /// it is.
+    /// </summary>
+    bool formatted = true;
+
+    /// <summary>
+    /// If this is true, the records start at row 1 and the fields at column A. Otherwise
+    /// they start at the first row and column containing a cell, like worksheet::rows.
+    /// </summary>
+    bool from_a1 = false;
+
+    /// <summary>
+    /// If this is true, the type of each field read is inferred as cell::value does for
+    /// a string with infer_type, and TRUE and FALSE in any case become booleans and
+    /// dates written as yyyy-mm-dd become dates. Otherwise every field is read as text.
+    /// </summary>
+    bool infer_types = true;
+};
+
+} // namespace xlnt
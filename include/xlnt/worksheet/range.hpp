@@ -27,6 +27,7 @@
 #include <functional>
 #include <iterator>
 #include <string>
+#include <vector>
 
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/styles/alignment.hpp>
@@ -45,8 +46,15 @@
 namespace xlnt {
 
 class const_range_iterator;
+class format;
 class range_iterator;
 
+namespace detail {
+
+struct numeric_summary;
+
+} // namespace detail
+
 /// <summary>
 /// A range is a 2D collection of cells with defined extens that can be iterated upon.
 /// </summary>
@@ -136,8 +144,15 @@ public:
     /// </summary>
     bool contains(const cell_reference &ref);
 
+    /// <summary>
+    /// Sets the format of all cells in the range to new_format and returns the range.
+    /// </summary>
+    range format(const xlnt::format &new_format);
+
     /// <summary>
     /// Sets the alignment of all cells in the range to new_alignment and returns the range.
+    /// The new format of the cells is only looked up once for each format they had before,
+    /// and likewise for the other styling setters below.
     /// </summary>
     range alignment(const xlnt::alignment &new_alignment);
 
@@ -269,6 +284,75 @@ public:
     /// </summary>
     void apply(std::function<void(class cell)> f);
 
+    /// <summary>
+    /// Replaces the contents of values with the numeric value of every cell in the range,
+    /// in major order. Cells which don't exist or don't hold a number, date or boolean
+    /// are given fill_value. The cells are read without creating a handle for each.
+    /// </summary>
+    void values(std::vector<double> &values, double fill_value = 0.0) const;
+
+    /// <summary>
+    /// Replaces the contents of strings with the plain text of every cell in the range,
+    /// in major order. Cells which don't exist or don't hold a string or an error are
+    /// given fill_value.
+    /// </summary>
+    void strings(std::vector<std::string> &strings, const std::string &fill_value = std::string()) const;
+
+    /// <summary>
+    /// Sets the values of the cells in the range to values, in major order, creating the
+    /// cells as needed. Throws invalid_parameter unless values has one value per cell.
+    /// </summary>
+    void assign(const std::vector<double> &values);
+
+    /// <summary>
+    /// Sets the values of the cells in the range to strings, in major order, creating the
+    /// cells as needed. Throws invalid_parameter unless strings has one string per cell.
+    /// </summary>
+    void assign(const std::vector<std::string> &strings);
+
+    /// <summary>
+    /// Sorts the rows of this range by the values of their cells in key_columns, by the
+    /// first key column and then by the next one where those are equal, keeping the order of
+    /// rows with equal keys. Numbers come before strings, which are compared ignoring the case
+    /// of ASCII letters, followed by booleans and errors; rows whose key cell is empty come last
+    /// in either order. The cells are moved in the cell storage of the worksheet together with
+    /// their formats, hyperlinks and comments, and their formulae are kept unchanged. The keys
+    /// are sorted on the given number of threads. Throws invalid_parameter if a key column is
+    /// outside the range or the range overlaps merged cells or an array formula.
+    /// </summary>
+    void sort(const std::vector<column_t> &key_columns, bool ascending = true, std::size_t threads = 1);
+
+    /// <summary>
+    /// Returns the sum of the numbers in the range. Like SUM, dates count as their serial
+    /// numbers while booleans, strings and empty cells are ignored. The stored cells are
+    /// read without creating a handle for each, and ranges holding more cells than the
+    /// worksheet stores are split by rows across the given number of threads.
+    /// </summary>
+    double sum(std::size_t threads = 1) const;
+
+    /// <summary>
+    /// Returns the smallest number in the range, or 0 if it holds no numbers like MIN.
+    /// Numbers are counted and read as by sum.
+    /// </summary>
+    double min(std::size_t threads = 1) const;
+
+    /// <summary>
+    /// Returns the largest number in the range, or 0 if it holds no numbers like MAX.
+    /// Numbers are counted and read as by sum.
+    /// </summary>
+    double max(std::size_t threads = 1) const;
+
+    /// <summary>
+    /// Returns the number of cells in the range holding a number or a date, like COUNT.
+    /// </summary>
+    std::size_t count_numeric(std::size_t threads = 1) const;
+
+    /// <summary>
+    /// Returns the mean of the numbers in the range like AVERAGE, or NaN if it holds none.
+    /// Numbers are counted and read as by sum.
+    /// </summary>
+    double mean(std::size_t threads = 1) const;
+
     /// <summary>
     /// Returns the n-th row or column in this range.
     /// </summary>
@@ -290,6 +374,29 @@ public:
     bool operator!=(const range &comparand) const;
 
 private:
+    /// <summary>
+    /// Gives every cell the format which restyle_first gave the first cell that had the
+    /// same format, calling restyle_first once per distinct format in the range. The
+    /// formats of the other cells are assigned directly with their reference counts
+    /// adjusted once per group.
+    /// </summary>
+    void restyle(const std::function<xlnt::format(class cell)> &restyle_first);
+
+    /// <summary>
+    /// Calls function with every stored cell in the range and its offset in major order,
+    /// looking the cells up one by one or visiting all cells of the worksheet, whichever
+    /// takes fewer steps.
+    /// </summary>
+    template <typename Function>
+    void for_each_stored(Function function) const;
+
+    /// <summary>
+    /// Returns the count, sum and bounds of the numbers in the range, summing the parts
+    /// of its rows on up to threads threads when the range holds more cells than the
+    /// worksheet stores.
+    /// </summary>
+    detail::numeric_summary summarize(std::size_t threads) const;
+
     /// <summary>
     /// The worksheet this range is within
     /// </summary>
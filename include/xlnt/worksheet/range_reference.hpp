@@ -36,11 +36,22 @@ namespace xlnt {
 class XLNT_API range_reference
 {
 public:
+    /// <summary>
+    /// The most characters to_chars writes, for two cell references and a colon.
+    /// </summary>
+    static const std::size_t max_string_length = 2 * cell_reference::max_string_length + 1;
+
     /// <summary>
     /// Converts relative reference coordinates to absolute coordinates (B12 -> $B$12)
     /// </summary>
     static range_reference make_absolute(const range_reference &relative_reference);
 
+    /// <summary>
+    /// Returns the range_reference for the characters [begin, end), in any of the forms the
+    /// constructor taking a string accepts, without copying them into strings.
+    /// </summary>
+    static range_reference from_chars(const char *begin, const char *end);
+
     /// <summary>
     /// Constructs a range reference equal to A1:A1
     /// </summary>
@@ -126,6 +137,13 @@ public:
     /// </summary>
     std::string to_string() const;
 
+    /// <summary>
+    /// Writes the string to_string would return to buffer without allocating and returns a
+    /// pointer past the last character written. No terminating null is written, and buffer
+    /// must have room for max_string_length characters.
+    /// </summary>
+    char *to_chars(char *buffer) const;
+
     /// <summary>
     /// Returns true if the given cell reference is within the bounds of this range reference.
     /// </summary>
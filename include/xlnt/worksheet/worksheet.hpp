@@ -25,19 +25,25 @@
 
 #pragma once
 
+#include <functional>
+#include <iosfwd>
 #include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/packaging/relationship.hpp>
+#include <xlnt/utils/optional.hpp>
+#include <xlnt/utils/typed_row.hpp>
 #include <xlnt/worksheet/page_margins.hpp>
 #include <xlnt/worksheet/page_setup.hpp>
 #include <xlnt/worksheet/sheet_view.hpp>
 
 namespace xlnt {
 
+class auto_fit_options;
 class cell;
 class cell_reference;
 class cell_vector;
@@ -45,9 +51,11 @@ class column_properties;
 class comment;
 class condition;
 class conditional_format;
+class csv_options;
 class const_range_iterator;
 class footer;
 class header;
+class memory_usage;
 class range;
 class range_iterator;
 class range_reference;
@@ -55,6 +63,7 @@ class relationship;
 class row_properties;
 class sheet_format_properties;
 class workbook;
+class worksheet_diff;
 class phonetic_pr;
 
 struct date;
@@ -72,6 +81,11 @@ struct worksheet_impl;
 /// A worksheet is a 2D array of cells starting with cell A1 in the top-left corner
 /// and extending indefinitely down and right as needed.
 /// </summary>
+/// <remarks>
+/// Like its workbook, a worksheet may be read from several threads at once through
+/// its const member functions, but must not be modified while any other thread
+/// accesses the workbook.
+/// </remarks>
 class XLNT_API worksheet
 {
 public:
@@ -121,6 +135,14 @@ public:
     /// </summary>
     void garbage_collect();
 
+    /// <summary>
+    /// Returns the approximate number of bytes this worksheet occupies in memory. The
+    /// shared strings, styles and binaries are part of the workbook, so they're zero.
+    /// A worksheet which hasn't been read yet because of load_options::lazy_worksheets
+    /// isn't read by this.
+    /// </summary>
+    class memory_usage memory_usage() const;
+
     // identification
 
     /// <summary>
@@ -179,6 +201,32 @@ public:
     /// </summary>
     bool has_cell(const cell_reference &reference) const;
 
+    /// <summary>
+    /// Returns the references of the cells whose value is the unformatted string text, as
+    /// compared by rich_text::operator==(const std::string &), in the order of their rows and
+    /// then columns. Shared strings are resolved to their index in the shared string table once,
+    /// after which cells are matched by comparing indices.
+    /// </summary>
+    std::vector<cell_reference> find_all(const std::string &text) const;
+
+    /// <summary>
+    /// Returns the references of the number cells whose value is exactly number, in the order
+    /// of their rows and then columns.
+    /// </summary>
+    std::vector<cell_reference> find_all(double number) const;
+
+    /// <summary>
+    /// Returns the reference of the first cell in the order of rows and then columns whose
+    /// value is the unformatted string text, or an unset optional if there is none.
+    /// </summary>
+    optional<cell_reference> find(const std::string &text) const;
+
+    /// <summary>
+    /// Returns the reference of the first number cell in the order of rows and then columns
+    /// whose value is exactly number, or an unset optional if there is none.
+    /// </summary>
+    optional<cell_reference> find(double number) const;
+
     /// <summary>
     /// Returns the cell at the given reference. If the cell doesn't exist, it
     /// will be initialized to null before being returned.
@@ -257,11 +305,122 @@ public:
     /// </summary>
     const class range columns(bool skip_null = true) const;
 
-    //TODO: finish implementing cell_iterator wrapping before uncommenting
-    //class cell_vector cells(bool skip_null = true);
+    /// <summary>
+    /// Sets the cells of the row below the last non-empty cell in the worksheet to
+    /// values, starting in column A, and returns the row. The cells are created
+    /// without a cell handle each, which is much faster than setting them one by one.
+    /// </summary>
+    row_t append_row(const std::vector<double> &values);
+
+    /// <summary>
+    /// Sets the cells of the row below the last non-empty cell in the worksheet to
+    /// values, starting in column A, and returns the row. Repeated strings are
+    /// only looked up once in the shared string table.
+    /// </summary>
+    row_t append_row(const std::vector<std::string> &values);
+
+    /// <summary>
+    /// Sets the cells of the row below the last non-empty cell in the worksheet to
+    /// values, starting in column A, and returns the row.
+    /// </summary>
+    row_t append_row(const std::vector<bool> &values);
+
+    /// <summary>
+    /// Sets the cells of a row below the last non-empty cell in the worksheet to the
+    /// elements of each tuple of rows, starting in column A, and returns the first of the
+    /// rows. How each element is stored is chosen at compile time from its type, see
+    /// streaming_workbook_writer::write_row, except that strings are stored as cell::value
+    /// stores them and NaN is kept. Throws invalid_cell_reference when a row doesn't fit
+    /// into the worksheet, keeping the rows before it.
+    /// </summary>
+    template <typename Rows>
+    row_t append_rows(const Rows &rows)
+    {
+        const auto first_row = next_appended_row();
+        auto row = first_row;
+
+        for (const auto &values : rows)
+        {
+            detail::write_typed_row(values, [this, &row](column_t::index_t column, const auto &value) {
+                assign_typed(column, row, value);
+            });
+            ++row;
+        }
+
+        return first_row;
+    }
+
+    /// <summary>
+    /// Sets the cells of the block with top_left as its top-left corner to the given
+    /// columns of values, so columns[i][j] goes i columns to the right of and j rows
+    /// below top_left. Columns may differ in length. The cells are created row by row
+    /// in the order the worksheet stores them. Throws invalid_cell_reference if the
+    /// block doesn't fit into the worksheet, before any cell is changed.
+    /// </summary>
+    void write_block(const cell_reference &top_left, const std::vector<std::vector<double>> &columns);
+
+    /// <summary>
+    /// Sets the cells of the block with top_left as its top-left corner to the given
+    /// columns of strings, see write_block for numbers. Repeated strings are only
+    /// looked up once in the shared string table.
+    /// </summary>
+    void write_block(const cell_reference &top_left, const std::vector<std::vector<std::string>> &columns);
+
+    /// <summary>
+    /// Sets the cells of the block with top_left as its top-left corner to the given
+    /// columns of booleans, see write_block for numbers.
+    /// </summary>
+    void write_block(const cell_reference &top_left, const std::vector<std::vector<bool>> &columns);
+
+    /// <summary>
+    /// Fills values with the numbers of the cells in range, row by row, so the cell
+    /// i rows below and j columns to the right of the top-left corner goes to
+    /// values[i * range.width() + j]. values must hold range.width() * range.height()
+    /// doubles. Dates are given as their serial numbers, empty cells and cells of any
+    /// other type as NaN. The stored cells of the range's rows are visited once, without
+    /// creating cells for the empty ones.
+    /// </summary>
+    void read_block(const range_reference &range, double *values) const;
+
+    /// <summary>
+    /// Adds a hyperlink to each cell in links pointing to the URL paired with it, like
+    /// cell::hyperlink(url). Links to the same URL share one relationship. Throws
+    /// invalid_parameter before any cell is changed if a URL is empty.
+    /// </summary>
+    void add_hyperlinks(const std::vector<std::pair<cell_reference, std::string>> &links);
+
+    /// <summary>
+    /// Returns a vector of every cell in this worksheet in row-major order. If skip_null
+    /// is true, only the cells which exist are visited, going straight from one to the
+    /// next without visiting the empty positions in between.
+    /// </summary>
+    class cell_vector cells(bool skip_null = true);
+
+    /// <summary>
+    /// Returns a vector of every cell in this worksheet in row-major order. If skip_null
+    /// is true, only the cells which exist are visited, going straight from one to the
+    /// next without visiting the empty positions in between.
+    /// </summary>
+    const class cell_vector cells(bool skip_null = true) const;
+
+    /// <summary>
+    /// Calls function with every existing cell of this worksheet, dividing the cells
+    /// between thread_count threads of the current executor, or as many as its concurrency
+    /// if thread_count is 0. A thread_count of 1 visits them on the calling thread.
+    /// The cells are visited in no particular order.
+    /// Reading the values and formats of the given cells from function concurrently is
+    /// safe, modifying the workbook is not. The first exception thrown by function stops the
+    /// remaining work and is rethrown once every thread has finished.
+    /// </summary>
+    void parallel_for_each_cell(const std::function<void(const class cell &)> &function,
+        std::size_t thread_count = 0) const;
 
-    //TODO: finish implementing cell_iterator wrapping before uncommenting
-    //const class cell_vector cells(bool skip_null = true) const;
+    /// <summary>
+    /// Calls function with every existing cell in the rows [first_row, last_row] of
+    /// this worksheet, see parallel_for_each_cell.
+    /// </summary>
+    void parallel_for_each_cell(row_t first_row, row_t last_row,
+        const std::function<void(const class cell &)> &function, std::size_t thread_count = 0) const;
 
     /// <summary>
     /// Clears memory used by the given cell.
@@ -296,7 +455,8 @@ public:
     // properties
 
     /// <summary>
-    /// Returns the column properties for the given column.
+    /// Returns the column properties for the given column, adding them if necessary.
+    /// The reference is invalidated when properties are added to or removed from another column.
     /// </summary>
     xlnt::column_properties &column_properties(column_t column);
 
@@ -322,7 +482,23 @@ public:
     double column_width(column_t column) const;
 
     /// <summary>
-    /// Returns the row properties for the given row.
+    /// Sets the width of every column which has a cell to the width of its widest cell,
+    /// estimated with the default auto_fit_options.
+    /// </summary>
+    void auto_fit_columns();
+
+    /// <summary>
+    /// Sets the width of every column of range which has a cell within range to the width
+    /// of its widest cell there, as estimated from the font and the number format of each
+    /// cell, and marks the width as custom and best fit. The character widths of each font
+    /// are worked out once and shared by the cells using it. Cells merged with cells of
+    /// other columns are left out, as in Excel, and columns without cells keep their width.
+    /// </summary>
+    void auto_fit_columns(const range_reference &range, const auto_fit_options &options);
+
+    /// <summary>
+    /// Returns the row properties for the given row, adding them if necessary.
+    /// The reference is invalidated when properties are added to or removed from another row.
     /// </summary>
     xlnt::row_properties &row_properties(row_t row);
 
@@ -452,6 +628,7 @@ public:
 
     /// <summary>
     /// Merges the cells within the given range.
+    /// Throws invalid_parameter if the range overlaps a range which is already merged.
     /// </summary>
     void merge_cells(const range_reference &reference);
 
@@ -470,6 +647,11 @@ public:
     /// </summary>
     std::vector<range_reference> merged_ranges() const;
 
+    /// <summary>
+    /// Returns the merged range containing the cell at the given reference, if any.
+    /// </summary>
+    optional<range_reference> merged_range(const cell_reference &reference) const;
+
     // operators
 
     /// <summary>
@@ -514,6 +696,32 @@ public:
     /// </summary>
     bool compare(const worksheet &other, bool compare_by_reference) const;
 
+    /// <summary>
+    /// Returns a hash of the content of the cells of this worksheet, that is their values,
+    /// formulae, formats, hyperlinks and comments. Cells without any content are ignored.
+    /// Keeping the fingerprint of a version of a worksheet makes it cheap to tell later whether
+    /// its cells have changed since: a different fingerprint means that they have, while the
+    /// same one means that they almost certainly haven't. Shared strings are hashed by their
+    /// text and formats by their styling, so worksheets of different workbooks can be compared.
+    /// </summary>
+    std::size_t fingerprint() const;
+
+    /// <summary>
+    /// Returns the fingerprints of the cells in each chunk of rows_per_chunk rows, starting
+    /// with row 1, which contains any cells with content, as pairs of the first row of the
+    /// chunk and its fingerprint in the order of the rows. Comparing these between two versions
+    /// of a worksheet narrows down which rows changed. Throws invalid_parameter if
+    /// rows_per_chunk is 0.
+    /// </summary>
+    std::vector<std::pair<row_t, std::size_t>> fingerprints(row_t rows_per_chunk = 1024) const;
+
+    /// <summary>
+    /// Returns the cells whose content differs between older and this worksheet, which may
+    /// belong to different workbooks. The fingerprints of chunks of rows are compared first
+    /// and only the cells of the chunks which differ are compared, by their fingerprints.
+    /// </summary>
+    worksheet_diff diff(const worksheet &older) const;
+
     // page
 
     /// <summary>
@@ -584,6 +792,35 @@ public:
     /// </summary>
     void reserve(std::size_t n);
 
+    /// <summary>
+    /// Writes the values of the cells as CSV to destination, a record per row and a field
+    /// per column of the rectangle from the first to the last cell, formatted as
+    /// csv_options describes by default.
+    /// </summary>
+    void export_csv(std::ostream &destination) const;
+
+    /// <summary>
+    /// Writes the values of the cells as CSV to destination as options describes. The
+    /// compiled number formats are shared with cell::to_string through the workbook, so
+    /// different worksheets can be exported from several threads at once.
+    /// </summary>
+    void export_csv(std::ostream &destination, const csv_options &options) const;
+
+    /// <summary>
+    /// Reads CSV from source into the cells of this worksheet, record by record from row 1
+    /// and field by field from column A, inferring the type of each field. Empty fields
+    /// don't create cells, and cells which exist already are overwritten as by write_block.
+    /// </summary>
+    void import_csv(std::istream &source);
+
+    /// <summary>
+    /// Reads CSV from source into the cells of this worksheet as options describes.
+    /// Quoted fields may contain delimiters, doubled quotes and line breaks. Throws
+    /// invalid_cell_reference if there are more records or fields than a worksheet has
+    /// rows or columns.
+    /// </summary>
+    void import_csv(std::istream &source, const csv_options &options);
+
     /// <summary>
     /// Returns true if this sheet has phonetic properties
     /// </summary>
@@ -767,6 +1004,19 @@ public:
     /// </summary>
     xlnt::conditional_format conditional_format(const range_reference &ref, const condition &when);
 
+    /// <summary>
+    /// Creates a conditional format for each range and condition in rules and returns
+    /// them in the same order.
+    /// </summary>
+    std::vector<xlnt::conditional_format> create_conditional_formats(
+        const std::vector<std::pair<range_reference, condition>> &rules);
+
+    /// <summary>
+    /// Returns the conditional formats of this worksheet whose range contains the cell
+    /// at reference, in the order they were created.
+    /// </summary>
+    std::vector<xlnt::conditional_format> conditional_formats(const cell_reference &reference) const;
+
     /// <summary>
     /// Returns the path of this worksheet in the containing package.
     /// </summary>
@@ -810,7 +1060,10 @@ public:
 
 private:
     friend class cell;
+    friend class cell_iterator;
+    friend class const_cell_iterator;
     friend class const_range_iterator;
+    friend class range;
     friend class range_iterator;
     friend class workbook;
     friend class detail::xlsx_consumer;
@@ -821,6 +1074,22 @@ private:
     /// </summary>
     worksheet(detail::worksheet_impl *d);
 
+    /// <summary>
+    /// Returns the row below the last non-empty cell, see append_rows. Throws
+    /// invalid_cell_reference if that is the last row of the worksheet.
+    /// </summary>
+    row_t next_appended_row() const;
+
+    /// <summary>
+    /// Sets the cell in column and row to value for append_rows, creating it without a handle.
+    /// </summary>
+    void assign_typed(column_t::index_t column, row_t row, std::int64_t value);
+    void assign_typed(column_t::index_t column, row_t row, double value);
+    void assign_typed(column_t::index_t column, row_t row, bool value);
+    void assign_typed(column_t::index_t column, row_t row, const std::string &value);
+    void assign_typed(column_t::index_t column, row_t row, const date &value);
+    void assign_typed(column_t::index_t column, row_t row, const datetime &value);
+
     /// <summary>
     /// Creates a comments part in the manifest as a relationship target of this sheet.
     /// </summary>
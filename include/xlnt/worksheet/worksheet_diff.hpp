@@ -0,0 +1,64 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// The cells which differ between two versions of a worksheet, as returned by
+/// worksheet::diff. Each list is ordered by row and then by column.
+/// </summary>
+class XLNT_API worksheet_diff
+{
+public:
+    /// <summary>
+    /// The cells with content in both versions whose content differs.
+    /// </summary>
+    std::vector<cell_reference> changed;
+
+    /// <summary>
+    /// The cells with content only in the newer version.
+    /// </summary>
+    std::vector<cell_reference> added;
+
+    /// <summary>
+    /// The cells with content only in the older version.
+    /// </summary>
+    std::vector<cell_reference> removed;
+
+    /// <summary>
+    /// Returns true if no cells differ.
+    /// </summary>
+    bool empty() const
+    {
+        return changed.empty() && added.empty() && removed.empty();
+    }
+};
+
+} // namespace xlnt
@@ -57,26 +57,51 @@
 #include <xlnt/utils/date.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/executor.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
+#include <xlnt/utils/typed_row.hpp>
 #include <xlnt/utils/variant.hpp>
 
 // workbook
+#include <xlnt/workbook/byte_sink.hpp>
+#include <xlnt/workbook/byte_source.hpp>
+#include <xlnt/workbook/cell_batch.hpp>
+#include <xlnt/workbook/column_batch.hpp>
+#include <xlnt/workbook/column_schema.hpp>
+#include <xlnt/workbook/column_view.hpp>
+#include <xlnt/workbook/deflated_fragment.hpp>
+#include <xlnt/workbook/encryption_key.hpp>
+#include <xlnt/workbook/io_stats.hpp>
+#include <xlnt/workbook/memory_usage.hpp>
+#include <xlnt/workbook/progress.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
 #include <xlnt/workbook/document_security.hpp>
 #include <xlnt/workbook/external_book.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/workbook/loader.hpp>
+#include <xlnt/workbook/merge_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/row_batch_range.hpp>
+#include <xlnt/workbook/save_options.hpp>
+#include <xlnt/workbook/streaming_sheet_writer.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/streaming_workbook_writer.hpp>
+#include <xlnt/workbook/string_storage.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/workbook/workbook.hpp>
+#include <xlnt/workbook/workbook_summary.hpp>
 #include <xlnt/workbook/worksheet_iterator.hpp>
 
 // worksheet
+#include <xlnt/worksheet/arrow_export.hpp>
+#include <xlnt/worksheet/auto_fit_options.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/cell_vector.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/csv_options.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/major_order.hpp>
 #include <xlnt/worksheet/page_margins.hpp>
@@ -91,3 +116,4 @@
 #include <xlnt/worksheet/sheet_protection.hpp>
 #include <xlnt/worksheet/sheet_view.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
+#include <xlnt/worksheet/worksheet_diff.hpp>
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
 #include <pybind11/pybind11.h>
 
 namespace xlnt {
@@ -31,7 +34,9 @@ class python_streambuf : public std::basic_streambuf<char>
 
     /// The default size of the read and write buffer.
     /** They are respectively used to buffer data read from and data written to
-        the Python file object. It can be modified from Python.
+        the Python file object. It can be modified from Python. Every underflow
+        crosses into Python once, so it is large enough for remote file objects
+        to be read in a few requests, while bounding the memory held per stream.
     */
     static std::size_t default_buffer_size;
 
@@ -46,6 +51,8 @@ class python_streambuf : public std::basic_streambuf<char>
       py_write(python_file_obj.attr("write").cast<pybind11::function>()),
       py_seek(python_file_obj.attr("seek").cast<pybind11::function>()),
       py_tell(python_file_obj.attr("tell").cast<pybind11::function>()),
+      py_readinto(pybind11::hasattr(python_file_obj, "readinto")
+          ? pybind11::object(python_file_obj.attr("readinto")) : pybind11::none()),
       buffer_size(buffer_size_ != 0 ? buffer_size_ : default_buffer_size),
       write_buffer(0),
       pos_of_read_buffer_end_in_py_file(0),
@@ -95,6 +102,15 @@ class python_streambuf : public std::basic_streambuf<char>
     /// Mundane destructor freeing the allocated resources
     virtual ~python_streambuf() {
       if (write_buffer) delete[] write_buffer;
+      // the stream may be destroyed while the GIL is released, so the
+      // references are dropped here while it is held rather than by the members
+      pybind11::gil_scoped_acquire acquire;
+      py_read.release().dec_ref();
+      py_write.release().dec_ref();
+      py_seek.release().dec_ref();
+      py_tell.release().dec_ref();
+      py_readinto.release().dec_ref();
+      read_buffer.release().dec_ref();
     }
 
     /// C.f. C++ standard section 27.5.2.4.3
@@ -110,19 +126,34 @@ class python_streambuf : public std::basic_streambuf<char>
 
     /// C.f. C++ standard section 27.5.2.4.3
     virtual int_type underflow() {
+      // the file object may be read while the GIL is released for decoding
+      pybind11::gil_scoped_acquire acquire;
       int_type const failure = traits_type::eof();
       if (py_read.is_none()) {
         throw std::invalid_argument(
           "That Python file object has no 'read' attribute");
       }
-      read_buffer = py_read(buffer_size).cast<pybind11::bytes>();
       char *read_buffer_data = nullptr;
       Py_ssize_t py_n_read = 0;
-      if (PyBytes_AsStringAndSize(read_buffer.ptr(), &read_buffer_data, &py_n_read) == -1) {
-        setg(0, 0, 0);
-        throw std::invalid_argument(
-          "The method 'read' of the Python file object "
-          "did not return a string.");
+      if (!py_readinto.is_none()) {
+        // readinto fills the same buffer every time instead of making a bytes object
+        read_area.resize(buffer_size);
+        auto view = pybind11::reinterpret_steal<pybind11::object>(PyMemoryView_FromMemory(
+          read_area.data(), static_cast<Py_ssize_t>(read_area.size()), PyBUF_WRITE));
+        if (!view) throw pybind11::error_already_set();
+        auto result = py_readinto(view);
+        // None means that no data is available yet from a non-blocking stream
+        py_n_read = result.is_none() ? 0 : result.cast<Py_ssize_t>();
+        read_buffer_data = read_area.data();
+      }
+      else {
+        read_buffer = py_read(buffer_size).cast<pybind11::bytes>();
+        if (PyBytes_AsStringAndSize(read_buffer.ptr(), &read_buffer_data, &py_n_read) == -1) {
+          setg(0, 0, 0);
+          throw std::invalid_argument(
+            "The method 'read' of the Python file object "
+            "did not return a string.");
+        }
       }
       auto n_read = (off_type)py_n_read;
       pos_of_read_buffer_end_in_py_file += n_read;
@@ -134,17 +165,17 @@ class python_streambuf : public std::basic_streambuf<char>
 
     /// C.f. C++ standard section 27.5.2.4.5
     virtual int_type overflow(int_type c=traits_type_eof()) {
+      pybind11::gil_scoped_acquire acquire;
       if (py_write.is_none()) {
         throw std::invalid_argument(
           "That Python file object has no 'write' attribute");
       }
       farthest_pptr = std::max(farthest_pptr, pptr());
       auto n_written = (off_type)(farthest_pptr - pbase());
-      auto chunk = PyBytes_FromStringAndSize(pbase(), farthest_pptr - pbase());
-      py_write(chunk);
+      py_write(pybind11::bytes(pbase(), static_cast<std::size_t>(farthest_pptr - pbase())));
       if (!traits_type::eq_int_type(c, traits_type::eof())) {
-	      auto ch = traits_type::to_char_type(c);
-        py_write(reinterpret_cast<char *>(&ch), 1);
+        auto ch = traits_type::to_char_type(c);
+        py_write(pybind11::bytes(&ch, 1));
         n_written++;
       }
       if (n_written) {
@@ -165,6 +196,7 @@ class python_streambuf : public std::basic_streambuf<char>
         seek position in that read buffer.
     */
     virtual int sync() {
+      pybind11::gil_scoped_acquire acquire;
       int result = 0;
       farthest_pptr = std::max(farthest_pptr, pptr());
       if (farthest_pptr && farthest_pptr > pbase()) {
@@ -203,6 +235,7 @@ class python_streambuf : public std::basic_streambuf<char>
          in a few places.
       */
       int const failure = off_type(-1);
+      pybind11::gil_scoped_acquire acquire;
 
       if (py_seek.is_none()) {
         throw std::invalid_argument(
@@ -262,9 +295,13 @@ class python_streambuf : public std::basic_streambuf<char>
     pybind11::function py_write;
     pybind11::function py_seek;
     pybind11::function py_tell;
+    pybind11::object py_readinto;
 
     std::size_t buffer_size;
 
+    // the buffer readinto reads into, allocated with the first read
+    std::vector<char> read_area;
+
     /* This is actually a Python string and the actual read buffer is
        its internal data, i.e. an array of characters. We use a Boost.Python
        object so as to hold on it: as a result, the actual buffer can't
@@ -338,6 +375,91 @@ class python_streambuf : public std::basic_streambuf<char>
     }
 };
 
-std::size_t python_streambuf::default_buffer_size = 1024;
+std::size_t python_streambuf::default_buffer_size = 1024 * 1024;
+
+/// A read-only streambuf over memory which it doesn't own, which is seekable
+/// and never needs to refill its buffer.
+class memory_view_streambuf : public std::streambuf
+{
+  public:
+    memory_view_streambuf(const char *data, std::size_t size)
+    {
+      reset(data, size);
+    }
+
+  protected:
+    void reset(const char *data, std::size_t size)
+    {
+      auto begin = const_cast<char *>(data);
+      setg(begin, begin, begin + size);
+    }
+
+    std::streamsize showmanyc() override
+    {
+      return egptr() - gptr();
+    }
+
+    std::streamsize xsgetn(char *s, std::streamsize count) override
+    {
+      const auto n = std::min(count, static_cast<std::streamsize>(egptr() - gptr()));
+      std::memcpy(s, gptr(), static_cast<std::size_t>(n));
+      setg(eback(), gptr() + n, egptr());
+      return n;
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                     std::ios_base::openmode which = std::ios_base::in) override
+    {
+      if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+
+      const auto size = egptr() - eback();
+      auto position = static_cast<off_type>(gptr() - eback());
+      if (way == std::ios_base::beg) position = off;
+      else if (way == std::ios_base::cur) position += off;
+      else position = size + off;
+
+      if (position < 0 || position > size) return pos_type(off_type(-1));
+      setg(eback(), eback() + position, egptr());
+      return pos_type(position);
+    }
+
+    pos_type seekpos(pos_type sp, std::ios_base::openmode which = std::ios_base::in) override
+    {
+      return seekoff(off_type(sp), std::ios_base::beg, which);
+    }
+};
+
+/// A read-only streambuf over the memory of a Python object supporting the buffer
+/// protocol, such as bytes, bytearray, memoryview or mmap, without copying it.
+/// The object is held, and the memory locked, until the streambuf is destroyed.
+class python_buffer_streambuf : public memory_view_streambuf
+{
+  public:
+    explicit python_buffer_streambuf(pybind11::object buffer_obj)
+      : memory_view_streambuf(nullptr, 0)
+    {
+      if (PyObject_GetBuffer(buffer_obj.ptr(), &view, PyBUF_SIMPLE) != 0)
+      {
+        throw pybind11::error_already_set();
+      }
+
+      reset(static_cast<const char *>(view.buf), static_cast<std::size_t>(view.len));
+    }
+
+    ~python_buffer_streambuf() override
+    {
+      pybind11::gil_scoped_acquire acquire;
+      PyBuffer_Release(&view);
+    }
+
+    /// Returns true if obj supports the buffer protocol.
+    static bool supports(pybind11::handle obj)
+    {
+      return PyObject_CheckBuffer(obj.ptr()) != 0;
+    }
+
+  private:
+    Py_buffer view;
+};
 
 } // namespace xlnt
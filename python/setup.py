@@ -2,17 +2,19 @@ import glob
 import os
 import os.path as osp
 import re
+import shlex
 import shutil
 import sys
-
-from distutils.command.clean import clean as _clean
-from distutils import sysconfig
+import sysconfig
 
 from os.path import join as pjoin
 
+# setuptools is imported first so that it provides distutils on Python 3.12 and later
 from setuptools import setup, Extension, Distribution
 from setuptools.command.build_ext import build_ext as _build_ext
 
+from distutils.command.clean import clean as _clean
+
 # Check if we're running 64-bit Python
 is_64_bit = sys.maxsize > 2**32
 
@@ -93,8 +95,8 @@ class build_ext(_build_ext):
 
         if sys.platform != 'win32':
             cmake_options.append('-DCMAKE_INSTALL_PREFIX={0}'
-                                 .format(os.environ['PREFIX']))
-            cmake_command = (['cmake', self.extra_cmake_args] +
+                                 .format(os.environ.get('PREFIX', sys.prefix)))
+            cmake_command = (['cmake'] + shlex.split(self.extra_cmake_args) +
                              cmake_options + [source])
 
             print("-- Runnning cmake for xlntpyarrow")
@@ -113,12 +115,11 @@ class build_ext(_build_ext):
             self.spawn(args)
             print("-- Finished cmake --build for xlntpyarrow")
         else:
-            import shlex
             if not is_64_bit:
                 raise RuntimeError('Not supported on 32-bit Windows')
 
             cmake_options.append('-DCMAKE_INSTALL_PREFIX={0}'
-                                 .format(os.environ['LIBRARY_PREFIX']))
+                                 .format(os.environ.get('LIBRARY_PREFIX', sys.prefix)))
             extra_cmake_args = shlex.split(self.extra_cmake_args)
             cmake_command = (['cmake'] + extra_cmake_args +
                              cmake_options + [source])
@@ -180,19 +181,16 @@ class build_ext(_build_ext):
         package_dir = build_py.get_package_dir('xlntpyarrow')
         # This is the name of the arrow C-extension
         suffix = sysconfig.get_config_var('EXT_SUFFIX')
-        if suffix is None:
-            suffix = sysconfig.get_config_var('SO')
         filename = name + suffix
         return pjoin(package_dir, filename)
 
     def get_ext_built(self, name):
+        # pybind11 names the module with the suffix of extension modules
+        suffix = sysconfig.get_config_var('EXT_SUFFIX')
         if sys.platform == 'win32':
             head, tail = os.path.split(name)
-            suffix = sysconfig.get_config_var('SO')
             return pjoin(head, self.build_type, tail + suffix)
         else:
-            suffix = sysconfig.get_config_var('SO')
-            print('suffix is', suffix)
             return name + suffix
 
     def get_names(self):
@@ -245,6 +243,8 @@ setup(
     url = 'https://github.com/tfussell/xlnt',
     download_url = 'https://github.com/tfussell/xlnt/releases',
     packages = ['xlntpyarrow'],
+    # the module is built against the Arrow shipped with this version of pyarrow
+    install_requires = ['pyarrow==16.1.0', 'numpy'],
     ext_modules = [Extension('xlntpyarrow.lib', [])],
     cmdclass = {
         'clean': clean,
@@ -0,0 +1,91 @@
+import io
+import unittest
+
+import numpy as np
+import pyarrow as pa
+
+import xlntpyarrow
+import xlntpyarrow.lib as xpa
+
+
+def write_sheets(tables):
+    stream = io.BytesIO()
+    writer = xpa.StreamingWorkbookWriter()
+    writer.open(stream)
+    for title, table in tables:
+        writer.write_table(table, title)
+    writer.close()
+    return stream.getvalue()
+
+
+class RoundTripTestCase(unittest.TestCase):
+    def test_arrow2xlsx_xlsx2arrow(self):
+        table = pa.table({
+            'number': pa.array([1.5, 2.0, -3.25, 4.0], pa.float64()),
+            'text': pa.array(['a', 'b', 'c', 'd'], pa.string()),
+        })
+
+        stream = io.BytesIO()
+        xlntpyarrow.arrow2xlsx(table, stream)
+        stream.seek(0)
+        result = xlntpyarrow.xlsx2arrow(stream, 'Sheet1')
+
+        self.assertEqual(result.column_names, ['number', 'text'])
+        self.assertEqual(result.column('number').to_pylist(), [1.5, 2.0, -3.25, 4.0])
+        self.assertEqual(result.column('text').to_pylist(), ['a', 'b', 'c', 'd'])
+
+    def test_dictionary_indices(self):
+        dictionary = pa.array(['x', 'y', 'z'])
+        chunks = [
+            pa.DictionaryArray.from_arrays(pa.array([0, 1], pa.int32()), dictionary),
+            pa.DictionaryArray.from_arrays(pa.array([2, 0], pa.int32()), dictionary),
+        ]
+        table = pa.table({
+            'int32': pa.chunked_array(chunks),
+            'int8': pa.DictionaryArray.from_arrays(pa.array([0, 1, 2, 1], pa.int8()), dictionary),
+            'uint16': pa.DictionaryArray.from_arrays(pa.array([2, 2, None, 0], pa.uint16()), dictionary),
+            'int64': pa.DictionaryArray.from_arrays(pa.array([1, 0, 1, 0], pa.int64()), dictionary),
+        })
+
+        stream = io.BytesIO(write_sheets([('Sheet1', table)]))
+        result = xlntpyarrow.xlsx2arrow(stream, 'Sheet1')
+
+        self.assertEqual(result.column('int32').to_pylist(), ['x', 'y', 'z', 'x'])
+        self.assertEqual(result.column('int8').to_pylist(), ['x', 'y', 'z', 'y'])
+        self.assertEqual(result.column('uint16').to_pylist(), ['z', 'z', None, 'x'])
+        self.assertEqual(result.column('int64').to_pylist(), ['y', 'x', 'y', 'x'])
+
+    def test_read_sheets_parallel(self):
+        first = pa.table({'number': [1.0, 2.0]})
+        second = pa.table({'number': [3.0, 4.0, 5.0]})
+        data = write_sheets([('First', first), ('Second', second)])
+
+        reader = xpa.StreamingWorkbookReader()
+        reader.open(data)
+        schema = pa.schema([('number', pa.float64())])
+        batches = reader.read_sheets_parallel(['First', 'Second'], schema)
+
+        # the header cells aren't numbers
+        self.assertEqual(len(batches), 2)
+        self.assertEqual(batches[0].column(0).to_pylist(), [None, 1.0, 2.0])
+        self.assertEqual(batches[1].column(0).to_pylist(), [None, 3.0, 4.0, 5.0])
+
+    def test_range_to_numpy(self):
+        table = pa.table({
+            'number': pa.array([1.5, None, 3.0], pa.float64()),
+            'text': pa.array(['a', 'b', 'c'], pa.string()),
+        })
+        data = write_sheets([('Sheet1', table)])
+
+        workbook = xpa.Workbook()
+        workbook.load(data)
+        values = workbook.sheet_by_title('Sheet1').range('A1:B4').to_numpy()
+
+        self.assertEqual(values.shape, (4, 2))
+        self.assertEqual(values.dtype, np.float64)
+        np.testing.assert_array_equal(values[:, 0], [np.nan, 1.5, np.nan, 3.0])
+        self.assertTrue(np.isnan(values[:, 1]).all())
+
+
+if __name__ == '__main__':
+    unittest.main()
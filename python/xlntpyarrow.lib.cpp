@@ -22,13 +22,23 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <initializer_list>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <vector>
 #include <arrow/api.h>
 #include <arrow/python/pyarrow.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <xlnt/xlnt.hpp>
+#include <xlnt/workbook/column_batch.hpp>
+#include <xlnt/workbook/column_view.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
+#include <xlnt/workbook/streaming_workbook_writer.hpp>
 #include <python_streambuf.hpp>
 
 void import_pyarrow()
@@ -163,15 +173,24 @@ arrow::ArrayBuilder *make_array_builder(arrow::Type::type type)
     return builder;
 }
 
-void open_file(xlnt::streaming_workbook_reader &reader, pybind11::object file)
+// Returns a streambuf reading file, which is either a file object, read buffer_size
+// bytes at a time, or an object supporting the buffer protocol, read without copying.
+std::unique_ptr<std::streambuf> make_read_streambuf(pybind11::object file, std::size_t buffer_size)
 {
-    reader.open(std::unique_ptr<std::streambuf>(new xlnt::python_streambuf(file)));
+    if (xlnt::python_buffer_streambuf::supports(file))
+    {
+        return std::unique_ptr<std::streambuf>(new xlnt::python_buffer_streambuf(file));
+    }
+
+    return std::unique_ptr<std::streambuf>(new xlnt::python_streambuf(file, buffer_size));
 }
 
-template<typename T>
-T cell_value(xlnt::cell cell)
+void open_file(pybind11::object self, pybind11::object file, std::size_t buffer_size)
 {
-    return static_cast<T>(cell.value<double>());
+    self.cast<xlnt::streaming_workbook_reader &>().open(make_read_streambuf(file, buffer_size));
+
+    // kept for read_sheets_parallel
+    self.attr("_file") = file;
 }
 
 // from https://stackoverflow.com/questions/1659440/32-bit-to-16-bit-floating-point-conversion
@@ -185,230 +204,803 @@ std::uint16_t float_to_half(float f)
     return half;
 }
 
-void append_cell_value(arrow::ArrayBuilder *builder, arrow::Type::type type, xlnt::cell cell)
+// Keeps the column_batch read by read_columns and the validity bitmaps made for it
+// alive while arrays wrapping their memory exist.
+struct column_buffers
 {
-    const status = arrow::Status::OK();
+    xlnt::column_batch batch;
+    std::vector<std::vector<std::uint8_t>> bitmaps;
+};
 
-    switch (type)
+// An arrow::Buffer viewing memory owned by a column_buffers without copying it.
+class column_buffer : public arrow::Buffer
+{
+public:
+    column_buffer(std::shared_ptr<column_buffers> owner, const void *data, std::size_t size)
+        : arrow::Buffer(static_cast<const std::uint8_t *>(data), static_cast<std::int64_t>(size)),
+          owner_(std::move(owner))
     {
-    case arrow::Type::NA:
-        break;
+    }
+
+private:
+    std::shared_ptr<column_buffers> owner_;
+};
+
+void check(const arrow::Status &status)
+{
+    if (!status.ok())
+    {
+        throw xlnt::exception(status.ToString());
+    }
+}
+
+// Returns the value of result, throwing like check(status) if there is none.
+template <typename T>
+T check(arrow::Result<T> result)
+{
+    check(result.status());
+    return result.MoveValueUnsafe();
+}
+
+// Returns a validity bitmap of the cells of column whose type is one of valid_types,
+// keeping it in buffers, and sets null_count to the number of other cells.
+std::shared_ptr<arrow::Buffer> validity_bitmap(std::shared_ptr<column_buffers> buffers,
+    const xlnt::column_batch::column &column,
+    std::initializer_list<xlnt::cell_type> valid_types, std::int64_t &null_count)
+{
+    const auto length = column.types.size();
+    std::vector<std::uint8_t> bitmap((length + 7) / 8, 0);
+    null_count = 0;
+
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        if (std::find(valid_types.begin(), valid_types.end(), column.types[i]) != valid_types.end())
+        {
+            bitmap[i / 8] |= static_cast<std::uint8_t>(1 << (i % 8));
+        }
+        else
+        {
+            ++null_count;
+        }
+    }
+
+    buffers->bitmaps.push_back(std::move(bitmap));
+    const auto &kept = buffers->bitmaps.back();
+
+    return std::make_shared<column_buffer>(buffers, kept.data(), kept.size());
+}
 
+// Returns the workbook's shared strings as the dictionary of shared_string columns.
+// It is built once per reader and kept as an attribute of the Python reader object.
+std::shared_ptr<arrow::Array> shared_string_dictionary(pybind11::object self)
+{
+    if (pybind11::hasattr(self, "_shared_string_dictionary"))
+    {
+        return check(arrow::py::unwrap_array(self.attr("_shared_string_dictionary").ptr()));
+    }
+
+    auto &reader = self.cast<xlnt::streaming_workbook_reader &>();
+    arrow::StringBuilder builder;
+
+    for (std::size_t i = 0; i < reader.shared_string_count(); ++i)
+    {
+        check(builder.Append(reader.shared_string(i).plain_text()));
+    }
+
+    std::shared_ptr<arrow::Array> dictionary;
+    check(builder.Finish(&dictionary));
+    self.attr("_shared_string_dictionary") = pybind11::reinterpret_steal<pybind11::object>(
+        arrow::py::wrap_array(dictionary));
+
+    return dictionary;
+}
+
+template <typename Builder, typename T>
+void append_numbers(arrow::ArrayBuilder *builder, const xlnt::column_batch::column &column)
+{
+    auto typed = static_cast<Builder *>(builder);
+
+    for (std::size_t i = 0; i < column.types.size(); ++i)
+    {
+        const auto type = column.types[i];
+        check(type == xlnt::cell_type::number || type == xlnt::cell_type::date || type == xlnt::cell_type::boolean
+            ? typed->Append(static_cast<T>(column.numbers[i]))
+            : typed->AppendNull());
+    }
+}
+
+template <typename Builder>
+void append_strings(arrow::ArrayBuilder *builder, const xlnt::column_batch::column &column,
+    const xlnt::column_batch &batch, const xlnt::streaming_workbook_reader &reader)
+{
+    auto typed = static_cast<Builder *>(builder);
+
+    for (std::size_t i = 0; i < column.types.size(); ++i)
+    {
+        switch (column.types[i])
+        {
+        case xlnt::cell_type::shared_string:
+            check(typed->Append(reader.shared_string(column.indices[i]).plain_text()));
+            break;
+        case xlnt::cell_type::inline_string:
+        case xlnt::cell_type::formula_string:
+        case xlnt::cell_type::error:
+            check(typed->Append(batch.strings[column.indices[i]]));
+            break;
+        default:
+            check(typed->AppendNull());
+            break;
+        }
+    }
+}
+
+// Builds a column of a type which can't wrap the buffers of the batch.
+std::shared_ptr<arrow::Array> build_column(const std::shared_ptr<arrow::DataType> &type,
+    const xlnt::column_batch::column &column, const xlnt::column_batch &batch,
+    const xlnt::streaming_workbook_reader &reader)
+{
+    std::unique_ptr<arrow::ArrayBuilder> builder(make_array_builder(type->id()));
+
+    switch (type->id())
+    {
     case arrow::Type::BOOL:
-        status = static_cast<arrow::BooleanBuilder *>(builder)
-            ->Append(cell.value<bool>());
+        append_numbers<arrow::BooleanBuilder, bool>(builder.get(), column);
         break;
-
     case arrow::Type::UINT8:
-        status = static_cast<arrow::UInt8Builder *>(builder)
-            ->Append(cell_value<std::uint8_t>(cell));
+        append_numbers<arrow::UInt8Builder, std::uint8_t>(builder.get(), column);
         break;
-
     case arrow::Type::INT8:
-        status = static_cast<arrow::Int8Builder *>(builder)
-          ->Append(cell_value<std::uint8_t>(cell));
+        append_numbers<arrow::Int8Builder, std::int8_t>(builder.get(), column);
         break;
-
     case arrow::Type::UINT16:
-        status = static_cast<arrow::UInt16Builder *>(builder)
-            ->Append(cell_value<std::uint16_t>(cell));
+        append_numbers<arrow::UInt16Builder, std::uint16_t>(builder.get(), column);
         break;
-
     case arrow::Type::INT16:
-        status = static_cast<arrow::Int16Builder *>(builder)
-            ->Append(cell_value<std::int16_t>(cell));
+        append_numbers<arrow::Int16Builder, std::int16_t>(builder.get(), column);
         break;
-
     case arrow::Type::UINT32:
-        status = static_cast<arrow::UInt32Builder *>(builder)
-            ->Append(cell_value<std::uint32_t>(cell));
+        append_numbers<arrow::UInt32Builder, std::uint32_t>(builder.get(), column);
         break;
-
     case arrow::Type::INT32:
-        status = static_cast<arrow::Int32Builder *>(builder)
-            ->Append(cell_value<std::int32_t>(cell));
+        append_numbers<arrow::Int32Builder, std::int32_t>(builder.get(), column);
         break;
-
     case arrow::Type::UINT64:
-        status = static_cast<arrow::UInt64Builder *>(builder)
-            ->Append(cell_value<std::uint64_t>(cell));
+        append_numbers<arrow::UInt64Builder, std::uint64_t>(builder.get(), column);
         break;
-
     case arrow::Type::INT64:
-        status = static_cast<arrow::Int64Builder *>(builder)
-            ->Append(cell_value<std::int64_t>(cell));
+        append_numbers<arrow::Int64Builder, std::int64_t>(builder.get(), column);
         break;
-
-    case arrow::Type::HALF_FLOAT:
-        status = static_cast<arrow::HalfFloatBuilder *>(builder)
-            ->Append(float_to_half(cell_value<float>(cell)));
+    case arrow::Type::HALF_FLOAT: {
+        auto typed = static_cast<arrow::HalfFloatBuilder *>(builder.get());
+        for (std::size_t i = 0; i < column.types.size(); ++i)
+        {
+            const auto cell_type = column.types[i];
+            check(cell_type == xlnt::cell_type::number || cell_type == xlnt::cell_type::date || cell_type == xlnt::cell_type::boolean
+                ? typed->Append(float_to_half(static_cast<float>(column.numbers[i])))
+                : typed->AppendNull());
+        }
         break;
-
+    }
     case arrow::Type::FLOAT:
-        status = static_cast<arrow::FloatBuilder *>(builder)
-            ->Append(cell_value<float>(cell));
+        append_numbers<arrow::FloatBuilder, float>(builder.get(), column);
         break;
-
-    case arrow::Type::DOUBLE:
-        status = static_cast<arrow::DoubleBuilder *>(builder)
-            ->Append(cell_value<double>(cell));
+    case arrow::Type::DATE32:
+        append_numbers<arrow::Date32Builder, arrow::Date32Type::c_type>(builder.get(), column);
+        break;
+    case arrow::Type::DATE64:
+        append_numbers<arrow::Date64Builder, arrow::Date64Type::c_type>(builder.get(), column);
         break;
-
     case arrow::Type::STRING:
-        status = static_cast<arrow::StringBuilder *>(builder)
-            ->Append(cell.value<std::string>());
+        append_strings<arrow::StringBuilder>(builder.get(), column, batch, reader);
         break;
-
     case arrow::Type::BINARY:
-        status = static_cast<arrow::BinaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
+        append_strings<arrow::BinaryBuilder>(builder.get(), column, batch, reader);
         break;
+    default:
+        throw xlnt::exception("not implemented");
+    }
 
-    case arrow::Type::FIXED_SIZE_BINARY:
-        status = static_cast<arrow::FixedSizeBinaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+    std::shared_ptr<arrow::Array> array;
+    check(builder->Finish(&array));
 
-    case arrow::Type::DATE32:
-        status = static_cast<arrow::Date32Builder *>(builder)
-            ->Append(cell_value<arrow::Date32Type::c_type>(cell));
-        break;
+    return array;
+}
 
-    case arrow::Type::DATE64:
-        status = static_cast<arrow::Date64Builder *>(builder)
-            ->Append(cell_value<arrow::Date64Type::c_type>(cell));
-        break;
+// Inserts rows of empty cells into batch for the rows from first_row to the
+// last row of the batch which have no cells.
+void fill_row_gaps(xlnt::column_batch &batch, xlnt::row_t first_row)
+{
+    if (batch.rows.empty() || batch.rows.back() - first_row + 1 == batch.size())
+    {
+        return;
+    }
 
-    case arrow::Type::TIMESTAMP:
-        status = static_cast<arrow::TimestampBuilder *>(builder)
-            ->Append(cell_value<arrow::TimestampType::c_type>(cell));
-        break;
+    const auto length = static_cast<std::size_t>(batch.rows.back() - first_row + 1);
 
-    case arrow::Type::TIME32:
-        status = static_cast<arrow::Time32Builder *>(builder)
-            ->Append(cell_value<arrow::Time32Type::c_type>(cell));
-        break;
+    for (auto &column : batch.columns)
+    {
+        xlnt::column_batch::column spread;
+        spread.index = column.index;
+        spread.types.assign(length, xlnt::cell_type::empty);
+        spread.numbers.assign(length, 0.0);
+        spread.indices.assign(length, 0);
 
-    case arrow::Type::TIME64:
-        status = static_cast<arrow::Time64Builder *>(builder)
-            ->Append(cell_value<arrow::Time64Type::c_type>(cell));
-        break;
-/*
-    case arrow::Type::INTERVAL:
-        status = static_cast<arrow::IntervalBuilder *>(builder)
-            ->Append(cell_value<std::int64_t>(cell));
-        break;
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            const auto row = static_cast<std::size_t>(batch.rows[i] - first_row);
+            spread.types[row] = column.types[i];
+            spread.numbers[row] = column.numbers[i];
+            spread.indices[row] = column.indices[i];
+        }
 
-    case arrow::Type::DECIMAL:
-        status = static_cast<arrow::DecimalBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+        column = std::move(spread);
+    }
 
-    case arrow::Type::LIST:
-        status = static_cast<arrow::ListBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+    batch.rows.resize(length);
 
-    case arrow::Type::STRUCT:
-        status = static_cast<arrow::StructBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        batch.rows[i] = first_row + static_cast<xlnt::row_t>(i);
+    }
+}
 
-    case arrow::Type::UNION:
-        status = static_cast<arrow::UnionBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+// Returns a record batch of the columns in buffers with one column per field of
+// schema, starting at column A. Cells without a value of the field's type are null.
+// DOUBLE columns wrap the number buffer of the batch and DICTIONARY columns the
+// shared string indices, both without copying, with the workbook's shared strings
+// as the dictionary, so DICTIONARY fields must be of type dictionary(uint32(), utf8()).
+// Other types are built from the buffers.
+pybind11::object make_record_batch(pybind11::object self,
+    const std::shared_ptr<arrow::Schema> &schema, std::shared_ptr<column_buffers> buffers)
+{
+    const auto &reader = self.cast<xlnt::streaming_workbook_reader &>();
+    const auto &batch = buffers->batch;
+    const auto length = static_cast<std::int64_t>(batch.size());
 
-    case arrow::Type::DICTIONARY:
-        status = static_cast<arrow::DictionaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
-*/
-    default:
-        throw xlnt::exception("not implemented");
+    auto columns = std::vector<std::shared_ptr<arrow::Array>>();
+
+    for (auto i = 0; i < schema->num_fields(); ++i)
+    {
+        const auto type = schema->field(i)->type();
+        const auto column = batch.find(static_cast<xlnt::column_t::index_t>(i + 1));
+        std::shared_ptr<arrow::Array> array;
+
+        if (column == nullptr)
+        {
+            array = check(arrow::MakeArrayOfNull(type, length));
+        }
+        else if (type->id() == arrow::Type::DOUBLE)
+        {
+            auto null_count = std::int64_t(0);
+            auto validity = validity_bitmap(buffers, *column,
+                {xlnt::cell_type::number, xlnt::cell_type::date, xlnt::cell_type::boolean}, null_count);
+            auto values = std::make_shared<column_buffer>(buffers,
+                column->numbers.data(), column->numbers.size() * sizeof(double));
+            array = arrow::MakeArray(arrow::ArrayData::Make(type, length, {validity, values}, null_count));
+        }
+        else if (type->id() == arrow::Type::DICTIONARY)
+        {
+            auto null_count = std::int64_t(0);
+            auto validity = validity_bitmap(buffers, *column, {xlnt::cell_type::shared_string}, null_count);
+            auto values = std::make_shared<column_buffer>(buffers,
+                column->indices.data(), column->indices.size() * sizeof(std::uint32_t));
+            auto indices = arrow::MakeArray(arrow::ArrayData::Make(arrow::uint32(), length, {validity, values}, null_count));
+            array = check(arrow::DictionaryArray::FromArrays(type, indices, shared_string_dictionary(self)));
+        }
+        else
+        {
+            array = build_column(type, *column, batch, reader);
+        }
+
+        columns.emplace_back(array);
     }
 
-    if (status != arrow::Status::OK())
+    auto batch_pointer = arrow::RecordBatch::Make(schema, length, columns);
+
+    // wrap_record_batch returns a new reference, which the object takes over
+    auto wrapped = pybind11::reinterpret_steal<pybind11::object>(arrow::py::wrap_record_batch(batch_pointer));
+
+    if (!wrapped)
     {
-        throw xlnt::exception("Append failed");
+        throw pybind11::error_already_set();
     }
+
+    return wrapped;
 }
 
-pybind11::handle read_batch(xlnt::streaming_workbook_reader &reader,
-    pybind11::object pyschema, int max_rows)
+// Reads up to max_rows rows which have cells into a record batch, see make_record_batch.
+// The values are decoded straight into column buffers without creating a cell for
+// each of them. Rows without any cells are left out.
+pybind11::object read_columns(pybind11::object self, pybind11::object pyschema, int max_rows)
 {
     import_pyarrow();
 
-    std::shared_ptr<arrow::Schema> schema;
-    arrow::py::unwrap_schema(pyschema.ptr(), &schema);
+    const auto schema = check(arrow::py::unwrap_schema(pyschema.ptr()));
 
-    std::vector<arrow::Type::type> column_types;
+    auto buffers = std::make_shared<column_buffers>();
+    auto &reader = self.cast<xlnt::streaming_workbook_reader &>();
 
-    for (auto i = 0; i < schema->num_fields(); ++i)
     {
-        column_types.push_back(schema->field(i)->type()->id());
+        pybind11::gil_scoped_release release;
+        reader.read_columns(buffers->batch, static_cast<std::size_t>(std::max(max_rows, 0)));
+    }
+
+    return make_record_batch(self, schema, buffers);
+}
+
+// Like read_columns, but the cells of sparse sheets are kept in the rows they are in:
+// rows without any cells between the rows read, and since the last row of the previous
+// batch, become rows of nulls.
+pybind11::object read_batch(pybind11::object self, pybind11::object pyschema, int max_rows)
+{
+    import_pyarrow();
+
+    const auto schema = check(arrow::py::unwrap_schema(pyschema.ptr()));
+
+    auto buffers = std::make_shared<column_buffers>();
+    auto &batch = buffers->batch;
+    auto &reader = self.cast<xlnt::streaming_workbook_reader &>();
+
+    {
+        pybind11::gil_scoped_release release;
+        reader.read_columns(batch, static_cast<std::size_t>(std::max(max_rows, 0)));
+    }
+
+    if (!batch.rows.empty())
+    {
+        auto first_row = batch.rows.front();
+
+        if (pybind11::hasattr(self, "_next_row"))
+        {
+            first_row = std::min(first_row, self.attr("_next_row").cast<xlnt::row_t>());
+        }
+
+        fill_row_gaps(batch, first_row);
+        self.attr("_next_row") = pybind11::cast(batch.rows.back() + 1);
+    }
+
+    return make_record_batch(self, schema, buffers);
+}
+
+// Reads each of the worksheets with the given titles into one record batch, see
+// read_batch, decoding them concurrently without holding the GIL. The file the reader
+// was opened with is read into memory once and every thread reads its worksheets
+// through a reader of its own, so the position of this reader is unaffected.
+pybind11::list read_sheets_parallel(pybind11::object self,
+    const std::vector<std::string> &titles, pybind11::object pyschema)
+{
+    import_pyarrow();
+
+    const auto schema = check(arrow::py::unwrap_schema(pyschema.ptr()));
+
+    if (!pybind11::hasattr(self, "_file"))
+    {
+        throw xlnt::exception("reader is not open");
+    }
+
+    // the workbook is read from memory by every thread, straight from the memory
+    // of objects supporting the buffer protocol and otherwise read into it once
+    auto file = self.attr("_file");
+    auto bytes = std::string();
+    auto buffer = pybind11::buffer_info();
+    const char *data = nullptr;
+    auto size = std::size_t(0);
+
+    if (xlnt::python_buffer_streambuf::supports(file))
+    {
+        buffer = pybind11::reinterpret_borrow<pybind11::buffer>(file).request();
+        data = static_cast<const char *>(buffer.ptr);
+        size = static_cast<std::size_t>(buffer.size * buffer.itemsize);
+    }
+    else
+    {
+        auto position = file.attr("tell")();
+        file.attr("seek")(0);
+        bytes = file.attr("read")().cast<std::string>();
+        file.attr("seek")(position);
+        data = bytes.data();
+        size = bytes.size();
+    }
+
+    auto sheets = std::vector<std::shared_ptr<column_buffers>>(titles.size());
+    auto errors = std::vector<std::exception_ptr>(titles.size());
+
+    {
+        pybind11::gil_scoped_release release;
+
+        const auto executor = xlnt::current_executor();
+        const auto thread_count = std::min(titles.size(), executor->concurrency());
+        std::atomic<std::size_t> next_sheet(0);
+
+        auto read_sheets = [&]() {
+            for (auto i = next_sheet++; i < titles.size(); i = next_sheet++)
+            {
+                try
+                {
+                    auto buffers = std::make_shared<column_buffers>();
+                    auto &batch = buffers->batch;
+
+                    xlnt::streaming_workbook_reader reader;
+                    reader.open(std::unique_ptr<std::streambuf>(new xlnt::memory_view_streambuf(data, size)));
+                    reader.begin_worksheet(titles[i]);
+                    reader.read_columns(batch, std::numeric_limits<std::size_t>::max());
+                    reader.end_worksheet();
+
+                    if (!batch.rows.empty())
+                    {
+                        fill_row_gaps(batch, batch.rows.front());
+                    }
+
+                    sheets[i] = buffers;
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        executor->run(thread_count, read_sheets);
+    }
+
+    for (auto &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    auto batches = pybind11::list();
+
+    for (auto &sheet : sheets)
+    {
+        batches.append(make_record_batch(self, schema, sheet));
+    }
+
+    return batches;
+}
+
+void begin_worksheet(pybind11::object self, const std::string &name)
+{
+    self.cast<xlnt::streaming_workbook_reader &>().begin_worksheet(name);
+
+    // the rows of read_batch start over in every worksheet
+    if (pybind11::hasattr(self, "_next_row"))
+    {
+        pybind11::delattr(self, "_next_row");
     }
+}
+
+void open_writer_file(xlnt::streaming_workbook_writer &writer, pybind11::object file, std::size_t buffer_size)
+{
+    writer.open(std::unique_ptr<std::streambuf>(new xlnt::python_streambuf(file, buffer_size)));
+}
+
+// Returns the validity bitmap of array for a column_view, or nullptr without nulls.
+const std::uint8_t *validity_of(const arrow::ArrayData &array)
+{
+    return array.null_count != 0 && array.buffers[0] ? array.buffers[0]->data() : nullptr;
+}
 
-    auto builders = std::vector<std::unique_ptr<arrow::ArrayBuilder>>();
+// Copies the values of a numeric array to doubles at the same positions, for types
+// column_view can't take directly.
+template <typename T>
+void copy_to_doubles(const arrow::ArrayData &array, std::vector<double> &doubles)
+{
+    const auto values = array.GetValues<T>(1, 0);
+    doubles.assign(static_cast<std::size_t>(array.offset + array.length), 0.0);
 
-    for (auto type : column_types)
+    for (auto i = array.offset; i < array.offset + array.length; ++i)
     {
-        builders.emplace_back(make_array_builder(type));
+        doubles[static_cast<std::size_t>(i)] = static_cast<double>(values[i]);
     }
+}
 
-    auto row = std::int64_t(0);
+// Copies the dictionary indices of array, of any integer type, to the int32 indices
+// column_view takes. Indices which don't fit become -1, which the writer rejects for
+// cells which aren't null.
+template <typename T>
+void widen_indices(const arrow::ArrayData &array, std::vector<std::int32_t> &widened)
+{
+    const auto values = array.GetValues<T>(1, 0);
+    widened.assign(static_cast<std::size_t>(array.offset + array.length), 0);
 
-    while (row < max_rows)
+    for (auto i = array.offset; i < array.offset + array.length; ++i)
+    {
+        // negative indices become too large as well
+        const auto index = static_cast<std::uint64_t>(values[i]);
+        widened[static_cast<std::size_t>(i)] = index <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())
+            ? static_cast<std::int32_t>(index)
+            : -1;
+    }
+}
+
+// Writes table to a new worksheet called sheet_title: a header row with the field
+// names, followed by the rows of the table starting in column A. The values are
+// written straight from the Arrow buffers of each record batch without the GIL.
+// Strings are written inline from their offset buffers and the dictionaries of
+// dictionary arrays are added to the shared strings once each, so their indices
+// map straight to shared strings.
+void write_table(xlnt::streaming_workbook_writer &writer, pybind11::object pytable,
+    const std::string &sheet_title)
+{
+    import_pyarrow();
+
+    const auto table = check(arrow::py::unwrap_table(pytable.ptr()));
+
+    writer.add_worksheet(sheet_title);
+
+    auto names = std::vector<std::string>();
+
+    for (auto i = 0; i < table->num_columns(); ++i)
+    {
+        names.push_back(table->schema()->field(i)->name());
+    }
+
+    writer.append_row(names);
+
+    // the shared string indices of each dictionary, which chunks usually share. Dictionaries
+    // are told apart by their data, which the table owns, rather than by the Array wrapping
+    // it, which is made again for every batch. The data is kept so that its address can't
+    // be reused by another dictionary while the table is written.
+    struct shared_dictionary
+    {
+        std::shared_ptr<arrow::ArrayData> data;
+        std::vector<std::uint32_t> ids;
+    };
+    auto dictionaries = std::unordered_map<const arrow::ArrayData *, shared_dictionary>();
+    arrow::TableBatchReader batches(*table);
+    std::shared_ptr<arrow::RecordBatch> batch;
+
+    for (check(batches.ReadNext(&batch)); batch != nullptr; check(batches.ReadNext(&batch)))
     {
-        if (!reader.has_cell()) break;
+        auto columns = std::vector<xlnt::column_view>();
+        auto converted = std::list<std::vector<double>>();
+        auto converted_indices = std::list<std::vector<std::int32_t>>();
 
-        for (auto column = 0; column < schema->num_fields(); ++column)
+        for (auto i = 0; i < batch->num_columns(); ++i)
         {
-            if (!reader.has_cell()) break;
+            const auto array = batch->column(i);
+            const auto &data = *array->data();
 
-            auto cell = reader.read_cell();
-            auto zero_indexed_column = cell.column().index - 1;
-            auto column_type = column_types.at(zero_indexed_column);
-            auto builder = builders.at(zero_indexed_column).get();
+            xlnt::column_view column;
+            column.index = static_cast<xlnt::column_t::index_t>(i + 1);
+            column.validity = validity_of(data);
+            column.offset = data.offset;
 
-            append_cell_value(builder, column_type, cell);
+            switch (array->type_id())
+            {
+            case arrow::Type::NA:
+                continue;
+            case arrow::Type::DOUBLE:
+                column.doubles = data.GetValues<double>(1, 0);
+                break;
+            case arrow::Type::INT64:
+                column.kind = xlnt::column_view::value_kind::integers;
+                column.integers = data.GetValues<std::int64_t>(1, 0);
+                break;
+            case arrow::Type::FLOAT:
+                converted.emplace_back();
+                copy_to_doubles<float>(data, converted.back());
+                column.doubles = converted.back().data();
+                break;
+            case arrow::Type::INT8:
+            case arrow::Type::INT16:
+            case arrow::Type::INT32:
+            case arrow::Type::UINT8:
+            case arrow::Type::UINT16:
+            case arrow::Type::UINT32:
+            case arrow::Type::UINT64: {
+                converted.emplace_back();
+                auto &doubles = converted.back();
+                switch (array->type_id())
+                {
+                case arrow::Type::INT8: copy_to_doubles<std::int8_t>(data, doubles); break;
+                case arrow::Type::INT16: copy_to_doubles<std::int16_t>(data, doubles); break;
+                case arrow::Type::INT32: copy_to_doubles<std::int32_t>(data, doubles); break;
+                case arrow::Type::UINT8: copy_to_doubles<std::uint8_t>(data, doubles); break;
+                case arrow::Type::UINT16: copy_to_doubles<std::uint16_t>(data, doubles); break;
+                case arrow::Type::UINT32: copy_to_doubles<std::uint32_t>(data, doubles); break;
+                default: copy_to_doubles<std::uint64_t>(data, doubles); break;
+                }
+                column.doubles = doubles.data();
+                break;
+            }
+            case arrow::Type::BOOL:
+                column.kind = xlnt::column_view::value_kind::booleans;
+                column.booleans = data.buffers[1]->data();
+                break;
+            case arrow::Type::STRING:
+                column.kind = xlnt::column_view::value_kind::strings;
+                column.offsets = data.GetValues<std::int32_t>(1, 0);
+                column.characters = data.buffers[2] ? reinterpret_cast<const char *>(data.buffers[2]->data()) : "";
+                break;
+            case arrow::Type::DICTIONARY: {
+                const auto &dictionary_array = static_cast<const arrow::DictionaryArray &>(*array);
+                const auto dictionary = dictionary_array.dictionary();
+
+                if (dictionary->type_id() != arrow::Type::STRING)
+                {
+                    throw xlnt::exception("not implemented");
+                }
+
+                const auto &dictionary_data = dictionary_array.data()->dictionary;
+                auto &shared = dictionaries[dictionary_data.get()];
+                auto &ids = shared.ids;
+
+                if (!shared.data)
+                {
+                    shared.data = dictionary_data;
+                    const auto &strings = static_cast<const arrow::StringArray &>(*dictionary);
+
+                    for (auto j = std::int64_t(0); j < strings.length(); ++j)
+                    {
+                        ids.push_back(static_cast<std::uint32_t>(writer.add_shared_string(strings.GetString(j))));
+                    }
+                }
+
+                const auto &indices = *dictionary_array.indices()->data();
+                column.kind = xlnt::column_view::value_kind::shared_strings;
+                column.dictionary = ids.data();
+                column.dictionary_size = ids.size();
+                column.validity = validity_of(indices);
+                column.offset = indices.offset;
+
+                if (indices.type->id() == arrow::Type::INT32)
+                {
+                    column.indices = indices.GetValues<std::int32_t>(1, 0);
+                    break;
+                }
+
+                converted_indices.emplace_back();
+                auto &widened = converted_indices.back();
+
+                switch (indices.type->id())
+                {
+                case arrow::Type::INT8: widen_indices<std::int8_t>(indices, widened); break;
+                case arrow::Type::INT16: widen_indices<std::int16_t>(indices, widened); break;
+                case arrow::Type::INT64: widen_indices<std::int64_t>(indices, widened); break;
+                case arrow::Type::UINT8: widen_indices<std::uint8_t>(indices, widened); break;
+                case arrow::Type::UINT16: widen_indices<std::uint16_t>(indices, widened); break;
+                case arrow::Type::UINT32: widen_indices<std::uint32_t>(indices, widened); break;
+                case arrow::Type::UINT64: widen_indices<std::uint64_t>(indices, widened); break;
+                default: throw xlnt::exception("not implemented");
+                }
+
+                column.indices = widened.data();
+                break;
+            }
+            default:
+                throw xlnt::exception("not implemented");
+            }
+
+            columns.push_back(column);
         }
 
-        ++row;
+        pybind11::gil_scoped_release release;
+        writer.append_rows(static_cast<std::size_t>(batch->num_rows()), columns);
     }
+}
 
-    auto columns = std::vector<std::shared_ptr<arrow::Array>>();
+// The numbers of a range, row by row, which NumPy wraps through the buffer protocol.
+struct numeric_block
+{
+    std::vector<double> values;
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+};
+
+// Returns a two-dimensional float64 array of the numbers in range with NaN for empty
+// and non-numeric cells. The block is filled without the GIL and the array views it
+// without copying.
+pybind11::object range_to_numpy(const xlnt::range &range)
+{
+    const auto reference = range.reference();
+    auto block = numeric_block();
+    block.rows = reference.height();
+    block.columns = reference.width();
+    block.values.resize(block.rows * block.columns);
 
-    for (auto &builder : builders)
     {
-        std::shared_ptr<arrow::Array> column;
-        builder->Finish(&column);
-        columns.emplace_back(column);
+        pybind11::gil_scoped_release release;
+        range.target_worksheet().read_block(reference, block.values.data());
     }
 
-    auto batch_pointer = std::make_shared<arrow::RecordBatch>(schema, row, columns);
-    auto batch_object = arrow::py::wrap_record_batch(batch_pointer);
-    auto batch_handle = pybind11::handle(batch_object); // don't need to incr. reference count, right?
+    return pybind11::module::import("numpy").attr("asarray")(pybind11::cast(std::move(block)));
+}
+
+void load_workbook(xlnt::workbook &workbook, pybind11::object file)
+{
+    if (pybind11::isinstance<pybind11::str>(file))
+    {
+        const auto filename = file.cast<std::string>();
+        pybind11::gil_scoped_release release;
+        workbook.load(filename);
+
+        return;
+    }
 
-    return batch_handle;
+    auto buffer = make_read_streambuf(file, 0);
+    std::istream stream(buffer.get());
+    workbook.load(stream);
 }
 
 PYBIND11_MODULE(lib, m)
 {
     m.doc() = "streaming read/write interface for C++ XLSX library xlnt";
 
-    pybind11::class_<xlnt::streaming_workbook_reader>(m, "StreamingWorkbookReader")
+    m.def("default_buffer_size", []()
+        {
+            return xlnt::python_streambuf::default_buffer_size;
+        });
+    m.def("set_default_buffer_size", [](std::size_t size)
+        {
+            if (size == 0)
+            {
+                throw xlnt::invalid_parameter();
+            }
+
+            xlnt::python_streambuf::default_buffer_size = size;
+        });
+
+    pybind11::class_<xlnt::streaming_workbook_reader>(m, "StreamingWorkbookReader", pybind11::dynamic_attr())
         .def(pybind11::init<>())
         .def("has_cell", &xlnt::streaming_workbook_reader::has_cell)
         .def("read_cell", &xlnt::streaming_workbook_reader::read_cell)
         .def("has_worksheet", &xlnt::streaming_workbook_reader::has_worksheet)
-        .def("begin_worksheet", &xlnt::streaming_workbook_reader::begin_worksheet)
+        .def("begin_worksheet", &begin_worksheet)
         .def("end_worksheet", &xlnt::streaming_workbook_reader::end_worksheet)
         .def("sheet_titles", &xlnt::streaming_workbook_reader::sheet_titles)
-        .def("open", &open_file)
-        .def("read_batch", &read_batch);
+        .def("open", &open_file, pybind11::arg("file"), pybind11::arg("buffer_size") = 0)
+        .def("read_batch", &read_batch)
+        .def("read_columns", &read_columns)
+        .def("read_sheets_parallel", &read_sheets_parallel);
+
+    pybind11::class_<xlnt::streaming_workbook_writer>(m, "StreamingWorkbookWriter")
+        .def(pybind11::init<>())
+        .def("open", &open_writer_file, pybind11::arg("file"), pybind11::arg("buffer_size") = 0)
+        .def("write_table", &write_table)
+        .def("close", [](xlnt::streaming_workbook_writer &writer)
+            {
+                pybind11::gil_scoped_release release;
+                writer.close();
+            });
+
+    pybind11::class_<numeric_block>(m, "NumericBlock", pybind11::buffer_protocol())
+        .def_buffer([](numeric_block &block)
+            {
+                return pybind11::buffer_info(block.values.data(), sizeof(double),
+                    pybind11::format_descriptor<double>::format(), 2,
+                    {block.rows, block.columns},
+                    {block.columns * sizeof(double), sizeof(double)});
+            });
+
+    pybind11::class_<xlnt::workbook>(m, "Workbook")
+        .def(pybind11::init<>())
+        .def("load", &load_workbook, pybind11::arg("file"))
+        .def("sheet_titles", &xlnt::workbook::sheet_titles)
+        .def("active_sheet", [](xlnt::workbook &workbook)
+            {
+                return workbook.active_sheet();
+            }, pybind11::keep_alive<0, 1>())
+        .def("sheet_by_title", [](xlnt::workbook &workbook, const std::string &title)
+            {
+                return workbook.sheet_by_title(title);
+            }, pybind11::keep_alive<0, 1>());
+
+    pybind11::class_<xlnt::worksheet>(m, "Worksheet")
+        .def("title", [](xlnt::worksheet &worksheet)
+            {
+                return worksheet.title();
+            })
+        .def("range", [](xlnt::worksheet &worksheet, const std::string &reference)
+            {
+                return worksheet.range(reference);
+            }, pybind11::keep_alive<0, 1>());
 
-    pybind11::class_<xlnt::worksheet>(m, "Worksheet");
+    pybind11::class_<xlnt::range>(m, "Range")
+        .def("to_numpy", &range_to_numpy);
 
     pybind11::class_<xlnt::cell> cell(m, "Cell");
     cell.def("value_string", [](xlnt::cell &cell)
@@ -64,13 +64,12 @@ def xlsx2arrow(io, sheetname):
             elif cell.row() == 2:
                 column_name = column_names[cell.column() - 1]
                 if type == xpa.Cell.Type.Number and cell.format_is_date():
-                    fields.append(pa.field(column_name, pa.date32))
+                    fields.append(pa.field(column_name, pa.date32()))
                 else:
                     fields.append(pa.field(column_name, COLUMN_TYPE_FIELD[type]()))
                 first_batch.append(cell_to_pyarrow_array(cell, fields[-1].type))
                 if cell.column() == max_column:
                     schema = pa.schema(fields)
-                    print(schema)
                     batches.append(pa.RecordBatch.from_arrays(first_batch, column_names))
                 continue
 
@@ -80,6 +79,12 @@ def xlsx2arrow(io, sheetname):
 
     return pa.Table.from_batches(batches)
 
+def arrow2xlsx(table, io, sheetname='Sheet1'):
+    writer = xpa.StreamingWorkbookWriter()
+    writer.open(io)
+    writer.write_table(table, sheetname)
+    writer.close()
+
 if __name__ == '__main__':
     file = open('tmp.xlsx', 'rb')
     table = xlsx2arrow(file, 'Sheet1')
@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
@@ -48,6 +49,7 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
+#include <xlnt/workbook/string_storage.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
 #include <xlnt/worksheet/phonetic_pr.hpp>
@@ -57,11 +59,32 @@
 #include <detail/implementations/format_impl.hpp>
 #include <detail/implementations/hyperlink_impl.hpp>
 #include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
 
 namespace {
 
+// max string length in Excel
+const std::size_t max_string_length = 32767;
+
+// Throws if the first max_string_length bytes of s contain a control character Excel doesn't allow.
+void check_characters(const std::string &s)
+{
+    const auto end = s.begin() + static_cast<std::ptrdiff_t>(std::min(s.size(), max_string_length));
+
+    for (auto it = s.begin(); it != end; ++it)
+    {
+        const char c = *it;
+
+        if (c >= 0 && (c <= 8 || c == 11 || c == 12 || (c >= 14 && c <= 31)))
+        {
+            throw xlnt::illegal_character(c);
+        }
+    }
+}
+
 std::pair<bool, double> cast_numeric(const std::string &s)
 {
     size_t len_convert = 0;
@@ -148,6 +171,15 @@ std::pair<bool, xlnt::time> cast_time(const std::string &s)
     return {true, result};
 }
 
+// Records that impl may have become garbage collectible, see worksheet::garbage_collect.
+void mark_collectible(xlnt::detail::cell_impl &impl)
+{
+    if (impl.parent_ != nullptr)
+    {
+        impl.parent_->cell_map_.collected(false);
+    }
+}
+
 } // namespace
 
 namespace xlnt {
@@ -168,27 +200,21 @@ const std::unordered_map<std::string, int> &cell::error_codes()
 
 std::string cell::check_string(const std::string &to_check)
 {
-    // so we can modify it
-    std::string s = to_check;
+    check_characters(to_check);
 
-    if (s.size() == 0)
-    {
-        return s;
-    }
-    else if (s.size() > 32767)
-    {
-        s = s.substr(0, 32767); // max string length in Excel
-    }
+    return to_check.size() > max_string_length ? to_check.substr(0, max_string_length) : to_check;
+}
+
+std::string cell::check_string(std::string &&to_check)
+{
+    check_characters(to_check);
 
-    for (char c : s)
+    if (to_check.size() > max_string_length)
     {
-        if (c >= 0 && (c <= 8 || c == 11 || c == 12 || (c >= 14 && c <= 31)))
-        {
-            throw illegal_character(c);
-        }
+        to_check.resize(max_string_length);
     }
 
-    return s;
+    return std::move(to_check);
 }
 
 cell::cell(detail::cell_impl *d)
@@ -209,56 +235,87 @@ void cell::value(std::nullptr_t)
 void cell::value(bool boolean_value)
 {
     d_->type_ = type::boolean;
-    d_->value_numeric_ = boolean_value ? 1.0 : 0.0;
+    d_->value_number(boolean_value ? 1.0 : 0.0);
 }
 
 void cell::value(int int_value)
 {
-    d_->value_numeric_ = static_cast<double>(int_value);
+    d_->value_integer(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned int int_value)
 {
-    d_->value_numeric_ = static_cast<double>(int_value);
+    d_->value_integer(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(long long int int_value)
 {
-    d_->value_numeric_ = static_cast<double>(int_value);
+    d_->value_integer(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned long long int int_value)
 {
-    d_->value_numeric_ = static_cast<double>(int_value);
+    if (int_value <= static_cast<unsigned long long>(std::numeric_limits<std::int64_t>::max()))
+    {
+        d_->value_integer(static_cast<std::int64_t>(int_value));
+    }
+    else
+    {
+        d_->value_number(static_cast<double>(int_value));
+    }
+
     d_->type_ = type::number;
 }
 
 void cell::value(float float_value)
 {
-    d_->value_numeric_ = static_cast<double>(float_value);
+    d_->value_number(static_cast<double>(float_value));
     d_->type_ = type::number;
 }
 
 void cell::value(double float_value)
 {
-    d_->value_numeric_ = static_cast<double>(float_value);
+    d_->value_number(static_cast<double>(float_value));
     d_->type_ = type::number;
 }
 
 void cell::value(const std::string &s)
 {
-    value(rich_text(check_string(s)));
+    value(std::string(s));
+}
+
+void cell::value(std::string &&s)
+{
+    // checked once here and then moved along, so this doesn't go through value(const rich_text &)
+    auto text = rich_text(check_string(std::move(s)));
+
+    if (has_formula())
+    {
+        d_->extension().value_text_ = std::move(text);
+        d_->type_ = type::formula_string;
+        return;
+    }
+
+    if (d_->parent_->workbook_->string_storage_ == string_storage::inline_string)
+    {
+        d_->extension().value_text_ = std::move(text);
+        d_->type_ = type::inline_string;
+        return;
+    }
+
+    d_->type_ = type::shared_string;
+    d_->value_number(static_cast<double>(workbook().add_shared_string(std::move(text))));
 }
 
 void cell::value(const rich_text &text)
 {
-    check_string(text.plain_text());
+    check_characters(text.plain_text());
 
     d_->type_ = type::shared_string;
-    d_->value_numeric_ = static_cast<double>(workbook().add_shared_string(text));
+    d_->value_number(static_cast<double>(workbook().add_shared_string(text)));
 }
 
 void cell::value(const char *c)
@@ -269,38 +326,46 @@ void cell::value(const char *c)
 void cell::value(const cell c)
 {
     d_->type_ = c.d_->type_;
-    d_->value_numeric_ = c.d_->value_numeric_;
-    d_->value_text_ = c.d_->value_text_;
-    d_->hyperlink_ = c.d_->hyperlink_;
-    d_->formula_ = c.d_->formula_;
+    d_->value_integer_ = c.d_->value_integer_;
+    d_->value_integral_ = c.d_->value_integral_;
+    if (c.d_->extension_ || d_->extension_ || c.d_->formula_group_ != 0 || d_->formula_group_ != 0)
+    {
+        auto &extension = d_->extension();
+        extension.value_text_ = c.d_->value_text();
+        extension.hyperlink_.reset(c.d_->hyperlink() ? new detail::hyperlink_impl(*c.d_->hyperlink()) : nullptr);
+        // the formula group of c may belong to another worksheet, so its text is copied
+        extension.formula_ = c.d_->formula();
+        d_->formula_group_ = 0;
+    }
     d_->format_ = c.d_->format_;
+    mark_collectible(*d_);
 }
 
 void cell::value(const date &d)
 {
     d_->type_ = type::number;
-    d_->value_numeric_ = d.to_number(base_date());
+    d_->value_number(d.to_number(base_date()));
     number_format(number_format::date_yyyymmdd2());
 }
 
 void cell::value(const datetime &d)
 {
     d_->type_ = type::number;
-    d_->value_numeric_ = d.to_number(base_date());
+    d_->value_number(d.to_number(base_date()));
     number_format(number_format::date_datetime());
 }
 
 void cell::value(const time &t)
 {
     d_->type_ = type::number;
-    d_->value_numeric_ = t.to_number();
+    d_->value_number(t.to_number());
     number_format(number_format::date_time6());
 }
 
 void cell::value(const timedelta &t)
 {
     d_->type_ = type::number;
-    d_->value_numeric_ = t.to_number();
+    d_->value_number(t.to_number());
     number_format(xlnt::number_format("[hh]:mm:ss"));
 }
 
@@ -322,6 +387,7 @@ column_t::index_t cell::column_index() const
 void cell::merged(bool merged)
 {
     d_->is_merged_ = merged;
+    mark_collectible(*d_);
 }
 
 bool cell::is_merged() const
@@ -337,13 +403,14 @@ bool cell::phonetics_visible() const
 void cell::show_phonetics(bool phonetics)
 {
     d_->phonetics_visible_ = phonetics;
+    mark_collectible(*d_);
 }
 
 bool cell::is_date() const
 {
     return data_type() == type::number
         && has_format()
-        && number_format().is_date_format();
+        && d_->format_.get()->date_format;
 }
 
 cell_reference cell::reference() const
@@ -377,7 +444,12 @@ cell &cell::operator=(const cell &rhs) = default;
 
 hyperlink cell::hyperlink() const
 {
-    return xlnt::hyperlink(&d_->hyperlink_.get());
+    if (d_->hyperlink() == nullptr)
+    {
+        throw invalid_attribute();
+    }
+
+    return xlnt::hyperlink(d_->hyperlink());
 }
 
 void cell::hyperlink(const std::string &url, const std::string &display)
@@ -390,34 +462,29 @@ void cell::hyperlink(const std::string &url, const std::string &display)
     auto ws = worksheet();
     auto &manifest = ws.workbook().manifest();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
+    d_->extension().hyperlink_.reset(new detail::hyperlink_impl());
 
-    // check for existing relationships
-    auto relationships = manifest.relationships(ws.path(), relationship_type::hyperlink);
-    auto relation = std::find_if(relationships.cbegin(), relationships.cend(),
-        [&url](xlnt::relationship rel) { return rel.target().path().string() == url; });
-    if (relation != relationships.end())
-    {
-        d_->hyperlink_.get().relationship = *relation;
-    }
-    else
+    // reuse an existing relationship to the same url
+    const auto ws_path = ws.path();
+    auto rel_id = manifest.relationship_id(ws_path, relationship_type::hyperlink, url);
+    if (rel_id.empty())
     { // register a new relationship
-        auto rel_id = manifest.register_relationship(
-            uri(ws.path().string()),
+        rel_id = manifest.register_relationship(
+            uri(ws_path.string()),
             relationship_type::hyperlink,
             uri(url),
             target_mode::external);
-        // TODO: make manifest::register_relationship return the created relationship instead of rel id
-        d_->hyperlink_.get().relationship = manifest.relationship(ws.path(), rel_id);
     }
+    // TODO: make manifest::register_relationship return the created relationship instead of rel id
+    d_->hyperlink()->relationship = manifest.relationship(ws_path, rel_id);
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        d_->hyperlink()->display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? url : display);
+        d_->hyperlink()->display.set(display.empty() ? url : display);
         value(hyperlink().display());
     }
 }
@@ -427,17 +494,17 @@ void cell::hyperlink(xlnt::cell target, const std::string &display)
     // TODO: should this computed value be a method on a cell?
     const auto cell_address = target.worksheet().title() + "!" + target.reference().to_string();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
-    d_->hyperlink_.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
+    d_->extension().hyperlink_.reset(new detail::hyperlink_impl());
+    d_->hyperlink()->relationship = xlnt::relationship("", relationship_type::hyperlink,
         uri(""), uri(cell_address), target_mode::internal);
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        d_->hyperlink()->display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? cell_address : display);
+        d_->hyperlink()->display.set(display.empty() ? cell_address : display);
         value(hyperlink().display());
     }
 }
@@ -447,18 +514,18 @@ void cell::hyperlink(xlnt::range target, const std::string &display)
     // TODO: should this computed value be a method on a cell?
     const auto range_address = target.target_worksheet().title() + "!" + target.reference().to_string();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
-    d_->hyperlink_.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
+    d_->extension().hyperlink_.reset(new detail::hyperlink_impl());
+    d_->hyperlink()->relationship = xlnt::relationship("", relationship_type::hyperlink,
         uri(""), uri(range_address), target_mode::internal);
 
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        d_->hyperlink()->display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? range_address : display);
+        d_->hyperlink()->display.set(display.empty() ? range_address : display);
         value(hyperlink().display());
     }
 }
@@ -470,13 +537,15 @@ void cell::formula(const std::string &formula)
         return clear_formula();
     }
 
+    d_->formula_group_ = 0;
+
     if (formula[0] == '=')
     {
-        d_->formula_ = formula.substr(1);
+        d_->extension().formula_ = formula.substr(1);
     }
     else
     {
-        d_->formula_ = formula;
+        d_->extension().formula_ = formula;
     }
 
     worksheet().register_calc_chain_in_manifest();
@@ -484,19 +553,21 @@ void cell::formula(const std::string &formula)
 
 bool cell::has_formula() const
 {
-    return d_->formula_.is_set();
+    return d_->formula().is_set();
 }
 
 std::string cell::formula() const
 {
-    return d_->formula_.get();
+    return d_->formula().get();
 }
 
 void cell::clear_formula()
 {
     if (has_formula())
     {
-        d_->formula_.clear();
+        d_->formula_group_ = 0;
+        d_->extension().formula_.clear();
+        mark_collectible(*d_);
         worksheet().garbage_collect_formulae();
     }
 }
@@ -517,10 +588,20 @@ void cell::error(const std::string &error)
         throw invalid_data_type();
     }
 
-    d_->value_text_.plain_text(error, false);
+    d_->extension().value_text_.plain_text(error, false);
     d_->type_ = type::error;
 }
 
+std::size_t cell::shared_string_index() const
+{
+    if (d_->type_ != type::shared_string)
+    {
+        throw invalid_data_type();
+    }
+
+    return static_cast<std::size_t>(d_->value_number());
+}
+
 cell cell::offset(int column, int row)
 {
     return worksheet().cell(reference().make_offset(column, row));
@@ -573,6 +654,7 @@ cell::type cell::data_type() const
 void cell::data_type(type t)
 {
     d_->type_ = t;
+    mark_collectible(*d_);
 }
 
 number_format cell::computed_number_format() const
@@ -607,76 +689,81 @@ protection cell::computed_protection() const
 
 void cell::clear_value()
 {
-    d_->value_numeric_ = 0;
-    d_->value_text_.clear();
+    d_->value_number(0.0);
+    if (d_->extension_)
+    {
+        d_->extension_->value_text_.clear();
+    }
     d_->type_ = cell::type::empty;
+    mark_collectible(*d_);
     clear_formula();
 }
 
 template <>
 bool cell::value() const
 {
-    return d_->value_numeric_ != 0.0;
+    return d_->value_number() != 0.0;
 }
 
 template <>
 int cell::value() const
 {
-    return static_cast<int>(d_->value_numeric_);
+    return static_cast<int>(d_->value_integer());
 }
 
 template <>
 long long int cell::value() const
 {
-    return static_cast<long long int>(d_->value_numeric_);
+    return static_cast<long long int>(d_->value_integer());
 }
 
 template <>
 unsigned int cell::value() const
 {
-    return static_cast<unsigned int>(d_->value_numeric_);
+    return static_cast<unsigned int>(d_->value_integer());
 }
 
 template <>
 unsigned long long cell::value() const
 {
-    return static_cast<unsigned long long>(d_->value_numeric_);
+    return d_->value_integral_ ? static_cast<unsigned long long>(d_->value_integer_)
+                               : static_cast<unsigned long long>(d_->value_numeric_);
 }
 
 template <>
 float cell::value() const
 {
-    return static_cast<float>(d_->value_numeric_);
+    return static_cast<float>(d_->value_number());
 }
 
 template <>
 double cell::value() const
 {
-    return static_cast<double>(d_->value_numeric_);
+    return static_cast<double>(d_->value_number());
 }
 
 template <>
 time cell::value() const
 {
-    return time::from_number(d_->value_numeric_);
+    return time::from_number(d_->value_number());
 }
 
 template <>
 datetime cell::value() const
 {
-    return datetime::from_number(d_->value_numeric_, base_date());
+    return datetime::from_number(d_->value_number(), base_date());
 }
 
 template <>
 date cell::value() const
 {
-    return date::from_number(static_cast<int>(d_->value_numeric_), base_date());
+    return date::from_number(static_cast<int>(d_->value_integer()), base_date());
 }
 
 template <>
 timedelta cell::value() const
 {
-    return timedelta::from_number(d_->value_numeric_);
+    return timedelta::from_number(d_->value_number());
 }
 
 void cell::alignment(const class alignment &alignment_)
@@ -718,6 +805,12 @@ void cell::protection(const class protection &protection_)
 template <>
 std::string cell::value() const
 {
+    if (data_type() == cell::type::shared_string)
+    {
+        auto wb = workbook();
+        return detail::shared_string_loader::plain_text(wb, static_cast<std::size_t>(d_->value_numeric_));
+    }
+
     return value<rich_text>().plain_text();
 }
 
@@ -729,7 +822,7 @@ rich_text cell::value() const
         return workbook().shared_strings(static_cast<std::size_t>(d_->value_numeric_));
     }
 
-    return d_->value_text_;
+    return d_->value_text();
 }
 
 bool cell::has_value() const
@@ -740,6 +833,8 @@ bool cell::has_value() const
 std::string cell::to_string() const
 {
     auto nf = computed_number_format();
+    auto wb = d_->parent_->workbook_;
+    auto formatters = wb->stylesheet_.is_set() ? &wb->stylesheet_.get().number_formatters : nullptr;
 
     switch (data_type())
     {
@@ -747,12 +842,16 @@ std::string cell::to_string() const
         return "";
     case cell::type::date:
     case cell::type::number:
-        return nf.format(value<double>(), base_date());
+        return formatters == nullptr
+            ? nf.format(value<double>(), base_date())
+            : formatters->get(nf, wb->base_date_).format_number(value<double>());
     case cell::type::inline_string:
     case cell::type::shared_string:
     case cell::type::formula_string:
     case cell::type::error:
-        return nf.format(value<std::string>());
+        return formatters == nullptr
+            ? nf.format(value<std::string>())
+            : formatters->get(nf, calendar::windows_1900).format_text(value<std::string>());
     case cell::type::boolean:
         return value<double>() == 0.0 ? "FALSE" : "TRUE";
     }
@@ -778,7 +877,7 @@ void cell::format(const class format new_format)
 
 calendar cell::base_date() const
 {
-    return workbook().base_date();
+    return d_->parent_->workbook_->base_date_;
 }
 
 bool operator==(std::nullptr_t, const cell &cell)
@@ -808,16 +907,18 @@ std::ostream &operator<<(std::ostream &stream, const xlnt::cell &cell)
 
 void cell::value(const std::string &value_string, bool infer_type)
 {
-    value(value_string);
-
-    if (!infer_type || value_string.empty())
+    if (infer_type && value_string.size() > 1 && value_string.front() == '=')
     {
+        // the formula text isn't a result of the formula
+        clear_value();
+        formula(value_string);
         return;
     }
 
-    if (value_string.front() == '=' && value_string.size() > 1)
+    value(value_string);
+
+    if (!infer_type || value_string.empty())
     {
-        formula(value_string);
         return;
     }
 
@@ -831,7 +932,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
     if (percentage.first)
     {
-        d_->value_numeric_ = percentage.second;
+        d_->value_number(percentage.second);
         d_->type_ = cell::type::number;
         number_format(xlnt::number_format::percentage());
     }
@@ -843,7 +944,7 @@ void cell::value(const std::string &value_string, bool infer_type)
         {
             d_->type_ = cell::type::number;
             number_format(number_format::date_time6());
-            d_->value_numeric_ = time.second.to_number();
+            d_->value_number(time.second.to_number());
         }
         else
         {
@@ -851,7 +952,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
             if (numeric.first)
             {
-                d_->value_numeric_ = numeric.second;
+                d_->value_number(numeric.second);
                 d_->type_ = cell::type::number;
             }
         }
@@ -864,6 +965,7 @@ void cell::clear_format()
     {
         format().d_->references -= format().d_->references > 0 ? 1 : 0;
         d_->format_.clear();
+        mark_collectible(*d_);
     }
 }
 
@@ -971,22 +1073,23 @@ protection cell::protection() const
 
 bool cell::has_hyperlink() const
 {
-    return d_->hyperlink_.is_set();
+    return d_->hyperlink() != nullptr;
 }
 
 // comment
 
 bool cell::has_comment() const
 {
-    return d_->comment_.is_set();
+    return d_->comment().is_set();
 }
 
 void cell::clear_comment()
 {
     if (has_comment())
     {
-        d_->parent_->comments_.erase(reference().to_string());
-        d_->comment_.clear();
+        d_->parent_->comments_.erase(reference());
+        d_->extension().comment_.clear();
+        mark_collectible(*d_);
     }
 }
 
@@ -997,7 +1100,7 @@ class comment cell::comment() const
         throw xlnt::exception("cell has no comment");
     }
 
-    return *d_->comment_.get();
+    return *d_->comment().get();
 }
 
 void cell::comment(const std::string &text, const std::string &author)
@@ -1014,12 +1117,13 @@ void cell::comment(const class comment &new_comment)
 {
     if (has_comment())
     {
-        *d_->comment_.get() = new_comment;
+        *d_->comment().get() = new_comment;
     }
     else
     {
-        d_->parent_->comments_[reference().to_string()] = new_comment;
-        d_->comment_.set(&d_->parent_->comments_[reference().to_string()]);
+        auto &stored = d_->parent_->comments_[reference()];
+        stored = new_comment;
+        d_->extension().comment_.set(&stored);
     }
 
     // offset comment 5 pixels down and 5 pixels right of the top right corner of the cell
@@ -1027,7 +1131,7 @@ void cell::comment(const class comment &new_comment)
     cell_position.first += static_cast<int>(width()) + 5;
     cell_position.second += 5;
 
-    d_->comment_.get()->position(cell_position.first, cell_position.second);
+    d_->comment().get()->position(cell_position.first, cell_position.second);
 
     worksheet().register_comments_in_manifest();
 }
@@ -24,6 +24,9 @@
 // @author: see AUTHORS file
 
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/utils/exceptions.hpp>
@@ -31,9 +34,13 @@
 
 #include <detail/constants.hpp>
 #include <detail/serialization/parsers.hpp>
+#include <detail/utils/reference_decoding.hpp>
+#include <detail/utils/reference_encoding.hpp>
 
 namespace xlnt {
 
+const std::size_t cell_reference::max_string_length;
+
 std::size_t cell_reference_hash::operator()(const cell_reference &k) const
 {
     return k.row() * constants::max_column().index + k.column_index();
@@ -53,18 +60,40 @@ cell_reference::cell_reference()
 }
 
 cell_reference::cell_reference(const std::string &string)
+    : cell_reference(from_chars(string.data(), string.data() + string.size()))
 {
-    // If not an error reference, proceed with normal parsing
-    auto split = split_reference(string, absolute_column_, absolute_row_);
-    column(split.first);
-    row(split.second);
 }
 
 cell_reference::cell_reference(const char *reference_string)
-    : cell_reference(std::string(reference_string))
+    : cell_reference(from_chars(reference_string, reference_string + std::strlen(reference_string)))
 {
 }
 
+cell_reference cell_reference::from_chars(const char *begin, const char *end)
+{
+    column_t::index_t column_index = 0;
+    std::uint64_t row_number = 0;
+    cell_reference result;
+
+    if (!detail::decode_cell_reference(begin, end, column_index, row_number,
+            result.absolute_column_, result.absolute_row_)
+        || row_number > std::numeric_limits<row_t>::max())
+    {
+        throw invalid_cell_reference(std::string(begin, end));
+    }
+
+    // more than three letters, which column_t rejects
+    if (column_index == 0)
+    {
+        throw invalid_column_index();
+    }
+
+    result.column_ = column_t(column_index);
+    result.row_ = static_cast<row_t>(row_number);
+
+    return result;
+}
+
 cell_reference::cell_reference(column_t column_index, row_t row)
     : column_(column_index), row_(row)
 {
@@ -84,23 +113,25 @@ range_reference cell_reference::operator,(const xlnt::cell_reference &other) con
 
 std::string cell_reference::to_string() const
 {
-    std::string string_representation;
+    char characters[max_string_length];
+    return std::string(characters, to_chars(characters));
+}
 
+char *cell_reference::to_chars(char *buffer) const
+{
     if (absolute_column_)
     {
-        string_representation.append("$");
+        *buffer++ = '$';
     }
 
-    string_representation.append(column_.column_string());
+    buffer = detail::encode_column_letters(column_.index, buffer);
 
     if (absolute_row_)
     {
-        string_representation.append("$");
+        *buffer++ = '$';
     }
 
-    string_representation.append(std::to_string(row_));
-
-    return string_representation;
+    return detail::encode_row_digits(row_, buffer);
 }
 
 range_reference cell_reference::to_range() const
@@ -22,35 +22,24 @@
 //
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
-#include <cctype>
-
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/utils/exceptions.hpp>
 #include <detail/constants.hpp>
+#include <detail/utils/reference_decoding.hpp>
+#include <detail/utils/reference_encoding.hpp>
 
 namespace xlnt {
 
 column_t::index_t column_t::column_index_from_string(const std::string &column_string)
 {
-    if (column_string.length() > 3 || column_string.empty())
-    {
-        throw invalid_column_index();
-    }
-
+    const auto begin = column_string.data();
+    const auto end = begin + column_string.size();
     column_t::index_t column_index = 0;
-    int place = 1;
 
-    for (int i = static_cast<int>(column_string.length()) - 1; i >= 0; i--)
+    // an empty string or one with more than three letters leaves the index at zero
+    if (detail::decode_column_letters(begin, end, column_index) != end || column_index == 0)
     {
-        if (!std::isalpha(column_string[static_cast<std::size_t>(i)]))
-        {
-            throw invalid_column_index();
-        }
-
-        auto char_index = std::toupper(column_string[static_cast<std::size_t>(i)]) - 'A';
-
-        column_index += static_cast<column_t::index_t>((char_index + 1) * place);
-        place *= 26;
+        throw invalid_column_index();
     }
 
     return column_index;
@@ -69,25 +58,8 @@ std::string column_t::column_string_from_index(column_t::index_t column_index)
         throw invalid_column_index();
     }
 
-    int temp = static_cast<int>(column_index);
-    std::string column_letter = "";
-
-    while (temp > 0)
-    {
-        int quotient = temp / 26, remainder = temp % 26;
-
-        // check for exact division and borrow if needed
-        if (remainder == 0)
-        {
-            quotient -= 1;
-            remainder = 26;
-        }
-
-        column_letter = std::string(1, char(remainder + 64)) + column_letter;
-        temp = quotient;
-    }
-
-    return column_letter;
+    char letters[detail::max_column_letters];
+    return std::string(letters, detail::encode_column_letters(column_index, letters));
 }
 
 column_t::column_t()
@@ -22,10 +22,13 @@
 //
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
+#include <memory>
 #include <numeric>
 
 #include <xlnt/cell/rich_text.hpp>
 #include <xlnt/cell/rich_text_run.hpp>
+#include <xlnt/utils/hash_combine.hpp>
+#include <detail/utils/heap_size.hpp>
 
 namespace {
 bool has_trailing_whitespace(const std::string &s)
@@ -41,6 +44,13 @@ rich_text::rich_text(const std::string &plain_text)
 {
 }
 
+rich_text::rich_text(std::string &&plain_text)
+    : plain_(std::move(plain_text)),
+      compact_(true)
+{
+    plain_preserve_space_ = has_trailing_whitespace(plain_);
+}
+
 rich_text::rich_text(const std::string &plain_text, const class font &text_font)
     : rich_text(rich_text_run{plain_text, optional<font>(text_font), has_trailing_whitespace(plain_text)})
 {
@@ -55,6 +65,9 @@ rich_text &rich_text::operator=(const rich_text &rhs)
 {
     clear();
     runs_ = rhs.runs_;
+    plain_ = rhs.plain_;
+    plain_preserve_space_ = rhs.plain_preserve_space_;
+    compact_ = rhs.compact_;
     phonetic_runs_ = rhs.phonetic_runs_;
     phonetic_properties_ = rhs.phonetic_properties_;
     return *this;
@@ -68,6 +81,9 @@ rich_text::rich_text(const rich_text_run &single_run)
 void rich_text::clear()
 {
     runs_.clear();
+    plain_.clear();
+    plain_preserve_space_ = false;
+    compact_ = false;
     phonetic_runs_.clear();
     phonetic_properties_.clear();
 }
@@ -75,33 +91,106 @@ void rich_text::clear()
 void rich_text::plain_text(const std::string &s, bool preserve_space = false)
 {
     clear();
-    add_run(rich_text_run{s, {}, preserve_space});
+    plain_ = s;
+    plain_preserve_space_ = preserve_space;
+    compact_ = true;
 }
 
 std::string rich_text::plain_text() const
 {
+    if (compact_)
+    {
+        return plain_;
+    }
+
     if (runs_.size() == 1)
     {
-        return runs_.begin()->first;
+        return runs_.begin()->text;
+    }
+
+    std::string text;
+    text.reserve(std::accumulate(runs_.begin(), runs_.end(), std::size_t(0),
+        [](std::size_t size, const stored_run &run) { return size + run.text.size(); }));
+
+    for (const auto &run : runs_)
+    {
+        text.append(run.text);
     }
 
-    return std::accumulate(runs_.begin(), runs_.end(), std::string(),
-        [](const std::string &a, const rich_text_run &run) { return a + run.first; });
+    return text;
 }
 
 std::vector<rich_text_run> rich_text::runs() const
 {
-    return runs_;
+    if (compact_)
+    {
+        return {rich_text_run{plain_, {}, plain_preserve_space_}};
+    }
+
+    std::vector<rich_text_run> result;
+    result.reserve(runs_.size());
+
+    for (const auto &run : runs_)
+    {
+        result.push_back(rich_text_run{run.text,
+            run.run_font ? optional<font>(*run.run_font) : optional<font>(), run.preserve_space});
+    }
+
+    return result;
 }
 
 void rich_text::runs(const std::vector<rich_text_run> &new_runs)
 {
-    runs_ = new_runs;
+    runs_.clear();
+    plain_.clear();
+    plain_preserve_space_ = false;
+    compact_ = false;
+
+    for (const auto &run : new_runs)
+    {
+        append_run(run);
+    }
 }
 
 void rich_text::add_run(const rich_text_run &t)
 {
-    runs_.push_back(t);
+    append_run(t);
+}
+
+void rich_text::append_run(const rich_text_run &new_run)
+{
+    append_run(std::string(new_run.first),
+        new_run.second.is_set() ? std::make_shared<const font>(new_run.second.get()) : nullptr,
+        new_run.preserve_space);
+}
+
+void rich_text::append_run(std::string &&text, std::shared_ptr<const font> run_font, bool preserve_space)
+{
+    if (runs_.empty() && !compact_ && !run_font)
+    {
+        plain_ = std::move(text);
+        plain_preserve_space_ = preserve_space;
+        compact_ = true;
+
+        return;
+    }
+
+    if (compact_)
+    {
+        runs_.push_back(stored_run{std::move(plain_), nullptr, plain_preserve_space_});
+        plain_.clear();
+        plain_preserve_space_ = false;
+        compact_ = false;
+    }
+
+    runs_.push_back(stored_run{std::move(text), std::move(run_font), preserve_space});
+}
+
+bool rich_text::stored_run::operator==(const stored_run &other) const
+{
+    // like rich_text_run::operator==, preserve_space isn't compared
+    return text == other.text
+        && (run_font == other.run_font || (run_font && other.run_font && *run_font == *other.run_font));
 }
 
 std::vector<phonetic_run> rich_text::phonetic_runs() const
@@ -134,13 +223,34 @@ void rich_text::phonetic_properties(const phonetic_pr &phonetic_props)
     phonetic_properties_.set(phonetic_props);
 }
 
+std::size_t rich_text::memory_usage() const
+{
+    auto usage = detail::heap_size(plain_) + detail::heap_size(runs_) + detail::heap_size(phonetic_runs_);
+
+    // fonts are shared between runs, so they aren't counted
+    for (const auto &run : runs_)
+    {
+        usage += detail::heap_size(run.text);
+    }
+
+    for (const auto &run : phonetic_runs_)
+    {
+        usage += detail::heap_size(run.text);
+    }
+
+    return usage;
+}
+
 bool rich_text::operator==(const rich_text &rhs) const
 {
+    // a single unformatted run is always stored compactly
+    if (compact_ != rhs.compact_) return false;
+    if (compact_ && plain_ != rhs.plain_) return false;
     if (runs_.size() != rhs.runs_.size()) return false;
 
     for (std::size_t i = 0; i < runs_.size(); i++)
     {
-        if (runs_[i] != rhs.runs_[i]) return false;
+        if (!(runs_[i] == rhs.runs_[i])) return false;
     }
 
     if (phonetic_runs_.size() != rhs.phonetic_runs_.size()) return false;
@@ -157,7 +267,7 @@ bool rich_text::operator==(const rich_text &rhs) const
 
 bool rich_text::operator==(const std::string &rhs) const
 {
-    return *this == rich_text(rhs);
+    return compact_ && plain_ == rhs && phonetic_runs_.empty() && !phonetic_properties_.is_set();
 }
 
 bool rich_text::operator!=(const rich_text &rhs) const
@@ -170,4 +280,46 @@ bool rich_text::operator!=(const std::string &rhs) const
     return !(*this == rhs);
 }
 
+std::size_t rich_text_hash::operator()(const rich_text &k) const
+{
+    if (k.compact_)
+    {
+        std::size_t seed = 0;
+        detail::hash_combine(seed, k.plain_);
+
+        return seed;
+    }
+
+    // combined in order so that reordered or repeated runs don't cancel out. Only fields
+    // font::operator== compares are hashed, so that equal texts hash equally.
+    std::size_t seed = 0;
+
+    for (const auto &run : k.runs_)
+    {
+        detail::hash_combine(seed, run.text);
+        detail::hash_combine(seed, run.run_font != nullptr);
+
+        if (run.run_font)
+        {
+            const auto &run_font = *run.run_font;
+
+            if (run_font.has_name())
+            {
+                detail::hash_combine(seed, run_font.name());
+            }
+
+            if (run_font.has_size())
+            {
+                detail::hash_combine(seed, run_font.size());
+            }
+
+            detail::hash_combine(seed, run_font.bold());
+            detail::hash_combine(seed, run_font.italic());
+            detail::hash_combine(seed, static_cast<int>(run_font.underline()));
+        }
+    }
+
+    return seed;
+}
+
 } // namespace xlnt
@@ -26,9 +26,22 @@
 // https://github.com/libtom/libtomcrypt/blob/develop/src/ciphers/aes/aes_tab.c
 // https://github.com/libtom/libtomcrypt/blob/develop/src/ciphers/aes/aes.c
 
+#include <algorithm>
 #include <array>
 #include <assert.h>
 #include <stdlib.h>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#endif
+#include <wmmintrin.h>
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && defined(__ARM_FEATURE_CRYPTO)
+#include <arm_neon.h>
+#endif
 
 #include <xlnt/utils/exceptions.hpp>
 #include <detail/cryptography/aes.hpp>
@@ -2967,169 +2980,392 @@ void rijndael_ecb_decrypt(const unsigned char *ct, unsigned char *pt, rijndael_k
     STORE32H(s3, pt + 12);
 }
 
-#undef byte
-#undef LOAD32H
-#undef STORE32H
-#undef RORc
+// Hardware AES: AES-NI on x86, detected at runtime, and the ARMv8 cryptography
+// extension when the compiler targets it. Both use the round keys expanded above;
+// dK already holds the equivalent inverse cipher keys the instructions expect.
 
-} // namespace
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) \
+    && (defined(__GNUC__) || defined(_MSC_VER))
+#define XLNT_AES_NI
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && defined(__ARM_FEATURE_CRYPTO)
+#define XLNT_AES_ARMV8
+#endif
 
-namespace xlnt {
-namespace detail {
+/// <summary>
+/// Stores the 32-bit big-endian round key words as the bytes the instructions load.
+/// </summary>
+void round_key_bytes(const std::uint32_t *words, int rounds, std::uint8_t *bytes)
+{
+    for (int i = 0; i < 4 * (rounds + 1); ++i)
+    {
+        STORE32H(words[i], bytes + 4 * i);
+    }
+}
 
-std::vector<std::uint8_t> aes_ecb_encrypt(
-    const std::vector<std::uint8_t> &plaintext,
-    const std::vector<std::uint8_t> &key,
-    const std::size_t offset)
+#if defined(XLNT_AES_NI)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define XLNT_AES_TARGET
+#else
+#define XLNT_AES_TARGET __attribute__((target("aes,sse2")))
+#endif
+
+bool hardware_aes_supported()
 {
-    if (plaintext.empty()) return {};
+    int registers[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuid(registers, 1);
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+    registers[2] = static_cast<int>(ecx);
+    registers[3] = static_cast<int>(edx);
+#endif
+    // AES in ecx, SSE2 in edx
+    return (registers[2] & (1 << 25)) != 0 && (registers[3] & (1 << 26)) != 0;
+}
 
-    auto len = plaintext.size() - offset;
+XLNT_AES_TARGET void hardware_ecb_encrypt(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks, const rijndael_key &skey)
+{
+    std::uint8_t key_bytes[240];
+    round_key_bytes(skey.eK, skey.Nr, key_bytes);
 
-    if (len % 16 != 0)
+    __m128i keys[15];
+    for (int i = 0; i <= skey.Nr; ++i)
     {
-        throw xlnt::exception("Invalid ECB plaintext length ("
-            + std::to_string(len)
-            + " bytes). Must be a multiple of 16 bytes.");
+        keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key_bytes + 16 * i));
     }
 
-    auto ciphertext = std::vector<std::uint8_t>(len);
-    auto expanded_key = rijndael_setup(key);
-    auto pt = plaintext.data() + offset;
-    auto ct = ciphertext.data();
+    for (; blocks > 0; --blocks, in += 16, out += 16)
+    {
+        auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)), keys[0]);
+
+        for (int round = 1; round < skey.Nr; ++round)
+        {
+            state = _mm_aesenc_si128(state, keys[round]);
+        }
 
-    while (len)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_aesenclast_si128(state, keys[skey.Nr]));
+    }
+}
+
+/// <summary>
+/// Decrypts four independent blocks at a time to keep the pipelined AESDEC unit busy.
+/// </summary>
+XLNT_AES_TARGET void hardware_ecb_decrypt(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks, const rijndael_key &skey)
+{
+    std::uint8_t key_bytes[240];
+    round_key_bytes(skey.dK, skey.Nr, key_bytes);
+
+    __m128i keys[15];
+    for (int i = 0; i <= skey.Nr; ++i)
+    {
+        keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key_bytes + 16 * i));
+    }
+
+    for (; blocks >= 4; blocks -= 4, in += 64, out += 64)
     {
-        rijndael_ecb_encrypt(pt, ct, expanded_key);
+        auto s0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)), keys[0]);
+        auto s1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16)), keys[0]);
+        auto s2 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 32)), keys[0]);
+        auto s3 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 48)), keys[0]);
+
+        for (int round = 1; round < skey.Nr; ++round)
+        {
+            s0 = _mm_aesdec_si128(s0, keys[round]);
+            s1 = _mm_aesdec_si128(s1, keys[round]);
+            s2 = _mm_aesdec_si128(s2, keys[round]);
+            s3 = _mm_aesdec_si128(s3, keys[round]);
+        }
 
-        pt += 16;
-        ct += 16;
-        len -= 16;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_aesdeclast_si128(s0, keys[skey.Nr]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_aesdeclast_si128(s1, keys[skey.Nr]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32), _mm_aesdeclast_si128(s2, keys[skey.Nr]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 48), _mm_aesdeclast_si128(s3, keys[skey.Nr]));
     }
 
-    return ciphertext;
+    for (; blocks > 0; --blocks, in += 16, out += 16)
+    {
+        auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)), keys[0]);
+
+        for (int round = 1; round < skey.Nr; ++round)
+        {
+            state = _mm_aesdec_si128(state, keys[round]);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_aesdeclast_si128(state, keys[skey.Nr]));
+    }
 }
 
-std::vector<std::uint8_t> aes_ecb_decrypt(
-    const std::vector<std::uint8_t> &ciphertext,
-    const std::vector<std::uint8_t> &key,
-    const std::size_t offset)
+#undef XLNT_AES_TARGET
+
+#elif defined(XLNT_AES_ARMV8)
+
+bool hardware_aes_supported()
 {
-    if (ciphertext.empty()) return {};
+    // guaranteed by the target the library was compiled for
+    return true;
+}
 
-    auto len = ciphertext.size() - offset;
+void hardware_ecb_encrypt(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks, const rijndael_key &skey)
+{
+    std::uint8_t key_bytes[240];
+    round_key_bytes(skey.eK, skey.Nr, key_bytes);
 
-    if (len % 16 != 0)
+    uint8x16_t keys[15];
+    for (int i = 0; i <= skey.Nr; ++i)
     {
-        throw xlnt::exception("Invalid ECB ciphertext length ("
-            + std::to_string(len)
-            + " bytes). Must be a multiple of 16 bytes.");
+        keys[i] = vld1q_u8(key_bytes + 16 * i);
     }
 
-    auto plaintext = std::vector<std::uint8_t>(len);
-    auto expanded_key = rijndael_setup(key);
-    auto ct = ciphertext.data() + offset;
-    auto pt = plaintext.data();
+    for (; blocks > 0; --blocks, in += 16, out += 16)
+    {
+        auto state = vld1q_u8(in);
+
+        for (int round = 0; round < skey.Nr - 1; ++round)
+        {
+            state = vaesmcq_u8(vaeseq_u8(state, keys[round]));
+        }
+
+        vst1q_u8(out, veorq_u8(vaeseq_u8(state, keys[skey.Nr - 1]), keys[skey.Nr]));
+    }
+}
 
-    while (len)
+void hardware_ecb_decrypt(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks, const rijndael_key &skey)
+{
+    std::uint8_t key_bytes[240];
+    round_key_bytes(skey.dK, skey.Nr, key_bytes);
+
+    uint8x16_t keys[15];
+    for (int i = 0; i <= skey.Nr; ++i)
+    {
+        keys[i] = vld1q_u8(key_bytes + 16 * i);
+    }
+
+    for (; blocks >= 4; blocks -= 4, in += 64, out += 64)
     {
-        rijndael_ecb_decrypt(ct, pt, expanded_key);
+        auto s0 = vld1q_u8(in);
+        auto s1 = vld1q_u8(in + 16);
+        auto s2 = vld1q_u8(in + 32);
+        auto s3 = vld1q_u8(in + 48);
+
+        for (int round = 0; round < skey.Nr - 1; ++round)
+        {
+            s0 = vaesimcq_u8(vaesdq_u8(s0, keys[round]));
+            s1 = vaesimcq_u8(vaesdq_u8(s1, keys[round]));
+            s2 = vaesimcq_u8(vaesdq_u8(s2, keys[round]));
+            s3 = vaesimcq_u8(vaesdq_u8(s3, keys[round]));
+        }
 
-        pt += 16;
-        ct += 16;
-        len -= 16;
+        vst1q_u8(out, veorq_u8(vaesdq_u8(s0, keys[skey.Nr - 1]), keys[skey.Nr]));
+        vst1q_u8(out + 16, veorq_u8(vaesdq_u8(s1, keys[skey.Nr - 1]), keys[skey.Nr]));
+        vst1q_u8(out + 32, veorq_u8(vaesdq_u8(s2, keys[skey.Nr - 1]), keys[skey.Nr]));
+        vst1q_u8(out + 48, veorq_u8(vaesdq_u8(s3, keys[skey.Nr - 1]), keys[skey.Nr]));
     }
 
-    return plaintext;
+    for (; blocks > 0; --blocks, in += 16, out += 16)
+    {
+        auto state = vld1q_u8(in);
+
+        for (int round = 0; round < skey.Nr - 1; ++round)
+        {
+            state = vaesimcq_u8(vaesdq_u8(state, keys[round]));
+        }
+
+        vst1q_u8(out, veorq_u8(vaesdq_u8(state, keys[skey.Nr - 1]), keys[skey.Nr]));
+    }
 }
 
-std::vector<std::uint8_t> aes_cbc_encrypt(
-    const std::vector<std::uint8_t> &plaintext,
-    const std::vector<std::uint8_t> &key,
-    const std::vector<std::uint8_t> &original_iv,
-    const std::size_t offset)
+#endif
+
+/// <summary>
+/// Encrypts blocks consecutive 16-byte blocks independently.
+/// </summary>
+void ecb_encrypt_blocks(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks, rijndael_key &skey)
 {
-    if (plaintext.empty()) return {};
+#if defined(XLNT_AES_NI) || defined(XLNT_AES_ARMV8)
+    static const bool hardware = hardware_aes_supported();
+
+    if (hardware)
+    {
+        hardware_ecb_encrypt(in, out, blocks, skey);
+        return;
+    }
+#endif
 
-    auto len = plaintext.size() - offset;
+    for (; blocks > 0; --blocks, in += 16, out += 16)
+    {
+        rijndael_ecb_encrypt(in, out, skey);
+    }
+}
+
+/// <summary>
+/// Decrypts blocks consecutive 16-byte blocks independently.
+/// </summary>
+void ecb_decrypt_blocks(const std::uint8_t *in, std::uint8_t *out, std::size_t blocks, rijndael_key &skey)
+{
+#if defined(XLNT_AES_NI) || defined(XLNT_AES_ARMV8)
+    static const bool hardware = hardware_aes_supported();
 
-    if (len % 16 != 0)
+    if (hardware)
+    {
+        hardware_ecb_decrypt(in, out, blocks, skey);
+        return;
+    }
+#endif
+
+    for (; blocks > 0; --blocks, in += 16, out += 16)
+    {
+        rijndael_ecb_decrypt(in, out, skey);
+    }
+}
+
+
+#undef byte
+#undef LOAD32H
+#undef STORE32H
+#undef RORc
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+void aes_ecb_encrypt(const std::uint8_t *plaintext, std::size_t length,
+    const std::vector<std::uint8_t> &key, std::uint8_t *ciphertext)
+{
+    if (length % 16 != 0)
+    {
+        throw xlnt::exception("Invalid ECB plaintext length ("
+            + std::to_string(length)
+            + " bytes). Must be a multiple of 16 bytes.");
+    }
+
+    auto expanded_key = rijndael_setup(key);
+    ecb_encrypt_blocks(plaintext, ciphertext, length / 16, expanded_key);
+}
+
+void aes_ecb_decrypt(const std::uint8_t *ciphertext, std::size_t length,
+    const std::vector<std::uint8_t> &key, std::uint8_t *plaintext)
+{
+    if (length % 16 != 0)
+    {
+        throw xlnt::exception("Invalid ECB ciphertext length ("
+            + std::to_string(length)
+            + " bytes). Must be a multiple of 16 bytes.");
+    }
+
+    auto expanded_key = rijndael_setup(key);
+    ecb_decrypt_blocks(ciphertext, plaintext, length / 16, expanded_key);
+}
+
+void aes_cbc_encrypt(const std::uint8_t *plaintext, std::size_t length,
+    const std::vector<std::uint8_t> &key, const std::uint8_t *original_iv, std::uint8_t *ciphertext)
+{
+    if (length % 16 != 0)
     {
         throw xlnt::exception("Invalid CBC plaintext length ("
-            + std::to_string(len)
+            + std::to_string(length)
             + " bytes). Must be a multiple of 16 bytes.");
     }
 
-    auto ciphertext = std::vector<std::uint8_t>(len);
     auto expanded_key = rijndael_setup(key);
-    auto ct = ciphertext.data();
-    auto pt = plaintext.data() + offset;
-    auto iv_vec = original_iv;
-    auto iv = iv_vec.data();
+    std::array<std::uint8_t, 16> iv;
+    std::copy(original_iv, original_iv + 16, iv.begin());
 
-    while (len)
+    for (; length > 0; length -= 16, plaintext += 16, ciphertext += 16)
     {
         for (auto x = 0; x < 16; x++)
         {
-            iv[x] ^= pt[x];
+            iv[static_cast<std::size_t>(x)] ^= plaintext[x];
         }
 
-        rijndael_ecb_encrypt(iv, ct, expanded_key);
+        ecb_encrypt_blocks(iv.data(), ciphertext, 1, expanded_key);
+        std::copy(ciphertext, ciphertext + 16, iv.begin());
+    }
+}
 
-        for (auto x = 0; x < 16; x++)
-        {
-            iv[x] = ct[x];
-        }
+void aes_cbc_decrypt(const std::uint8_t *ciphertext, std::size_t length,
+    const std::vector<std::uint8_t> &key, const std::uint8_t *iv, std::uint8_t *plaintext)
+{
+    if (length % 16 != 0)
+    {
+        throw xlnt::exception("Invalid CBC ciphertext length ("
+            + std::to_string(length)
+            + " bytes). Must be a multiple of 16 bytes.");
+    }
+
+    if (length == 0) return;
 
-        pt += 16;
-        ct += 16;
-        len -= 16;
+    auto expanded_key = rijndael_setup(key);
+
+    // unlike encryption, the blocks decrypt independently and are chained afterwards
+    ecb_decrypt_blocks(ciphertext, plaintext, length / 16, expanded_key);
+
+    for (auto x = std::size_t(0); x < 16; x++)
+    {
+        plaintext[x] = static_cast<std::uint8_t>(plaintext[x] ^ iv[x]);
     }
 
+    for (auto x = std::size_t(16); x < length; x++)
+    {
+        plaintext[x] = static_cast<std::uint8_t>(plaintext[x] ^ ciphertext[x - 16]);
+    }
+}
+
+std::vector<std::uint8_t> aes_ecb_encrypt(
+    const std::vector<std::uint8_t> &plaintext,
+    const std::vector<std::uint8_t> &key,
+    const std::size_t offset)
+{
+    if (plaintext.empty()) return {};
+
+    auto ciphertext = std::vector<std::uint8_t>(plaintext.size() - offset);
+    aes_ecb_encrypt(plaintext.data() + offset, ciphertext.size(), key, ciphertext.data());
+
     return ciphertext;
 }
 
-std::vector<std::uint8_t> aes_cbc_decrypt(
+std::vector<std::uint8_t> aes_ecb_decrypt(
     const std::vector<std::uint8_t> &ciphertext,
     const std::vector<std::uint8_t> &key,
-    const std::vector<std::uint8_t> &original_iv,
     const std::size_t offset)
 {
     if (ciphertext.empty()) return {};
 
-    auto len = ciphertext.size() - offset;
+    auto plaintext = std::vector<std::uint8_t>(ciphertext.size() - offset);
+    aes_ecb_decrypt(ciphertext.data() + offset, plaintext.size(), key, plaintext.data());
 
-    if (ciphertext.size() % 16 != 0)
-    {
-        throw xlnt::exception("Invalid ECB ciphertext length ("
-            + std::to_string(len)
-            + " bytes). Must be a multiple of 16 bytes.");
-    }
+    return plaintext;
+}
 
-    std::array<std::uint8_t, 16> temporary{{0}};
+std::vector<std::uint8_t> aes_cbc_encrypt(
+    const std::vector<std::uint8_t> &plaintext,
+    const std::vector<std::uint8_t> &key,
+    const std::vector<std::uint8_t> &iv,
+    const std::size_t offset)
+{
+    if (plaintext.empty()) return {};
 
-    auto plaintext = std::vector<std::uint8_t>(len);
-    auto expanded_key = rijndael_setup(key);
-    auto ct = ciphertext.data() + offset;
-    auto pt = plaintext.data();
-    auto iv_vec = original_iv;
-    auto iv = iv_vec.data();
+    auto ciphertext = std::vector<std::uint8_t>(plaintext.size() - offset);
+    aes_cbc_encrypt(plaintext.data() + offset, ciphertext.size(), key, iv.data(), ciphertext.data());
 
-    while (len)
-    {
-        rijndael_ecb_decrypt(ct, temporary.data(), expanded_key);
+    return ciphertext;
+}
 
-        for (auto x = std::size_t(0); x < 16; x++)
-        {
-            auto tmpy = static_cast<std::uint8_t>(temporary[x] ^ iv[x]);
-            iv[x] = ct[x];
-            pt[x] = tmpy;
-        }
+std::vector<std::uint8_t> aes_cbc_decrypt(
+    const std::vector<std::uint8_t> &ciphertext,
+    const std::vector<std::uint8_t> &key,
+    const std::vector<std::uint8_t> &iv,
+    const std::size_t offset)
+{
+    if (ciphertext.empty()) return {};
 
-        pt += 16;
-        ct += 16;
-        len -= 16;
-    }
+    auto plaintext = std::vector<std::uint8_t>(ciphertext.size() - offset);
+    aes_cbc_decrypt(ciphertext.data() + offset, plaintext.size(), key, iv.data(), plaintext.data());
 
     return plaintext;
 }
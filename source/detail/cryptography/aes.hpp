@@ -24,29 +24,47 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
+#include <detail/xlnt_config_impl.hpp>
+
 namespace xlnt {
 namespace detail {
 
-std::vector<std::uint8_t> aes_ecb_encrypt(
+// The pointer-based functions process length bytes, which must be a multiple of 16,
+// from input to output, which mustn't overlap. The iv is 16 bytes long.
+
+XLNT_API_INTERNAL void aes_ecb_encrypt(const std::uint8_t *input, std::size_t length,
+    const std::vector<std::uint8_t> &key, std::uint8_t *output);
+
+XLNT_API_INTERNAL void aes_ecb_decrypt(const std::uint8_t *input, std::size_t length,
+    const std::vector<std::uint8_t> &key, std::uint8_t *output);
+
+XLNT_API_INTERNAL void aes_cbc_encrypt(const std::uint8_t *input, std::size_t length,
+    const std::vector<std::uint8_t> &key, const std::uint8_t *iv, std::uint8_t *output);
+
+XLNT_API_INTERNAL void aes_cbc_decrypt(const std::uint8_t *input, std::size_t length,
+    const std::vector<std::uint8_t> &key, const std::uint8_t *iv, std::uint8_t *output);
+
+XLNT_API_INTERNAL std::vector<std::uint8_t> aes_ecb_encrypt(
     const std::vector<std::uint8_t> &input,
     const std::vector<std::uint8_t> &key,
     const std::size_t offset = 0);
 
-std::vector<std::uint8_t> aes_ecb_decrypt(
+XLNT_API_INTERNAL std::vector<std::uint8_t> aes_ecb_decrypt(
     const std::vector<std::uint8_t> &input,
     const std::vector<std::uint8_t> &key,
     const std::size_t offset = 0);
 
-std::vector<std::uint8_t> aes_cbc_encrypt(
+XLNT_API_INTERNAL std::vector<std::uint8_t> aes_cbc_encrypt(
     const std::vector<std::uint8_t> &input,
     const std::vector<std::uint8_t> &key,
     const std::vector<std::uint8_t> &iv,
     const std::size_t offset = 0);
 
-std::vector<std::uint8_t> aes_cbc_decrypt(
+XLNT_API_INTERNAL std::vector<std::uint8_t> aes_cbc_decrypt(
     const std::vector<std::uint8_t> &input,
     const std::vector<std::uint8_t> &key,
     const std::vector<std::uint8_t> &iv,
@@ -34,6 +34,7 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <detail/binary.hpp>
 #include <detail/cryptography/compound_document.hpp>
+#include <detail/serialization/vector_streambuf.hpp>
 #include <detail/unicode.hpp>
 
 namespace {
@@ -86,17 +87,61 @@ std::string join_path(const std::vector<std::string> &path)
 const sector_id FreeSector = -1;
 const sector_id EndOfChain = -2;
 const sector_id SATSector = -3;
-//const sector_id MSATSector = -4;
+const sector_id MSATSector = -4;
 
 const directory_id End = -1;
 
+// Returns true if the entry named left comes before the one named right among their
+// siblings, where shorter names come first and names of the same length are compared
+// without case.
+bool entry_name_less(const std::string &left, const std::string &right)
+{
+    const auto left_name = xlnt::detail::utf8_to_utf16(left);
+    const auto right_name = xlnt::detail::utf8_to_utf16(right);
+
+    if (left_name.size() != right_name.size())
+    {
+        return left_name.size() < right_name.size();
+    }
+
+    const auto upper = [](char16_t c) { return c >= u'a' && c <= u'z' ? char16_t(c - u'a' + u'A') : c; };
+
+    return std::lexicographical_compare(left_name.begin(), left_name.end(), right_name.begin(), right_name.end(),
+        [&upper](char16_t a, char16_t b) { return upper(a) < upper(b); });
+}
+
+// Links the entries ids[first, last), which are sorted by name, into a balanced red-black
+// tree and returns its root. Only the nodes below the last full level are red, so every
+// path has as many black nodes as there are full levels.
+directory_id link_entries(std::vector<xlnt::detail::compound_document_entry> &entries,
+    const std::vector<directory_id> &ids, std::size_t first, std::size_t last,
+    std::size_t depth, std::size_t full_levels)
+{
+    if (first == last)
+    {
+        return End;
+    }
+
+    const auto middle = first + (last - first) / 2;
+    auto &entry = entries[static_cast<std::size_t>(ids[middle])];
+    entry.prev = link_entries(entries, ids, first, middle, depth + 1, full_levels);
+    entry.next = link_entries(entries, ids, middle + 1, last, depth + 1, full_levels);
+    entry.color = depth < full_levels
+        ? xlnt::detail::compound_document_entry::entry_color::Black
+        : xlnt::detail::compound_document_entry::entry_color::Red;
+
+    return ids[middle];
+}
+
 } // namespace
 
 namespace xlnt {
 namespace detail {
 
 /// <summary>
-/// Allows a std::vector to be read through a std::istream.
+/// Reads a stream of a compound document through a std::istream. The sector chain
+/// of the stream is split into runs of consecutive sectors once, so that reads which
+/// span several sectors of a run become a single read from the document.
 /// </summary>
 class compound_document_istreambuf : public std::streambuf
 {
@@ -106,9 +151,31 @@ public:
     compound_document_istreambuf(const compound_document_entry &entry, compound_document &document)
         : entry_(entry),
           document_(document),
-          sector_writer_(current_sector_),
-          position_(0)
+          sector_size_(short_stream() ? document.short_sector_size() : document.sector_size()),
+          buffer_(std::min(std::size_t(entry.size), std::size_t(buffer_length))),
+          window_start_(0)
     {
+        const auto chain = document.follow_chain(entry.start, short_stream() ? document.ssat_ : document.sat_);
+
+        if (chain.size() * sector_size_ < entry.size)
+        {
+            throw xlnt::exception("compound document stream is shorter than its entry");
+        }
+
+        for (auto i = std::size_t(0); i < chain.size(); ++i)
+        {
+            if (!runs_.empty() && runs_.back().start + sector_id(runs_.back().count) == chain[i])
+            {
+                ++runs_.back().count;
+            }
+            else
+            {
+                runs_.push_back({i, chain[i], 1});
+            }
+        }
+
+        auto start = reinterpret_cast<char *>(buffer_.data());
+        setg(start, start, start);
     }
 
     compound_document_istreambuf(const compound_document_istreambuf &) = delete;
@@ -117,167 +184,182 @@ public:
     ~compound_document_istreambuf() override;
 
 private:
-    std::streamsize xsgetn(char *c, std::streamsize count) override
+    struct sector_run
     {
-        auto bytes_read = std::streamsize(0);
-
-        const auto sector_chain = short_stream() ? document_.ssat_ : document_.sat_;
-        const auto chain = document_.follow_chain(entry_.start, sector_chain);
-        const auto sector_size = short_stream() ? document_.short_sector_size() : document_.sector_size();
-        auto current_sector = chain[position_ / sector_size];
-        auto remaining = std::min(std::size_t(entry_.size) - position_, std::size_t(count));
+        // index of the first sector of the run within the stream
+        std::size_t first;
+        sector_id start;
+        std::size_t count;
+    };
 
-        while (remaining)
-        {
-            if (current_sector_.empty() || chain[position_ / sector_size] != current_sector)
-            {
-                current_sector = chain[position_ / sector_size];
-                sector_writer_.reset();
-                if (short_stream())
-                {
-                    document_.read_short_sector(current_sector, sector_writer_);
-                }
-                else
-                {
-                    document_.read_sector(current_sector, sector_writer_);
-                }
-            }
+    static const std::size_t buffer_length = 64 * 1024;
 
-            const auto available = std::min(entry_.size - position_,
-                sector_size - position_ % sector_size);
-            const auto to_read = std::min(available, std::size_t(remaining));
+    bool short_stream() const
+    {
+        return entry_.size < document_.header_.threshold;
+    }
 
-            auto start = current_sector_.begin() + static_cast<std::ptrdiff_t>(position_ % sector_size);
-            auto end = start + static_cast<std::ptrdiff_t>(to_read);
+    std::size_t current_position() const
+    {
+        return window_start_ + static_cast<std::size_t>(gptr() - eback());
+    }
 
-            for (auto i = start; i < end; ++i)
-            {
-                *(c++) = static_cast<char>(*i);
-            }
+    void reset_window(std::size_t position)
+    {
+        window_start_ = position;
+        auto start = reinterpret_cast<char *>(buffer_.data());
+        setg(start, start, start);
+    }
 
-            remaining -= to_read;
-            position_ += to_read;
-            bytes_read += to_read;
-        }
+    // Copies count bytes of the stream from position on, one read per run of sectors.
+    void read_range(std::size_t position, char *destination, std::size_t count)
+    {
+        auto run = std::upper_bound(runs_.begin(), runs_.end(), position / sector_size_,
+                       [](std::size_t index, const sector_run &r) { return index < r.first; })
+            - 1;
 
-        if (position_ < entry_.size && chain[position_ / sector_size] != current_sector)
+        while (count > 0)
         {
-            current_sector = chain[position_ / sector_size];
-            sector_writer_.reset();
+            const auto run_offset = position - run->first * sector_size_;
+            const auto bytes = std::min(count, run->count * sector_size_ - run_offset);
+            const auto offset = static_cast<std::size_t>(run->start) * sector_size_ + run_offset;
+
             if (short_stream())
             {
-                document_.read_short_sector(current_sector, sector_writer_);
+                document_.read_short_stream_bytes(offset, reinterpret_cast<byte *>(destination), bytes);
             }
             else
             {
-                document_.read_sector(current_sector, sector_writer_);
+                document_.read_bytes(document_.sector_data_start() + offset,
+                    reinterpret_cast<byte *>(destination), bytes);
             }
-        }
-
-        return bytes_read;
-    }
 
-    bool short_stream()
-    {
-        return entry_.size < document_.header_.threshold;
+            position += bytes;
+            destination += bytes;
+            count -= bytes;
+            ++run;
+        }
     }
 
     int_type underflow() override
     {
-        if (position_ >= entry_.size)
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        const auto position = current_position();
+
+        if (position >= entry_.size)
         {
             return traits_type::eof();
         }
 
-        auto old_position = position_;
-        auto result = '\0';
-        xsgetn(&result, 1);
-        position_ = old_position;
+        const auto bytes = std::min(buffer_.size(), std::size_t(entry_.size) - position);
+        auto start = reinterpret_cast<char *>(buffer_.data());
+        read_range(position, start, bytes);
+        window_start_ = position;
+        setg(start, start, start + bytes);
 
-        return result;
+        return traits_type::to_int_type(*gptr());
     }
 
-    int_type uflow() override
+    std::streamsize xsgetn(char *c, std::streamsize count) override
     {
-        auto result = underflow();
-        ++position_;
+        auto copied = std::streamsize(0);
+
+        while (copied < count)
+        {
+            if (gptr() == egptr())
+            {
+                const auto position = current_position();
+                const auto wanted = static_cast<std::size_t>(count - copied);
+
+                if (position >= entry_.size)
+                {
+                    break;
+                }
+
+                if (wanted >= buffer_.size())
+                {
+                    // large reads go straight to the destination
+                    const auto bytes = std::min(wanted, std::size_t(entry_.size) - position);
+                    read_range(position, c + copied, bytes);
+                    copied += static_cast<std::streamsize>(bytes);
+                    reset_window(position + bytes);
+
+                    continue;
+                }
 
-        return result;
+                underflow();
+            }
+
+            const auto bytes = std::min(static_cast<std::streamsize>(egptr() - gptr()), count - copied);
+            std::memcpy(c + copied, gptr(), static_cast<std::size_t>(bytes));
+            gbump(static_cast<int>(bytes));
+            copied += bytes;
+        }
+
+        return copied;
     }
 
     std::streamsize showmanyc() override
     {
-        if (position_ == entry_.size)
+        const auto position = current_position();
+
+        if (position >= entry_.size)
         {
             return static_cast<std::streamsize>(-1);
         }
 
-        return static_cast<std::streamsize>(entry_.size - position_);
+        return static_cast<std::streamsize>(entry_.size - position);
     }
 
     std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode) override
     {
-        if (way == std::ios_base::beg)
+        auto base = std::streamoff(0);
+
+        if (way == std::ios_base::cur)
         {
-            position_ = 0;
+            base = static_cast<std::streamoff>(current_position());
         }
         else if (way == std::ios_base::end)
         {
-            position_ = entry_.size;
+            base = static_cast<std::streamoff>(entry_.size);
         }
 
-        if (off < 0)
-        {
-            if (static_cast<std::size_t>(-off) > position_)
-            {
-                position_ = 0;
-                return static_cast<std::ptrdiff_t>(-1);
-            }
-            else
-            {
-                position_ -= static_cast<std::size_t>(-off);
-            }
-        }
-        else if (off > 0)
+        const auto target = base + off;
+
+        if (target < 0 || target > static_cast<std::streamoff>(entry_.size))
         {
-            if (static_cast<std::size_t>(off) + position_ > entry_.size)
-            {
-                position_ = entry_.size;
-                return static_cast<std::ptrdiff_t>(-1);
-            }
-            else
-            {
-                position_ += static_cast<std::size_t>(off);
-            }
+            return std::streampos(std::streamoff(-1));
         }
 
-        return static_cast<std::ptrdiff_t>(position_);
-    }
+        const auto position = static_cast<std::size_t>(target);
 
-    std::streampos seekpos(std::streampos sp, std::ios_base::openmode) override
-    {
-        if (sp < 0)
+        if (position >= window_start_ && position < window_start_ + static_cast<std::size_t>(egptr() - eback()))
         {
-            position_ = 0;
-        }
-        else if (static_cast<std::size_t>(sp) > entry_.size)
-        {
-            position_ = entry_.size;
+            setg(eback(), eback() + (position - window_start_), egptr());
         }
         else
         {
-            position_ = static_cast<std::size_t>(sp);
+            reset_window(position);
         }
 
-        return static_cast<std::ptrdiff_t>(position_);
+        return std::streampos(target);
+    }
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode which) override
+    {
+        return seekoff(std::streamoff(sp), std::ios_base::beg, which);
     }
 
-private:
     const compound_document_entry &entry_;
     compound_document &document_;
-    std::vector<byte> current_sector_;
-    binary_writer<byte> sector_writer_;
-    std::size_t position_;
+    const std::size_t sector_size_;
+    std::vector<sector_run> runs_;
+    std::vector<byte> buffer_;
+    std::size_t window_start_;
 };
 
 compound_document_istreambuf::~compound_document_istreambuf()
@@ -508,6 +590,7 @@ compound_document::compound_document(std::ostream &out)
 
 compound_document::compound_document(std::istream &in)
     : in_(&in),
+      memory_source_(dynamic_cast<const memory_istreambuf *>(in.rdbuf())),
       stream_in_(nullptr),
       stream_out_(nullptr)
 {
@@ -516,6 +599,14 @@ compound_document::compound_document(std::istream &in)
     read_sat();
     read_ssat();
     read_directory();
+
+    for (auto entry_id = std::size_t(0); entry_id < entries_.size(); ++entry_id)
+    {
+        if (entries_[entry_id].type == compound_document_entry::entry_type::UserStream)
+        {
+            read_streams_.emplace(tree_path(directory_id(entry_id)), directory_id(entry_id));
+        }
+    }
 }
 
 compound_document::~compound_document()
@@ -540,13 +631,15 @@ std::size_t compound_document::short_sector_size()
 
 std::istream &compound_document::open_read_stream(const std::string &name)
 {
-    if (!contains_entry(name, compound_document_entry::entry_type::UserStream))
+    // the directory was indexed when the document was read
+    const auto match = read_streams_.find(name);
+
+    if (match == read_streams_.end())
     {
         throw xlnt::exception("not found");
     }
 
-    const auto entry_id = find_entry(name, compound_document_entry::entry_type::UserStream);
-    const auto &entry = entries_.at(static_cast<std::size_t>(entry_id));
+    const auto &entry = entries_.at(static_cast<std::size_t>(match->second));
 
     stream_in_buffer_.reset(new compound_document_istreambuf(entry, *this));
     stream_in_.rdbuf(stream_in_buffer_.get());
@@ -586,51 +679,107 @@ void compound_document::write_short_sector(binary_reader<T> &reader, sector_id i
         static_cast<std::ptrdiff_t>(std::min(short_sector_size(), reader.bytes() - reader.offset())));
 }
 
-template <typename T>
-void compound_document::read_sector(sector_id id, binary_writer<T> &writer)
+void compound_document::read_bytes(std::size_t offset, byte *destination, std::size_t count)
 {
-    in_->seekg(static_cast<std::ptrdiff_t>(sector_data_start() + sector_size() * static_cast<std::size_t>(id)));
-    std::vector<byte> sector(sector_size(), 0);
-    in_->read(reinterpret_cast<char *>(sector.data()), static_cast<std::ptrdiff_t>(sector_size()));
-    writer.append(sector);
+    if (memory_source_ != nullptr)
+    {
+        // sectors are copied straight out of the source's memory
+        const auto available = offset < memory_source_->size() ? std::min(count, memory_source_->size() - offset) : 0;
+        if (available > 0)
+        {
+            std::memcpy(destination, memory_source_->data() + offset, available);
+        }
+        std::fill(destination + available, destination + count, byte(0));
+
+        return;
+    }
+
+    in_->clear();
+    in_->seekg(static_cast<std::streamoff>(offset));
+    in_->read(reinterpret_cast<char *>(destination), static_cast<std::streamsize>(count));
+    const auto available = static_cast<std::size_t>(std::max(in_->gcount(), std::streamsize(0)));
+    std::fill(destination + available, destination + count, byte(0));
 }
 
-template <typename T>
-void compound_document::read_sector_chain(sector_id start, binary_writer<T> &writer)
+void compound_document::read_short_stream_bytes(std::size_t offset, byte *destination, std::size_t count)
 {
-    for (auto link : follow_chain(start, sat_))
+    if (!short_stream_container_read_)
     {
-        read_sector(link, writer);
+        // the container of the short streams is only read once
+        auto container_writer = binary_writer<byte>(short_stream_container_);
+        read_sector_chain(entries_[0].start, container_writer);
+        short_stream_container_read_ = true;
     }
+
+    if (offset > short_stream_container_.size() || count > short_stream_container_.size() - offset)
+    {
+        throw xlnt::exception("reading past end");
+    }
+
+    std::memcpy(destination, short_stream_container_.data() + offset, count);
 }
 
 template <typename T>
-void compound_document::read_sector_chain(sector_id start, binary_writer<T> &writer, sector_id offset, std::size_t count)
+void compound_document::read_sectors(sector_id first, std::size_t count, binary_writer<T> &writer)
 {
-    auto chain = follow_chain(start, sat_);
+    const auto bytes = count * sector_size();
+    const auto start = writer.offset() * sizeof(T);
 
-    for (auto i = std::size_t(0); i < count; ++i)
+    if (writer.bytes() < start + bytes)
     {
-        read_sector(chain[offset + i], writer);
+        writer.resize((start + bytes) / sizeof(T));
     }
+
+    read_bytes(sector_data_start() + sector_size() * static_cast<std::size_t>(first),
+        reinterpret_cast<byte *>(writer.data().data()) + start, bytes);
+    writer.offset(writer.offset() + bytes / sizeof(T));
 }
 
 template <typename T>
-void compound_document::read_short_sector(sector_id id, binary_writer<T> &writer)
+void compound_document::read_sector(sector_id id, binary_writer<T> &writer)
+{
+    read_sectors(id, 1, writer);
+}
+
+template <typename T>
+void compound_document::read_sector_chain(sector_id start, binary_writer<T> &writer)
 {
-    const auto container_chain = follow_chain(entries_[0].start, sat_);
-    auto container = std::vector<byte>();
-    auto container_writer = binary_writer<byte>(container);
+    const auto chain = follow_chain(start, sat_);
+    read_sector_chain(start, writer, 0, chain.size());
+}
 
-    for (auto sector : container_chain)
+template <typename T>
+void compound_document::read_sector_chain(sector_id start, binary_writer<T> &writer, sector_id offset, std::size_t count)
+{
+    const auto chain = follow_chain(start, sat_);
+    const auto first = static_cast<std::size_t>(offset);
+
+    if (first > chain.size() || count > chain.size() - first)
     {
-        read_sector(sector, container_writer);
+        throw xlnt::exception("reading past end");
     }
 
-    auto container_reader = binary_reader<byte>(container);
-    container_reader.offset(static_cast<std::size_t>(id) * short_sector_size());
+    // consecutive sectors are read together
+    for (auto i = first; i < first + count;)
+    {
+        auto run = std::size_t(1);
+
+        while (i + run < first + count && chain[i + run] == chain[i] + sector_id(run))
+        {
+            ++run;
+        }
 
-    writer.append(container_reader, short_sector_size());
+        read_sectors(chain[i], run, writer);
+        i += run;
+    }
+}
+
+template <typename T>
+void compound_document::read_short_sector(sector_id id, binary_writer<T> &writer)
+{
+    std::vector<byte> sector(short_sector_size());
+    read_short_stream_bytes(static_cast<std::size_t>(id) * short_sector_size(), sector.data(), sector.size());
+    writer.append(sector);
 }
 
 template <typename T>
@@ -649,7 +798,7 @@ void compound_document::read_short_sector_chain(sector_id start, binary_writer<T
 
     for (auto i = std::size_t(0); i < count; ++i)
     {
-        read_short_sector(chain[offset + i], writer);
+        read_short_sector(chain[static_cast<std::size_t>(offset) + i], writer);
     }
 }
 
@@ -720,6 +869,11 @@ sector_chain compound_document::follow_chain(sector_id start, const sector_chain
 
     while (current >= 0)
     {
+        if (static_cast<std::size_t>(current) >= table.size() || chain.size() >= table.size())
+        {
+            throw xlnt::exception("invalid sector chain");
+        }
+
         chain.push_back(current);
         current = table[static_cast<std::size_t>(current)];
     }
@@ -1248,20 +1402,28 @@ void compound_document::read_msat()
     auto msat_sector = header_.extra_msat_start;
     auto msat_writer = binary_writer<sector_id>(msat_);
 
-    for (auto i = std::uint32_t(0); i < header_.num_msat_sectors; ++i)
+    const auto header_ids = std::min(header_.num_msat_sectors, std::uint32_t(header_.msat.size()));
+
+    for (auto i = std::uint32_t(0); i < header_ids; ++i)
     {
-        if (i < std::uint32_t(109))
-        {
-            msat_writer.write(header_.msat[i]);
-        }
-        else
-        {
-            read_sector(msat_sector, msat_writer);
+        msat_writer.write(header_.msat[i]);
+    }
 
-            msat_sector = msat_.back();
-            msat_.pop_back();
-        }
+    // each extension sector lists the ids of up to 127 more sat sectors followed by the next extension
+    for (auto i = std::uint32_t(0); msat_.size() < header_.num_msat_sectors && i < header_.num_extra_msat_sectors; ++i)
+    {
+        read_sector(msat_sector, msat_writer);
+
+        msat_sector = msat_.back();
+        msat_.pop_back();
+    }
+
+    if (msat_.size() < header_.num_msat_sectors)
+    {
+        throw xlnt::exception("missing sector allocation table sectors");
     }
+
+    msat_.resize(header_.num_msat_sectors);
 }
 
 void compound_document::read_sat()
@@ -1361,5 +1523,249 @@ void compound_document::write_entry(directory_id id)
     out_->write(reinterpret_cast<char *>(&entries_[static_cast<std::size_t>(id)]), sizeof(compound_document_entry));
 }
 
+compound_document_writer::compound_document_writer(std::ostream &out, const std::string &large_stream)
+    : out_(out),
+      start_(out.tellp()),
+      large_stream_(large_stream)
+{
+    // the header is written by close, once the position of the tables is known
+    const auto header = std::vector<byte>(sizeof(compound_document_header), 0);
+    out_.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+}
+
+void compound_document_writer::write(const byte *data, std::size_t count)
+{
+    out_.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(count));
+    large_size_ += count;
+}
+
+void compound_document_writer::overwrite(std::size_t offset, const byte *data, std::size_t count)
+{
+    if (offset + count > large_size_)
+    {
+        throw xlnt::exception("overwriting past the end of the stream");
+    }
+
+    const auto data_start = start_ + static_cast<std::streamoff>(sizeof(compound_document_header));
+    out_.seekp(data_start + static_cast<std::streamoff>(offset));
+    out_.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(count));
+    out_.seekp(data_start + static_cast<std::streamoff>(large_size_));
+}
+
+void compound_document_writer::add_small_stream(const std::string &name, const std::vector<byte> &data)
+{
+    if (data.size() >= compound_document_header().threshold)
+    {
+        throw xlnt::exception("stream too large for the mini stream");
+    }
+
+    small_streams_.emplace_back(name, data);
+}
+
+void compound_document_writer::write_sector_ids(const std::vector<sector_id> &ids)
+{
+    out_.write(reinterpret_cast<const char *>(ids.data()), static_cast<std::streamsize>(ids.size() * sizeof(sector_id)));
+}
+
+void compound_document_writer::close()
+{
+    auto header = compound_document_header();
+    const auto sector_size = std::size_t(1) << header.sector_size_power;
+    const auto short_sector_size = std::size_t(1) << header.short_sector_size_power;
+    const auto ids_per_sector = sector_size / sizeof(sector_id);
+    const auto header_ids = header.msat.size();
+
+    if (large_size_ < header.threshold)
+    {
+        throw xlnt::exception("stream too small for a compound document writer");
+    }
+
+    if (large_size_ > std::uint64_t(0xFFFFFFFF))
+    {
+        throw xlnt::exception("stream too large for a compound document");
+    }
+
+    const auto large_sectors = static_cast<std::size_t>((large_size_ + sector_size - 1) / sector_size);
+    const auto large_padding = std::vector<byte>(large_sectors * sector_size - static_cast<std::size_t>(large_size_), 0);
+    out_.write(reinterpret_cast<const char *>(large_padding.data()), static_cast<std::streamsize>(large_padding.size()));
+
+    // the small streams follow each other in the mini stream, each from a new short sector
+    auto mini_stream = std::vector<byte>();
+    auto short_sectors = std::vector<sector_id>();
+    auto short_starts = std::vector<sector_id>();
+
+    for (const auto &stream : small_streams_)
+    {
+        const auto first = mini_stream.size() / short_sector_size;
+        const auto count = (stream.second.size() + short_sector_size - 1) / short_sector_size;
+        short_starts.push_back(count == 0 ? EndOfChain : sector_id(first));
+
+        for (auto i = std::size_t(0); i < count; ++i)
+        {
+            short_sectors.push_back(i + 1 < count ? sector_id(first + i + 1) : EndOfChain);
+        }
+
+        mini_stream.insert(mini_stream.end(), stream.second.begin(), stream.second.end());
+        mini_stream.resize((first + count) * short_sector_size, 0);
+    }
+
+    const auto mini_stream_size = mini_stream.size();
+    const auto entries_per_sector = sector_size / sizeof(compound_document_entry);
+    const auto mini_sectors = (mini_stream_size + sector_size - 1) / sector_size;
+    const auto ssat_sectors = (short_sectors.size() + ids_per_sector - 1) / ids_per_sector;
+    const auto directory_sectors = (small_streams_.size() + 2 + entries_per_sector - 1) / entries_per_sector;
+
+    // the allocation table covers its own sectors and the sectors extending its index
+    const auto other_sectors = large_sectors + mini_sectors + ssat_sectors + directory_sectors;
+    auto sat_sectors = std::size_t(0);
+    auto msat_sectors = std::size_t(0);
+
+    while (true)
+    {
+        const auto needed_sat = (other_sectors + sat_sectors + msat_sectors + ids_per_sector - 1) / ids_per_sector;
+        const auto needed_msat = needed_sat > header_ids
+            ? (needed_sat - header_ids + ids_per_sector - 2) / (ids_per_sector - 1)
+            : std::size_t(0);
+
+        if (needed_sat == sat_sectors && needed_msat == msat_sectors)
+        {
+            break;
+        }
+
+        sat_sectors = needed_sat;
+        msat_sectors = needed_msat;
+    }
+
+    const auto mini_start = large_sectors;
+    const auto ssat_start = mini_start + mini_sectors;
+    const auto directory_start = ssat_start + ssat_sectors;
+    const auto sat_start = directory_start + directory_sectors;
+    const auto msat_start = sat_start + sat_sectors;
+    const auto sector_count = msat_start + msat_sectors;
+
+    mini_stream.resize(mini_sectors * sector_size, 0);
+    out_.write(reinterpret_cast<const char *>(mini_stream.data()), static_cast<std::streamsize>(mini_stream.size()));
+
+    short_sectors.resize(ssat_sectors * ids_per_sector, FreeSector);
+    write_sector_ids(short_sectors);
+
+    auto entries = std::vector<compound_document_entry>(directory_sectors * entries_per_sector);
+
+    for (auto &entry : entries)
+    {
+        entry.ignore.fill(0);
+        entry.ignore2 = 0;
+    }
+
+    entries[0].name("Root Entry");
+    entries[0].type = compound_document_entry::entry_type::RootStorage;
+    entries[0].start = mini_sectors == 0 ? EndOfChain : sector_id(mini_start);
+    entries[0].size = static_cast<std::uint32_t>(mini_stream_size);
+
+    entries[1].name(large_stream_);
+    entries[1].type = compound_document_entry::entry_type::UserStream;
+    entries[1].start = 0;
+    entries[1].size = static_cast<std::uint32_t>(large_size_);
+
+    for (auto i = std::size_t(0); i < small_streams_.size(); ++i)
+    {
+        auto &entry = entries[i + 2];
+        entry.name(small_streams_[i].first);
+        entry.type = compound_document_entry::entry_type::UserStream;
+        entry.start = short_starts[i];
+        entry.size = static_cast<std::uint32_t>(small_streams_[i].second.size());
+    }
+
+    auto siblings = std::vector<directory_id>();
+
+    for (auto i = std::size_t(1); i < small_streams_.size() + 2; ++i)
+    {
+        siblings.push_back(directory_id(i));
+    }
+
+    std::sort(siblings.begin(), siblings.end(), [&entries](directory_id left, directory_id right) {
+        return entry_name_less(entries[static_cast<std::size_t>(left)].name(),
+            entries[static_cast<std::size_t>(right)].name());
+    });
+
+    auto full_levels = std::size_t(0);
+
+    while ((std::size_t(2) << full_levels) - 1 <= siblings.size())
+    {
+        ++full_levels;
+    }
+
+    entries[0].child = link_entries(entries, siblings, 0, siblings.size(), 0, full_levels);
+    out_.write(reinterpret_cast<const char *>(entries.data()),
+        static_cast<std::streamsize>(entries.size() * sizeof(compound_document_entry)));
+
+    // the allocation table is written a sector at a time so it isn't held in memory
+    const auto table_entry = [&](std::size_t id) {
+        const auto next_in = [id](std::size_t first, std::size_t count) {
+            return id + 1 < first + count ? sector_id(id + 1) : EndOfChain;
+        };
+
+        if (id < mini_start) return next_in(0, large_sectors);
+        if (id < ssat_start) return next_in(mini_start, mini_sectors);
+        if (id < directory_start) return next_in(ssat_start, ssat_sectors);
+        if (id < sat_start) return next_in(directory_start, directory_sectors);
+        if (id < msat_start) return SATSector;
+        if (id < sector_count) return MSATSector;
+
+        return FreeSector;
+    };
+
+    auto ids = std::vector<sector_id>(ids_per_sector);
+
+    for (auto sector = std::size_t(0); sector < sat_sectors; ++sector)
+    {
+        for (auto i = std::size_t(0); i < ids_per_sector; ++i)
+        {
+            ids[i] = table_entry(sector * ids_per_sector + i);
+        }
+
+        write_sector_ids(ids);
+    }
+
+    // the sat sectors after the first header_ids are listed in a chain of msat sectors,
+    // each ending with the id of the next
+    for (auto sector = std::size_t(0); sector < msat_sectors; ++sector)
+    {
+        std::fill(ids.begin(), ids.end(), FreeSector);
+
+        for (auto i = std::size_t(0); i + 1 < ids_per_sector; ++i)
+        {
+            const auto listed = header_ids + sector * (ids_per_sector - 1) + i;
+
+            if (listed < sat_sectors)
+            {
+                ids[i] = sector_id(sat_start + listed);
+            }
+        }
+
+        ids.back() = sector + 1 < msat_sectors ? sector_id(msat_start + sector + 1) : EndOfChain;
+        write_sector_ids(ids);
+    }
+
+    header.msat.fill(FreeSector);
+
+    for (auto i = std::size_t(0); i < std::min(sat_sectors, header_ids); ++i)
+    {
+        header.msat[i] = sector_id(sat_start + i);
+    }
+
+    header.num_msat_sectors = static_cast<std::uint32_t>(sat_sectors);
+    header.directory_start = sector_id(directory_start);
+    header.ssat_start = ssat_sectors == 0 ? EndOfChain : sector_id(ssat_start);
+    header.num_short_sectors = static_cast<std::uint32_t>(ssat_sectors);
+    header.extra_msat_start = msat_sectors == 0 ? EndOfChain : sector_id(msat_start);
+    header.num_extra_msat_sectors = static_cast<std::uint32_t>(msat_sectors);
+
+    const auto end = out_.tellp();
+    out_.seekp(start_);
+    out_.write(reinterpret_cast<const char *>(&header), sizeof(compound_document_header));
+    out_.seekp(end);
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -31,6 +31,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <detail/binary.hpp>
 #include <detail/unicode.hpp>
@@ -117,6 +119,7 @@ struct compound_document_entry
 
 class compound_document_istreambuf;
 class compound_document_ostreambuf;
+class memory_istreambuf;
 
 class compound_document
 {
@@ -134,6 +137,11 @@ private:
     friend class compound_document_istreambuf;
     friend class compound_document_ostreambuf;
 
+    void read_bytes(std::size_t offset, byte *destination, std::size_t count);
+    void read_short_stream_bytes(std::size_t offset, byte *destination, std::size_t count);
+
+    template<typename T>
+    void read_sectors(sector_id first, std::size_t count, binary_writer<T> &writer);
     template<typename T>
     void read_sector(sector_id id, binary_writer<T> &writer);
     template<typename T>
@@ -217,11 +225,63 @@ private:
     std::istream *in_;
     std::ostream *out_;
 
+    // set when in_ reads from memory, whose sectors are then copied without seeking
+    const memory_istreambuf *memory_source_ = nullptr;
+    std::vector<byte> short_stream_container_;
+    bool short_stream_container_read_ = false;
+    std::unordered_map<std::string, directory_id> read_streams_;
+
     std::unique_ptr<compound_document_istreambuf> stream_in_buffer_;
     std::istream stream_in_;
     std::unique_ptr<compound_document_ostreambuf> stream_out_buffer_;
     std::ostream stream_out_;
 };
 
+/// <summary>
+/// Writes a compound document to a seekable stream with one large stream, which is
+/// appended to sequentially without being held in memory, and any number of streams
+/// smaller than the mini stream threshold, which are kept until close. The large stream
+/// takes the sectors right after the header, so unlike compound_document, the allocation
+/// tables and the directory are written once by close instead of for every sector.
+/// </summary>
+class compound_document_writer
+{
+public:
+    compound_document_writer(std::ostream &out, const std::string &large_stream);
+
+    compound_document_writer(const compound_document_writer &) = delete;
+    compound_document_writer &operator=(const compound_document_writer &) = delete;
+
+    /// <summary>
+    /// Appends count bytes to the large stream.
+    /// </summary>
+    void write(const byte *data, std::size_t count);
+
+    /// <summary>
+    /// Replaces count bytes of the large stream which have already been written, starting at offset.
+    /// </summary>
+    void overwrite(std::size_t offset, const byte *data, std::size_t count);
+
+    /// <summary>
+    /// Adds a stream of less than 4096 bytes, which is stored in the mini stream.
+    /// </summary>
+    void add_small_stream(const std::string &name, const std::vector<byte> &data);
+
+    /// <summary>
+    /// Writes the mini stream, the allocation tables, the directory and the header. The
+    /// large stream must hold at least 4096 bytes by then.
+    /// </summary>
+    void close();
+
+private:
+    void write_sector_ids(const std::vector<sector_id> &ids);
+
+    std::ostream &out_;
+    std::streampos start_;
+    std::string large_stream_;
+    std::uint64_t large_size_ = 0;
+    std::vector<std::pair<std::string, std::vector<byte>>> small_streams_;
+};
+
 } // namespace detail
 } // namespace xlnt
@@ -27,34 +27,69 @@
 #include <detail/binary.hpp>
 #include <detail/cryptography/aes.hpp>
 #include <detail/cryptography/encryption_info.hpp>
+#include <detail/cryptography/encryption_key_impl.hpp>
+#include <detail/utils/trace.hpp>
 
 namespace {
 
 using xlnt::detail::encryption_info;
 
-std::vector<std::uint8_t> calculate_standard_key(
-    encryption_info::standard_encryption_info info,
-    const std::u16string &password)
+// Returns H_n, the hash of the salt and password hashed spin_count more times,
+// taking it from derived_keys if it has been derived before.
+std::vector<std::uint8_t> spun_password_hash(
+    xlnt::detail::hash_algorithm algorithm,
+    const std::vector<std::uint8_t> &salt,
+    const std::u16string &password,
+    std::size_t spin_count,
+    xlnt::detail::encryption_key_impl *derived_keys)
 {
-    // H_0 = H(salt + password)
-    auto salt_plus_password = info.salt;
     auto password_bytes = xlnt::detail::string_to_bytes(password);
+    auto cache_key = std::vector<std::uint8_t>();
+
+    if (derived_keys != nullptr)
+    {
+        auto writer = xlnt::detail::binary_writer<std::uint8_t>(cache_key);
+        writer.write(static_cast<std::uint32_t>(algorithm));
+        writer.write(static_cast<std::uint64_t>(spin_count));
+        writer.write(static_cast<std::uint64_t>(salt.size()));
+        writer.append(salt);
+        writer.append(password_bytes);
+
+        std::lock_guard<std::mutex> lock(derived_keys->mutex);
+        const auto match = derived_keys->spun_hashes.find(cache_key);
+
+        if (match != derived_keys->spun_hashes.end())
+        {
+            return match->second;
+        }
+    }
+
+    // H_0 = H(salt + password)
+    auto salt_plus_password = salt;
     std::copy(password_bytes.begin(),
         password_bytes.end(),
         std::back_inserter(salt_plus_password));
-    auto h_0 = hash(info.hash, salt_plus_password);
+    auto h_n = hash(algorithm, salt_plus_password);
 
     // H_n = H(iterator + H_n-1)
-    std::vector<std::uint8_t> iterator_plus_h_n(4, 0);
-    iterator_plus_h_n.insert(iterator_plus_h_n.end(), h_0.begin(), h_0.end());
-    std::uint32_t &iterator = *reinterpret_cast<std::uint32_t *>(iterator_plus_h_n.data());
-    std::vector<std::uint8_t> h_n;
-    for (iterator = 0; iterator < info.spin_count; ++iterator)
+    spin_hash(algorithm, h_n, spin_count);
+
+    if (derived_keys != nullptr)
     {
-        hash(info.hash, iterator_plus_h_n, h_n);
-        std::copy(h_n.begin(), h_n.end(), iterator_plus_h_n.begin() + 4);
+        std::lock_guard<std::mutex> lock(derived_keys->mutex);
+        derived_keys->spun_hashes.emplace(std::move(cache_key), h_n);
     }
 
+    return h_n;
+}
+
+std::vector<std::uint8_t> calculate_standard_key(
+    encryption_info::standard_encryption_info info,
+    const std::u16string &password,
+    xlnt::detail::encryption_key_impl *derived_keys)
+{
+    auto h_n = spun_password_hash(info.hash, info.salt, password, info.spin_count, derived_keys);
+
     // H_final = H(H_n + block)
     auto h_n_plus_block = h_n;
     const std::uint32_t block_number = 0;
@@ -104,27 +139,11 @@ std::vector<std::uint8_t> calculate_standard_key(
 
 std::vector<std::uint8_t> calculate_agile_key(
     encryption_info::agile_encryption_info info,
-    const std::u16string &password)
+    const std::u16string &password,
+    xlnt::detail::encryption_key_impl *derived_keys)
 {
-    // H_0 = H(salt + password)
-    auto salt_plus_password = info.key_encryptor.salt_value;
-    auto password_bytes = xlnt::detail::string_to_bytes(password);
-    std::copy(password_bytes.begin(),
-        password_bytes.end(),
-        std::back_inserter(salt_plus_password));
-
-    auto h_0 = hash(info.key_encryptor.hash, salt_plus_password);
-
-    // H_n = H(iterator + H_n-1)
-    std::vector<std::uint8_t> iterator_plus_h_n(4, 0);
-    iterator_plus_h_n.insert(iterator_plus_h_n.end(), h_0.begin(), h_0.end());
-    std::uint32_t &iterator = *reinterpret_cast<std::uint32_t *>(iterator_plus_h_n.data());
-    std::vector<std::uint8_t> h_n;
-    for (iterator = 0; iterator < info.key_encryptor.spin_count; ++iterator)
-    {
-        hash(info.key_encryptor.hash, iterator_plus_h_n, h_n);
-        std::copy(h_n.begin(), h_n.end(), iterator_plus_h_n.begin() + 4);
-    }
+    auto h_n = spun_password_hash(info.key_encryptor.hash, info.key_encryptor.salt_value,
+        password, info.key_encryptor.spin_count, derived_keys);
 
     static const std::size_t block_size = 8;
 
@@ -171,9 +190,11 @@ namespace detail {
 
 std::vector<std::uint8_t> encryption_info::calculate_key() const
 {
+    XLNT_TRACE_SCOPE("derive_key");
+
     return is_agile
-        ? calculate_agile_key(agile, password)
-        : calculate_standard_key(standard, password);
+        ? calculate_agile_key(agile, password, derived_keys.get())
+        : calculate_standard_key(standard, password, derived_keys.get());
 }
 
 } // namespace detail
@@ -22,7 +22,10 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#pragma once
+
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,12 +35,17 @@
 namespace xlnt {
 namespace detail {
 
+struct encryption_key_impl;
+
 struct encryption_info
 {
     bool is_agile = true;
 
     std::u16string password;
 
+    // hashes already derived from the password, or null to derive them every time
+    std::shared_ptr<encryption_key_impl> derived_keys;
+
     struct standard_encryption_info
     {
         std::size_t spin_count = 50000;
@@ -0,0 +1,54 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The password of an encryption_key and the hashes derived from it, which take
+/// most of the time of deriving a key.
+/// </summary>
+struct encryption_key_impl
+{
+    std::u16string password;
+
+    std::mutex mutex;
+
+    /// <summary>
+    /// Password hashes after spinning, by the hash algorithm, spin count, salt and
+    /// password they were derived from, so that keys for other passwords, like the
+    /// fixed one used for writing, are kept apart.
+    /// </summary>
+    std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>> spun_hashes;
+};
+
+} // namespace detail
+} // namespace xlnt
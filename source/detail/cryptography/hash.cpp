@@ -52,5 +52,21 @@ std::vector<std::uint8_t> hash(hash_algorithm algorithm, const std::vector<std::
     return output;
 }
 
+void spin_hash(hash_algorithm algorithm, std::vector<std::uint8_t> &digest, std::size_t spin_count)
+{
+    if (algorithm == hash_algorithm::sha512 && digest.size() == 64)
+    {
+        xlnt::detail::sha512_spin(digest.data(), spin_count);
+    }
+    else if (algorithm == hash_algorithm::sha1 && digest.size() == 20)
+    {
+        xlnt::detail::sha1_spin(digest.data(), spin_count);
+    }
+    else
+    {
+        throw xlnt::exception("unsupported hash algorithm");
+    }
+}
+
 }; // namespace detail
 }; // namespace xlnt
@@ -28,6 +28,7 @@
 
 #include <detail/cryptography/sha.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <detail/xlnt_config_impl.hpp>
 
 namespace xlnt {
 namespace detail {
@@ -46,8 +47,11 @@ enum class hash_algorithm
     whirlpool
 };
 
-void hash(hash_algorithm algorithm, const std::vector<std::uint8_t> &input, std::vector<std::uint8_t> &output);
-std::vector<std::uint8_t> hash(hash_algorithm algorithm, const std::vector<std::uint8_t> &input);
+XLNT_API_INTERNAL void hash(hash_algorithm algorithm, const std::vector<std::uint8_t> &input, std::vector<std::uint8_t> &output);
+XLNT_API_INTERNAL std::vector<std::uint8_t> hash(hash_algorithm algorithm, const std::vector<std::uint8_t> &input);
+
+// Applies the key derivation spin H_n = H(iterator + H_n-1) spin_count times to digest in place.
+XLNT_API_INTERNAL void spin_hash(hash_algorithm algorithm, std::vector<std::uint8_t> &digest, std::size_t spin_count);
 
 }; // namespace detail
 }; // namespace xlnt
@@ -24,11 +24,24 @@
 
 #include <cstring>
 
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) \
+    && (defined(__GNUC__) || defined(_MSC_VER))
+#define XLNT_SHA_NI
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
 #include <detail/cryptography/sha.hpp>
 
 extern "C" {
 
+extern void sha1_compress(uint32_t state[5], const uint8_t block[64]);
 extern void sha1_hash(const uint8_t *message, size_t len, uint32_t hash[5]);
+extern void sha512_compress(uint64_t state[8], const uint8_t block[128]);
 extern void sha512_hash(const uint8_t *message, size_t len, uint64_t hash[8]);
 }
 
@@ -72,6 +85,156 @@ void byteswap(std::uint64_t *arr, std::size_t len)
     }
 }
 
+void store_big_endian(std::uint32_t word, std::uint8_t *bytes)
+{
+    bytes[0] = static_cast<std::uint8_t>(word >> 24);
+    bytes[1] = static_cast<std::uint8_t>(word >> 16);
+    bytes[2] = static_cast<std::uint8_t>(word >> 8);
+    bytes[3] = static_cast<std::uint8_t>(word);
+}
+
+void store_big_endian(std::uint64_t word, std::uint8_t *bytes)
+{
+    store_big_endian(static_cast<std::uint32_t>(word >> 32), bytes);
+    store_big_endian(static_cast<std::uint32_t>(word), bytes + 4);
+}
+
+void store_little_endian(std::uint32_t word, std::uint8_t *bytes)
+{
+    bytes[0] = static_cast<std::uint8_t>(word);
+    bytes[1] = static_cast<std::uint8_t>(word >> 8);
+    bytes[2] = static_cast<std::uint8_t>(word >> 16);
+    bytes[3] = static_cast<std::uint8_t>(word >> 24);
+}
+
+const std::uint32_t sha1_initial_state[5] = {
+    0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+const std::uint64_t sha512_initial_state[8] = {
+    0x6A09E667F3BCC908, 0xBB67AE8584CAA73B, 0x3C6EF372FE94F82B, 0xA54FF53A5F1D36F1,
+    0x510E527FADE682D1, 0x9B05688C2B3E6C1F, 0x1F83D9ABFB41BD6B, 0x5BE0CD19137E2179};
+
+using sha1_compress_function = void (*)(std::uint32_t state[5], const std::uint8_t block[64]);
+
+#if defined(XLNT_SHA_NI)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define XLNT_SHA_TARGET
+#else
+#define XLNT_SHA_TARGET __attribute__((target("sha,sse4.1")))
+#endif
+
+bool hardware_sha_supported()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int registers[4] = {0, 0, 0, 0};
+    __cpuid(registers, 0);
+    const auto max_leaf = registers[0];
+    __cpuid(registers, 1);
+    const auto leaf1_ecx = static_cast<unsigned int>(registers[2]);
+    auto leaf7_ebx = 0u;
+    if (max_leaf >= 7)
+    {
+        __cpuidex(registers, 7, 0);
+        leaf7_ebx = static_cast<unsigned int>(registers[1]);
+    }
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+    const auto leaf1_ecx = ecx;
+    auto leaf7_ebx = 0u;
+    if (__get_cpuid_max(0, nullptr) >= 7)
+    {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        leaf7_ebx = ebx;
+    }
+#endif
+    // SSE4.1 in leaf 1 ecx, SHA in leaf 7 ebx
+    return (leaf1_ecx & (1u << 19)) != 0 && (leaf7_ebx & (1u << 29)) != 0;
+}
+
+// One group of four rounds: w holds the schedule words of this group, the other
+// three registers are advanced towards the words of the following groups.
+#define XLNT_SHA1_ROUNDS(f, e, e_next, w, w1, w2, w3) \
+    e = _mm_sha1nexte_epu32(e, w);                    \
+    e_next = abcd;                                    \
+    w1 = _mm_sha1msg2_epu32(w1, w);                   \
+    abcd = _mm_sha1rnds4_epu32(abcd, e, f);           \
+    w3 = _mm_sha1msg1_epu32(w3, w);                   \
+    w2 = _mm_xor_si128(w2, w);
+
+XLNT_SHA_TARGET void hardware_sha1_compress(std::uint32_t state[5], const std::uint8_t block[64])
+{
+    const auto byte_order = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)), 0x1B);
+    auto e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    const auto abcd_save = abcd;
+    const auto e0_save = e0;
+
+    auto m0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block)), byte_order);
+    auto m1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16)), byte_order);
+    auto m2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 32)), byte_order);
+    auto m3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 48)), byte_order);
+
+    e0 = _mm_add_epi32(e0, m0);
+    auto e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    e1 = _mm_sha1nexte_epu32(e1, m1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    m0 = _mm_sha1msg1_epu32(m0, m1);
+
+    e0 = _mm_sha1nexte_epu32(e0, m2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    m1 = _mm_sha1msg1_epu32(m1, m2);
+    m0 = _mm_xor_si128(m0, m2);
+
+    XLNT_SHA1_ROUNDS(0, e1, e0, m3, m0, m1, m2)
+    XLNT_SHA1_ROUNDS(0, e0, e1, m0, m1, m2, m3)
+    XLNT_SHA1_ROUNDS(1, e1, e0, m1, m2, m3, m0)
+    XLNT_SHA1_ROUNDS(1, e0, e1, m2, m3, m0, m1)
+    XLNT_SHA1_ROUNDS(1, e1, e0, m3, m0, m1, m2)
+    XLNT_SHA1_ROUNDS(1, e0, e1, m0, m1, m2, m3)
+    XLNT_SHA1_ROUNDS(1, e1, e0, m1, m2, m3, m0)
+    XLNT_SHA1_ROUNDS(2, e0, e1, m2, m3, m0, m1)
+    XLNT_SHA1_ROUNDS(2, e1, e0, m3, m0, m1, m2)
+    XLNT_SHA1_ROUNDS(2, e0, e1, m0, m1, m2, m3)
+    XLNT_SHA1_ROUNDS(2, e1, e0, m1, m2, m3, m0)
+    XLNT_SHA1_ROUNDS(2, e0, e1, m2, m3, m0, m1)
+    XLNT_SHA1_ROUNDS(3, e1, e0, m3, m0, m1, m2)
+    XLNT_SHA1_ROUNDS(3, e0, e1, m0, m1, m2, m3)
+    XLNT_SHA1_ROUNDS(3, e1, e0, m1, m2, m3, m0)
+    XLNT_SHA1_ROUNDS(3, e0, e1, m2, m3, m0, m1)
+    XLNT_SHA1_ROUNDS(3, e1, e0, m3, m0, m1, m2)
+
+    e0 = _mm_sha1nexte_epu32(e0, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#undef XLNT_SHA1_ROUNDS
+
+#endif
+
+sha1_compress_function select_sha1_compress()
+{
+#if defined(XLNT_SHA_NI)
+    if (hardware_sha_supported())
+    {
+        return hardware_sha1_compress;
+    }
+#endif
+    return sha1_compress;
+}
+
 } // namespace
 
 namespace xlnt {
@@ -101,5 +264,58 @@ void sha512(const std::vector<std::uint8_t> &input, std::vector<std::uint8_t> &o
     byteswap(output_pointer_u64, sha512_bytes / sizeof(std::uint64_t));
 }
 
+void sha1_spin(std::uint8_t *digest, std::size_t spin_count)
+{
+    static const sha1_compress_function compress = select_sha1_compress();
+
+    // the 4 byte iterator and the 20 byte digest always fit one padded block
+    std::uint8_t block[64] = {0};
+    std::memcpy(block + 4, digest, 20);
+    block[24] = 0x80;
+    block[63] = 24 * 8;
+
+    std::uint32_t state[5];
+
+    for (auto i = std::size_t(0); i < spin_count; ++i)
+    {
+        store_little_endian(static_cast<std::uint32_t>(i), block);
+        std::memcpy(state, sha1_initial_state, sizeof(state));
+        compress(state, block);
+
+        for (auto word = 0; word < 5; ++word)
+        {
+            store_big_endian(state[word], block + 4 + 4 * word);
+        }
+    }
+
+    std::memcpy(digest, block + 4, 20);
+}
+
+void sha512_spin(std::uint8_t *digest, std::size_t spin_count)
+{
+    // the 4 byte iterator and the 64 byte digest always fit one padded block
+    std::uint8_t block[128] = {0};
+    std::memcpy(block + 4, digest, 64);
+    block[68] = 0x80;
+    block[126] = (68 * 8) >> 8;
+    block[127] = (68 * 8) & 0xff;
+
+    std::uint64_t state[8];
+
+    for (auto i = std::size_t(0); i < spin_count; ++i)
+    {
+        store_little_endian(static_cast<std::uint32_t>(i), block);
+        std::memcpy(state, sha512_initial_state, sizeof(state));
+        sha512_compress(state, block);
+
+        for (auto word = 0; word < 8; ++word)
+        {
+            store_big_endian(state[word], block + 4 + 8 * word);
+        }
+    }
+
+    std::memcpy(digest, block + 4, 64);
+}
+
 } // namespace detail
 } // namespace xlnt
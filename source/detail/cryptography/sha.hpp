@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -33,5 +34,11 @@ namespace detail {
 void sha1(const std::vector<std::uint8_t> &input, std::vector<std::uint8_t> &output);
 void sha512(const std::vector<std::uint8_t> &data, std::vector<std::uint8_t> &output);
 
+// Replace digest, H_0, with H_spin_count where H_n = H(iterator + H_n-1) and the
+// iterator is n - 1 as four little-endian bytes. Each round hashes one fixed block
+// on the stack; sha1 uses the SHA extensions when the CPU has them.
+void sha1_spin(std::uint8_t *digest, std::size_t spin_count);
+void sha512_spin(std::uint8_t *digest, std::size_t spin_count);
+
 }; // namespace detail
 }; // namespace xlnt
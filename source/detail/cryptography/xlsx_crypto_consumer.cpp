@@ -22,23 +22,31 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <istream>
+#include <streambuf>
 #include <vector>
 
 #include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/encryption_key.hpp>
 #include <detail/binary.hpp>
 #include <detail/constants.hpp>
 #include <detail/cryptography/aes.hpp>
 #include <detail/cryptography/base64.hpp>
 #include <detail/cryptography/compound_document.hpp>
 #include <detail/cryptography/encryption_info.hpp>
+#include <detail/cryptography/encryption_key_impl.hpp>
 #include <detail/cryptography/value_traits.hpp>
 #include <detail/cryptography/xlsx_crypto_consumer.hpp>
 #include <detail/external/include_libstudxml.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/unicode.hpp>
+#include <detail/utils/parallel_for.hpp>
 #include <detail/utils/string_helpers.hpp>
+#include <detail/utils/trace.hpp>
 
 namespace {
 
@@ -46,29 +54,223 @@ using xlnt::detail::byte;
 using xlnt::detail::encryption_info;
 using xlnt::detail::read;
 
+const auto segment_length = std::size_t(4096);
+
+// segments are only decrypted in parallel once each thread gets at least this many
+const auto segments_per_thread = std::size_t(16);
+
+// Reads the ciphertext which follows the size field of an EncryptedPackage stream
+// into a buffer of decrypted_size rounded up to whole AES blocks. Packages whose
+// last segment was written without its padding are padded with zeros.
+std::vector<std::uint8_t> read_encrypted_package(
+    std::istream &encrypted_package_stream,
+    std::uint64_t decrypted_size)
+{
+    std::vector<std::uint8_t> ciphertext;
+    std::vector<char> chunk(64 * 1024);
+
+    while (encrypted_package_stream)
+    {
+        encrypted_package_stream.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        ciphertext.insert(ciphertext.end(), chunk.begin(), chunk.begin() + encrypted_package_stream.gcount());
+    }
+
+    if (ciphertext.size() < decrypted_size)
+    {
+        throw xlnt::exception("encrypted package is truncated");
+    }
+
+    ciphertext.resize(static_cast<std::size_t>((decrypted_size + 15) / 16 * 16), 0);
+
+    return ciphertext;
+}
+
+// Each segment of an agile package has its own iv, the hash of the salt followed by the segment index.
+std::vector<std::uint8_t> segment_iv(const encryption_info &info, std::size_t segment)
+{
+    auto salt_size = info.agile.key_data.salt_size;
+    auto salt_with_block_key = info.agile.key_data.salt_value;
+    salt_with_block_key.resize(salt_size + sizeof(std::uint32_t), 0);
+    const auto segment_index = static_cast<std::uint32_t>(segment);
+    std::memcpy(salt_with_block_key.data() + salt_size, &segment_index, sizeof(std::uint32_t));
+
+    auto iv = hash(info.agile.key_encryptor.hash, salt_with_block_key);
+    iv.resize(16);
+
+    return iv;
+}
+
+/// <summary>
+/// Reads the decrypted contents of an EncryptedPackage stream, decrypting only the
+/// window of segments around the current position. Seeking moves the window, which
+/// lets izstream read an encrypted package without the whole package in memory.
+/// </summary>
+class decrypting_istreambuf : public std::streambuf
+{
+public:
+    decrypting_istreambuf(const encryption_info &info, std::istream &encrypted_package_stream)
+        : info_(info),
+          key_(info.calculate_key()),
+          encrypted_(encrypted_package_stream),
+          ciphertext_(window_length),
+          plaintext_(window_length),
+          window_start_(0)
+    {
+        encrypted_.seekg(0, std::ios_base::end);
+        const auto stream_size = static_cast<std::uint64_t>(encrypted_.tellg());
+        encrypted_.seekg(0, std::ios_base::beg);
+        size_ = read<std::uint64_t>(encrypted_);
+
+        // the last segment may have been written without its padding
+        if (stream_size < sizeof(std::uint64_t) || stream_size - sizeof(std::uint64_t) < size_)
+        {
+            throw xlnt::exception("encrypted package is truncated");
+        }
+
+        auto start = reinterpret_cast<char *>(plaintext_.data());
+        setg(start, start, start);
+    }
+
+private:
+    static const std::size_t window_length = 16 * segment_length;
+
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        const auto position = window_start_ + static_cast<std::uint64_t>(gptr() - eback());
+
+        if (position >= size_)
+        {
+            return traits_type::eof();
+        }
+
+        load_window(position);
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize showmanyc() override
+    {
+        const auto position = current_position();
+        return position < size_ ? static_cast<std::streamsize>(size_ - position) : std::streamsize(-1);
+    }
+
+    std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode) override
+    {
+        auto base = std::uint64_t(0);
+
+        if (way == std::ios_base::cur)
+        {
+            base = current_position();
+        }
+        else if (way == std::ios_base::end)
+        {
+            base = size_;
+        }
+
+        if ((off < 0 && static_cast<std::uint64_t>(-off) > base)
+            || (off > 0 && static_cast<std::uint64_t>(off) > size_ - base))
+        {
+            return std::streampos(std::streamoff(-1));
+        }
+
+        const auto target = off < 0 ? base - static_cast<std::uint64_t>(-off) : base + static_cast<std::uint64_t>(off);
+        const auto window_size = static_cast<std::uint64_t>(egptr() - eback());
+
+        if (target >= window_start_ && target < window_start_ + window_size)
+        {
+            setg(eback(), eback() + (target - window_start_), egptr());
+        }
+        else
+        {
+            // the window is loaded by the next read
+            window_start_ = target;
+            auto start = reinterpret_cast<char *>(plaintext_.data());
+            setg(start, start, start);
+        }
+
+        return std::streampos(static_cast<std::streamoff>(target));
+    }
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode which) override
+    {
+        return seekoff(std::streamoff(sp), std::ios_base::beg, which);
+    }
+
+    std::uint64_t current_position()
+    {
+        return window_start_ + static_cast<std::uint64_t>(gptr() - eback());
+    }
+
+    void load_window(std::uint64_t position)
+    {
+        const auto first_segment = static_cast<std::size_t>(position / segment_length);
+        const auto start = std::uint64_t(first_segment) * segment_length;
+        const auto padded_size = (size_ + 15) / 16 * 16;
+        const auto length = static_cast<std::size_t>(std::min(std::uint64_t(window_length), padded_size - start));
+
+        encrypted_.clear();
+        encrypted_.seekg(static_cast<std::streamoff>(sizeof(std::uint64_t) + start), std::ios_base::beg);
+        encrypted_.read(reinterpret_cast<char *>(ciphertext_.data()), static_cast<std::streamsize>(length));
+        std::fill(ciphertext_.begin() + encrypted_.gcount(), ciphertext_.begin() + static_cast<std::ptrdiff_t>(length), 0);
+
+        for (auto offset = std::size_t(0); offset < length; offset += segment_length)
+        {
+            const auto bytes = std::min(length - offset, segment_length);
+
+            if (info_.is_agile)
+            {
+                const auto iv = segment_iv(info_, first_segment + offset / segment_length);
+                xlnt::detail::aes_cbc_decrypt(ciphertext_.data() + offset, bytes, key_, iv.data(),
+                    plaintext_.data() + offset);
+            }
+            else
+            {
+                xlnt::detail::aes_ecb_decrypt(ciphertext_.data() + offset, bytes, key_,
+                    plaintext_.data() + offset);
+            }
+        }
+
+        window_start_ = start;
+        const auto available = static_cast<std::size_t>(std::min(std::uint64_t(length), size_ - start));
+        auto data = reinterpret_cast<char *>(plaintext_.data());
+        setg(data, data + (position - start), data + available);
+    }
+
+    const encryption_info info_;
+    const std::vector<std::uint8_t> key_;
+    std::istream &encrypted_;
+    std::vector<std::uint8_t> ciphertext_;
+    std::vector<std::uint8_t> plaintext_;
+    std::uint64_t size_;
+    std::uint64_t window_start_;
+};
+
 std::vector<std::uint8_t> decrypt_xlsx_standard(
     encryption_info info,
     std::istream &encrypted_package_stream)
 {
+    XLNT_TRACE_SCOPE("decrypt_package");
     const auto key = info.calculate_key();
 
     auto decrypted_size = read<std::uint64_t>(encrypted_package_stream);
+    const auto ciphertext = read_encrypted_package(encrypted_package_stream, decrypted_size);
+    auto decrypted_package = std::vector<std::uint8_t>(ciphertext.size());
 
-    std::vector<std::uint8_t> encrypted_segment(4096, 0);
-    std::vector<std::uint8_t> decrypted_package;
+    const auto segments = (ciphertext.size() + segment_length - 1) / segment_length;
+    const auto thread_count = xlnt::detail::parallel_thread_count(segments, segments_per_thread);
 
-    while (encrypted_package_stream)
-    {
-        encrypted_package_stream.read(
-            reinterpret_cast<char *>(encrypted_segment.data()),
-            static_cast<std::streamsize>(encrypted_segment.size()));
-        auto decrypted_segment = xlnt::detail::aes_ecb_decrypt(encrypted_segment, key);
-
-        decrypted_package.insert(
-            decrypted_package.end(),
-            decrypted_segment.begin(),
-            decrypted_segment.end());
-    }
+    xlnt::detail::parallel_for(segments, thread_count, [&](std::size_t i) {
+        const auto offset = i * segment_length;
+        const auto bytes = std::min(ciphertext.size() - offset, segment_length);
+
+        xlnt::detail::aes_ecb_decrypt(ciphertext.data() + offset, bytes, key,
+            decrypted_package.data() + offset);
+    });
 
     decrypted_package.resize(static_cast<std::size_t>(decrypted_size));
 
@@ -79,35 +281,24 @@ std::vector<std::uint8_t> decrypt_xlsx_agile(
     const encryption_info &info,
     std::istream &encrypted_package_stream)
 {
+    XLNT_TRACE_SCOPE("decrypt_package");
     const auto key = info.calculate_key();
 
-    auto salt_size = info.agile.key_data.salt_size;
-    auto salt_with_block_key = info.agile.key_data.salt_value;
-    salt_with_block_key.resize(salt_size + sizeof(std::uint32_t), 0);
-
-    auto &segment = *reinterpret_cast<std::uint32_t *>(salt_with_block_key.data() + salt_size);
     auto total_size = read<std::uint64_t>(encrypted_package_stream);
+    const auto ciphertext = read_encrypted_package(encrypted_package_stream, total_size);
+    auto decrypted_package = std::vector<std::uint8_t>(ciphertext.size());
 
-    std::vector<std::uint8_t> encrypted_segment(4096, 0);
-    std::vector<std::uint8_t> decrypted_package;
+    const auto segments = (ciphertext.size() + segment_length - 1) / segment_length;
+    const auto thread_count = xlnt::detail::parallel_thread_count(segments, segments_per_thread);
 
-    while (encrypted_package_stream)
-    {
-        auto iv = hash(info.agile.key_encryptor.hash, salt_with_block_key);
-        iv.resize(16);
-
-        encrypted_package_stream.read(
-            reinterpret_cast<char *>(encrypted_segment.data()),
-            static_cast<std::streamsize>(encrypted_segment.size()));
-        auto decrypted_segment = xlnt::detail::aes_cbc_decrypt(encrypted_segment, key, iv);
-
-        decrypted_package.insert(
-            decrypted_package.end(),
-            decrypted_segment.begin(),
-            decrypted_segment.end());
+    xlnt::detail::parallel_for(segments, thread_count, [&](std::size_t i) {
+        const auto iv = segment_iv(info, i);
+        const auto offset = i * segment_length;
+        const auto bytes = std::min(ciphertext.size() - offset, segment_length);
 
-        ++segment;
-    }
+        xlnt::detail::aes_cbc_decrypt(ciphertext.data() + offset, bytes, key, iv.data(),
+            decrypted_package.data() + offset);
+    });
 
     decrypted_package.resize(static_cast<std::size_t>(total_size));
 
@@ -259,6 +450,7 @@ encryption_info::agile_encryption_info read_agile_encryption_info(std::istream &
 
 encryption_info read_encryption_info(std::istream &info_stream, const std::u16string &password)
 {
+    XLNT_TRACE_SCOPE("read_encryption_info");
     encryption_info info;
 
     info.password = password;
@@ -347,27 +539,52 @@ std::vector<std::uint8_t> decrypt_xlsx(const std::vector<std::uint8_t> &data, st
 }
 #endif
 
-template <typename T>
-void xlsx_consumer::read_internal(std::istream &source, const T &password)
+void xlsx_consumer::read_encrypted(std::istream &source, const std::u16string &password,
+    std::shared_ptr<encryption_key_impl> derived_keys)
 {
-    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(source)), (std::istreambuf_iterator<char>()));
-    const auto decrypted = decrypt_xlsx(data, password);
-    vector_istreambuf decrypted_buffer(decrypted);
+    if (source.tellg() != std::streampos(0))
+    {
+        // the compound document is read from the start of a seekable stream
+        std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(source)), (std::istreambuf_iterator<char>()));
+        vector_istreambuf data_buffer(data);
+        std::istream data_stream(&data_buffer);
+
+        return read_encrypted(data_stream, password, derived_keys);
+    }
+
+    if (source.peek() == std::istream::traits_type::eof())
+    {
+        throw xlnt::exception("empty file");
+    }
+
+    compound_document document(source);
+
+    auto &encryption_info_stream = document.open_read_stream("/EncryptionInfo");
+    auto encryption_info = read_encryption_info(encryption_info_stream, password);
+    encryption_info.derived_keys = derived_keys;
+
+    // the package is decrypted as izstream reads it
+    decrypting_istreambuf decrypted_buffer(encryption_info, document.open_read_stream("/EncryptedPackage"));
     std::istream decrypted_stream(&decrypted_buffer);
     read(decrypted_stream);
 }
 
 void xlsx_consumer::read(std::istream &source, const std::string &password)
 {
-    return read_internal(source, password);
+    return read_encrypted(source, utf8_to_utf16(password), nullptr);
 }
 
 #if XLNT_HAS_FEATURE(U8_STRING_VIEW)
 void xlsx_consumer::read(std::istream &source, std::u8string_view password)
 {
-    return read_internal(source, password);
+    return read_encrypted(source, utf8_to_utf16(password), nullptr);
 }
 #endif
 
+void xlsx_consumer::read(std::istream &source, const encryption_key &key)
+{
+    return read_encrypted(source, key.d_->password, key.d_);
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -22,12 +22,18 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/encryption_key.hpp>
 #include <detail/constants.hpp>
 #include <detail/cryptography/aes.hpp>
 #include <detail/cryptography/base64.hpp>
 #include <detail/cryptography/compound_document.hpp>
 #include <detail/cryptography/encryption_info.hpp>
+#include <detail/cryptography/encryption_key_impl.hpp>
 #include <detail/cryptography/value_traits.hpp>
 #include <detail/cryptography/xlsx_crypto_producer.hpp>
 #include <detail/external/include_libstudxml.hpp>
@@ -35,7 +41,9 @@
 #include <detail/serialization/xlsx_producer.hpp>
 #include <detail/serialization/zstream.hpp>
 #include <detail/unicode.hpp>
+#include <detail/utils/parallel_for.hpp>
 #include <detail/utils/string_helpers.hpp>
+#include <detail/utils/trace.hpp>
 
 namespace {
 
@@ -101,6 +109,18 @@ encryption_info generate_encryption_info(const std::u16string & /*password*/)
     return result;
 }
 
+// The encryption info used for writing, whose key is always derived from the
+// same password for now.
+encryption_info writing_encryption_info(const std::u16string &password,
+    std::shared_ptr<xlnt::detail::encryption_key_impl> derived_keys = nullptr)
+{
+    auto result = generate_encryption_info(password);
+    result.password = u"secret";
+    result.derived_keys = derived_keys;
+
+    return result;
+}
+
 void write_agile_encryption_info(
     const encryption_info &info,
     std::ostream &info_stream)
@@ -209,37 +229,73 @@ void write_standard_encryption_info(const encryption_info &info, std::ostream &i
         static_cast<std::streamsize>(result.size()));
 }
 
+const auto segment_length = std::size_t(4096);
+
+// segments are only encrypted in parallel once each thread gets at least this many
+const auto segments_per_thread = std::size_t(16);
+
+// the number of segments encrypting_ostreambuf buffers before encrypting them
+const auto segments_per_batch = std::size_t(256);
+
+// Returns plaintext padded with zeros to whole AES blocks. The last segment of a
+// package is written padded, the real length is stored in front of the segments.
+std::vector<std::uint8_t> pad_to_blocks(const std::vector<std::uint8_t> &plaintext)
+{
+    auto padded = plaintext;
+    padded.resize((plaintext.size() + 15) / 16 * 16, 0);
+
+    return padded;
+}
+
+// Encrypts the segment at the given index of padded into ciphertext with the key,
+// where the package starts with segment first_segment.
+void encrypt_agile_segment(
+    const encryption_info &info,
+    const std::vector<std::uint8_t> &key,
+    std::size_t index,
+    const std::vector<std::uint8_t> &padded,
+    std::vector<std::uint8_t> &ciphertext,
+    std::size_t first_segment = 0)
+{
+    // each segment's iv is the hash of the salt followed by the segment index
+    auto salt_size = info.agile.key_data.salt_size;
+    auto salt_with_block_key = info.agile.key_data.salt_value;
+    salt_with_block_key.resize(salt_size + sizeof(std::uint32_t), 0);
+    const auto segment = static_cast<std::uint32_t>(first_segment + index);
+    std::memcpy(salt_with_block_key.data() + salt_size, &segment, sizeof(std::uint32_t));
+
+    auto iv = hash(info.agile.key_encryptor.hash, salt_with_block_key);
+    iv.resize(16);
+
+    const auto offset = index * segment_length;
+    const auto bytes = std::min(padded.size() - offset, segment_length);
+
+    xlnt::detail::aes_cbc_encrypt(padded.data() + offset, bytes, key, iv.data(),
+        ciphertext.data() + offset);
+}
+
 void encrypt_xlsx_agile(
     const encryption_info &info,
     const std::vector<std::uint8_t> &plaintext,
     std::ostream &ciphertext_stream)
 {
+    XLNT_TRACE_SCOPE("encrypt_package");
     const auto length = static_cast<std::uint64_t>(plaintext.size());
     ciphertext_stream.write(reinterpret_cast<const char *>(&length), sizeof(std::uint64_t));
 
-    auto key = info.calculate_key();
-
-    auto salt_size = info.agile.key_data.salt_size;
-    auto salt_with_block_key = info.agile.key_data.salt_value;
-    salt_with_block_key.resize(salt_size + sizeof(std::uint32_t), 0);
-    auto &segment_index = *reinterpret_cast<std::uint32_t *>(salt_with_block_key.data() + salt_size);
+    const auto key = info.calculate_key();
+    const auto padded = pad_to_blocks(plaintext);
+    auto ciphertext = std::vector<std::uint8_t>(padded.size());
 
-    auto segment = std::vector<std::uint8_t>(4096, 0);
+    const auto segments = (padded.size() + segment_length - 1) / segment_length;
+    const auto thread_count = xlnt::detail::parallel_thread_count(segments, segments_per_thread);
 
-    for (auto i = std::size_t(0); i < length; i += 4096)
-    {
-        auto iv = hash(info.agile.key_encryptor.hash, salt_with_block_key);
-        iv.resize(16);
+    xlnt::detail::parallel_for(segments, thread_count, [&](std::size_t i) {
+        encrypt_agile_segment(info, key, i, padded, ciphertext);
+    });
 
-        auto start = plaintext.begin() + static_cast<std::ptrdiff_t>(i);
-        auto bytes = std::min(std::size_t(length - i), std::size_t(4096));
-        std::copy(start, start + static_cast<std::ptrdiff_t>(bytes), segment.begin());
-        auto encrypted_segment = xlnt::detail::aes_cbc_encrypt(segment, key, iv);
-        ciphertext_stream.write(reinterpret_cast<char *>(encrypted_segment.data()),
-            static_cast<std::streamsize>(bytes));
-
-        ++segment_index;
-    }
+    ciphertext_stream.write(reinterpret_cast<const char *>(ciphertext.data()),
+        static_cast<std::streamsize>(ciphertext.size()));
 }
 
 void encrypt_xlsx_standard(
@@ -247,45 +303,51 @@ void encrypt_xlsx_standard(
     const std::vector<std::uint8_t> &plaintext,
     std::ostream &ciphertext_stream)
 {
+    XLNT_TRACE_SCOPE("encrypt_package");
     const auto length = static_cast<std::uint64_t>(plaintext.size());
     ciphertext_stream.write(reinterpret_cast<const char *>(&length), sizeof(std::uint64_t));
 
-    auto key = info.calculate_key();
-    auto segment = std::vector<std::uint8_t>(4096, 0);
+    const auto key = info.calculate_key();
+    const auto padded = pad_to_blocks(plaintext);
+    auto ciphertext = std::vector<std::uint8_t>(padded.size());
 
-    for (auto i = std::size_t(0); i < length; ++i)
-    {
-        auto start = plaintext.begin() + static_cast<std::ptrdiff_t>(i);
-        auto bytes = std::min(std::size_t(length - i), std::size_t(4096));
-        std::copy(start, start + static_cast<std::ptrdiff_t>(bytes), segment.begin());
-        auto encrypted_segment = xlnt::detail::aes_ecb_encrypt(segment, key);
-        ciphertext_stream.write(reinterpret_cast<char *>(encrypted_segment.data()),
-            static_cast<std::streamsize>(bytes));
-    }
+    const auto segments = (padded.size() + segment_length - 1) / segment_length;
+    const auto thread_count = xlnt::detail::parallel_thread_count(segments, segments_per_thread);
+
+    xlnt::detail::parallel_for(segments, thread_count, [&](std::size_t i) {
+        const auto offset = i * segment_length;
+        const auto bytes = std::min(padded.size() - offset, segment_length);
+
+        xlnt::detail::aes_ecb_encrypt(padded.data() + offset, bytes, key,
+            ciphertext.data() + offset);
+    });
+
+    ciphertext_stream.write(reinterpret_cast<const char *>(ciphertext.data()),
+        static_cast<std::streamsize>(ciphertext.size()));
 }
 
 std::vector<std::uint8_t> encrypt_xlsx(
     const std::vector<std::uint8_t> &plaintext,
-    const std::u16string &password)
+    const std::u16string &password,
+    std::shared_ptr<xlnt::detail::encryption_key_impl> derived_keys = nullptr)
 {
-    auto encryption_info = generate_encryption_info(password);
-    encryption_info.password = u"secret";
+    auto encryption_info = writing_encryption_info(password, derived_keys);
 
     auto ciphertext = std::vector<std::uint8_t>();
 
     xlnt::detail::vector_ostreambuf buffer(ciphertext);
     std::ostream stream(&buffer);
-    xlnt::detail::compound_document document(stream);
 
     if (encryption_info.is_agile)
     {
-        write_agile_encryption_info(encryption_info,
-            document.open_write_stream("/EncryptionInfo"));
-        encrypt_xlsx_agile(encryption_info, plaintext,
-            document.open_write_stream("/EncryptedPackage"));
+        xlnt::detail::encrypting_ostreambuf encrypted_buffer(stream, password, derived_keys);
+        encrypted_buffer.sputn(reinterpret_cast<const char *>(plaintext.data()),
+            static_cast<std::streamsize>(plaintext.size()));
+        encrypted_buffer.close();
     }
     else
     {
+        xlnt::detail::compound_document document(stream);
         write_standard_encryption_info(encryption_info,
             document.open_write_stream("/EncryptionInfo"));
         encrypt_xlsx_standard(encryption_info, plaintext,
@@ -316,16 +378,132 @@ std::vector<std::uint8_t> encrypt_xlsx(
 }
 #endif
 
-template <typename T>
-void xlsx_producer::write_internal(std::ostream &destination, const T &password)
+encrypting_ostreambuf::encrypting_ostreambuf(std::ostream &destination, const std::u16string &password,
+    std::shared_ptr<encryption_key_impl> derived_keys)
+    : destination_(destination),
+      info_(writing_encryption_info(password, derived_keys)),
+      buffer_(segments_per_batch * segment_length)
 {
+    setp(reinterpret_cast<char *>(buffer_.data()), reinterpret_cast<char *>(buffer_.data() + buffer_.size()));
+}
+
+encrypting_ostreambuf::~encrypting_ostreambuf()
+{
+}
+
+encrypting_ostreambuf::int_type encrypting_ostreambuf::overflow(int_type c)
+{
+    if (closed_)
+    {
+        return traits_type::eof();
+    }
+
+    encrypt_buffer();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+void encrypting_ostreambuf::encrypt_buffer()
+{
+    XLNT_TRACE_SCOPE("encrypt_package");
+    const auto count = static_cast<std::size_t>(pptr() - pbase());
+
+    if (!document_)
+    {
+        key_ = info_.calculate_key();
+        document_.reset(new compound_document_writer(destination_, "EncryptedPackage"));
+
+        // the length is known once the package is complete
+        const auto placeholder = std::vector<std::uint8_t>(sizeof(std::uint64_t), 0);
+        document_->write(placeholder.data(), placeholder.size());
+    }
+
+    auto plaintext = std::vector<std::uint8_t>(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(count));
+    plaintext = pad_to_blocks(plaintext);
+    auto ciphertext = std::vector<std::uint8_t>(plaintext.size());
+
+    const auto segments = (plaintext.size() + segment_length - 1) / segment_length;
+    const auto thread_count = parallel_thread_count(segments, segments_per_thread);
+
+    parallel_for(segments, thread_count, [&](std::size_t i) {
+        encrypt_agile_segment(info_, key_, i, plaintext, ciphertext, segments_);
+    });
+
+    document_->write(ciphertext.data(), ciphertext.size());
+    length_ += count;
+    segments_ += segments;
+
+    setp(reinterpret_cast<char *>(buffer_.data()), reinterpret_cast<char *>(buffer_.data() + buffer_.size()));
+}
+
+void encrypting_ostreambuf::close()
+{
+    if (closed_)
+    {
+        return;
+    }
+
+    closed_ = true;
+    const auto count = static_cast<std::size_t>(pptr() - pbase());
+
+    if (!document_ && sizeof(std::uint64_t) + (count + 15) / 16 * 16 < compound_document_header().threshold)
+    {
+        // packages this small are kept in the mini stream, which compound_document lays out
+        const auto plaintext = std::vector<std::uint8_t>(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(count));
+        compound_document document(destination_);
+        write_agile_encryption_info(info_, document.open_write_stream("/EncryptionInfo"));
+        encrypt_xlsx_agile(info_, plaintext, document.open_write_stream("/EncryptedPackage"));
+
+        return;
+    }
+
+    if (count != 0 || !document_)
+    {
+        encrypt_buffer();
+    }
+
+    document_->overwrite(0, reinterpret_cast<const std::uint8_t *>(&length_), sizeof(std::uint64_t));
+
+    auto info = std::vector<std::uint8_t>();
+    vector_ostreambuf info_buffer(info);
+    std::ostream info_stream(&info_buffer);
+    write_agile_encryption_info(info_, info_stream);
+    info_stream.flush();
+    document_->add_small_stream("EncryptionInfo", info);
+
+    document_->close();
+    destination_.flush();
+}
+
+void xlsx_producer::write_encrypted(std::ostream &destination, const std::u16string &password,
+    std::shared_ptr<encryption_key_impl> derived_keys)
+{
+    if (destination.tellp() != std::streampos(-1))
+    {
+        // seekable destinations get the package encrypted while it's written
+        encrypting_ostreambuf encrypted_buffer(destination, password, derived_keys);
+        std::ostream plaintext_stream(&encrypted_buffer);
+        write(plaintext_stream);
+        archive_.reset();
+        plaintext_stream.flush();
+        encrypted_buffer.close();
+
+        return;
+    }
+
     std::vector<std::uint8_t> plaintext;
     vector_ostreambuf plaintext_buffer(plaintext);
     std::ostream decrypted_stream(&plaintext_buffer);
     write(decrypted_stream);
     archive_.reset();
 
-    const auto ciphertext = ::encrypt_xlsx(plaintext, utf8_to_utf16(password));
+    const auto ciphertext = ::encrypt_xlsx(plaintext, password, derived_keys);
     vector_istreambuf encrypted_buffer(ciphertext);
 
     destination << &encrypted_buffer;
@@ -333,15 +511,20 @@ void xlsx_producer::write_internal(std::ostream &destination, const T &password)
 
 void xlsx_producer::write(std::ostream &destination, const std::string &password)
 {
-    write_internal(destination, password);
+    write_encrypted(destination, utf8_to_utf16(password), nullptr);
 }
 
 #if XLNT_HAS_FEATURE(U8_STRING_VIEW)
 void xlsx_producer::write(std::ostream &destination, std::u8string_view password)
 {
-    write_internal(destination, password);
+    write_encrypted(destination, utf8_to_utf16(password), nullptr);
 }
 #endif
 
+void xlsx_producer::write(std::ostream &destination, const encryption_key &key)
+{
+    write_encrypted(destination, key.d_->password, key.d_);
+}
+
 } // namespace detail
 } // namespace xlnt
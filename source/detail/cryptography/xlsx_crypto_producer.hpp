@@ -23,12 +23,15 @@
 // @author: see AUTHORS file
 
 #include <cstdint>
+#include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
 #include <detail/xlnt_config_impl.hpp>
 #include <xlnt/internal/features.hpp>
+#include <detail/cryptography/encryption_info.hpp>
 
 #if XLNT_HAS_INCLUDE(<string_view>) && XLNT_HAS_FEATURE(U8_STRING_VIEW)
   #include <string_view>
@@ -43,5 +46,47 @@ XLNT_API_INTERNAL std::vector<std::uint8_t> encrypt_xlsx(const std::vector<std::
 XLNT_API_INTERNAL std::vector<std::uint8_t> encrypt_xlsx(const std::vector<std::uint8_t> &bytes, std::u8string_view password);
 #endif
 
+class compound_document_writer;
+
+/// <summary>
+/// Encrypts the package written to it and writes it as the EncryptedPackage stream of
+/// a compound document to destination as it goes, so that the package is never held in
+/// memory in full. Segments are encrypted in batches on several threads. The length
+/// of the package and the tables of the document are written by close, which is why
+/// destination has to be seekable. A package too small for the streams of full sectors
+/// is written to a compound_document at once instead.
+/// </summary>
+class XLNT_API_INTERNAL encrypting_ostreambuf : public std::streambuf
+{
+public:
+    encrypting_ostreambuf(std::ostream &destination, const std::u16string &password,
+        std::shared_ptr<encryption_key_impl> derived_keys = nullptr);
+    ~encrypting_ostreambuf() override;
+
+    /// <summary>
+    /// Encrypts the rest of the package and finishes the document. Nothing may be
+    /// written afterwards.
+    /// </summary>
+    void close();
+
+private:
+    int_type overflow(int_type c) override;
+
+    /// <summary>
+    /// Encrypts the buffered plaintext and appends it to the package, padding it to
+    /// whole AES blocks unless it's a number of whole segments.
+    /// </summary>
+    void encrypt_buffer();
+
+    std::ostream &destination_;
+    encryption_info info_;
+    std::vector<std::uint8_t> key_;
+    std::vector<std::uint8_t> buffer_;
+    std::unique_ptr<compound_document_writer> document_;
+    std::uint64_t length_ = 0;
+    std::size_t segments_ = 0;
+    bool closed_ = false;
+};
+
 } // namespace detail
 } // namespace xlnt
@@ -35,3 +35,5 @@
 #include <libstudxml/qname.hxx>
 #include <libstudxml/serializer.hxx>
 #pragma clang diagnostic pop
+
+#include <detail/serialization/number_value_traits.hpp>
@@ -0,0 +1,1556 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <detail/constants.hpp>
+#include <detail/formula/formula_engine.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/parsers.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
+#include <detail/serialization/worksheet_loader.hpp>
+#include <detail/utils/parallel_for.hpp>
+
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+namespace {
+
+using xlnt::detail::formula_area;
+using xlnt::detail::formula_cell;
+using xlnt::detail::formula_function;
+using xlnt::detail::formula_node;
+
+/// <summary>
+/// The value of an expression. Errors keep their code in text.
+/// </summary>
+struct formula_value
+{
+    enum class kind
+    {
+        blank,
+        number,
+        string,
+        boolean,
+        error
+    };
+
+    kind type = kind::blank;
+    double number = 0.0;
+    std::string text;
+
+    static formula_value of_number(double number)
+    {
+        formula_value value;
+        value.type = kind::number;
+        value.number = number;
+
+        return value;
+    }
+
+    static formula_value of_string(const std::string &text)
+    {
+        formula_value value;
+        value.type = kind::string;
+        value.text = text;
+
+        return value;
+    }
+
+    static formula_value of_boolean(bool boolean)
+    {
+        formula_value value;
+        value.type = kind::boolean;
+        value.number = boolean ? 1.0 : 0.0;
+
+        return value;
+    }
+
+    static formula_value of_error(const std::string &code)
+    {
+        formula_value value;
+        value.type = kind::error;
+        value.text = code;
+
+        return value;
+    }
+
+    bool is_error() const
+    {
+        return type == kind::error;
+    }
+};
+
+const char *const div0_error = "#DIV/0!";
+const char *const na_error = "#N/A";
+const char *const num_error = "#NUM!";
+const char *const ref_error = "#REF!";
+const char *const value_error = "#VALUE!";
+
+bool row_major_less(const formula_cell &lhs, const formula_cell &rhs)
+{
+    return lhs.sheet != rhs.sheet ? lhs.sheet < rhs.sheet
+        : xlnt::detail::row_major_order()(lhs.reference, rhs.reference);
+}
+
+bool same_cell(const formula_cell &lhs, const formula_cell &rhs)
+{
+    return lhs.sheet == rhs.sheet && lhs.reference == rhs.reference;
+}
+
+bool same_formula(const formula_cell &lhs, const formula_cell &rhs)
+{
+    return same_cell(lhs, rhs) && lhs.column_offset == rhs.column_offset
+        && lhs.row_offset == rhs.row_offset && lhs.text == rhs.text;
+}
+
+std::string to_upper(std::string text)
+{
+    for (auto &c : text)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    return text;
+}
+
+std::string to_lower(std::string text)
+{
+    for (auto &c : text)
+    {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    return text;
+}
+
+/// <summary>
+/// Returns the byte offsets of the characters of UTF-8 text followed by its size.
+/// </summary>
+std::vector<std::size_t> character_offsets(const std::string &text)
+{
+    std::vector<std::size_t> offsets;
+
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80)
+        {
+            offsets.push_back(i);
+        }
+    }
+
+    offsets.push_back(text.size());
+
+    return offsets;
+}
+
+/// <summary>
+/// Formats number the way the General number format shows it, with at most
+/// 15 significant digits.
+/// </summary>
+std::string number_text(double number)
+{
+    return number == 0.0 ? std::string("0") : fmt::format("{:.15G}", number);
+}
+
+/// <summary>
+/// Returns number with the error of binary floating point removed beyond 15
+/// significant digits, so that e.g. 2.675 * 100 is rounded as 267.5.
+/// </summary>
+double significant(double number)
+{
+    const auto text = fmt::format("{:.15G}", number);
+    auto result = number;
+    xlnt::detail::parse(text.data(), text.data() + text.size(), result);
+
+    return result;
+}
+
+/// <summary>
+/// Returns the shared or array formula cell belongs to, if any.
+/// </summary>
+const xlnt::detail::formula_group *group_of(const xlnt::detail::cell_impl &cell, const xlnt::detail::worksheet_impl &ws)
+{
+    return cell.formula_group_ != 0 ? &ws.formula_groups_[cell.formula_group_ - 1] : nullptr;
+}
+
+/// <summary>
+/// Returns true if the engine treats cell as a formula cell rather than a value read
+/// by formulas. Array formulas keep their cached values, so they count as values.
+/// </summary>
+bool is_formula(const xlnt::detail::cell_impl &cell, const xlnt::detail::worksheet_impl &ws)
+{
+    const auto group = group_of(cell, ws);
+    return cell.formula().is_set() && (group == nullptr || !group->array);
+}
+
+std::uint64_t fingerprint(const xlnt::detail::cell_impl &cell)
+{
+    std::uint64_t bits = 0;
+    const auto number = cell.value_number();
+    std::memcpy(&bits, &number, sizeof(bits));
+
+    auto hash = (static_cast<std::uint64_t>(cell.type_) + 1) * 0x9E3779B97F4A7C15ULL ^ bits;
+
+    if (cell.type_ == xlnt::cell_type::inline_string || cell.type_ == xlnt::cell_type::formula_string
+        || cell.type_ == xlnt::cell_type::error)
+    {
+        hash ^= static_cast<std::uint64_t>(xlnt::rich_text_hash()(cell.value_text())) * 0xFF51AFD7ED558CCDULL;
+    }
+
+    return hash;
+}
+
+/// <summary>
+/// Evaluates one formula cell. A new evaluator is used per cell, so evaluators on
+/// different threads share nothing but the cells they read.
+/// </summary>
+class evaluator
+{
+public:
+    evaluator(const xlnt::detail::formula_engine &engine, xlnt::workbook &wb, const formula_cell &formula)
+        : engine_(engine),
+          wb_(wb),
+          formula_(formula),
+          nodes_(formula.ast->nodes)
+    {
+    }
+
+    formula_value evaluate()
+    {
+        auto result = evaluate(formula_.ast->root);
+
+        // a formula reading an empty cell shows 0
+        return result.type == formula_value::kind::blank ? formula_value::of_number(0.0) : result;
+    }
+
+private:
+    formula_value evaluate(std::size_t index)
+    {
+        const auto &node = nodes_[index];
+
+        switch (node.type)
+        {
+        case formula_node::kind::number:
+            return formula_value::of_number(node.number);
+        case formula_node::kind::string:
+            return formula_value::of_string(node.text);
+        case formula_node::kind::boolean:
+            return formula_value::of_boolean(node.number != 0.0);
+        case formula_node::kind::error:
+            return formula_value::of_error(node.text);
+        case formula_node::kind::reference:
+            return reference_value(node);
+        case formula_node::kind::unary: {
+            auto operand = to_number(evaluate(node.operands[0]));
+            return operand.is_error() ? operand : formula_value::of_number(-operand.number);
+        }
+        case formula_node::kind::percent: {
+            auto operand = to_number(evaluate(node.operands[0]));
+            return operand.is_error() ? operand : formula_value::of_number(operand.number / 100.0);
+        }
+        case formula_node::kind::binary:
+            return binary(node);
+        case formula_node::kind::function:
+            return function(node);
+        }
+
+        return formula_value::of_error(value_error);
+    }
+
+    formula_value cell_value(const xlnt::detail::cell_impl *cell)
+    {
+        if (cell == nullptr)
+        {
+            return formula_value();
+        }
+
+        switch (cell->type_)
+        {
+        case xlnt::cell_type::empty:
+            return formula_value();
+        case xlnt::cell_type::boolean:
+            return formula_value::of_boolean(cell->value_number() != 0.0);
+        case xlnt::cell_type::date:
+        case xlnt::cell_type::number:
+            return formula_value::of_number(cell->value_number());
+        case xlnt::cell_type::error:
+            return formula_value::of_error(cell->value_text().plain_text());
+        case xlnt::cell_type::inline_string:
+        case xlnt::cell_type::formula_string:
+            return formula_value::of_string(cell->value_text().plain_text());
+        case xlnt::cell_type::shared_string:
+            return formula_value::of_string(xlnt::detail::shared_string_loader::plain_text(
+                wb_, static_cast<std::size_t>(cell->value_numeric_)));
+        }
+
+        return formula_value();
+    }
+
+    formula_value cell_value(std::size_t sheet, xlnt::column_t::index_t column, xlnt::row_t row)
+    {
+        return cell_value(engine_.sheet(sheet).cell_map_.find(xlnt::cell_reference(column, row)));
+    }
+
+    /// <summary>
+    /// Returns the value of a reference used as a single value. An area is intersected
+    /// with the row or column of the formula cell as Excel does.
+    /// </summary>
+    formula_value reference_value(const formula_node &node)
+    {
+        const auto area = engine_.resolve(node, formula_);
+
+        if (area.sheet == formula_area::npos)
+        {
+            return formula_value::of_error(ref_error);
+        }
+
+        const auto column = formula_.reference.column_index();
+        const auto row = formula_.reference.row();
+
+        if (area.first_row == area.last_row && area.first_column == area.last_column)
+        {
+            return cell_value(area.sheet, area.first_column, area.first_row);
+        }
+
+        if (area.first_column == area.last_column && row >= area.first_row && row <= area.last_row)
+        {
+            return cell_value(area.sheet, area.first_column, row);
+        }
+
+        if (area.first_row == area.last_row && column >= area.first_column && column <= area.last_column)
+        {
+            return cell_value(area.sheet, column, area.first_row);
+        }
+
+        return formula_value::of_error(value_error);
+    }
+
+    /// <summary>
+    /// Calls visit with the value of every stored cell in area until it returns false.
+    /// </summary>
+    template <typename Visit>
+    bool for_each_cell(const formula_area &area, Visit visit)
+    {
+        const auto &cells = engine_.sheet(area.sheet).cell_map_;
+
+        for (auto row = cells.first_row(area.first_row, area.last_row); row != 0;
+             row = row < area.last_row ? cells.first_row(row + 1, area.last_row) : 0)
+        {
+            for (auto column = cells.first_in_row(row, area.first_column, area.last_column); column != 0;
+                 column = column < area.last_column ? cells.first_in_row(row, column + 1, area.last_column) : 0)
+            {
+                if (!visit(cell_value(cells.find(xlnt::cell_reference(column, row))), true))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Calls visit(value, from_reference) with the values of the arguments of function
+    /// until it returns false. References are expanded into the values of their cells.
+    /// </summary>
+    template <typename Visit>
+    void for_each_argument(const formula_node &function, Visit visit)
+    {
+        for (auto operand : function.operands)
+        {
+            const auto &node = nodes_[operand];
+
+            if (node.type != formula_node::kind::reference)
+            {
+                if (!visit(evaluate(operand), false)) return;
+                continue;
+            }
+
+            const auto area = engine_.resolve(node, formula_);
+
+            if (area.sheet == formula_area::npos)
+            {
+                if (!visit(formula_value::of_error(ref_error), false)) return;
+                continue;
+            }
+
+            if (!for_each_cell(area, visit)) return;
+        }
+    }
+
+    static formula_value to_number(const formula_value &value)
+    {
+        switch (value.type)
+        {
+        case formula_value::kind::blank:
+            return formula_value::of_number(0.0);
+        case formula_value::kind::number:
+        case formula_value::kind::boolean:
+            return formula_value::of_number(value.number);
+        case formula_value::kind::error:
+            return value;
+        case formula_value::kind::string: {
+            const auto first = value.text.find_first_not_of(' ');
+            const auto last = value.text.find_last_not_of(' ');
+            if (first == std::string::npos) break;
+
+            auto number = 0.0;
+            const auto begin = value.text.data() + first;
+            const auto end = value.text.data() + last + 1;
+            const char *parsed = nullptr;
+            std::string trimmed(begin, end);
+
+            if (xlnt::detail::parse(trimmed.c_str(), number, &parsed) == std::errc()
+                && parsed == trimmed.c_str() + trimmed.size())
+            {
+                return formula_value::of_number(number);
+            }
+
+            break;
+        }
+        }
+
+        return formula_value::of_error(value_error);
+    }
+
+    static formula_value to_boolean(const formula_value &value)
+    {
+        switch (value.type)
+        {
+        case formula_value::kind::blank:
+            return formula_value::of_boolean(false);
+        case formula_value::kind::number:
+        case formula_value::kind::boolean:
+            return formula_value::of_boolean(value.number != 0.0);
+        case formula_value::kind::error:
+            return value;
+        case formula_value::kind::string: {
+            const auto upper = to_upper(value.text);
+            if (upper == "TRUE" || upper == "FALSE")
+            {
+                return formula_value::of_boolean(upper == "TRUE");
+            }
+            break;
+        }
+        }
+
+        return formula_value::of_error(value_error);
+    }
+
+    static std::string to_text(const formula_value &value)
+    {
+        switch (value.type)
+        {
+        case formula_value::kind::number:
+            return number_text(value.number);
+        case formula_value::kind::boolean:
+            return value.number != 0.0 ? "TRUE" : "FALSE";
+        case formula_value::kind::string:
+        case formula_value::kind::error:
+            return value.text;
+        case formula_value::kind::blank:
+            break;
+        }
+
+        return std::string();
+    }
+
+    static formula_value checked(double number)
+    {
+        return std::isfinite(number) ? formula_value::of_number(number) : formula_value::of_error(num_error);
+    }
+
+    /// <summary>
+    /// Compares two values of a comparison operator: numbers sort before strings, which sort
+    /// before booleans, strings ignore case and an empty cell is equal to 0, "" and FALSE.
+    /// </summary>
+    static int compare(formula_value lhs, formula_value rhs)
+    {
+        auto fill_blank = [](formula_value &blank, const formula_value &other) {
+            if (blank.type != formula_value::kind::blank) return;
+            blank = other.type == formula_value::kind::string ? formula_value::of_string(std::string())
+                : other.type == formula_value::kind::boolean ? formula_value::of_boolean(false)
+                : formula_value::of_number(0.0);
+        };
+
+        fill_blank(lhs, rhs);
+        fill_blank(rhs, lhs);
+
+        auto rank = [](const formula_value &value) {
+            return value.type == formula_value::kind::number ? 0 : value.type == formula_value::kind::string ? 1 : 2;
+        };
+
+        if (rank(lhs) != rank(rhs))
+        {
+            return rank(lhs) < rank(rhs) ? -1 : 1;
+        }
+
+        if (lhs.type == formula_value::kind::string)
+        {
+            const auto result = to_upper(lhs.text).compare(to_upper(rhs.text));
+            return result < 0 ? -1 : result > 0 ? 1 : 0;
+        }
+
+        return lhs.number < rhs.number ? -1 : lhs.number > rhs.number ? 1 : 0;
+    }
+
+    formula_value binary(const formula_node &node)
+    {
+        const auto lhs = evaluate(node.operands[0]);
+        const auto rhs = evaluate(node.operands[1]);
+        const auto &op = node.text;
+
+        if (op == "&")
+        {
+            if (lhs.is_error()) return lhs;
+            if (rhs.is_error()) return rhs;
+
+            return formula_value::of_string(to_text(lhs) + to_text(rhs));
+        }
+
+        if (op == "=" || op == "<>" || op == "<" || op == "<=" || op == ">" || op == ">=")
+        {
+            if (lhs.is_error()) return lhs;
+            if (rhs.is_error()) return rhs;
+
+            const auto order = compare(lhs, rhs);
+            const auto result = op == "=" ? order == 0
+                : op == "<>" ? order != 0
+                : op == "<" ? order < 0
+                : op == "<=" ? order <= 0
+                : op == ">" ? order > 0
+                : order >= 0;
+
+            return formula_value::of_boolean(result);
+        }
+
+        const auto left = to_number(lhs);
+        if (left.is_error()) return left;
+        const auto right = to_number(rhs);
+        if (right.is_error()) return right;
+
+        switch (op[0])
+        {
+        case '+':
+            return checked(left.number + right.number);
+        case '-':
+            return checked(left.number - right.number);
+        case '*':
+            return checked(left.number * right.number);
+        case '/':
+            return right.number == 0.0 ? formula_value::of_error(div0_error) : checked(left.number / right.number);
+        case '^':
+            if (left.number == 0.0 && right.number == 0.0) return formula_value::of_error(num_error);
+            return checked(std::pow(left.number, right.number));
+        }
+
+        return formula_value::of_error(value_error);
+    }
+
+    /// <summary>
+    /// Collects the numbers of the arguments of an aggregate function. Numbers in cells
+    /// count while text and booleans in cells are skipped; arguments given directly are
+    /// converted to numbers. Returns the first error found, or a blank value.
+    /// </summary>
+    formula_value numbers(const formula_node &function, std::vector<double> &values)
+    {
+        formula_value error;
+
+        for_each_argument(function, [&](const formula_value &value, bool from_reference) {
+            if (value.is_error())
+            {
+                error = value;
+                return false;
+            }
+
+            if (from_reference)
+            {
+                if (value.type == formula_value::kind::number)
+                {
+                    values.push_back(value.number);
+                }
+
+                return true;
+            }
+
+            const auto number = to_number(value);
+
+            if (number.is_error())
+            {
+                error = number;
+                return false;
+            }
+
+            values.push_back(number.number);
+
+            return true;
+        });
+
+        return error;
+    }
+
+    formula_value number_argument(const formula_node &function, std::size_t index)
+    {
+        return to_number(evaluate(function.operands[index]));
+    }
+
+    formula_value text_argument(const formula_node &function, std::size_t index)
+    {
+        const auto value = evaluate(function.operands[index]);
+        return value.is_error() ? value : formula_value::of_string(to_text(value));
+    }
+
+    /// <summary>
+    /// Rounds the first argument of a ROUND function to the number of digits in the second
+    /// using rounding, which is called with a non-negative number.
+    /// </summary>
+    template <typename Rounding>
+    formula_value round(const formula_node &function, Rounding rounding)
+    {
+        const auto number = number_argument(function, 0);
+        if (number.is_error()) return number;
+        const auto digits = number_argument(function, 1);
+        if (digits.is_error()) return digits;
+
+        const auto factor = std::pow(10.0, std::trunc(digits.number));
+        const auto scaled = significant(std::fabs(number.number) * factor);
+        const auto rounded = rounding(scaled) / factor;
+
+        return checked(number.number < 0 ? -rounded : rounded);
+    }
+
+    formula_value substring(const formula_node &function, double start, double count)
+    {
+        const auto text = text_argument(function, 0);
+        if (text.is_error()) return text;
+
+        const auto offsets = character_offsets(text.text);
+        const auto length = static_cast<double>(offsets.size() - 1);
+        const auto first = static_cast<std::size_t>(std::min(std::max(start, 0.0), length));
+        const auto last = static_cast<std::size_t>(std::min(std::max(start + count, 0.0), length));
+
+        return formula_value::of_string(last <= first ? std::string()
+            : text.text.substr(offsets[first], offsets[last] - offsets[first]));
+    }
+
+    formula_value function(const formula_node &node)
+    {
+        const auto arguments = node.operands.size();
+
+        switch (node.function)
+        {
+        case formula_function::sum:
+        case formula_function::product:
+        case formula_function::average:
+        case formula_function::min:
+        case formula_function::max: {
+            std::vector<double> values;
+            const auto error = numbers(node, values);
+            if (error.is_error()) return error;
+
+            if (node.function == formula_function::sum || node.function == formula_function::average)
+            {
+                auto sum = 0.0;
+                for (auto value : values)
+                    sum += value;
+
+                if (node.function == formula_function::sum) return checked(sum);
+                if (values.empty()) return formula_value::of_error(div0_error);
+
+                return checked(sum / static_cast<double>(values.size()));
+            }
+
+            if (values.empty()) return formula_value::of_number(0.0);
+
+            if (node.function == formula_function::product)
+            {
+                auto product = 1.0;
+                for (auto value : values)
+                    product *= value;
+
+                return checked(product);
+            }
+
+            return formula_value::of_number(node.function == formula_function::min
+                    ? *std::min_element(values.begin(), values.end())
+                    : *std::max_element(values.begin(), values.end()));
+        }
+        case formula_function::count:
+        case formula_function::counta: {
+            std::size_t count = 0;
+            const auto all = node.function == formula_function::counta;
+
+            for_each_argument(node, [&](const formula_value &value, bool from_reference) {
+                if (all)
+                {
+                    count += value.type != formula_value::kind::blank;
+                }
+                else if (value.type == formula_value::kind::number)
+                {
+                    ++count;
+                }
+                else if (!from_reference && !value.is_error())
+                {
+                    count += !to_number(value).is_error();
+                }
+
+                return true;
+            });
+
+            return formula_value::of_number(static_cast<double>(count));
+        }
+        case formula_function::countblank: {
+            const auto &argument = nodes_[node.operands[0]];
+            if (argument.type != formula_node::kind::reference) return formula_value::of_error(value_error);
+
+            const auto area = engine_.resolve(argument, formula_);
+            if (area.sheet == formula_area::npos) return formula_value::of_error(ref_error);
+
+            auto blank = static_cast<double>(area.last_column - area.first_column + 1)
+                * static_cast<double>(area.last_row - area.first_row + 1);
+
+            for_each_cell(area, [&blank](const formula_value &value, bool) {
+                if (value.type != formula_value::kind::blank
+                    && !(value.type == formula_value::kind::string && value.text.empty()))
+                {
+                    blank -= 1.0;
+                }
+
+                return true;
+            });
+
+            return formula_value::of_number(blank);
+        }
+        case formula_function::and_:
+        case formula_function::or_: {
+            const auto conjunction = node.function == formula_function::and_;
+            auto result = conjunction;
+            auto any = false;
+            formula_value error;
+
+            for_each_argument(node, [&](const formula_value &value, bool from_reference) {
+                if (value.is_error())
+                {
+                    error = value;
+                    return false;
+                }
+
+                if (value.type == formula_value::kind::blank
+                    || (from_reference && value.type == formula_value::kind::string))
+                {
+                    return true;
+                }
+
+                const auto boolean = to_boolean(value);
+
+                if (boolean.is_error())
+                {
+                    error = boolean;
+                    return false;
+                }
+
+                any = true;
+                result = conjunction ? result && boolean.number != 0.0 : result || boolean.number != 0.0;
+
+                return true;
+            });
+
+            if (error.is_error()) return error;
+            if (!any) return formula_value::of_error(value_error);
+
+            return formula_value::of_boolean(result);
+        }
+        case formula_function::not_: {
+            const auto boolean = to_boolean(evaluate(node.operands[0]));
+            return boolean.is_error() ? boolean : formula_value::of_boolean(boolean.number == 0.0);
+        }
+        case formula_function::if_: {
+            const auto condition = to_boolean(evaluate(node.operands[0]));
+            if (condition.is_error()) return condition;
+
+            if (condition.number != 0.0)
+            {
+                return arguments > 1 ? evaluate(node.operands[1]) : formula_value::of_boolean(true);
+            }
+
+            return arguments > 2 ? evaluate(node.operands[2]) : formula_value::of_boolean(false);
+        }
+        case formula_function::iferror: {
+            const auto value = evaluate(node.operands[0]);
+            return value.is_error() ? evaluate(node.operands[1]) : value;
+        }
+        case formula_function::isblank:
+            return formula_value::of_boolean(evaluate(node.operands[0]).type == formula_value::kind::blank);
+        case formula_function::iserror:
+            return formula_value::of_boolean(evaluate(node.operands[0]).is_error());
+        case formula_function::isnumber:
+            return formula_value::of_boolean(evaluate(node.operands[0]).type == formula_value::kind::number);
+        case formula_function::istext:
+            return formula_value::of_boolean(evaluate(node.operands[0]).type == formula_value::kind::string);
+        case formula_function::abs:
+        case formula_function::int_:
+        case formula_function::sqrt: {
+            const auto number = number_argument(node, 0);
+            if (number.is_error()) return number;
+
+            if (node.function == formula_function::abs) return formula_value::of_number(std::fabs(number.number));
+            if (node.function == formula_function::int_) return formula_value::of_number(std::floor(number.number));
+            if (number.number < 0) return formula_value::of_error(num_error);
+
+            return formula_value::of_number(std::sqrt(number.number));
+        }
+        case formula_function::mod:
+        case formula_function::power: {
+            const auto lhs = number_argument(node, 0);
+            if (lhs.is_error()) return lhs;
+            const auto rhs = number_argument(node, 1);
+            if (rhs.is_error()) return rhs;
+
+            if (node.function == formula_function::power)
+            {
+                if (lhs.number == 0.0 && rhs.number == 0.0) return formula_value::of_error(num_error);
+                return checked(std::pow(lhs.number, rhs.number));
+            }
+
+            if (rhs.number == 0.0) return formula_value::of_error(div0_error);
+
+            return checked(lhs.number - rhs.number * std::floor(lhs.number / rhs.number));
+        }
+        case formula_function::round:
+            return round(node, [](double number) { return std::floor(number + 0.5); });
+        case formula_function::roundup:
+            return round(node, [](double number) { return std::ceil(number); });
+        case formula_function::rounddown:
+            return round(node, [](double number) { return std::floor(number); });
+        case formula_function::pi:
+            return formula_value::of_number(3.14159265358979323846);
+        case formula_function::na:
+            return formula_value::of_error(na_error);
+        case formula_function::concatenate: {
+            std::string result;
+            formula_value error;
+
+            for_each_argument(node, [&](const formula_value &value, bool) {
+                if (value.is_error())
+                {
+                    error = value;
+                    return false;
+                }
+
+                result.append(to_text(value));
+
+                return true;
+            });
+
+            return error.is_error() ? error : formula_value::of_string(result);
+        }
+        case formula_function::len: {
+            const auto text = text_argument(node, 0);
+            if (text.is_error()) return text;
+
+            return formula_value::of_number(static_cast<double>(character_offsets(text.text).size() - 1));
+        }
+        case formula_function::upper:
+        case formula_function::lower: {
+            const auto text = text_argument(node, 0);
+            if (text.is_error()) return text;
+
+            return formula_value::of_string(node.function == formula_function::upper
+                    ? to_upper(text.text) : to_lower(text.text));
+        }
+        case formula_function::trim: {
+            const auto text = text_argument(node, 0);
+            if (text.is_error()) return text;
+
+            std::string result;
+
+            for (auto c : text.text)
+            {
+                if (c != ' ' || (!result.empty() && result.back() != ' '))
+                {
+                    result.push_back(c);
+                }
+            }
+
+            if (!result.empty() && result.back() == ' ')
+            {
+                result.pop_back();
+            }
+
+            return formula_value::of_string(result);
+        }
+        case formula_function::left:
+        case formula_function::right: {
+            auto count = formula_value::of_number(1.0);
+            if (arguments > 1)
+            {
+                count = number_argument(node, 1);
+                if (count.is_error()) return count;
+            }
+
+            if (count.number < 0) return formula_value::of_error(value_error);
+
+            if (node.function == formula_function::left)
+            {
+                return substring(node, 0.0, std::floor(count.number));
+            }
+
+            const auto text = text_argument(node, 0);
+            if (text.is_error()) return text;
+            const auto length = static_cast<double>(character_offsets(text.text).size() - 1);
+
+            return substring(node, length - std::floor(count.number), std::floor(count.number));
+        }
+        case formula_function::mid: {
+            const auto start = number_argument(node, 1);
+            if (start.is_error()) return start;
+            const auto count = number_argument(node, 2);
+            if (count.is_error()) return count;
+
+            if (start.number < 1 || count.number < 0) return formula_value::of_error(value_error);
+
+            return substring(node, std::floor(start.number) - 1, std::floor(count.number));
+        }
+        }
+
+        return formula_value::of_error(value_error);
+    }
+
+    const xlnt::detail::formula_engine &engine_;
+    xlnt::workbook &wb_;
+    const formula_cell &formula_;
+    const std::vector<formula_node> &nodes_;
+};
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const std::size_t formula_area::npos;
+
+worksheet_impl &formula_engine::sheet(std::size_t index) const
+{
+    return *sheets_[index].impl;
+}
+
+formula_area formula_engine::resolve(const formula_node &reference, const formula_cell &formula) const
+{
+    formula_area area;
+    auto sheet = formula.sheet;
+
+    if (!reference.sheet.empty())
+    {
+        auto match = sheet_indices_.find(reference.sheet);
+
+        if (match == sheet_indices_.end())
+        {
+            // titles are matched without regard to case like in Excel
+            const auto upper = to_upper(reference.sheet);
+            match = std::find_if(sheet_indices_.begin(), sheet_indices_.end(),
+                [&upper](const std::pair<const std::string, std::size_t> &entry) { return to_upper(entry.first) == upper; });
+
+            if (match == sheet_indices_.end())
+            {
+                return area;
+            }
+        }
+
+        sheet = match->second;
+    }
+
+    auto shift = [](std::uint32_t value, bool absolute, std::int64_t offset, std::int64_t max, bool &valid) {
+        const auto shifted = static_cast<std::int64_t>(value) + (absolute ? 0 : offset);
+        valid = valid && shifted >= 1 && shifted <= max;
+
+        return static_cast<std::uint32_t>(shifted);
+    };
+
+    const auto max_column = static_cast<std::int64_t>(constants::max_column().index);
+    const auto max_row = static_cast<std::int64_t>(constants::max_row());
+    auto valid = true;
+
+    area.first_column = shift(reference.first_column, (reference.absolute & formula_node::absolute_first_column) != 0,
+        formula.column_offset, max_column, valid);
+    area.last_column = shift(reference.last_column, (reference.absolute & formula_node::absolute_last_column) != 0,
+        formula.column_offset, max_column, valid);
+    area.first_row = shift(reference.first_row, (reference.absolute & formula_node::absolute_first_row) != 0,
+        formula.row_offset, max_row, valid);
+    area.last_row = shift(reference.last_row, (reference.absolute & formula_node::absolute_last_row) != 0,
+        formula.row_offset, max_row, valid);
+
+    if (!valid)
+    {
+        return formula_area();
+    }
+
+    if (area.first_column > area.last_column) std::swap(area.first_column, area.last_column);
+    if (area.first_row > area.last_row) std::swap(area.first_row, area.last_row);
+    area.sheet = sheet;
+
+    return area;
+}
+
+bool formula_engine::same_sheets(const workbook_impl &wb) const
+{
+    if (wb.worksheets_.size() != sheets_.size()) return false;
+
+    auto state = sheets_.begin();
+
+    for (const auto &ws : wb.worksheets_)
+    {
+        if (state->impl != &ws || state->title != ws.title_) return false;
+        ++state;
+    }
+
+    return true;
+}
+
+void formula_engine::track_sheets(workbook &wb)
+{
+    auto &worksheets = wb.d_->worksheets_;
+
+    if (same_sheets(*wb.d_)) return;
+
+    sheets_.clear();
+    sheet_indices_.clear();
+    formulas_.clear();
+    formulas_by_column_.clear();
+    calculated_ = false;
+
+    for (auto &ws : worksheets)
+    {
+        sheet_indices_[ws.title_] = sheets_.size();
+        sheets_.emplace_back();
+        sheets_.back().impl = &ws;
+        sheets_.back().title = ws.title_;
+    }
+}
+
+std::vector<formula_cell> formula_engine::scan(std::vector<std::vector<cell_reference>> &changed)
+{
+    std::vector<formula_cell> formulas;
+
+    for (std::size_t index = 0; index < sheets_.size(); ++index)
+    {
+        auto &state = sheets_[index];
+        const auto &ws = *state.impl;
+        const auto first_formula = formulas.size();
+        const auto &read = state.read;
+        decltype(state.fingerprints) fingerprints;
+
+        ws.cell_map_.for_each([&](const cell_impl &cell) {
+            const auto reference = cell_reference(cell.column_, cell.row_);
+
+            if (is_formula(cell, ws))
+            {
+                formula_cell formula;
+                formula.sheet = index;
+                formula.reference = reference;
+                formula.text = cell.formula().get();
+
+                if (const auto group = group_of(cell, ws))
+                {
+                    formula.column_offset = static_cast<std::int64_t>(reference.column_index()) - group->master.column_index();
+                    formula.row_offset = static_cast<std::int64_t>(reference.row()) - group->master.row();
+                }
+
+                formulas.push_back(std::move(formula));
+                return;
+            }
+
+            if (reference.column_index() < read.min_column || reference.column_index() > read.max_column
+                || reference.row() < read.min_row || reference.row() > read.max_row)
+            {
+                return;
+            }
+
+            const auto print = fingerprint(cell);
+            fingerprints.emplace(reference, print);
+
+            if (calculated_)
+            {
+                auto previous = state.fingerprints.find(reference);
+
+                if (previous == state.fingerprints.end() || previous->second != print)
+                {
+                    changed[index].push_back(reference);
+                }
+            }
+        });
+
+        if (calculated_)
+        {
+            // cells which were erased
+            for (const auto &previous : state.fingerprints)
+            {
+                if (fingerprints.find(previous.first) == fingerprints.end())
+                {
+                    changed[index].push_back(previous.first);
+                }
+            }
+        }
+
+        state.fingerprints.swap(fingerprints);
+        std::sort(formulas.begin() + static_cast<std::ptrdiff_t>(first_formula), formulas.end(), row_major_less);
+    }
+
+    return formulas;
+}
+
+void formula_engine::refresh_fingerprints(sheet_state &sheet)
+{
+    const auto &read = sheet.read;
+    sheet.fingerprints.clear();
+
+    if (read.min_row > read.max_row) return;
+
+    const auto &ws = *sheet.impl;
+
+    ws.cell_map_.for_each([&](const cell_impl &cell) {
+        if (!is_formula(cell, ws) && cell.column_ >= read.min_column && cell.column_ <= read.max_column
+            && cell.row_ >= read.min_row && cell.row_ <= read.max_row)
+        {
+            sheet.fingerprints.emplace(cell_reference(cell.column_, cell.row_), fingerprint(cell));
+        }
+    });
+}
+
+void formula_engine::rebuild(std::vector<formula_cell> &&formulas, std::vector<bool> &dirty,
+    std::vector<std::vector<cell_reference>> &changed)
+{
+    dirty.assign(formulas.size(), !calculated_);
+    decltype(parsed_) parsed;
+
+    // both lists are in row-major order, so they are merged to find the formulas which stayed
+    auto previous = formulas_.begin();
+
+    for (std::size_t i = 0; i < formulas.size(); ++i)
+    {
+        auto &formula = formulas[i];
+
+        while (previous != formulas_.end() && row_major_less(*previous, formula))
+        {
+            changed[previous->sheet].push_back(previous->reference);
+            ++previous;
+        }
+
+        if (previous != formulas_.end() && same_cell(*previous, formula))
+        {
+            if (!same_formula(*previous, formula))
+            {
+                dirty[i] = true;
+            }
+
+            ++previous;
+        }
+        else
+        {
+            dirty[i] = true;
+        }
+
+        auto cached = parsed.find(formula.text);
+
+        if (cached == parsed.end())
+        {
+            auto known = parsed_.find(formula.text);
+            std::shared_ptr<const formula_ast> ast;
+
+            if (known != parsed_.end())
+            {
+                ast = known->second;
+            }
+            else
+            {
+                try
+                {
+                    ast = std::make_shared<const formula_ast>(parse_formula(formula.text));
+                }
+                catch (const xlnt::exception &)
+                {
+                    // unsupported formulas keep their cached values
+                }
+            }
+
+            cached = parsed.emplace(formula.text, ast).first;
+        }
+
+        formula.ast = cached->second;
+    }
+
+    for (; previous != formulas_.end(); ++previous)
+    {
+        changed[previous->sheet].push_back(previous->reference);
+    }
+
+    formulas_ = std::move(formulas);
+    parsed_.swap(parsed);
+
+    // what each formula reads
+    std::vector<cell_bounds> read(sheets_.size());
+
+    for (auto &formula : formulas_)
+    {
+        if (!formula.ast) continue;
+
+        for (const auto &node : formula.ast->nodes)
+        {
+            if (node.type != formula_node::kind::reference) continue;
+
+            const auto area = resolve(node, formula);
+            if (area.sheet == formula_area::npos) continue;
+
+            formula.precedents.push_back(area);
+            read[area.sheet].extend(cell_reference(area.first_column, area.first_row));
+            read[area.sheet].extend(cell_reference(area.last_column, area.last_row));
+        }
+    }
+
+    for (std::size_t index = 0; index < sheets_.size(); ++index)
+    {
+        auto &bounds = sheets_[index].read;
+        const auto &grown = read[index];
+
+        if (bounds.min_column != grown.min_column || bounds.max_column != grown.max_column
+            || bounds.min_row != grown.min_row || bounds.max_row != grown.max_row)
+        {
+            // the cells newly covered are only read by new or edited formulas, which are dirty anyway
+            bounds = grown;
+            refresh_fingerprints(sheets_[index]);
+        }
+    }
+
+    // the formulas each formula is read by
+    formulas_by_column_.resize(formulas_.size());
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        formulas_by_column_[i] = i;
+    }
+
+    std::sort(formulas_by_column_.begin(), formulas_by_column_.end(), [this](std::size_t lhs, std::size_t rhs) {
+        const auto &left = formulas_[lhs];
+        const auto &right = formulas_[rhs];
+
+        if (left.sheet != right.sheet) return left.sheet < right.sheet;
+        if (left.reference.column_index() != right.reference.column_index())
+        {
+            return left.reference.column_index() < right.reference.column_index();
+        }
+
+        return left.reference.row() < right.reference.row();
+    });
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        for (const auto &area : formulas_[i].precedents)
+        {
+            const auto rows = static_cast<std::uint64_t>(area.last_row - area.first_row);
+            const auto columns = static_cast<std::uint64_t>(area.last_column - area.first_column);
+
+            if (rows <= columns)
+            {
+                // search the formulas in row-major order from the first cell of the area
+                formula_cell first;
+                first.sheet = area.sheet;
+                first.reference = cell_reference(area.first_column, area.first_row);
+
+                for (auto match = std::lower_bound(formulas_.begin(), formulas_.end(), first, row_major_less);
+                     match != formulas_.end() && match->sheet == area.sheet && match->reference.row() <= area.last_row;
+                     ++match)
+                {
+                    if (area.contains(match->sheet, match->reference.column_index(), match->reference.row()))
+                    {
+                        match->dependents.push_back(i);
+                    }
+                }
+            }
+            else
+            {
+                for (auto column = area.first_column; column <= area.last_column; ++column)
+                {
+                    auto match = std::lower_bound(formulas_by_column_.begin(), formulas_by_column_.end(), column,
+                        [this, &area](std::size_t index, column_t::index_t value) {
+                            const auto &formula = formulas_[index];
+                            if (formula.sheet != area.sheet) return formula.sheet < area.sheet;
+                            if (formula.reference.column_index() != value) return formula.reference.column_index() < value;
+                            return formula.reference.row() < area.first_row;
+                        });
+
+                    for (; match != formulas_by_column_.end(); ++match)
+                    {
+                        auto &formula = formulas_[*match];
+
+                        if (formula.sheet != area.sheet || formula.reference.column_index() != column
+                            || formula.reference.row() > area.last_row)
+                        {
+                            break;
+                        }
+
+                        formula.dependents.push_back(i);
+                    }
+
+                    if (match == formulas_by_column_.end() || formulas_[*match].sheet != area.sheet)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for (auto &formula : formulas_)
+    {
+        std::sort(formula.dependents.begin(), formula.dependents.end());
+        formula.dependents.erase(std::unique(formula.dependents.begin(), formula.dependents.end()), formula.dependents.end());
+    }
+}
+
+void formula_engine::evaluate(workbook &wb, const formula_cell &formula) const
+{
+    const auto result = evaluator(*this, wb, formula).evaluate();
+    auto &cell = *sheets_[formula.sheet].impl->cell_map_.find(formula.reference);
+
+    switch (result.type)
+    {
+    case formula_value::kind::blank:
+    case formula_value::kind::number:
+        cell.type_ = cell_type::number;
+        cell.value_number(result.number);
+        if (cell.extension_) cell.extension_->value_text_.clear();
+        break;
+    case formula_value::kind::boolean:
+        cell.type_ = cell_type::boolean;
+        cell.value_number(result.number);
+        if (cell.extension_) cell.extension_->value_text_.clear();
+        break;
+    case formula_value::kind::string:
+        cell.type_ = cell_type::formula_string;
+        cell.value_number(0.0);
+        cell.extension().value_text_.plain_text(result.text, false);
+        break;
+    case formula_value::kind::error:
+        cell.type_ = cell_type::error;
+        cell.value_number(0.0);
+        cell.extension().value_text_.plain_text(result.text, false);
+        break;
+    }
+}
+
+std::vector<calculation_chain_entry> formula_engine::evaluation_order(const workbook_impl &wb) const
+{
+    std::vector<calculation_chain_entry> order;
+
+    if (!calculated_ || !same_sheets(wb)) return order;
+
+    std::vector<std::size_t> precedents(formulas_.size(), 0);
+    std::vector<bool> ordered(formulas_.size(), false);
+
+    for (const auto &formula : formulas_)
+    {
+        for (auto dependent : formula.dependents)
+        {
+            ++precedents[dependent];
+        }
+    }
+
+    std::vector<std::size_t> level;
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        if (precedents[i] == 0) level.push_back(i);
+    }
+
+    auto append = [&](std::size_t index, bool new_level) {
+        calculation_chain_entry entry;
+        entry.sheet_id = sheets_[formulas_[index].sheet].impl->id_;
+        entry.reference = formulas_[index].reference;
+        entry.new_level = new_level;
+        order.push_back(entry);
+        ordered[index] = true;
+    };
+
+    while (!level.empty())
+    {
+        std::vector<std::size_t> next;
+
+        for (std::size_t i = 0; i < level.size(); ++i)
+        {
+            append(level[i], i == 0 && !order.empty());
+
+            for (auto dependent : formulas_[level[i]].dependents)
+            {
+                if (--precedents[dependent] == 0) next.push_back(dependent);
+            }
+        }
+
+        level.swap(next);
+    }
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        if (!ordered[i]) append(i, false);
+    }
+
+    return order;
+}
+
+std::size_t formula_engine::calculate(workbook &wb, std::size_t threads)
+{
+    worksheet_loader::load_all(*wb.d_);
+    track_sheets(wb);
+
+    std::vector<std::vector<cell_reference>> changed(sheets_.size());
+    auto formulas = scan(changed);
+    std::vector<bool> dirty;
+
+    const auto unchanged = calculated_ && formulas.size() == formulas_.size()
+        && std::equal(formulas.begin(), formulas.end(), formulas_.begin(), same_formula);
+
+    if (unchanged)
+    {
+        dirty.assign(formulas_.size(), false);
+    }
+    else
+    {
+        rebuild(std::move(formulas), dirty, changed);
+    }
+
+    // the formulas reading a changed cell
+    for (auto &cells : changed)
+    {
+        std::sort(cells.begin(), cells.end(), row_major_order());
+    }
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        for (const auto &area : formulas_[i].precedents)
+        {
+            if (dirty[i]) break;
+
+            const auto &cells = changed[area.sheet];
+
+            for (auto match = std::lower_bound(cells.begin(), cells.end(),
+                     cell_reference(area.first_column, area.first_row), row_major_order());
+                 match != cells.end() && match->row() <= area.last_row; ++match)
+            {
+                if (area.contains(area.sheet, match->column_index(), match->row()))
+                {
+                    dirty[i] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // and everything depending on them
+    std::vector<std::size_t> pending;
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        if (dirty[i]) pending.push_back(i);
+    }
+
+    while (!pending.empty())
+    {
+        const auto formula = pending.back();
+        pending.pop_back();
+
+        for (auto dependent : formulas_[formula].dependents)
+        {
+            if (!dirty[dependent])
+            {
+                dirty[dependent] = true;
+                pending.push_back(dependent);
+            }
+        }
+    }
+
+    // evaluate the dirty formulas level by level, each level only reading earlier ones
+    std::vector<std::size_t> precedents(formulas_.size(), 0);
+    std::vector<std::size_t> level;
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        if (!dirty[i]) continue;
+
+        for (auto dependent : formulas_[i].dependents)
+        {
+            if (dirty[dependent]) ++precedents[dependent];
+        }
+    }
+
+    for (std::size_t i = 0; i < formulas_.size(); ++i)
+    {
+        if (dirty[i] && precedents[i] == 0) level.push_back(i);
+    }
+
+    std::size_t evaluated = 0;
+
+    while (!level.empty())
+    {
+        // levels too small to be worth a thread are evaluated in place
+        const auto thread_count = std::min(std::max(threads, std::size_t(1)), parallel_thread_count(level.size(), 64));
+
+        parallel_for(level.size(), thread_count, [&](std::size_t i) {
+            const auto &formula = formulas_[level[i]];
+
+            if (formula.ast)
+            {
+                evaluate(wb, formula);
+            }
+        });
+
+        std::vector<std::size_t> next;
+
+        for (auto formula : level)
+        {
+            evaluated += formulas_[formula].ast ? 1 : 0;
+
+            for (auto dependent : formulas_[formula].dependents)
+            {
+                if (dirty[dependent] && --precedents[dependent] == 0)
+                {
+                    next.push_back(dependent);
+                }
+            }
+        }
+
+        level.swap(next);
+    }
+
+    // formulas in or after a cycle are never reached and keep their cached values
+    calculated_ = true;
+
+    return evaluated;
+}
+
+} // namespace detail
+} // namespace xlnt
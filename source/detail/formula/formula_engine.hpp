@@ -0,0 +1,195 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <detail/xlnt_config_impl.hpp>
+#include <detail/formula/formula_parser.hpp>
+#include <detail/implementations/calculation_chain_entry.hpp>
+#include <detail/implementations/cell_store.hpp>
+
+namespace xlnt {
+
+class workbook;
+
+namespace detail {
+
+struct workbook_impl;
+struct worksheet_impl;
+
+/// <summary>
+/// A rectangle of cells read by a formula. sheet is the index of the worksheet in
+/// the formula_engine, or npos if the reference doesn't point at any cells.
+/// </summary>
+struct formula_area
+{
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::size_t sheet = npos;
+    column_t::index_t first_column = 1;
+    column_t::index_t last_column = 1;
+    row_t first_row = 1;
+    row_t last_row = 1;
+
+    bool contains(std::size_t other_sheet, column_t::index_t column, row_t row) const
+    {
+        return sheet == other_sheet && column >= first_column && column <= last_column
+            && row >= first_row && row <= last_row;
+    }
+};
+
+/// <summary>
+/// A cell with a formula, as last seen by the formula_engine.
+/// </summary>
+struct formula_cell
+{
+    std::size_t sheet = 0;
+    cell_reference reference;
+
+    /// <summary>
+    /// The text of the formula. Cells of a shared formula have the text of its master cell
+    /// and their offset from the master cell, which shifts their relative references.
+    /// </summary>
+    std::string text;
+    std::int64_t column_offset = 0;
+    std::int64_t row_offset = 0;
+
+    /// <summary>
+    /// The parsed text, shared by all cells with the same text, or nullptr if the engine
+    /// can't evaluate it and the cell keeps its cached value.
+    /// </summary>
+    std::shared_ptr<const formula_ast> ast;
+
+    std::vector<formula_area> precedents;
+
+    /// <summary>
+    /// The indices of the formula cells whose precedents contain this cell.
+    /// </summary>
+    std::vector<std::size_t> dependents;
+};
+
+/// <summary>
+/// Evaluates the formulas of a workbook, see workbook::calculate. Between calls it keeps
+/// the parsed formulas, the dependency graph between the formula cells and a fingerprint
+/// of each cell which formulas read. The cell setters don't notify the engine, so the
+/// cells changed since the previous call are found by comparing the fingerprints, and
+/// only the formulas depending on them are evaluated again.
+/// </summary>
+class XLNT_API_INTERNAL formula_engine
+{
+public:
+    /// <summary>
+    /// Evaluates the formulas of wb which may have changed since the previous call and
+    /// returns how many were evaluated. Independent formulas are evaluated on up to
+    /// threads threads.
+    /// </summary>
+    std::size_t calculate(workbook &wb, std::size_t threads);
+
+    /// <summary>
+    /// Returns the formula cells seen by the last call to calculate in an order in which
+    /// every formula comes after the formulas it reads. Formulas in or after a cycle come last.
+    /// The order is empty if the worksheets of wb changed since then.
+    /// </summary>
+    std::vector<calculation_chain_entry> evaluation_order(const workbook_impl &wb) const;
+
+    /// <summary>
+    /// Returns the cells the reference node points at when evaluated in formula.
+    /// </summary>
+    formula_area resolve(const formula_node &reference, const formula_cell &formula) const;
+
+    /// <summary>
+    /// Returns the worksheet with the given index.
+    /// </summary>
+    worksheet_impl &sheet(std::size_t index) const;
+
+private:
+    struct sheet_state
+    {
+        worksheet_impl *impl = nullptr;
+        std::string title;
+
+        /// <summary>
+        /// The bounds of the areas formulas read on this worksheet. Only the cells within
+        /// them are fingerprinted.
+        /// </summary>
+        cell_bounds read;
+        std::unordered_map<cell_reference, std::uint64_t> fingerprints;
+    };
+
+    /// <summary>
+    /// Returns true if the worksheets of wb are the ones seen by the previous call.
+    /// </summary>
+    bool same_sheets(const workbook_impl &wb) const;
+
+    /// <summary>
+    /// Starts over if the worksheets of wb aren't the ones seen by the previous call,
+    /// since references resolve to different cells then.
+    /// </summary>
+    void track_sheets(workbook &wb);
+
+    /// <summary>
+    /// Returns the formula cells of all worksheets in row-major order and appends the
+    /// cells read by formulas whose value changed since the previous call to changed.
+    /// </summary>
+    std::vector<formula_cell> scan(std::vector<std::vector<cell_reference>> &changed);
+
+    /// <summary>
+    /// Replaces formulas_ with formulas, reusing the parsed formulas which didn't change,
+    /// and rebuilds the dependency graph. New and edited formulas are marked in dirty and
+    /// the cells of removed formulas are appended to changed.
+    /// </summary>
+    void rebuild(std::vector<formula_cell> &&formulas, std::vector<bool> &dirty,
+        std::vector<std::vector<cell_reference>> &changed);
+
+    /// <summary>
+    /// Fingerprints the cells of sheet within its read bounds again.
+    /// </summary>
+    void refresh_fingerprints(sheet_state &sheet);
+
+    /// <summary>
+    /// Evaluates formula and stores the result in its cell.
+    /// </summary>
+    void evaluate(workbook &wb, const formula_cell &formula) const;
+
+    std::vector<sheet_state> sheets_;
+    std::unordered_map<std::string, std::size_t> sheet_indices_;
+    std::vector<formula_cell> formulas_;
+
+    /// <summary>
+    /// The indices of formulas_ ordered by sheet, column and row.
+    /// </summary>
+    std::vector<std::size_t> formulas_by_column_;
+    std::unordered_map<std::string, std::shared_ptr<const formula_ast>> parsed_;
+    bool calculated_ = false;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,679 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <cctype>
+#include <limits>
+#include <unordered_map>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/constants.hpp>
+#include <detail/formula/formula_parser.hpp>
+#include <detail/serialization/parsers.hpp>
+
+namespace {
+
+using xlnt::detail::formula_function;
+using xlnt::detail::formula_node;
+
+struct function_signature
+{
+    formula_function function;
+    std::size_t min_arguments;
+    std::size_t max_arguments;
+};
+
+const std::size_t any_count = std::numeric_limits<std::size_t>::max();
+
+const std::unordered_map<std::string, function_signature> &functions()
+{
+    static const std::unordered_map<std::string, function_signature> functions = {
+        {"ABS", {formula_function::abs, 1, 1}},
+        {"AND", {formula_function::and_, 1, any_count}},
+        {"AVERAGE", {formula_function::average, 1, any_count}},
+        {"CONCAT", {formula_function::concatenate, 1, any_count}},
+        {"CONCATENATE", {formula_function::concatenate, 1, any_count}},
+        {"COUNT", {formula_function::count, 1, any_count}},
+        {"COUNTA", {formula_function::counta, 1, any_count}},
+        {"COUNTBLANK", {formula_function::countblank, 1, 1}},
+        {"IF", {formula_function::if_, 2, 3}},
+        {"IFERROR", {formula_function::iferror, 2, 2}},
+        {"INT", {formula_function::int_, 1, 1}},
+        {"ISBLANK", {formula_function::isblank, 1, 1}},
+        {"ISERROR", {formula_function::iserror, 1, 1}},
+        {"ISNUMBER", {formula_function::isnumber, 1, 1}},
+        {"ISTEXT", {formula_function::istext, 1, 1}},
+        {"LEFT", {formula_function::left, 1, 2}},
+        {"LEN", {formula_function::len, 1, 1}},
+        {"LOWER", {formula_function::lower, 1, 1}},
+        {"MAX", {formula_function::max, 1, any_count}},
+        {"MID", {formula_function::mid, 3, 3}},
+        {"MIN", {formula_function::min, 1, any_count}},
+        {"MOD", {formula_function::mod, 2, 2}},
+        {"NA", {formula_function::na, 0, 0}},
+        {"NOT", {formula_function::not_, 1, 1}},
+        {"OR", {formula_function::or_, 1, any_count}},
+        {"PI", {formula_function::pi, 0, 0}},
+        {"POWER", {formula_function::power, 2, 2}},
+        {"PRODUCT", {formula_function::product, 1, any_count}},
+        {"RIGHT", {formula_function::right, 1, 2}},
+        {"ROUND", {formula_function::round, 2, 2}},
+        {"ROUNDDOWN", {formula_function::rounddown, 2, 2}},
+        {"ROUNDUP", {formula_function::roundup, 2, 2}},
+        {"SQRT", {formula_function::sqrt, 1, 1}},
+        {"SUM", {formula_function::sum, 1, any_count}},
+        {"TRIM", {formula_function::trim, 1, 1}},
+        {"UPPER", {formula_function::upper, 1, 1}}};
+
+    return functions;
+}
+
+bool is_name_character(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$' || c == '\\';
+}
+
+std::string to_upper(std::string text)
+{
+    for (auto &c : text)
+    {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    return text;
+}
+
+/// <summary>
+/// A recursive descent parser over the text of a formula. The precedence of the
+/// operators from lowest to highest is comparison, &amp;, + -, * /, ^, % and negation,
+/// with ranges bound inside references.
+/// </summary>
+class formula_parser
+{
+public:
+    explicit formula_parser(const std::string &text)
+        : text_(text)
+    {
+    }
+
+    xlnt::detail::formula_ast parse()
+    {
+        ast_.root = parse_comparison();
+        skip_space();
+
+        if (position_ != text_.size())
+        {
+            fail();
+        }
+
+        return std::move(ast_);
+    }
+
+private:
+    [[noreturn]] void fail() const
+    {
+        throw xlnt::exception("unsupported formula " + text_);
+    }
+
+    void skip_space()
+    {
+        while (position_ < text_.size() && (text_[position_] == ' ' || text_[position_] == '\n' || text_[position_] == '\r'))
+        {
+            ++position_;
+        }
+    }
+
+    bool match(const char *token)
+    {
+        skip_space();
+        const auto length = std::char_traits<char>::length(token);
+
+        if (text_.compare(position_, length, token) != 0)
+        {
+            return false;
+        }
+
+        position_ += length;
+        return true;
+    }
+
+    char peek() const
+    {
+        return position_ < text_.size() ? text_[position_] : '\0';
+    }
+
+    std::size_t add(formula_node &&node)
+    {
+        ast_.nodes.push_back(std::move(node));
+        return ast_.nodes.size() - 1;
+    }
+
+    std::size_t add_operator(formula_node::kind type, const std::string &op, std::size_t lhs, std::size_t rhs)
+    {
+        formula_node node;
+        node.type = type;
+        node.text = op;
+        node.operands.push_back(lhs);
+
+        if (type == formula_node::kind::binary)
+        {
+            node.operands.push_back(rhs);
+        }
+
+        return add(std::move(node));
+    }
+
+    std::size_t parse_comparison()
+    {
+        auto lhs = parse_concatenation();
+
+        while (true)
+        {
+            static const char *const operators[] = {"<>", "<=", ">=", "=", "<", ">"};
+            const char *matched = nullptr;
+
+            for (auto op : operators)
+            {
+                if (match(op))
+                {
+                    matched = op;
+                    break;
+                }
+            }
+
+            if (matched == nullptr) return lhs;
+
+            lhs = add_operator(formula_node::kind::binary, matched, lhs, parse_concatenation());
+        }
+    }
+
+    std::size_t parse_concatenation()
+    {
+        auto lhs = parse_additive();
+
+        while (match("&"))
+        {
+            lhs = add_operator(formula_node::kind::binary, "&", lhs, parse_additive());
+        }
+
+        return lhs;
+    }
+
+    std::size_t parse_additive()
+    {
+        auto lhs = parse_multiplicative();
+
+        while (true)
+        {
+            if (match("+"))
+            {
+                lhs = add_operator(formula_node::kind::binary, "+", lhs, parse_multiplicative());
+            }
+            else if (match("-"))
+            {
+                lhs = add_operator(formula_node::kind::binary, "-", lhs, parse_multiplicative());
+            }
+            else
+            {
+                return lhs;
+            }
+        }
+    }
+
+    std::size_t parse_multiplicative()
+    {
+        auto lhs = parse_power();
+
+        while (true)
+        {
+            if (match("*"))
+            {
+                lhs = add_operator(formula_node::kind::binary, "*", lhs, parse_power());
+            }
+            else if (match("/"))
+            {
+                lhs = add_operator(formula_node::kind::binary, "/", lhs, parse_power());
+            }
+            else
+            {
+                return lhs;
+            }
+        }
+    }
+
+    std::size_t parse_power()
+    {
+        auto lhs = parse_percent();
+
+        while (match("^"))
+        {
+            lhs = add_operator(formula_node::kind::binary, "^", lhs, parse_percent());
+        }
+
+        return lhs;
+    }
+
+    std::size_t parse_percent()
+    {
+        auto operand = parse_unary();
+
+        while (match("%"))
+        {
+            operand = add_operator(formula_node::kind::percent, "%", operand, 0);
+        }
+
+        return operand;
+    }
+
+    std::size_t parse_unary()
+    {
+        if (match("-"))
+        {
+            return add_operator(formula_node::kind::unary, "-", parse_unary(), 0);
+        }
+
+        if (match("+"))
+        {
+            return parse_unary();
+        }
+
+        return parse_primary();
+    }
+
+    std::size_t parse_primary()
+    {
+        skip_space();
+        const auto c = peek();
+
+        if (c == '(')
+        {
+            ++position_;
+            const auto inner = parse_comparison();
+
+            if (!match(")")) fail();
+
+            return inner;
+        }
+
+        if (c == '"')
+        {
+            return parse_string();
+        }
+
+        if (c == '#')
+        {
+            return parse_error();
+        }
+
+        if (c == '\'')
+        {
+            return parse_reference(parse_quoted_sheet());
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+        {
+            return is_row_range() ? parse_reference(std::string()) : parse_number();
+        }
+
+        if (is_name_character(c))
+        {
+            return parse_name();
+        }
+
+        fail();
+    }
+
+    std::size_t parse_string()
+    {
+        formula_node node;
+        node.type = formula_node::kind::string;
+        ++position_;
+
+        while (true)
+        {
+            if (position_ >= text_.size()) fail();
+
+            const auto c = text_[position_++];
+
+            if (c == '"')
+            {
+                if (peek() != '"') break;
+                ++position_;
+            }
+
+            node.text.push_back(c);
+        }
+
+        return add(std::move(node));
+    }
+
+    std::size_t parse_error()
+    {
+        static const char *const errors[] = {"#DIV/0!", "#GETTING_DATA", "#N/A", "#NAME?", "#NULL!", "#NUM!", "#REF!", "#VALUE!"};
+
+        for (auto error : errors)
+        {
+            if (match(error))
+            {
+                formula_node node;
+                node.type = formula_node::kind::error;
+                node.text = error;
+
+                return add(std::move(node));
+            }
+        }
+
+        fail();
+    }
+
+    std::size_t parse_number()
+    {
+        const auto start = position_;
+
+        while (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '.')
+        {
+            ++position_;
+        }
+
+        if (peek() == 'e' || peek() == 'E')
+        {
+            ++position_;
+
+            if (peek() == '+' || peek() == '-') ++position_;
+
+            while (std::isdigit(static_cast<unsigned char>(peek())))
+            {
+                ++position_;
+            }
+        }
+
+        formula_node node;
+        node.type = formula_node::kind::number;
+
+        const auto first = text_.data() + start;
+        const auto last = text_.data() + position_;
+        if (xlnt::detail::parse(first, last, node.number) != std::errc())
+        {
+            fail();
+        }
+
+        return add(std::move(node));
+    }
+
+    std::string parse_quoted_sheet()
+    {
+        std::string sheet;
+        ++position_;
+
+        while (true)
+        {
+            if (position_ >= text_.size()) fail();
+
+            const auto c = text_[position_++];
+
+            if (c == '\'')
+            {
+                if (peek() != '\'') break;
+                ++position_;
+            }
+
+            sheet.push_back(c);
+        }
+
+        if (peek() != '!') fail();
+        ++position_;
+
+        return sheet;
+    }
+
+    std::size_t parse_name()
+    {
+        const auto start = position_;
+        auto end = start;
+
+        while (end < text_.size() && is_name_character(text_[end]))
+        {
+            ++end;
+        }
+
+        const auto word = text_.substr(start, end - start);
+
+        if (end < text_.size() && text_[end] == '!')
+        {
+            position_ = end + 1;
+            return parse_reference(word);
+        }
+
+        auto after = end;
+        while (after < text_.size() && text_[after] == ' ')
+        {
+            ++after;
+        }
+
+        if (after < text_.size() && text_[after] == '(')
+        {
+            position_ = after + 1;
+            return parse_function(word);
+        }
+
+        const auto upper = to_upper(word);
+
+        if (upper == "TRUE" || upper == "FALSE")
+        {
+            position_ = end;
+
+            formula_node node;
+            node.type = formula_node::kind::boolean;
+            node.number = upper == "TRUE" ? 1.0 : 0.0;
+
+            return add(std::move(node));
+        }
+
+        return parse_reference(std::string());
+    }
+
+    std::size_t parse_function(const std::string &name)
+    {
+        auto upper = to_upper(name);
+
+        for (auto prefix : {"_XLFN.", "_XLWS."})
+        {
+            if (upper.compare(0, 6, prefix) == 0)
+            {
+                upper.erase(0, 6);
+            }
+        }
+
+        const auto match_function = functions().find(upper);
+        if (match_function == functions().end()) fail();
+
+        formula_node node;
+        node.type = formula_node::kind::function;
+        node.function = match_function->second.function;
+
+        if (!match(")"))
+        {
+            do
+            {
+                node.operands.push_back(parse_comparison());
+            } while (match(","));
+
+            if (!match(")")) fail();
+        }
+
+        if (node.operands.size() < match_function->second.min_arguments
+            || node.operands.size() > match_function->second.max_arguments)
+        {
+            fail();
+        }
+
+        return add(std::move(node));
+    }
+
+    /// <summary>
+    /// Returns true if the text at the current position has the form [$]digits:[$]digits.
+    /// </summary>
+    bool is_row_range() const
+    {
+        auto p = position_;
+        auto digits = [this, &p]() {
+            if (p < text_.size() && text_[p] == '$') ++p;
+            const auto start = p;
+            while (p < text_.size() && std::isdigit(static_cast<unsigned char>(text_[p]))) ++p;
+            return p > start;
+        };
+
+        if (!digits() || p >= text_.size() || text_[p++] != ':') return false;
+
+        return digits();
+    }
+
+    /// <summary>
+    /// Parses one side of a reference, which is a cell, a column or a row. The flags
+    /// of the side found are set in has_column and has_row.
+    /// </summary>
+    void parse_reference_part(xlnt::column_t::index_t &column, xlnt::row_t &row,
+        bool &absolute_column, bool &absolute_row, bool &has_column, bool &has_row)
+    {
+        absolute_column = peek() == '$';
+        if (absolute_column) ++position_;
+
+        std::string letters;
+        while (std::isalpha(static_cast<unsigned char>(peek())) && letters.size() < 4)
+        {
+            letters.push_back(text_[position_++]);
+        }
+
+        has_column = !letters.empty();
+
+        if (has_column)
+        {
+            if (letters.size() > 3) fail();
+            column = xlnt::column_t::column_index_from_string(to_upper(letters));
+            if (column > xlnt::constants::max_column().index) fail();
+            absolute_row = peek() == '$';
+            if (absolute_row) ++position_;
+        }
+        else
+        {
+            absolute_row = absolute_column;
+            absolute_column = false;
+        }
+
+        std::uint64_t number = 0;
+        has_row = false;
+
+        while (std::isdigit(static_cast<unsigned char>(peek())))
+        {
+            number = number * 10 + static_cast<std::uint64_t>(text_[position_++] - '0');
+            if (number > xlnt::constants::max_row()) fail();
+            has_row = true;
+        }
+
+        if (has_row)
+        {
+            if (number == 0) fail();
+            row = static_cast<xlnt::row_t>(number);
+        }
+        else if (absolute_row)
+        {
+            fail();
+        }
+    }
+
+    std::size_t parse_reference(const std::string &sheet)
+    {
+        formula_node node;
+        node.type = formula_node::kind::reference;
+        node.sheet = sheet;
+
+        bool absolute_column = false, absolute_row = false, has_column = false, has_row = false;
+        parse_reference_part(node.first_column, node.first_row, absolute_column, absolute_row, has_column, has_row);
+
+        if (absolute_column) node.absolute |= formula_node::absolute_first_column;
+        if (absolute_row) node.absolute |= formula_node::absolute_first_row;
+
+        const auto first_has_column = has_column;
+        const auto first_has_row = has_row;
+
+        if (!has_column && !has_row) fail();
+
+        if (peek() == ':')
+        {
+            ++position_;
+            parse_reference_part(node.last_column, node.last_row, absolute_column, absolute_row, has_column, has_row);
+
+            if (has_column != first_has_column || has_row != first_has_row) fail();
+
+            if (absolute_column) node.absolute |= formula_node::absolute_last_column;
+            if (absolute_row) node.absolute |= formula_node::absolute_last_row;
+        }
+        else if (!has_column || !has_row)
+        {
+            fail();
+        }
+        else
+        {
+            node.last_column = node.first_column;
+            node.last_row = node.first_row;
+            if (absolute_column) node.absolute |= formula_node::absolute_last_column;
+            if (absolute_row) node.absolute |= formula_node::absolute_last_row;
+        }
+
+        // a defined name or a function name without parentheses
+        if (is_name_character(peek()) || peek() == '(') fail();
+
+        if (!first_has_row)
+        {
+            node.first_row = 1;
+            node.last_row = xlnt::constants::max_row();
+            node.absolute |= formula_node::absolute_first_row | formula_node::absolute_last_row;
+        }
+
+        if (!first_has_column)
+        {
+            node.first_column = 1;
+            node.last_column = xlnt::constants::max_column().index;
+            node.absolute |= formula_node::absolute_first_column | formula_node::absolute_last_column;
+        }
+
+        return add(std::move(node));
+    }
+
+    const std::string &text_;
+    std::size_t position_ = 0;
+    xlnt::detail::formula_ast ast_;
+};
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+formula_ast parse_formula(const std::string &text)
+{
+    return formula_parser(text).parse();
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,161 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/index_types.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The worksheet functions the formula engine can evaluate.
+/// </summary>
+enum class formula_function
+{
+    abs,
+    and_,
+    average,
+    concatenate,
+    count,
+    counta,
+    countblank,
+    if_,
+    iferror,
+    int_,
+    isblank,
+    iserror,
+    isnumber,
+    istext,
+    left,
+    len,
+    lower,
+    max,
+    mid,
+    min,
+    mod,
+    na,
+    not_,
+    or_,
+    pi,
+    power,
+    product,
+    right,
+    round,
+    rounddown,
+    roundup,
+    sqrt,
+    sum,
+    trim,
+    upper
+};
+
+/// <summary>
+/// One node of a parsed formula. Operands are referred to by their index in
+/// formula_ast::nodes so that a parsed formula is a single allocation.
+/// </summary>
+struct formula_node
+{
+    enum class kind
+    {
+        number,
+        string,
+        boolean,
+        error,
+        reference,
+        unary,
+        binary,
+        percent,
+        function
+    };
+
+    /// <summary>
+    /// Bits of formula_node::absolute for the $ markers of a reference.
+    /// </summary>
+    enum absolute_flags : std::uint8_t
+    {
+        absolute_first_column = 1,
+        absolute_first_row = 2,
+        absolute_last_column = 4,
+        absolute_last_row = 8
+    };
+
+    kind type = kind::number;
+
+    /// <summary>
+    /// The value of a number or boolean literal.
+    /// </summary>
+    double number = 0.0;
+
+    /// <summary>
+    /// The text of a string or error literal or the operator of a unary or binary node.
+    /// </summary>
+    std::string text;
+
+    formula_function function = formula_function::sum;
+
+    /// <summary>
+    /// The title of the worksheet a reference points into, empty for the worksheet
+    /// of the formula itself.
+    /// </summary>
+    std::string sheet;
+
+    /// <summary>
+    /// The corners of a reference as written. Whole columns span every row and whole
+    /// rows every column, with the corresponding bounds marked absolute.
+    /// </summary>
+    column_t::index_t first_column = 1;
+    column_t::index_t last_column = 1;
+    row_t first_row = 1;
+    row_t last_row = 1;
+    std::uint8_t absolute = 0;
+
+    std::vector<std::size_t> operands;
+};
+
+/// <summary>
+/// A formula parsed once from its text. References are kept as written, so cells of
+/// a shared formula evaluate the same tree with the offset of the cell from the
+/// master cell applied to their relative references.
+/// </summary>
+struct formula_ast
+{
+    std::vector<formula_node> nodes;
+    std::size_t root = 0;
+};
+
+/// <summary>
+/// Parses the text of a formula as stored in a cell, without the leading '='.
+/// Throws xlnt::exception if the text isn't a formula the engine can evaluate,
+/// including formulas calling functions it doesn't know.
+/// </summary>
+XLNT_API_INTERNAL formula_ast parse_formula(const std::string &text);
+
+} // namespace detail
+} // namespace xlnt
@@ -507,7 +507,8 @@ std::string encode_header_footer(const rich_text &t, header_footer::location whe
             if (run.second.get().has_size())
             {
                 encoded.push_back('&');
-                encoded.append(xlnt::detail::serialise(run.second.get().size()));
+                char size[xlnt::detail::serialised_double_capacity];
+                encoded.append(size, xlnt::detail::serialise_to(size, run.second.get().size()));
             }
             if (run.second.get().underlined())
             {
@@ -539,5 +540,94 @@ std::string encode_header_footer(const rich_text &t, header_footer::location whe
     return encoded;
 };
 
+const std::array<xlnt::optional<xlnt::rich_text>, 3> &decode_header_footer(const std::string &hf_string, decoded_header_footers &decoded)
+{
+    auto match = decoded.find(hf_string);
+
+    if (match == decoded.end())
+    {
+        match = decoded.emplace(hf_string, decode_header_footer(hf_string)).first;
+    }
+
+    return match->second;
+}
+
+encoded_header_footer encode_header_footer(const header_footer &hf)
+{
+    encoded_header_footer result;
+    auto &odd_header = result[0];
+    auto &odd_footer = result[1];
+    auto &even_header = result[2];
+    auto &even_footer = result[3];
+    auto &first_header = result[4];
+    auto &first_footer = result[5];
+
+    const auto locations =
+        {
+            header_footer::location::left,
+            header_footer::location::center,
+            header_footer::location::right};
+
+    for (auto location : locations)
+    {
+        if (hf.different_odd_even())
+        {
+            if (hf.has_odd_even_header(location))
+            {
+                odd_header.append(encode_header_footer(hf.odd_header(location), location));
+                even_header.append(encode_header_footer(hf.even_header(location), location));
+            }
+
+            if (hf.has_odd_even_footer(location))
+            {
+                odd_footer.append(encode_header_footer(hf.odd_footer(location), location));
+                even_footer.append(encode_header_footer(hf.even_footer(location), location));
+            }
+        }
+        else
+        {
+            if (hf.has_header(location))
+            {
+                odd_header.append(encode_header_footer(hf.header(location), location));
+            }
+
+            if (hf.has_footer(location))
+            {
+                odd_footer.append(encode_header_footer(hf.footer(location), location));
+            }
+        }
+
+        if (hf.different_first())
+        {
+            if (hf.has_first_page_header(location))
+            {
+                first_header.append(encode_header_footer(hf.first_page_header(location), location));
+            }
+
+            if (hf.has_first_page_footer(location))
+            {
+                first_footer.append(encode_header_footer(hf.first_page_footer(location), location));
+            }
+        }
+    }
+
+    return result;
+}
+
+const encoded_header_footer &encode_header_footer(const header_footer &hf, encoded_header_footers &encoded)
+{
+    for (const auto &existing : encoded)
+    {
+        if (existing.first == hf)
+        {
+            return existing.second;
+        }
+    }
+
+    encoded.emplace_back(hf, encode_header_footer(hf));
+
+    return encoded.back().second;
+}
+
 } // namespace detail
 } // namespace xlnt
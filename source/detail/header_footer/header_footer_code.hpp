@@ -24,6 +24,9 @@
 
 #include <array>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <xlnt/cell/rich_text.hpp>
 #include <xlnt/utils/optional.hpp>
@@ -36,5 +39,38 @@ namespace detail {
 std::array<xlnt::optional<xlnt::rich_text>, 3> decode_header_footer(const std::string &hf_string);
 std::string encode_header_footer(const rich_text &t, header_footer::location where);
 
+/// <summary>
+/// Decoded header and footer codes by their text. Sheets of a workbook often share their
+/// headers and footers, which are then only tokenized once.
+/// </summary>
+using decoded_header_footers = std::unordered_map<std::string, std::array<xlnt::optional<xlnt::rich_text>, 3>>;
+
+/// <summary>
+/// Returns the decoded hf_string from decoded, decoding and adding it if it's new.
+/// </summary>
+const std::array<xlnt::optional<xlnt::rich_text>, 3> &decode_header_footer(const std::string &hf_string, decoded_header_footers &decoded);
+
+/// <summary>
+/// The codes of the oddHeader, oddFooter, evenHeader, evenFooter, firstHeader and firstFooter
+/// elements of a header_footer in that order. An empty code means the element is omitted.
+/// </summary>
+using encoded_header_footer = std::array<std::string, 6>;
+
+/// <summary>
+/// Encodes every header and footer of hf.
+/// </summary>
+encoded_header_footer encode_header_footer(const header_footer &hf);
+
+/// <summary>
+/// Header_footers with their encoded codes, looked up by equality since a workbook only
+/// has a few distinct ones.
+/// </summary>
+using encoded_header_footers = std::vector<std::pair<header_footer, encoded_header_footer>>;
+
+/// <summary>
+/// Returns the encoded hf from encoded, encoding and adding it if it's new.
+/// </summary>
+const encoded_header_footer &encode_header_footer(const header_footer &hf, encoded_header_footers &encoded);
+
 } // namespace detail
 } // namespace xlnt
@@ -23,6 +23,7 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -40,29 +41,209 @@ namespace detail {
 
 struct worksheet_impl;
 
+/// <summary>
+/// The fields of a cell which most cells never use. They are allocated on first
+/// write so that a plain numeric or shared string cell stays small.
+/// </summary>
+struct cell_extension
+{
+    cell_extension() = default;
+
+    cell_extension(const cell_extension &other)
+        : value_text_(other.value_text_),
+          formula_(other.formula_),
+          hyperlink_(other.hyperlink_ ? new hyperlink_impl(*other.hyperlink_) : nullptr),
+          comment_(other.comment_)
+    {
+    }
+
+    cell_extension &operator=(const cell_extension &other)
+    {
+        value_text_ = other.value_text_;
+        formula_ = other.formula_;
+        hyperlink_.reset(other.hyperlink_ ? new hyperlink_impl(*other.hyperlink_) : nullptr);
+        comment_ = other.comment_;
+
+        return *this;
+    }
+
+    rich_text value_text_;
+    optional<std::string> formula_;
+    std::unique_ptr<hyperlink_impl> hyperlink_;
+    optional<xlnt::comment *> comment_;
+};
+
 struct cell_impl
 {
-    cell_type type_ = cell_type::empty;
+    cell_impl() = default;
+
+    cell_impl(const cell_impl &other)
+    {
+        *this = other;
+    }
+
+    cell_impl &operator=(const cell_impl &other)
+    {
+        parent_ = other.parent_;
+        // copied as an integer so that the bits of one never pass through a float register
+        value_integer_ = other.value_integer_;
+        value_integral_ = other.value_integral_;
+        format_ = other.format_;
+        extension_.reset(other.extension_ ? new cell_extension(*other.extension_) : nullptr);
+        column_ = other.column_;
+        row_ = other.row_;
+        type_ = other.type_;
+        is_merged_ = other.is_merged_;
+        phonetics_visible_ = other.phonetics_visible_;
+        formula_group_ = other.formula_group_;
+
+        return *this;
+    }
+
+    cell_impl(cell_impl &&other) = default;
+    cell_impl &operator=(cell_impl &&other) = default;
+
+    /// <summary>
+    /// Returns this cell to the state of a default constructed one while keeping its
+    /// extension allocated, so that it can be reused for another cell.
+    /// </summary>
+    void reset()
+    {
+        parent_ = nullptr;
+        value_numeric_ = 0.0;
+        value_integral_ = false;
+        format_.clear();
+        column_ = 1;
+        row_ = 1;
+        type_ = cell_type::empty;
+        is_merged_ = false;
+        phonetics_visible_ = false;
+        formula_group_ = 0;
+
+        if (extension_)
+        {
+            extension_->value_text_.clear();
+            extension_->formula_.clear();
+            extension_->hyperlink_.reset();
+            extension_->comment_.clear();
+        }
+    }
 
     worksheet_impl *parent_ = nullptr;
 
+    /// <summary>
+    /// The value of a number, boolean or shared string cell, where booleans are 0 or 1 and
+    /// shared strings the index of their string. A number is kept in value_integer_ instead
+    /// if value_integral_ is set. Numbers are read and written with value_number and
+    /// value_integer, which keep the two apart.
+    /// </summary>
+    union
+    {
+        double value_numeric_ = 0.0;
+        std::int64_t value_integer_;
+    };
+
+    optional<format_impl *> format_;
+
+    std::unique_ptr<cell_extension> extension_;
+
     column_t column_ = 1;
     row_t row_ = 1;
 
+    cell_type type_ = cell_type::empty;
+
     bool is_merged_ = false;
     bool phonetics_visible_ = false;
 
-    rich_text value_text_;
-    double value_numeric_ = 0.0;
+    /// <summary>
+    /// Set if the number of this cell is held exactly in value_integer_, which it is
+    /// if it was set from an integer type or read without a fraction or exponent.
+    /// </summary>
+    bool value_integral_ = false;
 
-    optional<std::string> formula_;
-    optional<hyperlink_impl> hyperlink_;
-    optional<format_impl *> format_;
-    optional<comment *> comment_;
+    /// <summary>
+    /// One plus the index of the formula group in parent_->formula_groups_ which
+    /// provides the formula of this cell, or 0 if the formula is stored in the extension.
+    /// </summary>
+    std::uint32_t formula_group_ = 0;
+
+    /// <summary>
+    /// Returns the out-of-line fields of this cell, allocating them if needed.
+    /// Use the const accessors below for reading so nothing is allocated.
+    /// </summary>
+    cell_extension &extension()
+    {
+        if (!extension_)
+        {
+            extension_.reset(new cell_extension());
+        }
+
+        return *extension_;
+    }
+
+    /// <summary>
+    /// Returns the number of this cell, or its boolean or shared string index.
+    /// </summary>
+    double value_number() const
+    {
+        return value_integral_ ? static_cast<double>(value_integer_) : value_numeric_;
+    }
+
+    /// <summary>
+    /// Sets the number of this cell, or its boolean or shared string index.
+    /// </summary>
+    void value_number(double number)
+    {
+        value_numeric_ = number;
+        value_integral_ = false;
+    }
+
+    /// <summary>
+    /// Returns the number of this cell truncated to an integer, which is exact if
+    /// value_integral_ is set.
+    /// </summary>
+    std::int64_t value_integer() const
+    {
+        return value_integral_ ? value_integer_ : static_cast<std::int64_t>(value_numeric_);
+    }
+
+    /// <summary>
+    /// Sets the number of this cell to integer, keeping all of its digits.
+    /// </summary>
+    void value_integer(std::int64_t integer)
+    {
+        value_integer_ = integer;
+        value_integral_ = true;
+    }
+
+    const rich_text &value_text() const
+    {
+        static const rich_text empty;
+        return extension_ ? extension_->value_text_ : empty;
+    }
+
+    /// <summary>
+    /// Returns the formula of this cell, which is either its own or that of its formula group.
+    /// </summary>
+    const optional<std::string> &formula() const;
+
+    /// <summary>
+    /// Returns the hyperlink of this cell or nullptr if it has none.
+    /// </summary>
+    hyperlink_impl *hyperlink() const
+    {
+        return extension_ ? extension_->hyperlink_.get() : nullptr;
+    }
+
+    const optional<xlnt::comment *> &comment() const
+    {
+        static const optional<xlnt::comment *> empty;
+        return extension_ ? extension_->comment_ : empty;
+    }
 
     bool is_garbage_collectible() const
     {
-        return !(type_ != cell_type::empty || is_merged_ || phonetics_visible_ || formula_.is_set() || format_.is_set() || hyperlink_.is_set());
+        return !(type_ != cell_type::empty || is_merged_ || phonetics_visible_ || formula().is_set() || format_.is_set() || hyperlink() != nullptr || comment().is_set());
     }
 };
 
@@ -72,12 +253,13 @@ inline bool operator==(const cell_impl &lhs, const cell_impl &rhs)
     return lhs.type_ == rhs.type_
         && lhs.is_merged_ == rhs.is_merged_
         && lhs.phonetics_visible_ == rhs.phonetics_visible_
-        && lhs.value_text_ == rhs.value_text_
-        && float_equals(lhs.value_numeric_, rhs.value_numeric_)
-        && lhs.formula_ == rhs.formula_
-        && lhs.hyperlink_ == rhs.hyperlink_
+        && lhs.value_text() == rhs.value_text()
+        && (lhs.value_integral_ && rhs.value_integral_ ? lhs.value_integer_ == rhs.value_integer_
+                                                        : float_equals(lhs.value_number(), rhs.value_number()))
+        && lhs.formula() == rhs.formula()
+        && ((lhs.hyperlink() == nullptr) == (rhs.hyperlink() == nullptr) && (lhs.hyperlink() == nullptr || *lhs.hyperlink() == *rhs.hyperlink()))
         && (lhs.format_.is_set() == rhs.format_.is_set() && (!lhs.format_.is_set() || *lhs.format_.get() == *rhs.format_.get()))
-        && (lhs.comment_.is_set() == rhs.comment_.is_set() && (!lhs.comment_.is_set() || *lhs.comment_.get() == *rhs.comment_.get()));
+        && (lhs.comment().is_set() == rhs.comment().is_set() && (!lhs.comment().is_set() || *lhs.comment().get() == *rhs.comment().get()));
 }
 
 inline bool operator!=(const cell_impl &lhs, const cell_impl &rhs)
@@ -0,0 +1,268 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/implementations/cell_spill.hpp>
+
+namespace {
+
+// large enough that even a 10 GB worksheet only needs a few hundred mappings
+const std::size_t default_segment_size = std::size_t(64) << 20;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+cell_spill::cell_spill(std::size_t slot_size, std::size_t budget)
+    : slot_size_(slot_size),
+      segment_size_(default_segment_size < slot_size ? slot_size : default_segment_size),
+      budget_(budget)
+{
+}
+
+cell_spill::~cell_spill()
+{
+    for (const auto &segment : segments_)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(segment.first);
+#else
+        ::munmap(segment.first, segment.second);
+#endif
+    }
+
+#ifdef _WIN32
+    if (file_ != nullptr)
+    {
+        CloseHandle(file_);
+    }
+#else
+    if (file_ != -1)
+    {
+        ::close(file_);
+    }
+#endif
+}
+
+void *cell_spill::allocate()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (heap_bytes_ + slot_size_ <= budget_)
+    {
+        auto slot = ::operator new(slot_size_);
+        heap_bytes_ += slot_size_;
+
+        return slot;
+    }
+
+    if (!free_slots_.empty())
+    {
+        auto slot = free_slots_.back();
+        free_slots_.pop_back();
+        file_bytes_ += slot_size_;
+
+        return slot;
+    }
+
+    if (current_ == nullptr || segment_used_ + slot_size_ > segment_size_)
+    {
+        grow();
+    }
+
+    auto slot = current_ + segment_used_;
+    segment_used_ += slot_size_;
+    file_bytes_ += slot_size_;
+
+    return slot;
+}
+
+void cell_spill::deallocate(void *slot)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (in_file(slot))
+    {
+        free_slots_.push_back(slot);
+        file_bytes_ -= slot_size_;
+
+        return;
+    }
+
+    ::operator delete(slot);
+    heap_bytes_ -= slot_size_;
+}
+
+std::size_t cell_spill::budget() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+void cell_spill::budget(std::size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+}
+
+std::size_t cell_spill::heap_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return heap_bytes_;
+}
+
+std::size_t cell_spill::file_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_bytes_;
+}
+
+bool cell_spill::in_file(const void *slot) const
+{
+    auto segment = segments_.upper_bound(static_cast<std::uint8_t *>(const_cast<void *>(slot)));
+    if (segment == segments_.begin()) return false;
+
+    --segment;
+    return static_cast<const std::uint8_t *>(slot) < segment->first + segment->second;
+}
+
+#ifdef _WIN32
+
+void cell_spill::grow()
+{
+    if (file_ == nullptr)
+    {
+        wchar_t directory[MAX_PATH + 1];
+        wchar_t name[MAX_PATH + 1];
+
+        if (GetTempPathW(MAX_PATH + 1, directory) == 0 || GetTempFileNameW(directory, L"xln", 0, name) == 0)
+        {
+            throw xlnt::exception("failed to create a temporary file for cells");
+        }
+
+        auto file = CreateFileW(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw xlnt::exception("failed to create a temporary file for cells");
+        }
+
+        file_ = file;
+    }
+    else
+    {
+        // start writing the full segment back so that its pages can be dropped cheaply
+        FlushViewOfFile(current_, segment_size_);
+    }
+
+    const auto offset = static_cast<std::uint64_t>(segments_.size()) * segment_size_;
+    const auto size = offset + segment_size_;
+    auto mapping = CreateFileMappingW(file_, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+
+    if (mapping == nullptr)
+    {
+        throw xlnt::exception("failed to grow the temporary file for cells");
+    }
+
+    auto view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS,
+        static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), segment_size_);
+
+    // the view keeps the mapping alive
+    CloseHandle(mapping);
+
+    if (view == nullptr)
+    {
+        throw xlnt::exception("failed to map the temporary file for cells");
+    }
+
+    current_ = static_cast<std::uint8_t *>(view);
+    segments_.emplace(current_, segment_size_);
+    segment_used_ = 0;
+}
+
+#else
+
+void cell_spill::grow()
+{
+    if (file_ == -1)
+    {
+        const char *directory = std::getenv("TMPDIR");
+        std::string name = std::string(directory != nullptr && *directory != '\0' ? directory : "/tmp") + "/xlnt-cells-XXXXXX";
+
+        const auto file = ::mkstemp(&name[0]);
+        if (file == -1)
+        {
+            throw xlnt::exception("failed to create a temporary file for cells");
+        }
+
+        // the file is removed once the descriptor is closed
+        ::unlink(name.c_str());
+        file_ = file;
+    }
+    else
+    {
+        // start writing the full segment back so that its pages can be dropped cheaply
+        ::msync(current_, segment_size_, MS_ASYNC);
+    }
+
+    const auto offset = static_cast<off_t>(segments_.size() * segment_size_);
+
+    if (::ftruncate(file_, offset + static_cast<off_t>(segment_size_)) != 0)
+    {
+        throw xlnt::exception("failed to grow the temporary file for cells");
+    }
+
+    auto view = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, file_, offset);
+    if (view == MAP_FAILED)
+    {
+        throw xlnt::exception("failed to map the temporary file for cells");
+    }
+
+    current_ = static_cast<std::uint8_t *>(view);
+    segments_.emplace(current_, segment_size_);
+    segment_used_ = 0;
+}
+
+#endif
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,128 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Hands out equally sized slots for the cell blocks of the worksheets of a workbook
+/// using cell_storage::spilled_rows. Slots come from the heap until they take up the
+/// memory budget and from then on from segments of a temporary file mapped into memory,
+/// which the operating system writes back and pages out like any other file rather
+/// than keeping them resident or swapping them. Slots never move, so pointers to the
+/// cells in them stay valid. All functions may be called concurrently.
+/// </summary>
+class XLNT_API_INTERNAL cell_spill
+{
+public:
+    /// <summary>
+    /// Creates a spill for slots of slot_size bytes which starts using its file once
+    /// budget bytes of slots are allocated on the heap. The file is only created then.
+    /// </summary>
+    cell_spill(std::size_t slot_size, std::size_t budget);
+
+    ~cell_spill();
+
+    cell_spill(const cell_spill &) = delete;
+    cell_spill &operator=(const cell_spill &) = delete;
+
+    /// <summary>
+    /// Returns uninitialized memory for one slot. Throws xlnt::exception if the file
+    /// can't be created or grown.
+    /// </summary>
+    void *allocate();
+
+    /// <summary>
+    /// Returns slot, which was allocated by this spill, for reuse.
+    /// </summary>
+    void deallocate(void *slot);
+
+    /// <summary>
+    /// Returns the number of bytes of slots allowed on the heap.
+    /// </summary>
+    std::size_t budget() const;
+
+    /// <summary>
+    /// Sets the number of bytes of slots allowed on the heap. Slots already allocated
+    /// stay where they are.
+    /// </summary>
+    void budget(std::size_t budget);
+
+    /// <summary>
+    /// Returns the number of bytes of slots in use on the heap.
+    /// </summary>
+    std::size_t heap_bytes() const;
+
+    /// <summary>
+    /// Returns the number of bytes of slots in use in the file.
+    /// </summary>
+    std::size_t file_bytes() const;
+
+private:
+    /// <summary>
+    /// Maps another segment of the file, creating the file first if needed.
+    /// </summary>
+    void grow();
+
+    /// <summary>
+    /// Returns true if slot lies in one of the mapped segments.
+    /// </summary>
+    bool in_file(const void *slot) const;
+
+    const std::size_t slot_size_;
+    const std::size_t segment_size_;
+    std::size_t budget_;
+    std::size_t heap_bytes_ = 0;
+    std::size_t file_bytes_ = 0;
+
+    /// <summary>
+    /// The mapped segments by their first byte and size, the segment mapped last, the
+    /// number of its bytes handed out and the file slots which were given back.
+    /// </summary>
+    std::map<std::uint8_t *, std::size_t> segments_;
+    std::uint8_t *current_ = nullptr;
+    std::size_t segment_used_ = 0;
+    std::vector<void *> free_slots_;
+
+#ifdef _WIN32
+    void *file_ = nullptr;
+#else
+    int file_ = -1;
+#endif
+
+    mutable std::mutex mutex_;
+};
+
+} // namespace detail
+} // namespace xlnt
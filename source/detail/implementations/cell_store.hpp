@@ -0,0 +1,1730 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/cell_spill.hpp>
+#include <detail/utils/heap_size.hpp>
+#include <detail/utils/node_pool.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The lowest and highest row and column of the cells in a cell_store.
+/// The bounds of an empty store have each minimum above its maximum.
+/// </summary>
+struct cell_bounds
+{
+    column_t::index_t min_column = std::numeric_limits<column_t::index_t>::max();
+    column_t::index_t max_column = 0;
+    row_t min_row = std::numeric_limits<row_t>::max();
+    row_t max_row = 0;
+
+    void extend(const cell_reference &reference)
+    {
+        min_column = std::min(min_column, reference.column_index());
+        max_column = std::max(max_column, reference.column_index());
+        min_row = std::min(min_row, reference.row());
+        max_row = std::max(max_row, reference.row());
+    }
+
+    bool on_edge(const cell_reference &reference) const
+    {
+        return reference.column_index() == min_column || reference.column_index() == max_column
+            || reference.row() == min_row || reference.row() == max_row;
+    }
+};
+
+/// <summary>
+/// Owns the cells of a worksheet using one of the engines in xlnt::cell_storage.
+/// Pointers to stored cells stay valid until the cell is erased, the store is
+/// cleared or the engine is changed. cell_storage::spilled_rows is the dense engine
+/// with its blocks allocated from a cell_spill, so "the dense engine" below means both.
+/// </summary>
+class cell_store
+{
+public:
+    /// <summary>
+    /// Creates a store using engine. The blocks of cell_storage::spilled_rows are
+    /// allocated from spill, or from the heap if there is none.
+    /// </summary>
+    explicit cell_store(cell_storage engine = cell_storage::hashed, std::shared_ptr<cell_spill> spill = nullptr)
+        : engine_(engine),
+          spill_(std::move(spill))
+    {
+    }
+
+    cell_store(const cell_store &other)
+    {
+        *this = other;
+    }
+
+    cell_store &operator=(const cell_store &other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        engine_ = other.engine_;
+        spill_ = other.spill_;
+        hashed_ = other.hashed_;
+        bounds_ = other.bounds_;
+        bounds_valid_ = other.bounds_valid_.load();
+        collected_ = other.collected_;
+        frozen_ = other.frozen_;
+        frozen_cells_ = other.frozen_cells_;
+        frozen_rows_ = other.frozen_rows_;
+        frozen_row_starts_ = other.frozen_row_starts_;
+
+        for (const auto &row : other.rows_)
+        {
+            auto &copy = rows_[row.first];
+            copy.count = row.second.count;
+            copy.blocks.resize(row.second.blocks.size());
+
+            for (std::size_t i = 0; i < row.second.blocks.size(); ++i)
+            {
+                if (row.second.blocks[i])
+                {
+                    copy.blocks[i] = new_block(row.second.blocks[i].get());
+                }
+            }
+        }
+
+        dense_size_ = other.dense_size_;
+
+        return *this;
+    }
+
+    cell_storage engine() const
+    {
+        return engine_;
+    }
+
+    /// <summary>
+    /// Returns the spill the blocks of cell_storage::spilled_rows are allocated from.
+    /// </summary>
+    const std::shared_ptr<cell_spill> &spill() const
+    {
+        return spill_;
+    }
+
+    /// <summary>
+    /// Sets the spill the blocks of cell_storage::spilled_rows are allocated from
+    /// unless the store already has one, which its blocks may still belong to.
+    /// </summary>
+    void spill(std::shared_ptr<cell_spill> spill)
+    {
+        if (!spill_)
+        {
+            spill_ = std::move(spill);
+        }
+    }
+
+    /// <summary>
+    /// Returns the size of the slots a spill for this store has to hand out.
+    /// </summary>
+    static std::size_t block_size()
+    {
+        return sizeof(dense_block);
+    }
+
+    /// <summary>
+    /// Moves every cell into the given engine, thawing the store first if it is frozen.
+    /// This invalidates all pointers to stored cells.
+    /// </summary>
+    void engine(cell_storage new_engine)
+    {
+        thaw();
+
+        if (new_engine == engine_)
+        {
+            return;
+        }
+
+        cell_store converted(new_engine, spill_);
+        for_each([&converted](cell_impl &impl) {
+            converted.emplace(cell_reference(impl.column_, impl.row_), std::move(impl));
+        });
+        converted.collected_ = collected_;
+
+        *this = std::move(converted);
+    }
+
+    /// <summary>
+    /// Moves every cell into one array sorted by row and column with a sorted index of its
+    /// rows, releasing the containers of the engine. Cells are then found by binary search
+    /// and can still be changed, but adding or removing one throws xlnt::unsupported until
+    /// the store is thawed. Bounds are computed here, so no reader modifies a frozen store.
+    /// This invalidates all pointers to stored cells.
+    /// </summary>
+    void freeze()
+    {
+        if (frozen_) return;
+
+        std::vector<cell_impl> cells;
+        cells.reserve(size());
+        for_each([&cells](cell_impl &impl) { cells.push_back(std::move(impl)); });
+
+        if (engine_ == cell_storage::hashed)
+        {
+            std::sort(cells.begin(), cells.end(), [](const cell_impl &a, const cell_impl &b) {
+                return a.row_ < b.row_ || (a.row_ == b.row_ && a.column_ < b.column_);
+            });
+        }
+
+        const auto engine = engine_;
+        const auto collected = collected_;
+        clear();
+        engine_ = engine;
+        collected_ = collected;
+
+        frozen_cells_ = std::move(cells);
+        frozen_cells_.shrink_to_fit();
+
+        for (std::size_t i = 0; i < frozen_cells_.size(); ++i)
+        {
+            const auto &impl = frozen_cells_[i];
+
+            if (frozen_rows_.empty() || frozen_rows_.back() != impl.row_)
+            {
+                frozen_rows_.push_back(impl.row_);
+                frozen_row_starts_.push_back(i);
+            }
+
+            bounds_.extend(cell_reference(impl.column_, impl.row_));
+        }
+
+        frozen_row_starts_.push_back(frozen_cells_.size());
+        frozen_rows_.shrink_to_fit();
+        frozen_row_starts_.shrink_to_fit();
+        frozen_ = true;
+    }
+
+    /// <summary>
+    /// Moves the cells of a frozen store back into its engine.
+    /// This invalidates all pointers to stored cells.
+    /// </summary>
+    void thaw()
+    {
+        if (!frozen_) return;
+
+        auto cells = std::move(frozen_cells_);
+        const auto engine = engine_;
+        const auto collected = collected_;
+        clear();
+        engine_ = engine;
+        reserve(cells.size());
+
+        for (auto &impl : cells)
+        {
+            emplace(cell_reference(impl.column_, impl.row_), std::move(impl));
+        }
+
+        collected_ = collected;
+    }
+
+    bool frozen() const
+    {
+        return frozen_;
+    }
+
+    cell_store(cell_store &&other)
+    {
+        *this = std::move(other);
+    }
+
+    cell_store &operator=(cell_store &&other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        engine_ = other.engine_;
+        // the nodes move along with their pool, and other is left with an empty pool of its own
+        hashed_map().swap(hashed_);
+        hashed_.swap(other.hashed_);
+        occupancy_ = std::move(other.occupancy_);
+        occupancy_ready_ = occupancy_ != nullptr;
+        bounds_ = other.bounds_;
+        bounds_valid_ = other.bounds_valid_.load();
+        collected_ = other.collected_;
+        // the blocks of the old rows go back to the old spill before it's replaced
+        rows_ = std::move(other.rows_);
+        spill_ = other.spill_;
+        dense_size_ = other.dense_size_;
+        row_blocks_ = other.row_blocks_;
+        frozen_ = other.frozen_;
+        frozen_cells_ = std::move(other.frozen_cells_);
+        frozen_rows_ = std::move(other.frozen_rows_);
+        frozen_row_starts_ = std::move(other.frozen_row_starts_);
+        other.frozen_ = false;
+
+        return *this;
+    }
+
+    cell_impl *find(const cell_reference &reference)
+    {
+        if (frozen_)
+        {
+            const auto cells = frozen_row(reference.row());
+            auto match = std::lower_bound(frozen_cells_.begin() + cells.first, frozen_cells_.begin() + cells.second,
+                reference.column_index(), [](const cell_impl &impl, column_t::index_t column) {
+                    return impl.column_.index < column;
+                });
+
+            return match != frozen_cells_.begin() + cells.second && match->column_.index == reference.column_index()
+                ? &*match
+                : nullptr;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            auto match = hashed_.find(reference);
+            return match == hashed_.end() ? nullptr : &match->second;
+        }
+
+        auto row = rows_.find(reference.row());
+        if (row == rows_.end())
+        {
+            return nullptr;
+        }
+
+        const auto column = reference.column_index() - 1;
+        const auto block_index = column / block_width;
+        if (block_index >= row->second.blocks.size() || !row->second.blocks[block_index])
+        {
+            return nullptr;
+        }
+
+        auto &block = *row->second.blocks[block_index];
+        const auto bit = column % block_width;
+
+        return block.occupied & (1u << bit) ? &block.cells[bit] : nullptr;
+    }
+
+    const cell_impl *find(const cell_reference &reference) const
+    {
+        return const_cast<cell_store *>(this)->find(reference);
+    }
+
+    /// <summary>
+    /// Inserts impl at reference unless a cell is already stored there.
+    /// Returns the stored cell and whether the insertion took place.
+    /// </summary>
+    std::pair<cell_impl *, bool> emplace(const cell_reference &reference, cell_impl &&impl)
+    {
+        if (frozen_)
+        {
+            if (auto existing = find(reference))
+            {
+                return {existing, false};
+            }
+
+            throw xlnt::unsupported("adding a cell to a frozen worksheet");
+        }
+
+        collected_ = false;
+
+        if (engine_ == cell_storage::hashed)
+        {
+            auto result = hashed_.emplace(reference, std::move(impl));
+
+            if (result.second)
+            {
+                added(reference);
+            }
+
+            return {&result.first->second, result.second};
+        }
+
+        auto result = dense_emplace(rows_[reference.row()], reference.column_index(), std::move(impl));
+
+        if (result.second)
+        {
+            ++dense_size_;
+            added(reference);
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Stores impl at reference, replacing any cell already stored there.
+    /// </summary>
+    cell_impl *insert_or_assign(const cell_reference &reference, cell_impl &&impl)
+    {
+        auto result = emplace(reference, cell_impl());
+        *result.first = std::move(impl);
+
+        return result.first;
+    }
+
+    /// <summary>
+    /// Removes the cell at reference. Returns true if there was one.
+    /// </summary>
+    bool erase(const cell_reference &reference)
+    {
+        if (frozen_)
+        {
+            if (find(reference) == nullptr) return false;
+
+            throw xlnt::unsupported("removing a cell from a frozen worksheet");
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            if (hashed_.erase(reference) == 0)
+            {
+                return false;
+            }
+
+            removed(reference);
+
+            return true;
+        }
+
+        auto row = rows_.find(reference.row());
+        if (row == rows_.end())
+        {
+            return false;
+        }
+
+        const auto column = reference.column_index() - 1;
+        const auto block_index = column / block_width;
+        if (block_index >= row->second.blocks.size() || !row->second.blocks[block_index])
+        {
+            return false;
+        }
+
+        auto &block = *row->second.blocks[block_index];
+        const auto bit = column % block_width;
+        if (!(block.occupied & (1u << bit)))
+        {
+            return false;
+        }
+
+        block.cells[bit] = cell_impl();
+        block.occupied &= ~(1u << bit);
+        removed(reference);
+        --dense_size_;
+
+        if (--row->second.count == 0)
+        {
+            rows_.erase(row);
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Removes every cell for which predicate returns true.
+    /// </summary>
+    template <typename Predicate>
+    void erase_if(Predicate predicate)
+    {
+        if (frozen_)
+        {
+            if (std::any_of(frozen_cells_.begin(), frozen_cells_.end(), predicate))
+            {
+                throw xlnt::unsupported("removing a cell from a frozen worksheet");
+            }
+
+            return;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            for (auto iter = hashed_.begin(); iter != hashed_.end();)
+            {
+                if (predicate(iter->second))
+                {
+                    bounds_valid_ = bounds_valid_ && !bounds_.on_edge(iter->first);
+                    iter = hashed_.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+
+            occupancy_.reset();
+            occupancy_ready_ = false;
+
+            return;
+        }
+
+        for (auto row = rows_.begin(); row != rows_.end();)
+        {
+            for (auto &block : row->second.blocks)
+            {
+                if (!block) continue;
+
+                for (std::size_t bit = 0; bit < block_width; ++bit)
+                {
+                    if ((block->occupied & (1u << bit)) && predicate(block->cells[bit]))
+                    {
+                        const auto column = static_cast<column_t::index_t>(
+                            static_cast<std::size_t>(&block - row->second.blocks.data()) * block_width + bit + 1);
+                        bounds_valid_ = bounds_valid_ && !bounds_.on_edge(cell_reference(column, row->first));
+                        block->cells[bit] = cell_impl();
+                        block->occupied &= ~(1u << bit);
+                        --row->second.count;
+                        --dense_size_;
+                    }
+                }
+
+                if (block->occupied == 0)
+                {
+                    block.reset();
+                }
+            }
+
+            row = row->second.count == 0 ? rows_.erase(row) : std::next(row);
+        }
+    }
+
+    /// <summary>
+    /// Moves every cell in row first or below it amount rows down, or up if reverse is true,
+    /// in which case the cells in the amount rows above first are removed beforehand.
+    /// The dense engine moves whole rows without moving their cells.
+    /// </summary>
+    void shift_rows(row_t first, row_t amount, bool reverse)
+    {
+        if (frozen_)
+        {
+            throw xlnt::unsupported("moving the cells of a frozen worksheet");
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            shift_hashed(first, amount, reverse, true);
+            return;
+        }
+
+        if (reverse)
+        {
+            const auto removed_end = rows_.lower_bound(first);
+            for (auto row = rows_.lower_bound(first - amount); row != removed_end;)
+            {
+                dense_size_ -= row->second.count;
+                row = rows_.erase(row);
+            }
+        }
+
+        std::vector<std::pair<row_t, dense_row>> moved;
+        const auto moved_begin = rows_.lower_bound(first);
+
+        for (auto row = moved_begin; row != rows_.end(); ++row)
+        {
+            const auto target = reverse ? row->first - amount : row->first + amount;
+            dense_for_each(row->second, [target](cell_impl &impl, column_t::index_t) { impl.row_ = target; });
+            moved.emplace_back(target, std::move(row->second));
+        }
+
+        rows_.erase(moved_begin, rows_.end());
+
+        // every moved row still follows the rows left in place
+        for (auto &row : moved)
+        {
+            rows_.emplace_hint(rows_.end(), row.first, std::move(row.second));
+        }
+
+        bounds_valid_ = false;
+    }
+
+    /// <summary>
+    /// Moves every cell in column first or right of it amount columns right, or left if
+    /// reverse is true, in which case the cells in the amount columns left of first are
+    /// removed beforehand. The dense engine moves cells within their rows.
+    /// </summary>
+    void shift_columns(column_t::index_t first, column_t::index_t amount, bool reverse)
+    {
+        if (frozen_)
+        {
+            throw xlnt::unsupported("moving the cells of a frozen worksheet");
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            shift_hashed(first, amount, reverse, false);
+            return;
+        }
+
+        const auto affected = reverse ? first - amount : first;
+        std::vector<column_t::index_t> columns;
+
+        for (auto row = rows_.begin(); row != rows_.end();)
+        {
+            auto &cells = row->second;
+
+            columns.clear();
+            dense_for_each(cells, [&columns, affected](cell_impl &, column_t::index_t column) {
+                if (column >= affected) columns.push_back(column);
+            });
+
+            if (reverse)
+            {
+                // ascending, so each target was already vacated or removed
+                for (auto column : columns)
+                {
+                    auto impl = dense_take(cells, column);
+                    if (column < first)
+                    {
+                        --dense_size_;
+                        continue;
+                    }
+
+                    impl.column_ = column - amount;
+                    dense_emplace(cells, column - amount, std::move(impl));
+                }
+            }
+            else
+            {
+                // descending, so each target was already vacated
+                for (auto column = columns.rbegin(); column != columns.rend(); ++column)
+                {
+                    auto impl = dense_take(cells, *column);
+                    impl.column_ = *column + amount;
+                    dense_emplace(cells, *column + amount, std::move(impl));
+                }
+            }
+
+            row = cells.count == 0 ? rows_.erase(row) : std::next(row);
+        }
+
+        bounds_valid_ = false;
+    }
+
+    /// <summary>
+    /// Calls function with every stored cell. The dense engine and frozen stores visit
+    /// cells in row-major order; the hashed engine visits them in an unspecified order.
+    /// </summary>
+    template <typename Function>
+    void for_each(Function function)
+    {
+        if (frozen_)
+        {
+            for (auto &impl : frozen_cells_)
+            {
+                function(impl);
+            }
+
+            return;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            for (auto &cell : hashed_)
+            {
+                function(cell.second);
+            }
+
+            return;
+        }
+
+        for (auto &row : rows_)
+        {
+            for (auto &block : row.second.blocks)
+            {
+                if (!block) continue;
+
+                for (std::size_t bit = 0; bit < block_width; ++bit)
+                {
+                    if (block->occupied & (1u << bit))
+                    {
+                        function(block->cells[bit]);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename Function>
+    void for_each(Function function) const
+    {
+        const_cast<cell_store *>(this)->for_each([&function](const cell_impl &impl) { function(impl); });
+    }
+
+    /// <summary>
+    /// A part of the stored cells in rows [first_row, last_row] which can be visited by
+    /// for_each_in independently of, and concurrently with, the other parts returned by
+    /// the same call of parts. The hashed engine divides its buckets between the parts,
+    /// the dense engine and frozen stores their rows.
+    /// </summary>
+    struct part
+    {
+        row_t first_row = 0;
+        row_t last_row = 0;
+        std::size_t first_bucket = 0;
+        std::size_t last_bucket = 0;
+    };
+
+    /// <summary>
+    /// Divides the stored cells in rows [first, last] into up to count parts of about
+    /// the same size.
+    /// </summary>
+    std::vector<part> parts(row_t first, row_t last, std::size_t count) const
+    {
+        std::vector<part> result;
+        if (first > last || count == 0 || empty()) return result;
+
+        if (frozen_)
+        {
+            const auto begin = std::lower_bound(frozen_rows_.begin(), frozen_rows_.end(), first);
+            const auto rows = static_cast<std::size_t>(
+                std::upper_bound(frozen_rows_.begin(), frozen_rows_.end(), last) - begin);
+            count = std::min(count, rows);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                part next;
+                next.first_row = *(begin + static_cast<std::ptrdiff_t>(rows * i / count));
+                next.last_row = *(begin + static_cast<std::ptrdiff_t>(rows * (i + 1) / count - 1));
+                result.push_back(next);
+            }
+
+            return result;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            const auto buckets = hashed_.bucket_count();
+            count = std::min(count, buckets);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                part next;
+                next.first_row = first;
+                next.last_row = last;
+                next.first_bucket = buckets * i / count;
+                next.last_bucket = buckets * (i + 1) / count;
+                result.push_back(next);
+            }
+
+            return result;
+        }
+
+        const auto begin = rows_.lower_bound(first);
+        const auto end = rows_.upper_bound(last);
+        const auto rows = static_cast<std::size_t>(std::distance(begin, end));
+        count = std::min(count, rows);
+
+        auto row = begin;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            part next;
+            next.first_row = row->first;
+            std::advance(row, static_cast<std::ptrdiff_t>(rows * (i + 1) / count - rows * i / count) - 1);
+            next.last_row = row->first;
+            ++row;
+            result.push_back(next);
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Calls function with every stored cell of the given part of this store.
+    /// </summary>
+    template <typename Function>
+    void for_each_in(const part &cells, Function function) const
+    {
+        if (frozen_)
+        {
+            const auto begin = std::lower_bound(frozen_rows_.begin(), frozen_rows_.end(), cells.first_row);
+            const auto end = std::upper_bound(frozen_rows_.begin(), frozen_rows_.end(), cells.last_row);
+            const auto first_cell = frozen_row_starts_[static_cast<std::size_t>(begin - frozen_rows_.begin())];
+            const auto last_cell = frozen_row_starts_[static_cast<std::size_t>(end - frozen_rows_.begin())];
+
+            for (auto i = first_cell; i < last_cell; ++i)
+            {
+                function(frozen_cells_[i]);
+            }
+
+            return;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            for (auto bucket = cells.first_bucket; bucket < cells.last_bucket; ++bucket)
+            {
+                for (auto cell = hashed_.begin(bucket); cell != hashed_.end(bucket); ++cell)
+                {
+                    if (cell->first.row() >= cells.first_row && cell->first.row() <= cells.last_row)
+                    {
+                        function(cell->second);
+                    }
+                }
+            }
+
+            return;
+        }
+
+        const auto end = rows_.upper_bound(cells.last_row);
+
+        for (auto row = rows_.lower_bound(cells.first_row); row != end; ++row)
+        {
+            for (const auto &block : row->second.blocks)
+            {
+                if (!block) continue;
+
+                for (std::size_t bit = 0; bit < block_width; ++bit)
+                {
+                    if (block->occupied & (1u << bit))
+                    {
+                        function(static_cast<const cell_impl &>(block->cells[bit]));
+                    }
+                }
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return frozen_ ? frozen_cells_.size() : engine_ == cell_storage::hashed ? hashed_.size() : dense_size_;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// <summary>
+    /// Returns the approximate number of bytes allocated by the containers of this
+    /// store, not counting what the cells themselves allocate.
+    /// </summary>
+    std::size_t memory_usage() const
+    {
+        std::size_t usage = hashed_.bucket_count() * sizeof(void *) + hashed_.get_allocator().capacity() + heap_size(rows_)
+            + heap_size(frozen_cells_) + heap_size(frozen_rows_) + heap_size(frozen_row_starts_);
+
+        for (const auto &row : rows_)
+        {
+            usage += heap_size(row.second.blocks);
+
+            for (const auto &block : row.second.blocks)
+            {
+                usage += block ? sizeof(dense_block) : 0;
+            }
+        }
+
+        if (occupancy_ready_.load(std::memory_order_acquire))
+        {
+            usage += sizeof(hashed_occupancy) + heap_size(occupancy_->columns_by_row)
+                + heap_size(occupancy_->rows_by_column);
+
+            for (const auto &line : occupancy_->columns_by_row)
+            {
+                usage += heap_size(line.second);
+            }
+
+            for (const auto &line : occupancy_->rows_by_column)
+            {
+                usage += heap_size(line.second);
+            }
+        }
+
+        return usage;
+    }
+
+    void clear()
+    {
+        // releases the chunks of the pool rather than keeping them for reuse
+        hashed_map().swap(hashed_);
+        occupancy_.reset();
+        occupancy_ready_ = false;
+        bounds_ = cell_bounds();
+        bounds_valid_ = true;
+        collected_ = false;
+        rows_.clear();
+        dense_size_ = 0;
+        row_blocks_ = 0;
+        frozen_ = false;
+        std::vector<cell_impl>().swap(frozen_cells_);
+        std::vector<row_t>().swap(frozen_rows_);
+        std::vector<std::size_t>().swap(frozen_row_starts_);
+    }
+
+    /// <summary>
+    /// Prepares the store for about count cells in rows of up to width columns. The hashed
+    /// engine is sized so that count cells don't rehash it, the dense engine allocates the
+    /// block table of every new row for width columns at once.
+    /// </summary>
+    void reserve(std::size_t count, std::size_t width = 0)
+    {
+        if (frozen_) return;
+
+        if (engine_ == cell_storage::hashed)
+        {
+            if (count > hashed_.size())
+            {
+                hashed_.reserve(count);
+            }
+
+            return;
+        }
+
+        row_blocks_ = (width + block_width - 1) / block_width;
+    }
+
+    /// <summary>
+    /// Releases capacity the store doesn't need for the cells it holds: the hashed engine
+    /// is rehashed to as few buckets as its cells need, the dense engines free the blocks
+    /// left empty by removed cells and trim the block table of each row to its last block.
+    /// Cells stay where they are, so pointers to them stay valid.
+    /// </summary>
+    void shrink_to_fit()
+    {
+        if (frozen_) return;
+
+        hashed_.rehash(0);
+
+        if (occupancy_ready_.load(std::memory_order_acquire))
+        {
+            for (auto &line : occupancy_->columns_by_row)
+            {
+                line.second.shrink_to_fit();
+            }
+
+            for (auto &line : occupancy_->rows_by_column)
+            {
+                line.second.shrink_to_fit();
+            }
+        }
+
+        for (auto &row : rows_)
+        {
+            auto &blocks = row.second.blocks;
+
+            for (auto &block : blocks)
+            {
+                if (block && block->occupied == 0)
+                {
+                    block.reset();
+                }
+            }
+
+            while (!blocks.empty() && !blocks.back())
+            {
+                blocks.pop_back();
+            }
+
+            blocks.shrink_to_fit();
+        }
+    }
+
+    /// <summary>
+    /// Returns true if no stored cell was garbage collectible when worksheet::garbage_collect
+    /// last ran and none has been added or made collectible since, so that writers don't
+    /// need to check each cell again. Cells report possible changes with collected(false).
+    /// </summary>
+    bool collected() const
+    {
+        return collected_;
+    }
+
+    void collected(bool collected)
+    {
+        collected_ = collected;
+    }
+
+    /// <summary>
+    /// Returns the bounds of the stored cells. They are extended as cells are added;
+    /// removing a cell on their edge only marks them stale to be recomputed here on
+    /// the next call, which is safe from concurrent readers.
+    /// </summary>
+    const cell_bounds &bounds() const
+    {
+        if (!bounds_valid_.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(lazy_mutex_.mutex);
+
+            if (!bounds_valid_.load(std::memory_order_relaxed))
+            {
+                bounds_ = cell_bounds();
+                for_each([this](const cell_impl &impl) {
+                    bounds_.extend(cell_reference(impl.column_, impl.row_));
+                });
+                bounds_valid_.store(true, std::memory_order_release);
+            }
+        }
+
+        return bounds_;
+    }
+
+    /// <summary>
+    /// Returns the column of the first cell stored in row with a column in [first, last],
+    /// or 0 if there is none. This finds the next cell of a sparse row without probing
+    /// every column in between.
+    /// </summary>
+    column_t::index_t first_in_row(row_t row, column_t::index_t first, column_t::index_t last) const
+    {
+        if (first > last) return 0;
+
+        if (frozen_)
+        {
+            const auto cells = frozen_row(row);
+            auto match = std::lower_bound(frozen_cells_.begin() + cells.first, frozen_cells_.begin() + cells.second,
+                first, [](const cell_impl &impl, column_t::index_t column) { return impl.column_.index < column; });
+
+            return match != frozen_cells_.begin() + cells.second && match->column_.index <= last
+                ? match->column_.index
+                : 0;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            return occupancy().first_of(occupancy().columns_by_row, row, first, last);
+        }
+
+        auto match = rows_.find(row);
+        if (match == rows_.end()) return 0;
+
+        const auto &blocks = match->second.blocks;
+
+        for (auto column = first - 1; column < last && column / block_width < blocks.size();)
+        {
+            const auto &block = blocks[column / block_width];
+            const auto bit = column % block_width;
+
+            if (block)
+            {
+                const auto occupied = block->occupied >> bit;
+
+                if (occupied != 0)
+                {
+                    const auto found = column + lowest_bit(occupied) + 1;
+                    return found <= last ? static_cast<column_t::index_t>(found) : 0;
+                }
+            }
+
+            column += static_cast<column_t::index_t>(block_width - bit);
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Returns the column of the last cell stored in row with a column in [first, last],
+    /// or 0 if there is none.
+    /// </summary>
+    column_t::index_t last_in_row(row_t row, column_t::index_t first, column_t::index_t last) const
+    {
+        if (first > last) return 0;
+
+        if (frozen_)
+        {
+            const auto cells = frozen_row(row);
+            auto match = std::upper_bound(frozen_cells_.begin() + cells.first, frozen_cells_.begin() + cells.second,
+                last, [](column_t::index_t column, const cell_impl &impl) { return column < impl.column_.index; });
+            if (match == frozen_cells_.begin() + cells.first) return 0;
+
+            --match;
+            return match->column_.index >= first ? match->column_.index : 0;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            return occupancy().last_of(occupancy().columns_by_row, row, first, last);
+        }
+
+        auto match = rows_.find(row);
+        if (match == rows_.end()) return 0;
+
+        const auto &blocks = match->second.blocks;
+
+        for (auto column = last; column >= first;)
+        {
+            const auto block_index = (column - 1) / block_width;
+            const auto bit = (column - 1) % block_width;
+
+            if (block_index < blocks.size() && blocks[block_index])
+            {
+                const auto occupied = blocks[block_index]->occupied & ((2u << bit) - 1);
+
+                if (occupied != 0)
+                {
+                    const auto found = block_index * block_width + highest_bit(occupied) + 1;
+                    return found >= first ? static_cast<column_t::index_t>(found) : 0;
+                }
+            }
+
+            if (column <= bit + 1) break;
+            column -= static_cast<column_t::index_t>(bit + 1);
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Returns the row of the first cell stored in column with a row in [first, last],
+    /// or 0 if there is none.
+    /// </summary>
+    row_t first_in_column(column_t::index_t column, row_t first, row_t last) const
+    {
+        if (first > last) return 0;
+
+        if (frozen_)
+        {
+            for (auto row = std::lower_bound(frozen_rows_.begin(), frozen_rows_.end(), first);
+                 row != frozen_rows_.end() && *row <= last; ++row)
+            {
+                if (first_in_row(*row, column, column) != 0)
+                {
+                    return *row;
+                }
+            }
+
+            return 0;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            return occupancy().first_of(occupancy().rows_by_column, column, first, last);
+        }
+
+        for (auto row = rows_.lower_bound(first); row != rows_.end() && row->first <= last; ++row)
+        {
+            if (dense_has(row->second, column))
+            {
+                return row->first;
+            }
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Returns the row of the last cell stored in column with a row in [first, last],
+    /// or 0 if there is none.
+    /// </summary>
+    row_t last_in_column(column_t::index_t column, row_t first, row_t last) const
+    {
+        if (first > last) return 0;
+
+        if (frozen_)
+        {
+            for (auto row = std::vector<row_t>::const_reverse_iterator(
+                     std::upper_bound(frozen_rows_.begin(), frozen_rows_.end(), last));
+                 row != frozen_rows_.rend() && *row >= first; ++row)
+            {
+                if (first_in_row(*row, column, column) != 0)
+                {
+                    return *row;
+                }
+            }
+
+            return 0;
+        }
+
+        if (engine_ == cell_storage::hashed)
+        {
+            return occupancy().last_of(occupancy().rows_by_column, column, first, last);
+        }
+
+        for (auto row = std::map<row_t, dense_row>::const_reverse_iterator(rows_.upper_bound(last));
+             row != rows_.rend() && row->first >= first; ++row)
+        {
+            if (dense_has(row->second, column))
+            {
+                return row->first;
+            }
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Returns the first row in [first, last] with a stored cell, or 0 if there is none.
+    /// </summary>
+    row_t first_row(row_t first, row_t last) const
+    {
+        if (frozen_)
+        {
+            auto row = std::lower_bound(frozen_rows_.begin(), frozen_rows_.end(), first);
+            return row != frozen_rows_.end() && *row <= last ? *row : 0;
+        }
+
+        return engine_ == cell_storage::hashed
+            ? first_key(occupancy().columns_by_row, first, last)
+            : first_key(rows_, first, last);
+    }
+
+    /// <summary>
+    /// Returns the last row in [first, last] with a stored cell, or 0 if there is none.
+    /// </summary>
+    row_t last_row(row_t first, row_t last) const
+    {
+        if (frozen_)
+        {
+            auto row = std::upper_bound(frozen_rows_.begin(), frozen_rows_.end(), last);
+            if (row == frozen_rows_.begin()) return 0;
+
+            --row;
+            return *row >= first ? *row : 0;
+        }
+
+        return engine_ == cell_storage::hashed
+            ? last_key(occupancy().columns_by_row, first, last)
+            : last_key(rows_, first, last);
+    }
+
+    /// <summary>
+    /// Returns the first column in [first, last] with a stored cell, or 0 if there is none.
+    /// The dense engine and frozen stores have to check each of their rows for this.
+    /// </summary>
+    column_t::index_t first_column(column_t::index_t first, column_t::index_t last) const
+    {
+        if (engine_ == cell_storage::hashed && !frozen_)
+        {
+            return first_key(occupancy().rows_by_column, first, last);
+        }
+
+        column_t::index_t found = 0;
+
+        for_each_row([&](row_t row) {
+            const auto column = first_in_row(row, first, found != 0 ? found - 1 : last);
+            found = column != 0 ? column : found;
+            return found != first;
+        });
+
+        return found;
+    }
+
+    /// <summary>
+    /// Returns the last column in [first, last] with a stored cell, or 0 if there is none.
+    /// The dense engine and frozen stores have to check each of their rows for this.
+    /// </summary>
+    column_t::index_t last_column(column_t::index_t first, column_t::index_t last) const
+    {
+        if (engine_ == cell_storage::hashed && !frozen_)
+        {
+            return last_key(occupancy().rows_by_column, first, last);
+        }
+
+        column_t::index_t found = 0;
+
+        for_each_row([&](row_t row) {
+            const auto column = last_in_row(row, found != 0 ? found + 1 : first, last);
+            found = column != 0 ? column : found;
+            return found != last;
+        });
+
+        return found;
+    }
+
+    bool operator==(const cell_store &rhs) const
+    {
+        if (size() != rhs.size())
+        {
+            return false;
+        }
+
+        bool equal = true;
+        for_each([&rhs, &equal](const cell_impl &impl) {
+            if (!equal) return;
+            auto other = rhs.find(cell_reference(impl.column_, impl.row_));
+            equal = other != nullptr && *other == impl;
+        });
+
+        return equal;
+    }
+
+    bool operator!=(const cell_store &rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+private:
+    /// <summary>
+    /// The number of adjacent columns which share one allocation in the dense engine.
+    /// </summary>
+    static const std::size_t block_width = 16;
+
+    struct dense_block
+    {
+        std::array<cell_impl, block_width> cells;
+        std::uint32_t occupied = 0;
+    };
+
+    /// <summary>
+    /// Destroys a block and gives its memory back to the spill it came from, if any.
+    /// </summary>
+    struct block_deleter
+    {
+        cell_spill *spill = nullptr;
+
+        void operator()(dense_block *block) const
+        {
+            if (spill == nullptr)
+            {
+                delete block;
+                return;
+            }
+
+            block->~dense_block();
+            spill->deallocate(block);
+        }
+    };
+
+    using block_ptr = std::unique_ptr<dense_block, block_deleter>;
+
+    struct dense_row
+    {
+        std::vector<block_ptr> blocks;
+        std::size_t count = 0;
+    };
+
+    /// <summary>
+    /// The sorted columns of the cells in each row and rows of the cells in each column
+    /// of the hashed engine, which has no order of its own. It is only built once cells
+    /// are searched for and then kept up to date as cells are added and removed.
+    /// </summary>
+    struct hashed_occupancy
+    {
+        std::map<row_t, std::vector<column_t::index_t>> columns_by_row;
+        std::map<column_t::index_t, std::vector<row_t>> rows_by_column;
+
+        template <typename Key, typename Value>
+        static void add(std::map<Key, std::vector<Value>> &lines, Key key, Value value)
+        {
+            auto &line = lines[key];
+            line.insert(std::lower_bound(line.begin(), line.end(), value), value);
+        }
+
+        template <typename Key, typename Value>
+        static void remove(std::map<Key, std::vector<Value>> &lines, Key key, Value value)
+        {
+            auto line = lines.find(key);
+            if (line == lines.end()) return;
+
+            auto position = std::lower_bound(line->second.begin(), line->second.end(), value);
+            if (position != line->second.end() && *position == value)
+            {
+                line->second.erase(position);
+            }
+
+            if (line->second.empty())
+            {
+                lines.erase(line);
+            }
+        }
+
+        template <typename Key, typename Value>
+        static Value first_of(const std::map<Key, std::vector<Value>> &lines, Key key, Value first, Value last)
+        {
+            auto line = lines.find(key);
+            if (line == lines.end()) return 0;
+
+            auto position = std::lower_bound(line->second.begin(), line->second.end(), first);
+            return position != line->second.end() && *position <= last ? *position : 0;
+        }
+
+        template <typename Key, typename Value>
+        static Value last_of(const std::map<Key, std::vector<Value>> &lines, Key key, Value first, Value last)
+        {
+            auto line = lines.find(key);
+            if (line == lines.end()) return 0;
+
+            auto position = std::upper_bound(line->second.begin(), line->second.end(), last);
+            if (position == line->second.begin()) return 0;
+
+            --position;
+            return *position >= first ? *position : 0;
+        }
+
+        void add(const cell_reference &reference)
+        {
+            add(columns_by_row, reference.row(), reference.column_index());
+            add(rows_by_column, reference.column_index(), reference.row());
+        }
+
+        void remove(const cell_reference &reference)
+        {
+            remove(columns_by_row, reference.row(), reference.column_index());
+            remove(rows_by_column, reference.column_index(), reference.row());
+        }
+    };
+
+    /// <summary>
+    /// Allocates an empty block, or a copy of source, from the spill if the engine is
+    /// cell_storage::spilled_rows and from the heap otherwise.
+    /// </summary>
+    block_ptr new_block(const dense_block *source = nullptr) const
+    {
+        if (engine_ != cell_storage::spilled_rows || !spill_)
+        {
+            return block_ptr(source != nullptr ? new dense_block(*source) : new dense_block());
+        }
+
+        auto slot = spill_->allocate();
+
+        try
+        {
+            auto block = source != nullptr ? new (slot) dense_block(*source) : new (slot) dense_block();
+            return block_ptr(block, block_deleter{spill_.get()});
+        }
+        catch (...)
+        {
+            spill_->deallocate(slot);
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Stores impl at column of row unless a cell is already stored there, leaving the
+    /// cell count and bounds of the store to the caller.
+    /// </summary>
+    std::pair<cell_impl *, bool> dense_emplace(dense_row &row, column_t::index_t column, cell_impl &&impl)
+    {
+        const auto block_index = (column - 1) / block_width;
+
+        if (block_index >= row.blocks.size())
+        {
+            row.blocks.resize(std::max(block_index + 1, row_blocks_));
+        }
+
+        if (!row.blocks[block_index])
+        {
+            row.blocks[block_index] = new_block();
+        }
+
+        auto &block = *row.blocks[block_index];
+        const auto bit = (column - 1) % block_width;
+
+        if (block.occupied & (1u << bit))
+        {
+            return {&block.cells[bit], false};
+        }
+
+        block.cells[bit] = std::move(impl);
+        block.occupied |= 1u << bit;
+        ++row.count;
+
+        return {&block.cells[bit], true};
+    }
+
+    /// <summary>
+    /// Removes and returns the cell stored at column of row, which must exist.
+    /// </summary>
+    static cell_impl dense_take(dense_row &row, column_t::index_t column)
+    {
+        auto &block = *row.blocks[(column - 1) / block_width];
+        const auto bit = (column - 1) % block_width;
+
+        auto impl = std::move(block.cells[bit]);
+        block.cells[bit] = cell_impl();
+        block.occupied &= ~(1u << bit);
+        --row.count;
+
+        return impl;
+    }
+
+    template <typename Function>
+    static void dense_for_each(dense_row &row, Function function)
+    {
+        for (std::size_t block_index = 0; block_index < row.blocks.size(); ++block_index)
+        {
+            const auto &block = row.blocks[block_index];
+            if (!block) continue;
+
+            for (std::size_t bit = 0; bit < block_width; ++bit)
+            {
+                if (block->occupied & (1u << bit))
+                {
+                    function(block->cells[bit], static_cast<column_t::index_t>(block_index * block_width + bit + 1));
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Implements shift_rows, or shift_columns if rows is false, for the hashed engine,
+    /// which has to rehash every moved cell.
+    /// </summary>
+    void shift_hashed(std::uint32_t first, std::uint32_t amount, bool reverse, bool rows)
+    {
+        std::vector<cell_impl> moved;
+
+        for (auto iter = hashed_.begin(); iter != hashed_.end();)
+        {
+            const auto index = rows ? iter->first.row() : iter->first.column_index();
+
+            if (index >= first)
+            {
+                moved.push_back(std::move(iter->second));
+                auto &impl = moved.back();
+                const auto target = reverse ? index - amount : index + amount;
+
+                if (rows)
+                {
+                    impl.row_ = target;
+                }
+                else
+                {
+                    impl.column_ = target;
+                }
+
+                iter = hashed_.erase(iter);
+            }
+            else if (reverse && index >= first - amount)
+            {
+                iter = hashed_.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+
+        for (auto &impl : moved)
+        {
+            hashed_.emplace(cell_reference(impl.column_, impl.row_), std::move(impl));
+        }
+
+        occupancy_.reset();
+        occupancy_ready_ = false;
+        bounds_valid_ = false;
+    }
+
+    void added(const cell_reference &reference)
+    {
+        if (occupancy_)
+        {
+            occupancy_->add(reference);
+        }
+
+        if (bounds_valid_)
+        {
+            bounds_.extend(reference);
+        }
+    }
+
+    void removed(const cell_reference &reference)
+    {
+        if (occupancy_)
+        {
+            occupancy_->remove(reference);
+        }
+
+        bounds_valid_ = bounds_valid_ && !bounds_.on_edge(reference);
+    }
+
+    const hashed_occupancy &occupancy() const
+    {
+        if (!occupancy_ready_.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(lazy_mutex_.mutex);
+
+            if (!occupancy_ready_.load(std::memory_order_relaxed))
+            {
+                occupancy_.reset(new hashed_occupancy());
+
+                for (const auto &cell : hashed_)
+                {
+                    occupancy_->columns_by_row[cell.first.row()].push_back(cell.first.column_index());
+                    occupancy_->rows_by_column[cell.first.column_index()].push_back(cell.first.row());
+                }
+
+                for (auto &line : occupancy_->columns_by_row)
+                {
+                    std::sort(line.second.begin(), line.second.end());
+                }
+
+                for (auto &line : occupancy_->rows_by_column)
+                {
+                    std::sort(line.second.begin(), line.second.end());
+                }
+
+                occupancy_ready_.store(true, std::memory_order_release);
+            }
+        }
+
+        return *occupancy_;
+    }
+
+    template <typename Map, typename Key>
+    static Key first_key(const Map &lines, Key first, Key last)
+    {
+        auto line = lines.lower_bound(first);
+        return line != lines.end() && line->first <= last ? line->first : 0;
+    }
+
+    template <typename Map, typename Key>
+    static Key last_key(const Map &lines, Key first, Key last)
+    {
+        auto line = lines.upper_bound(last);
+        if (line == lines.begin()) return 0;
+
+        --line;
+        return line->first >= first ? line->first : 0;
+    }
+
+    /// <summary>
+    /// Returns the range of frozen_cells_ holding the cells of row, which is empty if there are none.
+    /// </summary>
+    std::pair<std::size_t, std::size_t> frozen_row(row_t row) const
+    {
+        auto match = std::lower_bound(frozen_rows_.begin(), frozen_rows_.end(), row);
+        if (match == frozen_rows_.end() || *match != row) return {0, 0};
+
+        const auto index = static_cast<std::size_t>(match - frozen_rows_.begin());
+        return {frozen_row_starts_[index], frozen_row_starts_[index + 1]};
+    }
+
+    /// <summary>
+    /// Calls function with each row holding a cell of a frozen store or of the dense
+    /// engine in ascending order until it returns false.
+    /// </summary>
+    template <typename Function>
+    void for_each_row(Function function) const
+    {
+        if (frozen_)
+        {
+            for (const auto row : frozen_rows_)
+            {
+                if (!function(row)) return;
+            }
+
+            return;
+        }
+
+        for (const auto &row : rows_)
+        {
+            if (!function(row.first)) return;
+        }
+    }
+
+    static bool dense_has(const dense_row &row, column_t::index_t column)
+    {
+        const auto block_index = (column - 1) / block_width;
+
+        return block_index < row.blocks.size() && row.blocks[block_index]
+            && (row.blocks[block_index]->occupied & (1u << ((column - 1) % block_width)));
+    }
+
+    static std::size_t lowest_bit(std::uint32_t bits)
+    {
+        std::size_t index = 0;
+        while (!(bits & 1u))
+        {
+            bits >>= 1;
+            ++index;
+        }
+
+        return index;
+    }
+
+    static std::size_t highest_bit(std::uint32_t bits)
+    {
+        std::size_t index = 0;
+        while (bits >>= 1)
+        {
+            ++index;
+        }
+
+        return index;
+    }
+
+    /// <summary>
+    /// A mutex which isn't copied along with the store.
+    /// </summary>
+    struct lazy_mutex
+    {
+        lazy_mutex() = default;
+
+        lazy_mutex(const lazy_mutex &)
+        {
+        }
+
+        lazy_mutex &operator=(const lazy_mutex &)
+        {
+            return *this;
+        }
+
+        std::mutex mutex;
+    };
+
+    /// <summary>
+    /// The cells of the hashed engine, whose nodes are allocated from a pool owned by the
+    /// map so that a large worksheet is freed in a few chunks rather than cell by cell.
+    /// </summary>
+    using hashed_map = std::unordered_map<cell_reference, cell_impl, std::hash<cell_reference>,
+        std::equal_to<cell_reference>, pool_allocator<std::pair<const cell_reference, cell_impl>>>;
+
+    cell_storage engine_ = cell_storage::hashed;
+    hashed_map hashed_;
+    // occupancy_ and bounds_ are built on demand by const readers, which may run
+    // concurrently, so they are guarded by lazy_mutex_ and published by the flags
+    mutable std::unique_ptr<hashed_occupancy> occupancy_;
+    mutable std::atomic<bool> occupancy_ready_{false};
+    mutable cell_bounds bounds_;
+    mutable std::atomic<bool> bounds_valid_{true};
+    mutable lazy_mutex lazy_mutex_;
+    bool collected_ = false;
+    // declared before rows_ so that it outlives the blocks allocated from it
+    std::shared_ptr<cell_spill> spill_;
+    std::map<row_t, dense_row> rows_;
+    std::size_t dense_size_ = 0;
+
+    /// <summary>
+    /// The number of blocks a new row of the dense engine starts with, see reserve.
+    /// </summary>
+    std::size_t row_blocks_ = 0;
+
+    /// <summary>
+    /// The cells of a frozen store in row-major order, the rows holding them in ascending
+    /// order and the index of the first cell of each of those rows followed by the cell
+    /// count, see freeze.
+    /// </summary>
+    bool frozen_ = false;
+    std::vector<cell_impl> frozen_cells_;
+    std::vector<row_t> frozen_rows_;
+    std::vector<std::size_t> frozen_row_starts_;
+};
+
+} // namespace detail
+} // namespace xlnt
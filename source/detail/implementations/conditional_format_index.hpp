@@ -0,0 +1,219 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/implementations/conditional_format_impl.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct worksheet_impl;
+
+/// <summary>
+/// The conditional formats of each worksheet indexed by the blocks of rows or columns
+/// their ranges cover, so that the formats applying to a cell are found without
+/// scanning every rule. Ranges spanning more than max_blocks blocks both ways, such as
+/// whole rows and columns, are kept aside and scanned instead. The index isn't copied
+/// with the stylesheet and is rebuilt from its rules when it's next used.
+/// </summary>
+class conditional_format_index
+{
+public:
+    /// <summary>
+    /// The number of rows or columns in a block.
+    /// </summary>
+    static const std::uint32_t block_size = 64;
+
+    /// <summary>
+    /// Ranges covering more blocks than this are indexed the other way or kept aside.
+    /// </summary>
+    static const std::uint32_t max_blocks = 16;
+
+    conditional_format_index() = default;
+
+    conditional_format_index(const conditional_format_index &)
+    {
+    }
+
+    conditional_format_index &operator=(const conditional_format_index &)
+    {
+        invalidate();
+        return *this;
+    }
+
+    /// <summary>
+    /// Forgets every rule, e.g. after the rules were cleared.
+    /// </summary>
+    void invalidate()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sheets_.clear();
+        valid_ = false;
+    }
+
+    /// <summary>
+    /// Adds rule, which was just appended to the rules of the stylesheet.
+    /// </summary>
+    void add(conditional_format_impl &rule)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (valid_)
+        {
+            sheets_[rule.target_sheet].add(rule);
+        }
+    }
+
+    /// <summary>
+    /// Returns the rules of ws whose range contains reference in the order they were
+    /// created, indexing rules first if needed.
+    /// </summary>
+    std::vector<conditional_format_impl *> find(std::list<conditional_format_impl> &rules,
+        const worksheet_impl *ws, const cell_reference &reference)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!valid_)
+        {
+            for (auto &rule : rules)
+            {
+                sheets_[rule.target_sheet].add(rule);
+            }
+
+            valid_ = true;
+        }
+
+        auto sheet = sheets_.find(ws);
+
+        return sheet == sheets_.end() ? std::vector<conditional_format_impl *>() : sheet->second.find(reference);
+    }
+
+private:
+    struct sheet_index
+    {
+        void add(conditional_format_impl &rule)
+        {
+            const auto &range = rule.target_range;
+            const auto first_row = block(range.top_left().row());
+            const auto last_row = block(range.bottom_right().row());
+            const auto first_column = block(range.top_left().column_index());
+            const auto last_column = block(range.bottom_right().column_index());
+            const auto index = rules.size();
+
+            rules.push_back(&rule);
+
+            if (last_row - first_row < max_blocks)
+            {
+                for (auto row = first_row; row <= last_row; ++row)
+                {
+                    by_row[row].push_back(index);
+                }
+            }
+            else if (last_column - first_column < max_blocks)
+            {
+                for (auto column = first_column; column <= last_column; ++column)
+                {
+                    by_column[column].push_back(index);
+                }
+            }
+            else
+            {
+                large.push_back(index);
+            }
+        }
+
+        std::vector<conditional_format_impl *> find(const cell_reference &reference) const
+        {
+            std::vector<std::size_t> matches;
+
+            auto gather = [this, &reference, &matches](const std::vector<std::size_t> &candidates) {
+                for (auto index : candidates)
+                {
+                    if (rules[index]->target_range.contains(reference))
+                    {
+                        matches.push_back(index);
+                    }
+                }
+            };
+
+            auto row = by_row.find(block(reference.row()));
+
+            if (row != by_row.end())
+            {
+                gather(row->second);
+            }
+
+            auto column = by_column.find(block(reference.column_index()));
+
+            if (column != by_column.end())
+            {
+                gather(column->second);
+            }
+
+            gather(large);
+
+            // each rule is in one list only, so sorting restores the order of creation
+            std::sort(matches.begin(), matches.end());
+
+            std::vector<conditional_format_impl *> result;
+            result.reserve(matches.size());
+
+            for (auto index : matches)
+            {
+                result.push_back(rules[index]);
+            }
+
+            return result;
+        }
+
+        static std::uint32_t block(std::uint32_t row_or_column)
+        {
+            return (row_or_column - 1) / block_size;
+        }
+
+        std::vector<conditional_format_impl *> rules;
+        std::unordered_map<std::uint32_t, std::vector<std::size_t>> by_row;
+        std::unordered_map<std::uint32_t, std::vector<std::size_t>> by_column;
+        std::vector<std::size_t> large;
+    };
+
+    std::unordered_map<const worksheet_impl *, sheet_index> sheets_;
+    bool valid_ = false;
+    std::mutex mutex_;
+};
+
+} // namespace detail
+} // namespace xlnt
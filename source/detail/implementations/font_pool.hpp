@@ -0,0 +1,66 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <detail/implementations/record_index.hpp>
+#include <xlnt/styles/font.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Shares one immutable instance of each distinct font between the rich text runs of a
+/// workbook, so that the many runs of shared strings formatted alike don't each hold a copy.
+/// Shared strings may be decoded from several threads, so interning is serialised.
+/// </summary>
+class font_pool
+{
+public:
+    /// <summary>
+    /// Returns the pooled font equal to value, adding value to the pool if there is none.
+    /// </summary>
+    std::shared_ptr<const font> intern(font &&value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &pooled = fonts_[value];
+
+        if (!pooled)
+        {
+            pooled = std::make_shared<const font>(std::move(value));
+        }
+
+        return pooled;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<font, std::shared_ptr<const font>, font_hash> fonts_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include <detail/xlnt_config_impl.hpp>
 
@@ -31,6 +32,11 @@ struct format_impl
 
 	std::size_t id = 0;
 
+    // tells formats apart for as long as the program runs, unlike id, which collecting
+    // garbage changes, or the address, which a later format may reuse. Set when the format
+    // is added to a stylesheet and kept by copies of the stylesheet. Not compared or hashed.
+    std::uint64_t serial = 0;
+
 	optional<std::size_t> alignment_id;
 	optional<std::size_t> border_id;
     optional<std::size_t> fill_id;
@@ -48,6 +54,11 @@ struct format_impl
     bool pivot_button_ = false;
     bool quote_prefix_ = false;
 
+    // whether the number format with number_format_id is a date format, set along with
+    // number_format_id so that cell::is_date doesn't parse the format code. Not compared
+    // or hashed since it follows from number_format_id.
+    bool date_format = false;
+
 	optional<std::string> style;
 
     std::size_t references = 0;
@@ -0,0 +1,311 @@
+// Copyright (c) 2014-2022 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/implementations/format_impl.hpp>
+#include <detail/implementations/record_index.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Hashes the parts of a format_impl compared by its operator==.
+/// </summary>
+struct format_impl_hash
+{
+    std::size_t operator()(const format_impl &value) const
+    {
+        std::size_t seed = 0;
+        hash_combine_optional<std::size_t>(seed, value.alignment_id);
+        hash_combine_optional<std::size_t>(seed, value.border_id);
+        hash_combine_optional<std::size_t>(seed, value.fill_id);
+        hash_combine_optional<std::size_t>(seed, value.font_id);
+        hash_combine_optional<std::size_t>(seed, value.number_format_id);
+        hash_combine_optional<std::size_t>(seed, value.protection_id);
+        hash_combine_optional<bool>(seed, value.alignment_applied);
+        hash_combine_optional<bool>(seed, value.border_applied);
+        hash_combine_optional<bool>(seed, value.fill_applied);
+        hash_combine_optional<bool>(seed, value.font_applied);
+        hash_combine_optional<bool>(seed, value.number_format_applied);
+        hash_combine_optional<bool>(seed, value.protection_applied);
+        hash_combine(seed, value.pivot_button_);
+        hash_combine(seed, value.quote_prefix_);
+        hash_combine_optional<std::string>(seed, value.style);
+
+        return seed;
+    }
+};
+
+/// <summary>
+/// Owns the cell formats of a stylesheet in index order. Formats are kept in a list
+/// so that pointers to them stay valid while others are added or removed, alongside
+/// a table of those pointers which makes looking a format up by index constant time
+/// and a hash table of their contents for finding an equal format.
+/// </summary>
+class format_store
+{
+public:
+    using iterator = std::list<format_impl>::iterator;
+    using const_iterator = std::list<format_impl>::const_iterator;
+
+    format_store() = default;
+
+    format_store(const format_store &other)
+        : formats_(other.formats_)
+    {
+        reindex();
+    }
+
+    format_store &operator=(const format_store &other)
+    {
+        if (this != &other)
+        {
+            formats_ = other.formats_;
+            reindex();
+        }
+
+        return *this;
+    }
+
+    // moving a list keeps its elements where they are, so the index stays valid
+    format_store(format_store &&other) = default;
+    format_store &operator=(format_store &&other) = default;
+
+    /// <summary>
+    /// Appends a copy of value with a new serial and returns a reference to the stored format.
+    /// </summary>
+    format_impl &push_back(const format_impl &value)
+    {
+        static std::atomic<std::uint64_t> next_serial(1);
+
+        formats_.push_back(value);
+        formats_.back().serial = next_serial++;
+        index_.push_back(&formats_.back());
+
+        return formats_.back();
+    }
+
+    /// <summary>
+    /// Removes the last format.
+    /// </summary>
+    void pop_back()
+    {
+        if (index_.size() == contents_indexed_)
+        {
+            unindex(--contents_indexed_);
+            hashes_.pop_back();
+        }
+
+        formats_.pop_back();
+        index_.pop_back();
+    }
+
+    /// <summary>
+    /// Returns the index of the first format equal to pattern, or size() if there is none.
+    /// Formats are indexed by content when they are first searched, so a format which
+    /// is changed in place afterwards must be passed to refresh to be found again.
+    /// </summary>
+    std::size_t find(const format_impl &pattern)
+    {
+        for (; contents_indexed_ < index_.size(); ++contents_indexed_)
+        {
+            const auto hash = format_impl_hash()(*index_[contents_indexed_]);
+            contents_.emplace(hash, contents_indexed_);
+            hashes_.push_back(hash);
+        }
+
+        auto found = index_.size();
+        auto range = contents_.equal_range(format_impl_hash()(pattern));
+
+        for (auto entry = range.first; entry != range.second; ++entry)
+        {
+            if (entry->second < found && *index_[entry->second] == pattern)
+            {
+                found = entry->second;
+            }
+        }
+
+        return found;
+    }
+
+    /// <summary>
+    /// Indexes the current contents of the format at the given index after it has been
+    /// changed in place.
+    /// </summary>
+    void refresh(std::size_t index)
+    {
+        if (index < contents_indexed_)
+        {
+            unindex(index);
+            hashes_[index] = format_impl_hash()(*index_[index]);
+            contents_.emplace(hashes_[index], index);
+        }
+    }
+
+    /// <summary>
+    /// Forgets the contents of every format, for after their record ids have been renumbered.
+    /// </summary>
+    void forget_contents()
+    {
+        contents_.clear();
+        hashes_.clear();
+        contents_indexed_ = 0;
+    }
+
+    /// <summary>
+    /// Returns the format at the given index, which must be less than size().
+    /// </summary>
+    format_impl &operator[](std::size_t index)
+    {
+        return *index_[index];
+    }
+
+    const format_impl &operator[](std::size_t index) const
+    {
+        return *index_[index];
+    }
+
+    /// <summary>
+    /// Removes every format for which predicate returns true and updates the index once.
+    /// </summary>
+    template <typename Predicate>
+    void remove_if(Predicate predicate)
+    {
+        formats_.remove_if(predicate);
+        reindex();
+    }
+
+    void clear()
+    {
+        formats_.clear();
+        index_.clear();
+        forget_contents();
+    }
+
+    void shrink_to_fit()
+    {
+        index_.shrink_to_fit();
+        hashes_.shrink_to_fit();
+        contents_.rehash(0);
+    }
+
+    std::size_t size() const
+    {
+        return index_.size();
+    }
+
+    bool empty() const
+    {
+        return index_.empty();
+    }
+
+    format_impl &back()
+    {
+        return formats_.back();
+    }
+
+    iterator begin()
+    {
+        return formats_.begin();
+    }
+
+    iterator end()
+    {
+        return formats_.end();
+    }
+
+    const_iterator begin() const
+    {
+        return formats_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return formats_.end();
+    }
+
+    bool operator==(const format_store &other) const
+    {
+        return formats_ == other.formats_;
+    }
+
+    bool operator!=(const format_store &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    /// <summary>
+    /// Removes the entry of the format at the given index from contents_.
+    /// </summary>
+    void unindex(std::size_t index)
+    {
+        auto range = contents_.equal_range(hashes_[index]);
+
+        for (auto entry = range.first; entry != range.second; ++entry)
+        {
+            if (entry->second == index)
+            {
+                contents_.erase(entry);
+                break;
+            }
+        }
+    }
+
+    void reindex()
+    {
+        forget_contents();
+        index_.clear();
+        index_.reserve(formats_.size());
+
+        for (auto &format : formats_)
+        {
+            index_.push_back(&format);
+        }
+    }
+
+    std::list<format_impl> formats_;
+    std::vector<format_impl *> index_;
+
+    /// <summary>
+    /// The indices of the first contents_indexed_ formats by the hash of their contents
+    /// when they were indexed, which hashes_ holds for each of them. Formats changed in place
+    /// without being refreshed are skipped when their contents don't match any more.
+    /// </summary>
+    std::unordered_multimap<std::size_t, std::size_t> contents_;
+    std::vector<std::size_t> hashes_;
+    std::size_t contents_indexed_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,197 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The merged ranges of a worksheet in the order they were merged, indexed by their
+/// top-left cell so that the range containing a cell or overlapping another range is
+/// found in logarithmic time. Ranges taller than tall_rows rows, which are rare, and
+/// ranges overlapping others are kept aside and scanned instead.
+/// </summary>
+class merged_cell_index
+{
+public:
+    /// <summary>
+    /// Ranges with at most this many rows are found by looking back from a row.
+    /// </summary>
+    static const row_t tall_rows = 64;
+
+    const std::vector<range_reference> &ranges() const
+    {
+        return ranges_;
+    }
+
+    bool empty() const
+    {
+        return ranges_.empty();
+    }
+
+    void add(const range_reference &reference)
+    {
+        ranges_.push_back(reference);
+        index(reference);
+    }
+
+    /// <summary>
+    /// Removes reference and returns true if it was merged.
+    /// </summary>
+    bool remove(const range_reference &reference)
+    {
+        const auto top_left = reference.top_left();
+        auto row = by_row_.find(top_left.row());
+
+        if (row == by_row_.end() || row->second.erase(top_left.column_index()) == 0)
+        {
+            auto tall = std::find(tall_.begin(), tall_.end(), reference);
+
+            if (tall == tall_.end())
+            {
+                return false;
+            }
+
+            tall_.erase(tall);
+        }
+        else if (row->second.empty())
+        {
+            by_row_.erase(row);
+        }
+
+        ranges_.erase(std::find(ranges_.begin(), ranges_.end(), reference));
+
+        return true;
+    }
+
+    /// <summary>
+    /// Replaces every range, e.g. after they were moved.
+    /// </summary>
+    void assign(std::vector<range_reference> ranges)
+    {
+        ranges_ = std::move(ranges);
+        by_row_.clear();
+        tall_.clear();
+
+        for (const auto &reference : ranges_)
+        {
+            index(reference);
+        }
+    }
+
+    /// <summary>
+    /// Returns the merged range containing reference or nullptr if there is none.
+    /// </summary>
+    const range_reference *find(const cell_reference &reference) const
+    {
+        return find_overlap(range_reference(reference, reference));
+    }
+
+    /// <summary>
+    /// Returns a merged range sharing at least one cell with reference or nullptr if
+    /// there is none.
+    /// </summary>
+    const range_reference *find_overlap(const range_reference &reference) const
+    {
+        const auto top = reference.top_left().row();
+        const auto bottom = reference.bottom_right().row();
+        const auto left = reference.top_left().column_index();
+        const auto right = reference.bottom_right().column_index();
+
+        // ranges indexed under one row don't overlap each other, so they are ordered
+        // by their right as well as their left column
+        auto row = by_row_.lower_bound(top > tall_rows ? top - tall_rows + 1 : 1);
+
+        for (; row != by_row_.end() && row->first <= bottom; ++row)
+        {
+            auto candidate = row->second.upper_bound(left);
+
+            if (candidate != row->second.begin())
+            {
+                --candidate;
+            }
+
+            for (; candidate != row->second.end() && candidate->first <= right; ++candidate)
+            {
+                if (overlap(candidate->second, top, bottom, left, right))
+                {
+                    return &candidate->second;
+                }
+            }
+        }
+
+        for (const auto &tall : tall_)
+        {
+            if (overlap(tall, top, bottom, left, right))
+            {
+                return &tall;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool operator==(const merged_cell_index &rhs) const
+    {
+        return ranges_ == rhs.ranges_;
+    }
+
+private:
+    void index(const range_reference &reference)
+    {
+        // moving cells may make ranges overlap, which would break the order within a row
+        if (reference.height() > tall_rows || find_overlap(reference) != nullptr)
+        {
+            tall_.push_back(reference);
+            return;
+        }
+
+        const auto top_left = reference.top_left();
+        by_row_[top_left.row()].emplace(top_left.column_index(), reference);
+    }
+
+    static bool overlap(const range_reference &range, row_t top, row_t bottom,
+        column_t::index_t left, column_t::index_t right)
+    {
+        return range.top_left().row() <= bottom && range.bottom_right().row() >= top
+            && range.top_left().column_index() <= right && range.bottom_right().column_index() >= left;
+    }
+
+    std::vector<range_reference> ranges_;
+    std::map<row_t, std::map<column_t::index_t, range_reference>> by_row_;
+    std::vector<range_reference> tall_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,231 @@
+// Copyright (c) 2014-2022 Thomas Fussell
+// Copyright (c) 2010-2015 openpyxl
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/border.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/protection.hpp>
+#include <xlnt/utils/hash_combine.hpp>
+#include <xlnt/utils/optional.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Combines whether value is set and, if it is, the value converted to Key into seed.
+/// </summary>
+template <typename Key, typename T>
+void hash_combine_optional(std::size_t &seed, const optional<T> &value)
+{
+    hash_combine(seed, value.is_set());
+
+    if (value.is_set())
+    {
+        hash_combine(seed, static_cast<Key>(value.get()));
+    }
+}
+
+/// <summary>
+/// Hashes of the styling records of a stylesheet. They only cover enough of each
+/// record to agree for records which compare equal, a match is always confirmed
+/// with operator==.
+/// </summary>
+struct alignment_hash
+{
+    std::size_t operator()(const alignment &value) const
+    {
+        std::size_t seed = 0;
+        hash_combine_optional<int>(seed, value.horizontal());
+        hash_combine_optional<int>(seed, value.vertical());
+        hash_combine_optional<int>(seed, value.indent());
+        hash_combine_optional<int>(seed, value.rotation());
+        hash_combine(seed, value.wrap());
+        hash_combine(seed, value.shrink());
+
+        return seed;
+    }
+};
+
+struct border_hash
+{
+    std::size_t operator()(const border &value) const
+    {
+        std::size_t seed = 0;
+
+        for (auto side : border::all_sides())
+        {
+            const auto property = value.side(side);
+            hash_combine(seed, property.is_set());
+
+            if (property.is_set())
+            {
+                hash_combine_optional<int>(seed, property.get().style());
+                hash_combine_optional<color>(seed, property.get().color());
+            }
+        }
+
+        return seed;
+    }
+};
+
+struct fill_hash
+{
+    std::size_t operator()(const fill &value) const
+    {
+        std::size_t seed = 0;
+        hash_combine(seed, static_cast<int>(value.type()));
+
+        if (value.type() == fill_type::pattern)
+        {
+            const auto pattern = value.pattern_fill();
+            hash_combine(seed, static_cast<int>(pattern.type()));
+            hash_combine_optional<color>(seed, pattern.foreground());
+            hash_combine_optional<color>(seed, pattern.background());
+        }
+        else
+        {
+            hash_combine(seed, static_cast<int>(value.gradient_fill().type()));
+        }
+
+        return seed;
+    }
+};
+
+// std::hash<font> also covers the outline, which font::operator== doesn't compare,
+// so equal fonts could miss each other through it
+struct font_hash
+{
+    std::size_t operator()(const font &value) const
+    {
+        std::size_t seed = 0;
+        hash_combine(seed, value.has_name());
+
+        if (value.has_name())
+        {
+            hash_combine(seed, value.name());
+        }
+
+        hash_combine(seed, value.has_size());
+
+        if (value.has_size())
+        {
+            hash_combine(seed, value.size());
+        }
+
+        hash_combine(seed, value.bold());
+        hash_combine(seed, value.italic());
+        hash_combine(seed, value.strikethrough());
+        hash_combine(seed, static_cast<int>(value.underline()));
+        hash_combine(seed, value.has_color());
+
+        return seed;
+    }
+};
+
+struct protection_hash
+{
+    std::size_t operator()(const protection &value) const
+    {
+        std::size_t seed = 0;
+        hash_combine(seed, value.locked());
+        hash_combine(seed, value.hidden());
+
+        return seed;
+    }
+};
+
+/// <summary>
+/// Finds the position of a styling record in a vector of them, like the fonts of a
+/// stylesheet, through a hash table instead of a linear search. Records appended to the
+/// vector directly are indexed on the next lookup. The table must be reset with clear()
+/// whenever records are removed from or reordered in the vector.
+/// </summary>
+template <typename T, typename Hash = std::hash<T>>
+class record_index
+{
+public:
+    /// <summary>
+    /// Returns the position of the first record in values equal to value,
+    /// appending value to values first if there is none.
+    /// </summary>
+    std::size_t find_or_add(std::vector<T> &values, const T &value)
+    {
+        update(values);
+
+        const auto hash = Hash()(value);
+        auto found = values.size();
+        auto range = positions_.equal_range(hash);
+
+        for (auto entry = range.first; entry != range.second; ++entry)
+        {
+            if (entry->second < found && values[entry->second] == value)
+            {
+                found = entry->second;
+            }
+        }
+
+        if (found == values.size())
+        {
+            values.push_back(value);
+            positions_.emplace(hash, found);
+            indexed_ = values.size();
+        }
+
+        return found;
+    }
+
+    void clear()
+    {
+        positions_.clear();
+        indexed_ = 0;
+    }
+
+private:
+    void update(const std::vector<T> &values)
+    {
+        if (values.size() < indexed_)
+        {
+            clear();
+        }
+
+        for (; indexed_ < values.size(); ++indexed_)
+        {
+            positions_.emplace(Hash()(values[indexed_]), indexed_);
+        }
+    }
+
+    std::unordered_multimap<std::size_t, std::size_t> positions_;
+    std::size_t indexed_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,198 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <xlnt/utils/exceptions.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A map keeping its entries sorted by key in a vector, for the properties of rows and
+/// columns. Iteration is in key order and inserting past the last key, which is how
+/// worksheets are read, is amortized constant time. Inserting or erasing elsewhere
+/// moves the later entries and invalidates references to them.
+/// </summary>
+template <typename Key, typename Value>
+class sorted_vector_map
+{
+public:
+    using value_type = std::pair<Key, Value>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    iterator begin()
+    {
+        return entries_.begin();
+    }
+
+    iterator end()
+    {
+        return entries_.end();
+    }
+
+    const_iterator begin() const
+    {
+        return entries_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return entries_.end();
+    }
+
+    bool empty() const
+    {
+        return entries_.empty();
+    }
+
+    std::size_t size() const
+    {
+        return entries_.size();
+    }
+
+    void reserve(std::size_t count)
+    {
+        entries_.reserve(count);
+    }
+
+    void shrink_to_fit()
+    {
+        entries_.shrink_to_fit();
+    }
+
+    void clear()
+    {
+        entries_.clear();
+    }
+
+    /// <summary>
+    /// The entries with the lowest and the highest key. The map mustn't be empty.
+    /// </summary>
+    const value_type &front() const
+    {
+        return entries_.front();
+    }
+
+    const value_type &back() const
+    {
+        return entries_.back();
+    }
+
+    iterator lower_bound(const Key &key)
+    {
+        if (entries_.empty() || entries_.back().first < key)
+        {
+            return entries_.end();
+        }
+
+        return std::lower_bound(entries_.begin(), entries_.end(), key,
+            [](const value_type &entry, const Key &k) { return entry.first < k; });
+    }
+
+    const_iterator lower_bound(const Key &key) const
+    {
+        return const_cast<sorted_vector_map *>(this)->lower_bound(key);
+    }
+
+    iterator find(const Key &key)
+    {
+        auto entry = lower_bound(key);
+        return entry != entries_.end() && entry->first == key ? entry : entries_.end();
+    }
+
+    const_iterator find(const Key &key) const
+    {
+        return const_cast<sorted_vector_map *>(this)->find(key);
+    }
+
+    const Value &at(const Key &key) const
+    {
+        auto entry = find(key);
+
+        if (entry == entries_.end())
+        {
+            throw key_not_found();
+        }
+
+        return entry->second;
+    }
+
+    /// <summary>
+    /// Inserts value under key unless key is present and returns the entry of key
+    /// together with whether the value was inserted.
+    /// </summary>
+    std::pair<iterator, bool> emplace(const Key &key, Value value)
+    {
+        auto entry = lower_bound(key);
+
+        if (entry != entries_.end() && entry->first == key)
+        {
+            return {entry, false};
+        }
+
+        return {entries_.emplace(entry, key, std::move(value)), true};
+    }
+
+    Value &operator[](const Key &key)
+    {
+        return emplace(key, Value()).first->second;
+    }
+
+    std::size_t erase(const Key &key)
+    {
+        auto entry = find(key);
+
+        if (entry == entries_.end())
+        {
+            return 0;
+        }
+
+        entries_.erase(entry);
+        return 1;
+    }
+
+    iterator erase(iterator first, iterator last)
+    {
+        return entries_.erase(first, last);
+    }
+
+    bool operator==(const sorted_vector_map &rhs) const
+    {
+        return entries_ == rhs.entries_;
+    }
+
+private:
+    std::vector<value_type> entries_;
+};
+
+} // namespace detail
+} // namespace xlnt
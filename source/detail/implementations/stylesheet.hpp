@@ -25,13 +25,18 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
 #include <list>
 #include <string>
 #include <vector>
 
 #include <detail/implementations/conditional_format_impl.hpp>
+#include <detail/implementations/conditional_format_index.hpp>
 #include <detail/implementations/format_impl.hpp>
+#include <detail/implementations/format_store.hpp>
+#include <detail/implementations/record_index.hpp>
 #include <detail/implementations/style_impl.hpp>
+#include <detail/number_format/number_formatter.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/conditional_format.hpp>
 #include <xlnt/styles/format.hpp>
@@ -48,8 +53,7 @@ struct stylesheet
 {
     class format create_format(bool default_format)
     {
-		format_impls.push_back(format_impl());
-		auto &impl = format_impls.back();
+		auto &impl = format_impls.push_back(format_impl());
 
 		impl.parent = this;
 		impl.id = format_impls.size() - 1;
@@ -61,10 +65,12 @@ struct stylesheet
 
     class xlnt::format format(std::size_t index)
     {
-        auto iter = format_impls.begin();
-        std::advance(iter, static_cast<std::list<format_impl>::difference_type>(index));
+        if (index >= format_impls.size())
+        {
+            throw invalid_parameter();
+        }
 
-        return xlnt::format(&*iter);
+        return xlnt::format(&format_impls[index]);
     }
 
     class style create_style(const std::string &name)
@@ -159,6 +165,34 @@ struct stylesheet
 		return style_impls.count(name) > 0;
 	}
 
+    /// <summary>
+    /// Returns true if the number format with the given id is a date format. Format codes
+    /// which can't be parsed aren't date formats.
+    /// </summary>
+    bool is_date_format(std::size_t number_format_id) const
+    {
+        try
+        {
+            if (number_format::is_builtin_format(number_format_id))
+            {
+                return number_format::from_builtin_id(number_format_id).is_date_format();
+            }
+
+            for (const auto &nf : number_formats)
+            {
+                if (nf.id() == number_format_id)
+                {
+                    return nf.is_date_format();
+                }
+            }
+        }
+        catch (const xlnt::exception &)
+        {
+        }
+
+        return false;
+    }
+
 	std::size_t next_custom_number_format_id() const
 	{
 		std::size_t id = 164;
@@ -174,241 +208,361 @@ struct stylesheet
 		return id;
 	}
 
-    template<typename T, typename C>
-    std::size_t find_or_add(C &container, const T &item)
+    std::size_t find_or_add(std::vector<alignment> &container, const alignment &item)
     {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wsign-conversion"
-        auto iter = std::find(container.begin(), container.end(), item);
-        if (iter != container.end())
-        {
-            return std::size_t(iter - container.begin());
-        }
-        iter = container.emplace(container.end(), item);
-        return std::size_t(iter - container.begin());
-#pragma GCC diagnostic pop
+        return alignment_index.find_or_add(container, item);
     }
 
-    template<typename T>
-    std::unordered_map<std::size_t, std::size_t> garbage_collect(
-        const std::unordered_map<std::size_t, std::size_t> &reference_counts,
-        std::vector<T> &container)
+    std::size_t find_or_add(std::vector<border> &container, const border &item)
     {
-        std::unordered_map<std::size_t, std::size_t> id_map;
-        std::size_t unreferenced = 0;
-        const auto original_size = container.size();
+        return border_index.find_or_add(container, item);
+    }
 
-        for (std::size_t i = 0; i < original_size; ++i)
+    std::size_t find_or_add(std::vector<fill> &container, const fill &item)
+    {
+        return fill_index.find_or_add(container, item);
+    }
+
+    std::size_t find_or_add(std::vector<font> &container, const font &item)
+    {
+        return font_index.find_or_add(container, item);
+    }
+
+    std::size_t find_or_add(std::vector<protection> &container, const protection &item)
+    {
+        return protection_index.find_or_add(container, item);
+    }
+
+    /// <summary>
+    /// Replaces the record ids of impl, a format or style of source, with the ids of the
+    /// same records in this stylesheet, adding those which are missing.
+    /// </summary>
+    template <typename Impl>
+    void import_records(Impl &impl, const stylesheet &source)
+    {
+        import_record(alignments, source.alignments, impl.alignment_id);
+        import_record(borders, source.borders, impl.border_id);
+        import_record(fills, source.fills, impl.fill_id);
+        import_record(fonts, source.fonts, impl.font_id);
+        import_record(protections, source.protections, impl.protection_id);
+
+        if (impl.number_format_id.is_set() && impl.number_format_id.get() >= 164)
         {
-            id_map[i] = i - unreferenced;
+            const auto id = impl.number_format_id.get();
+            const auto other = std::find_if(source.number_formats.begin(), source.number_formats.end(),
+                [id](const number_format &nf) { return nf.id() == id; });
 
-            if (reference_counts.count(i) == 0 || reference_counts.at(i) == 0)
+            if (other != source.number_formats.end())
             {
-                container.erase(container.begin() + static_cast<typename std::vector<T>::difference_type>(i - unreferenced));
-                unreferenced++;
+                auto iter = std::find(number_formats.begin(), number_formats.end(), *other);
+
+                if (iter == number_formats.end())
+                {
+                    const auto new_id = next_custom_number_format_id();
+                    iter = number_formats.emplace(number_formats.end(), *other);
+                    iter->id(new_id);
+                }
+
+                impl.number_format_id = iter->id();
             }
         }
+    }
 
-        return id_map;
+    template <typename Record>
+    void import_record(std::vector<Record> &container, const std::vector<Record> &source, optional<std::size_t> &id)
+    {
+        if (id.is_set() && id.get() < source.size())
+        {
+            id = find_or_add(container, source[id.get()]);
+        }
     }
 
-    void garbage_collect()
+    /// <summary>
+    /// Bits of dirty_records, one for each kind of record garbage is collected from.
+    /// </summary>
+    enum dirty_record : unsigned
     {
-        if (!garbage_collection_enabled) return;
+        dirty_alignments = 1u << 0,
+        dirty_borders = 1u << 1,
+        dirty_fills = 1u << 2,
+        dirty_fonts = 1u << 3,
+        dirty_protections = 1u << 4
+    };
+
+    /// <summary>
+    /// Marks the kinds of record the given format or style refers to as dirty, as is
+    /// needed when it stops referring to them.
+    /// </summary>
+    template<typename Impl>
+    void mark_records_dirty(const Impl &impl)
+    {
+        if (impl.alignment_id.is_set()) dirty_records |= dirty_alignments;
+        if (impl.border_id.is_set()) dirty_records |= dirty_borders;
+        if (impl.fill_id.is_set()) dirty_records |= dirty_fills;
+        if (impl.font_id.is_set()) dirty_records |= dirty_fonts;
+        if (impl.protection_id.is_set()) dirty_records |= dirty_protections;
+    }
 
-        auto format_iter = format_impls.begin();
-        while (format_iter != format_impls.end())
+    /// <summary>
+    /// Counts one more reference to id. Nothing is counted for kinds of record which
+    /// aren't being collected, whose counts are empty.
+    /// </summary>
+    static void count_reference(const optional<std::size_t> &id, std::vector<std::size_t> &counts)
+    {
+        if (id.is_set() && id.get() < counts.size())
         {
-            auto &impl = *format_iter;
-
-            if (impl.references != 0)
-            {
-                ++format_iter;
-            }
-            else
-            {
-                format_iter = format_impls.erase(format_iter);
-            }
+            ++counts[id.get()];
         }
+    }
 
-        std::size_t new_id = 0;
+    /// <summary>
+    /// Renumbers id with id_map, which is empty if the records kept their ids.
+    /// </summary>
+    static void remap_reference(optional<std::size_t> &id, const std::vector<std::size_t> &id_map)
+    {
+        if (id.is_set() && id.get() < id_map.size())
+        {
+            id = id_map[id.get()];
+        }
+    }
 
-        std::unordered_map<std::size_t, std::size_t> alignment_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> border_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> fill_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> font_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> number_format_reference_counts;
-        std::unordered_map<std::size_t, std::size_t> protection_reference_counts;
+    /// <summary>
+    /// Removes the records of container without references in one pass and returns the
+    /// new id of each old one, or an empty map if every record is still referenced.
+    /// </summary>
+    template<typename T>
+    static std::vector<std::size_t> garbage_collect(
+        const std::vector<std::size_t> &reference_counts,
+        std::vector<T> &container)
+    {
+        if (std::find(reference_counts.begin(), reference_counts.end(), std::size_t(0)) == reference_counts.end())
+        {
+            return {};
+        }
 
-        fill_reference_counts[0]++;
-        fill_reference_counts[1]++;
+        std::vector<std::size_t> id_map(container.size());
+        std::size_t kept = 0;
 
-        for (auto &impl : format_impls)
+        for (std::size_t i = 0; i < container.size(); ++i)
         {
-            impl.id = new_id++;
+            id_map[i] = kept;
 
-            if (impl.alignment_id.is_set())
+            if (reference_counts[i] != 0)
             {
-                alignment_reference_counts[impl.alignment_id.get()]++;
-            }
+                if (kept != i)
+                {
+                    container[kept] = std::move(container[i]);
+                }
 
-            if (impl.border_id.is_set())
-            {
-                border_reference_counts[impl.border_id.get()]++;
+                ++kept;
             }
+        }
 
-            if (impl.fill_id.is_set())
-            {
-                fill_reference_counts[impl.fill_id.get()]++;
-            }
+        container.erase(container.begin() + static_cast<typename std::vector<T>::difference_type>(kept), container.end());
 
-            if (impl.font_id.is_set())
-            {
-                font_reference_counts[impl.font_id.get()]++;
-            }
+        return id_map;
+    }
 
-            if (impl.number_format_id.is_set())
-            {
-                number_format_reference_counts[impl.number_format_id.get()]++;
-            }
+    template<typename Impl>
+    static void count_references(const Impl &impl,
+        std::vector<std::size_t> &alignment_counts,
+        std::vector<std::size_t> &border_counts,
+        std::vector<std::size_t> &fill_counts,
+        std::vector<std::size_t> &font_counts,
+        std::vector<std::size_t> &protection_counts)
+    {
+        count_reference(impl.alignment_id, alignment_counts);
+        count_reference(impl.border_id, border_counts);
+        count_reference(impl.fill_id, fill_counts);
+        count_reference(impl.font_id, font_counts);
+        count_reference(impl.protection_id, protection_counts);
+    }
 
-            if (impl.protection_id.is_set())
-            {
-                protection_reference_counts[impl.protection_id.get()]++;
-            }
-        }
+    template<typename Impl>
+    static void remap_references(Impl &impl,
+        const std::vector<std::size_t> &alignment_id_map,
+        const std::vector<std::size_t> &border_id_map,
+        const std::vector<std::size_t> &fill_id_map,
+        const std::vector<std::size_t> &font_id_map,
+        const std::vector<std::size_t> &protection_id_map)
+    {
+        remap_reference(impl.alignment_id, alignment_id_map);
+        remap_reference(impl.border_id, border_id_map);
+        remap_reference(impl.fill_id, fill_id_map);
+        remap_reference(impl.font_id, font_id_map);
+        remap_reference(impl.protection_id, protection_id_map);
+    }
 
-        for (auto &name_impl_pair : style_impls)
+    /// <summary>
+    /// Removes every format which isn't referenced any more along with the records only
+    /// they used, and renumbers the rest. Only the kinds of record marked dirty since the
+    /// last collection are recounted, so collecting after a few edits to a large
+    /// stylesheet costs one pass over the formats and styles.
+    /// </summary>
+    void garbage_collect()
+    {
+        if (!garbage_collection_enabled) return;
+
+        if (garbage_pending)
         {
-            auto &impl = name_impl_pair.second;
+            format_impls.remove_if([this](const format_impl &impl) {
+                if (impl.references != 0) return false;
+                mark_records_dirty(impl);
+                return true;
+            });
 
-            if (impl.alignment_id.is_set())
-            {
-                alignment_reference_counts[impl.alignment_id.get()]++;
-            }
+            std::size_t new_id = 0;
 
-            if (impl.border_id.is_set())
+            for (auto &impl : format_impls)
             {
-                border_reference_counts[impl.border_id.get()]++;
+                impl.id = new_id++;
             }
 
-            if (impl.fill_id.is_set())
-            {
-                fill_reference_counts[impl.fill_id.get()]++;
-            }
+            format_impls.forget_contents();
+            garbage_pending = false;
+        }
 
-            if (impl.font_id.is_set())
-            {
-                font_reference_counts[impl.font_id.get()]++;
-            }
+        const auto dirty = dirty_records;
+        dirty_records = 0;
 
-            if (impl.number_format_id.is_set())
-            {
-                number_format_reference_counts[impl.number_format_id.get()]++;
-            }
+        if (dirty == 0) return;
 
-            if (impl.protection_id.is_set())
-            {
-                protection_reference_counts[impl.protection_id.get()]++;
-            }
-        }
+        std::vector<std::size_t> alignment_counts((dirty & dirty_alignments) ? alignments.size() : 0, 0);
+        std::vector<std::size_t> border_counts((dirty & dirty_borders) ? borders.size() : 0, 0);
+        std::vector<std::size_t> fill_counts((dirty & dirty_fills) ? fills.size() : 0, 0);
+        std::vector<std::size_t> font_counts((dirty & dirty_fonts) ? fonts.size() : 0, 0);
+        std::vector<std::size_t> protection_counts((dirty & dirty_protections) ? protections.size() : 0, 0);
 
-        auto alignment_id_map = garbage_collect(alignment_reference_counts, alignments);
-        auto border_id_map = garbage_collect(border_reference_counts, borders);
-        auto fill_id_map = garbage_collect(fill_reference_counts, fills);
-        auto font_id_map = garbage_collect(font_reference_counts, fonts);
-        auto protection_id_map = garbage_collect(protection_reference_counts, protections);
+        // the first two fills are reserved
+        for (std::size_t i = 0; i < 2 && i < fill_counts.size(); ++i)
+        {
+            ++fill_counts[i];
+        }
 
-        for (auto &impl : format_impls)
+        for (const auto &impl : format_impls)
         {
-            if (impl.alignment_id.is_set())
-            {
-                impl.alignment_id = alignment_id_map[impl.alignment_id.get()];
-            }
+            count_references(impl, alignment_counts, border_counts, fill_counts, font_counts, protection_counts);
+        }
 
-            if (impl.border_id.is_set())
-            {
-                impl.border_id = border_id_map[impl.border_id.get()];
-            }
+        for (const auto &name_impl_pair : style_impls)
+        {
+            count_references(name_impl_pair.second, alignment_counts, border_counts, fill_counts, font_counts, protection_counts);
+        }
 
-            if (impl.fill_id.is_set())
-            {
-                impl.fill_id = fill_id_map[impl.fill_id.get()];
-            }
+        const auto alignment_id_map = garbage_collect(alignment_counts, alignments);
+        const auto border_id_map = garbage_collect(border_counts, borders);
+        const auto fill_id_map = garbage_collect(fill_counts, fills);
+        const auto font_id_map = garbage_collect(font_counts, fonts);
+        const auto protection_id_map = garbage_collect(protection_counts, protections);
 
-            if (impl.font_id.is_set())
-            {
-                impl.font_id = font_id_map[impl.font_id.get()];
-            }
+        if (alignment_id_map.empty() && border_id_map.empty() && fill_id_map.empty()
+            && font_id_map.empty() && protection_id_map.empty())
+        {
+            return;
+        }
 
-            if (impl.protection_id.is_set())
-            {
-                impl.protection_id = protection_id_map[impl.protection_id.get()];
-            }
+        for (auto &impl : format_impls)
+        {
+            remap_references(impl, alignment_id_map, border_id_map, fill_id_map, font_id_map, protection_id_map);
         }
 
-        for (auto &name_impl : style_impls)
+        for (auto &name_impl_pair : style_impls)
         {
-            auto &impl = name_impl.second;
+            remap_references(name_impl_pair.second, alignment_id_map, border_id_map, fill_id_map, font_id_map, protection_id_map);
+        }
 
-            if (impl.alignment_id.is_set())
-            {
-                impl.alignment_id = alignment_id_map[impl.alignment_id.get()];
-            }
+        format_impls.forget_contents();
+        if (!alignment_id_map.empty()) alignment_index.clear();
+        if (!border_id_map.empty()) border_index.clear();
+        if (!fill_id_map.empty()) fill_index.clear();
+        if (!font_id_map.empty()) font_index.clear();
+        if (!protection_id_map.empty()) protection_index.clear();
+    }
 
-            if (impl.border_id.is_set())
-            {
-                impl.border_id = border_id_map[impl.border_id.get()];
-            }
+    /// <summary>
+    /// Collects garbage if formats or records may have become unreferenced since the
+    /// last collection.
+    /// </summary>
+    void collect_pending_garbage()
+    {
+        if (garbage_pending || dirty_records != 0)
+        {
+            garbage_collect();
+        }
+    }
 
-            if (impl.fill_id.is_set())
-            {
-                impl.fill_id = fill_id_map[impl.fill_id.get()];
-            }
+    /// <summary>
+    /// Called when the format at the given index may have lost its last reference.
+    /// Collecting garbage renumbers every format, so it is deferred until the formats
+    /// are written. An unreferenced last format, as left behind
+    /// when a new format turns out to equal an existing one, is removed straight away
+    /// since that needs no renumbering.
+    /// </summary>
+    void release_format(std::size_t index)
+    {
+        if (!garbage_collection_enabled) return;
 
-            if (impl.font_id.is_set())
-            {
-                impl.font_id = font_id_map[impl.font_id.get()];
-            }
+        garbage_pending = true;
 
-            if (impl.protection_id.is_set())
-            {
-                impl.protection_id = protection_id_map[impl.protection_id.get()];
-            }
+        if (format_impls[index].references == 0 && index + 1 == format_impls.size())
+        {
+            mark_records_dirty(format_impls[index]);
+            format_impls.pop_back();
         }
     }
 
     format_impl *find_or_create(format_impl &pattern)
     {
         pattern.references = 0;
-        std::size_t id = 0;
-        auto iter = format_impls.begin();
-        while (iter != format_impls.end() && !(*iter == pattern))
-        {
-            ++id;
-            ++iter;
-        }
-        if (iter == format_impls.end())
-        {
-            iter = format_impls.emplace(format_impls.end(), pattern);
-        }
-        auto &result = *iter;
+        const auto id = format_impls.find(pattern);
+        auto &result = id == format_impls.size() ? format_impls.push_back(pattern) : format_impls[id];
 
         result.parent = this;
         result.id = id;
         result.references++;
 
-        if (id != pattern.id)
+        if (id != pattern.id && pattern.id < format_impls.size())
         {
-            iter = format_impls.begin();
-            std::advance(iter, static_cast<std::list<format_impl>::difference_type>(pattern.id));
-            iter->references -= iter->references > 0 ? 1 : 0;
-            garbage_collect();
+            auto &previous = format_impls[pattern.id];
+            previous.references -= previous.references > 0 ? 1 : 0;
+            release_format(pattern.id);
         }
 
         return &result;
     }
 
+    /// <summary>
+    /// Returns the format of this stylesheet equal to the format of another stylesheet,
+    /// adding it along with its records, custom number format and named style if needed.
+    /// The returned format has one more reference.
+    /// </summary>
+    format_impl *import_format(const format_impl &other)
+    {
+        const auto &source = *other.parent;
+        format_impl pattern = other;
+        pattern.id = std::numeric_limits<std::size_t>::max();
+        import_records(pattern, source);
+
+        if (pattern.style.is_set() && style_impls.count(pattern.style.get()) == 0)
+        {
+            const auto style = source.style_impls.find(pattern.style.get());
+
+            if (style == source.style_impls.end())
+            {
+                pattern.style.clear();
+            }
+            else
+            {
+                auto &impl = style_impls.emplace(style->first, style->second).first->second;
+                impl.parent = this;
+                import_records(impl, source);
+                style_names.push_back(style->first);
+            }
+        }
+
+        return find_or_create(pattern);
+    }
+
     format_impl *find_or_create_with(format_impl *pattern, const std::string &style_name)
     {
         format_impl new_format = *pattern;
@@ -416,6 +570,7 @@ struct stylesheet
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -424,10 +579,12 @@ struct stylesheet
     {
         format_impl new_format = *pattern;
         new_format.alignment_id = find_or_add(alignments, new_alignment);
+        if (new_format.alignment_id != pattern->alignment_id) dirty_records |= dirty_alignments;
         new_format.alignment_applied = applied;
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -436,10 +593,12 @@ struct stylesheet
     {
         format_impl new_format = *pattern;
         new_format.border_id = find_or_add(borders, new_border);
+        if (new_format.border_id != pattern->border_id) dirty_records |= dirty_borders;
         new_format.border_applied = applied;
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -448,10 +607,12 @@ struct stylesheet
     {
         format_impl new_format = *pattern;
         new_format.fill_id = find_or_add(fills, new_fill);
+        if (new_format.fill_id != pattern->fill_id) dirty_records |= dirty_fills;
         new_format.fill_applied = applied;
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -460,10 +621,12 @@ struct stylesheet
     {
         format_impl new_format = *pattern;
         new_format.font_id = find_or_add(fonts, new_font);
+        if (new_format.font_id != pattern->font_id) dirty_records |= dirty_fonts;
         new_format.font_applied = applied;
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -487,9 +650,11 @@ struct stylesheet
             new_format.number_format_id = iter->id();
         }
         new_format.number_format_applied = applied;
+        new_format.date_format = is_date_format(new_format.number_format_id.get());
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -498,10 +663,12 @@ struct stylesheet
     {
         format_impl new_format = *pattern;
         new_format.protection_id = find_or_add(protections, new_protection);
+        if (new_format.protection_id != pattern->protection_id) dirty_records |= dirty_protections;
         new_format.protection_applied = applied;
         if (pattern->references == 0)
         {
             *pattern = new_format;
+            format_impls.refresh(pattern->id);
         }
         return find_or_create(new_format);
     }
@@ -515,7 +682,10 @@ struct stylesheet
     void clear()
     {
 		conditional_format_impls.clear();
+        conditional_format_ranges.invalidate();
         format_impls.clear();
+        garbage_pending = false;
+        dirty_records = 0;
 
         style_impls.clear();
         style_names.clear();
@@ -525,8 +695,15 @@ struct stylesheet
         fills.clear();
         fonts.clear();
         number_formats.clear();
+        number_formatters.clear();
         protections.clear();
 
+        alignment_index.clear();
+        border_index.clear();
+        fill_index.clear();
+        font_index.clear();
+        protection_index.clear();
+
         colors.clear();
     }
 
@@ -540,10 +717,47 @@ struct stylesheet
 		impl.target_sheet = ws;
 		impl.target_range = ref;
 		impl.differential_format_id = conditional_format_impls.size() - 1;
+		conditional_format_ranges.add(impl);
 
 		return xlnt::conditional_format(&impl);
 	}
 
+    /// <summary>
+    /// Adds a rule for each range and condition in rules, splicing them into
+    /// conditional_format_impls at once.
+    /// </summary>
+    std::vector<conditional_format> add_conditional_format_rules(worksheet_impl *ws,
+        const std::vector<std::pair<range_reference, condition>> &rules)
+    {
+        std::list<conditional_format_impl> added(rules.size());
+        std::vector<conditional_format> result;
+        result.reserve(rules.size());
+        auto id = conditional_format_impls.size();
+        auto rule = rules.begin();
+
+        for (auto &impl : added)
+        {
+            impl.when = rule->second;
+            impl.parent = this;
+            impl.target_sheet = ws;
+            impl.target_range = rule->first;
+            impl.differential_format_id = id++;
+            ++rule;
+
+            result.push_back(xlnt::conditional_format(&impl));
+        }
+
+        // splicing keeps the rules where they are, so the handles stay valid
+        for (auto &impl : added)
+        {
+            conditional_format_ranges.add(impl);
+        }
+
+        conditional_format_impls.splice(conditional_format_impls.end(), added);
+
+        return result;
+    }
+
     std::weak_ptr<workbook_impl> parent;
 
     bool operator==(const stylesheet& rhs) const
@@ -573,8 +787,21 @@ struct stylesheet
     bool garbage_collection_enabled = true;
     bool known_fonts_enabled = false;
 
+    /// <summary>
+    /// True if formats may have become unreferenced since garbage was last collected.
+    /// </summary>
+    bool garbage_pending = false;
+
+    /// <summary>
+    /// The dirty_record bits of the kinds of record which may have lost their last
+    /// reference since garbage was last collected.
+    /// </summary>
+    unsigned dirty_records = 0;
+
 	std::list<conditional_format_impl> conditional_format_impls;
-    std::list<format_impl> format_impls;
+    // the rules above by worksheet and range, see worksheet::conditional_formats
+    detail::conditional_format_index conditional_format_ranges;
+    format_store format_impls;
     std::unordered_map<std::string, style_impl> style_impls;
     std::vector<std::string> style_names;
     optional<std::string> default_slicer_style;
@@ -584,9 +811,20 @@ struct stylesheet
     std::vector<fill> fills;
     std::vector<font> fonts;
     std::vector<number_format> number_formats;
+
+    /// <summary>
+    /// Compiled number formats used by cell::to_string.
+    /// </summary>
+    number_formatter_cache number_formatters;
 	std::vector<protection> protections;
 
     std::vector<color> colors;
+
+    record_index<alignment, alignment_hash> alignment_index;
+    record_index<border, border_hash> border_index;
+    record_index<fill, fill_hash> fill_index;
+    record_index<font, font_hash> font_index;
+    record_index<protection, protection_hash> protection_index;
 };
 
 } // namespace detail
@@ -0,0 +1,51 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+void workbook_impl::map_copied_formats(const workbook_impl &other)
+{
+    copied_formats_.clear();
+
+    const auto waiting = std::any_of(worksheets_.begin(), worksheets_.end(),
+        [](const worksheet_impl &ws) { return ws.copy_source_ != nullptr; });
+
+    if (!waiting || !stylesheet_.is_set() || !other.stylesheet_.is_set())
+    {
+        return;
+    }
+
+    for (auto &format : stylesheet_.get().format_impls)
+    {
+        copied_formats_.emplace(format.serial, &format);
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -23,18 +23,29 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <detail/implementations/calculation_chain_entry.hpp>
+#include <detail/implementations/font_pool.hpp>
 #include <detail/implementations/stylesheet.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
+#include <detail/implementations/worksheet_index.hpp>
+#include <detail/serialization/zstream.hpp>
+#include <detail/utils/node_pool.hpp>
 #include <xlnt/packaging/ext_list.hpp>
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/variant.hpp>
 #include <xlnt/workbook/calculation_properties.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
+#include <xlnt/workbook/string_storage.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/workbook/workbook_view.hpp>
 #include <xlnt/worksheet/range.hpp>
@@ -44,6 +55,8 @@
 namespace xlnt {
 namespace detail {
 
+class formula_engine;
+class shared_string_loader;
 struct worksheet_impl;
 
 struct workbook_impl
@@ -57,41 +70,105 @@ struct workbook_impl
           worksheets_(other.worksheets_),
           shared_strings_ids_(other.shared_strings_ids_),
           shared_strings_values_(other.shared_strings_values_),
+          shared_strings_loader_(other.shared_strings_loader_),
           stylesheet_(other.stylesheet_),
           manifest_(other.manifest_),
+          pending_workbook_parts_(other.pending_workbook_parts_),
           theme_(other.theme_),
+          images_(other.images_),
+          binaries_(other.binaries_),
+          compressed_images_(other.compressed_images_),
+          compressed_binaries_(other.compressed_binaries_),
+          shared_images_(other.shared_images_),
+          drawing_images_(other.drawing_images_),
           core_properties_(other.core_properties_),
           extended_properties_(other.extended_properties_),
           custom_properties_(other.custom_properties_),
           view_(other.view_),
           code_name_(other.code_name_),
-          file_version_(other.file_version_)
+          file_version_(other.file_version_),
+          cell_storage_(other.cell_storage_),
+          cell_memory_budget_(other.cell_memory_budget_),
+          cell_spill_(other.cell_spill_),
+          string_storage_(other.string_storage_),
+          calculation_chain_(other.calculation_chain_)
     {
+        shared_strings_pending_ = other.shared_strings_pending_.load();
+        map_copied_formats(other);
     }
 
     workbook_impl &operator=(const workbook_impl &other)
+    {
+        assign(other, true);
+        return *this;
+    }
+
+    /// <summary>
+    /// Copies other into this workbook. If copy_cells is false, the worksheets wait
+    /// for their cells to be copied until they are first accessed, see
+    /// worksheet_impl::assign.
+    /// </summary>
+    void assign(const workbook_impl &other, bool copy_cells)
     {
         active_sheet_index_ = other.active_sheet_index_;
         worksheets_.clear();
-        std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
+
+        for (const auto &ws : other.worksheets_)
+        {
+            worksheets_.emplace_back(ws, copy_cells);
+        }
+
+        worksheet_index_.invalidate();
+
         shared_strings_ids_ = other.shared_strings_ids_;
         shared_strings_values_ = other.shared_strings_values_;
+        shared_strings_loader_ = other.shared_strings_loader_;
+        shared_strings_pending_ = other.shared_strings_pending_.load();
+        stylesheet_ = other.stylesheet_;
+        map_copied_formats(other);
+        base_date_ = other.base_date_;
+        title_ = other.title_;
         theme_ = other.theme_;
         manifest_ = other.manifest_;
+        pending_workbook_parts_ = other.pending_workbook_parts_;
+        images_ = other.images_;
+        binaries_ = other.binaries_;
+        compressed_images_ = other.compressed_images_;
+        compressed_binaries_ = other.compressed_binaries_;
+        shared_images_ = other.shared_images_;
+        drawing_images_ = other.drawing_images_;
 
         sheet_title_rel_id_map_ = other.sheet_title_rel_id_map_;
         sheet_hidden_ = other.sheet_hidden_;
         view_ = other.view_;
         code_name_ = other.code_name_;
         file_version_ = other.file_version_;
+        cell_storage_ = other.cell_storage_;
+        cell_memory_budget_ = other.cell_memory_budget_;
+        cell_spill_ = other.cell_spill_;
+        string_storage_ = other.string_storage_;
+        calculation_properties_ = other.calculation_properties_;
+        calculation_chain_ = other.calculation_chain_;
+        abs_path_ = other.abs_path_;
+        arch_id_flags_ = other.arch_id_flags_;
+        extensions_ = other.extensions_;
 
         core_properties_ = other.core_properties_;
         extended_properties_ = other.extended_properties_;
         custom_properties_ = other.custom_properties_;
 
-        return *this;
+        // what the engine remembers refers to the worksheets it has seen
+        formula_engine_.reset();
     }
 
+    /// <summary>
+    /// Fills copied_formats_ after the stylesheet of other has been copied into this
+    /// workbook, if any worksheet still waits for its cells to be copied. Since copies keep
+    /// the serials of their formats, this also covers the worksheets other hasn't copied
+    /// from the workbook it was cloned from itself.
+    /// </summary>
+    void map_copied_formats(const workbook_impl &other);
+
     bool operator==(const workbook_impl &other) const
     {
         // not comparing abs_path_
@@ -126,18 +203,52 @@ struct workbook_impl
     optional<std::size_t> active_sheet_index_;
 
     std::list<worksheet_impl> worksheets_;
-    std::unordered_map<rich_text, std::size_t, rich_text_hash> shared_strings_ids_;
+    // must be kept up to date or invalidated when worksheets_ changes
+    worksheet_index worksheet_index_;
+    std::unordered_map<rich_text, std::size_t, rich_text_hash, std::equal_to<rich_text>,
+        pool_allocator<std::pair<const rich_text, std::size_t>>> shared_strings_ids_;
     std::vector<rich_text> shared_strings_values_;
+    // set while the shared strings of a workbook loaded with load_options::lazy_shared_strings
+    // haven't been decoded into shared_strings_values_ yet
+    std::shared_ptr<shared_string_loader> shared_strings_loader_;
+    // set together with shared_strings_loader_ but safe to check from threads which only read
+    std::atomic<bool> shared_strings_pending_{false};
+    // the detached loader, which keeps the strings it returned valid for concurrent readers
+    // until the workbook is modified, see shared_string_loader::load_all
+    std::shared_ptr<shared_string_loader> retired_shared_strings_loader_;
+    // serialises reading lazily loaded worksheets and shared strings, which may recurse
+    std::recursive_mutex lazy_load_mutex_;
+    // the fonts of rich text runs read from the file, not copied with the workbook
+    font_pool run_fonts_;
+    // created by the first workbook::calculate, not copied with the workbook
+    std::shared_ptr<formula_engine> formula_engine_;
 
     optional<stylesheet> stylesheet_;
+    // the formats of stylesheet_ by the serials of the formats they were copied from, which
+    // the copies share, for the worksheets of a copy on access clone which haven't copied their
+    // cells yet, see worksheet_loader::copy_cells. Built when the workbook is copied, so formats
+    // the source creates afterwards aren't found.
+    std::unordered_map<std::uint64_t, format_impl *> copied_formats_;
 
     calendar base_date_;
     optional<std::string> title_;
 
     manifest manifest_;
+    // workbook parts which still have to be added to manifest_, see workbook::register_pending_parts
+    std::vector<relationship_type> pending_workbook_parts_;
     optional<theme> theme_;
     std::unordered_map<std::string, std::vector<std::uint8_t>> images_;
     std::unordered_map<std::string, std::vector<std::uint8_t>> binaries_;
+    // the images and binaries of a workbook loaded with load_options::lazy_binaries which are
+    // still compressed as they were in its archive. A part is either here or in images_ or binaries_.
+    std::unordered_map<std::string, zcompressed> compressed_images_;
+    std::unordered_map<std::string, zcompressed> compressed_binaries_;
+    // images which aren't changed and shared with other workbooks, like the thumbnail of
+    // workbook::empty. An image is either here or in images_ or compressed_images_.
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<std::uint8_t>>> shared_images_;
+    // the paths of the images read for drawings by the CRC-32 and size of their contents, so that
+    // a drawing image with the same contents as one read before can refer to that one instead
+    std::unordered_multimap<std::uint64_t, std::string> drawing_images_;
 
     std::vector<std::pair<xlnt::core_property, variant>> core_properties_;
     std::vector<std::pair<xlnt::extended_property, variant>> extended_properties_;
@@ -175,7 +286,14 @@ struct workbook_impl
     };
 
     optional<file_version_t> file_version_;
+    cell_storage cell_storage_ = cell_storage::hashed;
+    std::size_t cell_memory_budget_ = std::size_t(256) << 20;
+    // created once cell_storage::spilled_rows is used and shared with copies of the workbook
+    std::shared_ptr<cell_spill> cell_spill_;
+    string_storage string_storage_ = string_storage::shared_table;
     optional<calculation_properties> calculation_properties_;
+    // the chain read from the loaded file, not compared since it only speeds up opening it in Excel
+    std::vector<calculation_chain_entry> calculation_chain_;
     optional<std::string> abs_path_;
     optional<std::size_t> arch_id_flags_;
     optional<ext_list> extensions_;
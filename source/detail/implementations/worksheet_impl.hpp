@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -42,6 +45,9 @@
 #include <xlnt/worksheet/print_options.hpp>
 #include <xlnt/worksheet/sheet_pr.hpp>
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/cell_store.hpp>
+#include <detail/implementations/merged_cell_index.hpp>
+#include <detail/implementations/sorted_vector_map.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 
 namespace xlnt {
@@ -50,12 +56,46 @@ class workbook;
 
 namespace detail {
 
+class worksheet_loader;
+struct workbook_impl;
+
+/// <summary>
+/// Returns the spill shared by the cells of the worksheets of wb if it uses
+/// cell_storage::spilled_rows, or null.
+/// </summary>
+XLNT_API_INTERNAL std::shared_ptr<cell_spill> cell_spill_of(const workbook_impl &wb);
+
+/// <summary>
+/// Orders cell references by row, then by column.
+/// </summary>
+struct row_major_order
+{
+    bool operator()(const cell_reference &lhs, const cell_reference &rhs) const
+    {
+        return lhs.row() < rhs.row() || (lhs.row() == rhs.row() && lhs.column_index() < rhs.column_index());
+    }
+};
+
+/// <summary>
+/// A shared or an array formula read from a worksheet. The cells covered by it hold
+/// the index of the group instead of each holding a copy of its text.
+/// </summary>
+struct formula_group
+{
+    bool array = false;
+    cell_reference master;
+    range_reference range;
+    optional<std::string> text;
+};
+
 struct worksheet_impl
 {
     worksheet_impl(workbook *parent_workbook, std::size_t id, const std::string &title)
         : parent_(parent_workbook->d_),
+          workbook_(parent_workbook->d_.get()),
           id_(id),
-          title_(title)
+          title_(title),
+          cell_map_(parent_workbook->cell_storage(), cell_spill_of(*parent_workbook->d_))
     {
     }
 
@@ -64,16 +104,65 @@ struct worksheet_impl
         *this = other;
     }
 
+    worksheet_impl(const worksheet_impl &other, bool copy_cells)
+    {
+        assign(other, copy_cells);
+    }
+
     void operator=(const worksheet_impl &other)
+    {
+        assign(other, true);
+    }
+
+    /// <summary>
+    /// Copies other into this worksheet. If copy_cells is false and other has been
+    /// read, this worksheet instead waits for the cells of other to be copied when it
+    /// is first accessed, see worksheet_loader::load.
+    /// </summary>
+    void assign(const worksheet_impl &other, bool copy_cells)
     {
         parent_ = other.parent_;
+        workbook_ = other.workbook_;
 
         id_ = other.id_;
         title_ = other.title_;
+        copy_properties(other);
+        loader_ = other.loader_;
+        loader_rel_id_ = other.loader_rel_id_;
+        copy_source_ = other.copy_source_;
+        load_pending_ = other.load_pending_.load();
+
+        if (!copy_cells && !load_pending_)
+        {
+            copy_source_ = other.parent_.lock();
+            load_pending_ = true;
+        }
+
+        if (load_pending_)
+        {
+            // the cells are read or copied later, other still has the same cells
+            cell_map_ = cell_store(other.cell_map_.engine(), other.cell_map_.spill());
+            return;
+        }
+
+        cell_map_ = other.cell_map_;
+
+        cell_map_.for_each([this](cell_impl &cell) {
+            cell.parent_ = this;
+        });
+
+        point_cells_at_comments();
+    }
+
+    /// <summary>
+    /// Copies everything of other but its identity, its cells and how they are loaded,
+    /// so that other may belong to another workbook.
+    /// </summary>
+    void copy_properties(const worksheet_impl &other)
+    {
         format_properties_ = other.format_properties_;
         column_properties_ = other.column_properties_;
         row_properties_ = other.row_properties_;
-        cell_map_ = other.cell_map_;
         page_setup_ = other.page_setup_;
         auto_filter_ = other.auto_filter_;
         page_margins_ = other.page_margins_;
@@ -90,14 +179,44 @@ struct worksheet_impl
         extension_list_ = other.extension_list_;
         sheet_properties_ = other.sheet_properties_;
         print_options_ = other.print_options_;
+        formula_groups_ = other.formula_groups_;
+        comments_ = other.comments_;
+    }
+
+    /// <summary>
+    /// Rebuilds comments_ from the comments the cells point to, e.g. after the cells
+    /// moved. Comments of cells which were erased are dropped.
+    /// </summary>
+    void reindex_comments()
+    {
+        decltype(comments_) reindexed;
+
+        cell_map_.for_each([&reindexed](cell_impl &cell) {
+            if (cell.comment().is_set())
+            {
+                reindexed.emplace(cell_reference(cell.column_, cell.row_), std::move(*cell.comment().get()));
+            }
+        });
+
+        comments_.swap(reindexed);
+        point_cells_at_comments();
+    }
 
-        for (auto &cell : cell_map_)
+    /// <summary>
+    /// Points every cell with a comment at its entry in comments_.
+    /// </summary>
+    void point_cells_at_comments()
+    {
+        for (auto &comment : comments_)
         {
-            cell.second.parent_ = this;
+            cell_map_.find(comment.first)->extension().comment_.set(&comment.second);
         }
     }
 
     std::weak_ptr<workbook_impl> parent_;
+    // the same workbook as parent_, which owns this worksheet and so outlives it.
+    // Lets cells reach the workbook without locking parent_.
+    workbook_impl *workbook_ = nullptr;
 
     bool operator==(const worksheet_impl& rhs) const
     {
@@ -135,15 +254,16 @@ struct worksheet_impl
 
     sheet_format_properties format_properties_;
 
-    std::unordered_map<column_t, column_properties> column_properties_;
-    std::unordered_map<row_t, row_properties> row_properties_;
+    sorted_vector_map<column_t, column_properties> column_properties_;
+    sorted_vector_map<row_t, row_properties> row_properties_;
 
-    std::unordered_map<cell_reference, cell_impl> cell_map_;
+    cell_store cell_map_;
+    std::vector<formula_group> formula_groups_;
 
     optional<page_setup> page_setup_;
     optional<range_reference> auto_filter_;
     optional<page_margins> page_margins_;
-    std::vector<range_reference> merged_cells_;
+    merged_cell_index merged_cells_;
     std::unordered_map<std::string, named_range> named_ranges_;
 
     optional<phonetic_pr> phonetic_properties_;
@@ -158,7 +278,8 @@ struct worksheet_impl
     std::vector<column_t> column_breaks_;
     std::vector<row_t> row_breaks_;
 
-    std::unordered_map<std::string, comment> comments_;
+    // ordered so that the producer writes the comments row by row
+    std::map<cell_reference, comment, row_major_order> comments_;
     optional<print_options> print_options_;
     optional<sheet_pr> sheet_properties_;
 
@@ -166,6 +287,28 @@ struct worksheet_impl
 
     std::string drawing_rel_id_;
     optional<drawing::spreadsheet_drawing> drawing_;
+
+    /// <summary>
+    /// Set until the content of this worksheet has been read if the workbook was
+    /// loaded with load_options::lazy_worksheets, together with the id of the
+    /// relationship from the workbook part to the worksheet part.
+    /// </summary>
+    std::shared_ptr<worksheet_loader> loader_;
+    std::string loader_rel_id_;
+
+    /// <summary>
+    /// Set until the cells of this worksheet have been copied if it belongs to a clone
+    /// made with workbook::clone_method::copy_on_access. The cells are copied from the
+    /// worksheet with the same id in this workbook.
+    /// </summary>
+    std::shared_ptr<workbook_impl> copy_source_;
+
+    /// <summary>
+    /// Set together with loader_ or copy_source_ and cleared once the worksheet has
+    /// been read or copied, so that threads which only read the workbook can check it
+    /// without locking.
+    /// </summary>
+    std::atomic<bool> load_pending_{false};
 };
 
 } // namespace detail
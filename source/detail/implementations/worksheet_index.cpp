@@ -0,0 +1,56 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/implementations/worksheet_index.hpp>
+
+namespace xlnt {
+namespace detail {
+
+void worksheet_index::build(std::list<worksheet_impl> &worksheets)
+{
+    if (valid_) return;
+
+    sheets_.clear();
+    titles_.clear();
+    positions_.clear();
+
+    for (auto &ws : worksheets)
+    {
+        add(ws);
+    }
+
+    valid_ = true;
+}
+
+void worksheet_index::add(worksheet_impl &ws)
+{
+    // the first of several worksheets with one title is found, as when searching the list
+    titles_.emplace(ws.title_, sheets_.size());
+    positions_.emplace(&ws, sheets_.size());
+    sheets_.push_back(&ws);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,152 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/implementations/worksheet_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The worksheets of a workbook by position and by title, so that finding one doesn't
+/// walk the list they're kept in. Appending and renaming a worksheet update the index,
+/// other changes to the list invalidate it and it's rebuilt when it's next used. Like
+/// the list, the index isn't copied with the workbook.
+/// </summary>
+class worksheet_index
+{
+public:
+    worksheet_index() = default;
+
+    worksheet_index(const worksheet_index &)
+    {
+    }
+
+    worksheet_index &operator=(const worksheet_index &)
+    {
+        invalidate();
+        return *this;
+    }
+
+    /// <summary>
+    /// Forgets every worksheet, e.g. after worksheets were inserted, moved or removed.
+    /// </summary>
+    void invalidate()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        valid_ = false;
+    }
+
+    /// <summary>
+    /// Adds ws, which was just appended to the worksheets of the workbook.
+    /// </summary>
+    void append(worksheet_impl &ws)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (valid_)
+        {
+            add(ws);
+        }
+    }
+
+    /// <summary>
+    /// Moves the worksheet titled old_title to new_title, which no worksheet has yet.
+    /// </summary>
+    void rename(const std::string &old_title, const std::string &new_title)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!valid_) return;
+
+        auto match = titles_.find(old_title);
+
+        if (match != titles_.end())
+        {
+            const auto position = match->second;
+            titles_.erase(match);
+            titles_.emplace(new_title, position);
+        }
+    }
+
+    /// <summary>
+    /// Returns the first worksheet titled title or nullptr if there is none.
+    /// </summary>
+    worksheet_impl *find(std::list<worksheet_impl> &worksheets, const std::string &title)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        build(worksheets);
+
+        auto match = titles_.find(title);
+
+        return match == titles_.end() ? nullptr : sheets_[match->second];
+    }
+
+    /// <summary>
+    /// Returns the worksheet at position or nullptr if there are fewer worksheets.
+    /// </summary>
+    worksheet_impl *at(std::list<worksheet_impl> &worksheets, std::size_t position)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        build(worksheets);
+
+        return position < sheets_.size() ? sheets_[position] : nullptr;
+    }
+
+    /// <summary>
+    /// Returns the position of ws or the number of worksheets if it isn't one of them.
+    /// </summary>
+    std::size_t position(std::list<worksheet_impl> &worksheets, const worksheet_impl *ws)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        build(worksheets);
+
+        auto match = positions_.find(ws);
+
+        return match == positions_.end() ? sheets_.size() : match->second;
+    }
+
+private:
+    // defined with worksheet_impl complete, which it isn't yet when this is included
+    // through worksheet_impl.hpp
+    void build(std::list<worksheet_impl> &worksheets);
+
+    void add(worksheet_impl &ws);
+
+    std::vector<worksheet_impl *> sheets_;
+    std::unordered_map<std::string, std::size_t> titles_;
+    std::unordered_map<const worksheet_impl *, std::size_t> positions_;
+    bool valid_ = false;
+    std::mutex mutex_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,87 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <limits>
+#include <string>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/limits.hpp>
+
+namespace xlnt {
+namespace detail {
+
+load_limits::load_limits(const load_options &options)
+    : max_cells_(options.max_cells),
+      max_shared_strings_(options.max_shared_strings),
+      max_styles_(options.max_styles),
+      cells_(0)
+{
+}
+
+void load_limits::add_cells(std::size_t count)
+{
+    if (max_cells_ == 0)
+    {
+        return;
+    }
+
+    if (cells_.fetch_add(count) + count > max_cells_)
+    {
+        throw xlnt::limit_exceeded("the worksheets have more than the limit of "
+            + std::to_string(max_cells_) + " cells (load_options::max_cells)");
+    }
+}
+
+void load_limits::check_shared_strings(std::size_t count) const
+{
+    if (max_shared_strings_ != 0 && count > max_shared_strings_)
+    {
+        throw xlnt::limit_exceeded("the shared string table has more than the limit of "
+            + std::to_string(max_shared_strings_) + " strings (load_options::max_shared_strings)");
+    }
+}
+
+void load_limits::check_styles(std::size_t count, const char *list) const
+{
+    if (max_styles_ != 0 && count > max_styles_)
+    {
+        throw xlnt::limit_exceeded(std::string("the stylesheet has more than the limit of ")
+            + std::to_string(max_styles_) + " " + list + " (load_options::max_styles)");
+    }
+}
+
+std::size_t load_limits::remaining_cells() const
+{
+    if (max_cells_ == 0)
+    {
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    const auto cells = cells_.load();
+
+    return cells < max_cells_ ? max_cells_ - cells : 0;
+}
+
+} // namespace detail
+} // namespace xlnt
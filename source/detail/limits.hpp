@@ -24,7 +24,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
 #include "constants.hpp"
+#include <xlnt/workbook/load_options.hpp>
+#include <detail/xlnt_config_impl.hpp>
 
 namespace xlnt {
 namespace detail {
@@ -41,5 +47,46 @@ inline size_t clip_reserve_elements(size_t num_elements)
     return std::min(num_elements, xlnt::constants::max_elements_for_reserve());
 }
 
+/// <summary>
+/// Enforces the resource limits of load_options while a workbook is read, throwing
+/// limit_exceeded with the name of the limit as soon as one is exceeded. It is shared
+/// by the consumers reading worksheets concurrently, so cells are counted across them.
+/// </summary>
+class XLNT_API_INTERNAL load_limits
+{
+public:
+    explicit load_limits(const load_options &options);
+
+    load_limits(const load_limits &) = delete;
+    load_limits &operator=(const load_limits &) = delete;
+
+    /// <summary>
+    /// Adds count cells, which are about to be constructed, to the cells read so far.
+    /// </summary>
+    void add_cells(std::size_t count);
+
+    /// <summary>
+    /// Checks a shared string table of count strings.
+    /// </summary>
+    void check_shared_strings(std::size_t count) const;
+
+    /// <summary>
+    /// Checks a list of count entries of the stylesheet, such as fonts, called list.
+    /// </summary>
+    void check_styles(std::size_t count, const char *list) const;
+
+    /// <summary>
+    /// Returns the number of cells which may still be read, or the largest std::size_t
+    /// if cells are unlimited.
+    /// </summary>
+    std::size_t remaining_cells() const;
+
+private:
+    std::size_t max_cells_;
+    std::size_t max_shared_strings_;
+    std::size_t max_styles_;
+    std::atomic<std::size_t> cells_;
+};
+
 } // namespace detail
 } // namespace xlnt
@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <limits>
 #include <unordered_map>
 
 #include <xlnt/utils/exceptions.hpp>
@@ -1491,31 +1492,70 @@ number_formatter::number_formatter(const std::string &format_string, xlnt::calen
     format_ = parser_.result();
 }
 
-std::string number_formatter::format_number(double number)
+std::string number_formatter::format_number(double number) const
+{
+    std::string result;
+    append_number(number, result);
+
+    return result;
+}
+
+void number_formatter::format_numbers(const double *numbers, std::size_t count,
+    std::string &output, std::vector<std::size_t> &offsets) const
+{
+    output.clear();
+    offsets.clear();
+    offsets.reserve(count + 1);
+    offsets.push_back(0);
+
+    // a single unconditional section is used for every number, so skip the selection
+    const auto single_section = format_.size() == 1 && !format_[0].has_condition;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (single_section)
+        {
+            append_number(format_[0], numbers[i], output);
+        }
+        else
+        {
+            append_number(numbers[i], output);
+        }
+
+        offsets.push_back(output.size());
+    }
+}
+
+void number_formatter::append_number(double number, std::string &result) const
 {
     if (format_[0].has_condition)
     {
         if (format_[0].condition.satisfied_by(number))
         {
-            return format_number(format_[0], number);
+            append_number(format_[0], number, result);
+            return;
         }
 
         if (format_.size() == 1)
         {
-            return std::string(11, '#');
+            result.append(11, '#');
+            return;
         }
 
         if (!format_[1].has_condition || format_[1].condition.satisfied_by(number))
         {
-            return format_number(format_[1], number);
+            append_number(format_[1], number, result);
+            return;
         }
 
         if (format_.size() == 2)
         {
-            return std::string(11, '#');
+            result.append(11, '#');
+            return;
         }
 
-        return format_number(format_[2], number);
+        append_number(format_[2], number, result);
+        return;
     }
 
     // no conditions, format based on sign:
@@ -1523,18 +1563,21 @@ std::string number_formatter::format_number(double number)
     // 1 section, use for all
     if (format_.size() == 1)
     {
-        return format_number(format_[0], number);
+        append_number(format_[0], number, result);
+        return;
     }
     // 2 sections, first for positive and zero, second for negative
     else if (format_.size() == 2)
     {
         if (number >= 0)
         {
-            return format_number(format_[0], number);
+            append_number(format_[0], number, result);
+            return;
         }
         else
         {
-            return format_number(format_[1], std::fabs(number));
+            append_number(format_[1], std::fabs(number), result);
+            return;
         }
     }
     // 3+ sections, first for positive, second for negative, third for zero
@@ -1542,20 +1585,23 @@ std::string number_formatter::format_number(double number)
     {
         if (number > 0)
         {
-            return format_number(format_[0], number);
+            append_number(format_[0], number, result);
+            return;
         }
         else if (number < 0)
         {
-            return format_number(format_[1], std::fabs(number));
+            append_number(format_[1], std::fabs(number), result);
+            return;
         }
         else
         {
-            return format_number(format_[2], number);
+            append_number(format_[2], number, result);
+            return;
         }
     }
 }
 
-std::string number_formatter::format_text(const std::string &text)
+std::string number_formatter::format_text(const std::string &text) const
 {
     if (format_.size() < 4)
     {
@@ -1570,7 +1616,7 @@ std::string number_formatter::format_text(const std::string &text)
     return format_text(format_[3], text);
 }
 
-std::string number_formatter::fill_placeholders(const format_placeholders &p, double number)
+std::string number_formatter::fill_placeholders(const format_placeholders &p, double number) const
 {
     std::string result;
 
@@ -1659,7 +1705,7 @@ std::string number_formatter::fill_placeholders(const format_placeholders &p, do
 }
 
 std::string number_formatter::fill_scientific_placeholders(const format_placeholders &integer_part,
-    const format_placeholders &fractional_part, const format_placeholders &exponent_part, double number)
+    const format_placeholders &fractional_part, const format_placeholders &exponent_part, double number) const
 {
     std::size_t logarithm = 0;
 
@@ -1705,7 +1751,7 @@ std::string number_formatter::fill_scientific_placeholders(const format_placehol
 }
 
 std::string number_formatter::fill_fraction_placeholders(const format_placeholders & /*numerator*/,
-    const format_placeholders &denominator, double number, bool /*improper*/)
+    const format_placeholders &denominator, double number, bool /*improper*/) const
 {
     auto fractional_part = number - static_cast<long long>(number);
     auto original_fractional_part = fractional_part;
@@ -1743,7 +1789,15 @@ std::string number_formatter::fill_fraction_placeholders(const format_placeholde
     return std::to_string(numerator_rounded) + "/" + std::to_string(best_denominator);
 }
 
-std::string number_formatter::format_number(const format_code &format, double number)
+std::string number_formatter::format_number(const format_code &format, double number) const
+{
+    std::string result;
+    append_number(format, number, result);
+
+    return result;
+}
+
+void number_formatter::append_number(const format_code &format, double number, std::string &result) const
 {
     static const std::vector<std::string> month_names = std::vector<std::string>{"January", "February", "March",
         "April", "May", "June", "July", "August", "September", "October", "November", "December"};
@@ -1751,7 +1805,7 @@ std::string number_formatter::format_number(const format_code &format, double nu
     static const std::vector<std::string> day_names =
         std::vector<std::string>{"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
 
-    std::string result;
+    const auto start = result.size();
 
     if (number < 0)
     {
@@ -1759,7 +1813,9 @@ std::string number_formatter::format_number(const format_code &format, double nu
 
         if (format.is_datetime)
         {
-            return std::string(11, '#');
+            result.resize(start);
+            result.append(11, '#');
+            return;
         }
     }
 
@@ -2051,20 +2107,16 @@ std::string number_formatter::format_number(const format_code &format, double nu
 
     const std::size_t width = 11;
 
-    if (fill && result.size() < width)
+    if (fill && result.size() - start < width)
     {
-        auto remaining = width - result.size();
+        auto remaining = width - (result.size() - start);
 
-        std::string fill_string(remaining, fill_character.front());
         // TODO: A UTF-8 character could be multiple bytes
-
-        result = result.substr(0, fill_index) + fill_string + result.substr(fill_index);
+        result.insert(fill_index, remaining, fill_character.front());
     }
-
-    return result;
 }
 
-std::string number_formatter::format_text(const format_code &format, const std::string &text)
+std::string number_formatter::format_text(const format_code &format, const std::string &text) const
 {
     std::string result;
     bool any_text_part = false;
@@ -2095,5 +2147,50 @@ std::string number_formatter::format_text(const format_code &format, const std::
     return result;
 }
 
+number_formatter_cache::number_formatter_cache(const number_formatter_cache &)
+{
+}
+
+number_formatter_cache &number_formatter_cache::operator=(const number_formatter_cache &other)
+{
+    if (this != &other)
+    {
+        clear();
+    }
+
+    return *this;
+}
+
+const number_formatter &number_formatter_cache::get(const number_format &format, calendar base_date)
+{
+    const auto key = format.has_id() ? format.id() : std::numeric_limits<std::size_t>::max();
+    const auto &format_string = format.format_string();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &bucket = entries_[key];
+
+    for (const auto &existing : bucket)
+    {
+        if (existing.base_date == base_date && existing.format_string == format_string)
+        {
+            return *existing.formatter;
+        }
+    }
+
+    entry compiled;
+    compiled.format_string = format_string;
+    compiled.base_date = base_date;
+    compiled.formatter.reset(new number_formatter(format_string, base_date));
+    bucket.push_back(std::move(compiled));
+
+    return *bucket.back().formatter;
+}
+
+void number_formatter_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -24,11 +24,15 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <detail/xlnt_config_impl.hpp>
 
+#include <xlnt/styles/number_format.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
 
@@ -679,23 +683,73 @@ class XLNT_API_INTERNAL number_formatter
 {
 public:
     number_formatter(const std::string &format_string, xlnt::calendar calendar);
-    std::string format_number(double number);
-    std::string format_text(const std::string &text);
+    std::string format_number(double number) const;
+    std::string format_text(const std::string &text) const;
+
+    /// <summary>
+    /// Formats count numbers one after another into output, replacing its contents.
+    /// The text of number i is output[offsets[i], offsets[i + 1]), so offsets ends up
+    /// with count + 1 entries. Doesn't allocate a string per number.
+    /// </summary>
+    void format_numbers(const double *numbers, std::size_t count,
+        std::string &output, std::vector<std::size_t> &offsets) const;
 
 private:
-    std::string fill_placeholders(const format_placeholders &p, double number);
+    std::string fill_placeholders(const format_placeholders &p, double number) const;
     std::string fill_fraction_placeholders(const format_placeholders &numerator,
-        const format_placeholders &denominator, double number, bool improper);
+        const format_placeholders &denominator, double number, bool improper) const;
     std::string fill_scientific_placeholders(const format_placeholders &integer_part,
         const format_placeholders &fractional_part, const format_placeholders &exponent_part,
-        double number);
-    std::string format_number(const format_code &format, double number);
-    std::string format_text(const format_code &format, const std::string &text);
+        double number) const;
+    std::string format_number(const format_code &format, double number) const;
+    void append_number(double number, std::string &result) const;
+    void append_number(const format_code &format, double number, std::string &result) const;
+    std::string format_text(const format_code &format, const std::string &text) const;
 
     number_format_parser parser_;
     std::vector<format_code> format_;
     xlnt::calendar calendar_;
 };
 
+/// <summary>
+/// Compiled number formatters keyed by number format id so that each format code is
+/// only parsed once per workbook. Lookups take a lock and formatters are never removed
+/// until the cache is cleared, so cells may be rendered from several threads at once.
+/// A copy starts out empty.
+/// </summary>
+class XLNT_API_INTERNAL number_formatter_cache
+{
+public:
+    number_formatter_cache() = default;
+    number_formatter_cache(const number_formatter_cache &other);
+    number_formatter_cache &operator=(const number_formatter_cache &other);
+
+    /// <summary>
+    /// Returns the formatter for format and base_date, compiling it on first use.
+    /// </summary>
+    const number_formatter &get(const number_format &format, calendar base_date);
+
+    /// <summary>
+    /// Removes every formatter. This mustn't race with get.
+    /// </summary>
+    void clear();
+
+private:
+    struct entry
+    {
+        std::string format_string;
+        calendar base_date;
+        std::unique_ptr<number_formatter> formatter;
+    };
+
+    std::mutex mutex_;
+
+    /// <summary>
+    /// Formats without an id share the bucket of the largest id. Formats are told apart
+    /// by their format string within a bucket in case an id is reused.
+    /// </summary>
+    std::unordered_map<std::size_t, std::vector<entry>> entries_;
+};
+
 } // namespace detail
 } // namespace xlnt
@@ -0,0 +1,328 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/byte_sink.hpp>
+#include <xlnt/workbook/byte_source.hpp>
+#include <detail/serialization/byte_streambuf.hpp>
+
+namespace {
+
+// small blocks would turn every read into a request of its own
+const std::size_t minimum_block_size = 4096;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+source_streambuf::source_streambuf(byte_source &source, std::size_t block_size)
+    : source_(source),
+      size_(source.size()),
+      block_size_(std::max(block_size, minimum_block_size))
+{
+    setg(nullptr, nullptr, nullptr);
+}
+
+source_streambuf::~source_streambuf()
+{
+    // the source must not be read for a buffer which is gone
+    if (ahead_.valid())
+    {
+        ahead_.wait();
+    }
+}
+
+std::size_t source_streambuf::memory_usage() const
+{
+    return block_.capacity() + (ahead_.valid() ? block_size_ : 0);
+}
+
+std::uint64_t source_streambuf::position() const
+{
+    return block_offset_ + static_cast<std::uint64_t>(gptr() - eback());
+}
+
+void source_streambuf::reset(std::uint64_t offset)
+{
+    block_.clear();
+    block_offset_ = offset;
+    setg(nullptr, nullptr, nullptr);
+}
+
+void source_streambuf::read_ahead(std::uint64_t offset)
+{
+    if (offset >= size_ || ahead_.valid())
+    {
+        return;
+    }
+
+    ahead_offset_ = offset;
+    ahead_ = source_.read_async(offset, static_cast<std::size_t>(std::min<std::uint64_t>(block_size_, size_ - offset)));
+}
+
+std::vector<std::uint8_t> source_streambuf::fetch(std::uint64_t offset, std::size_t count)
+{
+    if (ahead_.valid())
+    {
+        auto ahead = std::move(ahead_);
+
+        if (ahead_offset_ == offset)
+        {
+            auto data = ahead.get();
+
+            if (data.size() == count)
+            {
+                return data;
+            }
+        }
+    }
+
+    std::vector<std::uint8_t> data(count);
+    source_.read(offset, data.data(), count);
+
+    return data;
+}
+
+void source_streambuf::read_direct(char *destination, std::size_t count)
+{
+    const auto offset = position();
+    std::deque<std::future<std::vector<std::uint8_t>>> reads;
+    std::size_t requested = 0;
+
+    if (ahead_.valid() && ahead_offset_ == offset)
+    {
+        // count is at least a block, so the block read ahead is its first range
+        reads.push_back(std::move(ahead_));
+        requested = static_cast<std::size_t>(std::min<std::uint64_t>(block_size_, size_ - offset));
+    }
+
+    ahead_ = std::future<std::vector<std::uint8_t>>();
+
+    for (std::size_t done = 0; done < count;)
+    {
+        while (reads.size() < max_parallel_reads && requested < count)
+        {
+            const auto range = std::min(block_size_, count - requested);
+            reads.push_back(source_.read_async(offset + requested, range));
+            requested += range;
+        }
+
+        const auto data = reads.front().get();
+        reads.pop_front();
+        const auto expected = std::min(block_size_, count - done);
+
+        if (data.size() != expected)
+        {
+            throw xlnt::exception("byte source returned the wrong number of bytes");
+        }
+
+        std::memcpy(destination + done, data.data(), expected);
+        done += expected;
+    }
+
+    reset(offset + count);
+    read_ahead(offset + count);
+}
+
+source_streambuf::int_type source_streambuf::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    const auto offset = position();
+
+    if (offset >= size_)
+    {
+        return traits_type::eof();
+    }
+
+    const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(block_size_, size_ - offset));
+    block_ = fetch(offset, count);
+    block_offset_ = offset;
+
+    auto begin = reinterpret_cast<char *>(block_.data());
+    setg(begin, begin, begin + block_.size());
+    read_ahead(offset + count);
+
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize source_streambuf::xsgetn(char *s, std::streamsize n)
+{
+    std::streamsize copied = 0;
+
+    while (copied < n)
+    {
+        const auto available = egptr() - gptr();
+
+        if (available > 0)
+        {
+            const auto count = std::min<std::streamsize>(available, n - copied);
+            std::memcpy(s + copied, gptr(), static_cast<std::size_t>(count));
+            gbump(static_cast<int>(count));
+            copied += count;
+
+            continue;
+        }
+
+        const auto offset = position();
+
+        if (offset >= size_)
+        {
+            break;
+        }
+
+        const auto remaining = static_cast<std::size_t>(
+            std::min<std::uint64_t>(static_cast<std::uint64_t>(n - copied), size_ - offset));
+
+        if (remaining >= block_size_)
+        {
+            read_direct(s + copied, remaining);
+            copied += static_cast<std::streamsize>(remaining);
+        }
+        else if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+        {
+            break;
+        }
+    }
+
+    return copied;
+}
+
+std::streamsize source_streambuf::showmanyc()
+{
+    const auto offset = position();
+
+    return offset >= size_ ? static_cast<std::streamsize>(-1) : static_cast<std::streamsize>(size_ - offset);
+}
+
+std::streampos source_streambuf::seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode)
+{
+    const auto base = static_cast<std::int64_t>(way == std::ios_base::beg ? 0 : way == std::ios_base::end ? size_ : position());
+    const auto target = base + static_cast<std::int64_t>(off);
+
+    if (target < 0 || static_cast<std::uint64_t>(target) > size_)
+    {
+        return static_cast<std::streamoff>(-1);
+    }
+
+    const auto offset = static_cast<std::uint64_t>(target);
+
+    if (offset >= block_offset_ && offset - block_offset_ <= static_cast<std::uint64_t>(egptr() - eback()))
+    {
+        setg(eback(), eback() + (offset - block_offset_), egptr());
+    }
+    else
+    {
+        reset(offset);
+    }
+
+    return static_cast<std::streamoff>(target);
+}
+
+std::streampos source_streambuf::seekpos(std::streampos sp, std::ios_base::openmode which)
+{
+    return seekoff(static_cast<std::streamoff>(sp), std::ios_base::beg, which);
+}
+
+sink_streambuf::sink_streambuf(byte_sink &sink, std::size_t chunk_size)
+    : sink_(sink),
+      chunk_size_(std::max(chunk_size, minimum_block_size)),
+      chunk_(chunk_size_)
+{
+    auto begin = reinterpret_cast<char *>(chunk_.data());
+    setp(begin, begin + chunk_.size());
+}
+
+sink_streambuf::~sink_streambuf()
+{
+    if (pending_.valid())
+    {
+        pending_.wait();
+    }
+}
+
+void sink_streambuf::write_chunk()
+{
+    const auto used = static_cast<std::size_t>(pptr() - pbase());
+
+    if (used == 0)
+    {
+        return;
+    }
+
+    if (pending_.valid())
+    {
+        pending_.get();
+    }
+
+    chunk_.resize(used);
+    pending_ = sink_.write_async(offset_, std::move(chunk_));
+    offset_ += used;
+
+    chunk_ = std::vector<std::uint8_t>(chunk_size_);
+    auto begin = reinterpret_cast<char *>(chunk_.data());
+    setp(begin, begin + chunk_.size());
+}
+
+void sink_streambuf::finish()
+{
+    write_chunk();
+
+    if (pending_.valid())
+    {
+        pending_.get();
+    }
+
+    sink_.finish();
+}
+
+sink_streambuf::int_type sink_streambuf::overflow(int_type c)
+{
+    write_chunk();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+int sink_streambuf::sync()
+{
+    // chunks are only written once full, so that every chunk but the last has the same size
+    return 0;
+}
+
+} // namespace detail
+} // namespace xlnt
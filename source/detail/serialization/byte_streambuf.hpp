@@ -0,0 +1,155 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <vector>
+
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+
+class byte_sink;
+class byte_source;
+
+namespace detail {
+
+/// <summary>
+/// A seekable istreambuf reading a byte_source in blocks of block_size bytes. After
+/// each block is fetched, the block following it is requested with read_async so that
+/// sequential reads don't wait for it. Reads of block_size bytes or more bypass the
+/// buffer and are fetched as block_size ranges, up to max_parallel_reads at a time.
+/// </summary>
+class XLNT_API_INTERNAL source_streambuf : public std::streambuf
+{
+public:
+    using int_type = std::streambuf::int_type;
+
+    static const std::size_t max_parallel_reads = 4;
+
+    source_streambuf(byte_source &source, std::size_t block_size);
+
+    ~source_streambuf() override;
+
+    source_streambuf(const source_streambuf &) = delete;
+    source_streambuf &operator=(const source_streambuf &) = delete;
+
+    /// <summary>
+    /// Returns the number of bytes buffered, including the block read ahead.
+    /// </summary>
+    std::size_t memory_usage() const;
+
+private:
+    int_type underflow() override;
+
+    std::streamsize xsgetn(char *s, std::streamsize n) override;
+
+    std::streamsize showmanyc() override;
+
+    std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode) override;
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode) override;
+
+    /// <summary>
+    /// Returns the offset in the source of the next byte to be read.
+    /// </summary>
+    std::uint64_t position() const;
+
+    /// <summary>
+    /// Makes the get area empty, with the next byte read from offset.
+    /// </summary>
+    void reset(std::uint64_t offset);
+
+    /// <summary>
+    /// Requests the block starting at offset with read_async unless a block is already
+    /// being read ahead or offset is the end of the source.
+    /// </summary>
+    void read_ahead(std::uint64_t offset);
+
+    /// <summary>
+    /// Returns the count bytes at offset, taking them from the block read ahead if it
+    /// starts there, otherwise waiting for it to be dropped and reading them.
+    /// </summary>
+    std::vector<std::uint8_t> fetch(std::uint64_t offset, std::size_t count);
+
+    /// <summary>
+    /// Reads count bytes from position() straight into destination.
+    /// </summary>
+    void read_direct(char *destination, std::size_t count);
+
+    byte_source &source_;
+    std::uint64_t size_;
+    std::size_t block_size_;
+    std::vector<std::uint8_t> block_;
+    std::uint64_t block_offset_ = 0;
+    std::future<std::vector<std::uint8_t>> ahead_;
+    std::uint64_t ahead_offset_ = 0;
+};
+
+/// <summary>
+/// An ostreambuf collecting chunk_size bytes at a time and passing each full chunk to
+/// byte_sink::write_async, with at most one chunk being written while the next one is
+/// filled. finish must be called after the last byte, which rethrows the exception of
+/// a failed write.
+/// </summary>
+class XLNT_API_INTERNAL sink_streambuf : public std::streambuf
+{
+public:
+    using int_type = std::streambuf::int_type;
+
+    sink_streambuf(byte_sink &sink, std::size_t chunk_size);
+
+    ~sink_streambuf() override;
+
+    sink_streambuf(const sink_streambuf &) = delete;
+    sink_streambuf &operator=(const sink_streambuf &) = delete;
+
+    /// <summary>
+    /// Writes the last chunk, waits for it and calls byte_sink::finish.
+    /// </summary>
+    void finish();
+
+private:
+    int_type overflow(int_type c) override;
+
+    int sync() override;
+
+    /// <summary>
+    /// Hands the bytes of the put area to the sink once the previous chunk has been
+    /// written, and starts a new chunk.
+    /// </summary>
+    void write_chunk();
+
+    byte_sink &sink_;
+    std::size_t chunk_size_;
+    std::vector<std::uint8_t> chunk_;
+    std::uint64_t offset_ = 0;
+    std::future<void> pending_;
+};
+
+} // namespace detail
+} // namespace xlnt
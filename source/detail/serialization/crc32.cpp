@@ -0,0 +1,350 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#include <array>
+
+#include <detail/serialization/crc32.hpp>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define XLNT_CRC32_PCLMUL 1
+#define XLNT_CRC32_PCLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define XLNT_CRC32_PCLMUL 1
+#define XLNT_CRC32_PCLMUL_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define XLNT_CRC32_ARM 1
+#define XLNT_CRC32_ARM_TARGET
+#include <arm_acle.h>
+#elif defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define XLNT_CRC32_ARM 1
+#define XLNT_CRC32_ARM_RUNTIME 1
+#if defined(__clang__)
+#define XLNT_CRC32_ARM_TARGET __attribute__((target("crc")))
+#else
+#define XLNT_CRC32_ARM_TARGET __attribute__((target("+crc")))
+#endif
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+
+namespace {
+
+// the reflected polynomial of the CRC-32 of ZIP members
+const std::uint32_t polynomial = 0xEDB88320;
+
+// Eight tables of 256 entries: the first is the CRC of each byte, each further one that of
+// the byte followed by one more zero byte than the table before.
+using crc_tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+const crc_tables &tables()
+{
+    static const crc_tables result = []() {
+        crc_tables t{};
+
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            auto crc = i;
+
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ ((crc & 1) != 0 ? polynomial : 0);
+            }
+
+            t[0][i] = crc;
+        }
+
+        for (std::size_t k = 1; k < t.size(); ++k)
+        {
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+
+        return t;
+    }();
+
+    return result;
+}
+
+// Updates crc, which is already inverted, eight bytes at a time.
+std::uint32_t crc32_table(std::uint32_t crc, const std::uint8_t *data, std::size_t size)
+{
+    const auto &t = tables();
+
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        const auto low = crc ^ (static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8
+                                   | static_cast<std::uint32_t>(data[2]) << 16
+                                   | static_cast<std::uint32_t>(data[3]) << 24);
+
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+    }
+
+    for (; size > 0; ++data, --size)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+    }
+
+    return crc;
+}
+
+#if defined(XLNT_CRC32_PCLMUL)
+
+bool has_pclmul()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 1);
+    return (info[2] & (1 << 1)) != 0 && (info[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+XLNT_CRC32_PCLMUL_TARGET
+inline __m128i load(const std::uint8_t *at)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(at));
+}
+
+// Multiplies the halves of lane by those of k, moving it 128 or 512 bits forward, and adds next.
+XLNT_CRC32_PCLMUL_TARGET
+inline __m128i fold(__m128i lane, __m128i k, __m128i next)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(lane, k, 0x00), _mm_clmulepi64_si128(lane, k, 0x11)), next);
+}
+
+// Updates crc, which is already inverted, with size bytes, which must be at least 64 and
+// a multiple of 16. Four 128 bit lanes are folded 64 bytes at a time, folded into one and
+// reduced to 32 bits, as described in "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction" by Gopal et al.
+XLNT_CRC32_PCLMUL_TARGET
+std::uint32_t crc32_pclmul(std::uint32_t crc, const std::uint8_t *data, std::size_t size)
+{
+    // x^(4*128+64) mod P and x^(4*128) mod P, x^(128+64) mod P and x^128 mod P, x^64 mod P,
+    // each bit reflected and shifted left by one, and P and its Barrett quotient x^64 / P
+    const auto k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+    const auto k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+    const auto k5 = _mm_set_epi64x(0, 0x0163CD6124);
+    const auto p = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+    const auto low_words = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    auto x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    auto x2 = load(data + 16);
+    auto x3 = load(data + 32);
+    auto x4 = load(data + 48);
+    data += 64;
+    size -= 64;
+
+    for (; size >= 64; data += 64, size -= 64)
+    {
+        x1 = fold(x1, k1k2, load(data));
+        x2 = fold(x2, k1k2, load(data + 16));
+        x3 = fold(x3, k1k2, load(data + 32));
+        x4 = fold(x4, k1k2, load(data + 48));
+    }
+
+    x1 = fold(x1, k3k4, x2);
+    x1 = fold(x1, k3k4, x3);
+    x1 = fold(x1, k3k4, x4);
+
+    for (; size >= 16; data += 16, size -= 16)
+    {
+        x1 = fold(x1, k3k4, load(data));
+    }
+
+    // 128 bits to 64
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low_words), k5, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, low_words), p, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, low_words), p, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+#if defined(XLNT_CRC32_ARM)
+
+bool has_arm_crc32()
+{
+#if defined(XLNT_CRC32_ARM_RUNTIME)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+    return true;
+#endif
+}
+
+// Updates crc, which is already inverted, eight bytes at a time.
+XLNT_CRC32_ARM_TARGET
+std::uint32_t crc32_arm(std::uint32_t crc, const std::uint8_t *data, std::size_t size)
+{
+    for (; size > 0 && (reinterpret_cast<std::uintptr_t>(data) & 7) != 0; ++data, --size)
+    {
+        crc = __crc32b(crc, *data);
+    }
+
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        std::uint64_t word = 0;
+        __builtin_memcpy(&word, data, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+
+    for (; size > 0; ++data, --size)
+    {
+        crc = __crc32b(crc, *data);
+    }
+
+    return crc;
+}
+
+#endif
+
+enum class implementation
+{
+    table,
+    pclmul,
+    armv8
+};
+
+implementation detect()
+{
+#if defined(XLNT_CRC32_PCLMUL)
+    if (has_pclmul()) return implementation::pclmul;
+#endif
+#if defined(XLNT_CRC32_ARM)
+    if (has_arm_crc32()) return implementation::armv8;
+#endif
+    return implementation::table;
+}
+
+implementation selected()
+{
+    static const auto result = detect();
+    return result;
+}
+
+// Returns the product of a and b modulo the polynomial, all of them reflected.
+std::uint32_t multiply_modulo(std::uint32_t a, std::uint32_t b)
+{
+    std::uint32_t product = 0;
+
+    for (std::uint32_t bit = 0x80000000; bit != 0; bit >>= 1)
+    {
+        if ((a & bit) != 0)
+        {
+            product ^= b;
+        }
+
+        b = (b >> 1) ^ ((b & 1) != 0 ? polynomial : 0);
+    }
+
+    return product;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+std::uint32_t compute_crc32(std::uint32_t crc, const std::uint8_t *data, std::size_t size)
+{
+    crc = ~crc;
+
+    switch (selected())
+    {
+#if defined(XLNT_CRC32_PCLMUL)
+    case implementation::pclmul:
+        if (size >= 64)
+        {
+            const auto folded = size & ~static_cast<std::size_t>(15);
+            crc = crc32_pclmul(crc, data, folded);
+            data += folded;
+            size -= folded;
+        }
+        break;
+#endif
+#if defined(XLNT_CRC32_ARM)
+    case implementation::armv8:
+        return ~crc32_arm(crc, data, size);
+#endif
+    default:
+        break;
+    }
+
+    return ~crc32_table(crc, data, size);
+}
+
+std::uint32_t combine_crc32(std::uint32_t first, std::uint32_t second, std::uint64_t second_size)
+{
+    // appending second_size bytes multiplies the CRC of the first part by x^(8 * second_size),
+    // which is built from the powers x^(2^k) by squaring; x^8 is 1 << 23 reflected
+    auto shift = std::uint32_t(0x80000000);
+    auto power = std::uint32_t(1) << 23;
+
+    for (; second_size != 0; second_size >>= 1)
+    {
+        if ((second_size & 1) != 0)
+        {
+            shift = multiply_modulo(power, shift);
+        }
+
+        power = multiply_modulo(power, power);
+    }
+
+    return multiply_modulo(shift, first) ^ second;
+}
+
+const char *crc32_implementation()
+{
+    switch (selected())
+    {
+    case implementation::pclmul:
+        return "pclmul";
+    case implementation::armv8:
+        return "armv8";
+    default:
+        return "table";
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,58 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Returns the CRC-32 of ZIP members of the size bytes at data continuing from crc, as
+/// update_crc32 does for the deflate implementations without a fast CRC-32 of their own.
+/// Folds with carry-less multiplication on x86 processors with PCLMULQDQ and uses the CRC32
+/// instructions on ARMv8 processors which have them, both chosen once at run time, and
+/// processes eight bytes at a time with tables otherwise.
+/// </summary>
+XLNT_API_INTERNAL std::uint32_t compute_crc32(std::uint32_t crc, const std::uint8_t *data, std::size_t size);
+
+/// <summary>
+/// Returns the CRC-32 of two pieces of data one after the other from first and second,
+/// their CRC-32s, and second_size, the length of the second piece, without the data.
+/// </summary>
+XLNT_API_INTERNAL std::uint32_t combine_crc32(std::uint32_t first, std::uint32_t second, std::uint64_t second_size);
+
+/// <summary>
+/// Returns the name of the implementation compute_crc32 uses on this processor: "pclmul",
+/// "armv8" or "table".
+/// </summary>
+XLNT_API_INTERNAL const char *crc32_implementation();
+
+} // namespace detail
+} // namespace xlnt
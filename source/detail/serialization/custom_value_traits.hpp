@@ -25,8 +25,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <string>
-#include <unordered_map>
 
 #include <detail/default_case.hpp>
 #include <detail/external/include_libstudxml.hpp>
@@ -80,6 +81,48 @@ std::string to_string(pane_state state);
 
 std::string to_string(orientation state);
 
+/// <summary>
+/// A name in an OOXML vocabulary and the value it stands for.
+/// </summary>
+template <typename T>
+struct vocabulary_entry
+{
+    template <std::size_t N>
+    constexpr vocabulary_entry(const char (&name_)[N], T value_)
+        : name(name_), length(N - 1), value(value_)
+    {
+    }
+
+    const char *name;
+    std::size_t length;
+    T value;
+};
+
+/// <summary>
+/// Returns the entry of names named by the length characters at string, or nullptr if
+/// there is none. Only the names of the same length are compared character by character.
+/// </summary>
+template <typename T, std::size_t N>
+const vocabulary_entry<T> *find_name(const vocabulary_entry<T> (&names)[N],
+    const char *string, std::size_t length, bool ignore_case = false)
+{
+    for (const auto &entry : names)
+    {
+        if (entry.length != length) continue;
+
+        if (ignore_case
+                ? std::equal(string, string + length, entry.name, [](char lhs, char rhs) {
+                      return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
+                  })
+                : std::memcmp(string, entry.name, length) == 0)
+        {
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
 template<typename T>
 static T from_string(const std::string &string_value);
 
@@ -98,75 +141,64 @@ font::underline_style from_string(const std::string &string)
 template<>
 relationship_type from_string(const std::string &string)
 {
-    if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument")
-        return relationship_type::office_document;
-    else if (string == "http://schemas.openxmlformats.org/package/2006/relationships/metadata/thumbnail")
-        return relationship_type::thumbnail;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/calcChain")
-        return relationship_type::calculation_chain;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/extended-properties")
-        return relationship_type::extended_properties;
-    else if (string == "http://schemas.openxmlformats.org/package/2006/relationships/metadata/core-properties"
-        || string == "http://schemas.openxmlformats.org/officedocument/2006/relationships/metadata/core-properties")
-        return relationship_type::core_properties;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet")
-        return relationship_type::worksheet;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings")
-        return relationship_type::shared_string_table;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles")
-        return relationship_type::stylesheet;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/theme")
-        return relationship_type::theme;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/hyperlink")
-        return relationship_type::hyperlink;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/chartsheet")
-        return relationship_type::chartsheet;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/comments")
-        return relationship_type::comments;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/vmlDrawing")
-        return relationship_type::vml_drawing;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/custom-properties")
-        return relationship_type::custom_properties;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/printerSettings")
-        return relationship_type::printer_settings;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/connections")
-        return relationship_type::connections;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/customProperty")
-        return relationship_type::custom_property;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/customXmlMappings")
-        return relationship_type::custom_xml_mappings;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/dialogsheet")
-        return relationship_type::dialogsheet;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/drawing")
-        return relationship_type::drawings;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/externalLinkPath")
-        return relationship_type::external_workbook_references;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/pivotTable")
-        return relationship_type::pivot_table;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/pivotCacheDefinition")
-        return relationship_type::pivot_table_cache_definition;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/pivotCacheRecords")
-        return relationship_type::pivot_table_cache_records;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/queryTable")
-        return relationship_type::query_table;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/revisionHeaders")
-        return relationship_type::shared_workbook_revision_headers;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedWorkbook")
-        return relationship_type::shared_workbook;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/revisionLog")
-        return relationship_type::revision_log;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/usernames")
-        return relationship_type::shared_workbook_user_data;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/tableSingleCells")
-        return relationship_type::single_cell_table_definitions;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/table")
-        return relationship_type::table_definition;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/volatileDependencies")
-        return relationship_type::volatile_dependencies;
-    else if (string == "http://schemas.microsoft.com/office/2006/relationships/vbaProject")
-        return relationship_type::vbaproject;
-    else if (string == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/image")
-        return relationship_type::image;
+    // most types share this prefix, so it is compared once and only the rest of them after it
+    static const char office_document_prefix[] = "http://schemas.openxmlformats.org/officeDocument/2006/relationships/";
+    static const vocabulary_entry<relationship_type> office_document_types[] = {
+        {"officeDocument", relationship_type::office_document},
+        {"calcChain", relationship_type::calculation_chain},
+        {"extended-properties", relationship_type::extended_properties},
+        {"worksheet", relationship_type::worksheet},
+        {"sharedStrings", relationship_type::shared_string_table},
+        {"styles", relationship_type::stylesheet},
+        {"theme", relationship_type::theme},
+        {"hyperlink", relationship_type::hyperlink},
+        {"chartsheet", relationship_type::chartsheet},
+        {"comments", relationship_type::comments},
+        {"vmlDrawing", relationship_type::vml_drawing},
+        {"custom-properties", relationship_type::custom_properties},
+        {"printerSettings", relationship_type::printer_settings},
+        {"connections", relationship_type::connections},
+        {"customProperty", relationship_type::custom_property},
+        {"customXmlMappings", relationship_type::custom_xml_mappings},
+        {"dialogsheet", relationship_type::dialogsheet},
+        {"drawing", relationship_type::drawings},
+        {"externalLinkPath", relationship_type::external_workbook_references},
+        {"pivotTable", relationship_type::pivot_table},
+        {"pivotCacheDefinition", relationship_type::pivot_table_cache_definition},
+        {"pivotCacheRecords", relationship_type::pivot_table_cache_records},
+        {"queryTable", relationship_type::query_table},
+        {"revisionHeaders", relationship_type::shared_workbook_revision_headers},
+        {"sharedWorkbook", relationship_type::shared_workbook},
+        {"revisionLog", relationship_type::revision_log},
+        {"usernames", relationship_type::shared_workbook_user_data},
+        {"tableSingleCells", relationship_type::single_cell_table_definitions},
+        {"table", relationship_type::table_definition},
+        {"volatileDependencies", relationship_type::volatile_dependencies},
+        {"image", relationship_type::image},
+    };
+    static const vocabulary_entry<relationship_type> other_types[] = {
+        {"http://schemas.openxmlformats.org/package/2006/relationships/metadata/thumbnail", relationship_type::thumbnail},
+        {"http://schemas.openxmlformats.org/package/2006/relationships/metadata/core-properties", relationship_type::core_properties},
+        {"http://schemas.openxmlformats.org/officedocument/2006/relationships/metadata/core-properties", relationship_type::core_properties},
+        {"http://schemas.microsoft.com/office/2006/relationships/vbaProject", relationship_type::vbaproject},
+    };
+
+    const auto prefix_length = sizeof(office_document_prefix) - 1;
+    const vocabulary_entry<relationship_type> *found = nullptr;
+
+    if (string.size() > prefix_length && string.compare(0, prefix_length, office_document_prefix) == 0)
+    {
+        found = find_name(office_document_types, string.data() + prefix_length, string.size() - prefix_length);
+    }
+    else
+    {
+        found = find_name(other_types, string.data(), string.size());
+    }
+
+    if (found != nullptr)
+    {
+        return found->value;
+    }
 
     // ECMA 376-4 Part 1 Section 9.1.7 says consumers shall not fail to load
     // a document with unknown relationships.
@@ -176,57 +208,33 @@ relationship_type from_string(const std::string &string)
 template<>
 pattern_fill_type from_string(const std::string &string)
 {
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wexit-time-destructors"
-    static std::unordered_map<std::string, pattern_fill_type> patternFill {
-        {"darkdown", pattern_fill_type::darkdown },
-        { "darkgray", pattern_fill_type::darkgray },
-        { "darkgrid", pattern_fill_type::darkgrid },
-        { "darkhorizontal", pattern_fill_type::darkhorizontal },
-        { "darktrellis", pattern_fill_type::darktrellis },
-        { "darkup", pattern_fill_type::darkup },
-        { "darkvertical", pattern_fill_type::darkvertical },
-        { "gray0625", pattern_fill_type::gray0625 },
-        { "gray125", pattern_fill_type::gray125 },
-        { "lightdown", pattern_fill_type::lightdown },
-        { "lightgray", pattern_fill_type::lightgray },
-        { "lightgrid", pattern_fill_type::lightgrid },
-        { "lighthorizontal", pattern_fill_type::lighthorizontal },
-        { "lighttrellis", pattern_fill_type::lighttrellis },
-        { "lightup", pattern_fill_type::lightup },
-        { "lightvertical", pattern_fill_type::lightvertical },
-        { "mediumgray", pattern_fill_type::mediumgray },
-        { "none", pattern_fill_type::none },
-        { "solid", pattern_fill_type::solid }
-    };
-#pragma clang diagnostic pop
-
-    auto toLower = [](std::string str) {
-        auto bg = std::begin (str);
-        auto en = std::end (str);
-        std::transform(bg, en, bg,
-                       [](char c) {
-                        // static cast to avoid int -> char narrowing warning
-                           return static_cast<char>(tolower(c));
-                       });
-
-        return str;
-    };
-
-    auto patternLookup = [](const std::string& key) {
-        auto entry = patternFill.find (key);
-        if (entry != std::end (patternFill)) {
-            return entry->second;
-        }
-        else {
-            // Note: there won't be an error if there is an unsupported pattern
-            return pattern_fill_type::none;
-        }
+    static const vocabulary_entry<pattern_fill_type> names[] = {
+        {"darkdown", pattern_fill_type::darkdown},
+        {"darkgray", pattern_fill_type::darkgray},
+        {"darkgrid", pattern_fill_type::darkgrid},
+        {"darkhorizontal", pattern_fill_type::darkhorizontal},
+        {"darktrellis", pattern_fill_type::darktrellis},
+        {"darkup", pattern_fill_type::darkup},
+        {"darkvertical", pattern_fill_type::darkvertical},
+        {"gray0625", pattern_fill_type::gray0625},
+        {"gray125", pattern_fill_type::gray125},
+        {"lightdown", pattern_fill_type::lightdown},
+        {"lightgray", pattern_fill_type::lightgray},
+        {"lightgrid", pattern_fill_type::lightgrid},
+        {"lighthorizontal", pattern_fill_type::lighthorizontal},
+        {"lighttrellis", pattern_fill_type::lighttrellis},
+        {"lightup", pattern_fill_type::lightup},
+        {"lightvertical", pattern_fill_type::lightvertical},
+        {"mediumgray", pattern_fill_type::mediumgray},
+        {"none", pattern_fill_type::none},
+        {"solid", pattern_fill_type::solid},
     };
 
-    std::string lowerString {toLower (string) };
+    // the names are compared case-insensitively, as some writers capitalise them
+    const auto found = find_name(names, string.data(), string.size(), true);
 
-    return patternLookup (lowerString);
+    // Note: there won't be an error if there is an unsupported pattern
+    return found != nullptr ? found->value : pattern_fill_type::none;
 }
 
 template<>
@@ -417,7 +425,7 @@ namespace xml {
 template <>
 struct value_traits<xlnt::font::underline_style>
 {
-    static xlnt::font::underline_style parse(std::string underline_string, const parser &)
+    static xlnt::font::underline_style parse(const std::string &underline_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::font::underline_style>(underline_string);
     }
@@ -431,7 +439,7 @@ struct value_traits<xlnt::font::underline_style>
 template <>
 struct value_traits<xlnt::relationship_type>
 {
-    static xlnt::relationship_type parse(std::string relationship_type_string, const parser &)
+    static xlnt::relationship_type parse(const std::string &relationship_type_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::relationship_type>(relationship_type_string);
     }
@@ -445,7 +453,7 @@ struct value_traits<xlnt::relationship_type>
 template <>
 struct value_traits<xlnt::pattern_fill_type>
 {
-    static xlnt::pattern_fill_type parse(std::string fill_type_string, const parser &)
+    static xlnt::pattern_fill_type parse(const std::string &fill_type_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::pattern_fill_type>(fill_type_string);
     }
@@ -459,7 +467,7 @@ struct value_traits<xlnt::pattern_fill_type>
 template <>
 struct value_traits<xlnt::gradient_fill_type>
 {
-    static xlnt::gradient_fill_type parse(std::string fill_type_string, const parser &)
+    static xlnt::gradient_fill_type parse(const std::string &fill_type_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::gradient_fill_type>(fill_type_string);
     }
@@ -473,7 +481,7 @@ struct value_traits<xlnt::gradient_fill_type>
 template <>
 struct value_traits<xlnt::border_style>
 {
-    static xlnt::border_style parse(std::string style_string, const parser &)
+    static xlnt::border_style parse(const std::string &style_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::border_style>(style_string);
     }
@@ -488,7 +496,7 @@ struct value_traits<xlnt::border_style>
 template <>
 struct value_traits<xlnt::vertical_alignment>
 {
-    static xlnt::vertical_alignment parse(std::string alignment_string, const parser &)
+    static xlnt::vertical_alignment parse(const std::string &alignment_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::vertical_alignment>(alignment_string);
     }
@@ -502,7 +510,7 @@ struct value_traits<xlnt::vertical_alignment>
 template <>
 struct value_traits<xlnt::horizontal_alignment>
 {
-    static xlnt::horizontal_alignment parse(std::string alignment_string, const parser &)
+    static xlnt::horizontal_alignment parse(const std::string &alignment_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::horizontal_alignment>(alignment_string);
     }
@@ -516,7 +524,7 @@ struct value_traits<xlnt::horizontal_alignment>
 template <>
 struct value_traits<xlnt::border_side>
 {
-    static xlnt::border_side parse(std::string side_string, const parser &)
+    static xlnt::border_side parse(const std::string &side_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::border_side>(side_string);
     }
@@ -530,7 +538,7 @@ struct value_traits<xlnt::border_side>
 template <>
 struct value_traits<xlnt::target_mode>
 {
-    static xlnt::target_mode parse(std::string mode_string, const parser &)
+    static xlnt::target_mode parse(const std::string &mode_string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::target_mode>(mode_string);
     }
@@ -544,7 +552,7 @@ struct value_traits<xlnt::target_mode>
 template <>
 struct value_traits<xlnt::pane_state>
 {
-    static xlnt::pane_state parse(std::string string, const parser &)
+    static xlnt::pane_state parse(const std::string &string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::pane_state>(string);
     }
@@ -558,7 +566,7 @@ struct value_traits<xlnt::pane_state>
 template <>
 struct value_traits<xlnt::pane_corner>
 {
-    static xlnt::pane_corner parse(std::string string, const parser &)
+    static xlnt::pane_corner parse(const std::string &string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::pane_corner>(string);
     }
@@ -572,7 +580,7 @@ struct value_traits<xlnt::pane_corner>
 template <>
 struct value_traits<xlnt::core_property>
 {
-    static xlnt::core_property parse(std::string string, const parser &)
+    static xlnt::core_property parse(const std::string &string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::core_property>(string);
     }
@@ -586,7 +594,7 @@ struct value_traits<xlnt::core_property>
 template <>
 struct value_traits<xlnt::extended_property>
 {
-    static xlnt::extended_property parse(std::string string, const parser &)
+    static xlnt::extended_property parse(const std::string &string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::extended_property>(string);
     }
@@ -600,7 +608,7 @@ struct value_traits<xlnt::extended_property>
 template <>
 struct value_traits<xlnt::orientation>
 {
-    static xlnt::orientation parse(std::string string, const parser &)
+    static xlnt::orientation parse(const std::string &string, const parser &)
     {
         return xlnt::detail::from_string<xlnt::orientation>(string);
     }
@@ -0,0 +1,503 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/crc32.hpp>
+#include <detail/serialization/deflate_codec.hpp>
+
+#if defined(XLNT_DEFLATE_ISAL)
+#include <isa-l/crc.h>
+#include <isa-l/igzip_lib.h>
+#elif defined(XLNT_DEFLATE_ZLIB_NG)
+#include <zlib-ng.h>
+#define XLNT_ZLIB(name) ::zng_##name
+#define XLNT_ZLIB_STREAM zng_stream
+#elif defined(XLNT_DEFLATE_ZLIB)
+#include <zlib.h>
+#define XLNT_ZLIB(name) ::name
+#define XLNT_ZLIB_STREAM z_stream
+#else
+#include <miniz.h>
+#define XLNT_ZLIB(name) ::name
+#define XLNT_ZLIB_STREAM z_stream
+#endif
+
+namespace {
+
+// The most bytes the implementations take or give in one call.
+const std::size_t max_chunk = std::numeric_limits<std::uint32_t>::max();
+
+#if defined(XLNT_DEFLATE_ISAL)
+
+class isal_inflater : public xlnt::detail::inflater
+{
+public:
+    isal_inflater()
+    {
+        isal_inflate_init(&state_);
+        state_.crc_flag = ISAL_DEFLATE;
+    }
+
+    bool process(const std::uint8_t *&next_in, std::size_t &avail_in,
+        std::uint8_t *&next_out, std::size_t &avail_out) override
+    {
+        const auto in_chunk = static_cast<std::uint32_t>(std::min(avail_in, max_chunk));
+        const auto out_chunk = static_cast<std::uint32_t>(std::min(avail_out, max_chunk));
+
+        state_.next_in = const_cast<std::uint8_t *>(next_in);
+        state_.avail_in = in_chunk;
+        state_.next_out = next_out;
+        state_.avail_out = out_chunk;
+
+        if (isal_inflate(&state_) < 0)
+        {
+            throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+        }
+
+        next_in += in_chunk - state_.avail_in;
+        avail_in -= in_chunk - state_.avail_in;
+        next_out += out_chunk - state_.avail_out;
+        avail_out -= out_chunk - state_.avail_out;
+
+        return state_.block_state == ISAL_BLOCK_FINISH;
+    }
+
+    std::unique_ptr<xlnt::detail::inflater> clone() const override
+    {
+        // back-references may be resolved from the caller's previous output
+        return nullptr;
+    }
+
+    void reset() override
+    {
+        isal_inflate_reset(&state_);
+        state_.crc_flag = ISAL_DEFLATE;
+    }
+
+private:
+    inflate_state state_;
+};
+
+class isal_deflater : public xlnt::detail::deflater
+{
+public:
+    explicit isal_deflater(xlnt::compression_level level)
+    {
+        isal_deflate_init(&stream_);
+        stream_.gzip_flag = IGZIP_DEFLATE;
+        stream_.flush = NO_FLUSH;
+
+        switch (level)
+        {
+        case xlnt::compression_level::fastest:
+            stream_.level = 1;
+            level_buffer_.resize(ISAL_DEF_LVL1_DEFAULT);
+            break;
+        case xlnt::compression_level::best:
+            stream_.level = 3;
+            level_buffer_.resize(ISAL_DEF_LVL3_DEFAULT);
+            break;
+        case xlnt::compression_level::none:
+        case xlnt::compression_level::standard:
+        default:
+            stream_.level = 2;
+            level_buffer_.resize(ISAL_DEF_LVL2_DEFAULT);
+            break;
+        }
+
+        stream_.level_buf = level_buffer_.data();
+        stream_.level_buf_size = static_cast<std::uint32_t>(level_buffer_.size());
+    }
+
+    bool process(const std::uint8_t *&next_in, std::size_t &avail_in,
+        std::uint8_t *&next_out, std::size_t &avail_out, bool finish) override
+    {
+        const auto in_chunk = static_cast<std::uint32_t>(std::min(avail_in, max_chunk));
+        const auto out_chunk = static_cast<std::uint32_t>(std::min(avail_out, max_chunk));
+
+        stream_.next_in = const_cast<std::uint8_t *>(next_in);
+        stream_.avail_in = in_chunk;
+        stream_.next_out = next_out;
+        stream_.avail_out = out_chunk;
+        stream_.end_of_stream = finish && in_chunk == avail_in ? 1 : 0;
+
+        if (isal_deflate(&stream_) != COMP_OK)
+        {
+            throw xlnt::exception("couldn't deflate ZIP member");
+        }
+
+        next_in += in_chunk - stream_.avail_in;
+        avail_in -= in_chunk - stream_.avail_in;
+        next_out += out_chunk - stream_.avail_out;
+        avail_out -= out_chunk - stream_.avail_out;
+
+        return stream_.internal_state.state == ZSTATE_END;
+    }
+
+    bool flush(std::uint8_t *&next_out, std::size_t &avail_out) override
+    {
+        const auto out_chunk = static_cast<std::uint32_t>(std::min(avail_out, max_chunk));
+
+        stream_.next_in = nullptr;
+        stream_.avail_in = 0;
+        stream_.next_out = next_out;
+        stream_.avail_out = out_chunk;
+        stream_.end_of_stream = 0;
+        stream_.flush = FULL_FLUSH;
+
+        const auto result = isal_deflate(&stream_);
+        stream_.flush = NO_FLUSH;
+
+        if (result != COMP_OK)
+        {
+            throw xlnt::exception("couldn't deflate ZIP member");
+        }
+
+        next_out += out_chunk - stream_.avail_out;
+        avail_out -= out_chunk - stream_.avail_out;
+
+        // the flush is complete once it leaves room unused
+        return stream_.avail_out != 0;
+    }
+
+private:
+    isal_zstream stream_;
+    std::vector<std::uint8_t> level_buffer_;
+};
+
+#else
+
+#if !defined(XLNT_DEFLATE_ZLIB) && !defined(XLNT_DEFLATE_ZLIB_NG)
+
+// miniz has no inflateCopy, but the state of its inflater is a single allocation
+// holding no pointers, so it can be copied once the size of that allocation is known.
+// Each allocation is preceded by its size.
+const std::size_t allocation_prefix = sizeof(std::max_align_t);
+
+void *allocate_sized(void * /*opaque*/, std::size_t items, std::size_t size)
+{
+    const auto bytes = items * size;
+    auto block = static_cast<std::uint8_t *>(std::malloc(allocation_prefix + bytes));
+
+    if (block == nullptr) return nullptr;
+
+    std::memcpy(block, &bytes, sizeof(bytes));
+
+    return block + allocation_prefix;
+}
+
+void free_sized(void * /*opaque*/, void *address)
+{
+    if (address != nullptr)
+    {
+        std::free(static_cast<std::uint8_t *>(address) - allocation_prefix);
+    }
+}
+
+void *copy_sized(const void *address)
+{
+    auto bytes = std::size_t(0);
+    std::memcpy(&bytes, static_cast<const std::uint8_t *>(address) - allocation_prefix, sizeof(bytes));
+    auto copy = allocate_sized(nullptr, 1, bytes);
+
+    if (copy != nullptr)
+    {
+        std::memcpy(copy, address, bytes);
+    }
+
+    return copy;
+}
+
+#endif
+
+// miniz, zlib and the native API of zlib-ng share the interface of zlib
+class zlib_inflater : public xlnt::detail::inflater
+{
+public:
+    zlib_inflater()
+    {
+#if defined(XLNT_DEFLATE_ZLIB) || defined(XLNT_DEFLATE_ZLIB_NG)
+        stream_.zalloc = nullptr;
+        stream_.zfree = nullptr;
+#else
+        stream_.zalloc = allocate_sized;
+        stream_.zfree = free_sized;
+#endif
+        stream_.opaque = nullptr;
+        stream_.next_in = nullptr;
+        stream_.avail_in = 0;
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+        if (XLNT_ZLIB(inflateInit2)(&stream_, -MAX_WBITS) != Z_OK)
+#pragma clang diagnostic pop
+        {
+            throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+        }
+    }
+
+    ~zlib_inflater() override
+    {
+        if (initialized_)
+        {
+            XLNT_ZLIB(inflateEnd)(&stream_);
+        }
+    }
+
+    bool process(const std::uint8_t *&next_in, std::size_t &avail_in,
+        std::uint8_t *&next_out, std::size_t &avail_out) override
+    {
+        const auto in_chunk = static_cast<unsigned int>(std::min(avail_in, max_chunk));
+        const auto out_chunk = static_cast<unsigned int>(std::min(avail_out, max_chunk));
+
+        stream_.next_in = const_cast<std::uint8_t *>(next_in);
+        stream_.avail_in = in_chunk;
+        stream_.next_out = next_out;
+        stream_.avail_out = out_chunk;
+
+        const auto result = XLNT_ZLIB(inflate)(&stream_, Z_NO_FLUSH);
+
+        if (result == Z_STREAM_ERROR || result == Z_NEED_DICT || result == Z_DATA_ERROR || result == Z_MEM_ERROR)
+        {
+            throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+        }
+
+        next_in += in_chunk - stream_.avail_in;
+        avail_in -= in_chunk - stream_.avail_in;
+        next_out += out_chunk - stream_.avail_out;
+        avail_out -= out_chunk - stream_.avail_out;
+
+        return result == Z_STREAM_END;
+    }
+
+    std::unique_ptr<xlnt::detail::inflater> clone() const override
+    {
+        std::unique_ptr<zlib_inflater> copy(new zlib_inflater(copy_tag()));
+#if defined(XLNT_DEFLATE_ZLIB) || defined(XLNT_DEFLATE_ZLIB_NG)
+        if (XLNT_ZLIB(inflateCopy)(&copy->stream_, const_cast<XLNT_ZLIB_STREAM *>(&stream_)) != Z_OK)
+        {
+            throw xlnt::exception("couldn't copy the state of the inflater");
+        }
+#else
+        copy->stream_ = stream_;
+        copy->stream_.state = static_cast<decltype(stream_.state)>(copy_sized(stream_.state));
+
+        if (copy->stream_.state == nullptr)
+        {
+            throw xlnt::exception("couldn't copy the state of the inflater");
+        }
+#endif
+        copy->initialized_ = true;
+
+        return std::unique_ptr<xlnt::detail::inflater>(copy.release());
+    }
+
+    void reset() override
+    {
+        if (XLNT_ZLIB(inflateReset)(&stream_) != Z_OK)
+        {
+            throw xlnt::exception("couldn't reset the inflater");
+        }
+    }
+
+private:
+    struct copy_tag
+    {
+    };
+
+    /// <summary>
+    /// Constructs an inflater whose stream clone initializes.
+    /// </summary>
+    explicit zlib_inflater(copy_tag)
+        : initialized_(false)
+    {
+    }
+
+    XLNT_ZLIB_STREAM stream_;
+    bool initialized_ = true;
+};
+
+class zlib_deflater : public xlnt::detail::deflater
+{
+public:
+    explicit zlib_deflater(xlnt::compression_level level)
+    {
+        stream_.zalloc = nullptr;
+        stream_.zfree = nullptr;
+        stream_.opaque = nullptr;
+
+        auto deflate_level = Z_DEFAULT_COMPRESSION;
+
+        if (level == xlnt::compression_level::fastest)
+        {
+            deflate_level = Z_BEST_SPEED;
+        }
+        else if (level == xlnt::compression_level::best)
+        {
+            deflate_level = Z_BEST_COMPRESSION;
+        }
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+        if (XLNT_ZLIB(deflateInit2)(&stream_, deflate_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+#pragma clang diagnostic pop
+        {
+            throw xlnt::exception("couldn't initialize deflate");
+        }
+    }
+
+    ~zlib_deflater() override
+    {
+        XLNT_ZLIB(deflateEnd)(&stream_);
+    }
+
+    bool process(const std::uint8_t *&next_in, std::size_t &avail_in,
+        std::uint8_t *&next_out, std::size_t &avail_out, bool finish) override
+    {
+        const auto in_chunk = static_cast<unsigned int>(std::min(avail_in, max_chunk));
+        const auto out_chunk = static_cast<unsigned int>(std::min(avail_out, max_chunk));
+
+        stream_.next_in = const_cast<std::uint8_t *>(next_in);
+        stream_.avail_in = in_chunk;
+        stream_.next_out = next_out;
+        stream_.avail_out = out_chunk;
+
+        const auto result = XLNT_ZLIB(deflate)(&stream_, finish && in_chunk == avail_in ? Z_FINISH : Z_NO_FLUSH);
+
+        if (result == Z_STREAM_ERROR)
+        {
+            throw xlnt::exception("couldn't deflate ZIP member");
+        }
+
+        next_in += in_chunk - stream_.avail_in;
+        avail_in -= in_chunk - stream_.avail_in;
+        next_out += out_chunk - stream_.avail_out;
+        avail_out -= out_chunk - stream_.avail_out;
+
+        return result == Z_STREAM_END;
+    }
+
+    bool flush(std::uint8_t *&next_out, std::size_t &avail_out) override
+    {
+        const auto out_chunk = static_cast<unsigned int>(std::min(avail_out, max_chunk));
+
+        stream_.next_in = nullptr;
+        stream_.avail_in = 0;
+        stream_.next_out = next_out;
+        stream_.avail_out = out_chunk;
+
+        const auto result = XLNT_ZLIB(deflate)(&stream_, Z_FULL_FLUSH);
+
+        // Z_BUF_ERROR only means that a finished flush had nothing left to write
+        if (result == Z_STREAM_ERROR)
+        {
+            throw xlnt::exception("couldn't deflate ZIP member");
+        }
+
+        next_out += out_chunk - stream_.avail_out;
+        avail_out -= out_chunk - stream_.avail_out;
+
+        // the flush is complete once it leaves room unused
+        return stream_.avail_out != 0;
+    }
+
+private:
+    XLNT_ZLIB_STREAM stream_;
+};
+
+#endif
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+inflater::~inflater()
+{
+}
+
+deflater::~deflater()
+{
+}
+
+std::unique_ptr<inflater> make_inflater()
+{
+#if defined(XLNT_DEFLATE_ISAL)
+    return std::unique_ptr<inflater>(new isal_inflater());
+#else
+    return std::unique_ptr<inflater>(new zlib_inflater());
+#endif
+}
+
+std::unique_ptr<deflater> make_deflater(compression_level level)
+{
+#if defined(XLNT_DEFLATE_ISAL)
+    return std::unique_ptr<deflater>(new isal_deflater(level));
+#else
+    return std::unique_ptr<deflater>(new zlib_deflater(level));
+#endif
+}
+
+std::uint32_t update_crc32(std::uint32_t crc, const std::uint8_t *data, std::size_t size)
+{
+#if defined(XLNT_DEFLATE_ISAL)
+    return crc32_gzip_refl(crc, data, size);
+#elif !defined(XLNT_DEFLATE_ZLIB_NG)
+    // the CRC-32 of miniz is byte by byte and that of zlib doesn't use the processor's
+    // instructions, zlib-ng and isa-l have their own accelerated ones
+    return compute_crc32(crc, data, size);
+#else
+    while (size > 0)
+    {
+        const auto chunk = static_cast<unsigned int>(std::min(size, max_chunk));
+        crc = static_cast<std::uint32_t>(XLNT_ZLIB(crc32)(crc, data, chunk));
+        data += chunk;
+        size -= chunk;
+    }
+
+    return crc;
+#endif
+}
+
+const char *deflate_backend()
+{
+#if defined(XLNT_DEFLATE_ISAL)
+    return "isa-l";
+#elif defined(XLNT_DEFLATE_ZLIB_NG)
+    return "zlib-ng";
+#elif defined(XLNT_DEFLATE_ZLIB)
+    return "zlib";
+#else
+    return "miniz";
+#endif
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,118 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <xlnt/workbook/save_options.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Decompresses a raw deflate stream, as stored in the members of a ZIP archive, piece by piece.
+/// The implementation is chosen when building xlnt, see XLNT_DEFLATE_BACKEND.
+/// </summary>
+class XLNT_API_INTERNAL inflater
+{
+public:
+    virtual ~inflater();
+
+    /// <summary>
+    /// Inflates from the avail_in bytes at next_in into the avail_out bytes at next_out and
+    /// advances both past the bytes consumed and produced. Returns true once the end of the
+    /// stream has been reached. Throws xlnt::exception if the data is corrupt.
+    /// </summary>
+    virtual bool process(const std::uint8_t *&next_in, std::size_t &avail_in,
+        std::uint8_t *&next_out, std::size_t &avail_out) = 0;
+
+    /// <summary>
+    /// Returns an inflater which continues from the current state of this one independently
+    /// of it, including the window of recent output back-references are resolved from.
+    /// Returns nullptr if the implementation can't copy its state.
+    /// </summary>
+    virtual std::unique_ptr<inflater> clone() const = 0;
+
+    /// <summary>
+    /// Returns the inflater to the start of a new stream, keeping the state and window
+    /// it has allocated so that it can inflate another member.
+    /// </summary>
+    virtual void reset() = 0;
+};
+
+/// <summary>
+/// Compresses data into a raw deflate stream piece by piece.
+/// The implementation is chosen when building xlnt, see XLNT_DEFLATE_BACKEND.
+/// </summary>
+class XLNT_API_INTERNAL deflater
+{
+public:
+    virtual ~deflater();
+
+    /// <summary>
+    /// Deflates from the avail_in bytes at next_in into the avail_out bytes at next_out and
+    /// advances both past the bytes consumed and produced. finish is true once all input has
+    /// been given, after which this returns true when the end of the stream has been written.
+    /// Throws xlnt::exception if compression fails.
+    /// </summary>
+    virtual bool process(const std::uint8_t *&next_in, std::size_t &avail_in,
+        std::uint8_t *&next_out, std::size_t &avail_out, bool finish) = 0;
+
+    /// <summary>
+    /// Writes the blocks of all input given to process so far into the avail_out bytes at
+    /// next_out, advancing it, and ends them with an empty stored block so that the output
+    /// stops at a byte boundary, as a full flush does. Returns true once all of it has been
+    /// written; otherwise this is to be called again with more room. Later blocks don't refer
+    /// back to data before the flush.
+    /// </summary>
+    virtual bool flush(std::uint8_t *&next_out, std::size_t &avail_out) = 0;
+};
+
+/// <summary>
+/// Returns a new inflater of the configured implementation.
+/// </summary>
+XLNT_API_INTERNAL std::unique_ptr<inflater> make_inflater();
+
+/// <summary>
+/// Returns a new deflater of the configured implementation compressing as given by level,
+/// which mustn't be compression_level::none since that stores data without deflating it.
+/// </summary>
+XLNT_API_INTERNAL std::unique_ptr<deflater> make_deflater(compression_level level);
+
+/// <summary>
+/// Returns the CRC-32 of the size bytes at data continuing from crc, the CRC-32 of the
+/// data before them or 0 if there is none.
+/// </summary>
+XLNT_API_INTERNAL std::uint32_t update_crc32(std::uint32_t crc, const std::uint8_t *data, std::size_t size);
+
+/// <summary>
+/// Returns the name of the configured deflate implementation: "miniz", "zlib", "zlib-ng" or "isa-l".
+/// </summary>
+XLNT_API_INTERNAL const char *deflate_backend();
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,212 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <detail/serialization/deflate_codec.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Keeps the inflaters and buffers of archive members which have been read so that the
+/// next member, or the next archive read through the same xlnt::loader, takes them over
+/// instead of allocating its own. Members may be finished on the worker threads of a
+/// load, so taking and giving back are serialised.
+/// </summary>
+class load_buffers
+{
+public:
+    /// <summary>
+    /// The most inflaters and buffers of each kind which are kept.
+    /// </summary>
+    static const std::size_t max_spares = 8;
+
+    /// <summary>
+    /// Returns a kept inflater reset to the start of a stream, or a new one.
+    /// </summary>
+    std::unique_ptr<inflater> take_inflater()
+    {
+        std::unique_ptr<inflater> spare;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (!inflaters_.empty())
+            {
+                spare = std::move(inflaters_.back());
+                inflaters_.pop_back();
+            }
+        }
+
+        if (!spare)
+        {
+            return make_inflater();
+        }
+
+        spare->reset();
+
+        return spare;
+    }
+
+    /// <summary>
+    /// Returns a buffer of size elements, reusing a kept one if there is any. The contents
+    /// of a reused buffer are left as they were.
+    /// </summary>
+    std::vector<char> take_chars(std::size_t size)
+    {
+        return take(chars_, size);
+    }
+
+    std::vector<std::uint8_t> take_bytes(std::size_t size)
+    {
+        return take(bytes_, size);
+    }
+
+    /// <summary>
+    /// Keeps spare for a later take unless max_spares are kept already.
+    /// </summary>
+    void give_back(std::unique_ptr<inflater> spare)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (spare && inflaters_.size() < max_spares)
+        {
+            inflaters_.push_back(std::move(spare));
+        }
+    }
+
+    void give_back(std::vector<char> &&spare)
+    {
+        keep(chars_, std::move(spare));
+    }
+
+    void give_back(std::vector<std::uint8_t> &&spare)
+    {
+        keep(bytes_, std::move(spare));
+    }
+
+    /// <summary>
+    /// Returns the number of bytes allocated by the kept buffers, not counting the inflaters.
+    /// </summary>
+    std::size_t retained_bytes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto bytes = std::size_t(0);
+
+        for (const auto &spare : chars_)
+        {
+            bytes += spare.capacity();
+        }
+
+        for (const auto &spare : bytes_)
+        {
+            bytes += spare.capacity();
+        }
+
+        return bytes;
+    }
+
+    /// <summary>
+    /// Returns the number of kept inflaters.
+    /// </summary>
+    std::size_t retained_inflaters() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inflaters_.size();
+    }
+
+    /// <summary>
+    /// Frees everything which is kept.
+    /// </summary>
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inflaters_.clear();
+        chars_.clear();
+        bytes_.clear();
+    }
+
+private:
+    /// <summary>
+    /// Takes the smallest kept buffer holding size elements without growing, or failing
+    /// that the largest one, and resizes it to size.
+    /// </summary>
+    template <typename T>
+    std::vector<T> take(std::vector<std::vector<T>> &spares, std::size_t size)
+    {
+        std::vector<T> spare;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto best = spares.end();
+
+            for (auto candidate = spares.begin(); candidate != spares.end(); ++candidate)
+            {
+                const auto fits = candidate->capacity() >= size;
+
+                if (best == spares.end()
+                    || (fits && (best->capacity() < size || candidate->capacity() < best->capacity()))
+                    || (!fits && best->capacity() < candidate->capacity()))
+                {
+                    best = candidate;
+                }
+            }
+
+            if (best != spares.end())
+            {
+                spare = std::move(*best);
+                spares.erase(best);
+            }
+        }
+
+        spare.resize(size);
+
+        return spare;
+    }
+
+    template <typename T>
+    void keep(std::vector<std::vector<T>> &spares, std::vector<T> &&spare)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (spare.capacity() != 0 && spares.size() < max_spares)
+        {
+            spares.push_back(std::move(spare));
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<inflater>> inflaters_;
+    std::vector<std::vector<char>> chars_;
+    std::vector<std::vector<std::uint8_t>> bytes_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,112 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <string>
+#include <system_error>
+
+#include <detail/serialization/parsers.hpp>
+
+namespace xml {
+
+/// <summary>
+/// Parses numeric attributes and element text like default_value_traits, but with
+/// xlnt::detail::parse instead of a std::istringstream, which copies the value, allocates
+/// a stream for every number and depends on the global locale.
+/// </summary>
+template <typename T>
+struct number_value_traits
+{
+    static T parse(const std::string &value, const parser &p)
+    {
+        auto result = T();
+        std::size_t parsed = 0;
+
+        // leading white space is skipped by detail::parse and trailing white space is allowed
+        if (xlnt::detail::parse(value, result, &parsed) != std::errc()
+            || value.find_first_not_of(" \t\r\n", parsed) != std::string::npos)
+        {
+            throw parsing(p, "invalid value '" + value + "'");
+        }
+
+        return result;
+    }
+
+    static std::string serialize(const T &value, const serializer &s)
+    {
+        return default_value_traits<T>::serialize(value, s);
+    }
+};
+
+template <>
+struct value_traits<short> : number_value_traits<short>
+{
+};
+
+template <>
+struct value_traits<unsigned short> : number_value_traits<unsigned short>
+{
+};
+
+template <>
+struct value_traits<int> : number_value_traits<int>
+{
+};
+
+template <>
+struct value_traits<unsigned int> : number_value_traits<unsigned int>
+{
+};
+
+template <>
+struct value_traits<long> : number_value_traits<long>
+{
+};
+
+template <>
+struct value_traits<unsigned long> : number_value_traits<unsigned long>
+{
+};
+
+template <>
+struct value_traits<long long> : number_value_traits<long long>
+{
+};
+
+template <>
+struct value_traits<unsigned long long> : number_value_traits<unsigned long long>
+{
+};
+
+template <>
+struct value_traits<float> : number_value_traits<float>
+{
+};
+
+template <>
+struct value_traits<double> : number_value_traits<double>
+{
+};
+
+} // namespace xml
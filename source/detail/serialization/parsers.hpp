@@ -82,6 +82,17 @@ std::errc parse(const std::string &string, T &result, std::size_t *num_character
     return parsing_result.ec;
 }
 
+template <typename T, typename std::enable_if<fast_float::is_supported_integer_type<T>::value, bool>::type = true>
+std::errc parse(const char *first, const char *last, T &result, int base = 10)
+{
+    fast_float::parse_options options {
+        internal::FAST_FLOAT_FORMAT,
+        '.',
+        base
+    };
+
+    return fast_float::from_chars_int_advanced(first, last, result, options).ec;
+}
 
 /// ----- FLOATING-POINT NUMBER PARSING -----
 
@@ -121,5 +132,16 @@ std::errc parse(const std::string &string, T &result, std::size_t *num_character
     return parsing_result.ec;
 }
 
+template <typename T, typename std::enable_if<fast_float::is_supported_float_type<T>::value, bool>::type = true>
+std::errc parse(const char *first, const char *last, T &result, char decimal_separator = '.')
+{
+    fast_float::parse_options options {
+        internal::FAST_FLOAT_FORMAT,
+        decimal_separator
+    };
+
+    return fast_float::from_chars_float_advanced(first, last, result, options).ec;
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -0,0 +1,117 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+
+#include <detail/serialization/read_ahead_streambuf.hpp>
+
+namespace xlnt {
+namespace detail {
+
+read_ahead_streambuf::read_ahead_streambuf(std::unique_ptr<std::streambuf> source, std::size_t block_size,
+    std::size_t block_count)
+    : source_(std::move(source)),
+      block_size_(std::max<std::size_t>(block_size, 1)),
+      filled_(std::max<std::size_t>(block_count, 1)),
+      empty_(std::max<std::size_t>(block_count, 1))
+{
+    for (std::size_t i = 0; i < std::max<std::size_t>(block_count, 1); ++i)
+    {
+        empty_.push(std::vector<char>());
+    }
+
+    setg(nullptr, nullptr, nullptr);
+    reader_ = std::thread(&read_ahead_streambuf::read_source, this);
+}
+
+read_ahead_streambuf::~read_ahead_streambuf()
+{
+    filled_.close();
+    empty_.close();
+    reader_.join();
+}
+
+void read_ahead_streambuf::read_source()
+{
+    try
+    {
+        std::vector<char> block;
+
+        while (empty_.pop(block))
+        {
+            block.resize(block_size_);
+            const auto read = source_->sgetn(block.data(), static_cast<std::streamsize>(block_size_));
+
+            if (read <= 0)
+            {
+                break;
+            }
+
+            block.resize(static_cast<std::size_t>(read));
+
+            if (!filled_.push(std::move(block)))
+            {
+                break;
+            }
+        }
+    }
+    catch (...)
+    {
+        error_ = std::current_exception();
+    }
+
+    filled_.close();
+}
+
+read_ahead_streambuf::int_type read_ahead_streambuf::underflow()
+{
+    if (gptr() != nullptr && gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    if (current_.capacity() != 0)
+    {
+        empty_.push(std::move(current_));
+        current_ = std::vector<char>();
+    }
+
+    setg(nullptr, nullptr, nullptr);
+
+    if (!filled_.pop(current_))
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+
+        return traits_type::eof();
+    }
+
+    setg(current_.data(), current_.data(), current_.data() + current_.size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,95 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <detail/utils/spsc_queue.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// An istreambuf which reads another streambuf, such as that of a deflated archive member,
+/// on a thread of its own into a ring of block_count blocks of block_size bytes. This lets
+/// the member be inflated while the blocks before it are being parsed. An exception thrown
+/// while reading the source is thrown again once the blocks before it have been read.
+/// </summary>
+class XLNT_API_INTERNAL read_ahead_streambuf : public std::streambuf
+{
+public:
+    using int_type = std::streambuf::int_type;
+
+    static const std::size_t default_block_count = 4;
+
+    read_ahead_streambuf(std::unique_ptr<std::streambuf> source, std::size_t block_size,
+        std::size_t block_count = default_block_count);
+
+    /// <summary>
+    /// Stops the reading thread, which finishes the block it's reading first.
+    /// </summary>
+    ~read_ahead_streambuf() override;
+
+    read_ahead_streambuf(const read_ahead_streambuf &) = delete;
+    read_ahead_streambuf &operator=(const read_ahead_streambuf &) = delete;
+
+private:
+    int_type underflow() override;
+
+    /// <summary>
+    /// Fills the empty blocks from source_ and hands them on until the source ends.
+    /// </summary>
+    void read_source();
+
+    std::unique_ptr<std::streambuf> source_;
+    std::size_t block_size_;
+
+    /// <summary>
+    /// The blocks read from the source, in order, and the blocks which have been
+    /// consumed and can be filled again.
+    /// </summary>
+    spsc_queue<std::vector<char>> filled_;
+    spsc_queue<std::vector<char>> empty_;
+
+    /// <summary>
+    /// The block the get area is in.
+    /// </summary>
+    std::vector<char> current_;
+
+    /// <summary>
+    /// What reading the source threw, set before filled_ is closed.
+    /// </summary>
+    std::exception_ptr error_;
+
+    std::thread reader_;
+};
+
+} // namespace detail
+} // namespace xlnt
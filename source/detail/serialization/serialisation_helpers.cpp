@@ -12,7 +12,22 @@ namespace detail {
 
 std::string serialise(double d)
 {
-    return fmt::format("{}", d);
+    char buffer[serialised_double_capacity];
+    return std::string(buffer, serialise_to(buffer, d));
+}
+
+std::size_t serialise_to(char *buffer, double d)
+{
+    const auto result = fmt::format_to_n(buffer, serialised_double_capacity, "{}", d);
+    assert(result.size <= serialised_double_capacity);
+
+    return static_cast<std::size_t>(result.out - buffer);
+}
+
+std::size_t serialise_to(char *buffer, std::int64_t i)
+{
+    const auto result = fmt::format_to_n(buffer, serialised_double_capacity, "{}", i);
+    return static_cast<std::size_t>(result.out - buffer);
 }
 
 double deserialise(const std::string &s, size_t *len_converted)
@@ -31,5 +46,38 @@ double deserialise(const char *s, const char **end)
     return d;
 }
 
+double deserialise(const char *s, std::size_t length)
+{
+    assert(s != nullptr);
+    double d = std::numeric_limits<double>::quiet_NaN();
+    detail::parse(s, s + length, d);
+    return d;
+}
+
+bool deserialise_exactly(const char *s, std::size_t length, double &d)
+{
+    assert(s != nullptr);
+    const fast_float::parse_options options{internal::FAST_FLOAT_FORMAT, '.'};
+    const auto result = fast_float::from_chars_float_advanced(s, s + length, d, options);
+    return length > 0 && result.ec == std::errc() && result.ptr == s + length;
+}
+
+void deserialise_numbers(const Sheet_Data &data, std::vector<double> &numbers)
+{
+    numbers.assign(data.parsed_cells.size(), 0.0);
+    auto number = numbers.begin();
+
+    for (const auto &parsed : data.parsed_cells)
+    {
+        if (!parsed.value.empty()
+            && (parsed.type == cell_type::number || parsed.type == cell_type::date || parsed.type == cell_type::empty))
+        {
+            *number = deserialise(data.data(parsed.value), parsed.value.length);
+        }
+
+        ++number;
+    }
+}
+
 } // namespace detail
 } // namespace xlnt
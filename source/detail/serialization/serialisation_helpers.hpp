@@ -3,9 +3,16 @@
 
 #include <xlnt/cell/cell_type.hpp>
 #include <xlnt/cell/index_types.hpp>
+#include <xlnt/worksheet/row_properties.hpp>
 #include <detail/xlnt_config_impl.hpp>
+#include <detail/utils/reference_decoding.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace xlnt {
 namespace detail {
@@ -34,24 +41,7 @@ struct Cell_Reference
     explicit Cell_Reference(xlnt::row_t row_arg, const std::string &reference) noexcept
         : row(row_arg)
     {
-        // only three characters allowed for the column
-        // assumption:
-        // - regex pattern match: [A-Z]{1,3}\d{1,7}
-        const char *iter = reference.c_str();
-        int temp = *iter - 'A' + 1; // 'A' == 1
-        ++iter;
-        if (*iter >= 'A') // second char
-        {
-            temp *= 26; // LHS values are more significant
-            temp += *iter - 'A' + 1; // 'A' == 1
-            ++iter;
-            if (*iter >= 'A') // third char
-            {
-                temp *= 26; // LHS values are more significant
-                temp += *iter - 'A' + 1; // 'A' == 1
-            }
-        }
-        column = static_cast<xlnt::column_t::index_t>(temp);
+        decode_column_letters(reference.data(), reference.data() + reference.size(), column);
     }
 
     // for sorting purposes
@@ -74,6 +64,19 @@ struct Cell_Reference
     xlnt::column_t::index_t column; // range:["A", "ZZZ"] -> [1, 26^3] -> [1, 17576]
 };
 
+// a string stored in the text arena of the Sheet_Data batch the cell belongs to
+// cells are staged by the thousand, so individually allocated strings are avoided
+struct Text_Ref
+{
+    bool empty() const
+    {
+        return length == 0;
+    }
+
+    std::size_t offset = 0;
+    std::size_t length = 0;
+};
+
 // <c> inside <row> element
 // https://docs.microsoft.com/en-us/dotnet/api/documentformat.openxml.spreadsheet.cell?view=openxml-2.8.1
 struct Cell
@@ -89,14 +92,111 @@ struct Cell
     int cell_metadata_idx = -1; // 'cm'
     int style_index = -1; // 's'
     Cell_Reference ref{0, 0}; // 'r'
-    std::string value; // <v> OR <is>
-    std::string formula_string; // <f>
+    Text_Ref value; // <v> OR <is>
+    Text_Ref formula_string; // <f>
+    int shared_index = -1; // <f t="shared" si>, only the master cell has formula_string set
+};
+
+// the rows and columns whose cells are read, see load_options::rows and load_options::columns
+struct Cell_Projection
+{
+    bool contains_row(xlnt::row_t row) const
+    {
+        return row >= first_row && row <= last_row;
+    }
+
+    bool contains(const Cell_Reference &ref) const
+    {
+        return contains_row(ref.row) && ref.column >= first_column && ref.column <= last_column;
+    }
+
+    xlnt::row_t first_row = 0;
+    xlnt::row_t last_row = std::numeric_limits<xlnt::row_t>::max();
+    xlnt::column_t::index_t first_column = 0;
+    xlnt::column_t::index_t last_column = std::numeric_limits<xlnt::column_t::index_t>::max();
+};
+
+// <sheetData> element, or a batch of its rows
+struct Sheet_Data
+{
+    // returns the arena to append the characters of ref to, moving ref to its end if
+    // something else has been appended since. end_append must be called afterwards.
+    std::string &begin_append(Text_Ref &ref)
+    {
+        if (ref.empty())
+        {
+            ref.offset = text.size();
+        }
+        else if (ref.offset + ref.length != text.size())
+        {
+            const auto existing = text.substr(ref.offset, ref.length);
+            ref.offset = text.size();
+            text.append(existing);
+        }
+
+        return text;
+    }
+
+    void end_append(Text_Ref &ref)
+    {
+        ref.length = text.size() - ref.offset;
+    }
+
+    void append(Text_Ref &ref, const std::string &characters)
+    {
+        begin_append(ref).append(characters);
+        end_append(ref);
+    }
+
+    void assign(Text_Ref &ref, const std::string &characters)
+    {
+        ref = Text_Ref();
+        append(ref, characters);
+    }
+
+    const char *data(const Text_Ref &ref) const
+    {
+        return text.data() + ref.offset;
+    }
+
+    std::string str(const Text_Ref &ref) const
+    {
+        return text.substr(ref.offset, ref.length);
+    }
+
+    // empties the batch but keeps its memory for the next one
+    void clear()
+    {
+        parsed_rows.clear();
+        parsed_cells.clear();
+        skipped_shared_formulae.clear();
+        text.clear();
+    }
+
+    std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> parsed_rows;
+    std::vector<xlnt::detail::Cell> parsed_cells;
+    // master cells of shared formulae outside the Cell_Projection, only kept for the formula text
+    std::vector<xlnt::detail::Cell> skipped_shared_formulae;
+    std::string text; // the characters of all Text_Refs of parsed_cells and skipped_shared_formulae
 };
 
 // for printing to file.
 // This matches the output format of excel irrespective of current locale
 XLNT_API_INTERNAL std::string serialise(double d);
 
+// The number of characters serialise_to may write, which is more than the longest
+// shortest round-trip representation of any double.
+const std::size_t serialised_double_capacity = 32;
+
+// Writes d into buffer exactly as serialise(d) would return it without allocating and
+// returns the number of characters written. buffer must have room for at least
+// serialised_double_capacity characters.
+XLNT_API_INTERNAL std::size_t serialise_to(char *buffer, double d);
+
+// Writes the decimal digits of i into buffer and returns the number of characters
+// written, which is at most serialised_double_capacity.
+XLNT_API_INTERNAL std::size_t serialise_to(char *buffer, std::int64_t i);
+
 // Parses a string to a double-precision floating-point number. Optionally, num_characters_parsed can point
 // to a variable where the number of parsed characters will be stored.
 XLNT_API_INTERNAL double deserialise(const std::string &s, size_t *num_characters_parsed = nullptr);
@@ -105,6 +205,20 @@ XLNT_API_INTERNAL double deserialise(const std::string &s, size_t *num_character
 // to a pointer where the character after the last successfully parsed character will be stored.
 XLNT_API_INTERNAL double deserialise(const char *s, const char **end = nullptr);
 
+// Parses the length characters at s, which need not be null-terminated, to a
+// double-precision floating-point number.
+XLNT_API_INTERNAL double deserialise(const char *s, std::size_t length);
+
+// Parses the length characters at s into d and returns true if all of them make up the
+// number, as cell::value with type inference requires of a number.
+XLNT_API_INTERNAL bool deserialise_exactly(const char *s, std::size_t length, double &d);
+
+// Parses the values of all parsed cells of data which hold numbers, that is number and
+// date cells and cells with a value but no type, in one tight pass over the batch rather
+// than interleaved with building the cells. numbers gets one entry per parsed cell, in
+// order, which is 0 for the other cells.
+XLNT_API_INTERNAL void deserialise_numbers(const Sheet_Data &data, std::vector<double> &numbers);
+
 } // namespace detail
 } // namespace xlnt
 #endif
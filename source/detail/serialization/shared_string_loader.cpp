@@ -0,0 +1,235 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <sstream>
+
+#include <xlnt/workbook/workbook.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+#include <detail/serialization/xlsx_consumer.hpp>
+#include <detail/utils/heap_size.hpp>
+
+namespace xlnt {
+namespace detail {
+
+shared_string_loader::shared_string_loader(std::string &&part, std::size_t root_begin, std::size_t root_end,
+    std::vector<std::size_t> &&offsets)
+    : part_(std::move(part)),
+      root_start_(part_, root_begin, root_end - root_begin),
+      offsets_(std::move(offsets))
+{
+    // the start tag keeps the namespace declarations the si elements may rely on
+    const auto name_end = root_start_.find_first_of(" \t\r\n/>", 1);
+    root_end_ = "</" + root_start_.substr(1, name_end - 1) + ">";
+}
+
+std::size_t shared_string_loader::size() const
+{
+    return offsets_.size() - 1;
+}
+
+const std::string &shared_string_loader::part() const
+{
+    return part_;
+}
+
+std::size_t shared_string_loader::memory_usage() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto usage = sizeof(shared_string_loader) + heap_size(part_) + heap_size(root_start_) + heap_size(root_end_)
+        + heap_size(offsets_) + heap_size(decoded_);
+
+    for (const auto &decoded : decoded_)
+    {
+        usage += decoded.second.memory_usage();
+    }
+
+    return usage;
+}
+
+const rich_text &shared_string_loader::get(workbook &wb, std::size_t index)
+{
+    if (!wb.d_->shared_strings_pending_.load(std::memory_order_acquire))
+    {
+        return wb.shared_strings(index);
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(wb.d_->lazy_load_mutex_);
+
+    if (!wb.d_->shared_strings_loader_)
+    {
+        return wb.shared_strings(index);
+    }
+
+    auto &loader = *wb.d_->shared_strings_loader_;
+
+    if (index >= loader.size())
+    {
+        static rich_text empty;
+        return empty;
+    }
+
+    std::lock_guard<std::mutex> decoding(loader.mutex_);
+    auto decoded = loader.decoded_.find(index);
+
+    if (decoded == loader.decoded_.end())
+    {
+        decoded = loader.decoded_.emplace(index, loader.decode(wb, index)).first;
+    }
+
+    return decoded->second;
+}
+
+std::string shared_string_loader::plain_text(workbook &wb, std::size_t index)
+{
+    if (!wb.d_->shared_strings_pending_.load(std::memory_order_acquire))
+    {
+        return wb.shared_strings(index).plain_text();
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(wb.d_->lazy_load_mutex_);
+
+    if (!wb.d_->shared_strings_loader_)
+    {
+        return wb.shared_strings(index).plain_text();
+    }
+
+    const auto &loader = *wb.d_->shared_strings_loader_;
+    auto undecoded = index < loader.size();
+
+    if (undecoded)
+    {
+        std::lock_guard<std::mutex> decoding(loader.mutex_);
+        undecoded = loader.decoded_.find(index) == loader.decoded_.end();
+    }
+
+    if (undecoded)
+    {
+        const auto begin = loader.part_.data() + loader.offsets_[index];
+        const auto end = loader.part_.data() + loader.offsets_[index + 1];
+        auto text = std::string();
+        auto preserve_space = false;
+
+        if (read_plain_shared_string(begin, end, text, preserve_space))
+        {
+            return text;
+        }
+    }
+
+    return get(wb, index).plain_text();
+}
+
+std::size_t shared_string_loader::count(workbook &wb)
+{
+    if (wb.d_->shared_strings_pending_.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::recursive_mutex> lock(wb.d_->lazy_load_mutex_);
+
+        if (wb.d_->shared_strings_loader_)
+        {
+            return wb.d_->shared_strings_loader_->size();
+        }
+    }
+
+    return wb.d_->shared_strings_values_.size();
+}
+
+void shared_string_loader::load_all(workbook &wb)
+{
+    if (!wb.d_->shared_strings_pending_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(wb.d_->lazy_load_mutex_);
+
+    if (!wb.d_->shared_strings_loader_)
+    {
+        return;
+    }
+
+    // Strings returned by get may still be used by other threads reading the workbook,
+    // so they are copied and the loader is kept until the workbook is modified. Only
+    // the part, which nothing reads anymore, is released.
+    auto loader = std::move(wb.d_->shared_strings_loader_);
+    wb.d_->shared_strings_loader_.reset();
+
+    auto &values = wb.d_->shared_strings_values_;
+    auto &ids = wb.d_->shared_strings_ids_;
+    values.clear();
+    ids.clear();
+    values.reserve(loader->size());
+    ids.reserve(loader->size());
+
+    std::lock_guard<std::mutex> decoding(loader->mutex_);
+
+    for (std::size_t index = 0; index < loader->size(); ++index)
+    {
+        auto decoded = loader->decoded_.find(index);
+
+        if (decoded == loader->decoded_.end())
+        {
+            values.push_back(loader->decode(wb, index));
+        }
+        else
+        {
+            values.push_back(decoded->second);
+        }
+
+        ids[values.back()] = index;
+    }
+
+    if (loader.use_count() == 1)
+    {
+        // no copy of the workbook shares the loader, so nothing decodes from it anymore
+        std::string().swap(loader->part_);
+    }
+
+    wb.d_->retired_shared_strings_loader_ = std::move(loader);
+    wb.d_->shared_strings_pending_.store(false, std::memory_order_release);
+}
+
+rich_text shared_string_loader::decode(workbook &wb, std::size_t index) const
+{
+    const auto begin = part_.data() + offsets_[index];
+    const auto end = part_.data() + offsets_[index + 1];
+    auto text = std::string();
+    auto preserve_space = false;
+
+    if (read_plain_shared_string(begin, end, text, preserve_space))
+    {
+        rich_text result;
+        result.plain_text(text, preserve_space);
+
+        return result;
+    }
+
+    std::istringstream document(root_start_ + std::string(begin, end) + root_end_);
+    xlsx_consumer consumer(wb);
+
+    return consumer.read_shared_string(document);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,114 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/cell/rich_text.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+
+class workbook;
+
+namespace detail {
+
+/// <summary>
+/// Holds the shared string table of a workbook loaded with load_options::lazy_shared_strings.
+/// It keeps the bytes of the part and the offset of each si element, and decodes a string
+/// only when it is asked for. The workbook's own table and its lookup map are only built
+/// once the workbook needs them, e.g. when a shared string is added or the workbook is saved.
+/// </summary>
+class XLNT_API_INTERNAL shared_string_loader
+{
+public:
+    /// <summary>
+    /// Takes over the shared string table part, indexed as by index_shared_strings.
+    /// </summary>
+    shared_string_loader(std::string &&part, std::size_t root_begin, std::size_t root_end,
+        std::vector<std::size_t> &&offsets);
+
+    shared_string_loader(const shared_string_loader &) = delete;
+    shared_string_loader &operator=(const shared_string_loader &) = delete;
+
+    /// <summary>
+    /// Returns the number of strings in the table.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Returns the approximate number of bytes held by the loader, i.e. the part and
+    /// the strings decoded from it so far.
+    /// </summary>
+    std::size_t memory_usage() const;
+
+    /// <summary>
+    /// Returns the shared string table part the loader was constructed from.
+    /// </summary>
+    const std::string &part() const;
+
+    /// <summary>
+    /// Returns the shared string at index of wb, decoding and keeping it on first access
+    /// if the table of wb is still held by a loader.
+    /// </summary>
+    static const rich_text &get(workbook &wb, std::size_t index);
+
+    /// <summary>
+    /// Returns the plain text of the shared string at index of wb. Strings made of a
+    /// single text element are decoded directly from the part every time without being kept.
+    /// </summary>
+    static std::string plain_text(workbook &wb, std::size_t index);
+
+    /// <summary>
+    /// Returns the number of shared strings of wb without decoding them.
+    /// </summary>
+    static std::size_t count(workbook &wb);
+
+    /// <summary>
+    /// Decodes every string of wb into its shared string table, builds the lookup map
+    /// and detaches the loader. Does nothing if wb isn't held by a loader.
+    /// </summary>
+    static void load_all(workbook &wb);
+
+private:
+    rich_text decode(workbook &wb, std::size_t index) const;
+
+    std::string part_;
+    std::string root_start_;
+    std::string root_end_;
+    std::vector<std::size_t> offsets_;
+    std::unordered_map<std::size_t, rich_text> decoded_;
+
+    /// <summary>
+    /// Guards decoded_, which copies of a workbook share along with the loader.
+    /// </summary>
+    mutable std::mutex mutex_;
+};
+
+} // namespace detail
+} // namespace xlnt
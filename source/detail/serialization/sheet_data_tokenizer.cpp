@@ -0,0 +1,947 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cstring>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+
+namespace {
+
+using xlnt::detail::Cell_Projection;
+using xlnt::detail::Cell;
+using xlnt::detail::Sheet_Data;
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+template <std::size_t N>
+bool equals(const char *begin, const char *end, const char (&literal)[N])
+{
+    return static_cast<std::size_t>(end - begin) == N - 1 && std::memcmp(begin, literal, N - 1) == 0;
+}
+
+template <std::size_t N>
+bool starts_with(const char *begin, const char *end, const char (&literal)[N])
+{
+    return static_cast<std::size_t>(end - begin) >= N - 1 && std::memcmp(begin, literal, N - 1) == 0;
+}
+
+template <std::size_t N>
+const char *find(const char *begin, const char *end, const char (&literal)[N])
+{
+    return std::search(begin, end, literal, literal + N - 1);
+}
+
+bool is_true(const char *begin, const char *end)
+{
+    return equals(begin, end, "1") || equals(begin, end, "true");
+}
+
+// Parses an optionally signed decimal integer spanning exactly [begin, end).
+template <typename T>
+bool parse_integer(const char *begin, const char *end, T &result)
+{
+    const auto negative = begin != end && *begin == '-';
+    if (begin != end && (*begin == '-' || *begin == '+')) ++begin;
+    if (begin == end) return false;
+
+    T value = 0;
+
+    for (; begin != end; ++begin)
+    {
+        if (*begin < '0' || *begin > '9') return false;
+        value = static_cast<T>(value * 10 + (*begin - '0'));
+    }
+
+    result = negative ? static_cast<T>(0 - value) : value;
+
+    return true;
+}
+
+void append_utf8(std::string &out, unsigned long code_point)
+{
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+// Appends the character data [begin, end) to out, replacing entity and character
+// references and normalizing line breaks as an XML parser would. In attribute values,
+// literal whitespace is additionally replaced by spaces.
+void append_decoded(std::string &out, const char *begin, const char *end, bool attribute = false)
+{
+    while (begin != end)
+    {
+        auto special = begin;
+
+        while (special != end && *special != '&' && *special != '\r'
+            && !(attribute && (*special == '\n' || *special == '\t')))
+        {
+            ++special;
+        }
+
+        out.append(begin, special);
+
+        if (special == end)
+        {
+            break;
+        }
+
+        if (*special != '&')
+        {
+            out.push_back(attribute ? ' ' : '\n');
+            begin = special + 1;
+
+            if (*special == '\r' && begin != end && *begin == '\n')
+            {
+                ++begin;
+            }
+
+            continue;
+        }
+
+        const auto semicolon = std::find(special, end, ';');
+
+        if (semicolon == end)
+        {
+            throw xlnt::exception("malformed reference in sheetData");
+        }
+
+        const auto name = special + 1;
+
+        if (equals(name, semicolon, "lt"))
+        {
+            out.push_back('<');
+        }
+        else if (equals(name, semicolon, "gt"))
+        {
+            out.push_back('>');
+        }
+        else if (equals(name, semicolon, "amp"))
+        {
+            out.push_back('&');
+        }
+        else if (equals(name, semicolon, "quot"))
+        {
+            out.push_back('"');
+        }
+        else if (equals(name, semicolon, "apos"))
+        {
+            out.push_back('\'');
+        }
+        else if (name != semicolon && *name == '#')
+        {
+            const auto hex = name + 1 != semicolon && (name[1] == 'x' || name[1] == 'X');
+            auto code_point = 0UL;
+
+            for (auto digit = name + (hex ? 2 : 1); digit != semicolon; ++digit)
+            {
+                const auto c = *digit;
+                auto value = 0UL;
+
+                if (c >= '0' && c <= '9') value = static_cast<unsigned long>(c - '0');
+                else if (hex && c >= 'a' && c <= 'f') value = static_cast<unsigned long>(c - 'a' + 10);
+                else if (hex && c >= 'A' && c <= 'F') value = static_cast<unsigned long>(c - 'A' + 10);
+                else throw xlnt::exception("malformed character reference in sheetData");
+
+                code_point = code_point * (hex ? 16 : 10) + value;
+            }
+
+            append_utf8(out, code_point);
+        }
+        else
+        {
+            throw xlnt::exception("undefined entity in sheetData");
+        }
+
+        begin = semicolon + 1;
+    }
+}
+
+struct tag
+{
+    const char *begin = nullptr; // the opening '<'
+    const char *name = nullptr; // local name, without any namespace prefix
+    const char *name_end = nullptr;
+    const char *attributes = nullptr;
+    const char *attributes_end = nullptr;
+    bool closing = false; // </name>
+    bool empty = false; // <name/>
+};
+
+/// <summary>
+/// Scans the content of a sheetData element tag by tag. Everything it produces
+/// mirrors what parse_sheet_data in xlsx_consumer.cpp builds from libstudxml events.
+/// </summary>
+class sheet_data_scanner
+{
+public:
+    sheet_data_scanner(const char *begin, const char *end,
+        std::unordered_map<std::string, std::string> &array_formulae, const Cell_Projection &projection)
+        : position_(begin),
+          end_(end),
+          array_formulae_(array_formulae),
+          projection_(projection)
+    {
+    }
+
+    // <sheetData> content
+    Sheet_Data parse(std::size_t batch_size, const std::function<void(Sheet_Data &)> &flush)
+    {
+        Sheet_Data sheet_data;
+        tag current;
+        auto previous_row = 0;
+
+        while (next_tag(current))
+        {
+            if (current.closing)
+            {
+                throw xlnt::exception("unexpected end tag in sheetData");
+            }
+
+            if (!equals(current.name, current.name_end, "row"))
+            {
+                skip_element(current);
+                continue;
+            }
+
+            auto row = parse_row(current, previous_row + 1, sheet_data);
+            previous_row = row.second;
+
+            if (projection_.contains_row(static_cast<xlnt::row_t>(row.second)))
+            {
+                sheet_data.parsed_rows.push_back(std::move(row));
+            }
+
+            if (batch_size != 0 && sheet_data.parsed_cells.size() >= batch_size)
+            {
+                flush(sheet_data);
+                sheet_data.clear();
+            }
+        }
+
+        return sheet_data;
+    }
+
+    // <sst>, recording where its start tag and each of its si elements start
+    bool index_shared_strings(const char *part, std::size_t &root_begin, std::size_t &root_end,
+        std::vector<std::size_t> &offsets)
+    {
+        tag current;
+
+        if (!next_tag(current) || current.closing || !equals(current.name, current.name_end, "sst"))
+        {
+            return false;
+        }
+
+        root_begin = static_cast<std::size_t>(current.begin - part);
+        root_end = static_cast<std::size_t>(position_ - part);
+        auto items_end = root_end;
+
+        if (!current.empty)
+        {
+            // anything after the last si element, such as extLst, isn't part of it
+            while (next_tag(current) && !current.closing && equals(current.name, current.name_end, "si"))
+            {
+                offsets.push_back(static_cast<std::size_t>(current.begin - part));
+                skip_element(current);
+                items_end = static_cast<std::size_t>(position_ - part);
+            }
+        }
+
+        offsets.push_back(items_end);
+
+        return true;
+    }
+
+    // <si>, if its only child is a t element
+    bool read_plain_text(std::string &text, bool &preserve_space)
+    {
+        tag current;
+
+        if (!next_tag(current) || current.closing || !equals(current.name, current.name_end, "si"))
+        {
+            return false;
+        }
+
+        preserve_space = false;
+
+        if (current.empty)
+        {
+            return true;
+        }
+
+        if (!next_tag(current) || current.closing || !equals(current.name, current.name_end, "t"))
+        {
+            return false;
+        }
+
+        for_each_attribute(current, [&preserve_space](const char *name, const char *name_end,
+                                        const char *value, const char *value_end) {
+            if (equals(name, name_end, "space"))
+            {
+                preserve_space = equals(value, value_end, "preserve");
+            }
+        });
+
+        if (!current.empty)
+        {
+            append_element_text(text);
+        }
+
+        return next_tag(current) && current.closing;
+    }
+
+private:
+    // Skips character data up to the next tag and reads that into result, appending the
+    // decoded character data to text if given. Comments and processing instructions are
+    // skipped and CDATA sections are character data. Returns false at the end of the input.
+    bool next_tag(tag &result, std::string *text = nullptr)
+    {
+        while (true)
+        {
+            auto open = static_cast<const char *>(std::memchr(position_, '<', static_cast<std::size_t>(end_ - position_)));
+
+            if (open == nullptr)
+            {
+                if (text != nullptr)
+                {
+                    append_decoded(*text, position_, end_);
+                }
+
+                position_ = end_;
+                return false;
+            }
+
+            if (text != nullptr)
+            {
+                append_decoded(*text, position_, open);
+            }
+
+            if (starts_with(open, end_, "<!--"))
+            {
+                position_ = skip_past(open + 4, "-->");
+                continue;
+            }
+
+            if (starts_with(open, end_, "<![CDATA["))
+            {
+                const auto data = open + 9;
+                position_ = skip_past(data, "]]>");
+
+                if (text != nullptr)
+                {
+                    text->append(data, position_ - 3);
+                }
+
+                continue;
+            }
+
+            if (starts_with(open, end_, "<?"))
+            {
+                position_ = skip_past(open + 2, "?>");
+                continue;
+            }
+
+            if (starts_with(open, end_, "<!"))
+            {
+                throw xlnt::exception("unexpected markup in sheetData");
+            }
+
+            result.begin = open;
+            auto cursor = open + 1;
+            result.closing = cursor != end_ && *cursor == '/';
+            if (result.closing) ++cursor;
+
+            auto qname = cursor;
+            while (cursor != end_ && !is_space(*cursor) && *cursor != '/' && *cursor != '>') ++cursor;
+
+            const auto colon = std::find(qname, cursor, ':');
+            result.name = colon == cursor ? qname : colon + 1;
+            result.name_end = cursor;
+            result.attributes = cursor;
+
+            // attribute values may contain '>'
+            auto quote = '\0';
+            while (cursor != end_ && (quote != '\0' || *cursor != '>'))
+            {
+                if (quote == '\0' && (*cursor == '"' || *cursor == '\''))
+                {
+                    quote = *cursor;
+                }
+                else if (*cursor == quote)
+                {
+                    quote = '\0';
+                }
+
+                ++cursor;
+            }
+
+            if (cursor == end_ || result.name == result.name_end)
+            {
+                throw xlnt::exception("malformed tag in sheetData");
+            }
+
+            result.empty = cursor[-1] == '/' && !result.closing;
+            result.attributes_end = result.empty ? cursor - 1 : cursor;
+            position_ = cursor + 1;
+
+            return true;
+        }
+    }
+
+    template <std::size_t N>
+    const char *skip_past(const char *begin, const char (&terminator)[N])
+    {
+        const auto found = find(begin, end_, terminator);
+
+        if (found == end_)
+        {
+            throw xlnt::exception("unterminated markup in sheetData");
+        }
+
+        return found + N - 1;
+    }
+
+    // Calls on_attribute(name, name_end, value, value_end) for every attribute of t
+    // with the local name of the attribute and its raw value.
+    template <typename F>
+    void for_each_attribute(const tag &t, F on_attribute)
+    {
+        auto cursor = t.attributes;
+
+        while (true)
+        {
+            while (cursor != t.attributes_end && is_space(*cursor)) ++cursor;
+            if (cursor == t.attributes_end) return;
+
+            const auto qname = cursor;
+            while (cursor != t.attributes_end && *cursor != '=' && !is_space(*cursor)) ++cursor;
+            const auto qname_end = cursor;
+            while (cursor != t.attributes_end && is_space(*cursor)) ++cursor;
+
+            if (cursor == t.attributes_end || *cursor != '=')
+            {
+                throw xlnt::exception("malformed attribute in sheetData");
+            }
+
+            ++cursor;
+            while (cursor != t.attributes_end && is_space(*cursor)) ++cursor;
+
+            if (cursor == t.attributes_end || (*cursor != '"' && *cursor != '\''))
+            {
+                throw xlnt::exception("malformed attribute in sheetData");
+            }
+
+            const auto quote = *cursor++;
+            const auto value = cursor;
+            cursor = std::find(value, t.attributes_end, quote);
+
+            if (cursor == t.attributes_end)
+            {
+                throw xlnt::exception("malformed attribute in sheetData");
+            }
+
+            const auto colon = std::find(qname, qname_end, ':');
+            on_attribute(colon == qname_end ? qname : colon + 1, qname_end, value, cursor);
+            ++cursor;
+        }
+    }
+
+    static std::string attribute_text(const char *begin, const char *end)
+    {
+        if (std::find(begin, end, '&') == end && std::find_if(begin, end, is_space) == end)
+        {
+            return std::string(begin, end);
+        }
+
+        std::string text;
+        append_decoded(text, begin, end, true);
+
+        return text;
+    }
+
+    void skip_element(const tag &t)
+    {
+        if (t.empty) return;
+
+        auto depth = std::size_t(1);
+        tag inner;
+
+        while (depth > 0)
+        {
+            if (!next_tag(inner))
+            {
+                throw xlnt::exception("unexpected end of sheetData");
+            }
+
+            if (inner.closing)
+            {
+                --depth;
+            }
+            else if (!inner.empty)
+            {
+                ++depth;
+            }
+        }
+    }
+
+    // Appends the character data directly inside t to the text of ref in sheet_data
+    // and consumes its end tag. Character data of nested elements is ignored.
+    void read_element_text(const tag &t, Sheet_Data &sheet_data, xlnt::detail::Text_Ref &ref)
+    {
+        if (t.empty) return;
+
+        auto &text = sheet_data.begin_append(ref);
+        append_element_text(text);
+        sheet_data.end_append(ref);
+    }
+
+    void append_element_text(std::string &text)
+    {
+        auto depth = std::size_t(1);
+        tag inner;
+
+        while (depth > 0)
+        {
+            if (!next_tag(inner, depth == 1 ? &text : nullptr))
+            {
+                throw xlnt::exception("unexpected end of sheetData");
+            }
+
+            if (inner.closing)
+            {
+                --depth;
+            }
+            else if (!inner.empty)
+            {
+                ++depth;
+            }
+        }
+    }
+
+    static xlnt::cell_type type_from_string(const char *begin, const char *end)
+    {
+        if (equals(begin, end, "s")) return xlnt::cell_type::shared_string;
+        if (equals(begin, end, "n")) return xlnt::cell_type::number;
+        if (equals(begin, end, "b")) return xlnt::cell_type::boolean;
+        if (equals(begin, end, "e")) return xlnt::cell_type::error;
+        if (equals(begin, end, "inlineStr")) return xlnt::cell_type::inline_string;
+        if (equals(begin, end, "str")) return xlnt::cell_type::formula_string;
+
+        return xlnt::cell_type::shared_string;
+    }
+
+    // <row>
+    // <row>, which is in implied_row if it has no r attribute
+    std::pair<xlnt::row_properties, int> parse_row(const tag &row_tag, int implied_row, Sheet_Data &sheet_data)
+    {
+        std::pair<xlnt::row_properties, int> props;
+        props.second = implied_row;
+
+        for_each_attribute(row_tag, [&](const char *name, const char *name_end, const char *value, const char *value_end) {
+            if (equals(name, name_end, "r"))
+            {
+                parse_integer(value, value_end, props.second);
+            }
+            else if (equals(name, name_end, "spans"))
+            {
+                props.first.spans = attribute_text(value, value_end);
+            }
+            else if (equals(name, name_end, "ht"))
+            {
+                props.first.height = xlnt::detail::deserialise(std::string(value, value_end));
+            }
+            else if (equals(name, name_end, "dyDescent"))
+            {
+                props.first.dy_descent = xlnt::detail::deserialise(std::string(value, value_end));
+            }
+            else if (equals(name, name_end, "s"))
+            {
+                std::size_t style = 0;
+                if (parse_integer(value, value_end, style))
+                {
+                    props.first.style = style;
+                }
+            }
+            else if (equals(name, name_end, "hidden"))
+            {
+                props.first.hidden = is_true(value, value_end);
+            }
+            else if (equals(name, name_end, "customFormat"))
+            {
+                props.first.custom_format = is_true(value, value_end);
+            }
+            else if (equals(name, name_end, "customHeight"))
+            {
+                props.first.custom_height = is_true(value, value_end);
+            }
+        });
+
+        if (row_tag.empty)
+        {
+            return props;
+        }
+
+        tag child;
+        xlnt::detail::sequential_column columns;
+
+        while (next_tag(child))
+        {
+            if (child.closing)
+            {
+                return props;
+            }
+
+            if (equals(child.name, child.name_end, "c"))
+            {
+                parse_cell(static_cast<xlnt::row_t>(props.second), columns, child, sheet_data);
+            }
+            else
+            {
+                skip_element(child);
+            }
+        }
+
+        throw xlnt::exception("unexpected end of sheetData");
+    }
+
+    // <c>, appended to the parsed cells of sheet_data unless it is outside the projection
+    void parse_cell(xlnt::row_t row, xlnt::detail::sequential_column &columns, const tag &cell_tag, Sheet_Data &sheet_data)
+    {
+        Cell c;
+        auto has_reference = false;
+
+        for_each_attribute(cell_tag, [&](const char *name, const char *name_end, const char *value, const char *value_end) {
+            if (equals(name, name_end, "r"))
+            {
+                c.ref = xlnt::detail::Cell_Reference(row, columns.resolve(value, value_end));
+                has_reference = true;
+            }
+            else if (equals(name, name_end, "t"))
+            {
+                c.type = type_from_string(value, value_end);
+            }
+            else if (equals(name, name_end, "s"))
+            {
+                parse_integer(value, value_end, c.style_index);
+            }
+            else if (equals(name, name_end, "ph"))
+            {
+                c.is_phonetic = is_true(value, value_end);
+            }
+            else if (equals(name, name_end, "cm"))
+            {
+                parse_integer(value, value_end, c.cell_metadata_idx);
+            }
+        });
+
+        if (!has_reference)
+        {
+            c.ref = xlnt::detail::Cell_Reference(row, columns.next());
+        }
+
+        if (!projection_.contains(c.ref))
+        {
+            skip_cell(cell_tag, c, sheet_data);
+            return;
+        }
+
+        if (cell_tag.empty)
+        {
+            sheet_data.parsed_cells.push_back(c);
+            return;
+        }
+
+        tag child;
+
+        while (next_tag(child))
+        {
+            if (child.closing)
+            {
+                sheet_data.parsed_cells.push_back(c);
+                return;
+            }
+
+            if (equals(child.name, child.name_end, "v"))
+            {
+                read_element_text(child, sheet_data, c.value);
+            }
+            else if (equals(child.name, child.name_end, "f"))
+            {
+                parse_formula(child, c, sheet_data);
+            }
+            else if (equals(child.name, child.name_end, "is"))
+            {
+                parse_inline_string(child, c, sheet_data);
+            }
+            else
+            {
+                skip_element(child);
+            }
+        }
+
+        throw xlnt::exception("unexpected end of sheetData");
+    }
+
+    // Skips the content of a cell outside the projection. Only its formula is read, so that
+    // the master cell of a shared formula still provides the text of its group.
+    void skip_cell(const tag &cell_tag, Cell &c, Sheet_Data &sheet_data)
+    {
+        if (cell_tag.empty)
+        {
+            return;
+        }
+
+        tag child;
+
+        while (next_tag(child))
+        {
+            if (child.closing)
+            {
+                if (c.shared_index >= 0 && !c.formula_string.empty())
+                {
+                    sheet_data.skipped_shared_formulae.push_back(c);
+                }
+
+                return;
+            }
+
+            if (equals(child.name, child.name_end, "f"))
+            {
+                parse_formula(child, c, sheet_data);
+            }
+            else
+            {
+                skip_element(child);
+            }
+        }
+
+        throw xlnt::exception("unexpected end of sheetData");
+    }
+
+    // <f>
+    void parse_formula(const tag &formula_tag, Cell &c, Sheet_Data &sheet_data)
+    {
+        const char *type = nullptr;
+        const char *type_end = nullptr;
+        auto shared_index = 0;
+        std::string ref;
+
+        for_each_attribute(formula_tag, [&](const char *name, const char *name_end, const char *value, const char *value_end) {
+            if (equals(name, name_end, "t"))
+            {
+                type = value;
+                type_end = value_end;
+            }
+            else if (equals(name, name_end, "si"))
+            {
+                parse_integer(value, value_end, shared_index);
+            }
+            else if (equals(name, name_end, "ref"))
+            {
+                ref = attribute_text(value, value_end);
+            }
+        });
+
+        // only the master cell of a shared formula carries its text,
+        // the other cells of the group are left with just its index
+        if (type != nullptr && equals(type, type_end, "shared"))
+        {
+            c.shared_index = shared_index;
+        }
+
+        const auto length = c.formula_string.length;
+        read_element_text(formula_tag, sheet_data, c.formula_string);
+
+        if (c.formula_string.length != length && type != nullptr && equals(type, type_end, "array"))
+        {
+            array_formulae_[ref] = sheet_data.str(c.formula_string);
+        }
+    }
+
+    // <is>
+    void parse_inline_string(const tag &inline_tag, Cell &c, Sheet_Data &sheet_data)
+    {
+        if (inline_tag.empty) return;
+
+        tag child;
+
+        while (next_tag(child))
+        {
+            if (child.closing)
+            {
+                return;
+            }
+
+            if (equals(child.name, child.name_end, "t"))
+            {
+                read_element_text(child, sheet_data, c.value);
+            }
+            else
+            {
+                skip_element(child);
+            }
+        }
+
+        throw xlnt::exception("unexpected end of sheetData");
+    }
+
+    const char *position_;
+    const char *end_;
+    std::unordered_map<std::string, std::string> &array_formulae_;
+    const Cell_Projection &projection_;
+};
+
+bool is_name_character(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+        || c == '_' || c == '-' || c == '.';
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+bool find_sheet_data(const char *part, std::size_t size, std::size_t &content_begin, std::size_t &content_end)
+{
+    const auto end = part + size;
+
+    // only UTF-8 parts can be scanned byte by byte
+    if (size >= 2 && ((part[0] == '\xFE' && part[1] == '\xFF') || (part[0] == '\xFF' && part[1] == '\xFE')))
+    {
+        return false;
+    }
+
+    for (auto name = find(part, end, "sheetData"); name != end; name = find(name + 9, end, "sheetData"))
+    {
+        const auto name_end = name + 9;
+
+        // the name must be the (possibly prefixed) name of a start tag
+        auto qname = name;
+
+        if (qname != part && qname[-1] == ':')
+        {
+            --qname;
+            while (qname != part && is_name_character(qname[-1])) --qname;
+        }
+
+        if (qname == part || qname[-1] != '<' || name_end == end
+            || !(is_space(*name_end) || *name_end == '>' || *name_end == '/'))
+        {
+            continue;
+        }
+
+        const auto start_tag_end = std::find(name_end, end, '>');
+
+        if (start_tag_end == end || start_tag_end[-1] == '/')
+        {
+            return false;
+        }
+
+        const auto closing = std::string("</") + std::string(qname, name_end);
+        auto close = std::search(start_tag_end + 1, end, closing.begin(), closing.end());
+
+        while (close != end)
+        {
+            const auto after = close + closing.size();
+
+            if (after != end && (*after == '>' || is_space(*after)))
+            {
+                break;
+            }
+
+            close = std::search(after, end, closing.begin(), closing.end());
+        }
+
+        if (close == end || close == start_tag_end + 1)
+        {
+            return false;
+        }
+
+        content_begin = static_cast<std::size_t>(start_tag_end + 1 - part);
+        content_end = static_cast<std::size_t>(close - part);
+
+        return true;
+    }
+
+    return false;
+}
+
+Sheet_Data tokenize_sheet_data(const char *begin, const char *end,
+    std::unordered_map<std::string, std::string> &array_formulae, const Cell_Projection &projection,
+    std::size_t batch_size, const std::function<void(Sheet_Data &)> &flush)
+{
+    return sheet_data_scanner(begin, end, array_formulae, projection).parse(batch_size, flush);
+}
+
+bool index_shared_strings(const char *part, std::size_t size, std::size_t &root_begin, std::size_t &root_end,
+    std::vector<std::size_t> &offsets)
+{
+    // only UTF-8 parts can be scanned byte by byte
+    if (size >= 2 && ((part[0] == '\xFE' && part[1] == '\xFF') || (part[0] == '\xFF' && part[1] == '\xFE')))
+    {
+        return false;
+    }
+
+    std::unordered_map<std::string, std::string> array_formulae;
+    const Cell_Projection projection;
+
+    return sheet_data_scanner(part, part + size, array_formulae, projection)
+        .index_shared_strings(part, root_begin, root_end, offsets);
+}
+
+bool read_plain_shared_string(const char *begin, const char *end, std::string &text, bool &preserve_space)
+{
+    std::unordered_map<std::string, std::string> array_formulae;
+    const Cell_Projection projection;
+
+    return sheet_data_scanner(begin, end, array_formulae, projection).read_plain_text(text, preserve_space);
+}
+
+} // namespace detail
+} // namespace xlnt
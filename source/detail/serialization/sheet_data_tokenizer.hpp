@@ -0,0 +1,76 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/xlnt_config_impl.hpp>
+#include <detail/serialization/serialisation_helpers.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Finds the content of the sheetData element in the size bytes of a worksheet part,
+/// i.e. everything between its start and end tag. Returns false if the part has no
+/// sheetData element or the element is empty. Otherwise content_begin and content_end
+/// are set to the offsets of the content, so that cutting [content_begin, content_end)
+/// out of the part leaves an empty sheetData element.
+/// </summary>
+XLNT_API_INTERNAL bool find_sheet_data(const char *part, std::size_t size,
+    std::size_t &content_begin, std::size_t &content_end);
+
+/// <summary>
+/// Parses the content of a sheetData element, as found by find_sheet_data, by scanning
+/// the bytes directly instead of going through libstudxml. The result, the array formula map
+/// and the batching through flush behave exactly as parse_sheet_data in xlsx_consumer.cpp.
+/// Rows and cells outside projection are skipped without being parsed.
+/// </summary>
+XLNT_API_INTERNAL Sheet_Data tokenize_sheet_data(const char *begin, const char *end,
+    std::unordered_map<std::string, std::string> &array_formulae, const Cell_Projection &projection = Cell_Projection(),
+    std::size_t batch_size = 0, const std::function<void(Sheet_Data &)> &flush = nullptr);
+
+/// <summary>
+/// Indexes the shared string table part in the size bytes at part without decoding any
+/// string. root_begin and root_end are set to the offsets of the sst start tag, and the
+/// offset of each si element is appended to offsets, followed by the offset just past the
+/// last one. Returns false if the part isn't UTF-8 or its root isn't an sst element.
+/// </summary>
+XLNT_API_INTERNAL bool index_shared_strings(const char *part, std::size_t size,
+    std::size_t &root_begin, std::size_t &root_end, std::vector<std::size_t> &offsets);
+
+/// <summary>
+/// Appends the text of the si element in [begin, end) to text if its only child is a t
+/// element, setting preserve_space from its xml:space attribute. Returns false without
+/// a complete result if the element also has runs or phonetic properties.
+/// </summary>
+XLNT_API_INTERNAL bool read_plain_shared_string(const char *begin, const char *end,
+    std::string &text, bool &preserve_space);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,310 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <ostream>
+
+#include <cstring>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/sheet_data_writer.hpp>
+
+namespace {
+
+// the buffer is handed to the stream once it grows past this many bytes
+const std::size_t flush_threshold = 64 * 1024;
+
+const std::uint64_t ones = 0x0101010101010101ULL;
+const std::uint64_t highs = 0x8080808080808080ULL;
+
+// true if any of the eight bytes of word is below the byte limit, which must be at most 0x80
+bool has_byte_below(std::uint64_t word, std::uint64_t limit)
+{
+    return ((word - ones * limit) & ~word & highs) != 0;
+}
+
+bool has_byte(std::uint64_t word, char c)
+{
+    return has_byte_below(word ^ (ones * static_cast<unsigned char>(c)), 1);
+}
+
+// true if any of the eight bytes of word may need escaping: a control character,
+// one of & < > or, in an attribute value, a double quote
+bool needs_escaping(std::uint64_t word, bool attribute)
+{
+    return has_byte_below(word, 0x20) || has_byte(word, '&') || has_byte(word, '<') || has_byte(word, '>')
+        || (attribute && has_byte(word, '"'));
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+sheet_data_writer::sheet_data_writer(std::ostream &destination)
+    : destination_(destination)
+{
+    buffer_.reserve(flush_threshold + 1024);
+}
+
+void sheet_data_writer::start_element(const char *name)
+{
+    buffer_.push_back('<');
+    append(name);
+}
+
+void sheet_data_writer::end_start_tag()
+{
+    buffer_.push_back('>');
+}
+
+void sheet_data_writer::end_empty_element()
+{
+    buffer_.append("/>", 2);
+    flush_if_full();
+}
+
+void sheet_data_writer::end_element(const char *name)
+{
+    buffer_.append("</", 2);
+    append(name);
+    buffer_.push_back('>');
+    flush_if_full();
+}
+
+void sheet_data_writer::attribute(const char *name, const std::string &value)
+{
+    buffer_.push_back(' ');
+    append(name);
+    buffer_.append("=\"", 2);
+    append_escaped(value.data(), value.size(), true);
+    buffer_.push_back('"');
+}
+
+void sheet_data_writer::attribute(const char *name, std::uint64_t value)
+{
+    buffer_.push_back(' ');
+    append(name);
+    buffer_.append("=\"", 2);
+    append_number(value);
+    buffer_.push_back('"');
+}
+
+void sheet_data_writer::attribute(const char *name, double value)
+{
+    buffer_.push_back(' ');
+    append(name);
+    buffer_.append("=\"", 2);
+    append_number(value);
+    buffer_.push_back('"');
+}
+
+void sheet_data_writer::attribute(const char *name, column_t column, row_t row)
+{
+    buffer_.push_back(' ');
+    append(name);
+    buffer_.append("=\"", 2);
+
+    char reference[cell_reference::max_string_length];
+    buffer_.append(reference, cell_reference(column, row).to_chars(reference));
+    buffer_.push_back('"');
+}
+
+void sheet_data_writer::attribute(const char *name, std::uint64_t first, std::uint64_t last)
+{
+    buffer_.push_back(' ');
+    append(name);
+    buffer_.append("=\"", 2);
+    append_number(first);
+    buffer_.push_back(':');
+    append_number(last);
+    buffer_.push_back('"');
+}
+
+void sheet_data_writer::characters(const std::string &text)
+{
+    append_escaped(text.data(), text.size(), false);
+}
+
+void sheet_data_writer::characters(const char *text, std::size_t length)
+{
+    append_escaped(text, length, false);
+}
+
+void sheet_data_writer::element(const char *name, const std::string &text)
+{
+    start_element(name);
+    end_start_tag();
+    characters(text);
+    end_element(name);
+}
+
+void sheet_data_writer::element(const char *name, std::uint64_t value)
+{
+    start_element(name);
+    end_start_tag();
+    append_number(value);
+    end_element(name);
+}
+
+void sheet_data_writer::element(const char *name, std::int64_t value)
+{
+    start_element(name);
+    end_start_tag();
+    number(value);
+    end_element(name);
+}
+
+void sheet_data_writer::element(const char *name, double value)
+{
+    start_element(name);
+    end_start_tag();
+    append_number(value);
+    end_element(name);
+}
+
+void sheet_data_writer::number(std::int64_t value)
+{
+    if (value < 0)
+    {
+        buffer_.push_back('-');
+    }
+
+    // the magnitude of the lowest value doesn't fit into std::int64_t
+    append_number(value < 0 ? std::uint64_t(0) - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value));
+}
+
+void sheet_data_writer::markup(const char *text, std::size_t length)
+{
+    buffer_.append(text, length);
+    flush_if_full();
+}
+
+void sheet_data_writer::flush()
+{
+    destination_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+void sheet_data_writer::append(const char *text)
+{
+    buffer_.append(text);
+}
+
+void sheet_data_writer::append_number(std::uint64_t value)
+{
+    char digits[20];
+    auto first = digits + sizeof(digits);
+
+    do
+    {
+        *--first = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    buffer_.append(first, static_cast<std::size_t>(digits + sizeof(digits) - first));
+}
+
+void sheet_data_writer::append_number(double value)
+{
+    char characters[serialised_double_capacity];
+    buffer_.append(characters, serialise_to(characters, value));
+}
+
+void sheet_data_writer::append_escaped(const char *text, std::size_t length, bool attribute)
+{
+    // runs of characters which need no escaping are appended at once
+    auto run = text;
+    const auto end = run + length;
+
+    for (auto cursor = run; cursor != end; ++cursor)
+    {
+        // skip eight bytes at a time while none of them can need escaping
+        std::uint64_t word = 0;
+
+        while (end - cursor >= static_cast<std::ptrdiff_t>(sizeof(word)))
+        {
+            std::memcpy(&word, cursor, sizeof(word));
+            if (needs_escaping(word, attribute)) break;
+            cursor += sizeof(word);
+        }
+
+        if (cursor == end) break;
+
+        const auto c = static_cast<unsigned char>(*cursor);
+        const char *escaped = nullptr;
+
+        switch (c)
+        {
+        case '&':
+            escaped = "&amp;";
+            break;
+        case '<':
+            escaped = "&lt;";
+            break;
+        case '>':
+            escaped = "&gt;";
+            break;
+        case '\r':
+            escaped = "&#xD;";
+            break;
+        case '"':
+            escaped = attribute ? "&quot;" : nullptr;
+            break;
+        case '\t':
+            escaped = attribute ? "&#x9;" : nullptr;
+            break;
+        case '\n':
+            escaped = attribute ? "&#xA;" : nullptr;
+            break;
+        default:
+            if (c < 0x20)
+            {
+                // not allowed in XML 1.0, which xml::serializer also refuses
+                throw illegal_character(static_cast<char>(c));
+            }
+            break;
+        }
+
+        if (escaped != nullptr)
+        {
+            buffer_.append(run, static_cast<std::size_t>(cursor - run));
+            append(escaped);
+            run = cursor + 1;
+        }
+    }
+
+    buffer_.append(run, static_cast<std::size_t>(end - run));
+}
+
+void sheet_data_writer::flush_if_full()
+{
+    if (buffer_.size() >= flush_threshold)
+    {
+        flush();
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,166 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include <xlnt/cell/index_types.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Writes the content of a sheetData element by appending escaped bytes to a buffer which
+/// is handed to the part stream in large blocks, instead of going through xml::serializer
+/// with a string per attribute and value. It is the writing counterpart of tokenize_sheet_data.
+/// All elements are written without a prefix, so the default namespace of the part must be
+/// the one they belong to, and the serializer writing the rest of the part must not touch
+/// the stream until flush has been called.
+/// </summary>
+class XLNT_API_INTERNAL sheet_data_writer
+{
+public:
+    /// <summary>
+    /// Constructs a writer which appends to destination.
+    /// </summary>
+    explicit sheet_data_writer(std::ostream &destination);
+
+    /// <summary>
+    /// Writes "<name", leaving the start tag open for attributes.
+    /// </summary>
+    void start_element(const char *name);
+
+    /// <summary>
+    /// Closes the open start tag for content.
+    /// </summary>
+    void end_start_tag();
+
+    /// <summary>
+    /// Closes the open start tag as an empty element.
+    /// </summary>
+    void end_empty_element();
+
+    /// <summary>
+    /// Writes the end tag of the element called name.
+    /// </summary>
+    void end_element(const char *name);
+
+    /// <summary>
+    /// Writes an attribute of the open start tag with the escaped value.
+    /// </summary>
+    void attribute(const char *name, const std::string &value);
+
+    /// <summary>
+    /// Writes an attribute of the open start tag with the decimal value.
+    /// </summary>
+    void attribute(const char *name, std::uint64_t value);
+
+    /// <summary>
+    /// Writes an attribute of the open start tag with value formatted like serialise(double).
+    /// </summary>
+    void attribute(const char *name, double value);
+
+    /// <summary>
+    /// Writes an attribute of the open start tag with the A1 style reference of a cell.
+    /// </summary>
+    void attribute(const char *name, column_t column, row_t row);
+
+    /// <summary>
+    /// Writes an attribute of the open start tag with the range "first:last" of two numbers.
+    /// </summary>
+    void attribute(const char *name, std::uint64_t first, std::uint64_t last);
+
+    /// <summary>
+    /// Writes the escaped text as content of the current element.
+    /// </summary>
+    void characters(const std::string &text);
+
+    /// <summary>
+    /// Writes the escaped length characters at text as content of the current element.
+    /// </summary>
+    void characters(const char *text, std::size_t length);
+
+    /// <summary>
+    /// Writes the decimal value, which may be negative, as content or as part of an
+    /// attribute value written with markup.
+    /// </summary>
+    void number(std::int64_t value);
+
+    /// <summary>
+    /// Writes the length bytes at text unchanged. They must be well formed markup or
+    /// text which needs no escaping, for the parts of a fragment which never vary.
+    /// </summary>
+    void markup(const char *text, std::size_t length);
+
+    /// <summary>
+    /// Writes the string literal text unchanged, see markup(const char *, std::size_t).
+    /// </summary>
+    template <std::size_t N>
+    void markup(const char (&text)[N])
+    {
+        markup(text, N - 1);
+    }
+
+    /// <summary>
+    /// Writes a complete element with the escaped text as its content.
+    /// </summary>
+    void element(const char *name, const std::string &text);
+
+    /// <summary>
+    /// Writes a complete element with the decimal value as its content.
+    /// </summary>
+    void element(const char *name, std::uint64_t value);
+
+    /// <summary>
+    /// Writes a complete element with the decimal value, which may be negative, as its content.
+    /// </summary>
+    void element(const char *name, std::int64_t value);
+
+    /// <summary>
+    /// Writes a complete element with value formatted like serialise(double) as its content.
+    /// </summary>
+    void element(const char *name, double value);
+
+    /// <summary>
+    /// Hands everything written so far to the destination stream.
+    /// </summary>
+    void flush();
+
+private:
+    void append(const char *text);
+    void append_number(std::uint64_t value);
+    void append_number(double value);
+    void append_escaped(const char *text, std::size_t length, bool attribute);
+    void flush_if_full();
+
+    std::ostream &destination_;
+    std::string buffer_;
+};
+
+} // namespace detail
+} // namespace xlnt
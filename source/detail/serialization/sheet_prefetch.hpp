@@ -0,0 +1,171 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Inflates a worksheet part into memory on a thread of its own, so that the next sheet
+/// of a streaming_workbook_reader is ready by the time it is begun. A part which grows
+/// past max_bytes is dropped again and has to be streamed from the archive as usual.
+/// </summary>
+class sheet_prefetch
+{
+public:
+    sheet_prefetch(std::string title, std::unique_ptr<std::streambuf> part, std::size_t max_bytes)
+        : title_(std::move(title)),
+          part_(std::move(part)),
+          max_bytes_(max_bytes),
+          reader_(&sheet_prefetch::read_part, this)
+    {
+    }
+
+    /// <summary>
+    /// Stops reading the part, which finishes the block it's reading first.
+    /// </summary>
+    ~sheet_prefetch()
+    {
+        stop_ = true;
+
+        if (reader_.joinable())
+        {
+            reader_.join();
+        }
+    }
+
+    sheet_prefetch(const sheet_prefetch &) = delete;
+    sheet_prefetch &operator=(const sheet_prefetch &) = delete;
+
+    /// <summary>
+    /// Returns the title of the worksheet whose part is read.
+    /// </summary>
+    const std::string &title() const
+    {
+        return title_;
+    }
+
+    /// <summary>
+    /// Waits for the part to be read and returns a streambuf over it, or nullptr if it
+    /// didn't fit in max_bytes. Rethrows what inflating the part threw.
+    /// </summary>
+    std::unique_ptr<std::streambuf> take()
+    {
+        if (reader_.joinable())
+        {
+            reader_.join();
+        }
+
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+
+        if (!complete_)
+        {
+            return nullptr;
+        }
+
+        return std::unique_ptr<std::streambuf>(new prefetched_part(std::move(data_)));
+    }
+
+private:
+    /// <summary>
+    /// Reads the inflated part from the memory which holds it.
+    /// </summary>
+    class prefetched_part : public std::streambuf
+    {
+    public:
+        explicit prefetched_part(std::vector<char> &&data)
+            : data_(std::move(data))
+        {
+            setg(data_.data(), data_.data(), data_.data() + data_.size());
+        }
+
+    private:
+        std::vector<char> data_;
+    };
+
+    void read_part()
+    {
+        const std::size_t block_size = 64 * 1024;
+
+        try
+        {
+            while (!stop_)
+            {
+                const auto size = data_.size();
+
+                if (size > max_bytes_)
+                {
+                    data_ = std::vector<char>();
+                    break;
+                }
+
+                data_.resize(size + block_size);
+                const auto read = part_->sgetn(data_.data() + size, static_cast<std::streamsize>(block_size));
+                data_.resize(size + static_cast<std::size_t>(read > 0 ? read : 0));
+
+                if (read < static_cast<std::streamsize>(block_size))
+                {
+                    complete_ = data_.size() <= max_bytes_;
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            error_ = std::current_exception();
+        }
+
+        // the inflater and its buffers aren't needed any more
+        part_.reset();
+
+        if (!complete_)
+        {
+            data_ = std::vector<char>();
+        }
+    }
+
+    std::string title_;
+    std::unique_ptr<std::streambuf> part_;
+    std::size_t max_bytes_;
+    std::vector<char> data_;
+    bool complete_ = false;
+    std::exception_ptr error_;
+    std::atomic<bool> stop_{false};
+    std::thread reader_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -122,6 +122,47 @@ std::streampos vector_istreambuf::seekpos(std::streampos sp, std::ios_base::open
     return static_cast<std::ptrdiff_t>(position_);
 }
 
+memory_istreambuf::memory_istreambuf(const std::uint8_t *data, std::size_t size)
+{
+    // the get area is never written through, std::streambuf just requires char *
+    auto begin = const_cast<char *>(reinterpret_cast<const char *>(data));
+    setg(begin, begin, begin + size);
+}
+
+const std::uint8_t *memory_istreambuf::data() const
+{
+    return reinterpret_cast<const std::uint8_t *>(eback());
+}
+
+std::size_t memory_istreambuf::size() const
+{
+    return static_cast<std::size_t>(egptr() - eback());
+}
+
+std::streamsize memory_istreambuf::showmanyc()
+{
+    return gptr() == egptr() ? static_cast<std::streamsize>(-1) : static_cast<std::streamsize>(egptr() - gptr());
+}
+
+std::streampos memory_istreambuf::seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode)
+{
+    auto base = way == std::ios_base::beg ? eback() : way == std::ios_base::end ? egptr() : gptr();
+
+    if (off < eback() - base || off > egptr() - base)
+    {
+        return static_cast<std::ptrdiff_t>(-1);
+    }
+
+    setg(eback(), base + off, egptr());
+
+    return static_cast<std::ptrdiff_t>(gptr() - eback());
+}
+
+std::streampos memory_istreambuf::seekpos(std::streampos sp, std::ios_base::openmode which)
+{
+    return seekoff(static_cast<std::streamoff>(sp), std::ios_base::beg, which);
+}
+
 vector_ostreambuf::vector_ostreambuf(std::vector<std::uint8_t> &data)
     : data_(data),
       position_(0)
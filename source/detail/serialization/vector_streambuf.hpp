@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <vector>
@@ -62,6 +63,36 @@ private:
     std::size_t position_;
 };
 
+/// <summary>
+/// Allows a contiguous block of memory which outlives this object, such as a
+/// memory-mapped file, to be read through a std::istream without copying it.
+/// </summary>
+class XLNT_API_INTERNAL memory_istreambuf : public std::streambuf
+{
+public:
+    memory_istreambuf(const std::uint8_t *data, std::size_t size);
+
+    memory_istreambuf(const memory_istreambuf &) = delete;
+    memory_istreambuf &operator=(const memory_istreambuf &) = delete;
+
+    /// <summary>
+    /// Returns the first byte of the underlying memory.
+    /// </summary>
+    const std::uint8_t *data() const;
+
+    /// <summary>
+    /// Returns the size of the underlying memory in bytes.
+    /// </summary>
+    std::size_t size() const;
+
+private:
+    std::streamsize showmanyc() override;
+
+    std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode) override;
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode) override;
+};
+
 /// <summary>
 /// Allows a std::vector to be written through a std::ostream.
 /// </summary>
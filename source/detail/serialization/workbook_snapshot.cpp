@@ -0,0 +1,473 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include <xlnt/packaging/manifest.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+#include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/workbook_snapshot.hpp>
+#include <detail/serialization/zstream.hpp>
+
+namespace {
+
+const char magic[] = {'X', 'L', 'N', 'T', 'S', 'N', 'A', 'P'};
+
+// the snapshot format, which must be incremented whenever it changes
+const std::uint32_t format_version = 1;
+
+// values are written in little-endian order whatever the byte order of the machine
+class snapshot_writer
+{
+public:
+    explicit snapshot_writer(std::vector<std::uint8_t> &data)
+        : data_(data)
+    {
+    }
+
+    void u8(std::uint8_t value)
+    {
+        data_.push_back(value);
+    }
+
+    void u32(std::uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            data_.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void u64(std::uint64_t value)
+    {
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            data_.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void f64(double value)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u64(bits);
+    }
+
+    void bytes(const void *data, std::size_t size)
+    {
+        const auto begin = static_cast<const std::uint8_t *>(data);
+        data_.insert(data_.end(), begin, begin + size);
+    }
+
+    void string(const std::string &value)
+    {
+        u64(value.size());
+        bytes(value.data(), value.size());
+    }
+
+private:
+    std::vector<std::uint8_t> &data_;
+};
+
+class snapshot_reader
+{
+public:
+    snapshot_reader(const std::uint8_t *data, std::size_t size)
+        : position_(data),
+          end_(data + size)
+    {
+    }
+
+    std::uint8_t u8()
+    {
+        return *take(1);
+    }
+
+    std::uint32_t u32()
+    {
+        const auto data = take(4);
+        std::uint32_t value = 0;
+
+        for (int i = 3; i >= 0; --i)
+        {
+            value = (value << 8) | data[i];
+        }
+
+        return value;
+    }
+
+    std::uint64_t u64()
+    {
+        const auto data = take(8);
+        std::uint64_t value = 0;
+
+        for (int i = 7; i >= 0; --i)
+        {
+            value = (value << 8) | data[i];
+        }
+
+        return value;
+    }
+
+    double f64()
+    {
+        const auto bits = u64();
+        double value = 0;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        return value;
+    }
+
+    const std::uint8_t *bytes(std::uint64_t size)
+    {
+        return take(size);
+    }
+
+    std::string string()
+    {
+        const auto size = u64();
+        const auto data = take(size);
+
+        return std::string(reinterpret_cast<const char *>(data), static_cast<std::size_t>(size));
+    }
+
+    // the number of records of the given size that follow, checked against the remaining bytes
+    // so that a malformed count can't make the caller reserve a huge amount of memory
+    std::size_t count(std::size_t record_size)
+    {
+        const auto value = u64();
+
+        if (value > static_cast<std::uint64_t>(end_ - position_) / record_size)
+        {
+            malformed();
+        }
+
+        return static_cast<std::size_t>(value);
+    }
+
+    bool at_end() const
+    {
+        return position_ == end_;
+    }
+
+    [[noreturn]] static void malformed()
+    {
+        throw xlnt::exception("snapshot is truncated or malformed");
+    }
+
+private:
+    const std::uint8_t *take(std::uint64_t size)
+    {
+        if (size > static_cast<std::uint64_t>(end_ - position_))
+        {
+            malformed();
+        }
+
+        const auto data = position_;
+        position_ += size;
+
+        return data;
+    }
+
+    const std::uint8_t *position_;
+    const std::uint8_t *end_;
+};
+
+// the size of a cell written by write_cells, which bounds the cell count when reading
+const std::size_t cell_record_size = 2 + 4 * 5 + 8 * 4;
+
+void write_cells(snapshot_writer &writer, const std::vector<xlnt::detail::Cell> &cells)
+{
+    writer.u64(cells.size());
+
+    for (const auto &cell : cells)
+    {
+        writer.u8(cell.is_phonetic ? 1 : 0);
+        writer.u8(static_cast<std::uint8_t>(cell.type));
+        writer.u32(static_cast<std::uint32_t>(cell.cell_metadata_idx));
+        writer.u32(static_cast<std::uint32_t>(cell.style_index));
+        writer.u32(cell.ref.row);
+        writer.u32(cell.ref.column);
+        writer.u64(cell.value.offset);
+        writer.u64(cell.value.length);
+        writer.u64(cell.formula_string.offset);
+        writer.u64(cell.formula_string.length);
+        writer.u32(static_cast<std::uint32_t>(cell.shared_index));
+    }
+}
+
+xlnt::detail::Text_Ref read_text_ref(snapshot_reader &reader, std::size_t text_size)
+{
+    xlnt::detail::Text_Ref ref;
+    const auto offset = reader.u64();
+    const auto length = reader.u64();
+
+    if (offset > text_size || length > text_size - offset)
+    {
+        snapshot_reader::malformed();
+    }
+
+    ref.offset = static_cast<std::size_t>(offset);
+    ref.length = static_cast<std::size_t>(length);
+
+    return ref;
+}
+
+void read_cells(snapshot_reader &reader, std::size_t text_size, std::vector<xlnt::detail::Cell> &cells)
+{
+    cells.resize(reader.count(cell_record_size));
+
+    for (auto &cell : cells)
+    {
+        cell.is_phonetic = reader.u8() != 0;
+        const auto type = reader.u8();
+
+        if (type > static_cast<std::uint8_t>(xlnt::cell_type::formula_string))
+        {
+            snapshot_reader::malformed();
+        }
+
+        cell.type = static_cast<xlnt::cell_type>(type);
+        cell.cell_metadata_idx = static_cast<int>(reader.u32());
+        cell.style_index = static_cast<int>(reader.u32());
+        cell.ref.row = reader.u32();
+        cell.ref.column = reader.u32();
+        cell.value = read_text_ref(reader, text_size);
+        cell.formula_string = read_text_ref(reader, text_size);
+        cell.shared_index = static_cast<int>(reader.u32());
+    }
+}
+
+void write_rows(snapshot_writer &writer, const std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> &rows)
+{
+    writer.u64(rows.size());
+
+    for (const auto &row : rows)
+    {
+        const auto &props = row.first;
+        writer.u32(row.second);
+        writer.u8(static_cast<std::uint8_t>((props.height.is_set() ? 1 : 0)
+            | (props.dy_descent.is_set() ? 2 : 0)
+            | (props.custom_height ? 4 : 0)
+            | (props.hidden ? 8 : 0)
+            | (props.custom_format.is_set() ? 16 : 0)
+            | (props.custom_format.is_set() && props.custom_format.get() ? 32 : 0)
+            | (props.style.is_set() ? 64 : 0)
+            | (props.spans.is_set() ? 128 : 0)));
+
+        if (props.height.is_set())
+        {
+            writer.f64(props.height.get());
+        }
+
+        if (props.dy_descent.is_set())
+        {
+            writer.f64(props.dy_descent.get());
+        }
+
+        if (props.style.is_set())
+        {
+            writer.u64(props.style.get());
+        }
+
+        if (props.spans.is_set())
+        {
+            writer.string(props.spans.get());
+        }
+    }
+}
+
+void read_rows(snapshot_reader &reader, std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> &rows)
+{
+    rows.resize(reader.count(5));
+
+    for (auto &row : rows)
+    {
+        auto &props = row.first;
+        row.second = reader.u32();
+        const auto flags = reader.u8();
+
+        if (flags & 1)
+        {
+            props.height = reader.f64();
+        }
+
+        if (flags & 2)
+        {
+            props.dy_descent = reader.f64();
+        }
+
+        props.custom_height = (flags & 4) != 0;
+        props.hidden = (flags & 8) != 0;
+
+        if (flags & 16)
+        {
+            props.custom_format = (flags & 32) != 0;
+        }
+
+        if (flags & 64)
+        {
+            props.style = static_cast<std::size_t>(reader.u64());
+        }
+
+        if (flags & 128)
+        {
+            props.spans = reader.string();
+        }
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+void write_snapshot(const std::vector<std::uint8_t> &package, const manifest &manifest, std::vector<std::uint8_t> &snapshot)
+{
+    memory_istreambuf package_buffer(package.data(), package.size());
+    std::istream package_stream(&package_buffer);
+    izstream archive(package_stream);
+
+    std::unordered_map<std::string, snapshot_sheet> sheets;
+    const auto root = path("/");
+
+    for (const auto &workbook_rel : manifest.relationships(root, relationship_type::office_document))
+    {
+        for (const auto &rel : manifest.relationships(workbook_rel.target().path(), relationship_type::worksheet))
+        {
+            sheets[manifest.canonicalize({workbook_rel, rel}).string()];
+        }
+    }
+
+    // the archive is rebuilt with the sheetData of every worksheet cut out of it
+    std::vector<std::uint8_t> stripped;
+
+    {
+        vector_ostreambuf stripped_buffer(stripped);
+        std::ostream stripped_stream(&stripped_buffer);
+        ozstream stripped_archive(stripped_stream, compression_level::none);
+
+        for (const auto &file : archive.files())
+        {
+            auto sheet = sheets.find(file.string());
+
+            if (sheet == sheets.end())
+            {
+                stripped_archive.append(file, archive.read_compressed(file));
+                continue;
+            }
+
+            auto part = archive.read(file);
+            std::size_t content_begin = 0;
+            std::size_t content_end = 0;
+
+            if (find_sheet_data(part.data(), part.size(), content_begin, content_end))
+            {
+                sheet->second.data = tokenize_sheet_data(part.data() + content_begin,
+                    part.data() + content_end, sheet->second.array_formulae);
+                part.erase(content_begin, content_end - content_begin);
+            }
+
+            auto part_buffer = stripped_archive.open(file);
+            part_buffer->sputn(part.data(), static_cast<std::streamsize>(part.size()));
+        }
+    }
+
+    snapshot.clear();
+    snapshot_writer writer(snapshot);
+    writer.bytes(magic, sizeof(magic));
+    writer.u32(format_version);
+    writer.u64(stripped.size());
+    writer.bytes(stripped.data(), stripped.size());
+    writer.u64(sheets.size());
+
+    for (const auto &sheet : sheets)
+    {
+        const auto &data = sheet.second.data;
+        writer.string(sheet.first);
+        writer.string(data.text);
+        write_rows(writer, data.parsed_rows);
+        write_cells(writer, data.parsed_cells);
+        write_cells(writer, data.skipped_shared_formulae);
+        writer.u64(sheet.second.array_formulae.size());
+
+        for (const auto &formula : sheet.second.array_formulae)
+        {
+            writer.string(formula.first);
+            writer.string(formula.second);
+        }
+    }
+}
+
+void read_snapshot(const std::uint8_t *data, std::size_t size,
+    const std::uint8_t *&package, std::size_t &package_size, snapshot_sheets &sheets)
+{
+    snapshot_reader reader(data, size);
+
+    if (size < sizeof(magic) || std::memcmp(reader.bytes(sizeof(magic)), magic, sizeof(magic)) != 0)
+    {
+        throw xlnt::exception("file is not a workbook snapshot");
+    }
+
+    const auto version = reader.u32();
+
+    if (version != format_version)
+    {
+        throw xlnt::unsupported("workbook snapshot version " + std::to_string(version) + " can't be read");
+    }
+
+    const auto stored_size = reader.u64();
+    package = reader.bytes(stored_size);
+    package_size = static_cast<std::size_t>(stored_size);
+
+    const auto count = reader.count(1);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto &sheet = sheets[reader.string()];
+        auto &sheet_data = sheet.data;
+        sheet_data.text = reader.string();
+        read_rows(reader, sheet_data.parsed_rows);
+        read_cells(reader, sheet_data.text.size(), sheet_data.parsed_cells);
+        read_cells(reader, sheet_data.text.size(), sheet_data.skipped_shared_formulae);
+        const auto formulae = reader.count(16);
+
+        for (std::size_t j = 0; j < formulae; ++j)
+        {
+            auto reference = reader.string();
+            sheet.array_formulae[reference] = reader.string();
+        }
+    }
+
+    if (!reader.at_end())
+    {
+        snapshot_reader::malformed();
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
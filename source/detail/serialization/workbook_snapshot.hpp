@@ -0,0 +1,76 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/xlnt_config_impl.hpp>
+#include <detail/serialization/serialisation_helpers.hpp>
+
+namespace xlnt {
+
+class manifest;
+
+namespace detail {
+
+/// <summary>
+/// The content of the sheetData element of a worksheet in a snapshot, as
+/// tokenize_sheet_data returned it when the snapshot was written.
+/// </summary>
+struct snapshot_sheet
+{
+    Sheet_Data data;
+    std::unordered_map<std::string, std::string> array_formulae;
+};
+
+/// <summary>
+/// The sheets of a snapshot by the path of their worksheet part.
+/// </summary>
+using snapshot_sheets = std::unordered_map<std::string, snapshot_sheet>;
+
+/// <summary>
+/// Writes a snapshot of the archive in package, a workbook saved without compression
+/// whose relationships are described by manifest, to snapshot. The sheetData of every
+/// worksheet is tokenized and stored as flat arrays of rows and cells, and the worksheet
+/// parts are stored with an empty sheetData element.
+/// </summary>
+XLNT_API_INTERNAL void write_snapshot(const std::vector<std::uint8_t> &package,
+    const manifest &manifest, std::vector<std::uint8_t> &snapshot);
+
+/// <summary>
+/// Reads the size bytes of a snapshot at data into sheets and sets package and
+/// package_size to the archive stored in it, which points into data. Throws
+/// unsupported if the snapshot was written in another version of the format and
+/// exception if it is malformed.
+/// </summary>
+XLNT_API_INTERNAL void read_snapshot(const std::uint8_t *data, std::size_t size,
+    const std::uint8_t *&package, std::size_t &package_size, snapshot_sheets &sheets);
+
+} // namespace detail
+} // namespace xlnt
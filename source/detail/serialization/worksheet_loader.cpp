@@ -0,0 +1,206 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+
+#include <xlnt/packaging/manifest.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/worksheet_loader.hpp>
+#include <detail/serialization/xlsx_consumer.hpp>
+#include <detail/serialization/zstream.hpp>
+
+namespace xlnt {
+namespace detail {
+
+worksheet_loader::worksheet_loader(std::vector<std::uint8_t> &&data, const load_options &options)
+    : data_(std::move(data)),
+      buffer_(data_.data(), data_.size()),
+      stream_(&buffer_),
+      archive_(new izstream(stream_, options.decompression_buffer_size)),
+      options_(options)
+{
+    archive_->max_part_size(options.max_part_size);
+
+    // the statistics and callbacks of the load may be gone by the time a
+    // worksheet is read
+    options_.stats = nullptr;
+    options_.progress = nullptr;
+    options_.worksheet_loaded = nullptr;
+}
+
+worksheet_loader::worksheet_loader(std::shared_ptr<byte_source> source, const load_options &options)
+    : buffer_(nullptr, 0),
+      source_(std::move(source)),
+      source_buffer_(new source_streambuf(*source_, options.source_block_size)),
+      stream_(source_buffer_.get()),
+      options_(options)
+{
+    // failed reads of the source are rethrown rather than ending the stream
+    stream_.exceptions(std::ios::badbit);
+    archive_.reset(new izstream(stream_, options.decompression_buffer_size));
+    archive_->max_part_size(options.max_part_size);
+
+    options_.stats = nullptr;
+    options_.progress = nullptr;
+    options_.worksheet_loaded = nullptr;
+}
+
+worksheet_loader::~worksheet_loader()
+{
+}
+
+std::shared_ptr<izstream> worksheet_loader::archive() const
+{
+    return archive_;
+}
+
+std::size_t worksheet_loader::memory_usage() const
+{
+    return sizeof(worksheet_loader) + data_.capacity() + (source_buffer_ ? source_buffer_->memory_usage() : 0)
+        + defined_names.capacity() * sizeof(defined_name);
+}
+
+void worksheet_loader::load(worksheet_impl &ws)
+{
+    if (!ws.load_pending_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    // threads reading the same workbook wait here until the worksheet has been read
+    const auto parent = ws.parent_.lock();
+    std::lock_guard<std::recursive_mutex> lock(parent->lazy_load_mutex_);
+
+    if (ws.copy_source_)
+    {
+        copy_cells(ws);
+        return;
+    }
+
+    if (!ws.loader_)
+    {
+        return;
+    }
+
+    // ws stops waiting first so that accessing it while it is read doesn't recurse
+    auto loader = std::move(ws.loader_);
+    ws.loader_.reset();
+
+    auto wb = workbook(parent);
+    xlsx_consumer consumer(wb, loader->options_);
+    consumer.archive_ = loader->archive_;
+    consumer.defined_names_ = loader->defined_names;
+    consumer.current_worksheet_ = &ws;
+
+    const auto &manifest = wb.manifest();
+    const auto workbook_rel = manifest.relationship(path("/"), relationship_type::office_document);
+    consumer.read_part({workbook_rel, manifest.relationship(workbook_rel.target().path(), ws.loader_rel_id_)});
+    ws.load_pending_.store(false, std::memory_order_release);
+}
+
+void worksheet_loader::copy_cells(worksheet_impl &ws)
+{
+    const auto source = std::move(ws.copy_source_);
+    ws.copy_source_.reset();
+
+    const auto parent = ws.parent_.lock();
+    const auto &copied_formats = parent->copied_formats_;
+    const auto engine = ws.cell_map_.engine();
+    auto found = false;
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(source->lazy_load_mutex_);
+
+        for (const auto &other : source->worksheets_)
+        {
+            if (other.id_ == ws.id_)
+            {
+                ws.cell_map_ = other.cell_map_;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    // the formats were copied along with the stylesheet when the clone was made, so a
+    // format which wasn't is one the source created afterwards
+    auto formats_known = true;
+
+    ws.cell_map_.for_each([&ws, &copied_formats, &formats_known](cell_impl &cell) {
+        cell.parent_ = &ws;
+
+        if (cell.format_.is_set())
+        {
+            const auto match = copied_formats.find(cell.format_.get()->serial);
+
+            if (match == copied_formats.end())
+            {
+                formats_known = false;
+                cell.format_.clear();
+            }
+            else
+            {
+                cell.format_ = match->second;
+            }
+        }
+    });
+
+    if (!found || !formats_known)
+    {
+        ws.cell_map_ = cell_store(engine);
+        ws.load_pending_.store(false, std::memory_order_release);
+
+        throw xlnt::exception(found ? "the cells of a copy on access clone were given new formats in its source"
+                                    : "a worksheet of a copy on access clone was removed from its source");
+    }
+
+    if (ws.cell_map_.engine() != engine)
+    {
+        ws.cell_map_.engine(engine);
+    }
+
+    ws.point_cells_at_comments();
+    ws.load_pending_.store(false, std::memory_order_release);
+
+    const auto waiting = std::any_of(parent->worksheets_.begin(), parent->worksheets_.end(),
+        [](const worksheet_impl &other) { return other.copy_source_ != nullptr; });
+
+    if (!waiting)
+    {
+        parent->copied_formats_.clear();
+    }
+}
+
+void worksheet_loader::load_all(workbook_impl &wb)
+{
+    for (auto &ws : wb.worksheets_)
+    {
+        load(ws);
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,118 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <xlnt/workbook/load_options.hpp>
+#include <detail/xlnt_config_impl.hpp>
+#include <detail/serialization/byte_streambuf.hpp>
+#include <detail/serialization/defined_name.hpp>
+#include <detail/serialization/vector_streambuf.hpp>
+
+namespace xlnt {
+
+class byte_source;
+
+namespace detail {
+
+class izstream;
+struct workbook_impl;
+struct worksheet_impl;
+
+/// <summary>
+/// Reads the worksheets of a workbook loaded with load_options::lazy_worksheets
+/// when they are first accessed. It owns a copy of the archive, or the byte_source
+/// it was loaded from, which every worksheet waiting to be read shares until the
+/// last of them has been read.
+/// The cells of the worksheets of a clone made with clone_method::copy_on_access
+/// are copied the same way.
+/// </summary>
+class XLNT_API_INTERNAL worksheet_loader
+{
+public:
+    /// <summary>
+    /// Opens the archive in data, which is taken over by the loader.
+    /// </summary>
+    worksheet_loader(std::vector<std::uint8_t> &&data, const load_options &options);
+
+    /// <summary>
+    /// Opens the archive in source, which is kept and only read for the parts needed.
+    /// </summary>
+    worksheet_loader(std::shared_ptr<byte_source> source, const load_options &options);
+
+    ~worksheet_loader();
+
+    worksheet_loader(const worksheet_loader &) = delete;
+    worksheet_loader &operator=(const worksheet_loader &) = delete;
+
+    /// <summary>
+    /// Returns the archive, which the consumer also reads the workbook parts from.
+    /// </summary>
+    std::shared_ptr<izstream> archive() const;
+
+    /// <summary>
+    /// Returns the approximate number of bytes held by the loader, mostly its copy of
+    /// the archive.
+    /// </summary>
+    std::size_t memory_usage() const;
+
+    /// <summary>
+    /// Reads or copies the content of ws if it is still waiting for it, otherwise does
+    /// nothing. The worksheet stops waiting even if reading it fails.
+    /// </summary>
+    static void load(worksheet_impl &ws);
+
+    /// <summary>
+    /// Reads every worksheet of wb which is still waiting to be read.
+    /// </summary>
+    static void load_all(workbook_impl &wb);
+
+    /// <summary>
+    /// The defined names of the workbook, which worksheets read their print titles,
+    /// print area and named ranges from.
+    /// </summary>
+    std::vector<defined_name> defined_names;
+
+private:
+    /// <summary>
+    /// Copies the cells of ws from the worksheet with the same id in its copy source,
+    /// pointing them at the formats of the workbook of ws.
+    /// </summary>
+    static void copy_cells(worksheet_impl &ws);
+
+    std::vector<std::uint8_t> data_;
+    memory_istreambuf buffer_;
+    std::shared_ptr<byte_source> source_;
+    std::unique_ptr<source_streambuf> source_buffer_;
+    std::istream stream_;
+    std::shared_ptr<izstream> archive_;
+    load_options options_;
+};
+
+} // namespace detail
+} // namespace xlnt
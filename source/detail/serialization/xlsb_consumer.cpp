@@ -0,0 +1,559 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/packaging/manifest.hpp>
+#include <xlnt/packaging/relationship.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/utils/calendar.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/page_setup.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/xlsb_consumer.hpp>
+#include <detail/serialization/zstream.hpp>
+#include <detail/unicode.hpp>
+
+namespace {
+
+// The record types of [MS-XLSB] 2.3 which are read, the others are skipped.
+const std::uint32_t brt_row_hdr = 0;
+const std::uint32_t brt_cell_blank = 1;
+const std::uint32_t brt_cell_rk = 2;
+const std::uint32_t brt_cell_error = 3;
+const std::uint32_t brt_cell_bool = 4;
+const std::uint32_t brt_cell_real = 5;
+const std::uint32_t brt_cell_st = 6;
+const std::uint32_t brt_cell_isst = 7;
+const std::uint32_t brt_fmla_string = 8;
+const std::uint32_t brt_fmla_num = 9;
+const std::uint32_t brt_fmla_bool = 10;
+const std::uint32_t brt_fmla_error = 11;
+const std::uint32_t brt_sst_item = 19;
+const std::uint32_t brt_fmt = 44;
+const std::uint32_t brt_xf = 47;
+const std::uint32_t brt_wb_prop = 153;
+const std::uint32_t brt_bundle_sh = 156;
+const std::uint32_t brt_begin_cell_xfs = 617;
+const std::uint32_t brt_end_cell_xfs = 618;
+
+const std::uint32_t max_column_index = 16384;
+const std::uint32_t max_row_index = 1048576;
+
+/// <summary>
+/// The data of one record, read from its start in little-endian order.
+/// </summary>
+class record
+{
+public:
+    record(std::uint32_t type, const char *begin, const char *end)
+        : type_(type), cursor_(begin), end_(end)
+    {
+    }
+
+    std::uint32_t type() const
+    {
+        return type_;
+    }
+
+    std::uint8_t read_u8()
+    {
+        check(1);
+        return static_cast<std::uint8_t>(*cursor_++);
+    }
+
+    std::uint16_t read_u16()
+    {
+        return static_cast<std::uint16_t>(read_bytes(2));
+    }
+
+    std::uint32_t read_u32()
+    {
+        return static_cast<std::uint32_t>(read_bytes(4));
+    }
+
+    double read_double()
+    {
+        const auto bits = read_bytes(8);
+        double value = 0;
+        std::memcpy(&value, &bits, sizeof(value));
+
+        return value;
+    }
+
+    // an XLWideString, a count of characters followed by them in UTF-16
+    std::string read_wide_string()
+    {
+        return read_characters(read_u32());
+    }
+
+    // an XLNullableWideString, which is empty if it's null
+    std::string read_nullable_wide_string()
+    {
+        const auto length = read_u32();
+        return length == 0xFFFFFFFF ? std::string() : read_characters(length);
+    }
+
+    void skip(std::size_t count)
+    {
+        check(count);
+        cursor_ += count;
+    }
+
+private:
+    std::uint64_t read_bytes(std::size_t count)
+    {
+        check(count);
+        std::uint64_t value = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(*cursor_++)) << (8 * i);
+        }
+
+        return value;
+    }
+
+    std::string read_characters(std::uint32_t length)
+    {
+        if (length > static_cast<std::size_t>(end_ - cursor_) / 2)
+        {
+            throw xlnt::invalid_file("truncated XLSB record");
+        }
+
+        std::u16string characters(length, u'\0');
+
+        for (auto &character : characters)
+        {
+            character = static_cast<char16_t>(read_u16());
+        }
+
+        return xlnt::detail::utf16_to_utf8(characters);
+    }
+
+    void check(std::size_t count) const
+    {
+        if (count > static_cast<std::size_t>(end_ - cursor_))
+        {
+            throw xlnt::invalid_file("truncated XLSB record");
+        }
+    }
+
+    std::uint32_t type_;
+    const char *cursor_;
+    const char *end_;
+};
+
+/// <summary>
+/// Splits a binary part into its records. The type and the size in the header of each
+/// record are variable length integers of seven bits per byte, the type taking up to
+/// two bytes and the size up to four.
+/// </summary>
+class record_reader
+{
+public:
+    explicit record_reader(const std::string &data)
+        : cursor_(data.data()), end_(data.data() + data.size())
+    {
+    }
+
+    bool at_end() const
+    {
+        return cursor_ == end_;
+    }
+
+    record next()
+    {
+        const auto type = read_varint(2);
+        const auto size = read_varint(4);
+
+        if (size > static_cast<std::size_t>(end_ - cursor_))
+        {
+            throw xlnt::invalid_file("truncated XLSB record");
+        }
+
+        const auto begin = cursor_;
+        cursor_ += size;
+
+        return record(type, begin, cursor_);
+    }
+
+private:
+    std::uint32_t read_varint(std::size_t max_bytes)
+    {
+        std::uint32_t value = 0;
+
+        for (std::size_t i = 0; i < max_bytes; ++i)
+        {
+            if (cursor_ == end_)
+            {
+                throw xlnt::invalid_file("truncated XLSB record");
+            }
+
+            const auto byte = static_cast<unsigned char>(*cursor_++);
+            value |= static_cast<std::uint32_t>(byte & 0x7F) << (7 * i);
+
+            if ((byte & 0x80) == 0) break;
+        }
+
+        return value;
+    }
+
+    const char *cursor_;
+    const char *end_;
+};
+
+// Decodes an RkNumber, a double or an integer in 30 bits, possibly multiplied by 100.
+double decode_rk(std::uint32_t rk)
+{
+    double value = 0;
+
+    if ((rk & 0x2) != 0)
+    {
+        value = static_cast<double>(static_cast<std::int32_t>(rk & 0xFFFFFFFC) / 4);
+    }
+    else
+    {
+        // the 30 bits are the most significant bits of the double
+        const auto bits = static_cast<std::uint64_t>(rk & 0xFFFFFFFC) << 32;
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+
+    return (rk & 0x1) != 0 ? value / 100 : value;
+}
+
+std::string error_text(std::uint8_t error)
+{
+    switch (error)
+    {
+    case 0x00:
+        return "#NULL!";
+    case 0x07:
+        return "#DIV/0!";
+    case 0x0F:
+        return "#VALUE!";
+    case 0x17:
+        return "#REF!";
+    case 0x1D:
+        return "#NAME?";
+    case 0x24:
+        return "#NUM!";
+    case 0x2A:
+        return "#N/A";
+    case 0x2B:
+        return "#GETTING_DATA";
+    default:
+        throw xlnt::invalid_file("unknown XLSB error value");
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const char *xlsb_consumer::workbook_content_type()
+{
+    return "application/vnd.ms-excel.sheet.binary.macroEnabled.main";
+}
+
+xlsb_consumer::xlsb_consumer(workbook &target, const izstream &archive, const load_options &options)
+    : target_(target), archive_(archive), options_(options)
+{
+}
+
+void xlsb_consumer::read()
+{
+    const auto package = target_.manifest();
+    const auto workbook_rel = package.relationship(path("/"), relationship_type::office_document);
+    const auto workbook_path = workbook_rel.target().path();
+
+    read_workbook(archive_.read(workbook_path));
+
+    if (sheets_.empty())
+    {
+        throw invalid_file("XLSB workbook without worksheets");
+    }
+
+    if (package.has_relationship(workbook_path, relationship_type::stylesheet))
+    {
+        read_styles(archive_.read(package.canonicalize(
+            {workbook_rel, package.relationship(workbook_path, relationship_type::stylesheet)})));
+    }
+
+    // the parts are rebuilt as those of an XLSX workbook and only the document properties,
+    // which are XML in both, are kept
+    auto wb = workbook::empty();
+
+    for (auto property : target_.core_properties())
+    {
+        wb.core_property(property, target_.core_property(property));
+    }
+
+    for (const auto &property : target_.custom_properties())
+    {
+        wb.custom_property(property, target_.custom_property(property));
+    }
+
+    if (date1904_)
+    {
+        wb.base_date(calendar::mac_1904);
+    }
+
+    auto &stylesheet = wb.d_->stylesheet_.get();
+
+    for (const auto &number_format : number_formats_)
+    {
+        const auto id = number_format.first;
+        auto same_id = [id](const xlnt::number_format &nf) { return nf.id() == id; };
+
+        if (std::find_if(stylesheet.number_formats.begin(), stylesheet.number_formats.end(), same_id)
+            == stylesheet.number_formats.end())
+        {
+            xlnt::number_format nf;
+            nf.format_string(number_format.second);
+            nf.id(number_format.first);
+            stylesheet.number_formats.push_back(nf);
+        }
+    }
+
+    // every cell format is the default format with its own number format, since fonts,
+    // fills and borders aren't read
+    const auto default_format = stylesheet.format_impls[0];
+
+    for (std::size_t index = 0; index < format_number_formats_.size(); ++index)
+    {
+        auto &format = index == 0 ? stylesheet.format_impls[0] : stylesheet.format_impls.push_back(default_format);
+        const auto number_format_id = format_number_formats_[index];
+
+        format.id = index;
+        format.number_format_id = number_format_id;
+        format.number_format_applied = number_format_id != 0;
+        format.date_format = stylesheet.is_date_format(number_format_id);
+        stylesheet.format_impls.refresh(index);
+        formats_.push_back(&format);
+    }
+
+    if (package.has_relationship(workbook_path, relationship_type::shared_string_table))
+    {
+        read_shared_strings(archive_.read(package.canonicalize(
+            {workbook_rel, package.relationship(workbook_path, relationship_type::shared_string_table)})), wb);
+    }
+
+    for (std::size_t index = 0; index < sheets_.size(); ++index)
+    {
+        auto ws = index == 0 ? wb.sheet_by_index(0) : wb.create_sheet();
+        ws.title(sheets_[index].title);
+        ws.sheet_state(sheets_[index].state == 0 ? sheet_state::visible
+                : sheets_[index].state == 1 ? sheet_state::hidden : sheet_state::very_hidden);
+    }
+
+    auto impl = wb.d_->worksheets_.begin();
+
+    for (const auto &sheet : sheets_)
+    {
+        auto &ws = *impl++;
+
+        // worksheets which aren't projected are left empty
+        if (!options_.sheets.empty()
+            && std::find(options_.sheets.begin(), options_.sheets.end(), sheet.title) == options_.sheets.end())
+        {
+            continue;
+        }
+
+        read_worksheet(archive_.read(package.canonicalize(
+            {workbook_rel, package.relationship(workbook_path, sheet.rel_id)})), ws);
+    }
+
+    target_.swap(wb);
+}
+
+void xlsb_consumer::read_workbook(const std::string &data)
+{
+    record_reader reader(data);
+
+    while (!reader.at_end())
+    {
+        auto current = reader.next();
+
+        if (current.type() == brt_wb_prop)
+        {
+            date1904_ = (current.read_u32() & 0x1) != 0;
+        }
+        else if (current.type() == brt_bundle_sh)
+        {
+            sheet new_sheet;
+            new_sheet.state = current.read_u32();
+            current.skip(4); // iTabID
+            new_sheet.rel_id = current.read_nullable_wide_string();
+            new_sheet.title = current.read_wide_string();
+            sheets_.push_back(std::move(new_sheet));
+        }
+    }
+}
+
+void xlsb_consumer::read_styles(const std::string &data)
+{
+    record_reader reader(data);
+    auto in_cell_formats = false;
+
+    while (!reader.at_end())
+    {
+        auto current = reader.next();
+
+        switch (current.type())
+        {
+        case brt_fmt: {
+            const auto id = current.read_u16();
+            auto format_string = current.read_wide_string();
+            number_formats_.emplace_back(id, format_string == "GENERAL" ? "General" : std::move(format_string));
+            break;
+        }
+        case brt_begin_cell_xfs:
+            in_cell_formats = true;
+            break;
+        case brt_end_cell_xfs:
+            in_cell_formats = false;
+            break;
+        case brt_xf:
+            // the formats of cell styles come first and aren't used by cells
+            if (in_cell_formats)
+            {
+                current.skip(2); // ixfeParent
+                format_number_formats_.push_back(current.read_u16());
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void xlsb_consumer::read_shared_strings(const std::string &data, workbook &wb)
+{
+    record_reader reader(data);
+
+    while (!reader.at_end())
+    {
+        auto current = reader.next();
+
+        if (current.type() == brt_sst_item)
+        {
+            current.skip(1); // whether formatting runs and phonetic text follow the text
+            wb.add_shared_string(rich_text(current.read_wide_string()), true);
+        }
+    }
+}
+
+void xlsb_consumer::read_worksheet(const std::string &data, worksheet_impl &ws)
+{
+    record_reader reader(data);
+    std::uint32_t row = 0;
+
+    while (!reader.at_end())
+    {
+        auto current = reader.next();
+        const auto type = current.type();
+
+        if (type == brt_row_hdr)
+        {
+            row = current.read_u32();
+            continue;
+        }
+
+        if (type < brt_cell_blank || type > brt_fmla_error)
+        {
+            continue;
+        }
+
+        // every cell record starts with a Cell structure: the column and the format
+        const auto column = current.read_u32();
+        const auto format = current.read_u32() & 0xFFFFFF;
+
+        if (column >= max_column_index || row >= max_row_index)
+        {
+            throw invalid_file("XLSB cell out of range");
+        }
+
+        cell_impl impl;
+        impl.parent_ = &ws;
+        impl.column_ = column_t(static_cast<column_t::index_t>(column + 1));
+        impl.row_ = static_cast<row_t>(row + 1);
+
+        if (format < formats_.size())
+        {
+            impl.format_ = formats_[format];
+        }
+
+        switch (type)
+        {
+        case brt_cell_blank:
+            break;
+        case brt_cell_rk:
+            impl.type_ = cell::type::number;
+            impl.value_number(decode_rk(current.read_u32()));
+            break;
+        case brt_cell_error:
+        case brt_fmla_error:
+            impl.type_ = cell::type::error;
+            impl.extension().value_text_.plain_text(error_text(current.read_u8()), false);
+            break;
+        case brt_cell_bool:
+        case brt_fmla_bool:
+            impl.type_ = cell::type::boolean;
+            impl.value_number(current.read_u8() != 0 ? 1.0 : 0.0);
+            break;
+        case brt_cell_real:
+        case brt_fmla_num:
+            impl.type_ = cell::type::number;
+            impl.value_number(current.read_double());
+            break;
+        case brt_cell_st:
+            impl.type_ = cell::type::inline_string;
+            impl.extension().value_text_ = rich_text(current.read_wide_string());
+            break;
+        case brt_cell_isst:
+            impl.type_ = cell::type::shared_string;
+            impl.value_number(static_cast<double>(current.read_u32()));
+            break;
+        case brt_fmla_string:
+            impl.type_ = cell::type::formula_string;
+            impl.extension().value_text_ = rich_text(current.read_wide_string());
+            break;
+        }
+
+        ws.cell_map_.emplace(cell_reference(impl.column_, impl.row_), std::move(impl));
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,101 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/workbook/load_options.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+
+class workbook;
+
+namespace detail {
+
+class izstream;
+struct format_impl;
+struct worksheet_impl;
+
+/// <summary>
+/// Reads the binary (BIFF12) parts of an XLSB workbook: the sheets of its workbook part,
+/// its shared strings, the number formats of its cell formats and the cell values of its
+/// worksheets. The package of an XLSB file is the same as that of an XLSX file, so
+/// xlsx_consumer reads its content types, relationships and document properties and hands
+/// over to this class when the office document turns out to be binary. The workbook is
+/// rebuilt as a new XLSX workbook, so it can be saved like any other. Formulas are read
+/// as their cached values since their parsed expressions aren't decoded.
+/// </summary>
+class XLNT_API_INTERNAL xlsb_consumer
+{
+public:
+    /// <summary>
+    /// The content type of the workbook part of an XLSB file.
+    /// </summary>
+    static const char *workbook_content_type();
+
+    /// <summary>
+    /// Reads into target, whose manifest xlsx_consumer has already read from archive.
+    /// </summary>
+    xlsb_consumer(workbook &target, const izstream &archive, const load_options &options);
+
+    /// <summary>
+    /// Reads the workbook part and the parts it refers to, replacing the content of the
+    /// target workbook.
+    /// </summary>
+    void read();
+
+private:
+    struct sheet
+    {
+        std::string title;
+        std::string rel_id;
+        std::uint32_t state = 0;
+    };
+
+    void read_workbook(const std::string &data);
+    void read_styles(const std::string &data);
+    void read_shared_strings(const std::string &data, workbook &wb);
+    void read_worksheet(const std::string &data, worksheet_impl &ws);
+
+    workbook &target_;
+    const izstream &archive_;
+    const load_options &options_;
+
+    std::vector<sheet> sheets_;
+    bool date1904_ = false;
+
+    // the custom number formats, and the number format of each cell format in order
+    std::vector<std::pair<std::uint16_t, std::string>> number_formats_;
+    std::vector<std::uint16_t> format_number_formats_;
+
+    // the format of each cell format index of the worksheets once the workbook is built
+    std::vector<format_impl *> formats_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,698 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/packaging/manifest.hpp>
+#include <xlnt/packaging/relationship.hpp>
+#include <xlnt/packaging/uri.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/page_setup.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/workbook_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/xlsb_consumer.hpp>
+#include <detail/serialization/xlsb_producer.hpp>
+#include <detail/serialization/zstream.hpp>
+#include <detail/unicode.hpp>
+#include <detail/utils/progress_reporter.hpp>
+
+namespace {
+
+// The record types of [MS-XLSB] 2.3 which are written.
+const std::uint32_t brt_row_hdr = 0;
+const std::uint32_t brt_cell_blank = 1;
+const std::uint32_t brt_cell_rk = 2;
+const std::uint32_t brt_cell_error = 3;
+const std::uint32_t brt_cell_bool = 4;
+const std::uint32_t brt_cell_real = 5;
+const std::uint32_t brt_cell_st = 6;
+const std::uint32_t brt_cell_isst = 7;
+const std::uint32_t brt_sst_item = 19;
+const std::uint32_t brt_font = 43;
+const std::uint32_t brt_fmt = 44;
+const std::uint32_t brt_fill = 45;
+const std::uint32_t brt_border = 46;
+const std::uint32_t brt_xf = 47;
+const std::uint32_t brt_style = 48;
+const std::uint32_t brt_begin_sheet = 129;
+const std::uint32_t brt_end_sheet = 130;
+const std::uint32_t brt_begin_book = 131;
+const std::uint32_t brt_end_book = 132;
+const std::uint32_t brt_begin_bundle_shs = 143;
+const std::uint32_t brt_end_bundle_shs = 144;
+const std::uint32_t brt_begin_sheet_data = 145;
+const std::uint32_t brt_end_sheet_data = 146;
+const std::uint32_t brt_ws_dim = 148;
+const std::uint32_t brt_wb_prop = 153;
+const std::uint32_t brt_bundle_sh = 156;
+const std::uint32_t brt_begin_sst = 159;
+const std::uint32_t brt_end_sst = 160;
+const std::uint32_t brt_begin_style_sheet = 278;
+const std::uint32_t brt_end_style_sheet = 279;
+const std::uint32_t brt_begin_dxfs = 505;
+const std::uint32_t brt_end_dxfs = 506;
+const std::uint32_t brt_begin_table_styles = 508;
+const std::uint32_t brt_end_table_styles = 509;
+const std::uint32_t brt_begin_fills = 603;
+const std::uint32_t brt_end_fills = 604;
+const std::uint32_t brt_begin_fonts = 611;
+const std::uint32_t brt_end_fonts = 612;
+const std::uint32_t brt_begin_borders = 613;
+const std::uint32_t brt_end_borders = 614;
+const std::uint32_t brt_begin_fmts = 615;
+const std::uint32_t brt_end_fmts = 616;
+const std::uint32_t brt_begin_cell_xfs = 617;
+const std::uint32_t brt_end_cell_xfs = 618;
+const std::uint32_t brt_begin_styles = 619;
+const std::uint32_t brt_end_styles = 620;
+const std::uint32_t brt_begin_cell_style_xfs = 626;
+const std::uint32_t brt_end_cell_style_xfs = 627;
+
+// the height of rows without properties, in twips
+const std::uint16_t default_row_height = 300;
+
+/// <summary>
+/// Writes records to a part, each as a header of its type and size as variable length
+/// integers of seven bits per byte followed by its data in little-endian order. The data
+/// of a record is collected by the write functions between begin and end.
+/// </summary>
+class record_writer
+{
+public:
+    explicit record_writer(std::streambuf &destination)
+        : destination_(destination)
+    {
+    }
+
+    void begin(std::uint32_t type)
+    {
+        type_ = type;
+        data_.clear();
+    }
+
+    void end()
+    {
+        header_.clear();
+        append_varint(header_, type_);
+        append_varint(header_, static_cast<std::uint32_t>(data_.size()));
+        put(header_);
+        put(data_);
+    }
+
+    // writes a record without data
+    void empty(std::uint32_t type)
+    {
+        begin(type);
+        end();
+    }
+
+    void write_u8(std::uint8_t value)
+    {
+        data_.push_back(static_cast<char>(value));
+    }
+
+    void write_u16(std::uint16_t value)
+    {
+        write_bytes(value, 2);
+    }
+
+    void write_u32(std::uint32_t value)
+    {
+        write_bytes(value, 4);
+    }
+
+    void write_double(double value)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(value));
+        write_bytes(bits, 8);
+    }
+
+    // an XLWideString, a count of characters followed by them in UTF-16
+    void write_wide_string(const std::string &text)
+    {
+        const auto characters = xlnt::detail::utf8_to_utf16(text);
+        write_u32(static_cast<std::uint32_t>(characters.size()));
+
+        for (auto character : characters)
+        {
+            write_u16(static_cast<std::uint16_t>(character));
+        }
+    }
+
+    // the Cell structure which starts every cell record: the column and the format
+    void write_cell(std::uint32_t column, std::uint32_t format)
+    {
+        write_u32(column);
+        write_u32(format & 0xFFFFFF);
+    }
+
+    // a BrtColor of the theme color index, which is also what Excel gives default fonts
+    void write_theme_color(std::uint8_t index)
+    {
+        write_u8(0x03 << 1);
+        write_u8(index);
+        write_u16(0); // nTintAndShade
+        write_u32(0xFF000000); // unused RGBA
+    }
+
+    void write_zeros(std::size_t count)
+    {
+        data_.append(count, '\0');
+    }
+
+private:
+    static void append_varint(std::string &buffer, std::uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void write_bytes(std::uint64_t value, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            data_.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void put(const std::string &bytes)
+    {
+        const auto size = static_cast<std::streamsize>(bytes.size());
+
+        if (destination_.sputn(bytes.data(), size) != size)
+        {
+            throw xlnt::exception("failed to write XLSB part");
+        }
+    }
+
+    std::streambuf &destination_;
+    std::uint32_t type_ = 0;
+    std::string header_;
+    std::string data_;
+};
+
+// Encodes value as an RkNumber if that is exact, an integer in 30 bits or a double
+// whose least significant 34 bits are zero.
+bool encode_rk(double value, std::uint32_t &rk)
+{
+    const double min_integer = -536870912.0; // -2^29
+    const double max_integer = 536870911.0;
+
+    if (value >= min_integer && value <= max_integer && std::floor(value) == value)
+    {
+        rk = (static_cast<std::uint32_t>(static_cast<std::int32_t>(value)) << 2) | 0x2;
+        return true;
+    }
+
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(value));
+
+    if ((bits & 0x3FFFFFFFFull) == 0)
+    {
+        rk = static_cast<std::uint32_t>(bits >> 32);
+        return true;
+    }
+
+    return false;
+}
+
+std::uint8_t error_code(const std::string &text)
+{
+    if (text == "#NULL!") return 0x00;
+    if (text == "#DIV/0!") return 0x07;
+    if (text == "#VALUE!") return 0x0F;
+    if (text == "#REF!") return 0x17;
+    if (text == "#NAME?") return 0x1D;
+    if (text == "#NUM!") return 0x24;
+    if (text == "#N/A") return 0x2A;
+    if (text == "#GETTING_DATA") return 0x2B;
+
+    throw xlnt::invalid_parameter("unknown error value");
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+xlsb_producer::xlsb_producer(const workbook &source, ozstream &archive, progress_reporter *progress)
+    : source_(source), archive_(archive), progress_(progress)
+{
+}
+
+void xlsb_producer::write(manifest &package)
+{
+    const auto workbook_part = path("/xl/workbook.bin");
+    const auto styles_part = path("/xl/styles.bin");
+    const auto shared_strings_part = path("/xl/sharedStrings.bin");
+    const uri workbook_uri(workbook_part.string());
+
+    package.register_override_type(workbook_part, xlsb_consumer::workbook_content_type());
+    package.register_relationship(uri("/"), relationship_type::office_document,
+        uri("xl/workbook.bin"), target_mode::internal);
+
+    std::vector<std::string> sheet_rel_ids;
+    std::vector<path> sheet_parts;
+
+    for (std::size_t index = 1; index <= source_.d_->worksheets_.size(); ++index)
+    {
+        const auto relative = "worksheets/sheet" + std::to_string(index) + ".bin";
+        sheet_parts.push_back(path("/xl").append(relative));
+        package.register_override_type(sheet_parts.back(), "application/vnd.ms-excel.worksheet");
+        sheet_rel_ids.push_back(package.register_relationship(workbook_uri,
+            relationship_type::worksheet, uri(relative), target_mode::internal));
+    }
+
+    package.register_override_type(styles_part, "application/vnd.ms-excel.styles");
+    package.register_relationship(workbook_uri, relationship_type::stylesheet,
+        uri("styles.bin"), target_mode::internal);
+
+    package.register_override_type(shared_strings_part, "application/vnd.ms-excel.sharedStrings");
+    package.register_relationship(workbook_uri, relationship_type::shared_string_table,
+        uri("sharedStrings.bin"), target_mode::internal);
+
+    write_workbook(workbook_part, sheet_rel_ids);
+    write_styles(styles_part);
+    write_shared_strings(shared_strings_part);
+
+    auto sheet_part = sheet_parts.begin();
+
+    for (const auto &ws : source_.d_->worksheets_)
+    {
+        write_worksheet(*sheet_part++, ws);
+    }
+}
+
+void xlsb_producer::write_workbook(const path &part, const std::vector<std::string> &sheet_rel_ids)
+{
+    auto streambuf = archive_.open(part);
+    record_writer writer(*streambuf);
+
+    writer.empty(brt_begin_book);
+
+    writer.begin(brt_wb_prop);
+    writer.write_u32(source_.base_date() == calendar::mac_1904 ? 0x1 : 0x0);
+    writer.write_u32(0); // dwThemeVersion
+    writer.write_wide_string(""); // strName, the code name
+    writer.end();
+
+    writer.empty(brt_begin_bundle_shs);
+
+    auto rel_id = sheet_rel_ids.begin();
+
+    for (const auto &ws : source_.d_->worksheets_)
+    {
+        const auto state = ws.page_setup_.is_set() ? ws.page_setup_.get().sheet_state() : sheet_state::visible;
+
+        writer.begin(brt_bundle_sh);
+        writer.write_u32(state == sheet_state::visible ? 0 : state == sheet_state::hidden ? 1 : 2);
+        writer.write_u32(static_cast<std::uint32_t>(rel_id - sheet_rel_ids.begin() + 1)); // iTabID
+        writer.write_wide_string(*rel_id++);
+        writer.write_wide_string(ws.title_);
+        writer.end();
+    }
+
+    writer.empty(brt_end_bundle_shs);
+    writer.empty(brt_end_book);
+}
+
+void xlsb_producer::write_styles(const path &part)
+{
+    auto streambuf = archive_.open(part);
+    record_writer writer(*streambuf);
+
+    const auto stylesheet = source_.d_->stylesheet_.is_set() ? &source_.d_->stylesheet_.get() : nullptr;
+
+    writer.empty(brt_begin_style_sheet);
+
+    // only the custom number formats are written, the built-in ones are implied by their ids
+    std::vector<const number_format *> custom_formats;
+
+    if (stylesheet != nullptr)
+    {
+        for (const auto &nf : stylesheet->number_formats)
+        {
+            if (nf.id() >= 164)
+            {
+                custom_formats.push_back(&nf);
+            }
+        }
+    }
+
+    writer.begin(brt_begin_fmts);
+    writer.write_u32(static_cast<std::uint32_t>(custom_formats.size()));
+    writer.end();
+
+    for (auto nf : custom_formats)
+    {
+        writer.begin(brt_fmt);
+        writer.write_u16(static_cast<std::uint16_t>(nf->id()));
+        writer.write_wide_string(nf->format_string());
+        writer.end();
+    }
+
+    writer.empty(brt_end_fmts);
+
+    // one font, the fills none and gray125 which Excel requires and one border
+    writer.begin(brt_begin_fonts);
+    writer.write_u32(1);
+    writer.end();
+
+    writer.begin(brt_font);
+    writer.write_u16(220); // dyHeight, 11pt in twips
+    writer.write_u16(0); // grbit
+    writer.write_u16(400); // bls, normal weight
+    writer.write_u16(0); // sss
+    writer.write_u8(0); // uls
+    writer.write_u8(2); // bFamily, swiss
+    writer.write_u8(0); // bCharSet
+    writer.write_u8(0);
+    writer.write_theme_color(1);
+    writer.write_u8(2); // bFontScheme, minor
+    writer.write_wide_string("Calibri");
+    writer.end();
+
+    writer.empty(brt_end_fonts);
+
+    writer.begin(brt_begin_fills);
+    writer.write_u32(2);
+    writer.end();
+
+    for (std::uint32_t pattern : {0x00u, 0x11u})
+    {
+        writer.begin(brt_fill);
+        writer.write_u32(pattern);
+        writer.write_theme_color(0);
+        writer.write_theme_color(0);
+        writer.write_zeros(4 + 5 * 8 + 4); // no gradient and its stops
+        writer.end();
+    }
+
+    writer.empty(brt_end_fills);
+
+    writer.begin(brt_begin_borders);
+    writer.write_u32(1);
+    writer.end();
+
+    writer.begin(brt_border);
+    writer.write_u8(0); // no diagonals
+    writer.write_zeros(5 * 10); // top, bottom, left, right and diagonal without lines
+    writer.end();
+
+    writer.empty(brt_end_borders);
+
+    // locked and bottom aligned, as are cells without a format
+    auto write_xf = [&writer](std::uint16_t parent, std::uint16_t number_format) {
+        writer.begin(brt_xf);
+        writer.write_u16(parent);
+        writer.write_u16(number_format);
+        writer.write_u16(0); // iFont
+        writer.write_u16(0); // iFill
+        writer.write_u16(0); // ixBorder
+        writer.write_u8(0); // trot
+        writer.write_u8(0); // indent
+        writer.write_u16((2 << 3) | (1 << 12)); // alcv bottom and fLocked
+        writer.write_u16(0);
+        writer.end();
+    };
+
+    writer.begin(brt_begin_cell_style_xfs);
+    writer.write_u32(1);
+    writer.end();
+    write_xf(0xFFFF, 0);
+    writer.empty(brt_end_cell_style_xfs);
+
+    const auto format_count = stylesheet == nullptr || stylesheet->format_impls.size() == 0
+        ? std::size_t(1)
+        : stylesheet->format_impls.size();
+
+    writer.begin(brt_begin_cell_xfs);
+    writer.write_u32(static_cast<std::uint32_t>(format_count));
+    writer.end();
+
+    if (stylesheet == nullptr || stylesheet->format_impls.size() == 0)
+    {
+        write_xf(0, 0);
+    }
+    else
+    {
+        for (const auto &format : stylesheet->format_impls)
+        {
+            write_xf(0, static_cast<std::uint16_t>(format.number_format_id.is_set() ? format.number_format_id.get() : 0));
+        }
+    }
+
+    writer.empty(brt_end_cell_xfs);
+
+    writer.begin(brt_begin_styles);
+    writer.write_u32(1);
+    writer.end();
+
+    writer.begin(brt_style);
+    writer.write_u32(0); // ixf
+    writer.write_u16(0x1); // fBuiltIn
+    writer.write_u8(0); // iStyBuiltIn, Normal
+    writer.write_u8(0xFF); // iLevel
+    writer.write_wide_string("Normal");
+    writer.end();
+
+    writer.empty(brt_end_styles);
+
+    writer.begin(brt_begin_dxfs);
+    writer.write_u32(0);
+    writer.end();
+    writer.empty(brt_end_dxfs);
+
+    writer.begin(brt_begin_table_styles);
+    writer.write_u32(0);
+    writer.write_wide_string("TableStyleMedium9");
+    writer.write_wide_string("PivotStyleLight16");
+    writer.end();
+    writer.empty(brt_end_table_styles);
+
+    writer.empty(brt_end_style_sheet);
+}
+
+void xlsb_producer::write_shared_strings(const path &part)
+{
+    auto streambuf = archive_.open(part);
+    record_writer writer(*streambuf);
+
+    const auto &strings = source_.shared_strings();
+    std::size_t string_count = 0;
+
+    for (const auto &ws : source_.d_->worksheets_)
+    {
+        ws.cell_map_.for_each([&string_count](const cell_impl &cell) {
+            if (cell.type_ == cell_type::shared_string)
+            {
+                ++string_count;
+            }
+        });
+    }
+
+    writer.begin(brt_begin_sst);
+    writer.write_u32(static_cast<std::uint32_t>(std::min<std::size_t>(string_count, 0xFFFFFFFF)));
+    writer.write_u32(static_cast<std::uint32_t>(strings.size()));
+    writer.end();
+
+    for (const auto &text : strings)
+    {
+        // the runs of rich text are joined into plain text
+        writer.begin(brt_sst_item);
+        writer.write_u8(0);
+        writer.write_wide_string(text.plain_text());
+        writer.end();
+    }
+
+    writer.empty(brt_end_sst);
+}
+
+void xlsb_producer::write_worksheet(const path &part, const worksheet_impl &ws)
+{
+    auto streambuf = archive_.open(part);
+    record_writer writer(*streambuf);
+
+    // every cell which will be written, ordered by row and then column
+    std::vector<const cell_impl *> cells;
+    cells.reserve(ws.cell_map_.size());
+    const auto collected = ws.cell_map_.collected();
+    ws.cell_map_.for_each([&cells, collected](const cell_impl &cell) {
+        if (collected || !cell.is_garbage_collectible())
+        {
+            cells.push_back(&cell);
+        }
+    });
+    std::sort(cells.begin(), cells.end(), [](const cell_impl *a, const cell_impl *b) {
+        return a->row_ < b->row_ || (a->row_ == b->row_ && a->column_ < b->column_);
+    });
+
+    writer.empty(brt_begin_sheet);
+
+    // the rows and columns are counted from 0
+    writer.begin(brt_ws_dim);
+
+    if (cells.empty())
+    {
+        writer.write_zeros(16);
+    }
+    else
+    {
+        auto first_column = cells.front()->column_;
+        auto last_column = first_column;
+
+        for (auto cell : cells)
+        {
+            first_column = std::min(first_column, cell->column_);
+            last_column = std::max(last_column, cell->column_);
+        }
+
+        writer.write_u32(cells.front()->row_ - 1);
+        writer.write_u32(cells.back()->row_ - 1);
+        writer.write_u32(first_column.index - 1);
+        writer.write_u32(last_column.index - 1);
+    }
+
+    writer.end();
+
+    writer.empty(brt_begin_sheet_data);
+
+    progress_reporter::worksheet_progress sheet_progress;
+
+    if (progress_ != nullptr)
+    {
+        sheet_progress.title = ws.title_;
+    }
+
+    auto row_begin = cells.begin();
+
+    while (row_begin != cells.end())
+    {
+        const auto row = (*row_begin)->row_;
+        auto row_end = row_begin;
+
+        while (row_end != cells.end() && (*row_end)->row_ == row)
+        {
+            ++row_end;
+        }
+
+        writer.begin(brt_row_hdr);
+        writer.write_u32(row - 1);
+        writer.write_u32(0); // ixfe
+        writer.write_u16(default_row_height);
+        writer.write_zeros(3); // flags
+        writer.write_u32(0); // ccolspan, the columns of the row aren't hinted
+        writer.end();
+
+        for (auto it = row_begin; it != row_end; ++it)
+        {
+            const auto &cell = **it;
+            const auto column = cell.column_.index - 1;
+            const auto format = cell.format_.is_set() ? static_cast<std::uint32_t>(cell.format_.get()->id) : 0u;
+
+            switch (cell.type_)
+            {
+            case cell_type::empty:
+                writer.begin(brt_cell_blank);
+                writer.write_cell(column, format);
+                break;
+            case cell_type::boolean:
+                writer.begin(brt_cell_bool);
+                writer.write_cell(column, format);
+                writer.write_u8(cell.value_number() != 0.0 ? 1 : 0);
+                break;
+            case cell_type::error:
+                writer.begin(brt_cell_error);
+                writer.write_cell(column, format);
+                writer.write_u8(error_code(cell.value_text().plain_text()));
+                break;
+            case cell_type::date:
+            case cell_type::number: {
+                std::uint32_t rk = 0;
+
+                if (encode_rk(cell.value_number(), rk))
+                {
+                    writer.begin(brt_cell_rk);
+                    writer.write_cell(column, format);
+                    writer.write_u32(rk);
+                }
+                else
+                {
+                    writer.begin(brt_cell_real);
+                    writer.write_cell(column, format);
+                    writer.write_double(cell.value_number());
+                }
+                break;
+            }
+            case cell_type::shared_string:
+                writer.begin(brt_cell_isst);
+                writer.write_cell(column, format);
+                writer.write_u32(static_cast<std::uint32_t>(cell.value_numeric_));
+                break;
+            case cell_type::inline_string:
+            case cell_type::formula_string:
+                writer.begin(brt_cell_st);
+                writer.write_cell(column, format);
+                writer.write_wide_string(cell.value_text().plain_text());
+                break;
+            }
+
+            writer.end();
+        }
+
+        if (progress_ != nullptr)
+        {
+            progress_->add_cells(sheet_progress, static_cast<std::size_t>(row_end - row_begin));
+        }
+
+        row_begin = row_end;
+    }
+
+    if (progress_ != nullptr)
+    {
+        progress_->finish(sheet_progress);
+    }
+
+    writer.empty(brt_end_sheet_data);
+    writer.empty(brt_end_sheet);
+}
+
+} // namespace detail
+} // namespace xlnt
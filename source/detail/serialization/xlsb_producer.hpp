@@ -0,0 +1,82 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+
+class manifest;
+class path;
+class workbook;
+
+namespace detail {
+
+class ozstream;
+class progress_reporter;
+struct worksheet_impl;
+
+/// <summary>
+/// Writes the binary (BIFF12) parts of an XLSB workbook: its workbook part with the
+/// sheets, its cell formats with their number formats, its shared strings and the cell
+/// values of its worksheets. The rest of the package, its content types, relationships
+/// and document properties, is XML as in an XLSX file, so xlsx_producer writes it from
+/// the manifest this class fills in. Formulas are written as their cached values and
+/// the fonts, fills, borders and alignments of the formats are left at their defaults,
+/// matching what xlsb_consumer reads back.
+/// </summary>
+class XLNT_API_INTERNAL xlsb_producer
+{
+public:
+    /// <summary>
+    /// Writes the parts of source to archive, reporting the cells written to progress
+    /// unless it is nullptr.
+    /// </summary>
+    xlsb_producer(const workbook &source, ozstream &archive, progress_reporter *progress);
+
+    /// <summary>
+    /// Writes the workbook part and the parts it refers to, registering their content
+    /// types and relationships in package, which mustn't have an office document yet.
+    /// </summary>
+    void write(manifest &package);
+
+private:
+    void write_workbook(const path &part, const std::vector<std::string> &sheet_rel_ids);
+    void write_styles(const path &part);
+    void write_shared_strings(const path &part);
+    void write_worksheet(const path &part, const worksheet_impl &ws);
+
+    const workbook &source_;
+    ozstream &archive_;
+    progress_reporter *progress_;
+};
+
+} // namespace detail
+} // namespace xlnt
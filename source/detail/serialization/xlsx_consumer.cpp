@@ -22,9 +22,18 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 
 #include <xlnt/cell/cell.hpp>
@@ -34,18 +43,32 @@
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/optional.hpp>
 #include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/cell_batch.hpp>
+#include <xlnt/workbook/column_batch.hpp>
 #include <xlnt/workbook/workbook.hpp>
+#include <xlnt/workbook/workbook_summary.hpp>
 #include <xlnt/worksheet/selection.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 #include <detail/constants.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
 #include <detail/implementations/workbook_impl.hpp>
+#include <detail/serialization/byte_streambuf.hpp>
+#include <detail/serialization/crc32.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
 #include <detail/serialization/defined_name.hpp>
+#include <detail/serialization/read_ahead_streambuf.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/xlsb_consumer.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
+#include <detail/serialization/worksheet_loader.hpp>
 #include <detail/serialization/zstream.hpp>
+#include <detail/utils/io_stats_recorder.hpp>
+#include <detail/utils/parallel_for.hpp>
+#include <detail/utils/spsc_queue.hpp>
+#include <detail/utils/trace.hpp>
 #include <detail/limits.hpp>
 #include <detail/serialization/parsers.hpp>
 
@@ -77,19 +100,42 @@ inline bool string_equal(const std::string &lhs, const char (&rhs)[N])
     return string_arr_loop_equal(lhs, rhs);
 }
 
-xml::qname &qn(const std::string &namespace_, const std::string &name)
+/// <summary>
+/// Expands to the qualified name of name, a string literal, in the namespace with the
+/// string literal id namespace_ in constants::ns. Every use is a constant built the
+/// first time it is reached, so matching an element doesn't build or look up any string,
+/// and worksheets can be read concurrently since the constants are never changed.
+/// </summary>
+#define XLNT_QN(namespace_, name) \
+    ([]() -> const xml::qname & { \
+        static const xml::qname qualified_name(xlnt::constants::ns(namespace_), name); \
+        return qualified_name; \
+    }())
+
+/// <summary>
+/// Sets the number of impl to number, which was parsed from the length characters at
+/// text, keeping it as an exact integer if it has no fraction or exponent.
+/// </summary>
+void assign_number(xlnt::detail::cell_impl &impl, double number, const char *text, std::size_t length)
 {
-    using qname_map = std::unordered_map<std::string, xml::qname>;
-    static auto memo = std::unordered_map<std::string, qname_map>();
+    // integers below 2^53 are exact as doubles, so only longer ones are parsed again
+    if (number == std::trunc(number) && std::abs(number) < 9007199254740992.0)
+    {
+        impl.value_integer(static_cast<std::int64_t>(number));
+        return;
+    }
 
-    auto &ns_memo = memo[namespace_];
+    const auto digits = text + (length > 0 && text[0] == '-' ? 1 : 0);
+    long long integer = 0;
 
-    if (ns_memo.find(name) == ns_memo.end())
+    if (digits != text + length && std::all_of(digits, text + length, [](char c) { return c >= '0' && c <= '9'; })
+        && xlnt::detail::parse(text, text + length, integer) == std::errc())
     {
-        return ns_memo.emplace(name, xml::qname(xlnt::constants::ns(namespace_), name)).first->second;
+        impl.value_integer(integer);
+        return;
     }
 
-    return ns_memo[name];
+    impl.value_number(number);
 }
 
 /// <summary>
@@ -121,6 +167,8 @@ bool is_valid_reference (const std::string &reference_string)
 }
 
 using style_id_pair = std::pair<xlnt::detail::style_impl, std::size_t>;
+using xlnt::detail::Cell_Projection;
+using xlnt::detail::Sheet_Data;
 
 /// <summary>
 /// Try to find given xfid value in the styles vector and, if succeeded, set's the optional style.
@@ -137,13 +185,6 @@ void set_style_by_xfid(const std::vector<style_id_pair> &styles,
     }
 }
 
-// <sheetData> element
-struct Sheet_Data
-{
-    std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> parsed_rows;
-    std::vector<xlnt::detail::Cell> parsed_cells;
-};
-
 xlnt::cell_type type_from_string(const std::string &str)
 {
     if (string_equal(str, "s"))
@@ -173,14 +214,18 @@ xlnt::cell_type type_from_string(const std::string &str)
     return xlnt::cell::type::shared_string;
 }
 
-xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xlnt::detail::sequential_column &columns, xml::parser *parser,
+    Sheet_Data &sheet_data, std::unordered_map<std::string, std::string> &array_formulae)
 {
     xlnt::detail::Cell c;
+    auto has_reference = false;
     for (auto &attr : parser->attribute_map())
     {
         if (string_equal(attr.first.name(), "r"))
         {
-            c.ref = xlnt::detail::Cell_Reference(row_arg, attr.second.value);
+            const auto &value = attr.second.value;
+            c.ref = xlnt::detail::Cell_Reference(row_arg, columns.resolve(value.data(), value.data() + value.size()));
+            has_reference = true;
         }
         else if (string_equal(attr.first.name(), "t"))
         {
@@ -199,6 +244,10 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::uno
             xlnt::detail::parse(attr.second.value, c.cell_metadata_idx);
         }
     }
+    if (!has_reference)
+    {
+        c.ref = xlnt::detail::Cell_Reference(row_arg, columns.next());
+    }
     int level = 1; // nesting level
         // 1 == <c>
         // 2 == <v>/<f>
@@ -212,12 +261,11 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::uno
         case xml::parser::start_element: {
             if (string_equal(parser->name(), "f") && parser->attribute_present("t"))
             {
-                // Skip shared formulas with a ref attribute because it indicates that this
-                // is the master cell which will be handled in the xml::parser::characters case.
-                if (parser->attribute("t") == "shared" && !parser->attribute_present("ref"))
+                // Only the master cell, the one with a ref attribute, carries the text of a
+                // shared formula. The other cells of the group are left with just its index.
+                if (parser->attribute("t") == "shared")
                 {
-                    auto shared_index = parser->attribute<int>("si");
-                    c.formula_string = shared_formulae[shared_index];
+                    c.shared_index = parser->attribute<int>("si");
                 }
             }
             ++level;
@@ -235,26 +283,16 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::uno
                 // <v> -> numeric values
                 if (string_equal(parser->name(), "v"))
                 {
-                    c.value += std::move(parser->value());
+                    sheet_data.append(c.value, parser->value());
                 }
                 // <f> formula
                 else if (string_equal(parser->name(), "f"))
                 {
-                    c.formula_string += std::move(parser->value());
+                    sheet_data.append(c.formula_string, parser->value());
 
-                    if (parser->attribute_present("t"))
+                    if (parser->attribute_present("t") && parser->attribute("t") == "array")
                     {
-                        auto formula_ref = parser->attribute("ref");
-                        auto formula_type = parser->attribute("t");
-                        if (formula_type == "shared")
-                        {
-                            auto shared_index = parser->attribute<int>("si");
-                            shared_formulae[shared_index] = c.formula_string;
-                        }
-                        else if (formula_type == "array")
-                        {
-                            array_formulae[formula_ref] = c.formula_string;
-                        }
+                        array_formulae[parser->attribute("ref")] = sheet_data.str(c.formula_string);
                     }
                 }
             }
@@ -263,7 +301,7 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::uno
                 // <is><t> -> inline string
                 if (string_equal(parser->name(), "t"))
                 {
-                    c.value += std::move(parser->value());
+                    sheet_data.append(c.value, parser->value());
                 }
             }
             break;
@@ -283,10 +321,26 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::uno
     return c;
 }
 
-// <row> inside <sheetData> element
-std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, std::vector<xlnt::detail::Cell> &parsed_cells, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+// Appends c to the parsed cells of sheet_data unless it is outside projection. The master
+// cell of a shared formula is still kept aside then to provide the text of its group.
+void add_parsed_cell(Sheet_Data &sheet_data, xlnt::detail::Cell &&c, const Cell_Projection &projection)
+{
+    if (projection.contains(c.ref))
+    {
+        sheet_data.parsed_cells.push_back(std::move(c));
+    }
+    else if (c.shared_index >= 0 && !c.formula_string.empty())
+    {
+        sheet_data.skipped_shared_formulae.push_back(std::move(c));
+    }
+}
+
+// <row> inside <sheetData> element, which is in implied_row if it has no r attribute
+std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, int implied_row, Sheet_Data &sheet_data,
+    std::unordered_map<std::string, std::string> &array_formulae, const Cell_Projection &projection)
 {
     std::pair<xlnt::row_properties, int> props;
+    props.second = implied_row;
     for (auto &attr : parser->attribute_map())
     {
         if (string_equal(attr.first.name(), "dyDescent"))
@@ -331,6 +385,7 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, std::vector<
         }
     }
 
+    xlnt::detail::sequential_column columns;
     int level = 1;
     while (level > 0)
     {
@@ -338,7 +393,7 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, std::vector<
         switch (e)
         {
         case xml::parser::start_element: {
-            parsed_cells.push_back(parse_cell(static_cast<xlnt::row_t>(props.second), parser, array_formulae, shared_formulae));
+            add_parsed_cell(sheet_data, parse_cell(static_cast<xlnt::row_t>(props.second), columns, parser, sheet_data, array_formulae), projection);
             break;
         }
         case xml::parser::end_element: {
@@ -363,9 +418,14 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, std::vector<
 }
 
 // <sheetData> inside <worksheet> element
-Sheet_Data parse_sheet_data(xml::parser *parser, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+// If batch_size is non-zero, flush is called with the rows and cells parsed so far
+// every time at least batch_size cells have accumulated, and the remainder is returned.
+Sheet_Data parse_sheet_data(xml::parser *parser, std::unordered_map<std::string, std::string> &array_formulae,
+    const Cell_Projection &projection = Cell_Projection(), std::size_t batch_size = 0,
+    const std::function<void(Sheet_Data &)> &flush = nullptr)
 {
     Sheet_Data sheet_data;
+    auto previous_row = 0;
     int level = 1; // nesting level
         // 1 == <sheetData>
         // 2 == <row>
@@ -376,7 +436,17 @@ Sheet_Data parse_sheet_data(xml::parser *parser, std::unordered_map<std::string,
         switch (e)
         {
         case xml::parser::start_element: {
-            sheet_data.parsed_rows.push_back(parse_row(parser, sheet_data.parsed_cells, array_formulae, shared_formulae));
+            auto row = parse_row(parser, previous_row + 1, sheet_data, array_formulae, projection);
+            previous_row = row.second;
+            if (projection.contains_row(static_cast<xlnt::row_t>(row.second)))
+            {
+                sheet_data.parsed_rows.push_back(std::move(row));
+            }
+            if (batch_size != 0 && sheet_data.parsed_cells.size() >= batch_size)
+            {
+                flush(sheet_data);
+                sheet_data.clear();
+            }
             break;
         }
         case xml::parser::end_element: {
@@ -400,6 +470,54 @@ Sheet_Data parse_sheet_data(xml::parser *parser, std::unordered_map<std::string,
     return sheet_data;
 }
 
+/// <summary>
+/// Returns the CRC-32 of the contents of the image read at key in the high half and
+/// their size in the low half, for finding images with the same contents.
+/// </summary>
+std::uint64_t image_contents_key(const xlnt::detail::workbook_impl &wb, const std::string &key)
+{
+    auto compressed = wb.compressed_images_.find(key);
+    std::uint32_t crc = 0;
+    std::uint64_t size = 0;
+
+    if (compressed != wb.compressed_images_.end())
+    {
+        crc = compressed->second.header.crc;
+        size = compressed->second.header.uncompressed_size;
+    }
+    else
+    {
+        const auto &image = wb.images_.at(key);
+        crc = xlnt::detail::compute_crc32(0, image.data(), image.size());
+        size = image.size();
+    }
+
+    return (static_cast<std::uint64_t>(crc) << 32) | (size & 0xFFFFFFFFu);
+}
+
+/// <summary>
+/// Returns true if the images read at first and second have the same contents. Images
+/// kept compressed are only compared as they were compressed.
+/// </summary>
+bool same_image_contents(const xlnt::detail::workbook_impl &wb, const std::string &first, const std::string &second)
+{
+    auto first_image = wb.images_.find(first);
+    auto second_image = wb.images_.find(second);
+
+    if (first_image != wb.images_.end() && second_image != wb.images_.end())
+    {
+        return first_image->second == second_image->second;
+    }
+
+    auto first_compressed = wb.compressed_images_.find(first);
+    auto second_compressed = wb.compressed_images_.find(second);
+
+    return first_compressed != wb.compressed_images_.end() && second_compressed != wb.compressed_images_.end()
+        && first_compressed->second.header.compression_type == second_compressed->second.header.compression_type
+        && first_compressed->second.header.uncompressed_size == second_compressed->second.header.uncompressed_size
+        && first_compressed->second.data == second_compressed->second.data;
+}
+
 } // namespace
 
 /*
@@ -424,24 +542,206 @@ namespace detail {
 
 xlsx_consumer::xlsx_consumer(workbook &target)
     : target_(target),
+      limits_(std::make_shared<load_limits>(options_)),
+      parser_(nullptr)
+{
+}
+
+xlsx_consumer::xlsx_consumer(workbook &target, const load_options &options)
+    : target_(target),
+      options_(options),
+      limits_(std::make_shared<load_limits>(options_)),
       parser_(nullptr)
 {
+    if (options_.progress)
+    {
+        progress_ = std::make_shared<progress_reporter>(options_.progress, options_.progress_interval);
+    }
+
+    if (options_.rows.is_set())
+    {
+        projection_.first_row = options_.rows.get().first;
+        projection_.last_row = options_.rows.get().second;
+    }
+
+    if (options_.columns.is_set())
+    {
+        projection_.first_column = options_.columns.get().first.index;
+        projection_.last_column = options_.columns.get().second.index;
+    }
 }
 
 xlsx_consumer::~xlsx_consumer()
 {
 }
 
+void xlsx_consumer::reuse(std::shared_ptr<load_buffers> buffers)
+{
+    buffers_ = std::move(buffers);
+}
+
+void xlsx_consumer::read_snapshot(std::istream &source, snapshot_sheets &sheets)
+{
+    snapshot_sheets_ = &sheets;
+    read(source);
+    snapshot_sheets_ = nullptr;
+}
+
 void xlsx_consumer::read(std::istream &source)
 {
-    archive_.reset(new izstream(source));
+    phase_timer timer(options_.stats, &io_stats::total);
+
+    if (options_.lazy_worksheets)
+    {
+        // the worksheets are read after source may be gone, so the loader keeps a copy of it
+        std::vector<std::uint8_t> data;
+        auto memory = dynamic_cast<memory_istreambuf *>(source.rdbuf());
+
+        if (memory != nullptr)
+        {
+            data.assign(memory->data(), memory->data() + memory->size());
+        }
+        else
+        {
+            data.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+        }
+
+        phase_timer archive_timer(options_.stats, &io_stats::archive);
+        archive_timer.add_bytes(data.size());
+        worksheet_loader_ = std::make_shared<worksheet_loader>(std::move(data), options_);
+        archive_ = worksheet_loader_->archive();
+    }
+    else
+    {
+        archive_.reset(new izstream(source, options_.decompression_buffer_size, options_.stats));
+        archive_->max_part_size(options_.max_part_size);
+        archive_->reuse(buffers_);
+    }
+
+    populate_workbook(false);
+    record_loaded_counts();
+}
+
+void xlsx_consumer::read(std::shared_ptr<byte_source> source)
+{
+    if (!options_.lazy_worksheets)
+    {
+        source_streambuf buffer(*source, options_.source_block_size);
+        std::istream stream(&buffer);
+        stream.exceptions(std::ios::badbit);
+        read(stream);
+
+        return;
+    }
+
+    phase_timer timer(options_.stats, &io_stats::total);
+
+    {
+        // only the central directory is read here, the parts are fetched as they're read
+        phase_timer archive_timer(options_.stats, &io_stats::archive);
+        worksheet_loader_ = std::make_shared<worksheet_loader>(std::move(source), options_);
+        archive_ = worksheet_loader_->archive();
+    }
+
     populate_workbook(false);
+    record_loaded_counts();
 }
 
 void xlsx_consumer::open(std::istream &source)
 {
-    archive_.reset(new izstream(source));
+    phase_timer timer(options_.stats, &io_stats::total);
+    archive_.reset(new izstream(source, options_.decompression_buffer_size, options_.stats, options_.forward_only));
+    archive_->max_part_size(options_.max_part_size);
+    populate_workbook(true);
+    record_loaded_counts();
+}
+
+workbook_summary xlsx_consumer::peek(std::istream &source)
+{
+    archive_.reset(new izstream(source, options_.decompression_buffer_size));
+    archive_->max_part_size(options_.max_part_size);
+    peeking_ = true;
     populate_workbook(true);
+
+    workbook_summary summary;
+
+    for (auto property : target_.core_properties())
+    {
+        summary.core_properties.emplace_back(property, target_.core_property(property));
+    }
+
+    std::vector<std::string> titles(sheet_title_index_map_.size());
+
+    for (const auto &title : sheet_title_index_map_)
+    {
+        titles[title.second] = title.first;
+    }
+
+    const auto workbook_rel = manifest().relationship(path("/"), relationship_type::office_document);
+    const auto workbook_path = workbook_rel.target().path();
+    const auto &hidden = target_.d_->sheet_hidden_;
+
+    for (std::size_t index = 0; index < titles.size(); ++index)
+    {
+        sheet_summary sheet;
+        sheet.title = titles[index];
+        sheet.hidden = index < hidden.size() && hidden[index];
+
+        const auto &rel_id = target_.d_->sheet_title_rel_id_map_.at(sheet.title);
+        const auto sheet_rel = manifest().relationship(workbook_path, rel_id);
+        const auto part_path = manifest().canonicalize({workbook_rel, sheet_rel});
+
+        if (sheet_rel.type() == relationship_type::worksheet && archive_->has_file(part_path))
+        {
+            // only the start of the part is inflated, the dimension comes before sheetData
+            auto part_streambuf = archive_->open(part_path);
+            std::istream part_stream(part_streambuf.get());
+            xml::parser parser(part_stream, part_path.string(),
+                xml::parser::receive_elements | xml::parser::receive_attributes_map);
+
+            for (auto event = parser.next(); event != xml::parser::eof; event = parser.next())
+            {
+                if (event != xml::parser::start_element)
+                {
+                    continue;
+                }
+
+                if (parser.name() == "dimension")
+                {
+                    sheet.dimension = range_reference(parser.attribute("ref"));
+                    break;
+                }
+                else if (parser.name() == "sheetData")
+                {
+                    break;
+                }
+
+                parser.attribute_map();
+            }
+        }
+
+        summary.sheets.push_back(std::move(sheet));
+    }
+
+    return summary;
+}
+
+void xlsx_consumer::record_loaded_counts()
+{
+    if (options_.stats == nullptr)
+    {
+        return;
+    }
+
+    auto cells = std::size_t(0);
+
+    for (const auto &ws : target_.d_->worksheets_)
+    {
+        cells += ws.cell_map_.size();
+    }
+
+    record_counts(options_.stats, cells, target_.d_->shared_strings_values_.size(),
+        target_.d_->stylesheet_.is_set() ? target_.d_->stylesheet_.get().format_impls.size() : 0);
 }
 
 cell xlsx_consumer::read_cell()
@@ -449,6 +749,205 @@ cell xlsx_consumer::read_cell()
     return cell(streaming_cell_.get());
 }
 
+namespace {
+
+// Appends the cells read by xlsx_consumer::read_batch_rows to a cell_batch.
+class cell_batch_appender
+{
+public:
+    explicit cell_batch_appender(xlnt::cell_batch &batch)
+        : batch_(batch)
+    {
+    }
+
+    void operator()(xlnt::row_t row, xlnt::column_t::index_t column,
+        xlnt::cell_type type, double number, const std::string &text)
+    {
+        const auto index = string_index(batch_.strings, type, number, text);
+
+        batch_.rows.push_back(row);
+        batch_.columns.push_back(column);
+        batch_.types.push_back(type);
+        batch_.numbers.push_back(type == xlnt::cell_type::shared_string ? 0.0 : number);
+        batch_.indices.push_back(index);
+    }
+
+    // Returns the shared string index of shared_string cells, carried in number, or
+    // adds the text of the other string cells to strings and returns its index.
+    static std::uint32_t string_index(std::vector<std::string> &strings,
+        xlnt::cell_type type, double number, const std::string &text)
+    {
+        switch (type)
+        {
+        case xlnt::cell_type::shared_string:
+            return static_cast<std::uint32_t>(number);
+        case xlnt::cell_type::inline_string:
+        case xlnt::cell_type::formula_string:
+        case xlnt::cell_type::error:
+            strings.push_back(text);
+            return static_cast<std::uint32_t>(strings.size() - 1);
+        case xlnt::cell_type::empty:
+        case xlnt::cell_type::boolean:
+        case xlnt::cell_type::date:
+        case xlnt::cell_type::number:
+            break;
+        }
+
+        return 0;
+    }
+
+private:
+    xlnt::cell_batch &batch_;
+};
+
+// Appends the cells read by xlsx_consumer::read_batch_rows to the columns of a
+// column_batch, padding the columns a row has no cell in with empty values.
+class column_batch_appender
+{
+public:
+    explicit column_batch_appender(xlnt::column_batch &batch)
+        : batch_(batch)
+    {
+    }
+
+    void operator()(xlnt::row_t row, xlnt::column_t::index_t column,
+        xlnt::cell_type type, double number, const std::string &text)
+    {
+        if (batch_.rows.empty() || batch_.rows.back() != row)
+        {
+            begin_row(row);
+        }
+
+        // the cells of a row are in ascending column order like the columns
+        while (next_column_ < batch_.columns.size() && batch_.columns[next_column_].index < column)
+        {
+            ++next_column_;
+        }
+
+        if (next_column_ == batch_.columns.size() || batch_.columns[next_column_].index != column)
+        {
+            insert_column(column);
+        }
+
+        auto &values = batch_.columns[next_column_];
+        values.types.back() = type;
+        values.numbers.back() = type == xlnt::cell_type::shared_string ? 0.0 : number;
+        values.indices.back() = cell_batch_appender::string_index(batch_.strings, type, number, text);
+    }
+
+private:
+    void begin_row(xlnt::row_t row)
+    {
+        batch_.rows.push_back(row);
+        next_column_ = 0;
+
+        for (auto &values : batch_.columns)
+        {
+            values.types.push_back(xlnt::cell_type::empty);
+            values.numbers.push_back(0.0);
+            values.indices.push_back(0);
+        }
+    }
+
+    void insert_column(xlnt::column_t::index_t column)
+    {
+        xlnt::column_batch::column values;
+        values.index = column;
+        values.types.assign(batch_.rows.size(), xlnt::cell_type::empty);
+        values.numbers.assign(batch_.rows.size(), 0.0);
+        values.indices.assign(batch_.rows.size(), 0);
+
+        batch_.columns.insert(batch_.columns.begin() + static_cast<std::ptrdiff_t>(next_column_), std::move(values));
+    }
+
+    xlnt::column_batch &batch_;
+    std::size_t next_column_ = 0;
+};
+
+} // namespace
+
+std::size_t xlsx_consumer::read_rows(cell_batch &batch, std::size_t row_count)
+{
+    batch.clear();
+    cell_batch_appender append(batch);
+
+    return read_batch_rows(append, row_count);
+}
+
+std::size_t xlsx_consumer::read_columns(column_batch &batch, std::size_t row_count)
+{
+    batch.clear();
+    column_batch_appender append(batch);
+
+    return read_batch_rows(append, row_count);
+}
+
+template <typename Appender>
+std::size_t xlsx_consumer::read_batch_rows(Appender &append, std::size_t row_count)
+{
+    if (!streaming_cell_ || row_count == 0)
+    {
+        return 0;
+    }
+
+    std::size_t rows_read = 0;
+
+    // appends the cells of streaming_batch_ which haven't been handed out by has_cell() yet
+    auto append_row = [&]() {
+        for (; streaming_next_ < streaming_batch_.parsed_cells.size(); ++streaming_next_)
+        {
+            const auto &parsed_cell = streaming_batch_.parsed_cells[streaming_next_];
+            const auto parsed_number = numbers_[streaming_next_];
+            const auto value = streaming_batch_.data(parsed_cell.value);
+            auto type = parsed_cell.value.empty() ? cell::type::empty : parsed_cell.type;
+            auto number = 0.0;
+
+            switch (type)
+            {
+            case cell::type::boolean:
+                number = is_true(streaming_batch_.str(parsed_cell.value)) ? 1.0 : 0.0;
+                break;
+            case cell::type::number:
+            case cell::type::date:
+                number = parsed_number;
+                break;
+            case cell::type::shared_string: {
+                long long index = -1;
+                if (xlnt::detail::parse(value, value + parsed_cell.value.length, index) == std::errc())
+                {
+                    number = static_cast<double>(index);
+                }
+                break;
+            }
+            case cell::type::empty:
+            case cell::type::inline_string:
+            case cell::type::formula_string:
+            case cell::type::error:
+                break;
+            }
+
+            append(parsed_cell.ref.row, parsed_cell.ref.column, type, number, streaming_batch_.str(parsed_cell.value));
+        }
+
+        streaming_row_open_ = false;
+        ++rows_read;
+    };
+
+    // finish a row partially read through has_cell() one cell at a time
+    if (streaming_row_open_)
+    {
+        append_row();
+    }
+
+    // the remaining rows are parsed with the same decoder, without constructing their cells
+    while (rows_read < row_count && read_next_row())
+    {
+        append_row();
+    }
+
+    return rows_read;
+}
+
 void xlsx_consumer::read_worksheet(const std::string &rel_id)
 {
     read_worksheet_begin(rel_id);
@@ -456,13 +955,18 @@ void xlsx_consumer::read_worksheet(const std::string &rel_id)
     if (!streaming_)
     {
         read_worksheet_sheetdata();
-        read_worksheet_end(rel_id);
+        auto ws = read_worksheet_end(rel_id);
+
+        if (options_.worksheet_loaded)
+        {
+            options_.worksheet_loaded(ws);
+        }
     }
 }
 
-void read_defined_names(worksheet ws, std::vector<defined_name> defined_names)
+void read_defined_names(worksheet ws, const std::vector<defined_name> &defined_names)
 {
-    for (auto &name : defined_names)
+    for (const auto &name : defined_names)
     {
         if (name.sheet_id != ws.id() - 1)
         {
@@ -547,7 +1051,12 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
     }
 
     array_formulae_.clear();
-    shared_formulae_.clear();
+    shared_formula_groups_.clear();
+    dimension_.clear();
+    streaming_row_ = 0;
+    streaming_batch_.clear();
+    streaming_next_ = 0;
+    streaming_row_open_ = false;
 
     auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
         target_.d_->sheet_title_rel_id_map_.end(),
@@ -557,16 +1066,21 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
 
     auto ws = worksheet(current_worksheet_);
 
-    expect_start_element(qn("spreadsheetml", "worksheet"), xml::content::complex); // CT_Worksheet
-    skip_attributes({qn("mc", "Ignorable")});
+    expect_start_element(XLNT_QN("spreadsheetml", "worksheet"), xml::content::complex); // CT_Worksheet
+    skip_attributes({XLNT_QN("mc", "Ignorable")});
 
     read_defined_names(ws, defined_names_);
 
-    while (in_element(qn("spreadsheetml", "worksheet")))
+    while (in_element(XLNT_QN("spreadsheetml", "worksheet")))
     {
         auto current_worksheet_element = expect_start_element(xml::content::complex);
 
-        if (current_worksheet_element == qn("spreadsheetml", "sheetPr")) // CT_SheetPr 0-1
+        if (options_.values_only && current_worksheet_element != XLNT_QN("spreadsheetml", "dimension")
+            && current_worksheet_element != XLNT_QN("spreadsheetml", "sheetData"))
+        {
+            skip_remaining_content(current_worksheet_element);
+        }
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sheetPr")) // CT_SheetPr 0-1
         {
             sheet_pr props;
             if (parser().attribute_present("syncHorizontal"))
@@ -610,18 +1124,18 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
             {
                 auto sheet_pr_child_element = expect_start_element(xml::content::simple);
 
-                if (sheet_pr_child_element == qn("spreadsheetml", "tabColor")) // CT_Color 0-1
+                if (sheet_pr_child_element == XLNT_QN("spreadsheetml", "tabColor")) // CT_Color 0-1
                 {
                     read_color();
                 }
-                else if (sheet_pr_child_element == qn("spreadsheetml", "outlinePr")) // CT_OutlinePr 0-1
+                else if (sheet_pr_child_element == XLNT_QN("spreadsheetml", "outlinePr")) // CT_OutlinePr 0-1
                 {
                     skip_attribute("applyStyles"); // optional, boolean, false
                     skip_attribute("summaryBelow"); // optional, boolean, true
                     skip_attribute("summaryRight"); // optional, boolean, true
                     skip_attribute("showOutlineSymbols"); // optional, boolean, true
                 }
-                else if (sheet_pr_child_element == qn("spreadsheetml", "pageSetUpPr")) // CT_PageSetUpPr 0-1
+                else if (sheet_pr_child_element == XLNT_QN("spreadsheetml", "pageSetUpPr")) // CT_PageSetUpPr 0-1
                 {
                     skip_attribute("autoPageBreaks"); // optional, boolean, true
                     skip_attribute("fitToPage"); // optional, boolean, false
@@ -634,15 +1148,24 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                 expect_end_element(sheet_pr_child_element);
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "dimension")) // CT_SheetDimension 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "dimension")) // CT_SheetDimension 0-1
         {
+            try
+            {
+                dimension_ = range_reference(parser().attribute("ref"));
+            }
+            catch (const xlnt::exception &)
+            {
+                // the dimension is only a hint for reserving memory
+            }
+
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "sheetViews")) // CT_SheetViews 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sheetViews")) // CT_SheetViews 0-1
         {
             while (in_element(current_worksheet_element))
             {
-                expect_start_element(qn("spreadsheetml", "sheetView"), xml::content::complex); // CT_SheetView 1+
+                expect_start_element(XLNT_QN("spreadsheetml", "sheetView"), xml::content::complex); // CT_SheetView 1+
 
                 sheet_view new_view;
                 new_view.id(parser().attribute<std::size_t>("workbookViewId"));
@@ -684,11 +1207,11 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                     "view", "topLeftCell", "colorId", "zoomScaleNormal", "zoomScaleSheetLayoutView",
                     "zoomScalePageLayoutView"});
 
-                while (in_element(qn("spreadsheetml", "sheetView")))
+                while (in_element(XLNT_QN("spreadsheetml", "sheetView")))
                 {
                     auto sheet_view_child_element = expect_start_element(xml::content::simple);
 
-                    if (sheet_view_child_element == qn("spreadsheetml", "pane")) // CT_Pane 0-1
+                    if (sheet_view_child_element == XLNT_QN("spreadsheetml", "pane")) // CT_Pane 0-1
                     {
                         pane new_pane;
 
@@ -719,7 +1242,7 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
 
                         new_view.pane(new_pane);
                     }
-                    else if (sheet_view_child_element == qn("spreadsheetml", "selection")) // CT_Selection 0-4
+                    else if (sheet_view_child_element == XLNT_QN("spreadsheetml", "selection")) // CT_Selection 0-4
                     {
                         selection current_selection;
 
@@ -742,11 +1265,11 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
 
                         skip_remaining_content(sheet_view_child_element);
                     }
-                    else if (sheet_view_child_element == qn("spreadsheetml", "pivotSelection")) // CT_PivotSelection 0-4
+                    else if (sheet_view_child_element == XLNT_QN("spreadsheetml", "pivotSelection")) // CT_PivotSelection 0-4
                     {
                         skip_remaining_content(sheet_view_child_element);
                     }
-                    else if (sheet_view_child_element == qn("spreadsheetml", "extLst")) // CT_ExtensionList 0-1
+                    else if (sheet_view_child_element == XLNT_QN("spreadsheetml", "extLst")) // CT_ExtensionList 0-1
                     {
                         skip_remaining_content(sheet_view_child_element);
                     }
@@ -758,12 +1281,12 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                     expect_end_element(sheet_view_child_element);
                 }
 
-                expect_end_element(qn("spreadsheetml", "sheetView"));
+                expect_end_element(XLNT_QN("spreadsheetml", "sheetView"));
 
                 ws.d_->views_.push_back(new_view);
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "sheetFormatPr")) // CT_SheetFormatPr 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sheetFormatPr")) // CT_SheetFormatPr 0-1
         {
             if (parser().attribute_present("baseColWidth"))
             {
@@ -781,19 +1304,19 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                     xlnt::detail::deserialise(parser().attribute("defaultRowHeight"));
             }
 
-            if (parser().attribute_present(qn("x14ac", "dyDescent")))
+            if (parser().attribute_present(XLNT_QN("x14ac", "dyDescent")))
             {
                 ws.d_->format_properties_.dy_descent =
-                    xlnt::detail::deserialise(parser().attribute(qn("x14ac", "dyDescent")));
+                    xlnt::detail::deserialise(parser().attribute(XLNT_QN("x14ac", "dyDescent")));
             }
 
             skip_attributes();
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "cols")) // CT_Cols 0+
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "cols")) // CT_Cols 0+
         {
-            while (in_element(qn("spreadsheetml", "cols")))
+            while (in_element(XLNT_QN("spreadsheetml", "cols")))
             {
-                expect_start_element(qn("spreadsheetml", "col"), xml::content::simple);
+                expect_start_element(XLNT_QN("spreadsheetml", "col"), xml::content::simple);
 
                 skip_attributes(std::vector<std::string>{"collapsed", "outlineLevel"});
 
@@ -836,7 +1359,7 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                     ? is_true(parser().attribute("bestFit"))
                     : false;
 
-                expect_end_element(qn("spreadsheetml", "col"));
+                expect_end_element(XLNT_QN("spreadsheetml", "col"));
 
                 for (auto column = min; column <= max; column++)
                 {
@@ -859,7 +1382,7 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                 }
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "sheetData")) // CT_SheetData 1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sheetData")) // CT_SheetData 1
         {
             return title;
         }
@@ -872,78 +1395,387 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
 
 void xlsx_consumer::read_worksheet_sheetdata()
 {
-    if (stack_.back() != qn("spreadsheetml", "sheetData"))
+    if (stack_.back() != XLNT_QN("spreadsheetml", "sheetData"))
     {
         return;
     }
 
-    auto ws_data = parse_sheet_data(parser_, array_formulae_, shared_formulae_);
-    // NOTE: parse->construct are seperated here and could easily be threaded
-    // with a SPSC queue for what is likely to be an easy performance win
-    for (auto &row : ws_data.parsed_rows)
+    XLNT_TRACE_SCOPE("read_worksheet_sheetdata");
+    phase_timer timer(options_.stats, &io_stats::sheet_data);
+    reserve_sheet_data();
+
+    progress_reporter::worksheet_progress sheet_progress;
+
+    if (progress_)
     {
-        current_worksheet_->row_properties_.emplace(row.second, std::move(row.first));
+        sheet_progress.title = current_worksheet_->title_;
     }
-    auto impl = detail::cell_impl();
-    for (Cell &cell : ws_data.parsed_cells)
+
+    if (options_.pipelined_sheet_data)
     {
-        impl.parent_ = current_worksheet_;
-        impl.column_ = cell.ref.column;
-        impl.row_ = cell.ref.row;
-        detail::cell_impl *ws_cell_impl = &current_worksheet_->cell_map_.emplace(cell_reference(impl.column_, impl.row_), std::move(impl)).first->second;
-        if (cell.style_index != -1)
-        {
-            ws_cell_impl->format_ = target_.format(static_cast<size_t>(cell.style_index)).d_;
-        }
-        if (cell.cell_metadata_idx != -1)
+        read_worksheet_sheetdata_pipelined(sheet_progress);
+    }
+    else
+    {
+        // cells are constructed batch by batch so the whole sheet is never staged at once
+        auto construct = [&](Sheet_Data &batch) {
+            limits_->add_cells(batch.parsed_cells.size());
+            construct_sheet_data(batch);
+
+            if (progress_)
+            {
+                progress_->add_cells(sheet_progress, batch.parsed_cells.size());
+            }
+        };
+        auto remainder = read_sheet_data_rows(std::max<std::size_t>(options_.sheet_data_batch_size, 1), construct);
+        limits_->add_cells(remainder.parsed_cells.size());
+        construct_sheet_data(remainder);
+        sheet_progress.cells += remainder.parsed_cells.size();
+    }
+
+    if (progress_)
+    {
+        progress_->finish(sheet_progress);
+    }
+
+    stack_.pop_back();
+}
+
+Sheet_Data xlsx_consumer::read_sheet_data_rows(std::size_t batch_size, const std::function<void(Sheet_Data &)> &flush)
+{
+    if (snapshot_sheet_)
+    {
+        const auto sheet = std::move(snapshot_sheet_);
+        array_formulae_.insert(sheet->array_formulae.begin(), sheet->array_formulae.end());
+
+        // the sheetData element of the worksheet part is empty
+        parse_sheet_data(parser_, array_formulae_);
+
+        return std::move(sheet->data);
+    }
+
+    if (sheet_data_begin_ == nullptr)
+    {
+        return parse_sheet_data(parser_, array_formulae_, projection_, batch_size, flush);
+    }
+
+    auto sheet_data = tokenize_sheet_data(sheet_data_begin_, sheet_data_end_,
+        array_formulae_, projection_, batch_size, flush);
+    sheet_data_begin_ = sheet_data_end_ = nullptr;
+
+    // the parser has only seen an empty sheetData element, this consumes its end tag
+    parse_sheet_data(parser_, array_formulae_);
+
+    return sheet_data;
+}
+
+std::unique_ptr<std::streambuf> xlsx_consumer::read_ahead(std::unique_ptr<std::streambuf> part)
+{
+    return std::unique_ptr<std::streambuf>(
+        new read_ahead_streambuf(std::move(part), options_.decompression_buffer_size));
+}
+
+std::unique_ptr<std::streambuf> xlsx_consumer::cut_sheet_data(std::streambuf &part)
+{
+    const std::size_t chunk_size = 64 * 1024;
+    worksheet_part_.clear();
+
+    while (true)
+    {
+        const auto size = worksheet_part_.size();
+        worksheet_part_.resize(size + std::max(chunk_size, size));
+        const auto read = part.sgetn(reinterpret_cast<char *>(worksheet_part_.data() + size),
+            static_cast<std::streamsize>(worksheet_part_.size() - size));
+        worksheet_part_.resize(size + static_cast<std::size_t>(std::max<std::streamsize>(read, 0)));
+
+        if (read <= 0)
         {
+            break;
         }
-        ws_cell_impl->phonetics_visible_ = cell.is_phonetic;
-        if (!cell.formula_string.empty())
+    }
+
+    const auto data = reinterpret_cast<const char *>(worksheet_part_.data());
+    std::size_t content_begin = 0;
+    std::size_t content_end = 0;
+    sheet_data_begin_ = sheet_data_end_ = nullptr;
+
+    if (!find_sheet_data(data, worksheet_part_.size(), content_begin, content_end))
+    {
+        return std::unique_ptr<std::streambuf>(new memory_istreambuf(worksheet_part_.data(), worksheet_part_.size()));
+    }
+
+    const auto content_begin_iter = worksheet_part_.begin() + static_cast<std::ptrdiff_t>(content_begin);
+    const auto content_end_iter = worksheet_part_.begin() + static_cast<std::ptrdiff_t>(content_end);
+    worksheet_markup_.assign(worksheet_part_.begin(), content_begin_iter);
+    worksheet_markup_.insert(worksheet_markup_.end(), content_end_iter, worksheet_part_.end());
+    sheet_data_begin_ = data + content_begin;
+    sheet_data_end_ = data + content_end;
+
+    return std::unique_ptr<std::streambuf>(new memory_istreambuf(worksheet_markup_.data(), worksheet_markup_.size()));
+}
+
+void xlsx_consumer::read_worksheet_sheetdata_pipelined(progress_reporter::worksheet_progress &sheet_progress)
+{
+    // Parsing stays on this thread because it owns the XML parser. Batches of parsed
+    // cells are handed to a second thread which inserts them into the worksheet.
+    spsc_queue<Sheet_Data> batches(4);
+    std::exception_ptr construct_error;
+
+    std::thread constructor([&]() {
+        try
         {
-            ws_cell_impl->formula_ = cell.formula_string[0] == '=' ? cell.formula_string.substr(1) : std::move(cell.formula_string);
+            Sheet_Data batch;
+            while (batches.pop(batch))
+            {
+                construct_sheet_data(batch);
+            }
         }
-        if (!cell.value.empty())
+        catch (...)
         {
-            ws_cell_impl->type_ = cell.type;
-            switch (cell.type)
+            construct_error = std::current_exception();
+            batches.close();
+        }
+    });
+
+    try
+    {
+        auto flush = [&](Sheet_Data &batch) {
+            limits_->add_cells(batch.parsed_cells.size());
+
+            // progress is reported as cells are parsed, the parsing thread can cancel
+            if (progress_)
             {
-            case cell::type::boolean: {
-                ws_cell_impl->value_numeric_ = is_true(cell.value) ? 1.0 : 0.0;
-                break;
+                progress_->add_cells(sheet_progress, batch.parsed_cells.size());
             }
-            case cell::type::empty:
-            case cell::type::number:
-            case cell::type::date: {
-                ws_cell_impl->value_numeric_ = xlnt::detail::deserialise(cell.value);
-                break;
-            }
-            case cell::type::shared_string: {
-                long long value = -1;
-                if (xlnt::detail::parse(cell.value, value) == std::errc())
-                {
-                    ws_cell_impl->value_numeric_ = static_cast<double>(value);
-                }
-                break;
-            }
-            case cell::type::inline_string: {
-                ws_cell_impl->value_text_ = std::move(cell.value);
-                break;
-            }
-            case cell::type::formula_string: {
-                ws_cell_impl->value_text_ = std::move(cell.value);
-                break;
-            }
-            case cell::type::error: {
-                ws_cell_impl->value_text_.plain_text(cell.value, false);
-                break;
+
+            if (!batches.push(std::move(batch)))
+            {
+                throw xlnt::exception("sheet data construction failed");
             }
+        };
+        auto remainder = read_sheet_data_rows(std::max<std::size_t>(options_.sheet_data_batch_size, 1), flush);
+
+        if (!remainder.parsed_rows.empty())
+        {
+            flush(remainder);
+        }
+    }
+    catch (...)
+    {
+        batches.close();
+        constructor.join();
+
+        if (construct_error)
+        {
+            std::rethrow_exception(construct_error);
+        }
+
+        throw;
+    }
+
+    batches.close();
+    constructor.join();
+
+    if (construct_error)
+    {
+        std::rethrow_exception(construct_error);
+    }
+}
+
+void xlsx_consumer::reserve_sheet_data()
+{
+    if (!dimension_.is_set())
+    {
+        return;
+    }
+
+    const auto &dimension = dimension_.get();
+    const auto first_row = std::max(dimension.top_left().row(), projection_.first_row);
+    const auto last_row = std::min(dimension.bottom_right().row(), projection_.last_row);
+    const auto first_column = std::max(dimension.top_left().column_index(), projection_.first_column);
+    const auto last_column = std::min(dimension.bottom_right().column_index(), projection_.last_column);
+
+    if (first_row > last_row || first_column > last_column)
+    {
+        return;
+    }
+
+    const auto rows = std::uint64_t(last_row - first_row) + 1;
+    const auto columns = std::uint64_t(last_column - first_column) + 1;
+
+    // a sparse or bogus dimension mustn't reserve more than the sheet could hold,
+    // every cell takes at least "<c/>" and every row "<row/>"
+    auto cell_limit = std::uint64_t(constants::max_elements_for_reserve());
+    auto row_limit = cell_limit;
+
+    if (sheet_data_begin_ != nullptr)
+    {
+        const auto size = static_cast<std::uint64_t>(sheet_data_end_ - sheet_data_begin_);
+        cell_limit = size / 4;
+        row_limit = size / 6;
+    }
+
+    cell_limit = std::min(cell_limit, std::uint64_t(limits_->remaining_cells()));
+
+    current_worksheet_->cell_map_.reserve(static_cast<std::size_t>(std::min(rows * columns, cell_limit)),
+        static_cast<std::size_t>(columns));
+    current_worksheet_->row_properties_.reserve(static_cast<std::size_t>(std::min(rows, row_limit)));
+}
+
+void xlsx_consumer::construct_sheet_data(Sheet_Data &ws_data)
+{
+    for (auto &row : ws_data.parsed_rows)
+    {
+        current_worksheet_->row_properties_.emplace(row.second, std::move(row.first));
+    }
+
+    // masters outside the projection come before any cell of their group in this batch
+    for (const Cell &cell : ws_data.skipped_shared_formulae)
+    {
+        add_shared_formula(ws_data, cell);
+    }
+    deserialise_numbers(ws_data, numbers_);
+    auto next_number = numbers_.begin();
+    auto impl = detail::cell_impl();
+    for (Cell &cell : ws_data.parsed_cells)
+    {
+        const auto parsed_number = *next_number++;
+        impl.parent_ = current_worksheet_;
+        impl.column_ = cell.ref.column;
+        impl.row_ = cell.ref.row;
+        detail::cell_impl *ws_cell_impl = current_worksheet_->cell_map_.emplace(cell_reference(impl.column_, impl.row_), std::move(impl)).first;
+        construct_cell(*ws_cell_impl, ws_data, cell, parsed_number);
+    }
+}
+
+void xlsx_consumer::add_shared_formula(const Sheet_Data &sheet_data, const Cell &cell)
+{
+    const auto formula = sheet_data.data(cell.formula_string);
+    const auto skip = formula[0] == '=' ? std::size_t(1) : std::size_t(0);
+    detail::formula_group group;
+    group.master = cell_reference(cell.ref.column, cell.ref.row);
+    group.range = range_reference(group.master, group.master);
+    group.text = std::string(formula + skip, cell.formula_string.length - skip);
+    current_worksheet_->formula_groups_.push_back(std::move(group));
+    shared_formula_groups_[cell.shared_index] = static_cast<std::uint32_t>(current_worksheet_->formula_groups_.size());
+}
+
+void xlsx_consumer::construct_cell(detail::cell_impl &impl, const Sheet_Data &sheet_data, const Cell &cell, double number)
+{
+    impl.parent_ = current_worksheet_;
+    impl.column_ = cell.ref.column;
+    impl.row_ = cell.ref.row;
+    if (cell.style_index != -1 && deferred_formats_)
+    {
+        // runs of cells with the same format take one entry until the stylesheet is read
+        const auto style = static_cast<std::size_t>(cell.style_index);
+        auto &deferred = *deferred_formats_;
+
+        if (!deferred.empty() && deferred.back().row == cell.ref.row
+            && deferred.back().last + 1 == cell.ref.column && deferred.back().style == style)
+        {
+            deferred.back().last = cell.ref.column;
+        }
+        else
+        {
+            deferred.push_back({cell.ref.row, cell.ref.column, cell.ref.column, style});
+        }
+    }
+    else if (cell.style_index != -1)
+    {
+        impl.format_ = target_.format(static_cast<size_t>(cell.style_index)).d_;
+    }
+    impl.phonetics_visible_ = cell.is_phonetic;
+    if (cell.shared_index >= 0)
+    {
+        // the following cells of a group only refer to it
+        if (!cell.formula_string.empty())
+        {
+            add_shared_formula(sheet_data, cell);
+        }
+
+        auto group = shared_formula_groups_.find(cell.shared_index);
+        if (group != shared_formula_groups_.end())
+        {
+            auto &range = current_worksheet_->formula_groups_[group->second - 1].range;
+            range = range_reference(
+                std::min(range.top_left().column(), column_t(cell.ref.column)),
+                std::min(range.top_left().row(), row_t(cell.ref.row)),
+                std::max(range.bottom_right().column(), column_t(cell.ref.column)),
+                std::max(range.bottom_right().row(), row_t(cell.ref.row)));
+            impl.formula_group_ = group->second;
+        }
+    }
+    else if (!cell.formula_string.empty())
+    {
+        const auto formula = sheet_data.data(cell.formula_string);
+        const auto skip = formula[0] == '=' ? std::size_t(1) : std::size_t(0);
+        impl.extension().formula_ = std::string(formula + skip, cell.formula_string.length - skip);
+    }
+    if (!cell.value.empty())
+    {
+        const auto value = sheet_data.data(cell.value);
+        const auto length = cell.value.length;
+        impl.type_ = cell.type;
+        switch (cell.type)
+        {
+        case cell::type::boolean: {
+            impl.value_number(is_true(sheet_data.str(cell.value)) ? 1.0 : 0.0);
+            break;
+        }
+        case cell::type::empty:
+        case cell::type::number:
+        case cell::type::date: {
+            assign_number(impl, number, value, length);
+            break;
+        }
+        case cell::type::shared_string: {
+            long long index = -1;
+            if (xlnt::detail::parse(value, value + length, index) == std::errc())
+            {
+                impl.value_number(static_cast<double>(index));
             }
+            break;
+        }
+        case cell::type::inline_string: {
+            impl.extension().value_text_ = std::string(value, length);
+            break;
+        }
+        case cell::type::formula_string: {
+            impl.extension().value_text_ = std::string(value, length);
+            break;
+        }
+        case cell::type::error: {
+            impl.extension().value_text_.plain_text(std::string(value, length), false);
+            break;
+        }
         }
     }
-    stack_.pop_back();
+}
 
+void xlsx_consumer::resolve_deferred_formats()
+{
+    if (!deferred_formats_)
+    {
+        return;
+    }
+
+    for (const auto &run : *deferred_formats_)
+    {
+        const auto format = target_.format(run.style).d_;
 
+        for (auto column = run.first; column <= run.last; ++column)
+        {
+            auto impl = current_worksheet_->cell_map_.find(cell_reference(column, run.row));
+
+            if (impl != nullptr)
+            {
+                impl->format_ = format;
+            }
+        }
+    }
+
+    deferred_formats_.reset();
 }
 
 worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
@@ -957,56 +1789,67 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 
     auto ws = worksheet(current_worksheet_);
 
-    while (in_element(qn("spreadsheetml", "worksheet")))
+    while (in_element(XLNT_QN("spreadsheetml", "worksheet")))
     {
         auto current_worksheet_element = expect_start_element(xml::content::complex);
 
-        if (current_worksheet_element == qn("spreadsheetml", "sheetCalcPr")) // CT_SheetCalcPr 0-1
+        if (options_.values_only)
+        {
+            // nothing after sheetData holds a value
+            skip_remaining_content(current_worksheet_element);
+        }
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sheetCalcPr")) // CT_SheetCalcPr 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "sheetProtection")) // CT_SheetProtection 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sheetProtection")) // CT_SheetProtection 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "protectedRanges")) // CT_ProtectedRanges 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "protectedRanges")) // CT_ProtectedRanges 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "scenarios")) // CT_Scenarios 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "scenarios")) // CT_Scenarios 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "autoFilter")) // CT_AutoFilter 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "autoFilter")) // CT_AutoFilter 0-1
         {
             ws.auto_filter(xlnt::range_reference(parser().attribute("ref")));
             // auto filter complex
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "sortState")) // CT_SortState 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "sortState")) // CT_SortState 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "dataConsolidate")) // CT_DataConsolidate 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "dataConsolidate")) // CT_DataConsolidate 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "customSheetViews")) // CT_CustomSheetViews 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "customSheetViews")) // CT_CustomSheetViews 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "mergeCells")) // CT_MergeCells 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "mergeCells")) // CT_MergeCells 0-1
         {
             parser().attribute_map();
 
-            while (in_element(qn("spreadsheetml", "mergeCells")))
+            while (in_element(XLNT_QN("spreadsheetml", "mergeCells")))
             {
-                expect_start_element(qn("spreadsheetml", "mergeCell"), xml::content::simple);
-                ws.merge_cells(range_reference(parser().attribute("ref")));
-                expect_end_element(qn("spreadsheetml", "mergeCell"));
+                expect_start_element(XLNT_QN("spreadsheetml", "mergeCell"), xml::content::simple);
+                const auto merged = range_reference(parser().attribute("ref"));
+
+                // like Excel, drop ranges overlapping an earlier one instead of rejecting the file
+                if (ws.d_->merged_cells_.find_overlap(merged) == nullptr)
+                {
+                    ws.merge_cells(merged);
+                }
+                expect_end_element(XLNT_QN("spreadsheetml", "mergeCell"));
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "phoneticPr")) // CT_PhoneticPr 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "phoneticPr")) // CT_PhoneticPr 0-1
         {
             phonetic_pr phonetic_properties(parser().attribute<std::uint32_t>("fontId"));
             if (parser().attribute_present("type"))
@@ -1019,26 +1862,26 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
             }
             current_worksheet_->phonetic_properties_.set(phonetic_properties);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "conditionalFormatting")) // CT_ConditionalFormatting 0+
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "conditionalFormatting")) // CT_ConditionalFormatting 0+
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "dataValidations")) // CT_DataValidations 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "dataValidations")) // CT_DataValidations 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "hyperlinks")) // CT_Hyperlinks 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "hyperlinks")) // CT_Hyperlinks 0-1
         {
             while (in_element(current_worksheet_element))
             {
                 // CT_Hyperlink
-                expect_start_element(qn("spreadsheetml", "hyperlink"), xml::content::simple);
+                expect_start_element(XLNT_QN("spreadsheetml", "hyperlink"), xml::content::simple);
 
                 auto cell = ws.cell(parser().attribute("ref"));
 
-                if (parser().attribute_present(qn("r", "id")))
+                if (parser().attribute_present(XLNT_QN("r", "id")))
                 {
-                    auto hyperlink_rel_id = parser().attribute(qn("r", "id"));
+                    auto hyperlink_rel_id = parser().attribute(XLNT_QN("r", "id"));
                     auto hyperlink_rel = std::find_if(hyperlinks.begin(), hyperlinks.end(),
                         [&](const relationship &r) { return r.id() == hyperlink_rel_id; });
 
@@ -1074,13 +1917,13 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
                         hyperlink.tooltip = parser().attribute("tooltip");
                     }
 
-                    cell.d_->hyperlink_ = hyperlink;
+                    cell.d_->extension().hyperlink_.reset(new hyperlink_impl(std::move(hyperlink)));
                 }
 
-                expect_end_element(qn("spreadsheetml", "hyperlink"));
+                expect_end_element(XLNT_QN("spreadsheetml", "hyperlink"));
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "printOptions")) // CT_PrintOptions 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "printOptions")) // CT_PrintOptions 0-1
         {
             print_options opts;
             if (parser().attribute_present("gridLines"))
@@ -1106,7 +1949,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
             ws.d_->print_options_.set(opts);
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "pageMargins")) // CT_PageMargins 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "pageMargins")) // CT_PageMargins 0-1
         {
             page_margins margins;
 
@@ -1119,7 +1962,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 
             ws.page_margins(margins);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "pageSetup")) // CT_PageSetup 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "pageSetup")) // CT_PageSetup 0-1
         {
             page_setup setup;
             if (parser().attribute_present("orientation"))
@@ -1142,14 +1985,14 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
             {
                 setup.scale(parser().attribute<double>("scale"));
             }
-            if (parser().attribute_present(qn("r", "id")))
+            if (parser().attribute_present(XLNT_QN("r", "id")))
             {
-                setup.rel_id(parser().attribute(qn("r", "id")));
+                setup.rel_id(parser().attribute(XLNT_QN("r", "id")));
             }
             ws.page_setup(setup);
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "headerFooter")) // CT_HeaderFooter 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "headerFooter")) // CT_HeaderFooter 0-1
         {
             header_footer hf;
 
@@ -1169,33 +2012,35 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
             optional<std::array<optional<rich_text>, 3>> first_header;
             optional<std::array<optional<rich_text>, 3>> first_footer;
 
-            using xlnt::detail::decode_header_footer;
+            const auto decode_header_footer = [this](const std::string &hf_string) {
+                return xlnt::detail::decode_header_footer(hf_string, *decoded_header_footers_);
+            };
 
             while (in_element(current_worksheet_element))
             {
                 auto current_hf_element = expect_start_element(xml::content::simple);
 
-                if (current_hf_element == qn("spreadsheetml", "oddHeader"))
+                if (current_hf_element == XLNT_QN("spreadsheetml", "oddHeader"))
                 {
                     odd_header = decode_header_footer(read_text());
                 }
-                else if (current_hf_element == qn("spreadsheetml", "oddFooter"))
+                else if (current_hf_element == XLNT_QN("spreadsheetml", "oddFooter"))
                 {
                     odd_footer = decode_header_footer(read_text());
                 }
-                else if (current_hf_element == qn("spreadsheetml", "evenHeader"))
+                else if (current_hf_element == XLNT_QN("spreadsheetml", "evenHeader"))
                 {
                     even_header = decode_header_footer(read_text());
                 }
-                else if (current_hf_element == qn("spreadsheetml", "evenFooter"))
+                else if (current_hf_element == XLNT_QN("spreadsheetml", "evenFooter"))
                 {
                     even_footer = decode_header_footer(read_text());
                 }
-                else if (current_hf_element == qn("spreadsheetml", "firstHeader"))
+                else if (current_hf_element == XLNT_QN("spreadsheetml", "firstHeader"))
                 {
                     first_header = decode_header_footer(read_text());
                 }
-                else if (current_hf_element == qn("spreadsheetml", "firstFooter"))
+                else if (current_hf_element == XLNT_QN("spreadsheetml", "firstFooter"))
                 {
                     first_footer = decode_header_footer(read_text());
                 }
@@ -1250,16 +2095,16 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 
             ws.header_footer(hf);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "rowBreaks")) // CT_PageBreak 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "rowBreaks")) // CT_PageBreak 0-1
         {
             auto count = parser().attribute_present("count") ? parser().attribute<std::size_t>("count") : 0;
             auto manual_break_count = parser().attribute_present("manualBreakCount")
                 ? parser().attribute<std::size_t>("manualBreakCount")
                 : 0;
 
-            while (in_element(qn("spreadsheetml", "rowBreaks")))
+            while (in_element(XLNT_QN("spreadsheetml", "rowBreaks")))
             {
-                expect_start_element(qn("spreadsheetml", "brk"), xml::content::simple);
+                expect_start_element(XLNT_QN("spreadsheetml", "brk"), xml::content::simple);
 
                 if (parser().attribute_present("id"))
                 {
@@ -1273,19 +2118,19 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
                 }
 
                 skip_attributes({"min", "max", "pt"});
-                expect_end_element(qn("spreadsheetml", "brk"));
+                expect_end_element(XLNT_QN("spreadsheetml", "brk"));
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "colBreaks")) // CT_PageBreak 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "colBreaks")) // CT_PageBreak 0-1
         {
             auto count = parser().attribute_present("count") ? parser().attribute<std::size_t>("count") : 0;
             auto manual_break_count = parser().attribute_present("manualBreakCount")
                 ? parser().attribute<std::size_t>("manualBreakCount")
                 : 0;
 
-            while (in_element(qn("spreadsheetml", "colBreaks")))
+            while (in_element(XLNT_QN("spreadsheetml", "colBreaks")))
             {
-                expect_start_element(qn("spreadsheetml", "brk"), xml::content::simple);
+                expect_start_element(XLNT_QN("spreadsheetml", "brk"), xml::content::simple);
 
                 if (parser().attribute_present("id"))
                 {
@@ -1299,38 +2144,38 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
                 }
 
                 skip_attributes({"min", "max", "pt"});
-                expect_end_element(qn("spreadsheetml", "brk"));
+                expect_end_element(XLNT_QN("spreadsheetml", "brk"));
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "customProperties")) // CT_CustomProperties 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "customProperties")) // CT_CustomProperties 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "cellWatches")) // CT_CellWatches 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "cellWatches")) // CT_CellWatches 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "ignoredErrors")) // CT_IgnoredErrors 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "ignoredErrors")) // CT_IgnoredErrors 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "smartTags")) // CT_SmartTags 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "smartTags")) // CT_SmartTags 0-1
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "drawing")) // CT_Drawing 0-1
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "drawing")) // CT_Drawing 0-1
         {
-            if (parser().attribute_present(qn("r", "id")))
+            if (parser().attribute_present(XLNT_QN("r", "id")))
             {
-                auto drawing_rel_id = parser().attribute(qn("r", "id"));
+                auto drawing_rel_id = parser().attribute(XLNT_QN("r", "id"));
                 ws.d_->drawing_rel_id_ = drawing_rel_id;
             }
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "legacyDrawing"))
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "legacyDrawing"))
         {
             skip_remaining_content(current_worksheet_element);
         }
-        else if (current_worksheet_element == qn("spreadsheetml", "extLst"))
+        else if (current_worksheet_element == XLNT_QN("spreadsheetml", "extLst"))
         {
             ext_list extensions(parser(), current_worksheet_element.namespace_());
             ws.d_->extension_list_.set(extensions);
@@ -1343,9 +2188,9 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
         expect_end_element(current_worksheet_element);
     }
 
-    expect_end_element(qn("spreadsheetml", "worksheet"));
+    expect_end_element(XLNT_QN("spreadsheetml", "worksheet"));
 
-    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::comments))
+    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::comments) && !options_.values_only)
     {
         auto comments_part = manifest.canonicalize({workbook_rel, sheet_rel,
             manifest.relationship(sheet_path, xlnt::relationship_type::comments)});
@@ -1372,7 +2217,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
         }
     }
 
-    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::drawings))
+    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::drawings) && !options_.values_only)
     {
         auto drawings_part = manifest.canonicalize({workbook_rel, sheet_rel,
             manifest.relationship(sheet_path, xlnt::relationship_type::drawings)});
@@ -1386,22 +2231,46 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
         read_drawings(ws, drawings_part);
     }
 
-    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::printer_settings))
+    if (manifest.has_relationship(sheet_path, xlnt::relationship_type::printer_settings) && !options_.values_only)
     {
         read_part({workbook_rel, sheet_rel,
             manifest.relationship(sheet_path,
                 relationship_type::printer_settings)});
     }
 
-    for (auto array_formula : array_formulae_)
+    for (const auto &array_formula : array_formulae_)
     {
-        for (auto row : ws.range(array_formula.first))
-        {
-            for (auto cell : row)
+        const auto &text = array_formula.second;
+        const auto skip = text[0] == '=' ? std::size_t(1) : std::size_t(0);
+        detail::formula_group group;
+        group.array = true;
+        group.range = range_reference(array_formula.first);
+        group.master = group.range.top_left();
+        group.text = text.substr(skip);
+        const auto range = group.range;
+        ws.d_->formula_groups_.push_back(std::move(group));
+        const auto group_id = static_cast<std::uint32_t>(ws.d_->formula_groups_.size());
+
+        for (auto row = range.top_left().row(); row <= range.bottom_right().row(); ++row)
+        {
+            for (auto column = range.top_left().column(); column <= range.bottom_right().column(); ++column)
             {
-                cell.formula(array_formula.second);
+                // cells outside the projection aren't created
+                if (!projection_.contains(Cell_Reference(row, column.index)))
+                {
+                    continue;
+                }
+
+                auto cell = ws.cell(cell_reference(column, row));
+                if (cell.d_->extension_)
+                {
+                    cell.d_->extension_->formula_.clear();
+                }
+                cell.d_->formula_group_ = group_id;
             }
         }
+
+        ws.register_calc_chain_in_manifest();
     }
 
     return ws;
@@ -1414,229 +2283,80 @@ xml::parser &xlsx_consumer::parser()
 
 bool xlsx_consumer::has_cell()
 {
-    auto ws = worksheet(current_worksheet_);
-
-    while (streaming_cell_ // we're not at the end of the file
-           && !in_element(qn("spreadsheetml", "row"))) // we're at the end of a row, or between rows
+    while (streaming_next_ == streaming_batch_.parsed_cells.size())
     {
-        if (parser().peek() == xml::parser::event_type::end_element
-            && stack_.back() == qn("spreadsheetml", "row"))
-        {
-            // We're at the end of a row.
-            expect_end_element(qn("spreadsheetml", "row"));
-            // ... and keep parsing.
-        }
-
-        if (parser().peek() == xml::parser::event_type::end_element
-            && stack_.back() == qn("spreadsheetml", "sheetData"))
-        {
-            // End of sheet. Mark it by setting streaming_cell_ to nullptr, so we never get here again.
-            expect_end_element(qn("spreadsheetml", "sheetData"));
-            streaming_cell_.reset(nullptr);
-            break;
-        }
-
-        expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
-        row_t row_index = 0;
-        bool ok = detail::parse(parser().attribute("r"), row_index) == std::errc();
-
-        if (!ok)
-        {
-#ifdef THROW_ON_INVALID_XML
-            throw xlnt::invalid_parameter();
-#endif
-        }
-        auto &row_properties = ws.row_properties(row_index);
-
-        if (parser().attribute_present("ht"))
-        {
-            row_properties.height = xlnt::detail::deserialise(parser().attribute("ht"));
-        }
-
-        if (parser().attribute_present("customHeight"))
-        {
-            row_properties.custom_height = is_true(parser().attribute("customHeight"));
-        }
-
-        if (parser().attribute_present("hidden") && is_true(parser().attribute("hidden")))
-        {
-            row_properties.hidden = true;
-        }
-
-        if (parser().attribute_present(qn("x14ac", "dyDescent")))
-        {
-            row_properties.dy_descent = xlnt::detail::deserialise(parser().attribute(qn("x14ac", "dyDescent")));
-        }
-
-        if (parser().attribute_present("spans"))
+        if (!read_next_row())
         {
-            row_properties.spans = parser().attribute("spans");
+            return false;
         }
-
-        skip_attributes({"customFormat", "s", "customFont",
-            "outlineLevel", "collapsed", "thickTop", "thickBot",
-            "ph"});
-    }
-
-    if (!streaming_cell_)
-    {
-        // We're at the end of the worksheet
-        return false;
     }
 
-    expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
-
     assert(streaming_);
-    streaming_cell_.reset(new detail::cell_impl()); // Clean cell state - otherwise it might contain information from the previously streamed cell.
-    auto cell = xlnt::cell(streaming_cell_.get());
-    auto reference = cell_reference(parser().attribute("r"));
-    cell.d_->parent_ = current_worksheet_;
-    cell.d_->column_ = reference.column_index();
-    cell.d_->row_ = reference.row();
-
-    if (parser().attribute_present("ph"))
-    {
-        cell.d_->phonetics_visible_ = parser().attribute<bool>("ph");
-    }
-
-    auto has_type = parser().attribute_present("t");
-    auto type = has_type ? parser().attribute("t") : "n";
-
-    if (parser().attribute_present("s"))
-    {
-        size_t s = 0;
-        bool ok = detail::parse(parser().attribute("s"), s) == std::errc();
-
-        if (!ok)
-        {
-#ifdef THROW_ON_INVALID_XML
-            throw xlnt::invalid_parameter();
-#endif
-        }
-
-        cell.format(target_.format(s));
-    }
-
-    auto has_value = false;
-    auto value_string = std::string();
-    auto formula_string = std::string();
-
-    while (in_element(qn("spreadsheetml", "c")))
-    {
-        auto current_element = expect_start_element(xml::content::mixed);
-
-        if (current_element == qn("spreadsheetml", "v")) // s:ST_Xstring
-        {
-            has_value = true;
-            value_string = read_text();
-        }
-        else if (current_element == qn("spreadsheetml", "f")) // CT_CellFormula
-        {
-            auto has_shared_formula = false;
-            auto has_array_formula = false;
-            auto is_master_cell = false;
-            auto shared_formula_index = 0;
-            auto formula_range = range_reference();
-
-            if (parser().attribute_present("t"))
-            {
-                auto formula_type = parser().attribute("t");
-                if (formula_type == "shared")
-                {
-                    has_shared_formula = true;
-                    shared_formula_index = parser().attribute<int>("si");
-                    if (parser().attribute_present("ref"))
-                    {
-                        is_master_cell = true;
-                    }
-                }
-                else if (formula_type == "array")
-                {
-                    has_array_formula = true;
-                    formula_range = range_reference(parser().attribute("ref"));
-                    is_master_cell = true;
-                }
-            }
-
-            skip_attributes({"aca", "dt2D", "dtr", "del1", "del2", "r1",
-                "r2", "ca", "bx"});
+    const auto index = streaming_next_++;
+    // Clean cell state - otherwise it might contain information from the previously streamed cell.
+    streaming_cell_->reset();
+    construct_cell(*streaming_cell_, streaming_batch_, streaming_batch_.parsed_cells[index], numbers_[index]);
 
-            formula_string = read_text();
-
-            if (is_master_cell)
-            {
-                if (has_shared_formula)
-                {
-                    shared_formulae_[shared_formula_index] = formula_string;
-                }
-                else if (has_array_formula)
-                {
-                    array_formulae_[formula_range.to_string()] = formula_string;
-                }
-            }
-            else if (has_shared_formula)
-            {
-                auto shared_formula = shared_formulae_.find(shared_formula_index);
-                if (shared_formula != shared_formulae_.end())
-                {
-                    formula_string = shared_formula->second;
-                }
-            }
-        }
-        else if (current_element == qn("spreadsheetml", "is")) // CT_Rst
-        {
-            expect_start_element(qn("spreadsheetml", "t"), xml::content::simple);
-            has_value = true;
-            value_string = read_text();
-            expect_end_element(qn("spreadsheetml", "t"));
-        }
-        else
-        {
-            unexpected_element(current_element);
-        }
-
-        expect_end_element(current_element);
-    }
-
-    expect_end_element(qn("spreadsheetml", "c"));
-
-    if (!formula_string.empty())
-    {
-        cell.formula(formula_string);
-    }
+    return true;
+}
 
-    if (has_value)
+bool xlsx_consumer::read_next_row()
+{
+    while (streaming_cell_) // we're not at the end of the worksheet
     {
-        if (type == "str")
+        const auto event = parser_->next();
+
+        if (event == xml::parser::characters)
         {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::formula_string);
+            continue;
         }
-        else if (type == "inlineStr")
+
+        if (event == xml::parser::end_element)
         {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::inline_string);
+            // End of sheetData. Mark it by setting streaming_cell_ to nullptr, so we never get here again.
+            stack_.pop_back();
+            streaming_cell_.reset(nullptr);
+            break;
         }
-        else if (type == "s")
+
+        if (event != xml::parser::start_element)
         {
-            cell.d_->value_numeric_ = xlnt::detail::deserialise(value_string);
-            cell.data_type(cell::type::shared_string);
+            throw xlnt::exception("unexpected XML parsing event");
         }
-        else if (type == "b") // boolean
+
+        streaming_batch_.clear();
+        streaming_next_ = 0;
+        auto row = parse_row(parser_, static_cast<int>(streaming_row_) + 1, streaming_batch_, array_formulae_, projection_);
+        streaming_row_ = static_cast<row_t>(row.second);
+
+        // masters outside the projection still provide the text of their group
+        for (const auto &master : streaming_batch_.skipped_shared_formulae)
         {
-            cell.value(is_true(value_string));
+            add_shared_formula(streaming_batch_, master);
         }
-        else if (type == "n") // numeric
+
+        if (!projection_.contains_row(streaming_row_))
         {
-            cell.value(xlnt::detail::deserialise(value_string));
+            continue;
         }
-        else if (!value_string.empty() && value_string[0] == '#')
+
+        // the properties aren't kept in the worksheet so that streaming memory stays flat
+        if (streaming_row_callback_)
         {
-            cell.error(value_string);
+            streaming_row_callback_(streaming_row_, row.first);
         }
+
+        deserialise_numbers(streaming_batch_, numbers_);
+        streaming_row_open_ = true;
+
+        return true;
     }
 
-    return true;
+    streaming_batch_.clear();
+    streaming_next_ = 0;
+    streaming_row_open_ = false;
+
+    return false;
 }
 
 std::vector<relationship> xlsx_consumer::read_relationships(const path &part)
@@ -1651,11 +2371,11 @@ std::vector<relationship> xlsx_consumer::read_relationships(const path &part)
     xml::parser parser(rels_stream, part_rels_path.string());
     parser_ = &parser;
 
-    expect_start_element(qn("relationships", "Relationships"), xml::content::complex);
+    expect_start_element(XLNT_QN("relationships", "Relationships"), xml::content::complex);
 
-    while (in_element(qn("relationships", "Relationships")))
+    while (in_element(XLNT_QN("relationships", "Relationships")))
     {
-        expect_start_element(qn("relationships", "Relationship"), xml::content::simple);
+        expect_start_element(XLNT_QN("relationships", "Relationship"), xml::content::simple);
 
         const auto target_mode = parser.attribute_present("TargetMode")
             ? parser.attribute<xlnt::target_mode>("TargetMode")
@@ -1671,10 +2391,10 @@ std::vector<relationship> xlsx_consumer::read_relationships(const path &part)
             parser.attribute<xlnt::relationship_type>("Type"),
             xlnt::uri(part.string()), target, target_mode);
 
-        expect_end_element(qn("relationships", "Relationship"));
+        expect_end_element(XLNT_QN("relationships", "Relationship"));
     }
 
-    expect_end_element(qn("relationships", "Relationships"));
+    expect_end_element(XLNT_QN("relationships", "Relationships"));
     parser_ = nullptr;
 
     return relationships;
@@ -1693,7 +2413,43 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
 {
     const auto &manifest = target_.manifest();
     const auto part_path = manifest.canonicalize(rel_chain);
-    auto part_streambuf = archive_->open(part_path);
+    XLNT_TRACE_SCOPE_ARG("read_part", part_path.string());
+
+    const auto type = rel_chain.back().type();
+    phase_timer timer(type == relationship_type::shared_string_table ? options_.stats : nullptr,
+        &io_stats::shared_strings);
+    phase_timer stylesheet_timer(type == relationship_type::stylesheet ? options_.stats : nullptr,
+        &io_stats::stylesheet);
+
+    if (type == relationship_type::shared_string_table && options_.lazy_shared_strings
+        && read_shared_string_table_lazily(archive_->read(part_path)))
+    {
+        return;
+    }
+
+    // a part read ahead gets its own copy of the member, as the parts it refers to are
+    // opened while it's still being inflated
+    const auto inflate_ahead = type == relationship_type::worksheet && !streaming_
+        && options_.inflate_ahead && !options_.fast_sheet_data;
+    auto part_streambuf = inflate_ahead ? read_ahead(archive_->open_detached(part_path))
+                                        : archive_->open(part_path);
+    snapshot_sheet_.reset();
+
+    if (rel_chain.back().type() == relationship_type::worksheet && snapshot_sheets_ != nullptr)
+    {
+        auto sheet = snapshot_sheets_->find(part_path.string());
+
+        if (sheet != snapshot_sheets_->end())
+        {
+            snapshot_sheet_.reset(new snapshot_sheet(std::move(sheet->second)));
+            snapshot_sheets_->erase(sheet);
+        }
+    }
+    else if (rel_chain.back().type() == relationship_type::worksheet && !streaming_ && options_.fast_sheet_data)
+    {
+        part_streambuf = cut_sheet_data(*part_streambuf);
+    }
+
     std::istream part_stream(part_streambuf.get());
     xml::parser parser(part_stream, part_path.string());
     parser_ = &parser;
@@ -1852,19 +2608,52 @@ void xlsx_consumer::populate_workbook(bool streaming)
             continue;
         }
 
+        if (package_rel.type() == relationship_type::thumbnail && options_.values_only)
+        {
+            continue;
+        }
+
+        if (peeking_ && package_rel.type() != relationship_type::core_properties)
+        {
+            continue;
+        }
+
         read_part({package_rel});
     }
 
-    for (const auto &relationship_source_string : archive_->files())
+    const auto workbook_rel = manifest().relationship(root_path, relationship_type::office_document);
+
+    if (archive_->forward_only() || peeking_)
     {
-        for (const auto &part_rel : read_relationships(path(relationship_source_string)))
+        // listing the files would read the whole archive, so only the workbook's relationships are read
+        for (const auto &part_rel : read_relationships(manifest().canonicalize({workbook_rel})))
         {
             manifest().register_relationship(part_rel);
         }
     }
+    else
+    {
+        for (const auto &relationship_source_string : archive_->files())
+        {
+            for (const auto &part_rel : read_relationships(path(relationship_source_string)))
+            {
+                manifest().register_relationship(part_rel);
+            }
+        }
+    }
 
-    read_part({manifest().relationship(root_path,
-        relationship_type::office_document)});
+    if (manifest().content_type(manifest().canonicalize({workbook_rel})) == xlsb_consumer::workbook_content_type())
+    {
+        if (streaming_)
+        {
+            throw xlnt::unsupported(peeking_ ? "peeking XLSB workbooks" : "streaming XLSB workbooks");
+        }
+
+        xlsb_consumer(target_, *archive_, options_).read();
+        return;
+    }
+
+    read_part({workbook_rel});
 }
 
 // Package Parts
@@ -1877,19 +2666,19 @@ void xlsx_consumer::read_content_types()
     xml::parser parser(content_types_stream, "[Content_Types].xml");
     parser_ = &parser;
 
-    expect_start_element(qn("content-types", "Types"), xml::content::complex);
+    expect_start_element(XLNT_QN("content-types", "Types"), xml::content::complex);
 
-    while (in_element(qn("content-types", "Types")))
+    while (in_element(XLNT_QN("content-types", "Types")))
     {
         auto current_element = expect_start_element(xml::content::complex);
 
-        if (current_element == qn("content-types", "Default"))
+        if (current_element == XLNT_QN("content-types", "Default"))
         {
             auto extension = parser.attribute("Extension");
             auto content_type = parser.attribute("ContentType");
             manifest.register_default_type(extension, content_type);
         }
-        else if (current_element == qn("content-types", "Override"))
+        else if (current_element == XLNT_QN("content-types", "Override"))
         {
             auto part_name = parser.attribute("PartName");
             auto content_type = parser.attribute("ContentType");
@@ -1903,35 +2692,35 @@ void xlsx_consumer::read_content_types()
         expect_end_element(current_element);
     }
 
-    expect_end_element(qn("content-types", "Types"));
+    expect_end_element(XLNT_QN("content-types", "Types"));
 }
 
 void xlsx_consumer::read_core_properties()
 {
-    //qn("extended-properties", "Properties");
-    //qn("custom-properties", "Properties");
-    expect_start_element(qn("core-properties", "coreProperties"), xml::content::complex);
+    //XLNT_QN("extended-properties", "Properties");
+    //XLNT_QN("custom-properties", "Properties");
+    expect_start_element(XLNT_QN("core-properties", "coreProperties"), xml::content::complex);
 
-    while (in_element(qn("core-properties", "coreProperties")))
+    while (in_element(XLNT_QN("core-properties", "coreProperties")))
     {
         const auto property_element = expect_start_element(xml::content::simple);
         const auto prop = detail::from_string<core_property>(property_element.name());
         if (prop == core_property::created || prop == core_property::modified)
         {
-            skip_attribute(qn("xsi", "type"));
+            skip_attribute(XLNT_QN("xsi", "type"));
         }
         target_.core_property(prop, read_text());
         expect_end_element(property_element);
     }
 
-    expect_end_element(qn("core-properties", "coreProperties"));
+    expect_end_element(XLNT_QN("core-properties", "coreProperties"));
 }
 
 void xlsx_consumer::read_extended_properties()
 {
-    expect_start_element(qn("extended-properties", "Properties"), xml::content::complex);
+    expect_start_element(XLNT_QN("extended-properties", "Properties"), xml::content::complex);
 
-    while (in_element(qn("extended-properties", "Properties")))
+    while (in_element(XLNT_QN("extended-properties", "Properties")))
     {
         const auto property_element = expect_start_element(xml::content::mixed);
         const auto prop = detail::from_string<extended_property>(property_element.name());
@@ -1939,14 +2728,14 @@ void xlsx_consumer::read_extended_properties()
         expect_end_element(property_element);
     }
 
-    expect_end_element(qn("extended-properties", "Properties"));
+    expect_end_element(XLNT_QN("extended-properties", "Properties"));
 }
 
 void xlsx_consumer::read_custom_properties()
 {
-    expect_start_element(qn("custom-properties", "Properties"), xml::content::complex);
+    expect_start_element(XLNT_QN("custom-properties", "Properties"), xml::content::complex);
 
-    while (in_element(qn("custom-properties", "Properties")))
+    while (in_element(XLNT_QN("custom-properties", "Properties")))
     {
         const auto property_element = expect_start_element(xml::content::complex);
         const auto prop = parser().attribute("name");
@@ -1956,7 +2745,7 @@ void xlsx_consumer::read_custom_properties()
         expect_end_element(property_element);
     }
 
-    expect_end_element(qn("custom-properties", "Properties"));
+    expect_end_element(XLNT_QN("custom-properties", "Properties"));
 }
 
 void xlsx_consumer::read_office_document(const std::string &content_type) // CT_Workbook
@@ -1976,14 +2765,14 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
 
     target_.d_->calculation_properties_.clear();
 
-    expect_start_element(qn("workbook", "workbook"), xml::content::complex);
-    skip_attribute(qn("mc", "Ignorable"));
+    expect_start_element(XLNT_QN("workbook", "workbook"), xml::content::complex);
+    skip_attribute(XLNT_QN("mc", "Ignorable"));
 
-    while (in_element(qn("workbook", "workbook")))
+    while (in_element(XLNT_QN("workbook", "workbook")))
     {
         auto current_workbook_element = expect_start_element(xml::content::complex);
 
-        if (current_workbook_element == qn("workbook", "fileVersion")) // CT_FileVersion 0-1
+        if (current_workbook_element == XLNT_QN("workbook", "fileVersion")) // CT_FileVersion 0-1
         {
             detail::workbook_impl::file_version_t file_version;
 
@@ -2011,23 +2800,23 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
 
             target_.d_->file_version_ = file_version;
         }
-        else if (current_workbook_element == qn("workbook", "fileSharing")) // CT_FileSharing 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "fileSharing")) // CT_FileSharing 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("mc", "AlternateContent"))
+        else if (current_workbook_element == XLNT_QN("mc", "AlternateContent"))
         {
-            while (in_element(qn("mc", "AlternateContent")))
+            while (in_element(XLNT_QN("mc", "AlternateContent")))
             {
                 auto alternate_content_element = expect_start_element(xml::content::complex);
 
-                if (alternate_content_element == qn("mc", "Choice")
+                if (alternate_content_element == XLNT_QN("mc", "Choice")
                     && parser().attribute_present("Requires")
                     && parser().attribute("Requires") == "x15")
                 {
                     auto x15_element = expect_start_element(xml::content::simple);
 
-                    if (x15_element == qn("x15ac", "absPath"))
+                    if (x15_element == XLNT_QN("x15ac", "absPath"))
                     {
                         target_.d_->abs_path_ = parser().attribute("url");
                     }
@@ -2040,7 +2829,7 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
                 expect_end_element(alternate_content_element);
             }
         }
-        else if (current_workbook_element == qn("workbook", "workbookPr")) // CT_WorkbookPr 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "workbookPr")) // CT_WorkbookPr 0-1
         {
             target_.base_date(parser().attribute_present("date1904") // optional, bool=false
                         && is_true(parser().attribute("date1904"))
@@ -2065,15 +2854,15 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
             skip_attribute("defaultThemeVersion"); // optional, uint
             skip_attribute("dateCompatibility"); // optional, bool (undocumented)
         }
-        else if (current_workbook_element == qn("workbook", "workbookProtection")) // CT_WorkbookProtection 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "workbookProtection")) // CT_WorkbookProtection 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "bookViews")) // CT_BookViews 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "bookViews")) // CT_BookViews 0-1
         {
-            while (in_element(qn("workbook", "bookViews")))
+            while (in_element(XLNT_QN("workbook", "bookViews")))
             {
-                expect_start_element(qn("workbook", "workbookView"), xml::content::simple);
+                expect_start_element(XLNT_QN("workbook", "workbookView"), xml::content::simple);
                 skip_attributes({"firstSheet", "showHorizontalScroll",
                     "showSheetTabs", "showVerticalScroll"});
 
@@ -2113,42 +2902,42 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
                 target_.view(view);
 
                 skip_attributes();
-                expect_end_element(qn("workbook", "workbookView"));
+                expect_end_element(XLNT_QN("workbook", "workbookView"));
             }
         }
-        else if (current_workbook_element == qn("workbook", "sheets")) // CT_Sheets 1
+        else if (current_workbook_element == XLNT_QN("workbook", "sheets")) // CT_Sheets 1
         {
             std::size_t index = 0;
 
-            while (in_element(qn("workbook", "sheets")))
+            while (in_element(XLNT_QN("workbook", "sheets")))
             {
-                expect_start_element(qn("spreadsheetml", "sheet"), xml::content::simple);
+                expect_start_element(XLNT_QN("spreadsheetml", "sheet"), xml::content::simple);
 
                 auto title = parser().attribute("name");
 
                 sheet_title_index_map_[title] = index++;
                 sheet_title_id_map_[title] = parser().attribute<std::size_t>("sheetId");
-                target_.d_->sheet_title_rel_id_map_[title] = parser().attribute(qn("r", "id"));
+                target_.d_->sheet_title_rel_id_map_[title] = parser().attribute(XLNT_QN("r", "id"));
 
                 bool hidden = parser().attribute<std::string>("state", "") == "hidden";
                 target_.d_->sheet_hidden_.push_back(hidden);
 
-                expect_end_element(qn("spreadsheetml", "sheet"));
+                expect_end_element(XLNT_QN("spreadsheetml", "sheet"));
             }
         }
-        else if (current_workbook_element == qn("workbook", "functionGroups")) // CT_FunctionGroups 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "functionGroups")) // CT_FunctionGroups 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "externalReferences")) // CT_ExternalReferences 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "externalReferences")) // CT_ExternalReferences 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "definedNames")) // CT_DefinedNames 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "definedNames")) // CT_DefinedNames 0-1
         {
-            while (in_element(qn("workbook", "definedNames")))
+            while (in_element(XLNT_QN("workbook", "definedNames")))
             {
-                expect_start_element(qn("spreadsheetml", "definedName"), xml::content::mixed);
+                expect_start_element(XLNT_QN("spreadsheetml", "definedName"), xml::content::mixed);
 
                 defined_name name;
                 name.name = parser().attribute("name");
@@ -2164,10 +2953,10 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
                 name.value = read_text();
                 defined_names_.push_back(name);
 
-                expect_end_element(qn("spreadsheetml", "definedName"));
+                expect_end_element(XLNT_QN("spreadsheetml", "definedName"));
             }
         }
-        else if (current_workbook_element == qn("workbook", "calcPr")) // CT_CalcPr 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "calcPr")) // CT_CalcPr 0-1
         {
             xlnt::calculation_properties calc_props;
             if (parser().attribute_present("calcId"))
@@ -2181,51 +2970,51 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
             target_.calculation_properties(calc_props);
             parser().attribute_map(); // skip remaining
         }
-        else if (current_workbook_element == qn("workbook", "oleSize")) // CT_OleSize 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "oleSize")) // CT_OleSize 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "customWorkbookViews")) // CT_CustomWorkbookViews 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "customWorkbookViews")) // CT_CustomWorkbookViews 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "pivotCaches")) // CT_PivotCaches 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "pivotCaches")) // CT_PivotCaches 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "smartTagPr")) // CT_SmartTagPr 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "smartTagPr")) // CT_SmartTagPr 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "smartTagTypes")) // CT_SmartTagTypes 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "smartTagTypes")) // CT_SmartTagTypes 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "webPublishing")) // CT_WebPublishing 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "webPublishing")) // CT_WebPublishing 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "fileRecoveryPr")) // CT_FileRecoveryPr 0+
+        else if (current_workbook_element == XLNT_QN("workbook", "fileRecoveryPr")) // CT_FileRecoveryPr 0+
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "webPublishObjects")) // CT_WebPublishObjects 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "webPublishObjects")) // CT_WebPublishObjects 0-1
         {
             skip_remaining_content(current_workbook_element);
         }
-        else if (current_workbook_element == qn("workbook", "extLst")) // CT_ExtensionList 0-1
+        else if (current_workbook_element == XLNT_QN("workbook", "extLst")) // CT_ExtensionList 0-1
         {
-            while (in_element(qn("workbook", "extLst")))
+            while (in_element(XLNT_QN("workbook", "extLst")))
             {
                 auto extension_element = expect_start_element(xml::content::complex);
 
-                if (extension_element == qn("workbook", "ext")
+                if (extension_element == XLNT_QN("workbook", "ext")
                     && parser().attribute_present("uri")
                     && parser().attribute("uri") == "{7523E5D3-25F3-A5E0-1632-64F254C22452}")
                 {
                     auto arch_id_extension_element = expect_start_element(xml::content::simple);
 
-                    if (arch_id_extension_element == qn("mx", "ArchID"))
+                    if (arch_id_extension_element == XLNT_QN("mx", "ArchID"))
                     {
                         target_.d_->arch_id_flags_ = parser().attribute<std::size_t>("Flags");
                     }
@@ -2246,7 +3035,12 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         expect_end_element(current_workbook_element);
     }
 
-    expect_end_element(qn("workbook", "workbook"));
+    expect_end_element(XLNT_QN("workbook", "workbook"));
+
+    if (peeking_)
+    {
+        return;
+    }
 
     auto workbook_rel = manifest().relationship(path("/"), relationship_type::office_document);
     auto workbook_path = workbook_rel.target().path();
@@ -2258,15 +3052,54 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         relationship_type::vbaproject,
     };
 
+    // when the worksheets are read concurrently, the shared strings and the stylesheet
+    // are read alongside them instead of before them
+    const auto concurrent = options_.worksheet_threads > 1 && !streaming_ && !worksheet_loader_
+        && snapshot_sheets_ == nullptr && !archive_->forward_only();
+    std::vector<relationship> workbook_parts;
+
     for (auto rel_type : rel_types)
     {
-        if (manifest().has_relationship(workbook_path, rel_type))
+        // the stylesheet is still read for the number formats
+        if (options_.values_only && (rel_type == relationship_type::theme || rel_type == relationship_type::vbaproject))
+        {
+            continue;
+        }
+
+        if (!manifest().has_relationship(workbook_path, rel_type))
+        {
+            continue;
+        }
+
+        const auto part_rel = manifest().relationship(workbook_path, rel_type);
+
+        if (concurrent
+            && (rel_type == relationship_type::stylesheet
+                || (rel_type == relationship_type::shared_string_table && !options_.lazy_shared_strings)))
+        {
+            workbook_parts.push_back(part_rel);
+        }
+        else
+        {
+            read_part({workbook_rel, part_rel});
+        }
+    }
+
+    // files saved by earlier versions have the relationship of a calculation chain
+    // without its part, and a forward-only archive would be read to its end to find out
+    if (manifest().has_relationship(workbook_path, relationship_type::calculation_chain)
+        && !archive_->forward_only() && !options_.values_only)
+    {
+        const auto chain_rel = manifest().relationship(workbook_path, relationship_type::calculation_chain);
+
+        if (archive_->has_file(manifest().canonicalize({workbook_rel, chain_rel})))
         {
-            read_part({workbook_rel,
-                manifest().relationship(workbook_path, rel_type)});
+            read_part({workbook_rel, chain_rel});
         }
     }
 
+    std::vector<std::pair<relationship, detail::worksheet_impl *>> worksheets;
+
     for (auto worksheet_rel : manifest().relationships(workbook_path, relationship_type::worksheet))
     {
         auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
@@ -2286,18 +3119,254 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         }
 
         current_worksheet_ = &*target_.d_->worksheets_.emplace(insertion_iter, &target_, id, title);
+        target_.d_->worksheet_index_.invalidate();
+
+        if (streaming_)
+        {
+            continue;
+        }
+
+        // worksheets which aren't projected are left empty
+        if (!options_.sheets.empty()
+            && std::find(options_.sheets.begin(), options_.sheets.end(), title) == options_.sheets.end())
+        {
+            continue;
+        }
+
+        if (worksheet_loader_)
+        {
+            current_worksheet_->loader_ = worksheet_loader_;
+            current_worksheet_->loader_rel_id_ = worksheet_rel.id();
+            current_worksheet_->load_pending_ = true;
+            continue;
+        }
 
-        if (!streaming_)
+        if (options_.worksheet_threads > 1)
+        {
+            worksheets.emplace_back(worksheet_rel, current_worksheet_);
+        }
+        else
         {
             read_part({workbook_rel, worksheet_rel});
         }
     }
+
+    if (!worksheets.empty())
+    {
+        read_worksheets_concurrently(workbook_rel, workbook_parts, worksheets);
+    }
+    else
+    {
+        for (const auto &part_rel : workbook_parts)
+        {
+            read_part({workbook_rel, part_rel});
+        }
+    }
+
+    if (worksheet_loader_)
+    {
+        worksheet_loader_->defined_names = defined_names_;
+    }
+}
+
+void xlsx_consumer::read_worksheets_concurrently(const relationship &workbook_rel,
+    const std::vector<relationship> &workbook_parts,
+    const std::vector<std::pair<relationship, detail::worksheet_impl *>> &worksheets)
+{
+    // Only the workbook parts and sheetData are read without holding this lock. Everything
+    // before and after sheetData may touch the manifest, views or the archive's source stream,
+    // and everything after it may also use the shared strings and the stylesheet.
+    std::mutex workbook_mutex;
+    std::condition_variable workbook_parts_read;
+    auto workbook_parts_pending = workbook_parts.size();
+    // the formats of cells constructed before the stylesheet has been read are resolved later
+    auto stylesheet_pending = std::any_of(workbook_parts.begin(), workbook_parts.end(),
+        [](const relationship &part_rel) { return part_rel.type() == relationship_type::stylesheet; });
+    std::atomic<std::size_t> next_task(0);
+    std::exception_ptr error;
+
+    // the workbook parts are the first tasks, so none is waited for before a thread has taken it
+    const auto task_count = workbook_parts.size() + worksheets.size();
+
+    auto read_workbook_part = [&](const relationship &part_rel, std::unique_lock<std::mutex> &lock) {
+        xlsx_consumer worker(target_, options_);
+        worker.archive_ = archive_;
+        worker.progress_ = progress_;
+        worker.limits_ = limits_;
+
+        const auto part_path = manifest().canonicalize({workbook_rel, part_rel});
+        auto part_streambuf = archive_->open_detached(part_path);
+        lock.unlock();
+
+        XLNT_TRACE_SCOPE_ARG("read_part", part_path.string());
+        std::istream part_stream(part_streambuf.get());
+        xml::parser parser(part_stream, part_path.string());
+        worker.parser_ = &parser;
+
+        if (part_rel.type() == relationship_type::shared_string_table)
+        {
+            phase_timer timer(options_.stats, &io_stats::shared_strings);
+
+            // the workbook's table is only filled while holding the lock since adding
+            // to it registers the part in the manifest
+            std::vector<rich_text> strings;
+            worker.read_shared_string_table(&strings);
+            lock.lock();
+
+            for (auto &text : strings)
+            {
+                target_.add_shared_string(std::move(text), true);
+            }
+        }
+        else
+        {
+            phase_timer timer(options_.stats, &io_stats::stylesheet);
+            worker.read_stylesheet();
+            lock.lock();
+            stylesheet_pending = false;
+        }
+
+        --workbook_parts_pending;
+        workbook_parts_read.notify_all();
+    };
+
+    auto read_worksheet = [&](std::size_t i, std::unique_lock<std::mutex> &lock) {
+        const auto &worksheet_rel = worksheets[i].first;
+
+        xlsx_consumer worker(target_, options_);
+        worker.archive_ = archive_;
+        worker.progress_ = progress_;
+        worker.limits_ = limits_;
+        worker.defined_names_ = defined_names_;
+        worker.decoded_header_footers_ = decoded_header_footers_;
+        worker.current_worksheet_ = worksheets[i].second;
+
+        if (stylesheet_pending)
+        {
+            worker.deferred_formats_.reset(new std::vector<deferred_format>());
+        }
+
+        const auto part_path = manifest().canonicalize({workbook_rel, worksheet_rel});
+        auto part_streambuf = archive_->open_detached(part_path);
+
+        if (options_.fast_sheet_data)
+        {
+            // the detached part is inflated without holding the lock
+            lock.unlock();
+            part_streambuf = worker.cut_sheet_data(*part_streambuf);
+            lock.lock();
+        }
+        else if (options_.inflate_ahead)
+        {
+            part_streambuf = worker.read_ahead(std::move(part_streambuf));
+        }
+
+        std::istream part_stream(part_streambuf.get());
+        xml::parser parser(part_stream, part_path.string());
+        worker.parser_ = &parser;
+
+        worker.read_worksheet_begin(worksheet_rel.id());
+        lock.unlock();
+
+        worker.read_worksheet_sheetdata();
+
+        lock.lock();
+        workbook_parts_read.wait(lock, [&]() { return workbook_parts_pending == 0 || error; });
+
+        if (error)
+        {
+            return;
+        }
+
+        lock.unlock();
+        worker.resolve_deferred_formats();
+
+        lock.lock();
+        auto ws = worker.read_worksheet_end(worksheet_rel.id());
+
+        // the lock keeps the other workers from changing the workbook while it's used
+        if (options_.worksheet_loaded)
+        {
+            options_.worksheet_loaded(ws);
+        }
+    };
+
+    auto run_tasks = [&]() {
+        try
+        {
+            for (auto i = next_task++; i < task_count; i = next_task++)
+            {
+                std::unique_lock<std::mutex> lock(workbook_mutex);
+
+                if (error)
+                {
+                    return;
+                }
+
+                if (i < workbook_parts.size())
+                {
+                    read_workbook_part(workbook_parts[i], lock);
+                }
+                else
+                {
+                    read_worksheet(i - workbook_parts.size(), lock);
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(workbook_mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            next_task = task_count;
+            workbook_parts_read.notify_all();
+        }
+    };
+
+    run_workers(std::min(options_.worksheet_threads, task_count), run_tasks);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
 }
 
 // Write Workbook Relationship Target Parts
 
 void xlsx_consumer::read_calculation_chain()
 {
+    auto &chain = target_.d_->calculation_chain_;
+    chain.clear();
+    std::size_t sheet_id = 0;
+
+    expect_start_element(XLNT_QN("spreadsheetml", "calcChain"), xml::content::complex);
+
+    while (in_element(XLNT_QN("spreadsheetml", "calcChain")))
+    {
+        expect_start_element(XLNT_QN("spreadsheetml", "c"), xml::content::simple);
+
+        // a cell without a sheet id is on the sheet of the cell before it
+        if (parser().attribute_present("i"))
+        {
+            sheet_id = parser().attribute<std::size_t>("i");
+        }
+
+        detail::calculation_chain_entry entry;
+        entry.sheet_id = sheet_id;
+        entry.reference = cell_reference(parser().attribute("r"));
+        entry.new_level = parser().attribute_present("l") && is_true(parser().attribute("l"));
+        entry.array = parser().attribute_present("a") && is_true(parser().attribute("a"));
+        skip_attributes({"s", "t", "a"});
+        chain.push_back(entry);
+
+        expect_end_element(XLNT_QN("spreadsheetml", "c"));
+    }
+
+    expect_end_element(XLNT_QN("spreadsheetml", "calcChain"));
 }
 
 void xlsx_consumer::read_chartsheet(const std::string & /*title*/)
@@ -2328,26 +3397,38 @@ void xlsx_consumer::read_pivot_table()
 {
 }
 
-void xlsx_consumer::read_shared_string_table()
+void xlsx_consumer::read_shared_string_table(std::vector<rich_text> *strings_read)
 {
-    expect_start_element(qn("spreadsheetml", "sst"), xml::content::complex);
+    XLNT_TRACE_SCOPE("read_shared_string_table");
+    expect_start_element(XLNT_QN("spreadsheetml", "sst"), xml::content::complex);
     skip_attributes({"count"});
+    std::size_t strings = 0;
 
-    while (in_element(qn("spreadsheetml", "sst")))
+    while (in_element(XLNT_QN("spreadsheetml", "sst")))
     {
-        expect_start_element(qn("spreadsheetml", "si"), xml::content::complex);
-        auto rt = read_rich_text(qn("spreadsheetml", "si"));
-        target_.add_shared_string(rt, true);
-        expect_end_element(qn("spreadsheetml", "si"));
+        limits_->check_shared_strings(++strings);
+        expect_start_element(XLNT_QN("spreadsheetml", "si"), xml::content::complex);
+        auto rt = read_rich_text(XLNT_QN("spreadsheetml", "si"));
+
+        if (strings_read != nullptr)
+        {
+            strings_read->push_back(std::move(rt));
+        }
+        else
+        {
+            target_.add_shared_string(std::move(rt), true);
+        }
+
+        expect_end_element(XLNT_QN("spreadsheetml", "si"));
     }
 
-    expect_end_element(qn("spreadsheetml", "sst"));
+    expect_end_element(XLNT_QN("spreadsheetml", "sst"));
 
 #ifdef THROW_ON_INVALID_XML
     if (parser().attribute_present("uniqueCount"))
     {
         std::size_t unique_count = parser().attribute<std::size_t>("uniqueCount");
-        if (unique_count != target_.shared_strings().size())
+        if (unique_count != strings)
         {
             throw invalid_file("sizes don't match");
         }
@@ -2355,6 +3436,45 @@ void xlsx_consumer::read_shared_string_table()
 #endif
 }
 
+bool xlsx_consumer::read_shared_string_table_lazily(std::string &&part)
+{
+    auto root_begin = std::size_t(0);
+    auto root_end = std::size_t(0);
+    auto offsets = std::vector<std::size_t>();
+
+    if (!index_shared_strings(part.data(), part.size(), root_begin, root_end, offsets))
+    {
+        return false;
+    }
+
+    if (offsets.size() > 1)
+    {
+        // the offsets end with the end of the last string
+        limits_->check_shared_strings(offsets.size() - 1);
+        target_.register_workbook_part(relationship_type::shared_string_table);
+        target_.d_->shared_strings_loader_ = std::make_shared<shared_string_loader>(
+            std::move(part), root_begin, root_end, std::move(offsets));
+        target_.d_->shared_strings_pending_ = true;
+    }
+
+    return true;
+}
+
+rich_text xlsx_consumer::read_shared_string(std::istream &stream)
+{
+    xml::parser parser(stream, "si");
+    parser_ = &parser;
+
+    expect_start_element(XLNT_QN("spreadsheetml", "sst"), xml::content::complex);
+    skip_attributes();
+    expect_start_element(XLNT_QN("spreadsheetml", "si"), xml::content::complex);
+    auto text = read_rich_text(XLNT_QN("spreadsheetml", "si"));
+    expect_end_element(XLNT_QN("spreadsheetml", "si"));
+    expect_end_element(XLNT_QN("spreadsheetml", "sst"));
+
+    return text;
+}
+
 void xlsx_consumer::read_shared_workbook_revision_headers()
 {
 }
@@ -2372,18 +3492,24 @@ void xlsx_consumer::read_stylesheet()
     target_.impl().stylesheet_ = detail::stylesheet();
     auto &stylesheet = target_.impl().stylesheet_.get();
 
-    expect_start_element(qn("spreadsheetml", "styleSheet"), xml::content::complex);
-    skip_attributes({qn("mc", "Ignorable")});
+    expect_start_element(XLNT_QN("spreadsheetml", "styleSheet"), xml::content::complex);
+    skip_attributes({XLNT_QN("mc", "Ignorable")});
 
     std::vector<std::pair<style_impl, std::size_t>> styles;
     std::vector<std::pair<format_impl, std::size_t>> format_records;
     std::vector<std::pair<format_impl, std::size_t>> style_records;
 
-    while (in_element(qn("spreadsheetml", "styleSheet")))
+    while (in_element(XLNT_QN("spreadsheetml", "styleSheet")))
     {
         auto current_style_element = expect_start_element(xml::content::complex);
 
-        if (current_style_element == qn("spreadsheetml", "borders"))
+        if (options_.values_only && current_style_element != XLNT_QN("spreadsheetml", "numFmts")
+            && current_style_element != XLNT_QN("spreadsheetml", "cellXfs"))
+        {
+            // only the number formats of the cell formats are needed to recognise dates
+            skip_remaining_content(current_style_element);
+        }
+        else if (current_style_element == XLNT_QN("spreadsheetml", "borders"))
         {
             auto &borders = stylesheet.borders;
             optional<std::size_t> count;
@@ -2393,12 +3519,13 @@ void xlsx_consumer::read_stylesheet()
                 borders.reserve(xlnt::detail::clip_reserve_elements(count.get()));
             }
 
-            while (in_element(qn("spreadsheetml", "borders")))
+            while (in_element(XLNT_QN("spreadsheetml", "borders")))
             {
+                limits_->check_styles(borders.size() + 1, "borders");
                 borders.push_back(xlnt::border());
                 auto &border = borders.back();
 
-                expect_start_element(qn("spreadsheetml", "border"), xml::content::complex);
+                expect_start_element(XLNT_QN("spreadsheetml", "border"), xml::content::complex);
 
                 auto diagonal = diagonal_direction::neither;
 
@@ -2417,7 +3544,7 @@ void xlsx_consumer::read_stylesheet()
                     border.diagonal(diagonal);
                 }
 
-                while (in_element(qn("spreadsheetml", "border")))
+                while (in_element(XLNT_QN("spreadsheetml", "border")))
                 {
                     auto current_side_element = expect_start_element(xml::content::complex);
 
@@ -2430,9 +3557,9 @@ void xlsx_consumer::read_stylesheet()
 
                     if (in_element(current_side_element))
                     {
-                        expect_start_element(qn("spreadsheetml", "color"), xml::content::complex);
+                        expect_start_element(XLNT_QN("spreadsheetml", "color"), xml::content::complex);
                         side.color(read_color());
-                        expect_end_element(qn("spreadsheetml", "color"));
+                        expect_end_element(XLNT_QN("spreadsheetml", "color"));
                     }
 
                     expect_end_element(current_side_element);
@@ -2441,7 +3568,7 @@ void xlsx_consumer::read_stylesheet()
                     border.side(side_type, side);
                 }
 
-                expect_end_element(qn("spreadsheetml", "border"));
+                expect_end_element(XLNT_QN("spreadsheetml", "border"));
             }
 
 #ifdef THROW_ON_INVALID_XML
@@ -2451,7 +3578,7 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "fills"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "fills"))
         {
             auto &fills = stylesheet.fills;
             optional<std::size_t> count;
@@ -2461,19 +3588,20 @@ void xlsx_consumer::read_stylesheet()
                 fills.reserve(xlnt::detail::clip_reserve_elements(count.get()));
             }
 
-            while (in_element(qn("spreadsheetml", "fills")))
+            while (in_element(XLNT_QN("spreadsheetml", "fills")))
             {
+                limits_->check_styles(fills.size() + 1, "fills");
                 fills.push_back(xlnt::fill());
                 auto &new_fill = fills.back();
 
-                expect_start_element(qn("spreadsheetml", "fill"), xml::content::complex);
+                expect_start_element(XLNT_QN("spreadsheetml", "fill"), xml::content::complex);
 
-                if (in_element(qn("spreadsheetml", "fill")))
+                if (in_element(XLNT_QN("spreadsheetml", "fill")))
                 {
 
                     auto fill_element = expect_start_element(xml::content::complex);
 
-                    if (fill_element == qn("spreadsheetml", "patternFill"))
+                    if (fill_element == XLNT_QN("spreadsheetml", "patternFill"))
                     {
                         xlnt::pattern_fill pattern;
 
@@ -2481,15 +3609,15 @@ void xlsx_consumer::read_stylesheet()
                         {
                             pattern.type(parser().attribute<xlnt::pattern_fill_type>("patternType"));
 
-                            while (in_element(qn("spreadsheetml", "patternFill")))
+                            while (in_element(XLNT_QN("spreadsheetml", "patternFill")))
                             {
                                 auto pattern_type_element = expect_start_element(xml::content::complex);
 
-                                if (pattern_type_element == qn("spreadsheetml", "fgColor"))
+                                if (pattern_type_element == XLNT_QN("spreadsheetml", "fgColor"))
                                 {
                                     pattern.foreground(read_color());
                                 }
-                                else if (pattern_type_element == qn("spreadsheetml", "bgColor"))
+                                else if (pattern_type_element == XLNT_QN("spreadsheetml", "bgColor"))
                                 {
                                     pattern.background(read_color());
                                 }
@@ -2504,7 +3632,7 @@ void xlsx_consumer::read_stylesheet()
 
                         new_fill = pattern;
                     }
-                    else if (fill_element == qn("spreadsheetml", "gradientFill"))
+                    else if (fill_element == XLNT_QN("spreadsheetml", "gradientFill"))
                     {
                         xlnt::gradient_fill gradient;
 
@@ -2517,14 +3645,14 @@ void xlsx_consumer::read_stylesheet()
                             gradient.type(xlnt::gradient_fill_type::linear);
                         }
 
-                        while (in_element(qn("spreadsheetml", "gradientFill")))
+                        while (in_element(XLNT_QN("spreadsheetml", "gradientFill")))
                         {
-                            expect_start_element(qn("spreadsheetml", "stop"), xml::content::complex);
+                            expect_start_element(XLNT_QN("spreadsheetml", "stop"), xml::content::complex);
                             auto position = xlnt::detail::deserialise(parser().attribute("position"));
-                            expect_start_element(qn("spreadsheetml", "color"), xml::content::complex);
+                            expect_start_element(XLNT_QN("spreadsheetml", "color"), xml::content::complex);
                             auto color = read_color();
-                            expect_end_element(qn("spreadsheetml", "color"));
-                            expect_end_element(qn("spreadsheetml", "stop"));
+                            expect_end_element(XLNT_QN("spreadsheetml", "color"));
+                            expect_end_element(XLNT_QN("spreadsheetml", "stop"));
 
                             gradient.add_stop(position, color);
                         }
@@ -2539,7 +3667,7 @@ void xlsx_consumer::read_stylesheet()
                     expect_end_element(fill_element);
                 }
 
-                expect_end_element(qn("spreadsheetml", "fill"));
+                expect_end_element(XLNT_QN("spreadsheetml", "fill"));
             }
 
 #ifdef THROW_ON_INVALID_XML
@@ -2549,7 +3677,7 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "fonts"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "fonts"))
         {
             auto &fonts = stylesheet.fonts;
             optional<std::size_t> count;
@@ -2559,43 +3687,44 @@ void xlsx_consumer::read_stylesheet()
                 fonts.reserve(xlnt::detail::clip_reserve_elements(count.get()));
             }
 
-            if (parser().attribute_present(qn("x14ac", "knownFonts")))
+            if (parser().attribute_present(XLNT_QN("x14ac", "knownFonts")))
             {
                 target_.enable_known_fonts();
             }
 
-            while (in_element(qn("spreadsheetml", "fonts")))
+            while (in_element(XLNT_QN("spreadsheetml", "fonts")))
             {
+                limits_->check_styles(fonts.size() + 1, "fonts");
                 fonts.push_back(xlnt::font());
                 auto &new_font = stylesheet.fonts.back();
 
-                expect_start_element(qn("spreadsheetml", "font"), xml::content::complex);
+                expect_start_element(XLNT_QN("spreadsheetml", "font"), xml::content::complex);
 
-                while (in_element(qn("spreadsheetml", "font")))
+                while (in_element(XLNT_QN("spreadsheetml", "font")))
                 {
                     auto font_property_element = expect_start_element(xml::content::simple);
 
-                    if (font_property_element == qn("spreadsheetml", "sz"))
+                    if (font_property_element == XLNT_QN("spreadsheetml", "sz"))
                     {
                         new_font.size(xlnt::detail::deserialise(parser().attribute("val")));
                     }
-                    else if (font_property_element == qn("spreadsheetml", "name"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "name"))
                     {
                         new_font.name(parser().attribute("val"));
                     }
-                    else if (font_property_element == qn("spreadsheetml", "color"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "color"))
                     {
                         new_font.color(read_color());
                     }
-                    else if (font_property_element == qn("spreadsheetml", "family"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "family"))
                     {
                         new_font.family(parser().attribute<std::size_t>("val"));
                     }
-                    else if (font_property_element == qn("spreadsheetml", "scheme"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "scheme"))
                     {
                         new_font.scheme(parser().attribute("val"));
                     }
-                    else if (font_property_element == qn("spreadsheetml", "b"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "b"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2606,7 +3735,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.bold(true);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "vertAlign"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "vertAlign"))
                     {
                         auto vert_align = parser().attribute("val");
 
@@ -2619,7 +3748,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.subscript(true);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "strike"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "strike"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2630,7 +3759,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.strikethrough(true);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "outline"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "outline"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2641,7 +3770,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.outline(true);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "shadow"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "shadow"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2652,7 +3781,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.shadow(true);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "i"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "i"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2663,7 +3792,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.italic(true);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "u"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "u"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2674,7 +3803,7 @@ void xlsx_consumer::read_stylesheet()
                             new_font.underline(xlnt::font::underline_style::single);
                         }
                     }
-                    else if (font_property_element == qn("spreadsheetml", "charset"))
+                    else if (font_property_element == XLNT_QN("spreadsheetml", "charset"))
                     {
                         if (parser().attribute_present("val"))
                         {
@@ -2689,7 +3818,7 @@ void xlsx_consumer::read_stylesheet()
                     expect_end_element(font_property_element);
                 }
 
-                expect_end_element(qn("spreadsheetml", "font"));
+                expect_end_element(XLNT_QN("spreadsheetml", "font"));
             }
 
 #ifdef THROW_ON_INVALID_XML
@@ -2699,7 +3828,7 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "numFmts"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "numFmts"))
         {
             auto &number_formats = stylesheet.number_formats;
             optional<std::size_t> count;
@@ -2709,9 +3838,10 @@ void xlsx_consumer::read_stylesheet()
                 number_formats.reserve(xlnt::detail::clip_reserve_elements(count.get()));
             }
 
-            while (in_element(qn("spreadsheetml", "numFmts")))
+            while (in_element(XLNT_QN("spreadsheetml", "numFmts")))
             {
-                expect_start_element(qn("spreadsheetml", "numFmt"), xml::content::simple);
+                limits_->check_styles(number_formats.size() + 1, "number formats");
+                expect_start_element(XLNT_QN("spreadsheetml", "numFmt"), xml::content::simple);
 
                 auto format_string = parser().attribute("formatCode");
 
@@ -2725,7 +3855,7 @@ void xlsx_consumer::read_stylesheet()
                 nf.format_string(format_string);
                 nf.id(parser().attribute<std::size_t>("numFmtId"));
 
-                expect_end_element(qn("spreadsheetml", "numFmt"));
+                expect_end_element(XLNT_QN("spreadsheetml", "numFmt"));
 
                 number_formats.push_back(nf);
             }
@@ -2737,7 +3867,7 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "cellStyles"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "cellStyles"))
         {
             optional<std::size_t> count;
             if (parser().attribute_present("count"))
@@ -2746,11 +3876,12 @@ void xlsx_consumer::read_stylesheet()
                 styles.reserve(xlnt::detail::clip_reserve_elements(count.get()));
             }
 
-            while (in_element(qn("spreadsheetml", "cellStyles")))
+            while (in_element(XLNT_QN("spreadsheetml", "cellStyles")))
             {
+                limits_->check_styles(styles.size() + 1, "cell styles");
                 auto &data = *styles.emplace(styles.end());
 
-                expect_start_element(qn("spreadsheetml", "cellStyle"), xml::content::simple);
+                expect_start_element(XLNT_QN("spreadsheetml", "cellStyle"), xml::content::simple);
 
                 data.first.name = parser().attribute("name");
                 data.second = parser().attribute<std::size_t>("xfId");
@@ -2770,7 +3901,7 @@ void xlsx_consumer::read_stylesheet()
                     data.first.custom_builtin = is_true(parser().attribute("customBuiltin"));
                 }
 
-                expect_end_element(qn("spreadsheetml", "cellStyle"));
+                expect_end_element(XLNT_QN("spreadsheetml", "cellStyle"));
             }
 
 #ifdef THROW_ON_INVALID_XML
@@ -2780,8 +3911,8 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "cellStyleXfs")
-            || current_style_element == qn("spreadsheetml", "cellXfs"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "cellStyleXfs")
+            || current_style_element == XLNT_QN("spreadsheetml", "cellXfs"))
         {
             auto in_style_records = current_style_element.name() == "cellStyleXfs";
             optional<std::size_t> count;
@@ -2800,7 +3931,16 @@ void xlsx_consumer::read_stylesheet()
 
             while (in_element(current_style_element))
             {
-                expect_start_element(qn("spreadsheetml", "xf"), xml::content::complex);
+                if (in_style_records)
+                {
+                    limits_->check_styles(style_records.size() + 1, "cell style formats");
+                }
+                else
+                {
+                    limits_->check_styles(format_records.size() + 1, "cell formats");
+                }
+
+                expect_start_element(XLNT_QN("spreadsheetml", "xf"), xml::content::complex);
 
                 auto &record = *(!in_style_records
                         ? format_records.emplace(format_records.end())
@@ -2860,11 +4000,11 @@ void xlsx_consumer::read_stylesheet()
                     record.second = parser().attribute<std::size_t>("xfId");
                 }
 
-                while (in_element(qn("spreadsheetml", "xf")))
+                while (in_element(XLNT_QN("spreadsheetml", "xf")))
                 {
                     auto xf_child_element = expect_start_element(xml::content::simple);
 
-                    if (xf_child_element == qn("spreadsheetml", "alignment"))
+                    if (xf_child_element == XLNT_QN("spreadsheetml", "alignment"))
                     {
                         record.first.alignment_id = stylesheet.alignments.size();
                         auto &alignment = *stylesheet.alignments.emplace(stylesheet.alignments.end());
@@ -2904,7 +4044,7 @@ void xlsx_consumer::read_stylesheet()
                             parser().attribute<int>("readingOrder");
                         }
                     }
-                    else if (xf_child_element == qn("spreadsheetml", "protection"))
+                    else if (xf_child_element == XLNT_QN("spreadsheetml", "protection"))
                     {
                         record.first.protection_id = stylesheet.protections.size();
                         auto &protection = *stylesheet.protections.emplace(stylesheet.protections.end());
@@ -2922,7 +4062,7 @@ void xlsx_consumer::read_stylesheet()
                     expect_end_element(xf_child_element);
                 }
 
-                expect_end_element(qn("spreadsheetml", "xf"));
+                expect_end_element(XLNT_QN("spreadsheetml", "xf"));
             }
 
 #ifdef THROW_ON_INVALID_XML
@@ -2933,7 +4073,7 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "dxfs"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "dxfs"))
         {
             std::size_t processed = 0;
 
@@ -2956,14 +4096,14 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "tableStyles"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "tableStyles"))
         {
             skip_attribute("defaultTableStyle");
             skip_attribute("defaultPivotStyle");
 
             std::size_t processed = 0;
 
-            while (in_element(qn("spreadsheetml", "tableStyles")))
+            while (in_element(XLNT_QN("spreadsheetml", "tableStyles")))
             {
                 auto current_element = expect_start_element(xml::content::complex);
                 skip_remaining_content(current_element);
@@ -2982,44 +4122,44 @@ void xlsx_consumer::read_stylesheet()
             }
 #endif
         }
-        else if (current_style_element == qn("spreadsheetml", "extLst"))
+        else if (current_style_element == XLNT_QN("spreadsheetml", "extLst"))
         {
-            while (in_element(qn("spreadsheetml", "extLst")))
+            while (in_element(XLNT_QN("spreadsheetml", "extLst")))
             {
-                expect_start_element(qn("spreadsheetml", "ext"), xml::content::complex);
+                expect_start_element(XLNT_QN("spreadsheetml", "ext"), xml::content::complex);
 
                 const auto uri = parser().attribute("uri");
 
                 if (uri == "{EB79DEF2-80B8-43e5-95BD-54CBDDF9020C}") // slicerStyles
                 {
-                    expect_start_element(qn("x14", "slicerStyles"), xml::content::simple);
+                    expect_start_element(XLNT_QN("x14", "slicerStyles"), xml::content::simple);
                     stylesheet.default_slicer_style = parser().attribute("defaultSlicerStyle");
-                    expect_end_element(qn("x14", "slicerStyles"));
+                    expect_end_element(XLNT_QN("x14", "slicerStyles"));
                 }
                 else
                 {
-                    skip_remaining_content(qn("spreadsheetml", "ext"));
+                    skip_remaining_content(XLNT_QN("spreadsheetml", "ext"));
                 }
 
-                expect_end_element(qn("spreadsheetml", "ext"));
+                expect_end_element(XLNT_QN("spreadsheetml", "ext"));
             }
         }
-        else if (current_style_element == qn("spreadsheetml", "colors")) // CT_Colors 0-1
+        else if (current_style_element == XLNT_QN("spreadsheetml", "colors")) // CT_Colors 0-1
         {
-            while (in_element(qn("spreadsheetml", "colors")))
+            while (in_element(XLNT_QN("spreadsheetml", "colors")))
             {
                 auto colors_child_element = expect_start_element(xml::content::complex);
 
-                if (colors_child_element == qn("spreadsheetml", "indexedColors")) // CT_IndexedColors 0-1
+                if (colors_child_element == XLNT_QN("spreadsheetml", "indexedColors")) // CT_IndexedColors 0-1
                 {
                     while (in_element(colors_child_element))
                     {
-                        expect_start_element(qn("spreadsheetml", "rgbColor"), xml::content::simple);
+                        expect_start_element(XLNT_QN("spreadsheetml", "rgbColor"), xml::content::simple);
                         stylesheet.colors.push_back(read_color());
-                        expect_end_element(qn("spreadsheetml", "rgbColor"));
+                        expect_end_element(XLNT_QN("spreadsheetml", "rgbColor"));
                     }
                 }
-                else if (colors_child_element == qn("spreadsheetml", "mruColors")) // CT_MRUColors
+                else if (colors_child_element == XLNT_QN("spreadsheetml", "mruColors")) // CT_MRUColors
                 {
                     skip_remaining_content(colors_child_element);
                 }
@@ -3039,17 +4179,26 @@ void xlsx_consumer::read_stylesheet()
         expect_end_element(current_style_element);
     }
 
-    expect_end_element(qn("spreadsheetml", "styleSheet"));
+    expect_end_element(XLNT_QN("spreadsheetml", "styleSheet"));
+
+    // the first named style of each cell style format, found without searching the styles for every format
+    std::vector<const std::pair<style_impl, std::size_t> *> styles_by_xf(style_records.size(), nullptr);
+
+    for (const auto &style : styles)
+    {
+        if (style.second < styles_by_xf.size() && styles_by_xf[style.second] == nullptr)
+        {
+            styles_by_xf[style.second] = &style;
+        }
+    }
 
     std::size_t xf_id = 0;
 
     for (const auto &record : style_records)
     {
-        auto style_iter = std::find_if(styles.begin(), styles.end(),
-            [&xf_id](const std::pair<style_impl, std::size_t> &s) { return s.second == xf_id; });
-        ++xf_id;
+        const auto style_iter = styles_by_xf[xf_id++];
 
-        if (style_iter == styles.end()) continue;
+        if (style_iter == nullptr) continue;
 
         auto new_style = stylesheet.create_style(style_iter->first.name);
 
@@ -3078,14 +4227,24 @@ void xlsx_consumer::read_stylesheet()
 
     for (const auto &record : format_records)
     {
-        stylesheet.format_impls.push_back(format_impl());
-        auto &new_format = stylesheet.format_impls.back();
+        auto &new_format = stylesheet.format_impls.push_back(format_impl());
 
         new_format.id = record_index++;
         new_format.parent = &stylesheet;
 
         ++new_format.references;
 
+        if (options_.values_only)
+        {
+            // the other components weren't read
+            new_format.number_format_id = record.first.number_format_id;
+            new_format.number_format_applied = record.first.number_format_applied;
+            new_format.date_format = record.first.number_format_id.is_set()
+                && stylesheet.is_date_format(record.first.number_format_id.get());
+
+            continue;
+        }
+
         new_format.alignment_id = record.first.alignment_id;
         new_format.alignment_applied = record.first.alignment_applied;
         new_format.border_id = record.first.border_id;
@@ -3096,6 +4255,8 @@ void xlsx_consumer::read_stylesheet()
         new_format.font_applied = record.first.font_applied;
         new_format.number_format_id = record.first.number_format_id;
         new_format.number_format_applied = record.first.number_format_applied;
+        new_format.date_format = record.first.number_format_id.is_set()
+            && stylesheet.is_date_format(record.first.number_format_id.get());
         new_format.protection_id = record.first.protection_id;
         new_format.protection_applied = record.first.protection_applied;
         new_format.pivot_button_ = record.first.pivot_button_;
@@ -3137,47 +4298,47 @@ void xlsx_consumer::read_comments(worksheet ws)
 {
     std::vector<std::string> authors;
 
-    expect_start_element(qn("spreadsheetml", "comments"), xml::content::complex);
+    expect_start_element(XLNT_QN("spreadsheetml", "comments"), xml::content::complex);
     // name space can be ignored
-    skip_attribute(qn("mc", "Ignorable"));
-    expect_start_element(qn("spreadsheetml", "authors"), xml::content::complex);
+    skip_attribute(XLNT_QN("mc", "Ignorable"));
+    expect_start_element(XLNT_QN("spreadsheetml", "authors"), xml::content::complex);
 
-    while (in_element(qn("spreadsheetml", "authors")))
+    while (in_element(XLNT_QN("spreadsheetml", "authors")))
     {
-        expect_start_element(qn("spreadsheetml", "author"), xml::content::simple);
+        expect_start_element(XLNT_QN("spreadsheetml", "author"), xml::content::simple);
         authors.push_back(read_text());
-        expect_end_element(qn("spreadsheetml", "author"));
+        expect_end_element(XLNT_QN("spreadsheetml", "author"));
     }
 
-    expect_end_element(qn("spreadsheetml", "authors"));
-    expect_start_element(qn("spreadsheetml", "commentList"), xml::content::complex);
+    expect_end_element(XLNT_QN("spreadsheetml", "authors"));
+    expect_start_element(XLNT_QN("spreadsheetml", "commentList"), xml::content::complex);
 
-    while (in_element(xml::qname(qn("spreadsheetml", "commentList"))))
+    while (in_element(XLNT_QN("spreadsheetml", "commentList")))
     {
-        expect_start_element(qn("spreadsheetml", "comment"), xml::content::complex);
+        expect_start_element(XLNT_QN("spreadsheetml", "comment"), xml::content::complex);
 
         skip_attribute("shapeId");
         auto cell_ref = parser().attribute("ref");
         auto author_id = parser().attribute<std::size_t>("authorId");
 
-        expect_start_element(qn("spreadsheetml", "text"), xml::content::complex);
+        expect_start_element(XLNT_QN("spreadsheetml", "text"), xml::content::complex);
 
-        ws.cell(cell_ref).comment(comment(read_rich_text(qn("spreadsheetml", "text")), authors.at(author_id)));
+        ws.cell(cell_ref).comment(comment(read_rich_text(XLNT_QN("spreadsheetml", "text")), authors.at(author_id)));
 
-        expect_end_element(qn("spreadsheetml", "text"));
+        expect_end_element(XLNT_QN("spreadsheetml", "text"));
 
-        if (in_element(xml::qname(qn("spreadsheetml", "comment"))))
+        if (in_element(XLNT_QN("spreadsheetml", "comment")))
         {
-            expect_start_element(qn("mc", "AlternateContent"), xml::content::complex);
-            skip_remaining_content(qn("mc", "AlternateContent"));
-            expect_end_element(qn("mc", "AlternateContent"));
+            expect_start_element(XLNT_QN("mc", "AlternateContent"), xml::content::complex);
+            skip_remaining_content(XLNT_QN("mc", "AlternateContent"));
+            expect_end_element(XLNT_QN("mc", "AlternateContent"));
         }
 
-        expect_end_element(qn("spreadsheetml", "comment"));
+        expect_end_element(XLNT_QN("spreadsheetml", "comment"));
     }
 
-    expect_end_element(qn("spreadsheetml", "commentList"));
-    expect_end_element(qn("spreadsheetml", "comments"));
+    expect_end_element(XLNT_QN("spreadsheetml", "commentList"));
+    expect_end_element(XLNT_QN("spreadsheetml", "comments"));
 }
 
 void xlsx_consumer::read_drawings(worksheet ws, const path &part)
@@ -3194,8 +4355,13 @@ void xlsx_consumer::read_drawings(worksheet ws, const path &part)
         if (image_rel != images.end())
         {
             const auto url = image_rel->target().path().resolve(part.parent());
+            const auto same = read_drawing_image(url);
 
-            read_image(url);
+            if (same != url)
+            {
+                manifest().register_relationship(relationship(image_rel->id(), image_rel->type(), image_rel->source(),
+                    uri(image_rel->target().path().parent().append(same.filename()).string()), image_rel->target_mode()));
+            }
         }
     }
 
@@ -3214,14 +4380,67 @@ void xlsx_consumer::read_unknown_relationships()
 
 void xlsx_consumer::read_image(const xlnt::path &image_path)
 {
+    if (options_.lazy_binaries)
+    {
+        target_.d_->compressed_images_[image_path.string()] = archive_->read_compressed(image_path);
+        return;
+    }
+
     auto image_streambuf = archive_->open(image_path);
     vector_ostreambuf buffer(target_.d_->images_[image_path.string()]);
     std::ostream out_stream(&buffer);
     out_stream << image_streambuf.get();
 }
 
+path xlsx_consumer::read_drawing_image(const xlnt::path &image_path)
+{
+    auto &wb = *target_.d_;
+    const auto key = image_path.string();
+
+    // already read for another drawing or as another part
+    if (wb.images_.count(key) != 0 || wb.compressed_images_.count(key) != 0 || wb.shared_images_.count(key) != 0)
+    {
+        return image_path;
+    }
+
+    read_image(image_path);
+
+    const auto contents = image_contents_key(wb, key);
+    const auto same = wb.drawing_images_.equal_range(contents);
+
+    for (auto entry = same.first; entry != same.second; ++entry)
+    {
+        const path other(entry->second);
+
+        // the relationship is only retargeted within the folder the image is in
+        if (other.parent() != image_path.parent() || !same_image_contents(wb, entry->second, key)) continue;
+
+        wb.images_.erase(key);
+        wb.compressed_images_.erase(key);
+
+        const path part_name("/" + key);
+
+        if (manifest().has_override_type(part_name))
+        {
+            manifest().unregister_override_type(part_name);
+        }
+
+        return other;
+    }
+
+    wb.drawing_images_.emplace(contents, key);
+
+    return image_path;
+}
+
 void xlsx_consumer::read_binary(const xlnt::path &binary_path)
 {
+    if (options_.lazy_binaries)
+    {
+        target_.d_->compressed_binaries_[binary_path.string()] = archive_->read_compressed(binary_path);
+        return;
+    }
+
     auto binary_streambuf = archive_->open(binary_path);
     vector_ostreambuf buffer(target_.d_->binaries_[binary_path.string()]);
     std::ostream out_stream(&buffer);
@@ -3250,11 +4469,11 @@ variant xlsx_consumer::read_variant()
         auto element = expect_start_element(xml::content::mixed);
         auto text = read_text();
 
-        if (element == qn("vt", "lpwstr") || element == qn("vt", "lpstr"))
+        if (element == XLNT_QN("vt", "lpwstr") || element == XLNT_QN("vt", "lpstr"))
         {
             value = variant(text);
         }
-        if (element == qn("vt", "i4"))
+        if (element == XLNT_QN("vt", "i4"))
         {
             int number = -1;
             if (detail::parse(text, number) != std::errc())
@@ -3268,11 +4487,11 @@ variant xlsx_consumer::read_variant()
                 value = variant(number);
             }
         }
-        if (element == qn("vt", "bool"))
+        if (element == XLNT_QN("vt", "bool"))
         {
             value = variant(is_true(text));
         }
-        else if (element == qn("vt", "vector"))
+        else if (element == XLNT_QN("vt", "vector"))
         {
             auto size = parser().attribute<std::size_t>("size");
             auto base_type = parser().attribute("baseType");
@@ -3283,14 +4502,14 @@ variant xlsx_consumer::read_variant()
             {
                 if (base_type == "variant")
                 {
-                    expect_start_element(qn("vt", "variant"), xml::content::complex);
+                    expect_start_element(XLNT_QN("vt", "variant"), xml::content::complex);
                 }
 
                 vector.push_back(read_variant());
 
                 if (base_type == "variant")
                 {
-                    expect_end_element(qn("vt", "variant"));
+                    expect_end_element(XLNT_QN("vt", "variant"));
                     read_text();
                 }
             }
@@ -3377,7 +4596,7 @@ xml::qname xlsx_consumer::expect_start_element(xml::content content)
     parser().content(content);
     stack_.push_back(parser().qname());
 
-    const auto xml_space = qn("xml", "space");
+    const auto xml_space = XLNT_QN("xml", "space");
     preserve_space_ = parser().attribute_present(xml_space) ? parser().attribute(xml_space) == "preserve" : false;
 
     return stack_.back();
@@ -3389,7 +4608,7 @@ void xlsx_consumer::expect_start_element(const xml::qname &name, xml::content co
     parser().content(content);
     stack_.push_back(name);
 
-    const auto xml_space = qn("xml", "space");
+    const auto xml_space = XLNT_QN("xml", "space");
     preserve_space_ = parser().attribute_present(xml_space) ? parser().attribute(xml_space) == "preserve" : false;
 }
 
@@ -3417,7 +4636,7 @@ rich_text xlsx_consumer::read_rich_text(const xml::qname &parent)
     while (in_element(parent))
     {
         auto text_element = expect_start_element(xml::content::mixed);
-        const auto xml_space = qn("xml", "space");
+        const auto xml_space = XLNT_QN("xml", "space");
         const auto preserve_space = parser().attribute_present(xml_space)
             ? parser().attribute(xml_space) == "preserve"
             : false;
@@ -3522,7 +4741,15 @@ rich_text xlsx_consumer::read_rich_text(const xml::qname &parent)
                 read_text();
             }
 
-            t.add_run(run);
+            if (run.second.is_set())
+            {
+                t.append_run(std::move(run.first), target_.d_->run_fonts_.intern(std::move(run.second.get())),
+                    run.preserve_space);
+            }
+            else
+            {
+                t.add_run(run);
+            }
         }
         else if (text_element == xml::qname(xmlns, "rPh"))
         {
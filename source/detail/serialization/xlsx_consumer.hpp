@@ -26,6 +26,7 @@
 #pragma once
 
 #include <detail/xlnt_config_impl.hpp>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -33,9 +34,14 @@
 #include <vector>
 
 #include <detail/external/include_libstudxml.hpp>
+#include <detail/header_footer/header_footer_code.hpp>
 #include <detail/serialization/zstream.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/workbook_snapshot.hpp>
+#include <detail/utils/progress_reporter.hpp>
 #include <xlnt/internal/features.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
 
 #if XLNT_HAS_INCLUDE(<string_view>) && XLNT_HAS_FEATURE(U8_STRING_VIEW)
   #include <string_view>
@@ -43,26 +49,34 @@
 
 namespace xlnt {
 
+class byte_source;
 class cell;
+class cell_batch;
+class column_batch;
 class color;
+class encryption_key;
 class rich_text;
 class manifest;
 template<typename T>
 class optional;
 class path;
-class range_reference;
 class relationship;
 class streaming_workbook_reader;
 class variant;
 class workbook;
 class worksheet;
+struct workbook_summary;
 
 namespace detail {
 
+struct encryption_key_impl;
 class izstream;
+class load_buffers;
+class load_limits;
 struct cell_impl;
 struct defined_name;
 struct worksheet_impl;
+class worksheet_loader;
 
 /// <summary>
 /// Handles writing a workbook into an XLSX file.
@@ -72,6 +86,8 @@ class XLNT_API_INTERNAL xlsx_consumer
 public:
 	xlsx_consumer(workbook &destination);
 
+	xlsx_consumer(workbook &destination, const load_options &options);
+
 	~xlsx_consumer();
 
 	void read(std::istream &source);
@@ -82,19 +98,63 @@ public:
 	void read(std::istream &source, std::u8string_view password);
 #endif
 
+    void read(std::istream &source, const encryption_key &key);
+
+    /// <summary>
+    /// Reads the archive with ranged reads of source. With load_options::lazy_worksheets,
+    /// source is kept to read the worksheets from when they are first accessed.
+    /// </summary>
+    void read(std::shared_ptr<byte_source> source);
+
+    /// <summary>
+    /// Reads the archive of a snapshot from source like read, but takes the content of
+    /// the sheetData element of each worksheet in sheets from there. Sheets are removed
+    /// from sheets as they are read.
+    /// </summary>
+    void read_snapshot(std::istream &source, snapshot_sheets &sheets);
+
+    /// <summary>
+    /// Makes the archive read by read(std::istream &) take the inflaters and buffers of its
+    /// parts from buffers and give them back afterwards, so that they're reused by later loads.
+    /// </summary>
+    void reuse(std::shared_ptr<load_buffers> buffers);
+
+    /// <summary>
+    /// Reads the sheets and the core properties of the archive in source like
+    /// xlnt::peek, leaving the destination workbook only partly read.
+    /// </summary>
+    workbook_summary peek(std::istream &source);
+
     // For unit testing purpose only
     void read_stylesheet (const std::string& xml);
 
 private:
     friend class xlnt::streaming_workbook_reader;
+    friend class worksheet_loader;
+    friend class shared_string_loader;
 
     void open(std::istream &source);
 
-    template <typename T>
-    void read_internal(std::istream &source, const T &password);
+    /// <summary>
+    /// Decrypts source with password and reads the package it holds, deriving the key
+    /// with the hashes in derived_keys unless it's null.
+    /// </summary>
+    void read_encrypted(std::istream &source, const std::u16string &password,
+        std::shared_ptr<encryption_key_impl> derived_keys);
 
+    /// <summary>
+    /// Constructs the next cell of the current worksheet within projection_ in
+    /// streaming_cell_ and returns false at the end of the worksheet.
+    /// </summary>
     bool has_cell();
 
+    /// <summary>
+    /// Parses the next row of the current worksheet within projection_ into
+    /// streaming_batch_ with the same decoder as a full load. Returns false at the
+    /// end of the worksheet.
+    /// </summary>
+    bool read_next_row();
+
     /// <summary>
     /// Reads the next cell in the current worksheet and optionally returns it if
     /// the last cell in the sheet has not yet been read. An exception will be thrown
@@ -102,12 +162,38 @@ private:
     /// </summary>
     cell read_cell();
 
+    /// <summary>
+    /// Clears batch and fills it with the cells of up to row_count of the next rows
+    /// in the current worksheet without constructing a cell for each of them.
+    /// Returns the number of rows read.
+    /// </summary>
+    std::size_t read_rows(cell_batch &batch, std::size_t row_count);
+
+    /// <summary>
+    /// Like read_rows, but fills the columns of a column_batch.
+    /// </summary>
+    std::size_t read_columns(column_batch &batch, std::size_t row_count);
+
+    /// <summary>
+    /// Reads up to row_count rows for read_rows and read_columns, calling
+    /// append(row, column, type, number, text) for every cell. The index of
+    /// shared_string cells is passed in number.
+    /// </summary>
+    template <typename Appender>
+    std::size_t read_batch_rows(Appender &append, std::size_t row_count);
+
 	/// <summary>
 	/// Read all the files needed from the XLSX archive and initialize all of
 	/// the data in the workbook to match.
 	/// </summary>
 	void populate_workbook(bool streaming);
 
+    /// <summary>
+    /// Adds the number of cells, shared strings and formats that were read to
+    /// options_.stats, if it was given.
+    /// </summary>
+    void record_loaded_counts();
+
     /// <summary>
     ///
     /// </summary>
@@ -172,8 +258,21 @@ private:
 
 	/// <summary>
 	/// xl/sharedStrings.xml
+	/// The strings are appended to strings instead of the workbook's table if it isn't nullptr.
+	/// </summary>
+	void read_shared_string_table(std::vector<rich_text> *strings = nullptr);
+
+	/// <summary>
+	/// Indexes the shared string table part without decoding its strings and hands it
+	/// to a shared_string_loader. Returns false if the part can't be indexed.
 	/// </summary>
-	void read_shared_string_table();
+	bool read_shared_string_table_lazily(std::string &&part);
+
+	/// <summary>
+	/// Reads the single si element of the sst document in stream, which a
+	/// shared_string_loader cuts out of the shared string table part.
+	/// </summary>
+	rich_text read_shared_string(std::istream &stream);
 
 	/// <summary>
 	///
@@ -230,11 +329,92 @@ private:
     /// </summary>
     void read_worksheet_sheetdata();
 
+    /// <summary>
+    /// Parses sheetData on this thread while a second thread constructs the
+    /// parsed cells, see load_options::pipelined_sheet_data. The parsed cells are
+    /// added to sheet_progress.
+    /// </summary>
+    void read_worksheet_sheetdata_pipelined(progress_reporter::worksheet_progress &sheet_progress);
+
+    /// <summary>
+    /// Parses the rows of the current sheetData element, either from the content cut
+    /// out by cut_sheet_data or through the XML parser. flush is called as described
+    /// for parse_sheet_data every time batch_size cells have accumulated.
+    /// </summary>
+    Sheet_Data read_sheet_data_rows(std::size_t batch_size = 0,
+        const std::function<void(Sheet_Data &)> &flush = nullptr);
+
+    /// <summary>
+    /// Reads the whole worksheet part from part and cuts the content of its sheetData
+    /// element out of it so that it can be tokenized directly, see
+    /// load_options::fast_sheet_data. Returns a streambuf over the rest of the part,
+    /// which is what the XML parser reads.
+    /// </summary>
+    std::unique_ptr<std::streambuf> cut_sheet_data(std::streambuf &part);
+
+    /// <summary>
+    /// Wraps part, which must not share its source with other open parts, so that it is
+    /// inflated on a thread of its own while it is parsed, see load_options::inflate_ahead.
+    /// </summary>
+    std::unique_ptr<std::streambuf> read_ahead(std::unique_ptr<std::streambuf> part);
+
+    /// <summary>
+    /// Moves parsed rows and cells into the worksheet currently being read.
+    /// </summary>
+    void construct_sheet_data(Sheet_Data &sheet_data);
+
+    /// <summary>
+    /// Sets the value, formula and format of impl to those of the parsed cell, whose
+    /// number was deserialised to number.
+    /// </summary>
+    void construct_cell(detail::cell_impl &impl, const Sheet_Data &sheet_data, const Cell &cell, double number);
+
+    /// <summary>
+    /// Opens the formula group whose master is the parsed cell.
+    /// </summary>
+    void add_shared_formula(const Sheet_Data &sheet_data, const Cell &cell);
+
+    /// <summary>
+    /// Sizes the cell and row property containers of the worksheet currently being
+    /// read for the cells within dimension_, so that they aren't rehashed while its
+    /// sheetData is constructed.
+    /// </summary>
+    void reserve_sheet_data();
+
     /// <summary>
     /// xl/sheets/*.xml
     /// </summary>
     worksheet read_worksheet_end(const std::string &rel_id);
 
+    /// <summary>
+    /// Reads the given worksheet parts on up to options_.worksheet_threads threads.
+    /// Each worksheet_impl must already exist in the workbook. The shared string table
+    /// and the stylesheet in workbook_parts, if any, are read alongside the sheetData of
+    /// the worksheets, which only refers to them by index: the formats of the cells are
+    /// resolved and the rest of a worksheet is read once both have been read.
+    /// </summary>
+    void read_worksheets_concurrently(const relationship &workbook_rel,
+        const std::vector<relationship> &workbook_parts,
+        const std::vector<std::pair<relationship, detail::worksheet_impl *>> &worksheets);
+
+    /// <summary>
+    /// The cells of one row of the current worksheet, from column first to last, which
+    /// have the cell format at index style.
+    /// </summary>
+    struct deferred_format
+    {
+        row_t row;
+        column_t::index_t first;
+        column_t::index_t last;
+        std::size_t style;
+    };
+
+    /// <summary>
+    /// Gives the cells of the current worksheet the formats recorded in deferred_formats_
+    /// once the stylesheet has been read.
+    /// </summary>
+    void resolve_deferred_formats();
+
 	// Sheet Relationship Target Parts
 
 	/// <summary>
@@ -269,6 +449,14 @@ private:
 	/// </summary>
 	void read_image(const path &part);
 
+	/// <summary>
+	/// Reads an image a drawing refers to unless it has been read before. If an image
+	/// with the same contents was read for a drawing before from the same folder, the
+	/// new one is dropped and the path of that one is returned for the drawing to refer
+	/// to instead. Returns part otherwise.
+	/// </summary>
+	path read_drawing_image(const path &part);
+
 	/// <summary>
 	///
 	/// </summary>
@@ -401,8 +589,14 @@ private:
 
 	/// <summary>
 	/// The ZIP file containing the files that make up the OOXML package.
+	/// It is shared with the consumers reading worksheets concurrently.
+	/// </summary>
+	std::shared_ptr<izstream> archive_;
+
+	/// <summary>
+	/// Where the parts of archive_ take their inflaters and buffers from, or nullptr.
 	/// </summary>
-	std::unique_ptr<izstream> archive_;
+	std::shared_ptr<load_buffers> buffers_;
 
 	/// <summary>
 	/// Map of sheet titles to relationship IDs.
@@ -420,6 +614,28 @@ private:
 	/// </summary>
 	workbook &target_;
 
+	/// <summary>
+	/// Options controlling how the workbook is read.
+	/// </summary>
+	load_options options_;
+
+	/// <summary>
+	/// Reports the cells read to options_.progress, if it is set. It is shared with the
+	/// consumers reading worksheets concurrently.
+	/// </summary>
+	std::shared_ptr<progress_reporter> progress_;
+
+	/// <summary>
+	/// Enforces the resource limits of options_. It is shared with the consumers
+	/// reading worksheets concurrently.
+	/// </summary>
+	std::shared_ptr<load_limits> limits_;
+
+	/// <summary>
+	/// The rows and columns of options_ whose cells are read.
+	/// </summary>
+	Cell_Projection projection_;
+
 	/// <summary>
 	/// This pointer is generally set by instantiating an xml::parser in a function
 	/// scope and then calling a read_*() method which uses xlsx_consumer::parser()
@@ -433,14 +649,90 @@ private:
 
     bool streaming_ = false;
 
+    /// <summary>
+    /// True while peek reads only the parts a workbook_summary is made of.
+    /// </summary>
+    bool peeking_ = false;
+
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
-    std::unordered_map<int, std::string> shared_formulae_;
+    /// <summary>
+    /// The row last parsed by read_next_row(), whose cells are in streaming_batch_ and
+    /// their numbers in numbers_. has_cell() hands out the cells from streaming_next_
+    /// on, and streaming_row_open_ is true until read_rows() has counted the row.
+    /// </summary>
+    row_t streaming_row_ = 0;
+    Sheet_Data streaming_batch_;
+    std::size_t streaming_next_ = 0;
+    bool streaming_row_open_ = false;
+
+    /// <summary>
+    /// Called with the properties of every row read by read_next_row(), see
+    /// streaming_workbook_reader::row_callback.
+    /// </summary>
+    std::function<void(row_t, const row_properties &)> streaming_row_callback_;
+
+    /// <summary>
+    /// Maps the si attribute of the shared formulae of the current worksheet to one
+    /// plus the index of their group in worksheet_impl::formula_groups_.
+    /// </summary>
+    std::unordered_map<int, std::uint32_t> shared_formula_groups_;
     std::unordered_map<std::string, std::string> array_formulae_;
 
+    /// <summary>
+    /// The range given by the dimension element of the current worksheet, if any.
+    /// </summary>
+    optional<range_reference> dimension_;
+
     detail::worksheet_impl *current_worksheet_ = nullptr;
 
     std::vector<defined_name> defined_names_;
+
+    /// <summary>
+    /// Owns the archive and reads the worksheets later if options_.lazy_worksheets is set.
+    /// </summary>
+    std::shared_ptr<worksheet_loader> worksheet_loader_;
+
+    /// <summary>
+    /// The uncompressed worksheet part being read when its sheetData is tokenized directly.
+    /// </summary>
+    std::vector<std::uint8_t> worksheet_part_;
+
+    /// <summary>
+    /// worksheet_part_ without the content of its sheetData element.
+    /// </summary>
+    std::vector<std::uint8_t> worksheet_markup_;
+
+    /// <summary>
+    /// The content of the sheetData element in worksheet_part_, or nullptr if
+    /// sheetData is read through the XML parser.
+    /// </summary>
+    const char *sheet_data_begin_ = nullptr;
+    const char *sheet_data_end_ = nullptr;
+
+    /// <summary>
+    /// The sheets of the snapshot being read, and the sheet of the current worksheet
+    /// until its sheetData has been read.
+    /// </summary>
+    snapshot_sheets *snapshot_sheets_ = nullptr;
+    std::unique_ptr<snapshot_sheet> snapshot_sheet_;
+
+    /// <summary>
+    /// The numbers of the batch of cells being constructed, kept to reuse its memory.
+    /// </summary>
+    std::vector<double> numbers_;
+
+    /// <summary>
+    /// The formats of the cells constructed while the stylesheet is still being read,
+    /// if it is read concurrently with the current worksheet.
+    /// </summary>
+    std::unique_ptr<std::vector<deferred_format>> deferred_formats_;
+
+    /// <summary>
+    /// The header and footer codes decoded so far, shared with the consumers reading
+    /// worksheets concurrently, which only use it while holding the workbook lock.
+    /// </summary>
+    std::shared_ptr<decoded_header_footers> decoded_header_footers_ = std::make_shared<decoded_header_footers>();
 };
 
 } // namespace detail
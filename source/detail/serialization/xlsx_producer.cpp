@@ -22,31 +22,49 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cmath>
+#include <exception>
+#include <mutex>
 #include <numeric> // for std::accumulate
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/hyperlink.hpp>
 #include <xlnt/packaging/manifest.hpp>
+#include <xlnt/utils/date.hpp>
+#include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/numeric.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/scoped_enum_hash.hpp>
+#include <xlnt/workbook/column_view.hpp>
+#include <xlnt/workbook/deflated_fragment.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/workbook_view.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 #include <detail/constants.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
+#include <detail/formula/formula_engine.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
 #include <detail/serialization/defined_name.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
+#include <detail/serialization/sheet_data_writer.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/worksheet_loader.hpp>
+#include <detail/serialization/xlsb_producer.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
 #include <detail/serialization/zstream.hpp>
 #include <detail/serialization/parsers.hpp>
+#include <detail/utils/io_stats_recorder.hpp>
+#include <detail/utils/parallel_for.hpp>
 #include <detail/utils/string_helpers.hpp>
+#include <detail/utils/trace.hpp>
 
 namespace {
 
@@ -77,49 +95,867 @@ std::vector<std::pair<std::string, std::string>> core_property_namespace(xlnt::c
     return {{constants::ns("core-properties"), "cp"}};
 }
 
+/// <summary>
+/// Removes the ".." components of the path of a part in the archive, which
+/// relationship targets are often relative to.
+/// </summary>
+xlnt::path resolve_part_path(const xlnt::path &part)
+{
+    auto split_part_path = part.split();
+    auto part_path_iter = split_part_path.begin();
+
+    while (part_path_iter != split_part_path.end())
+    {
+        if (*part_path_iter == ".." && part_path_iter != split_part_path.begin())
+        {
+            part_path_iter = split_part_path.erase(part_path_iter - 1, part_path_iter + 1);
+            continue;
+        }
+
+        ++part_path_iter;
+    }
+
+    return std::accumulate(split_part_path.begin(), split_part_path.end(), xlnt::path(""),
+        [](const xlnt::path &a, const std::string &b) { return a.append(b); });
+}
+
+/// <summary>
+/// Returns the path of the part holding the relationships of the given part.
+/// </summary>
+xlnt::path relationships_part_path(const xlnt::path &part)
+{
+    auto parent = part.parent();
+
+    if (parent.is_absolute())
+    {
+        parent = xlnt::path(parent.string().substr(1));
+    }
+
+    return xlnt::path(parent.append("_rels").append(part.filename() + ".rels").string());
+}
+
+/// <summary>
+/// Returns the type cell is written with. A string is the cached result of the formula
+/// of its cell only as a "str" value, so the strings of formula cells are written as one.
+/// </summary>
+xlnt::cell_type written_type(const xlnt::cell &cell)
+{
+    const auto type = cell.data_type();
+
+    if ((type == xlnt::cell_type::inline_string || type == xlnt::cell_type::shared_string) && cell.has_formula())
+    {
+        return xlnt::cell_type::formula_string;
+    }
+
+    return type;
+}
+
+bool is_name_character(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' || c == '.' || c == '\\';
+}
+
+/// <summary>
+/// Parses a cell reference such as A1 or $B$2 starting at text[at] and, if there is one,
+/// appends it to key relative to the cell at column and row, except for its absolute parts,
+/// and returns the position after it. Returns at if no reference starts there.
+/// </summary>
+std::size_t append_relative_reference(const std::string &text, std::size_t at,
+    xlnt::column_t::index_t column, xlnt::row_t row, std::string &key)
+{
+    auto end = at;
+    const auto absolute_column = end < text.size() && text[end] == '$';
+    end += absolute_column ? 1 : 0;
+
+    xlnt::column_t::index_t reference_column = 0;
+    const auto column_start = end;
+
+    while (end < text.size() && end - column_start < 3 && std::isalpha(static_cast<unsigned char>(text[end])))
+    {
+        reference_column = reference_column * 26 + static_cast<xlnt::column_t::index_t>(std::toupper(static_cast<unsigned char>(text[end])) - 'A' + 1);
+        ++end;
+    }
+
+    if (end == column_start || reference_column > xlnt::constants::max_column().index) return at;
+
+    const auto absolute_row = end < text.size() && text[end] == '$';
+    end += absolute_row ? 1 : 0;
+
+    std::uint64_t reference_row = 0;
+    const auto row_start = end;
+
+    while (end < text.size() && end - row_start < 7 && std::isdigit(static_cast<unsigned char>(text[end])))
+    {
+        reference_row = reference_row * 10 + static_cast<std::uint64_t>(text[end] - '0');
+        ++end;
+    }
+
+    // names, function calls and structured references which merely start like a reference
+    if (end == row_start || reference_row == 0 || reference_row > xlnt::constants::max_row()
+        || (end < text.size() && (is_name_character(text[end]) || text[end] == '(' || text[end] == '[')))
+    {
+        return at;
+    }
+
+    key.push_back('\x01');
+    key.append(absolute_column ? "C" + std::to_string(reference_column)
+                               : "c" + std::to_string(static_cast<std::int64_t>(reference_column) - column));
+    key.append(absolute_row ? "R" + std::to_string(reference_row)
+                            : "r" + std::to_string(static_cast<std::int64_t>(reference_row) - row));
+    key.push_back('\x01');
+
+    return end;
+}
+
+/// <summary>
+/// Writes into key the text of formula with its relative references made relative to
+/// the cell at column and row, so that formulas which are copies of each other moved
+/// along with their cells have the same key. Returns false for formulas with row ranges
+/// such as 1:3, whose rows aren't told apart from numbers here.
+/// </summary>
+bool shared_formula_key(const std::string &formula, xlnt::column_t::index_t column, xlnt::row_t row, std::string &key)
+{
+    key.clear();
+    auto at = std::size_t(0);
+
+    while (at < formula.size())
+    {
+        const auto c = formula[at];
+
+        if (c == '"' || c == '\'')
+        {
+            // string literals and quoted sheet names, in which a doubled quote is a quote
+            auto end = at + 1;
+
+            while (end < formula.size() && (formula[end] != c || (end + 1 < formula.size() && formula[end + 1] == c)))
+            {
+                end += formula[end] == c ? 2 : 1;
+            }
+
+            end = std::min(end + 1, formula.size());
+            key.append(formula, at, end - at);
+            at = end;
+        }
+        else if (is_name_character(c) || c == '$')
+        {
+            if (at == 0 || !is_name_character(formula[at - 1]))
+            {
+                const auto end = append_relative_reference(formula, at, column, row, key);
+
+                if (end != at)
+                {
+                    at = end;
+                    continue;
+                }
+            }
+
+            auto end = at + 1;
+            while (end < formula.size() && (is_name_character(formula[end]) || formula[end] == '$'))
+            {
+                ++end;
+            }
+
+            const auto token = formula.substr(at, end - at);
+            const auto digits = token.find_first_not_of("$0123456789") == std::string::npos;
+
+            if (digits && ((end < formula.size() && formula[end] == ':') || (at > 0 && formula[at - 1] == ':')))
+            {
+                return false;
+            }
+
+            key.append(token);
+            at = end;
+        }
+        else
+        {
+            key.push_back(c);
+            ++at;
+        }
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Returns true if image is a PNG, JPEG or GIF file, whose contents are compressed
+/// already and hardly get smaller when they are deflated again.
+/// </summary>
+bool is_compressed_image(const std::vector<std::uint8_t> &image)
+{
+    static const std::uint8_t png[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static const std::uint8_t jpeg[] = {0xFF, 0xD8, 0xFF};
+    static const std::uint8_t gif[] = {'G', 'I', 'F', '8'};
+
+    auto starts_with = [&image](const std::uint8_t *signature, std::size_t size) {
+        return image.size() >= size && std::equal(signature, signature + size, image.begin());
+    };
+
+    return starts_with(png, sizeof(png)) || starts_with(jpeg, sizeof(jpeg)) || starts_with(gif, sizeof(gif));
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+xlsx_producer::xlsx_producer(const workbook &target)
+    : source_(target),
+      current_part_stream_(nullptr),
+      current_worksheet_(nullptr)
+{
+}
+
+xlsx_producer::xlsx_producer(const workbook &target, const save_options &options)
+    : source_(target),
+      options_(options),
+      current_part_stream_(nullptr),
+      current_worksheet_(nullptr)
+{
+    if (options_.progress)
+    {
+        progress_ = std::make_shared<progress_reporter>(options_.progress, options_.progress_interval);
+    }
+}
+
+xlsx_producer::~xlsx_producer()
+{
+    end_part();
+    archive_.reset();
+}
+
+void xlsx_producer::write(std::ostream &destination)
+{
+    phase_timer timer(options_.stats, &io_stats::total);
+
+    if (options_.preserve_unchanged_parts && !options_.xlsb)
+    {
+        select_copied_worksheets();
+    }
+
+    // copied worksheets keep the numbering of the strings they were loaded with
+    if (options_.compact_shared_strings && copied_worksheets_.empty())
+    {
+        workbook(source_.d_).compact_shared_strings(options_.order_shared_strings_by_frequency);
+    }
+
+    // reading a worksheet can change the manifest, so this can't wait until it's written
+    for (auto &ws : source_.d_->worksheets_)
+    {
+        if (copied_worksheets_.count(&ws) == 0)
+        {
+            worksheet_loader::load(ws);
+        }
+    }
+
+    // cells are written with the ids of their formats, which collecting garbage changes
+    if (source_.d_->stylesheet_.is_set())
+    {
+        source_.d_->stylesheet_.get().collect_pending_garbage();
+    }
+
+    archive_.reset(new ozstream(destination, options_.compression, options_.stats));
+    archive_->fixed_timestamps(options_.deterministic);
+
+    {
+        phase_timer serialization_timer(options_.stats, &io_stats::serialization);
+        if (options_.xlsb)
+        {
+            populate_binary_archive();
+        }
+        else
+        {
+            populate_archive(false);
+        }
+    }
+
+    // the central directory is written when the archive is destroyed
+    end_part();
+    archive_.reset();
+    record_saved_counts();
+}
+
+void xlsx_producer::open(std::ostream &destination)
+{
+    archive_.reset(new ozstream(destination, options_.compression, options_.stats));
+    archive_->fixed_timestamps(options_.deterministic);
+    streaming_ = true;
+    streaming_cell_.reset(new detail::cell_impl());
+
+    // cells write the id of their format as soon as they are streamed, so formats
+    // mustn't be renumbered by garbage collection afterwards
+    if (source_.d_->stylesheet_.is_set())
+    {
+        source_.d_->stylesheet_.get().collect_pending_garbage();
+        source_.d_->stylesheet_.get().garbage_collection_enabled = false;
+    }
+}
+
+void xlsx_producer::close()
+{
+    phase_timer timer(options_.stats, &io_stats::total);
+    end_streaming_worksheet();
+
+    for (auto &worker : concurrent_producers_)
+    {
+        worker->finish_concurrent_worksheet();
+        archive_->append(*worker->concurrent_members_);
+        streamed_worksheets_.insert(worker->streamed_worksheets_.begin(), worker->streamed_worksheets_.end());
+        streamed_formulas_.insert(streamed_formulas_.end(), worker->streamed_formulas_.begin(), worker->streamed_formulas_.end());
+        shared_string_cells_.insert(worker->shared_string_cells_.begin(), worker->shared_string_cells_.end());
+    }
+
+    concurrent_producers_.clear();
+
+    {
+        phase_timer serialization_timer(options_.stats, &io_stats::serialization);
+        populate_archive(true);
+    }
+
+    archive_.reset();
+    record_saved_counts();
+}
+
+void xlsx_producer::record_saved_counts()
+{
+    if (options_.stats == nullptr)
+    {
+        return;
+    }
+
+    auto cells = std::size_t(0);
+
+    for (const auto &ws : source_.d_->worksheets_)
+    {
+        cells += ws.cell_map_.size();
+    }
+
+    record_counts(options_.stats, cells, source_.d_->shared_strings_values_.size(),
+        source_.d_->stylesheet_.is_set() ? source_.d_->stylesheet_.get().format_impls.size() : 0);
+}
+
+cell xlsx_producer::add_cell(const cell_reference &ref)
+{
+    if (current_worksheet_ == nullptr)
+    {
+        add_worksheet(source_.sheet_by_index(0).title());
+    }
+
+    write_streaming_cell();
+
+    if (streaming_row_open_ && ref.row() == streaming_row_)
+    {
+        if (ref.column_index() <= streaming_column_)
+        {
+            throw invalid_parameter();
+        }
+    }
+    else if (ref.row() <= streaming_row_)
+    {
+        throw invalid_parameter();
+    }
+    else
+    {
+        end_row();
+
+        if (!streaming_sheet_data_)
+        {
+            begin_streaming_worksheet();
+        }
+
+        write_row_start(*streaming_sheet_data_, worksheet(current_worksheet_), ref.row(),
+            constants::max_column(), constants::min_column());
+        streaming_sheet_data_->end_start_tag();
+        streaming_row_ = ref.row();
+        streaming_row_open_ = true;
+    }
+
+    *streaming_cell_ = detail::cell_impl();
+    streaming_cell_->parent_ = current_worksheet_;
+    streaming_cell_->column_ = ref.column();
+    streaming_cell_->row_ = ref.row();
+    streaming_cell_pending_ = true;
+    streaming_column_ = ref.column_index();
+
+    return cell(streaming_cell_.get());
+}
+
+cell xlsx_producer::add_cell(const cell_reference &ref, const format &cell_format)
+{
+    auto added = add_cell(ref);
+    streaming_cell_->format_ = cell_format.d_;
+
+    return added;
+}
+
+cell xlsx_producer::add_cell(const cell_reference &ref, std::size_t format_id)
+{
+    if (!source_.d_->stylesheet_.is_set() || format_id >= source_.d_->stylesheet_.get().format_impls.size())
+    {
+        throw invalid_parameter();
+    }
+
+    auto added = add_cell(ref);
+    streaming_cell_->format_ = &source_.d_->stylesheet_.get().format_impls[format_id];
+
+    return added;
+}
+
+std::size_t xlsx_producer::format_id(const format &cell_format) const
+{
+    if (!source_.d_->stylesheet_.is_set() || cell_format.d_->parent != &source_.d_->stylesheet_.get())
+    {
+        throw invalid_parameter();
+    }
+
+    return cell_format.d_->id;
+}
+
+void xlsx_producer::end_row()
+{
+    write_streaming_cell();
+
+    if (streaming_row_open_)
+    {
+        streaming_sheet_data_->end_element("row");
+        streaming_row_open_ = false;
+    }
+}
+
+void xlsx_producer::begin_typed_row(std::size_t column_count)
+{
+    if (current_worksheet_ == nullptr)
+    {
+        add_worksheet(source_.sheet_by_index(0).title());
+    }
+
+    end_row();
+
+    if (streaming_row_ == constants::max_row() || column_count > constants::max_column().index)
+    {
+        throw invalid_parameter();
+    }
+
+    if (!streaming_sheet_data_)
+    {
+        begin_streaming_worksheet();
+    }
+
+    const auto row = streaming_row_ + 1;
+    const auto last_column = static_cast<column_t::index_t>(column_count);
+    write_row_start(*streaming_sheet_data_, worksheet(current_worksheet_), row,
+        last_column == 0 ? constants::max_column() : constants::min_column(),
+        last_column == 0 ? constants::min_column() : column_t(last_column));
+    streaming_sheet_data_->end_start_tag();
+
+    streaming_row_ = row;
+    streaming_row_open_ = true;
+    streaming_column_ = last_column;
+}
+
+void xlsx_producer::write_typed_cell(column_t::index_t column, std::int64_t value)
+{
+    auto &sheet_data = *streaming_sheet_data_;
+    sheet_data.start_element("c");
+    sheet_data.attribute("r", column_t(column), streaming_row_);
+    sheet_data.end_start_tag();
+    sheet_data.element("v", value);
+    sheet_data.end_element("c");
+}
+
+void xlsx_producer::write_typed_cell(column_t::index_t column, double value)
+{
+    if (!std::isfinite(value)) return;
+
+    auto &sheet_data = *streaming_sheet_data_;
+    sheet_data.start_element("c");
+    sheet_data.attribute("r", column_t(column), streaming_row_);
+    sheet_data.end_start_tag();
+    sheet_data.element("v", value);
+    sheet_data.end_element("c");
+}
+
+void xlsx_producer::write_typed_cell(column_t::index_t column, bool value)
+{
+    auto &sheet_data = *streaming_sheet_data_;
+    sheet_data.start_element("c");
+    sheet_data.attribute("r", column_t(column), streaming_row_);
+    sheet_data.attribute("t", "b");
+    sheet_data.end_start_tag();
+    sheet_data.element("v", std::uint64_t(value ? 1 : 0));
+    sheet_data.end_element("c");
+}
+
+void xlsx_producer::write_typed_cell(column_t::index_t column, const std::string &value)
+{
+    const auto index = workbook(source_.d_).add_shared_string(rich_text(value));
+    ++shared_string_cells_[current_worksheet_];
+
+    auto &sheet_data = *streaming_sheet_data_;
+    sheet_data.start_element("c");
+    sheet_data.attribute("r", column_t(column), streaming_row_);
+    sheet_data.attribute("t", "s");
+    sheet_data.end_start_tag();
+    sheet_data.element("v", static_cast<std::uint64_t>(index));
+    sheet_data.end_element("c");
+}
+
+void xlsx_producer::write_typed_cell(column_t::index_t column, const date &value)
+{
+    if (!typed_date_format_.is_set())
+    {
+        typed_date_format_ = workbook(source_.d_).create_format().number_format(number_format::date_yyyymmdd2(), true).d_->id;
+    }
+
+    auto &sheet_data = *streaming_sheet_data_;
+    sheet_data.start_element("c");
+    sheet_data.attribute("r", column_t(column), streaming_row_);
+    sheet_data.attribute("s", static_cast<std::uint64_t>(typed_date_format_.get()));
+    sheet_data.end_start_tag();
+    sheet_data.element("v", static_cast<std::int64_t>(value.to_number(source_.base_date())));
+    sheet_data.end_element("c");
+}
+
+void xlsx_producer::write_typed_cell(column_t::index_t column, const datetime &value)
+{
+    if (!typed_datetime_format_.is_set())
+    {
+        typed_datetime_format_ = workbook(source_.d_).create_format().number_format(number_format::date_datetime(), true).d_->id;
+    }
+
+    auto &sheet_data = *streaming_sheet_data_;
+    sheet_data.start_element("c");
+    sheet_data.attribute("r", column_t(column), streaming_row_);
+    sheet_data.attribute("s", static_cast<std::uint64_t>(typed_datetime_format_.get()));
+    sheet_data.end_start_tag();
+    sheet_data.element("v", value.to_number(source_.base_date()));
+    sheet_data.end_element("c");
+}
+
+namespace {
+
+bool bit_is_set(const std::uint8_t *bitmap, std::int64_t bit)
+{
+    return (bitmap[bit / 8] >> (bit % 8) & 1) != 0;
+}
+
+bool has_value(const column_view &column, std::int64_t position)
+{
+    return column.validity == nullptr || bit_is_set(column.validity, position);
+}
+
+// Throws invalid_parameter unless the buffers of column are all set for its kind
+// and its shared string indices and format id are in range for row_count rows.
+void validate_column(const column_view &column, std::size_t row_count, std::size_t shared_string_count,
+    std::size_t format_count)
+{
+    if (column.format_id != 0 && column.format_id >= format_count)
+    {
+        throw invalid_parameter();
+    }
+
+    switch (column.kind)
+    {
+    case column_view::value_kind::doubles:
+        if (column.doubles == nullptr) throw invalid_parameter();
+        break;
+    case column_view::value_kind::integers:
+        if (column.integers == nullptr) throw invalid_parameter();
+        break;
+    case column_view::value_kind::booleans:
+        if (column.booleans == nullptr) throw invalid_parameter();
+        break;
+    case column_view::value_kind::strings:
+        if (column.offsets == nullptr || column.characters == nullptr) throw invalid_parameter();
+        break;
+    case column_view::value_kind::shared_strings: {
+        if (column.indices == nullptr) throw invalid_parameter();
+
+        if (column.dictionary != nullptr
+            && std::any_of(column.dictionary, column.dictionary + column.dictionary_size,
+                [&](std::uint32_t id) { return id >= shared_string_count; }))
+        {
+            throw invalid_parameter();
+        }
+
+        const auto index_count = column.dictionary != nullptr ? column.dictionary_size : shared_string_count;
+
+        for (std::size_t i = 0; i < row_count; ++i)
+        {
+            const auto position = column.offset + static_cast<std::int64_t>(i);
+            const auto index = column.indices[position];
+
+            if (has_value(column, position) && (index < 0 || static_cast<std::size_t>(index) >= index_count))
+            {
+                throw invalid_parameter();
+            }
+        }
+
+        break;
+    }
+    }
+}
+
+bool needs_space_preserved(const char *text, std::size_t length)
+{
+    const auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+    return length > 0 && (is_space(text[0]) || is_space(text[length - 1]));
+}
+
 } // namespace
 
-namespace xlnt {
-namespace detail {
+void xlsx_producer::append_rows(std::size_t row_count, const std::vector<column_view> &columns)
+{
+    if (current_worksheet_ == nullptr)
+    {
+        add_worksheet(source_.sheet_by_index(0).title());
+    }
 
-xlsx_producer::xlsx_producer(const workbook &target)
-    : source_(target),
-      current_part_stream_(nullptr),
-      current_cell_(nullptr),
-      current_worksheet_(nullptr)
+    end_row();
+
+    if (row_count > static_cast<std::size_t>(constants::max_row() - streaming_row_))
+    {
+        throw invalid_parameter();
+    }
+
+    const auto shared_string_count = source_.d_->shared_strings_values_.size();
+    const auto format_count = source_.d_->stylesheet_.is_set() ? source_.d_->stylesheet_.get().format_impls.size() : 0;
+    auto previous_index = column_t::index_t(0);
+
+    for (const auto &column : columns)
+    {
+        if (column.index <= previous_index || column.index > constants::max_column().index)
+        {
+            throw invalid_parameter();
+        }
+
+        validate_column(column, row_count, shared_string_count, format_count);
+        previous_index = column.index;
+    }
+
+    if (row_count == 0) return;
+
+    if (!streaming_sheet_data_)
+    {
+        begin_streaming_worksheet();
+    }
+
+    auto &sheet_data = *streaming_sheet_data_;
+    auto &shared_string_cells = shared_string_cells_[current_worksheet_];
+    const auto ws = worksheet(current_worksheet_);
+    const auto first_span_column = columns.empty() ? constants::max_column() : column_t(columns.front().index);
+    const auto last_span_column = columns.empty() ? constants::min_column() : column_t(columns.back().index);
+
+    for (std::size_t i = 0; i < row_count; ++i)
+    {
+        const auto row = streaming_row_ + 1;
+        write_row_start(sheet_data, ws, row, first_span_column, last_span_column);
+        sheet_data.end_start_tag();
+
+        for (const auto &column : columns)
+        {
+            const auto position = column.offset + static_cast<std::int64_t>(i);
+
+            if (!has_value(column, position)) continue;
+
+            if (column.kind == column_view::value_kind::doubles && !std::isfinite(column.doubles[position]))
+            {
+                continue;
+            }
+
+            sheet_data.start_element("c");
+            sheet_data.attribute("r", column_t(column.index), row);
+
+            if (column.format_id != 0)
+            {
+                sheet_data.attribute("s", static_cast<std::uint64_t>(column.format_id));
+            }
+
+            switch (column.kind)
+            {
+            case column_view::value_kind::doubles:
+                sheet_data.end_start_tag();
+                sheet_data.element("v", column.doubles[position]);
+                break;
+
+            case column_view::value_kind::integers:
+                sheet_data.end_start_tag();
+                sheet_data.element("v", static_cast<double>(column.integers[position]));
+                break;
+
+            case column_view::value_kind::booleans:
+                sheet_data.attribute("t", "b");
+                sheet_data.end_start_tag();
+                sheet_data.element("v", std::uint64_t(bit_is_set(column.booleans, position) ? 1 : 0));
+                break;
+
+            case column_view::value_kind::strings: {
+                const auto text = column.characters + column.offsets[position];
+                const auto length = static_cast<std::size_t>(column.offsets[position + 1] - column.offsets[position]);
+
+                sheet_data.attribute("t", "inlineStr");
+                sheet_data.end_start_tag();
+                sheet_data.start_element("is");
+                sheet_data.end_start_tag();
+                sheet_data.start_element("t");
+
+                if (needs_space_preserved(text, length))
+                {
+                    sheet_data.attribute("xml:space", "preserve");
+                }
+
+                sheet_data.end_start_tag();
+                sheet_data.characters(text, length);
+                sheet_data.end_element("t");
+                sheet_data.end_element("is");
+                break;
+            }
+
+            case column_view::value_kind::shared_strings: {
+                const auto index = static_cast<std::size_t>(column.indices[position]);
+
+                sheet_data.attribute("t", "s");
+                sheet_data.end_start_tag();
+                sheet_data.element("v", static_cast<std::uint64_t>(column.dictionary != nullptr ? column.dictionary[index] : index));
+                ++shared_string_cells;
+                break;
+            }
+            }
+
+            sheet_data.end_element("c");
+        }
+
+        sheet_data.end_element("row");
+        streaming_row_ = row;
+    }
+}
+
+row_t xlsx_producer::next_row() const
 {
+    return streaming_row_ + 1;
 }
 
-xlsx_producer::~xlsx_producer()
+worksheet xlsx_producer::add_worksheet(const std::string &title)
 {
-    end_part();
+    end_streaming_worksheet();
+
+    auto ws = next_streamed_worksheet(title);
+    current_worksheet_ = ws.d_;
+
+    return ws;
+}
+
+xlsx_producer &xlsx_producer::open_concurrent_worksheet(const std::string &title)
+{
+    const auto ws = next_streamed_worksheet(title);
+
+    // formulas register the calculation chain when they are set, which mustn't happen on
+    // several threads at once; an empty chain isn't written
+    workbook(source_.d_).register_workbook_part_later(relationship_type::calculation_chain);
+
+    // the worker only reads the workbook, apart from the cell it reuses
+    std::unique_ptr<xlsx_producer> worker(new xlsx_producer(source_, options_));
+    worker->progress_ = progress_;
+    worker->written_images_ = written_images_;
+    worker->streaming_ = true;
+    worker->streaming_cell_.reset(new detail::cell_impl());
+    worker->current_worksheet_ = ws.d_;
+    worker->concurrent_worksheet_ = ws.d_;
+    worker->concurrent_members_.reset(new zmembers());
+    worker->concurrent_streambuf_.reset(new vector_ostreambuf(worker->concurrent_members_->bytes));
+    worker->concurrent_stream_.reset(new std::ostream(worker->concurrent_streambuf_.get()));
+    worker->archive_.reset(new ozstream(*worker->concurrent_stream_, options_.compression, options_.stats));
+    worker->archive_->fixed_timestamps(options_.deterministic);
+
+    concurrent_producers_.push_back(std::move(worker));
+
+    return *concurrent_producers_.back();
+}
+
+void xlsx_producer::finish_concurrent_worksheet()
+{
+    if (!archive_) return;
+
+    end_streaming_worksheet();
+    concurrent_members_->headers = archive_->release();
     archive_.reset();
 }
 
-void xlsx_producer::write(std::ostream &destination)
+worksheet xlsx_producer::concurrent_worksheet() const
 {
-    archive_.reset(new ozstream(destination));
-    populate_archive(false);
+    return worksheet(concurrent_worksheet_);
 }
 
-void xlsx_producer::open(std::ostream &destination)
+worksheet xlsx_producer::next_streamed_worksheet(const std::string &title)
 {
-    archive_.reset(new ozstream(destination));
-    populate_archive(true);
+    // the first worksheet streamed is the one every workbook starts with
+    const auto first = streamed_worksheets_.empty() && concurrent_producers_.empty()
+        && current_worksheet_ == nullptr;
+    auto target = source_;
+    auto ws = first ? target.sheet_by_index(0) : target.create_sheet();
+    ws.title(title);
+
+    return ws;
 }
 
-cell xlsx_producer::add_cell(const cell_reference &ref)
+void xlsx_producer::write_streaming_cell()
 {
-    current_cell_->column_ = ref.column();
-    current_cell_->row_ = ref.row();
+    if (!streaming_cell_pending_) return;
+    streaming_cell_pending_ = false;
+
+    if (streaming_cell_->is_garbage_collectible()) return;
 
-    return cell(current_cell_);
+    auto &sheet_data = *streaming_sheet_data_;
+    const auto streamed = cell(streaming_cell_.get());
+
+    write_cell_start(sheet_data, streamed);
+
+    if (streamed.has_formula())
+    {
+        sheet_data.element("f", streamed.formula());
+
+        calculation_chain_entry entry;
+        entry.sheet_id = current_worksheet_->id_;
+        entry.reference = streamed.reference();
+        streamed_formulas_.push_back(entry);
+    }
+
+    write_cell_value(sheet_data, streamed, shared_string_cells_[current_worksheet_]);
+    sheet_data.end_element("c");
 }
 
-worksheet xlsx_producer::add_worksheet(const std::string &title)
+void xlsx_producer::begin_streaming_worksheet()
+{
+    const auto ws = worksheet(current_worksheet_);
+    const auto rel = ws.referring_relationship();
+
+    begin_part(rel.source().path().parent().append(rel.target().path()));
+    begin_worksheet(ws);
+    streaming_sheet_data_.reset(new detail::sheet_data_writer(current_part_stream_));
+}
+
+void xlsx_producer::end_streaming_worksheet()
 {
-    current_worksheet_->title_ = title;
-    return worksheet(current_worksheet_);
+    if (current_worksheet_ == nullptr) return;
+
+    if (!streaming_sheet_data_)
+    {
+        // a worksheet without cells still needs its part
+        begin_streaming_worksheet();
+    }
+
+    end_row();
+    streaming_sheet_data_->flush();
+    streaming_sheet_data_.reset();
+
+    const auto ws = worksheet(current_worksheet_);
+    const auto rel = ws.referring_relationship();
+    end_worksheet(rel, ws, {});
+    end_part();
+
+    streamed_worksheets_.insert(rel.id());
+    current_worksheet_ = nullptr;
+    streaming_row_ = 0;
+    streaming_column_ = 0;
 }
 
 // Part Writing Methods
@@ -127,12 +963,22 @@ worksheet xlsx_producer::add_worksheet(const std::string &title)
 void xlsx_producer::populate_archive(bool streaming)
 {
     streaming_ = streaming;
+    // cell setters only mark the shared strings and calculation chain for registration
+    source_.register_pending_parts();
 
-    write_content_types();
+    write_content_types(source_.manifest());
 
-    const auto root_rels = source_.manifest().relationships(path("/"));
+    auto root_rels = source_.manifest().relationships(path("/"));
     write_relationships(root_rels, path("/"));
 
+    if (options_.streaming_part_order)
+    {
+        // the document properties are read before the workbook
+        std::stable_partition(root_rels.begin(), root_rels.end(), [](const relationship &rel) {
+            return rel.type() != relationship_type::office_document;
+        });
+    }
+
     for (auto &rel : root_rels)
     {
         // thumbnail is binary content so we don't want to open an xml serializer stream
@@ -142,6 +988,12 @@ void xlsx_producer::populate_archive(bool streaming)
             continue;
         }
 
+        if (rel.type() == relationship_type::office_document && options_.streaming_part_order)
+        {
+            // the relationships of the workbook are read before it
+            write_relationships(source_.manifest().relationships(rel.target().path()), rel.target().path());
+        }
+
         begin_part(rel.target().path());
 
         if (rel.type() == relationship_type::core_properties)
@@ -170,6 +1022,73 @@ void xlsx_producer::populate_archive(bool streaming)
     end_part();
 }
 
+void xlsx_producer::populate_binary_archive()
+{
+    source_.register_pending_parts();
+
+    // the document properties and the thumbnail are kept, the office document is replaced
+    // by the binary parts
+    const auto &source_package = source_.manifest();
+    manifest package;
+
+    for (const auto &extension : source_package.extensions_with_default_types())
+    {
+        package.register_default_type(extension, source_package.default_type(extension));
+    }
+
+    std::vector<relationship> kept_rels;
+
+    for (const auto &rel : source_package.relationships(path("/")))
+    {
+        if (rel.type() == relationship_type::office_document) continue;
+
+        const auto part = rel.target().path().resolve(path("/"));
+
+        if (source_package.has_override_type(part))
+        {
+            package.register_override_type(part, source_package.override_type(part));
+        }
+
+        package.register_relationship(uri("/"), rel.type(), rel.target(), rel.target_mode());
+        kept_rels.push_back(rel);
+    }
+
+    xlsb_producer(source_, *archive_, progress_.get()).write(package);
+
+    write_content_types(package);
+    write_relationships(package.relationships(path("/")), path("/"));
+
+    const auto workbook_rel = package.relationship(path("/"), relationship_type::office_document);
+    const auto workbook_part = package.canonicalize({workbook_rel});
+    write_relationships(package.relationships(workbook_part), workbook_part);
+
+    for (const auto &rel : kept_rels)
+    {
+        if (rel.type() == relationship_type::thumbnail)
+        {
+            write_image(rel.target().path());
+            continue;
+        }
+
+        begin_part(rel.target().path());
+
+        if (rel.type() == relationship_type::core_properties)
+        {
+            write_core_properties(rel);
+        }
+        else if (rel.type() == relationship_type::extended_properties)
+        {
+            write_extended_properties(rel);
+        }
+        else if (rel.type() == relationship_type::custom_properties)
+        {
+            write_custom_properties(rel);
+        }
+    }
+
+    end_part();
+}
+
 void xlsx_producer::end_part()
 {
     if (current_part_serializer_)
@@ -178,6 +1097,47 @@ void xlsx_producer::end_part()
     }
 
     current_part_streambuf_.reset();
+
+    if (spliced_fragments_ == nullptr)
+    {
+        return;
+    }
+
+    const auto &fragments = *spliced_fragments_;
+    spliced_fragments_ = nullptr;
+
+    // the rows of the fragments follow those this producer wrote
+    static const std::string sheet_data_end = "</sheetData>";
+    const auto &xml = spliced_part_xml_;
+    const auto head_size = static_cast<std::size_t>(
+        std::search(xml.begin(), xml.end(), sheet_data_end.begin(), sheet_data_end.end()) - xml.begin());
+
+    if (head_size == xml.size())
+    {
+        throw xlnt::exception("no sheetData to splice fragments into");
+    }
+
+    auto spliced = deflated_fragment::compress(xml.data(), head_size, options_.compression);
+
+    for (const auto &fragment : fragments)
+    {
+        spliced.append(fragment);
+    }
+
+    spliced.append(deflated_fragment::compress(xml.data() + head_size, xml.size() - head_size, options_.compression));
+    spliced_part_xml_.clear();
+
+    zcompressed member;
+    member.header.compression_type = 8;
+    member.header.crc = spliced.crc32;
+    member.header.uncompressed_size = spliced.uncompressed_size;
+    member.data = std::move(spliced.data);
+    // an empty final block with fixed codes ends the stream
+    member.data.push_back(0x03);
+    member.data.push_back(0x00);
+    member.header.compressed_size = member.data.size();
+
+    archive_->append(spliced_part_, member);
 }
 
 void xlsx_producer::begin_part(const path &part)
@@ -191,9 +1151,42 @@ void xlsx_producer::begin_part(const path &part)
     current_part_serializer_.reset(xml_serializer);
 }
 
+void xlsx_producer::begin_part(const path &part, const std::vector<deflated_fragment> &fragments)
+{
+    end_part();
+    spliced_part_ = part;
+    spliced_part_xml_.clear();
+    spliced_fragments_ = &fragments;
+    current_part_streambuf_.reset(new vector_ostreambuf(spliced_part_xml_));
+    current_part_stream_.rdbuf(current_part_streambuf_.get());
+
+    auto xml_serializer = new xml::serializer(current_part_stream_, part.string(), 0);
+    xml_serializer->xml_decl("1.0", "UTF-8", "yes");
+    current_part_serializer_.reset(xml_serializer);
+}
+
+const std::vector<deflated_fragment> *xlsx_producer::worksheet_fragments(const relationship &rel) const
+{
+    if (options_.sheet_data_fragments == nullptr || streaming_ || rel.type() != relationship_type::worksheet)
+    {
+        return nullptr;
+    }
+
+    for (const auto &title_rel_id : source_.d_->sheet_title_rel_id_map_)
+    {
+        if (title_rel_id.second == rel.id())
+        {
+            const auto fragments = options_.sheet_data_fragments->find(title_rel_id.first);
+            return fragments == options_.sheet_data_fragments->end() ? nullptr : &fragments->second;
+        }
+    }
+
+    return nullptr;
+}
+
 // Package Parts
 
-void xlsx_producer::write_content_types()
+void xlsx_producer::write_content_types(const manifest &package)
 {
     const auto content_types_path = path("[Content_Types].xml");
     begin_part(content_types_path);
@@ -203,19 +1196,29 @@ void xlsx_producer::write_content_types()
     write_start_element(xmlns, "Types");
     write_namespace(xmlns, "");
 
-    for (const auto &extension : source_.manifest().extensions_with_default_types())
+    auto extensions = package.extensions_with_default_types();
+    auto parts = package.parts_with_overriden_types();
+
+    // the manifest keeps the types in hash tables, whose order isn't fixed
+    if (options_.deterministic)
+    {
+        std::sort(extensions.begin(), extensions.end());
+        std::sort(parts.begin(), parts.end(), [](const path &a, const path &b) { return a.string() < b.string(); });
+    }
+
+    for (const auto &extension : extensions)
     {
         write_start_element(xmlns, "Default");
         write_attribute("Extension", extension);
-        write_attribute("ContentType", source_.manifest().default_type(extension));
+        write_attribute("ContentType", package.default_type(extension));
         write_end_element(xmlns, "Default");
     }
 
-    for (const auto &part : source_.manifest().parts_with_overriden_types())
+    for (const auto &part : parts)
     {
         write_start_element(xmlns, "Override");
         write_attribute("PartName", part.resolve(path("/")).string());
-        write_attribute("ContentType", source_.manifest().override_type(part));
+        write_attribute("ContentType", package.override_type(part));
         write_end_element(xmlns, "Override");
     }
 
@@ -437,8 +1440,30 @@ void xlsx_producer::write_workbook(const relationship &rel)
     std::size_t num_visible = 0;
     std::vector<defined_name> defined_names;
 
-    for (auto ws : source_)
+    for (auto &impl : source_.d_->worksheets_)
     {
+        auto ws = worksheet(&impl);
+
+        if (copied_worksheets_.count(&impl) != 0)
+        {
+            // the sheet state isn't read from the worksheet, so a copied worksheet is
+            // visible as it would be once read, and its defined names are copied as read
+            num_visible++;
+
+            for (auto name : impl.loader_->defined_names)
+            {
+                if (name.sheet_id == ws.id() - 1
+                    && (name.name == "_xlnm._FilterDatabase" || name.name == "_xlnm.Print_Area"
+                        || name.name == "_xlnm.Print_Titles"))
+                {
+                    name.sheet_id = ws.id();
+                    defined_names.push_back(name);
+                }
+            }
+
+            continue;
+        }
+
         if (!ws.has_page_setup() || ws.page_setup().sheet_state() == sheet_state::visible)
         {
             num_visible++;
@@ -638,8 +1663,9 @@ void xlsx_producer::write_workbook(const relationship &rel)
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wrange-loop-analysis"
-    for (const auto ws : source_)
+    for (auto &impl : source_.d_->worksheets_)
     {
+        const auto ws = worksheet(&impl);
         auto sheet_rel_id = source_.d_->sheet_title_rel_id_map_[ws.title()];
         auto sheet_rel = source_.d_->manifest_.relationship(rel.target().path(), sheet_rel_id);
 
@@ -691,11 +1717,30 @@ void xlsx_producer::write_workbook(const relationship &rel)
         write_end_element(xmlns, "calcPr");
     }
 
-    if (!source_.named_ranges().empty())
+    // workbook::named_ranges would read the copied worksheets
+    std::vector<named_range> named_ranges;
+
+    for (const auto &impl : source_.d_->worksheets_)
+    {
+        const auto first = named_ranges.size();
+
+        for (const auto &ws_named_range : impl.named_ranges_)
+        {
+            named_ranges.push_back(ws_named_range.second);
+        }
+
+        if (options_.deterministic)
+        {
+            std::sort(named_ranges.begin() + static_cast<std::ptrdiff_t>(first), named_ranges.end(),
+                [](const named_range &a, const named_range &b) { return a.name() < b.name(); });
+        }
+    }
+
+    if (!named_ranges.empty())
     {
         write_start_element(xmlns, "definedNames");
 
-        for (auto &named_range : source_.named_ranges())
+        for (auto &named_range : named_ranges)
         {
             write_start_element(xmlns_s, "definedName");
             write_namespace(xmlns_s, "s");
@@ -724,17 +1769,58 @@ void xlsx_producer::write_workbook(const relationship &rel)
     write_end_element(xmlns, "workbook");
 
     auto workbook_rels = source_.manifest().relationships(rel.target().path());
-    write_relationships(workbook_rels, rel.target().path());
+
+    if (!options_.streaming_part_order)
+    {
+        write_relationships(workbook_rels, rel.target().path());
+    }
+
+    // worksheets serialized and compressed ahead of time, by relationship id
+    std::vector<zmembers> rendered_worksheets;
+    std::unordered_map<std::string, std::size_t> rendered_worksheet_index;
+
+    if (options_.worksheet_threads > 1 && !streaming_)
+    {
+        std::vector<relationship> worksheet_rels;
+
+        for (const auto &child_rel : workbook_rels)
+        {
+            if (child_rel.type() == relationship_type::worksheet
+                && copied_worksheet_parts_.count(child_rel.id()) == 0
+                && worksheet_fragments(child_rel) == nullptr)
+            {
+                rendered_worksheet_index[child_rel.id()] = worksheet_rels.size();
+                worksheet_rels.push_back(child_rel);
+            }
+        }
+
+        rendered_worksheets = write_worksheets_concurrently(worksheet_rels);
+    }
+
+    if (options_.streaming_part_order)
+    {
+        // every part a reader needs before the sheets comes first
+        std::stable_partition(workbook_rels.begin(), workbook_rels.end(), [](const relationship &child_rel) {
+            return child_rel.type() != relationship_type::worksheet
+                && child_rel.type() != relationship_type::chartsheet
+                && child_rel.type() != relationship_type::dialogsheet
+                && child_rel.type() != relationship_type::calculation_chain;
+        });
+    }
+    else
+    {
+        // the shared string table is written last so that its count attribute can be
+        // taken from the worksheets instead of scanning every cell again
+        std::stable_partition(workbook_rels.begin(), workbook_rels.end(), [](const relationship &child_rel) {
+            return child_rel.type() != relationship_type::shared_string_table;
+        });
+    }
 
     for (const auto &child_rel : workbook_rels)
     {
-        if (child_rel.type() == relationship_type::calculation_chain)
+        // a chain needs at least one cell, so none is written once no formulas are left
+        if (child_rel.type() == relationship_type::calculation_chain && calculation_chain().empty())
         {
-            // We don't yet have a VBA interpreter which can evaluate formulas.
-            // If we write an outdated calculate chain, Excel will treat the XLSX
-            // as corrupt. As a workaround, we keep the relationship but don't
-            // write the calculation chain file so Excel will recalculate all formulae
-            // on load.
             continue;
         }
 
@@ -748,8 +1834,50 @@ void xlsx_producer::write_workbook(const relationship &rel)
             continue;
         }
 
+        if (streamed_worksheets_.count(child_rel.id()) != 0)
+        {
+            continue;
+        }
+
+        if (child_rel.type() == relationship_type::worksheet
+            && copied_worksheet_parts_.count(child_rel.id()) != 0)
+        {
+            copy_worksheet(child_rel.id());
+            continue;
+        }
+
+        // a table still held by its loader hasn't changed since it was loaded, as
+        // adding a string decodes it first
+        if (child_rel.type() == relationship_type::shared_string_table && options_.preserve_unchanged_parts
+            && source_.d_->shared_strings_pending_.load(std::memory_order_acquire))
+        {
+            end_part();
+            const auto &part = source_.d_->shared_strings_loader_->part();
+            auto part_streambuf = archive_->open(archive_path);
+            std::ostream(part_streambuf.get()).write(part.data(), static_cast<std::streamsize>(part.size()));
+            continue;
+        }
+
+        auto rendered = rendered_worksheet_index.find(child_rel.id());
+
+        if (rendered != rendered_worksheet_index.end())
+        {
+            end_part();
+            archive_->append(rendered_worksheets[rendered->second]);
+            continue;
+        }
+
         // write xml
-        begin_part(archive_path);
+        const auto fragments = worksheet_fragments(child_rel);
+
+        if (fragments != nullptr)
+        {
+            begin_part(archive_path, *fragments);
+        }
+        else
+        {
+            begin_part(archive_path);
+        }
 
         switch (child_rel.type())
         {
@@ -802,7 +1930,9 @@ void xlsx_producer::write_workbook(const relationship &rel)
             break;
 
         case relationship_type::calculation_chain:
+            write_calculation_chain(child_rel);
             break;
+
         case relationship_type::office_document:
             break;
         case relationship_type::thumbnail:
@@ -849,14 +1979,139 @@ void xlsx_producer::write_workbook(const relationship &rel)
             break;
         }
     }
-}
+}
+
+// Write Workbook Relationship Target Parts
+
+void xlsx_producer::write_chartsheet(const relationship & /*rel*/)
+{
+    write_start_element(constants::ns("spreadsheetml"), "chartsheet");
+    write_start_element(constants::ns("spreadsheetml"), "chartsheet");
+}
+
+std::vector<calculation_chain_entry> xlsx_producer::calculation_chain() const
+{
+    const auto &wb = *source_.d_;
+
+    // Excel repairs a file whose chain lists a cell without a formula element, so only
+    // the formulas the rewritten worksheets will have are listed. The chain of a copied
+    // worksheet is still the one read with it.
+    std::unordered_map<std::size_t, std::unordered_map<cell_reference, bool>> formulas;
+    std::unordered_set<std::size_t> copied;
+    std::vector<calculation_chain_entry> missing;
+
+    for (const auto &ws : wb.worksheets_)
+    {
+        if (copied_worksheets_.count(&ws) != 0)
+        {
+            copied.insert(ws.id_);
+            continue;
+        }
+
+        auto &cells = formulas[ws.id_];
+        const auto first_missing = missing.size();
+
+        ws.cell_map_.for_each([&](const cell_impl &cell) {
+            if (!cell.formula().is_set()) return;
+
+            const auto reference = cell_reference(cell.column_, cell.row_);
+            const auto array = cell.formula_group_ != 0 && ws.formula_groups_[cell.formula_group_ - 1].array;
+
+            // only the master cell of an array formula has the formula element
+            if (array && reference != ws.formula_groups_[cell.formula_group_ - 1].master) return;
+
+            cells.emplace(reference, array);
+
+            calculation_chain_entry entry;
+            entry.sheet_id = ws.id_;
+            entry.reference = reference;
+            entry.array = array;
+            missing.push_back(entry);
+        });
+
+        std::sort(missing.begin() + static_cast<std::ptrdiff_t>(first_missing), missing.end(),
+            [](const calculation_chain_entry &lhs, const calculation_chain_entry &rhs) {
+                return row_major_order()(lhs.reference, rhs.reference);
+            });
+    }
 
-// Write Workbook Relationship Target Parts
+    auto order = wb.formula_engine_ ? wb.formula_engine_->evaluation_order(wb) : std::vector<calculation_chain_entry>();
+    const auto calculated = !order.empty();
 
-void xlsx_producer::write_chartsheet(const relationship & /*rel*/)
+    if (!calculated)
+    {
+        order = wb.calculation_chain_;
+    }
+
+    std::vector<calculation_chain_entry> chain;
+    chain.reserve(missing.size());
+
+    for (const auto &entry : order)
+    {
+        if (copied.count(entry.sheet_id) != 0)
+        {
+            if (!calculated) chain.push_back(entry);
+            continue;
+        }
+
+        auto sheet = formulas.find(entry.sheet_id);
+        if (sheet == formulas.end()) continue;
+        auto cell = sheet->second.find(entry.reference);
+        if (cell == sheet->second.end()) continue;
+
+        chain.push_back(entry);
+        chain.back().array = cell->second;
+
+        // erasing the cell keeps cells listed twice from being written twice
+        sheet->second.erase(cell);
+    }
+
+    for (const auto &entry : missing)
+    {
+        if (formulas[entry.sheet_id].count(entry.reference) != 0)
+        {
+            chain.push_back(entry);
+        }
+    }
+
+    chain.insert(chain.end(), streamed_formulas_.begin(), streamed_formulas_.end());
+
+    return chain;
+}
+
+void xlsx_producer::write_calculation_chain(const relationship & /*rel*/)
 {
-    write_start_element(constants::ns("spreadsheetml"), "chartsheet");
-    write_start_element(constants::ns("spreadsheetml"), "chartsheet");
+    write_start_element(constants::ns("spreadsheetml"), "calcChain");
+    write_namespace(constants::ns("spreadsheetml"), "");
+
+    std::size_t sheet_id = 0;
+
+    for (const auto &entry : calculation_chain())
+    {
+        write_start_element(constants::ns("spreadsheetml"), "c");
+        write_attribute("r", entry.reference.to_string());
+
+        // a cell without a sheet id is on the sheet of the cell before it
+        if (entry.sheet_id != sheet_id)
+        {
+            write_attribute("i", entry.sheet_id);
+            sheet_id = entry.sheet_id;
+        }
+
+        if (entry.new_level)
+        {
+            write_attribute("l", write_bool(true));
+        }
+
+        if (entry.array)
+        {
+            write_attribute("a", write_bool(true));
+        }
+
+        write_end_element(constants::ns("spreadsheetml"), "c");
+    }
+
+    write_end_element(constants::ns("spreadsheetml"), "calcChain");
 }
 
 void xlsx_producer::write_connections(const relationship & /*rel*/)
@@ -889,17 +2144,43 @@ void xlsx_producer::write_pivot_table(const relationship & /*rel*/)
     write_end_element(constants::ns("spreadsheetml"), "pivotTableDefinition");
 }
 
+bool xlsx_producer::write_plain_text(detail::sheet_data_writer &writer, const rich_text &text, const char *element)
+{
+    if (!text.compact_ || !text.phonetic_runs_.empty() || text.phonetic_properties_.is_set())
+    {
+        return false;
+    }
+
+    writer.start_element(element);
+    writer.end_start_tag();
+    writer.start_element("t");
+
+    if (text.plain_preserve_space_)
+    {
+        writer.attribute("xml:space", "preserve");
+    }
+
+    writer.end_start_tag();
+    writer.characters(text.plain_);
+    writer.end_element("t");
+    writer.end_element(element);
+
+    return true;
+}
+
 void xlsx_producer::write_rich_text(const std::string &ns, const xlnt::rich_text &text)
 {
-    if (text.runs().size() == 1 && !text.runs().at(0).second.is_set())
+    const auto runs = text.runs();
+
+    if (runs.size() == 1 && !runs.front().second.is_set())
     {
         write_start_element(ns, "t");
-        write_characters(text.plain_text(), text.runs().front().preserve_space);
+        write_characters(runs.front().first, runs.front().preserve_space);
         write_end_element(ns, "t");
     }
     else
     {
-        for (const auto &run : text.runs())
+        for (const auto &run : runs)
         {
             write_start_element(ns, "r");
 
@@ -993,46 +2274,66 @@ void xlsx_producer::write_rich_text(const std::string &ns, const xlnt::rich_text
 void xlsx_producer::write_shared_string_table(const relationship & /*rel*/)
 {
     static const auto &xmlns = constants::ns("spreadsheetml");
+    XLNT_TRACE_SCOPE("write_shared_string_table");
+    phase_timer timer(options_.stats, &io_stats::shared_strings);
 
     write_start_element(xmlns, "sst");
     write_namespace(xmlns, "");
 
-    // todo: is there a more elegant way to get this number?
+    // worksheets count their shared string cells as they are written, so only
+    // sheets which weren't written as worksheets need to be scanned here
     std::size_t string_count = 0;
 
-    for (const auto ws : source_)
+    for (const auto &ws : source_.d_->worksheets_)
     {
-        auto dimension = ws.calculate_dimension();
-        auto current_cell = dimension.top_left();
+        auto counted = shared_string_cells_.find(&ws);
 
-        while (current_cell.row() <= dimension.bottom_right().row())
+        if (counted != shared_string_cells_.end())
         {
-            while (current_cell.column() <= dimension.bottom_right().column())
-            {
-                auto c_iter = ws.d_->cell_map_.find(current_cell);
-                if (c_iter != ws.d_->cell_map_.end() && c_iter->second.type_ == cell_type::shared_string)
-                {
-                    ++string_count;
-                }
+            string_count += counted->second;
+            continue;
+        }
 
-                current_cell.column_index(current_cell.column_index() + 1);
+        ws.cell_map_.for_each([&string_count](const detail::cell_impl &cell) {
+            if (cell.type_ == cell_type::shared_string)
+            {
+                ++string_count;
             }
-
-            current_cell.row(current_cell.row() + 1);
-            current_cell.column_index(dimension.top_left().column_index());
-        }
+        });
     }
 
-    write_attribute("count", string_count);
+    // the cells of copied worksheets aren't known, and the count is optional
+    if (copied_worksheets_.empty())
+    {
+        write_attribute("count", string_count);
+    }
     write_attribute("uniqueCount", source_.shared_strings().size());
 
+    if (source_.shared_strings().empty())
+    {
+        write_end_element(xmlns, "sst");
+        return;
+    }
+
+    // plain strings are escaped straight into the part stream, like the cells of sheetData,
+    // and only rich text is left to the serializer
+    detail::sheet_data_writer strings(current_part_stream_);
+    write_characters("");
+
     for (const auto &text : source_.shared_strings())
     {
+        if (write_plain_text(strings, text))
+        {
+            continue;
+        }
+
+        strings.flush();
         write_start_element(xmlns, "si");
         write_rich_text(xmlns, text);
         write_end_element(xmlns, "si");
     }
 
+    strings.flush();
     write_end_element(xmlns, "sst");
 }
 
@@ -1268,6 +2569,7 @@ void xlsx_producer::write_styles(const relationship & /*rel*/)
     static const auto &xmlns_mc = constants::ns("mc");
     static const auto &xmlns_x14 = constants::ns("x14");
     static const auto &xmlns_x14ac = constants::ns("x14ac");
+    phase_timer timer(options_.stats, &io_stats::stylesheet);
 
     write_start_element(xmlns, "styleSheet");
     write_namespace(xmlns, "");
@@ -2259,20 +3561,32 @@ void xlsx_producer::write_volatile_dependencies(const relationship & /*rel*/)
 
 void xlsx_producer::write_worksheet(const relationship &rel)
 {
-    static const auto &xmlns = constants::ns("spreadsheetml");
-    static const auto &xmlns_r = constants::ns("r");
-    static const auto &xmlns_mc = constants::ns("mc");
-    static const auto &xmlns_x14ac = constants::ns("x14ac");
-
-    auto worksheet_part = rel.source().path().parent().append(rel.target().path());
-    auto worksheet_rels = source_.manifest().relationships(worksheet_part);
-
     auto title = std::find_if(source_.d_->sheet_title_rel_id_map_.begin(), source_.d_->sheet_title_rel_id_map_.end(),
         [&](const std::pair<std::string, std::string> &p) {
             return p.second == rel.id();
         })->first;
 
     auto ws = source_.sheet_by_title(title);
+    XLNT_TRACE_SCOPE_ARG("write_worksheet", title);
+
+    std::vector<std::pair<std::string, hyperlink>> hyperlinks;
+
+    begin_worksheet(ws);
+
+    {
+        phase_timer timer(options_.stats, &io_stats::sheet_data);
+        write_sheet_data(ws, hyperlinks);
+    }
+
+    end_worksheet(rel, ws, hyperlinks);
+}
+
+void xlsx_producer::begin_worksheet(worksheet ws)
+{
+    static const auto &xmlns = constants::ns("spreadsheetml");
+    static const auto &xmlns_r = constants::ns("r");
+    static const auto &xmlns_mc = constants::ns("mc");
+    static const auto &xmlns_x14ac = constants::ns("x14ac");
 
     write_start_element(xmlns, "worksheet");
     write_namespace(xmlns, "");
@@ -2286,10 +3600,11 @@ void xlsx_producer::write_worksheet(const relationship &rel)
                 return true;
             }
 
-            auto highest = ws.highest_row();
-            for (auto row = ws.lowest_row(); row <= highest; ++row)
+            const auto lowest = ws.lowest_row();
+            const auto highest = ws.highest_row();
+            for (const auto &row : ws.d_->row_properties_)
             {
-                if (ws.has_row_properties(row) && ws.row_properties(row).dy_descent.is_set())
+                if (row.first >= lowest && row.first <= highest && row.second.dy_descent.is_set())
                 {
                     return true;
                 }
@@ -2361,10 +3676,14 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "sheetPr");
     }
 
-    write_start_element(xmlns, "dimension");
-    const auto dimension = ws.calculate_dimension();
-    write_attribute("ref", dimension.to_string());
-    write_end_element(xmlns, "dimension");
+    // the cells of a streamed worksheet are only known once they have been written
+    if (!streaming_)
+    {
+        write_start_element(xmlns, "dimension");
+        const auto dimension = ws.calculate_dimension();
+        write_attribute("ref", dimension.to_string());
+        write_end_element(xmlns, "dimension");
+    }
 
     if (ws.has_view())
     {
@@ -2494,21 +3813,18 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
     write_end_element(xmlns, "sheetFormatPr");
 
-    bool has_column_properties = false;
-    const auto first_column = ws.lowest_column_or_props();
-    const auto last_column = ws.highest_column_or_props();
+    const auto &column_properties = ws.d_->column_properties_;
 
-    for (auto column = first_column; column <= last_column; column++)
+    if (!column_properties.empty())
     {
-        if (!ws.has_column_properties(column)) continue;
-
-        if (!has_column_properties)
-        {
-            write_start_element(xmlns, "cols");
-            has_column_properties = true;
-        }
+        write_start_element(xmlns, "cols");
+    }
 
-        const auto &props = ws.column_properties(column);
+    // the properties are stored in column order
+    for (const auto &column_props : column_properties)
+    {
+        const auto &column = column_props.first;
+        const auto &props = column_props.second;
 
         write_start_element(xmlns, "col");
         write_attribute("min", column.index);
@@ -2543,25 +3859,176 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "col");
     }
 
-    if (has_column_properties)
+    if (!column_properties.empty())
     {
         write_end_element(xmlns, "cols");
     }
 
-    std::vector<std::pair<std::string, hyperlink>> hyperlinks;
-    std::vector<cell_reference> cells_with_comments;
-
     write_start_element(xmlns, "sheetData");
+    // closes the start tag so that the rows can be written straight to the part stream
+    write_characters("");
+}
+
+void xlsx_producer::write_sheet_data(worksheet ws, std::vector<std::pair<std::string, hyperlink>> &hyperlinks)
+{
+    detail::sheet_data_writer sheet_data(current_part_stream_);
+    std::size_t shared_string_cells = 0;
     auto first_row = ws.lowest_row_or_props();
     auto last_row = ws.highest_row_or_props();
     auto first_block_column = constants::max_column();
     auto last_block_column = constants::min_column();
 
+    // every cell which will be written, ordered by row and then column; after
+    // worksheet::garbage_collect there are no collectible cells left to skip
+    std::vector<detail::cell_impl *> cells;
+    cells.reserve(ws.d_->cell_map_.size());
+    const auto collected = ws.d_->cell_map_.collected();
+    ws.d_->cell_map_.for_each([&cells, collected](detail::cell_impl &cell) {
+        if (collected || !cell.is_garbage_collectible())
+        {
+            cells.push_back(&cell);
+        }
+    });
+    std::sort(cells.begin(), cells.end(), [](const detail::cell_impl *a, const detail::cell_impl *b) {
+        return a->row_ < b->row_ || (a->row_ == b->row_ && a->column_ < b->column_);
+    });
+
+    // Formula groups are written back as shared or array formulae as long as their master
+    // cell still belongs to them and, for an array formula, no cell has left the range.
+    // Groups which don't qualify anymore are written as a plain formula in every cell.
+    struct formula_group_output
+    {
+        bool write = false;
+        int shared_index = -1;
+        std::size_t members = 0;
+        range_reference range;
+    };
+
+    const auto &formula_groups = ws.d_->formula_groups_;
+    std::vector<formula_group_output> group_outputs(formula_groups.size());
+
+    for (auto cell : cells)
+    {
+        if (cell->formula_group_ == 0) continue;
+
+        auto &output = group_outputs[cell->formula_group_ - 1];
+        const auto reference = cell_reference(cell->column_, cell->row_);
+
+        if (output.members++ == 0)
+        {
+            output.range = range_reference(reference, reference);
+        }
+        else
+        {
+            output.range = range_reference(
+                std::min(output.range.top_left().column(), cell->column_),
+                std::min(output.range.top_left().row(), cell->row_),
+                std::max(output.range.bottom_right().column(), cell->column_),
+                std::max(output.range.bottom_right().row(), cell->row_));
+        }
+
+        if (reference == formula_groups[cell->formula_group_ - 1].master)
+        {
+            output.write = true;
+        }
+    }
+
+    auto next_shared_index = 0;
+
+    for (std::size_t i = 0; i < group_outputs.size(); ++i)
+    {
+        auto &output = group_outputs[i];
+
+        if (formula_groups[i].array)
+        {
+            output.write = output.write && output.range == formula_groups[i].range
+                && output.members == formula_groups[i].range.width() * formula_groups[i].range.height();
+        }
+        else if (output.write)
+        {
+            output.shared_index = next_shared_index++;
+        }
+    }
+
+    // With save_options::share_formulas, runs of plain formulas down a column which are
+    // copies of the first one moved along with their cells are written as shared formulae.
+    // Fragments are spliced into other worksheets, where their indices could collide.
+    struct formula_run
+    {
+        std::size_t first = 0;
+        row_t last_row = 0;
+        int shared_index = -1;
+    };
+
+    std::vector<formula_run> formula_runs;
+    std::vector<std::uint32_t> cell_runs;
+
+    if (options_.share_formulas && !writing_fragment_)
+    {
+        struct open_run
+        {
+            std::size_t run = 0;
+            std::string key;
+        };
+
+        std::unordered_map<column_t::index_t, open_run> open_runs;
+        std::string key;
+        cell_runs.assign(cells.size(), 0);
+
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            const auto cell = cells[i];
+            if (cell->formula_group_ != 0 || !cell->formula().is_set()) continue;
+            if (!shared_formula_key(cell->formula().get(), cell->column_.index, cell->row_, key)) continue;
+
+            auto &open = open_runs[cell->column_.index];
+
+            if (open.run != 0 && formula_runs[open.run - 1].last_row + 1 == cell->row_ && open.key == key)
+            {
+                formula_runs[open.run - 1].last_row = cell->row_;
+            }
+            else
+            {
+                formula_runs.push_back({i, cell->row_, -1});
+                open.run = formula_runs.size();
+                open.key.swap(key);
+            }
+
+            cell_runs[i] = static_cast<std::uint32_t>(open.run);
+        }
+
+        for (auto &run : formula_runs)
+        {
+            if (run.last_row > cells[run.first]->row_)
+            {
+                run.shared_index = next_shared_index++;
+            }
+        }
+    }
+
+    progress_reporter::worksheet_progress sheet_progress;
+
+    if (progress_)
+    {
+        sheet_progress.title = ws.title();
+    }
+
+    auto row_begin = cells.begin();
+
     for (auto row = first_row; row <= last_row; ++row)
     {
-        bool any_non_null = false;
-        auto first_check_row = row;
-        auto last_check_row = row;
+        while (row_begin != cells.end() && (*row_begin)->row_ < row)
+        {
+            ++row_begin;
+        }
+
+        auto row_end = row_begin;
+        while (row_end != cells.end() && (*row_end)->row_ == row)
+        {
+            ++row_end;
+        }
+
+        bool any_non_null = row_begin != row_end;
         auto first_row_in_block = row == first_row || row % 16 == 1;
 
         // See note for CT_Row, span attribute about block optimization
@@ -2571,207 +4038,343 @@ void xlsx_producer::write_worksheet(const relationship &rel)
             first_block_column = constants::max_column();
             last_block_column = constants::min_column();
 
-            first_check_row = row;
             // round up to the next multiple of 16
-            last_check_row = ((row / 16) + 1) * 16;
-        }
+            const auto last_check_row = ((row / 16) + 1) * 16;
 
-        for (auto check_row = first_check_row; check_row <= last_check_row; ++check_row)
-        {
-            for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
+            for (auto cell = row_begin; cell != cells.end() && (*cell)->row_ <= last_check_row; ++cell)
             {
-                auto ref = cell_reference(column, check_row);
-                auto cell = ws.d_->cell_map_.find(ref);
-                if (cell == ws.d_->cell_map_.end())
-                {
-                    continue;
-                }
-                if (cell->second.is_garbage_collectible())
-                {
-                    continue;
-                }
-
-                first_block_column = std::min(first_block_column, cell->second.column_);
-                last_block_column = std::max(last_block_column, cell->second.column_);
-
-                if (row == check_row)
-                {
-                    any_non_null = true;
-                }
+                first_block_column = std::min(first_block_column, (*cell)->column_);
+                last_block_column = std::max(last_block_column, (*cell)->column_);
             }
         }
 
         if (!any_non_null && !ws.has_row_properties(row)) continue;
 
-        write_start_element(xmlns, "row");
-        write_attribute("r", row);
+        write_row_start(sheet_data, ws, row, first_block_column, last_block_column);
+
+        if (!any_non_null)
+        {
+            sheet_data.end_empty_element();
+            continue;
+        }
 
-        auto span_string = std::to_string(first_block_column.index) + ":"
-            + std::to_string(last_block_column.index);
-        write_attribute("spans", span_string);
+        sheet_data.end_start_tag();
 
-        if (ws.has_row_properties(row))
+        for (auto cell_iter = row_begin; cell_iter != row_end; ++cell_iter)
         {
-            const auto &props = ws.row_properties(row);
+            auto cell = xlnt::cell(*cell_iter);
 
-            if (props.style.is_set())
-            {
-                write_attribute("s", props.style.get());
-            }
-            if (props.custom_format.is_set())
-            {
-                write_attribute("customFormat", write_bool(props.custom_format.get()));
-            }
+            // record data about the cell needed later
 
-            if (props.height.is_set())
+            if (cell.has_hyperlink())
             {
-                auto height = props.height.get();
-                write_attribute("ht", xlnt::detail::serialise(height));
+                hyperlinks.push_back(std::make_pair(cell.reference().to_string(), cell.hyperlink()));
             }
 
-            if (props.hidden)
+            write_cell_start(sheet_data, cell);
+
+            // begin child elements
+
+            const auto group_id = (*cell_iter)->formula_group_;
+            const auto run_id = cell_runs.empty() ? 0 : cell_runs[static_cast<std::size_t>(cell_iter - cells.begin())];
+            const auto run = run_id != 0 && formula_runs[run_id - 1].shared_index >= 0 ? &formula_runs[run_id - 1] : nullptr;
+
+            if (group_id != 0 && group_outputs[group_id - 1].write)
             {
-                write_attribute("hidden", write_bool(true));
+                const auto &group = formula_groups[group_id - 1];
+                const auto &output = group_outputs[group_id - 1];
+                const auto is_master = cell.reference() == group.master;
+
+                if (is_master || !group.array)
+                {
+                    sheet_data.start_element("f");
+                    sheet_data.attribute("t", group.array ? "array" : "shared");
+
+                    if (is_master)
+                    {
+                        sheet_data.attribute("ref", output.range.to_string());
+                    }
+
+                    if (!group.array)
+                    {
+                        sheet_data.attribute("si", static_cast<std::uint64_t>(output.shared_index));
+                    }
+
+                    if (is_master)
+                    {
+                        sheet_data.end_start_tag();
+                        sheet_data.characters(group.text.get());
+                        sheet_data.end_element("f");
+                    }
+                    else
+                    {
+                        sheet_data.end_empty_element();
+                    }
+                }
             }
+            else if (run != nullptr)
+            {
+                const auto master = cells[run->first];
 
-            if (props.custom_height)
+                sheet_data.start_element("f");
+                sheet_data.attribute("t", "shared");
+
+                if (*cell_iter == master)
+                {
+                    sheet_data.attribute("ref",
+                        range_reference(master->column_, master->row_, master->column_, run->last_row).to_string());
+                    sheet_data.attribute("si", static_cast<std::uint64_t>(run->shared_index));
+                    sheet_data.end_start_tag();
+                    sheet_data.characters(cell.formula());
+                    sheet_data.end_element("f");
+                }
+                else
+                {
+                    sheet_data.attribute("si", static_cast<std::uint64_t>(run->shared_index));
+                    sheet_data.end_empty_element();
+                }
+            }
+            else if (cell.has_formula())
             {
-                write_attribute("customHeight", write_bool(true));
+                sheet_data.element("f", cell.formula());
             }
 
-            if (props.dy_descent.is_set())
-            {
-                write_attribute<double>(xml::qname(xmlns_x14ac, "dyDescent"), props.dy_descent.get());
-            }
+            write_cell_value(sheet_data, cell, shared_string_cells);
+
+            sheet_data.end_element("c");
+        }
+
+        sheet_data.end_element("row");
+
+        if (progress_)
+        {
+            progress_->add_cells(sheet_progress, static_cast<std::size_t>(row_end - row_begin));
+        }
+    }
+
+    sheet_data.flush();
+
+    if (progress_)
+    {
+        progress_->finish(sheet_progress);
+    }
+
+    shared_string_cells_[ws.d_] = shared_string_cells;
+}
+
+deflated_fragment xlsx_producer::write_sheet_data_fragment(worksheet ws, compression_level level)
+{
+    worksheet_loader::load(*ws.d_);
+
+    std::vector<std::uint8_t> xml;
+    vector_ostreambuf xml_buffer(xml);
+    current_part_stream_.rdbuf(&xml_buffer);
+
+    std::vector<std::pair<std::string, hyperlink>> hyperlinks;
+    writing_fragment_ = true;
+    write_sheet_data(ws, hyperlinks);
+    writing_fragment_ = false;
+    current_part_stream_.rdbuf(nullptr);
+
+    return deflated_fragment::compress(xml.data(), xml.size(), level);
+}
+
+void xlsx_producer::write_row_start(detail::sheet_data_writer &sheet_data, worksheet ws, row_t row,
+    column_t first_span_column, column_t last_span_column)
+{
+    sheet_data.start_element("row");
+    sheet_data.attribute("r", static_cast<std::uint64_t>(row));
+
+    if (first_span_column <= last_span_column)
+    {
+        sheet_data.attribute("spans", static_cast<std::uint64_t>(first_span_column.index),
+            static_cast<std::uint64_t>(last_span_column.index));
+    }
+
+    const auto row_props = ws.d_->row_properties_.find(row);
+
+    if (row_props != ws.d_->row_properties_.end())
+    {
+        const auto &props = row_props->second;
+
+        if (props.style.is_set())
+        {
+            sheet_data.attribute("s", static_cast<std::uint64_t>(props.style.get()));
+        }
+        if (props.custom_format.is_set())
+        {
+            sheet_data.attribute("customFormat", write_bool(props.custom_format.get()));
+        }
+
+        if (props.height.is_set())
+        {
+            sheet_data.attribute("ht", props.height.get());
+        }
+
+        if (props.hidden)
+        {
+            sheet_data.attribute("hidden", write_bool(true));
+        }
+
+        if (props.custom_height)
+        {
+            sheet_data.attribute("customHeight", write_bool(true));
         }
 
-        if (any_non_null)
+        if (props.dy_descent.is_set())
         {
-            for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
-            {
-                if (!ws.has_cell(cell_reference(column, row))) continue;
+            // the x14ac prefix is declared on the worksheet whenever a row has dyDescent
+            sheet_data.attribute("x14ac:dyDescent", props.dy_descent.get());
+        }
+    }
+}
 
-                auto cell = ws.cell(cell_reference(column, row));
+void xlsx_producer::write_cell_start(detail::sheet_data_writer &sheet_data, const cell &cell)
+{
+    sheet_data.start_element("c");
 
-                if (cell.garbage_collectible()) continue;
+    // begin cell attributes
 
-                // record data about the cell needed later
+    sheet_data.attribute("r", cell.d_->column_, cell.d_->row_);
 
-                if (cell.has_comment())
-                {
-                    cells_with_comments.push_back(cell.reference());
-                }
+    if (cell.phonetics_visible())
+    {
+        sheet_data.attribute("ph", write_bool(true));
+    }
 
-                if (cell.has_hyperlink())
-                {
-                    hyperlinks.push_back(std::make_pair(cell.reference().to_string(), cell.hyperlink()));
-                }
+    if (cell.has_format())
+    {
+        sheet_data.attribute("s", static_cast<std::uint64_t>(cell.format().d_->id));
+    }
 
-                write_start_element(xmlns, "c");
+    switch (written_type(cell))
+    {
+    case cell::type::empty:
+        break;
 
-                // begin cell attributes
+    case cell::type::boolean:
+        sheet_data.attribute("t", "b");
+        break;
 
-                write_attribute("r", cell.reference().to_string());
+    case cell::type::date:
+        sheet_data.attribute("t", "d");
+        break;
 
-                if (cell.phonetics_visible())
-                {
-                    write_attribute("ph", write_bool(true));
-                }
+    case cell::type::error:
+        sheet_data.attribute("t", "e");
+        break;
 
-                if (cell.has_format())
-                {
-                    write_attribute("s", cell.format().d_->id);
-                }
+    case cell::type::inline_string:
+        sheet_data.attribute("t", "inlineStr");
+        break;
 
-                switch (cell.data_type())
-                {
-                case cell::type::empty:
-                    break;
+    case cell::type::number: // default, don't write it
+        break;
+
+    case cell::type::shared_string:
+        sheet_data.attribute("t", writing_fragment_ ? "inlineStr" : "s");
+        break;
 
-                case cell::type::boolean:
-                    write_attribute("t", "b");
-                    break;
+    case cell::type::formula_string:
+        sheet_data.attribute("t", "str");
+        break;
+    }
 
-                case cell::type::date:
-                    write_attribute("t", "d");
-                    break;
+    //write_attribute("cm", "");
+    //write_attribute("vm", "");
+    //write_attribute("ph", "");
 
-                case cell::type::error:
-                    write_attribute("t", "e");
-                    break;
+    sheet_data.end_start_tag();
+}
 
-                case cell::type::inline_string:
-                    write_attribute("t", "inlineStr");
-                    break;
+void xlsx_producer::write_cell_value(detail::sheet_data_writer &sheet_data, const cell &cell,
+    std::size_t &shared_string_cells)
+{
+    static const auto &xmlns = constants::ns("spreadsheetml");
 
-                case cell::type::number: // default, don't write it
-                    //write_attribute("t", "n");
-                    break;
+    switch (written_type(cell))
+    {
+    case cell::type::empty:
+        break;
 
-                case cell::type::shared_string:
-                    write_attribute("t", "s");
-                    break;
+    case cell::type::boolean:
+        sheet_data.element("v", write_bool(cell.value<bool>()));
+        break;
 
-                case cell::type::formula_string:
-                    write_attribute("t", "str");
-                    break;
-                }
+    case cell::type::date:
+        sheet_data.element("v", cell.value<std::string>());
+        break;
 
-                //write_attribute("cm", "");
-                //write_attribute("vm", "");
-                //write_attribute("ph", "");
+    case cell::type::error:
+        sheet_data.element("v", cell.value<std::string>());
+        break;
 
-                // begin child elements
+    case cell::type::inline_string: {
+        const auto &text = cell.d_->value_text();
 
-                if (cell.has_formula())
-                {
-                    write_element(xmlns, "f", cell.formula());
-                }
+        if (write_plain_text(sheet_data, text, "is"))
+        {
+            break;
+        }
 
-                switch (cell.data_type())
-                {
-                case cell::type::empty:
-                    break;
-
-                case cell::type::boolean:
-                    write_element(xmlns, "v", write_bool(cell.value<bool>()));
-                    break;
-
-                case cell::type::date:
-                    write_element(xmlns, "v", cell.value<std::string>());
-                    break;
-
-                case cell::type::error:
-                    write_element(xmlns, "v", cell.value<std::string>());
-                    break;
-
-                case cell::type::inline_string:
-                    write_start_element(xmlns, "is");
-                    write_rich_text(xmlns, cell.value<xlnt::rich_text>());
-                    write_end_element(xmlns, "is");
-                    break;
-
-                case cell::type::number:
-                    write_start_element(xmlns, "v");
-                    write_characters(xlnt::detail::serialise(cell.value<double>()));
-                    write_end_element(xmlns, "v");
-                    break;
-
-                case cell::type::shared_string:
-                    write_element(xmlns, "v", static_cast<std::size_t>(cell.d_->value_numeric_));
-                    break;
-
-                case cell::type::formula_string:
-                    write_element(xmlns, "v", cell.value<std::string>());
-                    break;
-                }
+        // a fragment has no serializer to write rich text with
+        if (writing_fragment_)
+        {
+            write_plain_text(sheet_data, rich_text(text.plain_text()), "is");
+            break;
+        }
+
+        // rich text is rare enough inline to leave to the serializer, which
+        // continues writing at the end of the buffer once it is flushed
+        sheet_data.flush();
+        write_start_element(xmlns, "is");
+        write_rich_text(xmlns, text);
+        write_end_element(xmlns, "is");
+        break;
+    }
+
+    case cell::type::number:
+        if (cell.d_->value_integral_)
+        {
+            sheet_data.element("v", cell.d_->value_integer_);
+        }
+        else
+        {
+            sheet_data.element("v", cell.d_->value_numeric_);
+        }
+        break;
+
+    case cell::type::shared_string:
+        if (writing_fragment_)
+        {
+            const auto text = cell.value<rich_text>();
 
-                write_end_element(xmlns, "c");
+            if (!write_plain_text(sheet_data, text, "is"))
+            {
+                write_plain_text(sheet_data, rich_text(text.plain_text()), "is");
             }
+
+            break;
         }
 
-        write_end_element(xmlns, "row");
+        sheet_data.element("v", static_cast<std::uint64_t>(cell.d_->value_numeric_));
+        ++shared_string_cells;
+        break;
+
+    case cell::type::formula_string:
+        sheet_data.element("v", cell.value<std::string>());
+        break;
     }
+}
+
+void xlsx_producer::end_worksheet(const relationship &rel, worksheet ws,
+    const std::vector<std::pair<std::string, hyperlink>> &hyperlinks)
+{
+    static const auto &xmlns = constants::ns("spreadsheetml");
+    static const auto &xmlns_r = constants::ns("r");
+
+    auto worksheet_part = rel.source().path().parent().append(rel.target().path());
+    auto worksheet_rels = source_.manifest().relationships(worksheet_part);
 
     write_end_element(xmlns, "sheetData");
 
@@ -2782,12 +4385,14 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "autoFilter");
     }
 
-    if (!ws.merged_ranges().empty())
+    const auto &merged_ranges = ws.d_->merged_cells_.ranges();
+
+    if (!merged_ranges.empty())
     {
         write_start_element(xmlns, "mergeCells");
-        write_attribute("count", ws.merged_ranges().size());
+        write_attribute("count", merged_ranges.size());
 
-        for (auto merged_range : ws.merged_ranges())
+        for (const auto &merged_range : merged_ranges)
         {
             write_start_element(xmlns, "mergeCell");
             write_attribute("ref", merged_range.to_string());
@@ -2808,11 +4413,6 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         {
             if (cf.target_sheet != ws.d_) continue;
 
-            if (range_map.find(cf.target_range.to_string()) == range_map.end())
-            {
-                range_map[cf.target_range.to_string()] = {};
-            }
-
             range_map[cf.target_range.to_string()].push_back(&cf);
         }
 
@@ -2963,63 +4563,13 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
         write_start_element(xmlns, "headerFooter");
 
-        auto odd_header = std::string();
-        auto odd_footer = std::string();
-        auto even_header = std::string();
-        auto even_footer = std::string();
-        auto first_header = std::string();
-        auto first_footer = std::string();
-
-        const auto locations =
-            {
-                header_footer::location::left,
-                header_footer::location::center,
-                header_footer::location::right};
-
-        using xlnt::detail::encode_header_footer;
-
-        for (auto location : locations)
-        {
-            if (hf.different_odd_even())
-            {
-                if (hf.has_odd_even_header(location))
-                {
-                    odd_header.append(encode_header_footer(hf.odd_header(location), location));
-                    even_header.append(encode_header_footer(hf.even_header(location), location));
-                }
-
-                if (hf.has_odd_even_footer(location))
-                {
-                    odd_footer.append(encode_header_footer(hf.odd_footer(location), location));
-                    even_footer.append(encode_header_footer(hf.even_footer(location), location));
-                }
-            }
-            else
-            {
-                if (hf.has_header(location))
-                {
-                    odd_header.append(encode_header_footer(hf.header(location), location));
-                }
-
-                if (hf.has_footer(location))
-                {
-                    odd_footer.append(encode_header_footer(hf.footer(location), location));
-                }
-            }
-
-            if (hf.different_first())
-            {
-                if (hf.has_first_page_header(location))
-                {
-                    first_header.append(encode_header_footer(hf.first_page_header(location), location));
-                }
-
-                if (hf.has_first_page_footer(location))
-                {
-                    first_footer.append(encode_header_footer(hf.first_page_footer(location), location));
-                }
-            }
-        }
+        const auto &encoded = detail::encode_header_footer(hf, encoded_header_footers_);
+        const auto &odd_header = encoded[0];
+        const auto &odd_footer = encoded[1];
+        const auto &even_header = encoded[2];
+        const auto &even_footer = encoded[3];
+        const auto &first_header = encoded[4];
+        const auto &first_footer = encoded[5];
 
         if (!odd_header.empty())
         {
@@ -3126,24 +4676,7 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         {
             if (child_rel.target_mode() == target_mode::external) continue;
 
-            // todo: this is ugly
-            path archive_path(worksheet_part.parent().append(child_rel.target().path()));
-            auto split_part_path = archive_path.split();
-            auto part_path_iter = split_part_path.begin();
-
-            while (part_path_iter != split_part_path.end())
-            {
-                if (*part_path_iter == "..")
-                {
-                    part_path_iter = split_part_path.erase(part_path_iter - 1, part_path_iter + 1);
-                    continue;
-                }
-
-                ++part_path_iter;
-            }
-
-            archive_path = std::accumulate(split_part_path.begin(), split_part_path.end(), path(""),
-                [](const path &a, const std::string &b) { return a.append(b); });
+            const auto archive_path = resolve_part_path(worksheet_part.parent().append(child_rel.target().path()));
 
             if (child_rel.type() == relationship_type::printer_settings)
             {
@@ -3155,11 +4688,11 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
             if (child_rel.type() == relationship_type::comments)
             {
-                write_comments(child_rel, ws, cells_with_comments);
+                write_comments(child_rel, ws);
             }
             else if (child_rel.type() == relationship_type::vml_drawing)
             {
-                write_vml_drawings(child_rel, ws, cells_with_comments);
+                write_vml_drawings(child_rel, ws);
             }
             else if (child_rel.type() == relationship_type::drawings)
             {
@@ -3169,28 +4702,202 @@ void xlsx_producer::write_worksheet(const relationship &rel)
     }
 }
 
+std::vector<zmembers> xlsx_producer::write_worksheets_concurrently(const std::vector<relationship> &worksheet_rels)
+{
+    // The workbook is only read while worksheets are written, so each thread only
+    // needs its own producer and destination archive.
+    std::vector<zmembers> rendered(worksheet_rels.size());
+    std::vector<std::unordered_map<const detail::worksheet_impl *, std::size_t>> shared_string_cells(worksheet_rels.size());
+    std::atomic<std::size_t> next_worksheet(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto write_worksheets = [&]() {
+        try
+        {
+            for (auto i = next_worksheet++; i < worksheet_rels.size(); i = next_worksheet++)
+            {
+                const auto &worksheet_rel = worksheet_rels[i];
+                const auto worksheet_path = worksheet_rel.source().path().parent().append(worksheet_rel.target().path());
+
+                vector_ostreambuf member_buffer(rendered[i].bytes);
+                std::ostream member_stream(&member_buffer);
+
+                xlsx_producer worker(source_, options_);
+                worker.progress_ = progress_;
+                worker.written_images_ = written_images_;
+                worker.archive_.reset(new ozstream(member_stream, options_.compression, options_.stats));
+                worker.archive_->fixed_timestamps(options_.deterministic);
+                worker.begin_part(worksheet_path);
+                worker.write_worksheet(worksheet_rel);
+                worker.end_part();
+                rendered[i].headers = worker.archive_->release();
+                shared_string_cells[i] = worker.shared_string_cells_;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            next_worksheet = worksheet_rels.size();
+        }
+    };
+
+    run_workers(std::min(options_.worksheet_threads, worksheet_rels.size()), write_worksheets);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    for (const auto &counted : shared_string_cells)
+    {
+        shared_string_cells_.insert(counted.begin(), counted.end());
+    }
+
+    return rendered;
+}
+
+void xlsx_producer::select_copied_worksheets()
+{
+    // collecting garbage renumbers the formats the copied worksheets refer to
+    if (source_.d_->stylesheet_.is_set())
+    {
+        const auto &stylesheet = source_.d_->stylesheet_.get();
+
+        if (stylesheet.garbage_pending || stylesheet.dirty_records != 0)
+        {
+            return;
+        }
+    }
+
+    const auto &manifest = source_.manifest();
+    const auto workbook_rel = manifest.relationship(path("/"), relationship_type::office_document);
+    const auto workbook_part = workbook_rel.target().path();
+
+    // the number of internal relationships targeting each part
+    std::unordered_map<path, std::size_t> referrers;
+
+    for (const auto &part : manifest.parts())
+    {
+        for (const auto &rel : manifest.relationships(part))
+        {
+            if (rel.target_mode() == target_mode::internal)
+            {
+                ++referrers[resolve_part_path(part.parent().append(rel.target().path()))];
+            }
+        }
+    }
+
+    for (auto &ws : source_.d_->worksheets_)
+    {
+        if (!ws.load_pending_.load(std::memory_order_acquire) || !ws.loader_
+            || !manifest.has_relationship(workbook_part, ws.loader_rel_id_))
+        {
+            continue;
+        }
+
+        // fragments are spliced into the worksheet as it is written
+        if (options_.sheet_data_fragments != nullptr && options_.sheet_data_fragments->count(ws.title_) != 0)
+        {
+            continue;
+        }
+
+        const auto archive = ws.loader_->archive();
+        const auto worksheet_rel = manifest.relationship(workbook_part, ws.loader_rel_id_);
+        const auto worksheet_part = resolve_part_path(workbook_part.parent().append(worksheet_rel.target().path()));
+
+        // the worksheet and the parts reachable from it, which it's only copied with if
+        // they are all in the archive and no other part refers to them
+        std::vector<path> parts{worksheet_part};
+        std::unordered_set<path> reachable{worksheet_part};
+        std::vector<path> copied;
+        auto internal_references = std::size_t(1);
+        auto copyable = true;
+
+        for (std::size_t i = 0; copyable && i < parts.size(); ++i)
+        {
+            const auto part = parts[i];
+            const auto part_rels = manifest.relationships(part);
+            const auto rels_part = relationships_part_path(part);
+
+            copyable = archive->has_file(part) && archive->has_file(rels_part) == !part_rels.empty();
+            copied.push_back(part);
+
+            if (!part_rels.empty())
+            {
+                copied.push_back(rels_part);
+            }
+
+            for (const auto &rel : part_rels)
+            {
+                if (rel.target_mode() == target_mode::external) continue;
+
+                const auto target = resolve_part_path(part.parent().append(rel.target().path()));
+                ++internal_references;
+
+                if (reachable.insert(target).second)
+                {
+                    parts.push_back(target);
+                }
+            }
+        }
+
+        auto total_references = std::size_t(0);
+
+        for (const auto &part : parts)
+        {
+            total_references += referrers[part];
+        }
+
+        if (copyable && total_references == internal_references)
+        {
+            copied_worksheets_.insert(&ws);
+            copied_worksheet_parts_[ws.loader_rel_id_] = std::make_pair(archive, std::move(copied));
+        }
+    }
+}
+
+void xlsx_producer::copy_worksheet(const std::string &rel_id)
+{
+    end_part();
+
+    const auto &copied = copied_worksheet_parts_.at(rel_id);
+
+    for (const auto &part : copied.second)
+    {
+        archive_->append(part, copied.first->read_compressed(part));
+    }
+}
+
 // Sheet Relationship Target Parts
 
-void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws, const std::vector<cell_reference> &cells)
+void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws)
 {
     static const auto &xmlns = constants::ns("spreadsheetml");
+    const auto &comments = ws.d_->comments_;
 
     write_start_element(xmlns, "comments");
     write_namespace(xmlns, "");
 
-    if (!cells.empty())
+    if (!comments.empty())
     {
-        std::unordered_map<std::string, std::size_t> authors;
+        // authors are written in the order of their ids
+        std::vector<std::string> authors;
+        std::unordered_map<std::string, std::size_t> author_ids;
 
-        for (auto cell_ref : cells)
+        for (const auto &comment : comments)
         {
-            auto cell = ws.cell(cell_ref);
-            auto author = cell.comment().author();
+            const auto &author = comment.second.author();
 
-            if (authors.find(author) == authors.end())
+            if (author_ids.emplace(author, authors.size()).second)
             {
-                auto author_index = authors.size();
-                authors[author] = author_index;
+                authors.push_back(author);
             }
         }
 
@@ -3199,38 +4906,46 @@ void xlsx_producer::write_comments(const relationship & /*rel*/, worksheet ws, c
         for (const auto &author : authors)
         {
             write_start_element(xmlns, "author");
-            write_characters(author.first);
+            write_characters(author);
             write_end_element(xmlns, "author");
         }
 
         write_end_element(xmlns, "authors");
         write_start_element(xmlns, "commentList");
 
-        for (const auto &cell_ref : cells)
-        {
-            write_start_element(xmlns, "comment");
+        // comments are escaped straight into the part stream in the order of their cells,
+        // like the cells of sheetData, and only rich text is left to the serializer
+        detail::sheet_data_writer list(current_part_stream_);
+        write_characters("");
 
-            auto cell = ws.cell(cell_ref);
-            auto cell_comment = cell.comment();
+        for (const auto &comment : comments)
+        {
+            const auto &cell_comment = comment.second;
 
-            write_attribute("ref", cell_ref.to_string());
-            auto author_id = authors.at(cell_comment.author());
-            write_attribute("authorId", author_id);
+            list.start_element("comment");
+            list.attribute("ref", comment.first.column(), comment.first.row());
+            list.attribute("authorId", static_cast<std::uint64_t>(author_ids.at(cell_comment.author())));
+            list.end_start_tag();
 
-            write_start_element(xmlns, "text");
-            write_rich_text(xmlns, cell_comment.text());
-            write_end_element(xmlns, "text");
+            if (!write_plain_text(list, cell_comment.text(), "text"))
+            {
+                list.flush();
+                write_start_element(xmlns, "text");
+                write_rich_text(xmlns, cell_comment.text());
+                write_end_element(xmlns, "text");
+            }
 
-            write_end_element(xmlns, "comment");
+            list.end_element("comment");
         }
 
+        list.flush();
         write_end_element(xmlns, "commentList");
     }
 
     write_end_element(xmlns, "comments");
 }
 
-void xlsx_producer::write_vml_drawings(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells)
+void xlsx_producer::write_vml_drawings(const relationship &rel, worksheet ws)
 {
     static const auto &xmlns_mv = std::string("http://macVmlSchemaUri");
     static const auto &xmlns_o = std::string("urn:schemas-microsoft-com:office:office");
@@ -3277,93 +4992,60 @@ void xlsx_producer::write_vml_drawings(const relationship &rel, worksheet ws, co
     write_end_element(xmlns_v, "path");
     write_end_element(xmlns_v, "shapetype");
 
-    std::size_t comment_index = 0;
-
-    for (const auto &cell_ref : cells)
-    {
-        auto comment = ws.cell(cell_ref).comment();
-        auto shape_id = 1024 * file_index + 1 + comment_index * 2;
-
-        write_start_element(xmlns_v, "shape");
-        write_attribute("id", "_x0000_s" + std::to_string(shape_id));
-        write_attribute("type", "#_x0000_t202");
-
-        std::vector<std::pair<std::string, std::string>> style;
+    // the shapes are written straight to the part stream, copying the markup which is
+    // the same for every comment and filling in only the values which vary
+    detail::sheet_data_writer shapes(current_part_stream_);
+    write_characters("");
 
-        style.push_back({"position", "absolute"});
-        style.push_back({"margin-left", std::to_string(comment.left()) + "pt"});
-        style.push_back({"margin-top", std::to_string(comment.top()) + "pt"});
-        style.push_back({"width", std::to_string(comment.width()) + "pt"});
-        style.push_back({"height", std::to_string(comment.height()) + "pt"});
-        style.push_back({"z-index", std::to_string(comment_index + 1)});
-        style.push_back({"visibility", comment.visible() ? "visible" : "hidden"});
+    std::uint64_t comment_index = 0;
 
-        std::string style_string;
-
-        for (auto part : style)
-        {
-            style_string.append(part.first);
-            style_string.append(":");
-            style_string.append(part.second);
-            style_string.append(";");
-        }
-
-        write_attribute("style", style_string);
-        write_attribute("fillcolor", "#fbf6d6");
-        write_attribute("strokecolor", "#edeaa1");
-
-        write_start_element(xmlns_v, "fill");
-        write_attribute("color2", "#fbfe82");
-        write_attribute("angle", -180);
-        write_attribute("type", "gradient");
-        write_start_element(xmlns_o, "fill");
-        write_attribute(xml::qname(xmlns_v, "ext"), "view");
-        write_attribute("type", "gradientUnscaled");
-        write_end_element(xmlns_o, "fill");
-        write_end_element(xmlns_v, "fill");
-
-        write_start_element(xmlns_v, "shadow");
-        write_attribute("on", "t");
-        write_attribute("obscured", "t");
-        write_end_element(xmlns_v, "shadow");
-
-        write_start_element(xmlns_v, "path");
-        write_attribute(xml::qname(xmlns_o, "connecttype"), "none");
-        write_end_element(xmlns_v, "path");
-
-        write_start_element(xmlns_v, "textbox");
-        write_attribute("style", "mso-direction-alt:auto");
-        write_start_element("div");
-        write_attribute("style", "text-align:left");
-        write_characters("");
-        write_end_element("div");
-        write_end_element(xmlns_v, "textbox");
-
-        write_start_element(xmlns_x, "ClientData");
-        write_attribute("ObjectType", "Note");
-        write_start_element(xmlns_x, "MoveWithCells");
-        write_end_element(xmlns_x, "MoveWithCells");
-        write_start_element(xmlns_x, "SizeWithCells");
-        write_end_element(xmlns_x, "SizeWithCells");
-        write_start_element(xmlns_x, "Anchor");
-        write_characters("1, 15, 0, " + std::to_string(2 + comment_index * 4) + ", 2, 54, 4, 14");
-        write_end_element(xmlns_x, "Anchor");
-        write_start_element(xmlns_x, "AutoFill");
-        write_characters("False");
-        write_end_element(xmlns_x, "AutoFill");
-        write_start_element(xmlns_x, "Row");
-        write_characters(cell_ref.row() - 1);
-        write_end_element(xmlns_x, "Row");
-        write_start_element(xmlns_x, "Column");
-        write_characters(cell_ref.column_index() - 1);
-        write_end_element(xmlns_x, "Column");
-        write_end_element(xmlns_x, "ClientData");
-
-        write_end_element(xmlns_v, "shape");
+    for (const auto &entry : ws.d_->comments_)
+    {
+        const auto &cell_ref = entry.first;
+        const auto &comment = entry.second;
+
+        shapes.markup("<v:shape id=\"_x0000_s");
+        shapes.number(static_cast<std::int64_t>(1024 * file_index + 1 + comment_index * 2));
+        shapes.markup("\" type=\"#_x0000_t202\" style=\"position:absolute;margin-left:");
+        shapes.number(comment.left());
+        shapes.markup("pt;margin-top:");
+        shapes.number(comment.top());
+        shapes.markup("pt;width:");
+        shapes.number(comment.width());
+        shapes.markup("pt;height:");
+        shapes.number(comment.height());
+        shapes.markup("pt;z-index:");
+        shapes.number(static_cast<std::int64_t>(comment_index + 1));
+        shapes.markup(";visibility:");
+
+        if (comment.visible())
+        {
+            shapes.markup("visible");
+        }
+        else
+        {
+            shapes.markup("hidden");
+        }
+
+        shapes.markup(";\" fillcolor=\"#fbf6d6\" strokecolor=\"#edeaa1\">"
+                      "<v:fill color2=\"#fbfe82\" angle=\"-180\" type=\"gradient\">"
+                      "<o:fill v:ext=\"view\" type=\"gradientUnscaled\"/></v:fill>"
+                      "<v:shadow on=\"t\" obscured=\"t\"/>"
+                      "<v:path o:connecttype=\"none\"/>"
+                      "<v:textbox style=\"mso-direction-alt:auto\"><div style=\"text-align:left\"></div></v:textbox>"
+                      "<x:ClientData ObjectType=\"Note\"><x:MoveWithCells/><x:SizeWithCells/>"
+                      "<x:Anchor>1, 15, 0, ");
+        shapes.number(static_cast<std::int64_t>(2 + comment_index * 4));
+        shapes.markup(", 2, 54, 4, 14</x:Anchor><x:AutoFill>False</x:AutoFill><x:Row>");
+        shapes.number(static_cast<std::int64_t>(cell_ref.row() - 1));
+        shapes.markup("</x:Row><x:Column>");
+        shapes.number(static_cast<std::int64_t>(cell_ref.column_index() - 1));
+        shapes.markup("</x:Column></x:ClientData></v:shape>");
 
         ++comment_index;
     }
 
+    shapes.flush();
     write_end_element("xml");
 }
 
@@ -3417,8 +5099,32 @@ void xlsx_producer::write_image(const path &image_path)
 {
     end_part();
 
-    vector_istreambuf buffer(source_.d_->images_.at(image_path.string()));
-    auto image_streambuf = archive_->open(image_path);
+    {
+        std::lock_guard<std::mutex> lock(written_images_->mutex);
+
+        if (!written_images_->paths.insert(image_path.string()).second)
+        {
+            return;
+        }
+    }
+
+    // parts still compressed as they were loaded are copied as they are
+    auto compressed = source_.d_->compressed_images_.find(image_path.string());
+
+    if (compressed != source_.d_->compressed_images_.end())
+    {
+        archive_->append(image_path, compressed->second);
+        return;
+    }
+
+    auto shared = source_.d_->shared_images_.find(image_path.string());
+    const auto &image = shared != source_.d_->shared_images_.end()
+        ? *shared->second
+        : source_.d_->images_.at(image_path.string());
+
+    vector_istreambuf buffer(image);
+    auto image_streambuf = is_compressed_image(image) ? archive_->open(image_path, compression_level::none)
+                                                      : archive_->open(image_path);
     std::ostream(image_streambuf.get()) << &buffer;
 }
 
@@ -3426,6 +5132,14 @@ void xlsx_producer::write_binary(const path &binary_path)
 {
     end_part();
 
+    auto compressed = source_.d_->compressed_binaries_.find(binary_path.string());
+
+    if (compressed != source_.d_->compressed_binaries_.end())
+    {
+        archive_->append(binary_path, compressed->second);
+        return;
+    }
+
     vector_istreambuf buffer(source_.d_->binaries_.at(binary_path.string()));
     auto image_streambuf = archive_->open(binary_path);
     std::ostream(image_streambuf.get()) << &buffer;
@@ -3438,26 +5152,51 @@ std::string xlsx_producer::write_bool(bool boolean) const
 
 void xlsx_producer::write_relationships(const std::vector<xlnt::relationship> &relationships, const path &part)
 {
-    path parent = part.parent();
-
-    if (parent.is_absolute())
-    {
-        parent = path(parent.string().substr(1));
-    }
-
-    path rels_path(parent.append("_rels").append(part.filename() + ".rels").string());
-    begin_part(rels_path);
+    begin_part(relationships_part_path(part));
 
     const auto xmlns = xlnt::constants::ns("relationships");
 
     write_start_element(xmlns, "Relationships");
     write_namespace(xmlns, "");
 
-    for (std::size_t i = 1; i <= relationships.size(); ++i)
+    // written in order of their ids, placed by number instead of searching for each id
+    std::vector<const xlnt::relationship *> ordered(relationships.size(), nullptr);
+    std::vector<const xlnt::relationship *> unnumbered;
+
+    for (const auto &relationship : relationships)
+    {
+        const auto &id = relationship.id();
+        std::size_t index = 0;
+
+        if (id.size() > 3 && id.compare(0, 3, "rId") == 0
+            && std::all_of(id.begin() + 3, id.end(), [](char c) { return c >= '0' && c <= '9'; })
+            && id.size() < 13)
+        {
+            index = static_cast<std::size_t>(std::stoull(id.substr(3)));
+        }
+
+        if (index >= 1 && index <= ordered.size() && ordered[index - 1] == nullptr)
+        {
+            ordered[index - 1] = &relationship;
+        }
+        else
+        {
+            unnumbered.push_back(&relationship);
+        }
+    }
+
+    if (options_.deterministic)
+    {
+        std::sort(unnumbered.begin(), unnumbered.end(),
+            [](const xlnt::relationship *a, const xlnt::relationship *b) { return a->id() < b->id(); });
+    }
+
+    ordered.erase(std::remove(ordered.begin(), ordered.end(), nullptr), ordered.end());
+    ordered.insert(ordered.end(), unnumbered.begin(), unnumbered.end());
+
+    for (const auto *rel : ordered)
     {
-        auto rel_iter = std::find_if(relationships.begin(), relationships.end(),
-            [&i](const relationship &r) { return r.id() == "rId" + std::to_string(i); });
-        auto relationship = *rel_iter;
+        const auto &relationship = *rel;
 
         write_start_element(xmlns, "Relationship");
 
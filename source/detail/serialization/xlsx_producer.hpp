@@ -26,13 +26,24 @@
 
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <detail/constants.hpp>
 #include <detail/external/include_libstudxml.hpp>
+#include <detail/header_footer/header_footer_code.hpp>
+#include <detail/implementations/calculation_chain_entry.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/utils/progress_reporter.hpp>
+#include <xlnt/cell/index_types.hpp>
 #include <xlnt/internal/features.hpp>
+#include <xlnt/utils/optional.hpp>
+#include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/save_options.hpp>
 
 #if XLNT_HAS_INCLUDE(<string_view>) && XLNT_HAS_FEATURE(U8_STRING_VIEW)
   #include <string_view>
@@ -48,11 +59,19 @@ class border;
 class cell;
 class cell_reference;
 class color;
+class deflated_fragment;
+class column_view;
+struct date;
+struct datetime;
+class encryption_key;
 class fill;
 class font;
-class path;
+class format;
+class hyperlink;
+class manifest;
 class relationship;
 class rich_text;
+class streaming_sheet_writer;
 class streaming_workbook_writer;
 class variant;
 class workbook;
@@ -60,8 +79,12 @@ class worksheet;
 
 namespace detail {
 
+struct encryption_key_impl;
+class izstream;
 class ozstream;
 struct cell_impl;
+class sheet_data_writer;
+struct zmembers;
 struct worksheet_impl;
 
 /// <summary>
@@ -72,6 +95,8 @@ class xlsx_producer
 public:
 	xlsx_producer(const workbook &target);
 
+    xlsx_producer(const workbook &target, const save_options &options);
+
     ~xlsx_producer();
 
 	void write(std::ostream &destination);
@@ -82,30 +107,175 @@ public:
     void write(std::ostream &destination, std::u8string_view password);
 #endif
 
+    void write(std::ostream &destination, const encryption_key &key);
+
+    /// <summary>
+    /// Returns the row elements of every cell of ws deflated into a fragment, with strings
+    /// written inline, see deflated_fragment::from_sheet_data.
+    /// </summary>
+    deflated_fragment write_sheet_data_fragment(worksheet ws, compression_level level);
+
 private:
+    friend class xlnt::streaming_sheet_writer;
     friend class xlnt::streaming_workbook_writer;
 
     void open(std::ostream &destination);
 
-    template <typename T>
-    void write_internal(std::ostream &destination, const T &password);
-
+    /// <summary>
+    /// Writes the package encrypted with password to destination, deriving the key
+    /// with the hashes in derived_keys unless it's null.
+    /// </summary>
+    void write_encrypted(std::ostream &destination, const std::u16string &password,
+        std::shared_ptr<encryption_key_impl> derived_keys);
+
+    /// <summary>
+    /// Writes the cell returned by the previous call, then returns a cell at ref for the
+    /// caller to fill in. Ends the current row when ref is below it and throws
+    /// invalid_parameter when ref isn't to the right of or below the previous cell.
+    /// </summary>
     cell add_cell(const cell_reference &ref);
 
+    /// <summary>
+    /// Returns a cell at ref with cell_format as add_cell(ref) does, without counting the
+    /// cell as a reference to cell_format, which doesn't matter once formats aren't
+    /// collected anymore.
+    /// </summary>
+    cell add_cell(const cell_reference &ref, const format &cell_format);
+
+    /// <summary>
+    /// Returns a cell at ref with the format whose id is format_id as add_cell(ref, format)
+    /// does. Throws invalid_parameter before anything is written if there is no such format.
+    /// </summary>
+    cell add_cell(const cell_reference &ref, std::size_t format_id);
+
+    /// <summary>
+    /// Returns the id cells with cell_format are written with. Throws invalid_parameter if
+    /// cell_format isn't a format of the workbook being written.
+    /// </summary>
+    std::size_t format_id(const format &cell_format) const;
+
+    /// <summary>
+    /// Writes the pending cell and ends the current row, if any. The next cell must be below it.
+    /// </summary>
+    void end_row();
+
+    /// <summary>
+    /// Ends the current row and starts the row below it, spanning column_count columns, for
+    /// the typed cells of streaming_workbook_writer::write_row. Throws invalid_parameter if
+    /// the row doesn't fit into the worksheet.
+    /// </summary>
+    void begin_typed_row(std::size_t column_count);
+
+    /// <summary>
+    /// Writes a cell with value in column of the row started by begin_typed_row.
+    /// </summary>
+    void write_typed_cell(column_t::index_t column, std::int64_t value);
+    void write_typed_cell(column_t::index_t column, double value);
+    void write_typed_cell(column_t::index_t column, bool value);
+    void write_typed_cell(column_t::index_t column, const std::string &value);
+    void write_typed_cell(column_t::index_t column, const date &value);
+    void write_typed_cell(column_t::index_t column, const datetime &value);
+
+    /// <summary>
+    /// Ends the current row and writes row_count rows below it from the buffers of
+    /// columns, see streaming_workbook_writer::append_rows.
+    /// </summary>
+    void append_rows(std::size_t row_count, const std::vector<column_view> &columns);
+
+    /// <summary>
+    /// Returns the row below the last one which has been streamed to the current worksheet.
+    /// </summary>
+    row_t next_row() const;
+
+    /// <summary>
+    /// Finishes the worksheet being streamed and starts the next one with the given title.
+    /// The worksheet part is only begun with its first cell, so that properties written
+    /// before sheetData can still be set on the returned worksheet.
+    /// </summary>
     worksheet add_worksheet(const std::string &title);
 
+    /// <summary>
+    /// Creates a worksheet with the given title and returns a producer of its own which
+    /// streams it into memory, so that it can be written on another thread, see
+    /// streaming_sheet_writer. The worksheet is added to the archive by close.
+    /// </summary>
+    xlsx_producer &open_concurrent_worksheet(const std::string &title);
+
+    /// <summary>
+    /// Finishes the worksheet of a producer returned by open_concurrent_worksheet and
+    /// releases the headers of its members. Does nothing once it has been finished.
+    /// </summary>
+    void finish_concurrent_worksheet();
+
+    /// <summary>
+    /// Returns the worksheet streamed by a producer returned by open_concurrent_worksheet.
+    /// </summary>
+    worksheet concurrent_worksheet() const;
+
+    /// <summary>
+    /// Returns the worksheet to stream next with the given title: the first worksheet of
+    /// the workbook if none has been streamed yet, otherwise a new one.
+    /// </summary>
+    worksheet next_streamed_worksheet(const std::string &title);
+
+    /// <summary>
+    /// Finishes the worksheet being streamed and writes the rest of the workbook, which
+    /// for a streamed workbook is only known once every worksheet has been written.
+    /// </summary>
+    void close();
+
+    /// <summary>
+    /// Writes the cell returned by the last call to add_cell, unless it has already been written.
+    /// </summary>
+    void write_streaming_cell();
+
+    /// <summary>
+    /// Begins the part of the worksheet being streamed and writes everything before its rows.
+    /// </summary>
+    void begin_streaming_worksheet();
+
+    /// <summary>
+    /// Writes everything after the rows of the worksheet being streamed.
+    /// </summary>
+    void end_streaming_worksheet();
+
 	/// <summary>
 	/// Write all files needed to create a valid XLSX file which represents all
 	/// data contained in workbook.
 	/// </summary>
 	void populate_archive(bool streaming);
 
+    /// <summary>
+    /// Writes the workbook as an XLSB package with xlsb_producer, which writes the
+    /// binary parts, followed by its content types, relationships and document properties.
+    /// </summary>
+    void populate_binary_archive();
+
+    /// <summary>
+    /// Adds the number of cells, shared strings and formats that were written to
+    /// options_.stats, if it was given.
+    /// </summary>
+    void record_saved_counts();
+
     void begin_part(const path &part);
+
+    /// <summary>
+    /// Begins part in memory instead of in the archive. end_part then adds it to the archive
+    /// with fragments spliced in before its end of sheetData.
+    /// </summary>
+    void begin_part(const path &part, const std::vector<deflated_fragment> &fragments);
+
     void end_part();
 
+    /// <summary>
+    /// Returns the fragments of options_.sheet_data_fragments to be spliced into the worksheet
+    /// rel targets, or nullptr if there are none or rel isn't a worksheet.
+    /// </summary>
+    const std::vector<deflated_fragment> *worksheet_fragments(const relationship &rel) const;
+
 	// Package Parts
 
-	void write_content_types();
+	void write_content_types(const manifest &package);
     void write_property(const std::string &name, const variant &value, const std::string &ns, bool custom, std::size_t pid);
 	void write_core_properties(const relationship &rel);
     void write_extended_properties(const relationship &rel);
@@ -119,6 +289,7 @@ private:
 
 	// Workbook Relationship Target Parts
 
+    void write_calculation_chain(const relationship &rel);
 	void write_connections(const relationship &rel);
 	void write_custom_xml_mappings(const relationship &rel);
 	void write_external_workbook_references(const relationship &rel);
@@ -135,10 +306,74 @@ private:
 	void write_dialogsheet(const relationship &rel);
 	void write_worksheet(const relationship &rel);
 
+    // write_worksheet in parts, so that the streaming writer can write rows in between
+
+    /// <summary>
+    /// Writes the start of ws up to and including the start tag of sheetData.
+    /// </summary>
+    void begin_worksheet(worksheet ws);
+
+    /// <summary>
+    /// Writes the rows of ws, collecting the cells with hyperlinks.
+    /// </summary>
+    void write_sheet_data(worksheet ws, std::vector<std::pair<std::string, hyperlink>> &hyperlinks);
+
+    /// <summary>
+    /// Writes the rest of ws from the end tag of sheetData, followed by its relationships
+    /// and the parts they refer to.
+    /// </summary>
+    void end_worksheet(const relationship &rel, worksheet ws,
+        const std::vector<std::pair<std::string, hyperlink>> &hyperlinks);
+
+    /// <summary>
+    /// Writes the start tag of a row with its properties, leaving it open. The spans
+    /// attribute is only written when first_span_column isn't after last_span_column.
+    /// </summary>
+    void write_row_start(detail::sheet_data_writer &sheet_data, worksheet ws, row_t row,
+        column_t first_span_column, column_t last_span_column);
+
+    /// <summary>
+    /// Writes the start tag of a cell with its attributes.
+    /// </summary>
+    void write_cell_start(detail::sheet_data_writer &sheet_data, const cell &cell);
+
+    /// <summary>
+    /// Writes the value element of a cell, counting shared strings in shared_string_cells.
+    /// </summary>
+    void write_cell_value(detail::sheet_data_writer &sheet_data, const cell &cell,
+        std::size_t &shared_string_cells);
+
+    /// <summary>
+    /// Serializes and compresses the worksheets of worksheet_rels, together with their
+    /// child parts, on options_.worksheet_threads threads. Each worksheet is written to
+    /// its own in-memory archive. The results are returned in the order of worksheet_rels.
+    /// </summary>
+    std::vector<zmembers> write_worksheets_concurrently(const std::vector<relationship> &worksheet_rels);
+
+    /// <summary>
+    /// Finds the worksheets which save_options::preserve_unchanged_parts allows to be
+    /// copied from the archive they were loaded from, together with the parts to copy
+    /// for each of them.
+    /// </summary>
+    void select_copied_worksheets();
+
+    /// <summary>
+    /// Copies the compressed parts of the worksheet with the given relationship id, and
+    /// their relationships, from the archive it was loaded from.
+    /// </summary>
+    void copy_worksheet(const std::string &rel_id);
+
+    /// <summary>
+    /// Returns the cells to list in the calculation chain: the formulas in the order of the
+    /// last workbook::calculate if there was one, otherwise in the order of the chain read
+    /// from the loaded file, followed by the formulas missing from that order.
+    /// </summary>
+    std::vector<calculation_chain_entry> calculation_chain() const;
+
 	// Sheet Relationship Target Parts
 
-	void write_comments(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells);
-    void write_vml_drawings(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells);
+	void write_comments(const relationship &rel, worksheet ws);
+    void write_vml_drawings(const relationship &rel, worksheet ws);
     void write_drawings(const relationship &rel, worksheet ws);
 
 	// Other Parts
@@ -165,6 +400,12 @@ private:
     void write_colors(const std::vector<xlnt::color> &colors);
     void write_rich_text(const std::string &ns, const xlnt::rich_text &text);
 
+    /// <summary>
+    /// Writes text as element containing a t element through writer if it is a single
+    /// unformatted run without phonetic runs, and returns false without writing otherwise.
+    /// </summary>
+    bool write_plain_text(detail::sheet_data_writer &writer, const rich_text &text, const char *element = "si");
+
     template<typename T>
     void write_element(const std::string &ns, const std::string &name, T value, bool preserve_whitespace = false)
     {
@@ -240,18 +481,127 @@ private:
 	/// </summary>
 	const workbook &source_;
 
+	save_options options_;
+
+	/// <summary>
+	/// Reports the cells written to options_.progress, if it is set. It is shared with
+	/// the producers writing worksheets concurrently.
+	/// </summary>
+	std::shared_ptr<progress_reporter> progress_;
+
 	std::unique_ptr<ozstream> archive_;
     std::unique_ptr<xml::serializer> current_part_serializer_;
     std::unique_ptr<std::streambuf> current_part_streambuf_;
     std::ostream current_part_stream_;
 
+    /// <summary>
+    /// The part begun with fragments to splice into it, as it is written, and its fragments
+    /// or nullptr while no such part is being written.
+    /// </summary>
+    path spliced_part_;
+    std::vector<std::uint8_t> spliced_part_xml_;
+    const std::vector<deflated_fragment> *spliced_fragments_ = nullptr;
+
+    /// <summary>
+    /// True while rows are written for write_sheet_data_fragment: strings are written
+    /// inline instead of as indices into the shared strings.
+    /// </summary>
+    bool writing_fragment_ = false;
+
     bool streaming_ = false;
 
+    /// <summary>
+    /// The cell returned by add_cell, reused for every streamed cell.
+    /// </summary>
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
-    detail::cell_impl *current_cell_ = nullptr;
+    /// <summary>
+    /// True while streaming_cell_ holds a cell which hasn't been written.
+    /// </summary>
+    bool streaming_cell_pending_ = false;
 
+    /// <summary>
+    /// The worksheet being streamed, or null before the first one.
+    /// </summary>
     detail::worksheet_impl *current_worksheet_ = nullptr;
+
+    /// <summary>
+    /// Writes the rows of the worksheet being streamed once its part has been begun.
+    /// </summary>
+    std::unique_ptr<detail::sheet_data_writer> streaming_sheet_data_;
+
+    /// <summary>
+    /// The last row streamed to the current worksheet, and whether it is still open.
+    /// </summary>
+    row_t streaming_row_ = 0;
+    bool streaming_row_open_ = false;
+
+    /// <summary>
+    /// The column of the last cell streamed to the open row.
+    /// </summary>
+    column_t::index_t streaming_column_ = 0;
+
+    /// <summary>
+    /// The ids of the formats given to the date and datetime cells of typed rows, created
+    /// for the first such cell.
+    /// </summary>
+    optional<std::size_t> typed_date_format_;
+    optional<std::size_t> typed_datetime_format_;
+
+    /// <summary>
+    /// The relationship ids of the worksheets which have already been streamed.
+    /// </summary>
+    std::unordered_set<std::string> streamed_worksheets_;
+
+    /// <summary>
+    /// The formula cells of the worksheets which have already been streamed.
+    /// </summary>
+    std::vector<calculation_chain_entry> streamed_formulas_;
+
+    /// <summary>
+    /// The producers returned by open_concurrent_worksheet, in the order their worksheets
+    /// are added to the archive.
+    /// </summary>
+    std::vector<std::unique_ptr<xlsx_producer>> concurrent_producers_;
+
+    /// <summary>
+    /// For a producer returned by open_concurrent_worksheet, its worksheet and the members
+    /// it compresses into memory through concurrent_stream_.
+    /// </summary>
+    detail::worksheet_impl *concurrent_worksheet_ = nullptr;
+    std::unique_ptr<zmembers> concurrent_members_;
+    std::unique_ptr<std::streambuf> concurrent_streambuf_;
+    std::unique_ptr<std::ostream> concurrent_stream_;
+
+    /// <summary>
+    /// The worksheets copied from the archive they were loaded from, and the parts
+    /// copied for each of them by relationship id.
+    /// </summary>
+    std::unordered_set<const detail::worksheet_impl *> copied_worksheets_;
+    std::unordered_map<std::string, std::pair<std::shared_ptr<izstream>, std::vector<path>>> copied_worksheet_parts_;
+
+    /// <summary>
+    /// The number of shared string cells in each worksheet written so far, used for
+    /// the count attribute of the shared string table.
+    /// </summary>
+    std::unordered_map<const detail::worksheet_impl *, std::size_t> shared_string_cells_;
+
+    /// <summary>
+    /// The header_footers written so far with their codes, reused by later worksheets.
+    /// </summary>
+    detail::encoded_header_footers encoded_header_footers_;
+
+    /// <summary>
+    /// The paths of the images written so far, shared with the producers writing worksheets
+    /// concurrently, so that an image several drawings refer to is only written once.
+    /// </summary>
+    struct written_images
+    {
+        std::mutex mutex;
+        std::unordered_set<std::string> paths;
+    };
+
+    std::shared_ptr<written_images> written_images_ = std::make_shared<written_images>();
 };
 
 } // namespace detail
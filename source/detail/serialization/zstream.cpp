@@ -36,15 +36,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <iterator> // for std::back_inserter
+#include <limits>
 #include <string>
-#include <miniz.h>
 
 #include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/deflate_codec.hpp>
+#include <detail/serialization/load_buffers.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/zstream.hpp>
+#include <detail/utils/io_stats_recorder.hpp>
+#include <detail/utils/trace.hpp>
 
 namespace {
 
@@ -63,6 +68,62 @@ void write_int(std::ostream &stream, T value)
     stream.write(reinterpret_cast<char *>(&value), sizeof(T));
 }
 
+// Sizes, offsets and counts at or above these are stored in zip64 records instead.
+const std::uint32_t zip64_limit = 0xffffffff;
+const std::uint16_t zip64_count_limit = 0xffff;
+
+// The version needed to extract an archive which uses zip64 records.
+const std::uint16_t zip64_version = 45;
+
+const std::uint16_t zip64_extra_tag = 0x0001;
+
+// Replaces each field of header which was saturated in the central header with its value
+// from the zip64 extra field. The values only appear for saturated fields, in this order.
+void read_zip64_extra(xlnt::detail::zheader &header, bool compressed_saturated, bool uncompressed_saturated,
+    bool offset_saturated)
+{
+    std::size_t position = 0;
+
+    while (position + 4 <= header.extra.size())
+    {
+        const auto tag = static_cast<std::uint16_t>(header.extra[position] | (header.extra[position + 1] << 8));
+        const auto size = static_cast<std::size_t>(header.extra[position + 2] | (header.extra[position + 3] << 8));
+        position += 4;
+
+        if (tag != zip64_extra_tag)
+        {
+            position += size;
+            continue;
+        }
+
+        const auto end = std::min(position + size, header.extra.size());
+
+        auto read_value = [&](std::uint64_t &value) {
+            if (position + 8 > end)
+            {
+                throw xlnt::exception("truncated zip64 extra field");
+            }
+
+            value = 0;
+
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+                value |= static_cast<std::uint64_t>(header.extra[position + i]) << (8 * i);
+            }
+
+            position += 8;
+        };
+
+        if (uncompressed_saturated) read_value(header.uncompressed_size);
+        if (compressed_saturated) read_value(header.compressed_size);
+        if (offset_saturated) read_value(header.header_offset);
+
+        return;
+    }
+
+    throw xlnt::exception("missing zip64 extra field");
+}
+
 xlnt::detail::zheader read_header(std::istream &istream, const bool global)
 {
     xlnt::detail::zheader header;
@@ -93,6 +154,8 @@ xlnt::detail::zheader read_header(std::istream &istream, const bool global)
     header.crc = read_int<std::uint32_t>(istream);
     header.compressed_size = read_int<std::uint32_t>(istream);
     header.uncompressed_size = read_int<std::uint32_t>(istream);
+    const auto compressed_saturated = header.compressed_size == zip64_limit;
+    const auto uncompressed_saturated = header.uncompressed_size == zip64_limit;
 
     auto filename_length = read_int<std::uint16_t>(istream);
     auto extra_length = read_int<std::uint16_t>(istream);
@@ -118,46 +181,125 @@ xlnt::detail::zheader read_header(std::istream &istream, const bool global)
     {
         header.comment.resize(comment_length, '\0');
         istream.read(&header.comment[0], comment_length);
+
+        const auto offset_saturated = header.header_offset == zip64_limit;
+
+        if (compressed_saturated || uncompressed_saturated || offset_saturated)
+        {
+            read_zip64_extra(header, compressed_saturated, uncompressed_saturated, offset_saturated);
+        }
     }
 
     return header;
 }
 
-void write_header(const xlnt::detail::zheader &header, std::ostream &ostream, const bool global)
+// Writes the local header of a file whose sizes and checksum follow its data in a data descriptor.
+void write_local_header(const xlnt::detail::zheader &header, std::ostream &ostream)
 {
-    if (global)
+    write_int(ostream, static_cast<std::uint32_t>(0x04034b50));
+    write_int(ostream, header.version);
+    write_int(ostream, header.flags);
+    write_int(ostream, header.compression_type);
+    write_int(ostream, header.stamp_date);
+    write_int(ostream, header.stamp_time);
+    write_int(ostream, static_cast<std::uint32_t>(0)); // crc, in the data descriptor
+    write_int(ostream, static_cast<std::uint32_t>(0)); // compressed size, in the data descriptor
+    write_int(ostream, static_cast<std::uint32_t>(0)); // uncompressed size, in the data descriptor
+    write_int(ostream, static_cast<std::uint16_t>(header.filename.length()));
+    write_int(ostream, static_cast<std::uint16_t>(0)); // extra length
+    ostream.write(header.filename.data(), static_cast<std::streamsize>(header.filename.length()));
+}
+
+// Writes the data descriptor which follows the data of the file described by header.
+// The sizes take eight bytes each if either is too large for four.
+void write_data_descriptor(const xlnt::detail::zheader &header, std::ostream &ostream)
+{
+    write_int(ostream, static_cast<std::uint32_t>(0x08074b50));
+    write_int(ostream, header.crc);
+
+    if (header.compressed_size >= zip64_limit || header.uncompressed_size >= zip64_limit)
     {
-        write_int(ostream, static_cast<std::uint32_t>(0x02014b50)); // header sig
-        write_int(ostream, static_cast<std::uint16_t>(20)); // version made by
+        write_int(ostream, header.compressed_size);
+        write_int(ostream, header.uncompressed_size);
     }
     else
     {
-        write_int(ostream, static_cast<std::uint32_t>(0x04034b50));
+        write_int(ostream, static_cast<std::uint32_t>(header.compressed_size));
+        write_int(ostream, static_cast<std::uint32_t>(header.uncompressed_size));
     }
+}
 
-    write_int(ostream, header.version);
+void write_central_header(const xlnt::detail::zheader &header, std::ostream &ostream)
+{
+    const auto compressed_saturated = header.compressed_size >= zip64_limit;
+    const auto uncompressed_saturated = header.uncompressed_size >= zip64_limit;
+    const auto offset_saturated = header.header_offset >= zip64_limit;
+    const auto zip64_values = static_cast<std::uint16_t>(
+        (compressed_saturated ? 1 : 0) + (uncompressed_saturated ? 1 : 0) + (offset_saturated ? 1 : 0));
+    const auto version = zip64_values > 0 ? std::max(header.version, zip64_version) : header.version;
+
+    auto saturate = [](std::uint64_t value) {
+        return static_cast<std::uint32_t>(std::min<std::uint64_t>(value, zip64_limit));
+    };
+
+    write_int(ostream, static_cast<std::uint32_t>(0x02014b50)); // header sig
+    write_int(ostream, version); // version made by
+    write_int(ostream, version);
     write_int(ostream, header.flags);
     write_int(ostream, header.compression_type);
     write_int(ostream, header.stamp_date);
     write_int(ostream, header.stamp_time);
     write_int(ostream, header.crc);
-    write_int(ostream, header.compressed_size);
-    write_int(ostream, header.uncompressed_size);
+    write_int(ostream, saturate(header.compressed_size));
+    write_int(ostream, saturate(header.uncompressed_size));
     write_int(ostream, static_cast<std::uint16_t>(header.filename.length()));
-    write_int(ostream, static_cast<std::uint16_t>(0)); // extra lengthx
+    write_int(ostream, static_cast<std::uint16_t>(zip64_values > 0 ? 4 + 8 * zip64_values : 0)); // extra length
+    write_int(ostream, static_cast<std::uint16_t>(0)); // filecomment
+    write_int(ostream, static_cast<std::uint16_t>(0)); // disk# start
+    write_int(ostream, static_cast<std::uint16_t>(0)); // internal file
+    write_int(ostream, static_cast<std::uint32_t>(0)); // ext final
+    write_int(ostream, saturate(header.header_offset)); // rel offset
+    ostream.write(header.filename.data(), static_cast<std::streamsize>(header.filename.length()));
+
+    if (zip64_values > 0)
+    {
+        write_int(ostream, zip64_extra_tag);
+        write_int(ostream, static_cast<std::uint16_t>(8 * zip64_values));
+        if (uncompressed_saturated) write_int(ostream, header.uncompressed_size);
+        if (compressed_saturated) write_int(ostream, header.compressed_size);
+        if (offset_saturated) write_int(ostream, header.header_offset);
+    }
+}
 
-    if (global)
+// Inflates the header.compressed_size bytes of the deflated member at member into
+// the header.uncompressed_size bytes at destination with a single call to inflate_stream,
+// which must be at the start of a stream.
+void inflate_member(const xlnt::detail::zheader &header, const std::uint8_t *member, std::uint8_t *destination,
+    xlnt::detail::inflater &inflate_stream)
+{
+    auto next_in = member;
+    auto avail_in = static_cast<std::size_t>(header.compressed_size);
+    // the inflater needs somewhere to write even when the member is empty
+    std::uint8_t empty = 0;
+    auto next_out = header.uncompressed_size == 0 ? &empty : destination;
+    auto avail_out = static_cast<std::size_t>(header.uncompressed_size);
+    auto inflated_all = false;
+
+    while (!inflated_all)
     {
-        write_int(ostream, static_cast<std::uint16_t>(0)); // filecomment
-        write_int(ostream, static_cast<std::uint16_t>(0)); // disk# start
-        write_int(ostream, static_cast<std::uint16_t>(0)); // internal file
-        write_int(ostream, static_cast<std::uint32_t>(0)); // ext final
-        write_int(ostream, static_cast<std::uint32_t>(header.header_offset)); // rel offset
+        const auto avail_in_before = avail_in;
+        const auto avail_out_before = avail_out;
+        inflated_all = inflate_stream.process(next_in, avail_in, next_out, avail_out);
+
+        if (!inflated_all && avail_in == avail_in_before && avail_out == avail_out_before)
+        {
+            throw xlnt::exception("couldn't inflate ZIP, member doesn't match its recorded size");
+        }
     }
 
-    for (auto c : header.filename)
+    if (avail_out != 0)
     {
-        write_int(ostream, c);
+        throw xlnt::exception("couldn't inflate ZIP, member doesn't match its recorded size");
     }
 }
 
@@ -168,41 +310,134 @@ namespace detail {
 
 static const std::size_t buffer_size = 512;
 
+/// <summary>
+/// The smallest buffer zip_streambuf_decompress accepts; it must leave room
+/// for the four put-back characters.
+/// </summary>
+static const std::size_t min_buffer_size = 512;
+
 class zip_streambuf_decompress : public std::streambuf
 {
-    std::istream &istream;
-
-    z_stream strm;
-    std::array<char, buffer_size> in;
-    std::array<char, buffer_size> out;
+    std::istream *istream;
+    const char *memory_in;
+
+    std::unique_ptr<inflater> inflate_stream;
+    const std::uint8_t *next_in = nullptr;
+    std::size_t avail_in = 0;
+    bool inflated_all = false;
+    std::size_t io_buffer_size;
+    std::vector<char> in;
+    std::vector<char> out;
     zheader header;
-    std::size_t total_read;
-    std::size_t total_uncompressed;
+    std::uint64_t total_read;
+    std::uint64_t total_uncompressed;
     bool valid;
     bool compressed_data;
+    io_stats *stats = nullptr;
+    double seconds = 0.0;
+    std::uint64_t max_size = 0;
+    std::shared_ptr<load_buffers> buffers;
 
     static const unsigned short DEFLATE = 8;
     static const unsigned short UNCOMPRESSED = 0;
 
 public:
-    zip_streambuf_decompress(std::istream &stream, zheader central_header)
-        : istream(stream), header(central_header), total_read(0), total_uncompressed(0), valid(true)
+    /// <summary>
+    /// Constructs a streambuf which inflates the member at the current position of stream.
+    /// The buffers and the inflater are taken from reused and given back to it when this
+    /// is destroyed, unless it is nullptr.
+    /// </summary>
+    zip_streambuf_decompress(std::istream &stream, zheader central_header,
+        std::size_t decompress_buffer_size = izstream::default_buffer_size,
+        std::shared_ptr<load_buffers> reused = nullptr)
+        : istream(&stream),
+          memory_in(nullptr),
+          io_buffer_size(std::max(decompress_buffer_size, min_buffer_size)),
+          in(reused ? reused->take_chars(io_buffer_size) : std::vector<char>(io_buffer_size, 0)),
+          out(reused ? reused->take_chars(io_buffer_size) : std::vector<char>(io_buffer_size, 0)),
+          header(central_header),
+          total_read(0),
+          total_uncompressed(0),
+          valid(true),
+          buffers(std::move(reused))
+    {
+        // skip the header
+        read_header(*istream, false);
+        header = central_header;
+
+        initialize();
+    }
+
+    /// <summary>
+    /// Constructs a streambuf which inflates header.compressed_size bytes starting at
+    /// member_data, the first byte after the local header, without copying them.
+    /// </summary>
+    zip_streambuf_decompress(const char *member_data, zheader central_header,
+        std::size_t decompress_buffer_size = izstream::default_buffer_size,
+        std::shared_ptr<load_buffers> reused = nullptr)
+        : istream(nullptr),
+          memory_in(member_data),
+          io_buffer_size(std::max(decompress_buffer_size, min_buffer_size)),
+          out(reused ? reused->take_chars(io_buffer_size) : std::vector<char>(io_buffer_size, 0)),
+          header(central_header),
+          total_read(0),
+          total_uncompressed(0),
+          valid(true),
+          buffers(std::move(reused))
+    {
+        initialize();
+    }
+
+    ~zip_streambuf_decompress() override
+    {
+        record_part(stats, &io_stats::inflate, header.filename, seconds,
+            compressed_data ? total_uncompressed : total_read);
+
+        if (buffers)
+        {
+            buffers->give_back(std::move(inflate_stream));
+            buffers->give_back(std::move(in));
+            buffers->give_back(std::move(out));
+        }
+    }
+
+    /// <summary>
+    /// Records the time spent decompressing the member in stats when this is destroyed.
+    /// </summary>
+    void record_to(io_stats *recorded)
+    {
+        stats = recorded;
+    }
+
+    /// <summary>
+    /// Throws limit_exceeded once more than size bytes have been inflated, unless size is 0.
+    /// </summary>
+    void limit_to(std::uint64_t size)
+    {
+        max_size = size;
+    }
+
+    /// <summary>
+    /// Continues from checkpoint instead of the start of the member: inflating from a copy
+    /// of its state if it has one, otherwise reading a stored member from its offset.
+    /// A source stream must already be positioned at the checkpoint's compressed offset.
+    /// </summary>
+    void resume(const zcheckpoint &checkpoint)
     {
-        in.fill(0);
-        out.fill(0);
+        if (checkpoint.state)
+        {
+            inflate_stream = checkpoint.state->clone();
+        }
 
-        strm.zalloc = nullptr;
-        strm.zfree = nullptr;
-        strm.opaque = nullptr;
-        strm.avail_in = 0;
-        strm.next_in = nullptr;
+        total_read = checkpoint.compressed_offset;
+        total_uncompressed = checkpoint.uncompressed_offset;
+    }
 
+    void initialize()
+    {
         setg(in.data(), in.data(), in.data());
         setp(nullptr, nullptr);
 
-        // skip the header
-        read_header(istream, false);
-
         if (header.compression_type == DEFLATE)
         {
             compressed_data = true;
@@ -217,72 +452,91 @@ public:
             throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
         }
 
-        // initialize the inflate
         if (compressed_data && valid)
         {
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wold-style-cast"
-            int result = inflateInit2(&strm, -MAX_WBITS);
-#pragma clang diagnostic pop
-
-            if (result != Z_OK)
-            {
-                throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
-            }
+            inflate_stream = buffers ? buffers->take_inflater() : make_inflater();
         }
-
-        header = central_header;
     }
 
-    ~zip_streambuf_decompress() override
+    int process()
     {
-        if (compressed_data && valid)
+        if (stats == nullptr)
         {
-            inflateEnd(&strm);
+            return process_uninstrumented();
         }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = process_uninstrumented();
+        seconds += phase_timer::seconds_since(start);
+
+        return result;
     }
 
-    int process()
+    int process_uninstrumented()
     {
         if (!valid) return -1;
 
         if (compressed_data)
         {
-            strm.avail_out = buffer_size - 4;
-            strm.next_out = reinterpret_cast<Bytef *>(out.data() + 4);
+            auto next_out = reinterpret_cast<std::uint8_t *>(out.data() + 4);
+            auto avail_out = io_buffer_size - 4;
 
-            while (strm.avail_out != 0)
+            while (avail_out != 0 && !inflated_all)
             {
-                if (strm.avail_in == 0)
+                if (avail_in == 0 && memory_in != nullptr)
+                {
+                    // inflate straight from the mapped member
+                    next_in = reinterpret_cast<const std::uint8_t *>(memory_in + static_cast<std::size_t>(total_read));
+                    avail_in = static_cast<std::size_t>(header.compressed_size - total_read);
+                    total_read = header.compressed_size;
+                }
+                else if (avail_in == 0)
                 {
                     // buffer empty, read some more from file
-                    istream.read(in.data(),
-                        static_cast<std::streamsize>(std::min(buffer_size, header.compressed_size - total_read)));
-                    strm.avail_in = static_cast<unsigned int>(istream.gcount());
-                    total_read += strm.avail_in;
-                    strm.next_in = reinterpret_cast<Bytef *>(in.data());
+                    istream->read(in.data(), static_cast<std::streamsize>(
+                        std::min<std::uint64_t>(io_buffer_size, header.compressed_size - total_read)));
+                    avail_in = static_cast<std::size_t>(istream->gcount());
+                    total_read += avail_in;
+                    next_in = reinterpret_cast<const std::uint8_t *>(in.data());
                 }
 
-                const auto ret = inflate(&strm, Z_NO_FLUSH); // decompress
+                const auto had_input = avail_in != 0;
+                const auto avail_out_before = avail_out;
+                inflated_all = inflate_stream->process(next_in, avail_in, next_out, avail_out);
 
-                if (ret == Z_STREAM_ERROR || ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR)
+                if (!inflated_all && !had_input && avail_out == avail_out_before)
                 {
-                    throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+                    throw xlnt::exception("couldn't inflate ZIP, member is truncated");
                 }
-
-                if (ret == Z_STREAM_END) break;
             }
 
-            auto unzip_count = buffer_size - strm.avail_out - 4;
+            auto unzip_count = io_buffer_size - avail_out - 4;
             total_uncompressed += unzip_count;
+
+            // the recorded size has been checked already, but a crafted member can inflate to more
+            if (max_size != 0 && total_uncompressed > max_size)
+            {
+                valid = false;
+                throw xlnt::limit_exceeded("part " + header.filename + " inflates to more than the limit of "
+                    + std::to_string(max_size) + " bytes (load_options::max_part_size)");
+            }
             return static_cast<int>(unzip_count);
         }
 
         // uncompressed, so just read
-        istream.read(out.data() + 4,
-            static_cast<std::streamsize>(std::min(buffer_size - 4, header.uncompressed_size - total_read)));
-        auto count = istream.gcount();
-        total_read += static_cast<std::size_t>(count);
+        const auto wanted = static_cast<std::size_t>(
+            std::min<std::uint64_t>(io_buffer_size - 4, header.uncompressed_size - total_read));
+
+        if (memory_in != nullptr)
+        {
+            std::memcpy(out.data() + 4, memory_in + static_cast<std::size_t>(total_read), wanted);
+            total_read += wanted;
+            return static_cast<int>(wanted);
+        }
+
+        istream->read(out.data() + 4, static_cast<std::streamsize>(wanted));
+        auto count = istream->gcount();
+        total_read += static_cast<std::uint64_t>(count);
         return static_cast<int>(count);
     }
 
@@ -308,48 +562,174 @@ int zip_streambuf_decompress::overflow(int)
     throw xlnt::exception("writing to read-only buffer");
 }
 
+/// <summary>
+/// Owns a private copy of one compressed archive member so that it can be
+/// decompressed without touching the archive's shared source stream.
+/// </summary>
+struct detached_member
+{
+    explicit detached_member(std::vector<std::uint8_t> &&member_bytes)
+        : bytes(std::move(member_bytes)),
+          buffer(bytes),
+          stream(&buffer)
+    {
+    }
+
+    std::vector<std::uint8_t> bytes;
+    xlnt::detail::vector_istreambuf buffer;
+    std::istream stream;
+};
+
+class zip_streambuf_decompress_detached : private detached_member, public zip_streambuf_decompress
+{
+public:
+    zip_streambuf_decompress_detached(std::vector<std::uint8_t> &&member_bytes, zheader central_header,
+        std::size_t decompress_buffer_size, std::shared_ptr<load_buffers> reused)
+        : detached_member(std::move(member_bytes)),
+          zip_streambuf_decompress(detached_member::stream, central_header, decompress_buffer_size, std::move(reused))
+    {
+    }
+};
+
+/// <summary>
+/// Owns the buffer an archive member is inflated into by izstream::read_whole, which is
+/// taken from and given back to buffers unless that is nullptr.
+/// </summary>
+struct inflated_member
+{
+    inflated_member(std::size_t size, std::shared_ptr<load_buffers> reused)
+        : bytes(reused ? reused->take_bytes(size) : std::vector<std::uint8_t>(size)),
+          buffers(std::move(reused))
+    {
+    }
+
+    ~inflated_member()
+    {
+        if (buffers)
+        {
+            buffers->give_back(std::move(bytes));
+        }
+    }
+
+    std::vector<std::uint8_t> bytes;
+    std::shared_ptr<load_buffers> buffers;
+};
+
+class inflated_member_streambuf : private inflated_member, public memory_istreambuf
+{
+public:
+    inflated_member_streambuf(std::size_t size, std::shared_ptr<load_buffers> reused)
+        : inflated_member(size, std::move(reused)),
+          memory_istreambuf(inflated_member::bytes.data(), size)
+    {
+    }
+
+    std::uint8_t *destination()
+    {
+        return inflated_member::bytes.data();
+    }
+};
+
+/// <summary>
+/// Passes everything written to it on to another stream and counts the bytes,
+/// which gives the position in the destination even if it can't be seeked.
+/// </summary>
+class counting_ostreambuf : public std::streambuf
+{
+public:
+    explicit counting_ostreambuf(std::ostream &destination)
+        : destination_(destination)
+    {
+    }
+
+    std::uint64_t count() const
+    {
+        return count_;
+    }
+
+protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        destination_.write(s, n);
+
+        if (!destination_)
+        {
+            return 0;
+        }
+
+        count_ += static_cast<std::uint64_t>(n);
+        return n;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            return traits_type::not_eof(c);
+        }
+
+        const auto character = traits_type::to_char_type(c);
+        return xsputn(&character, 1) == 1 ? c : traits_type::eof();
+    }
+
+    int sync() override
+    {
+        destination_.flush();
+        return destination_ ? 0 : -1;
+    }
+
+private:
+    std::ostream &destination_;
+    std::uint64_t count_ = 0;
+};
+
 class zip_streambuf_compress : public std::streambuf
 {
     std::ostream &ostream; // owned when header==0 (when not part of zip file)
 
-    z_stream strm;
+    std::unique_ptr<deflater> deflate_stream;
     std::array<char, buffer_size> in;
     std::array<char, buffer_size> out;
 
     zheader *header;
-    std::uint32_t uncompressed_size;
+    std::uint64_t uncompressed_size;
     std::uint32_t crc;
 
     bool valid;
+    bool compressed_data;
+    io_stats *stats;
+    double seconds = 0.0;
+
+    static const unsigned short DEFLATE = 8;
+    static const unsigned short UNCOMPRESSED = 0;
+    static const std::uint16_t data_descriptor_flag = 0x0008;
 
 public:
-    zip_streambuf_compress(zheader *central_header, std::ostream &stream)
-        : ostream(stream), header(central_header), valid(true)
+    zip_streambuf_compress(zheader *central_header, std::ostream &stream,
+        xlnt::compression_level compression = xlnt::compression_level::standard,
+        io_stats *recorded = nullptr)
+        : ostream(stream), header(central_header), valid(true),
+          compressed_data(compression != xlnt::compression_level::none),
+          stats(recorded)
     {
-        strm.zalloc = nullptr;
-        strm.zfree = nullptr;
-        strm.opaque = nullptr;
-
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wold-style-cast"
-        int ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
-#pragma clang diagnostic pop
+        if (compressed_data)
+        {
+            deflate_stream = make_deflater(compression);
+        }
 
-        if (ret != Z_OK)
+        if (header)
         {
-            std::cerr << "libz: failed to deflateInit" << std::endl;
-            valid = false;
-            return;
+            header->compression_type = compressed_data ? DEFLATE : UNCOMPRESSED;
         }
 
         setg(nullptr, nullptr, nullptr);
         setp(in.data(), in.data() + buffer_size - 4); // we want to be 4 aligned
 
-        // Write appropriate header
+        // the sizes and checksum aren't known yet, so they follow the data in a data descriptor
         if (header)
         {
-            header->header_offset = static_cast<std::uint32_t>(stream.tellp());
-            write_header(*header, ostream, false);
+            header->flags |= data_descriptor_flag;
+            write_local_header(*header, ostream);
         }
 
         uncompressed_size = crc = 0;
@@ -357,23 +737,22 @@ public:
 
     virtual ~zip_streambuf_compress() override
     {
+        XLNT_TRACE_SCOPE_ARG("zip_close_entry", header ? header->filename : std::string());
+
         if (valid)
         {
             process(true);
-            deflateEnd(&strm);
             if (header)
             {
-                auto final_position = ostream.tellp();
                 header->uncompressed_size = uncompressed_size;
                 header->crc = crc;
-                ostream.seekp(header->header_offset);
-                write_header(*header, ostream, false);
-                ostream.seekp(final_position);
+                write_data_descriptor(*header, ostream);
+                record_part(stats, &io_stats::deflate, header->filename, seconds, header->compressed_size);
             }
             else
             {
                 write_int(ostream, crc);
-                write_int(ostream, uncompressed_size);
+                write_int(ostream, static_cast<std::uint32_t>(uncompressed_size));
             }
         }
         if (!header) delete &ostream;
@@ -381,36 +760,61 @@ public:
 
 protected:
     int process(bool flush)
+    {
+        if (stats == nullptr)
+        {
+            return process_uninstrumented(flush);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = process_uninstrumented(flush);
+        seconds += phase_timer::seconds_since(start);
+
+        return result;
+    }
+
+    int process_uninstrumented(bool flush)
     {
         if (!valid) return -1;
 
-        strm.next_in = reinterpret_cast<Bytef *>(pbase());
-        strm.avail_in = static_cast<unsigned int>(pptr() - pbase());
+        auto next_in = reinterpret_cast<const std::uint8_t *>(pbase());
+        auto avail_in = static_cast<std::size_t>(pptr() - pbase());
 
-        while (strm.avail_in != 0 || flush)
+        if (!compressed_data)
         {
-            strm.avail_out = buffer_size;
-            strm.next_out = reinterpret_cast<Bytef *>(out.data());
+            // stored, so the input is written as is
+            ostream.write(pbase(), static_cast<std::streamsize>(avail_in));
+            if (header) header->compressed_size += avail_in;
+            avail_in = 0;
+        }
 
-            int ret = deflate(&strm, flush ? Z_FINISH : Z_NO_FLUSH);
+        auto finished = false;
 
-            if (!(ret != Z_BUF_ERROR && ret != Z_STREAM_ERROR))
+        while (compressed_data && (avail_in != 0 || (flush && !finished)))
+        {
+            auto next_out = reinterpret_cast<std::uint8_t *>(out.data());
+            auto avail_out = out.size();
+
+            try
+            {
+                finished = deflate_stream->process(next_in, avail_in, next_out, avail_out, flush);
+            }
+            catch (const std::exception &e)
             {
                 valid = false;
-                std::cerr << "gzip: gzip error " << strm.msg << std::endl;
+                std::cerr << "deflate: " << e.what() << std::endl;
                 return -1;
             }
 
-            auto generated_output = static_cast<int>(strm.next_out - reinterpret_cast<std::uint8_t *>(out.data()));
-            ostream.write(out.data(), generated_output);
-            if (header) header->compressed_size += static_cast<std::uint32_t>(generated_output);
-            if (ret == Z_STREAM_END) break;
+            const auto generated_output = out.size() - avail_out;
+            ostream.write(out.data(), static_cast<std::streamsize>(generated_output));
+            if (header) header->compressed_size += generated_output;
         }
 
         // update counts, crc's and buffers
-        auto consumed_input = static_cast<std::uint32_t>(pptr() - pbase());
+        auto consumed_input = static_cast<std::size_t>(pptr() - pbase());
         uncompressed_size += consumed_input;
-        crc = static_cast<std::uint32_t>(crc32(crc, reinterpret_cast<Bytef *>(in.data()), consumed_input));
+        crc = update_crc32(crc, reinterpret_cast<const std::uint8_t *>(in.data()), consumed_input);
         setp(pbase(), pbase() + buffer_size - 4);
 
         return 1;
@@ -441,8 +845,12 @@ int zip_streambuf_compress::overflow(int c)
     return c;
 }
 
-ozstream::ozstream(std::ostream &stream)
-    : destination_stream_(stream)
+ozstream::ozstream(std::ostream &stream, compression_level compression, io_stats *stats)
+    : destination_stream_(stream),
+      compression_(compression),
+      stats_(stats),
+      counter_(new counting_ostreambuf(stream)),
+      stream_(counter_.get())
 {
     if (!destination_stream_)
     {
@@ -452,166 +860,1425 @@ ozstream::ozstream(std::ostream &stream)
 
 ozstream::~ozstream()
 {
+    if (released_)
+    {
+        return;
+    }
+
+    XLNT_TRACE_SCOPE("zip_write_central_directory");
+    const auto start = std::chrono::steady_clock::now();
+
     // Write all file headers
-    auto final_position = destination_stream_.tellp();
+    const auto central_start = counter_->count();
 
     for (const auto &header : file_headers_)
     {
-        write_header(header, destination_stream_, true);
+        write_central_header(header, stream_);
     }
 
-    auto central_end = destination_stream_.tellp();
+    const auto central_end = counter_->count();
+    const auto central_size = central_end - central_start;
+    const auto entries = static_cast<std::uint64_t>(file_headers_.size());
+
+    if (entries >= zip64_count_limit || central_size >= zip64_limit || central_start >= zip64_limit)
+    {
+        // zip64 end of central directory record and its locator
+        write_int(stream_, static_cast<std::uint32_t>(0x06064b50));
+        write_int(stream_, static_cast<std::uint64_t>(44)); // size of the rest of the record
+        write_int(stream_, zip64_version); // version made by
+        write_int(stream_, zip64_version); // version needed
+        write_int(stream_, static_cast<std::uint32_t>(0)); // this disk number
+        write_int(stream_, static_cast<std::uint32_t>(0)); // disk with the central directory
+        write_int(stream_, entries); // entries on this disk
+        write_int(stream_, entries); // entries
+        write_int(stream_, central_size);
+        write_int(stream_, central_start);
+
+        write_int(stream_, static_cast<std::uint32_t>(0x07064b50));
+        write_int(stream_, static_cast<std::uint32_t>(0)); // disk with the zip64 record
+        write_int(stream_, central_end); // offset of the zip64 record
+        write_int(stream_, static_cast<std::uint32_t>(1)); // number of disks
+    }
 
     // Write end of central
-    write_int(destination_stream_, static_cast<std::uint32_t>(0x06054b50)); // end of central
-    write_int(destination_stream_, static_cast<std::uint16_t>(0)); // this disk number
-    write_int(destination_stream_, static_cast<std::uint16_t>(0)); // this disk number
-    write_int(destination_stream_, static_cast<std::uint16_t>(file_headers_.size())); // one entry in center in this disk
-    write_int(destination_stream_, static_cast<std::uint16_t>(file_headers_.size())); // one entry in center
-    write_int(destination_stream_, static_cast<std::uint32_t>(central_end - final_position)); // size of header
-    write_int(destination_stream_, static_cast<std::uint32_t>(final_position)); // offset to header
-    write_int(destination_stream_, static_cast<std::uint16_t>(0)); // zip comment
+    write_int(stream_, static_cast<std::uint32_t>(0x06054b50)); // end of central
+    write_int(stream_, static_cast<std::uint16_t>(0)); // this disk number
+    write_int(stream_, static_cast<std::uint16_t>(0)); // this disk number
+    write_int(stream_, static_cast<std::uint16_t>(std::min<std::uint64_t>(entries, zip64_count_limit))); // entries in this disk
+    write_int(stream_, static_cast<std::uint16_t>(std::min<std::uint64_t>(entries, zip64_count_limit))); // entries
+    write_int(stream_, static_cast<std::uint32_t>(std::min<std::uint64_t>(central_size, zip64_limit))); // size of header
+    write_int(stream_, static_cast<std::uint32_t>(std::min<std::uint64_t>(central_start, zip64_limit))); // offset to header
+    write_int(stream_, static_cast<std::uint16_t>(0)); // zip comment
+    stream_.flush();
+
+    record_phase(stats_, &io_stats::archive, phase_timer::seconds_since(start), central_size,
+        file_headers_.size());
 }
 
 std::unique_ptr<std::streambuf> ozstream::open(const path &filename)
 {
+    return open(filename, compression_);
+}
+
+std::unique_ptr<std::streambuf> ozstream::open(const path &filename, compression_level compression)
+{
+    XLNT_TRACE_SCOPE_ARG("zip_open_entry", filename.string());
     zheader header;
     header.filename = filename.string();
+    header.header_offset = counter_->count();
     file_headers_.push_back(header);
-    auto buffer = new zip_streambuf_compress(&file_headers_.back(), destination_stream_);
+    auto buffer = new zip_streambuf_compress(&file_headers_.back(), stream_, compression, stats_);
 
     return std::unique_ptr<zip_streambuf_compress>(buffer);
 }
 
-izstream::izstream(std::istream &stream)
-    : source_stream_(stream)
-{
-    if (!stream)
-    {
-        throw xlnt::exception("Invalid file handle");
-    }
-
-    read_central_header();
-}
-
-izstream::~izstream()
+std::vector<zheader> ozstream::release()
 {
+    released_ = true;
+    return std::move(file_headers_);
 }
 
-bool izstream::read_central_header()
+void ozstream::append(const zmembers &members)
 {
-    // Find the header
-    // NOTE: this assumes the zip file header is the last thing written to file...
-    source_stream_.seekg(0, std::ios_base::end);
-    auto end_position = source_stream_.tellg();
-
-    auto max_comment_size = std::uint32_t(0xffff); // max size of header
-    auto read_size_before_comment = std::uint32_t(22);
+    const auto offset = counter_->count();
+    stream_.write(reinterpret_cast<const char *>(members.bytes.data()),
+        static_cast<std::streamsize>(members.bytes.size()));
 
-    std::streamoff read_start = max_comment_size + read_size_before_comment;
-
-    if (read_start > end_position)
+    for (auto header : members.headers)
     {
-        read_start = end_position;
+        header.header_offset += offset;
+        file_headers_.push_back(header);
     }
+}
 
-    source_stream_.seekg(end_position - read_start);
-    std::vector<std::uint8_t> buf(static_cast<std::size_t>(read_start), '\0');
-
-    if (read_start <= 0)
+void ozstream::append(const path &file, const zcompressed &compressed)
+{
+    XLNT_TRACE_SCOPE_ARG("zip_open_entry", file.string());
+    auto header = compressed.header;
+    header.filename = file.string();
+    header.flags |= 0x0008; // the sizes and checksum follow the data in a data descriptor
+    header.extra.clear();
+    header.comment.clear();
+    header.header_offset = counter_->count();
+
+    if (fixed_timestamps_)
     {
-        throw xlnt::exception("file is empty");
+        header.stamp_date = zheader().stamp_date;
+        header.stamp_time = zheader().stamp_time;
     }
 
-    source_stream_.read(reinterpret_cast<char *>(buf.data()), read_start);
+    write_local_header(header, stream_);
+    stream_.write(reinterpret_cast<const char *>(compressed.data.data()), static_cast<std::streamsize>(compressed.data.size()));
+    write_data_descriptor(header, stream_);
+    file_headers_.push_back(header);
 
-    if (buf[0] == 0xd0 && buf[1] == 0xcf && buf[2] == 0x11 && buf[3] == 0xe0
-        && buf[4] == 0xa1 && buf[5] == 0xb1 && buf[6] == 0x1a && buf[7] == 0xe1)
-    {
-        throw xlnt::exception("encrypted xlsx, password required");
-    }
+    record_part(stats_, &io_stats::deflate, header.filename, 0.0, header.uncompressed_size);
+}
 
-    auto found_header = false;
-    std::streamoff header_index = 0;
+void ozstream::fixed_timestamps(bool fixed)
+{
+    fixed_timestamps_ = fixed;
+}
 
-    for (std::streamoff i = 0; i < read_start - 3; ++i)
+std::vector<std::uint8_t> zcompressed::inflate() const
+{
+    std::vector<std::uint8_t> contents(static_cast<std::size_t>(header.uncompressed_size));
+
+    if (header.compression_type == 0)
     {
-        if (buf[static_cast<std::size_t>(i)] == 0x50
-            && buf[static_cast<std::size_t>(i) + 1] == 0x4b
-            && buf[static_cast<std::size_t>(i) + 2] == 0x05
-            && buf[static_cast<std::size_t>(i) + 3] == 0x06)
+        if (data.size() != contents.size())
         {
-            found_header = true;
-            header_index = i;
-            break;
+            throw xlnt::exception("truncated archive member");
         }
-    }
 
-    if (!found_header)
+        std::copy(data.begin(), data.end(), contents.begin());
+    }
+    else if (header.compression_type == 8)
     {
-        throw xlnt::exception("failed to find zip header");
+        inflate_member(header, data.data(), contents.data(), *make_inflater());
+    }
+    else
+    {
+        throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
+    }
+
+    return contents;
+}
+
+namespace {
+
+template <class T>
+T load_int(const std::uint8_t *bytes)
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+
+    return value;
+}
+
+const std::uint32_t local_header_signature = 0x04034b50;
+const std::uint32_t data_descriptor_signature = 0x08074b50;
+
+} // namespace
+
+/// <summary>
+/// Buffers a stream which is only read forwards and allows bytes read past the end
+/// of a member to be put back for the next one.
+/// </summary>
+class forward_source
+{
+public:
+    forward_source(std::istream &stream, std::size_t buffer_size)
+        : stream_(stream),
+          buffer_size_(std::max(buffer_size, min_buffer_size))
+    {
+    }
+
+    /// <summary>
+    /// Reads more of the stream if nothing is buffered and returns the number of bytes
+    /// available, which is 0 only at the end of the stream.
+    /// </summary>
+    std::size_t fill()
+    {
+        if (position_ == buffer_.size())
+        {
+            buffer_.resize(buffer_size_);
+            stream_.read(reinterpret_cast<char *>(buffer_.data()), static_cast<std::streamsize>(buffer_size_));
+            buffer_.resize(static_cast<std::size_t>(stream_.gcount()));
+            position_ = 0;
+        }
+
+        return available();
+    }
+
+    const std::uint8_t *data() const
+    {
+        return buffer_.data() + position_;
+    }
+
+    std::size_t available() const
+    {
+        return buffer_.size() - position_;
+    }
+
+    void consume(std::size_t count)
+    {
+        position_ += count;
+    }
+
+    /// <summary>
+    /// Reads up to count bytes into destination and returns how many there were.
+    /// </summary>
+    std::size_t read_some(std::uint8_t *destination, std::size_t count)
+    {
+        auto read = std::size_t(0);
+
+        while (read < count && fill() != 0)
+        {
+            const auto chunk = std::min(count - read, available());
+            std::memcpy(destination + read, data(), chunk);
+            consume(chunk);
+            read += chunk;
+        }
+
+        return read;
+    }
+
+    /// <summary>
+    /// Reads exactly count bytes into destination.
+    /// </summary>
+    void read(std::uint8_t *destination, std::size_t count)
+    {
+        if (read_some(destination, count) != count)
+        {
+            throw xlnt::exception("truncated archive member");
+        }
+    }
+
+    /// <summary>
+    /// Puts count bytes back in front of the unread ones.
+    /// </summary>
+    void unread(const std::uint8_t *bytes, std::size_t count)
+    {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(position_));
+        buffer_.insert(buffer_.begin(), bytes, bytes + count);
+        position_ = 0;
+    }
+
+private:
+    std::istream &stream_;
+    std::size_t buffer_size_;
+    std::vector<std::uint8_t> buffer_;
+    std::size_t position_ = 0;
+};
+
+namespace {
+
+// Reads the local header of the next member into header and its bytes into local_bytes.
+// zip64 is set if it has a zip64 extra field, which makes the sizes of its data descriptor
+// eight bytes each. Returns false if the members have ended.
+bool read_local_header(forward_source &source, zheader &header, std::vector<std::uint8_t> &local_bytes, bool &zip64)
+{
+    const std::size_t local_header_size = 30;
+    std::array<std::uint8_t, local_header_size> local;
+
+    if (source.read_some(local.data(), 4) != 4 || load_int<std::uint32_t>(local.data()) != local_header_signature)
+    {
+        return false;
+    }
+
+    source.read(local.data() + 4, local_header_size - 4);
+
+    header.version = load_int<std::uint16_t>(local.data() + 4);
+    header.flags = load_int<std::uint16_t>(local.data() + 6);
+    header.compression_type = load_int<std::uint16_t>(local.data() + 8);
+    header.stamp_date = load_int<std::uint16_t>(local.data() + 10);
+    header.stamp_time = load_int<std::uint16_t>(local.data() + 12);
+    header.crc = load_int<std::uint32_t>(local.data() + 14);
+    header.compressed_size = load_int<std::uint32_t>(local.data() + 18);
+    header.uncompressed_size = load_int<std::uint32_t>(local.data() + 22);
+    const auto filename_length = std::size_t(load_int<std::uint16_t>(local.data() + 26));
+    const auto extra_length = std::size_t(load_int<std::uint16_t>(local.data() + 28));
+
+    local_bytes.assign(local.begin(), local.end());
+    local_bytes.resize(local_header_size + filename_length + extra_length);
+    source.read(local_bytes.data() + local_header_size, filename_length + extra_length);
+
+    const auto filename = reinterpret_cast<const char *>(local_bytes.data() + local_header_size);
+    header.filename.assign(filename, filename_length);
+    header.extra.assign(local_bytes.begin() + static_cast<std::ptrdiff_t>(local_header_size + filename_length),
+        local_bytes.end());
+
+    zip64 = false;
+
+    for (std::size_t position = 0; position + 4 <= header.extra.size();)
+    {
+        zip64 = zip64 || load_int<std::uint16_t>(header.extra.data() + position) == zip64_extra_tag;
+        position += 4 + load_int<std::uint16_t>(header.extra.data() + position + 2);
+    }
+
+    const auto compressed_saturated = header.compressed_size == zip64_limit;
+    const auto uncompressed_saturated = header.uncompressed_size == zip64_limit;
+
+    if (compressed_saturated || uncompressed_saturated)
+    {
+        read_zip64_extra(header, compressed_saturated, uncompressed_saturated, false);
+    }
+
+    return true;
+}
+
+// Returns the offset of the data of a member from the start of its local header.
+std::size_t member_data_offset(const std::vector<std::uint8_t> &member)
+{
+    return 30 + std::size_t(load_int<std::uint16_t>(member.data() + 26))
+        + std::size_t(load_int<std::uint16_t>(member.data() + 28));
+}
+
+// Reads the data of a stored member whose size is only recorded in the data descriptor
+// after it into member by looking for a signed descriptor whose sizes and checksum match
+// the data before it, then puts back what was read past the descriptor.
+void read_stored_member(forward_source &source, zheader &header, std::vector<std::uint8_t> &member, bool zip64,
+    std::uint64_t max_size)
+{
+    const std::size_t descriptor_size = zip64 ? 24 : 16;
+    std::vector<std::uint8_t> data;
+    auto candidate = std::size_t(0);
+    auto crc = std::uint32_t(0);
+    auto crc_position = std::size_t(0);
+    auto ended = false;
+
+    while (true)
+    {
+        for (; candidate + descriptor_size <= data.size(); ++candidate)
+        {
+            const auto descriptor = data.data() + candidate;
+
+            if (load_int<std::uint32_t>(descriptor) != data_descriptor_signature)
+            {
+                continue;
+            }
+
+            const auto compressed_size = zip64 ? load_int<std::uint64_t>(descriptor + 8)
+                                               : load_int<std::uint32_t>(descriptor + 8);
+            const auto uncompressed_size = zip64 ? load_int<std::uint64_t>(descriptor + 16)
+                                                 : load_int<std::uint32_t>(descriptor + 12);
+
+            if (compressed_size != candidate || uncompressed_size != candidate)
+            {
+                continue;
+            }
+
+            crc = update_crc32(crc, data.data() + crc_position, candidate - crc_position);
+            crc_position = candidate;
+
+            if (crc != load_int<std::uint32_t>(descriptor + 4))
+            {
+                continue;
+            }
+
+            header.crc = crc;
+            header.compressed_size = candidate;
+            header.uncompressed_size = candidate;
+            source.unread(descriptor + descriptor_size, data.size() - candidate - descriptor_size);
+            member.insert(member.end(), data.begin(), data.begin() + static_cast<std::ptrdiff_t>(candidate));
+
+            return;
+        }
+
+        if (ended)
+        {
+            throw xlnt::exception("truncated archive member");
+        }
+
+        if (source.fill() == 0)
+        {
+            ended = true;
+            continue;
+        }
+
+        data.insert(data.end(), source.data(), source.data() + source.available());
+        source.consume(source.available());
+
+        if (max_size != 0 && data.size() > max_size + descriptor_size)
+        {
+            throw xlnt::limit_exceeded("part " + header.filename + " inflates to more than the limit of "
+                + std::to_string(max_size) + " bytes (load_options::max_part_size)");
+        }
+    }
+}
+
+} // namespace
+
+/// <summary>
+/// Reads the data of the next member of a forward_source, inflating it if it's deflated,
+/// and then its data descriptor if it has one.
+/// </summary>
+class forward_member
+{
+public:
+    /// <summary>
+    /// The compressed bytes are also appended to kept unless it's nullptr, in which case
+    /// finish keeps the rest of the output to be read instead.
+    /// </summary>
+    forward_member(std::shared_ptr<forward_source> source, const zheader &header, bool zip64,
+        std::vector<std::uint8_t> *kept, std::uint64_t max_size, std::size_t buffer_size)
+        : source_(std::move(source)),
+          header_(header),
+          zip64_(zip64),
+          descriptor_((header.flags & 8) != 0),
+          kept_(kept),
+          max_size_(max_size),
+          buffer_size_(std::max(buffer_size, min_buffer_size))
+    {
+        if (header_.compression_type == 8)
+        {
+            inflater_ = make_inflater();
+        }
+        else if (descriptor_ || header_.compressed_size != header_.uncompressed_size)
+        {
+            // stored members with a data descriptor are read by read_stored_member
+            throw xlnt::exception("truncated archive member");
+        }
+    }
+
+    const zheader &header() const
+    {
+        return header_;
+    }
+
+    /// <summary>
+    /// Reads up to count bytes of the member into destination and returns how many were read,
+    /// which is 0 only at the end of the member.
+    /// </summary>
+    std::size_t read(std::uint8_t *destination, std::size_t count)
+    {
+        if (rest_position_ < rest_.size())
+        {
+            const auto chunk = std::min(count, rest_.size() - rest_position_);
+            std::memcpy(destination, rest_.data() + rest_position_, chunk);
+            rest_position_ += chunk;
+
+            return chunk;
+        }
+
+        auto read = std::size_t(0);
+
+        while (read == 0 && !ended_)
+        {
+            read = read_data(destination, count);
+        }
+
+        return read;
+    }
+
+    /// <summary>
+    /// Reads the rest of the member so that the source is at the next one.
+    /// </summary>
+    void finish()
+    {
+        std::vector<std::uint8_t> scratch(buffer_size_);
+
+        while (!ended_)
+        {
+            const auto read = read_data(scratch.data(), scratch.size());
+
+            if (kept_ == nullptr)
+            {
+                rest_.insert(rest_.end(), scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(read));
+            }
+        }
+    }
+
+private:
+    std::size_t read_data(std::uint8_t *destination, std::size_t count)
+    {
+        auto read = std::size_t(0);
+        auto member_ended = false;
+
+        if (inflater_)
+        {
+            if (source_->fill() == 0)
+            {
+                throw xlnt::exception("couldn't inflate ZIP, member is truncated");
+            }
+
+            auto next_in = source_->data();
+            auto avail_in = source_->available();
+            auto next_out = destination;
+            auto avail_out = count;
+            const auto avail_in_before = avail_in;
+            member_ended = inflater_->process(next_in, avail_in, next_out, avail_out);
+            consume(avail_in_before - avail_in);
+            read = count - avail_out;
+
+            if (!member_ended && read == 0 && avail_in == avail_in_before)
+            {
+                throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+            }
+        }
+        else
+        {
+            read = static_cast<std::size_t>(std::min<std::uint64_t>(count, header_.compressed_size - compressed_));
+            source_->read(destination, read);
+
+            if (kept_ != nullptr)
+            {
+                kept_->insert(kept_->end(), destination, destination + read);
+            }
+
+            compressed_ += read;
+            member_ended = compressed_ == header_.compressed_size;
+        }
+
+        uncompressed_ += read;
+
+        if (max_size_ != 0 && uncompressed_ > max_size_)
+        {
+            throw xlnt::limit_exceeded("part " + header_.filename + " inflates to more than the limit of "
+                + std::to_string(max_size_) + " bytes (load_options::max_part_size)");
+        }
+
+        if (member_ended)
+        {
+            end_member();
+        }
+
+        return read;
+    }
+
+    void consume(std::size_t count)
+    {
+        if (kept_ != nullptr)
+        {
+            kept_->insert(kept_->end(), source_->data(), source_->data() + count);
+        }
+
+        source_->consume(count);
+        compressed_ += count;
+    }
+
+    void end_member()
+    {
+        ended_ = true;
+
+        if (!descriptor_)
+        {
+            if (compressed_ != header_.compressed_size || uncompressed_ != header_.uncompressed_size)
+            {
+                throw xlnt::exception("couldn't inflate ZIP, member doesn't match its recorded size");
+            }
+
+            return;
+        }
+
+        // the signature of the data descriptor is optional
+        std::array<std::uint8_t, 24> descriptor;
+        source_->read(descriptor.data(), 4);
+        auto crc = load_int<std::uint32_t>(descriptor.data());
+
+        if (crc == data_descriptor_signature)
+        {
+            source_->read(descriptor.data(), 4);
+            crc = load_int<std::uint32_t>(descriptor.data());
+        }
+
+        std::uint64_t compressed_size = 0;
+        std::uint64_t uncompressed_size = 0;
+
+        if (zip64_ || compressed_ >= zip64_limit || uncompressed_ >= zip64_limit)
+        {
+            source_->read(descriptor.data(), 16);
+            compressed_size = load_int<std::uint64_t>(descriptor.data());
+            uncompressed_size = load_int<std::uint64_t>(descriptor.data() + 8);
+        }
+        else
+        {
+            source_->read(descriptor.data(), 8);
+            compressed_size = load_int<std::uint32_t>(descriptor.data());
+            uncompressed_size = load_int<std::uint32_t>(descriptor.data() + 4);
+        }
+
+        if (compressed_size != compressed_ || uncompressed_size != uncompressed_)
+        {
+            throw xlnt::exception("couldn't inflate ZIP, member doesn't match its recorded size");
+        }
+
+        header_.crc = crc;
+        header_.compressed_size = compressed_size;
+        header_.uncompressed_size = uncompressed_size;
+    }
+
+    std::shared_ptr<forward_source> source_;
+    zheader header_;
+    bool zip64_;
+    bool descriptor_;
+    std::vector<std::uint8_t> *kept_;
+    std::uint64_t max_size_;
+    std::size_t buffer_size_;
+    std::unique_ptr<inflater> inflater_;
+    std::uint64_t compressed_ = 0;
+    std::uint64_t uncompressed_ = 0;
+    bool ended_ = false;
+    std::vector<std::uint8_t> rest_;
+    std::size_t rest_position_ = 0;
+};
+
+/// <summary>
+/// Reads the member of a forward-only archive which is being inflated straight from its source.
+/// </summary>
+class forward_member_streambuf : public std::streambuf
+{
+public:
+    forward_member_streambuf(std::shared_ptr<forward_member> member, std::size_t buffer_size)
+        : member_(std::move(member)),
+          buffer_(std::max(buffer_size, min_buffer_size))
+    {
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+    }
+
+protected:
+    int underflow() override
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        const auto count = member_->read(reinterpret_cast<std::uint8_t *>(buffer_.data()), buffer_.size());
+        setg(buffer_.data(), buffer_.data(), buffer_.data() + count);
+
+        return count == 0 ? traits_type::eof() : traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::shared_ptr<forward_member> member_;
+    std::vector<char> buffer_;
+};
+
+struct izstream::forward_state
+{
+    std::shared_ptr<forward_source> source;
+
+    /// <summary>
+    /// The local header and compressed data of each member kept in memory.
+    /// </summary>
+    std::unordered_map<std::string, std::vector<std::uint8_t>> members;
+
+    /// <summary>
+    /// The member being inflated straight from the source, if any.
+    /// </summary>
+    std::shared_ptr<forward_member> current;
+
+    bool at_end = false;
+};
+
+izstream::izstream(std::istream &stream, std::size_t buffer_size, io_stats *stats)
+    : izstream(stream, buffer_size, stats, false)
+{
+}
+
+izstream::izstream(std::istream &stream, std::size_t buffer_size, io_stats *stats, bool forward_only)
+    : source_stream_(stream),
+      buffer_size_(buffer_size),
+      memory_source_(forward_only ? nullptr : dynamic_cast<const memory_istreambuf *>(stream.rdbuf())),
+      stats_(stats)
+{
+    if (!stream)
+    {
+        throw xlnt::exception("Invalid file handle");
+    }
+
+    if (forward_only)
+    {
+        // the members are read from their local headers as they're asked for
+        forward_.reset(new forward_state());
+        forward_->source = std::make_shared<forward_source>(stream, buffer_size);
+
+        return;
+    }
+
+    XLNT_TRACE_SCOPE("zip_read_central_directory");
+    const auto start = std::chrono::steady_clock::now();
+    read_central_header();
+
+    if (stats_ != nullptr)
+    {
+        auto compressed_size = std::uint64_t(0);
+
+        for (const auto &header : file_headers_)
+        {
+            compressed_size += header.second.compressed_size;
+        }
+
+        record_phase(stats_, &io_stats::archive, phase_timer::seconds_since(start),
+            compressed_size, file_headers_.size());
+    }
+}
+
+izstream::~izstream()
+{
+}
+
+bool izstream::forward_only() const
+{
+    return forward_ != nullptr;
+}
+
+bool izstream::read_forward_to(const std::string &file, bool direct) const
+{
+    auto &state = *forward_;
+
+    if (state.current)
+    {
+        // the rest of the member being streamed is kept in it for its reader
+        state.current->finish();
+        state.current.reset();
+    }
+
+    while (!state.at_end)
+    {
+        zheader header;
+        std::vector<std::uint8_t> member;
+        auto zip64 = false;
+
+        if (!read_local_header(*state.source, header, member, zip64))
+        {
+            state.at_end = true;
+            break;
+        }
+
+        if (header.compression_type != 0 && header.compression_type != 8)
+        {
+            throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
+        }
+
+        const auto found = header.filename == file;
+        const auto stored_with_descriptor = header.compression_type == 0 && (header.flags & 8) != 0;
+
+        if (found && direct && !stored_with_descriptor)
+        {
+            check_part_size(header);
+            state.current = std::make_shared<forward_member>(state.source, header, zip64, nullptr,
+                max_part_size_, buffer_size_);
+            file_headers_[header.filename] = header;
+
+            return true;
+        }
+
+        if (stored_with_descriptor)
+        {
+            read_stored_member(*state.source, header, member, zip64, max_part_size_);
+        }
+        else
+        {
+            forward_member reader(state.source, header, zip64, &member, max_part_size_, buffer_size_);
+            reader.finish();
+            header = reader.header();
+        }
+
+        file_headers_[header.filename] = header;
+        state.members[header.filename] = std::move(member);
+
+        if (found)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool izstream::read_central_header()
+{
+    // Find the header
+    // NOTE: this assumes the zip file header is the last thing written to file...
+    source_stream_.seekg(0, std::ios_base::end);
+    auto end_position = source_stream_.tellg();
+
+    auto max_comment_size = std::uint32_t(0xffff); // max size of header
+    auto read_size_before_comment = std::uint32_t(22);
+
+    std::streamoff read_start = max_comment_size + read_size_before_comment;
+
+    if (read_start > end_position)
+    {
+        read_start = end_position;
+    }
+
+    source_stream_.seekg(end_position - read_start);
+    std::vector<std::uint8_t> buf(static_cast<std::size_t>(read_start), '\0');
+
+    if (read_start <= 0)
+    {
+        throw xlnt::exception("file is empty");
+    }
+
+    source_stream_.read(reinterpret_cast<char *>(buf.data()), read_start);
+
+    if (buf[0] == 0xd0 && buf[1] == 0xcf && buf[2] == 0x11 && buf[3] == 0xe0
+        && buf[4] == 0xa1 && buf[5] == 0xb1 && buf[6] == 0x1a && buf[7] == 0xe1)
+    {
+        throw xlnt::exception("encrypted xlsx, password required");
+    }
+
+    auto found_header = false;
+    std::streamoff header_index = 0;
+
+    for (std::streamoff i = 0; i < read_start - 3; ++i)
+    {
+        if (buf[static_cast<std::size_t>(i)] == 0x50
+            && buf[static_cast<std::size_t>(i) + 1] == 0x4b
+            && buf[static_cast<std::size_t>(i) + 2] == 0x05
+            && buf[static_cast<std::size_t>(i) + 3] == 0x06)
+        {
+            found_header = true;
+            header_index = i;
+            break;
+        }
+    }
+
+    if (!found_header)
+    {
+        throw xlnt::exception("failed to find zip header");
     }
 
     // seek to end of central header and read
     source_stream_.seekg(end_position - (read_start - header_index));
 
-    /*auto word = */ read_int<std::uint32_t>(source_stream_);
-    auto disk_number1 = read_int<std::uint16_t>(source_stream_);
-    auto disk_number2 = read_int<std::uint16_t>(source_stream_);
+    /*auto word = */ read_int<std::uint32_t>(source_stream_);
+    auto disk_number1 = read_int<std::uint16_t>(source_stream_);
+    auto disk_number2 = read_int<std::uint16_t>(source_stream_);
+
+    if (disk_number1 != disk_number2 || disk_number1 != 0)
+    {
+        throw xlnt::exception("multiple disk zip files are not supported");
+    }
+
+    std::uint64_t num_files = read_int<std::uint16_t>(source_stream_); // one entry in center in this disk
+    std::uint64_t num_files_this_disk = read_int<std::uint16_t>(source_stream_); // one entry in center
+
+    if (num_files != num_files_this_disk)
+    {
+        throw xlnt::exception("multi disk zip files are not supported");
+    }
+
+    /*auto size_of_header = */ read_int<std::uint32_t>(source_stream_); // size of header
+    std::uint64_t header_offset = read_int<std::uint32_t>(source_stream_); // offset to header
+
+    // a zip64 end of central directory locator directly precedes the record if there is one
+    const std::streamoff locator_size = 20;
+
+    if (header_index >= locator_size
+        && buf[static_cast<std::size_t>(header_index - locator_size)] == 0x50
+        && buf[static_cast<std::size_t>(header_index - locator_size) + 1] == 0x4b
+        && buf[static_cast<std::size_t>(header_index - locator_size) + 2] == 0x06
+        && buf[static_cast<std::size_t>(header_index - locator_size) + 3] == 0x07)
+    {
+        source_stream_.seekg(static_cast<std::streamoff>(end_position) - (read_start - header_index) - locator_size + 8);
+        const auto record_offset = read_int<std::uint64_t>(source_stream_);
+
+        source_stream_.seekg(static_cast<std::streamoff>(record_offset));
+
+        if (read_int<std::uint32_t>(source_stream_) != 0x06064b50)
+        {
+            throw xlnt::exception("missing zip64 end of central directory signature");
+        }
+
+        /*auto record_size = */ read_int<std::uint64_t>(source_stream_);
+        /*auto version_made_by = */ read_int<std::uint16_t>(source_stream_);
+        /*auto version_needed = */ read_int<std::uint16_t>(source_stream_);
+        /*auto disk_number = */ read_int<std::uint32_t>(source_stream_);
+        /*auto central_disk_number = */ read_int<std::uint32_t>(source_stream_);
+        num_files = read_int<std::uint64_t>(source_stream_);
+        num_files_this_disk = read_int<std::uint64_t>(source_stream_);
+        /*auto size_of_header = */ read_int<std::uint64_t>(source_stream_);
+        header_offset = read_int<std::uint64_t>(source_stream_);
+
+        if (num_files != num_files_this_disk)
+        {
+            throw xlnt::exception("multi disk zip files are not supported");
+        }
+    }
+
+    // go to header and read all file headers
+    source_stream_.seekg(static_cast<std::streamoff>(header_offset));
+
+    for (std::uint64_t i = 0; i < num_files; ++i)
+    {
+        auto header = read_header(source_stream_, true);
+        file_headers_[header.filename] = header;
+    }
+
+    return true;
+}
+
+std::unique_ptr<std::streambuf> izstream::open(const path &filename) const
+{
+    XLNT_TRACE_SCOPE_ARG("zip_open_entry", filename.string());
+
+    if (forward_ && file_headers_.count(filename.string()) == 0)
+    {
+        if (!read_forward_to(filename.string(), true))
+        {
+            throw xlnt::exception("file not found");
+        }
+
+        if (forward_->current)
+        {
+            return std::unique_ptr<std::streambuf>(new forward_member_streambuf(forward_->current, buffer_size_));
+        }
+    }
 
-    if (disk_number1 != disk_number2 || disk_number1 != 0)
+    if (!has_file(filename))
     {
-        throw xlnt::exception("multiple disk zip files are not supported");
+        throw xlnt::exception("file not found");
     }
 
-    auto num_files = read_int<std::uint16_t>(source_stream_); // one entry in center in this disk
-    auto num_files_this_disk = read_int<std::uint16_t>(source_stream_); // one entry in center
+    auto header = file_headers_.at(filename.string());
+    check_part_size(header);
 
-    if (num_files != num_files_this_disk)
+    if (header.compression_type == 8 && header.uncompressed_size <= whole_inflate_limit)
     {
-        throw xlnt::exception("multi disk zip files are not supported");
+        // small parts are cheaper to inflate in one go than through the streaming buffers
+        auto buffer = new inflated_member_streambuf(static_cast<std::size_t>(header.uncompressed_size), buffers_);
+        std::unique_ptr<std::streambuf> owner(buffer);
+        read_whole(header, buffer->destination());
+
+        return owner;
     }
 
-    /*auto size_of_header = */ read_int<std::uint32_t>(source_stream_); // size of header
-    auto header_offset = read_int<std::uint32_t>(source_stream_); // offset to header
+    if (memory_source_ != nullptr || forward_)
+    {
+        return open_in_memory(header);
+    }
 
-    // go to header and read all file headers
-    source_stream_.seekg(header_offset);
+    source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+    auto buffer = new zip_streambuf_decompress(source_stream_, header, buffer_size_, buffers_);
+    buffer->record_to(stats_);
+    buffer->limit_to(max_part_size_);
+
+    return std::unique_ptr<zip_streambuf_decompress>(buffer);
+}
+
+std::unique_ptr<std::streambuf> izstream::open_in_memory(const zheader &header) const
+{
+    const auto member = member_in_memory(header);
 
-    for (std::uint16_t i = 0; i < num_files; ++i)
+    if (header.compression_type == 0)
     {
-        auto header = read_header(source_stream_, true);
-        file_headers_[header.filename] = header;
+        // stored members are served from the source without copying
+        record_part(stats_, &io_stats::inflate, header.filename, 0.0, header.uncompressed_size);
+
+        return std::unique_ptr<memory_istreambuf>(
+            new memory_istreambuf(member, static_cast<std::size_t>(header.uncompressed_size)));
     }
 
-    return true;
+    auto buffer = new zip_streambuf_decompress(reinterpret_cast<const char *>(member), header, buffer_size_, buffers_);
+    buffer->record_to(stats_);
+    buffer->limit_to(max_part_size_);
+
+    return std::unique_ptr<zip_streambuf_decompress>(buffer);
 }
 
-std::unique_ptr<std::streambuf> izstream::open(const path &filename) const
+std::uint64_t izstream::member_offset(const zheader &header) const
+{
+    const std::size_t local_header_size = 30;
+    std::array<std::uint8_t, local_header_size> local;
+
+    if (memory_source_ != nullptr)
+    {
+        const auto size = memory_source_->size();
+
+        if (header.header_offset > size || size - header.header_offset < local_header_size)
+        {
+            throw xlnt::exception("missing local header");
+        }
+
+        std::memcpy(local.data(), memory_source_->data() + static_cast<std::size_t>(header.header_offset),
+            local_header_size);
+    }
+    else
+    {
+        source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+        source_stream_.read(reinterpret_cast<char *>(local.data()), static_cast<std::streamsize>(local_header_size));
+
+        if (source_stream_.gcount() != static_cast<std::streamsize>(local_header_size))
+        {
+            throw xlnt::exception("missing local header");
+        }
+    }
+
+    if (local[0] != 0x50 || local[1] != 0x4b || local[2] != 0x03 || local[3] != 0x04)
+    {
+        throw xlnt::exception("missing local header signature");
+    }
+
+    // filename and extra field lengths are the last two fields of the local header
+    const auto filename_length = static_cast<std::size_t>(local[26] | (local[27] << 8));
+    const auto extra_length = static_cast<std::size_t>(local[28] | (local[29] << 8));
+
+    return header.header_offset + local_header_size + filename_length + extra_length;
+}
+
+const std::uint8_t *izstream::member_in_memory(const zheader &header) const
+{
+    if (forward_)
+    {
+        const auto member = forward_->members.find(header.filename);
+
+        if (member == forward_->members.end())
+        {
+            throw xlnt::exception(header.filename + " was already read from the forward-only archive");
+        }
+
+        return member->second.data() + member_data_offset(member->second);
+    }
+
+    const auto size = memory_source_->size();
+    const auto offset = member_offset(header);
+
+    if (offset > size || size - offset < header.compressed_size)
+    {
+        throw xlnt::exception("truncated archive member");
+    }
+
+    return memory_source_->data() + static_cast<std::size_t>(offset);
+}
+
+void izstream::read_member(const zheader &header, std::uint8_t *destination) const
+{
+    source_stream_.seekg(static_cast<std::streamoff>(member_offset(header)));
+    source_stream_.read(reinterpret_cast<char *>(destination), static_cast<std::streamsize>(header.compressed_size));
+
+    if (source_stream_.gcount() != static_cast<std::streamsize>(header.compressed_size))
+    {
+        throw xlnt::exception("truncated archive member");
+    }
+}
+
+void izstream::read_whole(const zheader &header, std::uint8_t *destination) const
+{
+    if (header.compression_type != 0 && header.compression_type != 8)
+    {
+        throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
+    }
+
+    XLNT_TRACE_SCOPE_ARG("zip_inflate_entry", header.filename);
+    const auto start = std::chrono::steady_clock::now();
+    const auto size = static_cast<std::size_t>(header.uncompressed_size);
+    std::vector<std::uint8_t> compressed;
+    const std::uint8_t *member = nullptr;
+
+    if (header.compression_type == 0 && header.compressed_size != header.uncompressed_size)
+    {
+        throw xlnt::exception("truncated archive member");
+    }
+
+    const auto in_memory = memory_source_ != nullptr || forward_;
+
+    if (in_memory)
+    {
+        member = member_in_memory(header);
+    }
+    else if (header.compression_type == 8)
+    {
+        compressed = buffers_ ? buffers_->take_bytes(static_cast<std::size_t>(header.compressed_size))
+                              : std::vector<std::uint8_t>(static_cast<std::size_t>(header.compressed_size));
+        read_member(header, compressed.data());
+        member = compressed.data();
+    }
+    else
+    {
+        // stored members are read straight into the destination
+        read_member(header, destination);
+    }
+
+    if (header.compression_type == 0)
+    {
+        if (in_memory && size != 0)
+        {
+            std::memcpy(destination, member, size);
+        }
+
+        record_part(stats_, &io_stats::inflate, header.filename, phase_timer::seconds_since(start), size);
+
+        return;
+    }
+
+    if (buffers_)
+    {
+        auto inflate_stream = buffers_->take_inflater();
+        inflate_member(header, member, destination, *inflate_stream);
+        buffers_->give_back(std::move(inflate_stream));
+        buffers_->give_back(std::move(compressed));
+    }
+    else
+    {
+        inflate_member(header, member, destination, *make_inflater());
+    }
+
+    record_part(stats_, &io_stats::inflate, header.filename, phase_timer::seconds_since(start), size);
+}
+
+std::unique_ptr<std::streambuf> izstream::open_detached(const path &filename) const
 {
+    XLNT_TRACE_SCOPE_ARG("zip_open_detached_entry", filename.string());
+
     if (!has_file(filename))
     {
         throw xlnt::exception("file not found");
     }
 
-    auto header = file_headers_.at(filename.string());
-    source_stream_.seekg(header.header_offset);
-    auto buffer = new zip_streambuf_decompress(source_stream_, header);
+    const auto &header = file_headers_.at(filename.string());
+    check_part_size(header);
 
-    return std::unique_ptr<zip_streambuf_decompress>(buffer);
+    if (memory_source_ != nullptr || forward_)
+    {
+        // members of an in-memory source, or kept from a forward-only one, can already be read independently
+        return open_in_memory(header);
+    }
+
+    const std::size_t local_header_size = 30;
+
+    std::vector<std::uint8_t> member(local_header_size);
+    source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+    source_stream_.read(reinterpret_cast<char *>(member.data()), static_cast<std::streamsize>(local_header_size));
+
+    if (source_stream_.gcount() != static_cast<std::streamsize>(local_header_size))
+    {
+        throw xlnt::exception("missing local header");
+    }
+
+    // filename and extra field lengths are the last two fields of the local header
+    const auto filename_length = static_cast<std::size_t>(member[26] | (member[27] << 8));
+    const auto extra_length = static_cast<std::size_t>(member[28] | (member[29] << 8));
+    const auto remaining = filename_length + extra_length + header.compressed_size;
+
+    member.resize(static_cast<std::size_t>(local_header_size + remaining));
+    source_stream_.read(reinterpret_cast<char *>(member.data() + local_header_size), static_cast<std::streamsize>(remaining));
+
+    if (source_stream_.gcount() != static_cast<std::streamsize>(remaining))
+    {
+        throw xlnt::exception("truncated archive member");
+    }
+
+    auto buffer = new zip_streambuf_decompress_detached(std::move(member), header, buffer_size_, buffers_);
+    buffer->record_to(stats_);
+    buffer->limit_to(max_part_size_);
+
+    return std::unique_ptr<zip_streambuf_decompress_detached>(buffer);
 }
 
 std::string izstream::read(const path &filename) const
 {
-    auto buffer = open(filename);
-    std::istream stream(buffer.get());
-    auto bytes = to_vector(stream);
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    const auto &header = file_headers_.at(filename.string());
+    check_part_size(header);
+    std::string contents(static_cast<std::size_t>(header.uncompressed_size), '\0');
+
+    if (!contents.empty() || header.compression_type != 0)
+    {
+        read_whole(header, reinterpret_cast<std::uint8_t *>(&contents[0]));
+    }
+
+    return contents;
+}
+
+zcompressed izstream::read_compressed(const path &filename) const
+{
+    XLNT_TRACE_SCOPE_ARG("zip_open_entry", filename.string());
+
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    zcompressed file;
+    file.header = file_headers_.at(filename.string());
+    check_part_size(file.header);
+
+    if (file.header.compression_type != 0 && file.header.compression_type != 8)
+    {
+        throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
+    }
+
+    if (file.header.compression_type == 0 && file.header.compressed_size != file.header.uncompressed_size)
+    {
+        throw xlnt::exception("truncated archive member");
+    }
+
+    file.data.resize(static_cast<std::size_t>(file.header.compressed_size));
+
+    if (memory_source_ != nullptr || forward_)
+    {
+        const auto member = member_in_memory(file.header);
+        std::copy(member, member + file.data.size(), file.data.begin());
+    }
+    else if (!file.data.empty())
+    {
+        read_member(file.header, file.data.data());
+    }
+
+    return file;
+}
+
+zindex izstream::index(const path &filename, std::size_t spacing) const
+{
+    XLNT_TRACE_SCOPE_ARG("zip_index_entry", filename.string());
+
+    if (forward_)
+    {
+        throw xlnt::unsupported("indexing members of a forward-only archive");
+    }
+
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    zindex index;
+    index.header = file_headers_.at(filename.string());
+    index.data_offset = member_offset(index.header);
+    check_part_size(index.header);
+
+    const auto &header = index.header;
+
+    if (header.compression_type == 0)
+    {
+        return index;
+    }
+
+    if (header.compression_type != 8)
+    {
+        throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto inflate_stream = make_inflater();
+    std::vector<std::uint8_t> in(memory_source_ != nullptr ? 0 : buffer_size_);
+    std::vector<std::uint8_t> out(std::max<std::size_t>(spacing, 1));
+    const std::uint8_t *next_in = nullptr;
+    auto avail_in = std::size_t(0);
+    auto total_read = std::uint64_t(0);
+    auto total_uncompressed = std::uint64_t(0);
+    auto inflated_all = false;
+
+    if (memory_source_ != nullptr)
+    {
+        next_in = member_in_memory(header);
+        avail_in = static_cast<std::size_t>(header.compressed_size);
+        total_read = header.compressed_size;
+    }
+    else
+    {
+        source_stream_.seekg(static_cast<std::streamoff>(index.data_offset));
+    }
+
+    while (!inflated_all)
+    {
+        auto next_out = out.data();
+        auto avail_out = out.size();
+
+        while (avail_out != 0 && !inflated_all)
+        {
+            if (avail_in == 0 && total_read < header.compressed_size)
+            {
+                source_stream_.read(reinterpret_cast<char *>(in.data()), static_cast<std::streamsize>(
+                    std::min<std::uint64_t>(in.size(), header.compressed_size - total_read)));
+                avail_in = static_cast<std::size_t>(source_stream_.gcount());
+                total_read += avail_in;
+                next_in = in.data();
+            }
+
+            const auto had_input = avail_in != 0;
+            const auto avail_out_before = avail_out;
+            inflated_all = inflate_stream->process(next_in, avail_in, next_out, avail_out);
+
+            if (!inflated_all && !had_input && avail_out == avail_out_before)
+            {
+                throw xlnt::exception("couldn't inflate ZIP, member is truncated");
+            }
+        }
+
+        total_uncompressed += out.size() - avail_out;
+
+        if (max_part_size_ != 0 && total_uncompressed > max_part_size_)
+        {
+            throw xlnt::limit_exceeded("part " + header.filename + " inflates to more than the limit of "
+                + std::to_string(max_part_size_) + " bytes (load_options::max_part_size)");
+        }
+
+        if (inflated_all) break;
+
+        std::shared_ptr<const inflater> state(inflate_stream->clone());
+
+        if (!state)
+        {
+            // without checkpoints, open inflates the file from its start
+            index.checkpoints.clear();
+            break;
+        }
+
+        zcheckpoint checkpoint;
+        checkpoint.compressed_offset = total_read - avail_in;
+        checkpoint.uncompressed_offset = total_uncompressed;
+        checkpoint.state = std::move(state);
+        index.checkpoints.push_back(std::move(checkpoint));
+    }
+
+    record_part(stats_, &io_stats::inflate, header.filename, phase_timer::seconds_since(start), total_uncompressed);
+
+    return index;
+}
+
+std::unique_ptr<std::streambuf> izstream::open(const zindex &index, std::uint64_t offset) const
+{
+    const auto &header = index.header;
+    XLNT_TRACE_SCOPE_ARG("zip_open_entry_at", header.filename);
+
+    if (offset > header.uncompressed_size)
+    {
+        throw xlnt::exception("offset is past the end of " + header.filename);
+    }
+
+    check_part_size(header);
+
+    // stored members are read from the offset, deflated ones from the last checkpoint before it
+    zcheckpoint checkpoint;
+
+    if (header.compression_type == 0)
+    {
+        checkpoint.compressed_offset = offset;
+        checkpoint.uncompressed_offset = offset;
+    }
+    else
+    {
+        auto after = std::upper_bound(index.checkpoints.begin(), index.checkpoints.end(), offset,
+            [](std::uint64_t value, const zcheckpoint &candidate) { return value < candidate.uncompressed_offset; });
+
+        if (after != index.checkpoints.begin())
+        {
+            checkpoint = *(after - 1);
+        }
+    }
+
+    std::unique_ptr<zip_streambuf_decompress> buffer;
+
+    if (memory_source_ != nullptr)
+    {
+        const auto member = member_in_memory(header);
+
+        if (header.compression_type == 0)
+        {
+            return std::unique_ptr<memory_istreambuf>(new memory_istreambuf(
+                member + offset, static_cast<std::size_t>(header.uncompressed_size - offset)));
+        }
+
+        buffer.reset(new zip_streambuf_decompress(reinterpret_cast<const char *>(member), header, buffer_size_));
+    }
+    else
+    {
+        source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+        buffer.reset(new zip_streambuf_decompress(source_stream_, header, buffer_size_));
+        source_stream_.seekg(static_cast<std::streamoff>(index.data_offset + checkpoint.compressed_offset));
+    }
+
+    buffer->resume(checkpoint);
+    buffer->record_to(stats_);
+    buffer->limit_to(max_part_size_);
+
+    // the bytes between the checkpoint and the offset are inflated and dropped
+    std::vector<char> skipped(buffer_size_);
+    auto remaining = offset - checkpoint.uncompressed_offset;
+
+    while (remaining > 0)
+    {
+        const auto count = buffer->sgetn(skipped.data(),
+            static_cast<std::streamsize>(std::min<std::uint64_t>(remaining, skipped.size())));
+
+        if (count <= 0)
+        {
+            throw xlnt::exception("couldn't inflate ZIP, member is truncated");
+        }
+
+        remaining -= static_cast<std::uint64_t>(count);
+    }
+
+    return std::unique_ptr<std::streambuf>(buffer.release());
+}
+
+void izstream::reuse(std::shared_ptr<load_buffers> buffers)
+{
+    buffers_ = std::move(buffers);
+}
+
+void izstream::max_part_size(std::uint64_t size)
+{
+    max_part_size_ = size;
+}
 
-    return std::string(bytes.begin(), bytes.end());
+void izstream::check_part_size(const zheader &header) const
+{
+    if (max_part_size_ != 0 && header.uncompressed_size > max_part_size_)
+    {
+        throw xlnt::limit_exceeded("part " + header.filename + " is larger than the limit of "
+            + std::to_string(max_part_size_) + " bytes (load_options::max_part_size)");
+    }
 }
 
 std::vector<path> izstream::files() const
 {
+    if (forward_)
+    {
+        // no member is named with an empty string, so this reads to the end
+        read_forward_to(std::string(), false);
+    }
+
     std::vector<path> filenames;
     std::transform(file_headers_.begin(), file_headers_.end(), std::back_inserter(filenames),
         [](const std::pair<std::string, zheader> &h) { return path(h.first); });
@@ -621,6 +2288,11 @@ std::vector<path> izstream::files() const
 
 bool izstream::has_file(const path &filename) const
 {
+    if (forward_ && file_headers_.count(filename.string()) == 0)
+    {
+        return read_forward_to(filename.string(), false);
+    }
+
     return file_headers_.count(filename.string()) != 0;
 }
 
@@ -44,13 +44,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 #include <xlnt/xlnt_config.hpp>
 #include <detail/xlnt_config_impl.hpp>
 #include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/save_options.hpp>
 
 namespace xlnt {
 namespace detail {
 
+class counting_ostreambuf;
+class inflater;
+class load_buffers;
+class memory_istreambuf;
+
 /// <summary>
 /// A structure representing the header that occurs before each compressed file in a ZIP
-/// archive and again at the end of the file with more information.
+/// archive and again at the end of the file with more information. Sizes and offsets
+/// which don't fit into 32 bits are stored in the zip64 extra field of the central header.
 /// </summary>
 struct XLNT_API_INTERNAL zheader
 {
@@ -60,25 +67,87 @@ struct XLNT_API_INTERNAL zheader
     std::uint16_t stamp_date = 0;
     std::uint16_t stamp_time = 0;
     std::uint32_t crc = 0;
-    std::uint32_t compressed_size = 0;
-    std::uint32_t uncompressed_size = 0;
+    std::uint64_t compressed_size = 0;
+    std::uint64_t uncompressed_size = 0;
     std::string filename;
     std::string comment;
     std::vector<std::uint8_t> extra;
-    std::uint32_t header_offset = 0;
+    std::uint64_t header_offset = 0;
+};
+
+/// <summary>
+/// Files compressed into memory by an ozstream, ready to be appended to another
+/// archive. The header offsets are relative to the start of bytes.
+/// </summary>
+struct XLNT_API_INTERNAL zmembers
+{
+    std::vector<std::uint8_t> bytes;
+    std::vector<zheader> headers;
+};
+
+/// <summary>
+/// A file kept compressed as it was in an archive, see izstream::read_compressed.
+/// </summary>
+struct XLNT_API_INTERNAL zcompressed
+{
+    zheader header;
+    std::vector<std::uint8_t> data;
+
+    /// <summary>
+    /// Returns the uncompressed contents of the file.
+    /// </summary>
+    std::vector<std::uint8_t> inflate() const;
+};
+
+/// <summary>
+/// A point in a deflated file from which it can be inflated without inflating the
+/// data before it: the state of the inflater after consuming compressed_offset bytes
+/// of the file and producing uncompressed_offset bytes.
+/// </summary>
+struct XLNT_API_INTERNAL zcheckpoint
+{
+    std::uint64_t compressed_offset = 0;
+    std::uint64_t uncompressed_offset = 0;
+    std::shared_ptr<const inflater> state;
+};
+
+/// <summary>
+/// The location of a file in an archive and checkpoints spread over its uncompressed
+/// contents, see izstream::index. Stored files need no checkpoints.
+/// </summary>
+struct XLNT_API_INTERNAL zindex
+{
+    zheader header;
+
+    /// <summary>
+    /// The offset of the first byte of the file's data in the archive, after its local header.
+    /// </summary>
+    std::uint64_t data_offset = 0;
+
+    /// <summary>
+    /// The checkpoints in order of their offsets.
+    /// </summary>
+    std::vector<zcheckpoint> checkpoints;
 };
 
 /// <summary>
 /// Writes a series of uncompressed binary file data as ostreams into another ostream
-/// according to the ZIP format.
+/// according to the ZIP format. The destination is only ever appended to, so it needs
+/// not be seekable: the sizes and checksum of each file follow its data in a data
+/// descriptor, and zip64 records are added where sizes, offsets or the number of files
+/// exceed the limits of the original format.
 /// </summary>
 class XLNT_API_INTERNAL ozstream
 {
 public:
     /// <summary>
     /// Construct a new zip_file_writer which writes a ZIP archive to the given stream.
+    /// Every file is compressed as given by compression.
+    /// If stats isn't nullptr, the compression of every file and the central directory
+    /// are recorded in it.
     /// </summary>
-    ozstream(std::ostream &stream);
+    ozstream(std::ostream &stream, compression_level compression = compression_level::standard,
+        io_stats *stats = nullptr);
 
     /// <summary>
     /// Destructor.
@@ -90,9 +159,50 @@ public:
     /// </summary>
     std::unique_ptr<std::streambuf> open(const path &file);
 
+    /// <summary>
+    /// Returns a pointer to a streambuf which compresses the data it receives as given
+    /// by compression instead of the compression of the archive.
+    /// </summary>
+    std::unique_ptr<std::streambuf> open(const path &file, compression_level compression);
+
+    /// <summary>
+    /// Returns the headers of the files written so far. The stream then writes no
+    /// central directory when destroyed, leaving only the files in the destination.
+    /// </summary>
+    std::vector<zheader> release();
+
+    /// <summary>
+    /// Copies the already compressed files in members to the end of this archive.
+    /// </summary>
+    void append(const zmembers &members);
+
+    /// <summary>
+    /// Copies compressed to the end of this archive as it is, without recompressing
+    /// it, under the name file.
+    /// </summary>
+    void append(const path &file, const zcompressed &compressed);
+
+    /// <summary>
+    /// If fixed is true, the files appended by append(file, compressed) are stamped with
+    /// the date and time of the files written by open instead of keeping their own, so that
+    /// the archive doesn't depend on when the files it copies were written.
+    /// </summary>
+    void fixed_timestamps(bool fixed);
+
 private:
     std::vector<zheader> file_headers_;
     std::ostream &destination_stream_;
+    compression_level compression_;
+    io_stats *stats_;
+    bool released_ = false;
+    bool fixed_timestamps_ = false;
+
+    /// <summary>
+    /// Counts the bytes written to destination_stream_, whose position can't be asked for
+    /// if it isn't seekable. Everything is written through stream_.
+    /// </summary>
+    std::unique_ptr<counting_ostreambuf> counter_;
+    std::ostream stream_;
 };
 
 /// <summary>
@@ -102,10 +212,40 @@ private:
 class XLNT_API_INTERNAL izstream
 {
 public:
+    /// <summary>
+    /// The default size in bytes of the buffers used to decompress each file.
+    /// </summary>
+    static const std::size_t default_buffer_size = 128 * 1024;
+
+    /// <summary>
+    /// Deflated files up to this many bytes once uncompressed are inflated in a single
+    /// step by open into a buffer sized from their header instead of being streamed.
+    /// </summary>
+    static const std::size_t whole_inflate_limit = 4 * 1024 * 1024;
+
+    /// <summary>
+    /// The default number of uncompressed bytes between the checkpoints of an index.
+    /// </summary>
+    static const std::size_t default_checkpoint_spacing = 4 * 1024 * 1024;
+
     /// <summary>
     /// Construct a new zip_file_reader which reads a ZIP archive from the given stream.
+    /// Files are decompressed through buffers of buffer_size bytes. If stats isn't
+    /// nullptr, reading the central directory and decompressing every file opened
+    /// are recorded in it.
     /// </summary>
-    izstream(std::istream &stream);
+    izstream(std::istream &stream, std::size_t buffer_size = default_buffer_size,
+        io_stats *stats = nullptr);
+
+    /// <summary>
+    /// Construct a zip_file_reader which reads the archive forward-only, for streams which
+    /// can't seek, if forward_only is true. No central directory is read: members are read
+    /// in archive order from their local headers as files are asked for, and the members
+    /// passed on the way are kept compressed in memory. The file opened is inflated
+    /// directly from the stream when it is the next member, after which it can't be opened
+    /// again unless open_detached kept it. index isn't supported.
+    /// </summary>
+    izstream(std::istream &stream, std::size_t buffer_size, io_stats *stats, bool forward_only);
 
     /// <summary>
     /// Destructor.
@@ -118,10 +258,40 @@ public:
     std::unique_ptr<std::streambuf> open(const path &file) const;
 
     /// <summary>
-    ///
+    /// Copies the compressed bytes of file out of the archive and returns a streambuf
+    /// which decompresses them independently of the archive's source stream. Reading
+    /// from the returned streambuf is safe while other members are being read.
+    /// </summary>
+    std::unique_ptr<std::streambuf> open_detached(const path &file) const;
+
+    /// <summary>
+    /// Returns the whole uncompressed contents of file, inflated in a single step
+    /// into a string sized from the file's header.
     /// </summary>
     std::string read(const path &file) const;
 
+    /// <summary>
+    /// Returns a copy of the compressed bytes of file, which can be inflated later or
+    /// appended to an ozstream without inflating and deflating them.
+    /// </summary>
+    zcompressed read_compressed(const path &file) const;
+
+    /// <summary>
+    /// Inflates file once and returns its index with a checkpoint after every spacing
+    /// uncompressed bytes, from which open can start reading it at any offset. Each
+    /// checkpoint holds a copy of the inflater's state, including its 32 KiB window.
+    /// The index has no checkpoints if the deflate implementation can't copy its state,
+    /// in which case open inflates the file from its start.
+    /// </summary>
+    zindex index(const path &file, std::size_t spacing = default_checkpoint_spacing) const;
+
+    /// <summary>
+    /// Returns a streambuf reading the file of index from the given uncompressed offset,
+    /// inflating it from the last checkpoint at or before the offset. index must have been
+    /// returned by this archive.
+    /// </summary>
+    std::unique_ptr<std::streambuf> open(const zindex &index, std::uint64_t offset) const;
+
     /// <summary>
     ///
     /// </summary>
@@ -132,21 +302,117 @@ public:
     /// </summary>
     bool has_file(const path &filename) const;
 
+    /// <summary>
+    /// Makes opening or reading a file throw limit_exceeded if it is larger than size
+    /// bytes once uncompressed, going by its header or by the bytes inflated so far.
+    /// A size of 0, the default, means no limit.
+    /// </summary>
+    void max_part_size(std::uint64_t size);
+
+    /// <summary>
+    /// Makes the files opened from now on take their inflaters and buffers from buffers
+    /// and give them back once they're destroyed, instead of allocating their own.
+    /// </summary>
+    void reuse(std::shared_ptr<load_buffers> buffers);
+
+    /// <summary>
+    /// Returns true if this archive is read forward-only, so that asking for a file which
+    /// isn't there reads the rest of the archive.
+    /// </summary>
+    bool forward_only() const;
+
 private:
+    struct forward_state;
+
+    /// <summary>
+    /// Reads the members of a forward-only archive until file, keeping the members before it
+    /// in memory. If direct is true and file can be inflated as it is read, it is left to be
+    /// read through forward_->current, otherwise it is kept as well. Returns false if the
+    /// archive ends without file.
+    /// </summary>
+    bool read_forward_to(const std::string &file, bool direct) const;
+
+    /// <summary>
+    /// Throws limit_exceeded if the header of a file records it as larger than max_part_size_.
+    /// </summary>
+    void check_part_size(const zheader &header) const;
+
     /// <summary>
     ///
     /// </summary>
     bool read_central_header();
 
     /// <summary>
-    ///
+    /// Returns a streambuf reading the member described by header directly from
+    /// memory_source_. Stored members are returned without copying or buffering.
+    /// </summary>
+    std::unique_ptr<std::streambuf> open_in_memory(const zheader &header) const;
+
+    /// <summary>
+    /// Returns the first compressed byte of the member described by header in memory_source_.
     /// </summary>
-    std::unordered_map<std::string, zheader> file_headers_;
+    const std::uint8_t *member_in_memory(const zheader &header) const;
+
+    /// <summary>
+    /// Returns the offset in the archive of the first compressed byte of the member
+    /// described by header, after its local header.
+    /// </summary>
+    std::uint64_t member_offset(const zheader &header) const;
+
+    /// <summary>
+    /// Reads the header.compressed_size bytes of the member described by header from
+    /// source_stream_ into destination.
+    /// </summary>
+    void read_member(const zheader &header, std::uint8_t *destination) const;
+
+    /// <summary>
+    /// Decompresses the whole member described by header into the header.uncompressed_size
+    /// bytes at destination, with a single call to the inflater for deflated members.
+    /// </summary>
+    void read_whole(const zheader &header, std::uint8_t *destination) const;
+
+    /// <summary>
+    /// The central headers of the files, or the headers of the members reached so far
+    /// with their sizes from the data descriptors if the archive is read forward-only.
+    /// </summary>
+    mutable std::unordered_map<std::string, zheader> file_headers_;
 
     /// <summary>
     ///
     /// </summary>
     std::istream &source_stream_;
+
+    /// <summary>
+    /// The size of the decompression buffers of each opened file.
+    /// </summary>
+    std::size_t buffer_size_;
+
+    /// <summary>
+    /// The source stream's buffer when the whole archive is already in memory,
+    /// otherwise nullptr.
+    /// </summary>
+    const memory_istreambuf *memory_source_;
+
+    /// <summary>
+    /// Where the decompression of files is recorded, or nullptr.
+    /// </summary>
+    io_stats *stats_;
+
+    /// <summary>
+    /// The largest uncompressed size of a file which may be opened, or 0 for no limit.
+    /// </summary>
+    std::uint64_t max_part_size_ = 0;
+
+    /// <summary>
+    /// Where the files opened take their inflaters and buffers from, or nullptr.
+    /// </summary>
+    std::shared_ptr<load_buffers> buffers_;
+
+    /// <summary>
+    /// The members read so far from a forward-only archive, or nullptr if the central
+    /// directory was read.
+    /// </summary>
+    std::unique_ptr<forward_state> forward_;
 };
 
 } // namespace detail
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <ctime>
 #include <xlnt/utils/optional.hpp>
 #include <xlnt/utils/environment.hpp>
@@ -92,5 +93,40 @@ inline optional<std::tm> gmtime_safe(std::time_t raw_time)
     return returned_value;
 }
 
+/// Converts a number of days since 1970-01-01 in the proleptic Gregorian calendar into a year, month and day
+/// with the algorithm of Neri and Schneider, "Euclidean affine functions and their application to calendar
+/// algorithms" (2022), which needs no branches, tables or divisions by anything but constants.
+/// Returns false without touching the outputs if days is below -12699422 or above 1061042401, where the
+/// 32-bit intermediate values would overflow.
+inline bool civil_from_days(std::int64_t days, int &year, int &month, int &day)
+{
+    // shift the epoch by 82 eras of 400 years so the arithmetic stays unsigned
+    const std::uint32_t era_shift = 82;
+    const std::int64_t offset = 719468 + 146097 * static_cast<std::int64_t>(era_shift);
+
+    if (days < -offset || days > 1061042401)
+    {
+        return false;
+    }
+
+    const auto n = static_cast<std::uint32_t>(days + offset);
+    const std::uint32_t n1 = 4 * n + 3;
+    const std::uint32_t century = n1 / 146097;
+    const std::uint32_t n2 = (n1 % 146097) | 3;
+    const std::uint64_t p2 = std::uint64_t(2939745) * n2;
+    const auto year_of_century = static_cast<std::uint32_t>(p2 >> 32);
+    const std::uint32_t day_of_year = static_cast<std::uint32_t>(p2) / 2939745 / 4;
+    const std::uint32_t n3 = 2141 * day_of_year + 197913;
+    const std::uint32_t march_month = n3 >> 16;
+    const bool january_or_february = day_of_year >= 306;
+
+    year = static_cast<int>(static_cast<std::int64_t>(100 * century + year_of_century)
+        - 400 * static_cast<std::int64_t>(era_shift) + (january_or_february ? 1 : 0));
+    month = static_cast<int>(january_or_february ? march_month - 12 : march_month);
+    day = static_cast<int>((n3 & 0xFFFF) / 2141 + 1);
+
+    return true;
+}
+
 } // namespace detail
 } // namespace xlnt
@@ -22,6 +22,10 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated"
 #pragma clang diagnostic ignored "-Wweak-vtables"
@@ -86,13 +90,36 @@ std::string latin1_to_utf8(const std::string &latin1)
 
 size_t string_length(const std::string &utf8_string)
 {
-    auto end_it = utf8::find_invalid(utf8_string.begin(), utf8_string.end());
-    if (end_it != utf8_string.end())
+    const auto data = utf8_string.data();
+    const auto size = utf8_string.size();
+    std::size_t ascii = 0;
+
+    // ASCII needs neither validation nor decoding, so skip it a word at a time
+    for (std::uint64_t word = 0; ascii + sizeof(word) <= size; ascii += sizeof(word))
+    {
+        std::memcpy(&word, data + ascii, sizeof(word));
+        if ((word & 0x8080808080808080ULL) != 0) break;
+    }
+
+    while (ascii < size && static_cast<unsigned char>(data[ascii]) < 0x80)
+    {
+        ++ascii;
+    }
+
+    if (ascii == size)
+    {
+        return size;
+    }
+
+    const auto rest = utf8_string.begin() + static_cast<std::ptrdiff_t>(ascii);
+    if (utf8::find_invalid(rest, utf8_string.end()) != utf8_string.end())
     {
         throw xlnt::exception("Invalid UTF-8 encoding detected");
     }
 
-    return static_cast<std::size_t>(utf8::distance(utf8_string.begin(), end_it));
+    // the rest is valid, so every byte other than a continuation byte starts a code point
+    return ascii + static_cast<std::size_t>(std::count_if(rest, utf8_string.end(),
+        [](char c) { return (static_cast<unsigned char>(c) & 0xc0) != 0x80; }));
 }
 
 #if XLNT_HAS_FEATURE(U8_STRING_VIEW)
@@ -0,0 +1,72 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+// Estimates of the bytes containers allocate beyond their own size, used for
+// workbook::memory_usage. Node sizes assume the usual implementations.
+
+inline std::size_t heap_size(const std::string &text)
+{
+    // short strings are stored inside the string itself
+    static const auto inline_capacity = std::string().capacity();
+    return text.capacity() > inline_capacity ? text.capacity() + 1 : 0;
+}
+
+template <typename T>
+std::size_t heap_size(const std::vector<T> &elements)
+{
+    return elements.capacity() * sizeof(T);
+}
+
+template <typename Key, typename Value, typename... Rest>
+std::size_t heap_size(const std::unordered_map<Key, Value, Rest...> &map)
+{
+    // a node holds the next pointer and the cached hash with the element
+    const auto node = sizeof(typename std::unordered_map<Key, Value, Rest...>::value_type)
+        + sizeof(void *) + sizeof(std::size_t);
+
+    return map.bucket_count() * sizeof(void *) + map.size() * node;
+}
+
+template <typename Key, typename Value, typename... Rest>
+std::size_t heap_size(const std::map<Key, Value, Rest...> &map)
+{
+    // a node holds three pointers and the colour of the tree with the element
+    const auto node = sizeof(typename std::map<Key, Value, Rest...>::value_type) + 4 * sizeof(void *);
+
+    return map.size() * node;
+}
+
+} // namespace detail
+} // namespace xlnt
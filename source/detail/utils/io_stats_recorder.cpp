@@ -0,0 +1,84 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <mutex>
+
+#include <detail/utils/io_stats_recorder.hpp>
+
+namespace xlnt {
+namespace detail {
+
+namespace {
+
+// recording is rare enough, once per phase or part, for a single lock to do
+std::mutex &stats_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+} // namespace
+
+void record_phase(io_stats *stats, io_stats::phase io_stats::*phase,
+    double seconds, std::uint64_t bytes, std::size_t count)
+{
+    if (stats == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(stats_mutex());
+    auto &recorded = stats->*phase;
+    recorded.seconds += seconds;
+    recorded.bytes += bytes;
+    recorded.count += count;
+}
+
+void record_part(io_stats *stats, io_stats::phase io_stats::*phase,
+    const std::string &path, double seconds, std::uint64_t bytes)
+{
+    if (stats == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(stats_mutex());
+    auto &recorded = stats->*phase;
+    recorded.seconds += seconds;
+    recorded.bytes += bytes;
+    ++recorded.count;
+
+    io_stats::part part;
+    part.path = path;
+    part.compression.seconds = seconds;
+    part.compression.bytes = bytes;
+    part.compression.count = 1;
+    stats->parts.push_back(part);
+}
+
+void record_counts(io_stats *stats, std::size_t cells, std::size_t strings, std::size_t formats)
+{
+    if (stats == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(stats_mutex());
+    stats->cells += cells;
+    stats->strings += strings;
+    stats->formats += formats;
+}
+
+} // namespace detail
+} // namespace xlnt
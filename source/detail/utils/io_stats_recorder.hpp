@@ -0,0 +1,108 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <xlnt/workbook/io_stats.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Adds seconds, bytes and count to the given phase of stats, unless stats is
+/// nullptr. This is safe to call from several threads at once.
+/// </summary>
+void XLNT_API_INTERNAL record_phase(io_stats *stats, io_stats::phase io_stats::*phase,
+    double seconds, std::uint64_t bytes, std::size_t count = 1);
+
+/// <summary>
+/// Adds a part of the archive to stats, unless it is nullptr, and its time and bytes to
+/// the given phase, which is io_stats::inflate or io_stats::deflate. This is safe to
+/// call from several threads at once.
+/// </summary>
+void XLNT_API_INTERNAL record_part(io_stats *stats, io_stats::phase io_stats::*phase,
+    const std::string &path, double seconds, std::uint64_t bytes);
+
+/// <summary>
+/// Adds counts to the cells, strings and formats of stats, unless it is nullptr.
+/// This is safe to call from several threads at once.
+/// </summary>
+void XLNT_API_INTERNAL record_counts(io_stats *stats, std::size_t cells, std::size_t strings, std::size_t formats);
+
+/// <summary>
+/// Records the wall time from its construction to its destruction, and the bytes
+/// added to it, as one occurrence of a phase of stats. Nothing is measured if stats
+/// is nullptr, so the timer costs next to nothing when statistics aren't wanted.
+/// </summary>
+class XLNT_API_INTERNAL phase_timer
+{
+public:
+    phase_timer(io_stats *stats, io_stats::phase io_stats::*phase)
+        : stats_(stats),
+          phase_(phase)
+    {
+        if (stats_ != nullptr)
+        {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    phase_timer(const phase_timer &) = delete;
+    phase_timer &operator=(const phase_timer &) = delete;
+
+    ~phase_timer()
+    {
+        if (stats_ != nullptr)
+        {
+            record_phase(stats_, phase_, seconds_since(start_), bytes_);
+        }
+    }
+
+    void add_bytes(std::uint64_t bytes)
+    {
+        bytes_ += bytes;
+    }
+
+    /// <summary>
+    /// Returns the seconds elapsed since start.
+    /// </summary>
+    static double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    io_stats *stats_;
+    io_stats::phase io_stats::*phase_;
+    std::chrono::steady_clock::time_point start_;
+    std::uint64_t bytes_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
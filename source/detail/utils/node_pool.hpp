@@ -0,0 +1,226 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Hands out small blocks of memory carved from large chunks and keeps the blocks which
+/// are given back on a free list per size for reuse. The chunks are only released when
+/// the pool is destroyed, so tearing down millions of container nodes costs a few frees.
+/// A pool isn't thread-safe, each one serves the containers of a single owner.
+/// </summary>
+class node_pool
+{
+public:
+    /// <summary>
+    /// Blocks are rounded up to, and aligned at, multiples of this.
+    /// </summary>
+    static const std::size_t granularity = alignof(std::max_align_t) < sizeof(void *) ? sizeof(void *) : alignof(std::max_align_t);
+
+    /// <summary>
+    /// Larger blocks aren't pooled.
+    /// </summary>
+    static const std::size_t max_block_size = 32 * granularity;
+
+    node_pool() = default;
+    node_pool(const node_pool &) = delete;
+    node_pool &operator=(const node_pool &) = delete;
+
+    void *allocate(std::size_t size)
+    {
+        if (size > max_block_size)
+        {
+            return ::operator new(size);
+        }
+
+        const auto size_class = (size + granularity - 1) / granularity;
+        auto &head = free_[size_class - 1];
+
+        if (head != nullptr)
+        {
+            auto block = head;
+            head = head->next;
+
+            return block;
+        }
+
+        const auto rounded = size_class * granularity;
+
+        if (static_cast<std::size_t>(end_ - cursor_) < rounded)
+        {
+            // the rest of the current chunk is abandoned; chunks double up to 1 MiB
+            chunk_size_ = chunks_.empty() ? 4096 : (chunk_size_ < 1024 * 1024 ? chunk_size_ * 2 : chunk_size_);
+            chunks_.emplace_back(new max_aligned[chunk_size_ / sizeof(max_aligned)]);
+            cursor_ = reinterpret_cast<char *>(chunks_.back().get());
+            end_ = cursor_ + chunk_size_;
+            capacity_ += chunk_size_;
+        }
+
+        auto block = cursor_;
+        cursor_ += rounded;
+
+        return block;
+    }
+
+    void deallocate(void *block, std::size_t size)
+    {
+        if (size > max_block_size)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        auto freed = static_cast<free_block *>(block);
+        auto &head = free_[(size + granularity - 1) / granularity - 1];
+        freed->next = head;
+        head = freed;
+    }
+
+    /// <summary>
+    /// Returns the number of bytes held in chunks by this pool.
+    /// </summary>
+    std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    using max_aligned = std::aligned_storage<granularity, granularity>::type;
+
+    std::vector<std::unique_ptr<max_aligned[]>> chunks_;
+    std::size_t chunk_size_ = 0;
+    std::size_t capacity_ = 0;
+    char *cursor_ = nullptr;
+    char *end_ = nullptr;
+    free_block *free_[max_block_size / granularity] = {};
+};
+
+/// <summary>
+/// An allocator drawing single elements from a node_pool, which suits the nodes of
+/// std::unordered_map and std::map. Arrays, like the buckets of a hash table, come from
+/// operator new. A default constructed allocator creates a pool of its own which is shared
+/// by its rebound copies, and a copied container gets a new pool so that containers never
+/// share a pool across owners.
+/// </summary>
+template <typename T>
+class pool_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    pool_allocator()
+        : pool_(std::make_shared<node_pool>())
+    {
+    }
+
+    pool_allocator(const pool_allocator &other)
+        : pool_(other.pool_)
+    {
+    }
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U> &other)
+        : pool_(other.pool_)
+    {
+    }
+
+    // copies rather than moves, so that a moved-from container keeps a usable pool
+    pool_allocator &operator=(const pool_allocator &other)
+    {
+        pool_ = other.pool_;
+        return *this;
+    }
+
+    T *allocate(std::size_t count)
+    {
+        if (count == 1 && alignof(T) <= node_pool::granularity)
+        {
+            return static_cast<T *>(pool_->allocate(sizeof(T)));
+        }
+
+        return static_cast<T *>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T *element, std::size_t count)
+    {
+        if (count == 1 && alignof(T) <= node_pool::granularity)
+        {
+            pool_->deallocate(element, sizeof(T));
+            return;
+        }
+
+        ::operator delete(element);
+    }
+
+    pool_allocator select_on_container_copy_construction() const
+    {
+        return pool_allocator();
+    }
+
+    /// <summary>
+    /// Returns the number of bytes held in chunks by the pool of this allocator.
+    /// </summary>
+    std::size_t capacity() const
+    {
+        return pool_->capacity();
+    }
+
+    template <typename U>
+    bool operator==(const pool_allocator<U> &other) const
+    {
+        return pool_ == other.pool_;
+    }
+
+    template <typename U>
+    bool operator!=(const pool_allocator<U> &other) const
+    {
+        return pool_ != other.pool_;
+    }
+
+private:
+    template <typename U>
+    friend class pool_allocator;
+
+    std::shared_ptr<node_pool> pool_;
+};
+
+} // namespace detail
+} // namespace xlnt
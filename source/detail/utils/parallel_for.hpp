@@ -0,0 +1,107 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+
+#include <xlnt/utils/executor.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Calls worker up to thread_count times on the current executor, or once on the
+/// calling thread if that is 1 or less. worker must take its work from a queue shared
+/// by the calls and mustn't throw.
+/// </summary>
+template <typename Worker>
+void run_workers(std::size_t thread_count, Worker worker)
+{
+    if (thread_count <= 1)
+    {
+        worker();
+        return;
+    }
+
+    current_executor()->run(thread_count, worker);
+}
+
+/// <summary>
+/// Calls function(i) for every i in [0, count) using up to thread_count threads
+/// of the current executor. The indices are handed out one at a time, so
+/// function may be called in any order. If function throws, the remaining indices
+/// are skipped and the first exception is rethrown once all threads have finished.
+/// </summary>
+template <typename Function>
+void parallel_for(std::size_t count, std::size_t thread_count, Function function)
+{
+    std::atomic<std::size_t> next(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto work = [&]() {
+        try
+        {
+            for (auto i = next++; i < count; i = next++)
+            {
+                function(i);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            next = count;
+        }
+    };
+
+    run_workers(std::min(thread_count, count), work);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/// <summary>
+/// Returns the number of threads worth using for count pieces of work when a
+/// thread should only be started for at least per_thread pieces, up to the
+/// concurrency of the current executor.
+/// </summary>
+inline std::size_t parallel_thread_count(std::size_t count, std::size_t per_thread)
+{
+    return std::max(std::size_t(1), std::min(current_executor()->concurrency(), count / per_thread));
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,66 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/utils/progress_reporter.hpp>
+
+namespace xlnt {
+namespace detail {
+
+progress_reporter::progress_reporter(const progress_callback &callback, std::size_t interval)
+    : callback_(callback),
+      interval_(std::max<std::size_t>(interval, 1)),
+      cancelled_(false)
+{
+}
+
+void progress_reporter::report(worksheet_progress &worksheet, bool done)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (cancelled_)
+    {
+        throw operation_cancelled();
+    }
+
+    total_cells_ += worksheet.cells - worksheet.reported;
+    worksheet.reported = worksheet.cells;
+
+    progress current;
+    current.worksheet = worksheet.title;
+    current.worksheet_cells = worksheet.cells;
+    current.total_cells = total_cells_;
+    current.worksheet_done = done;
+
+    if (!callback_(current))
+    {
+        cancelled_ = true;
+        throw operation_cancelled();
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
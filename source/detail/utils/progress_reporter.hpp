@@ -0,0 +1,95 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include <xlnt/workbook/progress.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Calls the progress callback of a load or save as the cells of its worksheets are
+/// read or written, and turns a cancellation into operation_cancelled. One reporter is
+/// shared by all threads of a load or save; it serializes the calls of the callback.
+/// </summary>
+class XLNT_API_INTERNAL progress_reporter
+{
+public:
+    /// <summary>
+    /// The cells done in one worksheet, owned by the thread reading or writing it.
+    /// </summary>
+    struct worksheet_progress
+    {
+        std::string title;
+        std::size_t cells = 0;
+        std::size_t reported = 0;
+    };
+
+    progress_reporter(const progress_callback &callback, std::size_t interval);
+
+    progress_reporter(const progress_reporter &) = delete;
+    progress_reporter &operator=(const progress_reporter &) = delete;
+
+    /// <summary>
+    /// Adds cells to worksheet and calls the callback once interval cells have been
+    /// added since its last call for worksheet. Throws operation_cancelled if the
+    /// callback has returned false, also from another worksheet's thread.
+    /// </summary>
+    void add_cells(worksheet_progress &worksheet, std::size_t cells)
+    {
+        worksheet.cells += cells;
+
+        if (worksheet.cells - worksheet.reported >= interval_ || cancelled_.load(std::memory_order_relaxed))
+        {
+            report(worksheet, false);
+        }
+    }
+
+    /// <summary>
+    /// Calls the callback for the last time for worksheet, whose cells are all done.
+    /// </summary>
+    void finish(worksheet_progress &worksheet)
+    {
+        report(worksheet, true);
+    }
+
+private:
+    void report(worksheet_progress &worksheet, bool done);
+
+    progress_callback callback_;
+    std::size_t interval_;
+    std::mutex mutex_;
+    std::size_t total_cells_ = 0;
+    std::atomic<bool> cancelled_;
+};
+
+} // namespace detail
+} // namespace xlnt
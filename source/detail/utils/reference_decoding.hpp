@@ -0,0 +1,222 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+namespace detail {
+
+// Decoders shared by cell_reference, column_t and the sheetData parsers. They work on
+// raw character ranges so that the hot paths never build intermediate strings, and test
+// each character with a single unsigned comparison instead of the locale-aware ctype functions.
+
+/// <summary>
+/// Decodes the column letters at the start of [begin, end), in either case, into a one-based
+/// column index and returns a pointer past the last letter. Letters beyond the third are
+/// consumed as well, but leave column at zero since no column has more than three letters.
+/// </summary>
+inline const char *decode_column_letters(const char *begin, const char *end, column_t::index_t &column) noexcept
+{
+    column_t::index_t result = 0;
+    auto cursor = begin;
+
+    for (; cursor != end; ++cursor)
+    {
+        // setting bit 5 maps upper case ASCII letters onto lower case ones and nothing else onto a-z
+        const auto letter = static_cast<unsigned char>((static_cast<unsigned char>(*cursor) | 0x20) - 'a');
+        if (letter >= 26) break;
+        result = result * 26 + letter + 1;
+    }
+
+    column = cursor - begin > 3 ? 0 : result;
+
+    return cursor;
+}
+
+/// <summary>
+/// Decodes the decimal digits at the start of [begin, end) into row and returns a pointer past
+/// the last digit. A number which doesn't fit in row_t leaves row above its maximum.
+/// </summary>
+inline const char *decode_row_digits(const char *begin, const char *end, std::uint64_t &row) noexcept
+{
+    const auto limit = static_cast<std::uint64_t>(std::numeric_limits<row_t>::max());
+    std::uint64_t result = 0;
+    auto cursor = begin;
+
+    for (; cursor != end; ++cursor)
+    {
+        const auto digit = static_cast<unsigned char>(static_cast<unsigned char>(*cursor) - '0');
+        if (digit >= 10) break;
+        if (result <= limit) result = result * 10 + digit;
+    }
+
+    row = result;
+
+    return cursor;
+}
+
+/// <summary>
+/// Decodes a cell reference such as "B7" or "$AA$100" spanning exactly [begin, end).
+/// Returns false if it isn't one, otherwise column and row are set as by
+/// decode_column_letters and decode_row_digits.
+/// </summary>
+inline bool decode_cell_reference(const char *begin, const char *end, column_t::index_t &column,
+    std::uint64_t &row, bool &absolute_column, bool &absolute_row) noexcept
+{
+    absolute_column = begin != end && *begin == '$';
+    if (absolute_column) ++begin;
+
+    const auto letters_end = decode_column_letters(begin, end, column);
+
+    if (letters_end == begin)
+    {
+        return false;
+    }
+
+    begin = letters_end;
+    absolute_row = begin != end && *begin == '$';
+    if (absolute_row) ++begin;
+
+    const auto digits_end = decode_row_digits(begin, end, row);
+
+    return digits_end != begin && digits_end == end;
+}
+
+/// <summary>
+/// Resolves the columns of the cells of one row. Cells are almost always written in order,
+/// so the r attribute of a cell is first compared with the letters of the column following
+/// the previous cell and only decoded if it doesn't start with them. As the specification
+/// requires, a cell without an r attribute is in the column following the previous cell.
+/// </summary>
+class sequential_column
+{
+public:
+    sequential_column() noexcept
+    {
+        reset();
+    }
+
+    /// <summary>
+    /// Starts a new row, the next cell of which is expected in column A.
+    /// </summary>
+    void reset() noexcept
+    {
+        assign(1);
+    }
+
+    /// <summary>
+    /// Returns the column of the cell whose r attribute is [begin, end), which is zero if
+    /// it has more than three letters, and expects the next cell in the column after it.
+    /// </summary>
+    column_t::index_t resolve(const char *begin, const char *end) noexcept
+    {
+        const auto size = static_cast<std::size_t>(end - begin);
+
+        if (length_ == 0 || size <= length_ || std::memcmp(begin, letters_, length_) != 0
+            || static_cast<unsigned char>(static_cast<unsigned char>(begin[length_]) - '0') >= 10)
+        {
+            column_t::index_t column = 0;
+            decode_column_letters(begin, end, column);
+            assign(column);
+
+            if (column == 0)
+            {
+                return 0;
+            }
+        }
+
+        return next();
+    }
+
+    /// <summary>
+    /// Returns the column of a cell without an r attribute and expects the next cell
+    /// in the column after it.
+    /// </summary>
+    column_t::index_t next() noexcept
+    {
+        const auto column = column_++;
+
+        // increment the letters like a base 26 number without a zero digit
+        auto digit = length_;
+
+        while (digit > 0 && letters_[digit - 1] == 'Z')
+        {
+            letters_[--digit] = 'A';
+        }
+
+        if (digit > 0)
+        {
+            ++letters_[digit - 1];
+        }
+        else if (length_ < 3)
+        {
+            std::memmove(letters_ + 1, letters_, length_);
+            letters_[0] = 'A';
+            ++length_;
+        }
+        else
+        {
+            // past ZZZ, only decoding can tell
+            length_ = 0;
+        }
+
+        return column;
+    }
+
+private:
+    void assign(column_t::index_t column) noexcept
+    {
+        column_ = column;
+        length_ = 0;
+
+        if (column == 0 || column > 18278) // ZZZ
+        {
+            return;
+        }
+
+        char reversed[3];
+
+        for (; column > 0; column = (column - 1) / 26)
+        {
+            reversed[length_++] = static_cast<char>('A' + (column - 1) % 26);
+        }
+
+        for (std::size_t i = 0; i < length_; ++i)
+        {
+            letters_[i] = reversed[length_ - 1 - i];
+        }
+    }
+
+    column_t::index_t column_ = 1;
+    char letters_[3] = {'A', 0, 0};
+    std::size_t length_ = 1;
+};
+
+} // namespace detail
+} // namespace xlnt
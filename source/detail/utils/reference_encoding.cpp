@@ -0,0 +1,119 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/utils/reference_encoding.hpp>
+
+namespace {
+
+// the columns Excel allows, XFD being the last one
+const xlnt::column_t::index_t table_columns = 16384;
+
+// the letters of a column, padded with nulls, followed by their number in the last byte
+using column_letters = std::array<char, 4>;
+
+// Writes the letters of column backwards, ending just before end, and returns a pointer
+// to the first one.
+char *encode_letters_backwards(xlnt::column_t::index_t column, char *end)
+{
+    while (column > 0)
+    {
+        // bijective base 26: A is 1 and Z is 26, there is no digit for zero
+        const auto remainder = (column - 1) % 26;
+        *--end = static_cast<char>('A' + remainder);
+        column = (column - 1) / 26;
+    }
+
+    return end;
+}
+
+const std::vector<column_letters> &column_letter_table()
+{
+    static const std::vector<column_letters> table = [] {
+        std::vector<column_letters> letters(table_columns + 1, column_letters{{0, 0, 0, 0}});
+
+        for (xlnt::column_t::index_t column = 1; column <= table_columns; ++column)
+        {
+            char encoded[3];
+            const auto first = encode_letters_backwards(column, encoded + 3);
+            const auto length = encoded + 3 - first;
+            std::memcpy(letters[column].data(), first, static_cast<std::size_t>(length));
+            letters[column][3] = static_cast<char>(length);
+        }
+
+        return letters;
+    }();
+
+    return table;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+char *encode_column_letters(column_t::index_t column, char *buffer)
+{
+    if (column == 0)
+    {
+        throw invalid_column_index();
+    }
+
+    if (column <= table_columns)
+    {
+        const auto &letters = column_letter_table()[column];
+        std::memcpy(buffer, letters.data(), 3);
+        return buffer + letters[3];
+    }
+
+    char encoded[max_column_letters];
+    const auto first = encode_letters_backwards(column, encoded + max_column_letters);
+    const auto length = static_cast<std::size_t>(encoded + max_column_letters - first);
+    std::memcpy(buffer, first, length);
+
+    return buffer + length;
+}
+
+char *encode_row_digits(row_t row, char *buffer) noexcept
+{
+    char digits[max_row_digits];
+    auto first = digits + max_row_digits;
+
+    do
+    {
+        *--first = static_cast<char>('0' + row % 10);
+        row /= 10;
+    } while (row != 0);
+
+    const auto length = static_cast<std::size_t>(digits + max_row_digits - first);
+    std::memcpy(buffer, first, length);
+
+    return buffer + length;
+}
+
+} // namespace detail
+} // namespace xlnt
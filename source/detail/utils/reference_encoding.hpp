@@ -0,0 +1,60 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/cell/index_types.hpp>
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+// Encoders shared by column_t, cell_reference and the worksheet writer. They write into a
+// caller buffer and return a pointer past the last character, without a terminating null.
+
+/// <summary>
+/// The most characters encode_column_letters writes, for the largest column_t::index_t.
+/// </summary>
+const std::size_t max_column_letters = 7;
+
+/// <summary>
+/// The most characters encode_row_digits writes, for the largest row_t.
+/// </summary>
+const std::size_t max_row_digits = 10;
+
+/// <summary>
+/// Writes the letters of the one-based column to buffer, which must have room for
+/// max_column_letters characters, taking the columns A to XFD from a table built once.
+/// Throws invalid_column_index for column zero.
+/// </summary>
+XLNT_API_INTERNAL char *encode_column_letters(column_t::index_t column, char *buffer);
+
+/// <summary>
+/// Writes the decimal digits of row to buffer.
+/// </summary>
+XLNT_API_INTERNAL char *encode_row_digits(row_t row, char *buffer) noexcept;
+
+} // namespace detail
+} // namespace xlnt
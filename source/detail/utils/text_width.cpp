@@ -0,0 +1,164 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+#include <xlnt/styles/font.hpp>
+#include <detail/utils/text_width.hpp>
+
+namespace {
+
+/// <summary>
+/// The advance widths of the characters from space to tilde in Calibri, in units of
+/// 1/2048 em.
+/// </summary>
+const std::uint16_t calibri_widths[95] = {
+    463, 667, 821, 1020, 1038, 1464, 1397, 452, 621, 621, 1020, 1020, 511, 627, 517, 791, // space to /
+    1038, 1038, 1038, 1038, 1038, 1038, 1038, 1038, 1038, 1038, // 0 to 9
+    548, 548, 1020, 1020, 1020, 949, 1831, // : to @
+    1185, 1114, 1092, 1260, 1000, 941, 1292, 1276, 516, 653, 1064, 861, 1751, // A to M
+    1322, 1356, 1058, 1378, 1112, 941, 998, 1314, 1162, 1822, 1063, 998, 959, // N to Z
+    628, 791, 628, 1020, 1020, 596, // [ to `
+    981, 1076, 866, 1076, 1019, 625, 964, 1076, 470, 490, 931, 470, 1636, // a to m
+    1076, 1080, 1076, 1076, 714, 801, 686, 1076, 925, 1464, 887, 927, 809, // n to z
+    714, 941, 714, 1020}; // { to ~
+
+const double calibri_digit = 1038.0;
+
+/// <summary>
+/// The width of a digit of the family name relative to one of Calibri, as a family which
+/// isn't known is assumed to be drawn like Calibri.
+/// </summary>
+double family_scale(const std::string &name)
+{
+    struct family
+    {
+        const char *name;
+        double digit;
+    };
+
+    // digit advance widths in units of 1/2048 em
+    static const family families[] = {{"arial", 1139.0}, {"helvetica", 1139.0}, {"times new roman", 1024.0},
+        {"verdana", 1302.0}, {"tahoma", 1118.0}, {"segoe ui", 1133.0}, {"cambria", 1139.0}, {"aptos", 1130.0},
+        {"georgia", 1248.0}};
+
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+    for (const auto &known : families)
+    {
+        if (lower == known.name) return known.digit / calibri_digit;
+    }
+
+    return 1.0;
+}
+
+bool is_monospaced(const std::string &name)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+    return lower.find("courier") != std::string::npos || lower.find("mono") != std::string::npos
+        || lower == "consolas" || lower == "lucida console" || lower == "menlo";
+}
+
+/// <summary>
+/// Returns true for the code points East Asian text draws two columns wide.
+/// </summary>
+bool is_wide(std::uint32_t code_point)
+{
+    return (code_point >= 0x1100 && code_point <= 0x115F) || (code_point >= 0x2E80 && code_point <= 0xA4CF)
+        || (code_point >= 0xAC00 && code_point <= 0xD7A3) || (code_point >= 0xF900 && code_point <= 0xFAFF)
+        || (code_point >= 0xFE30 && code_point <= 0xFE4F) || (code_point >= 0xFF00 && code_point <= 0xFF60)
+        || (code_point >= 0xFFE0 && code_point <= 0xFFE6) || code_point >= 0x20000;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+text_width_table::text_width_table(const font &f)
+{
+    // bold glyphs of Calibri are about 4% wider
+    const auto scale = f.size() / 11.0 * (f.bold() ? 1.04 : 1.0) * family_scale(f.name());
+    const auto monospaced = is_monospaced(f.name());
+
+    ascii_.fill(0.0f);
+
+    for (std::size_t c = 32; c < 127; ++c)
+    {
+        ascii_[c] = static_cast<float>((monospaced ? 1.0 : calibri_widths[c - 32] / calibri_digit) * scale);
+    }
+
+    digit_ = scale;
+}
+
+double text_width_table::measure(const std::string &text) const
+{
+    auto widest = 0.0;
+    auto line = 0.0;
+    const auto size = text.size();
+
+    for (std::size_t i = 0; i < size;)
+    {
+        const auto lead = static_cast<unsigned char>(text[i]);
+
+        if (lead < 0x80)
+        {
+            if (lead == '\n')
+            {
+                widest = std::max(widest, line);
+                line = 0.0;
+            }
+            else
+            {
+                line += ascii_[lead];
+            }
+
+            ++i;
+            continue;
+        }
+
+        // the length of the sequence comes from its lead byte, continuation bytes on their own count as one
+        const auto length = lead >= 0xF0 ? 4u : lead >= 0xE0 ? 3u : lead >= 0xC0 ? 2u : 1u;
+        auto code_point = static_cast<std::uint32_t>(length == 1 ? lead : lead & (0x7F >> length));
+
+        for (std::size_t k = 1; k < length && i + k < size; ++k)
+        {
+            code_point = (code_point << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3Fu);
+        }
+
+        line += is_wide(code_point) ? 2 * digit_ : digit_;
+        i += length;
+    }
+
+    return std::max(widest, line);
+}
+
+} // namespace detail
+} // namespace xlnt
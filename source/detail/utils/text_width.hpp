@@ -0,0 +1,71 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <detail/xlnt_config_impl.hpp>
+
+namespace xlnt {
+
+class font;
+
+namespace detail {
+
+/// <summary>
+/// Estimates the width of text drawn in a font in the units of column widths, which
+/// are the width of a digit in Calibri 11, the default font. The widths of the printable
+/// ASCII characters are worked out once from the advance widths of Calibri, scaled by the
+/// size of the font, the width of the digits of a few common families and bold text.
+/// Every character of a monospaced family is as wide as a digit. East Asian wide
+/// characters count as two digits and other characters outside ASCII as one.
+/// </summary>
+class XLNT_API_INTERNAL text_width_table
+{
+public:
+    explicit text_width_table(const font &f);
+
+    /// <summary>
+    /// Returns the width of the widest line of text, which is UTF-8. Invalid sequences
+    /// are measured byte by byte rather than rejected.
+    /// </summary>
+    double measure(const std::string &text) const;
+
+    /// <summary>
+    /// Returns the width of a digit, which every character of a formatted number is
+    /// close enough to.
+    /// </summary>
+    double digit() const
+    {
+        return digit_;
+    }
+
+private:
+    std::array<float, 128> ascii_;
+    double digit_ = 1.0;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,181 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <detail/utils/trace.hpp>
+
+#if defined(XLNT_TRACE) && XLNT_TRACE
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+namespace {
+
+struct trace_event
+{
+    const char *name;
+    std::string detail;
+    long long start_us;
+    long long duration_us;
+    int thread;
+};
+
+void append_json_string(std::string &out, const std::string &value)
+{
+    out.push_back('"');
+
+    for (auto c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                out.append(escaped);
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+    }
+
+    out.push_back('"');
+}
+
+// Events are only buffered while the program runs and written out once, when the
+// static buffer is destroyed at exit, so tracing doesn't add file I/O to the
+// measured phases.
+class trace_buffer
+{
+public:
+    trace_buffer()
+        : origin_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~trace_buffer()
+    {
+        const char *path = std::getenv("XLNT_TRACE_FILE");
+        auto file = std::fopen(path != nullptr && *path != '\0' ? path : "xlnt_trace.json", "wb");
+        if (file == nullptr) return;
+
+        std::string json = "{\"traceEvents\":[\n";
+
+        for (std::size_t i = 0; i < events_.size(); ++i)
+        {
+            const auto &event = events_[i];
+
+            json.append(i == 0 ? "" : ",\n");
+            json.append("{\"name\":");
+            append_json_string(json, event.name);
+            json.append(",\"cat\":\"xlnt\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            json.append(std::to_string(event.thread));
+            json.append(",\"ts\":");
+            json.append(std::to_string(event.start_us));
+            json.append(",\"dur\":");
+            json.append(std::to_string(event.duration_us));
+
+            if (!event.detail.empty())
+            {
+                json.append(",\"args\":{\"detail\":");
+                append_json_string(json, event.detail);
+                json.push_back('}');
+            }
+
+            json.push_back('}');
+        }
+
+        json.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+        std::fwrite(json.data(), 1, json.size(), file);
+        std::fclose(file);
+    }
+
+    std::chrono::steady_clock::time_point origin() const
+    {
+        return origin_;
+    }
+
+    void add(const char *name, std::string &&detail, long long start_us, long long duration_us)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // small sequential ids read better in the viewer than hashed std::thread::ids
+        auto thread = threads_.emplace(std::this_thread::get_id(), static_cast<int>(threads_.size()) + 1).first->second;
+        events_.push_back(trace_event{name, std::move(detail), start_us, duration_us, thread});
+    }
+
+private:
+    std::chrono::steady_clock::time_point origin_;
+    std::mutex mutex_;
+    std::unordered_map<std::thread::id, int> threads_;
+    std::vector<trace_event> events_;
+};
+
+trace_buffer &buffer()
+{
+    static trace_buffer instance;
+    return instance;
+}
+
+long long microseconds_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+} // namespace
+
+trace_scope::trace_scope(const char *name, std::string detail)
+    : name_(name),
+      detail_(std::move(detail))
+{
+    // constructs the buffer before the first event starts, so it outlives them all
+    buffer();
+    start_ = std::chrono::steady_clock::now();
+}
+
+trace_scope::~trace_scope()
+{
+    auto &events = buffer();
+    auto end = std::chrono::steady_clock::now();
+    events.add(name_, std::move(detail_), microseconds_between(events.origin(), start_), microseconds_between(start_, end));
+}
+
+} // namespace detail
+} // namespace xlnt
+
+#endif
@@ -0,0 +1,82 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <string>
+
+#include <detail/xlnt_config_impl.hpp>
+
+// Scoped trace events around the hot paths of reading and writing, for inspecting
+// where the time of a single load or save goes in chrome://tracing or Perfetto.
+// They are only compiled in when the library is built with XLNT_TRACE=1 (the
+// XLNT_TRACE CMake option); otherwise the macros expand to nothing.
+#if defined(XLNT_TRACE) && XLNT_TRACE
+
+#include <chrono>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Records one complete trace event covering the lifetime of this object on the
+/// calling thread. The events are written in Chrome trace JSON format to the file
+/// named by the XLNT_TRACE_FILE environment variable (xlnt_trace.json by default)
+/// when the program exits.
+/// </summary>
+class XLNT_API_INTERNAL trace_scope
+{
+public:
+    /// <summary>
+    /// Starts an event called name, which must be a string literal. The optional
+    /// detail, such as the path of a part, is shown in the event's arguments.
+    /// </summary>
+    explicit trace_scope(const char *name, std::string detail = std::string());
+
+    trace_scope(const trace_scope &) = delete;
+    trace_scope &operator=(const trace_scope &) = delete;
+
+    ~trace_scope();
+
+private:
+    const char *name_;
+    std::string detail_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace detail
+} // namespace xlnt
+
+#define XLNT_TRACE_CONCAT_IMPL(a, b) a##b
+#define XLNT_TRACE_CONCAT(a, b) XLNT_TRACE_CONCAT_IMPL(a, b)
+#define XLNT_TRACE_SCOPE(name) \
+    ::xlnt::detail::trace_scope XLNT_TRACE_CONCAT(xlnt_trace_scope_, __LINE__)(name)
+#define XLNT_TRACE_SCOPE_ARG(name, argument) \
+    ::xlnt::detail::trace_scope XLNT_TRACE_CONCAT(xlnt_trace_scope_, __LINE__)(name, argument)
+
+#else
+
+#define XLNT_TRACE_SCOPE(name) ((void)0)
+#define XLNT_TRACE_SCOPE_ARG(name, argument) ((void)0)
+
+#endif
@@ -30,6 +30,15 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <detail/serialization/parsers.hpp>
 
+namespace {
+
+std::string target_key(xlnt::relationship_type type, const std::string &target)
+{
+    return std::to_string(static_cast<int>(type)) + ' ' + target;
+}
+
+} // namespace
+
 namespace xlnt {
 
 void manifest::clear()
@@ -37,6 +46,8 @@ void manifest::clear()
     default_content_types_.clear();
     override_content_types_.clear();
     relationships_.clear();
+    relationship_targets_.clear();
+    next_relationship_index_.clear();
 }
 
 path manifest::canonicalize(const std::vector<xlnt::relationship> &rels) const
@@ -102,9 +113,10 @@ bool manifest::has_relationship(const path &path, const std::string &rel_id) con
 
 relationship manifest::relationship(const path &part, relationship_type type) const
 {
-    if (relationships_.find(part) == relationships_.end()) throw key_not_found();
+    auto rels = relationships_.find(part);
+    if (rels == relationships_.end()) throw key_not_found();
 
-    for (const auto &rel : relationships_.at(part))
+    for (const auto &rel : rels->second)
     {
         if (rel.second.type() == type) return rel.second;
     }
@@ -116,14 +128,17 @@ std::vector<xlnt::relationship> manifest::relationships(const path &part, relati
 {
     std::vector<xlnt::relationship> matches;
 
-    if (has_relationship(part, type))
+    auto rels = relationships_.find(part);
+    if (rels == relationships_.end())
     {
-        for (const auto &rel : relationships_.at(part))
+        return matches;
+    }
+
+    for (const auto &rel : rels->second)
+    {
+        if (rel.second.type() == type)
         {
-            if (rel.second.type() == type)
-            {
-                matches.push_back(rel.second);
-            }
+            matches.push_back(rel.second);
         }
     }
 
@@ -171,14 +186,16 @@ std::vector<path> manifest::parts_with_overriden_types() const
 
 std::vector<relationship> manifest::relationships(const path &part) const
 {
-    if (relationships_.find(part) == relationships_.end())
+    auto rels = relationships_.find(part);
+    if (rels == relationships_.end())
     {
         return {};
     }
 
     std::vector<xlnt::relationship> relationships;
+    relationships.reserve(rels->second.size());
 
-    for (const auto &rel : relationships_.at(part))
+    for (const auto &rel : rels->second)
     {
         relationships.push_back(rel.second);
     }
@@ -188,20 +205,31 @@ std::vector<relationship> manifest::relationships(const path &part) const
 
 relationship manifest::relationship(const path &part, const std::string &rel_id) const
 {
-    if (relationships_.find(part) == relationships_.end())
+    auto rels = relationships_.find(part);
+    if (rels == relationships_.end())
     {
         throw key_not_found();
     }
 
-    for (const auto &rel : relationships_.at(part))
+    auto rel = rels->second.find(rel_id);
+    if (rel == rels->second.end())
     {
-        if (rel.second.id() == rel_id)
-        {
-            return rel.second;
-        }
+        throw key_not_found();
     }
 
-    throw key_not_found();
+    return rel->second;
+}
+
+std::string manifest::relationship_id(const path &source, relationship_type type, const std::string &target) const
+{
+    auto targets = relationship_targets_.find(source);
+    if (targets == relationship_targets_.end())
+    {
+        return {};
+    }
+
+    auto match = targets->second.find(target_key(type, target));
+    return match == targets->second.end() ? std::string() : match->second;
 }
 
 std::vector<path> manifest::parts() const
@@ -228,12 +256,35 @@ std::string manifest::register_relationship(const uri &source,
     relationship_type type, const uri &target, target_mode mode)
 {
     xlnt::relationship rel(next_relationship_id(source.path()), type, source, target, mode);
-    return register_relationship(rel);
+    register_relationship(rel);
+
+    // the ids up to this one are taken, so the next one is searched for after it
+    std::size_t index = 0;
+    detail::parse(rel.id().substr(3), index);
+    next_relationship_index_[source.path()] = index + 1;
+
+    return rel.id();
 }
 
 std::string manifest::register_relationship(const class relationship &rel)
 {
-    relationships_[rel.source().path()][rel.id()] = rel;
+    auto &part_rels = relationships_[rel.source().path()];
+    auto &targets = relationship_targets_[rel.source().path()];
+    auto existing = part_rels.find(rel.id());
+
+    if (existing != part_rels.end())
+    {
+        auto replaced = targets.find(target_key(existing->second.type(), existing->second.target().path().string()));
+
+        if (replaced != targets.end() && replaced->second == rel.id())
+        {
+            targets.erase(replaced);
+        }
+    }
+
+    part_rels[rel.id()] = rel;
+    targets.emplace(target_key(rel.type(), rel.target().path().string()), rel.id());
+
     return rel.id();
 }
 
@@ -269,6 +320,17 @@ std::unordered_map<std::string, std::string> manifest::unregister_relationship(c
         part_rels.erase(old_id);
     }
 
+    // the ids have shifted, so the index of the part is rebuilt
+    auto &targets = relationship_targets_[source.path()];
+    targets.clear();
+
+    for (const auto &rel : part_rels)
+    {
+        targets.emplace(target_key(rel.second.type(), rel.second.target().path().string()), rel.first);
+    }
+
+    next_relationship_index_.erase(source.path());
+
     return id_map;
 }
 
@@ -291,12 +353,13 @@ std::vector<std::string> manifest::extensions_with_default_types() const
 
 std::string manifest::default_type(const std::string &extension) const
 {
-    if (default_content_types_.find(extension) == default_content_types_.end())
+    auto match = default_content_types_.find(extension);
+    if (match == default_content_types_.end())
     {
         throw key_not_found();
     }
 
-    return default_content_types_.at(extension);
+    return match->second;
 }
 
 void manifest::register_default_type(const std::string &extension, const std::string &content_type)
@@ -311,17 +374,22 @@ void manifest::unregister_default_type(const std::string &extension)
 
 std::string manifest::next_relationship_id(const path &part) const
 {
-    if (relationships_.find(part) == relationships_.end()) return "rId1";
+    auto rels = relationships_.find(part);
+    if (rels == relationships_.end()) return "rId1";
+
+    const auto &part_rels = rels->second;
 
-    std::size_t index = 1;
-    const auto &part_rels = relationships_.at(part);
+    auto hint = next_relationship_index_.find(part);
+    std::size_t index = hint == next_relationship_index_.end() ? 1 : hint->second;
+    std::string id = "rId" + std::to_string(index);
 
-    while (part_rels.find("rId" + std::to_string(index)) != part_rels.end())
+    while (part_rels.find(id) != part_rels.end())
     {
-        ++index;
+        id.resize(3);
+        id.append(std::to_string(++index));
     }
 
-    return "rId" + std::to_string(index);
+    return id;
 }
 
 bool manifest::has_override_type(const xlnt::path &part) const
@@ -331,12 +399,13 @@ bool manifest::has_override_type(const xlnt::path &part) const
 
 std::string manifest::override_type(const xlnt::path &part) const
 {
-    if (!has_override_type(part))
+    auto match = override_content_types_.find(part);
+    if (match == override_content_types_.end())
     {
         throw key_not_found();
     }
 
-    return override_content_types_.at(part);
+    return match->second;
 }
 
 bool manifest::operator==(const manifest &other) const
@@ -40,6 +40,7 @@ format::format(detail::format_impl *d)
 void format::clear_style()
 {
     d_->style.clear();
+    d_->parent->format_impls.refresh(d_->id);
 }
 
 format format::style(const xlnt::style &new_style)
@@ -216,6 +217,7 @@ bool format::pivot_button() const
 void format::pivot_button(bool show)
 {
     d_->pivot_button_ = show;
+    d_->parent->format_impls.refresh(d_->id);
 }
 
 bool format::quote_prefix() const
@@ -226,6 +228,7 @@ bool format::quote_prefix() const
 void format::quote_prefix(bool quote)
 {
     d_->quote_prefix_ = quote;
+    d_->parent->format_impls.refresh(d_->id);
 }
 
 } // namespace xlnt
@@ -34,59 +34,63 @@
 
 namespace {
 
-const std::unordered_map<std::size_t, xlnt::number_format> &builtin_formats()
-{
-    static std::unordered_map<std::size_t, xlnt::number_format> formats;
-
-    if (formats.size() == 0)
+std::unordered_map<std::size_t, xlnt::number_format> make_builtin_formats()
+{
+    std::unordered_map<std::size_t, xlnt::number_format> formats;
+
+    const std::unordered_map<std::size_t, std::string> format_strings{
+        {0, "General"},
+        {1, "0"},
+        {2, "0.00"},
+        {3, "#,##0"},
+        {4, "#,##0.00"},
+        {9, "0%"},
+        {10, "0.00%"},
+        {11, "0.00E+00"},
+        {12, "# ?/?"},
+        {13, "# \?\?/??"}, // escape trigraph
+        {14, "mm-dd-yy"},
+        {15, "d-mmm-yy"},
+        {16, "d-mmm"},
+        {17, "mmm-yy"},
+        {18, "h:mm AM/PM"},
+        {19, "h:mm:ss AM/PM"},
+        {20, "h:mm"},
+        {21, "h:mm:ss"},
+        {22, "m/d/yy h:mm"},
+        {37, "#,##0 ;(#,##0)"},
+        {38, "#,##0 ;[Red](#,##0)"},
+        {39, "#,##0.00;(#,##0.00)"},
+        {40, "#,##0.00;[Red](#,##0.00)"},
+
+        // 41-44 aren't in the ECMA 376 v4 standard, but Libre Office uses them
+        {41, "_(* #,##0_);_(* \\(#,##0\\);_(* \"-\"_);_(@_)"},
+        {42, "_(\"$\"* #,##0_);_(\"$\"* \\(#,##0\\);_(\"$\"* \"-\"_);_(@_)"},
+        {43, "_(* #,##0.00_);_(* \\(#,##0.00\\);_(* \"-\"??_);_(@_)"},
+        {44, "_(\"$\"* #,##0.00_)_(\"$\"* \\(#,##0.00\\)_(\"$\"* \"-\"??_)_(@_)"},
+
+        {45, "mm:ss"},
+        {46, "[h]:mm:ss"},
+        {47, "mmss.0"},
+        {48, "##0.0E+0"},
+        {49, "@"}};
+
+    for (auto format_string_pair : format_strings)
     {
-        const std::unordered_map<std::size_t, std::string> format_strings{
-            {0, "General"},
-            {1, "0"},
-            {2, "0.00"},
-            {3, "#,##0"},
-            {4, "#,##0.00"},
-            {9, "0%"},
-            {10, "0.00%"},
-            {11, "0.00E+00"},
-            {12, "# ?/?"},
-            {13, "# \?\?/??"}, // escape trigraph
-            {14, "mm-dd-yy"},
-            {15, "d-mmm-yy"},
-            {16, "d-mmm"},
-            {17, "mmm-yy"},
-            {18, "h:mm AM/PM"},
-            {19, "h:mm:ss AM/PM"},
-            {20, "h:mm"},
-            {21, "h:mm:ss"},
-            {22, "m/d/yy h:mm"},
-            {37, "#,##0 ;(#,##0)"},
-            {38, "#,##0 ;[Red](#,##0)"},
-            {39, "#,##0.00;(#,##0.00)"},
-            {40, "#,##0.00;[Red](#,##0.00)"},
-
-            // 41-44 aren't in the ECMA 376 v4 standard, but Libre Office uses them
-            {41, "_(* #,##0_);_(* \\(#,##0\\);_(* \"-\"_);_(@_)"},
-            {42, "_(\"$\"* #,##0_);_(\"$\"* \\(#,##0\\);_(\"$\"* \"-\"_);_(@_)"},
-            {43, "_(* #,##0.00_);_(* \\(#,##0.00\\);_(* \"-\"??_);_(@_)"},
-            {44, "_(\"$\"* #,##0.00_)_(\"$\"* \\(#,##0.00\\)_(\"$\"* \"-\"??_)_(@_)"},
-
-            {45, "mm:ss"},
-            {46, "[h]:mm:ss"},
-            {47, "mmss.0"},
-            {48, "##0.0E+0"},
-            {49, "@"}};
-
-        for (auto format_string_pair : format_strings)
-        {
-            formats[format_string_pair.first] =
-                xlnt::number_format(format_string_pair.second, format_string_pair.first);
-        }
+        formats[format_string_pair.first] =
+            xlnt::number_format(format_string_pair.second, format_string_pair.first);
     }
 
     return formats;
 }
 
+const std::unordered_map<std::size_t, xlnt::number_format> &builtin_formats()
+{
+    // initialised once, also when first used from several threads at the same time
+    static const auto formats = make_builtin_formats();
+    return formats;
+}
+
 } // namespace
 
 namespace xlnt {
@@ -105,6 +105,7 @@ xlnt::alignment style::alignment() const
 
 style style::alignment(const xlnt::alignment &new_alignment, optional<bool> applied)
 {
+    d_->parent->mark_records_dirty(*d_);
     d_->alignment_id = d_->parent->find_or_add(d_->parent->alignments, new_alignment);
     d_->alignment_applied = applied;
 
@@ -118,6 +119,7 @@ xlnt::border style::border() const
 
 style style::border(const xlnt::border &new_border, optional<bool> applied)
 {
+    d_->parent->mark_records_dirty(*d_);
     d_->border_id = d_->parent->find_or_add(d_->parent->borders, new_border);
     d_->border_applied = applied;
 
@@ -131,6 +133,7 @@ xlnt::fill style::fill() const
 
 style style::fill(const xlnt::fill &new_fill, optional<bool> applied)
 {
+    d_->parent->mark_records_dirty(*d_);
     d_->fill_id = d_->parent->find_or_add(d_->parent->fills, new_fill);
     d_->fill_applied = applied;
 
@@ -144,6 +147,7 @@ xlnt::font style::font() const
 
 style style::font(const xlnt::font &new_font, optional<bool> applied)
 {
+    d_->parent->mark_records_dirty(*d_);
     d_->font_id = d_->parent->find_or_add(d_->parent->fonts, new_font);
     d_->font_applied = applied;
 
@@ -191,6 +195,7 @@ xlnt::protection style::protection() const
 
 style style::protection(const xlnt::protection &new_protection, optional<bool> applied)
 {
+    d_->parent->mark_records_dirty(*d_);
     d_->protection_id = d_->parent->find_or_add(d_->parent->protections, new_protection);
     d_->protection_applied = applied;
 
@@ -60,6 +60,13 @@ date date::from_number(int days_since_base_year, calendar base_date)
         days_since_base_year++;
     }
 
+    // 25569 is the serial number of 1970-01-01
+    if (detail::civil_from_days(static_cast<std::int64_t>(days_since_base_year) - 25569,
+            result.year, result.month, result.day))
+    {
+        return result;
+    }
+
     int l = days_since_base_year + 68569 + 2415019;
     int n = int((4 * l) / 146097);
     l = l - int((146097 * n + 3) / 4);
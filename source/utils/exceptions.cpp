@@ -150,6 +150,24 @@ no_visible_worksheets::~no_visible_worksheets()
 {
 }
 
+operation_cancelled::operation_cancelled()
+    : exception("the operation was cancelled by its progress callback")
+{
+}
+
+operation_cancelled::~operation_cancelled()
+{
+}
+
+limit_exceeded::limit_exceeded(const std::string &message)
+    : exception(message)
+{
+}
+
+limit_exceeded::~limit_exceeded()
+{
+}
+
 unsupported::unsupported(const std::string &message)
     : exception(message)
 {
@@ -0,0 +1,108 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <xlnt/utils/executor.hpp>
+
+namespace {
+
+std::mutex &executor_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::shared_ptr<xlnt::executor> &installed_executor()
+{
+    static std::shared_ptr<xlnt::executor> installed = std::make_shared<xlnt::thread_executor>();
+    return installed;
+}
+
+} // namespace
+
+namespace xlnt {
+
+executor::~executor() = default;
+
+thread_executor::thread_executor(std::size_t max_threads)
+    : max_threads_(max_threads)
+{
+}
+
+void thread_executor::run(std::size_t thread_count, const std::function<void()> &worker)
+{
+    if (max_threads_ != 0)
+    {
+        thread_count = std::min(thread_count, max_threads_);
+    }
+
+    std::vector<std::thread> threads;
+
+    try
+    {
+        for (std::size_t i = 1; i < thread_count; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+    }
+    catch (...)
+    {
+        // the calls which did start still take the work of those which didn't
+    }
+
+    worker();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+std::size_t thread_executor::concurrency() const
+{
+    return max_threads_ != 0 ? max_threads_
+                             : static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u));
+}
+
+void set_executor(std::shared_ptr<executor> new_executor)
+{
+    if (!new_executor)
+    {
+        new_executor = std::make_shared<thread_executor>();
+    }
+
+    std::lock_guard<std::mutex> lock(executor_mutex());
+    installed_executor() = std::move(new_executor);
+}
+
+std::shared_ptr<executor> current_executor()
+{
+    std::lock_guard<std::mutex> lock(executor_mutex());
+    return installed_executor();
+}
+
+} // namespace xlnt
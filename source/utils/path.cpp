@@ -90,28 +90,115 @@ bool is_absolute(const std::string &part)
 
 #endif
 
+/// <summary>
+/// Walks the components of a path string in place, yielding the same components
+/// split_path would return without copying any of them.
+/// </summary>
+class component_cursor
+{
+public:
+    component_cursor(const std::string &path, char delim)
+        : path_(path), delim_(delim)
+    {
+    }
+
+    /// <summary>
+    /// Moves to the next component and returns false if there are none left.
+    /// </summary>
+    bool next()
+    {
+        if (done_) return false;
+
+        auto separator_index = path_.find(delim_, previous_index_);
+
+        if (separator_index != std::string::npos)
+        {
+            begin_ = previous_index_;
+            length_ = separator_index - previous_index_;
+            previous_index_ = separator_index + 1;
+
+            return true;
+        }
+
+        done_ = true;
+
+        // Don't add trailing slash
+        if (previous_index_ < path_.size())
+        {
+            begin_ = previous_index_;
+            length_ = path_.size() - previous_index_;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    const char *data() const
+    {
+        return path_.data() + begin_;
+    }
+
+    std::size_t size() const
+    {
+        return length_;
+    }
+
+    bool equals(const component_cursor &other) const
+    {
+        return length_ == other.length_ && path_.compare(begin_, length_, other.path_, other.begin_, other.length_) == 0;
+    }
+
+    bool equals(const char *component) const
+    {
+        return path_.compare(begin_, length_, component) == 0;
+    }
+
+private:
+    const std::string &path_;
+    char delim_;
+    std::string::size_type previous_index_ = 0;
+    std::string::size_type begin_ = 0;
+    std::string::size_type length_ = 0;
+    bool done_ = false;
+};
+
 std::vector<std::string> split_path(const std::string &path, char delim)
 {
     std::vector<std::string> split;
-    std::string::size_type previous_index = 0;
-    auto separator_index = path.find(delim);
+    component_cursor component(path, delim);
 
-    while (separator_index != std::string::npos)
+    while (component.next())
     {
-        auto part = path.substr(previous_index, separator_index - previous_index);
-        split.push_back(part);
-
-        previous_index = separator_index + 1;
-        separator_index = path.find(delim, previous_index);
+        split.emplace_back(component.data(), component.size());
     }
 
-    // Don't add trailing slash
-    if (previous_index < path.size())
+    return split;
+}
+
+char guess_separator(const std::string &path)
+{
+    if (system_separator() == '/' || path.empty() || path.front() == '/') return '/';
+    if (is_absolute(path)) return path.at(2);
+    return path.find('\\') != std::string::npos ? '\\' : '/';
+}
+
+/// <summary>
+/// Appends one component to a path string the way path::append does.
+/// </summary>
+void append_component(std::string &path, const char *component, std::size_t length)
+{
+    if (!path.empty())
     {
-        split.push_back(path.substr(previous_index));
+        const auto separator = guess_separator(path);
+
+        if (path.back() != separator)
+        {
+            path.push_back(separator);
+        }
     }
 
-    return split;
+    path.append(component, length);
 }
 
 #ifdef _MSC_VER
@@ -210,20 +297,22 @@ path path::parent() const
 {
     if (is_root()) return *this;
 
-    auto split_path = split();
+    const auto separator = guess_separator();
+    std::size_t count = 0;
+    component_cursor counter(internal_, separator);
 
-    split_path.pop_back();
-
-    if (split_path.empty())
+    while (counter.next())
     {
-        return path("");
+        ++count;
     }
 
+    // every component but the last
     path result;
+    component_cursor component(internal_, separator);
 
-    for (const auto &component : split_path)
+    for (std::size_t i = 1; i < count && component.next(); ++i)
     {
-        result = result.append(component);
+        append_component(result.internal_, component.data(), component.size());
     }
 
     return result;
@@ -231,8 +320,15 @@ path path::parent() const
 
 std::string path::filename() const
 {
-    auto split_path = split();
-    return split_path.empty() ? "" : split_path.back();
+    component_cursor component(internal_, guess_separator());
+    std::string last;
+
+    while (component.next())
+    {
+        last.assign(component.data(), component.size());
+    }
+
+    return last;
 }
 
 std::string path::extension() const
@@ -291,16 +387,17 @@ path path::resolve(const path &base_path) const
     }
 
     path copy(base_path.internal_);
+    component_cursor part(internal_, guess_separator());
 
-    for (const auto &part : split())
+    while (part.next())
     {
-        if (part == "..")
+        if (part.equals(".."))
         {
             copy = copy.parent();
             continue;
         }
 
-        copy = copy.append(part);
+        append_component(copy.internal_, part.data(), part.size());
     }
 
     return copy;
@@ -372,10 +469,11 @@ path path::append(std::u8string_view to_append) const
 path path::append(const path &to_append) const
 {
     path copy(internal_);
+    component_cursor component(to_append.internal_, to_append.guess_separator());
 
-    for (const auto &component : to_append.split())
+    while (component.next())
     {
-        copy = copy.append(component);
+        append_component(copy.internal_, component.data(), component.size());
     }
 
     return copy;
@@ -383,29 +481,29 @@ path path::append(const path &to_append) const
 
 char path::guess_separator() const
 {
-    if (system_separator() == '/' || internal_.empty() || internal_.front() == '/') return '/';
-    if (is_absolute()) return internal_.at(2);
-    return internal_.find('\\') != std::string::npos ? '\\' : '/';
+    return ::guess_separator(internal_);
 }
 
 path path::relative_to(const path &base_path) const
 {
     if (is_relative()) return *this;
 
-    auto base_split = base_path.split();
-    auto this_split = split();
-    auto index = std::size_t(0);
+    component_cursor base_component(base_path.internal_, base_path.guess_separator());
+    component_cursor this_component(internal_, guess_separator());
+    auto result = path();
+
+    // skip the components both paths have in common
+    bool remaining = this_component.next();
 
-    while (index < base_split.size() && index < this_split.size() && base_split[index] == this_split[index])
+    while (remaining && base_component.next() && base_component.equals(this_component))
     {
-        index++;
+        remaining = this_component.next();
     }
 
-    auto result = path();
-
-    for (auto i = index; i < this_split.size(); i++)
+    while (remaining)
     {
-        result = result.append(this_split[i]);
+        append_component(result.internal_, this_component.data(), this_component.size());
+        remaining = this_component.next();
     }
 
     return result;
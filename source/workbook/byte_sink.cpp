@@ -0,0 +1,49 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <memory>
+
+#include <xlnt/workbook/byte_sink.hpp>
+
+namespace xlnt {
+
+byte_sink::~byte_sink()
+{
+}
+
+std::future<void> byte_sink::write_async(std::uint64_t offset, std::vector<std::uint8_t> data)
+{
+    // the chunk is moved into the task, which owns it until it has been written
+    auto chunk = std::make_shared<std::vector<std::uint8_t>>(std::move(data));
+
+    return std::async(std::launch::async, [this, offset, chunk]() {
+        write(offset, chunk->data(), chunk->size());
+    });
+}
+
+void byte_sink::finish()
+{
+}
+
+} // namespace xlnt
@@ -0,0 +1,57 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+
+#include <xlnt/workbook/column_batch.hpp>
+
+namespace xlnt {
+
+std::size_t column_batch::size() const
+{
+    return rows.size();
+}
+
+const column_batch::column *column_batch::find(column_t::index_t index) const
+{
+    const auto match = std::lower_bound(columns.begin(), columns.end(), index,
+        [](const column &c, column_t::index_t i) { return c.index < i; });
+
+    return match != columns.end() && match->index == index ? &*match : nullptr;
+}
+
+void column_batch::clear()
+{
+    rows.clear();
+    strings.clear();
+
+    for (auto &c : columns)
+    {
+        c.types.clear();
+        c.numbers.clear();
+        c.indices.clear();
+    }
+}
+
+} // namespace xlnt
@@ -0,0 +1,128 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+
+#include <xlnt/workbook/deflated_fragment.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+#include <detail/serialization/crc32.hpp>
+#include <detail/serialization/deflate_codec.hpp>
+#include <detail/serialization/xlsx_producer.hpp>
+
+namespace {
+
+// the largest number of bytes a stored block can hold
+const std::size_t max_stored_block = 0xFFFF;
+
+void write_stored_block(const std::uint8_t *data, std::uint16_t length, std::vector<std::uint8_t> &out)
+{
+    const auto complement = static_cast<std::uint16_t>(~length);
+
+    out.push_back(0); // not final, stored; the rest of the byte is padding
+    out.push_back(static_cast<std::uint8_t>(length & 0xFF));
+    out.push_back(static_cast<std::uint8_t>(length >> 8));
+    out.push_back(static_cast<std::uint8_t>(complement & 0xFF));
+    out.push_back(static_cast<std::uint8_t>(complement >> 8));
+    out.insert(out.end(), data, data + length);
+}
+
+} // namespace
+
+namespace xlnt {
+
+deflated_fragment deflated_fragment::compress(const std::uint8_t *data, std::size_t size, compression_level level)
+{
+    deflated_fragment result;
+    result.crc32 = detail::update_crc32(0, data, size);
+    result.uncompressed_size = size;
+
+    if (level == compression_level::none)
+    {
+        while (size > 0)
+        {
+            const auto block = std::min(size, max_stored_block);
+            write_stored_block(data, static_cast<std::uint16_t>(block), result.data);
+            data += block;
+            size -= block;
+        }
+
+        // the empty block a full flush ends with
+        write_stored_block(data, 0, result.data);
+
+        return result;
+    }
+
+    auto deflater = detail::make_deflater(level);
+    result.data.resize(size / 2 + 1024);
+    auto next_out = result.data.data();
+    auto avail_out = result.data.size();
+
+    auto grow = [&]() {
+        const auto written = result.data.size() - avail_out;
+        result.data.resize(result.data.size() * 2);
+        next_out = result.data.data() + written;
+        avail_out = result.data.size() - written;
+    };
+
+    while (size > 0)
+    {
+        deflater->process(data, size, next_out, avail_out, false);
+
+        if (avail_out == 0)
+        {
+            grow();
+        }
+    }
+
+    while (!deflater->flush(next_out, avail_out))
+    {
+        grow();
+    }
+
+    result.data.resize(result.data.size() - avail_out);
+
+    return result;
+}
+
+deflated_fragment deflated_fragment::compress(const std::string &xml, compression_level level)
+{
+    return compress(reinterpret_cast<const std::uint8_t *>(xml.data()), xml.size(), level);
+}
+
+deflated_fragment deflated_fragment::from_sheet_data(const worksheet &ws, compression_level level)
+{
+    const auto wb = ws.workbook();
+    detail::xlsx_producer producer(wb);
+    return producer.write_sheet_data_fragment(ws, level);
+}
+
+void deflated_fragment::append(const deflated_fragment &next)
+{
+    data.insert(data.end(), next.data.begin(), next.data.end());
+    crc32 = detail::combine_crc32(crc32, next.crc32, next.uncompressed_size);
+    uncompressed_size += next.uncompressed_size;
+}
+
+} // namespace xlnt
@@ -0,0 +1,80 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/workbook/loader.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <detail/serialization/load_buffers.hpp>
+
+namespace xlnt {
+
+loader::loader()
+    : buffers_(std::make_shared<detail::load_buffers>())
+{
+}
+
+loader::~loader()
+{
+}
+
+void loader::load(workbook &destination, std::istream &stream)
+{
+    load(destination, stream, load_options());
+}
+
+void loader::load(workbook &destination, std::istream &stream, const load_options &options)
+{
+    destination.load_reusing(stream, options, buffers_);
+}
+
+void loader::load(workbook &destination, const xlnt::path &filename)
+{
+    load(destination, filename, load_options());
+}
+
+void loader::load(workbook &destination, const xlnt::path &filename, const load_options &options)
+{
+    destination.load_reusing(filename, options, buffers_);
+}
+
+void loader::load(workbook &destination, const std::vector<std::uint8_t> &data)
+{
+    load(destination, data, load_options());
+}
+
+void loader::load(workbook &destination, const std::vector<std::uint8_t> &data, const load_options &options)
+{
+    destination.load_reusing(data, options, buffers_);
+}
+
+std::size_t loader::retained_bytes() const
+{
+    return buffers_->retained_bytes();
+}
+
+void loader::release()
+{
+    buffers_->clear();
+}
+
+} // namespace xlnt
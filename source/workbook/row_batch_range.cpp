@@ -0,0 +1,86 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <xlnt/workbook/row_batch_range.hpp>
+#include <xlnt/workbook/streaming_workbook_reader.hpp>
+
+namespace xlnt {
+
+row_batch_range::row_batch_range(streaming_workbook_reader &reader, std::size_t rows_per_batch)
+    : reader_(&reader),
+      rows_per_batch_(rows_per_batch == 0 ? 1 : rows_per_batch)
+{
+}
+
+bool row_batch_range::read_next()
+{
+    return reader_->read_rows(batch_, rows_per_batch_) > 0;
+}
+
+row_batch_range::iterator row_batch_range::begin()
+{
+    return iterator(read_next() ? this : nullptr);
+}
+
+row_batch_range::iterator row_batch_range::end()
+{
+    return iterator(nullptr);
+}
+
+row_batch_range::iterator::iterator(row_batch_range *range)
+    : range_(range)
+{
+}
+
+row_batch_range::iterator::reference row_batch_range::iterator::operator*() const
+{
+    return range_->batch_;
+}
+
+row_batch_range::iterator::pointer row_batch_range::iterator::operator->() const
+{
+    return &range_->batch_;
+}
+
+row_batch_range::iterator &row_batch_range::iterator::operator++()
+{
+    if (!range_->read_next())
+    {
+        range_ = nullptr;
+    }
+
+    return *this;
+}
+
+bool row_batch_range::iterator::operator==(const iterator &other) const
+{
+    return range_ == other.range_;
+}
+
+bool row_batch_range::iterator::operator!=(const iterator &other) const
+{
+    return !(*this == other);
+}
+
+} // namespace xlnt
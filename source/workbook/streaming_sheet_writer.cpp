@@ -0,0 +1,78 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+
+#include <xlnt/workbook/column_view.hpp>
+#include <xlnt/workbook/streaming_sheet_writer.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+#include <detail/serialization/xlsx_producer.hpp>
+
+namespace xlnt {
+
+streaming_sheet_writer::streaming_sheet_writer(detail::xlsx_producer &producer)
+    : producer_(&producer)
+{
+}
+
+cell streaming_sheet_writer::add_cell(const cell_reference &ref)
+{
+    return producer_->add_cell(ref);
+}
+
+cell streaming_sheet_writer::add_cell(const cell_reference &ref, const format &cell_format)
+{
+    return producer_->add_cell(ref, cell_format);
+}
+
+cell streaming_sheet_writer::add_cell(const cell_reference &ref, std::size_t format_id)
+{
+    return producer_->add_cell(ref, format_id);
+}
+
+void streaming_sheet_writer::end_row()
+{
+    producer_->end_row();
+}
+
+void streaming_sheet_writer::append_rows(std::size_t row_count, const std::vector<column_view> &columns)
+{
+    producer_->append_rows(row_count, columns);
+}
+
+row_t streaming_sheet_writer::next_row() const
+{
+    return producer_->next_row();
+}
+
+worksheet streaming_sheet_writer::worksheet() const
+{
+    return producer_->concurrent_worksheet();
+}
+
+void streaming_sheet_writer::close()
+{
+    producer_->finish_concurrent_worksheet();
+}
+
+} // namespace xlnt
@@ -22,19 +22,70 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
 #include <fstream>
+#include <unordered_map>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/cell_batch.hpp>
+#include <xlnt/workbook/column_batch.hpp>
+#include <xlnt/workbook/column_schema.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
+#include <detail/external/include_libstudxml.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/serialization/open_stream.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
+#include <detail/serialization/sheet_prefetch.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 
+namespace {
+
+bool is_string(xlnt::cell_type type)
+{
+    return type == xlnt::cell_type::shared_string || type == xlnt::cell_type::inline_string
+        || type == xlnt::cell_type::formula_string;
+}
+
+// Returns the type of a cell with the given t attribute, like the consumer does when
+// reading its value, but with dates
+xlnt::cell_type type_from_string(const std::string &type)
+{
+    if (type == "n")
+    {
+        return xlnt::cell_type::number;
+    }
+    else if (type == "d")
+    {
+        return xlnt::cell_type::date;
+    }
+    else if (type == "b")
+    {
+        return xlnt::cell_type::boolean;
+    }
+    else if (type == "e")
+    {
+        return xlnt::cell_type::error;
+    }
+    else if (type == "inlineStr")
+    {
+        return xlnt::cell_type::inline_string;
+    }
+    else if (type == "str")
+    {
+        return xlnt::cell_type::formula_string;
+    }
+
+    return xlnt::cell_type::shared_string;
+}
+
+} // namespace
+
 namespace xlnt {
 
 streaming_workbook_reader::streaming_workbook_reader()
@@ -48,6 +99,10 @@ streaming_workbook_reader::~streaming_workbook_reader()
 
 void streaming_workbook_reader::close()
 {
+    prefetch_.reset();
+    prefetch_order_.clear();
+    current_title_.clear();
+
     if (consumer_)
     {
         consumer_.reset(nullptr);
@@ -65,6 +120,168 @@ cell streaming_workbook_reader::read_cell()
     return consumer_->read_cell();
 }
 
+void streaming_workbook_reader::row_callback(const std::function<void(row_t, const row_properties &)> &callback)
+{
+    row_callback_ = callback;
+
+    if (consumer_)
+    {
+        consumer_->streaming_row_callback_ = callback;
+    }
+}
+
+std::size_t streaming_workbook_reader::read_rows(cell_batch &batch, std::size_t row_count)
+{
+    return consumer_->read_rows(batch, row_count);
+}
+
+row_batch_range streaming_workbook_reader::rows(const std::string &title, std::size_t rows_per_batch)
+{
+    begin_worksheet(title);
+
+    return row_batch_range(*this, rows_per_batch);
+}
+
+std::size_t streaming_workbook_reader::read_columns(column_batch &batch, std::size_t row_count)
+{
+    return consumer_->read_columns(batch, row_count);
+}
+
+const rich_text &streaming_workbook_reader::shared_string(std::size_t index) const
+{
+    return workbook_->shared_strings(index);
+}
+
+std::string streaming_workbook_reader::resolve_string(std::size_t index) const
+{
+    return detail::shared_string_loader::plain_text(*workbook_, index);
+}
+
+std::size_t streaming_workbook_reader::shared_string_count() const
+{
+    return detail::shared_string_loader::count(*workbook_);
+}
+
+std::vector<column_schema> streaming_workbook_reader::sample_schema(const std::string &title, std::size_t row_count)
+{
+    if (!has_worksheet(title))
+    {
+        throw xlnt::exception("sheet not found");
+    }
+
+    const auto workbook_rel = workbook_->manifest().relationship(path("/"), relationship_type::office_document);
+    const auto worksheet_rel = workbook_->manifest().relationship(workbook_rel.target().path(),
+        workbook_->impl().sheet_title_rel_id_map_.at(title));
+    const auto part_path = workbook_->manifest().canonicalize({workbook_rel, worksheet_rel});
+
+    // a worksheet being read is streamed from the same source as the sample, and a sheet
+    // sampled from a forward-only archive has to be kept to be read again
+    auto part_buffer = parser_ || consumer_->archive_->forward_only()
+        ? consumer_->archive_->open_detached(part_path)
+        : consumer_->archive_->open(part_path);
+    std::istream part_stream(part_buffer.get());
+    xml::parser parser(part_stream, part_path.string(),
+        xml::parser::receive_elements | xml::parser::receive_attributes_map);
+
+    std::vector<column_schema> columns;
+    std::vector<std::size_t> values;
+    std::unordered_map<std::size_t, bool> date_styles;
+    std::size_t rows = 0;
+    std::size_t depth = 0;
+    std::size_t sheet_data_depth = 0;
+    std::size_t cell_depth = 0;
+    column_t::index_t column = 0;
+    auto type = cell_type::empty;
+    auto has_value = false;
+
+    for (auto event = parser.next(); event != xml::parser::eof; event = parser.next())
+    {
+        if (event == xml::parser::end_element)
+        {
+            if (depth == sheet_data_depth) break;
+
+            if (depth-- != cell_depth) continue;
+            cell_depth = 0;
+
+            auto found = std::lower_bound(columns.begin(), columns.end(), column,
+                [](const column_schema &schema, column_t::index_t index) { return schema.index < index; });
+
+            if (found == columns.end() || found->index != column)
+            {
+                values.insert(values.begin() + (found - columns.begin()), 0);
+                found = columns.insert(found, column_schema());
+                found->index = column;
+            }
+
+            if (!has_value || type == cell_type::error) continue;
+
+            ++values[static_cast<std::size_t>(found - columns.begin())];
+
+            if (found->type == cell_type::empty)
+            {
+                found->type = type;
+            }
+            else if (type != found->type && !(is_string(type) && is_string(found->type)))
+            {
+                found->mixed = true;
+            }
+
+            continue;
+        }
+
+        if (event != xml::parser::start_element) continue;
+
+        ++depth;
+        const auto &name = parser.name();
+
+        if (sheet_data_depth == 0)
+        {
+            if (name == "sheetData") sheet_data_depth = depth;
+        }
+        else if (depth == sheet_data_depth + 1 && name == "row")
+        {
+            if (rows == row_count) break;
+            ++rows;
+            column = 0;
+        }
+        else if (depth == sheet_data_depth + 2 && name == "c")
+        {
+            // a cell without a reference follows the one before it
+            column = parser.attribute_present("r") ? cell_reference(parser.attribute("r")).column_index() : column + 1;
+            type = parser.attribute_present("t") ? type_from_string(parser.attribute("t")) : cell_type::number;
+            cell_depth = depth;
+            has_value = false;
+
+            // numbers are dates by their number format, looked up once per style
+            if (type == cell_type::number && parser.attribute_present("s"))
+            {
+                const auto style = parser.attribute<std::size_t>("s");
+                auto date_style = date_styles.find(style);
+
+                if (date_style == date_styles.end())
+                {
+                    date_style = date_styles.emplace(style, workbook_->format(style).number_format().is_date_format()).first;
+                }
+
+                type = date_style->second ? cell_type::date : cell_type::number;
+            }
+        }
+        else if (depth == cell_depth + 1 && cell_depth != 0 && (name == "v" || name == "is"))
+        {
+            has_value = true;
+        }
+
+        parser.attribute_map();
+    }
+
+    for (std::size_t i = 0; i < columns.size(); ++i)
+    {
+        columns[i].nulls = rows - values[i];
+    }
+
+    return columns;
+}
+
 bool streaming_workbook_reader::has_worksheet(const std::string &name)
 {
     auto titles = sheet_titles();
@@ -88,7 +305,22 @@ void streaming_workbook_reader::begin_worksheet(const std::string &title)
 
     const auto &manifest = consumer_->target_.manifest();
     const auto part_path = manifest.canonicalize(rel_chain);
-    auto part_stream_buffer = consumer_->archive_->open(part_path);
+    std::unique_ptr<std::streambuf> part_stream_buffer;
+
+    if (prefetch_ && prefetch_->title() == title)
+    {
+        part_stream_buffer = prefetch_->take();
+    }
+
+    prefetch_.reset();
+
+    if (!part_stream_buffer)
+    {
+        part_stream_buffer = consumer_->options_.inflate_ahead
+            ? consumer_->read_ahead(consumer_->archive_->open_detached(part_path))
+            : consumer_->archive_->open(part_path);
+    }
+
     part_stream_buffer_.swap(part_stream_buffer);
     part_stream_.reset(new std::istream(part_stream_buffer_.get()));
     parser_.reset(new xml::parser(*part_stream_, part_path.string()));
@@ -110,11 +342,17 @@ void streaming_workbook_reader::begin_worksheet(const std::string &title)
     }
 
     consumer_->read_worksheet_begin(worksheet_rel_id_);
+    current_title_ = title;
+    prefetch_after(title);
 }
 
 worksheet streaming_workbook_reader::end_worksheet()
 {
-    return consumer_->read_worksheet_end(worksheet_rel_id_);
+    auto ws = consumer_->read_worksheet_end(worksheet_rel_id_);
+    consumer_->parser_ = nullptr;
+    parser_.reset();
+
+    return ws;
 }
 
 void streaming_workbook_reader::open(const std::vector<std::uint8_t> &data)
@@ -147,10 +385,26 @@ void streaming_workbook_reader::open(const xlnt::path &filename)
     open(*stream_);
 }
 
+void streaming_workbook_reader::open(const xlnt::path &filename, const load_options &options)
+{
+    stream_.reset(new std::ifstream());
+    xlnt::detail::open_stream(static_cast<std::ifstream &>(*stream_), filename.string());
+    open(*stream_, options);
+}
+
 void streaming_workbook_reader::open(std::istream &stream)
 {
-    workbook_.reset(new workbook());
-    consumer_.reset(new detail::xlsx_consumer(*workbook_));
+    open(stream, load_options());
+}
+
+void streaming_workbook_reader::open(std::istream &stream, const load_options &options)
+{
+    prefetch_.reset();
+    prefetch_order_.clear();
+    current_title_.clear();
+    workbook_.reset(new workbook(workbook::bare()));
+    consumer_.reset(new detail::xlsx_consumer(*workbook_, options));
+    consumer_->streaming_row_callback_ = row_callback_;
     consumer_->open(stream);
 
     const auto workbook_rel = workbook_->manifest()
@@ -167,7 +421,65 @@ void streaming_workbook_reader::open(std::unique_ptr<std::streambuf> &&buffer)
 
 std::vector<std::string> streaming_workbook_reader::sheet_titles()
 {
-    return workbook_->sheet_titles();
+    auto titles = workbook_->sheet_titles();
+    const auto &projected = consumer_->options_.sheets;
+
+    if (!projected.empty())
+    {
+        titles.erase(std::remove_if(titles.begin(), titles.end(), [&projected](const std::string &title) {
+            return std::find(projected.begin(), projected.end(), title) == projected.end();
+        }),
+            titles.end());
+    }
+
+    return titles;
+}
+
+void streaming_workbook_reader::prefetch(std::size_t max_bytes)
+{
+    prefetch(sheet_titles(), max_bytes);
+}
+
+void streaming_workbook_reader::prefetch(const std::vector<std::string> &order, std::size_t max_bytes)
+{
+    prefetch_order_ = order;
+    prefetch_max_bytes_ = max_bytes;
+    prefetch_after(current_title_);
+}
+
+void streaming_workbook_reader::prefetch_after(const std::string &title)
+{
+    if (prefetch_order_.empty() || consumer_->archive_->forward_only())
+    {
+        return;
+    }
+
+    auto next = prefetch_order_.begin();
+
+    if (!title.empty())
+    {
+        next = std::find(prefetch_order_.begin(), prefetch_order_.end(), title);
+
+        if (next == prefetch_order_.end() || ++next == prefetch_order_.end())
+        {
+            return;
+        }
+    }
+
+    if ((prefetch_ && prefetch_->title() == *next) || !has_worksheet(*next))
+    {
+        return;
+    }
+
+    const auto workbook_rel = workbook_->manifest().relationship(path("/"), relationship_type::office_document);
+    const auto worksheet_rel = workbook_->manifest().relationship(workbook_rel.target().path(),
+        workbook_->impl().sheet_title_rel_id_map_.at(*next));
+    const auto part_path = workbook_->manifest().canonicalize({workbook_rel, worksheet_rel});
+
+    // the part is copied out of the archive here, as the worksheet being read may be
+    // streamed from the same source, and only inflated on the prefetching thread
+    prefetch_.reset();
+    prefetch_.reset(new detail::sheet_prefetch(*next, consumer_->archive_->open_detached(part_path), prefetch_max_bytes_));
 }
 
 } // namespace xlnt
@@ -25,16 +25,21 @@
 #include <fstream>
 
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/rich_text.hpp>
 #include <xlnt/packaging/manifest.hpp>
+#include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/column_view.hpp>
+#include <xlnt/workbook/streaming_sheet_writer.hpp>
 #include <xlnt/workbook/streaming_workbook_writer.hpp>
+#include <xlnt/workbook/string_storage.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
-#include <detail/implementations/cell_impl.hpp>
-#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/cryptography/xlsx_crypto_producer.hpp>
 #include <detail/serialization/open_stream.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
+#include <detail/unicode.hpp>
 
 namespace xlnt {
 
@@ -51,7 +56,25 @@ void streaming_workbook_writer::close()
 {
     if (producer_)
     {
+        producer_->close();
         producer_.reset(nullptr);
+
+        if (encrypting_buffer_)
+        {
+            encrypting_stream_->flush();
+            encrypting_buffer_->close();
+            encrypting_stream_.reset(nullptr);
+            encrypting_buffer_.reset(nullptr);
+        }
+
+        if (stream_)
+        {
+            // streambufs held through open(std::unique_ptr<std::streambuf> &&)
+            // aren't flushed when they are destroyed
+            stream_->flush();
+        }
+
+        stream_.reset(nullptr);
         stream_buffer_.reset(nullptr);
     }
 }
@@ -61,11 +84,82 @@ cell streaming_workbook_writer::add_cell(const cell_reference &ref)
     return producer_->add_cell(ref);
 }
 
+cell streaming_workbook_writer::add_cell(const cell_reference &ref, std::size_t format_id)
+{
+    return producer_->add_cell(ref, format_id);
+}
+
+std::size_t streaming_workbook_writer::add_format(const format &cell_format)
+{
+    return producer_->format_id(cell_format);
+}
+
+void streaming_workbook_writer::begin_typed_row(std::size_t column_count)
+{
+    producer_->begin_typed_row(column_count);
+}
+
+void streaming_workbook_writer::write_typed_cell(column_t::index_t column, std::int64_t value)
+{
+    producer_->write_typed_cell(column, value);
+}
+
+void streaming_workbook_writer::write_typed_cell(column_t::index_t column, double value)
+{
+    producer_->write_typed_cell(column, value);
+}
+
+void streaming_workbook_writer::write_typed_cell(column_t::index_t column, bool value)
+{
+    producer_->write_typed_cell(column, value);
+}
+
+void streaming_workbook_writer::write_typed_cell(column_t::index_t column, const std::string &value)
+{
+    producer_->write_typed_cell(column, value);
+}
+
+void streaming_workbook_writer::write_typed_cell(column_t::index_t column, const date &value)
+{
+    producer_->write_typed_cell(column, value);
+}
+
+void streaming_workbook_writer::write_typed_cell(column_t::index_t column, const datetime &value)
+{
+    producer_->write_typed_cell(column, value);
+}
+
+void streaming_workbook_writer::end_row()
+{
+    producer_->end_row();
+}
+
+void streaming_workbook_writer::append_rows(std::size_t row_count, const std::vector<column_view> &columns)
+{
+    producer_->append_rows(row_count, columns);
+}
+
+std::size_t streaming_workbook_writer::add_shared_string(const std::string &text)
+{
+    return workbook_->add_shared_string(rich_text(text));
+}
+
+row_t streaming_workbook_writer::next_row() const
+{
+    return producer_->next_row();
+}
+
 worksheet streaming_workbook_writer::add_worksheet(const std::string &title)
 {
     return producer_->add_worksheet(title);
 }
 
+streaming_sheet_writer streaming_workbook_writer::open_worksheet(const std::string &title)
+{
+    workbook_->string_storage(string_storage::inline_string);
+    return streaming_sheet_writer(producer_->open_concurrent_worksheet(title));
+}
+
 void streaming_workbook_writer::open(std::vector<std::uint8_t> &data)
 {
     stream_buffer_.reset(new detail::vector_ostreambuf(data));
@@ -101,9 +195,32 @@ void streaming_workbook_writer::open(std::ostream &stream)
     workbook_.reset(new workbook());
     producer_.reset(new detail::xlsx_producer(*workbook_));
     producer_->open(stream);
-    producer_->current_worksheet_ = new detail::worksheet_impl(workbook_.get(), 1, "Sheet1");
-    producer_->current_cell_ = new detail::cell_impl();
-    producer_->current_cell_->parent_ = producer_->current_worksheet_;
+}
+
+void streaming_workbook_writer::open(std::unique_ptr<std::streambuf> &&buffer)
+{
+    stream_buffer_.swap(buffer);
+    stream_.reset(new std::ostream(stream_buffer_.get()));
+    open(*stream_);
+}
+
+void streaming_workbook_writer::open(const xlnt::path &filename, const std::string &password)
+{
+    stream_.reset(new std::ofstream());
+    xlnt::detail::open_stream(static_cast<std::ofstream &>(*stream_), filename.string());
+    open(*stream_, password);
+}
+
+void streaming_workbook_writer::open(std::ostream &stream, const std::string &password)
+{
+    if (stream.tellp() == std::streampos(-1))
+    {
+        throw invalid_parameter();
+    }
+
+    encrypting_buffer_.reset(new detail::encrypting_ostreambuf(stream, detail::utf8_to_utf16(password)));
+    encrypting_stream_.reset(new std::ostream(encrypting_buffer_.get()));
+    open(*encrypting_stream_);
 }
 
 } // namespace xlnt
@@ -26,6 +26,8 @@
 #include <algorithm>
 #include <fstream>
 #include <functional>
+#include <limits>
+#include <unordered_set>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
@@ -41,8 +43,17 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/variant.hpp>
+#include <xlnt/workbook/byte_sink.hpp>
+#include <xlnt/workbook/byte_source.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
+#include <xlnt/workbook/encryption_key.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/workbook/memory_usage.hpp>
+#include <xlnt/workbook/merge_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/save_options.hpp>
+#include <xlnt/workbook/string_storage.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/workbook_view.hpp>
@@ -52,19 +63,46 @@
 #include <xlnt/worksheet/worksheet.hpp>
 #include <detail/constants.hpp>
 #include <detail/default_case.hpp>
+#include <detail/formula/formula_engine.hpp>
 #include <detail/implementations/cell_impl.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/byte_streambuf.hpp>
 #include <detail/serialization/excel_thumbnail.hpp>
+#include <detail/serialization/mapped_file.hpp>
 #include <detail/serialization/open_stream.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/workbook_snapshot.hpp>
+#include <detail/serialization/worksheet_loader.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
+#include <detail/utils/heap_size.hpp>
 
 namespace {
 
 using xlnt::detail::open_stream;
 
+void read_snapshot(xlnt::workbook &wb, const std::uint8_t *data, std::size_t size)
+{
+    const std::uint8_t *package = nullptr;
+    std::size_t package_size = 0;
+    xlnt::detail::snapshot_sheets sheets;
+    xlnt::detail::read_snapshot(data, size, package, package_size, sheets);
+
+    wb.clear();
+    xlnt::detail::xlsx_consumer consumer(wb);
+    xlnt::detail::memory_istreambuf package_buffer(package, package_size);
+    std::istream package_stream(&package_buffer);
+    consumer.read_snapshot(package_stream, sheets);
+
+    // a sheet left over would mean that the cells of a worksheet were dropped
+    if (!sheets.empty())
+    {
+        throw xlnt::exception("snapshot is truncated or malformed");
+    }
+}
+
 template <typename T>
 std::vector<T> keys(const std::vector<std::pair<T, xlnt::variant>> &container)
 {
@@ -256,10 +294,205 @@ std::string content_type(xlnt::relationship_type type)
     default_case("application/xml");
 }
 
+// Inflates the images and binaries still compressed because of load_options::lazy_binaries
+// and copies the images shared with the template of workbook::empty.
+void inflate_binaries(xlnt::detail::workbook_impl &wb)
+{
+    std::lock_guard<std::recursive_mutex> lock(wb.lazy_load_mutex_);
+
+    for (auto &compressed : wb.compressed_images_)
+    {
+        wb.images_[compressed.first] = compressed.second.inflate();
+    }
+
+    for (auto &compressed : wb.compressed_binaries_)
+    {
+        wb.binaries_[compressed.first] = compressed.second.inflate();
+    }
+
+    for (auto &shared : wb.shared_images_)
+    {
+        wb.images_[shared.first] = *shared.second;
+    }
+
+    wb.compressed_images_.clear();
+    wb.compressed_binaries_.clear();
+    wb.shared_images_.clear();
+}
+
+// Translates the shared strings and formats of the cells of worksheets copied or moved
+// from another workbook. Each of them is looked up in the target workbook once, after
+// which its translation is read from a table indexed by its index in the source workbook.
+class sheet_translation
+{
+public:
+    sheet_translation(const xlnt::workbook &source, const xlnt::detail::workbook_impl &source_impl,
+        xlnt::workbook &target, const std::shared_ptr<xlnt::detail::workbook_impl> &target_impl)
+        : source_(source),
+          source_styles_(source_impl.stylesheet_.is_set() ? &source_impl.stylesheet_.get() : nullptr),
+          target_(target)
+    {
+        if (source_styles_ != nullptr && !target_impl->stylesheet_.is_set())
+        {
+            target_impl->stylesheet_ = xlnt::detail::stylesheet();
+            target_impl->stylesheet_.get().parent = target_impl;
+        }
+
+        styles_ = target_impl->stylesheet_.is_set() ? &target_impl->stylesheet_.get() : nullptr;
+    }
+
+    // copies the content of other, a worksheet of the source, into target
+    void copy_sheet(const xlnt::detail::worksheet_impl &other, xlnt::detail::worksheet_impl &target)
+    {
+        copy_properties(other, target);
+        target.cell_map_.reserve(other.cell_map_.size());
+
+        other.cell_map_.for_each([this, &target](const xlnt::detail::cell_impl &cell) {
+            auto copy = cell;
+            translate(copy, target);
+            target.cell_map_.emplace(xlnt::cell_reference(cell.column_, cell.row_), std::move(copy));
+        });
+
+        target.point_cells_at_comments();
+    }
+
+    // moves the content of other, a worksheet of the source, into target, leaving other
+    // without cells. The cells are converted to the storage engine of target.
+    void move_sheet(xlnt::detail::worksheet_impl &other, xlnt::detail::worksheet_impl &target)
+    {
+        copy_properties(other, target);
+
+        const auto engine = target.cell_map_.engine();
+        target.cell_map_ = std::move(other.cell_map_);
+
+        target.cell_map_.for_each([this, &target](xlnt::detail::cell_impl &cell) {
+            translate(cell, target);
+        });
+
+        target.cell_map_.engine(engine);
+        target.point_cells_at_comments();
+    }
+
+private:
+    void copy_properties(const xlnt::detail::worksheet_impl &other, xlnt::detail::worksheet_impl &target)
+    {
+        target.copy_properties(other);
+
+        for (auto &column : target.column_properties_)
+        {
+            format_index(column.second.style);
+        }
+
+        for (auto &row : target.row_properties_)
+        {
+            format_index(row.second.style);
+        }
+    }
+
+    void translate(xlnt::detail::cell_impl &cell, xlnt::detail::worksheet_impl &target)
+    {
+        cell.parent_ = &target;
+
+        if (cell.type_ == xlnt::cell::type::shared_string)
+        {
+            cell.value_number(static_cast<double>(shared_string(static_cast<std::size_t>(cell.value_number()))));
+        }
+
+        if (cell.format_.is_set())
+        {
+            cell.format_ = format(*cell.format_.get());
+        }
+    }
+
+    std::size_t shared_string(std::size_t index)
+    {
+        if (index >= strings_.size())
+        {
+            strings_.resize(index + 1, 0);
+        }
+
+        auto &translated = strings_[index];
+
+        if (translated == 0)
+        {
+            translated = target_.add_shared_string(source_.shared_strings(index)) + 1;
+        }
+
+        return translated - 1;
+    }
+
+    // returns the format of the target equal to format, with one more reference
+    xlnt::detail::format_impl *format(const xlnt::detail::format_impl &format)
+    {
+        if (format.id >= formats_.size())
+        {
+            formats_.resize(format.id + 1, nullptr);
+        }
+
+        auto &translated = formats_[format.id];
+
+        if (translated == nullptr)
+        {
+            translated = styles_->import_format(format);
+        }
+        else
+        {
+            ++translated->references;
+        }
+
+        return translated;
+    }
+
+    // translates the index of a format of the source, as in row and column properties
+    void format_index(xlnt::optional<std::size_t> &index)
+    {
+        if (source_styles_ != nullptr && index.is_set() && index.get() < source_styles_->format_impls.size())
+        {
+            index = format(source_styles_->format_impls[index.get()])->id;
+        }
+    }
+
+    const xlnt::workbook &source_;
+    const xlnt::detail::stylesheet *source_styles_;
+    xlnt::workbook &target_;
+    xlnt::detail::stylesheet *styles_ = nullptr;
+    // one plus the index of each shared string in the target, 0 until it is translated
+    std::vector<std::size_t> strings_;
+    std::vector<xlnt::detail::format_impl *> formats_;
+};
+
+// Returns title followed by " (number)", shortened to the 31 characters Excel allows.
+std::string numbered_title(const std::string &title, std::size_t number)
+{
+    const auto suffix = " (" + std::to_string(number) + ")";
+    const auto kept = 31 - suffix.size();
+    auto end = std::size_t(0);
+
+    // counts characters rather than bytes so that none is cut in half
+    for (std::size_t characters = 0; end < title.size() && characters < kept; ++characters)
+    {
+        do
+        {
+            ++end;
+        } while (end < title.size() && (static_cast<unsigned char>(title[end]) & 0xC0) == 0x80);
+    }
+
+    return title.substr(0, end) + suffix;
+}
+
 } // namespace
 
 namespace xlnt {
 
+namespace detail {
+
+std::shared_ptr<cell_spill> cell_spill_of(const workbook_impl &wb)
+{
+    return wb.cell_spill_;
+}
+
+} // namespace detail
+
 bool workbook::has_core_property(xlnt::core_property type) const
 {
     return ::contains(d_->core_properties_, type);
@@ -389,7 +622,15 @@ void workbook::arch_id_flags(const std::size_t flags)
 
 workbook workbook::empty()
 {
-    workbook wb(std::make_shared<detail::workbook_impl>());
+    // built once, every empty workbook is a copy of it
+    static const workbook empty_template = build_empty();
+
+    return empty_template.clone(clone_method::deep_copy);
+}
+
+workbook workbook::build_empty()
+{
+    auto wb = bare();
 
     wb.register_package_part(relationship_type::office_document);
 
@@ -400,6 +641,14 @@ workbook workbook::empty()
 
     wb.thumbnail(excel_thumbnail(), "jpeg", "image/jpeg");
 
+    // shared by the copies of the template instead of copied into each
+    for (auto &image : wb.d_->images_)
+    {
+        wb.d_->shared_images_[image.first] = std::make_shared<const std::vector<std::uint8_t>>(std::move(image.second));
+    }
+
+    wb.d_->images_.clear();
+
     wb.core_property(xlnt::core_property::creator, "Microsoft Office User");
     wb.core_property(xlnt::core_property::last_modified_by, "Microsoft Office User");
     wb.core_property(xlnt::core_property::created, datetime(2016, 8, 12, 3, 16, 56));
@@ -492,6 +741,9 @@ workbook workbook::empty()
         .number_format(xlnt::number_format::general())
         .style("Normal");
 
+    // leave only the finished default format behind
+    stylesheet.collect_pending_garbage();
+
     xlnt::calculation_properties calc_props;
     calc_props.calc_id = 150000;
     calc_props.concurrent_calc = false;
@@ -500,6 +752,11 @@ workbook workbook::empty()
     return wb;
 }
 
+workbook workbook::bare()
+{
+    return workbook(std::make_shared<detail::workbook_impl>());
+}
+
 workbook::workbook()
 {
     auto wb_template = empty();
@@ -508,14 +765,14 @@ workbook::workbook()
 
 workbook::workbook(const xlnt::path &file)
 {
-    *this = empty();
+    *this = bare();
     load(file);
 }
 
 template <typename T>
 void workbook::construct(const xlnt::path &file, const T &password)
 {
-    *this = empty();
+    *this = bare();
     load(file, password);
 }
 
@@ -533,14 +790,14 @@ workbook::workbook(const xlnt::path &file, std::u8string_view password)
 
 workbook::workbook(std::istream &data)
 {
-    *this = empty();
+    *this = bare();
     load(data);
 }
 
 template <typename T>
 void workbook::construct(std::istream &data, const T &password)
 {
-    *this = empty();
+    *this = bare();
     load(data, password);
 }
 
@@ -601,6 +858,34 @@ void workbook::register_workbook_part(relationship_type type)
     }
 }
 
+void workbook::register_workbook_part_later(relationship_type type)
+{
+    auto &pending = d_->pending_workbook_parts_;
+
+    if (std::find(pending.begin(), pending.end(), type) == pending.end())
+    {
+        pending.push_back(type);
+    }
+}
+
+void workbook::register_pending_parts() const
+{
+    if (d_->pending_workbook_parts_.empty())
+    {
+        return;
+    }
+
+    // taken first since registering the parts accesses the manifest again
+    auto pending = std::move(d_->pending_workbook_parts_);
+    d_->pending_workbook_parts_.clear();
+    auto self = workbook(d_);
+
+    for (auto type : pending)
+    {
+        self.register_workbook_part(type);
+    }
+}
+
 void workbook::register_worksheet_part(worksheet ws, relationship_type type)
 {
     auto wb_rel = manifest().relationship(path("/"),
@@ -613,36 +898,28 @@ void workbook::register_worksheet_part(worksheet ws, relationship_type type)
     {
         if (!manifest().has_relationship(ws_path, relationship_type::vml_drawing))
         {
-            std::size_t file_number = 1;
-            path filename("vmlDrawing1.vml");
-            bool filename_exists = true;
+            // the drawings already used by any worksheet, gathered once rather than per candidate name
+            std::unordered_set<path> used_drawings;
 
-            while (filename_exists)
+            for (const auto &current_ws_rel :
+                manifest().relationships(wb_rel.target().path(), xlnt::relationship_type::worksheet))
             {
-                filename_exists = false;
+                path current_ws_path(current_ws_rel.source().path().parent().append(current_ws_rel.target().path()));
 
-                for (auto current_ws_rel :
-                    manifest().relationships(wb_rel.target().path(), xlnt::relationship_type::worksheet))
+                for (const auto &current_ws_child_rel :
+                    manifest().relationships(current_ws_path, xlnt::relationship_type::vml_drawing))
                 {
-                    path current_ws_path(current_ws_rel.source().path().parent().append(current_ws_rel.target().path()));
-                    if (!manifest().has_relationship(current_ws_path, xlnt::relationship_type::vml_drawing)) continue;
-
-                    for (auto current_ws_child_rel :
-                        manifest().relationships(current_ws_path, xlnt::relationship_type::vml_drawing))
-                    {
-                        if (current_ws_child_rel.target().path() == path("../drawings").append(filename))
-                        {
-                            filename_exists = true;
-                            break;
-                        }
-                    }
+                    used_drawings.insert(current_ws_child_rel.target().path());
                 }
+            }
 
-                if (filename_exists)
-                {
-                    file_number++;
-                    filename = path("vmlDrawing" + std::to_string(file_number) + ".vml");
-                }
+            std::size_t file_number = 1;
+            path filename("vmlDrawing1.vml");
+
+            while (used_drawings.count(path("../drawings").append(filename)) > 0)
+            {
+                file_number++;
+                filename = path("vmlDrawing" + std::to_string(file_number) + ".vml");
             }
 
             manifest().register_default_type("vml", "application/vnd.openxmlformats-officedocument.vmlDrawing");
@@ -678,61 +955,54 @@ void workbook::register_worksheet_part(worksheet ws, relationship_type type)
 
 const worksheet workbook::sheet_by_title(const std::string &title) const
 {
-    for (auto &impl : d_->worksheets_)
+    auto impl = d_->worksheet_index_.find(d_->worksheets_, title);
+
+    if (impl == nullptr)
     {
-        if (impl.title_ == title)
-        {
-            return worksheet(&impl);
-        }
+        throw key_not_found();
     }
 
-    throw key_not_found();
+    detail::worksheet_loader::load(*impl);
+    return worksheet(impl);
 }
 
 worksheet workbook::sheet_by_title(const std::string &title)
 {
-    for (auto &impl : d_->worksheets_)
+    auto impl = d_->worksheet_index_.find(d_->worksheets_, title);
+
+    if (impl == nullptr)
     {
-        if (impl.title_ == title)
-        {
-            return worksheet(&impl);
-        }
+        throw key_not_found();
     }
 
-    throw key_not_found();
+    detail::worksheet_loader::load(*impl);
+    return worksheet(impl);
 }
 
 worksheet workbook::sheet_by_index(std::size_t index)
 {
-    if (index >= d_->worksheets_.size())
-    {
-        throw invalid_parameter();
-    }
+    auto impl = d_->worksheet_index_.at(d_->worksheets_, index);
 
-    auto iter = d_->worksheets_.begin();
-
-    for (std::size_t i = 0; i < index; ++i)
+    if (impl == nullptr)
     {
-        ++iter;
+        throw invalid_parameter();
     }
 
-    return worksheet(&*iter);
+    detail::worksheet_loader::load(*impl);
+    return worksheet(impl);
 }
 
 const worksheet workbook::sheet_by_index(std::size_t index) const
 {
-    if (index >= d_->worksheets_.size())
-    {
-        throw invalid_parameter();
-    }
+    auto impl = d_->worksheet_index_.at(d_->worksheets_, index);
 
-    auto iter = d_->worksheets_.begin();
-
-    for (std::size_t i = 0; i < index; ++i, ++iter)
+    if (impl == nullptr)
     {
+        throw invalid_parameter();
     }
 
-    return worksheet(&*iter);
+    detail::worksheet_loader::load(*impl);
+    return worksheet(impl);
 }
 
 worksheet workbook::sheet_by_id(std::size_t id)
@@ -741,6 +1011,7 @@ worksheet workbook::sheet_by_id(std::size_t id)
     {
         if (impl.id_ == id)
         {
+            detail::worksheet_loader::load(impl);
             return worksheet(&impl);
         }
     }
@@ -754,6 +1025,7 @@ const worksheet workbook::sheet_by_id(std::size_t id) const
     {
         if (impl.id_ == id)
         {
+            detail::worksheet_loader::load(impl);
             return worksheet(&impl);
         }
     }
@@ -783,9 +1055,10 @@ void workbook::active_sheet(std::size_t index)
 
 bool workbook::has_named_range(const std::string &name) const
 {
-    for (auto worksheet : *this)
+    // names are only created on worksheets which were accessed, so this doesn't need to load any
+    for (const auto &impl : d_->worksheets_)
     {
-        if (worksheet.has_named_range(name))
+        if (impl.named_ranges_.find(name) != impl.named_ranges_.end())
         {
             return true;
         }
@@ -798,33 +1071,35 @@ worksheet workbook::create_sheet()
     std::string title = "Sheet1";
     int index = 1;
 
-    // make a unique sheet name. Sheet<1...n>
-    while (contains(title))
+    // unique sheet id, collecting the existing titles on the way
+    size_t sheet_id = 1;
+    std::unordered_set<std::string> titles;
+    for (const auto &impl : d_->worksheets_)
     {
-        title = "Sheet" + std::to_string(++index);
+        sheet_id = std::max(sheet_id, impl.id_ + 1);
+        titles.insert(impl.title_);
     }
-    // unique sheet id
-    size_t sheet_id = 1;
-    for (const auto ws : *this)
+    // make a unique sheet name. Sheet<1...n>
+    while (titles.count(title) > 0)
     {
-        sheet_id = std::max(sheet_id, ws.id() + 1);
+        title = "Sheet" + std::to_string(++index);
     }
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    d_->worksheet_index_.append(d_->worksheets_.back());
     // unique sheet file name
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
-    auto workbook_files = d_->manifest_.relationships(workbook_rel.target().path());
-    auto rel_vec_contains = [&workbook_files](const xlnt::path &new_file_id) {
-        return workbook_files.end() != std::find_if(workbook_files.begin(), workbook_files.end(), [&new_file_id](const xlnt::relationship &rel) {
-            return rel.target().path() == new_file_id;
-        });
-    };
+    std::unordered_set<path> workbook_files;
+    for (const auto &rel : d_->manifest_.relationships(workbook_rel.target().path()))
+    {
+        workbook_files.insert(rel.target().path());
+    }
 
     size_t file_id = sheet_id;
     xlnt::path sheet_relative_path;
     do
     {
         sheet_relative_path = path("worksheets").append("sheet" + std::to_string(file_id++) + ".xml");
-    } while (rel_vec_contains(sheet_relative_path));
+    } while (workbook_files.count(sheet_relative_path) > 0);
 
     uri relative_sheet_uri(sheet_relative_path.string());
     auto absolute_sheet_path = path("/xl").append(relative_sheet_uri.path());
@@ -842,46 +1117,110 @@ worksheet workbook::create_sheet()
 
 worksheet workbook::copy_sheet(worksheet to_copy)
 {
-    if (to_copy.d_->parent_.lock() != d_) throw invalid_parameter();
+    return copy_sheet(to_copy, d_->worksheets_.size());
+}
 
-    detail::worksheet_impl impl(*to_copy.d_);
-    auto new_sheet = create_sheet();
-    impl.title_ = new_sheet.title();
-    impl.id_ = new_sheet.id();
-    *new_sheet.d_ = impl;
+worksheet workbook::copy_sheet(worksheet to_copy, std::size_t index)
+{
+    const auto source = to_copy.d_->parent_.lock();
+    if (!source) throw invalid_parameter();
+
+    auto new_sheet = create_sheet(index);
+    auto &target = *new_sheet.d_;
+    const auto &other = *to_copy.d_;
+
+    if (source == d_)
+    {
+        const auto title = target.title_;
+        const auto id = target.id_;
+        target.assign(other, true);
+        target.title_ = title;
+        target.id_ = id;
+
+        return new_sheet;
+    }
+
+    // the cells are copied one by one into the storage of this workbook, taking their
+    // shared strings and formats along
+    detail::worksheet_loader::load(*to_copy.d_);
+    const auto source_workbook = workbook(source);
+    sheet_translation translation(source_workbook, *source, *this, d_);
+    translation.copy_sheet(other, target);
 
     return new_sheet;
 }
 
-worksheet workbook::copy_sheet(worksheet to_copy, std::size_t index)
+void workbook::merge_from(std::vector<workbook> &&sources)
+{
+    merge_from(std::move(sources), merge_options());
+}
+
+void workbook::merge_from(std::vector<workbook> &&sources, const merge_options &options)
 {
-    copy_sheet(to_copy);
+    // the titles are settled first, so that nothing is merged if one is taken
+    std::unordered_set<std::string> titles;
+    std::vector<std::string> merged_titles;
+    std::unordered_set<const detail::workbook_impl *> merged = {d_.get()};
+
+    for (const auto &ws : d_->worksheets_)
+    {
+        titles.insert(ws.title_);
+    }
+
+    for (const auto &source : sources)
+    {
+        // neither this workbook nor any other may be merged twice
+        if (!merged.insert(source.d_.get()).second) throw invalid_parameter();
+
+        for (const auto &ws : source.d_->worksheets_)
+        {
+            auto title = ws.title_;
+
+            if (titles.count(title) > 0 && !options.rename_duplicates)
+            {
+                throw invalid_parameter();
+            }
+
+            for (std::size_t number = 2; titles.count(title) > 0; ++number)
+            {
+                title = numbered_title(ws.title_, number);
+            }
+
+            titles.insert(title);
+            merged_titles.push_back(title);
+        }
+    }
 
-    if (index != d_->worksheets_.size() - 1)
+    auto merged_title = merged_titles.begin();
+
+    for (auto &source : sources)
     {
-        auto iter = d_->worksheets_.begin();
+        detail::worksheet_loader::load_all(*source.d_);
+        sheet_translation translation(source, *source.d_, *this, d_);
 
-        for (std::size_t i = 0; i < index; ++i, ++iter)
+        for (auto &other : source.d_->worksheets_)
         {
+            auto new_sheet = create_sheet();
+            new_sheet.title(*merged_title++);
+            translation.move_sheet(other, *new_sheet.d_);
         }
 
-        d_->worksheets_.insert(iter, d_->worksheets_.back());
-        d_->worksheets_.pop_back();
+        source.clear();
     }
 
-    return sheet_by_index(index);
+    sources.clear();
 }
 
 std::size_t workbook::index(worksheet ws) const
 {
-    auto match = std::find(begin(), end(), ws);
+    const auto position = d_->worksheet_index_.position(d_->worksheets_, ws.d_);
 
-    if (match == end())
+    if (position == d_->worksheets_.size())
     {
         throw invalid_parameter();
     }
 
-    return static_cast<std::size_t>(std::distance(begin(), match));
+    return position;
 }
 
 void workbook::move_sheet(worksheet worksheet, std::size_t newIndex)
@@ -915,6 +1254,7 @@ void workbook::move_sheet(worksheet worksheet, std::size_t newIndex)
         ++targetPosition;
 
     d_->worksheets_.splice(targetPosition, d_->worksheets_, sourcePosition);
+    d_->worksheet_index_.invalidate();
 }
 
 void workbook::create_named_range(const std::string &name, worksheet range_owner, const std::string &reference_string)
@@ -955,9 +1295,21 @@ range workbook::named_range(const std::string &name)
 }
 
 void workbook::load(std::istream &stream)
+{
+    load(stream, load_options());
+}
+
+void workbook::load(std::istream &stream, const load_options &options)
+{
+    load_reusing(stream, options, nullptr);
+}
+
+void workbook::load_reusing(std::istream &stream, const load_options &options,
+    std::shared_ptr<detail::load_buffers> buffers)
 {
     clear();
-    detail::xlsx_consumer consumer(*this);
+    detail::xlsx_consumer consumer(*this, options);
+    consumer.reuse(std::move(buffers));
 
     try
     {
@@ -975,18 +1327,52 @@ void workbook::load(std::istream &stream)
             throw;
         }
     }
+
+    if (options.shrink_to_fit)
+    {
+        shrink_to_fit();
+    }
+}
+
+void workbook::load(std::shared_ptr<byte_source> source)
+{
+    load(std::move(source), load_options());
+}
+
+void workbook::load(std::shared_ptr<byte_source> source, const load_options &options)
+{
+    clear();
+    detail::xlsx_consumer consumer(*this, options);
+    consumer.read(std::move(source));
+
+    if (options.shrink_to_fit)
+    {
+        shrink_to_fit();
+    }
 }
 
 void workbook::load(const std::vector<std::uint8_t> &data)
+{
+    load(data, load_options());
+}
+
+void workbook::load(const std::vector<std::uint8_t> &data, const load_options &options)
+{
+    load_reusing(data, options, nullptr);
+}
+
+void workbook::load_reusing(const std::vector<std::uint8_t> &data, const load_options &options,
+    std::shared_ptr<detail::load_buffers> buffers)
 {
     if (data.size() < 22) // the shortest ZIP file is 22 bytes
     {
         throw xlnt::exception("file is empty or malformed");
     }
 
-    xlnt::detail::vector_istreambuf data_buffer(data);
+    // reading through a memory_istreambuf lets parts be inflated straight from data
+    xlnt::detail::memory_istreambuf data_buffer(data.data(), data.size());
     std::istream data_stream(&data_buffer);
-    load(data_stream);
+    load_reusing(data_stream, options, std::move(buffers));
 }
 
 template <typename T>
@@ -1008,6 +1394,41 @@ void workbook::load(const std::string &filename)
 
 void workbook::load(const path &filename)
 {
+    load(filename, load_options());
+}
+
+void workbook::load(const std::string &filename, const load_options &options)
+{
+    load(path(filename), options);
+}
+
+void workbook::load(const path &filename, const load_options &options)
+{
+    load_reusing(filename, options, nullptr);
+}
+
+void workbook::load_reusing(const path &filename, const load_options &options,
+    std::shared_ptr<detail::load_buffers> buffers)
+{
+    if (options.memory_map)
+    {
+        detail::mapped_file mapping(filename.string());
+
+        if (mapping.is_open())
+        {
+            if (mapping.size() < 22) // the shortest ZIP file is 22 bytes
+            {
+                throw xlnt::exception("file is empty or malformed");
+            }
+
+            detail::memory_istreambuf mapped_buffer(mapping.data(), mapping.size());
+            std::istream mapped_stream(&mapped_buffer);
+            load_reusing(mapped_stream, options, std::move(buffers));
+
+            return;
+        }
+    }
+
     std::ifstream file_stream;
     open_stream(file_stream, filename.string());
 
@@ -1016,15 +1437,96 @@ void workbook::load(const path &filename)
         throw xlnt::exception("file not found " + filename.string());
     }
 
-    load(file_stream);
+    load_reusing(file_stream, options, std::move(buffers));
 }
 
-void workbook::load(const std::string &filename, const std::string &password)
+void workbook::save_snapshot(std::vector<std::uint8_t> &data) const
 {
-    return load_internal(filename, password);
+    // the cells are tokenized from the saved archive, so they are exactly what load would read
+    save_options options;
+    options.compression = compression_level::none;
+    std::vector<std::uint8_t> package;
+    save(package, options);
+    detail::write_snapshot(package, manifest(), data);
 }
 
-template <typename T>
+void workbook::save_snapshot(const path &filename) const
+{
+    std::vector<std::uint8_t> data;
+    save_snapshot(data);
+
+    std::ofstream file_stream;
+    open_stream(file_stream, filename.string());
+    detail::to_stream(data, file_stream);
+}
+
+void workbook::load_snapshot(const std::vector<std::uint8_t> &data)
+{
+    read_snapshot(*this, data.data(), data.size());
+}
+
+void workbook::load_snapshot(const path &filename)
+{
+    detail::mapped_file mapping(filename.string());
+
+    if (mapping.is_open())
+    {
+        read_snapshot(*this, mapping.data(), mapping.size());
+        return;
+    }
+
+    std::ifstream file_stream;
+    open_stream(file_stream, filename.string());
+
+    if (!file_stream.good())
+    {
+        throw xlnt::exception("file not found " + filename.string());
+    }
+
+    const auto data = detail::to_vector(file_stream);
+    read_snapshot(*this, data.data(), data.size());
+}
+
+void workbook::update(const path &filename, const std::function<void(workbook &)> &modifications)
+{
+    update(filename, modifications, load_options(), save_options());
+}
+
+void workbook::update(const path &filename, const std::function<void(workbook &)> &modifications,
+    const load_options &load, const save_options &save)
+{
+    auto lazy_options = load;
+    lazy_options.lazy_worksheets = true;
+    lazy_options.lazy_shared_strings = true;
+    lazy_options.lazy_binaries = true;
+    this->load(filename, lazy_options);
+
+    modifications(*this);
+
+    // the parts copied from the old file are read from the copy the workbook keeps
+    // of it, so the file can be replaced once the new one is complete
+    auto preserving_options = save;
+    preserving_options.preserve_unchanged_parts = true;
+    std::vector<std::uint8_t> data;
+    this->save(data, preserving_options);
+
+    std::ofstream file_stream;
+    open_stream(file_stream, filename.string());
+
+    if (!file_stream.good())
+    {
+        throw xlnt::exception("file could not be opened for writing " + filename.string());
+    }
+
+    file_stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+void workbook::load(const std::string &filename, const std::string &password)
+{
+    return load_internal(filename, password);
+}
+
+template <typename T>
 void workbook::load_internal(const xlnt::path &filename, const T &password)
 {
     std::ifstream file_stream;
@@ -1050,6 +1552,11 @@ void workbook::load(const xlnt::path &filename, std::u8string_view password)
 }
 #endif
 
+void workbook::load(const xlnt::path &filename, const encryption_key &key)
+{
+    load_internal(filename, key);
+}
+
 template <typename T>
 void workbook::load_internal(const std::vector<std::uint8_t> &data, const T &password)
 {
@@ -1058,7 +1565,8 @@ void workbook::load_internal(const std::vector<std::uint8_t> &data, const T &pas
         throw xlnt::exception("file is empty or malformed");
     }
 
-    xlnt::detail::vector_istreambuf data_buffer(data);
+    // the compound document of an encrypted file reads its sectors straight from data
+    xlnt::detail::memory_istreambuf data_buffer(data.data(), data.size());
     std::istream data_stream(&data_buffer);
     load(data_stream, password);
 }
@@ -1095,6 +1603,11 @@ void workbook::load(std::istream &stream, std::u8string_view password)
 }
 #endif
 
+void workbook::load(std::istream &stream, const encryption_key &key)
+{
+    load_internal(stream, key);
+}
+
 void workbook::save(std::vector<std::uint8_t> &data) const
 {
     xlnt::detail::vector_ostreambuf data_buffer(data);
@@ -1171,12 +1684,71 @@ void workbook::save(const xlnt::path &filename, std::u8string_view password) con
 }
 #endif
 
+void workbook::save(const xlnt::path &filename, const encryption_key &key) const
+{
+    save_internal(filename, key);
+}
+
 void workbook::save(std::ostream &stream) const
 {
-    detail::xlsx_producer producer(*this);
+    save(stream, save_options());
+}
+
+void workbook::save(std::vector<std::uint8_t> &data, const save_options &options) const
+{
+    xlnt::detail::vector_ostreambuf data_buffer(data);
+    std::ostream data_stream(&data_buffer);
+    save(data_stream, options);
+}
+
+void workbook::save(const std::string &filename, const save_options &options) const
+{
+    save(path(filename), options);
+}
+
+void workbook::save(const path &filename, const save_options &options) const
+{
+    std::ofstream file_stream;
+    open_stream(file_stream, filename.string());
+    save(file_stream, options);
+}
+
+void workbook::save(std::ostream &stream, const save_options &options) const
+{
+    detail::xlsx_producer producer(*this, options);
     producer.write(stream);
 }
 
+void workbook::save(byte_sink &sink) const
+{
+    save(sink, save_options());
+}
+
+void workbook::save(byte_sink &sink, const save_options &options) const
+{
+    detail::sink_streambuf buffer(sink, options.sink_chunk_size);
+    std::ostream stream(&buffer);
+    // failed writes of the sink are rethrown rather than ending the stream
+    stream.exceptions(std::ios::badbit);
+    save(stream, options);
+    buffer.finish();
+}
+
+std::future<void> workbook::save_async(const path &filename) const
+{
+    return save_async(filename, save_options());
+}
+
+std::future<void> workbook::save_async(const path &filename, const save_options &options) const
+{
+    // the clone shares nothing with this workbook, so it can be written while this one changes
+    const auto snapshot = clone(clone_method::deep_copy);
+
+    return std::async(std::launch::async, [snapshot, filename, options]() {
+        snapshot.save(filename, options);
+    });
+}
+
 template <typename T>
 void workbook::save_internal(std::ostream &stream, const T &password) const
 {
@@ -1196,6 +1768,11 @@ void workbook::save(std::ostream &stream, std::u8string_view password) const
 }
 #endif
 
+void workbook::save(std::ostream &stream, const encryption_key &key) const
+{
+    save_internal(stream, key);
+}
+
 #ifdef _MSC_VER
 void workbook::save(const std::wstring &filename) const
 {
@@ -1266,6 +1843,7 @@ void workbook::remove_sheet(worksheet ws)
     auto rel_id_map = d_->manifest_.unregister_relationship(wb_rel.target(), ws_rel_id);
     d_->sheet_title_rel_id_map_.erase(ws.title());
     d_->worksheets_.erase(match_iter);
+    d_->worksheet_index_.invalidate();
 
     // Shift sheet title->ID mappings down as a result of manifest::unregister_relationship above.
     for (auto &title_rel_id_pair : d_->sheet_title_rel_id_map_)
@@ -1280,27 +1858,24 @@ void workbook::remove_sheet(worksheet ws)
 
 worksheet workbook::create_sheet(std::size_t index)
 {
-    create_sheet();
+    auto new_sheet = create_sheet();
 
-    if (index != d_->worksheets_.size() - 1)
+    if (index < d_->worksheets_.size() - 1)
     {
-        auto iter = d_->worksheets_.begin();
-
-        for (std::size_t i = 0; i < index; ++i, ++iter)
-        {
-        }
-
-        d_->worksheets_.insert(iter, d_->worksheets_.back());
-        d_->worksheets_.pop_back();
+        // moved into place without copying it
+        d_->worksheets_.splice(std::next(d_->worksheets_.begin(), static_cast<std::ptrdiff_t>(index)),
+            d_->worksheets_, std::prev(d_->worksheets_.end()));
+        d_->worksheet_index_.invalidate();
     }
 
-    return sheet_by_index(index);
+    return new_sheet;
 }
 
 worksheet workbook::create_sheet_with_rel(const std::string &title, const relationship &rel)
 {
     auto sheet_id = d_->worksheets_.size() + 1;
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    d_->worksheet_index_.append(d_->worksheets_.back());
 
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     auto sheet_absoulute_path = workbook_rel.target().path().parent().append(rel.target().path());
@@ -1349,9 +1924,9 @@ std::vector<std::string> workbook::sheet_titles() const
 {
     std::vector<std::string> names;
 
-    for (auto ws : *this)
+    for (const auto &impl : d_->worksheets_)
     {
-        names.push_back(ws.title());
+        names.push_back(impl.title_);
     }
 
     return names;
@@ -1374,8 +1949,102 @@ worksheet workbook::operator[](std::size_t index)
 
 void workbook::clear()
 {
+    const auto storage = d_->cell_storage_;
+    const auto budget = d_->cell_memory_budget_;
+    const auto spill = d_->cell_spill_;
+    const auto strings = d_->string_storage_;
     *d_ = detail::workbook_impl();
     d_->stylesheet_.clear();
+    d_->cell_storage_ = storage;
+    d_->cell_memory_budget_ = budget;
+    d_->cell_spill_ = spill;
+    d_->string_storage_ = strings;
+}
+
+std::size_t workbook::calculate(std::size_t threads)
+{
+    if (!d_->formula_engine_)
+    {
+        d_->formula_engine_ = std::make_shared<detail::formula_engine>();
+    }
+
+    return d_->formula_engine_->calculate(*this, threads);
+}
+
+memory_usage workbook::memory_usage() const
+{
+    auto usage = xlnt::memory_usage();
+    std::unordered_set<const detail::worksheet_loader *> loaders;
+
+    for (auto &impl : d_->worksheets_)
+    {
+        usage += worksheet(&impl).memory_usage();
+
+        // worksheets waiting to be read share the loader of the workbook
+        const auto loader = impl.loader_.get();
+
+        if (loader != nullptr && loaders.insert(loader).second)
+        {
+            usage.binaries += loader->memory_usage();
+        }
+    }
+
+    usage.shared_strings = detail::heap_size(d_->shared_strings_values_) + detail::heap_size(d_->shared_strings_ids_);
+
+    for (const auto &text : d_->shared_strings_values_)
+    {
+        usage.shared_strings += text.memory_usage();
+    }
+
+    for (const auto &id : d_->shared_strings_ids_)
+    {
+        usage.shared_strings += id.first.memory_usage();
+    }
+
+    for (const auto &loader : {d_->shared_strings_loader_, d_->retired_shared_strings_loader_})
+    {
+        usage.shared_strings += loader ? loader->memory_usage() : 0;
+    }
+
+    if (d_->stylesheet_.is_set())
+    {
+        const auto &stylesheet = d_->stylesheet_.get();
+
+        // formats are list nodes which the stylesheet indexes and hashes
+        usage.styles = sizeof(detail::stylesheet)
+            + stylesheet.format_impls.size() * (sizeof(detail::format_impl) + 3 * sizeof(void *) + sizeof(std::size_t))
+            + detail::heap_size(stylesheet.style_impls) + detail::heap_size(stylesheet.style_names)
+            + detail::heap_size(stylesheet.borders) + detail::heap_size(stylesheet.fills)
+            + detail::heap_size(stylesheet.fonts) + detail::heap_size(stylesheet.number_formats)
+            + detail::heap_size(stylesheet.colors);
+
+        for (const auto &name : stylesheet.style_names)
+        {
+            usage.styles += 2 * detail::heap_size(name);
+        }
+    }
+
+    for (const auto *binaries : {&d_->images_, &d_->binaries_})
+    {
+        usage.binaries += detail::heap_size(*binaries);
+
+        for (const auto &binary : *binaries)
+        {
+            usage.binaries += detail::heap_size(binary.first) + binary.second.capacity();
+        }
+    }
+
+    for (const auto *binaries : {&d_->compressed_images_, &d_->compressed_binaries_})
+    {
+        usage.binaries += detail::heap_size(*binaries);
+
+        for (const auto &binary : *binaries)
+        {
+            usage.binaries += detail::heap_size(binary.first) + binary.second.data.capacity();
+        }
+    }
+
+    return usage;
 }
 
 bool workbook::compare(const workbook &other, bool compare_by_reference) const
@@ -1386,6 +2055,17 @@ bool workbook::compare(const workbook &other, bool compare_by_reference) const
     }
     else
     {
+        detail::worksheet_loader::load_all(*d_);
+        detail::worksheet_loader::load_all(*other.d_);
+        auto self = workbook(d_);
+        auto rhs = workbook(other.d_);
+        detail::shared_string_loader::load_all(self);
+        detail::shared_string_loader::load_all(rhs);
+        inflate_binaries(*d_);
+        inflate_binaries(*other.d_);
+        register_pending_parts();
+        other.register_pending_parts();
+
         return *d_ == *other.d_;
     }
 }
@@ -1410,16 +2090,57 @@ workbook workbook::clone(clone_method method) const
     switch (method)
     {
     case clone_method::deep_copy:
+    case clone_method::copy_on_access:
     {
-        workbook wb;
-        *wb.d_ = *d_;
+        // the clone shouldn't inherit garbage which either of them would collect later.
+        // Worksheets still to be read from the file refer to formats by their ids in it,
+        // which collecting garbage would change.
+        const auto reading = std::any_of(d_->worksheets_.begin(), d_->worksheets_.end(),
+            [](const detail::worksheet_impl &ws) { return ws.loader_ != nullptr; });
+
+        if (d_->stylesheet_.is_set() && !reading)
+        {
+            d_->stylesheet_.get().collect_pending_garbage();
+        }
+
+        auto wb = bare();
+        wb.d_->assign(*d_, false);
+
+        for (auto &impl : wb.d_->worksheets_)
+        {
+            impl.parent_ = wb.d_;
+            impl.workbook_ = wb.d_.get();
+        }
+
+        auto &stylesheet = wb.d_->stylesheet_.get();
+        stylesheet.parent = wb.d_;
 
-        for (auto ws : wb)
+        for (auto &impl : stylesheet.format_impls)
         {
-            ws.parent(wb);
+            impl.parent = &stylesheet;
+        }
+
+        for (auto &entry : stylesheet.style_impls)
+        {
+            entry.second.parent = &stylesheet;
+        }
+
+        for (auto &impl : stylesheet.conditional_format_impls)
+        {
+            for (auto &ws : wb.d_->worksheets_)
+            {
+                if (impl.target_sheet != nullptr && ws.id_ == impl.target_sheet->id_)
+                {
+                    impl.target_sheet = &ws;
+                    break;
+                }
+            }
         }
 
-        wb.d_->stylesheet_.get().parent = wb.d_;
+        if (method == clone_method::deep_copy)
+        {
+            detail::worksheet_loader::load_all(*wb.d_);
+        }
 
         return wb;
     }
@@ -1538,16 +2259,24 @@ const format workbook::format(std::size_t format_index) const
 
 manifest &workbook::manifest()
 {
+    register_pending_parts();
     return d_->manifest_;
 }
 
 const manifest &workbook::manifest() const
 {
+    register_pending_parts();
     return d_->manifest_;
 }
 
 const rich_text &workbook::shared_strings(std::size_t index) const
 {
+    if (d_->shared_strings_pending_.load(std::memory_order_acquire))
+    {
+        auto wb = workbook(d_);
+        return detail::shared_string_loader::get(wb, index);
+    }
+
     if (index < d_->shared_strings_values_.size())
     {
         return d_->shared_strings_values_.at(index);
@@ -1559,17 +2288,24 @@ const rich_text &workbook::shared_strings(std::size_t index) const
 
 std::vector<rich_text> &workbook::shared_strings()
 {
+    detail::shared_string_loader::load_all(*this);
+    // the table may be modified now, which also invalidates the strings of the loader
+    d_->retired_shared_strings_loader_.reset();
     return d_->shared_strings_values_;
 }
 
 const std::vector<rich_text> &workbook::shared_strings() const
 {
+    auto wb = workbook(d_);
+    detail::shared_string_loader::load_all(wb);
     return d_->shared_strings_values_;
 }
 
 std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_duplicates)
 {
-    register_workbook_part(relationship_type::shared_string_table);
+    register_workbook_part_later(relationship_type::shared_string_table);
+    detail::shared_string_loader::load_all(*this);
+    d_->retired_shared_strings_loader_.reset();
 
     if (!allow_duplicates)
     {
@@ -1581,21 +2317,144 @@ std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_dupl
         }
     }
 
-    auto sz = d_->shared_strings_ids_.size();
+    // with duplicates, the lookup map has fewer entries than the table
+    auto sz = d_->shared_strings_values_.size();
     d_->shared_strings_ids_[shared] = sz;
     d_->shared_strings_values_.push_back(shared);
 
     return sz;
 }
 
-bool workbook::contains(const std::string &sheet_title) const
+std::size_t workbook::add_shared_string(rich_text &&shared, bool allow_duplicates)
 {
-    for (auto ws : *this)
+    register_workbook_part_later(relationship_type::shared_string_table);
+    detail::shared_string_loader::load_all(*this);
+    d_->retired_shared_strings_loader_.reset();
+
+    if (!allow_duplicates)
     {
-        if (ws.title() == sheet_title) return true;
+        auto it = d_->shared_strings_ids_.find(shared);
+
+        if (it != d_->shared_strings_ids_.end())
+        {
+            return it->second;
+        }
     }
 
-    return false;
+    // with duplicates, the lookup map has fewer entries than the table
+    auto sz = d_->shared_strings_values_.size();
+    d_->shared_strings_values_.push_back(std::move(shared));
+    d_->shared_strings_ids_[d_->shared_strings_values_.back()] = sz;
+
+    return sz;
+}
+
+std::size_t workbook::compact_shared_strings(bool order_by_frequency)
+{
+    detail::worksheet_loader::load_all(*d_);
+    detail::shared_string_loader::load_all(*this);
+    d_->retired_shared_strings_loader_.reset();
+
+    auto &values = d_->shared_strings_values_;
+    const auto old_count = values.size();
+    const auto unused = std::numeric_limits<std::size_t>::max();
+
+    // the number of cells referring to each string
+    std::vector<std::size_t> uses(old_count, 0);
+
+    for (auto &ws : d_->worksheets_)
+    {
+        ws.cell_map_.for_each([&uses](detail::cell_impl &cell) {
+            const auto index = static_cast<std::size_t>(cell.value_numeric_);
+
+            if (cell.type_ == cell::type::shared_string && index < uses.size())
+            {
+                ++uses[index];
+            }
+        });
+    }
+
+    // the new index of each string, keeping the first of identical strings
+    std::vector<std::size_t> remap(old_count, unused);
+    std::vector<rich_text> kept;
+    std::vector<std::size_t> kept_uses;
+    d_->shared_strings_ids_.clear();
+
+    for (std::size_t index = 0; index < old_count; ++index)
+    {
+        if (uses[index] == 0)
+        {
+            continue;
+        }
+
+        auto id = d_->shared_strings_ids_.emplace(values[index], kept.size());
+
+        if (id.second)
+        {
+            kept.push_back(std::move(values[index]));
+            kept_uses.push_back(0);
+        }
+
+        remap[index] = id.first->second;
+        kept_uses[remap[index]] += uses[index];
+    }
+
+    if (order_by_frequency)
+    {
+        std::vector<std::size_t> by_uses(kept.size());
+
+        for (std::size_t index = 0; index < by_uses.size(); ++index)
+        {
+            by_uses[index] = index;
+        }
+
+        std::stable_sort(by_uses.begin(), by_uses.end(), [&kept_uses](std::size_t a, std::size_t b) {
+            return kept_uses[a] > kept_uses[b];
+        });
+
+        std::vector<std::size_t> position(kept.size());
+        std::vector<rich_text> sorted;
+        sorted.reserve(kept.size());
+
+        for (std::size_t index = 0; index < by_uses.size(); ++index)
+        {
+            position[by_uses[index]] = index;
+            sorted.push_back(std::move(kept[by_uses[index]]));
+        }
+
+        kept.swap(sorted);
+
+        for (auto &index : remap)
+        {
+            index = index == unused ? unused : position[index];
+        }
+
+        for (auto &id : d_->shared_strings_ids_)
+        {
+            id.second = position[id.second];
+        }
+    }
+
+    values.swap(kept);
+
+    for (auto &ws : d_->worksheets_)
+    {
+        ws.cell_map_.for_each([&remap](detail::cell_impl &cell) {
+            const auto index = static_cast<std::size_t>(cell.value_numeric_);
+
+            if (cell.type_ == cell::type::shared_string && index < remap.size())
+            {
+                cell.value_number(static_cast<double>(remap[index]));
+            }
+        });
+    }
+
+    return old_count - values.size();
+}
+
+bool workbook::contains(const std::string &sheet_title) const
+{
+    return d_->worksheet_index_.find(d_->worksheets_, sheet_title) != nullptr;
 }
 
 void workbook::thumbnail(const std::vector<std::uint8_t> &thumbnail,
@@ -1609,17 +2468,21 @@ void workbook::thumbnail(const std::vector<std::uint8_t> &thumbnail,
     }
 
     auto thumbnail_rel = d_->manifest_.relationship(path("/"), relationship_type::thumbnail);
+    d_->compressed_images_.erase(thumbnail_rel.target().to_string());
+    d_->shared_images_.erase(thumbnail_rel.target().to_string());
     d_->images_[thumbnail_rel.target().to_string()] = thumbnail;
 }
 
 const std::vector<std::uint8_t> &workbook::thumbnail() const
 {
+    inflate_binaries(*d_);
     auto thumbnail_rel = d_->manifest_.relationship(path("/"), relationship_type::thumbnail);
     return d_->images_.at(thumbnail_rel.target().to_string());
 }
 
 const std::unordered_map<std::string, std::vector<std::uint8_t>> &workbook::binaries() const
 {
+    inflate_binaries(*d_);
     return d_->binaries_;
 }
 
@@ -1653,6 +2516,111 @@ void workbook::base_date(calendar base_date)
     d_->base_date_ = base_date;
 }
 
+xlnt::cell_storage workbook::cell_storage() const
+{
+    return d_->cell_storage_;
+}
+
+void workbook::cell_storage(xlnt::cell_storage storage)
+{
+    d_->cell_storage_ = storage;
+
+    if (storage == xlnt::cell_storage::spilled_rows && !d_->cell_spill_)
+    {
+        d_->cell_spill_ = std::make_shared<detail::cell_spill>(detail::cell_store::block_size(), d_->cell_memory_budget_);
+    }
+
+    for (auto &ws : d_->worksheets_)
+    {
+        ws.cell_map_.spill(d_->cell_spill_);
+        ws.cell_map_.engine(storage);
+    }
+}
+
+std::size_t workbook::cell_memory_budget() const
+{
+    return d_->cell_memory_budget_;
+}
+
+void workbook::cell_memory_budget(std::size_t bytes)
+{
+    d_->cell_memory_budget_ = bytes;
+
+    if (d_->cell_spill_)
+    {
+        d_->cell_spill_->budget(bytes);
+    }
+}
+
+void workbook::freeze()
+{
+    detail::worksheet_loader::load_all(*d_);
+    detail::shared_string_loader::load_all(*this);
+    d_->shared_strings_values_.shrink_to_fit();
+
+    for (auto &ws : d_->worksheets_)
+    {
+        ws.cell_map_.freeze();
+    }
+}
+
+void workbook::thaw()
+{
+    for (auto &ws : d_->worksheets_)
+    {
+        ws.cell_map_.thaw();
+    }
+}
+
+bool workbook::frozen() const
+{
+    return std::any_of(d_->worksheets_.begin(), d_->worksheets_.end(),
+        [](const detail::worksheet_impl &ws) { return ws.cell_map_.frozen(); });
+}
+
+void workbook::shrink_to_fit()
+{
+    for (auto &ws : d_->worksheets_)
+    {
+        if (ws.load_pending_) continue;
+
+        ws.cell_map_.shrink_to_fit();
+        ws.column_properties_.shrink_to_fit();
+        ws.row_properties_.shrink_to_fit();
+        ws.formula_groups_.shrink_to_fit();
+        ws.views_.shrink_to_fit();
+        ws.column_breaks_.shrink_to_fit();
+        ws.row_breaks_.shrink_to_fit();
+    }
+
+    d_->shared_strings_ids_.rehash(0);
+    d_->shared_strings_values_.shrink_to_fit();
+
+    if (d_->stylesheet_.is_set())
+    {
+        auto &stylesheet = d_->stylesheet_.get();
+        stylesheet.format_impls.shrink_to_fit();
+        stylesheet.style_names.shrink_to_fit();
+        stylesheet.alignments.shrink_to_fit();
+        stylesheet.borders.shrink_to_fit();
+        stylesheet.fills.shrink_to_fit();
+        stylesheet.fonts.shrink_to_fit();
+        stylesheet.number_formats.shrink_to_fit();
+        stylesheet.protections.shrink_to_fit();
+        stylesheet.colors.shrink_to_fit();
+    }
+}
+
+xlnt::string_storage workbook::string_storage() const
+{
+    return d_->string_storage_;
+}
+
+void workbook::string_storage(xlnt::string_storage storage)
+{
+    d_->string_storage_ = storage;
+}
+
 bool workbook::has_title() const
 {
     return d_->title_.is_set();
@@ -1852,10 +2820,10 @@ void workbook::reorder_relationships()
     const auto wb_rel_target = manifest().relationship(path("/"), relationship_type::office_document).target();
     auto rel_copy = manifest().relationships(wb_rel_target.path());
     std::sort(rel_copy.begin(), rel_copy.end(), rel_id_sorter{});
-    // clear existing relations
-    for (const auto &rel : rel_copy)
+    // clear existing relations, highest id first so that no remaining ids have to be shifted down
+    for (auto rel = rel_copy.rbegin(); rel != rel_copy.rend(); ++rel)
     {
-        manifest().unregister_relationship(wb_rel_target, rel.id());
+        manifest().unregister_relationship(wb_rel_target, rel->id());
     }
     // create new relations
     std::size_t index = 0;
@@ -0,0 +1,415 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/rich_text.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/arrow_export.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+#include <detail/serialization/serialisation_helpers.hpp>
+
+namespace {
+
+enum class value_kind : std::uint8_t
+{
+    none,
+    number,
+    boolean,
+    text
+};
+
+// The values of one column of the range, gathered before its type is known.
+struct column_values
+{
+    std::string name;
+    std::vector<value_kind> kinds;
+    std::vector<double> numbers;
+    // the shared string index of text, or -1 - i for the other text i
+    std::vector<std::int32_t> texts;
+    bool any_number = false;
+    bool any_boolean = false;
+    bool any_text = false;
+};
+
+// What an exported array owns, which release_array frees.
+struct exported_array
+{
+    std::vector<std::shared_ptr<const void>> owned;
+    std::vector<const void *> buffers;
+    std::vector<std::unique_ptr<ArrowArray>> children;
+    std::vector<ArrowArray *> child_pointers;
+    std::unique_ptr<ArrowArray> dictionary;
+};
+
+// What an exported schema owns, which release_schema frees.
+struct exported_schema
+{
+    std::string format;
+    std::string name;
+    std::vector<std::unique_ptr<ArrowSchema>> children;
+    std::vector<ArrowSchema *> child_pointers;
+    std::unique_ptr<ArrowSchema> dictionary;
+};
+
+void release_array(ArrowArray *array)
+{
+    auto data = static_cast<exported_array *>(array->private_data);
+
+    // consumers may have moved children out, leaving them released
+    for (auto child : data->child_pointers)
+    {
+        if (child->release != nullptr)
+        {
+            child->release(child);
+        }
+    }
+
+    if (data->dictionary && data->dictionary->release != nullptr)
+    {
+        data->dictionary->release(data->dictionary.get());
+    }
+
+    delete data;
+    array->release = nullptr;
+}
+
+void release_schema(ArrowSchema *schema)
+{
+    auto data = static_cast<exported_schema *>(schema->private_data);
+
+    for (auto child : data->child_pointers)
+    {
+        if (child->release != nullptr)
+        {
+            child->release(child);
+        }
+    }
+
+    if (data->dictionary && data->dictionary->release != nullptr)
+    {
+        data->dictionary->release(data->dictionary.get());
+    }
+
+    delete data;
+    schema->release = nullptr;
+}
+
+// Hands data over to array, which describes length elements of which null_count are null.
+void fill_array(ArrowArray *array, std::unique_ptr<exported_array> data, std::int64_t length, std::int64_t null_count)
+{
+    for (auto &child : data->children)
+    {
+        data->child_pointers.push_back(child.get());
+    }
+
+    array->length = length;
+    array->null_count = null_count;
+    array->offset = 0;
+    array->n_buffers = static_cast<std::int64_t>(data->buffers.size());
+    array->n_children = static_cast<std::int64_t>(data->child_pointers.size());
+    array->buffers = data->buffers.empty() ? nullptr : data->buffers.data();
+    array->children = data->child_pointers.empty() ? nullptr : data->child_pointers.data();
+    array->dictionary = data->dictionary.get();
+    array->release = release_array;
+    array->private_data = data.release();
+}
+
+// Hands data over to schema.
+void fill_schema(ArrowSchema *schema, std::unique_ptr<exported_schema> data, std::int64_t flags)
+{
+    for (auto &child : data->children)
+    {
+        data->child_pointers.push_back(child.get());
+    }
+
+    schema->format = data->format.c_str();
+    schema->name = data->name.c_str();
+    schema->metadata = nullptr;
+    schema->flags = flags;
+    schema->n_children = static_cast<std::int64_t>(data->child_pointers.size());
+    schema->children = data->child_pointers.empty() ? nullptr : data->child_pointers.data();
+    schema->dictionary = data->dictionary.get();
+    schema->release = release_schema;
+    schema->private_data = data.release();
+}
+
+template <typename T>
+const void *own(exported_array &data, std::shared_ptr<std::vector<T>> buffer)
+{
+    const void *pointer = buffer->data();
+    data.owned.push_back(std::move(buffer));
+
+    return pointer;
+}
+
+std::shared_ptr<std::vector<std::uint8_t>> make_bitmap(std::size_t length)
+{
+    return std::make_shared<std::vector<std::uint8_t>>((length + 7) / 8, std::uint8_t(0));
+}
+
+void set_bit(std::vector<std::uint8_t> &bitmap, std::size_t index)
+{
+    bitmap[index / 8] = static_cast<std::uint8_t>(bitmap[index / 8] | (1u << (index % 8)));
+}
+
+// The validity bitmap of values and its null count, or no bitmap if nothing is null.
+std::pair<std::shared_ptr<std::vector<std::uint8_t>>, std::int64_t> make_validity(const column_values &values)
+{
+    auto validity = make_bitmap(values.kinds.size());
+    auto null_count = std::int64_t(0);
+
+    for (auto i = std::size_t(0); i < values.kinds.size(); ++i)
+    {
+        if (values.kinds[i] == value_kind::none)
+        {
+            ++null_count;
+        }
+        else
+        {
+            set_bit(*validity, i);
+        }
+    }
+
+    return {null_count == 0 ? nullptr : validity, null_count};
+}
+
+} // namespace
+
+namespace xlnt {
+
+void export_arrow(const worksheet &ws, const range_reference &range, bool header_row,
+    ArrowSchema *schema, ArrowArray *array)
+{
+    const auto first_column = range.top_left().column_index();
+    const auto first_row = range.top_left().row();
+    const auto last_row = range.bottom_right().row();
+    const auto first_value_row = header_row ? first_row + 1 : first_row;
+    const auto length = static_cast<std::size_t>(last_row - first_value_row + 1);
+
+    auto columns = std::vector<column_values>(range.width());
+    auto other_texts = std::vector<std::string>();
+
+    for (auto i = std::size_t(0); i < columns.size(); ++i)
+    {
+        columns[i].name = column_t(static_cast<column_t::index_t>(first_column + i)).column_string();
+        columns[i].kinds.assign(length, value_kind::none);
+        columns[i].numbers.assign(length, 0.0);
+        columns[i].texts.assign(length, 0);
+    }
+
+    ws.parallel_for_each_cell(first_row, last_row, [&](const cell &c) {
+        if (c.column_index() < first_column || c.column_index() - first_column >= columns.size())
+        {
+            return;
+        }
+
+        auto &values = columns[c.column_index() - first_column];
+
+        if (c.row() < first_value_row)
+        {
+            values.name = c.to_string();
+            return;
+        }
+
+        const auto row = static_cast<std::size_t>(c.row() - first_value_row);
+
+        switch (c.data_type())
+        {
+        case cell_type::empty:
+            break;
+        case cell_type::number:
+        case cell_type::date:
+            values.kinds[row] = value_kind::number;
+            values.numbers[row] = c.value<double>();
+            values.any_number = true;
+            break;
+        case cell_type::boolean:
+            values.kinds[row] = value_kind::boolean;
+            values.numbers[row] = c.value<bool>() ? 1.0 : 0.0;
+            values.any_boolean = true;
+            break;
+        case cell_type::shared_string:
+            values.kinds[row] = value_kind::text;
+            values.texts[row] = static_cast<std::int32_t>(c.shared_string_index());
+            values.any_text = true;
+            break;
+        case cell_type::inline_string:
+        case cell_type::formula_string:
+        case cell_type::error:
+            values.kinds[row] = value_kind::text;
+            values.texts[row] = -1 - static_cast<std::int32_t>(other_texts.size());
+            other_texts.push_back(c.value<std::string>());
+            values.any_text = true;
+            break;
+        }
+    }, 1);
+
+    // numbers and booleans in columns of text become text as well
+    for (auto &values : columns)
+    {
+        if (!values.any_text) continue;
+
+        for (auto row = std::size_t(0); row < length; ++row)
+        {
+            if (values.kinds[row] == value_kind::number || values.kinds[row] == value_kind::boolean)
+            {
+                values.texts[row] = -1 - static_cast<std::int32_t>(other_texts.size());
+                other_texts.push_back(values.kinds[row] == value_kind::boolean
+                        ? (values.numbers[row] != 0.0 ? "TRUE" : "FALSE")
+                        : detail::serialise(values.numbers[row]));
+                values.kinds[row] = value_kind::text;
+            }
+        }
+    }
+
+    // the dictionary shared by the columns of text
+    auto shared_count = std::size_t(0);
+    auto dictionary_offsets = std::shared_ptr<std::vector<std::int32_t>>();
+    auto dictionary_characters = std::shared_ptr<std::vector<char>>();
+
+    for (const auto &values : columns)
+    {
+        if (!values.any_text || dictionary_offsets) continue;
+
+        const auto &shared = ws.workbook().shared_strings();
+        shared_count = shared.size();
+        dictionary_offsets = std::make_shared<std::vector<std::int32_t>>(1, 0);
+        dictionary_characters = std::make_shared<std::vector<char>>();
+        dictionary_offsets->reserve(shared_count + other_texts.size() + 1);
+
+        auto append = [&](const std::string &text) {
+            if (dictionary_characters->size() + text.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+            {
+                throw invalid_parameter();
+            }
+
+            dictionary_characters->insert(dictionary_characters->end(), text.begin(), text.end());
+            dictionary_offsets->push_back(static_cast<std::int32_t>(dictionary_characters->size()));
+        };
+
+        for (const auto &text : shared)
+        {
+            append(text.plain_text());
+        }
+
+        for (const auto &text : other_texts)
+        {
+            append(text);
+        }
+    }
+
+    auto root_schema = std::unique_ptr<exported_schema>(new exported_schema());
+    root_schema->format = "+s";
+    auto root_array = std::unique_ptr<exported_array>(new exported_array());
+    root_array->buffers.push_back(nullptr);
+
+    for (auto &values : columns)
+    {
+        auto child_schema = std::unique_ptr<exported_schema>(new exported_schema());
+        child_schema->name = values.name;
+        auto child_array = std::unique_ptr<exported_array>(new exported_array());
+        auto validity = make_validity(values);
+        child_array->buffers.push_back(validity.first ? own(*child_array, validity.first) : nullptr);
+
+        if (values.any_text)
+        {
+            child_schema->format = "i";
+            auto indices = std::make_shared<std::vector<std::int32_t>>(length, 0);
+
+            for (auto row = std::size_t(0); row < length; ++row)
+            {
+                const auto text = values.texts[row];
+
+                if (values.kinds[row] == value_kind::text)
+                {
+                    (*indices)[row] = text >= 0 ? text : static_cast<std::int32_t>(shared_count) - 1 - text;
+                }
+            }
+
+            child_array->buffers.push_back(own(*child_array, indices));
+
+            auto dictionary_schema = std::unique_ptr<exported_schema>(new exported_schema());
+            dictionary_schema->format = "u";
+            child_schema->dictionary.reset(new ArrowSchema());
+            fill_schema(child_schema->dictionary.get(), std::move(dictionary_schema), 0);
+
+            auto dictionary_array = std::unique_ptr<exported_array>(new exported_array());
+            dictionary_array->buffers.push_back(nullptr);
+            dictionary_array->buffers.push_back(own(*dictionary_array, dictionary_offsets));
+            dictionary_array->buffers.push_back(own(*dictionary_array, dictionary_characters));
+            child_array->dictionary.reset(new ArrowArray());
+            fill_array(child_array->dictionary.get(), std::move(dictionary_array),
+                static_cast<std::int64_t>(dictionary_offsets->size() - 1), 0);
+        }
+        else if (values.any_number)
+        {
+            child_schema->format = "g";
+            auto numbers = std::make_shared<std::vector<double>>(std::move(values.numbers));
+            child_array->buffers.push_back(own(*child_array, numbers));
+        }
+        else if (values.any_boolean)
+        {
+            child_schema->format = "b";
+            auto booleans = make_bitmap(length);
+
+            for (auto row = std::size_t(0); row < length; ++row)
+            {
+                if (values.numbers[row] != 0.0)
+                {
+                    set_bit(*booleans, row);
+                }
+            }
+
+            child_array->buffers.push_back(own(*child_array, booleans));
+        }
+        else
+        {
+            // null arrays have no buffers at all
+            child_schema->format = "n";
+            child_array->buffers.clear();
+            validity.second = static_cast<std::int64_t>(length);
+        }
+
+        root_schema->children.emplace_back(new ArrowSchema());
+        fill_schema(root_schema->children.back().get(), std::move(child_schema), ARROW_FLAG_NULLABLE);
+        root_array->children.emplace_back(new ArrowArray());
+        fill_array(root_array->children.back().get(), std::move(child_array),
+            static_cast<std::int64_t>(length), validity.second);
+
+        // the cells of the column aren't needed any more
+        values = column_values();
+    }
+
+    fill_schema(schema, std::move(root_schema), 0);
+    fill_array(array, std::move(root_array), static_cast<std::int64_t>(length), 0);
+}
+
+} // namespace xlnt
@@ -26,9 +26,177 @@
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/major_order.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 
 namespace xlnt {
 
+namespace {
+
+/// <summary>
+/// Moves cursor one cell forward within bounds, continuing on the next row or column
+/// if wrap is true. If skip_null is true, it then moves on to the next stored cell
+/// using the occupancy queries of the cell store rather than probing each empty cell
+/// in between, or one past the end if there is none.
+/// </summary>
+void advance(const detail::cell_store &cells, cell_reference &cursor,
+    const range_reference &bounds, major_order order, bool skip_null, bool wrap)
+{
+    const auto first_column = bounds.top_left().column_index();
+    const auto last_column = bounds.bottom_right().column_index();
+    const auto first_row = bounds.top_left().row();
+    const auto last_row = bounds.bottom_right().row();
+
+    if (order == major_order::row)
+    {
+        if (cursor.column_index() <= last_column)
+        {
+            cursor.column_index(cursor.column_index() + 1);
+        }
+
+        if (wrap && cursor.column_index() > last_column && cursor.row() < last_row)
+        {
+            cursor.column_index(first_column);
+            cursor.row(cursor.row() + 1);
+        }
+
+        if (!skip_null) return;
+
+        while (cells.find(cursor) == nullptr && cursor.column_index() <= last_column)
+        {
+            const auto next = cells.first_in_row(cursor.row(), cursor.column_index(), last_column);
+            if (next != 0)
+            {
+                cursor.column_index(next);
+                return;
+            }
+
+            const auto next_row = wrap && cursor.row() < last_row ? cells.first_row(cursor.row() + 1, last_row) : 0;
+            cursor.column_index(next_row != 0 ? first_column : last_column + 1);
+            cursor.row(next_row != 0 ? next_row : (wrap ? last_row : cursor.row()));
+        }
+    }
+    else
+    {
+        if (cursor.row() <= last_row)
+        {
+            cursor.row(cursor.row() + 1);
+        }
+
+        if (wrap && cursor.row() > last_row && cursor.column_index() < last_column)
+        {
+            cursor.row(first_row);
+            cursor.column_index(cursor.column_index() + 1);
+        }
+
+        if (!skip_null) return;
+
+        while (cells.find(cursor) == nullptr && cursor.row() <= last_row)
+        {
+            const auto next = cells.first_in_column(cursor.column_index(), cursor.row(), last_row);
+            if (next != 0)
+            {
+                cursor.row(next);
+                return;
+            }
+
+            const auto next_column = wrap && cursor.column_index() < last_column
+                ? cells.first_column(cursor.column_index() + 1, last_column)
+                : 0;
+            cursor.row(next_column != 0 ? first_row : last_row + 1);
+            cursor.column_index(next_column != 0 ? next_column : (wrap ? last_column : cursor.column_index()));
+        }
+    }
+}
+
+/// <summary>
+/// Moves cursor one cell back within bounds, continuing on the previous row or column
+/// if wrap is true. If skip_null is true, it then moves on to the previous stored cell,
+/// or to the first cell of the bounds if there is none.
+/// </summary>
+void retreat(const detail::cell_store &cells, cell_reference &cursor,
+    const range_reference &bounds, major_order order, bool skip_null, bool wrap)
+{
+    const auto first_column = bounds.top_left().column_index();
+    const auto last_column = bounds.bottom_right().column_index();
+    const auto first_row = bounds.top_left().row();
+    const auto last_row = bounds.bottom_right().row();
+
+    if (order == major_order::row)
+    {
+        if (cursor.column_index() > first_column)
+        {
+            cursor.column_index(cursor.column_index() - 1);
+        }
+        else if (wrap && cursor.row() > first_row)
+        {
+            cursor.column_index(last_column);
+            cursor.row(cursor.row() - 1);
+        }
+
+        if (!skip_null) return;
+
+        while (cells.find(cursor) == nullptr)
+        {
+            const auto previous = cells.last_in_row(cursor.row(), first_column, cursor.column_index());
+            if (previous != 0)
+            {
+                cursor.column_index(previous);
+                return;
+            }
+
+            const auto previous_row = wrap && cursor.row() > first_row ? cells.last_row(first_row, cursor.row() - 1) : 0;
+            if (previous_row == 0)
+            {
+                cursor.column_index(first_column);
+                cursor.row(wrap ? first_row : cursor.row());
+                return;
+            }
+
+            cursor.column_index(last_column);
+            cursor.row(previous_row);
+        }
+    }
+    else
+    {
+        if (cursor.row() > first_row)
+        {
+            cursor.row(cursor.row() - 1);
+        }
+        else if (wrap && cursor.column_index() > first_column)
+        {
+            cursor.row(last_row);
+            cursor.column_index(cursor.column_index() - 1);
+        }
+
+        if (!skip_null) return;
+
+        while (cells.find(cursor) == nullptr)
+        {
+            const auto previous = cells.last_in_column(cursor.column_index(), first_row, cursor.row());
+            if (previous != 0)
+            {
+                cursor.row(previous);
+                return;
+            }
+
+            const auto previous_column = wrap && cursor.column_index() > first_column
+                ? cells.last_column(first_column, cursor.column_index() - 1)
+                : 0;
+            if (previous_column == 0)
+            {
+                cursor.row(first_row);
+                cursor.column_index(wrap ? first_column : cursor.column_index());
+                return;
+            }
+
+            cursor.row(last_row);
+            cursor.column_index(previous_column);
+        }
+    }
+}
+
+} // namespace
+
 cell_iterator::cell_iterator(worksheet ws, const cell_reference &cursor,
     const range_reference &bounds, major_order order, bool skip_null, bool wrap)
     : skip_null_(skip_null),
@@ -91,72 +259,14 @@ bool const_cell_iterator::operator!=(const const_cell_iterator &other) const
 
 cell_iterator &cell_iterator::operator--()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() > bounds_.top_left().column())
-        {
-            cursor_.column_index(cursor_.column_index() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() > bounds_.top_left().row())
-        {
-            cursor_.row(cursor_.row() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
-    }
+    retreat(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
 
 const_cell_iterator &const_cell_iterator::operator--()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() > bounds_.top_left().column())
-        {
-            cursor_.column_index(cursor_.column_index() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() > bounds_.top_left().row())
-        {
-            cursor_.row(cursor_.row() - 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
-    }
+    retreat(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
@@ -179,72 +289,14 @@ const_cell_iterator const_cell_iterator::operator--(int)
 
 cell_iterator &cell_iterator::operator++()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() <= bounds_.bottom_right().column())
-        {
-            cursor_.column_index(cursor_.column_index() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() <= bounds_.bottom_right().row())
-        {
-            cursor_.row(cursor_.row() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
-    }
+    advance(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
 
 const_cell_iterator &const_cell_iterator::operator++()
 {
-    if (order_ == major_order::row)
-    {
-        if (cursor_.column() <= bounds_.bottom_right().column())
-        {
-            cursor_.column_index(cursor_.column_index() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
-    }
-    else
-    {
-        if (cursor_.row() <= bounds_.bottom_right().row())
-        {
-            cursor_.row(cursor_.row() + 1);
-        }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
-    }
+    advance(ws_.d_->cell_map_, cursor_, bounds_, order_, skip_null_, wrap_);
 
     return *this;
 }
@@ -46,7 +46,8 @@ cell_vector::iterator cell_vector::begin()
 
 cell_vector::iterator cell_vector::end()
 {
-    auto past_end = cursor_;
+    // a wrapping vector ends after the bottom right cell of its bounds
+    auto past_end = wrap_ ? bounds_.bottom_right() : cursor_;
 
     if (order_ == major_order::row)
     {
@@ -67,7 +68,8 @@ cell_vector::const_iterator cell_vector::cbegin() const
 
 cell_vector::const_iterator cell_vector::cend() const
 {
-    auto past_end = cursor_;
+    // a wrapping vector ends after the bottom right cell of its bounds
+    auto past_end = wrap_ ? bounds_.bottom_right() : cursor_;
 
     if (order_ == major_order::row)
     {
@@ -22,15 +22,167 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/comment.hpp>
+#include <xlnt/styles/format.hpp>
 #include <xlnt/styles/style.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
+#include <detail/utils/parallel_for.hpp>
+
+namespace {
+
+// Calls function with every reference in reference and its offset in major order.
+template <typename Function>
+void for_each_reference(const xlnt::range_reference &reference, xlnt::major_order order, Function function)
+{
+    const auto left = reference.top_left().column_index();
+    const auto top = reference.top_left().row();
+    const auto width = static_cast<xlnt::column_t::index_t>(reference.width());
+    const auto height = static_cast<xlnt::row_t>(reference.height());
+    auto offset = std::size_t(0);
+
+    if (order == xlnt::major_order::row)
+    {
+        for (auto row = top; row < top + height; ++row)
+        {
+            for (auto column = left; column < left + width; ++column)
+            {
+                function(xlnt::cell_reference(column, row), offset++);
+            }
+        }
+    }
+    else
+    {
+        for (auto column = left; column < left + width; ++column)
+        {
+            for (auto row = top; row < top + height; ++row)
+            {
+                function(xlnt::cell_reference(column, row), offset++);
+            }
+        }
+    }
+}
+
+// Returns true if a and b have any cell in common.
+bool overlaps(const xlnt::range_reference &a, const xlnt::range_reference &b)
+{
+    return a.top_left().row() <= b.bottom_right().row() && b.top_left().row() <= a.bottom_right().row()
+        && a.top_left().column_index() <= b.bottom_right().column_index()
+        && b.top_left().column_index() <= a.bottom_right().column_index();
+}
+
+// The value of a row in one key column of range::sort, where kind orders the types of
+// values and rank orders values of the same type. Strings and errors are ranked by their
+// text beforehand so that rows are compared without looking at the text again.
+struct sort_key
+{
+    enum kind_t : unsigned char
+    {
+        number,
+        string,
+        boolean,
+        error,
+        empty
+    };
+
+    kind_t kind = empty;
+    double rank = 0.0;
+};
+
+// Returns true if a comes before b, comparing the bytes of ASCII letters without their case.
+bool before_ignoring_case(const std::string &a, const std::string &b)
+{
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) < std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+// Sorts items stably with compare, sorting parts of them on up to threads threads and
+// merging the sorted parts afterwards.
+template <typename Compare>
+void parallel_stable_sort(std::vector<std::size_t> &items, Compare compare, std::size_t threads)
+{
+    // a thread isn't worth starting for fewer items than this
+    const std::size_t minimum_part = 4096;
+    const auto count = items.size();
+    const auto parts = std::max(std::size_t(1), std::min(threads, count / minimum_part));
+    const auto part = (count + parts - 1) / std::max(std::size_t(1), parts);
+
+    if (parts <= 1)
+    {
+        std::stable_sort(items.begin(), items.end(), compare);
+        return;
+    }
+
+    xlnt::detail::parallel_for((count + part - 1) / part, parts, [&items, &compare, part, count](std::size_t i) {
+        std::stable_sort(items.begin() + static_cast<std::ptrdiff_t>(i * part),
+            items.begin() + static_cast<std::ptrdiff_t>(std::min((i + 1) * part, count)), compare);
+    });
+
+    for (auto width = part; width < count; width *= 2)
+    {
+        for (std::size_t first = 0; first + width < count; first += 2 * width)
+        {
+            std::inplace_merge(items.begin() + static_cast<std::ptrdiff_t>(first),
+                items.begin() + static_cast<std::ptrdiff_t>(first + width),
+                items.begin() + static_cast<std::ptrdiff_t>(std::min(first + 2 * width, count)), compare);
+        }
+    }
+}
+
+} // namespace
 
 namespace xlnt {
+namespace detail {
+
+struct numeric_summary
+{
+    void add(const cell_impl &impl)
+    {
+        if (impl.type_ == cell::type::number || impl.type_ == cell::type::date)
+        {
+            const auto value = impl.value_number();
+            min = count == 0 ? value : std::min(min, value);
+            max = count == 0 ? value : std::max(max, value);
+            sum += value;
+            ++count;
+        }
+    }
+
+    void add(const numeric_summary &other)
+    {
+        if (other.count != 0)
+        {
+            min = count == 0 ? other.min : std::min(min, other.min);
+            max = count == 0 ? other.max : std::max(max, other.max);
+            sum += other.sum;
+            count += other.count;
+        }
+    }
+
+    std::size_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+} // namespace detail
 
 range::range(class worksheet ws, const range_reference &reference, major_order order, bool skip_null)
     : ws_(ws),
@@ -138,45 +290,75 @@ bool range::contains(const cell_reference &cell_ref)
     return ref_.contains(cell_ref);
 }
 
+range range::format(const xlnt::format &new_format)
+{
+    restyle([&new_format](class cell c) {
+        c.format(new_format);
+        return new_format;
+    });
+    return *this;
+}
+
 range range::alignment(const xlnt::alignment &new_alignment)
 {
-    apply([&new_alignment](class cell c) { c.alignment(new_alignment); });
+    restyle([&new_alignment](class cell c) {
+        c.alignment(new_alignment);
+        return c.format();
+    });
     return *this;
 }
 
 range range::border(const xlnt::border &new_border)
 {
-    apply([&new_border](class cell c) { c.border(new_border); });
+    restyle([&new_border](class cell c) {
+        c.border(new_border);
+        return c.format();
+    });
     return *this;
 }
 
 range range::fill(const xlnt::fill &new_fill)
 {
-    apply([&new_fill](class cell c) { c.fill(new_fill); });
+    restyle([&new_fill](class cell c) {
+        c.fill(new_fill);
+        return c.format();
+    });
     return *this;
 }
 
 range range::font(const xlnt::font &new_font)
 {
-    apply([&new_font](class cell c) { c.font(new_font); });
+    restyle([&new_font](class cell c) {
+        c.font(new_font);
+        return c.format();
+    });
     return *this;
 }
 
 range range::number_format(const xlnt::number_format &new_number_format)
 {
-    apply([&new_number_format](class cell c) { c.number_format(new_number_format); });
+    restyle([&new_number_format](class cell c) {
+        c.number_format(new_number_format);
+        return c.format();
+    });
     return *this;
 }
 
 range range::protection(const xlnt::protection &new_protection)
 {
-    apply([&new_protection](class cell c) { c.protection(new_protection); });
+    restyle([&new_protection](class cell c) {
+        c.protection(new_protection);
+        return c.format();
+    });
     return *this;
 }
 
 range range::style(const class style &new_style)
 {
-    apply([&new_style](class cell c) { c.style(new_style); });
+    restyle([&new_style](class cell c) {
+        c.style(new_style);
+        return c.format();
+    });
     return *this;
 }
 
@@ -190,6 +372,444 @@ conditional_format range::conditional_format(const condition &when)
     return ws_.conditional_format(ref_, when);
 }
 
+void range::restyle(const std::function<xlnt::format(class cell)> &restyle_first)
+{
+    // the format given to the first cell with each format, nullptr standing for no format
+    std::unordered_map<detail::format_impl *, detail::format_impl *> targets;
+    // the number of further cells moved off each format
+    std::unordered_map<detail::format_impl *, std::size_t> moved;
+
+    for (auto row : *this)
+    {
+        for (auto cell : row)
+        {
+            auto &current = cell.d_->format_;
+            const auto source = current.is_set() ? current.get() : nullptr;
+            const auto target = targets.find(source);
+
+            if (target == targets.end())
+            {
+                targets.emplace(source, restyle_first(cell).d_);
+                continue;
+            }
+
+            current = target->second;
+            ++target->second->references;
+
+            if (source != nullptr)
+            {
+                ++moved[source];
+            }
+        }
+    }
+
+    for (const auto &source_count : moved)
+    {
+        auto &source = *source_count.first;
+        source.references -= std::min(source.references, source_count.second);
+
+        if (source.references == 0)
+        {
+            // collected with the next garbage, which would invalidate the remaining sources now
+            source.parent->garbage_pending = true;
+        }
+    }
+}
+
+template <typename Function>
+void range::for_each_stored(Function function) const
+{
+    const auto &cells = ws_.d_->cell_map_;
+    const auto left = ref_.top_left().column_index();
+    const auto top = ref_.top_left().row();
+    const auto right = ref_.bottom_right().column_index();
+    const auto bottom = ref_.bottom_right().row();
+    const auto width = ref_.width();
+    const auto height = ref_.height();
+    const auto order = order_;
+
+    auto offset = [=](column_t::index_t column, row_t row) {
+        return order == major_order::row
+            ? (row - top) * width + (column - left)
+            : (column - left) * height + (row - top);
+    };
+
+    if (width * height <= cells.size())
+    {
+        for_each_reference(ref_, order_, [&cells, &function](const cell_reference &reference, std::size_t position) {
+            const auto impl = cells.find(reference);
+
+            if (impl != nullptr)
+            {
+                function(*impl, position);
+            }
+        });
+
+        return;
+    }
+
+    cells.for_each([&](const detail::cell_impl &impl) {
+        const auto column = impl.column_.index;
+
+        if (column >= left && column <= right && impl.row_ >= top && impl.row_ <= bottom)
+        {
+            function(impl, offset(column, impl.row_));
+        }
+    });
+}
+
+detail::numeric_summary range::summarize(std::size_t threads) const
+{
+    auto &cells = ws_.d_->cell_map_;
+    auto summary = detail::numeric_summary();
+
+    if (threads <= 1 || ref_.width() * ref_.height() <= cells.size())
+    {
+        for_each_stored([&summary](const detail::cell_impl &impl, std::size_t) {
+            summary.add(impl);
+        });
+
+        return summary;
+    }
+
+    const auto left = ref_.top_left().column_index();
+    const auto right = ref_.bottom_right().column_index();
+    const auto parts = cells.parts(ref_.top_left().row(), ref_.bottom_right().row(), threads);
+    auto part_summaries = std::vector<detail::numeric_summary>(parts.size());
+
+    // the parts are summed in row order whichever thread finished first so that the
+    // result only depends on the number of threads
+    detail::parallel_for(parts.size(), threads, [&cells, &parts, &part_summaries, left, right](std::size_t index) {
+        auto &part_summary = part_summaries[index];
+
+        cells.for_each_in(parts[index], [&part_summary, left, right](const detail::cell_impl &impl) {
+            if (impl.column_.index >= left && impl.column_.index <= right)
+            {
+                part_summary.add(impl);
+            }
+        });
+    });
+
+    for (const auto &part_summary : part_summaries)
+    {
+        summary.add(part_summary);
+    }
+
+    return summary;
+}
+
+double range::sum(std::size_t threads) const
+{
+    return summarize(threads).sum;
+}
+
+double range::min(std::size_t threads) const
+{
+    return summarize(threads).min;
+}
+
+double range::max(std::size_t threads) const
+{
+    return summarize(threads).max;
+}
+
+std::size_t range::count_numeric(std::size_t threads) const
+{
+    return summarize(threads).count;
+}
+
+double range::mean(std::size_t threads) const
+{
+    const auto summary = summarize(threads);
+
+    return summary.count == 0
+        ? std::numeric_limits<double>::quiet_NaN()
+        : summary.sum / static_cast<double>(summary.count);
+}
+
+void range::values(std::vector<double> &values, double fill_value) const
+{
+    values.assign(ref_.width() * ref_.height(), fill_value);
+
+    for_each_stored([&values](const detail::cell_impl &impl, std::size_t offset) {
+        if (impl.type_ == cell::type::number || impl.type_ == cell::type::date
+            || impl.type_ == cell::type::boolean)
+        {
+            values[offset] = impl.value_number();
+        }
+    });
+}
+
+void range::strings(std::vector<std::string> &strings, const std::string &fill_value) const
+{
+    strings.assign(ref_.width() * ref_.height(), fill_value);
+    auto wb = ws_.workbook();
+
+    for_each_stored([&strings, &wb](const detail::cell_impl &impl, std::size_t offset) {
+        switch (impl.type_)
+        {
+        case cell::type::shared_string:
+            strings[offset] = detail::shared_string_loader::plain_text(wb, static_cast<std::size_t>(impl.value_numeric_));
+            break;
+        case cell::type::inline_string:
+        case cell::type::formula_string:
+        case cell::type::error:
+            strings[offset] = impl.value_text().plain_text();
+            break;
+        default:
+            break;
+        }
+    });
+}
+
+void range::assign(const std::vector<double> &values)
+{
+    if (values.size() != ref_.width() * ref_.height())
+    {
+        throw invalid_parameter("expected one value per cell");
+    }
+
+    for_each_reference(ref_, order_, [this, &values](const cell_reference &reference, std::size_t offset) {
+        ws_.cell(reference).value(values[offset]);
+    });
+}
+
+void range::assign(const std::vector<std::string> &strings)
+{
+    if (strings.size() != ref_.width() * ref_.height())
+    {
+        throw invalid_parameter("expected one string per cell");
+    }
+
+    for_each_reference(ref_, order_, [this, &strings](const cell_reference &reference, std::size_t offset) {
+        ws_.cell(reference).value(strings[offset]);
+    });
+}
+
+void range::sort(const std::vector<column_t> &key_columns, bool ascending, std::size_t threads)
+{
+    auto &sheet = *ws_.d_;
+    auto &cells = sheet.cell_map_;
+    const auto top = ref_.top_left().row();
+    const auto left = ref_.top_left().column();
+    const auto right = ref_.bottom_right().column();
+    const auto height = static_cast<std::size_t>(ref_.height());
+
+    for (const auto &column : key_columns)
+    {
+        if (column < left || column > right)
+        {
+            throw invalid_parameter("key column outside of the range");
+        }
+    }
+
+    for (const auto &merged : sheet.merged_cells_.ranges())
+    {
+        if (overlaps(merged, ref_))
+        {
+            throw invalid_parameter("can't sort a range overlapping merged cells");
+        }
+    }
+
+    for (const auto &group : sheet.formula_groups_)
+    {
+        if (group.array && overlaps(group.range, ref_))
+        {
+            throw invalid_parameter("can't sort a range overlapping an array formula");
+        }
+    }
+
+    if (cells.frozen())
+    {
+        throw unsupported("sorting the cells of a frozen worksheet");
+    }
+
+    // the keys of each row, and the texts of its strings and errors to rank them by
+    auto wb = ws_.workbook();
+    std::vector<sort_key> keys(height * key_columns.size());
+    std::vector<std::string> texts;
+    std::unordered_map<std::size_t, std::size_t> shared_texts;
+
+    for (std::size_t row = 0; row < height; ++row)
+    {
+        for (std::size_t k = 0; k < key_columns.size(); ++k)
+        {
+            const auto impl = cells.find(cell_reference(key_columns[k], top + static_cast<row_t>(row)));
+            auto &key = keys[row * key_columns.size() + k];
+
+            if (impl == nullptr)
+            {
+                continue;
+            }
+
+            switch (impl->type_)
+            {
+            case cell::type::number:
+            case cell::type::date:
+                key.kind = sort_key::number;
+                key.rank = impl->value_number();
+                break;
+            case cell::type::boolean:
+                key.kind = sort_key::boolean;
+                key.rank = impl->value_number();
+                break;
+            case cell::type::shared_string: {
+                const auto index = static_cast<std::size_t>(impl->value_number());
+                auto text = shared_texts.find(index);
+
+                if (text == shared_texts.end())
+                {
+                    text = shared_texts.emplace(index, texts.size()).first;
+                    texts.push_back(detail::shared_string_loader::plain_text(wb, index));
+                }
+
+                key.kind = sort_key::string;
+                key.rank = static_cast<double>(text->second);
+                break;
+            }
+            case cell::type::inline_string:
+            case cell::type::formula_string:
+            case cell::type::error:
+                key.kind = impl->type_ == cell::type::error ? sort_key::error : sort_key::string;
+                key.rank = static_cast<double>(texts.size());
+                texts.push_back(impl->value_text().plain_text());
+                break;
+            case cell::type::empty:
+                break;
+            }
+        }
+    }
+
+    // replaces the position of each text by its rank, which equal texts share
+    std::vector<std::size_t> by_text(texts.size());
+    std::iota(by_text.begin(), by_text.end(), std::size_t(0));
+    std::sort(by_text.begin(), by_text.end(),
+        [&texts](std::size_t a, std::size_t b) { return before_ignoring_case(texts[a], texts[b]); });
+    std::vector<double> ranks(texts.size());
+
+    for (std::size_t i = 0; i < by_text.size(); ++i)
+    {
+        const auto tied = i > 0 && !before_ignoring_case(texts[by_text[i - 1]], texts[by_text[i]]);
+        ranks[by_text[i]] = tied ? ranks[by_text[i - 1]] : static_cast<double>(i);
+    }
+
+    for (auto &key : keys)
+    {
+        if (key.kind == sort_key::string || key.kind == sort_key::error)
+        {
+            key.rank = ranks[static_cast<std::size_t>(key.rank)];
+        }
+    }
+
+    const auto key_count = key_columns.size();
+    std::vector<std::size_t> order(height);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+
+    parallel_stable_sort(order, [&keys, key_count, ascending](std::size_t a, std::size_t b) {
+        for (std::size_t k = 0; k < key_count; ++k)
+        {
+            const auto &first = keys[a * key_count + k];
+            const auto &second = keys[b * key_count + k];
+
+            // empty keys come last either way
+            if (first.kind == sort_key::empty || second.kind == sort_key::empty)
+            {
+                if (first.kind == second.kind) continue;
+                return second.kind == sort_key::empty;
+            }
+
+            if (first.kind != second.kind)
+            {
+                return ascending ? first.kind < second.kind : first.kind > second.kind;
+            }
+
+            if (first.rank != second.rank)
+            {
+                return ascending ? first.rank < second.rank : first.rank > second.rank;
+            }
+        }
+
+        return false;
+    }, threads);
+
+    std::vector<std::size_t> target(height);
+    auto moved = false;
+
+    for (std::size_t i = 0; i < height; ++i)
+    {
+        target[order[i]] = i;
+        moved = moved || order[i] != i;
+    }
+
+    if (!moved)
+    {
+        return;
+    }
+
+    // takes the cells out of the range, with the comments which belong to them
+    std::vector<cell_reference> stored;
+    for_each_stored([&stored](const detail::cell_impl &impl, std::size_t) {
+        stored.emplace_back(impl.column_, impl.row_);
+    });
+
+    std::vector<std::pair<cell_reference, detail::cell_impl>> taken;
+    std::vector<std::pair<cell_reference, comment>> comments;
+    std::unordered_set<std::uint32_t> groups;
+    taken.reserve(stored.size());
+
+    for (const auto &reference : stored)
+    {
+        auto impl = cells.find(reference);
+
+        if (impl->comment().is_set())
+        {
+            auto stored_comment = sheet.comments_.find(reference);
+            comments.emplace_back(reference, std::move(stored_comment->second));
+            sheet.comments_.erase(stored_comment);
+        }
+
+        if (impl->formula_group_ != 0)
+        {
+            groups.insert(impl->formula_group_);
+        }
+
+        taken.emplace_back(reference, std::move(*impl));
+        cells.erase(reference);
+    }
+
+    // the cells of a shared formula are moved apart, so each is given the formula's text
+    auto detach = [&groups, &sheet](detail::cell_impl &impl) {
+        if (impl.formula_group_ != 0 && groups.count(impl.formula_group_) != 0)
+        {
+            const auto text = sheet.formula_groups_[impl.formula_group_ - 1].text;
+            impl.formula_group_ = 0;
+            impl.extension().formula_ = text;
+        }
+    };
+
+    if (!groups.empty())
+    {
+        cells.for_each(detach);
+    }
+
+    for (auto &cell : taken)
+    {
+        const auto row = top + static_cast<row_t>(target[cell.first.row() - top]);
+        detach(cell.second);
+        cell.second.row_ = row;
+        cells.emplace(cell_reference(cell.first.column(), row), std::move(cell.second));
+    }
+
+    for (auto &cell_comment : comments)
+    {
+        const auto reference = cell_reference(cell_comment.first.column(),
+            top + static_cast<row_t>(target[cell_comment.first.row() - top]));
+        auto &moved_comment = sheet.comments_[reference];
+        moved_comment = std::move(cell_comment.second);
+        cells.find(reference)->extension().comment_ = &moved_comment;
+    }
+}
+
 void range::apply(std::function<void(class cell)> f)
 {
     for (auto row : *this)
@@ -22,73 +22,75 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
 #include <xlnt/worksheet/range_reference.hpp>
 
 #include <detail/constants.hpp>
 #include <xlnt/utils/exceptions.hpp>
-#include <detail/serialization/parsers.hpp>
+#include <detail/utils/reference_decoding.hpp>
 
 namespace {
 
-bool is_whole_column(const std::string &s)
+// Returns true if [begin, end) is a column like "C" or "$C" without a row.
+bool is_whole_column(const char *begin, const char *end)
 {
-    if (s.empty())
-    {
-        return false;
-    }
+    if (begin != end && *begin == '$') ++begin;
+    xlnt::column_t::index_t column = 0;
 
-    size_t start_pos = (s[0] == '$') ? 1 : 0;
-    if (start_pos >= s.length()) // String contains only a "$"
-    {
-        return false;
-    }
+    return begin != end && xlnt::detail::decode_column_letters(begin, end, column) == end;
+}
 
-    for (size_t i = start_pos; i < s.length(); ++i)
-    {
-        if (!std::isalpha(static_cast<unsigned char>(s[i])))
-        {
-            return false;
-        }
-    }
+// Returns true if [begin, end) is a row like "5" or "$5" without a column.
+bool is_whole_row(const char *begin, const char *end)
+{
+    if (begin != end && *begin == '$') ++begin;
+    std::uint64_t row = 0;
 
-    return true;
+    return begin != end && xlnt::detail::decode_row_digits(begin, end, row) == end;
 }
 
-bool is_whole_row(const std::string &s)
+// Skips the "$" at begin, if there is one, and returns true if there was.
+bool extract_absolute(const char *&begin)
 {
-    if (s.empty())
-    {
-        return false;
-    }
+    const auto absolute = *begin == '$';
+    if (absolute) ++begin;
 
-    size_t start_pos = (s[0] == '$') ? 1 : 0;
-    if (start_pos >= s.length()) // String contains only a "$"
-    {
-        return false;
-    }
+    return absolute;
+}
 
-    for (size_t i = start_pos; i < s.length(); ++i)
+xlnt::column_t::index_t decode_whole_column(const char *begin, const char *end)
+{
+    xlnt::column_t::index_t column = 0;
+    xlnt::detail::decode_column_letters(begin, end, column);
+
+    // more than three letters, which column_t rejects
+    if (column == 0)
     {
-        if (!std::isdigit(static_cast<unsigned char>(s[i])))
-        {
-            return false;
-        }
+        throw xlnt::invalid_column_index();
     }
 
-    return true;
+    return column;
 }
 
-bool extract_absolute (std::string& part)
+xlnt::row_t decode_whole_row(const char *begin, const char *end)
 {
-    bool absolute = part[0] == '$';
-    if (absolute)
+    std::uint64_t row = 0;
+    xlnt::detail::decode_row_digits(begin, end, row);
+
+    if (row > std::numeric_limits<xlnt::row_t>::max())
     {
-        part.erase(0, 1);
+        throw xlnt::invalid_cell_reference(std::string(begin, end));
     }
-    return absolute;
-}
+
+    return static_cast<xlnt::row_t>(row);
 }
 
+} // namespace
+
 namespace xlnt {
 
 range_reference range_reference::make_absolute(const xlnt::range_reference &relative)
@@ -102,64 +104,57 @@ range_reference range_reference::make_absolute(const xlnt::range_reference &rela
 }
 
 range_reference::range_reference()
-    : range_reference("A1")
+    : range_reference(cell_reference(), cell_reference())
 {
 }
 
 range_reference::range_reference(const char *range_string)
-    : range_reference(std::string(range_string))
+    : range_reference(from_chars(range_string, range_string + std::strlen(range_string)))
 {
 }
 
 range_reference::range_reference(const std::string &range_string)
+    : range_reference(from_chars(range_string.data(), range_string.data() + range_string.size()))
 {
-    auto colon_index = range_string.find(':');
+}
 
-    if (colon_index == std::string::npos)
+range_reference range_reference::from_chars(const char *begin, const char *end)
+{
+    const auto colon = std::find(begin, end, ':');
+
+    if (colon == end)
     {
         // Single cell reference, e.g., "A1"
-        top_left_ = cell_reference(range_string);
-        bottom_right_ = top_left_;
-        return;
+        const auto cell = cell_reference::from_chars(begin, end);
+        return range_reference(cell, cell);
     }
 
-    std::string start_part = range_string.substr(0, colon_index);
-    std::string end_part = range_string.substr(colon_index + 1);
+    auto start = begin;
+    auto finish = colon + 1;
 
-    if (is_whole_column(start_part) && is_whole_column(end_part))
+    if (is_whole_column(start, colon) && is_whole_column(finish, end))
     {
         // Whole column reference, e.g., "A:C"
-        bool absoluteStart = extract_absolute(start_part);
-        bool absoluteEnd = extract_absolute(end_part);
+        const auto absolute_start = extract_absolute(start);
+        const auto absolute_end = extract_absolute(finish);
 
-        top_left_ = cell_reference(start_part, 1).make_absolute(absoluteStart, true);
-        bottom_right_ = cell_reference(end_part, constants::max_row()).make_absolute(absoluteEnd, true);
+        return range_reference(
+            cell_reference(decode_whole_column(start, colon), 1).make_absolute(absolute_start, true),
+            cell_reference(decode_whole_column(finish, end), constants::max_row()).make_absolute(absolute_end, true));
     }
-    else if (is_whole_row(start_part) && is_whole_row(end_part))
+
+    if (is_whole_row(start, colon) && is_whole_row(finish, end))
     {
         // Whole row reference, e.g., "1:5"
-        bool absoluteStart = extract_absolute(start_part);
-        bool absoluteEnd = extract_absolute(end_part);
-
-        row_t start_row;
-        if (detail::parse(start_part, start_row) != std::errc())
-        {
-            throw xlnt::invalid_cell_reference(start_part);
-        }
-        row_t end_row;
-        if (detail::parse(end_part, end_row) != std::errc())
-        {
-            throw xlnt::invalid_cell_reference(end_part);
-        }
-
-        top_left_ = cell_reference(constants::min_column(), start_row).make_absolute(true, absoluteStart);
-        bottom_right_ = cell_reference(constants::max_column(), end_row).make_absolute(true, absoluteEnd);
-    }
-    else
-    {
-        top_left_ = cell_reference(start_part);
-        bottom_right_ = cell_reference(end_part);
+        const auto absolute_start = extract_absolute(start);
+        const auto absolute_end = extract_absolute(finish);
+
+        return range_reference(
+            cell_reference(constants::min_column(), decode_whole_row(start, colon)).make_absolute(true, absolute_start),
+            cell_reference(constants::max_column(), decode_whole_row(finish, end)).make_absolute(true, absolute_end));
     }
+
+    return range_reference(cell_reference::from_chars(begin, colon), cell_reference::from_chars(colon + 1, end));
 }
 
 range_reference::range_reference(const cell_reference &top_left,
@@ -215,10 +210,21 @@ bool range_reference::whole_column() const
 
 std::string range_reference::to_string() const
 {
-    if (is_single_cell())
-        return top_left().to_string();
-    else
-        return top_left_.to_string() + ":" + bottom_right_.to_string();
+    char characters[max_string_length];
+    return std::string(characters, to_chars(characters));
+}
+
+char *range_reference::to_chars(char *buffer) const
+{
+    buffer = top_left_.to_chars(buffer);
+
+    if (!is_single_cell())
+    {
+        *buffer++ = ':';
+        buffer = bottom_right_.to_chars(buffer);
+    }
+
+    return buffer;
 }
 
 bool range_reference::operator==(const range_reference &comparand) const
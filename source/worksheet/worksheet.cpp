@@ -24,33 +24,62 @@
 // @author: see AUTHORS file
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
 #include <cmath>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/comment.hpp>
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/cell/index_types.hpp>
+#include <xlnt/cell/rich_text.hpp>
+#include <xlnt/packaging/manifest.hpp>
 #include <xlnt/packaging/relationship.hpp>
 #include <xlnt/utils/date.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/executor.hpp>
+#include <xlnt/utils/hash_combine.hpp>
 #include <xlnt/utils/numeric.hpp>
+#include <xlnt/workbook/memory_usage.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/string_storage.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/worksheet_iterator.hpp>
+#include <xlnt/worksheet/auto_fit_options.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/csv_options.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/worksheet/row_properties.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
+#include <xlnt/worksheet/worksheet_diff.hpp>
 #include <detail/constants.hpp>
 #include <detail/default_case.hpp>
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/format_store.hpp>
+#include <detail/implementations/hyperlink_impl.hpp>
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
+#include <detail/number_format/number_formatter.hpp>
+#include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/shared_string_loader.hpp>
 #include <detail/unicode.hpp>
+#include <detail/utils/heap_size.hpp>
+#include <detail/utils/parallel_for.hpp>
+#include <detail/utils/text_width.hpp>
 
 namespace {
 
@@ -59,6 +88,731 @@ int points_to_pixels(double points, double dpi)
     return static_cast<int>(std::ceil(points * dpi / 72));
 }
 
+// Returns a cell of ws at column and row, creating it if it doesn't exist.
+xlnt::detail::cell_impl &emplace_cell(xlnt::detail::worksheet_impl &ws, xlnt::column_t::index_t column, xlnt::row_t row)
+{
+    auto impl = xlnt::detail::cell_impl();
+    impl.parent_ = &ws;
+    impl.column_ = column;
+    impl.row_ = row;
+
+    return *ws.cell_map_.emplace(xlnt::cell_reference(column, row), std::move(impl)).first;
+}
+
+// Returns a cell of ws at column and row as emplace_cell does, throwing invalid_cell_reference
+// if row is past the last row of a worksheet.
+xlnt::detail::cell_impl &emplace_appended_cell(xlnt::detail::worksheet_impl &ws, xlnt::column_t::index_t column, xlnt::row_t row)
+{
+    if (row > xlnt::constants::max_row())
+    {
+        throw xlnt::invalid_cell_reference(column, row);
+    }
+
+    return emplace_cell(ws, column, row);
+}
+
+// Calls assign with the cell and the value for each value of columns, see worksheet::write_block.
+// The cells are visited row by row, which is the order the dense cell store keeps them in.
+template <typename T, typename Assign>
+void assign_block(xlnt::detail::worksheet_impl &ws, const xlnt::cell_reference &top_left,
+    const std::vector<std::vector<T>> &columns, Assign &assign)
+{
+    std::size_t height = 0;
+    std::size_t count = 0;
+
+    for (const auto &column : columns)
+    {
+        height = std::max(height, column.size());
+        count += column.size();
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto first_column = top_left.column_index();
+    const auto first_row = top_left.row();
+
+    if (columns.size() - 1 > xlnt::constants::max_column().index - first_column
+        || height - 1 > xlnt::constants::max_row() - first_row)
+    {
+        throw xlnt::invalid_cell_reference(top_left.to_string());
+    }
+
+    ws.cell_map_.reserve(ws.cell_map_.size() + count, first_column - 1 + columns.size());
+
+    for (std::size_t j = 0; j < height; ++j)
+    {
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            if (j < columns[i].size())
+            {
+                assign(emplace_cell(ws, static_cast<xlnt::column_t::index_t>(first_column + i),
+                           static_cast<xlnt::row_t>(first_row + j)),
+                    columns[i][j]);
+            }
+        }
+    }
+}
+
+// Calls assign with the cell and the value for each of values in the row below the last
+// cell of ws, see worksheet::append_row, and returns the row.
+template <typename T, typename Assign>
+xlnt::row_t assign_row(xlnt::detail::worksheet_impl &ws, const std::vector<T> &values, Assign &assign)
+{
+    auto row = ws.cell_map_.bounds().max_row;
+
+    if (row == xlnt::constants::max_row())
+    {
+        throw xlnt::invalid_cell_reference(1, row);
+    }
+
+    ++row;
+
+    if (!values.empty())
+    {
+        ws.cell_map_.reserve(ws.cell_map_.size() + values.size(), values.size());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            assign(emplace_cell(ws, static_cast<xlnt::column_t::index_t>(i + 1), row), values[i]);
+        }
+    }
+
+    return row;
+}
+
+void assign_number(xlnt::detail::cell_impl &cell, double value)
+{
+    cell.type_ = xlnt::cell_type::number;
+    cell.value_number(value);
+}
+
+void assign_boolean(xlnt::detail::cell_impl &cell, bool value)
+{
+    cell.type_ = xlnt::cell_type::boolean;
+    cell.value_number(value ? 1.0 : 0.0);
+}
+
+// Sets cells to strings as the string storage of the workbook says. Each distinct string is
+// checked and added to the shared string table once. check is called with the cell and the
+// string the first time a string is seen and returns the string to store, as cell::check_string does.
+template <typename Check>
+class string_assigner
+{
+public:
+    string_assigner(xlnt::workbook wb, Check check)
+        : workbook_(wb),
+          check_(check),
+          inline_(wb.string_storage() == xlnt::string_storage::inline_string)
+    {
+    }
+
+    void operator()(xlnt::detail::cell_impl &cell, const std::string &value)
+    {
+        if (inline_)
+        {
+            cell.extension().value_text_ = xlnt::rich_text(check_(cell, value));
+            cell.type_ = xlnt::cell_type::inline_string;
+            return;
+        }
+
+        auto match = indices_.find(value);
+
+        if (match == indices_.end())
+        {
+            const auto index = workbook_.add_shared_string(xlnt::rich_text(check_(cell, value)));
+            match = indices_.emplace(value, static_cast<double>(index)).first;
+        }
+
+        cell.type_ = xlnt::cell_type::shared_string;
+        cell.value_number(match->second);
+    }
+
+private:
+    xlnt::workbook workbook_;
+    Check check_;
+    bool inline_;
+    std::unordered_map<std::string, double> indices_;
+};
+
+template <typename Check>
+string_assigner<Check> make_string_assigner(xlnt::workbook wb, Check check)
+{
+    return string_assigner<Check>(wb, check);
+}
+
+/// <summary>
+/// Collects the text of a CSV export in a buffer which is written to the destination
+/// in large pieces.
+/// </summary>
+class csv_sink
+{
+public:
+    csv_sink(std::ostream &destination, const xlnt::csv_options &options)
+        : destination_(destination), options_(options)
+    {
+        buffer_.reserve(buffer_size + 1024);
+        needs_quotes_.fill(false);
+        needs_quotes_[static_cast<unsigned char>(options.delimiter)] = true;
+        needs_quotes_[static_cast<unsigned char>(options.quote)] = true;
+        needs_quotes_['\r'] = true;
+        needs_quotes_['\n'] = true;
+    }
+
+    void delimiter()
+    {
+        buffer_.push_back(options_.delimiter);
+    }
+
+    void empty_field()
+    {
+        if (options_.quote_all)
+        {
+            buffer_.push_back(options_.quote);
+            buffer_.push_back(options_.quote);
+        }
+    }
+
+    void field(const char *text, std::size_t size)
+    {
+        std::size_t special = 0;
+
+        while (special < size && !needs_quotes_[static_cast<unsigned char>(text[special])])
+        {
+            ++special;
+        }
+
+        if (special == size && !options_.quote_all)
+        {
+            buffer_.append(text, size);
+            return;
+        }
+
+        buffer_.push_back(options_.quote);
+        buffer_.append(text, special);
+
+        for (auto i = special; i < size; ++i)
+        {
+            if (text[i] == options_.quote)
+            {
+                buffer_.push_back(options_.quote);
+            }
+
+            buffer_.push_back(text[i]);
+        }
+
+        buffer_.push_back(options_.quote);
+    }
+
+    void field(const std::string &text)
+    {
+        field(text.data(), text.size());
+    }
+
+    void end_record()
+    {
+        buffer_.append(options_.line_terminator);
+
+        if (buffer_.size() >= buffer_size)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        destination_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+
+        if (!destination_)
+        {
+            throw xlnt::exception("failed to write CSV");
+        }
+    }
+
+private:
+    static const std::size_t buffer_size = 256 * 1024;
+
+    std::ostream &destination_;
+    const xlnt::csv_options &options_;
+    std::string buffer_;
+    std::array<bool, 256> needs_quotes_;
+};
+
+/// <summary>
+/// Splits CSV read from a stream in large chunks into records. The text of the fields
+/// of the current record is kept unquoted in one buffer.
+/// </summary>
+class csv_source
+{
+public:
+    csv_source(std::istream &source, const xlnt::csv_options &options)
+        : source_(source), options_(options)
+    {
+        chunk_.resize(chunk_size);
+        special_.fill(false);
+        special_[static_cast<unsigned char>(options.delimiter)] = true;
+        special_[static_cast<unsigned char>(options.quote)] = true;
+        special_['\r'] = true;
+        special_['\n'] = true;
+    }
+
+    // Reads the next record and returns false if the stream has ended before it.
+    bool next()
+    {
+        text_.clear();
+        ends_.clear();
+
+        if (!available())
+        {
+            return false;
+        }
+
+        auto field_start = true;
+
+        while (available())
+        {
+            if (field_start && chunk_[position_] == options_.quote)
+            {
+                ++position_;
+                read_quoted();
+                field_start = false;
+                continue;
+            }
+
+            field_start = false;
+            const auto begin = position_;
+
+            while (position_ < size_ && !special_[static_cast<unsigned char>(chunk_[position_])])
+            {
+                ++position_;
+            }
+
+            text_.append(&chunk_[begin], position_ - begin);
+
+            if (position_ == size_)
+            {
+                continue;
+            }
+
+            const auto c = chunk_[position_++];
+
+            if (c == options_.delimiter)
+            {
+                ends_.push_back(text_.size());
+                field_start = true;
+            }
+            else if (c == '\n' || c == '\r')
+            {
+                if (c == '\r' && available() && chunk_[position_] == '\n')
+                {
+                    ++position_;
+                }
+
+                break;
+            }
+            else
+            {
+                // a quote within an unquoted field is kept as it is
+                text_.push_back(c);
+            }
+        }
+
+        ends_.push_back(text_.size());
+
+        return true;
+    }
+
+    std::size_t fields() const
+    {
+        return ends_.size();
+    }
+
+    const char *field(std::size_t index, std::size_t &length) const
+    {
+        const auto begin = index == 0 ? 0 : ends_[index - 1];
+        length = ends_[index] - begin;
+
+        return text_.data() + begin;
+    }
+
+private:
+    static const std::size_t chunk_size = 256 * 1024;
+
+    // the text of a quoted field up to and including its closing quote
+    void read_quoted()
+    {
+        while (available())
+        {
+            const auto begin = position_;
+            const auto found = static_cast<const char *>(
+                std::memchr(&chunk_[begin], options_.quote, size_ - begin));
+
+            if (found == nullptr)
+            {
+                text_.append(&chunk_[begin], size_ - begin);
+                position_ = size_;
+                continue;
+            }
+
+            position_ = static_cast<std::size_t>(found - chunk_.data());
+            text_.append(&chunk_[begin], position_ - begin);
+            ++position_;
+
+            // a doubled quote is a quote in the text, otherwise the field is closed
+            if (!available() || chunk_[position_] != options_.quote)
+            {
+                return;
+            }
+
+            text_.push_back(options_.quote);
+            ++position_;
+        }
+    }
+
+    // Returns true if there is a character at position_, reading the next chunk if needed.
+    bool available()
+    {
+        if (position_ < size_)
+        {
+            return true;
+        }
+
+        source_.read(&chunk_[0], static_cast<std::streamsize>(chunk_.size()));
+        size_ = static_cast<std::size_t>(source_.gcount());
+        position_ = 0;
+
+        return size_ > 0;
+    }
+
+    std::istream &source_;
+    const xlnt::csv_options &options_;
+    std::vector<char> chunk_;
+    std::size_t size_ = 0;
+    std::size_t position_ = 0;
+    std::array<bool, 256> special_;
+    std::string text_;
+    std::vector<std::size_t> ends_;
+};
+
+// Returns true and sets value to the serial of text if it is a date written as yyyy-mm-dd.
+bool infer_iso_date(const char *text, std::size_t length, xlnt::calendar base_date, double &value)
+{
+    if (length != 10 || text[4] != '-' || text[7] != '-')
+    {
+        return false;
+    }
+
+    int parts[3] = {0, 0, 0};
+    const std::size_t begins[3] = {0, 5, 8};
+    const std::size_t lengths[3] = {4, 2, 2};
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        for (std::size_t j = begins[i]; j < begins[i] + lengths[i]; ++j)
+        {
+            if (text[j] < '0' || text[j] > '9') return false;
+            parts[i] = parts[i] * 10 + (text[j] - '0');
+        }
+    }
+
+    if (parts[1] < 1 || parts[1] > 12 || parts[2] < 1 || parts[2] > 31)
+    {
+        return false;
+    }
+
+    const auto date = xlnt::date(parts[0], parts[1], parts[2]);
+    value = date.to_number(base_date);
+
+    // days past the end of their month move to the next one
+    return xlnt::date::from_number(static_cast<int>(value), base_date) == date;
+}
+
+// Returns true if text is TRUE or FALSE in any case and sets value to which.
+bool infer_boolean(const char *text, std::size_t length, bool &value)
+{
+    auto equals = [text, length](const char *upper) {
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            if (upper[i] == '\0' || std::toupper(static_cast<unsigned char>(text[i])) != upper[i]) return false;
+        }
+
+        return upper[length] == '\0';
+    };
+
+    if (equals("TRUE"))
+    {
+        value = true;
+        return true;
+    }
+
+    if (equals("FALSE"))
+    {
+        value = false;
+        return true;
+    }
+
+    return false;
+}
+
+// Hashes the content of the cells of one worksheet, including their position, such that
+// cells holding the same values, formula, format, hyperlink and comment at the same reference
+// hash alike. Shared strings are hashed by their text and formats by their records rather than
+// by index, so cells of different workbooks can be compared.
+class cell_hasher
+{
+public:
+    explicit cell_hasher(const xlnt::workbook &wb)
+        : workbook_(wb)
+    {
+    }
+
+    std::size_t operator()(const xlnt::detail::cell_impl &impl)
+    {
+        using xlnt::detail::hash_combine;
+
+        std::size_t seed = 0;
+        hash_combine(seed, impl.row_);
+        hash_combine(seed, impl.column_.index);
+        hash_combine(seed, static_cast<int>(impl.type_));
+        hash_combine(seed, impl.is_merged_);
+        hash_combine(seed, impl.phonetics_visible_);
+
+        // a number hashes the same whether it's held as an integer or as an integral double
+        const auto number = impl.value_number();
+
+        if (impl.type_ == xlnt::cell::type::shared_string)
+        {
+            hash_combine(seed, shared_string(static_cast<std::size_t>(number)));
+        }
+        else if (impl.value_integral_ || (number == std::trunc(number) && std::fabs(number) < 9.0e18))
+        {
+            hash_combine(seed, impl.value_integer());
+        }
+        else
+        {
+            hash_combine(seed, number);
+        }
+
+        hash_combine(seed, xlnt::rich_text_hash()(impl.value_text()));
+        xlnt::detail::hash_combine_optional<std::string>(seed, impl.formula());
+
+        if (impl.format_.is_set())
+        {
+            hash_combine(seed, format(*impl.format_.get()));
+        }
+
+        if (impl.hyperlink() != nullptr)
+        {
+            const auto &link = *impl.hyperlink();
+            hash_combine(seed, link.relationship.target().to_string());
+            xlnt::detail::hash_combine_optional<std::string>(seed, link.tooltip);
+            xlnt::detail::hash_combine_optional<std::string>(seed, link.display);
+        }
+
+        if (impl.comment().is_set())
+        {
+            const auto &cell_comment = *impl.comment().get();
+            hash_combine(seed, xlnt::rich_text_hash()(cell_comment.text()));
+            hash_combine(seed, cell_comment.author());
+        }
+
+        return seed;
+    }
+
+private:
+    std::size_t shared_string(std::size_t index)
+    {
+        auto found = strings_.find(index);
+
+        if (found == strings_.end())
+        {
+            found = strings_.emplace(index, xlnt::rich_text_hash()(workbook_.shared_strings(index))).first;
+        }
+
+        return found->second;
+    }
+
+    std::size_t format(const xlnt::detail::format_impl &impl)
+    {
+        using xlnt::detail::hash_combine;
+
+        auto found = formats_.find(&impl);
+
+        if (found != formats_.end())
+        {
+            return found->second;
+        }
+
+        const auto &stylesheet = *impl.parent;
+        std::size_t seed = 0;
+
+        auto combine_record = [&seed](const xlnt::optional<std::size_t> &id, std::size_t hash) {
+            hash_combine(seed, id.is_set());
+            hash_combine(seed, hash);
+        };
+
+        combine_record(impl.alignment_id,
+            impl.alignment_id.is_set() ? xlnt::detail::alignment_hash()(stylesheet.alignments.at(impl.alignment_id.get())) : 0);
+        combine_record(impl.border_id,
+            impl.border_id.is_set() ? xlnt::detail::border_hash()(stylesheet.borders.at(impl.border_id.get())) : 0);
+        combine_record(impl.fill_id,
+            impl.fill_id.is_set() ? xlnt::detail::fill_hash()(stylesheet.fills.at(impl.fill_id.get())) : 0);
+        combine_record(impl.font_id,
+            impl.font_id.is_set() ? xlnt::detail::font_hash()(stylesheet.fonts.at(impl.font_id.get())) : 0);
+        combine_record(impl.protection_id,
+            impl.protection_id.is_set() ? xlnt::detail::protection_hash()(stylesheet.protections.at(impl.protection_id.get())) : 0);
+
+        // custom number formats are hashed by their format code, whose id depends on the workbook
+        hash_combine(seed, impl.number_format_id.is_set());
+
+        if (impl.number_format_id.is_set())
+        {
+            const auto id = impl.number_format_id.get();
+            const auto custom = std::find_if(stylesheet.number_formats.begin(), stylesheet.number_formats.end(),
+                [id](const xlnt::number_format &nf) { return nf.id() == id; });
+
+            if (xlnt::number_format::is_builtin_format(id) || custom == stylesheet.number_formats.end())
+            {
+                hash_combine(seed, id);
+            }
+            else
+            {
+                hash_combine(seed, custom->format_string());
+            }
+        }
+
+        xlnt::detail::hash_combine_optional<bool>(seed, impl.alignment_applied);
+        xlnt::detail::hash_combine_optional<bool>(seed, impl.border_applied);
+        xlnt::detail::hash_combine_optional<bool>(seed, impl.fill_applied);
+        xlnt::detail::hash_combine_optional<bool>(seed, impl.font_applied);
+        xlnt::detail::hash_combine_optional<bool>(seed, impl.number_format_applied);
+        xlnt::detail::hash_combine_optional<bool>(seed, impl.protection_applied);
+        hash_combine(seed, impl.pivot_button_);
+        hash_combine(seed, impl.quote_prefix_);
+        xlnt::detail::hash_combine_optional<std::string>(seed, impl.style);
+
+        return formats_.emplace(&impl, seed).first->second;
+    }
+
+    const xlnt::workbook &workbook_;
+    std::unordered_map<std::size_t, std::size_t> strings_;
+    std::unordered_map<const xlnt::detail::format_impl *, std::size_t> formats_;
+};
+
+// Calls visit with the reference of each cell in store for which match returns true.
+template <typename Match, typename Visit>
+void for_each_match(const xlnt::detail::cell_store &store, Match match, Visit visit)
+{
+    store.for_each([&match, &visit](const xlnt::detail::cell_impl &impl) {
+        if (match(impl))
+        {
+            visit(xlnt::cell_reference(impl.column_, impl.row_));
+        }
+    });
+}
+
+// Returns the references of the cells in store for which match returns true in row-major order.
+template <typename Match>
+std::vector<xlnt::cell_reference> all_matches(const xlnt::detail::cell_store &store, Match match)
+{
+    std::vector<xlnt::cell_reference> result;
+    for_each_match(store, match, [&result](const xlnt::cell_reference &ref) { result.push_back(ref); });
+    std::sort(result.begin(), result.end(), xlnt::detail::row_major_order());
+
+    return result;
+}
+
+// Returns the reference of the first cell in store in row-major order for which match returns true.
+template <typename Match>
+xlnt::optional<xlnt::cell_reference> first_match(const xlnt::detail::cell_store &store, Match match)
+{
+    xlnt::optional<xlnt::cell_reference> result;
+    for_each_match(store, match, [&result](const xlnt::cell_reference &ref) {
+        if (!result.is_set() || xlnt::detail::row_major_order()(ref, result.get()))
+        {
+            result = ref;
+        }
+    });
+
+    return result;
+}
+
+// Matches the cells whose value is an unformatted string. Shared strings are looked up in the
+// shared string table once, so that cells are matched by their index. Only if the table holds
+// some string more than once, which the lookup map doesn't tell apart, is each index compared
+// to the text the first time a cell refers to it.
+class string_matcher
+{
+public:
+    // the shared strings of wb must have been loaded with shared_string_loader::load_all
+    string_matcher(const xlnt::detail::workbook_impl &wb, const std::string &text)
+        : workbook_(wb), text_(text)
+    {
+        if (wb.shared_strings_ids_.size() == wb.shared_strings_values_.size())
+        {
+            const auto found = wb.shared_strings_ids_.find(xlnt::rich_text(text));
+            index_ = found == wb.shared_strings_ids_.end() ? wb.shared_strings_values_.size() : found->second;
+        }
+        else
+        {
+            matches_.assign(wb.shared_strings_values_.size(), unknown);
+        }
+    }
+
+    bool operator()(const xlnt::detail::cell_impl &impl)
+    {
+        switch (impl.type_)
+        {
+        case xlnt::cell::type::shared_string:
+            return shared_string(static_cast<std::size_t>(impl.value_number()));
+        case xlnt::cell::type::inline_string:
+        case xlnt::cell::type::formula_string:
+            return impl.value_text() == text_;
+        default:
+            return false;
+        }
+    }
+
+private:
+    bool shared_string(std::size_t index)
+    {
+        if (matches_.empty())
+        {
+            return index == index_;
+        }
+
+        if (index >= matches_.size())
+        {
+            return false;
+        }
+
+        if (matches_[index] == unknown)
+        {
+            matches_[index] = workbook_.shared_strings_values_[index] == text_ ? match : mismatch;
+        }
+
+        return matches_[index] == match;
+    }
+
+    enum state : unsigned char
+    {
+        unknown,
+        match,
+        mismatch
+    };
+
+    const xlnt::detail::workbook_impl &workbook_;
+    const std::string &text_;
+    std::size_t index_ = 0;
+    std::vector<state> matches_;
+};
+
+// The number of rows per chunk compared by worksheet::diff before looking at cells.
+const xlnt::row_t diff_chunk_rows = 1024;
+
 } // namespace
 
 namespace xlnt {
@@ -121,7 +875,13 @@ cell worksheet::operator[](const cell_reference &ref)
 
 std::vector<range_reference> worksheet::merged_ranges() const
 {
-    return d_->merged_cells_;
+    return d_->merged_cells_.ranges();
+}
+
+optional<range_reference> worksheet::merged_range(const cell_reference &reference) const
+{
+    const auto merged = d_->merged_cells_.find(reference);
+    return merged == nullptr ? optional<range_reference>() : optional<range_reference>(*merged);
 }
 
 bool worksheet::has_page_margins() const
@@ -199,21 +959,195 @@ const workbook worksheet::workbook() const
     return d_->parent_;
 }
 
+memory_usage worksheet::memory_usage() const
+{
+    auto usage = xlnt::memory_usage();
+    usage.cells = sizeof(detail::worksheet_impl) + d_->cell_map_.memory_usage();
+
+    d_->cell_map_.for_each([&usage](const detail::cell_impl &impl) {
+        if (!impl.extension_)
+        {
+            return;
+        }
+
+        const auto &extension = *impl.extension_;
+        usage.cells += sizeof(detail::cell_extension);
+        usage.text += extension.value_text_.memory_usage();
+
+        if (extension.formula_.is_set())
+        {
+            usage.formulas += detail::heap_size(extension.formula_.get());
+        }
+
+        if (extension.hyperlink_)
+        {
+            usage.cells += sizeof(detail::hyperlink_impl);
+        }
+    });
+
+    usage.formulas += detail::heap_size(d_->formula_groups_);
+
+    for (const auto &group : d_->formula_groups_)
+    {
+        usage.formulas += group.text.is_set() ? detail::heap_size(group.text.get()) : 0;
+    }
+
+    usage.comments += detail::heap_size(d_->comments_);
+
+    for (const auto &comment : d_->comments_)
+    {
+        usage.comments += comment.second.text().memory_usage() + comment.second.author().size();
+    }
+
+    return usage;
+}
+
 void worksheet::garbage_collect()
 {
-    auto cell_iter = d_->cell_map_.begin();
+    d_->cell_map_.erase_if([](const detail::cell_impl &impl) {
+        return impl.is_garbage_collectible();
+    });
+    d_->cell_map_.collected(true);
+}
+
+std::vector<std::pair<row_t, std::size_t>> worksheet::fingerprints(row_t rows_per_chunk) const
+{
+    if (rows_per_chunk == 0)
+    {
+        throw invalid_parameter("rows_per_chunk must be positive");
+    }
+
+    // cells are visited in no particular order, so the hashes of the cells of a chunk are
+    // added up, which doesn't depend on it
+    const auto wb = workbook();
+    cell_hasher hasher(wb);
+    std::unordered_map<row_t, std::size_t> chunks;
+
+    d_->cell_map_.for_each([&chunks, &hasher, rows_per_chunk](const detail::cell_impl &impl) {
+        if (!impl.is_garbage_collectible())
+        {
+            chunks[(impl.row_ - 1) / rows_per_chunk] += hasher(impl);
+        }
+    });
+
+    std::vector<std::pair<row_t, std::size_t>> result;
+    result.reserve(chunks.size());
+
+    for (const auto &chunk : chunks)
+    {
+        result.emplace_back(chunk.first * rows_per_chunk + 1, chunk.second);
+    }
+
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+std::size_t worksheet::fingerprint() const
+{
+    std::size_t seed = 0;
+
+    for (const auto &chunk : fingerprints())
+    {
+        detail::hash_combine(seed, chunk.first);
+        detail::hash_combine(seed, chunk.second);
+    }
+
+    return seed;
+}
+
+worksheet_diff worksheet::diff(const worksheet &older) const
+{
+    const auto newer_chunks = fingerprints(diff_chunk_rows);
+    const auto older_chunks = older.fingerprints(diff_chunk_rows);
+
+    // the indices of the chunks which differ, found by walking both ordered lists together
+    std::unordered_set<row_t> differing;
+    auto newer_chunk = newer_chunks.begin();
+    auto older_chunk = older_chunks.begin();
+
+    while (newer_chunk != newer_chunks.end() || older_chunk != older_chunks.end())
+    {
+        if (older_chunk == older_chunks.end()
+            || (newer_chunk != newer_chunks.end() && newer_chunk->first < older_chunk->first))
+        {
+            differing.insert(((newer_chunk++)->first - 1) / diff_chunk_rows);
+        }
+        else if (newer_chunk == newer_chunks.end() || older_chunk->first < newer_chunk->first)
+        {
+            differing.insert(((older_chunk++)->first - 1) / diff_chunk_rows);
+        }
+        else
+        {
+            if (newer_chunk->second != older_chunk->second)
+            {
+                differing.insert((newer_chunk->first - 1) / diff_chunk_rows);
+            }
+
+            ++newer_chunk;
+            ++older_chunk;
+        }
+    }
+
+    worksheet_diff result;
 
-    while (cell_iter != d_->cell_map_.end())
+    if (differing.empty())
     {
-        if (xlnt::cell(&cell_iter->second).garbage_collectible())
+        return result;
+    }
+
+    // the fingerprints of the cells with content in the differing chunks of a worksheet
+    auto cells_of = [&differing](const worksheet &ws) {
+        const auto wb = ws.workbook();
+        cell_hasher hasher(wb);
+        std::vector<std::pair<cell_reference, std::size_t>> cells;
+
+        ws.d_->cell_map_.for_each([&differing, &hasher, &cells](const detail::cell_impl &impl) {
+            if (!impl.is_garbage_collectible() && differing.count((impl.row_ - 1) / diff_chunk_rows) != 0)
+            {
+                cells.emplace_back(cell_reference(impl.column_, impl.row_), hasher(impl));
+            }
+        });
+
+        std::sort(cells.begin(), cells.end(),
+            [](const std::pair<cell_reference, std::size_t> &a, const std::pair<cell_reference, std::size_t> &b) {
+                return detail::row_major_order()(a.first, b.first);
+            });
+
+        return cells;
+    };
+
+    const auto newer_cells = cells_of(*this);
+    const auto older_cells = cells_of(older);
+    const auto before = detail::row_major_order();
+
+    auto newer_cell = newer_cells.begin();
+    auto older_cell = older_cells.begin();
+
+    while (newer_cell != newer_cells.end() || older_cell != older_cells.end())
+    {
+        if (older_cell == older_cells.end()
+            || (newer_cell != newer_cells.end() && before(newer_cell->first, older_cell->first)))
         {
-            cell_iter = d_->cell_map_.erase(cell_iter);
+            result.added.push_back((newer_cell++)->first);
+        }
+        else if (newer_cell == newer_cells.end() || before(older_cell->first, newer_cell->first))
+        {
+            result.removed.push_back((older_cell++)->first);
         }
         else
         {
-            ++cell_iter;
+            if (newer_cell->second != older_cell->second)
+            {
+                result.changed.push_back(newer_cell->first);
+            }
+
+            ++newer_cell;
+            ++older_cell;
         }
     }
+
+    return result;
 }
 
 void worksheet::id(std::size_t id)
@@ -259,6 +1193,7 @@ void worksheet::title(const std::string &title)
     // if the insert succeeded (i.e. wasn't a duplicate sheet name)
     // update the worksheet title and remove the old relation
     workbook().d_->sheet_title_rel_id_map_.erase(d_->title_);
+    workbook().d_->worksheet_index_.rename(d_->title_, title);
     d_->title_ = title;
 
     workbook().update_sheet_properties();
@@ -383,26 +1318,26 @@ cell_reference worksheet::active_cell() const
 cell worksheet::cell(const cell_reference &reference)
 {
     auto match = d_->cell_map_.find(reference);
-    if (match == d_->cell_map_.end())
+    if (match == nullptr)
     {
         auto impl = detail::cell_impl();
         impl.parent_ = d_;
         impl.column_ = reference.column_index();
         impl.row_ = reference.row();
 
-        match = d_->cell_map_.emplace(reference, impl).first;
+        match = d_->cell_map_.emplace(reference, std::move(impl)).first;
     }
-    return xlnt::cell(&match->second);
+    return xlnt::cell(match);
 }
 
 const cell worksheet::cell(const cell_reference &reference) const
 {
     const auto match = d_->cell_map_.find(reference);
-    if (match == d_->cell_map_.end())
+    if (match == nullptr)
     {
         throw xlnt::invalid_parameter("Requested cell doesn't exist.");
     }
-    return xlnt::cell(&match->second);
+    return xlnt::cell(const_cast<detail::cell_impl *>(match));
 }
 
 cell worksheet::cell(xlnt::column_t column, row_t row)
@@ -417,8 +1352,37 @@ const cell worksheet::cell(xlnt::column_t column, row_t row) const
 
 bool worksheet::has_cell(const cell_reference &reference) const
 {
-    const auto cell = d_->cell_map_.find(reference);
-    return cell != d_->cell_map_.cend();
+    return d_->cell_map_.find(reference) != nullptr;
+}
+
+std::vector<cell_reference> worksheet::find_all(const std::string &text) const
+{
+    auto wb = workbook();
+    detail::shared_string_loader::load_all(wb);
+
+    return all_matches(d_->cell_map_, string_matcher(*wb.d_, text));
+}
+
+std::vector<cell_reference> worksheet::find_all(double number) const
+{
+    return all_matches(d_->cell_map_, [number](const detail::cell_impl &impl) {
+        return impl.type_ == cell::type::number && impl.value_number() == number;
+    });
+}
+
+optional<cell_reference> worksheet::find(const std::string &text) const
+{
+    auto wb = workbook();
+    detail::shared_string_loader::load_all(wb);
+
+    return first_match(d_->cell_map_, string_matcher(*wb.d_, text));
+}
+
+optional<cell_reference> worksheet::find(double number) const
+{
+    return first_match(d_->cell_map_, [number](const detail::cell_impl &impl) {
+        return impl.type_ == cell::type::number && impl.value_number() == number;
+    });
 }
 
 bool worksheet::has_row_properties(row_t row) const
@@ -428,32 +1392,30 @@ bool worksheet::has_row_properties(row_t row) const
 
 range worksheet::named_range(const std::string &name)
 {
-    if (!workbook().has_named_range(name))
-    {
-        throw key_not_found();
-    }
+    // a name of this worksheet is also one of the workbook, so the other worksheets
+    // don't need to be searched
+    const auto match = d_->named_ranges_.find(name);
 
-    if (!has_named_range(name))
+    if (match == d_->named_ranges_.end())
     {
         throw key_not_found();
     }
 
-    return range(d_->named_ranges_[name].targets()[0].second);
+    return range(match->second.targets()[0].second);
 }
 
 const range worksheet::named_range(const std::string &name) const
 {
-    if (!workbook().has_named_range(name))
-    {
-        throw key_not_found();
-    }
+    // a name of this worksheet is also one of the workbook, so the other worksheets
+    // don't need to be searched
+    const auto match = d_->named_ranges_.find(name);
 
-    if (!has_named_range(name))
+    if (match == d_->named_ranges_.end())
     {
         throw key_not_found();
     }
 
-    return range(d_->named_ranges_[name].targets()[0].second);
+    return range(match->second.targets()[0].second);
 }
 
 column_t worksheet::lowest_column() const
@@ -463,31 +1425,24 @@ column_t worksheet::lowest_column() const
         return constants::min_column();
     }
 
-    auto lowest = constants::max_column();
-
-    for (auto &cell : d_->cell_map_)
-    {
-        lowest = std::min(lowest, cell.first.column());
-    }
-
-    return lowest;
+    return d_->cell_map_.bounds().min_column;
 }
 
 column_t worksheet::lowest_column_or_props() const
 {
     auto lowest = lowest_column();
 
-    if (d_->cell_map_.empty() && !d_->column_properties_.empty())
+    if (d_->column_properties_.empty())
     {
-        lowest = d_->column_properties_.begin()->first;
+        return lowest;
     }
 
-    for (auto &props : d_->column_properties_)
+    if (d_->cell_map_.empty())
     {
-        lowest = std::min(lowest, props.first);
+        return d_->column_properties_.front().first;
     }
 
-    return lowest;
+    return std::min(lowest, d_->column_properties_.front().first);
 }
 
 row_t worksheet::lowest_row() const
@@ -497,89 +1452,78 @@ row_t worksheet::lowest_row() const
         return constants::min_row();
     }
 
-    auto lowest = constants::max_row();
-
-    for (auto &cell : d_->cell_map_)
-    {
-        lowest = std::min(lowest, cell.first.row());
-    }
-
-    return lowest;
+    return d_->cell_map_.bounds().min_row;
 }
 
 row_t worksheet::lowest_row_or_props() const
 {
     auto lowest = lowest_row();
 
-    if (d_->cell_map_.empty() && !d_->row_properties_.empty())
+    if (d_->row_properties_.empty())
     {
-        lowest = d_->row_properties_.begin()->first;
+        return lowest;
     }
 
-    for (auto &props : d_->row_properties_)
+    if (d_->cell_map_.empty())
     {
-        lowest = std::min(lowest, props.first);
+        return d_->row_properties_.front().first;
     }
 
-    return lowest;
+    return std::min(lowest, d_->row_properties_.front().first);
 }
 
 row_t worksheet::highest_row() const
 {
-    auto highest = constants::min_row();
-
-    for (auto &cell : d_->cell_map_)
+    if (d_->cell_map_.empty())
     {
-        highest = std::max(highest, cell.first.row());
+        return constants::min_row();
     }
 
-    return highest;
+    return d_->cell_map_.bounds().max_row;
 }
 
 row_t worksheet::highest_row_or_props() const
 {
     auto highest = highest_row();
 
-    if (d_->cell_map_.empty() && !d_->row_properties_.empty())
+    if (d_->row_properties_.empty())
     {
-        highest = d_->row_properties_.begin()->first;
+        return highest;
     }
 
-    for (auto &props : d_->row_properties_)
+    if (d_->cell_map_.empty())
     {
-        highest = std::max(highest, props.first);
+        return d_->row_properties_.back().first;
     }
 
-    return highest;
+    return std::max(highest, d_->row_properties_.back().first);
 }
 
 column_t worksheet::highest_column() const
 {
-    auto highest = constants::min_column();
-
-    for (auto &cell : d_->cell_map_)
+    if (d_->cell_map_.empty())
     {
-        highest = std::max(highest, cell.first.column());
+        return constants::min_column();
     }
 
-    return highest;
+    return d_->cell_map_.bounds().max_column;
 }
 
 column_t worksheet::highest_column_or_props() const
 {
     auto highest = highest_column();
 
-    if (d_->cell_map_.empty() && !d_->column_properties_.empty())
+    if (d_->column_properties_.empty())
     {
-        highest = d_->column_properties_.begin()->first;
+        return highest;
     }
 
-    for (auto &props : d_->column_properties_)
+    if (d_->cell_map_.empty())
     {
-        highest = std::max(highest, props.first);
+        return d_->column_properties_.back().first;
     }
 
-    return highest;
+    return std::max(highest, d_->column_properties_.back().first);
 }
 
 range_reference worksheet::calculate_dimension(bool skip_null, bool skip_row_props) const
@@ -600,12 +1544,13 @@ range_reference worksheet::calculate_dimension(bool skip_null, bool skip_row_pro
     row_t max_row_prop = constants::min_row();
     if (!skip_row_props)
     {
-        for (const auto &row_prop : d_->row_properties_)
+        if (!d_->row_properties_.empty())
         {
-            if(skip_null){
-                min_row_prop = std::min(min_row_prop, row_prop.first);
+            if (skip_null)
+            {
+                min_row_prop = std::min(min_row_prop, d_->row_properties_.front().first);
             }
-            max_row_prop = std::max(max_row_prop, row_prop.first);
+            max_row_prop = std::max(max_row_prop, d_->row_properties_.back().first);
         }
     }
     if (d_->cell_map_.empty())
@@ -613,28 +1558,22 @@ range_reference worksheet::calculate_dimension(bool skip_null, bool skip_row_pro
         return range_reference(constants::min_column(), min_row_prop,
             constants::min_column(), max_row_prop);
     }
-    // find min and max row/column in cell map
-    column_t min_col = skip_null? constants::max_column() : constants::min_column();
-    column_t max_col = constants::min_column();
-    row_t min_row = min_row_prop;
-    row_t max_row = max_row_prop;
-    for (auto &c : d_->cell_map_)
-    {
-        if(skip_null){
-            min_col = std::min(min_col, c.second.column_);
-            min_row = std::min(min_row, c.second.row_);
-        }
-        max_col = std::max(max_col, c.second.column_);
-        max_row = std::max(max_row, c.second.row_);
-    }
+    // min and max row/column in cell map, kept up to date by the cell store
+    const auto &bounds = d_->cell_map_.bounds();
+    column_t min_col = skip_null ? column_t(bounds.min_column) : constants::min_column();
+    column_t max_col = bounds.max_column;
+    row_t min_row = skip_null ? std::min(min_row_prop, bounds.min_row) : min_row_prop;
+    row_t max_row = std::max(max_row_prop, bounds.max_row);
     return range_reference(min_col, min_row, max_col, max_row);
 }
 
 range worksheet::range(const std::string &reference_string)
 {
-    if (has_named_range(reference_string))
+    const auto match = d_->named_ranges_.find(reference_string);
+
+    if (match != d_->named_ranges_.end())
     {
-        return named_range(reference_string);
+        return range(match->second.targets()[0].second);
     }
 
     return range(range_reference(reference_string));
@@ -642,9 +1581,11 @@ range worksheet::range(const std::string &reference_string)
 
 const range worksheet::range(const std::string &reference_string) const
 {
-    if (has_named_range(reference_string))
+    const auto match = d_->named_ranges_.find(reference_string);
+
+    if (match != d_->named_ranges_.end())
     {
-        return named_range(reference_string);
+        return range(match->second.targets()[0].second);
     }
 
     return range(range_reference(reference_string));
@@ -672,7 +1613,12 @@ void worksheet::unmerge_cells(const std::string &reference_string)
 
 void worksheet::merge_cells(const range_reference &reference)
 {
-    d_->merged_cells_.push_back(reference);
+    if (d_->merged_cells_.find_overlap(reference) != nullptr)
+    {
+        throw invalid_parameter();
+    }
+
+    d_->merged_cells_.add(reference);
     bool first = true;
 
     for (auto row : range(reference))
@@ -700,15 +1646,11 @@ void worksheet::merge_cells(const range_reference &reference)
 
 void worksheet::unmerge_cells(const range_reference &reference)
 {
-    auto match = std::find(d_->merged_cells_.begin(), d_->merged_cells_.end(), reference);
-
-    if (match == d_->merged_cells_.end())
+    if (!d_->merged_cells_.remove(reference))
     {
         throw invalid_parameter();
     }
 
-    d_->merged_cells_.erase(match);
-
     for (auto row : range(reference))
     {
         for (auto cell : row)
@@ -727,64 +1669,259 @@ row_t worksheet::next_row() const
         row = 1;
     }
 
-    return row;
+    return row;
+}
+
+xlnt::range worksheet::rows(bool skip_null)
+{
+    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::row, skip_null);
+}
+
+const xlnt::range worksheet::rows(bool skip_null) const
+{
+    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::row, skip_null);
+}
+
+xlnt::range worksheet::columns(bool skip_null)
+{
+    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::column, skip_null);
+}
+
+const xlnt::range worksheet::columns(bool skip_null) const
+{
+    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::column, skip_null);
+}
+
+row_t worksheet::append_row(const std::vector<double> &values)
+{
+    return assign_row(*d_, values, assign_number);
+}
+
+row_t worksheet::append_row(const std::vector<std::string> &values)
+{
+    auto assign = make_string_assigner(workbook(), [](detail::cell_impl &cell, const std::string &value) {
+        return xlnt::cell(&cell).check_string(value);
+    });
+
+    return assign_row(*d_, values, assign);
+}
+
+row_t worksheet::append_row(const std::vector<bool> &values)
+{
+    return assign_row(*d_, values, assign_boolean);
+}
+
+row_t worksheet::next_appended_row() const
+{
+    const auto row = d_->cell_map_.bounds().max_row;
+
+    if (row == constants::max_row())
+    {
+        throw invalid_cell_reference(1, row);
+    }
+
+    return row + 1;
+}
+
+void worksheet::assign_typed(column_t::index_t column, row_t row, std::int64_t value)
+{
+    assign_number(emplace_appended_cell(*d_, column, row), static_cast<double>(value));
+}
+
+void worksheet::assign_typed(column_t::index_t column, row_t row, double value)
+{
+    assign_number(emplace_appended_cell(*d_, column, row), value);
+}
+
+void worksheet::assign_typed(column_t::index_t column, row_t row, bool value)
+{
+    assign_boolean(emplace_appended_cell(*d_, column, row), value);
+}
+
+void worksheet::assign_typed(column_t::index_t column, row_t row, const std::string &value)
+{
+    xlnt::cell(&emplace_appended_cell(*d_, column, row)).value(value);
+}
+
+void worksheet::assign_typed(column_t::index_t column, row_t row, const date &value)
+{
+    xlnt::cell(&emplace_appended_cell(*d_, column, row)).value(value);
+}
+
+void worksheet::assign_typed(column_t::index_t column, row_t row, const datetime &value)
+{
+    xlnt::cell(&emplace_appended_cell(*d_, column, row)).value(value);
+}
+
+void worksheet::write_block(const cell_reference &top_left, const std::vector<std::vector<double>> &columns)
+{
+    assign_block(*d_, top_left, columns, assign_number);
+}
+
+void worksheet::write_block(const cell_reference &top_left, const std::vector<std::vector<std::string>> &columns)
+{
+    auto assign = make_string_assigner(workbook(), [](detail::cell_impl &cell, const std::string &value) {
+        return xlnt::cell(&cell).check_string(value);
+    });
+
+    assign_block(*d_, top_left, columns, assign);
+}
+
+void worksheet::write_block(const cell_reference &top_left, const std::vector<std::vector<bool>> &columns)
+{
+    assign_block(*d_, top_left, columns, assign_boolean);
+}
+
+void worksheet::read_block(const range_reference &range, double *values) const
+{
+    const auto first_column = range.top_left().column_index();
+    const auto last_column = range.bottom_right().column_index();
+    const auto first_row = range.top_left().row();
+    const auto width = range.width();
+
+    std::fill(values, values + width * range.height(), std::numeric_limits<double>::quiet_NaN());
+
+    for (const auto &part : d_->cell_map_.parts(first_row, range.bottom_right().row(), 1))
+    {
+        d_->cell_map_.for_each_in(part, [&](const detail::cell_impl &impl) {
+            if (impl.column_.index < first_column || impl.column_.index > last_column) return;
+
+            if (impl.type_ == cell_type::number || impl.type_ == cell_type::date)
+            {
+                values[static_cast<std::size_t>(impl.row_ - first_row) * width + (impl.column_.index - first_column)] = impl.value_number();
+            }
+        });
+    }
+}
+
+void worksheet::add_hyperlinks(const std::vector<std::pair<cell_reference, std::string>> &links)
+{
+    for (const auto &link : links)
+    {
+        if (link.second.empty())
+        {
+            throw invalid_parameter();
+        }
+    }
+
+    auto &manifest = workbook().manifest();
+    const auto ws_path = path();
+    const auto source = uri(ws_path.string());
+
+    for (const auto &link : links)
+    {
+        auto rel_id = manifest.relationship_id(ws_path, relationship_type::hyperlink, link.second);
+        if (rel_id.empty())
+        {
+            rel_id = manifest.register_relationship(source, relationship_type::hyperlink,
+                uri(link.second), target_mode::external);
+        }
+
+        auto c = xlnt::cell(cell(link.first));
+        c.d_->extension().hyperlink_.reset(new detail::hyperlink_impl());
+        c.d_->hyperlink()->relationship = manifest.relationship(ws_path, rel_id);
+
+        // as with cell::hyperlink, an existing value is kept and displayed
+        if (c.has_value())
+        {
+            c.d_->hyperlink()->display.set(c.to_string());
+        }
+        else
+        {
+            c.d_->hyperlink()->display.set(link.second);
+            c.value(link.second);
+        }
+    }
 }
 
-xlnt::range worksheet::rows(bool skip_null)
+cell_vector worksheet::cells(bool skip_null)
 {
-    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::row, skip_null);
+    const auto dimension = calculate_dimension(skip_null, skip_null);
+    return cell_vector(*this, dimension.top_left(), dimension, major_order::row, skip_null, true);
 }
 
-const xlnt::range worksheet::rows(bool skip_null) const
+const cell_vector worksheet::cells(bool skip_null) const
 {
-    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::row, skip_null);
+    const auto dimension = calculate_dimension(skip_null, skip_null);
+    return cell_vector(*this, dimension.top_left(), dimension, major_order::row, skip_null, true);
 }
 
-xlnt::range worksheet::columns(bool skip_null)
+void worksheet::parallel_for_each_cell(const std::function<void(const class cell &)> &function,
+    std::size_t thread_count) const
 {
-    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::column, skip_null);
+    parallel_for_each_cell(constants::min_row(), constants::max_row(), function, thread_count);
 }
 
-const xlnt::range worksheet::columns(bool skip_null) const
+void worksheet::parallel_for_each_cell(row_t first_row, row_t last_row,
+    const std::function<void(const class cell &)> &function, std::size_t thread_count) const
 {
-    return xlnt::range(*this, calculate_dimension(skip_null, skip_null), major_order::column, skip_null);
-}
+    if (thread_count == 0)
+    {
+        thread_count = current_executor()->concurrency();
+    }
 
-/*
-//TODO: finish implementing cell_iterator wrapping before uncommenting
+    // state which is otherwise filled in on first access is prepared up front so that
+    // function only ever reads
+    auto wb = xlnt::workbook(d_->parent_);
+    detail::shared_string_loader::load_all(wb);
+    d_->cell_map_.bounds();
 
-cell_vector worksheet::cells(bool skip_null)
-{
-    const auto dimension = calculate_dimension();
-    return cell_vector(*this, dimension.top_left(), dimension, major_order::row, skip_null, true);
-}
+    // a few parts per thread even out parts that take longer than others
+    const auto parts = d_->cell_map_.parts(first_row, last_row, thread_count == 1 ? 1 : thread_count * 4);
+    std::atomic<std::size_t> next_part(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
 
-const cell_vector worksheet::cells(bool skip_null) const
-{
-    const auto dimension = calculate_dimension();
-    return cell_vector(*this, dimension.top_left(), dimension, major_order::row, skip_null, true);
+    auto visit_parts = [&]() {
+        try
+        {
+            for (auto i = next_part++; i < parts.size(); i = next_part++)
+            {
+                d_->cell_map_.for_each_in(parts[i], [&function](const detail::cell_impl &impl) {
+                    function(xlnt::cell(const_cast<detail::cell_impl *>(&impl)));
+                });
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            next_part = parts.size();
+        }
+    };
+
+    detail::run_workers(std::min(thread_count, parts.size()), visit_parts);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
 }
-*/
 
 void worksheet::clear_cell(const cell_reference &ref)
 {
+    d_->comments_.erase(ref);
     d_->cell_map_.erase(ref);
     // TODO: garbage collect newly unreferenced resources such as styles?
 }
 
 void worksheet::clear_row(row_t row)
 {
-    for (auto it = d_->cell_map_.begin(); it != d_->cell_map_.end();)
+    d_->cell_map_.erase_if([row](const detail::cell_impl &cell) {
+        return cell.row_ == row;
+    });
+
+    auto comment = d_->comments_.lower_bound(cell_reference(1, row));
+    while (comment != d_->comments_.end() && comment->first.row() == row)
     {
-        if (it->first.row() == row)
-        {
-            it = d_->cell_map_.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        comment = d_->comments_.erase(comment);
     }
+
     d_->row_properties_.erase(row);
     // TODO: garbage collect newly unreferenced resources such as styles?
 }
@@ -821,110 +1958,50 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
         throw xlnt::exception("Cannot move cells as they would be outside the maximum bounds of the spreadsheet");
     }
 
-    std::vector<detail::cell_impl> cells_to_move;
-
-    auto cell_iter = d_->cell_map_.cbegin();
-    while (cell_iter != d_->cell_map_.cend())
+    switch (row_or_col)
     {
-        std::uint32_t current_index;
-        switch (row_or_col)
-        {
-        case row_or_col_t::row:
-            current_index = cell_iter->first.row();
-            break;
-        case row_or_col_t::column:
-            current_index = cell_iter->first.column().index;
-            break;
-        default:
-            throw xlnt::unhandled_switch_case();
-        }
-
-        if (current_index >= min_index) // extract cells to be moved
-        {
-            auto cell = cell_iter->second;
-            if (row_or_col == row_or_col_t::row)
-            {
-                cell.row_ = reverse ? cell.row_ - amount : cell.row_ + amount;
-            }
-            else if (row_or_col == row_or_col_t::column)
-            {
-                cell.column_ = reverse ? cell.column_.index - amount : cell.column_.index + amount;
-            }
-
-            cells_to_move.push_back(cell);
-            cell_iter = d_->cell_map_.erase(cell_iter);
-        }
-        else if (reverse && current_index >= min_index - amount) // delete destination cells
-        {
-            cell_iter = d_->cell_map_.erase(cell_iter);
-        }
-        else // skip other cells
-        {
-            ++cell_iter;
-        }
+    case row_or_col_t::row:
+        d_->cell_map_.shift_rows(min_index, amount, reverse);
+        break;
+    case row_or_col_t::column:
+        d_->cell_map_.shift_columns(static_cast<column_t::index_t>(min_index), amount, reverse);
+        break;
+    default:
+        throw xlnt::unhandled_switch_case();
     }
 
-    for (auto &cell : cells_to_move)
-    {
-        d_->cell_map_[cell_reference(cell.column_, cell.row_)] = cell;
-    }
+    // the properties are sorted and keep their order as they all move by the same amount
+    auto shift_index = [amount, reverse](std::uint32_t index) {
+        return reverse ? index - amount : index + amount;
+    };
 
     if (row_or_col == row_or_col_t::row)
     {
-        std::vector<std::pair<row_t, xlnt::row_properties>> properties_to_move;
+        auto &properties = d_->row_properties_;
 
-        auto row_prop_iter = d_->row_properties_.cbegin();
-        while (row_prop_iter != d_->row_properties_.cend())
+        if (reverse) // clear properties of destination
         {
-            auto current_row = row_prop_iter->first;
-            if (current_row >= min_index) // extract properties that need to be moved
-            {
-                auto tmp_row = reverse ? current_row - amount : current_row + amount;
-                properties_to_move.push_back({tmp_row, row_prop_iter->second});
-                row_prop_iter = d_->row_properties_.erase(row_prop_iter);
-            }
-            else if (reverse && current_row >= min_index - amount) // clear properties of destination when in reverse
-            {
-                row_prop_iter = d_->row_properties_.erase(row_prop_iter);
-            }
-            else // skip the rest
-            {
-                ++row_prop_iter;
-            }
+            properties.erase(properties.lower_bound(min_index - amount), properties.lower_bound(min_index));
         }
 
-        for (const auto &prop : properties_to_move)
+        for (auto prop = properties.lower_bound(min_index); prop != properties.end(); ++prop)
         {
-            add_row_properties(prop.first, prop.second);
+            prop->first = shift_index(prop->first);
         }
     }
     else if (row_or_col == row_or_col_t::column)
     {
-        std::vector<std::pair<column_t, xlnt::column_properties>> properties_to_move;
+        auto &properties = d_->column_properties_;
 
-        auto col_prop_iter = d_->column_properties_.cbegin();
-        while (col_prop_iter != d_->column_properties_.cend())
+        if (reverse) // clear properties of destination
         {
-            auto current_col = col_prop_iter->first.index;
-            if (current_col >= min_index) // extract properties that need to be moved
-            {
-                auto tmp_column = column_t(reverse ? current_col - amount : current_col + amount);
-                properties_to_move.push_back({tmp_column, col_prop_iter->second});
-                col_prop_iter = d_->column_properties_.erase(col_prop_iter);
-            }
-            else if (reverse && current_col >= min_index - amount) // clear properties of destination when in reverse
-            {
-                col_prop_iter = d_->column_properties_.erase(col_prop_iter);
-            }
-            else // skip the rest
-            {
-                ++col_prop_iter;
-            }
+            properties.erase(properties.lower_bound(column_t(min_index - amount)),
+                properties.lower_bound(column_t(min_index)));
         }
 
-        for (auto &prop : properties_to_move)
+        for (auto prop = properties.lower_bound(column_t(min_index)); prop != properties.end(); ++prop)
         {
-            add_column_properties(prop.first, prop.second);
+            prop->first = column_t(shift_index(prop->first.index));
         }
     }
 
@@ -945,7 +2022,9 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
         }
     };
 
-    for (auto merged_cell = d_->merged_cells_.begin(); merged_cell != d_->merged_cells_.end(); ++merged_cell)
+    auto merged_cells = d_->merged_cells_.ranges();
+
+    for (auto merged_cell = merged_cells.begin(); merged_cell != merged_cells.end(); ++merged_cell)
     {
         cell_reference new_top_left = merged_cell->top_left();
         shift_reference(new_top_left);
@@ -959,6 +2038,13 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
             *merged_cell = new_range;
         }
     }
+
+    d_->merged_cells_.assign(std::move(merged_cells));
+
+    if (!d_->comments_.empty())
+    {
+        d_->reindex_comments();
+    }
 }
 
 bool worksheet::operator==(const worksheet &other) const
@@ -1023,6 +2109,238 @@ void worksheet::reserve(std::size_t n)
     d_->cell_map_.reserve(n);
 }
 
+void worksheet::export_csv(std::ostream &destination) const
+{
+    export_csv(destination, csv_options());
+}
+
+void worksheet::export_csv(std::ostream &destination, const csv_options &options) const
+{
+    if (d_->cell_map_.empty())
+    {
+        return;
+    }
+
+    // the cells row by row, which is the order the dense cell store already keeps them in
+    std::vector<const detail::cell_impl *> cells;
+    cells.reserve(d_->cell_map_.size());
+    d_->cell_map_.for_each([&cells](const detail::cell_impl &impl) { cells.push_back(&impl); });
+    auto before = [](const detail::cell_impl *a, const detail::cell_impl *b) {
+        return a->row_ < b->row_ || (a->row_ == b->row_ && a->column_ < b->column_);
+    };
+
+    if (!std::is_sorted(cells.begin(), cells.end(), before))
+    {
+        std::sort(cells.begin(), cells.end(), before);
+    }
+
+    const auto dimension = calculate_dimension(true, true);
+    const auto first_column = options.from_a1 ? constants::min_column() : dimension.top_left().column();
+    const auto last_column = dimension.bottom_right().column();
+    const auto first_row = options.from_a1 ? constants::min_row() : dimension.top_left().row();
+    const auto last_row = dimension.bottom_right().row();
+
+    // the compiled formatter of each format, looked up once per format rather than per cell
+    auto wb = d_->workbook_;
+    detail::number_formatter_cache local_formatters;
+    auto &formatters = wb->stylesheet_.is_set() ? wb->stylesheet_.get().number_formatters : local_formatters;
+    struct cell_formatter
+    {
+        const detail::number_formatter *numbers;
+        const detail::number_formatter *text;
+    };
+    std::unordered_map<const detail::format_impl *, cell_formatter> formatter_by_format;
+
+    auto formatter_of = [&](const detail::cell_impl &impl) -> const cell_formatter & {
+        const auto format = impl.format_.is_set() ? impl.format_.get() : nullptr;
+        auto match = formatter_by_format.find(format);
+
+        if (match == formatter_by_format.end())
+        {
+            const auto nf = format == nullptr ? number_format::general()
+                                              : xlnt::cell(const_cast<detail::cell_impl *>(&impl)).number_format();
+            const auto general = nf == number_format::general();
+            cell_formatter compiled{&formatters.get(nf, wb->base_date_),
+                general ? nullptr : &formatters.get(nf, calendar::windows_1900)};
+            match = formatter_by_format.emplace(format, compiled).first;
+        }
+
+        return match->second;
+    };
+
+    csv_sink sink(destination, options);
+    char number[detail::serialised_double_capacity];
+    auto current = cells.begin();
+
+    for (auto row = first_row; row <= last_row; ++row)
+    {
+        auto column = first_column;
+
+        for (; current != cells.end() && (*current)->row_ == row; ++current)
+        {
+            const auto &impl = **current;
+
+            for (; column < impl.column_; ++column)
+            {
+                if (column != first_column) sink.delimiter();
+                sink.empty_field();
+            }
+
+            if (column != first_column) sink.delimiter();
+            ++column;
+
+            switch (impl.type_)
+            {
+            case cell::type::empty:
+                sink.empty_field();
+                break;
+            case cell::type::boolean:
+                sink.field(impl.value_number() != 0.0 ? "TRUE" : "FALSE");
+                break;
+            case cell::type::date:
+            case cell::type::number:
+                if (options.formatted)
+                {
+                    sink.field(formatter_of(impl).numbers->format_number(impl.value_number()));
+                }
+                else if (impl.value_integral_)
+                {
+                    sink.field(number, detail::serialise_to(number, impl.value_integer_));
+                }
+                else
+                {
+                    sink.field(number, detail::serialise_to(number, impl.value_numeric_));
+                }
+                break;
+            case cell::type::error:
+                sink.field(impl.value_text().plain_text());
+                break;
+            case cell::type::inline_string:
+            case cell::type::shared_string:
+            case cell::type::formula_string: {
+                const auto text = xlnt::cell(const_cast<detail::cell_impl *>(&impl)).value<std::string>();
+                const auto text_formatter = options.formatted ? formatter_of(impl).text : nullptr;
+                sink.field(text_formatter == nullptr ? text : text_formatter->format_text(text));
+                break;
+            }
+            }
+        }
+
+        for (; column <= last_column; ++column)
+        {
+            if (column != first_column) sink.delimiter();
+            sink.empty_field();
+        }
+
+        sink.end_record();
+    }
+
+    sink.flush();
+}
+
+void worksheet::import_csv(std::istream &source)
+{
+    import_csv(source, csv_options());
+}
+
+void worksheet::import_csv(std::istream &source, const csv_options &options)
+{
+    auto wb = workbook();
+    const auto base_date = wb.base_date();
+    auto assign_string = make_string_assigner(wb, [](detail::cell_impl &cell, const std::string &value) {
+        return xlnt::cell(&cell).check_string(value);
+    });
+
+    // the formats given to percentages and dates, created by the first such cell
+    optional<class format> percentage_format;
+    optional<class format> date_format;
+    auto assign_formatted = [](detail::cell_impl &impl, double value, optional<class format> &format,
+                                const xlnt::number_format &number_format) {
+        assign_number(impl, value);
+        auto cell = xlnt::cell(&impl);
+
+        if (format.is_set())
+        {
+            cell.format(format.get());
+        }
+        else
+        {
+            cell.number_format(number_format);
+            format = cell.format();
+        }
+    };
+
+    csv_source records(source, options);
+    std::string value;
+    row_t row = 0;
+
+    while (records.next())
+    {
+        if (row == constants::max_row())
+        {
+            throw invalid_cell_reference(1, row + 1);
+        }
+
+        ++row;
+        const auto fields = records.fields();
+
+        if (fields > constants::max_column().index)
+        {
+            throw invalid_cell_reference(static_cast<column_t::index_t>(fields), row);
+        }
+
+        d_->cell_map_.reserve(d_->cell_map_.size() + fields, fields);
+
+        for (std::size_t i = 0; i < fields; ++i)
+        {
+            std::size_t length = 0;
+            const auto text = records.field(i, length);
+
+            if (length == 0)
+            {
+                continue;
+            }
+
+            auto &impl = emplace_cell(*d_, static_cast<column_t::index_t>(i + 1), row);
+            double number = 0;
+            bool boolean = false;
+
+            if (!options.infer_types)
+            {
+                assign_string(impl, value.assign(text, length));
+            }
+            else if (detail::deserialise_exactly(text, length, number) && std::isfinite(number))
+            {
+                // text such as nan and inf stays text as there are no such numbers in a worksheet
+                assign_number(impl, number);
+            }
+            else if (infer_boolean(text, length, boolean))
+            {
+                assign_boolean(impl, boolean);
+            }
+            else if (text[length - 1] == '%' && detail::deserialise_exactly(text, length - 1, number)
+                && std::isfinite(number))
+            {
+                assign_formatted(impl, number / 100, percentage_format, number_format::percentage());
+            }
+            else if (infer_iso_date(text, length, base_date, number))
+            {
+                assign_formatted(impl, number, date_format, number_format::date_yyyymmdd2());
+            }
+            else if ((length > 1 && (text[0] == '=' || text[0] == '#'))
+                || std::memchr(text, ':', length) != nullptr)
+            {
+                // formulas, errors and times are rare enough to infer as a single cell does
+                xlnt::cell(&impl).value(value.assign(text, length), true);
+            }
+            else
+            {
+                assign_string(impl, value.assign(text, length));
+            }
+        }
+    }
+}
+
 class header_footer worksheet::header_footer() const
 {
     return d_->header_footer_.get();
@@ -1197,7 +2515,7 @@ void worksheet::register_comments_in_manifest()
 
 void worksheet::register_calc_chain_in_manifest()
 {
-    workbook().register_workbook_part(relationship_type::calculation_chain);
+    workbook().register_workbook_part_later(relationship_type::calculation_chain);
 }
 
 bool worksheet::has_phonetic_properties() const
@@ -1265,6 +2583,195 @@ double worksheet::column_width(column_t column) const
     }
 }
 
+void worksheet::auto_fit_columns()
+{
+    auto_fit_columns(calculate_dimension(), auto_fit_options());
+}
+
+void worksheet::auto_fit_columns(const range_reference &range, const auto_fit_options &options)
+{
+    const auto first_column = range.top_left().column_index();
+    const auto last_column = range.bottom_right().column_index();
+    const auto thread_count = options.thread_count == 0 ? current_executor()->concurrency() : options.thread_count;
+
+    // state which is otherwise filled in on first access is prepared up front so that
+    // the threads only ever read
+    auto owner = workbook();
+    detail::shared_string_loader::load_all(owner);
+    d_->cell_map_.bounds();
+    auto wb = d_->workbook_;
+
+    // cells merged across columns don't widen any of them
+    std::vector<range_reference> merged;
+
+    for (const auto &merged_range : d_->merged_cells_.ranges())
+    {
+        if (merged_range.width() > 1)
+        {
+            merged.push_back(merged_range);
+        }
+    }
+
+    detail::number_formatter_cache local_formatters;
+    auto &formatters = wb->stylesheet_.is_set() ? wb->stylesheet_.get().number_formatters : local_formatters;
+    const auto default_font = wb->stylesheet_.is_set() && !wb->stylesheet_.get().fonts.empty()
+        ? wb->stylesheet_.get().fonts.front()
+        : font();
+
+    // the widest cell of each column, or a negative width for columns without cells
+    std::vector<double> widths(last_column - first_column + 1, -1.0);
+    std::mutex widths_mutex;
+
+    const auto parts = d_->cell_map_.parts(range.top_left().row(), range.bottom_right().row(),
+        thread_count == 1 ? 1 : thread_count * 4);
+    std::atomic<std::size_t> next_part(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto measure_parts = [&]() {
+        try
+        {
+            // the widths of the characters of each font and the compiled number formatters,
+            // looked up once per format rather than per cell
+            struct cell_measure
+            {
+                std::shared_ptr<detail::text_width_table> text;
+                const detail::number_formatter *numbers;
+                const detail::number_formatter *strings;
+            };
+
+            std::unordered_map<const detail::format_impl *, cell_measure> measure_by_format;
+            std::unordered_map<std::size_t, std::shared_ptr<detail::text_width_table>> tables_by_font;
+            std::shared_ptr<detail::text_width_table> default_table;
+            std::vector<double> local_widths(widths.size(), -1.0);
+            char number[detail::serialised_double_capacity];
+
+            auto measure_of = [&](const detail::cell_impl &impl) -> const cell_measure & {
+                const auto format = impl.format_.is_set() ? impl.format_.get() : nullptr;
+                auto match = measure_by_format.find(format);
+
+                if (match == measure_by_format.end())
+                {
+                    cell_measure measure{nullptr, nullptr, nullptr};
+
+                    if (format != nullptr && format->font_id.is_set())
+                    {
+                        auto &table = tables_by_font[format->font_id.get()];
+                        if (!table) table = std::make_shared<detail::text_width_table>(format->parent->fonts.at(format->font_id.get()));
+                        measure.text = table;
+                    }
+                    else
+                    {
+                        if (!default_table) default_table = std::make_shared<detail::text_width_table>(default_font);
+                        measure.text = default_table;
+                    }
+
+                    const auto nf = format == nullptr ? number_format::general()
+                                                      : xlnt::cell(const_cast<detail::cell_impl *>(&impl)).number_format();
+                    measure.numbers = &formatters.get(nf, wb->base_date_);
+                    measure.strings = nf == number_format::general() ? nullptr : &formatters.get(nf, calendar::windows_1900);
+                    match = measure_by_format.emplace(format, measure).first;
+                }
+
+                return match->second;
+            };
+
+            auto measure_cell = [&](const detail::cell_impl &impl) {
+                if (impl.column_.index < first_column || impl.column_.index > last_column || impl.type_ == cell::type::empty)
+                {
+                    return;
+                }
+
+                for (const auto &merged_range : merged)
+                {
+                    if (merged_range.contains(cell_reference(impl.column_, impl.row_))) return;
+                }
+
+                const auto &measure = measure_of(impl);
+                auto width = 0.0;
+
+                switch (impl.type_)
+                {
+                case cell::type::empty:
+                    break;
+                case cell::type::boolean:
+                    width = measure.text->measure(impl.value_number() != 0.0 ? "TRUE" : "FALSE");
+                    break;
+                case cell::type::date:
+                case cell::type::number:
+                    if (options.formatted)
+                    {
+                        width = measure.text->measure(measure.numbers->format_number(impl.value_number()));
+                    }
+                    else
+                    {
+                        const auto length = impl.value_integral_ ? detail::serialise_to(number, impl.value_integer_)
+                                                                 : detail::serialise_to(number, impl.value_numeric_);
+                        width = static_cast<double>(length) * measure.text->digit();
+                    }
+                    break;
+                case cell::type::error:
+                    width = measure.text->measure(impl.value_text().plain_text());
+                    break;
+                case cell::type::inline_string:
+                case cell::type::shared_string:
+                case cell::type::formula_string: {
+                    const auto text = xlnt::cell(const_cast<detail::cell_impl *>(&impl)).value<std::string>();
+                    const auto text_formatter = options.formatted ? measure.strings : nullptr;
+                    width = measure.text->measure(text_formatter == nullptr ? text : text_formatter->format_text(text));
+                    break;
+                }
+                }
+
+                auto &widest = local_widths[impl.column_.index - first_column];
+                widest = std::max(widest, width);
+            };
+
+            for (auto i = next_part++; i < parts.size(); i = next_part++)
+            {
+                d_->cell_map_.for_each_in(parts[i], measure_cell);
+            }
+
+            std::lock_guard<std::mutex> lock(widths_mutex);
+
+            for (std::size_t i = 0; i < widths.size(); ++i)
+            {
+                widths[i] = std::max(widths[i], local_widths[i]);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            next_part = parts.size();
+        }
+    };
+
+    detail::run_workers(std::min(thread_count, parts.size()), measure_parts);
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    for (std::size_t i = 0; i < widths.size(); ++i)
+    {
+        if (widths[i] < 0.0) continue;
+
+        // widths are stored in 1/256ths of a character, as Excel does
+        const auto width = std::trunc((widths[i] + options.padding) * 256.0) / 256.0;
+        auto &props = column_properties(column_t(static_cast<column_t::index_t>(first_column + i)));
+        props.width = std::min(options.maximum_width, std::max(options.minimum_width, width));
+        props.custom_width = true;
+        props.best_fit = true;
+    }
+}
+
 double worksheet::row_height(row_t row) const
 {
     static const auto DefaultRowHeight = 15.0;
@@ -1287,6 +2794,7 @@ void worksheet::garbage_collect_formulae()
 void worksheet::parent(xlnt::workbook &wb)
 {
     d_->parent_ = wb.d_;
+    d_->workbook_ = wb.d_.get();
 }
 
 conditional_format worksheet::conditional_format(const range_reference &ref, const condition &when)
@@ -1294,6 +2802,25 @@ conditional_format worksheet::conditional_format(const range_reference &ref, con
     return workbook().d_->stylesheet_.get().add_conditional_format_rule(d_, ref, when);
 }
 
+std::vector<conditional_format> worksheet::create_conditional_formats(
+    const std::vector<std::pair<range_reference, condition>> &rules)
+{
+    return workbook().d_->stylesheet_.get().add_conditional_format_rules(d_, rules);
+}
+
+std::vector<conditional_format> worksheet::conditional_formats(const cell_reference &reference) const
+{
+    auto &stylesheet = workbook().d_->stylesheet_.get();
+    std::vector<xlnt::conditional_format> result;
+
+    for (auto impl : stylesheet.conditional_format_ranges.find(stylesheet.conditional_format_impls, d_, reference))
+    {
+        result.push_back(xlnt::conditional_format(impl));
+    }
+
+    return result;
+}
+
 path worksheet::path() const
 {
     auto rel = referring_relationship();
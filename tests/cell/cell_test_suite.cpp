@@ -41,6 +41,7 @@
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
@@ -66,10 +67,12 @@ public:
         register_test(test_cell_formatted_as_date1);
         register_test(test_cell_formatted_as_date2);
         register_test(test_cell_formatted_as_date3);
+        register_test(test_cell_formatted_as_date4);
         register_test(test_illegal_characters);
         register_test(test_timedelta);
         register_test(test_cell_offset);
         register_test(test_font);
+        register_test(test_shared_formats);
         register_test(test_fill);
         register_test(test_border);
         register_test(test_number_format);
@@ -79,12 +82,15 @@ public:
         register_test(test_style);
         register_test(test_print);
         register_test(test_values);
+        register_test(test_integer_values);
         register_test(test_reference);
         register_test(test_anchor);
         register_test(test_hyperlink);
         register_test(test_comment);
+        register_test(test_comments_follow_cells);
         register_test(test_copy_and_compare);
         register_test(test_cell_phonetic_properties);
+        register_test(test_copy_value_with_formula_and_hyperlink);
     }
 
 private:
@@ -187,6 +193,15 @@ private:
 
         cell.value("0800");
         xlnt_assert(cell.data_type() == xlnt::cell::type::shared_string);
+
+        // moved strings are truncated and shared like copied ones
+        auto moved = std::string(40000, 'a');
+        cell.value(std::move(moved));
+        xlnt_assert_equals(cell.value<std::string>().size(), 32767);
+        ws.cell(xlnt::cell_reference(1, 2)).value(std::string(" hello "));
+        ws.cell(xlnt::cell_reference(1, 3)).value(std::string(" hello "));
+        xlnt_assert_equals(ws.cell(xlnt::cell_reference(1, 3)).value<xlnt::rich_text>().runs().front().preserve_space, true);
+        xlnt_assert_equals(wb.shared_strings().size(), 5);
     }
 
     void test_formula1()
@@ -357,6 +372,23 @@ private:
         xlnt_assert(cell.value<bool>() == true);
     }
 
+    void test_cell_formatted_as_date4()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto cell = ws.cell(xlnt::cell_reference(1, 1));
+
+        cell.value(1.5);
+        cell.number_format(xlnt::number_format("dd/mm/yyyy hh:mm"));
+        xlnt_assert(cell.is_date());
+        cell.number_format(xlnt::number_format::general());
+        xlnt_assert(!cell.is_date());
+        cell.number_format(xlnt::number_format::date_ddmmyyyy());
+        xlnt_assert(cell.is_date());
+        cell.number_format(xlnt::number_format("[h]:mm"));
+        xlnt_assert(!cell.is_date());
+    }
+
     void test_illegal_characters()
     {
         xlnt::workbook wb;
@@ -419,6 +451,35 @@ private:
         xlnt_assert_equals(cell.font(), font);
     }
 
+    void test_shared_formats()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto bold = xlnt::font().bold(true);
+        const auto red = xlnt::fill::solid(xlnt::color::red());
+
+        for (std::uint32_t row = 1; row <= 2000; ++row)
+        {
+            ws.cell(1, row).font(bold);
+            ws.cell(2, row).font(bold);
+            ws.cell(2, row).fill(red);
+        }
+
+        // the default format, bold, and bold on red
+        xlnt_assert_throws_nothing(wb.format(2));
+        xlnt_assert_throws(wb.format(3), xlnt::invalid_parameter);
+        xlnt_assert_equals(ws.cell("A2000").font(), bold);
+        xlnt_assert_equals(ws.cell("B2000").fill(), red);
+
+        xlnt::workbook loaded;
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        loaded.load(saved);
+        xlnt_assert_equals(loaded.active_sheet().cell("B1").font(), bold);
+        xlnt_assert_equals(loaded.active_sheet().cell("B1").fill(), red);
+        xlnt_assert(!loaded.active_sheet().cell("C1").has_format());
+    }
+
     void test_fill()
     {
         xlnt::workbook wb;
@@ -681,6 +742,39 @@ private:
         xlnt_assert_equals(cell.value<std::string>(), std::string(32767, 'a'));
     }
 
+    void test_integer_values()
+    {
+        // above 2^53, where doubles can't hold every integer
+        const auto id = 9007199254740993LL;
+        const auto lowest = -9223372036854775807LL - 1;
+
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value(id);
+        ws.cell("A2").value(lowest);
+        ws.cell("A3").value(18446744073709551615ULL);
+        ws.cell("A4").value(2.5);
+        xlnt_assert_equals(ws.cell("A1").value<long long>(), id);
+        xlnt_assert_equals(ws.cell("A1").value<unsigned long long>(), 9007199254740993ULL);
+        xlnt_assert_equals(ws.cell("A1").value<double>(), 9007199254740992.0);
+        xlnt_assert_equals(ws.cell("A2").value<long long>(), lowest);
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        const auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell("A1").value<long long>(), id);
+        xlnt_assert_equals(loaded_ws.cell("A2").value<long long>(), lowest);
+        xlnt_assert_equals(loaded_ws.cell("A3").value<double>(), 18446744073709551615.0);
+        xlnt_assert_equals(loaded_ws.cell("A4").value<double>(), 2.5);
+        xlnt_assert(wb.compare(loaded, false));
+
+        // copying a cell keeps all of its digits
+        ws.cell("B1").value(ws.cell("A1"));
+        xlnt_assert_equals(ws.cell("B1").value<long long>(), id);
+    }
+
     void test_reference()
     {
         xlnt::cell_reference_hash hash;
@@ -691,6 +785,12 @@ private:
 
         xlnt_assert_throws(xlnt::cell_reference("A1&"), xlnt::invalid_cell_reference);
         xlnt_assert_throws(xlnt::cell_reference("A"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("1"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("A$"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("A99999999999"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("ABCD1"), xlnt::invalid_column_index);
+        xlnt_assert_equals(xlnt::cell_reference("xfd1048576"), xlnt::cell_reference(16384, 1048576));
+        xlnt_assert_equals(xlnt::cell_reference("Ab12"), xlnt::cell_reference("AB12"));
 
         auto ref = xlnt::cell_reference("$B$7");
         xlnt_assert_equals(ref.row_absolute(), true);
@@ -706,6 +806,17 @@ private:
 
         xlnt_assert(xlnt::cell_reference("A1") == "A1");
         xlnt_assert(xlnt::cell_reference("A1") != "A2");
+
+        xlnt_assert_equals(xlnt::cell_reference("XFD1048576").to_string(), "XFD1048576");
+        xlnt_assert_equals(xlnt::cell_reference(16385, 1).to_string(), "XFE1");
+        xlnt_assert_equals(xlnt::column_t::column_string_from_index(702), "ZZ");
+        xlnt_assert_equals(xlnt::column_t::column_string_from_index(703), "AAA");
+
+        char chars[xlnt::cell_reference::max_string_length];
+        auto largest = xlnt::cell_reference(xlnt::column_t(4294967295u), 4294967295u).make_absolute();
+        const auto written = largest.to_chars(chars);
+        xlnt_assert_equals(std::string(chars, written), "$MWLQKWU$4294967295");
+        xlnt_assert_equals(written - chars, 19);
     }
 
     void test_anchor()
@@ -824,6 +935,49 @@ private:
         xlnt_assert_equals(cell.comment(), comment_with_size);
     }
 
+    void test_comments_follow_cells()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            ws.cell("C3").comment(xlnt::comment("third", "second author"));
+            ws.cell("A1").comment(xlnt::comment("first", "first author"));
+            ws.cell("B5").comment(xlnt::comment("removed", "first author"));
+            ws.cell("B5").clear_comment();
+            ws.cell("D2").comment(xlnt::comment("cleared", "first author"));
+            ws.clear_row(2);
+
+            // a cell which only holds a comment is kept
+            ws.garbage_collect();
+            xlnt_assert(ws.has_cell("C3"));
+
+            ws.insert_rows(2, 1);
+            xlnt_assert(!ws.cell("C3").has_comment());
+            xlnt_assert_equals(ws.cell("C4").comment().plain_text(), "third");
+            ws.insert_columns(1, 1);
+            xlnt_assert_equals(ws.cell("B1").comment().plain_text(), "first");
+            xlnt_assert_equals(ws.cell("D4").comment().plain_text(), "third");
+
+            auto copy = wb.clone(xlnt::workbook::clone_method::deep_copy);
+            ws.cell("D4").comment(xlnt::comment("changed", "second author"));
+            xlnt_assert_equals(copy.active_sheet().cell("D4").comment().plain_text(), "third");
+
+            std::vector<std::uint8_t> saved;
+            copy.save(saved);
+            xlnt::workbook loaded;
+            loaded.load(saved);
+            auto loaded_ws = loaded.active_sheet();
+            xlnt_assert_equals(loaded_ws.cell("B1").comment(), copy.active_sheet().cell("B1").comment());
+            xlnt_assert_equals(loaded_ws.cell("D4").comment().author(), "second author");
+            xlnt_assert(!loaded_ws.cell("B6").has_comment());
+            xlnt_assert(!loaded_ws.cell("E3").has_comment());
+        }
+    }
+
     void test_copy_and_compare()
     {
         xlnt::workbook wb;
@@ -861,6 +1015,31 @@ private:
         cell1.show_phonetics(false);
         xlnt_assert_equals(cell1.phonetics_visible(), false);
     }
+
+    void test_copy_value_with_formula_and_hyperlink()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto source = ws.cell("A1");
+        auto target = ws.cell("B1");
+
+        source.formula("=SUM(C1:C2)");
+        source.hyperlink("https://example.com/", "example");
+        target.value(source);
+        xlnt_assert_equals(target.formula(), "SUM(C1:C2)");
+        xlnt_assert_equals(target.hyperlink().url(), "https://example.com/");
+        xlnt_assert_equals(target.value<std::string>(), "example");
+
+        // copying a plain cell over clears the copied formula and hyperlink
+        target.value(ws.cell("C1"));
+        xlnt_assert(!target.has_formula());
+        xlnt_assert(!target.has_hyperlink());
+        xlnt_assert(source.has_formula());
+
+        target.error("#REF!");
+        target.clear_value();
+        xlnt_assert_equals(target.data_type(), xlnt::cell::type::empty);
+    }
 };
 
 static cell_test_suite x{};
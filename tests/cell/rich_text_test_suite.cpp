@@ -35,6 +35,9 @@ public:
     {
         register_test(test_operators);
         register_test(test_runs);
+        register_test(test_compact_runs);
+        register_test(test_hash);
+        register_test(test_run_fonts);
         register_test(test_phonetic_runs);
         register_test(test_phonetic_properties);
     }
@@ -117,6 +120,87 @@ public:
         xlnt_assert_equals(test_runs, rt.runs());
     }
 
+    void test_compact_runs()
+    {
+        // a single unformatted run compares and hashes the same however it was built
+        xlnt::rich_text plain("text");
+        xlnt::rich_text from_run;
+        from_run.add_run(xlnt::rich_text_run{"text", {}, false});
+        xlnt::rich_text from_runs;
+        from_runs.runs({xlnt::rich_text_run{"text", {}, false}});
+        xlnt_assert_equals(plain, from_run);
+        xlnt_assert_equals(plain, from_runs);
+        xlnt_assert_equals(xlnt::rich_text_hash()(plain), xlnt::rich_text_hash()(from_runs));
+        xlnt_assert(plain == std::string("text"));
+        xlnt_assert(xlnt::rich_text(std::string()) != xlnt::rich_text());
+
+        // appending to it keeps the first run
+        xlnt::rich_text_run bold{" bold", xlnt::font().bold(true), true};
+        plain.add_run(bold);
+        xlnt_assert_equals(plain.runs().size(), 2);
+        xlnt_assert_equals(plain.runs()[0], from_run.runs()[0]);
+        xlnt_assert_equals(plain.runs()[1], bold);
+        xlnt_assert_equals(plain.plain_text(), "text bold");
+        xlnt_assert_differs(plain, from_run);
+        xlnt_assert(plain != std::string("text bold"));
+
+        xlnt::rich_text formatted("text", xlnt::font().italic(true));
+        xlnt_assert_differs(formatted, from_run);
+        xlnt_assert(formatted != std::string("text"));
+    }
+
+    void test_hash()
+    {
+        const xlnt::rich_text_hash hash;
+        const xlnt::rich_text_run first{"first", xlnt::font().bold(true), false};
+        const xlnt::rich_text_run second{"second", {}, false};
+
+        xlnt::rich_text ordered;
+        ordered.runs({first, second});
+        xlnt::rich_text reordered;
+        reordered.runs({second, first});
+        xlnt::rich_text copy(ordered);
+        xlnt_assert_equals(hash(ordered), hash(copy));
+        xlnt_assert_differs(hash(ordered), hash(reordered));
+
+        // repeated runs don't cancel each other out
+        xlnt::rich_text repeated;
+        repeated.runs({second, second});
+        xlnt::rich_text other_repeated;
+        other_repeated.runs({first, first});
+        xlnt_assert_differs(hash(repeated), hash(other_repeated));
+
+        // the font takes part
+        xlnt::rich_text italic;
+        italic.runs({xlnt::rich_text_run{"first", xlnt::font().italic(true), false}, second});
+        xlnt_assert_differs(hash(ordered), hash(italic));
+    }
+
+    void test_run_fonts()
+    {
+        const auto bold = xlnt::font().bold(true).size(11).name("Calibri");
+        xlnt::rich_text original;
+        original.add_run(xlnt::rich_text_run{"bold", bold, false});
+        original.add_run(xlnt::rich_text_run{" plain", {}, true});
+
+        // copies share their fonts but changing a copy leaves the original alone
+        xlnt::rich_text copy(original);
+        xlnt_assert_equals(copy, original);
+        copy.runs({xlnt::rich_text_run{"bold", xlnt::font().italic(true), false}});
+        xlnt_assert_differs(copy, original);
+        xlnt_assert(original.runs()[0].second.is_set());
+        xlnt_assert_equals(original.runs()[0].second.get(), bold);
+        xlnt_assert(!original.runs()[1].second.is_set());
+        xlnt_assert(original.runs()[1].preserve_space);
+
+        // fonts are compared by value, not by instance
+        xlnt::rich_text separate;
+        separate.add_run(xlnt::rich_text_run{"bold", xlnt::font().bold(true).size(11).name("Calibri"), false});
+        separate.add_run(xlnt::rich_text_run{" plain", {}, true});
+        xlnt_assert_equals(separate, original);
+        xlnt_assert_equals(xlnt::rich_text_hash()(separate), xlnt::rich_text_hash()(original));
+    }
+
     void test_phonetic_runs()
     {
         xlnt::rich_text rt;
@@ -0,0 +1,140 @@
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace xlnt {
+namespace benchmarks {
+
+#if defined(__linux__)
+/// <summary>
+/// Returns the value in kB of the field of /proc/self/status with the given name in bytes.
+/// </summary>
+inline std::size_t process_status_bytes(const std::string &field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':')
+        {
+            return static_cast<std::size_t>(std::stoull(line.substr(field.size() + 1))) * 1024;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+/// <summary>
+/// Returns the memory this process has resident now in bytes, or 0 if the platform doesn't tell.
+/// </summary>
+inline std::size_t current_resident_bytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+        ? static_cast<std::size_t>(counters.WorkingSetSize)
+        : 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    return task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS
+        ? static_cast<std::size_t>(info.resident_size)
+        : 0;
+#elif defined(__linux__)
+    return process_status_bytes("VmRSS");
+#else
+    return 0;
+#endif
+}
+
+/// <summary>
+/// Returns the most memory this process has had resident since it started, or since
+/// reset_peak_resident_bytes where that is supported, in bytes. This is 0 if the
+/// platform doesn't tell.
+/// </summary>
+inline std::size_t peak_resident_bytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+        ? static_cast<std::size_t>(counters.PeakWorkingSetSize)
+        : 0;
+#elif defined(__linux__)
+    // VmHWM can be reset through clear_refs, unlike the maximum of getrusage
+    return process_status_bytes("VmHWM");
+#else
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/// <summary>
+/// Makes peak_resident_bytes start from the current usage and returns true, where the
+/// platform allows it (Linux). Elsewhere the peak stays the one of the whole process
+/// and this returns false.
+/// </summary>
+inline bool reset_peak_resident_bytes()
+{
+#if defined(__linux__)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+#else
+    return false;
+#endif
+}
+
+} // namespace benchmarks
+} // namespace xlnt
@@ -0,0 +1,170 @@
+// Copyright (c) 2014-2022 Thomas Fussell
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/cryptography/aes.hpp>
+#include <detail/utils/parallel_for.hpp>
+#include <helpers/test_suite.hpp>
+
+class aes_test_suite : public test_suite
+{
+public:
+    aes_test_suite()
+    {
+        register_test(test_ecb_known_answers);
+        register_test(test_cbc_known_answer);
+        register_test(test_round_trip_many_blocks);
+        register_test(test_segments_in_parallel);
+    }
+
+    // FIPS-197 appendix C
+    void test_ecb_known_answers()
+    {
+        const auto plaintext = bytes("00112233445566778899aabbccddeeff");
+        const std::vector<std::pair<std::size_t, std::string>> expected = {
+            {16, "69c4e0d86a7b0430d8cdb78070b4c55a"},
+            {24, "dda97ca4864cdfe06eaf70a0ec0d7191"},
+            {32, "8ea2b7ca516745bfeafc49904b496089"}};
+
+        for (const auto &answer : expected)
+        {
+            std::vector<std::uint8_t> key(answer.first);
+            for (std::size_t i = 0; i < key.size(); ++i)
+            {
+                key[i] = static_cast<std::uint8_t>(i);
+            }
+
+            xlnt_assert(xlnt::detail::aes_ecb_encrypt(plaintext, key) == bytes(answer.second));
+            xlnt_assert(xlnt::detail::aes_ecb_decrypt(bytes(answer.second), key) == plaintext);
+        }
+    }
+
+    // NIST SP 800-38A F.2.1 and F.2.2
+    void test_cbc_known_answer()
+    {
+        const auto key = bytes("2b7e151628aed2a6abf7158809cf4f3c");
+        const auto iv = bytes("000102030405060708090a0b0c0d0e0f");
+        const auto plaintext = bytes("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                                     "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+        const auto ciphertext = bytes("7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+                                      "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7");
+
+        xlnt_assert(xlnt::detail::aes_cbc_encrypt(plaintext, key, iv) == ciphertext);
+        xlnt_assert(xlnt::detail::aes_cbc_decrypt(ciphertext, key, iv) == plaintext);
+    }
+
+    void test_round_trip_many_blocks()
+    {
+        // not a multiple of the four blocks decrypted at once
+        std::vector<std::uint8_t> data(4096 + 3 * 16);
+        std::uint32_t seed = 12345;
+        for (auto &byte : data)
+        {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<std::uint8_t>(seed >> 16);
+        }
+
+        const auto key = bytes("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+        const auto iv = bytes("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+
+        const auto ecb = xlnt::detail::aes_ecb_encrypt(data, key);
+        xlnt_assert(ecb != data);
+        xlnt_assert(xlnt::detail::aes_ecb_decrypt(ecb, key) == data);
+
+        const auto cbc = xlnt::detail::aes_cbc_encrypt(data, key, iv);
+        xlnt_assert(xlnt::detail::aes_cbc_decrypt(cbc, key, iv) == data);
+
+        // each block decrypts on its own, so a block decrypted from the ECB output matches
+        const std::vector<std::uint8_t> last_block(ecb.end() - 16, ecb.end());
+        const std::vector<std::uint8_t> expected(data.end() - 16, data.end());
+        xlnt_assert(xlnt::detail::aes_ecb_decrypt(last_block, key) == expected);
+    }
+
+    void test_segments_in_parallel()
+    {
+        // segments chained separately like those of an encrypted package, the last one short
+        const auto segment_length = std::size_t(4096);
+        std::vector<std::uint8_t> data(40 * segment_length + 5 * 16);
+        for (std::size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<std::uint8_t>(i * 31 + i / 4096);
+        }
+
+        const auto key = bytes("2b7e151628aed2a6abf7158809cf4f3c");
+        const auto segments = (data.size() + segment_length - 1) / segment_length;
+        auto segment_iv = [](std::size_t i) { return std::vector<std::uint8_t>(16, static_cast<std::uint8_t>(i)); };
+
+        std::vector<std::uint8_t> expected;
+        for (std::size_t i = 0; i < segments; ++i)
+        {
+            const auto first = data.begin() + static_cast<std::ptrdiff_t>(i * segment_length);
+            const auto last = first + static_cast<std::ptrdiff_t>(std::min(segment_length, data.size() - i * segment_length));
+            const auto encrypted = xlnt::detail::aes_cbc_encrypt(std::vector<std::uint8_t>(first, last), key, segment_iv(i));
+            expected.insert(expected.end(), encrypted.begin(), encrypted.end());
+        }
+
+        std::vector<std::uint8_t> ciphertext(data.size());
+        std::vector<std::uint8_t> plaintext(data.size());
+
+        xlnt::detail::parallel_for(segments, 4, [&](std::size_t i) {
+            const auto offset = i * segment_length;
+            xlnt::detail::aes_cbc_encrypt(data.data() + offset, std::min(segment_length, data.size() - offset),
+                key, segment_iv(i).data(), ciphertext.data() + offset);
+        });
+        xlnt_assert(ciphertext == expected);
+
+        xlnt::detail::parallel_for(segments, 4, [&](std::size_t i) {
+            const auto offset = i * segment_length;
+            xlnt::detail::aes_cbc_decrypt(ciphertext.data() + offset, std::min(segment_length, data.size() - offset),
+                key, segment_iv(i).data(), plaintext.data() + offset);
+        });
+        xlnt_assert(plaintext == data);
+
+        // a failing segment is reported on the calling thread
+        xlnt_assert_throws(xlnt::detail::parallel_for(segments, 4, [&](std::size_t i) {
+            xlnt::detail::aes_ecb_decrypt(ciphertext.data(), i == 7 ? 15 : 16, key, plaintext.data());
+        }),
+            xlnt::exception);
+    }
+
+private:
+    static std::vector<std::uint8_t> bytes(const std::string &hex)
+    {
+        std::vector<std::uint8_t> result;
+
+        for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+        {
+            result.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+        }
+
+        return result;
+    }
+};
+static aes_test_suite x;
@@ -62,6 +62,13 @@ public:
         xlnt_assert(xlnt::detail::serialise(123456.789012345) == "123456.789012345");
         xlnt_assert(xlnt::detail::serialise(1.23456789012345e+67) == "1.23456789012345e+67");
         xlnt_assert(xlnt::detail::serialise(1.23456789012345e-67) == "1.23456789012345e-67");
+        // the buffer version writes the same characters, even for the longest representations
+        char buffer[xlnt::detail::serialised_double_capacity];
+        for (const double d : {-2.2250738585072014e-308, -1.7976931348623157e+308, 0.30000000000000004, -0.0})
+        {
+            xlnt_assert_equals(std::string(buffer, xlnt::detail::serialise_to(buffer, d)), xlnt::detail::serialise(d));
+            xlnt_assert_equals(xlnt::detail::deserialise(xlnt::detail::serialise(d)), d);
+        }
     }
 
     void test_float_equals_zero()
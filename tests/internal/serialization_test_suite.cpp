@@ -22,13 +22,28 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
 #include <xlnt/xlnt.hpp>
 #include <internal/locale_helpers.hpp>
 #include <helpers/path_helper.hpp>
 #include <helpers/temporary_file.hpp>
 #include <helpers/test_suite.hpp>
 #include <helpers/xml_helper.hpp>
+#include <detail/serialization/crc32.hpp>
+#include <detail/serialization/deflate_codec.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+#include <detail/serialization/sheet_data_writer.hpp>
+#include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
+#include <detail/serialization/zstream.hpp>
 #include <detail/utils/string_helpers.hpp>
 #include <xlnt/internal/features.hpp>
 
@@ -36,6 +51,78 @@
   #include <string_view>
 #endif
 
+namespace {
+
+// Appends everything written to it to a vector, like a pipe or socket it can't seek.
+class append_only_streambuf : public std::streambuf
+{
+public:
+    explicit append_only_streambuf(std::vector<std::uint8_t> &bytes)
+        : bytes_(bytes)
+    {
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            bytes_.push_back(static_cast<std::uint8_t>(c));
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        bytes_.insert(bytes_.end(), s, s + n);
+        return n;
+    }
+
+private:
+    std::vector<std::uint8_t> &bytes_;
+};
+
+// Hands out a vector a few bytes at a time, like a pipe or socket it can't seek.
+class forward_only_streambuf : public std::streambuf
+{
+public:
+    explicit forward_only_streambuf(const std::vector<std::uint8_t> &bytes)
+        : bytes_(bytes)
+    {
+    }
+
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        const auto count = std::min<std::size_t>(chunk_.size(), bytes_.size() - position_);
+
+        if (count == 0)
+        {
+            return traits_type::eof();
+        }
+
+        std::copy(bytes_.begin() + static_cast<std::ptrdiff_t>(position_),
+            bytes_.begin() + static_cast<std::ptrdiff_t>(position_ + count), chunk_.begin());
+        position_ += count;
+        setg(chunk_.data(), chunk_.data(), chunk_.data() + count);
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    const std::vector<std::uint8_t> &bytes_;
+    std::size_t position_ = 0;
+    std::array<char, 61> chunk_;
+};
+
+} // namespace
+
 class serialization_test_suite : public test_suite
 {
 public:
@@ -44,6 +131,25 @@ public:
         register_test(test_produce_empty);
         register_test(test_produce_simple_excel);
         register_test(test_save_after_sheet_deletion);
+        register_test(test_save_sparse_wide_sheet);
+        register_test(test_save_compression_levels);
+        register_test(test_save_concurrent_worksheets);
+        register_test(test_save_shared_string_count);
+        register_test(test_save_inline_strings);
+        register_test(test_save_streaming_part_order);
+        register_test(test_calculation_chain);
+        register_test(test_shared_string_escaping);
+        register_test(test_snapshot);
+        register_test(test_cached_formula_values);
+        register_test(test_save_collects_unused_styles);
+        register_test(test_save_after_cell_garbage_collection);
+        register_test(test_shared_header_footer);
+        register_test(test_save_unseekable_stream);
+        register_test(test_read_zip64_archive);
+        register_test(test_read_whole_member);
+        register_test(test_read_member_from_offset);
+        register_test(test_deflate_codec);
+        register_test(test_crc32);
         register_test(test_write_comments_hyperlinks_formulae);
         register_test(test_save_after_clear_formula);
         register_test(test_load_non_xlsx);
@@ -52,11 +158,17 @@ public:
         register_test(test_decrypt_libre_office_constructor);
         register_test(test_decrypt_standard);
         register_test(test_decrypt_numbers);
+        register_test(test_decrypt_from_streams);
         register_test(test_read_unicode_filename);
         register_test(test_write_unicode_filename);
         register_test(test_comments);
         register_test(test_read_hyperlink);
         register_test(test_read_formulae);
+        register_test(test_round_trip_formula_groups);
+        register_test(test_save_shared_formulas);
+        register_test(test_deduplicate_drawing_images);
+        register_test(test_save_deterministic);
+        register_test(test_load_projection);
         register_test(test_read_headers_and_footers);
         register_test(test_read_custom_properties);
         register_test(test_read_custom_heights_widths);
@@ -73,8 +185,26 @@ public:
         register_test(test_round_trip_rw_encrypted_libre);
         register_test(test_round_trip_rw_encrypted_standard);
         register_test(test_round_trip_rw_encrypted_numbers);
+        register_test(test_tokenize_sheet_data);
+        register_test(test_write_sheet_data);
+        register_test(test_load_fast_sheet_data);
+        register_test(test_load_xlsb);
+        register_test(test_save_xlsb);
         register_test(test_streaming_read);
+        register_test(test_streaming_read_matches_load);
+        register_test(test_streaming_read_forward_only);
+        register_test(test_streaming_prefetch);
+        register_test(test_streaming_deferred_shared_strings);
+        register_test(test_streaming_read_rows);
+        register_test(test_streaming_row_range);
+        register_test(test_streaming_read_columns);
+        register_test(test_streaming_sample_schema);
         register_test(test_streaming_write);
+        register_test(test_streaming_write_encrypted);
+        register_test(test_streaming_append_rows);
+        register_test(test_streaming_format_ids);
+        register_test(test_streaming_write_typed_rows);
+        register_test(test_streaming_concurrent_sheets);
         register_test(test_load_save_german_locale);
         register_test(test_Issue445_inline_str_load);
         register_test(test_Issue445_inline_str_streaming_read);
@@ -193,6 +323,732 @@ public:
         xlnt_assert(!temp_buffer.empty());
     }
 
+    void test_save_sparse_wide_sheet()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell(xlnt::cell_reference(1, 1)).value(1);
+        ws.cell(xlnt::cell_reference(5000, 1)).value(2);
+        ws.cell(xlnt::cell_reference(7, 3)).value("text");
+        ws.cell(xlnt::cell_reference(26, 17)); // empty, not written
+        ws.cell(xlnt::cell_reference(3000, 20)).formula("=A1");
+
+        std::vector<std::uint8_t> temp_buffer;
+        wb.save(temp_buffer);
+
+        xlnt::workbook loaded;
+        loaded.load(temp_buffer);
+        auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(5000, 1)).value<int>(), 2);
+        xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(7, 3)).value<std::string>(), "text");
+        xlnt_assert_equals(loaded_ws.cell(xlnt::cell_reference(3000, 20)).formula(), "A1");
+        xlnt_assert(!loaded_ws.has_cell(xlnt::cell_reference(26, 17)));
+
+        // spans cover every written cell in the row's 16-row block
+        xlnt_assert_equals(loaded_ws.row_properties(1).spans.get(), "1:5000");
+        xlnt_assert_equals(loaded_ws.row_properties(3).spans.get(), "1:5000");
+        xlnt_assert(!loaded_ws.has_row_properties(17));
+        xlnt_assert_equals(loaded_ws.row_properties(20).spans.get(), "3000:3000");
+    }
+
+    void test_save_concurrent_worksheets()
+    {
+        const xlnt::workbook expected(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"));
+
+        std::vector<std::uint8_t> sequential;
+        expected.save(sequential);
+
+        for (std::size_t threads : {std::size_t(2), std::size_t(16)})
+        {
+            xlnt::save_options options;
+            options.worksheet_threads = threads;
+
+            std::vector<std::uint8_t> concurrent;
+            expected.save(concurrent, options);
+            xlnt_assert(sequential == concurrent);
+        }
+    }
+
+    void test_save_shared_string_count()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+        first.cell("A1").value("a");
+        first.cell("A2").value("b");
+        first.cell("XFD1048576").value("a");
+        auto second = wb.create_sheet();
+        second.cell("B2").value("b");
+        second.cell("B3").value(1);
+
+        for (std::size_t threads : {std::size_t(1), std::size_t(2)})
+        {
+            xlnt::save_options options;
+            options.worksheet_threads = threads;
+
+            std::vector<std::uint8_t> saved;
+            wb.save(saved, options);
+
+            xlnt::detail::vector_istreambuf buffer(saved);
+            std::istream stream(&buffer);
+            xlnt::detail::izstream archive(stream);
+            const auto table = archive.read(xlnt::path("xl/sharedStrings.xml"));
+            xlnt_assert_differs(table.find("count=\"4\" uniqueCount=\"2\""), std::string::npos);
+        }
+    }
+
+    void test_save_inline_strings()
+    {
+        xlnt::workbook wb;
+        wb.string_storage(xlnt::string_storage::inline_string);
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("id-1");
+        ws.cell("B1").value(" padded & <escaped> ");
+        ws.append_row(std::vector<std::string>{"id-2", "id-3"});
+        ws.cell("A3").value(xlnt::rich_text("bold", xlnt::font().bold(true)));
+        xlnt_assert(ws.cell("A1").data_type() == xlnt::cell::type::inline_string);
+        xlnt_assert(ws.cell("B2").data_type() == xlnt::cell::type::inline_string);
+        xlnt_assert(ws.cell("A3").data_type() == xlnt::cell::type::shared_string);
+        xlnt_assert_equals(wb.shared_strings().size(), 1);
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto sheet = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+        xlnt_assert_differs(sheet.find("<c r=\"A1\" t=\"inlineStr\"><is><t>id-1</t></is></c>"), std::string::npos);
+        xlnt_assert_differs(sheet.find("<is><t xml:space=\"preserve\"> padded &amp; &lt;escaped&gt; </t></is>"), std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        xlnt_assert_equals(loaded.active_sheet().cell("B1").value<std::string>(), " padded & <escaped> ");
+        xlnt_assert_equals(loaded.active_sheet().cell("B2").value<std::string>(), "id-3");
+        xlnt_assert(loaded.active_sheet().cell("A3").value<xlnt::rich_text>().runs().front().second.get().bold());
+
+        // the setting survives clearing
+        wb.clear();
+        xlnt_assert(wb.string_storage() == xlnt::string_storage::inline_string);
+    }
+
+    void test_save_streaming_part_order()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+        first.cell("A1").value("shared");
+        first.cell("A2").value("shared");
+        first.cell("B1").formula("=1+1");
+        wb.create_sheet().cell("A1").value("other");
+
+        xlnt::save_options options;
+        options.streaming_part_order = true;
+        std::vector<std::uint8_t> saved;
+        wb.save(saved, options);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto offset = [&archive](const std::string &file) {
+            return archive.index(xlnt::path(file)).header.header_offset;
+        };
+        const auto first_sheet = offset("xl/worksheets/sheet1.xml");
+        xlnt_assert(first_sheet < offset("xl/worksheets/sheet2.xml"));
+        xlnt_assert(first_sheet < offset("xl/calcChain.xml"));
+
+        for (auto part : {"[Content_Types].xml", "_rels/.rels", "docProps/core.xml", "xl/_rels/workbook.xml.rels",
+                 "xl/workbook.xml", "xl/styles.xml", "xl/sharedStrings.xml"})
+        {
+            xlnt_assert(offset(part) < first_sheet);
+        }
+
+        // the shared strings are counted without the worksheets having been written
+        xlnt_assert_differs(archive.read(xlnt::path("xl/sharedStrings.xml")).find("count=\"3\" uniqueCount=\"2\""),
+            std::string::npos);
+
+        // so a forward-only reader inflates the sheets straight from the stream instead of keeping them
+        xlnt::load_options load;
+        load.forward_only = true;
+        forward_only_streambuf forward_buffer(saved);
+        std::istream forward_stream(&forward_buffer);
+        xlnt::streaming_workbook_reader reader;
+        reader.open(forward_stream, load);
+        reader.begin_worksheet("Sheet1");
+        xlnt_assert(reader.has_cell());
+        xlnt_assert_equals(reader.read_cell().value<std::string>(), "shared");
+        reader.end_worksheet();
+        reader.begin_worksheet("Sheet2");
+        xlnt_assert_equals(reader.read_cell().value<std::string>(), "other");
+        reader.end_worksheet();
+        xlnt_assert_throws(reader.begin_worksheet("Sheet1"), xlnt::exception);
+    }
+
+    void test_shared_string_escaping()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("a long run of text before the escapes & <tags> \"quoted\"\r");
+        ws.cell("A2").value(" leading space");
+        xlnt::rich_text rich;
+        xlnt::font bold;
+        bold.bold(true);
+        rich.add_run(xlnt::rich_text_run{"bold", bold, false});
+        rich.add_run(xlnt::rich_text_run{" & plain", {}, false});
+        ws.cell("A3").value(rich);
+        ws.cell("A4").value("after the rich text");
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto strings = archive.read(xlnt::path("xl/sharedStrings.xml"));
+        xlnt_assert_differs(strings.find("<si><t>a long run of text before the escapes &amp; &lt;tags&gt; \"quoted\"&#xD;</t></si>"
+                                         "<si><t xml:space=\"preserve\"> leading space</t></si><si><r><rPr><b/></rPr><t>bold</t></r>"),
+            std::string::npos);
+        xlnt_assert_differs(strings.find("<t> &amp; plain</t></r></si><si><t>after the rich text</t></si></sst>"), std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<std::string>(), ws.cell("A1").value<std::string>());
+        xlnt_assert_equals(loaded.active_sheet().cell("A2").value<std::string>(), " leading space");
+        xlnt_assert_equals(loaded.active_sheet().cell("A3").value<xlnt::rich_text>(), rich);
+        xlnt_assert_equals(loaded.active_sheet().cell("A4").value<std::string>(), "after the rich text");
+    }
+
+    void test_snapshot()
+    {
+        // a snapshot loads as the saved workbook does
+        for (const auto name : {"10_comments_hyperlinks_formulae.xlsx", "13_custom_heights_widths.xlsx",
+                 "15_phonetics.xlsx", "18_formulae.xlsx", "4_every_style.xlsx"})
+        {
+            const xlnt::workbook original(path_helper::test_file(name));
+            std::vector<std::uint8_t> saved;
+            original.save(saved);
+            xlnt::workbook expected;
+            expected.load(saved);
+
+            std::vector<std::uint8_t> snapshot;
+            original.save_snapshot(snapshot);
+            xlnt::workbook loaded;
+            loaded.load_snapshot(snapshot);
+            xlnt_assert(loaded.compare(expected, false));
+        }
+
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("text & <markup>");
+        ws.cell("B2").value(0.1);
+        ws.cell("C3").formula("B2*2");
+        ws.row_properties(2).height = 30.0;
+        std::vector<std::uint8_t> snapshot;
+        wb.save_snapshot(snapshot);
+        xlnt::workbook loaded;
+        loaded.load_snapshot(snapshot);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<std::string>(), "text & <markup>");
+        xlnt_assert_equals(loaded.active_sheet().cell("B2").value<double>(), 0.1);
+        xlnt_assert_equals(loaded.active_sheet().cell("C3").formula(), "B2*2");
+        xlnt_assert_equals(loaded.active_sheet().row_properties(2).height.get(), 30.0);
+
+        auto other_version = snapshot;
+        other_version[8] = 99;
+        xlnt_assert_throws(loaded.load_snapshot(other_version), xlnt::unsupported);
+
+        snapshot.pop_back();
+        xlnt_assert_throws(loaded.load_snapshot(snapshot), xlnt::exception);
+        xlnt_assert_throws(loaded.load_snapshot(std::vector<std::uint8_t>{'P', 'K'}), xlnt::exception);
+    }
+
+    void test_calculation_chain()
+    {
+        const auto chain_of = [](const std::vector<std::uint8_t> &saved) {
+            xlnt::detail::vector_istreambuf buffer(saved);
+            std::istream stream(&buffer);
+            xlnt::detail::izstream archive(stream);
+            return archive.has_file(xlnt::path("xl/calcChain.xml")) ? archive.read(xlnt::path("xl/calcChain.xml")) : std::string();
+        };
+
+        // the chain read with a file is kept, without the cells which lost their formulas
+        // and the members of array formulas, which have no formula element
+        xlnt::workbook loaded(path_helper::test_file("18_formulae.xlsx"));
+        loaded.active_sheet().cell("D1").clear_formula();
+        std::vector<std::uint8_t> saved;
+        loaded.save(saved);
+        auto chain = chain_of(saved);
+        xlnt_assert_equals(chain.find("r=\"D1\""), std::string::npos);
+        xlnt_assert_differs(chain.find("<c r=\"F2\" i=\"1\"/><c r=\"F3\"/>"), std::string::npos);
+        xlnt_assert_differs(chain.find("<c r=\"D2\"/><c r=\"G1\" a=\"1\"/></calcChain>"), std::string::npos);
+
+        // a calculated workbook lists its formulas in the order they were evaluated in
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto other = wb.create_sheet();
+        ws.cell("A1").value(1);
+        ws.cell("B1").formula("C1+Sheet2!A1");
+        ws.cell("C1").formula("A1*2");
+        other.cell("A1").formula("Sheet1!A1+1");
+        wb.save(saved);
+        xlnt_assert_differs(chain_of(saved).find("<c r=\"B1\" i=\"1\"/><c r=\"C1\"/><c r=\"A1\" i=\"2\"/>"), std::string::npos);
+        wb.calculate();
+        wb.save(saved);
+        chain = chain_of(saved);
+        xlnt_assert_differs(chain.find("<c r=\"C1\" i=\"1\"/><c r=\"A1\" i=\"2\"/><c r=\"B1\" i=\"1\" l=\"1\"/>"), std::string::npos);
+
+        // and a formula added since is appended
+        ws.cell("D1").formula("B1");
+        wb.save(saved);
+        chain = chain_of(saved);
+        xlnt_assert_differs(chain.find("l=\"1\"/><c r=\"D1\"/></calcChain>"), std::string::npos);
+    }
+
+    void test_cached_formula_values()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").formula("=1+1", 2);
+        ws.cell("A2").formula("=\"a\"&\"b\"", "ab");
+        ws.cell("A3").formula("=1<2", true);
+        ws.cell("A4").value(xlnt::rich_text("rich"));
+        ws.cell("A4").formula("=\"rich\"");
+        ws.cell("A5").value("=A1", true);
+        xlnt_assert(ws.cell("A2").data_type() == xlnt::cell::type::formula_string);
+        xlnt_assert(!ws.cell("A5").has_value());
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        // strings are only read as the results of formulas as "str" values
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto sheet = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+        xlnt_assert_differs(sheet.find("<c r=\"A1\"><f>1+1</f><v>2</v></c>"), std::string::npos);
+        xlnt_assert_differs(sheet.find("<c r=\"A2\" t=\"str\"><f>\"a\"&amp;\"b\"</f><v>ab</v></c>"), std::string::npos);
+        xlnt_assert_differs(sheet.find("<c r=\"A4\" t=\"str\"><f>\"rich\"</f><v>rich</v></c>"), std::string::npos);
+        xlnt_assert_differs(sheet.find("<c r=\"A5\"><f>A1</f></c>"), std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell("A1").formula(), "1+1");
+        xlnt_assert_equals(loaded_ws.cell("A1").value<int>(), 2);
+        xlnt_assert_equals(loaded_ws.cell("A2").value<std::string>(), "ab");
+        xlnt_assert(loaded_ws.cell("A3").value<bool>());
+        xlnt_assert_equals(loaded_ws.cell("A4").value<std::string>(), "rich");
+    }
+
+    void test_save_collects_unused_styles()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto bold = xlnt::font().bold(true);
+
+        for (std::uint32_t row = 1; row <= 500; ++row)
+        {
+            ws.cell(1, row).font(xlnt::font().size(8 + row));
+        }
+
+        for (std::uint32_t row = 1; row <= 500; ++row)
+        {
+            ws.cell(1, row).font(bold);
+        }
+
+        ws.cell("B1").style(wb.create_style("heading").font(xlnt::font().size(20)));
+        wb.style("heading").font(xlnt::font().size(24));
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto styles = archive.read(xlnt::path("xl/styles.xml"));
+        // the default font, bold, the heading's current font and the one B1 got from it
+        xlnt_assert_differs(styles.find("<fonts count=\"4\""), std::string::npos);
+        xlnt_assert_differs(styles.find("<cellXfs count=\"3\""), std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        xlnt_assert_equals(loaded.active_sheet().cell("A500").font(), bold);
+        xlnt_assert_equals(loaded.style("heading").font().size(), 24.);
+    }
+
+    void test_save_after_cell_garbage_collection()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value(1);
+        ws.cell("B2").value(2);
+        ws.cell("C3");
+        ws.garbage_collect();
+        xlnt_assert(!ws.has_cell("C3"));
+
+        // cells emptied or created after collecting are still left out
+        ws.cell("A1").clear_value();
+        ws.cell("E5");
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto sheet = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+        xlnt_assert_differs(sheet.find("r=\"B2\""), std::string::npos);
+        xlnt_assert_equals(sheet.find("r=\"A1\""), std::string::npos);
+        xlnt_assert_equals(sheet.find("r=\"E5\""), std::string::npos);
+    }
+
+    void test_shared_header_footer()
+    {
+        using hf_loc = xlnt::header_footer::location;
+        xlnt::header_footer shared;
+        shared.header(hf_loc::center, xlnt::rich_text("Report", xlnt::font().bold(true).size(14)));
+        shared.footer(hf_loc::right, "Confidential");
+        xlnt::header_footer other;
+        other.odd_even_header(hf_loc::left, xlnt::rich_text("odd"), xlnt::rich_text("even"));
+
+        xlnt::workbook wb;
+        wb.active_sheet().header_footer(shared);
+        for (int i = 0; i < 5; ++i)
+        {
+            wb.create_sheet().header_footer(i == 2 ? other : shared);
+        }
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        for (std::size_t threads : {std::size_t(1), std::size_t(3)})
+        {
+            xlnt::load_options options;
+            options.worksheet_threads = threads;
+            xlnt::workbook loaded;
+            loaded.load(saved, options);
+
+            for (std::size_t i = 0; i < loaded.sheet_count(); ++i)
+            {
+                const auto hf = loaded.sheet_by_index(i).header_footer();
+                xlnt_assert_equals(hf.has_header(hf_loc::center), i != 3);
+                xlnt_assert_equals(hf.has_header(hf_loc::left), i == 3);
+            }
+
+            const auto hf = loaded.sheet_by_index(5).header_footer();
+            xlnt_assert_equals(hf.header(hf_loc::center).plain_text(), "Report");
+            xlnt_assert(hf.header(hf_loc::center).runs().front().second.get().bold());
+            xlnt_assert_equals(hf.footer(hf_loc::right), "Confidential");
+            // differentOddEven isn't written, so only the odd header comes back
+            xlnt_assert_equals(loaded.sheet_by_index(3).header_footer().header(hf_loc::left), "odd");
+        }
+    }
+
+    void test_save_unseekable_stream()
+    {
+        const xlnt::workbook expected(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"));
+
+        std::vector<std::uint8_t> saved;
+        append_only_streambuf buffer(saved);
+        std::ostream stream(&buffer);
+        xlnt_assert_equals(stream.tellp(), std::streampos(-1));
+        expected.save(stream);
+
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        xlnt_assert(expected.compare(loaded, false));
+    }
+
+    void test_read_zip64_archive()
+    {
+        // a stored member whose sizes and offset are only given by zip64 records,
+        // as written for members and archives larger than 4 GiB
+        std::vector<std::uint8_t> archive;
+        auto append = [&archive](std::uint64_t value, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                archive.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        };
+        auto append_text = [&archive](const std::string &text) {
+            archive.insert(archive.end(), text.begin(), text.end());
+        };
+
+        append(0x04034b50, 4); // local header
+        append(45, 2);
+        append(0x0008, 2); // sizes in the data descriptor
+        append(0, 2); // stored
+        append(0, 4); // time and date
+        append(0, 4); // crc
+        append(0, 8); // sizes
+        append(5, 2);
+        append(0, 2);
+        append_text("a.txt");
+        append_text("abc");
+        append(0x08074b50, 4); // data descriptor
+        append(0x352441c2, 4);
+        append(3, 8);
+        append(3, 8);
+
+        const auto central_start = archive.size();
+        append(0x02014b50, 4); // central header
+        append(45, 2);
+        append(45, 2);
+        append(0x0008, 2);
+        append(0, 2);
+        append(0, 4);
+        append(0x352441c2, 4);
+        append(0xffffffff, 4);
+        append(0xffffffff, 4);
+        append(5, 2);
+        append(28, 2); // extra length
+        append(0, 2); // comment length
+        append(0, 2); // disk
+        append(0, 2); // internal attributes
+        append(0, 4); // external attributes
+        append(0xffffffff, 4); // offset
+        append_text("a.txt");
+        append(0x0001, 2); // zip64 extra field
+        append(24, 2);
+        append(3, 8); // uncompressed size
+        append(3, 8); // compressed size
+        append(0, 8); // offset
+
+        const auto central_end = archive.size();
+        append(0x06064b50, 4); // zip64 end of central directory
+        append(44, 8);
+        append(45, 2);
+        append(45, 2);
+        append(0, 4);
+        append(0, 4);
+        append(1, 8);
+        append(1, 8);
+        append(central_end - central_start, 8);
+        append(central_start, 8);
+        append(0x07064b50, 4); // zip64 end of central directory locator
+        append(0, 4);
+        append(central_end, 8);
+        append(1, 4);
+        append(0x06054b50, 4); // end of central directory
+        append(0, 2);
+        append(0, 2);
+        append(0xffff, 2);
+        append(0xffff, 2);
+        append(0xffffffff, 4);
+        append(0xffffffff, 4);
+        append(0, 2);
+
+        xlnt::detail::vector_istreambuf buffer(archive);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream from_stream(stream);
+        xlnt_assert_equals(from_stream.files().size(), 1);
+        xlnt_assert_equals(from_stream.read(xlnt::path("a.txt")), "abc");
+
+        xlnt::detail::memory_istreambuf memory(archive.data(), archive.size());
+        std::istream memory_stream(&memory);
+        xlnt::detail::izstream from_memory(memory_stream);
+        xlnt_assert_equals(from_memory.read(xlnt::path("a.txt")), "abc");
+    }
+
+    void test_read_whole_member()
+    {
+        const std::string small = "<workbook/>";
+        std::string large;
+        while (large.size() <= xlnt::detail::izstream::whole_inflate_limit)
+        {
+            large.append("<row r=\"" + std::to_string(large.size()) + "\"/>");
+        }
+
+        std::vector<std::uint8_t> archive;
+        {
+            xlnt::detail::vector_ostreambuf buffer(archive);
+            std::ostream stream(&buffer);
+            xlnt::detail::ozstream writer(stream);
+            std::ostream(writer.open(xlnt::path("small.xml")).get()) << small;
+            std::ostream(writer.open(xlnt::path("large.xml")).get()) << large;
+            writer.open(xlnt::path("empty.xml"));
+        }
+
+        auto read_all = [](std::streambuf *buffer) {
+            std::ostringstream contents;
+            contents << buffer;
+            return contents.str();
+        };
+
+        xlnt::detail::vector_istreambuf buffer(archive);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream from_stream(stream);
+        xlnt::detail::memory_istreambuf memory(archive.data(), archive.size());
+        std::istream memory_stream(&memory);
+        xlnt::detail::izstream from_memory(memory_stream);
+
+        for (auto reader : {&from_stream, &from_memory})
+        {
+            xlnt_assert_equals(reader->read(xlnt::path("small.xml")), small);
+            xlnt_assert(reader->read(xlnt::path("large.xml")) == large);
+            xlnt_assert_equals(reader->read(xlnt::path("empty.xml")), "");
+            xlnt_assert_equals(read_all(reader->open(xlnt::path("small.xml")).get()), small);
+            xlnt_assert(read_all(reader->open(xlnt::path("large.xml")).get()) == large);
+        }
+    }
+
+    void test_read_member_from_offset()
+    {
+        std::string rows;
+        for (int i = 0; rows.size() < 200000; ++i)
+        {
+            rows.append("<row r=\"" + std::to_string(i) + "\"><c><v>" + std::to_string(i * 7 % 1000) + "</v></c></row>");
+        }
+
+        for (auto compression : {xlnt::compression_level::standard, xlnt::compression_level::none})
+        {
+            std::vector<std::uint8_t> archive;
+            {
+                xlnt::detail::vector_ostreambuf buffer(archive);
+                std::ostream stream(&buffer);
+                xlnt::detail::ozstream writer(stream, compression);
+                std::ostream(writer.open(xlnt::path("sheet1.xml")).get()) << rows;
+            }
+
+            xlnt::detail::vector_istreambuf buffer(archive);
+            std::istream stream(&buffer);
+            xlnt::detail::izstream from_stream(stream);
+            xlnt::detail::memory_istreambuf memory(archive.data(), archive.size());
+            std::istream memory_stream(&memory);
+            xlnt::detail::izstream from_memory(memory_stream);
+
+            for (auto reader : {&from_stream, &from_memory})
+            {
+                const auto index = reader->index(xlnt::path("sheet1.xml"), 16 * 1024);
+                xlnt_assert_equals(index.header.uncompressed_size, rows.size());
+
+                if (compression != xlnt::compression_level::none
+                    && std::string(xlnt::detail::deflate_backend()) != "isa-l")
+                {
+                    xlnt_assert_equals(index.checkpoints.size(), rows.size() / (16 * 1024));
+                }
+
+                for (std::uint64_t offset : {std::uint64_t(0), std::uint64_t(100), std::uint64_t(16 * 1024),
+                         std::uint64_t(100000), std::uint64_t(rows.size() - 5), std::uint64_t(rows.size())})
+                {
+                    std::ostringstream contents;
+                    auto member = reader->open(index, offset);
+                    if (offset < rows.size())
+                    {
+                        contents << member.get();
+                    }
+                    xlnt_assert(contents.str() == rows.substr(static_cast<std::size_t>(offset)));
+                }
+
+                xlnt_assert_throws(reader->open(index, rows.size() + 1), xlnt::exception);
+            }
+        }
+    }
+
+    void test_deflate_codec()
+    {
+        std::string text;
+        for (int i = 0; i < 20000; ++i)
+        {
+            text.append("row " + std::to_string(i % 97) + ";");
+        }
+
+        auto deflate_stream = xlnt::detail::make_deflater(xlnt::compression_level::standard);
+        std::vector<std::uint8_t> compressed(text.size() + 1024);
+        auto next_in = reinterpret_cast<const std::uint8_t *>(text.data());
+        auto avail_in = text.size();
+        auto next_out = compressed.data();
+        auto avail_out = compressed.size();
+        xlnt_assert(deflate_stream->process(next_in, avail_in, next_out, avail_out, true));
+        xlnt_assert_equals(avail_in, 0);
+        compressed.resize(compressed.size() - avail_out);
+        xlnt_assert(compressed.size() < text.size() / 4);
+
+        auto inflate_stream = xlnt::detail::make_inflater();
+        std::vector<std::uint8_t> inflated(text.size());
+        next_in = compressed.data();
+        avail_in = compressed.size();
+        next_out = inflated.data();
+        avail_out = inflated.size();
+        xlnt_assert(inflate_stream->process(next_in, avail_in, next_out, avail_out));
+        xlnt_assert_equals(avail_out, 0);
+        xlnt_assert(std::string(inflated.begin(), inflated.end()) == text);
+
+        const std::uint8_t abc[] = {'a', 'b', 'c'};
+        xlnt_assert_equals(xlnt::detail::update_crc32(0, abc, 3), 0x352441c2u);
+    }
+
+    void test_crc32()
+    {
+        // bit by bit, see APPNOTE.TXT 4.4.7
+        auto reference = [](std::uint32_t crc, const std::uint8_t *data, std::size_t size) {
+            crc = ~crc;
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                crc ^= data[i];
+
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0xEDB88320u : 0u);
+                }
+            }
+
+            return ~crc;
+        };
+
+        std::vector<std::uint8_t> data(64 * 1024 + 17);
+        std::uint32_t state = 1;
+
+        for (auto &byte : data)
+        {
+            state = state * 1103515245u + 12345u;
+            byte = static_cast<std::uint8_t>(state >> 24);
+        }
+
+        // every alignment and every length around the 16 and 64 byte blocks the folding uses
+        for (std::size_t offset = 0; offset < 16; ++offset)
+        {
+            for (std::size_t size = 0; size < 300; ++size)
+            {
+                xlnt_assert_equals(xlnt::detail::compute_crc32(0x12345678u, data.data() + offset, size),
+                    reference(0x12345678u, data.data() + offset, size));
+            }
+        }
+
+        const auto whole = reference(0, data.data(), data.size());
+        xlnt_assert_equals(xlnt::detail::compute_crc32(0, data.data(), data.size()), whole);
+        xlnt_assert_equals(xlnt::detail::update_crc32(0, data.data(), data.size()), whole);
+
+        // continuing from the CRC of a part gives that of the whole
+        const auto first = xlnt::detail::compute_crc32(0, data.data(), 1000);
+        xlnt_assert_equals(xlnt::detail::compute_crc32(first, data.data() + 1000, data.size() - 1000), whole);
+
+        const std::string implementation = xlnt::detail::crc32_implementation();
+        xlnt_assert(implementation == "pclmul" || implementation == "armv8" || implementation == "table");
+    }
+
+    void test_save_compression_levels()
+    {
+        const xlnt::workbook expected(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"));
+        std::vector<std::size_t> sizes;
+
+        for (auto level : {xlnt::compression_level::none, xlnt::compression_level::fastest,
+                 xlnt::compression_level::standard, xlnt::compression_level::best})
+        {
+            xlnt::save_options options;
+            options.compression = level;
+
+            std::vector<std::uint8_t> temp_buffer;
+            expected.save(temp_buffer, options);
+            sizes.push_back(temp_buffer.size());
+
+            xlnt::workbook loaded;
+            loaded.load(temp_buffer);
+            xlnt_assert(expected.compare(loaded, false));
+        }
+
+        xlnt_assert(sizes[0] > sizes[1]);
+        xlnt_assert(sizes[1] >= sizes[3]);
+        xlnt_assert(sizes[2] >= sizes[3]);
+    }
+
     void test_write_comments_hyperlinks_formulae()
     {
         xlnt::workbook wb;
@@ -297,34 +1153,289 @@ public:
         xlnt_assert(workbook_matches_file(wb, path));
     }
 
-    void test_save_after_clear_formula()
+    void test_round_trip_formula_groups()
     {
         xlnt::workbook wb;
-        const auto path = path_helper::test_file("18_formulae.xlsx");
-        wb.load(path);
+        wb.load(path_helper::test_file("18_formulae.xlsx"));
+        auto ws = wb.sheet_by_index(0);
 
-        auto ws1 = wb.sheet_by_index(0);
-        for (auto row : ws1)
-        {
-            for (auto cell : row)
+        // the cells of a group all report the text of its master cell
+        xlnt_assert_equals(ws.cell("F3").formula(), "1+1");
+        xlnt_assert_equals(ws.cell("F4").formula(), "1+1");
+        xlnt_assert_equals(ws.cell("G3").formula(), "PI()");
+
+        ws.cell("F4").formula("2+2");
+        xlnt_assert_equals(ws.cell("F3").formula(), "1+1");
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto sheet = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+
+        auto count = [&sheet](const std::string &text) {
+            auto n = 0;
+            for (auto at = sheet.find(text); at != std::string::npos; at = sheet.find(text, at + 1))
             {
-                cell.clear_formula();
+                ++n;
             }
-        }
+            return n;
+        };
 
-        wb.save("clear_formulae.xlsx");
+        xlnt_assert_equals(count("<f t=\"shared\" ref=\"F2:F3\" si=\"0\">1+1</f>"), 1);
+        xlnt_assert_equals(count("t=\"shared\""), 2);
+        xlnt_assert_equals(count("<f>2+2</f>"), 1);
+        xlnt_assert_equals(count("<f t=\"array\" ref=\"G1:G3\">PI()</f>"), 1);
+        xlnt_assert_equals(count("PI()"), 1);
+
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        auto reloaded_ws = reloaded.sheet_by_index(0);
+        xlnt_assert_equals(reloaded_ws.cell("F3").formula(), "1+1");
+        xlnt_assert_equals(reloaded_ws.cell("F4").formula(), "2+2");
+        xlnt_assert_equals(reloaded_ws.cell("G2").formula(), "PI()");
     }
 
-    void test_load_non_xlsx()
+    void test_save_shared_formulas()
     {
         xlnt::workbook wb;
-        const auto path = path_helper::test_file("1_powerpoint_presentation.xlsx");
-        xlnt_assert_throws(wb.load(path), xlnt::invalid_file);
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 2; row <= 6; ++row)
+        {
+            const auto r = std::to_string(row);
+            ws.cell("A" + r).value(static_cast<int>(row));
+            ws.cell("B" + r).formula("=A" + r + "*$A$2+SUM(A$2:A" + r + ")");
+            ws.cell("C" + r).formula("=\"A" + r + "\"&A" + r);
+            ws.cell("D" + r).formula("=SUM(1:" + r + ")");
+        }
+
+        // breaks the run of column B in two
+        ws.cell("B4").formula("=A4+1");
+
+        xlnt::save_options options;
+        options.share_formulas = true;
+        std::vector<std::uint8_t> saved;
+        wb.save(saved, options);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        const auto sheet = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+
+        auto count = [&sheet](const std::string &text) {
+            auto n = 0;
+            for (auto at = sheet.find(text); at != std::string::npos; at = sheet.find(text, at + 1))
+            {
+                ++n;
+            }
+            return n;
+        };
+
+        xlnt_assert_equals(count("<f t=\"shared\" ref=\"B2:B3\" si=\"0\">A2*$A$2+SUM(A$2:A2)</f>"), 1);
+        xlnt_assert_equals(count("<f>A4+1</f>"), 1);
+        xlnt_assert_equals(count("<f t=\"shared\" ref=\"B5:B6\" si=\"1\">A5*$A$2+SUM(A$2:A5)</f>"), 1);
+        // the string literal isn't a reference, so each of these formulas differs
+        xlnt_assert_equals(count("<f>\"A3\"&amp;A3</f>"), 1);
+        xlnt_assert_equals(count("<f>SUM(1:4)</f>"), 1);
+        xlnt_assert_equals(count("t=\"shared\""), 4);
+
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        auto reloaded_ws = reloaded.active_sheet();
+        xlnt_assert_equals(reloaded_ws.cell("B3").formula(), "A2*$A$2+SUM(A$2:A2)");
+        xlnt_assert_equals(reloaded_ws.cell("B4").formula(), "A4+1");
+        xlnt_assert_equals(reloaded_ws.cell("C5").formula(), "\"A5\"&A5");
     }
 
-    void test_decrypt_agile()
+    void test_deduplicate_drawing_images()
     {
-        xlnt::workbook wb;
+        // 14_images.xlsx with a second worksheet whose drawing shows a copy of the image
+        std::ifstream file(path_helper::test_file("14_images.xlsx").string(), std::ios::binary);
+        xlnt::detail::izstream source(file);
+
+        auto replace = [](std::string text, const std::string &from, const std::string &to) {
+            return text.replace(text.find(from), from.size(), to);
+        };
+
+        std::vector<std::pair<std::string, std::string>> parts;
+        for (const auto &part : source.files())
+        {
+            parts.emplace_back(part.string(), source.read(part));
+        }
+
+        auto part = [&parts](const std::string &name) -> std::string & {
+            return std::find_if(parts.begin(), parts.end(), [&name](const std::pair<std::string, std::string> &p) {
+                return p.first == name;
+            })->second;
+        };
+
+        const auto image = part("xl/media/image1.jpg");
+        part("xl/workbook.xml") = replace(part("xl/workbook.xml"), "</sheets>", "<sheet name=\"2\" sheetId=\"2\" r:id=\"rId4\"/></sheets>");
+        part("xl/_rels/workbook.xml.rels") = replace(part("xl/_rels/workbook.xml.rels"), "</Relationships>",
+            "<Relationship Id=\"rId4\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet2.xml\"/></Relationships>");
+        part("[Content_Types].xml") = replace(part("[Content_Types].xml"), "</Types>",
+            "<Override PartName=\"/xl/worksheets/sheet2.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+            "<Override PartName=\"/xl/drawings/drawing2.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.drawing+xml\"/></Types>");
+        parts.emplace_back("xl/worksheets/sheet2.xml", part("xl/worksheets/sheet1.xml"));
+        parts.emplace_back("xl/worksheets/_rels/sheet2.xml.rels", replace(part("xl/worksheets/_rels/sheet1.xml.rels"), "drawing1", "drawing2"));
+        parts.emplace_back("xl/drawings/drawing2.xml", part("xl/drawings/drawing1.xml"));
+        parts.emplace_back("xl/drawings/_rels/drawing2.xml.rels", replace(part("xl/drawings/_rels/drawing1.xml.rels"), "image1", "image2"));
+        parts.emplace_back("xl/media/image2.jpg", image);
+
+        std::vector<std::uint8_t> archive;
+        {
+            xlnt::detail::vector_ostreambuf buffer(archive);
+            std::ostream stream(&buffer);
+            xlnt::detail::ozstream writer(stream);
+
+            for (const auto &p : parts)
+            {
+                std::ostream(writer.open(xlnt::path(p.first)).get()) << p.second;
+            }
+        }
+
+        for (const auto lazy : {false, true})
+        {
+            xlnt::load_options options;
+            options.lazy_binaries = lazy;
+            xlnt::workbook wb;
+            wb.load(archive, options);
+            xlnt_assert(wb.sheet_by_index(1).has_drawing());
+
+            std::vector<std::uint8_t> saved;
+            wb.save(saved);
+
+            xlnt::detail::vector_istreambuf saved_buffer(saved);
+            std::istream saved_stream(&saved_buffer);
+            xlnt::detail::izstream saved_archive(saved_stream);
+
+            xlnt_assert(!saved_archive.has_file(xlnt::path("xl/media/image2.jpg")));
+            xlnt_assert(saved_archive.read(xlnt::path("xl/drawings/_rels/drawing2.xml.rels")).find("../media/image1.jpg") != std::string::npos);
+            xlnt_assert(saved_archive.read(xlnt::path("xl/media/image1.jpg")) == image);
+
+            // JPEG files aren't deflated again, unless they are copied as they were loaded
+            const auto stored = saved_archive.read_compressed(xlnt::path("xl/media/image1.jpg")).header.compression_type == 0;
+            xlnt_assert_equals(stored, !lazy);
+
+            xlnt::workbook reloaded;
+            reloaded.load(saved);
+            xlnt_assert(reloaded.sheet_by_index(1).has_drawing());
+        }
+    }
+
+    void test_save_deterministic()
+    {
+        xlnt::load_options load;
+        load.lazy_binaries = true;
+        xlnt::workbook wb;
+        wb.load(path_helper::test_file("14_images.xlsx"), load);
+        for (const auto name : {"delta", "alpha", "charlie", "bravo"})
+        {
+            wb.active_sheet().create_named_range(name, "A1:B2");
+        }
+
+        xlnt::save_options options;
+        options.deterministic = true;
+
+        auto save = [&options](const xlnt::workbook &source) {
+            std::vector<std::uint8_t> saved;
+            source.save(saved, options);
+            return saved;
+        };
+
+        const auto saved = save(wb);
+        xlnt_assert(saved == save(xlnt::workbook(wb)));
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+
+        // the image is copied as it was compressed, but not with its time stamp
+        const auto image = archive.read_compressed(xlnt::path("xl/media/image1.jpg"));
+        xlnt_assert_equals(image.header.stamp_date, 0);
+        xlnt_assert_equals(image.header.stamp_time, 0);
+
+        const auto content_types = archive.read(xlnt::path("[Content_Types].xml"));
+        xlnt_assert(content_types.find("Extension=\"jpg\"") < content_types.find("Extension=\"rels\""));
+        xlnt_assert(content_types.find("/docProps/app.xml") < content_types.find("/xl/workbook.xml"));
+
+        const auto workbook_part = archive.read(xlnt::path("xl/workbook.xml"));
+        xlnt_assert(workbook_part.find("\"alpha\"") < workbook_part.find("\"bravo\""));
+        xlnt_assert(workbook_part.find("\"charlie\"") < workbook_part.find("\"delta\""));
+    }
+
+    void test_load_projection()
+    {
+        xlnt::load_options options;
+        options.rows = std::make_pair(xlnt::row_t(3), xlnt::row_t(4));
+        options.columns = std::make_pair(xlnt::column_t("F"), xlnt::column_t("G"));
+
+        xlnt::workbook wb;
+        wb.load(path_helper::test_file("18_formulae.xlsx"), options);
+        auto ws = wb.sheet_by_index(0);
+
+        xlnt_assert(!ws.has_cell("F2"));
+        xlnt_assert(!ws.has_cell("G1"));
+        xlnt_assert(!ws.has_cell("E3"));
+        // cells inside the projection keep the formula of a group whose master is outside it
+        xlnt_assert_equals(ws.cell("F3").formula(), "1+1");
+        xlnt_assert_equals(ws.cell("G3").formula(), "PI()");
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(path_helper::test_file("18_formulae.xlsx"), options);
+        reader.begin_worksheet(reader.sheet_titles().front());
+        while (reader.has_cell())
+        {
+            const auto cell = reader.read_cell();
+            xlnt_assert(cell.row() >= 3 && cell.row() <= 4);
+            xlnt_assert(cell.column() >= xlnt::column_t("F") && cell.column() <= xlnt::column_t("G"));
+        }
+        reader.end_worksheet();
+
+        xlnt::load_options sheets;
+        sheets.sheets.push_back("Sheet2");
+        xlnt::workbook projected;
+        projected.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), sheets);
+        xlnt_assert_equals(projected.sheet_count(), 2);
+        xlnt_assert(!projected.sheet_by_title("Sheet1").has_cell("A1"));
+        xlnt_assert(projected.sheet_by_title("Sheet2").has_cell("A1"));
+
+        reader.open(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), sheets);
+        xlnt_assert_equals(reader.sheet_titles(), std::vector<std::string>{"Sheet2"});
+        xlnt_assert(!reader.has_worksheet("Sheet1"));
+    }
+
+    void test_save_after_clear_formula()
+    {
+        xlnt::workbook wb;
+        const auto path = path_helper::test_file("18_formulae.xlsx");
+        wb.load(path);
+
+        auto ws1 = wb.sheet_by_index(0);
+        for (auto row : ws1)
+        {
+            for (auto cell : row)
+            {
+                cell.clear_formula();
+            }
+        }
+
+        wb.save("clear_formulae.xlsx");
+    }
+
+    void test_load_non_xlsx()
+    {
+        xlnt::workbook wb;
+        const auto path = path_helper::test_file("1_powerpoint_presentation.xlsx");
+        xlnt_assert_throws(wb.load(path), xlnt::invalid_file);
+    }
+
+    void test_decrypt_agile()
+    {
+        xlnt::workbook wb;
         const auto path = path_helper::test_file("5_encrypted_agile.xlsx");
         xlnt_assert_throws(wb.load(path, "incorrect"), xlnt::exception);
         xlnt_assert_throws_nothing(wb.load(path, "secret"));
@@ -361,6 +1472,28 @@ public:
         xlnt_assert_throws_nothing(wb.load(path, "secret"));
     }
 
+    void test_decrypt_from_streams()
+    {
+        const auto path = path_helper::test_file("5_encrypted_agile.xlsx");
+        const xlnt::workbook expected(path, "secret");
+
+        std::ifstream file(path.string(), std::ios::binary);
+        const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        // decrypted while the archive is read
+        std::istringstream stream(bytes);
+        xlnt::workbook streamed;
+        streamed.load(stream, "secret");
+        xlnt_assert(expected.compare(streamed, false));
+
+        // a stream which doesn't start at the file is copied first
+        std::istringstream prefixed("junk" + bytes);
+        prefixed.ignore(4);
+        xlnt::workbook copied;
+        copied.load(prefixed, "secret");
+        xlnt_assert(expected.compare(copied, false));
+    }
+
     void test_read_unicode_filename()
     {
 #ifdef _MSC_VER
@@ -720,6 +1853,677 @@ public:
         xlnt_assert(round_trip_matches_rw(path_helper::test_file("8_encrypted_numbers.xlsx"), "secret"));
     }
 
+    void test_tokenize_sheet_data()
+    {
+        const std::string part = "<?xml version=\"1.0\"?><x:worksheet xmlns:x=\"ns\"><x:sheetData>"
+            "<x:row r=\"2\" spans=\"1:3\" ht=\"20.5\" customHeight=\"1\"><!-- comment -->"
+            "<x:c r=\"B2\" s=\"3\"><x:v>1.5</x:v></x:c>"
+            "<x:c r=\"C2\" t=\"inlineStr\"><x:is><x:t>a &amp; b &#x3bb;</x:t></x:is></x:c>"
+            "<x:c r=\"AA2\" t='str'><x:f t=\"shared\" ref=\"AA2:AA3\" si=\"0\">SUM(A1)</x:f><x:v><![CDATA[<7>]]></x:v></x:c>"
+            "</x:row><x:row r=\"3\"><x:c r=\"AA3\"><x:f t=\"shared\" si=\"0\"/></x:c></x:row>"
+            "</x:sheetData><x:sheetDataExt/></x:worksheet>";
+
+        std::size_t content_begin = 0;
+        std::size_t content_end = 0;
+        xlnt_assert(xlnt::detail::find_sheet_data(part.data(), part.size(), content_begin, content_end));
+        xlnt_assert_equals(part.substr(content_end, 14), "</x:sheetData>");
+
+        std::unordered_map<std::string, std::string> array_formulae;
+        auto sheet_data = xlnt::detail::tokenize_sheet_data(part.data() + content_begin, part.data() + content_end,
+            array_formulae);
+
+        xlnt_assert_equals(sheet_data.parsed_rows.size(), 2);
+        xlnt_assert_equals(sheet_data.parsed_rows[0].second, 2);
+        xlnt_assert_equals(sheet_data.parsed_rows[0].first.spans.get(), "1:3");
+        xlnt_assert_equals(sheet_data.parsed_rows[0].first.height.get(), 20.5);
+        xlnt_assert(sheet_data.parsed_rows[0].first.custom_height);
+
+        const auto &cells = sheet_data.parsed_cells;
+        xlnt_assert_equals(cells.size(), 4);
+        xlnt_assert_equals(cells[0].ref.column, 2);
+        xlnt_assert_equals(cells[0].style_index, 3);
+        xlnt_assert_equals(sheet_data.str(cells[0].value), "1.5");
+        xlnt_assert_equals(cells[1].type, xlnt::cell_type::inline_string);
+        xlnt_assert_equals(sheet_data.str(cells[1].value), "a & b \xce\xbb");
+        xlnt_assert_equals(cells[2].ref.column, 27);
+        xlnt_assert_equals(sheet_data.str(cells[2].formula_string), "SUM(A1)");
+        xlnt_assert_equals(cells[2].shared_index, 0);
+        xlnt_assert_equals(sheet_data.str(cells[2].value), "<7>");
+        xlnt_assert_equals(cells[3].ref.row, 3);
+        xlnt_assert(cells[3].formula_string.empty());
+        xlnt_assert_equals(cells[3].shared_index, 0);
+
+        // cells and rows without r follow the previous one
+        const std::string implied = "<row r=\"2\"><c><v>1</v></c><c r=\"C2\"/><c/><c r=\"AA2\"/><c/></row>"
+            "<row><c r=\"B3\"/></row>";
+        auto implied_data = xlnt::detail::tokenize_sheet_data(implied.data(), implied.data() + implied.size(),
+            array_formulae);
+        xlnt_assert_equals(implied_data.parsed_rows.size(), 2);
+        xlnt_assert_equals(implied_data.parsed_rows[1].second, 3);
+        const auto &implied_cells = implied_data.parsed_cells;
+        xlnt_assert_equals(implied_cells.size(), 6);
+        xlnt_assert_equals(implied_cells[0].ref.column, 1);
+        xlnt_assert_equals(implied_cells[0].ref.row, 2);
+        xlnt_assert_equals(implied_cells[2].ref.column, 4);
+        xlnt_assert_equals(implied_cells[4].ref.column, 28);
+        xlnt_assert_equals(implied_cells[5].ref.column, 2);
+        xlnt_assert_equals(implied_cells[5].ref.row, 3);
+
+        const std::string empty = "<worksheet><sheetData/></worksheet>";
+        xlnt_assert(!xlnt::detail::find_sheet_data(empty.data(), empty.size(), content_begin, content_end));
+    }
+
+    void test_write_sheet_data()
+    {
+        std::ostringstream part;
+        xlnt::detail::sheet_data_writer writer(part);
+
+        writer.start_element("row");
+        writer.attribute("r", std::uint64_t(2));
+        writer.attribute("spans", std::uint64_t(1), std::uint64_t(16384));
+        writer.attribute("ht", 20.5);
+        writer.end_start_tag();
+        writer.start_element("c");
+        writer.attribute("r", xlnt::column_t(16384), 2);
+        writer.attribute("t", "str");
+        writer.end_start_tag();
+        writer.element("f", "\"a\" & <b>");
+        writer.element("v", 0.1);
+        writer.end_element("c");
+        writer.start_element("c");
+        writer.attribute("r", xlnt::column_t(16385), 2);
+        writer.attribute("x", "\"\t\n\r");
+        writer.end_empty_element();
+        writer.end_element("row");
+        xlnt_assert(part.str().empty());
+
+        writer.flush();
+        xlnt_assert_equals(part.str(), "<row r=\"2\" spans=\"1:16384\" ht=\"20.5\"><c r=\"XFD2\" t=\"str\">"
+            "<f>\"a\" &amp; &lt;b&gt;</f><v>0.1</v></c><c r=\"XFE2\" x=\"&quot;&#x9;&#xA;&#xD;\"/></row>");
+
+        xlnt_assert_throws(writer.element("v", std::string("\x01")), xlnt::illegal_character);
+
+        std::ostringstream shape;
+        xlnt::detail::sheet_data_writer template_writer(shape);
+        template_writer.markup("<v:shape style=\"margin-left:");
+        template_writer.number(-15);
+        template_writer.markup("pt\"/>");
+        template_writer.flush();
+        xlnt_assert_equals(shape.str(), "<v:shape style=\"margin-left:-15pt\"/>");
+    }
+
+    void test_load_xlsb()
+    {
+        // BIFF12 records, see [MS-XLSB] 2.1.4
+        auto integer = [](std::uint64_t value, std::size_t bytes) {
+            std::string result;
+            for (std::size_t i = 0; i < bytes; ++i) result.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+            return result;
+        };
+        auto u16 = [&integer](std::uint32_t value) { return integer(value, 2); };
+        auto u32 = [&integer](std::uint32_t value) { return integer(value, 4); };
+        auto real = [&integer](double value) {
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return integer(bits, 8);
+        };
+        auto wide = [&u16, &u32](const std::u16string &text) {
+            auto result = u32(static_cast<std::uint32_t>(text.size()));
+            for (auto character : text) result += u16(character);
+            return result;
+        };
+        auto record = [](std::uint32_t type, const std::string &data) {
+            std::string result;
+            for (auto value : {type, static_cast<std::uint32_t>(data.size())})
+            {
+                do
+                {
+                    result.push_back(static_cast<char>((value & 0x7F) | (value > 0x7F ? 0x80 : 0)));
+                    value >>= 7;
+                } while (value != 0);
+            }
+            return result + data;
+        };
+        auto cell = [&u32](std::uint32_t column, std::uint32_t format) { return u32(column) + u32(format); };
+        const auto xf = [&u16](std::uint32_t number_format) { return u16(0) + u16(number_format) + std::string(12, '\0'); };
+
+        const auto workbook_part = record(153, u32(1) + u32(0) + wide(u""))
+            + record(156, u32(0) + u32(1) + wide(u"rId1") + wide(u"Data"))
+            + record(156, u32(1) + u32(2) + wide(u"rId4") + wide(u"Hidden"));
+        const auto styles_part = record(44, u16(164) + wide(u"0.000"))
+            + record(626, u32(1)) + record(47, xf(22)) + record(627, "")
+            + record(617, u32(3)) + record(47, xf(0)) + record(47, xf(14)) + record(47, xf(164)) + record(618, "");
+        const auto strings_part = record(159, u32(2) + u32(2))
+            + record(19, std::string(1, '\0') + wide(u"hello"))
+            + record(19, std::string(1, '\0') + wide(u"café"))
+            + record(160, "");
+        const auto data_part = record(145, "")
+            + record(0, u32(0) + std::string(13, '\0'))
+            + record(7, cell(0, 0) + u32(0))
+            + record(5, cell(1, 2) + real(3.14159))
+            + record(2, cell(2, 0) + u32((42 << 2) | 0x2))
+            + record(0, u32(2) + std::string(13, '\0'))
+            + record(2, cell(0, 0) + u32((150 << 2) | 0x3))
+            + record(4, cell(1, 0) + std::string(1, '\1'))
+            + record(3, cell(2, 0) + std::string(1, '\x07'))
+            + record(6, cell(3, 0) + wide(u"inline"))
+            + record(9, cell(4, 1) + real(45000) + u16(0) + u32(0))
+            + record(7, cell(5, 0) + u32(1))
+            + record(2, cell(6, 0) + u32(0x3FE00000))
+            + record(146, "");
+        const auto hidden_part = record(145, "") + record(0, u32(0) + std::string(13, '\0'))
+            + record(5, cell(0, 0) + real(1)) + record(146, "");
+
+        const std::string relationships = "http://schemas.openxmlformats.org/officeDocument/2006/relationships/";
+        auto relationship = [&relationships](const std::string &id, const std::string &type, const std::string &target) {
+            return "<Relationship Id=\"" + id + "\" Type=\"" + relationships + type + "\" Target=\"" + target + "\"/>";
+        };
+        const std::string begin_relationships = "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">";
+        const std::vector<std::pair<std::string, std::string>> parts = {
+            {"[Content_Types].xml",
+                "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+                "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+                "<Override PartName=\"/xl/workbook.bin\" ContentType=\"application/vnd.ms-excel.sheet.binary.macroEnabled.main\"/>"
+                "<Override PartName=\"/xl/styles.bin\" ContentType=\"application/vnd.ms-excel.styles\"/>"
+                "<Override PartName=\"/xl/sharedStrings.bin\" ContentType=\"application/vnd.ms-excel.sharedStrings\"/>"
+                "<Override PartName=\"/xl/worksheets/sheet1.bin\" ContentType=\"application/vnd.ms-excel.worksheet\"/>"
+                "<Override PartName=\"/xl/worksheets/sheet2.bin\" ContentType=\"application/vnd.ms-excel.worksheet\"/>"
+                "</Types>"},
+            {"_rels/.rels", begin_relationships + relationship("rId1", "officeDocument", "xl/workbook.bin") + "</Relationships>"},
+            {"xl/_rels/workbook.bin.rels", begin_relationships
+                    + relationship("rId1", "worksheet", "worksheets/sheet1.bin")
+                    + relationship("rId2", "styles", "styles.bin")
+                    + relationship("rId3", "sharedStrings", "sharedStrings.bin")
+                    + relationship("rId4", "worksheet", "worksheets/sheet2.bin") + "</Relationships>"},
+            {"xl/workbook.bin", workbook_part},
+            {"xl/styles.bin", styles_part},
+            {"xl/sharedStrings.bin", strings_part},
+            {"xl/worksheets/sheet1.bin", data_part},
+            {"xl/worksheets/sheet2.bin", hidden_part}};
+
+        std::vector<std::uint8_t> archive;
+        {
+            xlnt::detail::vector_ostreambuf buffer(archive);
+            std::ostream stream(&buffer);
+            xlnt::detail::ozstream writer(stream);
+
+            for (const auto &part : parts)
+            {
+                std::ostream(writer.open(xlnt::path(part.first)).get()) << part.second;
+            }
+        }
+
+        xlnt::workbook wb;
+        wb.load(archive);
+
+        xlnt_assert_equals(wb.sheet_titles(), std::vector<std::string>({"Data", "Hidden"}));
+        xlnt_assert_equals(wb.sheet_by_title("Hidden").sheet_state(), xlnt::sheet_state::hidden);
+        xlnt_assert_equals(wb.base_date(), xlnt::calendar::mac_1904);
+
+        auto check = [](xlnt::worksheet ws) {
+            xlnt_assert_equals(ws.cell("A1").value<std::string>(), "hello");
+            xlnt_assert_equals(ws.cell("B1").value<double>(), 3.14159);
+            xlnt_assert_equals(ws.cell("B1").number_format().format_string(), "0.000");
+            xlnt_assert_equals(ws.cell("C1").value<int>(), 42);
+            xlnt_assert_equals(ws.cell("A3").value<double>(), 1.5);
+            xlnt_assert(ws.cell("B3").value<bool>());
+            xlnt_assert_equals(ws.cell("C3").error(), "#DIV/0!");
+            xlnt_assert_equals(ws.cell("D3").value<std::string>(), "inline");
+            xlnt_assert(ws.cell("E3").is_date());
+            xlnt_assert_equals(ws.cell("E3").value<double>(), 45000);
+            xlnt_assert_equals(ws.cell("F3").value<std::string>(), "caf\xc3\xa9");
+            xlnt_assert_equals(ws.cell("G3").value<double>(), 0.5);
+            xlnt_assert(!ws.has_cell("A2"));
+        };
+        check(wb.sheet_by_title("Data"));
+        xlnt_assert_equals(wb.sheet_by_title("Hidden").cell("A1").value<int>(), 1);
+
+        // the workbook is saved as an XLSX workbook
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        check(reloaded.sheet_by_title("Data"));
+
+        xlnt::load_options options;
+        options.sheets = {"Hidden"};
+        xlnt::workbook projected;
+        projected.load(archive, options);
+        xlnt_assert(!projected.sheet_by_title("Data").has_cell("A1"));
+        xlnt_assert_equals(projected.sheet_by_title("Hidden").cell("A1").value<int>(), 1);
+    }
+
+    void test_save_xlsb()
+    {
+        xlnt::workbook wb;
+        wb.base_date(xlnt::calendar::mac_1904);
+        wb.core_property(xlnt::core_property::title, "binary");
+
+        auto ws = wb.active_sheet();
+        ws.title("Data");
+        ws.cell("A1").value("shared");
+        ws.cell("B1").value(3.14159);
+        ws.cell("B1").number_format(xlnt::number_format("0.000"));
+        ws.cell("C1").value(42);
+        ws.cell("D1").value(-0.5);
+        ws.cell("E1").value(1e12);
+        ws.cell("A2").value(true);
+        ws.cell("B2").error("#N/A");
+        ws.cell("C2").value(xlnt::date(2024, 3, 1));
+        ws.cell("D2").value("caf\xc3\xa9");
+        ws.cell("H5").value(7);
+
+        auto hidden = wb.create_sheet();
+        hidden.title("Hidden");
+        hidden.sheet_state(xlnt::sheet_state::hidden);
+        hidden.cell("A1").value("shared");
+
+        xlnt::save_options options;
+        options.xlsb = true;
+        std::vector<std::uint8_t> saved;
+        wb.save(saved, options);
+
+        xlnt::detail::vector_istreambuf buffer(saved);
+        std::istream stream(&buffer);
+        xlnt::detail::izstream archive(stream);
+        xlnt_assert(archive.has_file(xlnt::path("xl/workbook.bin")));
+        xlnt_assert(!archive.has_file(xlnt::path("xl/workbook.xml")));
+
+        xlnt::workbook loaded;
+        loaded.load(saved);
+
+        xlnt_assert_equals(loaded.sheet_titles(), std::vector<std::string>({"Data", "Hidden"}));
+        xlnt_assert_equals(loaded.sheet_by_title("Hidden").sheet_state(), xlnt::sheet_state::hidden);
+        xlnt_assert_equals(loaded.base_date(), xlnt::calendar::mac_1904);
+        xlnt_assert_equals(loaded.core_property(xlnt::core_property::title).get<std::string>(), "binary");
+
+        auto data = loaded.sheet_by_title("Data");
+        xlnt_assert_equals(data.cell("A1").value<std::string>(), "shared");
+        xlnt_assert_equals(data.cell("B1").value<double>(), 3.14159);
+        xlnt_assert_equals(data.cell("B1").number_format().format_string(), "0.000");
+        xlnt_assert_equals(data.cell("C1").value<int>(), 42);
+        xlnt_assert_equals(data.cell("D1").value<double>(), -0.5);
+        xlnt_assert_equals(data.cell("E1").value<double>(), 1e12);
+        xlnt_assert(data.cell("A2").value<bool>());
+        xlnt_assert_equals(data.cell("B2").error(), "#N/A");
+        xlnt_assert(data.cell("C2").is_date());
+        xlnt_assert_equals(data.cell("C2").value<xlnt::date>(), xlnt::date(2024, 3, 1));
+        xlnt_assert_equals(data.cell("D2").value<std::string>(), "caf\xc3\xa9");
+        xlnt_assert_equals(data.cell("H5").value<int>(), 7);
+        xlnt_assert(!data.has_cell("A3"));
+        xlnt_assert_equals(loaded.sheet_by_title("Hidden").cell("A1").value<std::string>(), "shared");
+    }
+
+    void test_load_fast_sheet_data()
+    {
+        xlnt::load_options parser_options;
+        parser_options.fast_sheet_data = false;
+
+        for (auto file : {"4_every_style.xlsx", "10_comments_hyperlinks_formulae.xlsx", "15_phonetics.xlsx",
+                 "18_formulae.xlsx", "Issue445_inline_str.xlsx", "excel_test_sheet.xlsx"})
+        {
+            const auto path = path_helper::test_file(file);
+            xlnt::workbook tokenized(path);
+            xlnt::workbook parsed;
+            parsed.load(path, parser_options);
+            xlnt_assert(tokenized.compare(parsed, false));
+        }
+    }
+
+    void test_streaming_prefetch()
+    {
+        xlnt::workbook wb;
+        wb.active_sheet().title("First");
+        wb.create_sheet().title("Second");
+        wb.create_sheet().title("Third");
+
+        for (auto title : wb.sheet_titles())
+        {
+            auto ws = wb.sheet_by_title(title);
+
+            for (xlnt::row_t row = 1; row <= 200; ++row)
+            {
+                ws.cell(1, row).value(title + std::to_string(row));
+                ws.cell(2, row).value(static_cast<int>(row));
+            }
+        }
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        const auto read_all = [&wb](xlnt::streaming_workbook_reader &reader, const std::vector<std::string> &titles) {
+            for (const auto &title : titles)
+            {
+                auto ws = wb.sheet_by_title(title);
+                std::size_t cells = 0;
+                reader.begin_worksheet(title);
+
+                while (reader.has_cell())
+                {
+                    auto cell = reader.read_cell();
+                    xlnt_assert_equals(cell.to_string(), ws.cell(cell.reference()).to_string());
+                    ++cells;
+                }
+
+                reader.end_worksheet();
+                xlnt_assert_equals(cells, 400);
+            }
+        };
+
+        // in sheet_titles() order, and with a budget too small for any sheet
+        for (std::size_t max_bytes : {std::size_t(64 * 1024 * 1024), std::size_t(100)})
+        {
+            xlnt::streaming_workbook_reader reader;
+            reader.open(saved);
+            reader.prefetch(max_bytes);
+            read_all(reader, reader.sheet_titles());
+        }
+
+        // in a given order, which the sheets needn't be read in
+        xlnt::streaming_workbook_reader reader;
+        reader.open(saved);
+        reader.prefetch({"Third", "First", "Second"});
+        read_all(reader, {"Third", "Second", "First", "Third"});
+    }
+
+    void test_streaming_deferred_shared_strings()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).value(std::string(row % 2 == 0 ? "even" : "odd"));
+            ws.cell(2, row).value(static_cast<int>(row));
+        }
+
+        ws.cell("C1").value(xlnt::rich_text(xlnt::rich_text_run{"bold", xlnt::font().bold(true)}));
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        for (auto lazy : {false, true})
+        {
+            xlnt::load_options options;
+            options.lazy_shared_strings = lazy;
+            std::istringstream stream(std::string(saved.begin(), saved.end()));
+            xlnt::streaming_workbook_reader reader;
+            reader.open(stream, options);
+            xlnt_assert_equals(reader.shared_string_count(), 3);
+
+            // the strings are only counted by index and resolved afterwards
+            std::map<std::size_t, std::size_t> counts;
+            reader.begin_worksheet(ws.title());
+
+            while (reader.has_cell())
+            {
+                auto cell = reader.read_cell();
+
+                if (cell.data_type() == xlnt::cell_type::shared_string)
+                {
+                    ++counts[cell.shared_string_index()];
+                }
+                else
+                {
+                    xlnt_assert_throws(cell.shared_string_index(), xlnt::invalid_data_type);
+                }
+            }
+
+            reader.end_worksheet();
+
+            std::map<std::string, std::size_t> resolved;
+
+            for (const auto &count : counts)
+            {
+                resolved[reader.resolve_string(count.first)] = count.second;
+                xlnt_assert_equals(reader.resolve_string(count.first), reader.shared_string(count.first).plain_text());
+            }
+
+            xlnt_assert_equals(resolved.size(), 3);
+            xlnt_assert_equals(resolved["even"], 50);
+            xlnt_assert_equals(resolved["odd"], 50);
+            xlnt_assert_equals(resolved["bold"], 1);
+        }
+    }
+
+    void test_streaming_read_rows()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        using cell_values = std::vector<std::tuple<xlnt::row_t, xlnt::column_t::index_t, xlnt::cell_type, std::string>>;
+
+        auto describe = [](const xlnt::cell &c) {
+            return c.data_type() == xlnt::cell_type::number || c.data_type() == xlnt::cell_type::boolean
+                ? std::to_string(c.value<double>())
+                : c.data_type() == xlnt::cell_type::empty ? std::string() : c.value<std::string>();
+        };
+
+        for (auto sheet_index : {0, 1})
+        {
+            xlnt::streaming_workbook_reader reader;
+            reader.open(xlnt::path(path));
+            const auto title = reader.sheet_titles().at(static_cast<std::size_t>(sheet_index));
+
+            cell_values expected;
+            reader.begin_worksheet(title);
+            while (reader.has_cell())
+            {
+                auto c = reader.read_cell();
+                expected.emplace_back(c.row(), c.column_index(), c.data_type(), describe(c));
+            }
+            reader.end_worksheet();
+
+            cell_values batched;
+            reader.begin_worksheet(title);
+
+            // the first cell is read on its own to check mixing both interfaces
+            xlnt_assert(reader.has_cell());
+            auto first = reader.read_cell();
+            batched.emplace_back(first.row(), first.column_index(), first.data_type(), describe(first));
+
+            xlnt::cell_batch batch;
+            while (reader.read_rows(batch, 2) > 0)
+            {
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                {
+                    std::string value;
+                    switch (batch.types[i])
+                    {
+                    case xlnt::cell_type::number:
+                    case xlnt::cell_type::boolean:
+                        value = std::to_string(batch.numbers[i]);
+                        break;
+                    case xlnt::cell_type::shared_string:
+                        value = reader.shared_string(batch.indices[i]).plain_text();
+                        break;
+                    case xlnt::cell_type::empty:
+                        break;
+                    default:
+                        value = batch.strings[batch.indices[i]];
+                        break;
+                    }
+                    batched.emplace_back(batch.rows[i], batch.columns[i], batch.types[i], value);
+                }
+            }
+
+            xlnt_assert(!reader.has_cell());
+            reader.end_worksheet();
+
+            xlnt_assert(!expected.empty());
+            xlnt_assert(expected == batched);
+        }
+    }
+
+    void test_streaming_row_range()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        using cell_positions = std::vector<std::pair<xlnt::row_t, xlnt::column_t::index_t>>;
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(xlnt::path(path));
+        const auto title = reader.sheet_titles().front();
+
+        cell_positions expected;
+        reader.begin_worksheet(title);
+        while (reader.has_cell())
+        {
+            auto c = reader.read_cell();
+            expected.emplace_back(c.row(), c.column_index());
+        }
+        reader.end_worksheet();
+
+        cell_positions ranged;
+        std::size_t batches = 0;
+        for (const auto &batch : reader.rows(title, 2))
+        {
+            xlnt_assert(batch.size() > 0);
+            ++batches;
+
+            for (std::size_t i = 0; i < batch.size(); ++i)
+            {
+                ranged.emplace_back(batch.rows[i], batch.columns[i]);
+            }
+        }
+        reader.end_worksheet();
+
+        xlnt_assert(batches > 1);
+        xlnt_assert(expected == ranged);
+
+        // a single batch can hold the whole worksheet
+        auto range = reader.rows(title, 1000000);
+        auto batch = range.begin();
+        xlnt_assert(batch != range.end());
+        xlnt_assert_equals(batch->size(), expected.size());
+        xlnt_assert(++batch == range.end());
+        reader.end_worksheet();
+    }
+
+    void test_streaming_read_columns()
+    {
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        using cell_values = std::vector<std::tuple<xlnt::row_t, xlnt::column_t::index_t, xlnt::cell_type, std::string>>;
+
+        for (auto sheet_index : {0, 1})
+        {
+            xlnt::streaming_workbook_reader reader;
+            reader.open(xlnt::path(path));
+            const auto title = reader.sheet_titles().at(static_cast<std::size_t>(sheet_index));
+
+            // empty cells can't be told apart from the padding of the columns
+            cell_values expected;
+            reader.begin_worksheet(title);
+            while (reader.has_cell())
+            {
+                auto c = reader.read_cell();
+                if (c.data_type() == xlnt::cell_type::empty) continue;
+                const auto value = c.data_type() == xlnt::cell_type::number || c.data_type() == xlnt::cell_type::boolean
+                    ? std::to_string(c.value<double>())
+                    : c.value<std::string>();
+                expected.emplace_back(c.row(), c.column_index(), c.data_type(), value);
+            }
+            reader.end_worksheet();
+
+            cell_values batched;
+            reader.begin_worksheet(title);
+
+            xlnt::column_batch batch;
+            while (reader.read_columns(batch, 3) > 0)
+            {
+                for (const auto &column : batch.columns)
+                {
+                    xlnt_assert_equals(column.types.size(), batch.size());
+                    xlnt_assert_equals(column.numbers.size(), batch.size());
+                    xlnt_assert_equals(column.indices.size(), batch.size());
+                    xlnt_assert_equals(batch.find(column.index), &column);
+                }
+
+                // visit the cells in row-major order like read_cell()
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                {
+                    for (const auto &column : batch.columns)
+                    {
+                        std::string value;
+                        switch (column.types[i])
+                        {
+                        case xlnt::cell_type::empty:
+                            continue;
+                        case xlnt::cell_type::number:
+                        case xlnt::cell_type::boolean:
+                            value = std::to_string(column.numbers[i]);
+                            break;
+                        case xlnt::cell_type::shared_string:
+                            xlnt_assert(column.indices[i] < reader.shared_string_count());
+                            value = reader.shared_string(column.indices[i]).plain_text();
+                            break;
+                        default:
+                            value = batch.strings[column.indices[i]];
+                            break;
+                        }
+                        batched.emplace_back(batch.rows[i], column.index, column.types[i], value);
+                    }
+                }
+            }
+
+            xlnt_assert(!reader.has_cell());
+            reader.end_worksheet();
+
+            xlnt_assert(!expected.empty());
+            xlnt_assert(expected == batched);
+        }
+    }
+
+    void test_streaming_sample_schema()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.title("Data");
+
+        for (xlnt::row_t row = 1; row <= 4; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value(xlnt::date(2024, 1, static_cast<int>(row)));
+            ws.cell(3, row).value("text");
+            ws.cell(5, row).value(row == 2 ? xlnt::cell(ws.cell(1, row)) : xlnt::cell(ws.cell(3, row)));
+        }
+
+        ws.cell("C3").formula("=\"a\"&\"b\"", "ab");
+        ws.cell("D2").error("#N/A");
+        // a cell with a style but no value, and a row past the sample
+        ws.cell("D3").number_format(xlnt::number_format::percentage());
+        ws.cell("A4").value("not sampled");
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(saved);
+        reader.begin_worksheet("Data");
+        xlnt_assert(reader.has_cell());
+        reader.read_cell();
+
+        const auto schema = reader.sample_schema("Data", 3);
+        xlnt_assert_equals(schema.size(), 5);
+        xlnt_assert_equals(schema[0].index, 1);
+        xlnt_assert(schema[0].type == xlnt::cell_type::number);
+        xlnt_assert(!schema[0].mixed);
+        xlnt_assert(schema[1].type == xlnt::cell_type::date);
+        xlnt_assert(schema[2].type == xlnt::cell_type::shared_string);
+        xlnt_assert(!schema[2].mixed);
+        xlnt_assert_equals(schema[2].nulls, 0);
+        xlnt_assert(schema[3].type == xlnt::cell_type::empty);
+        xlnt_assert_equals(schema[3].nulls, 3);
+        xlnt_assert(schema[4].mixed);
+
+        // the worksheet being read carries on where it was
+        xlnt_assert(reader.has_cell());
+        xlnt_assert_equals(reader.read_cell().reference(), xlnt::cell_reference("B1"));
+        while (reader.has_cell())
+        {
+            reader.read_cell();
+        }
+        reader.end_worksheet();
+        xlnt_assert_throws(reader.sample_schema("Missing", 1), xlnt::exception);
+    }
+
     void test_streaming_read()
     {
         const auto path = path_helper::test_file("4_every_style.xlsx");
@@ -740,6 +2544,135 @@ public:
         }
     }
 
+    void test_streaming_read_matches_load()
+    {
+        for (auto file : {"10_comments_hyperlinks_formulae.xlsx", "4_every_style.xlsx"})
+        {
+            const auto path = path_helper::test_file(file);
+            xlnt::workbook loaded;
+            loaded.load(path);
+            xlnt::streaming_workbook_reader reader;
+            reader.open(xlnt::path(path));
+
+            for (auto title : reader.sheet_titles())
+            {
+                auto ws = loaded.sheet_by_title(title);
+                std::vector<xlnt::row_t> rows;
+                reader.row_callback([&rows, &ws](xlnt::row_t row, const xlnt::row_properties &properties) {
+                    rows.push_back(row);
+                    xlnt_assert(ws.has_row_properties(row));
+                    xlnt_assert(properties == ws.row_properties(row));
+                });
+
+                std::size_t cells = 0;
+                reader.begin_worksheet(title);
+
+                while (reader.has_cell())
+                {
+                    auto streamed = reader.read_cell();
+                    auto full = ws.cell(streamed.reference());
+                    ++cells;
+                    xlnt_assert(!rows.empty() && rows.back() == streamed.row());
+
+                    xlnt_assert_equals(streamed.data_type(), full.data_type());
+                    xlnt_assert_equals(streamed.to_string(), full.to_string());
+                    xlnt_assert_equals(streamed.has_formula(), full.has_formula());
+                    if (full.has_formula())
+                    {
+                        xlnt_assert_equals(streamed.formula(), full.formula());
+                    }
+                    xlnt_assert_equals(streamed.has_format(), full.has_format());
+                    if (full.has_format())
+                    {
+                        xlnt_assert(streamed.format().font() == full.format().font());
+                        xlnt_assert(streamed.format().number_format() == full.format().number_format());
+                    }
+                }
+
+                auto streamed_ws = reader.end_worksheet();
+                xlnt_assert(!rows.empty());
+                xlnt_assert(!streamed_ws.has_row_properties(rows.front()));
+                std::size_t loaded_cells = 0;
+                ws.parallel_for_each_cell([&loaded_cells](const xlnt::cell &) { ++loaded_cells; }, 1);
+                xlnt_assert_equals(cells, loaded_cells);
+            }
+        }
+    }
+
+    void test_streaming_read_forward_only()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+        first.title("First");
+        auto second = wb.create_sheet();
+        second.title("Second");
+
+        for (xlnt::row_t row = 1; row <= 200; ++row)
+        {
+            first.cell(1, row).value(static_cast<int>(row));
+            first.cell(2, row).value("first " + std::to_string(row % 7));
+            second.cell(1, row).value(row * 0.5);
+        }
+
+        for (auto compression : {xlnt::compression_level::standard, xlnt::compression_level::none})
+        {
+            xlnt::save_options save;
+            save.compression = compression;
+            std::vector<std::uint8_t> bytes;
+            wb.save(bytes, save);
+
+            xlnt::load_options options;
+            options.forward_only = true;
+            forward_only_streambuf buffer(bytes);
+            std::istream stream(&buffer);
+            xlnt::streaming_workbook_reader reader;
+            reader.open(stream, options);
+            xlnt_assert_equals(reader.sheet_titles(), std::vector<std::string>({"First", "Second"}));
+
+            // the second sheet is read first, so the first is kept on the way to it
+            for (auto title : {"Second", "First"})
+            {
+                xlnt::row_t rows = 0;
+                reader.begin_worksheet(title);
+
+                while (reader.has_cell())
+                {
+                    auto streamed = reader.read_cell();
+                    auto expected = wb.sheet_by_title(title).cell(streamed.reference());
+                    xlnt_assert_equals(streamed.to_string(), expected.to_string());
+                    rows = std::max(rows, streamed.row());
+                }
+
+                reader.end_worksheet();
+                xlnt_assert_equals(rows, 200u);
+            }
+
+            // the shared strings come last, so the sheets were kept on the way to them, but a
+            // member which hasn't been passed yet is inflated straight from the stream
+            forward_only_streambuf archive_buffer(bytes);
+            std::istream archive_stream(&archive_buffer);
+            xlnt::detail::izstream archive(archive_stream, 512, nullptr, true);
+            const auto sheet1 = xlnt::path("xl/worksheets/sheet1.xml");
+            const auto sheet2 = xlnt::path("xl/worksheets/sheet2.xml");
+            auto streamed = archive.open(sheet2);
+            xlnt_assert(archive.has_file(sheet1));
+            xlnt_assert(std::string(std::istreambuf_iterator<char>(streamed.get()), {}).find("<sheetData")
+                != std::string::npos);
+            xlnt_assert(!archive.read(sheet1).empty());
+            xlnt_assert(!archive.has_file(xlnt::path("xl/missing.xml")));
+
+            if (compression == xlnt::compression_level::standard)
+            {
+                xlnt_assert_throws(archive.open(sheet2), xlnt::exception);
+            }
+            else
+            {
+                // stored members with a data descriptor are kept to find where they end
+                xlnt_assert(!archive.read(sheet2).empty());
+            }
+        }
+    }
+
     void test_streaming_write()
     {
         const auto path = std::string("stream-out.xlsx");
@@ -755,6 +2688,282 @@ public:
         auto c3 = writer.add_cell("C3");
         b2.value("should not change");
         c3.value("C3!");
+        xlnt_assert_throws(writer.add_cell("B3"), xlnt::invalid_parameter);
+
+        writer.end_row();
+        xlnt_assert_throws(writer.add_cell("D3"), xlnt::invalid_parameter);
+        xlnt_assert_equals(writer.next_row(), 4);
+        writer.append_row(std::vector<double>{1.5, 2});
+
+        auto numbers = writer.add_worksheet("numbers");
+        numbers.column_properties("B").width = 20.0;
+        writer.add_cell("A1").formula("=1+1");
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            writer.append_row(std::vector<std::string>{"row", std::to_string(i)});
+        }
+        writer.close();
+
+        xlnt::workbook streamed{xlnt::path(path)};
+        const auto stream = streamed.sheet_by_title("stream");
+        xlnt_assert_equals(stream.cell("B2").value<std::string>(), "B2!");
+        xlnt_assert_equals(stream.cell("C3").value<std::string>(), "C3!");
+        xlnt_assert_equals(stream.cell("A4").value<double>(), 1.5);
+        xlnt_assert_equals(stream.cell("B4").value<double>(), 2.0);
+        xlnt_assert_equals(stream.highest_row(), 4);
+
+        const auto streamed_numbers = streamed.sheet_by_title("numbers");
+        xlnt_assert_equals(streamed_numbers.cell("A1").formula(), "1+1");
+        xlnt_assert_equals(streamed_numbers.cell("B1001").value<std::string>(), "999");
+        xlnt_assert_equals(streamed_numbers.column_properties("B").width.get(), 20.0);
+        xlnt_assert_equals(streamed.sheet_count(), 2);
+    }
+
+    void test_streaming_write_encrypted()
+    {
+        for (const auto rows : {1, 20000})
+        {
+            std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+            xlnt::streaming_workbook_writer writer;
+            writer.open(stream, "secret");
+            writer.add_worksheet("encrypted");
+
+            for (auto i = 0; i < rows; ++i)
+            {
+                writer.append_row(std::vector<std::string>{"row", std::to_string(i)});
+            }
+
+            writer.close();
+
+            xlnt::workbook streamed;
+            streamed.load(stream, "secret");
+            const auto sheet = streamed.sheet_by_title("encrypted");
+            xlnt_assert_equals(sheet.highest_row(), static_cast<xlnt::row_t>(rows));
+            xlnt_assert_equals(sheet.cell(2, static_cast<xlnt::row_t>(rows)).value<std::string>(), std::to_string(rows - 1));
+        }
+    }
+
+    void test_streaming_append_rows()
+    {
+        std::vector<std::uint8_t> data;
+        xlnt::streaming_workbook_writer writer;
+        writer.open(data);
+        writer.add_worksheet("columns");
+        writer.append_row(std::vector<std::string>{"number", "count", "flag", "name", "category"});
+
+        const double numbers[] = {0, 1.5, 2.5, std::numeric_limits<double>::quiet_NaN(), -4};
+        const std::int64_t counts[] = {0, 10, 20, 30, 40};
+        const std::uint8_t flags[] = {0x0a}; // rows 2 and 4 are true
+        const std::int32_t offsets[] = {0, 5, 6, 9, 9, 13};
+        const char characters[] = "ignorx <&  b ";
+        const std::uint8_t validity[] = {0x1e}; // the first element is never written
+
+        const auto red = static_cast<std::uint32_t>(writer.add_shared_string("red"));
+        const auto blue = static_cast<std::uint32_t>(writer.add_shared_string("blue"));
+        const std::uint32_t dictionary[] = {blue, red};
+        const std::int32_t categories[] = {0, 1, 0, 1, 1};
+
+        std::vector<xlnt::column_view> columns(5);
+        columns[0].index = 1;
+        columns[0].doubles = numbers;
+        columns[1].index = 2;
+        columns[1].kind = xlnt::column_view::value_kind::integers;
+        columns[1].integers = counts;
+        columns[2].index = 3;
+        columns[2].kind = xlnt::column_view::value_kind::booleans;
+        columns[2].booleans = flags;
+        columns[3].index = 4;
+        columns[3].kind = xlnt::column_view::value_kind::strings;
+        columns[3].offsets = offsets;
+        columns[3].characters = characters;
+        columns[4].index = 6;
+        columns[4].kind = xlnt::column_view::value_kind::shared_strings;
+        columns[4].indices = categories;
+        columns[4].dictionary = dictionary;
+        columns[4].dictionary_size = 2;
+
+        for (auto &column : columns)
+        {
+            column.validity = validity;
+            column.offset = 1;
+        }
+
+        auto unsorted = columns;
+        std::swap(unsorted[0], unsorted[1]);
+        xlnt_assert_throws(writer.append_rows(4, unsorted), xlnt::invalid_parameter);
+        auto out_of_range = columns;
+        out_of_range[4].dictionary_size = 1;
+        xlnt_assert_throws(writer.append_rows(4, out_of_range), xlnt::invalid_parameter);
+
+        writer.append_rows(3, columns);
+        xlnt_assert_equals(writer.next_row(), 5);
+        columns.resize(1);
+        columns[0].offset = 4;
+        writer.append_rows(1, columns);
+        writer.close();
+
+        xlnt::workbook wb;
+        wb.load(data);
+        const auto ws = wb.sheet_by_title("columns");
+
+        xlnt_assert_equals(ws.cell("A2").value<double>(), 1.5);
+        xlnt_assert_equals(ws.cell("A3").value<double>(), 2.5);
+        xlnt_assert(!ws.has_cell("A4"));
+        xlnt_assert_equals(ws.cell("A5").value<double>(), -4.0);
+        xlnt_assert_equals(ws.cell("B2").value<double>(), 10.0);
+        xlnt_assert_equals(ws.cell("B4").value<double>(), 30.0);
+        xlnt_assert(!ws.has_cell("B5"));
+        xlnt_assert(ws.cell("C2").value<bool>());
+        xlnt_assert(!ws.cell("C3").value<bool>());
+        xlnt_assert(ws.cell("C4").value<bool>());
+        xlnt_assert_equals(ws.cell("D2").value<std::string>(), "x");
+        xlnt_assert_equals(ws.cell("D3").value<std::string>(), " <&");
+        xlnt_assert_equals(ws.cell("D4").value<std::string>(), "");
+        xlnt_assert(!ws.has_cell("E2"));
+        xlnt_assert_equals(ws.cell("F2").data_type(), xlnt::cell_type::shared_string);
+        xlnt_assert_equals(ws.cell("F2").value<std::string>(), "red");
+        xlnt_assert_equals(ws.cell("F3").value<std::string>(), "blue");
+        xlnt_assert_equals(ws.cell("F4").value<std::string>(), "red");
+        xlnt_assert_equals(ws.highest_row(), 5);
+    }
+
+    void test_streaming_format_ids()
+    {
+        std::vector<std::uint8_t> data;
+        xlnt::streaming_workbook_writer writer;
+        writer.open(data);
+        auto ws = writer.add_worksheet("styled");
+
+        auto wb = ws.workbook();
+        const auto bold = writer.add_format(wb.create_format().font(xlnt::font().bold(true), true));
+        const auto percent = writer.add_format(wb.create_format().number_format(xlnt::number_format::percentage(), true));
+        xlnt_assert_differs(bold, percent);
+
+        xlnt::workbook other;
+        xlnt_assert_throws(writer.add_format(other.create_format()), xlnt::invalid_parameter);
+        xlnt_assert_throws(writer.add_cell("A1", std::size_t(1000)), xlnt::invalid_parameter);
+
+        writer.add_cell("A1", bold).value("title");
+        writer.add_cell("B1").value("plain");
+        writer.end_row();
+
+        const double ratios[] = {0.25, 0.5};
+        std::vector<xlnt::column_view> columns(1);
+        columns[0].index = 2;
+        columns[0].doubles = ratios;
+        columns[0].format_id = 1000;
+        xlnt_assert_throws(writer.append_rows(2, columns), xlnt::invalid_parameter);
+        columns[0].format_id = percent;
+        writer.append_rows(2, columns);
+
+        auto sheet = writer.open_worksheet("concurrent");
+        sheet.add_cell("C1", percent).value(0.75);
+        writer.close();
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        const auto styled = loaded.sheet_by_title("styled");
+        xlnt_assert(styled.cell("A1").font().bold());
+        xlnt_assert(!styled.cell("B1").has_format() || !styled.cell("B1").font().bold());
+        xlnt_assert_equals(styled.cell("B3").value<double>(), 0.5);
+        xlnt_assert(styled.cell("B3").number_format() == xlnt::number_format::percentage());
+        xlnt_assert(loaded.sheet_by_title("concurrent").cell("C1").number_format() == xlnt::number_format::percentage());
+    }
+
+    void test_streaming_write_typed_rows()
+    {
+        std::vector<std::uint8_t> data;
+        xlnt::streaming_workbook_writer writer;
+        writer.open(data);
+        writer.add_worksheet("typed");
+        writer.write_row(std::make_tuple("id", "ratio", "flag", "name", "day", "time"));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            writer.write_row(std::make_tuple(std::int64_t(9007199254740993) + i, i * 0.5, i % 2 == 0, std::string("row ") + std::to_string(i),
+                xlnt::date(2024, 3, 1 + i), xlnt::datetime(2024, 3, 1, 12, 30, 0)));
+        }
+
+        writer.write_row(std::make_tuple(std::numeric_limits<double>::quiet_NaN(), 7u));
+        writer.close();
+
+        xlnt::workbook wb;
+        wb.load(data);
+        const auto ws = wb.active_sheet();
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "id");
+        xlnt_assert_equals(ws.cell("B3").value<double>(), 0.5);
+        xlnt_assert(ws.cell("C2").value<bool>());
+        xlnt_assert(!ws.cell("C3").value<bool>());
+        xlnt_assert_equals(ws.cell("D4").value<std::string>(), "row 2");
+        xlnt_assert(ws.cell("E2").is_date());
+        xlnt_assert_equals(ws.cell("E3").value<xlnt::date>(), xlnt::date(2024, 3, 2));
+        xlnt_assert_equals(ws.cell("F4").value<xlnt::datetime>(), xlnt::datetime(2024, 3, 1, 12, 30, 0));
+        xlnt_assert(!ws.has_cell("A5"));
+        xlnt_assert_equals(ws.cell("B5").value<double>(), 7);
+
+        // shared strings repeated across rows are stored once
+        xlnt_assert_equals(wb.shared_strings().size(), 9);
+    }
+
+    void test_streaming_concurrent_sheets()
+    {
+        std::vector<std::uint8_t> data;
+        xlnt::streaming_workbook_writer writer;
+        writer.open(data);
+
+        auto first = writer.add_worksheet("first");
+        auto bold = first.workbook().create_format().font(xlnt::font().bold(true), true);
+        writer.append_row(std::vector<std::string>{"sequential"});
+
+        std::vector<xlnt::streaming_sheet_writer> sheets;
+        for (int i = 0; i < 3; ++i)
+        {
+            sheets.push_back(writer.open_worksheet("sheet" + std::to_string(i)));
+        }
+        sheets[1].worksheet().column_properties("A").width = 15.0;
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < sheets.size(); ++i)
+        {
+            threads.emplace_back([&sheets, &bold, i]() {
+                auto &sheet = sheets[i];
+                sheet.add_cell("A1", bold).value("title " + std::to_string(i));
+                sheet.end_row();
+                for (int row = 0; row < 2000; ++row)
+                {
+                    sheet.append_row(std::vector<double>{static_cast<double>(row), static_cast<double>(i)});
+                }
+                sheet.add_cell(xlnt::cell_reference(1, sheet.next_row())).formula("=SUM(A2:A2001)");
+                if (i != 0)
+                {
+                    sheet.close();
+                }
+            });
+        }
+        writer.append_row(std::vector<std::string>{"while the others are written"});
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        writer.close();
+
+        xlnt::workbook wb;
+        wb.load(data);
+        xlnt_assert_equals(wb.sheet_count(), 4);
+        xlnt_assert_equals(wb.sheet_by_index(0).cell("A2").value<std::string>(), "while the others are written");
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            const auto ws = wb.sheet_by_index(i + 1);
+            xlnt_assert_equals(ws.title(), "sheet" + std::to_string(i));
+            xlnt_assert_equals(ws.cell("A1").value<std::string>(), "title " + std::to_string(i));
+            xlnt_assert(ws.cell("A1").font().bold());
+            xlnt_assert_equals(ws.cell("A2001").value<double>(), 1999.0);
+            xlnt_assert_equals(ws.cell("B2001").value<double>(), static_cast<double>(i));
+            xlnt_assert_equals(ws.cell("A2002").formula(), "SUM(A2:A2001)");
+        }
+
+        xlnt_assert_equals(wb.sheet_by_index(2).column_properties("A").width.get(), 15.0);
     }
 
     void test_load_save_german_locale()
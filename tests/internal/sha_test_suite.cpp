@@ -0,0 +1,91 @@
+// Copyright (c) 2014-2022 Thomas Fussell
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <detail/cryptography/hash.hpp>
+#include <helpers/test_suite.hpp>
+
+class sha_test_suite : public test_suite
+{
+public:
+    sha_test_suite()
+    {
+        register_test(test_known_digests);
+        register_test(test_spin_matches_hash_loop);
+    }
+
+    void test_known_digests()
+    {
+        const std::vector<std::uint8_t> abc = {'a', 'b', 'c'};
+
+        xlnt_assert(xlnt::detail::hash(xlnt::detail::hash_algorithm::sha1, abc)
+            == bytes("a9993e364706816aba3e25717850c26c9cd0d89d"));
+        xlnt_assert(xlnt::detail::hash(xlnt::detail::hash_algorithm::sha512, abc)
+            == bytes("ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                     "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+    }
+
+    void test_spin_matches_hash_loop()
+    {
+        for (auto algorithm : {xlnt::detail::hash_algorithm::sha1, xlnt::detail::hash_algorithm::sha512})
+        {
+            const std::vector<std::uint8_t> salt_plus_password = {1, 2, 3, 4, 5, 6, 7, 8, 'p', 0, 'w', 0};
+            const auto h_0 = xlnt::detail::hash(algorithm, salt_plus_password);
+
+            auto expected = h_0;
+            for (std::uint32_t i = 0; i < 1000; ++i)
+            {
+                std::vector<std::uint8_t> iterator_plus_h_n = {
+                    static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i >> 8), 0, 0};
+                iterator_plus_h_n.insert(iterator_plus_h_n.end(), expected.begin(), expected.end());
+                expected = xlnt::detail::hash(algorithm, iterator_plus_h_n);
+            }
+
+            auto spun = h_0;
+            xlnt::detail::spin_hash(algorithm, spun, 1000);
+            xlnt_assert(spun == expected);
+
+            auto unchanged = h_0;
+            xlnt::detail::spin_hash(algorithm, unchanged, 0);
+            xlnt_assert(unchanged == h_0);
+        }
+    }
+
+private:
+    static std::vector<std::uint8_t> bytes(const std::string &hex)
+    {
+        std::vector<std::uint8_t> result;
+
+        for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+        {
+            result.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+        }
+
+        return result;
+    }
+};
+static sha_test_suite x;
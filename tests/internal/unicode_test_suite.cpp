@@ -49,6 +49,7 @@ public:
 #if XLNT_HAS_FEATURE(U8_STRING_VIEW)
         register_test(test_convert_utf32_to_utf8_u8);
 #endif
+        register_test(test_string_length);
     }
 
     void test_convert_utf8_to_utf16()
@@ -114,5 +115,16 @@ public:
         xlnt_assert_equals(result, U8STRING_LITERAL(UNICODE_TEST_STRING));
     }
 #endif
+
+    void test_string_length()
+    {
+        xlnt_assert_equals(xlnt::detail::string_length(""), 0);
+        xlnt_assert_equals(xlnt::detail::string_length("Sheet1"), 6);
+        xlnt_assert_equals(xlnt::detail::string_length("a long ASCII worksheet title"), 28);
+        xlnt_assert_equals(xlnt::detail::string_length(ENSURE_UTF8_LITERAL(UNICODE_TEST_STRING)), 3);
+        xlnt_assert_equals(xlnt::detail::string_length(std::string("summary ") + ENSURE_UTF8_LITERAL(UNICODE_TEST_STRING)), 11);
+        xlnt_assert_throws(xlnt::detail::string_length("ASCII prefix \xc3"), xlnt::exception);
+        xlnt_assert_throws(xlnt::detail::string_length("\xff\xfe"), xlnt::exception);
+    }
 };
 static unicode_test_suite x;
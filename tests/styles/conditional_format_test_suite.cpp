@@ -32,6 +32,7 @@ public:
     conditional_format_test_suite()
     {
         register_test(test_all);
+        register_test(test_formats_of_cell);
     }
 
     void test_all()
@@ -61,5 +62,40 @@ public:
         auto format_copy(format);
         xlnt_assert_equals(format, format_copy);
     }
+
+    void test_formats_of_cell()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto other = wb.create_sheet();
+        const auto when = xlnt::condition::text_contains("test");
+        auto small = ws.conditional_format(xlnt::range_reference("B2:C3"), when);
+        other.conditional_format(xlnt::range_reference("B2:C3"), when);
+
+        // a few rows, many rows in a few columns and a range which is large both ways
+        auto added = ws.create_conditional_formats({
+            {xlnt::range_reference("A1:E5"), when},
+            {xlnt::range_reference("C1:C100000"), when},
+            {xlnt::range_reference("A1:ZZ100000"), when}});
+        xlnt_assert_equals(added.size(), 3);
+
+        auto at_c2 = ws.conditional_formats(xlnt::cell_reference("C2"));
+        xlnt_assert_equals(at_c2.size(), 4);
+        xlnt_assert_equals(at_c2[0], small);
+        xlnt_assert_equals(at_c2[1], added[0]);
+        xlnt_assert_equals(at_c2[3], added[2]);
+
+        auto at_c5000 = ws.conditional_formats(xlnt::cell_reference("C5000"));
+        xlnt_assert_equals(at_c5000.size(), 2);
+        xlnt_assert_equals(at_c5000[0], added[1]);
+        xlnt_assert(ws.conditional_formats(xlnt::cell_reference("AAA1")).empty());
+
+        // the index is rebuilt for a copy, whose rules were copied too
+        auto copy = wb.clone(xlnt::workbook::clone_method::deep_copy);
+        xlnt_assert_equals(copy.active_sheet().conditional_formats(xlnt::cell_reference("C2")).size(), 4);
+        auto later = ws.conditional_format(xlnt::range_reference("C2:C2"), when);
+        xlnt_assert_equals(ws.conditional_formats(xlnt::cell_reference("C2")).back(), later);
+        xlnt_assert_equals(other.conditional_formats(xlnt::cell_reference("C2")).size(), 1);
+    }
 };
 static conditional_format_test_suite x;
@@ -26,10 +26,14 @@
 
 #include <helpers/test_suite.hpp>
 
+#include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/number_format.hpp>
 #include <xlnt/utils/date.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+#include <detail/number_format/number_formatter.hpp>
 
 class number_format_test_suite : public test_suite
 {
@@ -116,6 +120,8 @@ public:
         register_test(test_builtin_format_date_dmyminus);
         register_test(test_builtin_format_date_dmminus);
         register_test(test_builtin_format_date_myminus);
+        register_test(test_formatter_cache);
+        register_test(test_format_numbers);
     }
 
     void test_basic()
@@ -1033,5 +1039,48 @@ public:
     {
         format_and_test(xlnt::number_format::date_myminus(), {{"5-16", "###########", "1-00", "text"}});
     }
+
+    void test_format_numbers()
+    {
+        const double numbers[] = {0.125, -3, 0, 42613.5, 1e10};
+
+        for (const auto code : {"0.0%", "#,##0.00;[Red]-#,##0.00;\"zero\"", "yyyy-mm-dd h:mm", "[>100]\"big\";0", "*-0"})
+        {
+            const xlnt::detail::number_formatter formatter(code, xlnt::calendar::windows_1900);
+            std::string output;
+            std::vector<std::size_t> offsets;
+            formatter.format_numbers(numbers, 5, output, offsets);
+
+            xlnt_assert_equals(offsets.size(), 6);
+            xlnt_assert_equals(offsets.back(), output.size());
+
+            for (std::size_t i = 0; i < 5; ++i)
+            {
+                xlnt_assert_equals(output.substr(offsets[i], offsets[i + 1] - offsets[i]), formatter.format_number(numbers[i]));
+            }
+        }
+    }
+
+    void test_formatter_cache()
+    {
+        xlnt::detail::number_formatter_cache cache;
+        const xlnt::number_format percent("0.0%", 170);
+
+        const auto &first = cache.get(percent, xlnt::calendar::windows_1900);
+        xlnt_assert_equals(&cache.get(percent, xlnt::calendar::windows_1900), &first);
+        xlnt_assert_equals(first.format_number(0.125), "12.5%");
+
+        // a reused id or another calendar gets a formatter of its own
+        xlnt_assert_equals(cache.get(xlnt::number_format("0.00", 170), xlnt::calendar::windows_1900).format_number(2), "2.00");
+        xlnt_assert_equals(cache.get(xlnt::number_format("yyyy", 170), xlnt::calendar::mac_1904).format_number(400), "1905");
+        xlnt_assert_equals(cache.get(xlnt::number_format("yyyy"), xlnt::calendar::windows_1900).format_number(400), "1901");
+        xlnt_assert_equals(first.format_number(1), "100.0%");
+
+        xlnt::workbook wb;
+        auto cell = wb.active_sheet().cell("A1");
+        cell.value(2.5);
+        xlnt_assert_equals(cell.to_string(), "2.5");
+        xlnt_assert_equals(cell.to_string(), "2.5");
+    }
 };
 static number_format_test_suite x;
@@ -56,6 +56,7 @@ public:
         register_test(test_leap_year_bug);
         register_test(test_early_date);
         register_test(test_mac_calendar);
+        register_test(test_date_round_trip);
         register_test(test_operators);
         register_test(test_weekday);
         register_test(test_invalid_date_access);
@@ -290,6 +291,22 @@ public:
         xlnt_assert_equals(converted_1904, d);
     }
 
+    void test_date_round_trip()
+    {
+        // every day from 1900-03-01 to 9999-12-31, the last date Excel can show
+        auto previous = xlnt::date::from_number(60, xlnt::calendar::windows_1900);
+
+        for (int number = 61; number <= 2958465; ++number)
+        {
+            const auto d = xlnt::date::from_number(number, xlnt::calendar::windows_1900);
+            xlnt_assert_equals(d.to_number(xlnt::calendar::windows_1900), number);
+            xlnt_assert(d.day == previous.day + 1 || (d.day == 1 && (d.month == previous.month + 1 || (d.month == 1 && d.year == previous.year + 1))));
+            previous = d;
+        }
+
+        xlnt_assert_equals(previous, xlnt::date(9999, 12, 31));
+    }
+
     void test_operators()
     {
         xlnt::date d1(2016, 7, 16);
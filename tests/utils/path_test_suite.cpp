@@ -38,6 +38,7 @@ public:
         register_test(test_msvc_empty_path_wide);
 #endif
         register_test(test_append);
+        register_test(test_components);
 #if XLNT_HAS_FEATURE(U8_STRING_VIEW)
         register_test(test_append_u8);
 #endif
@@ -74,6 +75,24 @@ public:
         xlnt_assert_equals(path.string(), "hello/world");
     }
 
+    void test_components()
+    {
+        const xlnt::path sheet("/xl/worksheets/sheet1.xml");
+        xlnt_assert_equals(sheet.filename(), "sheet1.xml");
+        xlnt_assert_equals(sheet.extension(), "xml");
+        xlnt_assert_equals(sheet.parent().string(), "xl/worksheets");
+        xlnt_assert_equals(xlnt::path("/").parent().string(), "/");
+        xlnt_assert_equals(xlnt::path("/xl/").parent().string(), "");
+        xlnt_assert_equals(xlnt::path().parent().string(), "");
+        xlnt_assert_equals(xlnt::path().filename(), "");
+
+        xlnt_assert_equals(xlnt::path("../drawings/vmlDrawing1.vml").resolve(sheet.parent()).string(), "xl/drawings/vmlDrawing1.vml");
+        xlnt_assert_equals(xlnt::path("/xl").append(xlnt::path("worksheets//sheet1.xml")).string(), "/xl/worksheets/sheet1.xml");
+        xlnt_assert_equals(sheet.relative_to(xlnt::path("/xl")).string(), "worksheets/sheet1.xml");
+        xlnt_assert_equals(sheet.relative_to(xlnt::path("/docProps")).string(), "xl/worksheets/sheet1.xml");
+        xlnt_assert_equals(sheet.split().size(), 4);
+    }
+
 #if XLNT_HAS_FEATURE(U8_STRING_VIEW)
     void test_append_u8()
     {
@@ -0,0 +1,150 @@
+// Copyright (c) 2014-2022 Thomas Fussell
+// Copyright (c) 2024-2025 xlnt-community
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <helpers/path_helper.hpp>
+#include <helpers/test_suite.hpp>
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/range.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+/// <summary>
+/// Reads the same workbooks from several threads at once. Build with XLNT_SANITIZE_THREAD
+/// to have data races reported.
+/// </summary>
+class concurrent_read_test_suite : public test_suite
+{
+public:
+    concurrent_read_test_suite()
+    {
+        register_test(test_read_lazy_workbook_concurrently);
+        register_test(test_read_builtin_formats_concurrently);
+    }
+
+    void test_read_lazy_workbook_concurrently()
+    {
+        xlnt::load_options options;
+        options.lazy_worksheets = true;
+        options.lazy_shared_strings = true;
+
+        for (const auto name : {"10_comments_hyperlinks_formulae.xlsx", "excel_test_sheet.xlsx", "15_phonetics.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+            const auto expected = describe(xlnt::workbook(file));
+
+            xlnt::workbook lazy;
+            lazy.load(file, options);
+            const auto &shared = lazy;
+
+            std::vector<std::string> results(4);
+            std::vector<std::thread> threads;
+
+            for (auto &result : results)
+            {
+                threads.emplace_back([&shared, &result]() { result = describe(shared); });
+            }
+
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+
+            for (const auto &result : results)
+            {
+                xlnt_assert_equals(result, expected);
+            }
+        }
+    }
+
+    void test_read_builtin_formats_concurrently()
+    {
+        std::vector<std::string> results(4);
+        std::vector<std::thread> threads;
+
+        for (auto &result : results)
+        {
+            threads.emplace_back([&result]() {
+                for (std::size_t id = 0; id < 50; ++id)
+                {
+                    if (xlnt::number_format::is_builtin_format(id))
+                    {
+                        result.append(xlnt::number_format::from_builtin_id(id).format_string());
+                    }
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        xlnt_assert(!results.front().empty());
+
+        for (const auto &result : results)
+        {
+            xlnt_assert_equals(result, results.front());
+        }
+    }
+
+private:
+    /// <summary>
+    /// Renders everything which is read from wb through its const interface.
+    /// </summary>
+    static std::string describe(const xlnt::workbook &wb)
+    {
+        std::string description;
+
+        for (std::size_t index = 0; index < wb.sheet_count(); ++index)
+        {
+            const auto ws = wb.sheet_by_index(index);
+            description.append(ws.title()).append(ws.calculate_dimension().to_string()).append("\n");
+
+            for (const auto row : ws.rows())
+            {
+                for (const auto cell : row)
+                {
+                    description.append(cell.reference().to_string()).append("=");
+                    description.append(cell.to_string()).append(";");
+
+                    if (cell.data_type() == xlnt::cell::type::shared_string)
+                    {
+                        description.append(cell.value<std::string>());
+                    }
+                }
+            }
+        }
+
+        return description;
+    }
+};
+
+static concurrent_read_test_suite x;
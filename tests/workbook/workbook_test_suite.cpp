@@ -23,7 +23,11 @@
 // @author: see AUTHORS file
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <sstream>
+#include <unordered_set>
 
 #include <xlnt/xlnt.hpp>
 #include <detail/serialization/open_stream.hpp>
@@ -40,6 +44,54 @@
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 
+namespace {
+
+// a byte_source over memory counting the bytes it is asked for
+class memory_source : public xlnt::byte_source
+{
+public:
+    explicit memory_source(std::vector<std::uint8_t> data)
+        : data(std::move(data))
+    {
+    }
+
+    std::uint64_t size() override
+    {
+        return data.size();
+    }
+
+    void read(std::uint64_t offset, std::uint8_t *destination, std::size_t count) override
+    {
+        std::memcpy(destination, data.data() + offset, count);
+        fetched += count;
+    }
+
+    std::vector<std::uint8_t> data;
+    std::atomic<std::size_t> fetched{0};
+};
+
+class memory_sink : public xlnt::byte_sink
+{
+public:
+    void write(std::uint64_t offset, const std::uint8_t *bytes, std::size_t count) override
+    {
+        xlnt_assert_equals(offset, data.size());
+        data.insert(data.end(), bytes, bytes + count);
+        ++chunks;
+    }
+
+    void finish() override
+    {
+        finished = true;
+    }
+
+    std::vector<std::uint8_t> data;
+    std::size_t chunks = 0;
+    bool finished = false;
+};
+
+} // namespace
+
 class workbook_test_suite : public test_suite
 {
 public:
@@ -47,8 +99,11 @@ public:
     {
         register_test(test_active_sheet);
         register_test(test_create_sheet);
+        register_test(test_empty_workbooks_independent);
         register_test(test_add_correct_sheet);
         register_test(test_add_sheet_from_other_workbook);
+        register_test(test_copy_sheet_between_workbooks);
+        register_test(test_merge_from);
         register_test(test_add_sheet_at_index);
         register_test(test_get_sheet_by_title);
         register_test(test_get_sheet_by_title_const);
@@ -56,6 +111,7 @@ public:
         register_test(test_get_sheet_by_index_const);
         register_test(test_index_operator);
         register_test(test_contains);
+        register_test(test_sheet_lookup_after_changes);
         register_test(test_iter);
         register_test(test_const_iter);
         register_test(test_get_index);
@@ -65,6 +121,10 @@ public:
         register_test(test_remove_named_range);
         register_test(test_post_increment_iterator);
         register_test(test_clone);
+        register_test(test_clone_copy_on_access);
+        register_test(test_clone_copy_on_access_formats);
+        register_test(test_save_async);
+        register_test(test_format_by_index);
         register_test(test_copy_constructor);
         register_test(test_copy_assignment_operator);
         register_test(test_copy_iterator);
@@ -73,8 +133,35 @@ public:
         register_test(test_clear);
         register_test(test_comparison);
         register_test(test_id_gen);
+        register_test(test_relationship_ids);
+        register_test(test_pooled_cells);
         register_test(test_load_file);
         register_test(test_load_file_encrypted);
+        register_test(test_encryption_key);
+        register_test(test_load_pipelined_sheet_data);
+        register_test(test_load_inflate_ahead);
+        register_test(test_load_concurrent_worksheets);
+        register_test(test_load_worksheet_loaded);
+        register_test(test_load_decompression_buffer_size);
+        register_test(test_load_memory_mapped);
+        register_test(test_load_lazy_worksheets);
+        register_test(test_loader);
+        register_test(test_peek);
+        register_test(test_byte_source_and_sink);
+        register_test(test_sheet_data_fragments);
+        register_test(test_load_lazy_shared_strings);
+        register_test(test_compact_shared_strings);
+        register_test(test_io_stats);
+        register_test(test_memory_usage);
+        register_test(test_shrink_to_fit);
+        register_test(test_progress);
+        register_test(test_load_limits);
+        register_test(test_custom_executor);
+        register_test(test_lazy_binaries);
+        register_test(test_load_values_only);
+        register_test(test_preserve_unchanged_parts);
+        register_test(test_update);
+        register_test(test_calculate);
         register_test(test_Issue279);
         register_test(test_Issue353);
         register_test(test_Issue494);
@@ -102,6 +189,24 @@ public:
         xlnt_assert_equals(new_sheet, wb[last]);
     }
 
+    void test_empty_workbooks_independent()
+    {
+        xlnt::workbook first;
+        first.active_sheet().cell("A1").value(1);
+        first.create_sheet().title("Only in first");
+        first.thumbnail({1, 2, 3}, "jpeg", "image/jpeg");
+
+        // both are copies of one template, changing one doesn't change the next
+        xlnt::workbook second;
+        xlnt_assert_equals(second.sheet_count(), 1);
+        xlnt_assert(!second.contains("Only in first"));
+        xlnt_assert(!second.active_sheet().has_cell("A1"));
+        xlnt_assert_equals(first.thumbnail().size(), 3);
+        xlnt_assert(second.thumbnail().size() > 3);
+        xlnt_assert(second.compare(xlnt::workbook::empty(), false));
+        xlnt_assert(!second.compare(first, false));
+    }
+
     void test_add_correct_sheet()
     {
         xlnt::workbook wb;
@@ -118,10 +223,117 @@ public:
     {
         xlnt::workbook wb1, wb2;
         auto new_sheet = wb1.active_sheet();
-        xlnt_assert_throws(wb2.copy_sheet(new_sheet), xlnt::invalid_parameter);
+        new_sheet.cell("A1").value("copied");
+        auto copy = wb2.copy_sheet(new_sheet);
+        xlnt_assert_equals(wb2.index(copy), 1);
+        xlnt_assert_equals(copy.cell("A1").value<std::string>(), "copied");
         xlnt_assert_throws(wb2.index(new_sheet), std::runtime_error);
     }
 
+    void test_copy_sheet_between_workbooks()
+    {
+        const xlnt::workbook source(path_helper::test_file("4_every_style.xlsx"));
+        const auto original = source.sheet_by_index(0);
+
+        // strings and formats of the target take other indices than those of the source
+        xlnt::workbook target;
+        target.active_sheet().cell("A1").value("already there");
+        target.active_sheet().cell("A1").font(xlnt::font().size(42));
+        const auto copy = target.copy_sheet(original, 0);
+        xlnt_assert_equals(target.index(copy), 0);
+        xlnt_assert_equals(target.sheet_by_index(1).cell("A1").value<std::string>(), "already there");
+
+        std::size_t cells = 0;
+
+        for (auto row : original.rows())
+        {
+            for (auto cell : row)
+            {
+                const auto copied = copy.cell(cell.reference());
+                xlnt_assert_equals(copied.data_type(), cell.data_type());
+                xlnt_assert_equals(copied.to_string(), cell.to_string());
+                xlnt_assert_equals(copied.has_format(), cell.has_format());
+
+                if (cell.has_format())
+                {
+                    xlnt_assert_equals(copied.font(), cell.font());
+                    xlnt_assert_equals(copied.fill(), cell.fill());
+                    xlnt_assert_equals(copied.border(), cell.border());
+                    xlnt_assert_equals(copied.number_format(), cell.number_format());
+                }
+
+                ++cells;
+            }
+        }
+
+        xlnt_assert(cells > 0);
+
+        // the copy survives a round trip through the target
+        std::vector<std::uint8_t> data;
+        target.save(data);
+        xlnt::workbook reloaded;
+        reloaded.load(data);
+        xlnt_assert_equals(reloaded.sheet_by_index(0).calculate_dimension(), original.calculate_dimension());
+    }
+
+    void test_merge_from()
+    {
+        const auto department = [](const std::string &name, double total) {
+            xlnt::workbook wb;
+            auto ws = wb.active_sheet();
+            ws.title("Totals of the department " + name);
+            ws.cell("A1").value("department");
+            ws.cell("B1").value(name);
+            ws.cell("A2").value("total");
+            ws.cell("B2").value(total);
+            ws.cell("B2").font(xlnt::font().bold(true));
+            ws.cell("B2").number_format(xlnt::number_format("#,##0.00 \"EUR\""));
+            return wb;
+        };
+
+        xlnt::workbook merged;
+        merged.active_sheet().cell("A1").value("department");
+
+        std::vector<xlnt::workbook> sources;
+        sources.push_back(department("sales", 1.5));
+        sources.push_back(department("sales", 2.5));
+        sources.push_back(department("it", 3.5));
+        auto first = sources.front();
+        merged.merge_from(std::move(sources));
+        xlnt_assert(sources.empty());
+        xlnt_assert_equals(first.sheet_count(), 0);
+
+        // the title taken by the first sales sheet is shortened to make room for the number
+        const std::vector<std::string> titles = {"Sheet1", "Totals of the department sales",
+            "Totals of the department sa (2)", "Totals of the department it"};
+        xlnt_assert_equals(merged.sheet_titles(), titles);
+
+        // equal strings are shared
+        xlnt_assert_equals(merged.shared_strings().size(), 4);
+        const auto sales = merged.sheet_by_index(1).cell("B2");
+        const auto it = merged.sheet_by_index(3).cell("B2");
+        xlnt_assert_equals(merged.sheet_by_index(3).cell("B1").value<std::string>(), "it");
+        xlnt_assert_equals(it.value<double>(), 3.5);
+        xlnt_assert(it.font().bold());
+        xlnt_assert_equals(it.number_format().format_string(), "#,##0.00 \"EUR\"");
+        xlnt_assert_equals(sales.number_format(), it.number_format());
+
+        std::vector<std::uint8_t> data;
+        merged.save(data);
+        xlnt::workbook reloaded;
+        reloaded.load(data);
+        xlnt_assert_equals(reloaded.sheet_by_index(2).cell("B2").value<double>(), 2.5);
+
+        // nothing is merged if a title is taken and mustn't be renamed
+        std::vector<xlnt::workbook> duplicates;
+        duplicates.push_back(department("sales", 4.5));
+        xlnt::merge_options options;
+        options.rename_duplicates = false;
+        xlnt_assert_throws(merged.merge_from(std::move(duplicates), options), xlnt::invalid_parameter);
+        xlnt_assert_equals(merged.sheet_count(), 4);
+        xlnt_assert_equals(duplicates.size(), 1);
+    }
+
     void test_add_sheet_at_index()
     {
         xlnt::workbook wb;
@@ -200,6 +412,43 @@ public:
         xlnt_assert(!wb.contains("NotThere"));
     }
 
+    void test_sheet_lookup_after_changes()
+    {
+        xlnt::workbook wb;
+
+        for (int i = 0; i < 9; ++i)
+        {
+            wb.create_sheet();
+        }
+
+        // each lookup between changes uses what the previous changes left
+        xlnt_assert_equals(wb.sheet_by_index(9).title(), "Sheet10");
+        auto renamed = wb.sheet_by_title("Sheet5");
+        renamed.title("Renamed");
+        xlnt_assert(!wb.contains("Sheet5"));
+        xlnt_assert_equals(wb.sheet_by_title("Renamed"), renamed);
+        xlnt_assert_equals(wb.index(renamed), 4);
+
+        wb.move_sheet(renamed, 0);
+        xlnt_assert_equals(wb.sheet_by_index(0), renamed);
+        xlnt_assert_equals(wb.index(wb.sheet_by_title("Sheet1")), 1);
+
+        wb.remove_sheet(wb.sheet_by_title("Sheet1"));
+        xlnt_assert_throws(wb.sheet_by_title("Sheet1"), xlnt::key_not_found);
+        xlnt_assert_equals(wb.index(wb.sheet_by_title("Sheet2")), 1);
+        xlnt_assert_equals(wb.sheet_count(), 9);
+
+        auto inserted = wb.create_sheet(1);
+        xlnt_assert_equals(wb.sheet_by_index(1), inserted);
+        xlnt_assert_equals(wb.sheet_by_title(inserted.title()), inserted);
+        xlnt_assert_equals(wb.index(wb.sheet_by_title("Sheet10")), 9);
+
+        const auto copy = wb.clone(xlnt::workbook::clone_method::deep_copy);
+        xlnt_assert_equals(copy.sheet_by_title("Renamed").title(), "Renamed");
+        xlnt_assert_differs(copy.sheet_by_index(0), renamed);
+        xlnt_assert_throws(copy.sheet_by_index(10), xlnt::invalid_parameter);
+    }
+
     void test_iter()
     {
         xlnt::workbook wb;
@@ -389,6 +638,125 @@ public:
         xlnt_assert_throws(wb1.sheet_by_title("NEW_CHANGED_AGAIN"), xlnt::key_not_found);
     }
 
+    void test_save_async()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.title("Live");
+
+        for (auto row = 1u; row <= 1000; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value("row " + std::to_string(row));
+        }
+
+        temporary_file file;
+        auto saved = wb.save_async(file.get_path());
+
+        // the live workbook keeps changing while the snapshot is written
+        ws.cell("A1").value("changed");
+        ws.title("Renamed");
+        wb.create_sheet().cell("A1").value(1);
+        saved.get();
+
+        xlnt::workbook loaded(file.get_path());
+        xlnt_assert_equals(loaded.sheet_count(), 1);
+        auto loaded_ws = loaded.sheet_by_title("Live");
+        xlnt_assert_equals(loaded_ws.cell("A1").value<int>(), 1);
+        xlnt_assert_equals(loaded_ws.cell("B1000").value<std::string>(), "row 1000");
+    }
+
+    void test_clone_copy_on_access()
+    {
+        auto clone = xlnt::workbook();
+        auto chained = xlnt::workbook();
+
+        {
+            xlnt::workbook original;
+            auto ws = original.active_sheet();
+            ws.title("Template");
+            ws.cell("A1").value("original");
+            ws.cell("B2").value(1.5);
+            ws.cell("B2").font(xlnt::font().bold(true));
+            ws.cell("C3").comment(xlnt::comment("note", "author"));
+            original.create_sheet().cell("A1").value(2);
+
+            clone = original.clone(xlnt::workbook::clone_method::copy_on_access);
+            chained = clone.clone(xlnt::workbook::clone_method::copy_on_access);
+
+            clone.sheet_by_index(0).cell("A1").value("changed");
+            xlnt_assert_equals(ws.cell("A1").value<std::string>(), "original");
+            xlnt_assert_equals(chained.sheet_by_index(0).cell("A1").value<std::string>(), "original");
+        }
+
+        auto ws = clone.sheet_by_title("Template");
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "changed");
+        xlnt_assert_equals(ws.cell("B2").value<double>(), 1.5);
+        xlnt_assert(ws.cell("B2").font().bold());
+        xlnt_assert_equals(ws.cell("C3").comment().plain_text(), "note");
+        xlnt_assert_equals(clone.sheet_by_index(1).cell("A1").value<int>(), 2);
+
+        // formats of the clone are its own
+        ws.cell("B2").font(xlnt::font().italic(true));
+        xlnt_assert(chained.sheet_by_index(0).cell("B2").font().bold());
+        xlnt_assert(!chained.sheet_by_index(0).cell("B2").font().italic());
+        xlnt_assert_equals(chained.sheet_by_index(1).cell("A1").value<int>(), 2);
+        xlnt_assert_equals(chained.sheet_by_index(0).cell("C3").comment().author(), "author");
+
+        xlnt_assert(clone.clone(xlnt::workbook::clone_method::deep_copy).compare(clone, false));
+    }
+
+    void test_clone_copy_on_access_formats()
+    {
+        xlnt::workbook original;
+        auto first = original.active_sheet();
+        first.title("First");
+        first.cell("A1").font(xlnt::font().italic(true));
+        auto second = original.create_sheet();
+        second.title("Second");
+        second.cell("A1").font(xlnt::font().bold(true));
+        auto third = original.create_sheet();
+        third.title("Third");
+        third.cell("A1").value(3);
+        auto fourth = original.create_sheet();
+        fourth.title("Fourth");
+        fourth.cell("A1").value(4);
+
+        auto clone = original.clone(xlnt::workbook::clone_method::copy_on_access);
+        xlnt_assert(clone.sheet_by_title("First").cell("A1").font().italic());
+
+        // saving collects the italic format, which renumbers the bold one
+        first.cell("A1").font(xlnt::font());
+        std::vector<std::uint8_t> saved;
+        original.save(saved);
+
+        const auto bold = clone.sheet_by_title("Second").cell("A1").font();
+        xlnt_assert(bold.bold());
+        xlnt_assert(!bold.italic());
+
+        // a format created after the clone may be stored where the collected one was
+        fourth.cell("A1").font(xlnt::font().strikethrough(true));
+        xlnt_assert_throws(clone.sheet_by_title("Fourth").cell("A1"), xlnt::exception);
+
+        original.remove_sheet(original.sheet_by_title("Third"));
+        xlnt_assert_throws(clone.sheet_by_title("Third").cell("A1"), xlnt::exception);
+    }
+
+    void test_format_by_index()
+    {
+        xlnt::workbook wb1;
+        const std::size_t count = 1; // the default format
+
+        for (std::size_t i = 0; i < 3000; ++i)
+        {
+            wb1.create_format().pivot_button(i % 2 == 1);
+        }
+
+        xlnt_assert(!wb1.format(count + 2998).pivot_button());
+        xlnt_assert(wb1.format(count + 2999).pivot_button());
+        xlnt_assert_throws(wb1.format(count + 3000), xlnt::invalid_parameter);
+    }
+
     void test_copy_constructor()
     {
         xlnt::workbook wb1;
@@ -511,6 +879,71 @@ public:
         xlnt_assert_differs(wb[1].id(), wb[2].id());
     }
 
+    void test_relationship_ids()
+    {
+        xlnt::manifest m;
+        const xlnt::uri source("/xl/workbook.xml");
+        m.register_relationship(xlnt::relationship("rId2", xlnt::relationship_type::stylesheet,
+            source, xlnt::uri("styles.xml"), xlnt::target_mode::internal));
+        // the lowest free id is reused
+        xlnt_assert_equals(m.register_relationship(source, xlnt::relationship_type::theme,
+                               xlnt::uri("theme/theme1.xml"), xlnt::target_mode::internal),
+            "rId1");
+        xlnt_assert_equals(m.register_relationship(source, xlnt::relationship_type::worksheet,
+                               xlnt::uri("worksheets/sheet1.xml"), xlnt::target_mode::internal),
+            "rId3");
+        xlnt_assert_equals(m.relationship(source.path(), "rId2").type(), xlnt::relationship_type::stylesheet);
+        xlnt_assert_throws(m.relationship(source.path(), "rId4"), xlnt::key_not_found);
+
+        xlnt::workbook wb;
+        for (auto i = 0; i < 20; ++i)
+        {
+            wb.create_sheet();
+        }
+        std::unordered_set<std::string> drawings;
+        for (auto ws : wb)
+        {
+            ws.cell("A1").comment(xlnt::comment("note", "author"));
+            drawings.insert(wb.manifest().relationship(ws.path(), xlnt::relationship_type::vml_drawing).target().path().string());
+        }
+        xlnt_assert_equals(wb.sheet_count(), 21);
+        xlnt_assert_equals(drawings.size(), 21);
+        const auto wb_path = wb.manifest().relationship(xlnt::path("/"), xlnt::relationship_type::office_document).target().path();
+        xlnt_assert_equals(wb.manifest().relationships(wb_path, xlnt::relationship_type::worksheet).size(), 21);
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        xlnt_assert_equals(loaded.sheet_count(), 21);
+        xlnt_assert_equals(loaded.sheet_by_index(20).cell("A1").comment().plain_text(), "note");
+    }
+
+    void test_pooled_cells()
+    {
+        // copies of a workbook allocate their cells and shared strings from pools of their own
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        for (xlnt::row_t row = 1; row <= 2000; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value("text " + std::to_string(row % 100));
+        }
+
+        auto copy = wb.clone(xlnt::workbook::clone_method::deep_copy);
+        ws.clear_cell("A7");
+        ws.cell(3, 1).value(true);
+        xlnt_assert_equals(copy.active_sheet().cell("A7").value<int>(), 7);
+        xlnt_assert(!copy.active_sheet().has_cell("C1"));
+        xlnt_assert_equals(copy.active_sheet().cell("B150").value<std::string>(), "text 50");
+
+        wb = xlnt::workbook();
+        copy.active_sheet().cell("B2001").value("text new");
+        xlnt_assert_equals(copy.active_sheet().cell("B2001").value<std::string>(), "text new");
+        xlnt_assert_equals(copy.shared_strings().size(), 101);
+        xlnt_assert(copy.memory_usage().cells > 0);
+    }
+
     void test_load_file()
     {
         xlnt::path file = path_helper::test_file("2_minimal.xlsx");
@@ -546,6 +979,1043 @@ public:
         xlnt_assert(wb_path.compare(wb_load5, false));
     }
 
+    void test_load_pipelined_sheet_data()
+    {
+        for (const auto &name : {"10_comments_hyperlinks_formulae.xlsx", "18_formulae.xlsx", "excel_test_sheet.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+            xlnt::workbook expected(file);
+
+            for (std::size_t batch_size : {std::size_t(1), std::size_t(7), std::size_t(4096)})
+            {
+                xlnt::load_options options;
+                options.pipelined_sheet_data = true;
+                options.sheet_data_batch_size = batch_size;
+
+                xlnt::workbook pipelined;
+                pipelined.load(file, options);
+                xlnt_assert(expected.compare(pipelined, false));
+            }
+        }
+    }
+
+    void test_load_inflate_ahead()
+    {
+        for (const auto &name : {"10_comments_hyperlinks_formulae.xlsx", "14_images.xlsx", "excel_test_sheet.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+            xlnt::workbook expected(file);
+
+            // small blocks make the parser wait on the reading thread often
+            for (std::size_t block_size : {std::size_t(16), std::size_t(128 * 1024)})
+            {
+                for (std::size_t threads : {std::size_t(1), std::size_t(2)})
+                {
+                    xlnt::load_options options;
+                    options.fast_sheet_data = false;
+                    options.inflate_ahead = true;
+                    options.decompression_buffer_size = block_size;
+                    options.worksheet_threads = threads;
+
+                    xlnt::workbook read_ahead;
+                    read_ahead.load(file, options);
+                    xlnt_assert(expected.compare(read_ahead, false));
+                }
+            }
+        }
+    }
+
+    void test_load_concurrent_worksheets()
+    {
+        for (const auto &name : {"10_comments_hyperlinks_formulae.xlsx", "14_images.xlsx", "19_defined_names.xlsx", "excel_test_sheet.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+            xlnt::workbook expected(file);
+
+            for (std::size_t threads : {std::size_t(2), std::size_t(3), std::size_t(16)})
+            {
+                xlnt::load_options options;
+                options.worksheet_threads = threads;
+
+                xlnt::workbook concurrent;
+                concurrent.load(file, options);
+                xlnt_assert_equals(expected.sheet_titles(), concurrent.sheet_titles());
+                xlnt_assert(expected.compare(concurrent, false));
+            }
+        }
+
+        // the shared strings and the stylesheet are read alongside sheetData, so the formats
+        // of the cells and the hyperlinks displaying shared strings are only resolved afterwards
+        xlnt::workbook styled;
+        auto ws = styled.active_sheet();
+        auto percent = styled.create_format().number_format(xlnt::number_format::percentage(), xlnt::optional<bool>(true));
+        auto bold = styled.create_format().font(xlnt::font().bold(true), xlnt::optional<bool>(true));
+
+        for (xlnt::row_t row = 1; row <= 200; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 6; ++column)
+            {
+                auto cell = ws.cell(column, row);
+
+                if (column % 2 == 0)
+                {
+                    cell.value("text " + std::to_string(row * column));
+                    cell.format(bold);
+                }
+                else
+                {
+                    cell.value(row / 100.0);
+                    cell.format(row % 3 == 0 ? bold : percent);
+                }
+            }
+        }
+
+        ws.cell("B7").hyperlink("https://example.com/");
+        styled.create_sheet().cell("A1").value("second");
+
+        temporary_file styled_file;
+        styled.save(styled_file.get_path());
+        xlnt::workbook sequential(styled_file.get_path());
+
+        xlnt::load_options options;
+        options.worksheet_threads = 4;
+        xlnt::workbook concurrent;
+        concurrent.load(styled_file.get_path(), options);
+        xlnt_assert(sequential.compare(concurrent, false));
+
+        const auto loaded = concurrent.active_sheet();
+        xlnt_assert_equals(loaded.cell("B7").value<std::string>(), "text 14");
+        xlnt_assert_equals(loaded.cell("B7").hyperlink().url(), "https://example.com/");
+        xlnt_assert(loaded.cell("A1").number_format() == xlnt::number_format::percentage());
+        xlnt_assert(loaded.cell("A3").font().bold());
+        xlnt_assert(loaded.cell("F200").font().bold());
+        xlnt_assert_equals(loaded.cell("F200").value<std::string>(), "text 1200");
+    }
+
+    void test_load_worksheet_loaded()
+    {
+        const auto file = path_helper::test_file("excel_test_sheet.xlsx");
+        xlnt::workbook expected(file);
+
+        for (std::size_t threads : {std::size_t(1), std::size_t(3)})
+        {
+            std::vector<std::string> titles;
+            std::vector<std::size_t> cells;
+            xlnt::load_options options;
+            options.worksheet_threads = threads;
+            options.worksheet_loaded = [&](xlnt::worksheet ws) {
+                titles.push_back(ws.title());
+                std::size_t count = 0;
+
+                for (auto row : ws.rows(false))
+                {
+                    count += row.length();
+                }
+
+                cells.push_back(count);
+            };
+
+            xlnt::workbook loaded;
+            loaded.load(file, options);
+
+            // each worksheet is passed once, complete
+            auto sorted = titles;
+            std::sort(sorted.begin(), sorted.end());
+            auto expected_titles = expected.sheet_titles();
+            std::sort(expected_titles.begin(), expected_titles.end());
+            xlnt_assert_equals(sorted, expected_titles);
+
+            for (std::size_t i = 0; i < titles.size(); ++i)
+            {
+                std::size_t count = 0;
+
+                for (auto row : expected.sheet_by_title(titles[i]).rows(false))
+                {
+                    count += row.length();
+                }
+
+                xlnt_assert_equals(cells[i], count);
+            }
+        }
+    }
+
+    void test_load_decompression_buffer_size()
+    {
+        const auto file = path_helper::test_file("excel_test_sheet.xlsx");
+        xlnt::workbook expected(file);
+
+        for (std::size_t buffer_size : {std::size_t(0), std::size_t(513), std::size_t(1024 * 1024)})
+        {
+            xlnt::load_options options;
+            options.decompression_buffer_size = buffer_size;
+
+            xlnt::workbook loaded;
+            loaded.load(file, options);
+            xlnt_assert(expected.compare(loaded, false));
+        }
+    }
+
+    void test_load_memory_mapped()
+    {
+        xlnt::load_options options;
+        options.memory_map = true;
+
+        const auto file = path_helper::test_file("excel_test_sheet.xlsx");
+        xlnt::workbook expected(file);
+        xlnt::workbook mapped;
+        mapped.load(file, options);
+        xlnt_assert(expected.compare(mapped, false));
+
+        // stored parts are read straight from the mapping
+        temporary_file stored_file;
+        xlnt::save_options stored;
+        stored.compression = xlnt::compression_level::none;
+        expected.save(stored_file.get_path(), stored);
+
+        xlnt::workbook plain_stored(stored_file.get_path());
+        xlnt::workbook mapped_stored;
+        mapped_stored.load(stored_file.get_path(), options);
+        xlnt_assert(plain_stored.compare(mapped_stored, false));
+
+        options.worksheet_threads = 2;
+        xlnt::workbook mapped_concurrent;
+        mapped_concurrent.load(file, options);
+        xlnt_assert(expected.compare(mapped_concurrent, false));
+
+        xlnt_assert_throws(mapped.load(path_helper::test_file("does_not_exist.xlsx"), options), xlnt::exception);
+    }
+
+    void test_loader()
+    {
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::workbook expected(file);
+        std::vector<std::uint8_t> data;
+        expected.save(data);
+
+        xlnt::loader loader;
+        xlnt_assert_equals(loader.retained_bytes(), 0);
+
+        xlnt::workbook first;
+        loader.load(first, file);
+        xlnt_assert(expected.compare(first, false));
+        xlnt_assert(loader.retained_bytes() > 0);
+
+        // later loads take over the buffers of the first one
+        xlnt::workbook second;
+        loader.load(second, data);
+        xlnt_assert(expected.compare(second, false));
+        xlnt::workbook third;
+        loader.load(third, file);
+        xlnt_assert(expected.compare(third, false));
+
+        xlnt::load_options options;
+        options.worksheet_threads = 2;
+        options.decompression_buffer_size = 1024;
+        std::ifstream stream;
+        xlnt::detail::open_stream(stream, file.string());
+        xlnt::workbook concurrent;
+        loader.load(concurrent, stream, options);
+        xlnt_assert(expected.compare(concurrent, false));
+
+        loader.release();
+        xlnt_assert_equals(loader.retained_bytes(), 0);
+        xlnt_assert_throws(loader.load(first, path_helper::test_file("does_not_exist.xlsx")), xlnt::exception);
+    }
+
+    void test_peek()
+    {
+        xlnt::workbook wb;
+        wb.core_property(xlnt::core_property::title, "peeked");
+        auto data = wb.active_sheet();
+        data.title("Data");
+        data.cell("B2").value(1);
+        data.cell("D40").value("last");
+        auto hidden = wb.create_sheet();
+        hidden.title("Hidden");
+        hidden.sheet_state(xlnt::sheet_state::hidden);
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        xlnt::workbook loaded;
+        loaded.load(saved);
+
+        std::istringstream stream(std::string(saved.begin(), saved.end()));
+        const auto summary = xlnt::peek(stream);
+        xlnt_assert_equals(summary.sheets.size(), 2);
+        xlnt_assert_equals(summary.sheets[0].title, "Data");
+        xlnt_assert(!summary.sheets[0].hidden);
+        xlnt_assert(summary.sheets[0].dimension.is_set());
+        xlnt_assert_equals(summary.sheets[0].dimension.get(), loaded.sheet_by_index(0).calculate_dimension());
+        xlnt_assert_equals(summary.sheets[1].title, "Hidden");
+        xlnt_assert(summary.sheets[1].hidden);
+
+        const auto title = std::find_if(summary.core_properties.begin(), summary.core_properties.end(),
+            [](const std::pair<xlnt::core_property, xlnt::variant> &property) {
+                return property.first == xlnt::core_property::title;
+            });
+        xlnt_assert(title != summary.core_properties.end());
+        xlnt_assert_equals(title->second.get<std::string>(), "peeked");
+
+        // the titles of a file saved elsewhere come in the order of the workbook
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        std::vector<std::string> titles;
+
+        for (const auto &sheet : xlnt::peek(file).sheets)
+        {
+            titles.push_back(sheet.title);
+        }
+
+        xlnt_assert_equals(titles, xlnt::workbook(file).sheet_titles());
+
+        std::istringstream not_xlsx("not a zip file");
+        xlnt_assert_throws_nothing(xlnt::peek(path_helper::test_file("excel_test_sheet.xlsx")));
+        xlnt_assert_throws(xlnt::peek(not_xlsx), xlnt::exception);
+    }
+
+    void test_load_lazy_worksheets()
+    {
+        xlnt::load_options options;
+        options.lazy_worksheets = true;
+
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::workbook expected(file);
+
+        xlnt::workbook lazy;
+        {
+            // the workbook keeps its own copy of the data the worksheets are read from
+            std::vector<std::uint8_t> data;
+            expected.save(data);
+            lazy.load(data, options);
+            expected.load(data);
+        }
+
+        xlnt_assert_equals(lazy.sheet_count(), 2);
+        xlnt_assert_equals(lazy.sheet_titles(), expected.sheet_titles());
+        xlnt_assert(lazy.contains(expected.sheet_titles().back()));
+        xlnt_assert(lazy.sheet_by_index(1).compare(expected.sheet_by_index(1), false));
+        xlnt_assert(lazy.compare(expected, false));
+
+        // saving reads every worksheet which hasn't been accessed yet
+        xlnt::workbook lazy_file;
+        lazy_file.load(file, options);
+        std::vector<std::uint8_t> saved;
+        lazy_file.save(saved);
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        xlnt_assert(reloaded.compare(xlnt::workbook(file), false));
+
+        // a deep copy doesn't share the worksheets which are still waiting to be read
+        xlnt::workbook lazy_original;
+        lazy_original.load(file, options);
+        auto copy = lazy_original.clone(xlnt::workbook::clone_method::deep_copy);
+        lazy_original.sheet_by_index(0).cell("A1").value("changed");
+        xlnt_assert_equals(copy.sheet_by_index(0).cell("A1").value<std::string>(),
+            expected.sheet_by_index(0).cell("A1").value<std::string>());
+    }
+
+    void test_byte_source_and_sink()
+    {
+        xlnt::workbook wb;
+        auto big = wb.active_sheet();
+        big.title("Big");
+
+        for (auto row = 1u; row <= 2000; ++row)
+        {
+            for (auto column = 1u; column <= 20; ++column)
+            {
+                big.cell(column, row).value(row * 1.0001 + column * 7919.0);
+            }
+        }
+
+        wb.create_sheet().title("Small");
+        wb.sheet_by_title("Small").cell("A1").value("small");
+
+        memory_sink sink;
+        xlnt::save_options save;
+        save.sink_chunk_size = 4096;
+        wb.save(sink, save);
+        xlnt_assert(sink.finished);
+        xlnt_assert(sink.chunks > 1);
+
+        xlnt::workbook from_bytes;
+        from_bytes.load(sink.data);
+        xlnt_assert(from_bytes.compare(wb, false));
+
+        xlnt::load_options load;
+        load.source_block_size = 4096;
+        xlnt::workbook loaded;
+        loaded.load(std::make_shared<memory_source>(sink.data), load);
+        xlnt_assert(loaded.compare(wb, false));
+
+        // only the parts of the worksheets accessed are fetched
+        load.lazy_worksheets = true;
+        auto source = std::make_shared<memory_source>(sink.data);
+        xlnt::workbook lazy;
+        lazy.load(source, load);
+        xlnt_assert_equals(lazy.sheet_by_title("Small").cell("A1").value<std::string>(), "small");
+        xlnt_assert(source->fetched < source->data.size() / 2);
+        xlnt_assert_equals(lazy.sheet_by_title("Big").cell("T2000").value<double>(), 2000 * 1.0001 + 20 * 7919.0);
+        xlnt_assert(lazy.compare(wb, false));
+    }
+
+    void test_sheet_data_fragments()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.title("Data");
+        ws.cell("A1").value("id");
+        ws.cell("B1").value("name");
+        wb.create_sheet().title("Other");
+
+        // each worker writes the rows of its own range, here of copies of the same workbook
+        std::vector<xlnt::deflated_fragment> fragments;
+        for (xlnt::row_t first = 2; first <= 2000; first += 1000)
+        {
+            xlnt::workbook worker;
+            auto worker_ws = worker.active_sheet();
+            for (auto row = first; row < first + 1000; ++row)
+            {
+                worker_ws.cell(1, row).value(static_cast<int>(row));
+                worker_ws.cell(2, row).value("name " + std::to_string(row % 10));
+            }
+            fragments.push_back(xlnt::deflated_fragment::from_sheet_data(worker_ws,
+                first == 2 ? xlnt::compression_level::fastest : xlnt::compression_level::none));
+        }
+
+        std::unordered_map<std::string, std::vector<xlnt::deflated_fragment>> sheet_fragments;
+        sheet_fragments["Data"] = fragments;
+        xlnt::save_options options;
+        options.sheet_data_fragments = &sheet_fragments;
+        options.worksheet_threads = 2;
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes, options);
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+
+        auto loaded_ws = loaded.sheet_by_title("Data");
+        xlnt_assert_equals(loaded_ws.cell("A1").value<std::string>(), "id");
+        xlnt_assert_equals(loaded_ws.cell("A2").value<int>(), 2);
+        xlnt_assert_equals(loaded_ws.cell("B1001").value<std::string>(), "name 1");
+        xlnt_assert_equals(loaded_ws.cell("A2001").value<int>(), 2001);
+        xlnt_assert_equals(loaded_ws.highest_row(), 2001);
+        xlnt_assert_equals(loaded.sheet_by_title("Other").highest_row(), 1);
+
+        // fragments concatenated ahead of time are spliced the same way
+        auto joined = fragments.front();
+        joined.append(fragments.back());
+        sheet_fragments["Data"] = {joined};
+        std::vector<std::uint8_t> joined_bytes;
+        wb.save(joined_bytes, options);
+        xlnt::workbook joined_loaded;
+        joined_loaded.load(joined_bytes);
+        xlnt_assert(joined_loaded.compare(loaded, false));
+    }
+
+    void test_load_lazy_shared_strings()
+    {
+        xlnt::load_options options;
+        options.lazy_shared_strings = true;
+
+        for (const auto name : {"excel_test_sheet.xlsx", "15_phonetics.xlsx", "Issue494_shared_string.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+            const xlnt::workbook expected(file);
+            xlnt::workbook lazy;
+            lazy.load(file, options);
+
+            for (std::size_t i = 0; i < expected.sheet_count(); ++i)
+            {
+                for (auto row : lazy.sheet_by_index(i).rows())
+                {
+                    for (auto cell : row)
+                    {
+                        const auto other = expected.sheet_by_index(i).cell(cell.reference());
+                        xlnt_assert_equals(cell.value<std::string>(), other.value<std::string>());
+                        xlnt_assert(cell.value<xlnt::rich_text>() == other.value<xlnt::rich_text>());
+                    }
+                }
+            }
+
+            xlnt_assert(lazy.compare(expected, false));
+        }
+
+        // modifying the table decodes every string first
+        xlnt::workbook lazy;
+        lazy.load(path_helper::test_file("Issue494_shared_string.xlsx"), options);
+        const auto first = lazy.shared_strings(0);
+        const auto count = lazy.add_shared_string(xlnt::rich_text("added"));
+        xlnt_assert_equals(lazy.shared_strings().size(), count + 1);
+        xlnt_assert(lazy.shared_strings(0) == first);
+        xlnt_assert_equals(lazy.add_shared_string(first), 0);
+    }
+
+    void test_compact_shared_strings()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("dropped");
+        ws.cell("A1").value("rare");
+        ws.cell("A2").value("common");
+        ws.cell("A3").value("common");
+        ws.cell("A4").value("common");
+        ws.cell("B1").value(xlnt::rich_text("rare"));
+        wb.add_shared_string(xlnt::rich_text("common"), true);
+        xlnt_assert_equals(wb.shared_strings().size(), 4);
+
+        xlnt_assert_equals(wb.compact_shared_strings(true), 2);
+        xlnt_assert_equals(wb.shared_strings().size(), 2);
+        xlnt_assert(wb.shared_strings(0) == xlnt::rich_text("common"));
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "rare");
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "rare");
+        xlnt_assert_equals(ws.cell("A3").value<std::string>(), "common");
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("rare")), 1);
+
+        ws.cell("A1").value("saved");
+        ws.cell("B1").clear_value();
+        xlnt::save_options options;
+        options.compact_shared_strings = true;
+        std::vector<std::uint8_t> data;
+        wb.save(data, options);
+        xlnt_assert_equals(wb.shared_strings().size(), 2);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.shared_strings().size(), 2);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<std::string>(), "saved");
+        xlnt_assert_equals(loaded.active_sheet().cell("A2").value<std::string>(), "common");
+    }
+
+    void test_memory_usage()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto empty = wb.memory_usage();
+        xlnt_assert_equals(empty.total(), empty.cells + empty.text + empty.formulas + empty.shared_strings
+            + empty.styles + empty.binaries + empty.comments);
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).value(static_cast<double>(row));
+        }
+
+        const auto numbers = wb.memory_usage();
+        xlnt_assert(numbers.cells >= empty.cells + 100 * sizeof(double));
+        xlnt_assert_equals(numbers.shared_strings, empty.shared_strings);
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(2, row).value("a string which is too long to be stored inline " + std::to_string(row));
+            ws.cell(3, row).formula("=A" + std::to_string(row) + "*2+SUM(A1:A100)*1000000");
+        }
+
+        ws.cell(4, 1).comment(xlnt::comment("a comment which is too long to be stored inline", "author"));
+
+        const auto filled = wb.memory_usage();
+        xlnt_assert(filled.shared_strings > numbers.shared_strings + 100 * 48);
+        xlnt_assert(filled.formulas > numbers.formulas + 100 * 20);
+        xlnt_assert(filled.comments > numbers.comments);
+
+        // the workbook adds its own parts to those of its worksheets
+        const auto sheet = ws.memory_usage();
+        xlnt_assert_equals(sheet.shared_strings, 0);
+        xlnt_assert_equals(sheet.formulas, filled.formulas);
+        xlnt_assert(filled.total() > sheet.total());
+
+        ws.clear_cell(xlnt::cell_reference(3, 1));
+        xlnt_assert(ws.memory_usage().formulas < sheet.formulas);
+
+        xlnt::load_options options;
+        options.lazy_worksheets = true;
+        xlnt::workbook lazy;
+        lazy.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), options);
+        const auto waiting = lazy.memory_usage();
+        xlnt_assert(waiting.binaries > 0);
+        lazy.sheet_by_index(0);
+        lazy.sheet_by_index(1);
+        const auto read = lazy.memory_usage();
+        xlnt_assert(read.cells > waiting.cells);
+        xlnt_assert(read.comments > 0);
+        xlnt_assert(read.binaries < waiting.binaries);
+    }
+
+    void test_shrink_to_fit()
+    {
+        xlnt::workbook wb;
+        wb.cell_storage(xlnt::cell_storage::dense_rows);
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 100; ++column)
+            {
+                ws.cell(column, row).value(static_cast<double>(column));
+            }
+        }
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            for (xlnt::column_t::index_t column = 2; column <= 100; ++column)
+            {
+                ws.clear_cell(xlnt::cell_reference(column, row));
+            }
+        }
+
+        // the blocks left empty by the cleared cells are released, the cells kept
+        auto kept = ws.cell("A50");
+        const auto before = wb.memory_usage();
+        wb.shrink_to_fit();
+        xlnt_assert(wb.memory_usage().cells < before.cells);
+        xlnt_assert_equals(kept.value<double>(), 1.0);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:A100"));
+        ws.cell("CV100").value(2);
+        xlnt_assert_equals(ws.cell("CV100").value<int>(), 2);
+
+        const xlnt::workbook expected(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"));
+        xlnt::load_options options;
+        options.shrink_to_fit = true;
+        xlnt::workbook shrunk;
+        shrunk.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), options);
+        xlnt_assert(expected.compare(shrunk, false));
+        xlnt_assert(shrunk.memory_usage().total() <= expected.memory_usage().total());
+    }
+
+    void test_progress()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+        auto second = wb.create_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 50; ++column)
+            {
+                first.cell(column, row).value(static_cast<double>(row));
+                second.cell(column, row).value(static_cast<double>(column));
+            }
+        }
+
+        // every worksheet ends with a single call for all of its cells
+        std::vector<xlnt::progress> calls;
+        auto record = [&calls](const xlnt::progress &current) {
+            calls.push_back(current);
+            return true;
+        };
+        auto check_calls = [&calls, &first, &second]() {
+            std::size_t done = 0;
+
+            for (std::size_t i = 0; i < calls.size(); ++i)
+            {
+                xlnt_assert(calls[i].worksheet == first.title() || calls[i].worksheet == second.title());
+                xlnt_assert(calls[i].worksheet_cells <= 5000);
+                xlnt_assert(i == 0 || calls[i].total_cells >= calls[i - 1].total_cells);
+
+                if (calls[i].worksheet_done)
+                {
+                    xlnt_assert_equals(calls[i].worksheet_cells, 5000);
+                    ++done;
+                }
+            }
+
+            xlnt_assert_equals(done, 2);
+            xlnt_assert(calls.size() > 2);
+            xlnt_assert_equals(calls.back().total_cells, 10000);
+        };
+
+        xlnt::save_options save_options;
+        save_options.progress = record;
+        save_options.progress_interval = 1000;
+        std::vector<std::uint8_t> data;
+        wb.save(data, save_options);
+        check_calls();
+
+        calls.clear();
+        save_options.worksheet_threads = 2;
+        wb.save(data, save_options);
+        check_calls();
+
+        xlnt::load_options load_options;
+        load_options.progress = record;
+        load_options.progress_interval = 1000;
+        load_options.sheet_data_batch_size = 500;
+
+        for (auto pipelined : {false, true})
+        {
+            for (auto threads : {std::size_t(1), std::size_t(2)})
+            {
+                calls.clear();
+                load_options.pipelined_sheet_data = pipelined;
+                load_options.worksheet_threads = threads;
+                xlnt::workbook loaded;
+                loaded.load(data, load_options);
+                check_calls();
+            }
+        }
+
+        // cancelling stops at the first call
+        auto cancel = [&calls](const xlnt::progress &current) {
+            calls.push_back(current);
+            return false;
+        };
+
+        calls.clear();
+        save_options.progress = cancel;
+        std::vector<std::uint8_t> cancelled_data;
+        xlnt_assert_throws(wb.save(cancelled_data, save_options), xlnt::operation_cancelled);
+        xlnt_assert_equals(calls.size(), 1);
+
+        calls.clear();
+        load_options.progress = cancel;
+        xlnt::workbook cancelled;
+        xlnt_assert_throws(cancelled.load(data, load_options), xlnt::operation_cancelled);
+        xlnt_assert_equals(calls.size(), 1);
+    }
+
+    void test_custom_executor()
+    {
+        // makes the calls one after another on the calling thread
+        class sequential_executor : public xlnt::executor
+        {
+        public:
+            void run(std::size_t thread_count, const std::function<void()> &worker) override
+            {
+                ++runs;
+                max_threads = std::max(max_threads, thread_count);
+
+                for (std::size_t i = 0; i < thread_count; ++i)
+                {
+                    worker();
+                }
+            }
+
+            std::size_t concurrency() const override
+            {
+                return 3;
+            }
+
+            std::size_t runs = 0;
+            std::size_t max_threads = 0;
+        };
+
+        xlnt::workbook wb;
+
+        for (int sheet = 0; sheet < 4; ++sheet)
+        {
+            auto ws = sheet == 0 ? wb.active_sheet() : wb.create_sheet();
+
+            for (xlnt::row_t row = 1; row <= 100; ++row)
+            {
+                ws.cell(1, row).value(static_cast<double>(row * sheet));
+                ws.cell(2, row).value("text " + std::to_string(row));
+            }
+        }
+
+        auto executor = std::make_shared<sequential_executor>();
+        xlnt::set_executor(executor);
+        xlnt_assert(xlnt::current_executor() == executor);
+
+        xlnt::save_options save_options;
+        save_options.worksheet_threads = 4;
+        std::vector<std::uint8_t> data;
+        wb.save(data, save_options);
+        const auto save_runs = executor->runs;
+        xlnt_assert(save_runs > 0);
+        xlnt_assert_equals(executor->max_threads, 4);
+
+        xlnt::load_options load_options;
+        load_options.worksheet_threads = 4;
+        xlnt::workbook loaded;
+        loaded.load(data, load_options);
+        const auto load_runs = executor->runs;
+        xlnt_assert(load_runs > save_runs);
+        xlnt_assert(wb.compare(loaded, false));
+
+        // a thread count of 0 asks the executor how many threads to use
+        std::atomic<std::size_t> visited(0);
+        executor->max_threads = 0;
+        loaded.active_sheet().parallel_for_each_cell([&visited](const xlnt::cell &) { ++visited; });
+        xlnt_assert_equals(visited.load(), 200);
+        xlnt_assert_equals(executor->max_threads, 3);
+
+        xlnt::set_executor(nullptr);
+        xlnt_assert(xlnt::current_executor() != executor);
+        const auto final_runs = executor->runs;
+        loaded.load(data, load_options);
+        xlnt_assert_equals(executor->runs, final_runs);
+    }
+
+    void test_load_limits()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).value("string " + std::to_string(row));
+            ws.cell(2, row).value(static_cast<double>(row));
+            ws.cell(2, row).font(xlnt::font().size(8.0 + row % 10));
+        }
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        auto load = [&data](const xlnt::load_options &options) {
+            xlnt::workbook loaded;
+            loaded.load(data, options);
+            return loaded.active_sheet().highest_row();
+        };
+
+        xlnt::load_options generous;
+        generous.max_cells = 200;
+        generous.max_shared_strings = 100;
+        generous.max_part_size = 1024 * 1024;
+        generous.max_styles = 100;
+        xlnt_assert_equals(load(generous), 100);
+
+        for (auto lazy : {false, true})
+        {
+            for (auto pipelined : {false, true})
+            {
+                xlnt::load_options options;
+                options.lazy_shared_strings = lazy;
+                options.pipelined_sheet_data = pipelined;
+                options.sheet_data_batch_size = 16;
+
+                options.max_cells = 199;
+                xlnt_assert_throws(load(options), xlnt::limit_exceeded);
+                options.max_cells = 0;
+
+                options.max_shared_strings = 99;
+                xlnt_assert_throws(load(options), xlnt::limit_exceeded);
+                options.max_shared_strings = 0;
+
+                options.max_part_size = 1024;
+                xlnt_assert_throws(load(options), xlnt::limit_exceeded);
+                options.max_part_size = 0;
+
+                options.max_styles = 5;
+                xlnt_assert_throws(load(options), xlnt::limit_exceeded);
+            }
+        }
+    }
+
+    void test_load_values_only()
+    {
+        xlnt::load_options options;
+        options.values_only = true;
+
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::workbook expected(file);
+        xlnt::workbook values;
+        values.load(file, options);
+
+        auto comments = 0;
+        auto hyperlinks = 0;
+
+        for (const auto &expected_ws : expected)
+        {
+            const auto ws = values.sheet_by_title(expected_ws.title());
+
+            for (auto row : expected_ws.rows())
+            {
+                for (auto expected_cell : row)
+                {
+                    xlnt_assert(ws.has_cell(expected_cell.reference()));
+                    const auto cell = ws.cell(expected_cell.reference());
+                    xlnt_assert(cell.data_type() == expected_cell.data_type());
+                    xlnt_assert_equals(cell.to_string(), expected_cell.to_string());
+                    xlnt_assert(!cell.has_comment() && !cell.has_hyperlink());
+                    comments += expected_cell.has_comment() ? 1 : 0;
+                    hyperlinks += expected_cell.has_hyperlink() ? 1 : 0;
+                }
+            }
+        }
+
+        xlnt_assert(comments > 0 && hyperlinks > 0);
+
+        // the number formats are still read to recognise dates
+        xlnt::workbook dated;
+        dated.active_sheet().cell("A1").value(xlnt::date(2024, 2, 29));
+        dated.active_sheet().cell("B1").value(1.5);
+        dated.active_sheet().cell("B1").font(xlnt::font().bold(true));
+        std::vector<std::uint8_t> saved;
+        dated.save(saved);
+
+        xlnt::workbook dated_values;
+        dated_values.load(saved, options);
+        const auto ws = dated_values.active_sheet();
+        xlnt_assert(ws.cell("A1").is_date());
+        xlnt_assert(ws.cell("A1").value<xlnt::date>() == xlnt::date(2024, 2, 29));
+        xlnt_assert(!ws.cell("B1").is_date());
+        xlnt_assert_equals(ws.cell("B1").value<double>(), 1.5);
+    }
+
+    void test_lazy_binaries()
+    {
+        xlnt::load_options lazy_options;
+        lazy_options.lazy_binaries = true;
+
+        for (auto file : {"14_images.xlsx", "17_xlsm.xlsm", "10_comments_hyperlinks_formulae.xlsx"})
+        {
+            xlnt::workbook eager;
+            eager.load(path_helper::test_file(file));
+            xlnt::workbook lazy;
+            lazy.load(path_helper::test_file(file), lazy_options);
+            xlnt_assert(lazy.memory_usage().binaries > 0);
+
+            // the untouched parts are copied into the saved archive as they were
+            std::vector<std::uint8_t> saved;
+            lazy.save(saved);
+            xlnt::workbook reloaded;
+            reloaded.load(saved);
+            std::vector<std::uint8_t> eager_saved;
+            eager.save(eager_saved);
+            xlnt::workbook eager_reloaded;
+            eager_reloaded.load(eager_saved);
+            xlnt_assert(reloaded.binaries() == eager.binaries());
+            xlnt_assert(reloaded.compare(eager_reloaded, false));
+
+            // accessing them inflates them
+            xlnt_assert(lazy.binaries() == eager.binaries());
+            xlnt_assert(lazy.compare(eager, false));
+        }
+    }
+
+    void test_preserve_unchanged_parts()
+    {
+        xlnt::load_options lazy_options;
+        lazy_options.lazy_worksheets = true;
+        xlnt::save_options preserve_options;
+        preserve_options.preserve_unchanged_parts = true;
+
+        for (auto file : {"10_comments_hyperlinks_formulae.xlsx", "11_print_settings.xlsx",
+                 "14_images.xlsx", "19_defined_names.xlsx"})
+        {
+            // the worksheets after the first are left untouched
+            std::vector<std::uint8_t> data;
+            {
+                xlnt::workbook original(path_helper::test_file(file));
+                original.create_sheet(0).cell("A1").value("first");
+                original.save(data);
+            }
+
+            xlnt::workbook lazy;
+            lazy.load(data, lazy_options);
+            lazy.sheet_by_index(0).cell("A2").value("changed");
+            xlnt::workbook eager;
+            eager.load(data);
+            eager.sheet_by_index(0).cell("A2").value("changed");
+
+            // only the worksheet which has been accessed is written again
+            xlnt::io_stats stats;
+            preserve_options.stats = &stats;
+            std::vector<std::uint8_t> saved;
+            lazy.save(saved, preserve_options);
+            xlnt_assert_equals(stats.sheet_data.count, 1);
+
+            xlnt::workbook reloaded;
+            reloaded.load(saved);
+            std::vector<std::uint8_t> eager_saved;
+            eager.save(eager_saved);
+            xlnt::workbook eager_reloaded;
+            eager_reloaded.load(eager_saved);
+            xlnt_assert(reloaded.compare(eager_reloaded, false));
+        }
+
+        // formats which may have lost their last reference are removed before saving,
+        // which renumbers the ones the copied worksheets would refer to
+        xlnt::workbook lazy;
+        lazy.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), lazy_options);
+        lazy.sheet_by_index(0).cell("A1").font(xlnt::font().bold(true));
+        xlnt::io_stats stats;
+        preserve_options.stats = &stats;
+        std::vector<std::uint8_t> saved;
+        lazy.save(saved, preserve_options);
+        xlnt_assert_equals(stats.sheet_data.count, lazy.sheet_count());
+    }
+
+    void test_update()
+    {
+        temporary_file updated_file;
+        xlnt::workbook(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx")).save(updated_file.get_path());
+        xlnt::workbook expected(updated_file.get_path());
+        expected.sheet_by_index(1).cell("A1").value(42);
+
+        // only the modified worksheet is written again, and the shared strings are
+        // copied as they were since none were added
+        xlnt::io_stats stats;
+        xlnt::save_options options;
+        options.stats = &stats;
+        xlnt::workbook updated;
+        updated.update(updated_file.get_path(), [](xlnt::workbook &wb) {
+            wb.sheet_by_index(1).cell("A1").value(42);
+        }, xlnt::load_options(), options);
+        xlnt_assert_equals(stats.sheet_data.count, 1);
+        xlnt_assert_equals(stats.shared_strings.count, 0);
+
+        std::vector<std::uint8_t> expected_saved;
+        expected.save(expected_saved);
+        xlnt::workbook expected_reloaded;
+        expected_reloaded.load(expected_saved);
+        xlnt_assert(xlnt::workbook(updated_file.get_path()).compare(expected_reloaded, false));
+
+        // adding a string rewrites the table
+        updated.update(updated_file.get_path(), [](xlnt::workbook &wb) {
+            wb.sheet_by_index(0).cell("A1").value("added");
+        });
+        const xlnt::workbook reloaded(updated_file.get_path());
+        xlnt_assert_equals(reloaded.sheet_by_index(0).cell("A1").value<std::string>(), "added");
+        xlnt_assert_equals(reloaded.sheet_by_index(1).cell("A1").value<int>(), 42);
+    }
+
+    void test_io_stats()
+    {
+        xlnt::io_stats load_stats;
+        xlnt::load_options load_options;
+        load_options.stats = &load_stats;
+        xlnt::workbook wb;
+        wb.load(path_helper::test_file("excel_test_sheet.xlsx"), load_options);
+
+        xlnt_assert(load_stats.total.seconds > 0.0);
+        xlnt_assert_equals(load_stats.total.count, 1);
+        xlnt_assert(load_stats.archive.bytes > 0);
+        xlnt_assert(!load_stats.parts.empty());
+        xlnt_assert(load_stats.archive.count >= load_stats.parts.size());
+        xlnt_assert_equals(load_stats.inflate.count, load_stats.parts.size());
+        xlnt_assert_equals(load_stats.sheet_data.count, wb.sheet_count());
+        xlnt_assert_equals(load_stats.shared_strings.count, 1);
+        xlnt_assert_equals(load_stats.stylesheet.count, 1);
+        xlnt_assert(load_stats.cells > 0);
+        xlnt_assert_equals(load_stats.strings, wb.shared_strings().size());
+        xlnt_assert(load_stats.formats > 0);
+
+        const auto sheet = std::find_if(load_stats.parts.begin(), load_stats.parts.end(),
+            [](const xlnt::io_stats::part &part) { return part.path == "xl/worksheets/sheet1.xml"; });
+        xlnt_assert(sheet != load_stats.parts.end());
+        xlnt_assert(sheet->compression.bytes > 0);
+
+        xlnt::io_stats save_stats;
+        xlnt::save_options save_options;
+        save_options.stats = &save_stats;
+        std::vector<std::uint8_t> data;
+        wb.save(data, save_options);
+
+        xlnt_assert_equals(save_stats.total.count, 1);
+        xlnt_assert(save_stats.deflate.bytes > 0);
+        xlnt_assert(save_stats.deflate.bytes <= data.size());
+        xlnt_assert_equals(save_stats.deflate.count, save_stats.parts.size());
+        xlnt_assert_equals(save_stats.archive.count, save_stats.parts.size());
+        xlnt_assert_equals(save_stats.sheet_data.count, wb.sheet_count());
+        xlnt_assert_equals(save_stats.cells, load_stats.cells);
+
+        // statistics add up until they are reset
+        wb.save(data, save_options);
+        xlnt_assert_equals(save_stats.total.count, 2);
+        save_stats.reset();
+        xlnt_assert_equals(save_stats.total.count, 0);
+        xlnt_assert(save_stats.parts.empty());
+    }
+
     void test_load_file_encrypted()
     {
         const auto password = u8"\u043F\u0430\u0440\u043E\u043B\u044C"; // u8"пароль"
@@ -589,6 +2059,90 @@ public:
         xlnt_assert(wb_path.compare(wb_load5, false));
     }
 
+    void test_encryption_key()
+    {
+        const auto file = path_helper::test_file("5_encrypted_agile.xlsx");
+        xlnt::encryption_key key("secret");
+        xlnt_assert_equals(key.derived_key_count(), 0);
+
+        xlnt::workbook wb;
+        wb.load(file, key);
+        xlnt_assert_equals(key.derived_key_count(), 1);
+
+        // the key of the same file is derived once
+        xlnt::workbook again;
+        again.load(file, key);
+        xlnt_assert_equals(key.derived_key_count(), 1);
+        xlnt_assert(wb.compare(again, false));
+
+        std::stringstream saved;
+        wb.save(saved, key);
+        const auto derived = key.derived_key_count();
+
+        std::stringstream saved_again;
+        wb.save(saved_again, key);
+        xlnt::workbook reloaded;
+        reloaded.load(saved_again, key);
+        xlnt_assert_equals(key.derived_key_count(), derived);
+        xlnt_assert(wb.compare(reloaded, false));
+
+        // keys derived from a password string and from an encryption_key match
+        xlnt::workbook with_password;
+        with_password.load(saved, "secret");
+        xlnt_assert(wb.compare(with_password, false));
+    }
+
+    void test_calculate()
+    {
+        xlnt::workbook wb(path_helper::test_file("18_formulae.xlsx"));
+        auto ws = wb.active_sheet();
+        ws.cell("C2").value(0);
+        ws.cell("E2").value(0);
+
+        // the array formula in G1 and I2, which uses COS, keep their cached values
+        xlnt_assert_equals(wb.calculate(), 13);
+        xlnt_assert_equals(ws.cell("C2").value<double>(), 4.0);
+        xlnt_assert_equals(ws.cell("E2").value<std::string>(), "4a22");
+        xlnt_assert_equals(ws.cell("F4").value<double>(), 2.0);
+        xlnt_assert_delta(ws.cell("I2").value<double>(), -0.6536, 1e-4);
+
+        // only the formulas depending on B2 are evaluated again
+        xlnt_assert_equals(wb.calculate(), 0);
+        ws.cell("B2").value(5);
+        xlnt_assert_equals(wb.calculate(), 3);
+        xlnt_assert_equals(ws.cell("C2").value<double>(), 25.0);
+        xlnt_assert_equals(ws.cell("E2").value<std::string>(), "25a25");
+
+        xlnt::workbook built;
+        auto data = built.active_sheet();
+        auto other = built.create_sheet();
+        other.title("Other Sheet");
+        other.cell("A1").value(21);
+        data.cell("A1").value(1);
+        data.cell("A2").value(2);
+        data.cell("A3").value("text");
+        data.cell("B1").formula("SUM(A:A)*'Other Sheet'!A1");
+        data.cell("B2").formula("IF(B1>50,A3&\" \"&B1,\"small\")");
+        data.cell("B3").formula("IFERROR(A1/0,-1)");
+        data.cell("B4").formula("B5+1");
+        data.cell("B5").formula("B4+1");
+
+        // formulas in a cycle aren't evaluated
+        xlnt_assert_equals(built.calculate(2), 3);
+        xlnt_assert_equals(data.cell("B1").value<double>(), 63.0);
+        xlnt_assert_equals(data.cell("B2").value<std::string>(), "text 63");
+        xlnt_assert_equals(data.cell("B3").value<double>(), -1.0);
+        xlnt_assert(!data.cell("B4").has_value());
+
+        other.cell("A1").value(2);
+        xlnt_assert_equals(built.calculate(), 2);
+        xlnt_assert_equals(data.cell("B2").value<std::string>(), "small");
+
+        data.cell("B3").formula("A1/0");
+        xlnt_assert_equals(built.calculate(), 1);
+        xlnt_assert_equals(data.cell("B3").error(), "#DIV/0!");
+    }
+
     void test_Issue279()
     {
         xlnt::workbook wb(path_helper::test_file("Issue279_workbook_delete_rename.xlsx"));
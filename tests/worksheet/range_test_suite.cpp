@@ -22,9 +22,15 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <cmath>
+
 #include <helpers/test_suite.hpp>
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/comment.hpp>
+#include <xlnt/styles/fill.hpp>
 #include <xlnt/styles/font.hpp>
+#include <xlnt/styles/format.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/range.hpp>
@@ -38,12 +44,17 @@ public:
     {
         register_test(test_construction);
         register_test(test_batch_formatting);
+        register_test(test_batch_format_groups);
         register_test(test_clear_cells);
         register_test(test_whole_column_reference);
         register_test(test_whole_row_reference);
         register_test(test_mixed_reference_formats);
         register_test(test_invalid_references);
         register_test(test_offset);
+        register_test(test_bulk_values);
+        register_test(test_aggregates);
+        register_test(test_sort);
+        register_test(test_chars);
     }
 
     void test_construction()
@@ -104,6 +115,39 @@ public:
         xlnt_assert(!ws.cell("B2").has_format());
     }
 
+    void test_batch_format_groups()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto red = xlnt::fill::solid(xlnt::color::red());
+
+        // cells starting out unformatted, bold and italic each end up with their own format
+        ws.range("A1:C300").font(xlnt::font().bold(true));
+        ws.range("B1:B300").font(xlnt::font().italic(true));
+        ws.range("A1:D300").fill(red);
+
+        xlnt_assert(ws.cell("A300").font().bold());
+        xlnt_assert(ws.cell("B300").font().italic());
+        xlnt_assert(!ws.cell("D300").format().font_applied());
+        xlnt_assert_equals(ws.cell("C1").fill(), red);
+        xlnt_assert_equals(ws.cell("D1").fill(), red);
+        xlnt_assert_throws_nothing(wb.format(3));
+        xlnt_assert_throws(wb.format(4), xlnt::invalid_parameter);
+
+        auto highlight = wb.create_format();
+        highlight.fill(xlnt::fill::solid(xlnt::color::yellow()));
+        ws.range("A1:D300").format(highlight);
+        xlnt_assert_equals(ws.cell("A1").fill(), highlight.fill());
+        xlnt_assert_equals(ws.cell("D300").fill(), highlight.fill());
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        xlnt_assert_equals(loaded.active_sheet().cell("C300").fill(), highlight.fill());
+        xlnt_assert(!loaded.active_sheet().cell("E1").has_format());
+    }
+
     void test_clear_cells()
     {
         xlnt::workbook wb;
@@ -288,5 +332,154 @@ public:
         xlnt_assert_equals(xlnt::range_reference("B3:E10").make_offset(2, 5), xlnt::range_reference("D8:G15"));
         xlnt_assert_differs(xlnt::range_reference("B3:E10").make_offset(3, 5), xlnt::range_reference("D8:G15"));
     }
+
+    void test_sort()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("header");
+        ws.range("A2:B6").assign(std::vector<std::string>{"apple", "1", "apple", "2", "", "3", "Banana", "4", "apple", "5"});
+        ws.cell("A3").value(7);
+        ws.cell("A6").value("Apple");
+        ws.cell("A4").clear_value();
+        ws.cell("B3").fill(xlnt::fill::solid(xlnt::rgb_color(255, 0, 0)));
+        ws.cell("B6").comment(xlnt::comment("fifth", "author"));
+        ws.cell("C5").value("outside");
+
+        // numbers first, strings ignoring case with ties in their order, empty keys last
+        ws.range("A2:B6").sort({xlnt::column_t("A")});
+        std::vector<std::string> sorted;
+        ws.range("A2:B6").strings(sorted, "-");
+        xlnt_assert_equals(sorted, std::vector<std::string>({"-", "2", "apple", "1", "Apple", "5", "Banana", "4", "-", "3"}));
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 7);
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "header");
+        xlnt_assert_equals(ws.cell("C5").value<std::string>(), "outside");
+
+        // formats and comments move with their cells
+        xlnt_assert(ws.cell("B2").has_format() && ws.cell("B2").fill() == xlnt::fill::solid(xlnt::rgb_color(255, 0, 0)));
+        xlnt_assert(ws.cell("B4").has_comment());
+        xlnt_assert_equals(ws.cell("B4").comment().plain_text(), "fifth");
+        xlnt_assert(!ws.cell("B6").has_comment());
+
+        ws.range("A2:B6").sort({xlnt::column_t("B")}, false, 4);
+        ws.range("B2:B6").strings(sorted, "-");
+        xlnt_assert_equals(sorted, std::vector<std::string>({"5", "4", "3", "2", "1"}));
+
+        xlnt_assert_throws(ws.range("A2:B6").sort({xlnt::column_t("C")}), xlnt::invalid_parameter);
+        ws.merge_cells("B7:C8");
+        xlnt_assert_throws(ws.range("A2:B8").sort({xlnt::column_t("A")}), xlnt::invalid_parameter);
+    }
+
+    void test_bulk_values()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        auto range = ws.range("B2:C4");
+        range.assign(std::vector<double>{1, 2, 3, 4, 5, 6});
+        xlnt_assert_equals(ws.cell("C2").value<double>(), 2);
+        xlnt_assert_equals(ws.cell("B3").value<double>(), 3);
+        ws.cell("C3").value("text");
+        ws.cell("A1").value(9);
+
+        // fewer cells in the range than stored, so they are looked up
+        std::vector<double> values;
+        ws.range("A1:B2").values(values, -1);
+        xlnt_assert_equals(values, std::vector<double>({9, -1, -1, 1}));
+
+        range.values(values, -1);
+        xlnt_assert_equals(values, std::vector<double>({1, 2, 3, -1, 5, 6}));
+
+        // more cells in the range than stored, so the stored cells are visited instead
+        xlnt::range(ws, xlnt::range_reference("B2:C9"), xlnt::major_order::column).values(values);
+        xlnt_assert_equals(values.size(), 16);
+        xlnt_assert_equals(values[1], 3);
+        xlnt_assert_equals(values[8], 2);
+
+        std::vector<std::string> strings;
+        range.strings(strings, "-");
+        xlnt_assert_equals(strings, std::vector<std::string>({"-", "-", "-", "text", "-", "-"}));
+
+        xlnt::range(ws, xlnt::range_reference("D1:D2"), xlnt::major_order::column)
+            .assign(std::vector<std::string>{"top", "bottom"});
+        xlnt_assert_equals(ws.cell("D2").value<std::string>(), "bottom");
+        xlnt_assert_throws(range.assign(std::vector<double>{1}), xlnt::invalid_parameter);
+    }
+
+    void test_aggregates()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            ws.cell("A1").value(100);
+
+            for (xlnt::row_t row = 2; row <= 101; ++row)
+            {
+                ws.cell(2, row).value(static_cast<double>(row));
+                ws.cell(3, row).value("text");
+                ws.cell(4, row).value(true);
+            }
+
+            ws.cell("B50").clear_value();
+
+            // fewer cells in the range than stored, so they are looked up on one thread
+            auto small = ws.range("A1:B3");
+            xlnt_assert_equals(small.sum(4), 105);
+            xlnt_assert_equals(small.count_numeric(4), 3);
+            xlnt_assert_equals(small.min(4), 2);
+            xlnt_assert_equals(small.max(4), 100);
+            xlnt_assert_equals(small.mean(4), 35);
+
+            // more cells in the range than stored, so parts of its rows are summed on threads
+            auto large = ws.range("B1:D1000");
+            const auto total = 5150.0 - 50;
+
+            for (std::size_t threads : {1, 3})
+            {
+                xlnt_assert_equals(large.sum(threads), total);
+                xlnt_assert_equals(large.count_numeric(threads), 99);
+                xlnt_assert_equals(large.min(threads), 2);
+                xlnt_assert_equals(large.max(threads), 101);
+                xlnt_assert_equals(large.mean(threads), total / 99);
+            }
+
+            auto text = ws.range("C1:D200");
+            xlnt_assert_equals(text.sum(), 0);
+            xlnt_assert_equals(text.count_numeric(), 0);
+            xlnt_assert_equals(text.min(), 0);
+            xlnt_assert_equals(text.max(), 0);
+            xlnt_assert(std::isnan(text.mean()));
+        }
+    }
+
+    void test_chars()
+    {
+        const char text[] = "$B$2:AA100,C3";
+        const auto comma = text + 11;
+
+        const auto ref = xlnt::range_reference::from_chars(text, comma);
+        xlnt_assert_equals(ref, xlnt::range_reference("$B$2:AA100"));
+        xlnt_assert(ref.top_left().column_absolute());
+        xlnt_assert(!ref.bottom_right().row_absolute());
+        xlnt_assert_equals(xlnt::range_reference::from_chars(comma + 1, text + sizeof(text) - 1),
+            xlnt::range_reference("C3:C3"));
+        xlnt_assert_equals(xlnt::cell_reference::from_chars(text + 5, comma), xlnt::cell_reference("AA100"));
+        xlnt_assert_throws(xlnt::range_reference::from_chars(text, text + 6), xlnt::invalid_cell_reference);
+
+        const auto columns = xlnt::range_reference("$C:E");
+        xlnt_assert(columns.whole_column());
+        xlnt_assert_equals(columns.to_string(), "$C$1:E$1048576");
+
+        char buffer[xlnt::range_reference::max_string_length];
+        const xlnt::range_reference widest("$XFD$1048576:$XFD$1048576");
+        xlnt_assert_equals(std::string(buffer, widest.to_chars(buffer)), "$XFD$1048576");
+        const xlnt::range_reference widest_range(xlnt::cell_reference("$A$1048576"), xlnt::cell_reference("$XFD$1048576"));
+        const auto end = widest_range.to_chars(buffer);
+        xlnt_assert_equals(std::string(buffer, end), widest_range.to_string());
+        xlnt_assert(end - buffer <= static_cast<std::ptrdiff_t>(xlnt::range_reference::max_string_length));
+    }
 };
 static range_test_suite x;
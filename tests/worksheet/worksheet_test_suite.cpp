@@ -22,14 +22,29 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <atomic>
+#include <cmath>
+#include <sstream>
+#include <tuple>
+
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/hyperlink.hpp>
+#include <xlnt/packaging/manifest.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/utils/date.hpp>
+#include <xlnt/workbook/cell_storage.hpp>
+#include <xlnt/workbook/memory_usage.hpp>
 #include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/arrow_export.hpp>
+#include <xlnt/worksheet/auto_fit_options.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/csv_options.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/row_properties.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
+#include <xlnt/worksheet/worksheet_diff.hpp>
 #include <helpers/test_suite.hpp>
 
 class worksheet_test_suite : public test_suite
@@ -62,6 +77,8 @@ public:
         register_test(test_merge_range_string);
         register_test(test_unmerge_bad);
         register_test(test_unmerge_range_string);
+        register_test(test_merged_range_index);
+        register_test(test_properties_stay_ordered);
         register_test(test_defined_names);
         register_test(test_freeze_panes_horiz);
         register_test(test_freeze_panes_vert);
@@ -87,6 +104,9 @@ public:
         register_test(test_unique_sheet_name);
         register_test(test_page_margins);
         register_test(test_garbage_collect);
+        register_test(test_fingerprint);
+        register_test(test_diff);
+        register_test(test_find);
         register_test(test_has_cell);
         register_test(test_get_range_by_string);
         register_test(test_operators);
@@ -118,6 +138,22 @@ public:
         register_test(test_throw_empty_cell);
         register_test(test_zoom_scale);
         register_test(test_zoom_scale_no_view);
+        register_test(test_dense_cell_storage);
+        register_test(test_frozen_cell_storage);
+        register_test(test_spilled_cell_storage);
+        register_test(test_append_row_and_write_block);
+        register_test(test_read_block);
+        register_test(test_append_typed_rows);
+        register_test(test_auto_fit_columns);
+        register_test(test_sparse_iteration_skip_empty);
+        register_test(test_dimension_follows_cell_changes);
+        register_test(test_shift_cells_in_dense_storage);
+        register_test(test_cells_view);
+        register_test(test_parallel_for_each_cell);
+        register_test(test_add_hyperlinks);
+        register_test(test_export_csv);
+        register_test(test_import_csv);
+        register_test(test_export_arrow);
     }
 
     void test_new_worksheet()
@@ -405,6 +441,84 @@ public:
         xlnt_assert_equals(ws.merged_ranges().size(), 0);
     }
 
+    void test_merged_range_index()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        // a grid of 2x3 merges with a gap column between them, plus one tall merge
+        for (xlnt::row_t row = 1; row <= 300; row += 2)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 30; column += 4)
+            {
+                ws.merge_cells(xlnt::range_reference(column, row, column + 2, row + 1));
+            }
+        }
+
+        ws.merge_cells("AH1:AH500");
+        xlnt_assert_equals(ws.merged_ranges().size(), 150 * 8 + 1);
+        xlnt_assert_equals(ws.merged_ranges().back(), xlnt::range_reference("AH1:AH500"));
+
+        xlnt_assert_equals(ws.merged_range("B4").get(), xlnt::range_reference("A3:C4"));
+        xlnt_assert_equals(ws.merged_range("G300").get(), xlnt::range_reference("E299:G300"));
+        xlnt_assert_equals(ws.merged_range("AH450").get(), xlnt::range_reference("AH1:AH500"));
+        xlnt_assert(!ws.merged_range("D4").is_set());
+        xlnt_assert(!ws.merged_range("A301").is_set());
+
+        xlnt_assert_throws(ws.merge_cells("C2:D2"), xlnt::invalid_parameter);
+        xlnt_assert_throws(ws.merge_cells("AG400:AI400"), xlnt::invalid_parameter);
+        xlnt_assert_throws(ws.merge_cells("A1:C2"), xlnt::invalid_parameter);
+        ws.merge_cells("D1:D300");
+
+        ws.unmerge_cells("A3:C4");
+        xlnt_assert(!ws.merged_range("B4").is_set());
+        xlnt_assert(!ws.cell("B4").is_merged());
+        ws.merge_cells("A3:B4");
+        xlnt_assert_equals(ws.merged_range("B3").get(), xlnt::range_reference("A3:B4"));
+
+        // the index follows merges which are moved along with their cells
+        ws.insert_rows(1, 10);
+        xlnt_assert_equals(ws.merged_range("B14").get(), xlnt::range_reference("A13:B14"));
+        xlnt_assert(!ws.merged_range("B4").is_set());
+    }
+
+    void test_properties_stay_ordered()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row : {7u, 3u, 12u, 5u})
+        {
+            ws.row_properties(row).height = static_cast<double>(row);
+        }
+
+        ws.column_properties("D").width = 4.0;
+        ws.column_properties("B").width = 2.0;
+        xlnt_assert_equals(ws.lowest_row_or_props(), 3);
+        xlnt_assert_equals(ws.highest_row_or_props(), 12);
+        xlnt_assert_equals(ws.lowest_column_or_props(), xlnt::column_t("B"));
+        xlnt_assert_equals(ws.highest_column_or_props(), xlnt::column_t("D"));
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A3:A12"));
+
+        ws.insert_rows(5, 2);
+        ws.delete_rows(3, 1);
+        xlnt_assert(!ws.has_row_properties(3));
+        xlnt_assert_equals(ws.row_properties(6).height.get(), 5.0);
+        xlnt_assert_equals(ws.row_properties(8).height.get(), 7.0);
+        xlnt_assert_equals(ws.highest_row_or_props(), 13);
+
+        ws.insert_columns(3, 1);
+        xlnt_assert_equals(ws.column_properties("E").width.get(), 4.0);
+        const auto &const_ws = ws;
+        xlnt_assert_throws(const_ws.column_properties("D"), xlnt::key_not_found);
+
+        std::vector<std::uint8_t> saved;
+        wb.save(saved);
+        xlnt::workbook loaded;
+        loaded.load(saved);
+        xlnt_assert(loaded.active_sheet().compare(ws, false));
+    }
+
     void test_defined_names()
     {
         xlnt::workbook wb;
@@ -971,6 +1085,118 @@ public:
         xlnt_assert_equals(dimensions, xlnt::range_reference("B2", "B2"));
     }
 
+    void test_fingerprint()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        xlnt_assert(ws.fingerprints().empty());
+
+        ws.cell("A1").value(42);
+        ws.cell("B2").value("text");
+        ws.cell("C3000").formula("=A1*2");
+        const auto original = ws.fingerprint();
+        const auto chunks = ws.fingerprints();
+        xlnt_assert_equals(chunks.size(), 2);
+        xlnt_assert_equals(chunks[0].first, 1);
+        xlnt_assert_equals(chunks[1].first, 2049);
+
+        // cells without content and the way a number is held don't count
+        ws.cell("D4");
+        ws.cell("A1").value(42.0);
+        xlnt_assert_equals(ws.fingerprint(), original);
+
+        // a copy of the worksheet has the same fingerprint
+        auto copy = wb.copy_sheet(ws);
+        xlnt_assert_equals(copy.fingerprint(), original);
+
+        // only the chunk with the changed cell differs
+        ws.cell("C3000").formula("=A1*3");
+        xlnt_assert_differs(ws.fingerprint(), original);
+        const auto changed = ws.fingerprints();
+        xlnt_assert_equals(changed[0], chunks[0]);
+        xlnt_assert_differs(changed[1].second, chunks[1].second);
+
+        // moving a value to another cell changes it too
+        ws.cell("C3000").formula("=A1*2");
+        xlnt_assert_equals(ws.fingerprint(), original);
+        ws.cell("A1").clear_value();
+        ws.cell("A2").value(42);
+        xlnt_assert_differs(ws.fingerprint(), original);
+
+        xlnt_assert_throws(ws.fingerprints(0), xlnt::invalid_parameter);
+    }
+
+    void test_diff()
+    {
+        // the strings are added in a different order, so their indices differ
+        xlnt::workbook yesterday;
+        auto older = yesterday.active_sheet();
+        older.cell("A1").value("unchanged");
+        older.cell("B1").value("old");
+        older.cell("A5000").value(1);
+        older.cell("C5000").value(2);
+        older.cell("A9000").value(3);
+        older.cell("A9000").number_format(xlnt::number_format("0.000"));
+
+        xlnt::workbook today;
+        auto newer = today.active_sheet();
+        newer.cell("B1").value("new");
+        newer.cell("A1").value("unchanged");
+        newer.cell("A5000").value(1);
+        newer.cell("B5000").value(5);
+        newer.cell("A9000").value(3);
+        newer.cell("A9000").number_format(xlnt::number_format("0.000"));
+
+        const auto diff = newer.diff(older);
+        xlnt_assert_equals(diff.changed.size(), 1);
+        xlnt_assert_equals(diff.changed[0], xlnt::cell_reference("B1"));
+        xlnt_assert_equals(diff.added.size(), 1);
+        xlnt_assert_equals(diff.added[0], xlnt::cell_reference("B5000"));
+        xlnt_assert_equals(diff.removed.size(), 1);
+        xlnt_assert_equals(diff.removed[0], xlnt::cell_reference("C5000"));
+
+        newer.cell("B1").value("old");
+        newer.cell("B5000").clear_value();
+        newer.cell("C5000").value(2);
+        xlnt_assert(newer.diff(older).empty());
+        xlnt_assert_equals(newer.fingerprint(), older.fingerprint());
+
+        // formats take part by their content
+        newer.cell("A9000").number_format(xlnt::number_format("0.00"));
+        xlnt_assert_equals(newer.diff(older).changed.size(), 1);
+    }
+
+    void test_find()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("C3").value("needle");
+        ws.cell("A7").value("needle");
+        ws.cell("B1").value("hay");
+        ws.cell("B2").value(xlnt::rich_text("needle", xlnt::font().bold(true)));
+        ws.cell("D4").value(2.5);
+        ws.cell("A4").value(2.5);
+        ws.cell("E5").value(true);
+
+        const auto texts = ws.find_all("needle");
+        xlnt_assert_equals(texts.size(), 2);
+        xlnt_assert_equals(texts[0], xlnt::cell_reference("C3"));
+        xlnt_assert_equals(texts[1], xlnt::cell_reference("A7"));
+        xlnt_assert_equals(ws.find("needle").get(), xlnt::cell_reference("C3"));
+        xlnt_assert(!ws.find("missing").is_set());
+
+        const auto numbers = ws.find_all(2.5);
+        xlnt_assert_equals(numbers.size(), 2);
+        xlnt_assert_equals(numbers[0], xlnt::cell_reference("A4"));
+        xlnt_assert_equals(ws.find(2.5).get(), xlnt::cell_reference("A4"));
+        xlnt_assert(!ws.find(1.0).is_set());
+
+        // a string stored more than once in the shared string table is found under each index
+        wb.add_shared_string(xlnt::rich_text("needle"), true);
+        ws.cell("F9").value("needle");
+        xlnt_assert_equals(ws.find_all("needle").size(), 3);
+    }
+
     void test_has_cell()
     {
         xlnt::workbook wb;
@@ -1757,6 +1983,741 @@ public:
         xlnt_assert(ws2.has_view());
         xlnt_assert_equals(85, ws2.zoom_scale());
     }
+
+    void test_dense_cell_storage()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+        xlnt_assert(dense.cell_storage() == xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            ws.cell("A1").value(1);
+            ws.cell("Q3").value("text");
+            ws.cell("B40").value(2.5);
+            ws.cell("C2").value(true);
+            ws.clear_cell("C2");
+            ws.insert_rows(2, 3);
+            ws.insert_columns(1, 20);
+        }
+
+        auto ws = dense.active_sheet();
+        xlnt_assert(!ws.has_cell("C2"));
+        xlnt_assert(ws.has_cell("U1"));
+        xlnt_assert(ws.has_cell("AK6"));
+        xlnt_assert_equals(ws.cell("V43").value<double>(), 2.5);
+        xlnt_assert_equals(ws.calculate_dimension(false), xlnt::range_reference("A1:AK43"));
+        xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("U1:AK43"));
+        xlnt_assert(hashed.compare(dense, false));
+
+        // the setting survives loading and reproduces the same workbook
+        xlnt::workbook loaded;
+        loaded.cell_storage(xlnt::cell_storage::dense_rows);
+        loaded.load(path_helper::test_file("excel_test_sheet.xlsx"));
+        xlnt_assert(loaded.cell_storage() == xlnt::cell_storage::dense_rows);
+        const xlnt::workbook expected(path_helper::test_file("excel_test_sheet.xlsx"));
+        xlnt_assert(expected.compare(loaded, false));
+
+        // converting an existing workbook keeps its cells
+        loaded.cell_storage(xlnt::cell_storage::hashed);
+        xlnt_assert(expected.compare(loaded, false));
+        xlnt_assert(loaded.active_sheet().cell("A1").worksheet() == loaded.active_sheet());
+    }
+
+    void test_frozen_cell_storage()
+    {
+        const xlnt::workbook expected(path_helper::test_file("excel_test_sheet.xlsx"));
+        xlnt::workbook hashed(path_helper::test_file("excel_test_sheet.xlsx"));
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+        dense.load(path_helper::test_file("excel_test_sheet.xlsx"));
+
+        for (auto wb : {hashed, dense})
+        {
+            const auto before = wb.active_sheet().memory_usage().cells;
+            const auto dimension = wb.active_sheet().calculate_dimension();
+            xlnt_assert(!wb.frozen());
+            wb.freeze();
+            xlnt_assert(wb.frozen());
+            xlnt_assert(expected.compare(wb, false));
+
+            auto ws = wb.active_sheet();
+            xlnt_assert(ws.memory_usage().cells < before);
+            xlnt_assert_equals(ws.calculate_dimension(), dimension);
+
+            // existing cells can be changed, but none added or removed
+            const auto first = ws.calculate_dimension().top_left();
+            ws.cell(first).value("changed");
+            xlnt_assert_equals(ws.cell(first).value<std::string>(), "changed");
+            xlnt_assert_throws(ws.cell("ZZ1000").value(1), xlnt::unsupported);
+            xlnt_assert_throws(ws.clear_cell(first), xlnt::unsupported);
+            xlnt_assert_throws(ws.insert_rows(1, 1), xlnt::unsupported);
+            xlnt_assert(!ws.has_cell("ZZ1000"));
+
+            wb.thaw();
+            xlnt_assert(!wb.frozen());
+            ws = wb.active_sheet();
+            ws.cell("ZZ1000").value(1);
+            ws.clear_cell(first);
+            xlnt_assert(!ws.has_cell(first));
+        }
+
+        // the cells of a frozen worksheet are found by rows and columns alike
+        xlnt::workbook sparse;
+        auto ws = sparse.active_sheet();
+        ws.cell("M1").value(1);
+        ws.cell("A1").value(2);
+        ws.cell("Q2").value(3);
+        ws.cell("M4").value(4);
+        sparse.freeze();
+        ws = sparse.active_sheet();
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:Q4"));
+        xlnt_assert_equals(ws.rows(true).front().front().reference(), xlnt::cell_reference("A1"));
+        xlnt_assert_equals(ws.columns(true).back().back().reference(), xlnt::cell_reference("Q2"));
+        xlnt_assert_equals(ws.cell("M4").value<int>(), 4);
+        xlnt_assert(!ws.has_cell("M2"));
+    }
+
+    void test_spilled_cell_storage()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook spilled;
+        xlnt_assert_equals(spilled.cell_memory_budget(), std::size_t(256) << 20);
+        // only the first few blocks of cells stay on the heap
+        spilled.cell_memory_budget(4096);
+        spilled.cell_storage(xlnt::cell_storage::spilled_rows);
+        xlnt_assert(spilled.cell_storage() == xlnt::cell_storage::spilled_rows);
+
+        for (auto wb : {hashed, spilled})
+        {
+            auto ws = wb.active_sheet();
+
+            for (xlnt::row_t row = 1; row <= 500; ++row)
+            {
+                for (xlnt::column_t::index_t column = 1; column <= 40; column += 3)
+                {
+                    ws.cell(column, row).value(row * 100 + column);
+                }
+            }
+
+            ws.cell("B2").value("text");
+            ws.clear_cell("D3");
+            ws.insert_rows(2, 3);
+        }
+
+        auto ws = spilled.active_sheet();
+        const auto cell = ws.cell("AN503");
+        xlnt_assert_equals(cell.value<int>(), 50040);
+        xlnt_assert_equals(ws.cell("B5").value<std::string>(), "text");
+        xlnt_assert(!ws.has_cell("D6"));
+        xlnt_assert(hashed.compare(spilled, false));
+
+        // cells keep their address as more of them are added
+        for (xlnt::row_t row = 600; row <= 700; ++row)
+        {
+            ws.cell(1, row).value(row);
+        }
+        xlnt_assert_equals(cell.value<int>(), 50040);
+
+        std::vector<std::uint8_t> saved;
+        spilled.save(saved);
+        xlnt::workbook loaded;
+        loaded.cell_memory_budget(0);
+        loaded.cell_storage(xlnt::cell_storage::spilled_rows);
+        loaded.load(saved);
+        xlnt_assert(loaded.cell_storage() == xlnt::cell_storage::spilled_rows);
+        xlnt_assert_equals(loaded.cell_memory_budget(), std::size_t(0));
+        xlnt_assert(spilled.compare(loaded, false));
+
+        loaded.cell_storage(xlnt::cell_storage::hashed);
+        xlnt_assert(spilled.compare(loaded, false));
+    }
+
+    void test_sparse_iteration_skip_empty()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            ws.cell("A1").value(1);
+            ws.cell("M1").value(2);
+            ws.cell("XFD1").value(3);
+            ws.cell("Q2").value(4);
+            ws.cell("M4").value(5);
+
+            const auto collect = [](const xlnt::range &cells) {
+                std::vector<std::string> found;
+
+                for (auto line : cells)
+                {
+                    for (auto cell : line)
+                    {
+                        found.push_back(cell.reference().to_string());
+                    }
+                }
+
+                return found;
+            };
+
+            const auto rows = std::vector<std::string>{"A1", "M1", "XFD1", "Q2", "M4"};
+            xlnt_assert(collect(ws.rows(true)) == rows);
+            const auto columns = std::vector<std::string>{"A1", "M1", "M4", "Q2", "XFD1"};
+            xlnt_assert(collect(ws.columns(true)) == columns);
+
+            std::vector<std::string> reversed;
+            const auto first_row = ws.rows(true).front();
+            for (auto cell = first_row.rbegin(); cell != first_row.rend(); ++cell)
+            {
+                reversed.push_back((*cell).reference().to_string());
+            }
+            xlnt_assert(reversed == (std::vector<std::string>{"XFD1", "M1", "A1"}));
+
+            // cells added and removed after iterating are found on the next pass
+            ws.cell("B1").value(6);
+            ws.clear_cell("M1");
+            xlnt_assert(collect(ws.rows(true)) == (std::vector<std::string>{"A1", "B1", "XFD1", "Q2", "M4"}));
+        }
+    }
+
+    void test_dimension_follows_cell_changes()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            ws.cell("C3").value(1);
+            ws.cell("E2").value(2);
+            ws.cell("B7").value(3);
+            xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("B2:E7"));
+            xlnt_assert_equals(ws.next_row(), 8);
+
+            // removing cells on the edge shrinks the dimension, others leave it
+            ws.clear_cell("C3");
+            xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("B2:E7"));
+            ws.clear_cell("B7");
+            xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("E2:E2"));
+            xlnt_assert_equals(ws.highest_row(), 2);
+            xlnt_assert_equals(ws.lowest_column(), xlnt::column_t("E"));
+
+            ws.cell("A9").value(4);
+            ws.insert_rows(1, 2);
+            xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("A4:E11"));
+            ws.clear_row(11);
+            xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("E4:E4"));
+            xlnt_assert_equals(ws.append_row(std::vector<double>{5}), 5);
+
+            ws.clear_cell("E4");
+            ws.clear_cell("A5");
+            xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("A1:A1"));
+            xlnt_assert_equals(ws.next_row(), 1);
+        }
+    }
+
+    void test_shift_cells_in_dense_storage()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+
+            // a grid spanning the edges of the dense engine's 16 column blocks
+            for (xlnt::row_t row = 1; row <= 5; ++row)
+            {
+                for (xlnt::column_t::index_t column = 12; column <= 36; column += 3)
+                {
+                    ws.cell(column, row).value(xlnt::cell_reference(column, row).to_string());
+                }
+            }
+
+            ws.insert_columns(13, 5);
+            ws.delete_columns(15, 9);
+            ws.insert_rows(2, 3);
+            ws.delete_rows(1, 2);
+            ws.cell("A1").value("new");
+        }
+
+        xlnt_assert(hashed.compare(dense, false));
+
+        auto ws = dense.active_sheet();
+        xlnt_assert_equals(ws.cell("L5").value<std::string>(), "L4");
+        xlnt_assert_equals(ws.cell("Q3").value<std::string>(), "U2");
+        xlnt_assert_equals(ws.cell("W6").value<std::string>(), "AA5");
+        xlnt_assert(!ws.has_cell("L2"));
+        xlnt_assert(!ws.has_cell("O3"));
+        xlnt_assert_equals(ws.calculate_dimension(true), xlnt::range_reference("A1:AF6"));
+        xlnt_assert_equals(ws.cell("AF6").value<std::string>(), "AJ5");
+    }
+
+    void test_cells_view()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            xlnt_assert(ws.cells().empty());
+
+            ws.cell("C2").value(1);
+            ws.cell("XFD2").value(2);
+            ws.cell("B5").value(3);
+            ws.cell("D900000").value(4);
+
+            std::vector<std::string> found;
+            for (auto cell : ws.cells())
+            {
+                found.push_back(cell.reference().to_string());
+            }
+            xlnt_assert(found == (std::vector<std::string>{"C2", "XFD2", "B5", "D900000"}));
+
+            const auto const_ws = ws;
+            const auto view = const_ws.cells();
+            found.clear();
+            for (auto cell = view.rbegin(); cell != view.rend(); ++cell)
+            {
+                found.push_back((*cell).reference().to_string());
+            }
+            xlnt_assert(found == (std::vector<std::string>{"D900000", "B5", "XFD2", "C2"}));
+
+            // wrapping in column-major order within a part of the worksheet
+            const auto part = xlnt::range_reference("B2:D5");
+            const auto by_column = xlnt::cell_vector(ws, part.top_left(), part, xlnt::major_order::column, true, true);
+            found.clear();
+            for (auto cell : by_column)
+            {
+                found.push_back(cell.reference().to_string());
+            }
+            xlnt_assert(found == (std::vector<std::string>{"B5", "C2"}));
+
+            ws.clear_cell("D900000");
+            ws.clear_cell("XFD2");
+            std::size_t visited = 0;
+            for (auto cell : ws.cells(false))
+            {
+                xlnt_assert(xlnt::range_reference("A1:C5").contains(cell.reference()));
+                ++visited;
+            }
+            xlnt_assert_equals(visited, 15);
+        }
+    }
+
+    void test_parallel_for_each_cell()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+
+            for (xlnt::row_t row = 1; row <= 1000; ++row)
+            {
+                ws.cell(1, row).value(static_cast<int>(row));
+                ws.cell(20, row).value("text");
+            }
+
+            std::atomic<long long> sum(0);
+            std::atomic<std::size_t> strings(0);
+            ws.parallel_for_each_cell([&](const xlnt::cell &cell) {
+                if (cell.data_type() == xlnt::cell::type::number)
+                {
+                    sum += cell.value<int>();
+                }
+                else if (cell.value<std::string>() == "text")
+                {
+                    ++strings;
+                }
+            },
+                4);
+            xlnt_assert_equals(sum.load(), 500500);
+            xlnt_assert_equals(strings.load(), 1000);
+
+            sum = 0;
+            ws.parallel_for_each_cell(10, 20, [&](const xlnt::cell &cell) {
+                if (cell.data_type() == xlnt::cell::type::number)
+                {
+                    sum += cell.value<int>();
+                }
+            });
+            xlnt_assert_equals(sum.load(), 165);
+
+            xlnt_assert_throws(ws.parallel_for_each_cell([](const xlnt::cell &cell) {
+                if (cell.reference() == xlnt::cell_reference("A500")) throw xlnt::invalid_parameter();
+            },
+                                   3),
+                xlnt::invalid_parameter);
+        }
+    }
+
+    void test_append_row_and_write_block()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            xlnt_assert_equals(ws.append_row(std::vector<double>{1.5, 2}), 1);
+            xlnt_assert_equals(ws.append_row(std::vector<std::string>{"a", "b", "a"}), 2);
+            xlnt_assert_equals(ws.append_row(std::vector<bool>{true, false}), 3);
+
+            // a cell set in between moves the next row down
+            ws.cell("B5").value(3);
+            xlnt_assert_equals(ws.append_row(std::vector<double>{4}), 6);
+            ws.clear_row(6);
+            xlnt_assert_equals(ws.append_row(std::vector<double>{5}), 6);
+
+            ws.write_block(xlnt::cell_reference("D2"),
+                std::vector<std::vector<std::string>>{{"x", "a"}, {"y"}, {}, {"x", "z", "x"}});
+            ws.write_block(xlnt::cell_reference("B1"), std::vector<std::vector<double>>{{7}});
+            xlnt_assert_throws(ws.write_block(xlnt::cell_reference(1, 4294967295),
+                                   std::vector<std::vector<bool>>{{true, true}}),
+                xlnt::invalid_cell_reference);
+            xlnt_assert(!ws.has_cell(xlnt::cell_reference(1, 4294967295)));
+        }
+
+        auto ws = dense.active_sheet();
+        xlnt_assert_equals(ws.cell("A1").value<double>(), 1.5);
+        xlnt_assert_equals(ws.cell("B1").value<double>(), 7);
+        xlnt_assert_equals(ws.cell("C2").value<std::string>(), "a");
+        xlnt_assert(ws.cell("A3").data_type() == xlnt::cell::type::boolean);
+        xlnt_assert(!ws.cell("B3").value<bool>());
+        xlnt_assert_equals(ws.cell("A6").value<double>(), 5);
+        xlnt_assert_equals(ws.cell("D3").value<std::string>(), "a");
+        xlnt_assert_equals(ws.cell("G4").value<std::string>(), "x");
+        xlnt_assert(!ws.has_cell("F2"));
+        xlnt_assert(!ws.has_cell("E3"));
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:G6"));
+        xlnt_assert(hashed.compare(dense, false));
+
+        // every distinct string is in the shared string table once
+        xlnt_assert_equals(dense.shared_strings().size(), 5);
+    }
+
+    void test_read_block()
+    {
+        xlnt::workbook hashed;
+        xlnt::workbook dense;
+        dense.cell_storage(xlnt::cell_storage::dense_rows);
+
+        for (auto wb : {hashed, dense})
+        {
+            auto ws = wb.active_sheet();
+            ws.cell("A1").value(9);
+            ws.cell("B2").value(1.5);
+            ws.cell("C2").value("text");
+            ws.cell("D2").value(xlnt::date(2024, 1, 1));
+            ws.cell("B3").value(true);
+            ws.cell("D4").value(-2);
+            ws.cell("E4").value(8);
+
+            std::vector<double> values(9, 0.0);
+            ws.read_block(xlnt::range_reference("B2:D4"), values.data());
+
+            xlnt_assert_equals(values[0], 1.5);
+            xlnt_assert(std::isnan(values[1]));
+            xlnt_assert_equals(values[2], xlnt::date(2024, 1, 1).to_number(xlnt::calendar::windows_1900));
+            xlnt_assert(std::isnan(values[3]));
+            xlnt_assert(std::isnan(values[4]));
+            xlnt_assert(std::isnan(values[5]));
+            xlnt_assert(std::isnan(values[6]));
+            xlnt_assert(std::isnan(values[7]));
+            xlnt_assert_equals(values[8], -2);
+
+            // empty cells are not created
+            xlnt_assert(!ws.has_cell("C4"));
+        }
+    }
+
+    void test_append_typed_rows()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("header");
+
+        const auto rows = std::vector<std::tuple<int, double, bool, std::string, xlnt::date>>{
+            std::make_tuple(1, 1.5, true, "first", xlnt::date(2024, 1, 31)),
+            std::make_tuple(-2, 2.5, false, "second", xlnt::date(2024, 2, 29))};
+        xlnt_assert_equals(ws.append_rows(rows), 2);
+
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 1);
+        xlnt_assert_equals(ws.cell("A3").value<double>(), -2);
+        xlnt_assert_equals(ws.cell("B3").value<double>(), 2.5);
+        xlnt_assert(ws.cell("C2").data_type() == xlnt::cell::type::boolean);
+        xlnt_assert(!ws.cell("C3").value<bool>());
+        xlnt_assert_equals(ws.cell("D2").value<std::string>(), "first");
+        xlnt_assert(ws.cell("E3").is_date());
+        xlnt_assert_equals(ws.cell("E3").value<xlnt::date>(), xlnt::date(2024, 2, 29));
+
+        const auto more = std::vector<std::tuple<const char *, std::int64_t>>{std::make_tuple("third", 3)};
+        xlnt_assert_equals(ws.append_rows(more), 4);
+        xlnt_assert_equals(ws.cell("B4").value<double>(), 3);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:E4"));
+    }
+
+    void test_auto_fit_columns()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("short");
+        ws.cell("B1").value("a considerably longer piece of text");
+        ws.cell("C1").value("a considerably longer piece of text");
+        ws.cell("C1").font(xlnt::font().bold(true).size(16));
+        ws.cell("E1").value(1234567.0);
+        ws.cell("E1").number_format(xlnt::number_format("#,##0.00"));
+        ws.cell("F1").value("merged across two columns, so ignored");
+        ws.cell("F2").value(true);
+        ws.merge_cells("F1:G1");
+
+        ws.auto_fit_columns();
+
+        xlnt_assert(ws.column_properties("A").best_fit);
+        xlnt_assert(ws.column_properties("A").custom_width);
+        xlnt_assert(ws.column_width("A") < ws.column_width("B"));
+        xlnt_assert(ws.column_width("B") < ws.column_width("C"));
+        xlnt_assert(!ws.has_column_properties("D"));
+        // "1,234,567.00" is wider than "1234567"
+        xlnt_assert(ws.column_width("E") > 8.0);
+        xlnt_assert(ws.column_width("F") < ws.column_width("A") + 1.0);
+
+        const auto widths = std::vector<double>{ws.column_width("A"), ws.column_width("B"), ws.column_width("C")};
+
+        for (auto row = 2u; row <= 2000; ++row)
+        {
+            ws.cell(xlnt::cell_reference("A", row)).value("short");
+        }
+
+        xlnt::auto_fit_options options;
+        options.thread_count = 4;
+        options.maximum_width = 10.0;
+        ws.auto_fit_columns(xlnt::range_reference("A1:C2000"), options);
+
+        xlnt_assert_delta(ws.column_width("A"), widths[0], 1e-9);
+        xlnt_assert_delta(ws.column_width("B"), 10.0, 1e-9);
+        xlnt_assert_delta(ws.column_width("C"), 10.0, 1e-9);
+    }
+
+    void test_add_hyperlinks()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B1").value("kept");
+
+        xlnt_assert_throws(ws.add_hyperlinks({{"A1", "https://a.example"}, {"A2", ""}}), xlnt::invalid_parameter);
+        xlnt_assert(!ws.has_cell("A1"));
+
+        std::vector<std::pair<xlnt::cell_reference, std::string>> links;
+        for (auto row = 1u; row <= 1000; ++row)
+        {
+            links.emplace_back(xlnt::cell_reference("A", row), "https://example.com/item/" + std::to_string(row % 100));
+        }
+        links.emplace_back("B1", "https://example.com/item/1");
+        ws.add_hyperlinks(links);
+
+        // links to the same url share a relationship
+        const auto ws_path = ws.path();
+        xlnt_assert_equals(wb.manifest().relationships(ws_path, xlnt::relationship_type::hyperlink).size(), 100);
+        xlnt_assert_equals(ws.cell("A1").hyperlink().relationship().id(), ws.cell("B1").hyperlink().relationship().id());
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "https://example.com/item/1");
+        xlnt_assert_equals(ws.cell("B1").hyperlink().display(), "kept");
+
+        ws.cell("C1").hyperlink("https://example.com/item/42");
+        xlnt_assert_equals(ws.cell("C1").hyperlink().relationship().id(), ws.cell("A42").hyperlink().relationship().id());
+        ws.cell("C2").hyperlink("https://example.com/other");
+        xlnt_assert_equals(ws.cell("C2").hyperlink().relationship().id(), "rId101");
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt::workbook loaded;
+        loaded.load(data);
+        const auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell("A1000").hyperlink().url(), "https://example.com/item/0");
+        xlnt_assert_equals(loaded_ws.cell("C2").hyperlink().url(), "https://example.com/other");
+    }
+
+    void test_export_csv()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B2").value("plain");
+        ws.cell("C2").value(3.5);
+        ws.cell("D2").value("a,b");
+        ws.cell("B3").value(true);
+        ws.cell("C3").value(0.25);
+        ws.cell("C3").number_format(xlnt::number_format::percentage_00());
+        ws.cell("D3").value("say \"hi\"");
+        ws.cell("E4").value("line\nbreak");
+
+        std::ostringstream formatted;
+        ws.export_csv(formatted);
+        xlnt_assert_equals(formatted.str(),
+            "plain,3.5,\"a,b\",\r\n"
+            "TRUE,25.00%,\"say \"\"hi\"\"\",\r\n"
+            ",,,\"line\nbreak\"\r\n");
+
+        xlnt::csv_options options;
+        options.delimiter = ';';
+        options.line_terminator = "\n";
+        options.formatted = false;
+        options.from_a1 = true;
+        std::ostringstream raw;
+        ws.export_csv(raw, options);
+        xlnt_assert_equals(raw.str(),
+            ";;;;\n"
+            ";plain;3.5;a,b;\n"
+            ";TRUE;0.25;\"say \"\"hi\"\"\";\n"
+            ";;;;\"line\nbreak\"\n");
+
+        options.quote_all = true;
+        options.from_a1 = false;
+        std::ostringstream quoted;
+        wb.create_sheet().export_csv(quoted, options);
+        xlnt_assert_equals(quoted.str(), "");
+        ws.cell("B2").clear_value();
+        ws.export_csv(quoted, options);
+        xlnt_assert_equals(quoted.str().substr(0, quoted.str().find('\n')), "\"\";\"3.5\";\"a,b\";\"\"");
+    }
+
+    void test_import_csv()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        std::istringstream source(
+            "name,amount,share,paid,due,ratio\r\n"
+            "\"Doe, \"\"J\"\"\",12.5,25%,true,2024-02-29,=B2*2\n"
+            "name,-3,,FALSE,2023-02-29,#N/A\n"
+            "\n"
+            "multi\nline\"\r\n");
+        ws.import_csv(source);
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "name");
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "Doe, \"J\"");
+        xlnt_assert_equals(ws.cell("B2").value<double>(), 12.5);
+        xlnt_assert_equals(ws.cell("B3").value<double>(), -3);
+        xlnt_assert_equals(ws.cell("C2").value<double>(), 0.25);
+        xlnt_assert_equals(ws.cell("C2").number_format(), xlnt::number_format::percentage());
+        xlnt_assert(!ws.has_cell("C3"));
+        xlnt_assert(ws.cell("D2").value<bool>());
+        xlnt_assert_equals(ws.cell("D3").data_type(), xlnt::cell::type::boolean);
+        xlnt_assert(ws.cell("E2").is_date());
+        xlnt_assert_equals(ws.cell("E2").value<xlnt::date>(), xlnt::date(2024, 2, 29));
+        xlnt_assert_equals(ws.cell("E3").value<std::string>(), "2023-02-29");
+        xlnt_assert_equals(ws.cell("F2").formula(), "B2*2");
+        xlnt_assert_equals(ws.cell("F3").error(), "#N/A");
+        xlnt_assert(!ws.has_cell("A4"));
+        xlnt_assert_equals(ws.cell("A5").value<std::string>(), "multi");
+        xlnt_assert_equals(ws.cell("A6").value<std::string>(), "line\"");
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:F6"));
+
+        // the strings repeated in a column are shared
+        xlnt_assert_equals(ws.cell("A1").data_type(), xlnt::cell::type::shared_string);
+        xlnt_assert_equals(ws.cell("A3").value<std::string>(), "name");
+        xlnt_assert_equals(wb.shared_strings().size(), 10);
+
+        // a sheet reads back from its own export
+        std::ostringstream exported;
+        ws.export_csv(exported);
+        auto copy = wb.create_sheet();
+        std::istringstream exported_source(exported.str());
+        xlnt::csv_options options;
+        options.infer_types = false;
+        copy.import_csv(exported_source, options);
+        xlnt_assert_equals(copy.cell("A2").value<std::string>(), "Doe, \"J\"");
+        xlnt_assert_equals(copy.cell("B2").data_type(), xlnt::cell::type::shared_string);
+        xlnt_assert_equals(copy.cell("B2").value<std::string>(), "12.5");
+        xlnt_assert_equals(copy.cell("A6").value<std::string>(), "line\"");
+    }
+
+    void test_export_arrow()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("name");
+        ws.cell("B1").value("amount");
+        ws.cell("C1").value("flag");
+        ws.cell("D1").value("mixed");
+        ws.cell("A2").value("x");
+        ws.cell("A3").value("y");
+        ws.cell("B2").value(1.5);
+        ws.cell("B4").value(-2);
+        ws.cell("C2").value(true);
+        ws.cell("C3").value(false);
+        ws.cell("D2").value(3);
+        ws.cell("D3").value("text");
+        ws.cell("D4").error("#N/A");
+        ws.cell("F2").value("outside");
+
+        ArrowSchema schema;
+        ArrowArray array;
+        xlnt::export_arrow(ws, xlnt::range_reference("A1:E4"), true, &schema, &array);
+        xlnt_assert_equals(std::string(schema.format), "+s");
+        xlnt_assert_equals(schema.n_children, 5);
+        xlnt_assert_equals(array.n_children, 5);
+        xlnt_assert_equals(array.length, 3);
+
+        const char *names[] = {"name", "amount", "flag", "mixed", "E"};
+        const char *formats[] = {"i", "g", "b", "i", "n"};
+        const std::int64_t null_counts[] = {1, 1, 1, 0, 3};
+
+        for (auto i = 0; i < 5; ++i)
+        {
+            xlnt_assert_equals(std::string(schema.children[i]->name), names[i]);
+            xlnt_assert_equals(std::string(schema.children[i]->format), formats[i]);
+            xlnt_assert_equals(array.children[i]->null_count, null_counts[i]);
+        }
+
+        auto text = [&array](int column, int row) {
+            const auto child = array.children[column];
+            const auto index = static_cast<const std::int32_t *>(child->buffers[1])[row];
+            const auto offsets = static_cast<const std::int32_t *>(child->dictionary->buffers[1]);
+            const auto characters = static_cast<const char *>(child->dictionary->buffers[2]);
+
+            return std::string(characters + offsets[index], characters + offsets[index + 1]);
+        };
+
+        xlnt_assert_equals(std::string(schema.children[0]->dictionary->format), "u");
+        xlnt_assert_equals(text(0, 0), "x");
+        xlnt_assert_equals(text(0, 1), "y");
+        xlnt_assert_equals(static_cast<const std::uint8_t *>(array.children[0]->buffers[0])[0], 3);
+
+        const auto amounts = static_cast<const double *>(array.children[1]->buffers[1]);
+        xlnt_assert_equals(amounts[0], 1.5);
+        xlnt_assert_equals(amounts[2], -2.0);
+
+        const auto flags = static_cast<const std::uint8_t *>(array.children[2]->buffers[1]);
+        xlnt_assert_equals(flags[0] & 3, 1);
+
+        // numbers in a column of text become text
+        xlnt_assert_equals(text(3, 0), "3");
+        xlnt_assert_equals(text(3, 1), "text");
+        xlnt_assert_equals(text(3, 2), "#N/A");
+        xlnt_assert_equals(array.children[4]->n_buffers, 0);
+
+        schema.release(&schema);
+        array.release(&array);
+        xlnt_assert(schema.release == nullptr);
+        xlnt_assert(array.release == nullptr);
+
+        xlnt::export_arrow(ws, xlnt::range_reference("B2:B4"), false, &schema, &array);
+        xlnt_assert_equals(std::string(schema.children[0]->name), "B");
+        xlnt_assert_equals(array.length, 3);
+        schema.release(&schema);
+        array.release(&array);
+    }
 };
 
 static worksheet_test_suite x;